@@ -629,8 +629,11 @@ bfd_openr_next_archived_file (bfd *archive, bfd *last_file)
 		   openr_next_archived_file, (archive, last_file));
 }
 
-bfd *
-bfd_generic_openr_next_archived_file (bfd *archive, bfd *last_file)
+/* APPLE LOCAL: Return the file position of the element following
+   LAST_FILE in ARCHIVE, or of the first element if LAST_FILE is NULL.  */
+
+static file_ptr
+archive_next_element_filepos (bfd *archive, bfd *last_file)
 {
   file_ptr filestart;
 
@@ -659,9 +662,159 @@ bfd_generic_openr_next_archived_file (bfd *archive, bfd *last_file)
       filestart += filestart % 2;
     }
 
-  return _bfd_get_elt_at_filepos (archive, filestart);
+  return filestart;
+}
+
+bfd *
+bfd_generic_openr_next_archived_file (bfd *archive, bfd *last_file)
+{
+  return _bfd_get_elt_at_filepos (archive,
+				  archive_next_element_filepos (archive,
+								last_file));
+}
+
+/* APPLE LOCAL begin archive member index  */
+
+struct ar_member_index_entry
+{
+  const char *name;
+  file_ptr filepos;
+};
+
+static hashval_t
+hash_member_name (const PTR p)
+{
+  return htab_hash_string (((struct ar_member_index_entry *) p)->name);
+}
+
+static int
+eq_member_name (const PTR p1, const PTR p2)
+{
+  return strcmp (((struct ar_member_index_entry *) p1)->name,
+		 ((struct ar_member_index_entry *) p2)->name) == 0;
+}
+
+/* The index lives exactly as long as the archive, so take its memory
+   from the archive's objalloc and let bfd_close release it.  */
+
+static void *
+member_index_alloc (void *archive, size_t count, size_t size)
+{
+  return bfd_zalloc ((bfd *) archive, count * size);
+}
+
+static void
+member_index_free (void *archive ATTRIBUTE_UNUSED, void *p ATTRIBUTE_UNUSED)
+{
+}
+
+/* Walk ARCHIVE once, recording where each member's header starts.
+   Only archives read with the generic reader have element positions
+   we can compute; for anything else return FALSE and let the caller
+   scan.  */
+
+static bfd_boolean
+build_archive_member_index (bfd *archive)
+{
+  htab_t index;
+  bfd *elt = NULL;
+
+  if (archive->xvec->openr_next_archived_file
+      != bfd_generic_openr_next_archived_file)
+    return FALSE;
+
+  index = htab_create_alloc_ex (64, hash_member_name, eq_member_name, NULL,
+				archive, member_index_alloc,
+				member_index_free);
+  if (index == NULL)
+    return FALSE;
+
+  for (;;)
+    {
+      file_ptr filepos = archive_next_element_filepos (archive, elt);
+      struct ar_member_index_entry *entry;
+      void **slot;
+
+      elt = _bfd_get_elt_at_filepos (archive, filepos);
+      if (elt == NULL)
+	break;
+
+      entry = bfd_alloc (archive, sizeof (struct ar_member_index_entry));
+      if (entry == NULL)
+	return FALSE;
+      entry->name = elt->filename;
+      entry->filepos = filepos;
+
+      /* Keep the first of several members with the same name, which is
+	 the one a scan from the front of the archive would find.  */
+      slot = htab_find_slot (index, entry, INSERT);
+      if (slot == NULL)
+	return FALSE;
+      if (*slot == NULL)
+	*slot = entry;
+    }
+
+  /* Running off the end leaves bfd_error_no_more_archived_files;
+     anything else means we couldn't read the whole archive.  */
+  if (bfd_get_error () != bfd_error_no_more_archived_files)
+    return FALSE;
+
+  bfd_ardata (archive)->member_index = index;
+  return TRUE;
+}
+
+/*
+FUNCTION
+	bfd_openr_archived_file_by_name
+
+SYNOPSIS
+	bfd *bfd_openr_archived_file_by_name (bfd *archive, const char *name);
+
+DESCRIPTION
+	Open an input BFD on the element of @var{archive} called
+	@var{name}, or return NULL if there is none.  The first call
+	reads every member header once and remembers where each name
+	lives, so later calls on the same archive don't have to scan
+	it.  If several members share @var{name}, the first is returned,
+	as a scan with <<bfd_openr_next_archived_file>> would find.
+*/
+
+bfd *
+bfd_openr_archived_file_by_name (bfd *archive, const char *name)
+{
+  struct ar_member_index_entry key, *entry;
+  bfd *elt;
+
+  if ((bfd_get_format (archive) != bfd_archive) ||
+      (archive->direction == write_direction))
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return NULL;
+    }
+
+  if (bfd_ardata (archive)->member_index != NULL
+      || build_archive_member_index (archive))
+    {
+      key.name = name;
+      entry = htab_find (bfd_ardata (archive)->member_index, &key);
+      if (entry == NULL)
+	{
+	  bfd_set_error (bfd_error_no_more_archived_files);
+	  return NULL;
+	}
+      return _bfd_get_elt_at_filepos (archive, entry->filepos);
+    }
+
+  for (elt = bfd_openr_next_archived_file (archive, NULL);
+       elt != NULL;
+       elt = bfd_openr_next_archived_file (archive, elt))
+    if (strcmp (elt->filename, name) == 0)
+      break;
+  return elt;
 }
 
+/* APPLE LOCAL end archive member index  */
+
 const bfd_target *
 bfd_generic_archive_p (bfd *abfd)
 {
@@ -1712,6 +1712,20 @@ bfd_boolean bfd_generic_discard_group (bfd *abfd, asection *group);
 /* Extracted from cache.c.  */
 void bfd_set_cache_max_open(unsigned int nmax);
 
+struct bfd_cache_statistics
+{
+  unsigned int open_files;
+  unsigned int max_open;
+  /* Lookups that found the file already open.  */
+  unsigned long hits;
+  /* Lookups that had to reopen it.  */
+  unsigned long misses;
+  /* Files closed to make room for another.  */
+  unsigned long evictions;
+};
+
+void bfd_cache_get_statistics (struct bfd_cache_statistics *stats);
+
 bfd_boolean bfd_cache_close_all (void);
 
 /* Extracted from archures.c.  */
@@ -4571,6 +4585,8 @@ bfd_boolean bfd_set_archive_head (bfd *output, bfd *new_head);
 
 bfd *bfd_openr_next_archived_file (bfd *archive, bfd *previous);
 
+bfd *bfd_openr_archived_file_by_name (bfd *archive, const char *name);
+
 /* Extracted from corefile.c.  */
 const char *bfd_core_file_failing_command (bfd *abfd);
 
@@ -36,12 +36,33 @@ SECTION
 	close, closes it and opens the one wanted, returning its file
 	handle.
 
+	Files opened only for reading are read with <<pread>> where
+	it is available.  Their position is kept in the BFD rather
+	than in the stream, so seeking never needs the file to be
+	open, and a file that was closed to make room is only
+	reopened when it is actually read.
+
 */
 
 #include "bfd.h"
 #include "sysdep.h"
 #include "libbfd.h"
 #include "libiberty.h"
+/* APPLE LOCAL begin bfd cache  */
+#ifdef HAVE_GETRLIMIT
+#include <sys/resource.h>
+#endif
+
+#ifdef HAVE_PREAD
+#define CACHE_USES_PREAD(abfd) ((abfd)->direction == read_direction)
+#else
+#define CACHE_USES_PREAD(abfd) 0
+#endif
+
+static unsigned long cache_hits;
+static unsigned long cache_misses;
+static unsigned long cache_evictions;
+/* APPLE LOCAL end bfd cache  */
 
 static bfd_boolean bfd_cache_delete (bfd *);
 
@@ -49,12 +70,33 @@ static bfd_boolean bfd_cache_delete (bfd *);
 static file_ptr
 cache_btell (struct bfd *abfd)
 {
+  /* APPLE LOCAL begin bfd cache  */
+  while (abfd->my_archive != NULL)
+    abfd = abfd->my_archive;
+  if (CACHE_USES_PREAD (abfd))
+    return abfd->where;
+  /* APPLE LOCAL end bfd cache  */
   return real_ftell (bfd_cache_lookup (abfd));
 }
 
 static int
 cache_bseek (struct bfd *abfd, file_ptr offset, int whence)
 {
+  /* APPLE LOCAL begin bfd cache  */
+  /* bfd_seek keeps abfd->where up to date, and that is all cache_bread
+     looks at.  */
+  if (CACHE_USES_PREAD (abfd))
+    {
+      file_ptr pos = whence == SEEK_SET ? offset : abfd->where + offset;
+
+      if (pos < 0)
+	{
+	  errno = EINVAL;
+	  return -1;
+	}
+      return 0;
+    }
+  /* APPLE LOCAL end bfd cache  */
   return real_fseek (bfd_cache_lookup (abfd), offset, whence);
 }
 
@@ -81,6 +123,34 @@ cache_bread (struct bfd *abfd, void *buf, file_ptr nbytes)
   if (nbytes == 0)
     return 0;
 
+  /* APPLE LOCAL begin bfd cache  */
+#ifdef HAVE_PREAD
+  if (CACHE_USES_PREAD (abfd))
+    {
+      int fd = fileno (bfd_cache_lookup (abfd));
+      char *p = buf;
+
+      nread = 0;
+      while (nread < nbytes)
+	{
+	  ssize_t got = pread (fd, p + nread, nbytes - nread,
+			       abfd->where + nread);
+	  if (got < 0 && errno == EINTR)
+	    continue;
+	  if (got < 0)
+	    {
+	      bfd_set_error (bfd_error_system_call);
+	      return -1;
+	    }
+	  if (got == 0)
+	    break;
+	  nread += got;
+	}
+      return nread;
+    }
+#endif
+  /* APPLE LOCAL end bfd cache  */
+
 #if defined (__VAX) && defined (VMS)
   /* Apparently fread on Vax VMS does not keep the record length
      information.  */
@@ -154,7 +224,7 @@ INTERNAL_FUNCTION
 
 DESCRIPTION
 	The maximum number of files which the cache will keep open at
-	one time.
+	one time, if the limit on open files can't be found out.
 
 .#define BFD_CACHE_MAX_OPEN 10
 
@@ -163,7 +233,45 @@ DESCRIPTION
 /* The number of BFD files we have open.  */
 
 static unsigned int open_files;
-static unsigned int bfd_cache_max_open = BFD_CACHE_MAX_OPEN;
+/* APPLE LOCAL begin bfd cache  */
+/* Zero until it has been set or worked out from the process's limit
+   on open files; use max_open_files to read it.  */
+static unsigned int bfd_cache_max_open = 0;
+
+/* Never keep more files open than this, whatever the limit is.  */
+#define BFD_CACHE_MAX_OPEN_CEILING 65536
+
+/* How many files the cache may keep open.  Unless told otherwise, use
+   all the descriptors RLIMIT_NOFILE allows, less a tenth (and at least
+   five) for everyone else.  */
+
+static unsigned int
+max_open_files (void)
+{
+  if (bfd_cache_max_open == 0)
+    {
+      bfd_cache_max_open = BFD_CACHE_MAX_OPEN;
+#ifdef HAVE_GETRLIMIT
+      {
+	struct rlimit limit;
+
+	if (getrlimit (RLIMIT_NOFILE, &limit) == 0)
+	  {
+	    rlim_t max = limit.rlim_cur;
+	    rlim_t reserve;
+
+	    if (max == RLIM_INFINITY || max > BFD_CACHE_MAX_OPEN_CEILING)
+	      max = BFD_CACHE_MAX_OPEN_CEILING;
+	    reserve = max / 10 > 5 ? max / 10 : 5;
+	    if (max > reserve + BFD_CACHE_MAX_OPEN)
+	      bfd_cache_max_open = max - reserve;
+	  }
+      }
+#endif
+    }
+  return bfd_cache_max_open;
+}
+/* APPLE LOCAL end bfd cache  */
 
 /*
 FUNCTION
@@ -174,7 +282,8 @@ SYNOPSIS
 
 DESCRIPTION
 	Set the maximum number of files which the cache will keep
-	open at one time.
+	open at one time.  Zero means work it out from the process's
+	limit on open files, which is the default.
 
 */
 
@@ -185,6 +294,44 @@ bfd_set_cache_max_open (nmax)
   bfd_cache_max_open = nmax;
 }
 
+/* APPLE LOCAL begin bfd cache  */
+/*
+FUNCTION
+	bfd_cache_get_statistics
+
+SYNOPSIS
+	void bfd_cache_get_statistics (struct bfd_cache_statistics *stats);
+
+DESCRIPTION
+	Fill in @var{stats} with how the file cache has been doing.
+	Lookups of the most recently used BFD take a shortcut and
+	aren't counted as hits.
+
+.struct bfd_cache_statistics
+.{
+.  unsigned int open_files;
+.  unsigned int max_open;
+.  {* Lookups that found the file already open.  *}
+.  unsigned long hits;
+.  {* Lookups that had to reopen it.  *}
+.  unsigned long misses;
+.  {* Files closed to make room for another.  *}
+.  unsigned long evictions;
+.};
+.
+*/
+
+void
+bfd_cache_get_statistics (struct bfd_cache_statistics *stats)
+{
+  stats->open_files = open_files;
+  stats->max_open = max_open_files ();
+  stats->hits = cache_hits;
+  stats->misses = cache_misses;
+  stats->evictions = cache_evictions;
+}
+/* APPLE LOCAL end bfd cache  */
+
 /*
 INTERNAL_FUNCTION
 	bfd_last_cache
@@ -275,7 +422,11 @@ close_one (void)
       BFD_ASSERT ((kill->flags & BFD_IN_MEMORY) == 0);
       if (kill->cacheable)
 	{
-	  kill->where = real_ftell ((FILE *) kill->iostream);
+	  /* APPLE LOCAL begin bfd cache  */
+	  if (!CACHE_USES_PREAD (kill))
+	    kill->where = real_ftell ((FILE *) kill->iostream);
+	  cache_evictions++;
+	  /* APPLE LOCAL end bfd cache  */
 	  return bfd_cache_delete (kill);
 	}
     }
@@ -309,6 +460,36 @@ bfd_cache_delete (bfd *abfd)
   return ret;
 }
 
+/* APPLE LOCAL begin bfd cache  */
+/*
+INTERNAL_FUNCTION
+	bfd_cache_give_back_descriptor
+
+SYNOPSIS
+	bfd_boolean bfd_cache_give_back_descriptor (void);
+
+DESCRIPTION
+	Called when opening a file failed with <<EMFILE>> or
+	<<ENFILE>>, because the rest of the program is using the
+	descriptors the cache was counting on.  Close the least
+	recently used file, and lower the limit so that the cache
+	doesn't count on that descriptor again.  Returns <<FALSE>> if
+	there was nothing to close.
+*/
+
+bfd_boolean
+bfd_cache_give_back_descriptor (void)
+{
+  unsigned int before = open_files;
+
+  if (! close_one () || open_files == before)
+    return FALSE;
+
+  bfd_cache_max_open = open_files > 2 ? open_files : 2;
+  return TRUE;
+}
+/* APPLE LOCAL end bfd cache  */
+
 /*
 INTERNAL_FUNCTION
 	bfd_cache_init
@@ -326,7 +507,8 @@ bfd_cache_init (bfd *abfd)
   BFD_ASSERT (abfd->iostream != NULL);
   BFD_ASSERT ((abfd->flags & BFD_IN_MEMORY) == 0);
   
-  while (open_files >= bfd_cache_max_open)
+  /* APPLE LOCAL bfd cache  */
+  while (open_files >= max_open_files ())
     {
       if (! close_one ())
 	return FALSE;
@@ -413,7 +595,8 @@ bfd_open_file (bfd *abfd)
 {
   abfd->cacheable = TRUE;	/* Allow it to be closed later.  */
 
-  while ((open_files + 1) >= bfd_cache_max_open)
+  /* APPLE LOCAL bfd cache  */
+  while ((open_files + 1) >= max_open_files ())
     {
       if (! close_one ())
 	return NULL;
@@ -424,6 +607,11 @@ bfd_open_file (bfd *abfd)
     case read_direction:
     case no_direction:
       abfd->iostream = (PTR) fopen (abfd->filename, FOPEN_RB);
+      /* APPLE LOCAL begin bfd cache  */
+      while (abfd->iostream == NULL && (errno == EMFILE || errno == ENFILE)
+	     && bfd_cache_give_back_descriptor ())
+	abfd->iostream = (PTR) fopen (abfd->filename, FOPEN_RB);
+      /* APPLE LOCAL end bfd cache  */
       break;
     case both_direction:
     case write_direction:
@@ -508,9 +696,13 @@ bfd_cache_lookup_worker (bfd *abfd)
 	  snip (abfd);
 	  insert (abfd);
 	}
+      /* APPLE LOCAL bfd cache  */
+      cache_hits++;
     }
   else
     {
+      /* APPLE LOCAL bfd cache  */
+      cache_misses++;
       if (bfd_open_file (abfd) == NULL
 	  || abfd->where != (unsigned long) abfd->where
 	  || real_fseek ((FILE *) abfd->iostream, abfd->where, SEEK_SET) != 0)
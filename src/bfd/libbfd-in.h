@@ -65,6 +65,9 @@ struct artdata {
   file_ptr first_file_filepos;
   /* Speed up searching the armap */
   htab_t cache;
+  /* APPLE LOCAL: Member name to file position, built the first time
+     bfd_openr_archived_file_by_name is called.  */
+  htab_t member_index;
   bfd *archive_head;		/* Only interesting in output routines */
   carsym *symdefs;		/* the symdef entries */
   symindex symdef_count;	/* how many there are */
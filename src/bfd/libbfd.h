@@ -70,6 +70,9 @@ struct artdata {
   file_ptr first_file_filepos;
   /* Speed up searching the armap */
   htab_t cache;
+  /* APPLE LOCAL: Member name to file position, built the first time
+     bfd_openr_archived_file_by_name is called.  */
+  htab_t member_index;
   bfd *archive_head;		/* Only interesting in output routines */
   carsym *symdefs;		/* the symdef entries */
   symindex symdef_count;	/* how many there are */
@@ -790,6 +793,8 @@ extern bfd *bfd_last_cache;
     for (abfd = (bfd_last_cache != NULL) ? bfd_last_cache->lru_prev : NULL; \
          abfd != NULL; \
          abfd = (abfd == bfd_last_cache) ? NULL : abfd->lru_prev)
+bfd_boolean bfd_cache_give_back_descriptor (void);
+
 bfd_boolean bfd_cache_init (bfd *abfd);
 
 bfd_boolean bfd_cache_close (bfd *abfd);
@@ -39,7 +39,8 @@
 #define bfd_mach_o_get_elt_at_index                   _bfd_noarchive_get_elt_at_index
 #define bfd_mach_o_generic_stat_arch_elt              _bfd_noarchive_generic_stat_arch_elt
 #define bfd_mach_o_update_armap_timestamp             _bfd_noarchive_update_armap_timestamp
-#define bfd_mach_o_close_and_cleanup                  _bfd_generic_close_and_cleanup
+/* APPLE LOCAL mapped symtab  */
+static bfd_boolean bfd_mach_o_close_and_cleanup (bfd *);
 #define bfd_mach_o_new_section_hook                   _bfd_generic_new_section_hook
 #define bfd_mach_o_get_section_contents_in_window     _bfd_generic_get_section_contents_in_window
 #define bfd_mach_o_get_section_contents_in_window_with_mode _bfd_generic_get_section_contents_in_window_with_mode
@@ -270,7 +271,9 @@ bfd_mach_o_canonicalize_symtab (bfd *abfd, asymbol **alocation)
 	{
 	  bfd_mach_o_symtab_command *sym = &mdata->commands[i].command.symtab;
 
-	  if (bfd_mach_o_scan_read_symtab_symbols (abfd, &mdata->commands[i].command.symtab) != 0)
+	  /* APPLE LOCAL mapped symtab  */
+	  if (sym->symbols == NULL
+	      && bfd_mach_o_scan_read_symtab_symbols (abfd, &mdata->commands[i].command.symtab) != 0)
 	    {
 	      fprintf (stderr, "bfd_mach_o_canonicalize_symtab: unable to load symbols for section %lu\n", i);
 	      return 0;
@@ -1214,17 +1217,71 @@ bfd_mach_o_scan_read_section (bfd *abfd,
     return bfd_mach_o_scan_read_section_32 (abfd, section, offset);
 }
 
-int
-bfd_mach_o_scan_read_symtab_symbol (bfd *abfd,
-				    bfd_mach_o_symtab_command *sym,
-				    asymbol *s,
-				    unsigned long i)
+/* APPLE LOCAL begin mapped symtab  */
+/* Map SIZE bytes of ABFD at OFFSET through WINDOW, and return where
+   they are in memory, or NULL if they couldn't be mapped.  Without
+   USE_MMAP only in-memory bfds are mapped; callers fall back on
+   reading what they need.  */
+
+static unsigned char *
+bfd_mach_o_map_table (bfd *abfd, ufile_ptr offset, bfd_size_type size,
+		      bfd_window *window)
+{
+  if (size == 0)
+    return NULL;
+
+  if ((abfd->flags & BFD_IN_MEMORY) == 0)
+    {
+#ifdef USE_MMAP
+      if (offset + size > (ufile_ptr) bfd_get_size (abfd))
+	return NULL;
+#else
+      return NULL;
+#endif
+    }
+
+  if (! bfd_get_file_window (abfd, offset, size, window, FALSE))
+    {
+      bfd_free_window (window);
+      return NULL;
+    }
+  return (unsigned char *) window->data;
+}
+
+/* Make SYM's nlist array available in memory, if that can be done
+   without copying it.  Returns 0 if SYM->nlists is set.  */
+
+static int
+bfd_mach_o_scan_map_symtab_nlists (bfd *abfd, bfd_mach_o_symtab_command *sym)
+{
+  unsigned int symwidth = (bfd_mach_o_version (abfd) > 1) ? 16 : 12;
+
+  if (sym->nlists != NULL)
+    return 0;
+  if (sym->nlist_map_failed)
+    return -1;
+
+  sym->nlists = bfd_mach_o_map_table (abfd, sym->symoff,
+				      (bfd_size_type) sym->nsyms * symwidth,
+				      &sym->nlist_window);
+  if (sym->nlists == NULL)
+    {
+      sym->nlist_map_failed = 1;
+      return -1;
+    }
+  return 0;
+}
+
+/* Fill in S from the nlist record at BUF, one of SYM's.  */
+
+static int
+bfd_mach_o_decode_symtab_symbol (bfd *abfd,
+				 bfd_mach_o_symtab_command *sym,
+				 asymbol *s,
+				 const unsigned char *buf)
 {
   bfd_mach_o_data_struct *mdata = abfd->tdata.mach_o_data;
   unsigned int wide = (mdata->header.version == 2);
-  unsigned int symwidth = wide ? 16 : 12;
-  bfd_vma symoff = sym->symoff + (i * symwidth);
-  unsigned char buf[16];
   unsigned char type = -1;
   unsigned char section = -1;
   short desc = -1;
@@ -1234,14 +1291,6 @@ bfd_mach_o_scan_read_symtab_symbol (bfd *abfd,
 
   BFD_ASSERT (sym->strtab != NULL);
 
-  bfd_seek (abfd, symoff, SEEK_SET);
-  if (bfd_bread ((PTR) buf, symwidth, abfd) != symwidth)
-    {
-      fprintf (stderr, "bfd_mach_o_scan_read_symtab_symbol: unable to read %d bytes at %lu\n",
-	       symwidth, (unsigned long) symoff);
-      return -1;
-    }
-
   stroff = bfd_h_get_32 (abfd, buf);
   type = bfd_h_get_8 (abfd, buf + 4);
   symtype = (type & 0x0e);
@@ -1332,6 +1381,36 @@ bfd_mach_o_scan_read_symtab_symbol (bfd *abfd,
   return 0;
 }
 
+/* Fill in S from entry I of SYM.  This decodes the entry straight out
+   of the mapped nlists when they can be mapped, so callers can walk
+   the symbol table one entry at a time without canonicalizing it.  */
+
+int
+bfd_mach_o_scan_read_symtab_symbol (bfd *abfd,
+				    bfd_mach_o_symtab_command *sym,
+				    asymbol *s,
+				    unsigned long i)
+{
+  unsigned int symwidth = (bfd_mach_o_version (abfd) > 1) ? 16 : 12;
+  bfd_vma symoff = sym->symoff + (i * symwidth);
+  unsigned char buf[16];
+
+  if (i < sym->nsyms && bfd_mach_o_scan_map_symtab_nlists (abfd, sym) == 0)
+    return bfd_mach_o_decode_symtab_symbol (abfd, sym, s,
+					    sym->nlists + i * symwidth);
+
+  bfd_seek (abfd, symoff, SEEK_SET);
+  if (bfd_bread ((PTR) buf, symwidth, abfd) != symwidth)
+    {
+      fprintf (stderr, "bfd_mach_o_scan_read_symtab_symbol: unable to read %d bytes at %lu\n",
+	       symwidth, (unsigned long) symoff);
+      return -1;
+    }
+
+  return bfd_mach_o_decode_symtab_symbol (abfd, sym, s, buf);
+}
+/* APPLE LOCAL end mapped symtab  */
+
 int
 bfd_mach_o_scan_read_symtab_strtab (bfd *abfd,
 				    bfd_mach_o_symtab_command *sym)
@@ -1353,6 +1432,15 @@ bfd_mach_o_scan_read_symtab_strtab (bfd *abfd,
       return 0;
     }
 
+  /* APPLE LOCAL begin mapped symtab  */
+  /* The names are only ever read, so there's no need to copy them.  */
+  sym->strtab = (char *) bfd_mach_o_map_table (abfd, sym->stroff,
+					       sym->strsize,
+					       &sym->strtab_window);
+  if (sym->strtab != NULL)
+    return 0;
+  /* APPLE LOCAL end mapped symtab  */
+
   sym->strtab = bfd_alloc (abfd, sym->strsize);
   if (sym->strtab == NULL)
     return -1;
@@ -1372,6 +1460,9 @@ int
 bfd_mach_o_scan_read_symtab_symbols (bfd *abfd,
 				     bfd_mach_o_symtab_command *sym)
 {
+  /* APPLE LOCAL mapped symtab  */
+  unsigned int symwidth = (bfd_mach_o_version (abfd) > 1) ? 16 : 12;
+  unsigned char *nlists;
   unsigned long i;
   int ret;
 
@@ -1384,18 +1475,49 @@ bfd_mach_o_scan_read_symtab_symbols (bfd *abfd,
       return -1;
     }
 
-  ret = bfd_mach_o_scan_read_symtab_strtab (abfd, sym);
-  if (ret != 0)
-    return ret;
+  /* APPLE LOCAL begin mapped symtab  */
+  /* machoread may already have handed us the string table.  */
+  if (sym->strtab == NULL)
+    {
+      ret = bfd_mach_o_scan_read_symtab_strtab (abfd, sym);
+      if (ret != 0)
+	return ret;
+    }
+
+  /* Decode the symbols out of the mapped nlists if we can, otherwise
+     read them all in one go rather than seeking to each one.  */
+  if (bfd_mach_o_scan_map_symtab_nlists (abfd, sym) == 0)
+    nlists = sym->nlists;
+  else
+    {
+      bfd_size_type size = (bfd_size_type) sym->nsyms * symwidth;
+
+      nlists = bfd_malloc (size);
+      if (nlists == NULL && size != 0)
+	return -1;
+      bfd_seek (abfd, sym->symoff, SEEK_SET);
+      if (bfd_bread ((PTR) nlists, size, abfd) != size)
+	{
+	  fprintf (stderr, "bfd_mach_o_scan_read_symtab_symbols: unable to read %lu bytes at %lu\n",
+		   (unsigned long) size, sym->symoff);
+	  free (nlists);
+	  return -1;
+	}
+    }
 
+  ret = 0;
   for (i = 0; i < sym->nsyms; i++)
     {
-      ret = bfd_mach_o_scan_read_symtab_symbol (abfd, sym, &sym->symbols[i], i);
+      ret = bfd_mach_o_decode_symtab_symbol (abfd, sym, &sym->symbols[i],
+					     nlists + i * symwidth);
       if (ret != 0)
-	return ret;
+	break;
     }
 
-  return 0;
+  if (nlists != sym->nlists)
+    free (nlists);
+  return ret;
+  /* APPLE LOCAL end mapped symtab  */
 }
 
 int
@@ -1411,14 +1533,31 @@ bfd_mach_o_scan_read_dysymtab_symbol (bfd *abfd,
 
   BFD_ASSERT (i < dysym->nindirectsyms);
 
-  bfd_seek (abfd, isymoff, SEEK_SET);
-  if (bfd_bread ((PTR) buf, 4, abfd) != 4)
+  /* APPLE LOCAL begin mapped symtab  */
+  if (dysym->indirectsyms == NULL && !dysym->indirectsym_map_failed)
     {
-      fprintf (stderr, "bfd_mach_o_scan_read_dysymtab_symbol: unable to read %lu bytes at %lu\n",
-	       (unsigned long) 4, isymoff);
-      return -1;
+      dysym->indirectsyms
+	= bfd_mach_o_map_table (abfd, dysym->indirectsymoff,
+				(bfd_size_type) dysym->nindirectsyms * 4,
+				&dysym->indirectsym_window);
+      if (dysym->indirectsyms == NULL)
+	dysym->indirectsym_map_failed = 1;
+    }
+
+  if (dysym->indirectsyms != NULL)
+    symindex = bfd_h_get_32 (abfd, dysym->indirectsyms + i * 4);
+  else
+    {
+      bfd_seek (abfd, isymoff, SEEK_SET);
+      if (bfd_bread ((PTR) buf, 4, abfd) != 4)
+	{
+	  fprintf (stderr, "bfd_mach_o_scan_read_dysymtab_symbol: unable to read %lu bytes at %lu\n",
+		   (unsigned long) 4, isymoff);
+	  return -1;
+	}
+      symindex = bfd_h_get_32 (abfd, buf);
     }
-  symindex = bfd_h_get_32 (abfd, buf);
+  /* APPLE LOCAL end mapped symtab  */
   /* Strip off the INDIRECT_SYMBOL_LOCAL and INDIRECT_SYMBOL_ABS flags, if
      they were present.  */
   symindex = symindex & 
@@ -1840,6 +1979,11 @@ bfd_mach_o_scan_read_dysymtab (bfd *abfd, bfd_mach_o_load_command *command)
   seg->nextrel = bfd_h_get_32 (abfd, buf + 60);
   seg->locreloff = bfd_h_get_32 (abfd, buf + 64);
   seg->nlocrel = bfd_h_get_32 (abfd, buf + 68);
+  /* APPLE LOCAL begin mapped symtab  */
+  bfd_init_window (&seg->indirectsym_window);
+  seg->indirectsyms = NULL;
+  seg->indirectsym_map_failed = 0;
+  /* APPLE LOCAL end mapped symtab  */
 
   /* Create a fake section to indicate the start & length of the 
      "local" stabs -- the nlist records that are not externally
@@ -1981,6 +2125,12 @@ bfd_mach_o_scan_read_symtab (bfd *abfd, bfd_mach_o_load_command *command)
   seg->strsize = bfd_h_get_32 (abfd, buf + 12);
   seg->symbols = NULL;
   seg->strtab = NULL;
+  /* APPLE LOCAL begin mapped symtab  */
+  bfd_init_window (&seg->nlist_window);
+  bfd_init_window (&seg->strtab_window);
+  seg->nlists = NULL;
+  seg->nlist_map_failed = 0;
+  /* APPLE LOCAL end mapped symtab  */
 
   sname = (char *) bfd_alloc (abfd, strlen (prefix) + 1);
   if (sname == NULL)
@@ -3138,6 +3288,46 @@ mach_o_bfd_fat_free_cached_info (bfd *input)
 
 }
 
+/* APPLE LOCAL begin mapped symtab  */
+/* Let go of the windows the symbol tables were mapped through.  */
+
+static bfd_boolean
+bfd_mach_o_close_and_cleanup (bfd *abfd)
+{
+  if (bfd_get_format (abfd) == bfd_object
+      && (abfd->xvec == &mach_o_be_vec || abfd->xvec == &mach_o_le_vec)
+      && abfd->tdata.mach_o_data != NULL
+      && abfd->tdata.mach_o_data->commands != NULL)
+    {
+      bfd_mach_o_data_struct *mdata = abfd->tdata.mach_o_data;
+      unsigned long i;
+
+      for (i = 0; i < mdata->header.ncmds; i++)
+	{
+	  bfd_mach_o_load_command *cmd = &mdata->commands[i];
+
+	  if (cmd->type == BFD_MACH_O_LC_SYMTAB)
+	    {
+	      bfd_mach_o_symtab_command *sym = &cmd->command.symtab;
+
+	      if (sym->strtab == (char *) sym->strtab_window.data)
+		sym->strtab = NULL;
+	      bfd_free_window (&sym->strtab_window);
+	      bfd_free_window (&sym->nlist_window);
+	      sym->nlists = NULL;
+	    }
+	  else if (cmd->type == BFD_MACH_O_LC_DYSYMTAB)
+	    {
+	      bfd_free_window (&cmd->command.dysymtab.indirectsym_window);
+	      cmd->command.dysymtab.indirectsyms = NULL;
+	    }
+	}
+    }
+
+  return _bfd_generic_close_and_cleanup (abfd);
+}
+/* APPLE LOCAL end mapped symtab  */
+
 #define bfd_mach_o_bfd_free_cached_info mach_o_bfd_thin_free_cached_info 
 
 #define TARGET_NAME 		mach_o_be_vec
@@ -329,6 +329,15 @@ typedef struct bfd_mach_o_symtab_command
   char *strtab;
   asection *stabs_segment;
   asection *stabstr_segment;
+  /* APPLE LOCAL begin mapped symtab  */
+  /* The windows the nlist array and string table are mapped through,
+     if they were mapped rather than read.  NLISTS points at the mapped
+     nlist array, or is NULL if each nlist is read as it's needed.  */
+  bfd_window nlist_window;
+  bfd_window strtab_window;
+  unsigned char *nlists;
+  int nlist_map_failed;
+  /* APPLE LOCAL end mapped symtab  */
 }
 bfd_mach_o_symtab_command;
 
@@ -436,6 +445,13 @@ typedef struct bfd_mach_o_dysymtab_command
   unsigned long indirectsymoff; /* File offset to the indirect symbol table.  */
   unsigned long nindirectsyms;  /* Number of indirect symbol table entries.  */
 
+  /* APPLE LOCAL begin mapped symtab  */
+  /* The mapped indirect symbol table, as for the nlists above.  */
+  bfd_window indirectsym_window;
+  unsigned char *indirectsyms;
+  int indirectsym_map_failed;
+  /* APPLE LOCAL end mapped symtab  */
+
   /* To support relocating an individual module in a library file quickly the
      external relocation entries for each module in the library need to be
      accessed efficiently.  Since the relocation entries can't be accessed
@@ -198,7 +198,14 @@ bfd_fopen (const char *filename, const char *target, const char *mode, int fd)
     nbfd->iostream = fdopen (fd, mode);
   else
 #endif
-    nbfd->iostream = fopen (filename, mode);
+    {
+      nbfd->iostream = fopen (filename, mode);
+      /* APPLE LOCAL begin bfd cache  */
+      while (nbfd->iostream == NULL && (errno == EMFILE || errno == ENFILE)
+	     && bfd_cache_give_back_descriptor ())
+	nbfd->iostream = fopen (filename, mode);
+      /* APPLE LOCAL end bfd cache  */
+    }
   if (nbfd->iostream == NULL)
     {
       bfd_set_error (bfd_error_system_call);
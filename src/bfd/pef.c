@@ -30,7 +30,10 @@
 #define BFD_IO_FUNCS 0
 #endif
 
-#define bfd_pef_close_and_cleanup                   _bfd_generic_close_and_cleanup
+/* APPLE LOCAL begin mapped pef  */
+static bfd_boolean bfd_pef_close_and_cleanup (bfd *);
+extern const bfd_target pef_vec;
+/* APPLE LOCAL end mapped pef  */
 #define bfd_pef_bfd_free_cached_info                _bfd_generic_bfd_free_cached_info
 #define bfd_pef_new_section_hook                    _bfd_generic_new_section_hook
 #define bfd_pef_bfd_is_local_label_name             bfd_generic_is_local_label_name
@@ -445,29 +448,100 @@ bfd_pef_print_loader_header (bfd *abfd ATTRIBUTE_UNUSED,
 	   header->exported_symbol_count);
 }
 
+/* APPLE LOCAL begin mapped pef  */
+/* Read just the 56-byte header at the start of LOADERSEC into
+   HEADER, rather than the whole loader section.  */
+
+static int
+bfd_pef_read_loader_header (bfd *abfd, asection *loadersec,
+			    bfd_pef_loader_header *header)
+{
+  unsigned char buf[56];
+
+  if (loadersec->size < 56)
+    return -1;
+  if (bfd_seek (abfd, loadersec->filepos, SEEK_SET) < 0
+      || bfd_bread ((void *) buf, 56, abfd) != 56)
+    return -1;
+  return bfd_pef_parse_loader_header (abfd, buf, 56, header);
+}
+
+/* Map the contents of SEC through WINDOW, the first time they are
+   asked for, and return them, or NULL if they couldn't be mapped
+   without copying.  *MAP remembers the mapping.  Without USE_MMAP
+   only in-memory bfds are mapped; callers fall back on reading the
+   section.  */
+
+static unsigned char *
+bfd_pef_map_section (bfd *abfd, asection *sec, bfd_window *window,
+		     unsigned char **map)
+{
+  if (*map != NULL)
+    return *map;
+  if (sec->size == 0)
+    return NULL;
+
+  if ((abfd->flags & BFD_IN_MEMORY) == 0)
+    {
+#ifdef USE_MMAP
+      if (sec->filepos + sec->size > (ufile_ptr) bfd_get_size (abfd))
+	return NULL;
+#else
+      return NULL;
+#endif
+    }
+
+  if (! bfd_get_file_window (abfd, sec->filepos, sec->size, window, FALSE))
+    {
+      bfd_free_window (window);
+      return NULL;
+    }
+  *map = (unsigned char *) window->data;
+  return *map;
+}
+
+/* Return the contents of SEC, mapped if possible.  Otherwise they
+   are read into memory from bfd_malloc, and *COPIED is set to tell
+   the caller to free them.  */
+
+static unsigned char *
+bfd_pef_section_contents (bfd *abfd, asection *sec, bfd_window *window,
+			  unsigned char **map, int *copied)
+{
+  unsigned char *buf;
+
+  *copied = 0;
+  buf = bfd_pef_map_section (abfd, sec, window, map);
+  if (buf != NULL)
+    return buf;
+
+  buf = bfd_malloc (sec->size);
+  if (buf == NULL)
+    return NULL;
+  if (bfd_seek (abfd, sec->filepos, SEEK_SET) < 0
+      || bfd_bread ((void *) buf, sec->size, abfd) != sec->size)
+    {
+      free (buf);
+      return NULL;
+    }
+  *copied = 1;
+  return buf;
+}
+/* APPLE LOCAL end mapped pef  */
+
 int
 bfd_pef_print_loader_section (bfd *abfd, FILE *file)
 {
   bfd_pef_loader_header header;
   asection *loadersec = NULL;
-  unsigned char *loaderbuf = NULL;
-  size_t loaderlen = 0;
 
   loadersec = bfd_get_section_by_name (abfd, "loader");
   if (loadersec == NULL)
     return -1;
 
-  loaderlen = loadersec->size;
-  loaderbuf = bfd_malloc (loaderlen);
-
-  if (bfd_seek (abfd, loadersec->filepos, SEEK_SET) < 0
-      || bfd_bread ((void *) loaderbuf, loaderlen, abfd) != loaderlen
-      || loaderlen < 56
-      || bfd_pef_parse_loader_header (abfd, loaderbuf, 56, &header) < 0)
-    {
-      free (loaderbuf);
-      return -1;
-    }
+  /* APPLE LOCAL mapped pef  */
+  if (bfd_pef_read_loader_header (abfd, loadersec, &header) < 0)
+    return -1;
 
   bfd_pef_print_loader_header (abfd, &header, file);
   return 0;
@@ -480,48 +554,27 @@ bfd_pef_scan_start_address (bfd *abfd)
   asection *section;
 
   asection *loadersec = NULL;
-  unsigned char *loaderbuf = NULL;
-  size_t loaderlen = 0;
-  int ret;
 
   loadersec = bfd_get_section_by_name (abfd, "loader");
   if (loadersec == NULL)
-    goto end;
-
-  loaderlen = loadersec->size;
-  loaderbuf = bfd_malloc (loaderlen);
-  if (bfd_seek (abfd, loadersec->filepos, SEEK_SET) < 0)
-    goto error;
-  if (bfd_bread ((void *) loaderbuf, loaderlen, abfd) != loaderlen)
-    goto error;
+    return 0;
 
-  if (loaderlen < 56)
-    goto error;
-  ret = bfd_pef_parse_loader_header (abfd, loaderbuf, 56, &header);
-  if (ret < 0)
-    goto error;
+  /* APPLE LOCAL mapped pef  */
+  if (bfd_pef_read_loader_header (abfd, loadersec, &header) < 0)
+    return -1;
 
   if (header.main_section < 0)
-    goto end;
+    return 0;
 
   for (section = abfd->sections; section != NULL; section = section->next)
     if ((section->index + 1) == header.main_section)
       break;
 
   if (section == NULL)
-    goto error;
+    return -1;
 
   abfd->start_address = section->vma + header.main_offset;
-
- end:
-  if (loaderbuf != NULL)
-    free (loaderbuf);
   return 0;
-
- error:
-  if (loaderbuf != NULL)
-    free (loaderbuf);
-  return -1;
 }
 
 int
@@ -546,6 +599,13 @@ bfd_pef_scan (abfd, header, mdata)
   bfd_set_arch_mach (abfd, cputype, cpusubtype);
 
   mdata->header = *header;
+  /* APPLE LOCAL begin mapped pef  */
+  bfd_init_window (&mdata->code_window);
+  bfd_init_window (&mdata->loader_window);
+  mdata->code_map = NULL;
+  mdata->loader_map = NULL;
+  mdata->nsyms = -1;
+  /* APPLE LOCAL end mapped pef  */
 
   abfd->flags = (abfd->xvec->object_flags
 		 | (abfd->flags & (BFD_IN_MEMORY | BFD_IO_FUNCS)));
@@ -906,23 +966,29 @@ static long
 bfd_pef_parse_symbols (bfd *abfd, asymbol **csym)
 {
   unsigned long count = 0;
+  /* APPLE LOCAL mapped pef  */
+  bfd_pef_data_struct *mdata = abfd->tdata.pef_data;
 
   asection *codesec = NULL;
   unsigned char *codebuf = NULL;
   size_t codelen = 0;
+  /* APPLE LOCAL mapped pef  */
+  int code_copied = 0;
 
   asection *loadersec = NULL;
   unsigned char *loaderbuf = NULL;
   size_t loaderlen = 0;
+  /* APPLE LOCAL mapped pef  */
+  int loader_copied = 0;
 
+  /* APPLE LOCAL begin mapped pef  */
   codesec = bfd_get_section_by_name (abfd, "code");
   if (codesec != NULL)
     {
       codelen = codesec->size;
-      codebuf = bfd_malloc (codelen);
-      if (bfd_seek (abfd, codesec->filepos, SEEK_SET) < 0)
-	goto end;
-      if (bfd_bread ((void *) codebuf, codelen, abfd) != codelen)
+      codebuf = bfd_pef_section_contents (abfd, codesec, &mdata->code_window,
+					  &mdata->code_map, &code_copied);
+      if (codebuf == NULL)
 	goto end;
     }
 
@@ -930,12 +996,14 @@ bfd_pef_parse_symbols (bfd *abfd, asymbol **csym)
   if (loadersec != NULL)
     {
       loaderlen = loadersec->size;
-      loaderbuf = bfd_malloc (loaderlen);
-      if (bfd_seek (abfd, loadersec->filepos, SEEK_SET) < 0)
-	goto end;
-      if (bfd_bread ((void *) loaderbuf, loaderlen, abfd) != loaderlen)
+      loaderbuf = bfd_pef_section_contents (abfd, loadersec,
+					    &mdata->loader_window,
+					    &mdata->loader_map,
+					    &loader_copied);
+      if (loaderbuf == NULL)
 	goto end;
     }
+  /* APPLE LOCAL end mapped pef  */
 
   count = 0;
   if (codesec != NULL)
@@ -959,11 +1027,13 @@ bfd_pef_parse_symbols (bfd *abfd, asymbol **csym)
     csym[count] = NULL;
 
  end:
-  if (codebuf != NULL)
+  /* APPLE LOCAL begin mapped pef  */
+  if (code_copied)
     free (codebuf);
 
-  if (loaderbuf != NULL)
+  if (loader_copied)
     free (loaderbuf);
+  /* APPLE LOCAL end mapped pef  */
 
   return count;
 }
@@ -971,7 +1041,15 @@ bfd_pef_parse_symbols (bfd *abfd, asymbol **csym)
 static long
 bfd_pef_count_symbols (bfd *abfd)
 {
-  return bfd_pef_parse_symbols (abfd, NULL);
+  /* APPLE LOCAL begin mapped pef  */
+  bfd_pef_data_struct *mdata = abfd->tdata.pef_data;
+
+  /* get_symtab_upper_bound and canonicalize_symtab both want the
+     count; only walk the tables for it once.  */
+  if (mdata->nsyms < 0)
+    mdata->nsyms = bfd_pef_parse_symbols (abfd, NULL);
+  return mdata->nsyms;
+  /* APPLE LOCAL end mapped pef  */
 }
 
 static long
@@ -1011,6 +1089,26 @@ bfd_pef_canonicalize_symtab (bfd *abfd, asymbol **alocation)
   return ret;
 }
 
+/* APPLE LOCAL begin mapped pef  */
+static bfd_boolean
+bfd_pef_close_and_cleanup (bfd *abfd)
+{
+  if (bfd_get_format (abfd) == bfd_object
+      && abfd->xvec == &pef_vec
+      && abfd->tdata.pef_data != NULL)
+    {
+      bfd_pef_data_struct *mdata = abfd->tdata.pef_data;
+
+      bfd_free_window (&mdata->code_window);
+      bfd_free_window (&mdata->loader_window);
+      mdata->code_map = NULL;
+      mdata->loader_map = NULL;
+    }
+
+  return _bfd_generic_close_and_cleanup (abfd);
+}
+/* APPLE LOCAL end mapped pef  */
+
 static asymbol *
 bfd_pef_make_empty_symbol (bfd *abfd)
 {
@@ -135,6 +135,17 @@ struct bfd_pef_data_struct
   bfd_pef_header header;
   bfd_pef_section *sections;
   bfd *ibfd;
+  /* APPLE LOCAL begin mapped pef  */
+  /* The code and loader sections, if they could be mapped without
+     copying them.  Kept until the bfd is closed, since both symbol
+     table calls walk them.  */
+  bfd_window code_window;
+  unsigned char *code_map;
+  bfd_window loader_window;
+  unsigned char *loader_map;
+  /* The number of symbols, once they have been counted, or -1.  */
+  long nsyms;
+  /* APPLE LOCAL end mapped pef  */
 };
 typedef struct bfd_pef_data_struct bfd_pef_data_struct;
 
@@ -23,7 +23,8 @@
 #include "sysdep.h"
 #include "libbfd.h"
 
-#define bfd_sym_close_and_cleanup                   _bfd_generic_close_and_cleanup
+/* APPLE LOCAL mapped xsym  */
+static bfd_boolean bfd_sym_close_and_cleanup (bfd *);
 #define bfd_sym_bfd_free_cached_info                _bfd_generic_bfd_free_cached_info
 #define bfd_sym_new_section_hook                    _bfd_generic_new_section_hook
 #define bfd_sym_bfd_is_local_label_name             bfd_generic_is_local_label_name
@@ -117,6 +118,65 @@ bfd_sym_valid (bfd *abfd)
   return abfd->xvec == &sym_vec;
 }
 
+/* APPLE LOCAL begin mapped xsym  */
+/* Map all of ABFD into SDATA->map, the first time it is asked for.
+   Without USE_MMAP only in-memory bfds are mapped; callers fall back
+   on reading what they need.  Returns 0 if SDATA->map is set.  */
+
+static int
+bfd_sym_map_file (bfd *abfd, bfd_sym_data_struct *sdata)
+{
+  bfd_size_type size;
+
+  if (sdata->map != NULL)
+    return 0;
+  if (sdata->map_failed)
+    return -1;
+  sdata->map_failed = 1;
+
+  size = bfd_get_size (abfd);
+  if (size == 0)
+    return -1;
+#ifndef USE_MMAP
+  if ((abfd->flags & BFD_IN_MEMORY) == 0)
+    return -1;
+#endif
+
+  if (! bfd_get_file_window (abfd, 0, size, &sdata->map_window, FALSE))
+    {
+      bfd_free_window (&sdata->map_window);
+      return -1;
+    }
+  sdata->map = (unsigned char *) sdata->map_window.data;
+  sdata->map_size = size;
+  sdata->map_failed = 0;
+  return 0;
+}
+
+/* Return SIZE bytes of ABFD at OFFSET.  They are in the file's
+   mapping if it has one; otherwise they are read into BUF, which
+   must have room for them.  Returns NULL if they can't be had.  */
+
+unsigned char *
+bfd_sym_read_data (bfd *abfd, unsigned long offset, unsigned long size,
+		   unsigned char *buf)
+{
+  bfd_sym_data_struct *sdata = abfd->tdata.sym_data;
+
+  if (sdata != NULL
+      && bfd_sym_map_file (abfd, sdata) == 0
+      && offset <= sdata->map_size
+      && size <= sdata->map_size - offset)
+    return sdata->map + offset;
+
+  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
+    return NULL;
+  if (bfd_bread (buf, size, abfd) != size)
+    return NULL;
+  return buf;
+}
+/* APPLE LOCAL end mapped xsym  */
+
 unsigned char *
 bfd_sym_read_name_table (bfd *abfd, bfd_sym_header_block *dshb)
 {
@@ -124,6 +184,15 @@ bfd_sym_read_name_table (bfd *abfd, bfd_sym_header_block *dshb)
   long ret;
   size_t table_size = dshb->dshb_nte.dti_page_count * dshb->dshb_page_size;
   size_t table_offset = dshb->dshb_nte.dti_first_page * dshb->dshb_page_size;
+  /* APPLE LOCAL begin mapped xsym  */
+  bfd_sym_data_struct *sdata = abfd->tdata.sym_data;
+
+  if (sdata != NULL
+      && bfd_sym_map_file (abfd, sdata) == 0
+      && table_offset <= sdata->map_size
+      && table_size <= sdata->map_size - table_offset)
+    return sdata->map + table_offset;
+  /* APPLE LOCAL end mapped xsym  */
 
   rstr = bfd_alloc (abfd, table_size);
   if (rstr == NULL)
@@ -733,6 +802,8 @@ bfd_sym_fetch_resources_table_entry (bfd *abfd,
   unsigned long offset;
   unsigned long entry_size;
   unsigned char buf[18];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
   bfd_sym_data_struct *sdata = NULL;
 
   parser = NULL;
@@ -770,12 +841,13 @@ bfd_sym_fetch_resources_table_entry (bfd *abfd,
 			   sdata->header.dshb_page_size,
 			   entry_size, index);
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-  if (bfd_bread (buf, entry_size, abfd) != entry_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, offset, entry_size, buf);
+  if (data == NULL)
     return -1;
 
-  (*parser) (buf, entry_size, entry);
+  (*parser) (data, entry_size, entry);
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -789,6 +861,8 @@ bfd_sym_fetch_modules_table_entry (bfd *abfd,
   unsigned long offset;
   unsigned long entry_size;
   unsigned char buf[46];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
   bfd_sym_data_struct *sdata = NULL;
 
   parser = NULL;
@@ -826,12 +900,13 @@ bfd_sym_fetch_modules_table_entry (bfd *abfd,
 			   sdata->header.dshb_page_size,
 			   entry_size, index);
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-  if (bfd_bread (buf, entry_size, abfd) != entry_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, offset, entry_size, buf);
+  if (data == NULL)
     return -1;
 
-  (*parser) (buf, entry_size, entry);
+  (*parser) (data, entry_size, entry);
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -845,6 +920,8 @@ bfd_sym_fetch_file_references_table_entry (bfd *abfd,
   unsigned long offset;
   unsigned long entry_size = 0;
   unsigned char buf[8];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
   bfd_sym_data_struct *sdata = NULL;
 
   parser = NULL;
@@ -881,12 +958,13 @@ bfd_sym_fetch_file_references_table_entry (bfd *abfd,
 			   sdata->header.dshb_page_size,
 			   entry_size, index);
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-  if (bfd_bread (buf, entry_size, abfd) != entry_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, offset, entry_size, buf);
+  if (data == NULL)
     return -1;
 
-  (*parser) (buf, entry_size, entry);
+  (*parser) (data, entry_size, entry);
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -900,6 +978,8 @@ bfd_sym_fetch_contained_modules_table_entry (bfd *abfd,
   unsigned long offset;
   unsigned long entry_size = 0;
   unsigned char buf[6];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
   bfd_sym_data_struct *sdata = NULL;
 
   parser = NULL;
@@ -936,12 +1016,13 @@ bfd_sym_fetch_contained_modules_table_entry (bfd *abfd,
 			   sdata->header.dshb_page_size,
 			   entry_size, index);
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-  if (bfd_bread (buf, entry_size, abfd) != entry_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, offset, entry_size, buf);
+  if (data == NULL)
     return -1;
 
-  (*parser) (buf, entry_size, entry);
+  (*parser) (data, entry_size, entry);
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -955,6 +1036,8 @@ bfd_sym_fetch_contained_variables_table_entry (bfd *abfd,
   unsigned long offset;
   unsigned long entry_size = 0;
   unsigned char buf[26];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
   bfd_sym_data_struct *sdata = NULL;
 
   parser = NULL;
@@ -991,12 +1074,13 @@ bfd_sym_fetch_contained_variables_table_entry (bfd *abfd,
 			   sdata->header.dshb_page_size,
 			   entry_size, index);
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-  if (bfd_bread (buf, entry_size, abfd) != entry_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, offset, entry_size, buf);
+  if (data == NULL)
     return -1;
 
-  (*parser) (buf, entry_size, entry);
+  (*parser) (data, entry_size, entry);
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -1010,6 +1094,8 @@ bfd_sym_fetch_contained_statements_table_entry (bfd *abfd,
   unsigned long offset;
   unsigned long entry_size = 0;
   unsigned char buf[8];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
   bfd_sym_data_struct *sdata = NULL;
 
   parser = NULL;
@@ -1046,12 +1132,13 @@ bfd_sym_fetch_contained_statements_table_entry (bfd *abfd,
 			   sdata->header.dshb_page_size,
 			   entry_size, index);
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-  if (bfd_bread (buf, entry_size, abfd) != entry_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, offset, entry_size, buf);
+  if (data == NULL)
     return -1;
 
-  (*parser) (buf, entry_size, entry);
+  (*parser) (data, entry_size, entry);
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -1065,6 +1152,8 @@ bfd_sym_fetch_contained_labels_table_entry (bfd *abfd,
   unsigned long offset;
   unsigned long entry_size = 0;
   unsigned char buf[12];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
   bfd_sym_data_struct *sdata = NULL;
 
   parser = NULL;
@@ -1097,12 +1186,13 @@ bfd_sym_fetch_contained_labels_table_entry (bfd *abfd,
 			   sdata->header.dshb_page_size,
 			   entry_size, index);
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-  if (bfd_bread (buf, entry_size, abfd) != entry_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, offset, entry_size, buf);
+  if (data == NULL)
     return -1;
 
-  (*parser) (buf, entry_size, entry);
+  (*parser) (data, entry_size, entry);
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -1116,6 +1206,8 @@ bfd_sym_fetch_contained_types_table_entry (bfd *abfd,
   unsigned long offset;
   unsigned long entry_size = 0;
   unsigned char buf[0];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
   bfd_sym_data_struct *sdata = NULL;
 
   parser = NULL;
@@ -1148,12 +1240,13 @@ bfd_sym_fetch_contained_types_table_entry (bfd *abfd,
 			   sdata->header.dshb_page_size,
 			   entry_size, index);
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-  if (bfd_bread (buf, entry_size, abfd) != entry_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, offset, entry_size, buf);
+  if (data == NULL)
     return -1;
 
-  (*parser) (buf, entry_size, entry);
+  (*parser) (data, entry_size, entry);
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -1193,6 +1286,8 @@ bfd_sym_fetch_file_references_index_table_entry (bfd *abfd,
   unsigned long offset;
   unsigned long entry_size = 0;
   unsigned char buf[0];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
   bfd_sym_data_struct *sdata = NULL;
 
   parser = NULL;
@@ -1229,12 +1324,13 @@ bfd_sym_fetch_file_references_index_table_entry (bfd *abfd,
 			   sdata->header.dshb_page_size,
 			   entry_size, index);
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-  if (bfd_bread (buf, entry_size, abfd) != entry_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, offset, entry_size, buf);
+  if (data == NULL)
     return -1;
 
-  (*parser) (buf, entry_size, entry);
+  (*parser) (data, entry_size, entry);
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -1248,6 +1344,8 @@ bfd_sym_fetch_constant_pool_entry (bfd *abfd,
   unsigned long offset;
   unsigned long entry_size = 0;
   unsigned char buf[0];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
   bfd_sym_data_struct *sdata = NULL;
 
   parser = NULL;
@@ -1280,12 +1378,13 @@ bfd_sym_fetch_constant_pool_entry (bfd *abfd,
 			   sdata->header.dshb_page_size,
 			   entry_size, index);
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-  if (bfd_bread (buf, entry_size, abfd) != entry_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, offset, entry_size, buf);
+  if (data == NULL)
     return -1;
 
-  (*parser) (buf, entry_size, entry);
+  (*parser) (data, entry_size, entry);
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -1299,6 +1398,8 @@ bfd_sym_fetch_type_table_entry (bfd *abfd,
   unsigned long offset;
   unsigned long entry_size = 0;
   unsigned char buf[4];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
   bfd_sym_data_struct *sdata = NULL;
 
   parser = NULL;
@@ -1328,12 +1429,13 @@ bfd_sym_fetch_type_table_entry (bfd *abfd,
 			   sdata->header.dshb_page_size,
 			   entry_size, index);
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-  if (bfd_bread (buf, entry_size, abfd) != entry_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, offset, entry_size, buf);
+  if (data == NULL)
     return -1;
 
-  (*parser) (buf, entry_size, entry);
+  (*parser) (data, entry_size, entry);
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -1343,7 +1445,10 @@ bfd_sym_fetch_type_information_table_entry (bfd *abfd,
 					    bfd_sym_type_information_table_entry *entry,
 					    unsigned long offset)
 {
-  unsigned char buf[4];
+  /* APPLE LOCAL begin mapped xsym  */
+  unsigned char buf[10];
+  unsigned char *data;
+  /* APPLE LOCAL end mapped xsym  */
   bfd_sym_data_struct *sdata = NULL;
 
   BFD_ASSERT (bfd_sym_valid (abfd));
@@ -1352,33 +1457,35 @@ bfd_sym_fetch_type_information_table_entry (bfd *abfd,
   if (offset == 0)
     return -1;
 
-  if (bfd_seek (abfd, offset, SEEK_SET) < 0)
-    return -1;
-
-  if (bfd_bread (buf, 4, abfd) != 4)
+  /* APPLE LOCAL begin mapped xsym  */
+  /* The entry is a 4-byte name index and a 2-byte physical size,
+     whose top bit says whether a 4-byte or a 2-byte logical size
+     follows.  */
+  data = bfd_sym_read_data (abfd, offset, 6, buf);
+  if (data == NULL)
     return -1;
-  entry->nte_index = bfd_getb32 (buf);
-
-  if (bfd_bread (buf, 2, abfd) != 2)
-    return -1;
-  entry->physical_size = bfd_getb16 (buf);
+  entry->nte_index = bfd_getb32 (data);
+  entry->physical_size = bfd_getb16 (data + 4);
 
   if (entry->physical_size & 0x8000)
     {
-      if (bfd_bread (buf, 4, abfd) != 4)
+      data = bfd_sym_read_data (abfd, offset + 6, 4, buf + 6);
+      if (data == NULL)
 	return -1;
       entry->physical_size &= 0x7fff;
-      entry->logical_size = bfd_getb32 (buf);
+      entry->logical_size = bfd_getb32 (data);
       entry->offset = offset + 10;
     }
   else
     {
-      if (bfd_bread (buf, 2, abfd) != 2)
+      data = bfd_sym_read_data (abfd, offset + 6, 2, buf + 6);
+      if (data == NULL)
 	return -1;
       entry->physical_size &= 0x7fff;
-      entry->logical_size = bfd_getb16 (buf);
+      entry->logical_size = bfd_getb16 (data);
       entry->offset = offset + 8;
     }
+  /* APPLE LOCAL end mapped xsym  */
 
   return 0;
 }
@@ -1407,6 +1514,25 @@ bfd_sym_fetch_type_table_information (bfd *abfd,
   return 0;
 }
 
+/* APPLE LOCAL begin mapped xsym  */
+/* Return ABFD's name table, reading or mapping it if this is the
+   first time it is wanted, or NULL if it can't be had.  */
+
+static unsigned char *
+bfd_sym_name_table (bfd *abfd)
+{
+  bfd_sym_data_struct *sdata = abfd->tdata.sym_data;
+
+  if (sdata->name_table == NULL && !sdata->name_table_failed)
+    {
+      sdata->name_table = bfd_sym_read_name_table (abfd, &sdata->header);
+      if (sdata->name_table == NULL)
+	sdata->name_table_failed = 1;
+    }
+  return sdata->name_table;
+}
+/* APPLE LOCAL end mapped xsym  */
+
 const unsigned char *
 bfd_sym_symbol_name (bfd *abfd, unsigned long index)
 {
@@ -1423,6 +1549,11 @@ bfd_sym_symbol_name (bfd *abfd, unsigned long index)
       > sdata->header.dshb_nte.dti_page_count)
     return (const unsigned char *) "\09[INVALID]";
 
+  /* APPLE LOCAL begin mapped xsym  */
+  if (bfd_sym_name_table (abfd) == NULL)
+    return (const unsigned char *) "\09[INVALID]";
+  /* APPLE LOCAL end mapped xsym  */
+
   return (const unsigned char *) sdata->name_table + index;
 }
 
@@ -2071,16 +2202,14 @@ bfd_sym_print_type_information_table_entry (bfd *abfd,
       fprintf (f, "[ERROR]\n");
       return;
     }
-  if (bfd_seek (abfd, entry->offset, SEEK_SET) < 0)
-    {
-      fprintf (f, "[ERROR]\n");
-      return;
-    }
-  if (bfd_bread (buf, entry->physical_size, abfd) != entry->physical_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  buf = bfd_sym_read_data (abfd, entry->offset, entry->physical_size, buf);
+  if (buf == NULL)
     {
       fprintf (f, "[ERROR]\n");
       return;
     }
+  /* APPLE LOCAL end mapped xsym  */
 
   fprintf (f, "[");
   for (i = 0; i < entry->physical_size; i++)
@@ -2172,7 +2301,14 @@ bfd_sym_display_name_table (bfd *abfd, FILE *f)
   sdata = abfd->tdata.sym_data;
 
   name_table_len = sdata->header.dshb_nte.dti_page_count * sdata->header.dshb_page_size;
-  name_table = sdata->name_table;
+  /* APPLE LOCAL begin mapped xsym  */
+  name_table = bfd_sym_name_table (abfd);
+  if (name_table == NULL)
+    {
+      fprintf (f, "name table (NTE) could not be read\n");
+      return;
+    }
+  /* APPLE LOCAL end mapped xsym  */
   name_table_end = name_table + name_table_len;
 
   fprintf (f, "name table (NTE) contains %lu bytes:\n\n", name_table_len);
@@ -2495,14 +2631,26 @@ bfd_sym_scan (bfd *abfd, bfd_sym_version version, bfd_sym_data_struct *mdata)
   mdata->name_table = 0;
   mdata->sbfd = abfd;
   mdata->version = version;
+  /* APPLE LOCAL begin mapped xsym  */
+  bfd_init_window (&mdata->map_window);
+  mdata->map = NULL;
+  mdata->map_size = 0;
+  mdata->map_failed = 0;
+  mdata->name_table_failed = 0;
+  /* APPLE LOCAL end mapped xsym  */
 
   bfd_seek (abfd, 0, SEEK_SET);
   if (bfd_sym_read_header (abfd, &mdata->header, mdata->version) != 0)
     return -1;
 
-  mdata->name_table = bfd_sym_read_name_table (abfd, &mdata->header);
-  if (mdata->name_table == NULL)
+  /* APPLE LOCAL begin mapped xsym  */
+  /* The name table is read the first time a name is needed; just
+     make sure it is there.  */
+  if ((bfd_size_type) (mdata->header.dshb_nte.dti_first_page
+		       + mdata->header.dshb_nte.dti_page_count)
+      * mdata->header.dshb_page_size > bfd_get_size (abfd))
     return -1;
+  /* APPLE LOCAL end mapped xsym  */
 
   bfdsec = bfd_make_section_anyway (abfd, name);
   if (bfdsec == NULL)
@@ -2553,6 +2701,30 @@ bfd_sym_object_p (bfd *abfd)
   return NULL;
 }
 
+/* APPLE LOCAL begin mapped xsym  */
+static bfd_boolean
+bfd_sym_close_and_cleanup (bfd *abfd)
+{
+  if (bfd_get_format (abfd) == bfd_object
+      && abfd->xvec == &sym_vec
+      && abfd->tdata.sym_data != NULL)
+    {
+      bfd_sym_data_struct *sdata = abfd->tdata.sym_data;
+
+      if (sdata->map != NULL)
+	{
+	  if (sdata->name_table >= sdata->map
+	      && sdata->name_table < sdata->map + sdata->map_size)
+	    sdata->name_table = NULL;
+	  bfd_free_window (&sdata->map_window);
+	  sdata->map = NULL;
+	}
+    }
+
+  return _bfd_generic_close_and_cleanup (abfd);
+}
+/* APPLE LOCAL end mapped xsym  */
+
 asymbol *
 bfd_sym_make_empty_symbol (bfd *abfd)
 {
@@ -547,6 +547,17 @@ struct bfd_sym_data_struct
   bfd_sym_header_block header;
   bfd_sym_version version;
   bfd *sbfd;
+  /* APPLE LOCAL begin mapped xsym  */
+  /* The whole file, if it could be mapped without copying it.  The
+     tables are decoded from here, and NAME_TABLE points into it.  */
+  bfd_window map_window;
+  unsigned char *map;
+  bfd_size_type map_size;
+  int map_failed;
+  /* Nonzero if the name table couldn't be read.  It is read or
+     mapped the first time a name is asked for.  */
+  int name_table_failed;
+  /* APPLE LOCAL end mapped xsym  */
 };
 typedef struct bfd_sym_data_struct bfd_sym_data_struct;
 
@@ -558,6 +569,10 @@ extern bfd_boolean bfd_sym_valid
   (bfd *);
 extern unsigned char * bfd_sym_read_name_table
   (bfd *, bfd_sym_header_block *);
+/* APPLE LOCAL begin mapped xsym  */
+extern unsigned char * bfd_sym_read_data
+  (bfd *, unsigned long, unsigned long, unsigned char *);
+/* APPLE LOCAL end mapped xsym  */
 extern void bfd_sym_parse_file_reference_v32
   (unsigned char *, size_t, bfd_sym_file_reference *);
 /* APPLE LOCAL CW */
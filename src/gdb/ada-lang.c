@@ -52,6 +52,8 @@ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.  */
 #include "infcall.h"
 #include "dictionary.h"
 #include "exceptions.h"
+/* APPLE LOCAL ada lookup cache  */
+#include "target.h"
 
 #ifndef ADA_RETAIN_DOTS
 #define ADA_RETAIN_DOTS 0
@@ -3627,22 +3629,249 @@ ada_convert_actuals (struct value *func, int nargs, struct value *args[],
       convert_actual (args[i], TYPE_FIELD_TYPE (value_type (func), i), sp);
 }
 
-/* Dummy definitions for an experimental caching module that is not
- * used in the public sources. */
+/* APPLE LOCAL begin ada lookup cache  */
+/* The results of the global part of ada_lookup_symbol_list, which
+   searches every symtab, minimal symbol and psymtab of every objfile,
+   keyed by name and domain.  What is found doesn't depend on the block
+   the search started from, only on which objfiles are loaded, and
+   those only change while the inferior is stopped, so an entry is good
+   for the target_stop_generation it was made in.  A NULL SYM records
+   that nothing was found.  */
+
+#define ADA_LOOKUP_CACHE_SIZE 256
+
+struct ada_lookup_cache_entry
+{
+  char *name;
+  domain_enum namespace;
+  struct symbol *sym;
+  struct block *block;
+  struct symtab *symtab;
+  unsigned int generation;
+};
+
+static struct ada_lookup_cache_entry ada_lookup_cache[ADA_LOOKUP_CACHE_SIZE];
+
+static int ada_lookup_cache_enabled = 1;
+
+static void
+show_ada_lookup_cache_enabled (struct ui_file *file, int from_tty,
+                               struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Caching of Ada symbol lookups is %s.\n"),
+                    value);
+}
+
+static struct ada_lookup_cache_entry *
+ada_lookup_cache_slot (const char *name, domain_enum namespace)
+{
+  hashval_t hash = htab_hash_string (name) * 31 + (hashval_t) namespace;
+
+  return &ada_lookup_cache[hash % ADA_LOOKUP_CACHE_SIZE];
+}
+
+/* If the global lookup of NAME in NAMESPACE has been done since the
+   inferior last stopped, set *SYM, and *BLOCK and *SYMTAB if they are
+   non-NULL, to its result and return 1.  Otherwise return 0.  */
 
 static int
 lookup_cached_symbol (const char *name, domain_enum namespace,
                       struct symbol **sym, struct block **block,
                       struct symtab **symtab)
 {
-  return 0;
+  struct ada_lookup_cache_entry *entry;
+
+  if (!ada_lookup_cache_enabled)
+    return 0;
+
+  entry = ada_lookup_cache_slot (name, namespace);
+  if (entry->name == NULL || entry->generation != target_stop_generation
+      || entry->namespace != namespace || strcmp (entry->name, name) != 0)
+    return 0;
+
+  *sym = entry->sym;
+  if (block != NULL)
+    *block = entry->block;
+  if (symtab != NULL)
+    *symtab = entry->symtab;
+  return 1;
 }
 
 static void
 cache_symbol (const char *name, domain_enum namespace, struct symbol *sym,
               struct block *block, struct symtab *symtab)
 {
+  struct ada_lookup_cache_entry *entry;
+
+  if (!ada_lookup_cache_enabled)
+    return;
+
+  entry = ada_lookup_cache_slot (name, namespace);
+  if (entry->name == NULL || strcmp (entry->name, name) != 0)
+    {
+      xfree (entry->name);
+      entry->name = xstrdup (name);
+    }
+  entry->namespace = namespace;
+  entry->sym = sym;
+  entry->block = block;
+  entry->symtab = symtab;
+  entry->generation = target_stop_generation;
+}
+
+/* Matching a name against each of an objfile's minimal symbols is the
+   slowest part of a global lookup, so each objfile gets an index of
+   its minimal symbols by the first ADA_MSYM_INDEX_KEY_LEN characters
+   at each place a name can match: the start of the linkage name, after
+   a leading "_ada_", and after each "__" or ".".  Any symbol that
+   ada_match_name could accept for a name that long is then in the
+   bucket for the name's first characters.  Shorter names still scan
+   every symbol.  */
+
+#define ADA_MSYM_INDEX_KEY_LEN 4
+
+struct ada_msym_bucket
+{
+  char key[ADA_MSYM_INDEX_KEY_LEN + 1];
+
+  /* Indices into the objfile's msymbols, in increasing order.  */
+  int count;
+  int alloced;
+  int *indices;
+};
+
+struct ada_msym_index
+{
+  /* The minimal symbol table this index was built from; if the
+     objfile has been given a new one, the index is rebuilt.  */
+  struct minimal_symbol *msymbols;
+  int minimal_symbol_count;
+
+  htab_t buckets;
+};
+
+static const struct objfile_data *ada_msym_index_objfile_data;
+
+static hashval_t
+ada_msym_bucket_hash (const void *p)
+{
+  const struct ada_msym_bucket *bucket = p;
+
+  return htab_hash_string (bucket->key);
+}
+
+static int
+ada_msym_bucket_eq (const void *p1, const void *p2)
+{
+  const struct ada_msym_bucket *b1 = p1;
+  const struct ada_msym_bucket *b2 = p2;
+
+  return strcmp (b1->key, b2->key) == 0;
+}
+
+static void
+ada_msym_bucket_del (void *p)
+{
+  struct ada_msym_bucket *bucket = p;
+
+  xfree (bucket->indices);
+  xfree (bucket);
+}
+
+static void
+ada_msym_index_free (struct objfile *objfile, void *data)
+{
+  struct ada_msym_index *index = data;
+
+  if (index == NULL)
+    return;
+  htab_delete (index->buckets);
+  xfree (index);
 }
+
+/* Add minimal symbol number I to the bucket for the characters at
+   KEY, unless there are too few of them.  */
+
+static void
+ada_msym_index_add (htab_t buckets, const char *key, int i)
+{
+  struct ada_msym_bucket probe, *bucket;
+  void **slot;
+
+  if (strlen (key) < ADA_MSYM_INDEX_KEY_LEN)
+    return;
+  memcpy (probe.key, key, ADA_MSYM_INDEX_KEY_LEN);
+  probe.key[ADA_MSYM_INDEX_KEY_LEN] = '\0';
+
+  slot = htab_find_slot (buckets, &probe, INSERT);
+  bucket = *slot;
+  if (bucket == NULL)
+    {
+      bucket = xcalloc (1, sizeof (struct ada_msym_bucket));
+      strcpy (bucket->key, probe.key);
+      *slot = bucket;
+    }
+  else if (bucket->count > 0 && bucket->indices[bucket->count - 1] == i)
+    return;
+
+  if (bucket->count == bucket->alloced)
+    {
+      bucket->alloced = bucket->alloced * 2 + 4;
+      bucket->indices = xrealloc (bucket->indices,
+                                  bucket->alloced * sizeof (int));
+    }
+  bucket->indices[bucket->count++] = i;
+}
+
+static struct ada_msym_index *
+ada_msym_index_get (struct objfile *objfile)
+{
+  struct ada_msym_index *index;
+  int i;
+
+  index = objfile_data (objfile, ada_msym_index_objfile_data);
+  if (index != NULL
+      && index->msymbols == objfile->msymbols
+      && index->minimal_symbol_count == objfile->minimal_symbol_count)
+    return index;
+
+  if (index == NULL)
+    {
+      index = xmalloc (sizeof (struct ada_msym_index));
+      set_objfile_data (objfile, ada_msym_index_objfile_data, index);
+    }
+  else
+    htab_delete (index->buckets);
+
+  index->msymbols = objfile->msymbols;
+  index->minimal_symbol_count = objfile->minimal_symbol_count;
+  index->buckets = htab_create_alloc (1024, ada_msym_bucket_hash,
+                                      ada_msym_bucket_eq, ada_msym_bucket_del,
+                                      xcalloc, xfree);
+
+  for (i = 0;
+       objfile->msymbols != NULL
+       && SYMBOL_LINKAGE_NAME (&objfile->msymbols[i]) != NULL;
+       i++)
+    {
+      const char *name = SYMBOL_LINKAGE_NAME (&objfile->msymbols[i]);
+      const char *p;
+
+      ada_msym_index_add (index->buckets, name, i);
+      if (strncmp (name, "_ada_", 5) == 0)
+        ada_msym_index_add (index->buckets, name + 5, i);
+      for (p = name; *p != '\0'; p++)
+        {
+          if (p[0] == '_' && p[1] == '_')
+            ada_msym_index_add (index->buckets, p + 2, i);
+          else if (p[0] == '.')
+            ada_msym_index_add (index->buckets, p + 1, i);
+        }
+    }
+
+  return index;
+}
+/* APPLE LOCAL end ada lookup cache  */
 
                                 /* Symbol Lookup */
 
@@ -3656,11 +3885,12 @@ standard_lookup (const char *name, const struct block *block,
   struct symbol *sym;
   struct symtab *symtab;
 
-  if (lookup_cached_symbol (name, domain, &sym, NULL, NULL))
-    return sym;
+  /* APPLE LOCAL begin ada lookup cache  */
+  /* This finds local symbols too, so its answer depends on BLOCK and
+     can't go in the cache of global lookups.  */
   sym =
     lookup_symbol_in_language (name, block, domain, language_c, 0, &symtab);
-  cache_symbol (name, domain, sym, block_found, symtab);
+  /* APPLE LOCAL end ada lookup cache  */
   return sym;
 }
 
@@ -3815,6 +4045,9 @@ ada_lookup_partial_symbol (struct partial_symtab *pst, const char *name,
       return (NULL);
     }
 
+  /* APPLE LOCAL deferred psymbol relocation  */
+  objfile_relocate_psymbols (pst->objfile);
+
   start = (global ?
            pst->objfile->global_psymbols.list + pst->globals_offset :
            pst->objfile->static_psymbols.list + pst->statics_offset);
@@ -4284,6 +4517,47 @@ remove_out_of_scope_renamings (struct ada_symbol_info *syms,
   return nsyms;
 }
 
+/* APPLE LOCAL begin ada lookup cache  */
+/* If MSYMBOL, from OBJFILE, matches NAME, add the symbols for it in
+   DOMAIN from the global block of its symtab, or failing that from the
+   static block, to symbol_list_obstack.  Subroutine of
+   ada_lookup_symbol_list.  */
+
+static void
+add_msymbol_defns (struct minimal_symbol *msymbol, struct objfile *objfile,
+                   const char *name, domain_enum namespace, int wild_match)
+{
+  struct symtab *s;
+  struct blockvector *bv;
+  struct block *block;
+  int ndefns0;
+
+  if (!ada_match_name (SYMBOL_LINKAGE_NAME (msymbol), name, wild_match)
+      || MSYMBOL_TYPE (msymbol) == mst_solib_trampoline)
+    return;
+
+  s = find_pc_symtab (SYMBOL_VALUE_ADDRESS (msymbol));
+  if (s == NULL)
+    return;
+
+  ndefns0 = num_defns_collected (&symbol_list_obstack);
+  QUIT;
+  bv = BLOCKVECTOR (s);
+  block = BLOCKVECTOR_BLOCK (bv, GLOBAL_BLOCK);
+  ada_add_block_symbols (&symbol_list_obstack, block,
+                         SYMBOL_LINKAGE_NAME (msymbol),
+                         namespace, objfile, s, wild_match);
+
+  if (num_defns_collected (&symbol_list_obstack) == ndefns0)
+    {
+      block = BLOCKVECTOR_BLOCK (bv, STATIC_BLOCK);
+      ada_add_block_symbols (&symbol_list_obstack, block,
+                             SYMBOL_LINKAGE_NAME (msymbol),
+                             namespace, objfile, s, wild_match);
+    }
+}
+/* APPLE LOCAL end ada lookup cache  */
+
 /* Find symbols in DOMAIN matching NAME0, in BLOCK0 and enclosing
    scope and in global scopes, returning the number of matches.  Sets
    *RESULTS to point to a vector of (SYM,BLOCK,SYMTAB) triples,
@@ -4385,38 +4659,33 @@ ada_lookup_symbol_list (const char *name0, const struct block *block0,
 
   if (namespace == VAR_DOMAIN)
     {
-      ALL_MSYMBOLS (objfile, msymbol)
+      /* APPLE LOCAL begin ada lookup cache  */
+      ALL_OBJFILES (objfile)
       {
-        if (ada_match_name (SYMBOL_LINKAGE_NAME (msymbol), name, wild_match))
+        if (objfile->msymbols == NULL)
+          continue;
+
+        if (ada_lookup_cache_enabled
+            && strlen (name) >= ADA_MSYM_INDEX_KEY_LEN)
           {
-            switch (MSYMBOL_TYPE (msymbol))
-              {
-              case mst_solib_trampoline:
-                break;
-              default:
-                s = find_pc_symtab (SYMBOL_VALUE_ADDRESS (msymbol));
-                if (s != NULL)
-                  {
-                    int ndefns0 = num_defns_collected (&symbol_list_obstack);
-                    QUIT;
-                    bv = BLOCKVECTOR (s);
-                    block = BLOCKVECTOR_BLOCK (bv, GLOBAL_BLOCK);
-                    ada_add_block_symbols (&symbol_list_obstack, block,
-                                           SYMBOL_LINKAGE_NAME (msymbol),
-                                           namespace, objfile, s, wild_match);
-
-                    if (num_defns_collected (&symbol_list_obstack) == ndefns0)
-                      {
-                        block = BLOCKVECTOR_BLOCK (bv, STATIC_BLOCK);
-                        ada_add_block_symbols (&symbol_list_obstack, block,
-                                               SYMBOL_LINKAGE_NAME (msymbol),
-                                               namespace, objfile, s,
-                                               wild_match);
-                      }
-                  }
-              }
+            struct ada_msym_index *index = ada_msym_index_get (objfile);
+            struct ada_msym_bucket probe, *bucket;
+            int i;
+
+            memcpy (probe.key, name, ADA_MSYM_INDEX_KEY_LEN);
+            probe.key[ADA_MSYM_INDEX_KEY_LEN] = '\0';
+            bucket = htab_find (index->buckets, &probe);
+            if (bucket != NULL)
+              for (i = 0; i < bucket->count; i++)
+                add_msymbol_defns (&objfile->msymbols[bucket->indices[i]],
+                                   objfile, name, namespace, wild_match);
           }
+        else
+          ALL_OBJFILE_MSYMBOLS (objfile, msymbol)
+            add_msymbol_defns (msymbol, objfile, name, namespace,
+                               wild_match);
       }
+      /* APPLE LOCAL end ada lookup cache  */
     }
 
   ALL_PSYMTABS (objfile, ps)
@@ -8787,4 +9056,20 @@ _initialize_ada_language (void)
   decoded_names_store = htab_create_alloc
     (256, htab_hash_string, (int (*)(const void *, const void *)) streq,
      NULL, xcalloc, xfree);
+
+  /* APPLE LOCAL begin ada lookup cache  */
+  ada_msym_index_objfile_data
+    = register_objfile_data_with_cleanup (ada_msym_index_free);
+
+  add_setshow_boolean_cmd ("ada-lookup-cache", class_maintenance,
+                           &ada_lookup_cache_enabled, _("\
+Set whether Ada symbol lookups are cached."), _("\
+Show whether Ada symbol lookups are cached."), _("\
+When on, minimal symbols are indexed per objfile by name for Ada\n\
+lookups, and the result of each global Ada lookup is reused until the\n\
+inferior next stops."),
+                           NULL, show_ada_lookup_cache_enabled,
+                           &maintenance_set_cmdlist,
+                           &maintenance_show_cmdlist);
+  /* APPLE LOCAL end ada lookup cache  */
 }
@@ -40,6 +40,8 @@
 #include "trad-frame.h"
 #include "objfiles.h"
 #include "dwarf2-frame.h"
+/* APPLE LOCAL prologue analysis cache  */
+#include "prologue-memo.h"
 
 #include "arm-tdep.h"
 #include "gdb/sim-arm.h"
@@ -2032,6 +2034,68 @@ arm_macosx_locate_prologue_start (const CORE_ADDR addr)
   return prologue_start;
 }
 
+/* APPLE LOCAL begin prologue analysis cache  */
+/* The parts of an arm_prologue_cache that arm_macosx_scan_prologue
+   computes from the function's text, as handed to prologue_memo_store.
+   The (still SP-relative) SAVED_REGS array follows it.  */
+
+struct arm_prologue_memo
+{
+  CORE_ADDR prologue_start;
+  int framesize;
+  int frameoffset;
+  int framereg;
+};
+
+static size_t
+arm_prologue_memo_size (void)
+{
+  return sizeof (struct arm_prologue_memo)
+	 + (NUM_REGS + NUM_PSEUDO_REGS) * sizeof (struct trad_frame_saved_reg);
+}
+
+/* Fill in CACHE from an earlier scan of the prologue leading up to
+   PREV_PC with the same FLAGS, if we have one.  Returns 1 if we did.  */
+
+static int
+arm_prologue_memo_restore (CORE_ADDR prev_pc, int flags,
+			   arm_prologue_cache_t *cache)
+{
+  size_t size = arm_prologue_memo_size ();
+  gdb_byte *buf = alloca (size);
+  struct arm_prologue_memo memo;
+
+  if (!prologue_memo_lookup (prev_pc, prev_pc, flags, buf, size))
+    return 0;
+
+  memcpy (&memo, buf, sizeof (memo));
+  cache->prologue_start = memo.prologue_start;
+  cache->framesize = memo.framesize;
+  cache->frameoffset = memo.frameoffset;
+  cache->framereg = memo.framereg;
+  memcpy (cache->saved_regs, buf + sizeof (memo), size - sizeof (memo));
+  return 1;
+}
+
+static void
+arm_prologue_memo_save (CORE_ADDR prev_pc, int flags,
+			arm_prologue_cache_t *cache)
+{
+  size_t size = arm_prologue_memo_size ();
+  gdb_byte *buf = alloca (size);
+  struct arm_prologue_memo memo;
+
+  memset (&memo, 0, sizeof (memo));
+  memo.prologue_start = cache->prologue_start;
+  memo.framesize = cache->framesize;
+  memo.frameoffset = cache->frameoffset;
+  memo.framereg = cache->framereg;
+  memcpy (buf, &memo, sizeof (memo));
+  memcpy (buf + sizeof (memo), cache->saved_regs, size - sizeof (memo));
+  prologue_memo_store (prev_pc, prev_pc, flags, buf, size);
+}
+/* APPLE LOCAL end prologue analysis cache  */
+
 static void
 arm_macosx_scan_prologue (struct frame_info *next_frame, arm_prologue_cache_t *cache)
 {
@@ -2040,6 +2104,8 @@ arm_macosx_scan_prologue (struct frame_info *next_frame, arm_prologue_cache_t *c
   uint32_t insn;
   CORE_ADDR prologue_end;
   CORE_ADDR prev_pc = frame_pc_unwind (next_frame);
+  /* APPLE LOCAL prologue analysis cache  */
+  int memo_flags;
 
   init_prologue_state (&state);
 
@@ -2113,13 +2179,27 @@ arm_macosx_scan_prologue (struct frame_info *next_frame, arm_prologue_cache_t *c
     }
   
 
+  /* APPLE LOCAL begin prologue analysis cache  */
+  /* What follows only depends on PREV_PC, the frame register we
+     settled on above and the instruction set, so key on those.  */
+  memo_flags = cache->framereg << 1;
+
   /* Check for Thumb prologue.  */
   if ((next_cache && next_cache->prev_pc_is_thumb) || arm_pc_is_thumb (prev_pc))
     {
-      thumb_macosx_scan_prologue (prev_pc, cache);
+      memo_flags |= 1;
+      if (!arm_prologue_memo_restore (prev_pc, memo_flags, cache))
+	{
+	  thumb_macosx_scan_prologue (prev_pc, cache);
+	  arm_prologue_memo_save (prev_pc, memo_flags, cache);
+	}
       return;
     }
 
+  if (arm_prologue_memo_restore (prev_pc, memo_flags, cache))
+    return;
+  /* APPLE LOCAL end prologue analysis cache  */
+
   if (arm_debug > 3)
     fprintf_unfiltered (gdb_stdlog, "arm_macosx_scan_prologue (0x%s, %p)\n", 
 			paddr (prev_pc), cache);
@@ -2260,6 +2340,9 @@ arm_macosx_scan_prologue (struct frame_info *next_frame, arm_prologue_cache_t *c
     cache->frameoffset = state.fp_offset - state.sp_offset;
   else
     cache->frameoffset = 0;
+
+  /* APPLE LOCAL prologue analysis cache  */
+  arm_prologue_memo_save (prev_pc, memo_flags, cache);
 }
 
 
@@ -304,6 +304,19 @@ maybe_const_expr (union exp_element **pc)
    emits the trace bytecodes at the appropriate points.  */
 static int trace_kludge;
 
+/* APPLE LOCAL begin breakpoint condition bytecode  */
+/* Set while gen_eval_for_expr is compiling a breakpoint condition.
+   The result is run by ax_eval on every hit of the breakpoint, and a
+   wrong answer there silently skips a stop the user asked for, so we
+   refuse anything we aren't sure to get right: variables whose
+   location depends on the stack frame (TARGET_VIRTUAL_FRAME_POINTER
+   isn't trustworthy on our targets, and DWARF register numbers
+   aren't mapped to GDB's), and fetches of types the bytecode can't
+   represent, which would otherwise be internal errors.  An error
+   here just means the condition is evaluated the old way.  */
+static int condition_kludge;
+/* APPLE LOCAL end breakpoint condition bytecode  */
+
 /* Trace the lvalue on the stack, if it needs it.  In either case, pop
    the value.  Useful on the left side of a comma, and at the end of
    an expression being used for tracing.  */
@@ -385,6 +398,25 @@ gen_fetch (struct agent_expr *ax, struct type *type)
       ax_trace_quick (ax, TYPE_LENGTH (type));
     }
 
+  /* APPLE LOCAL begin breakpoint condition bytecode  */
+  if (condition_kludge)
+    switch (TYPE_CODE (type))
+      {
+      case TYPE_CODE_PTR:
+      case TYPE_CODE_ENUM:
+      case TYPE_CODE_INT:
+      case TYPE_CODE_CHAR:
+	if (TYPE_LENGTH (type) == 8 / TARGET_CHAR_BIT
+	    || TYPE_LENGTH (type) == 16 / TARGET_CHAR_BIT
+	    || TYPE_LENGTH (type) == 32 / TARGET_CHAR_BIT
+	    || TYPE_LENGTH (type) == 64 / TARGET_CHAR_BIT)
+	  break;
+	/* Fall through.  */
+      default:
+	error (_("Can't fetch a value of this type in an agent expression."));
+      }
+  /* APPLE LOCAL end breakpoint condition bytecode  */
+
   switch (TYPE_CODE (type))
     {
     case TYPE_CODE_PTR:
@@ -524,6 +556,22 @@ gen_var_ref (struct agent_expr *ax, struct axs_value *value, struct symbol *var)
   /* Dereference any typedefs. */
   value->type = check_typedef (SYMBOL_TYPE (var));
 
+  /* APPLE LOCAL begin breakpoint condition bytecode  */
+  if (condition_kludge)
+    switch (SYMBOL_CLASS (var))
+      {
+      case LOC_CONST:
+      case LOC_LABEL:
+      case LOC_STATIC:
+      case LOC_BLOCK:
+      case LOC_UNRESOLVED:
+	break;
+      default:
+	error (_("`%s' can't be referenced from a compiled condition."),
+	       SYMBOL_PRINT_NAME (var));
+      }
+  /* APPLE LOCAL end breakpoint condition bytecode  */
+
   /* I'm imitating the code in read_var_value.  */
   switch (SYMBOL_CLASS (var))
     {
@@ -682,6 +730,13 @@ require_rvalue (struct agent_expr *ax, struct axs_value *value)
 
          When we add floating-point support, this is going to have to
          change.  What about SPARC register pairs, for example?  */
+      /* APPLE LOCAL begin breakpoint condition bytecode  */
+      if (condition_kludge
+	  && ((TYPE_CODE (value->type) != TYPE_CODE_INT
+	       && TYPE_CODE (value->type) != TYPE_CODE_PTR)
+	      || TYPE_LENGTH (value->type) > sizeof (LONGEST)))
+	error (_("Can't fetch a register of this type in an agent expression."));
+      /* APPLE LOCAL end breakpoint condition bytecode  */
       ax_reg (ax, value->u.reg);
       gen_extend (ax, value->type);
       break;
@@ -1744,6 +1799,8 @@ expr_to_agent (struct expression *expr, struct axs_value *value)
 
   pc = expr->elts;
   trace_kludge = 0;
+  /* APPLE LOCAL breakpoint condition bytecode  */
+  condition_kludge = 0;
   gen_expr (&pc, ax, value);
 
   /* We have successfully built the agent expr, so cancel the cleanup
@@ -1797,6 +1854,8 @@ gen_trace_for_expr (CORE_ADDR scope, struct expression *expr)
 
   pc = expr->elts;
   trace_kludge = 1;
+  /* APPLE LOCAL breakpoint condition bytecode  */
+  condition_kludge = 0;
   gen_expr (&pc, ax, &value);
 
   /* Make sure we record the final object, and get rid of it.  */
@@ -1812,6 +1871,53 @@ gen_trace_for_expr (CORE_ADDR scope, struct expression *expr)
   return ax;
 }
 
+/* APPLE LOCAL begin breakpoint condition bytecode  */
+static void
+clear_condition_kludge (void *ignore)
+{
+  condition_kludge = 0;
+}
+
+/* Given a GDB expression EXPR, return bytecode that leaves its value
+   on the top of the stack and ends, for ax_eval to run when the
+   breakpoint at SCOPE is hit.  Signal an error if EXPR uses anything
+   that condition_kludge rules out, or if the result wouldn't be
+   trustworthy for any other reason; the caller is expected to fall
+   back on evaluate_expression.  */
+struct agent_expr *
+gen_eval_for_expr (CORE_ADDR scope, struct expression *expr)
+{
+  struct cleanup *old_chain = 0;
+  struct agent_expr *ax = new_agent_expr (scope);
+  union exp_element *pc;
+  struct axs_value value;
+  struct agent_reqs reqs;
+
+  old_chain = make_cleanup_free_agent_expr (ax);
+  make_cleanup (clear_condition_kludge, NULL);
+
+  pc = expr->elts;
+  trace_kludge = 0;
+  condition_kludge = 1;
+  gen_expr (&pc, ax, &value);
+  require_rvalue (ax, &value);
+  ax_simple (ax, aop_end);
+  condition_kludge = 0;
+
+  ax_reqs (ax, &reqs);
+  xfree (reqs.reg_mask);
+  if (reqs.flaw != agent_flaw_none)
+    error (_("Agent expression for breakpoint condition is malformed."));
+  if (reqs.final_height != 1 || reqs.min_height < 0)
+    error (_("Agent expression for breakpoint condition is unbalanced."));
+  if (reqs.max_height > AGENT_EVAL_STACK_SIZE)
+    error (_("Breakpoint condition is too deep for an agent expression."));
+
+  discard_cleanups (old_chain);
+  return ax;
+}
+/* APPLE LOCAL end breakpoint condition bytecode  */
+
 static void
 agent_command (char *exp, int from_tty)
 {
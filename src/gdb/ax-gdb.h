@@ -110,4 +110,12 @@ extern struct agent_expr *expr_to_address_and_size (struct expression *EXPR);
    function to discover which registers the expression uses.  */
 extern struct agent_expr *gen_trace_for_expr (CORE_ADDR, struct expression *);
 
+/* APPLE LOCAL begin breakpoint condition bytecode  */
+/* Given a GDB expression EXPR, the condition of a breakpoint at
+   SCOPE, return bytecode that leaves its value on the stack for
+   ax_eval.  Signal an error if the expression can't be compiled
+   faithfully; the caller should then evaluate it itself.  */
+extern struct agent_expr *gen_eval_for_expr (CORE_ADDR, struct expression *);
+/* APPLE LOCAL end breakpoint condition bytecode  */
+
 #endif /* AX_GDB_H */
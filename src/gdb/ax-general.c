@@ -540,3 +540,203 @@ ax_reqs (struct agent_expr *ax, struct agent_reqs *reqs)
   reqs->reg_mask_len = reg_mask_len;
   reqs->reg_mask = reg_mask;
 }
+
+
+/* APPLE LOCAL begin breakpoint condition bytecode  */
+/* Evaluating expressions.  */
+
+/* Extract the N-byte big-endian operand at offset O of X.  Unlike
+   read_const, do the arithmetic unsigned so a 64-bit constant with
+   its top bit set comes out right.  */
+static ULONGEST
+eval_operand (struct agent_expr *x, int o, int n)
+{
+  int i;
+  ULONGEST accum = 0;
+
+  if (o + n > x->len)
+    error (_("Agent expression ends in the middle of an operand."));
+
+  for (i = 0; i < n; i++)
+    accum = (accum << 8) | x->buf[o + i];
+
+  return accum;
+}
+
+LONGEST
+ax_eval (struct agent_expr *x, const struct agent_eval_ops *ops, void *data)
+{
+  LONGEST stack[AGENT_EVAL_STACK_SIZE];
+  int sp = 0;
+  int pc = 0;
+  const int width = sizeof (LONGEST) * 8;
+
+  while (pc < x->len)
+    {
+      enum agent_op op = x->buf[pc];
+      struct aop_map *map;
+      LONGEST a, b;
+      int n;
+
+      if (op >= (sizeof (aop_map) / sizeof (aop_map[0]))
+	  || aop_map[op].name == NULL)
+	error (_("Invalid agent expression bytecode 0x%x."), op);
+      map = &aop_map[op];
+
+      if (sp < map->consumed)
+	error (_("Agent expression stack underflow."));
+      if (sp - map->consumed + map->produced > AGENT_EVAL_STACK_SIZE)
+	error (_("Agent expression stack overflow."));
+
+      b = sp > 0 ? stack[sp - 1] : 0;
+      a = sp > 1 ? stack[sp - 2] : 0;
+
+      switch (op)
+	{
+	case aop_add:
+	  stack[sp - 2] = (LONGEST) ((ULONGEST) a + (ULONGEST) b);
+	  break;
+	case aop_sub:
+	  stack[sp - 2] = (LONGEST) ((ULONGEST) a - (ULONGEST) b);
+	  break;
+	case aop_mul:
+	  stack[sp - 2] = (LONGEST) ((ULONGEST) a * (ULONGEST) b);
+	  break;
+
+	case aop_div_signed:
+	case aop_rem_signed:
+	  if (b == 0)
+	    error (_("Division by zero in agent expression."));
+	  /* The one quotient that doesn't fit.  */
+	  if (b == -1)
+	    stack[sp - 2] = (op == aop_div_signed
+			     ? (LONGEST) (- (ULONGEST) a) : 0);
+	  else
+	    stack[sp - 2] = op == aop_div_signed ? a / b : a % b;
+	  break;
+	case aop_div_unsigned:
+	case aop_rem_unsigned:
+	  if (b == 0)
+	    error (_("Division by zero in agent expression."));
+	  stack[sp - 2] = (op == aop_div_unsigned
+			   ? (LONGEST) ((ULONGEST) a / (ULONGEST) b)
+			   : (LONGEST) ((ULONGEST) a % (ULONGEST) b));
+	  break;
+
+	case aop_lsh:
+	  stack[sp - 2] = ((ULONGEST) b >= (ULONGEST) width
+			   ? 0 : (LONGEST) ((ULONGEST) a << b));
+	  break;
+	case aop_rsh_signed:
+	  stack[sp - 2] = ((ULONGEST) b >= (ULONGEST) width
+			   ? (a < 0 ? -1 : 0) : a >> b);
+	  break;
+	case aop_rsh_unsigned:
+	  stack[sp - 2] = ((ULONGEST) b >= (ULONGEST) width
+			   ? 0 : (LONGEST) ((ULONGEST) a >> b));
+	  break;
+
+	case aop_log_not:
+	  stack[sp - 1] = !b;
+	  break;
+	case aop_bit_and:
+	  stack[sp - 2] = a & b;
+	  break;
+	case aop_bit_or:
+	  stack[sp - 2] = a | b;
+	  break;
+	case aop_bit_xor:
+	  stack[sp - 2] = a ^ b;
+	  break;
+	case aop_bit_not:
+	  stack[sp - 1] = ~b;
+	  break;
+
+	case aop_equal:
+	  stack[sp - 2] = a == b;
+	  break;
+	case aop_less_signed:
+	  stack[sp - 2] = a < b;
+	  break;
+	case aop_less_unsigned:
+	  stack[sp - 2] = (ULONGEST) a < (ULONGEST) b;
+	  break;
+
+	case aop_ext:
+	case aop_zero_ext:
+	  n = eval_operand (x, pc + 1, 1);
+	  if (n > 0 && n < width)
+	    {
+	      ULONGEST mask = ((ULONGEST) 1 << n) - 1;
+	      ULONGEST sign = (ULONGEST) 1 << (n - 1);
+
+	      if (op == aop_zero_ext)
+		stack[sp - 1] = (LONGEST) ((ULONGEST) b & mask);
+	      else
+		stack[sp - 1] = ((LONGEST) (((ULONGEST) b & mask) ^ sign)
+				 - (LONGEST) sign);
+	    }
+	  break;
+
+	case aop_ref8:
+	case aop_ref16:
+	case aop_ref32:
+	case aop_ref64:
+	  stack[sp - 1] = (LONGEST) ops->fetch_memory (data, (CORE_ADDR) b,
+						       map->data_size / 8);
+	  break;
+
+	case aop_if_goto:
+	case aop_goto:
+	  n = eval_operand (x, pc + 1, 2);
+	  /* Nothing we generate loops; don't let a bad expression hang
+	     us either.  */
+	  if (n <= pc)
+	    error (_("Backward jump in agent expression."));
+	  if (op == aop_goto || b != 0)
+	    {
+	      sp -= map->consumed;
+	      pc = n;
+	      continue;
+	    }
+	  break;
+
+	case aop_const8:
+	case aop_const16:
+	case aop_const32:
+	case aop_const64:
+	  stack[sp] = (LONGEST) eval_operand (x, pc + 1, map->op_size);
+	  break;
+
+	case aop_reg:
+	  n = eval_operand (x, pc + 1, 2);
+	  stack[sp] = (LONGEST) ops->fetch_register (data, n);
+	  break;
+
+	case aop_end:
+	  if (sp < 1)
+	    error (_("Agent expression ended with an empty stack."));
+	  return stack[sp - 1];
+
+	case aop_dup:
+	  stack[sp] = b;
+	  break;
+	case aop_pop:
+	  break;
+	case aop_swap:
+	  stack[sp - 2] = b;
+	  stack[sp - 1] = a;
+	  break;
+
+	default:
+	  error (_("Agent expression bytecode `%s' is not supported here."),
+		 map->name);
+	}
+
+      sp += map->produced - map->consumed;
+      pc += 1 + map->op_size;
+    }
+
+  error (_("Agent expression has no `end'."));
+}
+/* APPLE LOCAL end breakpoint condition bytecode  */
@@ -289,4 +289,31 @@ struct agent_reqs
    describing it.  */
 extern void ax_reqs (struct agent_expr *ax, struct agent_reqs *reqs);
 
+/* APPLE LOCAL begin breakpoint condition bytecode  */
+/* Evaluating expressions.  */
+
+/* How the evaluator gets at the machine.  Both functions signal an
+   error if the value can't be had.  */
+struct agent_eval_ops
+  {
+    /* Return the contents of register REG.  */
+    ULONGEST (*fetch_register) (void *data, int reg);
+
+    /* Return the LEN-byte unsigned integer at ADDR, in the target's
+       byte order.  */
+    ULONGEST (*fetch_memory) (void *data, CORE_ADDR addr, int len);
+  };
+
+/* The deepest stack ax_eval will run an expression with.  */
+#define AGENT_EVAL_STACK_SIZE 64
+
+/* Run the agent expression AX, fetching registers and memory through
+   OPS (passing DATA along), and return the value on the top of the
+   stack when it reaches `end'.  Trace and floating point bytecodes
+   aren't supported; those, a division by zero, a backward jump or a
+   stack overflow signal an error.  */
+extern LONGEST ax_eval (struct agent_expr *ax,
+			const struct agent_eval_ops *ops, void *data);
+/* APPLE LOCAL end breakpoint condition bytecode  */
+
 #endif /* AGENTEXPR_H */
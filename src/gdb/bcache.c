@@ -29,6 +29,10 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+/* APPLE LOCAL sharded bcache  */
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
 
 /* The type used to hold a single bcache string.  The user data is
    stored in d.data.  Since it can be any type, it needs to have the
@@ -93,6 +97,19 @@ struct bcache
      16 bits of hash values) hit, but the corresponding combined
      length/data compare missed.  */
   unsigned long half_hash_miss_count;
+
+  /* APPLE LOCAL begin sharded bcache  */
+  /* If non-zero, this bcache doesn't hold any strings itself; they
+     are spread over the N_SHARDS bcaches in SHARDS by hash value,
+     each with its own obstack and hash table, and each entered
+     under its own lock.  */
+  int n_shards;
+  struct bcache *shards;
+#ifdef USE_PTHREADS
+  /* Held by a shard while a string is looked up or entered in it.  */
+  pthread_mutex_t lock;
+#endif
+  /* APPLE LOCAL end sharded bcache  */
 };
 
 /* The old hash function was stolen from SDBM. This is what DB 3.0 uses now,
@@ -200,10 +217,12 @@ expand_hash_table (struct bcache *bcache)
 /* Find a copy of the LENGTH bytes at ADDR in BCACHE.  If BCACHE has
    never seen those bytes before, add a copy of them to BCACHE.  In
    either case, return a pointer to BCACHE's copy of that string.  */
+/* APPLE LOCAL sharded bcache: Split out of bcache_data; FULL_HASH is
+   hash (ADDR, LENGTH).  */
 static void *
-bcache_data (const void *addr, int length, struct bcache *bcache)
+bcache_data_1 (const void *addr, int length, unsigned long full_hash,
+	       struct bcache *bcache)
 {
-  unsigned long full_hash;
   unsigned short half_hash;
   int hash_index;
   struct bstring *s;
@@ -215,7 +234,6 @@ bcache_data (const void *addr, int length, struct bcache *bcache)
   bcache->total_count++;
   bcache->total_size += length;
 
-  full_hash = hash (addr, length);
   half_hash = (full_hash >> 16);
   hash_index = full_hash % bcache->num_buckets;
 
@@ -252,6 +270,37 @@ bcache_data (const void *addr, int length, struct bcache *bcache)
   }
 }
 
+/* APPLE LOCAL begin sharded bcache  */
+/* Find a copy of the LENGTH bytes at ADDR in BCACHE, adding one if
+   need be, as bcache_data_1 does.  For a sharded bcache, only the
+   shard the string's hash picks is searched and locked, so threads
+   entering strings that land in different shards don't wait for each
+   other, and growing one shard's hash table only rehashes the
+   strings in that shard.  */
+static void *
+bcache_data (const void *addr, int length, struct bcache *bcache)
+{
+  unsigned long full_hash = hash (addr, length);
+  struct bcache *shard;
+  void *result;
+
+  if (bcache->n_shards == 0)
+    return bcache_data_1 (addr, length, full_hash, bcache);
+
+  /* The low bits pick the bucket within the shard; use the high ones
+     to pick the shard.  */
+  shard = &bcache->shards[(full_hash >> 16) % bcache->n_shards];
+#ifdef USE_PTHREADS
+  pthread_mutex_lock (&shard->lock);
+#endif
+  result = bcache_data_1 (addr, length, full_hash, shard);
+#ifdef USE_PTHREADS
+  pthread_mutex_unlock (&shard->lock);
+#endif
+  return result;
+}
+/* APPLE LOCAL end sharded bcache  */
+
 /* APPLE LOCAL begin bcache pool */
 /* Allocating and freeing bcaches.  */
 
@@ -260,7 +309,12 @@ bcache_specify_allocation_with_arg
 (struct bcache *b, void * (* alloc) (void *, size_t),
  void (* free) (void *, void *), void *arg)
 {
+  int i;
+
   obstack_specify_allocation_with_arg (&b->cache, 0, 0, alloc, free, arg);
+  for (i = 0; i < b->n_shards; i++)
+    obstack_specify_allocation_with_arg (&b->shards[i].cache, 0, 0,
+					 alloc, free, arg);
 }
 
 void
@@ -268,7 +322,11 @@ bcache_specify_allocation
 (struct bcache *b, void * (* alloc) (size_t),
  void (* free) (void *))
 {
+  int i;
+
   obstack_specify_allocation (&b->cache, 0, 0, alloc, free);
+  for (i = 0; i < b->n_shards; i++)
+    obstack_specify_allocation (&b->shards[i].cache, 0, 0, alloc, free);
 }
 /* APPLE LOCAL end bcache pool */
 
@@ -299,13 +357,59 @@ bcache_xmalloc (void *pool)
   return b;
 }
 
+/* APPLE LOCAL begin sharded bcache  */
+/* Create a new bcache object whose strings are spread over N_SHARDS
+   separately locked shards, so that several threads can enter strings
+   into it at once.  */
+
+struct bcache *
+bcache_xmalloc_sharded (void *pool, int n_shards)
+{
+  struct bcache *b = bcache_xmalloc (pool);
+  int i;
+
+  if (n_shards <= 1)
+    return b;
+
+  b->n_shards = n_shards;
+  b->shards = (struct bcache *) xmcalloc (pool, n_shards,
+					  sizeof (struct bcache));
+  b->structure_size += n_shards * sizeof (struct bcache);
+  for (i = 0; i < n_shards; i++)
+    {
+      b->shards[i].pool = pool;
+      obstack_specify_allocation_with_arg (&b->shards[i].cache, 0, 0,
+					   xmmalloc, xmfree, pool);
+#ifdef USE_PTHREADS
+      pthread_mutex_init (&b->shards[i].lock, NULL);
+#endif
+    }
+  return b;
+}
+/* APPLE LOCAL end sharded bcache  */
+
 /* Free all the storage associated with BCACHE.  */
 void
 bcache_xfree (struct bcache *bcache)
 {
+  /* APPLE LOCAL sharded bcache  */
+  int i;
+
   if (bcache == NULL)
     return;
   obstack_free (&bcache->cache, 0);
+  /* APPLE LOCAL begin sharded bcache  */
+  for (i = 0; i < bcache->n_shards; i++)
+    {
+      obstack_free (&bcache->shards[i].cache, 0);
+      xmfree (bcache->pool, bcache->shards[i].bucket);
+#ifdef USE_PTHREADS
+      pthread_mutex_destroy (&bcache->shards[i].lock);
+#endif
+    }
+  if (bcache->shards)
+    xmfree (bcache->pool, bcache->shards);
+  /* APPLE LOCAL end sharded bcache  */
   /* APPLE LOCAL begin bcache pool */
   xmfree (bcache->pool, bcache->bucket);
   xmfree (bcache->pool, bcache);
@@ -340,8 +444,10 @@ print_percentage (int portion, int total)
    eliminating duplication.  NAME should describe the kind of data
    BCACHE holds.  Statistics are printed using `printf_filtered' and
    its ilk.  */
-void
-print_bcache_statistics (struct bcache *c, char *type)
+/* APPLE LOCAL sharded bcache: Renamed from print_bcache_statistics;
+   prints the statistics of one unsharded bcache or shard.  */
+static void
+print_bcache_statistics_1 (struct bcache *c, char *type)
 {
   int occupied_buckets;
   int max_chain_length;
@@ -463,8 +569,39 @@ print_bcache_statistics (struct bcache *c, char *type)
   printf_filtered ("\n");
 }
 
+/* APPLE LOCAL begin sharded bcache  */
+void
+print_bcache_statistics (struct bcache *c, char *type)
+{
+  char *shard_type;
+  int i;
+
+  if (c->n_shards == 0)
+    {
+      print_bcache_statistics_1 (c, type);
+      return;
+    }
+
+  printf_filtered (_("  Cached '%s' is split into %d shards.\n\n"),
+		   type, c->n_shards);
+  for (i = 0; i < c->n_shards; i++)
+    {
+      shard_type = xstrprintf ("%s, shard %d", type, i);
+      print_bcache_statistics_1 (&c->shards[i], shard_type);
+      xfree (shard_type);
+    }
+}
+/* APPLE LOCAL end sharded bcache  */
+
 int
 bcache_memory_used (struct bcache *bcache)
 {
-  return obstack_memory_used (&bcache->cache);
+  /* APPLE LOCAL begin sharded bcache  */
+  int used = obstack_memory_used (&bcache->cache);
+  int i;
+
+  for (i = 0; i < bcache->n_shards; i++)
+    used += obstack_memory_used (&bcache->shards[i].cache);
+  return used;
+  /* APPLE LOCAL end sharded bcache  */
 }
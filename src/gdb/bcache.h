@@ -168,6 +168,14 @@ extern void bcache_specify_allocation (struct bcache *b,
 /* APPLE LOCAL bcache */
 extern struct bcache *bcache_xmalloc (void *);
 
+/* APPLE LOCAL begin sharded bcache  */
+/* Create a new bcache object that spreads its strings over N_SHARDS
+   shards by hash value.  Each shard has its own obstack, hash table
+   and lock, so unlike an ordinary bcache, several threads may call
+   bcache on it at once.  */
+extern struct bcache *bcache_xmalloc_sharded (void *, int n_shards);
+/* APPLE LOCAL end sharded bcache  */
+
 /* Print statistics on BCACHE's memory usage and efficacity at
    eliminating duplication.  TYPE should be a string describing the
    kind of data BCACHE holds.  Statistics are printed using
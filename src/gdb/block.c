@@ -27,6 +27,8 @@
 #include "cp-support.h"
 /* APPLE LOCAL cache lookup values for improved performance  */
 #include "inferior.h"
+/* APPLE LOCAL block pc index  */
+#include "objfiles.h"
 
 /* This is used by struct block to store namespace-related info for
    C++ files, namely using declarations and the current namespace in
@@ -208,6 +210,262 @@ block_contains_pc (const struct block *bl, CORE_ADDR pc)
 }
 /* APPLE LOCAL end address ranges  */
 
+/* APPLE LOCAL begin block pc index  */
+/* Searching a blockvector for the block containing a pc means finding
+   the last block that starts at or before it and walking back until
+   one contains it, which in a big function with many lexical blocks
+   can be a long walk past its siblings.  So each symtab can have an
+   index that splits the addresses its local blocks cover into
+   intervals, each labelled with the innermost block containing every
+   address in it: the one with the highest position in the
+   blockvector, since blocks come after the blocks that enclose them.
+   Finding the block for a pc is then one binary search.
+
+   The index is built the first time it is needed, from the
+   blockvector, its size, and the start of its static block at that
+   time.  Relocating the objfile moves all of a symtab's blocks by the
+   same amount, so a static block that has moved means the index must
+   be rebuilt.  It lives on the objfile's obstack.  */
+
+struct block_pc_index_entry
+{
+  /* The interval runs from here to the next entry's START.  */
+  CORE_ADDR start;
+
+  /* The position of the innermost block containing the interval, or
+     -1 if no local block does.  */
+  int block;
+};
+
+struct block_pc_index
+{
+  struct blockvector *blockvector;
+  int nblocks;
+  CORE_ADDR static_start;
+
+  /* Sorted by START; the last entry always has BLOCK -1.  */
+  int nentries;
+  struct block_pc_index_entry *entries;
+};
+
+/* One address range of a local block, while the index is built.  */
+
+struct block_pc_range
+{
+  CORE_ADDR start;
+  CORE_ADDR end;
+  int block;
+};
+
+static int
+compare_block_pc_ranges (const void *a, const void *b)
+{
+  const struct block_pc_range *ra = a;
+  const struct block_pc_range *rb = b;
+
+  if (ra->start != rb->start)
+    return ra->start < rb->start ? -1 : 1;
+  return 0;
+}
+
+static int
+compare_core_addrs (const void *a, const void *b)
+{
+  CORE_ADDR aa = *(const CORE_ADDR *) a;
+  CORE_ADDR bb = *(const CORE_ADDR *) b;
+
+  if (aa != bb)
+    return aa < bb ? -1 : 1;
+  return 0;
+}
+
+/* HEAP holds N positions in RANGES, as a binary heap with the range
+   of the innermost block at the top.  */
+
+static void
+block_pc_heap_push (int *heap, int *n, struct block_pc_range *ranges, int r)
+{
+  int i = (*n)++;
+
+  while (i > 0 && ranges[heap[(i - 1) / 2]].block < ranges[r].block)
+    {
+      heap[i] = heap[(i - 1) / 2];
+      i = (i - 1) / 2;
+    }
+  heap[i] = r;
+}
+
+static void
+block_pc_heap_pop (int *heap, int *n, struct block_pc_range *ranges)
+{
+  int i = 0;
+  int last = heap[--(*n)];
+
+  for (;;)
+    {
+      int child = 2 * i + 1;
+
+      if (child >= *n)
+	break;
+      if (child + 1 < *n
+	  && ranges[heap[child + 1]].block > ranges[heap[child]].block)
+	child++;
+      if (ranges[heap[child]].block <= ranges[last].block)
+	break;
+      heap[i] = heap[child];
+      i = child;
+    }
+  if (*n > 0)
+    heap[i] = last;
+}
+
+/* Return the block pc index for symtab S, building it if this is the
+   first time it has been asked for or S's blocks have moved.  */
+
+static struct block_pc_index *
+block_pc_index (struct symtab *s)
+{
+  struct blockvector *bv = BLOCKVECTOR (s);
+  struct block_pc_index *index = s->block_pc_index;
+  struct block_pc_range *ranges;
+  CORE_ADDR *bounds;
+  struct obstack *obstack;
+  int *heap;
+  int nranges, nbounds, nheap, next, i, k;
+  int last;
+
+  if (bv == NULL || s->objfile == NULL)
+    return NULL;
+  if (index != NULL
+      && index->blockvector == bv
+      && index->nblocks == BLOCKVECTOR_NBLOCKS (bv)
+      && index->static_start == BLOCK_START (BLOCKVECTOR_BLOCK (bv,
+								 STATIC_BLOCK)))
+    return index;
+
+  nranges = 0;
+  for (i = FIRST_LOCAL_BLOCK; i < BLOCKVECTOR_NBLOCKS (bv); i++)
+    {
+      struct block *b = BLOCKVECTOR_BLOCK (bv, i);
+
+      nranges += BLOCK_RANGES (b) ? BLOCK_RANGES (b)->nelts : 1;
+    }
+
+  ranges = xmalloc ((nranges + 1) * sizeof (struct block_pc_range));
+  bounds = xmalloc ((2 * nranges + 1) * sizeof (CORE_ADDR));
+  heap = xmalloc ((nranges + 1) * sizeof (int));
+
+  nranges = 0;
+  nbounds = 0;
+  for (i = FIRST_LOCAL_BLOCK; i < BLOCKVECTOR_NBLOCKS (bv); i++)
+    {
+      struct block *b = BLOCKVECTOR_BLOCK (bv, i);
+      int nelts = BLOCK_RANGES (b) ? BLOCK_RANGES (b)->nelts : 1;
+      int j;
+
+      for (j = 0; j < nelts; j++)
+	{
+	  CORE_ADDR start = BLOCK_RANGES (b) ? BLOCK_RANGE_START (b, j)
+	    : BLOCK_START (b);
+	  CORE_ADDR end = BLOCK_RANGES (b) ? BLOCK_RANGE_END (b, j)
+	    : BLOCK_END (b);
+
+	  if (start >= end)
+	    continue;
+	  ranges[nranges].start = start;
+	  ranges[nranges].end = end;
+	  ranges[nranges].block = i;
+	  nranges++;
+	  bounds[nbounds++] = start;
+	  bounds[nbounds++] = end;
+	}
+    }
+
+  qsort (ranges, nranges, sizeof (struct block_pc_range),
+	 compare_block_pc_ranges);
+  qsort (bounds, nbounds, sizeof (CORE_ADDR), compare_core_addrs);
+
+  obstack = &s->objfile->objfile_obstack;
+  index = (struct block_pc_index *)
+    obstack_alloc (obstack, sizeof (struct block_pc_index));
+  index->blockvector = bv;
+  index->nblocks = BLOCKVECTOR_NBLOCKS (bv);
+  index->static_start = BLOCK_START (BLOCKVECTOR_BLOCK (bv, STATIC_BLOCK));
+  index->entries = (struct block_pc_index_entry *)
+    obstack_alloc (obstack,
+		   (nbounds + 1) * sizeof (struct block_pc_index_entry));
+
+  /* Sweep across the range boundaries in address order, keeping the
+     ranges that have started in a heap.  Ranges that have ended are
+     only dropped once they reach the top, which is the only place
+     anyone looks.  */
+
+  index->nentries = 0;
+  nheap = 0;
+  next = 0;
+  last = -2;
+  for (k = 0; k < nbounds; k++)
+    {
+      CORE_ADDR addr = bounds[k];
+      int block;
+
+      if (k > 0 && addr == bounds[k - 1])
+	continue;
+
+      while (next < nranges && ranges[next].start <= addr)
+	block_pc_heap_push (heap, &nheap, ranges, next++);
+      while (nheap > 0 && ranges[heap[0]].end <= addr)
+	block_pc_heap_pop (heap, &nheap, ranges);
+
+      block = nheap > 0 ? ranges[heap[0]].block : -1;
+      if (block != last)
+	{
+	  index->entries[index->nentries].start = addr;
+	  index->entries[index->nentries].block = block;
+	  index->nentries++;
+	  last = block;
+	}
+    }
+
+  xfree (ranges);
+  xfree (bounds);
+  xfree (heap);
+
+  s->block_pc_index = index;
+  return index;
+}
+
+/* Return the position in S's blockvector of the innermost local block
+   containing PC, or -1 if there is none.  */
+
+static int
+block_pc_index_lookup (struct symtab *s, CORE_ADDR pc)
+{
+  struct block_pc_index *index = block_pc_index (s);
+  int low = 0;
+  int high;
+
+  if (index == NULL)
+    return -1;
+
+  /* Find the first interval that starts after PC.  */
+  high = index->nentries;
+  while (low < high)
+    {
+      int mid = low + (high - low) / 2;
+
+      if (index->entries[mid].start <= pc)
+	low = mid + 1;
+      else
+	high = mid;
+    }
+
+  if (low == 0)
+    return -1;
+  return index->entries[low - 1].block;
+}
+/* APPLE LOCAL end block pc index  */
+
 /* Return the blockvector immediately containing the innermost lexical block
    containing the specified pc value and section, or 0 if there is none.
    PINDEX is a pointer to the index value of the block.  If PINDEX
@@ -256,6 +514,24 @@ blockvector_for_pc_sect (CORE_ADDR pc, struct bfd_section *section,
   static_block = BLOCKVECTOR_BLOCK (bl, STATIC_BLOCK);
   b = BLOCKVECTOR_BLOCK (bl, 0);
 
+  /* APPLE LOCAL begin block pc index  */
+  if (symtab->objfile != NULL)
+    {
+      bot = block_pc_index_lookup (symtab, pc);
+      if (bot < 0)
+	{
+	  cached_blockvector_index = -1;
+	  cached_blockvector = NULL;
+	  return 0;
+	}
+      if (pindex)
+	*pindex = bot;
+      cached_blockvector_index = bot;
+      cached_blockvector = bl;
+      return bl;
+    }
+  /* APPLE LOCAL end block pc index  */
+
   /* Then search that symtab for the smallest block that wins.  */
   /* Use binary search to find the last block that starts before PC.  */
 
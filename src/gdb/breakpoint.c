@@ -68,6 +68,9 @@
 #include "mi/mi-common.h"
 /* APPLE LOCAL - subroutine inlining */
 #include "inlining.h"
+/* APPLE LOCAL breakpoint condition bytecode  */
+#include "ax.h"
+#include "ax-gdb.h"
 /* APPLE LOCAL Disable user breakpoints while updating data formatters.  */
 #include "objc-lang.h"
 
@@ -165,6 +168,12 @@ static bpstat bpstat_alloc (struct breakpoint *, bpstat);
 
 static int breakpoint_cond_eval (void *);
 
+/* APPLE LOCAL breakpoint condition bytecode  */
+static void free_cond_bytecode (struct breakpoint *);
+
+/* APPLE LOCAL software watchpoint read plan  */
+static void free_watch_plan (struct breakpoint *);
+
 /* APPLE LOCAL begin exception throw/catch types */
 /* These variables contain the regexp's used in current_exception_should_stop
    to determine whether this is an object throw or catch we are interested
@@ -320,6 +329,16 @@ static int safe_breakpoint_sals_to_pc (struct symtabs_and_lines *sals,
 int symbol_generation = 1;
 int breakpoint_generation = 0;
 
+/* APPLE LOCAL begin incremental breakpoint re-set  */
+/* Non-zero if something has changed since the last breakpoint_update
+   that didn't say which objfile it was, or that changed an objfile
+   without putting it on the restricted search list.  Until then,
+   every change came from breakpoint_re_set on a particular objfile,
+   and a breakpoint scoped to any other shlib can't have been
+   affected.  */
+static int breakpoint_re_set_scoped_all = 1;
+/* APPLE LOCAL end incremental breakpoint re-set  */
+
 /* APPLE LOCAL: Use this variable to quiet the breakpoint setting code
    when RE-SETTING breakpoints.  */
 static int dont_mention = 0;
@@ -359,6 +378,84 @@ Debugger's behavior regarding pending breakpoints is %s.\n"),
 		    value);
 }
 
+/* APPLE LOCAL begin breakpoint always-inserted  */
+/* If non-zero, breakpoints are left in the inferior when it stops, so
+   that resuming only has to insert the ones that changed instead of
+   lifting and re-inserting every one of them.  Memory reads hide the
+   breakpoint instructions while this is on.  */
+static int always_inserted_mode = 0;
+static void
+show_always_inserted_mode (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Always inserted breakpoint mode is %s.\n"),
+		    value);
+}
+
+int
+breakpoints_always_inserted_mode (void)
+{
+  /* APPLE LOCAL non-stop: The threads that are still running need
+     the breakpoints in while the others sit at the prompt.  */
+  return always_inserted_mode || non_stop;
+}
+
+/* APPLE LOCAL begin breakpoint condition bytecode  */
+/* If non-zero, breakpoint conditions that only involve globals,
+   registers and constants are compiled to agent bytecode the first
+   time they are tested, and run from then on without building any
+   values.  */
+static int condition_bytecode = 0;
+static void
+show_condition_bytecode (struct ui_file *file, int from_tty,
+			 struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Compiling breakpoint conditions to bytecode is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end breakpoint condition bytecode  */
+
+/* APPLE LOCAL begin software watchpoint read plan  */
+/* If non-zero, a software watchpoint's expression is compiled to
+   agent bytecode, and running it once records which registers and
+   memory the expression depends on.  After each step, if none of
+   those have changed, watchpoint_check knows the value hasn't either
+   without evaluating the expression.  */
+static int watchpoint_bytecode = 0;
+static void
+show_watchpoint_bytecode (struct ui_file *file, int from_tty,
+			  struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Checking software watchpoints through bytecode is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end software watchpoint read plan  */
+
+/* Zero while the code that inserts and removes breakpoints wants to
+   see what is really in memory, trap instructions and all.  */
+static int breakpoint_shadowing = 1;
+
+int
+set_breakpoint_shadowing (int newval)
+{
+  int oldval = breakpoint_shadowing;
+  breakpoint_shadowing = newval;
+  return oldval;
+}
+
+/* set_breakpoint_shadowing() takes an int but the cleanup func must
+   take a void*, so use this trampoline like set_trust_readonly_cleanup
+   does.  */
+void
+set_breakpoint_shadowing_cleanup (void *new)
+{
+  set_breakpoint_shadowing ((int) new);
+}
+/* APPLE LOCAL end breakpoint always-inserted  */
+
 void _initialize_breakpoint (void);
 
 extern int addressprint;	/* Print machine addresses? */
@@ -399,6 +496,106 @@ struct breakpoint *breakpoint_chain;
 
 struct bp_location *bp_location_chain;
 
+/* APPLE LOCAL begin breakpoint location index  */
+/* The software and hardware breakpoint locations on bp_location_chain,
+   sorted by address.  The "is there a breakpoint at PC" predicates
+   and the shadowing done by deprecated_read_memory_nobpt run on every
+   stop and every memory read, and with thousands of breakpoints set
+   walking the whole chain each time adds up.  The index is rebuilt
+   lazily after a location is added, removed or moved; enabling,
+   disabling, inserting and removing don't change it, since those
+   states are still checked on the locations it finds.  */
+
+static struct bp_location **bp_location_index;
+static int bp_location_index_count;
+static int bp_location_index_size;
+static int bp_location_index_valid;
+
+/* Walk the following statement or block through all software and
+   hardware breakpoint locations whose address is ADDR.  I is an int
+   used as the cursor.  */
+
+#define ALL_BP_LOCATIONS_AT(B,I,ADDR)				\
+	for (I = bp_location_index_lower_bound (ADDR);		\
+	     I < bp_location_index_count			\
+	       && (B = bp_location_index[I])->address == (ADDR);	\
+	     I++)
+
+static void
+invalidate_bp_location_index (void)
+{
+  bp_location_index_valid = 0;
+}
+
+static int
+compare_bp_location_addresses (const void *ap, const void *bp)
+{
+  const struct bp_location *a = *(const struct bp_location **) ap;
+  const struct bp_location *b = *(const struct bp_location **) bp;
+
+  if (a->address < b->address)
+    return -1;
+  if (a->address > b->address)
+    return 1;
+  return 0;
+}
+
+static void
+build_bp_location_index (void)
+{
+  struct bp_location *b;
+  int count = 0;
+
+  ALL_BP_LOCATIONS (b)
+    if (b->loc_type == bp_loc_software_breakpoint
+	|| b->loc_type == bp_loc_hardware_breakpoint)
+      count++;
+
+  if (count > bp_location_index_size)
+    {
+      bp_location_index_size = count;
+      bp_location_index = xrealloc (bp_location_index,
+				    count * sizeof (struct bp_location *));
+    }
+
+  count = 0;
+  ALL_BP_LOCATIONS (b)
+    if (b->loc_type == bp_loc_software_breakpoint
+	|| b->loc_type == bp_loc_hardware_breakpoint)
+      bp_location_index[count++] = b;
+
+  qsort (bp_location_index, count, sizeof (struct bp_location *),
+	 compare_bp_location_addresses);
+  bp_location_index_count = count;
+  bp_location_index_valid = 1;
+}
+
+/* Return the position of the first location in bp_location_index
+   whose address is ADDR or above, rebuilding the index if needed.  */
+
+static int
+bp_location_index_lower_bound (CORE_ADDR addr)
+{
+  int lo, hi;
+
+  if (!bp_location_index_valid)
+    build_bp_location_index ();
+
+  lo = 0;
+  hi = bp_location_index_count;
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      if (bp_location_index[mid]->address < addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+/* APPLE LOCAL end breakpoint location index  */
+
 /* Number of last breakpoint made.  */
 
 int breakpoint_count;
@@ -733,6 +930,8 @@ condition_command_1 (struct breakpoint *b, char *condition, int from_tty)
       xfree (b->cond);
       b->cond = 0;
     }
+  /* APPLE LOCAL breakpoint condition bytecode  */
+  free_cond_bytecode (b);
   if (b->cond_string != NULL)
     xfree (b->cond_string);
   
@@ -866,12 +1065,30 @@ deprecated_read_memory_nobpt (CORE_ADDR memaddr, gdb_byte *myaddr,
   struct bp_location *b;
   CORE_ADDR bp_addr = 0;
   int bp_size = 0;
+  /* APPLE LOCAL begin breakpoint location index  */
+  CORE_ADDR low, high;
+  int i;
+  /* APPLE LOCAL end breakpoint location index  */
 
   if (BREAKPOINT_FROM_PC (&bp_addr, &bp_size) == NULL)
     /* No breakpoints on this machine. */
     return target_read_memory (memaddr, myaddr, len);
 
-  ALL_BP_LOCATIONS (b)
+  /* APPLE LOCAL begin breakpoint location index  */
+  /* Only look at the locations close enough to [MEMADDR, MEMADDR +
+     LEN) to overlap it.  BREAKPOINT_FROM_PC may move the address it
+     is given a little (e.g. to strip a Thumb bit), so allow for a
+     whole breakpoint's worth of slop on either side.  */
+  low = memaddr > BREAKPOINT_MAX ? memaddr - BREAKPOINT_MAX : 0;
+  high = memaddr + len + BREAKPOINT_MAX;
+  if (high < memaddr)
+    high = ~(CORE_ADDR) 0;
+
+  for (i = bp_location_index_lower_bound (low);
+       i < bp_location_index_count
+	 && (b = bp_location_index[i])->address < high;
+       i++)
+  /* APPLE LOCAL end breakpoint location index  */
   {
     if (b->owner->type == bp_none)
       warning (_("reading through apparently deleted breakpoint #%d?"),
@@ -948,6 +1165,137 @@ deprecated_read_memory_nobpt (CORE_ADDR memaddr, gdb_byte *myaddr,
   /* Nothing overlaps.  Just call read_memory_noerr.  */
   return target_read_memory (memaddr, myaddr, len);
 }
+
+/* APPLE LOCAL begin breakpoint always-inserted  */
+/* Visit the inserted software breakpoint locations that overlap
+   [MEMADDR, MEMADDR + LEN), calling FUNC with the location, the
+   breakpoint instruction and the overlapping part of each.  */
+
+static void
+iterate_over_inserted_breakpoint_bytes
+  (CORE_ADDR memaddr, LONGEST len,
+   void (*func) (struct bp_location *, const gdb_byte *bp, CORE_ADDR bp_addr,
+		 CORE_ADDR start, CORE_ADDR end, void *data),
+   void *data)
+{
+  struct bp_location *b;
+  CORE_ADDR low, high;
+  int i;
+
+  low = memaddr > BREAKPOINT_MAX ? memaddr - BREAKPOINT_MAX : 0;
+  high = memaddr + len + BREAKPOINT_MAX;
+  if (high < memaddr)
+    high = ~(CORE_ADDR) 0;
+
+  for (i = bp_location_index_lower_bound (low);
+       i < bp_location_index_count
+	 && (b = bp_location_index[i])->address < high;
+       i++)
+    {
+      const gdb_byte *bp;
+      CORE_ADDR bp_addr, start, end;
+      int bp_size;
+
+      if (b->loc_type != bp_loc_software_breakpoint
+	  || !b->inserted
+	  || b->owner->enable_state == bp_permanent)
+	continue;
+
+      bp_addr = b->address;
+      bp_size = 0;
+      bp = BREAKPOINT_FROM_PC (&bp_addr, &bp_size);
+      if (bp == NULL || bp_size == 0)
+	continue;
+
+      start = max (bp_addr, memaddr);
+      end = min (bp_addr + bp_size, memaddr + len);
+      if (start >= end)
+	continue;
+
+      func (b, bp, bp_addr, start, end, data);
+    }
+}
+
+struct restore_shadows_args
+{
+  gdb_byte *buf;
+  CORE_ADDR memaddr;
+};
+
+static void
+restore_one_shadow (struct bp_location *b, const gdb_byte *bp,
+		    CORE_ADDR bp_addr, CORE_ADDR start, CORE_ADDR end,
+		    void *data)
+{
+  struct restore_shadows_args *args = data;
+  gdb_byte *p = args->buf + (start - args->memaddr);
+
+  /* Targets that insert breakpoints themselves (a remote stub that
+     takes Z0 packets, say) may already hide them from memory reads,
+     and then SHADOW_CONTENTS was never filled in.  Only put the shadow
+     back where we actually see our own trap.  */
+  if (memcmp (p, bp + (start - bp_addr), end - start) != 0)
+    return;
+
+  memcpy (p, b->shadow_contents + (start - bp_addr), end - start);
+}
+
+/* BUF holds LEN bytes just read from MEMADDR.  If breakpoints are
+   being left inserted while the inferior is stopped, replace any of
+   our breakpoint instructions in it with the memory they cover.  */
+
+void
+breakpoint_restore_shadows (gdb_byte *buf, CORE_ADDR memaddr, LONGEST len)
+{
+  struct restore_shadows_args args;
+
+  if (!always_inserted_mode || !breakpoint_shadowing || len <= 0)
+    return;
+
+  args.buf = buf;
+  args.memaddr = memaddr;
+  iterate_over_inserted_breakpoint_bytes (memaddr, len, restore_one_shadow,
+					  &args);
+}
+
+static void
+lift_one_breakpoint (struct bp_location *b, const gdb_byte *bp,
+		     CORE_ADDR bp_addr, CORE_ADDR start, CORE_ADDR end,
+		     void *data)
+{
+  remove_breakpoint (b, mark_uninserted);
+}
+
+/* We are about to write LEN bytes at MEMADDR.  If breakpoints are
+   being left inserted while the inferior is stopped, take out the
+   ones in the way, so that neither the write clobbers them nor their
+   removal later clobbers the write.  insert_breakpoints puts them back
+   on the next resume.  */
+
+void
+remove_breakpoints_overlapping (CORE_ADDR memaddr, LONGEST len)
+{
+  if (!always_inserted_mode || !breakpoint_shadowing || len <= 0)
+    return;
+
+  iterate_over_inserted_breakpoint_bytes (memaddr, len, lift_one_breakpoint,
+					  NULL);
+}
+
+/* Take out the breakpoints inserted at PC, so that the inferior can be
+   stepped over them.  */
+
+void
+remove_breakpoints_at (CORE_ADDR pc)
+{
+  struct bp_location *b;
+  int i;
+
+  ALL_BP_LOCATIONS_AT (b, i, pc)
+    if (b->inserted && b->owner->enable_state != bp_permanent)
+      remove_breakpoint (b, mark_uninserted);
+}
+/* APPLE LOCAL end breakpoint always-inserted  */
 
 
 /* A wrapper function for inserting catchpoints.  */
@@ -1397,7 +1745,16 @@ insert_breakpoints (void)
       /* Permanent breakpoints cannot be inserted or removed.  Disabled
 	 breakpoints should not be inserted.  */
       if (!breakpoint_enabled (b->owner))
-	continue;
+	{
+	  /* APPLE LOCAL begin breakpoint always-inserted  */
+	  /* A breakpoint we left inserted at the last stop may have
+	     been disabled since.  */
+	  if (always_inserted_mode && b->inserted
+	      && b->owner->enable_state != bp_permanent)
+	    remove_breakpoint (b, mark_uninserted);
+	  /* APPLE LOCAL end breakpoint always-inserted  */
+	  continue;
+	}
       
       /* APPLE LOCAL: The watchpoint code will set this to 0 if there's an error.  */
       retval = 1;
@@ -1474,6 +1831,82 @@ You may have requested too many hardware breakpoints/watchpoints.\n");
   return return_val;
 }
 
+/* APPLE LOCAL begin native ignore counts  */
+/* Return non-zero if a thread that just hit the software breakpoint
+   inserted at PC would only have ignore counts run down by
+   bpstat_stop_status, and then be resumed.  That is the case when
+   every enabled breakpoint at PC, duplicates included, is a user
+   breakpoint with no condition, frame or thread restriction and an
+   ignore count left.  If so, count the hit on each of them the way
+   bpstat_stop_status would, so that the target can step the thread
+   over PC and let it go without reporting the stop.  */
+
+int
+breakpoint_count_ignored_hit (CORE_ADDR pc)
+{
+  struct bp_location *bpt;
+  int i;
+  int inserted = 0;
+
+  ALL_BP_LOCATIONS_AT (bpt, i, pc)
+    {
+      struct breakpoint *b = bpt->owner;
+
+      if (b->enable_state == bp_permanent)
+	return 0;
+      if (!breakpoint_enabled (b))
+	continue;
+      if (bpt->loc_type != bp_loc_software_breakpoint
+	  || b->type != bp_breakpoint
+	  || b->cond_string != NULL
+	  || b->thread != -1
+	  || frame_id_p (b->frame_id)
+	  || b->ignore_count <= 0)
+	return 0;
+      if (overlay_debugging
+	  && section_is_overlay (bpt->section)
+	  && !section_is_mapped (bpt->section))
+	return 0;
+      inserted |= bpt->inserted;
+    }
+
+  if (!inserted)
+    return 0;
+
+  ALL_BP_LOCATIONS_AT (bpt, i, pc)
+    if (breakpoint_enabled (bpt->owner))
+      {
+	++(bpt->owner->hit_count);
+	bpt->owner->ignore_count--;
+	annotate_ignore_count_change ();
+      }
+  return 1;
+}
+
+/* Put back the breakpoints at PC that remove_breakpoints_at took
+   out.  */
+
+void
+reinsert_breakpoints_at (CORE_ADDR pc)
+{
+  struct bp_location *b;
+  int i;
+  int disabled_breaks = 0;
+  int hw_breakpoint_error = 0;
+  int process_warning = 0;
+  struct ui_file *tmp_error_stream = mem_fileopen ();
+  struct cleanup *old_chain = make_cleanup_ui_file_delete (tmp_error_stream);
+
+  ALL_BP_LOCATIONS_AT (b, i, pc)
+    if (!b->inserted && breakpoint_enabled (b->owner)
+	&& b->loc_type == bp_loc_software_breakpoint)
+      insert_bp_location (b, tmp_error_stream, &disabled_breaks,
+			  &process_warning, &hw_breakpoint_error);
+
+  do_cleanups (old_chain);
+}
+/* APPLE LOCAL end native ignore counts  */
+
 int
 remove_breakpoints (void)
 {
@@ -1626,6 +2059,8 @@ update_breakpoints_after_exec (void)
 	(b->type == bp_catch_fork))
       {
 	b->loc->address = (CORE_ADDR) 0;
+	/* APPLE LOCAL breakpoint location index  */
+	invalidate_bp_location_index ();
 	continue;
       }
 
@@ -1679,6 +2114,8 @@ update_breakpoints_after_exec (void)
        the breakpoint's address from scratch, or deletes it if it can't.
        So I think this assignment could be deleted without effect.  */
     b->loc->address = (CORE_ADDR) 0;
+    /* APPLE LOCAL breakpoint location index  */
+    invalidate_bp_location_index ();
   }
   /* FIXME what about longjmp breakpoints?  Re-create them here?  */
   create_overlay_event_breakpoint ("_ovly_debug_event");
@@ -1948,6 +2385,8 @@ breakpoint_init_inferior (enum inf_context context)
 	    if (b->val)
 	      value_free (b->val);
 	    b->val = NULL;
+	    /* APPLE LOCAL software watchpoint read plan  */
+	    free_watch_plan (b);
 	  }
 	break;
       default:
@@ -1990,13 +2429,11 @@ breakpoint_here_p (CORE_ADDR pc)
 {
   struct bp_location *bpt;
   int any_breakpoint_here = 0;
+  /* APPLE LOCAL breakpoint location index  */
+  int i;
 
-  ALL_BP_LOCATIONS (bpt)
+  ALL_BP_LOCATIONS_AT (bpt, i, pc)
     {
-      if (bpt->loc_type != bp_loc_software_breakpoint
-	  && bpt->loc_type != bp_loc_hardware_breakpoint)
-	continue;
-
       if ((breakpoint_enabled (bpt->owner)
 	   || bpt->owner->enable_state == bp_permanent)
 	  && bpt->address == pc)	/* bp is enabled and matches pc */
@@ -2024,13 +2461,11 @@ int
 breakpoint_inserted_here_p (CORE_ADDR pc)
 {
   struct bp_location *bpt;
+  /* APPLE LOCAL breakpoint location index  */
+  int i;
 
-  ALL_BP_LOCATIONS (bpt)
+  ALL_BP_LOCATIONS_AT (bpt, i, pc)
     {
-      if (bpt->loc_type != bp_loc_software_breakpoint
-	  && bpt->loc_type != bp_loc_hardware_breakpoint)
-	continue;
-
       if (bpt->inserted
 	  && bpt->address == pc)	/* bp is inserted and matches pc */
 	{
@@ -2054,8 +2489,10 @@ software_breakpoint_inserted_here_p (CORE_ADDR pc)
 {
   struct bp_location *bpt;
   /* APPLE LOCAL remove unused local var */
+  /* APPLE LOCAL breakpoint location index  */
+  int i;
 
-  ALL_BP_LOCATIONS (bpt)
+  ALL_BP_LOCATIONS_AT (bpt, i, pc)
     {
       if (bpt->loc_type != bp_loc_software_breakpoint)
 	continue;
@@ -2085,15 +2522,13 @@ breakpoint_thread_match (CORE_ADDR pc, ptid_t ptid)
 {
   struct bp_location *bpt;
   int thread;
+  /* APPLE LOCAL breakpoint location index  */
+  int i;
 
   thread = pid_to_thread_id (ptid);
 
-  ALL_BP_LOCATIONS (bpt)
+  ALL_BP_LOCATIONS_AT (bpt, i, pc)
     {
-      if (bpt->loc_type != bp_loc_software_breakpoint
-	  && bpt->loc_type != bp_loc_hardware_breakpoint)
-	continue;
-
       if ((breakpoint_enabled (bpt->owner)
 	   || bpt->owner->enable_state == bp_permanent)
 	  && bpt->address == pc
@@ -2850,6 +3285,370 @@ breakpoint_cond_eval (void *exp)
   return i;
 }
 
+/* APPLE LOCAL begin breakpoint condition bytecode  */
+/* Throw away B's compiled condition, because B->cond is changing.  */
+
+static void
+free_cond_bytecode (struct breakpoint *b)
+{
+  if (b->cond_bytecode != NULL)
+    free_agent_expr (b->cond_bytecode);
+  b->cond_bytecode = NULL;
+  b->cond_bytecode_failed = 0;
+}
+
+static ULONGEST
+cond_bytecode_fetch_register (void *data, int regnum)
+{
+  struct frame_info *frame = data;
+
+  if (regnum < 0 || regnum >= NUM_REGS + NUM_PSEUDO_REGS)
+    error (_("Register %d is out of range."), regnum);
+  return get_frame_register_unsigned (frame, regnum);
+}
+
+static ULONGEST
+cond_bytecode_fetch_memory (void *data, CORE_ADDR addr, int len)
+{
+  return read_memory_unsigned_integer (addr, len);
+}
+
+static const struct agent_eval_ops cond_bytecode_ops =
+{
+  cond_bytecode_fetch_register,
+  cond_bytecode_fetch_memory
+};
+
+/* Try to test B's condition, already parsed into B->cond, by running
+   its compiled bytecode in the selected frame.  Return non-zero and
+   set *VALUE_IS_ZERO if that worked.  Return zero if the condition
+   can't be compiled or the bytecode ran into trouble (an unreadable
+   address, say); the caller should then evaluate B->cond as usual,
+   which also gets the user a proper error message.  */
+
+static int
+breakpoint_cond_bytecode_eval (struct breakpoint *b, int *value_is_zero)
+{
+  volatile struct gdb_exception e;
+  LONGEST result = 0;
+
+  if (!condition_bytecode || b->cond == NULL)
+    return 0;
+
+  if (b->cond_bytecode == NULL)
+    {
+      struct agent_expr *ax = NULL;
+
+      if (b->cond_bytecode_failed)
+	return 0;
+      TRY_CATCH (e, RETURN_MASK_ERROR)
+	{
+	  ax = gen_eval_for_expr (b->loc ? b->loc->address : 0, b->cond);
+	}
+      if (e.reason < 0)
+	{
+	  b->cond_bytecode_failed = 1;
+	  return 0;
+	}
+      b->cond_bytecode = ax;
+    }
+
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    {
+      result = ax_eval (b->cond_bytecode, &cond_bytecode_ops,
+			get_selected_frame (NULL));
+    }
+  if (e.reason < 0)
+    return 0;
+
+  *value_is_zero = (result == 0);
+  return 1;
+}
+/* APPLE LOCAL end breakpoint condition bytecode  */
+
+/* APPLE LOCAL begin software watchpoint read plan  */
+/* The most registers and memory reads a plan will keep track of.
+   Expressions that need more are evaluated the usual way.  */
+#define WATCH_PLAN_MAX_REGS 8
+#define WATCH_PLAN_MAX_READS 32
+
+/* Reads no further apart than this within one page are done as one.  */
+#define WATCH_PLAN_READ_GAP 32
+#define WATCH_PLAN_PAGE_SIZE 4096
+
+struct watch_plan_range
+{
+  CORE_ADDR addr;
+  int len;
+};
+
+struct watch_plan
+{
+  /* The watchpoint's expression compiled to bytecode, or NULL.  */
+  struct agent_expr *ax;
+
+  /* Non-zero if the expression can't be compiled, or reads more than
+     we are willing to keep track of.  */
+  int failed;
+
+  /* Non-zero if the registers and ranges below describe the
+     breakpoint's current value.  */
+  int valid;
+
+  /* The thread the plan was recorded in.  */
+  ptid_t ptid;
+
+  int nregs;
+  int regs[WATCH_PLAN_MAX_REGS];
+  ULONGEST reg_values[WATCH_PLAN_MAX_REGS];
+
+  /* The memory the expression read, sorted and merged, and the bytes
+     it held, laid end to end.  */
+  int nranges;
+  struct watch_plan_range ranges[WATCH_PLAN_MAX_READS];
+  gdb_byte *bytes;
+  int nbytes;
+};
+
+/* Where watch_plan_record collects the reads of one bytecode run.  */
+
+struct watch_plan_recording
+{
+  struct watch_plan *plan;
+  struct frame_info *frame;
+  int overflow;
+};
+
+static void
+free_watch_plan (struct breakpoint *b)
+{
+  if (b->watch_plan == NULL)
+    return;
+  if (b->watch_plan->ax != NULL)
+    free_agent_expr (b->watch_plan->ax);
+  xfree (b->watch_plan->bytes);
+  xfree (b->watch_plan);
+  b->watch_plan = NULL;
+}
+
+static ULONGEST
+watch_plan_fetch_register (void *data, int regnum)
+{
+  struct watch_plan_recording *rec = data;
+  struct watch_plan *plan = rec->plan;
+  ULONGEST value;
+  int i;
+
+  value = cond_bytecode_fetch_register (rec->frame, regnum);
+  for (i = 0; i < plan->nregs; i++)
+    if (plan->regs[i] == regnum)
+      return value;
+  if (plan->nregs == WATCH_PLAN_MAX_REGS)
+    rec->overflow = 1;
+  else
+    {
+      plan->regs[plan->nregs] = regnum;
+      plan->reg_values[plan->nregs] = value;
+      plan->nregs++;
+    }
+  return value;
+}
+
+static ULONGEST
+watch_plan_fetch_memory (void *data, CORE_ADDR addr, int len)
+{
+  struct watch_plan_recording *rec = data;
+  struct watch_plan *plan = rec->plan;
+
+  if (plan->nranges == WATCH_PLAN_MAX_READS)
+    rec->overflow = 1;
+  else
+    {
+      plan->ranges[plan->nranges].addr = addr;
+      plan->ranges[plan->nranges].len = len;
+      plan->nranges++;
+    }
+  return read_memory_unsigned_integer (addr, len);
+}
+
+static const struct agent_eval_ops watch_plan_ops =
+{
+  watch_plan_fetch_register,
+  watch_plan_fetch_memory
+};
+
+static int
+watch_plan_compare_ranges (const void *a, const void *b)
+{
+  const struct watch_plan_range *ra = a;
+  const struct watch_plan_range *rb = b;
+
+  if (ra->addr < rb->addr)
+    return -1;
+  return ra->addr > rb->addr;
+}
+
+/* Sort PLAN's ranges and merge those that overlap, touch, or lie
+   close together on the same page, so that each is read once.  */
+
+static void
+watch_plan_merge_ranges (struct watch_plan *plan)
+{
+  int i, n;
+
+  if (plan->nranges == 0)
+    return;
+
+  qsort (plan->ranges, plan->nranges, sizeof (plan->ranges[0]),
+	 watch_plan_compare_ranges);
+
+  n = 0;
+  for (i = 1; i < plan->nranges; i++)
+    {
+      struct watch_plan_range *last = &plan->ranges[n];
+      CORE_ADDR last_end = last->addr + last->len;
+      CORE_ADDR end = plan->ranges[i].addr + plan->ranges[i].len;
+
+      if (plan->ranges[i].addr <= last_end + WATCH_PLAN_READ_GAP
+	  && (plan->ranges[i].addr <= last_end
+	      || last->addr / WATCH_PLAN_PAGE_SIZE
+		 == (end - 1) / WATCH_PLAN_PAGE_SIZE))
+	{
+	  if (end > last_end)
+	    last->len = end - last->addr;
+	}
+      else
+	plan->ranges[++n] = plan->ranges[i];
+    }
+  plan->nranges = n + 1;
+}
+
+/* Read PLAN's ranges into BUF, which holds PLAN->nbytes bytes.
+   Return zero if any of them can't be read.  */
+
+static int
+watch_plan_read (struct watch_plan *plan, gdb_byte *buf)
+{
+  int i;
+
+  for (i = 0; i < plan->nranges; i++)
+    {
+      if (target_read_memory (plan->ranges[i].addr, buf,
+			      plan->ranges[i].len) != 0)
+	return 0;
+      buf += plan->ranges[i].len;
+    }
+  return 1;
+}
+
+/* B's value has just been computed in the selected frame.  Run its
+   expression's bytecode over the same state to find out what it read,
+   and remember that along with the bytes found there.  */
+
+static void
+watch_plan_record (struct breakpoint *b)
+{
+  volatile struct gdb_exception e;
+  struct watch_plan_recording rec;
+  struct watch_plan *plan;
+  int i;
+
+  if (!watchpoint_bytecode || b->type != bp_watchpoint)
+    return;
+
+  if (b->watch_plan == NULL)
+    b->watch_plan = XZALLOC (struct watch_plan);
+  plan = b->watch_plan;
+  plan->valid = 0;
+  if (plan->failed)
+    return;
+
+  if (plan->ax == NULL)
+    {
+      struct agent_expr *ax = NULL;
+
+      TRY_CATCH (e, RETURN_MASK_ERROR)
+	{
+	  ax = gen_eval_for_expr (get_frame_pc (get_selected_frame (NULL)),
+				  b->exp);
+	}
+      if (e.reason < 0)
+	{
+	  plan->failed = 1;
+	  return;
+	}
+      plan->ax = ax;
+    }
+
+  plan->nregs = 0;
+  plan->nranges = 0;
+  rec.plan = plan;
+  rec.frame = get_selected_frame (NULL);
+  rec.overflow = 0;
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    {
+      ax_eval (plan->ax, &watch_plan_ops, &rec);
+    }
+  if (e.reason < 0)
+    return;
+  if (rec.overflow)
+    {
+      plan->failed = 1;
+      return;
+    }
+
+  watch_plan_merge_ranges (plan);
+  plan->nbytes = 0;
+  for (i = 0; i < plan->nranges; i++)
+    plan->nbytes += plan->ranges[i].len;
+  plan->bytes = xrealloc (plan->bytes, plan->nbytes > 0 ? plan->nbytes : 1);
+  if (!watch_plan_read (plan, plan->bytes))
+    return;
+
+  plan->ptid = inferior_ptid;
+  plan->valid = 1;
+}
+
+/* Return non-zero if every register and byte of memory B's expression
+   read when its value was last computed still holds what it did then,
+   so that the value can't have changed.  */
+
+static int
+watch_plan_unchanged (struct breakpoint *b)
+{
+  struct watch_plan *plan = b->watch_plan;
+  struct frame_info *frame;
+  gdb_byte *buf;
+  int i, same;
+
+  if (!watchpoint_bytecode || plan == NULL || !plan->valid
+      || !ptid_equal (plan->ptid, inferior_ptid))
+    return 0;
+
+  frame = get_selected_frame (NULL);
+  for (i = 0; i < plan->nregs; i++)
+    {
+      volatile struct gdb_exception e;
+      ULONGEST value = 0;
+
+      TRY_CATCH (e, RETURN_MASK_ERROR)
+	{
+	  value = cond_bytecode_fetch_register (frame, plan->regs[i]);
+	}
+      if (e.reason < 0 || value != plan->reg_values[i])
+	return 0;
+    }
+
+  if (plan->nbytes == 0)
+    return 1;
+
+  buf = alloca (plan->nbytes);
+  same = watch_plan_read (plan, buf)
+	 && memcmp (buf, plan->bytes, plan->nbytes) == 0;
+  return same;
+}
+/* APPLE LOCAL end software watchpoint read plan  */
+
 /* Allocate a new bpstat and chain it to the current one.  */
 
 static bpstat
@@ -2963,8 +3762,15 @@ watchpoint_check (void *p)
 	 we haven't successfully inserted the watchpoint yet.  */
       if (b->val)
 	{
-	  struct value *mark = value_mark ();
-	  struct value *new_val = evaluate_expression (bs->breakpoint_at->exp);
+	  struct value *mark;
+	  struct value *new_val;
+
+	  /* APPLE LOCAL software watchpoint read plan  */
+	  if (watch_plan_unchanged (b))
+	    return WP_VALUE_NOT_CHANGED;
+
+	  mark = value_mark ();
+	  new_val = evaluate_expression (bs->breakpoint_at->exp);
 	  /* APPLE LOCAL watchpoint comparison */
 	  
 	  if (!watchpoint_equal (b->val, new_val))
@@ -2973,6 +3779,8 @@ watchpoint_check (void *p)
 	      value_free_to_mark (mark);
 	      bs->old_val = b->val;
 	      b->val = new_val;
+	      /* APPLE LOCAL software watchpoint read plan  */
+	      watch_plan_record (b);
 	      /* We will stop here */
 	      return WP_VALUE_CHANGED;
 	    }
@@ -2980,6 +3788,8 @@ watchpoint_check (void *p)
 	    {
 	      /* Nothing changed, don't do anything.  */
 	      value_free_to_mark (mark);
+	      /* APPLE LOCAL software watchpoint read plan  */
+	      watch_plan_record (b);
 	      /* We won't stop here */
 	      return WP_VALUE_NOT_CHANGED;
 	    }
@@ -3408,7 +4218,10 @@ bpstat_stop_status (CORE_ADDR bp_addr, ptid_t ptid, int stopped_by_watchpoint)
 						   0, &(b->cond));
               }
 	    
-            if (parse_succeeded)
+            /* APPLE LOCAL begin breakpoint condition bytecode  */
+            if (parse_succeeded
+		&& !breakpoint_cond_bytecode_eval (b, &value_is_zero))
+            /* APPLE LOCAL end breakpoint condition bytecode  */
               {
 		value_is_zero
 		  = catch_errors (breakpoint_cond_eval, (b->cond),
@@ -4708,6 +5521,9 @@ allocate_bp_location (struct breakpoint *bpt, enum bptype bp_type)
 
   /* Add this breakpoint to the end of the chain.  */
 
+  /* APPLE LOCAL breakpoint location index  */
+  invalidate_bp_location_index ();
+
   loc_p = bp_location_chain;
   if (loc_p == 0)
     bp_location_chain = loc;
@@ -4779,6 +5595,8 @@ set_raw_breakpoint (struct symtab_and_line sal, enum bptype bptype, int pending_
   b->loc->requested_address = sal.pc;
   b->loc->address = adjust_breakpoint_address (b->loc->requested_address,
                                                bptype);
+  /* APPLE LOCAL breakpoint location index  */
+  invalidate_bp_location_index ();
   if (sal.symtab == NULL)
     b->source_file = NULL;
   else
@@ -5254,6 +6072,31 @@ re_enable_breakpoints_in_shlibs (int silent)
   }
 }
 
+/* APPLE LOCAL begin coalesced dyld notifications  */
+/* Return 1 if some breakpoint is still waiting for a shared library
+   to be loaded: a pending breakpoint, one disabled because its library
+   went away, or a load/unload catchpoint.  The dyld code won't put off
+   reading newly loaded libraries while any of these exist.  */
+
+int
+breakpoints_waiting_for_shlibs (void)
+{
+  struct breakpoint *b;
+
+  ALL_BREAKPOINTS (b)
+  {
+    if (b->enable_state == bp_shlib_disabled)
+      return 1;
+    if (b->enable_state == bp_enabled
+	&& (b->pending
+	    || b->type == bp_catch_load
+	    || b->type == bp_catch_unload))
+      return 1;
+  }
+  return 0;
+}
+/* APPLE LOCAL end coalesced dyld notifications  */
+
 static void
 solib_load_unload_1 (char *hookname, int tempflag, char *dll_pathname,
 		     char *cond_string, enum bptype bp_kind)
@@ -5487,9 +6330,14 @@ set_longjmp_resume_breakpoint (CORE_ADDR pc, struct frame_id frame_id)
   ALL_BREAKPOINTS (b)
     if (b->type == bp_longjmp_resume)
     {
+      /* APPLE LOCAL breakpoint always-inserted  */
+      if (b->loc->inserted)
+	remove_breakpoint (b->loc, mark_uninserted);
       b->loc->requested_address = pc;
       b->loc->address = adjust_breakpoint_address (b->loc->requested_address,
                                                    b->type);
+      /* APPLE LOCAL breakpoint location index  */
+      invalidate_bp_location_index ();
       b->enable_state = bp_enabled;
       b->frame_id = frame_id;
       check_duplicates (b);
@@ -6239,6 +7087,8 @@ create_breakpoints (struct symtabs_and_lines sals, char **addr_string,
 			xfree (b->cond);
 			b->cond = NULL;
 		      }
+		    /* APPLE LOCAL breakpoint condition bytecode  */
+		    free_cond_bytecode (b);
 		    if (!parse_succeeded)
 		      warning ("Error parsing breakpoint condition expression");
 		    else if (*arg)
@@ -7622,6 +8472,8 @@ watch_command_1 (char *arg, int accessflag, int by_location, int from_tty)
 	  scope_breakpoint->loc->address
 	    = adjust_breakpoint_address (scope_breakpoint->loc->requested_address,
 	                                 scope_breakpoint->type);
+	  /* APPLE LOCAL breakpoint location index  */
+	  invalidate_bp_location_index ();
 
 	  /* The scope breakpoint is related to the watchpoint.  We
 	     will need to act on them together.  */
@@ -9025,6 +9877,9 @@ delete_breakpoint (struct breakpoint *bpt)
   if (bp_location_chain == bpt->loc)
     bp_location_chain = bpt->loc->next;
 
+  /* APPLE LOCAL breakpoint location index  */
+  invalidate_bp_location_index ();
+
   /* If we have callback-style exception catchpoints, don't go through
      the adjustments to the C++ runtime library etc. if the inferior
      isn't actually running.  target_enable_exception_callback for a
@@ -9135,6 +9990,8 @@ delete_breakpoint (struct breakpoint *bpt)
   free_command_lines (&bpt->commands);
   if (bpt->cond)
     xfree (bpt->cond);
+  /* APPLE LOCAL breakpoint condition bytecode  */
+  free_cond_bytecode (bpt);
   if (bpt->cond_string != NULL)
     xfree (bpt->cond_string);
   if (bpt->addr_string != NULL)
@@ -9145,6 +10002,8 @@ delete_breakpoint (struct breakpoint *bpt)
     xfree (bpt->exp_string);
   if (bpt->val != NULL)
     value_free (bpt->val);
+  /* APPLE LOCAL software watchpoint read plan  */
+  free_watch_plan (bpt);
   if (bpt->source_file != NULL)
     xfree (bpt->source_file);
   if (bpt->dll_pathname != NULL)
@@ -9531,6 +10390,8 @@ breakpoint_re_set_one (void *bint)
 		     to parse_exp_1.  */
 		  b->cond = NULL;
 		}
+	      /* APPLE LOCAL breakpoint condition bytecode  */
+	      free_cond_bytecode (b);
 	      /* APPLE LOCAL begin don't reparse cond */
 	      /* Nulling the cond is OK, since it might contain
 		 references to the old symtab.  But DON'T try to
@@ -9595,10 +10456,16 @@ breakpoint_re_set_one (void *bint)
 		  savestring (sals.sals[i].symtab->filename,
 			      strlen (sals.sals[i].symtab->filename));
 	      b->line_number = sals.sals[i].line;
+	      /* APPLE LOCAL breakpoint always-inserted: Don't strand the
+		 trap at the old address.  */
+	      if (b->loc->inserted)
+		remove_breakpoint (b->loc, mark_uninserted);
 	      b->loc->requested_address = sals.sals[i].pc;
 	      b->loc->address
 	        = adjust_breakpoint_address (b->loc->requested_address,
 		                             b->type);
+	      /* APPLE LOCAL breakpoint location index  */
+	      invalidate_bp_location_index ();
 
 	      /* Used to check for duplicates here, but that can
 	         cause trouble, as it doesn't check for disabled
@@ -9670,6 +10537,8 @@ breakpoint_re_set_one (void *bint)
       if (b->exp)
         xfree (b->exp);
       b->exp = s_exp;
+      /* APPLE LOCAL software watchpoint read plan  */
+      free_watch_plan (b);
       /* APPLE LOCAL end delete global watchpoints */
 
       b->exp_valid_block = innermost_block;
@@ -9696,6 +10565,8 @@ breakpoint_re_set_one (void *bint)
 		 to parse_exp_1.  */
 	      b->cond = NULL;
 	    }
+	  /* APPLE LOCAL breakpoint condition bytecode  */
+	  free_cond_bytecode (b);
 	  b->cond = parse_exp_1 (&s, (struct block *) 0, 0);
 	}
       if (breakpoint_enabled (b))
@@ -9778,6 +10649,8 @@ breakpoint_update ()
       do_cleanups (old_cleanups);
             
       breakpoint_generation = symbol_generation;
+      /* APPLE LOCAL incremental breakpoint re-set  */
+      breakpoint_re_set_scoped_all = 0;
     } 
   else
     {
@@ -9844,9 +10717,36 @@ breakpoint_re_set (struct objfile *objfile)
     {
       objfile_add_to_restrict_list (objfile);
     }
+  /* APPLE LOCAL incremental breakpoint re-set  */
+  else
+    breakpoint_re_set_scoped_all = 1;
   symbol_generation++;
 }
 
+/* APPLE LOCAL begin incremental breakpoint re-set  */
+/* Return zero if B is scoped to a shlib that none of the changes
+   since the last breakpoint_update can have touched, so that
+   re-setting it again would just fail the way it did last time.  */
+
+static int
+breakpoint_scope_changed (struct breakpoint *b)
+{
+  char *name;
+
+  if (breakpoint_re_set_scoped_all)
+    return 1;
+
+  if (b->requested_shlib != NULL)
+    name = b->requested_shlib;
+  else if (b->bp_objfile_name != NULL)
+    name = b->bp_objfile_name;
+  else
+    return 1;
+
+  return objfile_restrict_list_matches_name (name) != 0;
+}
+/* APPLE LOCAL end incremental breakpoint re-set  */
+
 /* Re-set all breakpoints after symbols have been re-loaded.  */
 
 static void
@@ -9893,6 +10793,18 @@ breakpoint_re_set_all (void)
 
     cleanups = make_cleanup (xfree, message);
 
+    /* APPLE LOCAL begin incremental breakpoint re-set  */
+    /* breakpoint_re_set_one searches a scoped breakpoint's own shlib
+       rather than just the objfiles that changed, so when a plugin is
+       loaded, don't have every breakpoint scoped to some other shlib
+       look itself up again.  */
+    if (!breakpoint_scope_changed (b))
+      {
+	do_cleanups (cleanups);
+	continue;
+      }
+    /* APPLE LOCAL end incremental breakpoint re-set  */
+
     /* APPLE LOCAL: All breakpoint setting respects the objfile_list.  */
     /* APPLE LOCAL begin subroutine inlining  */
     if (b->type == bp_breakpoint || b->type == bp_inlined_breakpoint)
@@ -10196,6 +11108,8 @@ is valid is not currently in scope.\n"), bpt->number);
 	    }
 	  
 	  value_free (bpt->val);
+	  /* APPLE LOCAL software watchpoint read plan  */
+	  free_watch_plan (bpt);
 	  mark = value_mark ();
 	  bpt->val = evaluate_expression (bpt->exp);
 	  release_value (bpt->val);
@@ -10710,6 +11624,8 @@ tell_breakpoints_objfile_changed_internal (struct objfile *objfile,
 	b->bp_set_state = bp_state_unset;
     }
   breakpoint_generation--;
+  /* APPLE LOCAL incremental breakpoint re-set  */
+  breakpoint_re_set_scoped_all = 1;
 }
 
 /* This one sets the breakpoint as unset, but doesn't mark
@@ -11177,4 +12093,53 @@ user-query to see if a pending breakpoint should be created."),
 				&breakpoint_show_cmdlist);
 
   pending_break_support = AUTO_BOOLEAN_AUTO;
+
+  /* APPLE LOCAL begin breakpoint always-inserted  */
+  add_setshow_boolean_cmd ("always-inserted", class_support,
+			   &always_inserted_mode, _("\
+Set mode for inserting breakpoints."), _("\
+Show mode for inserting breakpoints."), _("\
+When this mode is off (which is the default), breakpoints are inserted\n\
+when the inferior is resumed and removed when it stops.  When this mode\n\
+is on, breakpoints stay inserted while the inferior is stopped, and only\n\
+the ones that were added, moved or disabled are touched on the next\n\
+resume.  This saves a round trip per breakpoint on every stop when\n\
+debugging remotely with many breakpoints set."),
+			   NULL,
+			   show_always_inserted_mode,
+			   &breakpoint_set_cmdlist,
+			   &breakpoint_show_cmdlist);
+  /* APPLE LOCAL end breakpoint always-inserted  */
+
+  /* APPLE LOCAL begin breakpoint condition bytecode  */
+  add_setshow_boolean_cmd ("condition-bytecode", class_support,
+			   &condition_bytecode, _("\
+Set compiling of breakpoint conditions to bytecode."), _("\
+Show compiling of breakpoint conditions to bytecode."), _("\
+When on, a breakpoint condition that only refers to global variables,\n\
+registers and constants is compiled to agent bytecode the first time\n\
+it is tested, and the bytecode is run on each later hit instead of\n\
+evaluating the expression.  Conditions that can't be compiled, and\n\
+bytecode that fails to run, are evaluated the usual way."),
+			   NULL,
+			   show_condition_bytecode,
+			   &breakpoint_set_cmdlist,
+			   &breakpoint_show_cmdlist);
+  /* APPLE LOCAL end breakpoint condition bytecode  */
+
+  /* APPLE LOCAL begin software watchpoint read plan  */
+  add_setshow_boolean_cmd ("watchpoint-bytecode", class_support,
+			   &watchpoint_bytecode, _("\
+Set checking of software watchpoints through bytecode."), _("\
+Show checking of software watchpoints through bytecode."), _("\
+When on, a software watchpoint's expression is compiled to agent bytecode,\n\
+and running it records the registers and memory the expression reads.\n\
+After each step GDB rereads just those, and only evaluates the expression\n\
+again if one of them has changed.  Expressions that can't be compiled are\n\
+evaluated after every step as usual."),
+			   NULL,
+			   show_watchpoint_bytecode,
+			   &breakpoint_set_cmdlist,
+			   &breakpoint_show_cmdlist);
+  /* APPLE LOCAL end software watchpoint read plan  */
 }
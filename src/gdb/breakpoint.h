@@ -30,6 +30,10 @@
 
 struct value;
 struct block;
+/* APPLE LOCAL breakpoint condition bytecode  */
+struct agent_expr;
+/* APPLE LOCAL software watchpoint read plan  */
+struct watch_plan;
 
 /* This is the maximum number of bytes a breakpoint instruction can take.
    Feel free to increase it.  It's just used in a few places to size
@@ -355,6 +359,14 @@ struct breakpoint
     struct frame_id frame_id;
     /* Conditional.  Break only if this expression's value is nonzero.  */
     struct expression *cond;
+    /* APPLE LOCAL begin breakpoint condition bytecode  */
+    /* COND compiled to agent bytecode, or NULL if it hasn't been
+       compiled yet.  Freed whenever COND is.  */
+    struct agent_expr *cond_bytecode;
+    /* Non-zero if COND couldn't be compiled, so it is always
+       evaluated with evaluate_expression.  */
+    int cond_bytecode_failed;
+    /* APPLE LOCAL end breakpoint condition bytecode  */
 
     /* String we used to set the breakpoint (malloc'd).  */
     char *addr_string;
@@ -379,6 +391,13 @@ struct breakpoint
     /* Holds the value chain for a hardware watchpoint expression.  */
     struct value *val_chain;
 
+    /* APPLE LOCAL begin software watchpoint read plan  */
+    /* For a software watchpoint, the registers and memory its
+       expression read when VAL was computed, or NULL.  Freed whenever
+       EXP or VAL is replaced.  */
+    struct watch_plan *watch_plan;
+    /* APPLE LOCAL end software watchpoint read plan  */
+
     /* Holds the address of the related watchpoint_scope breakpoint
        when using watchpoints on local variables (might the concept
        of a related breakpoint be useful elsewhere, if not just call
@@ -748,6 +767,42 @@ extern int insert_breakpoints (void);
 
 extern int remove_breakpoints (void);
 
+/* APPLE LOCAL begin breakpoint always-inserted  */
+/* Non-zero if "set breakpoint always-inserted" is on, i.e. breakpoints
+   are left in the inferior while it is stopped.  */
+extern int breakpoints_always_inserted_mode (void);
+
+/* Take out the breakpoints inserted at PC.  */
+extern void remove_breakpoints_at (CORE_ADDR pc);
+/* APPLE LOCAL end breakpoint always-inserted  */
+
+/* APPLE LOCAL begin native ignore counts  */
+/* If the breakpoints at PC would only count down their ignore counts
+   on a hit, count the hit and return non-zero.  */
+extern int breakpoint_count_ignored_hit (CORE_ADDR pc);
+
+/* Put back the breakpoints remove_breakpoints_at took out of PC.  */
+extern void reinsert_breakpoints_at (CORE_ADDR pc);
+/* APPLE LOCAL end native ignore counts  */
+
+/* APPLE LOCAL begin breakpoint always-inserted  */
+
+/* Take out the software breakpoints overlapping [MEMADDR, MEMADDR +
+   LEN) before it is written.  Only does anything in always-inserted
+   mode.  */
+extern void remove_breakpoints_overlapping (CORE_ADDR memaddr, LONGEST len);
+
+/* Hide inserted software breakpoints from the LEN bytes at BUF just
+   read from MEMADDR.  Only does anything in always-inserted mode.  */
+extern void breakpoint_restore_shadows (gdb_byte *buf, CORE_ADDR memaddr,
+					LONGEST len);
+
+/* Turn the two functions above on or off, returning the old setting.
+   The breakpoint insertion code turns them off to see real memory.  */
+extern int set_breakpoint_shadowing (int newval);
+extern void set_breakpoint_shadowing_cleanup (void *new);
+/* APPLE LOCAL end breakpoint always-inserted  */
+
 /* This function can be used to physically insert eventpoints from the
    specified traced inferior process, without modifying the breakpoint
    package's state.  This can be useful for those targets which support
@@ -855,6 +910,9 @@ extern void disable_breakpoints_in_shlibs (int silent);
 /* APPLE LOCAL breakpoints */
 extern void re_enable_breakpoints_in_shlibs (int silent);
 
+/* APPLE LOCAL coalesced dyld notifications  */
+extern int breakpoints_waiting_for_shlibs (void);
+
 extern void create_solib_load_event_breakpoint (char *, int, char *, char *);
 
 extern void create_solib_unload_event_breakpoint (char *, int,
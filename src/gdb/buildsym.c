@@ -200,6 +200,8 @@ really_free_pendings (void *dummy)
 
   if (pending_macros)
     free_macro_table (pending_macros);
+  /* APPLE LOCAL lazy macro tables  */
+  pending_lazy_macro_table = NULL;
 }
 
 /* This function is called to discard any pending blocks. */
@@ -236,7 +238,9 @@ free_pending_blocks (void)
    is all contained within a single contiguous address range), RANGES
    should just be NULL.  */
 
-void
+/* APPLE LOCAL: Return the new block.  */
+
+struct block *
 finish_block (struct symbol *symbol, struct pending **listhead,
 	      struct pending_block *old_blocks, 
 	      CORE_ADDR start, CORE_ADDR end, 
@@ -530,6 +534,8 @@ finish_block (struct symbol *symbol, struct pending **listhead,
     }
 
   record_pending_block (objfile, block, opblock);
+
+  return block;
 }
 
 
@@ -1043,7 +1049,9 @@ end_symtab (CORE_ADDR end_addr, struct objfile *objfile, int section)
       && file_symbols == NULL
       && global_symbols == NULL
       && have_line_numbers == 0
-      && pending_macros == NULL)
+      && pending_macros == NULL
+      /* APPLE LOCAL lazy macro tables  */
+      && pending_lazy_macro_table == NULL)
     {
       /* Ignore symtabs that have no functions with real debugging
          info.  */
@@ -1109,6 +1117,8 @@ end_symtab (CORE_ADDR end_addr, struct objfile *objfile, int section)
 	  /* Fill in its components.  */
 	  symtab->blockvector = blockvector;
           symtab->macro_table = pending_macros;
+	  /* APPLE LOCAL lazy macro tables  */
+	  symtab->lazy_macro_table = pending_lazy_macro_table;
 	  if (subfile->line_vector)
 	    {
 	      /* Reallocate the line table on the symbol obstack */
@@ -1196,6 +1206,8 @@ end_symtab (CORE_ADDR end_addr, struct objfile *objfile, int section)
   last_source_file = NULL;
   current_subfile = NULL;
   pending_macros = NULL;
+  /* APPLE LOCAL lazy macro tables  */
+  pending_lazy_macro_table = NULL;
 
   return symtab;
 }
@@ -1309,6 +1321,8 @@ buildsym_init (void)
   global_symbols = NULL;
   pending_blocks = NULL;
   pending_macros = NULL;
+  /* APPLE LOCAL lazy macro tables  */
+  pending_lazy_macro_table = NULL;
 }
 
 /* Initialize anything that needs initializing when a completely new
@@ -237,12 +237,12 @@ extern struct symbol *find_symbol_in_list (struct pending *list,
 					   char *name, int length);
 
 /* APPLE LOCAL begin address ranges  */
-extern void finish_block (struct symbol *symbol,
-			  struct pending **listhead,
-			  struct pending_block *old_blocks,
-			  CORE_ADDR start, CORE_ADDR end,
-			  struct address_range_list *ranges,
-			  struct objfile *objfile);
+extern struct block *finish_block (struct symbol *symbol,
+				   struct pending **listhead,
+				   struct pending_block *old_blocks,
+				   CORE_ADDR start, CORE_ADDR end,
+				   struct address_range_list *ranges,
+				   struct objfile *objfile);
 /* APPLE LOCAL end address ranges  */
 
 extern void really_free_pendings (void *dummy);
@@ -304,6 +304,12 @@ extern void merge_symbol_lists (struct pending **srclist,
    currently reading.  All the symtabs for this CU will point to this.  */
 EXTERN struct macro_table *pending_macros;
 
+/* APPLE LOCAL begin lazy macro tables  */
+/* Set instead of pending_macros when the reader puts off reading the
+   compilation unit's macros.  */
+EXTERN struct lazy_macro_table *pending_lazy_macro_table;
+/* APPLE LOCAL end lazy macro tables  */
+
 #undef EXTERN
 
 #endif /* defined (BUILDSYM_H) */
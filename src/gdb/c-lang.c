@@ -458,6 +458,9 @@ c_preprocess_and_parse (void)
     {
       expression_macro_lookup_func = standard_macro_lookup;
       expression_macro_lookup_baton = (void *) scope;
+      /* APPLE LOCAL expression cache: The macros in scope can
+	 change from line to line.  */
+      expression_cacheable = 0;
     }
   else
     {
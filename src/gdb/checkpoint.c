@@ -80,6 +80,9 @@ memcache_get (struct checkpoint *cp, ULONGEST addr, int len)
   mc->len = len;
   mc->cache = (gdb_byte *) xmalloc (len);
 
+  /* APPLE LOCAL incremental checkpoints  */
+  mc->storage = NULL;
+
   mc->next = cp->mem;
   cp->mem = mc;
 
@@ -92,6 +95,197 @@ memcache_get (struct checkpoint *cp, ULONGEST addr, int len)
   mc->len = actual;
 }
 
+/* APPLE LOCAL begin incremental checkpoints  */
+/* The granularity at which a checkpoint's memory is compared with the
+   previous checkpoint's.  */
+
+#define CHECKPOINT_PAGE_SIZE 4096
+
+static int
+memcache_compare_addr (const void *a, const void *b)
+{
+  const struct memcache *ma = *(const struct memcache **) a;
+  const struct memcache *mb = *(const struct memcache **) b;
+
+  if (ma->startaddr < mb->startaddr)
+    return -1;
+  if (ma->startaddr > mb->startaddr)
+    return 1;
+  return 0;
+}
+
+/* Return the memcache of CP holding ADDR, or NULL.  */
+
+static struct memcache *
+memcache_find (struct checkpoint *cp, ULONGEST addr)
+{
+  int lo, hi;
+
+  if (cp->mem_index == NULL)
+    {
+      struct memcache *mc;
+      int n = 0;
+
+      for (mc = cp->mem; mc != NULL; mc = mc->next)
+	n++;
+      cp->mem_index = (struct memcache **)
+	xmalloc ((n > 0 ? n : 1) * sizeof (struct memcache *));
+      n = 0;
+      for (mc = cp->mem; mc != NULL; mc = mc->next)
+	cp->mem_index[n++] = mc;
+      qsort (cp->mem_index, n, sizeof (struct memcache *),
+	     memcache_compare_addr);
+      cp->mem_index_count = n;
+    }
+
+  /* Find the last block starting at or below ADDR.  */
+  lo = 0;
+  hi = cp->mem_index_count;
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      if (cp->mem_index[mid]->startaddr <= addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0)
+    return NULL;
+  if (addr - cp->mem_index[lo - 1]->startaddr
+      >= (ULONGEST) cp->mem_index[lo - 1]->len)
+    return NULL;
+  return cp->mem_index[lo - 1];
+}
+
+/* Add to CP a memcache for the LEN bytes at ADDR.  If SHARED is
+   non-NULL the bytes are already held by SHARED, a memcache of an
+   earlier checkpoint, and are shared with it; otherwise they are
+   copied from BUF.  */
+
+static void
+memcache_add (struct checkpoint *cp, ULONGEST addr, int len,
+	      const gdb_byte *buf, struct memcache *shared)
+{
+  struct memcache *mc;
+
+  mc = (struct memcache *) xmalloc (sizeof (struct memcache));
+  mc->startaddr = addr;
+  mc->len = len;
+
+  if (shared != NULL)
+    {
+      if (shared->storage == NULL)
+	{
+	  shared->storage = (struct memcache_storage *)
+	    xmalloc (sizeof (struct memcache_storage));
+	  shared->storage->refcount = 1;
+	  shared->storage->base = shared->cache;
+	}
+      shared->storage->refcount++;
+      mc->storage = shared->storage;
+      mc->cache = shared->cache + (addr - shared->startaddr);
+    }
+  else
+    {
+      mc->storage = NULL;
+      mc->cache = (gdb_byte *) xmalloc (len);
+      memcpy (mc->cache, buf, len);
+    }
+
+  mc->next = cp->mem;
+  cp->mem = mc;
+}
+
+/* Like memcache_get, but keep a copy of only those pages of the LEN
+   bytes at ADDR that differ from what PREV saved; the ones that
+   haven't changed share PREV's copy.  When checkpoints are taken at
+   every stop, most of memory is the same from one to the next.  */
+
+void
+memcache_get_incremental (struct checkpoint *cp, struct checkpoint *prev,
+			  ULONGEST addr, int len)
+{
+  gdb_byte *buf;
+  int actual, off, run_start, run_len;
+  struct memcache *run_mc = NULL;
+
+  if (prev == NULL || prev->mem == NULL)
+    {
+      memcache_get (cp, addr, len);
+      return;
+    }
+
+  buf = (gdb_byte *) xmalloc (len);
+  actual = target_read_partial (&current_target, TARGET_OBJECT_MEMORY,
+				NULL, buf, addr, len);
+
+  run_start = 0;
+  run_len = 0;
+  for (off = 0; off < actual; )
+    {
+      ULONGEST here = addr + off;
+      int chunk = CHECKPOINT_PAGE_SIZE - (int) (here % CHECKPOINT_PAGE_SIZE);
+      struct memcache *mc;
+
+      if (chunk > actual - off)
+	chunk = actual - off;
+
+      mc = memcache_find (prev, here);
+      if (mc != NULL
+	  && (here + chunk > mc->startaddr + mc->len
+	      || memcmp (mc->cache + (here - mc->startaddr), buf + off,
+			 chunk) != 0))
+	mc = NULL;
+
+      /* Start a new run whenever we switch between changed and
+	 unchanged pages, or between the blocks being shared.  */
+      if (run_len > 0 && mc != run_mc)
+	{
+	  memcache_add (cp, addr + run_start, run_len, buf + run_start,
+			run_mc);
+	  run_start = off;
+	  run_len = 0;
+	}
+      run_mc = mc;
+      run_len += chunk;
+      off += chunk;
+    }
+  if (run_len > 0)
+    memcache_add (cp, addr + run_start, run_len, buf + run_start, run_mc);
+
+  xfree (buf);
+}
+
+/* Free CP's saved memory.  */
+
+static void
+memcache_free (struct checkpoint *cp)
+{
+  struct memcache *mc = cp->mem;
+
+  while (mc != NULL)
+    {
+      struct memcache *next = mc->next;
+
+      if (mc->storage == NULL)
+	xfree (mc->cache);
+      else if (--mc->storage->refcount == 0)
+	{
+	  xfree (mc->storage->base);
+	  xfree (mc->storage);
+	}
+      xfree (mc);
+      mc = next;
+    }
+  cp->mem = NULL;
+
+  xfree (cp->mem_index);
+  cp->mem_index = NULL;
+  cp->mem_index_count = 0;
+}
+/* APPLE LOCAL end incremental checkpoints  */
+
 void
 memcache_put (struct checkpoint *cp)
 {
@@ -706,7 +900,6 @@ void
 delete_checkpoint (struct checkpoint *cp)
 {
   struct checkpoint *cpi;
-  struct memcache *mc;
 
   /* First disentangle all the logical connections.  */
   for (cpi = checkpoint_list; cpi != NULL; cpi = cpi->next)
@@ -735,10 +928,12 @@ delete_checkpoint (struct checkpoint *cp)
   if (cp->next)
     cp->next->prev = cp->prev;
 
-  for (mc = cp->mem; mc != NULL; mc = mc->next)
-    {
-      /* (should dealloc caches) */
-    }
+  /* APPLE LOCAL begin checkpoint restore: With max-checkpoints in the
+     hundreds, holding on to the memory of every pruned checkpoint adds
+     up quickly.  APPLE LOCAL incremental checkpoints: Blocks shared
+     with other checkpoints stay until the last of them goes.  */
+  memcache_free (cp);
+  /* APPLE LOCAL end checkpoint restore  */
 
   if (cp->pid)
     {
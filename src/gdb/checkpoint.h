@@ -29,7 +29,22 @@ struct memcache
   ULONGEST startaddr;
   int len;
   gdb_byte *cache;
+
+  /* APPLE LOCAL begin incremental checkpoints  */
+  /* If non-NULL, CACHE points into a block shared with memcaches of
+     other checkpoints, which is freed along with STORAGE when its
+     last user goes away.  If NULL, CACHE belongs to this memcache.  */
+  struct memcache_storage *storage;
+  /* APPLE LOCAL end incremental checkpoints  */
+};
+
+/* APPLE LOCAL begin incremental checkpoints  */
+struct memcache_storage
+{
+  int refcount;
+  gdb_byte *base;
 };
+/* APPLE LOCAL end incremental checkpoints  */
 
 enum cp_type {
   unset = '?',
@@ -70,6 +85,13 @@ struct checkpoint
   struct regcache *regs;
   struct memcache *mem;
 
+  /* APPLE LOCAL begin incremental checkpoints  */
+  /* MEM sorted by address, built the first time a later checkpoint is
+     diffed against this one.  */
+  struct memcache **mem_index;
+  int mem_index_count;
+  /* APPLE LOCAL end incremental checkpoints  */
+
   int pid;
 
   /* Flag used to decide which ones to keep.  */
@@ -77,6 +99,10 @@ struct checkpoint
 };
 
 extern void memcache_get (struct checkpoint *cp, ULONGEST addr, int len);
+/* APPLE LOCAL incremental checkpoints  */
+extern void memcache_get_incremental (struct checkpoint *cp,
+				      struct checkpoint *prev,
+				      ULONGEST addr, int len);
 
 extern void clear_checkpoints (void);
 extern void clear_all_checkpoints (void);
@@ -91,3 +117,6 @@ extern void checkpoint_clear_inferior ();
 
 extern int auto_checkpointing;
 
+/* APPLE LOCAL incremental checkpoints  */
+extern struct checkpoint *current_checkpoint;
+
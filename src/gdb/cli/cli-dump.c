@@ -31,6 +31,8 @@
 #include "gdb_assert.h"
 #include <ctype.h>
 #include "target.h"
+/* APPLE LOCAL streaming dump and restore  */
+#include "gdbcore.h"
 #include "readline/readline.h"
 
 #define XMALLOC(TYPE) ((TYPE*) xmalloc (sizeof (TYPE)))
@@ -40,6 +42,33 @@
 #define DEFAULT_MAX_BINARY_FILE_CHUNK LONG_MAX
 static long  g_max_binary_file_chunk = DEFAULT_MAX_BINARY_FILE_CHUNK;
 
+/* APPLE LOCAL begin streaming dump and restore  */
+/* The most target memory "dump" and "restore" hold at once.  Larger
+   ranges are copied a piece at a time.  Zero means no limit.  */
+static int dump_buffer_size = 1024 * 1024;
+
+static void
+show_dump_buffer_size (struct ui_file *file, int from_tty,
+		       struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+The buffer size used by dump and restore is %s.\n"),
+		    value);
+}
+
+/* How much of the LEFT bytes starting at ADDR to copy next: no more
+   than dump_buffer_size, and ending on a multiple of it, so that all
+   but the first piece start on the same alignment in the target.  */
+
+static ULONGEST
+dump_next_piece (CORE_ADDR addr, ULONGEST left)
+{
+  ULONGEST piece = dump_buffer_size - addr % dump_buffer_size;
+
+  return min (piece, left);
+}
+/* APPLE LOCAL end streaming dump and restore  */
+
 char *
 skip_spaces (char *chp)
 {
@@ -228,6 +257,63 @@ dump_bfd_file (const char *filename, const char *mode,
   bfd_set_section_contents (obfd, osection, buf, 0, len);
 }
 
+/* APPLE LOCAL begin streaming dump and restore  */
+/* Write the COUNT bytes of target memory at LO to FILENAME in
+   FILE_FORMAT, reading them dump_buffer_size bytes at a time so that
+   gdb's memory use doesn't grow with the size of the range.  */
+
+static void
+dump_memory_streaming (const char *filename, const char *mode,
+		       const char *file_format, CORE_ADDR lo, ULONGEST count)
+{
+  FILE *file = NULL;
+  bfd *obfd = NULL;
+  asection *osection = NULL;
+  gdb_byte *buf;
+  ULONGEST done = 0;
+
+  if (file_format == NULL || strcmp (file_format, "binary") == 0)
+    file = fopen_with_cleanup (filename, mode);
+  else
+    {
+      obfd = bfd_openw_with_cleanup (filename, file_format, mode);
+      osection = bfd_make_section_anyway (obfd, ".newsec");
+      bfd_set_section_size (obfd, osection, count);
+      bfd_set_section_vma (obfd, osection, lo);
+      bfd_set_section_alignment (obfd, osection, 0);
+      bfd_set_section_flags (obfd, osection, (SEC_HAS_CONTENTS
+					      | SEC_ALLOC
+					      | SEC_LOAD));
+      osection->entsize = 0;
+    }
+
+  buf = xmalloc (dump_buffer_size);
+  make_cleanup (xfree, buf);
+
+  while (done < count)
+    {
+      ULONGEST len = dump_next_piece (lo + done, count - done);
+      int status;
+
+      status = target_read_memory (lo + done, buf, len);
+      if (status != 0)
+	memory_error (status, lo + done);
+
+      if (file != NULL)
+	{
+	  if (fwrite (buf, len, 1, file) != 1)
+	    perror_with_name (filename);
+	}
+      else if (!bfd_set_section_contents (obfd, osection, buf, done, len))
+	error (_("Failed to write %s: %s."), filename,
+	       bfd_errmsg (bfd_get_error ()));
+
+      done += len;
+      QUIT;
+    }
+}
+/* APPLE LOCAL end streaming dump and restore  */
+
 static void
 dump_memory_to_file (char *cmd, char *mode, char *file_format)
 {
@@ -236,7 +322,9 @@ dump_memory_to_file (char *cmd, char *mode, char *file_format)
   CORE_ADDR hi;
   ULONGEST count;
   char *filename;
-  void *buf;
+  /* APPLE LOCAL map target memory  */
+  const void *buf;
+  void *handle;
   char *lo_exp;
   char *hi_exp;
 
@@ -259,11 +347,31 @@ dump_memory_to_file (char *cmd, char *mode, char *file_format)
     error (_("Invalid memory address range (start >= end)."));
   count = hi - lo;
 
-  /* FIXME: Should use read_memory_partial() and a magic blocking
-     value.  */
-  buf = xmalloc (count);
-  make_cleanup (xfree, buf);
-  target_read_memory (lo, buf, count);
+  /* APPLE LOCAL begin map target memory  */
+  /* If the target can map the range into our address space, write it
+     straight out of the mapping rather than copying it all first.  */
+  buf = target_map_memory (lo, count, &handle);
+  if (buf != NULL)
+    make_cleanup (target_unmap_memory, handle);
+  /* APPLE LOCAL begin streaming dump and restore  */
+  else if (dump_buffer_size > 0 && count > dump_buffer_size)
+    {
+      dump_memory_streaming (filename, mode, file_format, lo, count);
+      do_cleanups (old_cleanups);
+      return;
+    }
+  /* APPLE LOCAL end streaming dump and restore  */
+  else
+    {
+      /* FIXME: Should use read_memory_partial() and a magic blocking
+	 value.  */
+      void *copy = xmalloc (count);
+
+      make_cleanup (xfree, copy);
+      target_read_memory (lo, copy, count);
+      buf = copy;
+    }
+  /* APPLE LOCAL end map target memory  */
   
   /* Have everything.  Open/write the data.  */
   if (file_format == NULL || strcmp (file_format, "binary") == 0)
@@ -467,6 +575,10 @@ restore_section_callback (bfd *ibfd, asection *isec, void *args)
   struct cleanup *old_chain;
   gdb_byte *buf;
   int ret;
+  /* APPLE LOCAL begin streaming dump and restore  */
+  CORE_ADDR dest;
+  bfd_size_type done;
+  /* APPLE LOCAL end streaming dump and restore  */
 
   /* Ignore non-loadable sections, eg. from elf files. */
   if (!(bfd_get_section_flags (ibfd, isec) & SEC_LOAD))
@@ -492,13 +604,6 @@ restore_section_callback (bfd *ibfd, asection *isec, void *args)
   if (data->load_end > 0 && sec_end > data->load_end)
     sec_load_count -= sec_end - data->load_end;
 
-  /* Get the data.  */
-  buf = xmalloc (size);
-  old_chain = make_cleanup (xfree, buf);
-  if (!bfd_get_section_contents (ibfd, isec, buf, 0, size))
-    error (_("Failed to read bfd file %s: '%s'."), bfd_get_filename (ibfd), 
-	   bfd_errmsg (bfd_get_error ()));
-
   printf_filtered ("Restoring section %s (0x%lx to 0x%lx)",
 		   bfd_section_name (ibfd, isec), 
 		   (unsigned long) sec_start, 
@@ -513,11 +618,40 @@ restore_section_callback (bfd *ibfd, asection *isec, void *args)
   else
     puts_filtered ("\n");
 
-  /* Write the data.  */
-  ret = target_write_memory (sec_start + sec_offset + data->load_offset, 
-			     buf + sec_offset, sec_load_count);
-  if (ret != 0)
-    warning (_("restore: memory write failed (%s)."), safe_strerror (ret));
+  /* APPLE LOCAL begin streaming dump and restore  */
+  /* Copy the part of the section we want a buffer at a time, rather
+     than reading the whole section into memory first.  */
+  dest = sec_start + sec_offset + data->load_offset;
+  if (dump_buffer_size > 0 && sec_load_count > dump_buffer_size)
+    buf = xmalloc (dump_buffer_size);
+  else
+    buf = xmalloc (sec_load_count);
+  old_chain = make_cleanup (xfree, buf);
+
+  for (done = 0; done < sec_load_count; )
+    {
+      bfd_size_type len = sec_load_count - done;
+
+      if (dump_buffer_size > 0)
+	len = dump_next_piece (dest + done, len);
+
+      /* Get the data.  */
+      if (!bfd_get_section_contents (ibfd, isec, buf, sec_offset + done, len))
+	error (_("Failed to read bfd file %s: '%s'."), bfd_get_filename (ibfd), 
+	       bfd_errmsg (bfd_get_error ()));
+
+      /* Write the data.  */
+      ret = target_write_memory (dest + done, buf, len);
+      if (ret != 0)
+	{
+	  warning (_("restore: memory write failed (%s)."),
+		   safe_strerror (ret));
+	  break;
+	}
+      done += len;
+      QUIT;
+    }
+  /* APPLE LOCAL end streaming dump and restore  */
   do_cleanups (old_chain);
   return;
 }
@@ -798,6 +932,18 @@ large allocation failures in gdb."),
 	   &restore_show_cmdlist);
   /* APPLE LOCAL END: segment binary file downloads  */
 
+  /* APPLE LOCAL streaming dump and restore  */
+  add_setshow_zinteger_cmd ("dump-buffer-size", class_vars,
+			    &dump_buffer_size, _("\
+Set the buffer size used by dump and restore."), _("\
+Show the buffer size used by dump and restore."), _("\
+\"dump\" and \"restore\" copy ranges larger than this many bytes between\n\
+the target and the file a buffer at a time, so that copying a large\n\
+region doesn't need as much memory in gdb.  0 means copy each range\n\
+at once."),
+			    NULL, show_dump_buffer_size,
+			    &setlist, &showlist);
+
   add_prefix_cmd ("dump", class_vars, dump_command, _("\
 Dump target code/data to a local file."),
 		  &dump_cmdlist, "dump ",
@@ -381,7 +381,9 @@ execute_control_command (struct command_line *cmd)
 	if (!new_line)
 	  break;
 	make_cleanup (free_current_contents, &new_line);
-	expr = parse_expression (new_line);
+	/* APPLE LOCAL expression cache: A loop nested in another one
+	   runs this each time round the outer loop.  */
+	expr = parse_expression_cached (new_line);
 	make_cleanup (free_current_contents, &expr);
 
 	ret = simple_control;
@@ -451,7 +453,8 @@ execute_control_command (struct command_line *cmd)
 	  break;
 	make_cleanup (free_current_contents, &new_line);
 	/* Parse the conditional for the if statement.  */
-	expr = parse_expression (new_line);
+	/* APPLE LOCAL expression cache  */
+	expr = parse_expression_cached (new_line);
 	make_cleanup (free_current_contents, &expr);
 
 	current = NULL;
@@ -650,6 +653,12 @@ insert_args (char *line)
   char *p, *save_line, *new_line;
   unsigned len, i;
 
+  /* APPLE LOCAL begin user command args  */
+  /* Most lines have nothing to substitute.  */
+  if (locate_arg (line) == NULL)
+    return xstrdup (line);
+  /* APPLE LOCAL end user command args  */
+
   /* First we need to know how much memory to allocate for the new line.  */
   save_line = line;
   len = 0;
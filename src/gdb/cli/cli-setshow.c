@@ -29,6 +29,9 @@
 #include "cli/cli-cmds.h"
 #include "cli/cli-setshow.h"
 
+/* APPLE LOCAL setting generation  */
+unsigned int setting_generation = 1;
+
 /* Prototypes for local functions */
 
 static int parse_binary_operation (char *);
@@ -392,6 +395,9 @@ do_setshow_command (char *arg, int from_tty, struct cmd_list_element *c)
     }
   else
     error (_("gdb internal error: bad cmd_type in do_setshow_command"));
+  /* APPLE LOCAL setting generation  */
+  if (c->type == set_cmd)
+    setting_generation++;
   c->func (c, NULL, from_tty);
   if (c->type == set_cmd && deprecated_set_hook)
     deprecated_set_hook (c);
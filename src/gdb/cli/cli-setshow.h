@@ -35,4 +35,13 @@ extern void do_setshow_command (char *arg, int from_tty,
 extern void cmd_show_list (struct cmd_list_element *list, int from_tty,
 			   char *prefix);
 
+/* APPLE LOCAL begin setting generation  */
+/* Bumped by every "set" command, so that a cache of output that
+   depends on some setting - the disassembly flavor, how addresses are
+   printed, ... - can tell when it may be stale without knowing which
+   settings matter.  */
+
+extern unsigned int setting_generation;
+/* APPLE LOCAL end setting generation  */
+
 #endif /* !defined (CLI_SETSHOW_H) */
@@ -34,7 +34,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
    target_whatever macros.  We override these definitions so we can
    properly route the calls through the target vector, and so keep
    them out of the kdp side.  */
-/* The only one we don't override is TARGET_REGION_OK_FOR_HW_WATCHPOINT.
+/* TARGET_REGION_OK_FOR_HW_WATCHPOINT is overridden below too.
    That isn't actually a target vector entry, but rather it is a way to
    override the one-argument target vector entry 
      to_region_size_ok_for_hw_watchpoint
@@ -50,6 +50,15 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
 #undef target_insert_hw_breakpoint
 #undef target_remove_hw_breakpoint
 
+/* APPLE LOCAL begin debug register multiplexing  */
+/* Regions the debug registers can't cover may still be watched
+   through page protection.  */
+#undef TARGET_REGION_OK_FOR_HW_WATCHPOINT
+extern int i386_macosx_region_ok_for_watchpoint (CORE_ADDR addr, int len);
+#define TARGET_REGION_OK_FOR_HW_WATCHPOINT(addr, len) \
+  i386_macosx_region_ok_for_watchpoint (addr, len)
+/* APPLE LOCAL end debug register multiplexing  */
+
 extern void i386_macosx_dr_set_control (unsigned long control);
 #define I386_DR_LOW_SET_CONTROL(control) \
   i386_macosx_dr_set_control (control)
@@ -39,6 +39,13 @@ extern int i386_insert_watchpoint (CORE_ADDR addr, int len, int type);
    type TYPE.  Return 0 on success, -1 on failure.  */
 extern int i386_remove_watchpoint (CORE_ADDR addr, int len, int type);
 
+/* APPLE LOCAL begin debug register multiplexing  */
+/* Like i386_insert_watchpoint, but if any part of the region can't
+   get a debug register, leave the debug registers exactly as they
+   were and return -1.  */
+extern int i386_insert_watchpoint_whole (CORE_ADDR addr, int len, int type);
+/* APPLE LOCAL end debug register multiplexing  */
+
 /* Return non-zero if we can watch a memory region that starts at
    address ADDR and whose length is LEN bytes.  */
 extern int i386_region_ok_for_watchpoint (CORE_ADDR addr, int len);
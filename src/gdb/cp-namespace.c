@@ -32,6 +32,8 @@
 #include "dictionary.h"
 #include "command.h"
 #include "frame.h"
+/* APPLE LOCAL C++ lookup caches  */
+#include "hashtab.h"
 
 /* When set, the file that we're processing is known to have debugging
    info for C++ namespaces.  */
@@ -397,6 +399,166 @@ lookup_namespace_scope (const char *name,
 				     block, domain, symtab);
 }
 
+/* APPLE LOCAL begin C++ lookup caches  */
+/* Applying the using directives means walking the file's whole list
+   of them, recursively, for every namespace a lookup passes through.
+   The namespaces that end up being searched, and their order, depend
+   only on that list and the namespace we started from, so remember
+   them.  The list of directives belongs to the static block and so
+   lives on its objfile's obstack, as do the names we point to; the
+   table is flushed whenever an objfile is freed.  */
+
+struct using_resolution
+{
+  const struct using_direct *using;
+  char *namespace;
+
+  /* The namespaces to search, in order; the last one is NAMESPACE.  */
+  int count;
+  const char **namespaces;
+};
+
+static htab_t using_resolution_cache;
+
+static hashval_t
+using_resolution_hash (const void *p)
+{
+  const struct using_resolution *res = p;
+
+  return htab_hash_pointer (res->using) ^ htab_hash_string (res->namespace);
+}
+
+static int
+using_resolution_eq (const void *p1, const void *p2)
+{
+  const struct using_resolution *r1 = p1;
+  const struct using_resolution *r2 = p2;
+
+  return r1->using == r2->using && strcmp (r1->namespace, r2->namespace) == 0;
+}
+
+static void
+using_resolution_del (void *p)
+{
+  struct using_resolution *res = p;
+
+  xfree (res->namespace);
+  xfree (res->namespaces);
+  xfree (res);
+}
+
+void
+cp_flush_namespace_cache (void)
+{
+  if (using_resolution_cache != NULL)
+    htab_empty (using_resolution_cache);
+}
+
+/* The namespaces being expanded by using_resolution_collect, so that
+   directives that refer back to one of them aren't followed forever.  */
+
+struct using_resolution_stack
+{
+  const char *namespace;
+  struct using_resolution_stack *outer;
+};
+
+/* Append to RES, in the order cp_lookup_symbol_namespace would search
+   them, the namespaces reached from NAMESPACE by RES's directives,
+   then NAMESPACE itself.  */
+
+static void
+using_resolution_collect (struct using_resolution *res, int *alloced,
+			  const char *namespace,
+			  struct using_resolution_stack *outer)
+{
+  struct using_resolution_stack here, *s;
+  const struct using_direct *current;
+  int i;
+
+  for (s = outer; s != NULL; s = s->outer)
+    if (strcmp (s->namespace, namespace) == 0)
+      return;
+  here.namespace = namespace;
+  here.outer = outer;
+
+  for (current = res->using; current != NULL; current = current->next)
+    if (strcmp (namespace, current->outer) == 0)
+      using_resolution_collect (res, alloced, current->inner, &here);
+
+  /* Searching the same namespace twice can't find anything new.  */
+  for (i = 0; i < res->count; i++)
+    if (strcmp (res->namespaces[i], namespace) == 0)
+      return;
+
+  if (res->count == *alloced)
+    {
+      *alloced = *alloced * 2 + 4;
+      res->namespaces = xrealloc (res->namespaces,
+				  *alloced * sizeof (const char *));
+    }
+  res->namespaces[res->count++] = namespace;
+}
+
+static const struct using_resolution *
+lookup_using_resolution (const struct using_direct *using,
+			 const char *namespace)
+{
+  struct using_resolution key, *res;
+  void **slot;
+  int alloced = 0;
+
+  if (using_resolution_cache == NULL)
+    using_resolution_cache = htab_create_alloc (64, using_resolution_hash,
+						using_resolution_eq,
+						using_resolution_del,
+						xcalloc, xfree);
+
+  key.using = using;
+  key.namespace = (char *) namespace;
+  slot = htab_find_slot (using_resolution_cache, &key, INSERT);
+  if (*slot != NULL)
+    return *slot;
+
+  res = xmalloc (sizeof (struct using_resolution));
+  res->using = using;
+  res->namespace = xstrdup (namespace);
+  res->count = 0;
+  res->namespaces = NULL;
+  using_resolution_collect (res, &alloced, res->namespace, NULL);
+  *slot = res;
+  return res;
+}
+
+/* Look up NAME in NAMESPACE itself, ignoring using directives.  */
+
+static struct symbol *
+lookup_symbol_in_namespace (const char *namespace,
+			    const char *name,
+			    const char *linkage_name,
+			    const struct block *block,
+			    const domain_enum domain,
+			    struct symtab **symtab)
+{
+  if (namespace[0] == '\0')
+    {
+      return lookup_symbol_file (name, linkage_name, block,
+				 domain, symtab, 0);
+    }
+  else
+    {
+      char *concatenated_name
+	= alloca (strlen (namespace) + 2 + strlen (name) + 1);
+      strcpy (concatenated_name, namespace);
+      strcat (concatenated_name, "::");
+      strcat (concatenated_name, name);
+      return lookup_symbol_file (concatenated_name, linkage_name,
+				 block, domain, symtab,
+				 cp_is_anonymous (namespace));
+    }
+}
+/* APPLE LOCAL end C++ lookup caches  */
+
 /* Look up NAME in the C++ namespace NAMESPACE, applying the using
    directives that are active in BLOCK.  Other arguments are as in
    cp_lookup_symbol_nonlocal.  */
@@ -412,6 +574,27 @@ cp_lookup_symbol_namespace (const char *namespace,
   const struct using_direct *current;
   struct symbol *sym;
 
+  /* APPLE LOCAL begin C++ lookup caches  */
+  current = block_using (block);
+  if (cp_lookup_cache_enabled && current != NULL)
+    {
+      const struct using_resolution *res;
+      int i;
+
+      res = lookup_using_resolution (current, namespace);
+      for (i = 0; i < res->count - 1; i++)
+	{
+	  sym = lookup_symbol_in_namespace (res->namespaces[i], name,
+					    linkage_name, block, domain,
+					    symtab);
+	  if (sym != NULL)
+	    return sym;
+	}
+      return lookup_symbol_in_namespace (namespace, name, linkage_name,
+					 block, domain, symtab);
+    }
+  /* APPLE LOCAL end C++ lookup caches  */
+
   /* First, go through the using directives.  If any of them add new
      names to the namespace we're searching in, see if we can find a
      match by applying them.  */
@@ -436,24 +619,10 @@ cp_lookup_symbol_namespace (const char *namespace,
   /* We didn't find anything by applying any of the using directives
      that are still applicable; so let's see if we've got a match
      using the current namespace.  */
-  
-  if (namespace[0] == '\0')
-    {
-      return lookup_symbol_file (name, linkage_name, block,
-				 domain, symtab, 0);
-    }
-  else
-    {
-      char *concatenated_name
-	= alloca (strlen (namespace) + 2 + strlen (name) + 1);
-      strcpy (concatenated_name, namespace);
-      strcat (concatenated_name, "::");
-      strcat (concatenated_name, name);
-      sym = lookup_symbol_file (concatenated_name, linkage_name,
-				block, domain, symtab,
-				cp_is_anonymous (namespace));
-      return sym;
-    }
+
+  /* APPLE LOCAL C++ lookup caches  */
+  return lookup_symbol_in_namespace (namespace, name, linkage_name,
+				     block, domain, symtab);
 }
 
 /* Look up NAME in BLOCK's static block and in global blocks.  If
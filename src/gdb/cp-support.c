@@ -34,6 +34,8 @@
 #include "block.h"
 #include "complaints.h"
 #include "gdbtypes.h"
+/* APPLE LOCAL C++ lookup caches  */
+#include "hashtab.h"
 
 #define d_left(dc) (dc)->u.s_binary.left
 #define d_right(dc) (dc)->u.s_binary.right
@@ -70,15 +72,62 @@ struct cmd_list_element *maint_cplus_cmd_list = NULL;
 static void maint_cplus_command (char *arg, int from_tty);
 static void first_component_command (char *arg, int from_tty);
 
-/* Return the canonicalized form of STRING, or NULL if STRING can not be
-   parsed.  The return value is allocated via xmalloc.
+/* APPLE LOCAL begin C++ lookup caches  */
+int cp_lookup_cache_enabled = 1;
 
-   drow/2005-03-07: Should we also return NULL for things that trivially do
-   not require any change?  e.g. simple identifiers.  This could be more
-   efficient.  */
+static void
+show_cp_lookup_cache_enabled (struct ui_file *file, int from_tty,
+			      struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Caching of C++ name lookups is %s.\n"), value);
+}
 
-char *
-cp_canonicalize_string (const char *string)
+/* Canonicalizing a name runs the whole C++ name parser over it, and
+   the same names come up again and again in linespecs, expressions
+   and overload resolution.  The answer depends only on the string,
+   so remember it.  CANONICAL is NULL if the string couldn't be
+   parsed.  The table is emptied when it gets too big rather than
+   aged.  */
+
+#define CANONICAL_NAME_CACHE_MAX 4096
+
+struct canonical_name_entry
+{
+  char *string;
+  char *canonical;
+};
+
+static htab_t canonical_name_cache;
+
+static hashval_t
+canonical_name_hash (const void *p)
+{
+  const struct canonical_name_entry *entry = p;
+
+  return htab_hash_string (entry->string);
+}
+
+static int
+canonical_name_eq (const void *p1, const void *p2)
+{
+  const struct canonical_name_entry *e1 = p1;
+  const struct canonical_name_entry *e2 = p2;
+
+  return strcmp (e1->string, e2->string) == 0;
+}
+
+static void
+canonical_name_del (void *p)
+{
+  struct canonical_name_entry *entry = p;
+
+  xfree (entry->string);
+  xfree (entry->canonical);
+  xfree (entry);
+}
+
+static char *
+cp_canonicalize_string_1 (const char *string)
 {
   void *storage;
   struct demangle_component *ret_comp;
@@ -97,6 +146,49 @@ cp_canonicalize_string (const char *string)
 
   return ret;
 }
+/* APPLE LOCAL end C++ lookup caches  */
+
+/* Return the canonicalized form of STRING, or NULL if STRING can not be
+   parsed.  The return value is allocated via xmalloc.
+
+   drow/2005-03-07: Should we also return NULL for things that trivially do
+   not require any change?  e.g. simple identifiers.  This could be more
+   efficient.  */
+
+char *
+cp_canonicalize_string (const char *string)
+{
+  /* APPLE LOCAL begin C++ lookup caches  */
+  struct canonical_name_entry key, *entry;
+  void **slot;
+
+  if (!cp_lookup_cache_enabled)
+    return cp_canonicalize_string_1 (string);
+
+  if (canonical_name_cache == NULL)
+    canonical_name_cache = htab_create_alloc (256, canonical_name_hash,
+					      canonical_name_eq,
+					      canonical_name_del,
+					      xcalloc, xfree);
+  else if (htab_elements (canonical_name_cache) >= CANONICAL_NAME_CACHE_MAX)
+    htab_empty (canonical_name_cache);
+
+  key.string = (char *) string;
+  slot = htab_find_slot (canonical_name_cache, &key, INSERT);
+  entry = *slot;
+  if (entry == NULL)
+    {
+      entry = xmalloc (sizeof (struct canonical_name_entry));
+      entry->string = xstrdup (string);
+      entry->canonical = cp_canonicalize_string_1 (string);
+      *slot = entry;
+    }
+
+  if (entry->canonical == NULL)
+    return NULL;
+  return xstrdup (entry->canonical);
+  /* APPLE LOCAL end C++ lookup caches  */
+}
 
 /* Convert a mangled name to a demangle_component tree.  *MEMORY is set to the
    block of used memory that should be freed when finished with the tree. 
@@ -889,4 +981,16 @@ _initialize_cp_support (void)
   add_cmd ("first_component", class_maintenance, first_component_command,
 	   _("Print the first class/namespace component of NAME."),
 	   &maint_cplus_cmd_list);
+
+  /* APPLE LOCAL begin C++ lookup caches  */
+  add_setshow_boolean_cmd ("cplus-lookup-cache", class_maintenance,
+			   &cp_lookup_cache_enabled, _("\
+Set whether C++ name canonicalization and using directives are cached."), _("\
+Show whether C++ name canonicalization and using directives are cached."), _("\
+When on, the canonical form of each C++ name is remembered, as is the\n\
+list of namespaces the using directives of a file make a lookup search."),
+			   NULL, show_cp_lookup_cache_enabled,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end C++ lookup caches  */
 }
@@ -116,6 +116,15 @@ extern void cp_check_possible_namespace_symbols (const char *name,
 
 struct type *cp_lookup_transparent_type (const char *name);
 
+/* APPLE LOCAL begin C++ lookup caches  */
+extern void cp_flush_namespace_cache (void);
+
+/* Nonzero if canonical names and using-directive resolutions are
+   cached; "maint set cplus-lookup-cache".  */
+
+extern int cp_lookup_cache_enabled;
+/* APPLE LOCAL end C++ lookup caches  */
+
 /* Functions from cp-names.y.  */
 
 extern struct demangle_component *cp_demangled_name_to_comp
@@ -275,12 +275,48 @@ struct header_file_location
   int instance;			/* See above */
   struct partial_symtab *pst;	/* Partial symtab that has the
 				   BINCL/EINCL defs for this file */
+  /* APPLE LOCAL header file hash: Next in the same bincl_buckets
+     chain, or -1.  */
+  int next_in_bucket;
 };
 
 /* The actual list and controling variables */
 static struct header_file_location *bincl_list, *next_bincl;
 static int bincls_allocated;
 
+/* APPLE LOCAL begin header file hash  */
+/* Heads of the hash chains through BINCL_LIST.  */
+static int *bincl_buckets;
+static int n_bincl_buckets;
+
+/* A chain table is made four times bigger once it holds more than
+   twice as many entries as it has chains.  */
+#define HEADER_HASH_MIN_BUCKETS 256
+
+/* Return NBUCKETS chain heads for the NITEMS entries whose hashes
+   HASH_AT gives, threading each entry's NEXT_AT slot.  */
+
+static int *
+header_hash_rebuild (int nbuckets, int nitems,
+		     unsigned long (*hash_at) (int),
+		     int *(*next_at) (int))
+{
+  int *buckets = xmalloc (nbuckets * sizeof (int));
+  int i;
+
+  for (i = 0; i < nbuckets; i++)
+    buckets[i] = -1;
+  for (i = 0; i < nitems; i++)
+    {
+      int b = hash_at (i) % nbuckets;
+
+      *next_at (i) = buckets[b];
+      buckets[b] = i;
+    }
+  return buckets;
+}
+/* APPLE LOCAL end header file hash  */
+
 /* Local function prototypes */
 
 extern void _initialize_dbxread (void);
@@ -296,6 +332,10 @@ static void read_dbx_dynamic_symtab (struct objfile *objfile);
 /* APPLE LOCAL add argument */
 static void read_dbx_symtab (struct objfile *, int);
 
+/* APPLE LOCAL debug map prefetch  */
+static struct dwarf2_oso_prefetch *start_oso_prefetch (struct objfile *,
+						       file_ptr, int);
+
 static void free_bincl_list (struct objfile *);
 
 static struct partial_symtab *find_corresponding_bincl_psymtab (char *, int);
@@ -383,18 +423,50 @@ add_this_object_header_file (int i)
    INSTANCE is its instance code, to select among multiple
    symbol tables for the same header file.  */
 
+/* APPLE LOCAL begin header file hash  */
+static unsigned long
+header_file_hash_at (int i)
+{
+  return HEADER_FILES (current_objfile)[i].hash;
+}
+
+static int *
+header_file_next_at (int i)
+{
+  return &HEADER_FILES (current_objfile)[i].next_in_bucket;
+}
+/* APPLE LOCAL end header file hash  */
+
 static void
 add_old_header_file (char *name, int instance)
 {
   struct header_file *p = HEADER_FILES (current_objfile);
-  int i;
+  struct dbx_symfile_info *info = DBX_SYMFILE_INFO (current_objfile);
+  unsigned long hash;
+  int i, found = -1;
 
-  for (i = 0; i < N_HEADER_FILES (current_objfile); i++)
-    if (strcmp (p[i].name, name) == 0 && instance == p[i].instance)
-      {
-	add_this_object_header_file (i);
-	return;
-      }
+  /* APPLE LOCAL begin header file hash  */
+  if (info->n_header_file_buckets == 0)
+    {
+      repeated_header_complaint (name, symnum);
+      return;
+    }
+
+  /* The chains run from the newest entry; like the linear search this
+     replaces, use the oldest match.  */
+  hash = msymbol_hash (name);
+  for (i = info->header_file_buckets[hash % info->n_header_file_buckets];
+       i >= 0; i = p[i].next_in_bucket)
+    if (p[i].hash == hash && instance == p[i].instance
+	&& strcmp (p[i].name, name) == 0)
+      found = i;
+
+  if (found >= 0)
+    {
+      add_this_object_header_file (found);
+      return;
+    }
+  /* APPLE LOCAL end header file hash  */
   repeated_header_complaint (name, symnum);
 }
 
@@ -448,6 +520,31 @@ add_new_header_file (char *name, int instance)
     = (struct type **) xmalloc (10 * sizeof (struct type *));
   memset (hfile->vector, 0, 10 * sizeof (struct type *));
 
+  /* APPLE LOCAL begin header file hash  */
+  {
+    struct dbx_symfile_info *info = DBX_SYMFILE_INFO (current_objfile);
+
+    hfile->hash = msymbol_hash (name);
+    if (i + 1 > 2 * info->n_header_file_buckets)
+      {
+	xfree (info->header_file_buckets);
+	info->n_header_file_buckets
+	  = (info->n_header_file_buckets == 0 ? HEADER_HASH_MIN_BUCKETS
+	     : info->n_header_file_buckets * 4);
+	info->header_file_buckets
+	  = header_hash_rebuild (info->n_header_file_buckets, i + 1,
+				 header_file_hash_at, header_file_next_at);
+      }
+    else
+      {
+	int b = hfile->hash % info->n_header_file_buckets;
+
+	hfile->next_in_bucket = info->header_file_buckets[b];
+	info->header_file_buckets[b] = i;
+      }
+  }
+  /* APPLE LOCAL end header file hash  */
+
   add_this_object_header_file (i);
 }
 
@@ -639,6 +736,8 @@ dbx_symfile_read (struct objfile *objfile, int mainline)
   /* APPLE LOCAL: timers */
   static int timer = -1;
   struct cleanup *timer_cleanup = NULL;
+  /* APPLE LOCAL debug map prefetch  */
+  struct dwarf2_oso_prefetch *prefetch = NULL;
 
   /* APPLE LOCAL: If this is a dSYM that has minimal symbols, don't read the
      minsyms or we'll end up with duplicated minsyms.  */
@@ -713,9 +812,22 @@ dbx_symfile_read (struct objfile *objfile, int mainline)
        }
     }
 
+  /* APPLE LOCAL debug map prefetch: Get the debug map .o files on
+     their way into the buffer cache before the serial pubtypes scan
+     in read_dbx_symtab wants them.  */
+  if (read_type_psym_p
+      && objfile->separate_debug_objfile == NULL
+      && objfile->not_loaded_kext_filename == NULL
+      && dwarf2_oso_prefetch_wanted ())
+    prefetch = start_oso_prefetch (objfile, dbx_symtab_offset,
+				   dbx_symtab_count);
+
   val = bfd_seek (sym_bfd, dbx_symtab_offset, SEEK_SET);
   if (val < 0)
-    perror_with_name (objfile->name);
+    {
+      dwarf2_finish_oso_prefetch (prefetch);
+      perror_with_name (objfile->name);
+    }
 
   /* If we are reinitializing, or if we have never loaded syms yet, init */
   if (mainline
@@ -728,6 +840,8 @@ dbx_symfile_read (struct objfile *objfile, int mainline)
 
   free_pending_blocks ();
   back_to = make_cleanup (really_free_pendings, 0);
+  /* APPLE LOCAL debug map prefetch  */
+  make_cleanup (dwarf2_finish_oso_prefetch, prefetch);
 
 #if 0
   init_minimal_symbol_collection ();
@@ -925,6 +1039,8 @@ dbx_symfile_finish (struct objfile *objfile)
 	    }
 	  xfree (hfiles);
 	}
+      /* APPLE LOCAL header file hash  */
+      xfree (DBX_SYMFILE_INFO (objfile)->header_file_buckets);
       xfree (objfile->deprecated_sym_stab_info);
     }
   free_header_files ();
@@ -1177,7 +1293,26 @@ init_bincl_list (int number, struct objfile *objfile)
   bincls_allocated = number;
   next_bincl = bincl_list = (struct header_file_location *)
     xmalloc (bincls_allocated * sizeof (struct header_file_location));
+  /* APPLE LOCAL begin header file hash  */
+  xfree (bincl_buckets);
+  bincl_buckets = NULL;
+  n_bincl_buckets = 0;
+  /* APPLE LOCAL end header file hash  */
+}
+
+/* APPLE LOCAL begin header file hash  */
+static unsigned long
+bincl_hash_at (int i)
+{
+  return bincl_list[i].hash;
+}
+
+static int *
+bincl_next_at (int i)
+{
+  return &bincl_list[i].next_in_bucket;
 }
+/* APPLE LOCAL end header file hash  */
 
 /* Add a bincl to the list.  */
 
@@ -1196,7 +1331,30 @@ add_bincl_to_list (struct partial_symtab *pst, char *name, int instance)
   next_bincl->pst = pst;
   next_bincl->hash = bincl_hash (name);
   next_bincl->instance = instance;
-  next_bincl++->name = name;
+  next_bincl->name = name;
+
+  /* APPLE LOCAL begin header file hash  */
+  {
+    int i = next_bincl - bincl_list;
+
+    if (i + 1 > 2 * n_bincl_buckets)
+      {
+	xfree (bincl_buckets);
+	n_bincl_buckets = (n_bincl_buckets == 0 ? HEADER_HASH_MIN_BUCKETS
+			   : n_bincl_buckets * 4);
+	bincl_buckets = header_hash_rebuild (n_bincl_buckets, i + 1,
+					     bincl_hash_at, bincl_next_at);
+      }
+    else
+      {
+	int b = next_bincl->hash % n_bincl_buckets;
+
+	next_bincl->next_in_bucket = bincl_buckets[b];
+	bincl_buckets[b] = i;
+      }
+  }
+  /* APPLE LOCAL end header file hash  */
+  next_bincl++;
 }
 
 /* Given a name, value pair, find the corresponding
@@ -1208,12 +1366,23 @@ find_corresponding_bincl_psymtab (char *name, int instance)
 {
   struct header_file_location *bincl;
   unsigned long hash = bincl_hash (name);
+  /* APPLE LOCAL begin header file hash  */
+  int i, found = -1;
 
-  for (bincl = bincl_list; bincl < next_bincl; bincl++)
-    if ((bincl->hash == hash)
-	&& (bincl->instance == instance)
-	&& strcmp (name, bincl->name) == 0)
-      return bincl->pst;
+  /* As for add_old_header_file, the oldest match wins.  */
+  if (n_bincl_buckets != 0)
+    for (i = bincl_buckets[hash % n_bincl_buckets]; i >= 0;
+	 i = bincl_list[i].next_in_bucket)
+      {
+	bincl = &bincl_list[i];
+	if ((bincl->hash == hash)
+	    && (bincl->instance == instance)
+	    && strcmp (name, bincl->name) == 0)
+	  found = i;
+      }
+  if (found >= 0)
+    return bincl_list[found].pst;
+  /* APPLE LOCAL end header file hash  */
 
   repeated_header_complaint (name, symnum);
   return (struct partial_symtab *) 0;
@@ -1226,6 +1395,11 @@ free_bincl_list (struct objfile *objfile)
 {
   xfree (bincl_list);
   bincls_allocated = 0;
+  /* APPLE LOCAL begin header file hash  */
+  xfree (bincl_buckets);
+  bincl_buckets = NULL;
+  n_bincl_buckets = 0;
+  /* APPLE LOCAL end header file hash  */
 }
 
 static void
@@ -1620,6 +1794,95 @@ parse_archive_name (char *oso_name, char **archive_name, char **module_name)
   return 1;
 }
 
+/* APPLE LOCAL begin debug map prefetch  */
+
+/* How many nlist records start_oso_prefetch reads at a time.  */
+#define OSO_PREFETCH_NLIST_CHUNK 4096
+
+/* Walk the SYMCOUNT symbols at SYMTAB_OFFSET in OBJFILE, collecting
+   the names of the .o files (or, for members, the .a files) named by
+   its DWARF debug map, and hand them to dwarf2_start_oso_prefetch in
+   the order read_dbx_symtab will open them.  This leaves the file
+   position of OBJFILE's bfd undefined.  */
+
+static struct dwarf2_oso_prefetch *
+start_oso_prefetch (struct objfile *objfile, file_ptr symtab_offset,
+		    int symcount)
+{
+  bfd *abfd = objfile->obfd;
+  unsigned int size = DBX_SYMBOL_SIZE (objfile);
+  char *stringtab = DBX_STRINGTAB (objfile);
+  unsigned int stringtab_size = DBX_STRINGTAB_SIZE (objfile);
+  char **names = NULL;
+  int n_names = 0;
+  int names_size = 0;
+  gdb_byte *buf;
+  struct cleanup *back_to;
+  int done, chunk, i;
+
+  if (size == 0 || symcount <= 0 || stringtab == NULL)
+    return NULL;
+  if (bfd_seek (abfd, symtab_offset, SEEK_SET) != 0)
+    return NULL;
+
+  buf = xmalloc (OSO_PREFETCH_NLIST_CHUNK * size);
+  back_to = make_cleanup (xfree, buf);
+
+  for (done = 0; done < symcount; done += chunk)
+    {
+      chunk = symcount - done;
+      if (chunk > OSO_PREFETCH_NLIST_CHUNK)
+	chunk = OSO_PREFETCH_NLIST_CHUNK;
+      if (bfd_bread (buf, chunk * size, abfd) != chunk * size)
+	break;
+
+      for (i = 0; i < chunk; i++)
+	{
+	  struct internal_nlist nlist;
+	  int sect_p;
+	  char *name, *path;
+
+	  INTERNALIZE_SYMBOL (nlist, sect_p,
+			      (struct external_nlist *) (buf + i * size), abfd);
+	  if (nlist.n_type != N_OSO || nlist.n_desc != 1
+	      || nlist.n_strx >= stringtab_size)
+	    continue;
+
+	  name = stringtab + nlist.n_strx;
+	  if (name[0] == '\0')
+	    continue;
+	  if (!parse_archive_name (name, &path, NULL))
+	    path = xstrdup (name);
+
+	  /* Members of the same archive come one after another, and
+	     we only need to read the archive once.  */
+	  if (n_names > 0 && strcmp (names[n_names - 1], path) == 0)
+	    {
+	      xfree (path);
+	      continue;
+	    }
+
+	  if (n_names == names_size)
+	    {
+	      names_size = names_size ? names_size * 2 : 64;
+	      names = xrealloc (names, names_size * sizeof (char *));
+	    }
+	  names[n_names++] = path;
+	}
+    }
+
+  do_cleanups (back_to);
+
+  if (n_names == 0)
+    {
+      xfree (names);
+      return NULL;
+    }
+
+  return dwarf2_start_oso_prefetch (names, n_names);
+}
+/* APPLE LOCAL end debug map prefetch  */
+
 /* APPLE LOCAL: pass in the # of stab nlist records we're going to parse. */
 static void
 read_dbx_symtab (struct objfile *objfile, int dbx_symcount)
@@ -3525,9 +3788,11 @@ open_bfd_from_oso (struct partial_symtab *pst, int *cached)
 	    }
 	}
 
-      member_bfd = bfd_openr_next_archived_file (archive_bfd, NULL);
-
-      if (member_bfd == NULL)
+      /* The archive stays in the containing archive cache, so BFD
+	 only has to index its members the first time we look one up.  */
+      member_bfd = bfd_openr_archived_file_by_name (archive_bfd, member_name);
+      if (member_bfd == NULL
+	  && bfd_get_error () != bfd_error_no_more_archived_files)
 	{
 	  warning ("Could not read archive members out of OSO archive \"%s\"",
 		   archive_name);
@@ -3535,12 +3800,6 @@ open_bfd_from_oso (struct partial_symtab *pst, int *cached)
 	  goto do_cleanups;
 	}
 
-      while (member_bfd != NULL)
-	{
-	  if (strcmp (member_bfd->filename, member_name) == 0)
-	    break;
-          member_bfd = bfd_openr_next_archived_file (archive_bfd, member_bfd);
-	}
       if (member_bfd == NULL)
 	{
 	  warning ("Could not find specified archive member for OSO name \"%s\"",
@@ -5978,7 +6237,8 @@ objfile_contains_objc (struct objfile *objfile)
    to conserve address space.  We need to pull in a separate file
    from disk with the nlist records/real strings.  This function
    adds those records to the objfile's minsyms before we process whatever
-   is actually present in memory.  */
+   is actually present in memory.  NLIST_RECORDS_BASE and STRINGS_BASE
+   point into the mapped shared cache and are read in place.  */
 
 void
 add_dyld_shared_cache_local_symbols (struct objfile *objfile, uint8_t *nlist_records_base, 
@@ -6027,7 +6287,10 @@ add_dyld_shared_cache_local_symbols (struct objfile *objfile, uint8_t *nlist_rec
         }
       if (*(strings_base + str_off) == '_')
         str_off++;
-      name = xstrdup (strings_base + str_off);
+      /* The strings live in the mmapped shared cache for the rest of
+         the session, and the minsym gets its own copy of the name, so
+         there's no need to duplicate it here.  */
+      name = strings_base + str_off;
       record_minimal_symbol (name, address, type, desc, objfile);
       i++;
     }
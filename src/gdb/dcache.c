@@ -100,6 +100,14 @@
 
 #define DCACHE_SIZE 64
 
+/* APPLE LOCAL: The number of cache blocks used to be fixed by
+   DCACHE_SIZE, which is now just the default for "set dcache-depth".  */
+static int g_cache_depth = DCACHE_SIZE;
+
+/* APPLE LOCAL: The most lines dcache_read_ahead will fetch in one
+   target read.  0 or 1 turns read-ahead off.  */
+static int g_readahead_max = 8;
+
 /* This value regulates the size of a cache line.  Smaller values
    reduce the time taken to read a single byte, but reduce overall
    throughput.  */
@@ -172,6 +180,23 @@ struct dcache_struct
     struct dcache_block *the_cache;
     gdb_byte *data_block;
     unsigned char *state_block;
+
+    /* APPLE LOCAL begin dcache read-ahead  */
+    /* Address of the last line we had to read from the target, and
+       how many lines the next read will fetch if it is for the line
+       after that one.  See dcache_read_ahead.  */
+    CORE_ADDR last_miss_addr;
+    int readahead;
+
+    /* Statistics for "info dcache".  HITS and MISSES count lines
+       looked at by dcache_peek_line; PREFETCH_READS is the number of
+       target reads that fetched more than one line, and
+       PREFETCHED_LINES the lines beyond the first they brought in.  */
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long prefetch_reads;
+    unsigned long prefetched_lines;
+    /* APPLE LOCAL end dcache read-ahead  */
   };
 
 static struct dcache_block *dcache_hit (DCACHE *dcache, CORE_ADDR addr);
@@ -217,7 +242,10 @@ dcache_invalidate (DCACHE *dcache)
   dcache->free_head = 0;
   dcache->free_tail = 0;
 
-  for (i = 0; i < DCACHE_SIZE; i++)
+  /* APPLE LOCAL dcache read-ahead  */
+  dcache->readahead = 1;
+
+  for (i = 0; i < g_cache_depth; i++)
     {
       struct dcache_block *db = dcache->the_cache + i;
 
@@ -449,15 +477,136 @@ dcache_writeback (DCACHE *dcache)
 }
 
 
-/* Using the data cache DCACHE return the contents of the byte at
-   address ADDR in the remote machine.  
+/* APPLE LOCAL begin dcache read-ahead  */
+/* Like dcache_hit, but don't count the lookup as a reference.  */
+
+static struct dcache_block *
+dcache_lookup (DCACHE *dcache, CORE_ADDR addr)
+{
+  struct dcache_block *db;
+
+  for (db = dcache->valid_head; db; db = db->p)
+    if (MASK (addr) == db->addr)
+      return db;
+  return NULL;
+}
+
+/* Fill DB, a line we missed on, from the target, along with as many of
+   the lines that follow it as the read-ahead window says, all in one
+   target read.  The window doubles each time we miss on the line just
+   after the last one we read, as when walking a string, an array or
+   the stack, and drops back to a single line on any other miss.
+   Lines already in the cache with dirty bytes are left alone.  If the
+   whole window isn't cacheable memory in one region, or the target
+   can't read the line we actually want as part of it, this is just
+   dcache_read_line.
+
+   Returns 0 on error.  */
+
+static int
+dcache_read_ahead (DCACHE *dcache, struct dcache_block *db)
+{
+  CORE_ADDR addr = db->addr;
+  CORE_ADDR end;
+  struct mem_region *region;
+  gdb_byte *buf;
+  int nlines, nread, res, i;
+
+  if (dcache->readahead > 1 && addr == dcache->last_miss_addr + g_line_size)
+    nlines = dcache->readahead;
+  else
+    nlines = 1;
+
+  /* Don't let one read push out more than half the cache.  */
+  if (nlines > g_cache_depth / 2)
+    nlines = g_cache_depth / 2;
+
+  if (nlines > 1)
+    {
+      end = addr + (CORE_ADDR) nlines * g_line_size;
+      region = lookup_mem_region (addr);
+      if (end <= addr
+	  || !(end <= region->hi || region->hi == 0)
+	  || !(region->attrib.cache == 1) || region->attrib.mode == MEM_WO)
+	nlines = 1;
+    }
+
+  /* Next time, read twice as far if the miss is just past this one.  */
+  if (g_readahead_max > 1)
+    {
+      dcache->readahead = (nlines > 1 ? nlines : 1) * 2;
+      if (dcache->readahead > g_readahead_max)
+	dcache->readahead = g_readahead_max;
+    }
+  else
+    dcache->readahead = 1;
+
+  if (nlines <= 1)
+    {
+      dcache->last_miss_addr = addr;
+      return dcache_read_line (dcache, db);
+    }
+
+  if (db->anydirty && !dcache_write_line (dcache, db))
+    return 0;
+
+  buf = xmalloc (nlines * g_line_size);
+  res = target_read (&current_target, TARGET_OBJECT_RAW_MEMORY,
+		     NULL, buf, addr, nlines * g_line_size);
+  nread = res > 0 ? res / g_line_size : 0;
+  if (nread == 0)
+    {
+      /* Maybe it's the lines after this one that aren't readable.  */
+      xfree (buf);
+      dcache->readahead = 1;
+      dcache->last_miss_addr = addr;
+      return dcache_read_line (dcache, db);
+    }
+
+  memcpy (db->data, buf, g_line_size);
+  memset (db->state, ENTRY_OK, g_line_size * sizeof (unsigned char));
+  db->anydirty = 0;
+
+  for (i = 1; i < nread; i++)
+    {
+      CORE_ADDR line_addr = addr + (CORE_ADDR) i * g_line_size;
+      struct dcache_block *next = dcache_lookup (dcache, line_addr);
+
+      if (next == NULL)
+	{
+	  /* Don't push out the line we were asked for.  */
+	  if (dcache->free_head == NULL && dcache->valid_head == db)
+	    break;
+	  next = dcache_alloc (dcache, line_addr);
+	  if (next == NULL)
+	    break;
+	}
+      else if (next->anydirty)
+	continue;
+
+      memcpy (next->data, buf + i * g_line_size, g_line_size);
+      memset (next->state, ENTRY_OK, g_line_size * sizeof (unsigned char));
+      dcache->prefetched_lines++;
+    }
+  xfree (buf);
+
+  dcache->prefetch_reads++;
+  dcache->last_miss_addr = addr + (CORE_ADDR) (nread - 1) * g_line_size;
+  return 1;
+}
+
+/* Using the data cache DCACHE, copy the LEN bytes at address ADDR in
+   the remote machine to PTR.  They must all be in one cache line.
+   This replaces dcache_peek_byte, so that the cache is searched once
+   per line rather than once per byte.
 
    Returns 0 on error. */
 
 static int
-dcache_peek_byte (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr)
+dcache_peek_line (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr, int len)
 {
   struct dcache_block *db = dcache_hit (dcache, addr);
+  int i;
 
   if (!db)
     {
@@ -465,16 +614,24 @@ dcache_peek_byte (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr)
       if (!db)
 	return 0;
     }
-  
-  if (db->state[XFORM (addr)] == ENTRY_BAD)
+
+  for (i = 0; i < len; i++)
+    if (db->state[XFORM (addr) + i] == ENTRY_BAD)
+      break;
+
+  if (i < len)
     {
-      if (!dcache_read_line(dcache, db))
-         return 0;
+      dcache->misses++;
+      if (!dcache_read_ahead (dcache, db))
+	return 0;
     }
+  else
+    dcache->hits++;
 
-  *ptr = db->data[XFORM (addr)];
+  memcpy (ptr, db->data + XFORM (addr), len);
   return 1;
 }
+/* APPLE LOCAL end dcache read-ahead  */
 
 
 /* Write the byte at PTR into ADDR in the data cache.
@@ -505,10 +662,10 @@ dcache_set_data (DCACHE *dcache)
 
   int i;
 
-  dcache->data_block = xmalloc (g_line_size * DCACHE_SIZE * sizeof (gdb_byte));
-  dcache->state_block = xmalloc (g_line_size * DCACHE_SIZE * sizeof (unsigned char));
+  dcache->data_block = xmalloc (g_line_size * g_cache_depth * sizeof (gdb_byte));
+  dcache->state_block = xmalloc (g_line_size * g_cache_depth * sizeof (unsigned char));
   
-  for (i = 0; i < DCACHE_SIZE; i++)
+  for (i = 0; i < g_cache_depth; i++)
     {
       dcache->the_cache[i].data = dcache->data_block + (i * g_line_size);
       dcache->the_cache[i].state = dcache->state_block + (i * g_line_size);
@@ -518,6 +675,10 @@ dcache_set_data (DCACHE *dcache)
 static void
 dcache_resize (DCACHE *dcache)
 {
+  /* APPLE LOCAL: The number of blocks can change too.  */
+  xfree (dcache->the_cache);
+  dcache->the_cache = (struct dcache_block *)
+    xcalloc (g_cache_depth, sizeof (struct dcache_block));
   xfree (dcache->data_block);
   xfree (dcache->state_block);
   dcache_set_data (dcache);
@@ -527,10 +688,11 @@ dcache_resize (DCACHE *dcache)
 DCACHE *
 dcache_init (void)
 {
-  int csize = sizeof (struct dcache_block) * DCACHE_SIZE;
+  int csize = sizeof (struct dcache_block) * g_cache_depth;
   DCACHE *dcache;
 
-  dcache = (DCACHE *) xmalloc (sizeof (*dcache));
+  /* APPLE LOCAL dcache read-ahead: Zero the statistics too.  */
+  dcache = (DCACHE *) xcalloc (1, sizeof (*dcache));
 
   dcache->the_cache = (struct dcache_block *) xmalloc (csize);
   memset (dcache->the_cache, 0, csize);
@@ -586,12 +748,27 @@ dcache_xfer_memory (DCACHE *dcache, CORE_ADDR memaddr, gdb_byte *myaddr,
 		    int len, int should_write)
 {
   int i;
-  int (*xfunc) (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr);
-  xfunc = should_write ? dcache_poke_byte : dcache_peek_byte;
+
+  /* APPLE LOCAL begin dcache read-ahead  */
+  if (!should_write)
+    {
+      for (i = 0; i < len; )
+	{
+	  int chunk = g_line_size - XFORM (memaddr + i);
+
+	  if (chunk > len - i)
+	    chunk = len - i;
+	  if (!dcache_peek_line (dcache, memaddr + i, myaddr + i, chunk))
+	    return 0;
+	  i += chunk;
+	}
+      return len;
+    }
+  /* APPLE LOCAL end dcache read-ahead  */
 
   for (i = 0; i < len; i++)
     {
-      if (!xfunc (dcache, memaddr + i, myaddr + i))
+      if (!dcache_poke_byte (dcache, memaddr + i, myaddr + i))
 	return 0;
     }
 
@@ -617,10 +794,18 @@ dcache_info (char *exp, int tty)
   int i;
 
   printf_filtered (_("Dcache line width %d, depth %d\n"),
-		   g_line_size, DCACHE_SIZE);
+		   g_line_size, g_cache_depth);
 
   for (i = 0; i < g_num_caches; i++)
     {
+      /* APPLE LOCAL begin dcache read-ahead  */
+      DCACHE *dcache = g_cache_array[i];
+
+      printf_filtered (_("Line hits %lu, misses %lu\n"),
+		       dcache->hits, dcache->misses);
+      printf_filtered (_("Lines prefetched %lu, in %lu reads\n"),
+		       dcache->prefetched_lines, dcache->prefetch_reads);
+      /* APPLE LOCAL end dcache read-ahead  */
       printf_filtered (_("Cache state:\n"));
 
       for (p = g_cache_array[i]->valid_head; p; p = p->p)
@@ -659,6 +844,37 @@ set_cache_line_power (char *args, int from_tty, struct cmd_list_element *c)
     }
 }
 
+/* APPLE LOCAL begin dcache read-ahead  */
+static void
+set_cache_depth (char *args, int from_tty, struct cmd_list_element *c)
+{
+  static int current_depth = DCACHE_SIZE;
+  int new_depth = g_cache_depth;
+  int i;
+
+  if (new_depth < 1)
+    {
+      g_cache_depth = current_depth;
+      error (_("The dcache depth must be at least 1."));
+    }
+
+  /* The blocks have to be flushed and freed at the old depth.  */
+  g_cache_depth = current_depth;
+  for (i = 0; i < g_num_caches; i++)
+    {
+      dcache_writeback (g_cache_array[i]);
+      dcache_invalidate (g_cache_array[i]);
+    }
+
+  g_cache_depth = current_depth = new_depth;
+  for (i = 0; i < g_num_caches; i++)
+    {
+      dcache_resize (g_cache_array[i]);
+      dcache_invalidate (g_cache_array[i]);
+    }
+}
+/* APPLE LOCAL end dcache read-ahead  */
+
 void
 _initialize_dcache (void)
 {
@@ -686,4 +902,26 @@ volatile registers are in use.  By default, this option is off."),
                          set_cache_line_power,
                          NULL,
                          &setlist, &showlist);
+
+  /* APPLE LOCAL begin dcache read-ahead  */
+  add_setshow_zinteger_cmd ("dcache-depth", class_support,
+			    &g_cache_depth, _("\
+Set the number of lines in the dcache."), _("\
+Show the number of lines in the dcache."), NULL,
+			    set_cache_depth,
+			    NULL,
+			    &setlist, &showlist);
+
+  add_setshow_zinteger_cmd ("dcache-readahead", class_support,
+			    &g_readahead_max, _("\
+Set the most dcache lines read from the target at once."), _("\
+Show the most dcache lines read from the target at once."), _("\
+When the dcache misses on the line just after the one it last read,\n\
+it reads that line and up to this many lines after it (but never more\n\
+than half the cache) in one request, doubling the count on each such\n\
+miss.  0 or 1 reads a single line at a time."),
+			    NULL,
+			    NULL,
+			    &setlist, &showlist);
+  /* APPLE LOCAL end dcache read-ahead  */
 }
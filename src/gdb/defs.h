@@ -862,6 +862,10 @@ const char *re_comp (const char *str);
 
 int re_exec (const char *str);
 
+/* APPLE LOCAL shared regex buffers  */
+const char *re_comp_buf (regex_t *buf, const char *str);
+int re_exec_buf (const regex_t *buf, const char *str);
+
 int re_set_syntax (int newflags);
 
 int re_search_oneshot (regex_t *patbuf, const char *str, int size, int start, int range, void *regs);
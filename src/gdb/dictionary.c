@@ -99,7 +99,14 @@ enum dict_type
     /* Symbols are stored in a fixed-size array.  */
     DICT_LINEAR,
     /* Symbols are stored in an expandable array.  */
-    DICT_LINEAR_EXPANDABLE
+    DICT_LINEAR_EXPANDABLE,
+    /* APPLE LOCAL lazy dictionaries: Symbols haven't been computed
+       yet; the dictionary turns into a DICT_HASHED or DICT_LINEAR
+       one the first time it's used.  */
+    DICT_LAZY,
+    /* APPLE LOCAL frozen dictionaries: Symbols are stored in a flat
+       array grouped by hash bucket, with their hashes alongside.  */
+    DICT_HASHED_FROZEN
   };
 
 /* The virtual function table.  */
@@ -163,6 +170,32 @@ struct dictionary_linear_expandable
   int capacity;
 };
 
+/* APPLE LOCAL begin lazy dictionaries  */
+struct dictionary_lazy
+{
+  /* The function computing the real dictionary, and its argument.  */
+  struct dictionary *(*expand) (void *data);
+  void *data;
+};
+/* APPLE LOCAL end lazy dictionaries  */
+
+/* APPLE LOCAL begin frozen dictionaries  */
+/* The first two members must stay the same as dictionary_linear's,
+   so that the linear iterators walk every symbol.  SYMS is ordered by
+   bucket; the symbols in bucket B are SYMS[BUCKET_START[B]] up to
+   SYMS[BUCKET_START[B + 1]], and HASHES[I] is the msymbol_hash_iw of
+   SYMS[I]'s search name.  The number of buckets is a power of two,
+   MASK + 1.  */
+struct dictionary_hashed_frozen
+{
+  int nsyms;
+  struct symbol **syms;
+  unsigned int *hashes;
+  unsigned int *bucket_start;
+  unsigned int mask;
+};
+/* APPLE LOCAL end frozen dictionaries  */
+
 /* And now, the star of our show.  */
 
 struct dictionary
@@ -174,6 +207,10 @@ struct dictionary
     struct dictionary_hashed_expandable hashed_expandable;
     struct dictionary_linear linear;
     struct dictionary_linear_expandable linear_expandable;
+    /* APPLE LOCAL lazy dictionaries  */
+    struct dictionary_lazy lazy;
+    /* APPLE LOCAL frozen dictionaries  */
+    struct dictionary_hashed_frozen hashed_frozen;
   }
   data;
 };
@@ -199,6 +236,23 @@ struct dictionary
 #define DICT_LINEAR_EXPANDABLE_CAPACITY(d) \
 		(d)->data.linear_expandable.capacity
 
+/* APPLE LOCAL lazy dictionaries  */
+#define DICT_LAZY_EXPAND(d)		(d)->data.lazy.expand
+#define DICT_LAZY_DATA(d)		(d)->data.lazy.data
+
+/* APPLE LOCAL begin frozen dictionaries: DICT_LINEAR_NSYMS and
+   DICT_LINEAR_SYMS work on DICT_HASHED_FROZEN too.  */
+#define DICT_FROZEN_HASHES(d)		(d)->data.hashed_frozen.hashes
+#define DICT_FROZEN_BUCKET_START(d)	(d)->data.hashed_frozen.bucket_start
+#define DICT_FROZEN_MASK(d)		(d)->data.hashed_frozen.mask
+
+/* dict_create_hashed makes a frozen dictionary instead of chaining
+   the symbols when there are at least this many; below it, the
+   chains are short enough that it doesn't matter.  */
+
+#define DICT_FROZEN_MIN_SYMS 64
+/* APPLE LOCAL end frozen dictionaries  */
+
 /* The initial size of a DICT_*_EXPANDABLE dictionary.  */
 
 #define DICT_EXPANDABLE_INITIAL_CAPACITY 10
@@ -282,6 +336,36 @@ static void free_linear_expandable (struct dictionary *dict);
 static void add_symbol_linear_expandable (struct dictionary *dict,
 					  struct symbol *sym);
 
+/* APPLE LOCAL begin lazy dictionaries  */
+/* Functions for DICT_LAZY.  */
+
+static struct symbol *iterator_first_lazy (const struct dictionary *dict,
+					   struct dict_iterator *iterator);
+
+static struct symbol *iterator_next_lazy (struct dict_iterator *iterator);
+
+static struct symbol *iter_name_first_lazy (const struct dictionary *dict,
+					    const char *name,
+					    struct dict_iterator *iterator);
+
+static struct symbol *iter_name_next_lazy (const char *name,
+					   struct dict_iterator *iterator);
+
+static int size_lazy (const struct dictionary *dict);
+
+/* APPLE LOCAL begin frozen dictionaries  */
+/* Functions for DICT_HASHED_FROZEN.  Iterating over every symbol is
+   done with the linear functions.  */
+
+static struct symbol *iter_name_first_frozen (const struct dictionary *dict,
+					      const char *name,
+					      struct dict_iterator *iterator);
+
+static struct symbol *iter_name_next_frozen (const char *name,
+					     struct dict_iterator *iterator);
+/* APPLE LOCAL end frozen dictionaries  */
+/* APPLE LOCAL end lazy dictionaries  */
+
 /* Various vectors that we'll actually use.  */
 
 static const struct dict_vector dict_hashed_vector =
@@ -332,6 +416,34 @@ static const struct dict_vector dict_linear_expandable_vector =
     size_linear,			/* size */
   };
 
+/* APPLE LOCAL begin lazy dictionaries  */
+static const struct dict_vector dict_lazy_vector =
+  {
+    DICT_LAZY,				/* type */
+    free_obstack,			/* free */
+    add_symbol_nonexpandable,		/* add_symbol */
+    iterator_first_lazy,		/* iteractor_first */
+    iterator_next_lazy,			/* iterator_next */
+    iter_name_first_lazy,		/* iter_name_first */
+    iter_name_next_lazy,		/* iter_name_next */
+    size_lazy,				/* size */
+  };
+/* APPLE LOCAL end lazy dictionaries  */
+
+/* APPLE LOCAL begin frozen dictionaries  */
+static const struct dict_vector dict_hashed_frozen_vector =
+  {
+    DICT_HASHED_FROZEN,			/* type */
+    free_obstack,			/* free */
+    add_symbol_nonexpandable,		/* add_symbol */
+    iterator_first_linear,		/* iteractor_first */
+    iterator_next_linear,		/* iterator_next */
+    iter_name_first_frozen,		/* iter_name_first */
+    iter_name_next_frozen,		/* iter_name_next */
+    size_linear,			/* size */
+  };
+/* APPLE LOCAL end frozen dictionaries  */
+
 /* Declarations of helper functions (i.e. ones that don't go into
    vectors).  */
 
@@ -342,6 +454,13 @@ static void insert_symbol_hashed (struct dictionary *dict,
 
 static void expand_hashtable (struct dictionary *dict);
 
+/* APPLE LOCAL lazy dictionaries  */
+static void expand_lazy (const struct dictionary *dict);
+
+/* APPLE LOCAL frozen dictionaries  */
+static struct dictionary *create_hashed_frozen
+  (struct obstack *obstack, const struct pending *symbol_list, int nsyms);
+
 /* The creation functions.  */
 
 /* Create a dictionary implemented via a fixed-size hashtable.  All
@@ -357,9 +476,6 @@ dict_create_hashed (struct obstack *obstack,
   struct symbol **buckets;
   const struct pending *list_counter;
 
-  retval = obstack_alloc (obstack, sizeof (struct dictionary));
-  DICT_VECTOR (retval) = &dict_hashed_vector;
-
   /* Calculate the number of symbols, and allocate space for them.  */
   for (list_counter = symbol_list;
        list_counter != NULL;
@@ -367,6 +483,14 @@ dict_create_hashed (struct obstack *obstack,
     {
       nsyms += list_counter->nsyms;
     }
+
+  /* APPLE LOCAL frozen dictionaries  */
+  if (nsyms >= DICT_FROZEN_MIN_SYMS)
+    return create_hashed_frozen (obstack, symbol_list, nsyms);
+
+  retval = obstack_alloc (obstack, sizeof (struct dictionary));
+  DICT_VECTOR (retval) = &dict_hashed_vector;
+
   nbuckets = DICT_HASHTABLE_SIZE (nsyms);
   DICT_HASHED_NBUCKETS (retval) = nbuckets;
   buckets = obstack_alloc (obstack, nbuckets * sizeof (struct symbol *));
@@ -387,6 +511,88 @@ dict_create_hashed (struct obstack *obstack,
   return retval;
 }
 
+/* APPLE LOCAL begin frozen dictionaries  */
+/* Create the frozen hashed dictionary dict_create_hashed makes for
+   the NSYMS symbols in SYMBOL_LIST, on OBSTACK.  There is about one
+   bucket per symbol, and they are laid out one after another, so a
+   lookup hashes the name once, goes to its bucket and compares the
+   stored hashes, only looking at a symbol's name when its hash
+   matches.  Within a bucket the symbols come in the order a
+   DICT_HASHED chain would have them.  */
+
+static struct dictionary *
+create_hashed_frozen (struct obstack *obstack,
+		      const struct pending *symbol_list, int nsyms)
+{
+  struct dictionary *retval;
+  struct symbol **syms;
+  unsigned int *hashes, *bucket_start, *fill;
+  unsigned int *sym_hashes;
+  unsigned int nbuckets, mask, b;
+  const struct pending *list_counter;
+  int i, n;
+
+  retval = obstack_alloc (obstack, sizeof (struct dictionary));
+  DICT_VECTOR (retval) = &dict_hashed_frozen_vector;
+
+  for (nbuckets = 1; nbuckets < nsyms; nbuckets <<= 1)
+    ;
+  mask = nbuckets - 1;
+
+  syms = obstack_alloc (obstack, nsyms * sizeof (struct symbol *));
+  hashes = obstack_alloc (obstack, nsyms * sizeof (unsigned int));
+  bucket_start = obstack_alloc (obstack,
+				(nbuckets + 1) * sizeof (unsigned int));
+
+  /* Hash each symbol once, in the order insert_symbol_hashed would
+     see them, and count the symbols in each bucket.  */
+  sym_hashes = xmalloc (nsyms * sizeof (unsigned int));
+  memset (bucket_start, 0, (nbuckets + 1) * sizeof (unsigned int));
+  n = 0;
+  for (list_counter = symbol_list;
+       list_counter != NULL;
+       list_counter = list_counter->next)
+    for (i = list_counter->nsyms - 1; i >= 0; --i)
+      {
+	struct symbol *sym = list_counter->symbol[i];
+
+	sym_hashes[n] = msymbol_hash_iw (SYMBOL_SEARCH_NAME (sym));
+	bucket_start[(sym_hashes[n] & mask) + 1]++;
+	n++;
+      }
+  for (b = 0; b < nbuckets; b++)
+    bucket_start[b + 1] += bucket_start[b];
+
+  /* Now place them.  Chaining puts the last symbol inserted first,
+     so fill each bucket from its end.  */
+  fill = xmalloc (nbuckets * sizeof (unsigned int));
+  for (b = 0; b < nbuckets; b++)
+    fill[b] = bucket_start[b + 1];
+  n = 0;
+  for (list_counter = symbol_list;
+       list_counter != NULL;
+       list_counter = list_counter->next)
+    for (i = list_counter->nsyms - 1; i >= 0; --i)
+      {
+	unsigned int slot = --fill[sym_hashes[n] & mask];
+
+	syms[slot] = list_counter->symbol[i];
+	hashes[slot] = sym_hashes[n];
+	n++;
+      }
+  xfree (fill);
+  xfree (sym_hashes);
+
+  DICT_LINEAR_NSYMS (retval) = nsyms;
+  DICT_LINEAR_SYMS (retval) = syms;
+  DICT_FROZEN_HASHES (retval) = hashes;
+  DICT_FROZEN_BUCKET_START (retval) = bucket_start;
+  DICT_FROZEN_MASK (retval) = mask;
+
+  return retval;
+}
+/* APPLE LOCAL end frozen dictionaries  */
+
 /* Create a dictionary implemented via a hashtable that grows as
    necessary.  The dictionary is initially empty; to add symbols to
    it, call dict_add_symbol().  Call dict_free() when you're done with
@@ -474,6 +680,26 @@ dict_create_linear_expandable (void)
   return retval;
 }
 
+/* APPLE LOCAL begin lazy dictionaries  */
+/* Create a dictionary whose contents are computed by EXPAND, called
+   with DATA, the first time they're needed.  The dictionary itself is
+   allocated on OBSTACK.  */
+
+struct dictionary *
+dict_create_lazy (struct obstack *obstack,
+		  struct dictionary *(*expand) (void *data), void *data)
+{
+  struct dictionary *retval;
+
+  retval = obstack_alloc (obstack, sizeof (struct dictionary));
+  DICT_VECTOR (retval) = &dict_lazy_vector;
+  DICT_LAZY_EXPAND (retval) = expand;
+  DICT_LAZY_DATA (retval) = data;
+
+  return retval;
+}
+/* APPLE LOCAL end lazy dictionaries  */
+
 /* The functions providing the dictionary interface.  */
 
 /* Free the memory used by a dictionary that's not on an obstack.  (If
@@ -845,3 +1071,149 @@ add_symbol_linear_expandable (struct dictionary *dict,
 
   DICT_LINEAR_SYM (dict, nsyms - 1) = sym;
 }
+
+/* APPLE LOCAL begin lazy dictionaries  */
+/* Functions for DICT_LAZY.  Each of them turns the dictionary into
+   the real one and then hands off to its vector.  */
+
+/* Compute the contents of the lazy dictionary DICT.  DICT is made an
+   empty linear dictionary before calling the expand function, so that
+   anyone looking at it while it's being expanded sees no symbols
+   instead of expanding it again, and so that it stays empty if the
+   expand function throws an error.  */
+
+static void
+expand_lazy (const struct dictionary *cdict)
+{
+  /* Expanding a dictionary doesn't change its logical contents.  */
+  struct dictionary *dict = (struct dictionary *) cdict;
+  struct dictionary *(*expand) (void *data) = DICT_LAZY_EXPAND (dict);
+  void *data = DICT_LAZY_DATA (dict);
+  struct dictionary *real;
+
+  DICT_VECTOR (dict) = &dict_linear_vector;
+  DICT_LINEAR_NSYMS (dict) = 0;
+  DICT_LINEAR_SYMS (dict) = NULL;
+
+  real = expand (data);
+
+  if (real != NULL)
+    {
+      gdb_assert (DICT_VECTOR (real) == &dict_hashed_vector
+		  /* APPLE LOCAL frozen dictionaries  */
+		  || DICT_VECTOR (real) == &dict_hashed_frozen_vector
+		  || DICT_VECTOR (real) == &dict_linear_vector);
+      *dict = *real;
+    }
+}
+
+static struct symbol *
+iterator_first_lazy (const struct dictionary *dict,
+		     struct dict_iterator *iterator)
+{
+  expand_lazy (dict);
+  return dict_iterator_first (dict, iterator);
+}
+
+static struct symbol *
+iterator_next_lazy (struct dict_iterator *iterator)
+{
+  /* The iterator was set up by iterator_first_lazy, which already
+     expanded the dictionary, so we should never get here.  */
+  internal_error (__FILE__, __LINE__,
+		  _("iterator_next_lazy called on an unexpanded dictionary"));
+  return NULL;
+}
+
+static struct symbol *
+iter_name_first_lazy (const struct dictionary *dict,
+		      const char *name,
+		      struct dict_iterator *iterator)
+{
+  expand_lazy (dict);
+  return dict_iter_name_first (dict, name, iterator);
+}
+
+static struct symbol *
+iter_name_next_lazy (const char *name, struct dict_iterator *iterator)
+{
+  internal_error (__FILE__, __LINE__,
+		  _("iter_name_next_lazy called on an unexpanded dictionary"));
+  return NULL;
+}
+
+static int
+size_lazy (const struct dictionary *dict)
+{
+  expand_lazy (dict);
+  return dict_size (dict);
+}
+/* APPLE LOCAL end lazy dictionaries  */
+
+/* APPLE LOCAL begin frozen dictionaries  */
+/* Functions for DICT_HASHED_FROZEN.  DICT_ITERATOR_INDEX is the index
+   in the dictionary's symbol array of the last symbol returned.  */
+
+/* Does SYM, whose search name hashes to SYM_HASH, match NAME, which
+   hashes to HASH?  As with the chained tables, equivalence names are
+   only found if they happen to be in NAME's bucket.  */
+
+static int
+frozen_symbol_matches (struct symbol *sym, unsigned int sym_hash,
+		       const char *name, unsigned int hash)
+{
+  /* Warning: the order of arguments to strcmp_iw matters!  */
+  if (sym_hash == hash && strcmp_iw (SYMBOL_SEARCH_NAME (sym), name) == 0)
+    return 1;
+  return (psym_equivalences
+	  && psym_name_match (SYMBOL_SEARCH_NAME (sym), name));
+}
+
+/* Return the first symbol matching NAME at or after index I in DICT's
+   symbol array, stopping at the end of the bucket, and leave its
+   index in ITERATOR.  */
+
+static struct symbol *
+frozen_bucket_search (const struct dictionary *dict, const char *name,
+		      unsigned int hash, unsigned int i,
+		      struct dict_iterator *iterator)
+{
+  unsigned int end
+    = DICT_FROZEN_BUCKET_START (dict)[(hash & DICT_FROZEN_MASK (dict)) + 1];
+  const unsigned int *hashes = DICT_FROZEN_HASHES (dict);
+
+  for (; i < end; i++)
+    if (frozen_symbol_matches (DICT_LINEAR_SYM (dict, i), hashes[i],
+			       name, hash))
+      {
+	DICT_ITERATOR_INDEX (iterator) = i;
+	return DICT_LINEAR_SYM (dict, i);
+      }
+
+  DICT_ITERATOR_INDEX (iterator) = end;
+  return NULL;
+}
+
+static struct symbol *
+iter_name_first_frozen (const struct dictionary *dict,
+			const char *name,
+			struct dict_iterator *iterator)
+{
+  unsigned int hash = msymbol_hash_iw (name);
+
+  DICT_ITERATOR_DICT (iterator) = dict;
+  return frozen_bucket_search
+    (dict, name, hash,
+     DICT_FROZEN_BUCKET_START (dict)[hash & DICT_FROZEN_MASK (dict)],
+     iterator);
+}
+
+static struct symbol *
+iter_name_next_frozen (const char *name, struct dict_iterator *iterator)
+{
+  const struct dictionary *dict = DICT_ITERATOR_DICT (iterator);
+
+  return frozen_bucket_search (dict, name, msymbol_hash_iw (name),
+			       DICT_ITERATOR_INDEX (iterator) + 1, iterator);
+}
+/* APPLE LOCAL end frozen dictionaries  */
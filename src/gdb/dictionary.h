@@ -72,6 +72,21 @@ extern struct dictionary *dict_create_linear (struct obstack *obstack,
 extern struct dictionary *dict_create_linear_expandable (void);
 
 
+/* APPLE LOCAL begin lazy dictionaries  */
+/* Create a dictionary whose contents aren't computed until they're
+   needed.  The first time the dictionary is looked at, EXPAND is
+   called with DATA; it should return a dictionary created by
+   dict_create_hashed or dict_create_linear, whose contents then
+   become the contents of this one.  If EXPAND returns NULL or throws
+   an error, the dictionary is left empty.  The dictionary itself is
+   allocated on OBSTACK.  */
+
+extern struct dictionary *dict_create_lazy (struct obstack *obstack,
+					    struct dictionary *(*expand)
+					      (void *data),
+					    void *data);
+/* APPLE LOCAL end lazy dictionaries  */
+
 /* The functions providing the interface to dictionaries.  Note that
    the most common parts of the interface, namely symbol lookup, are
    only provided via iterator functions.  */
@@ -29,6 +29,10 @@
 #include "gdbcore.h"
 #include "dis-asm.h"
 #include "gdb_assert.h"
+/* APPLE LOCAL begin disassembly cache  */
+#include "gdbcmd.h"
+#include "cli/cli-setshow.h"
+/* APPLE LOCAL end disassembly cache  */
 
 /* Disassemble functions.
    FIXME: We should get rid of all the duplicate code in gdb that does
@@ -69,6 +73,229 @@ dis_asm_print_address (bfd_vma addr, struct disassemble_info *info)
   print_address (addr, info->stream);
 }
 
+/* APPLE LOCAL begin disassembly cache  */
+/* IDEs ask for the disassembly of the current function after every
+   stepi.  gdb_disassembly reads the whole range it is asked for with
+   one target read, and keeps the text of each instruction it decodes
+   from it for the last few ranges.
+
+   A later request for the same range reads the memory again - once -
+   and reuses the decoded instructions only if the bytes are unchanged,
+   so breakpoints, fix-and-continue and self-modifying code all get
+   the new instructions.  The text also depends on the symbols used to
+   print addresses and on settings like the disassembly flavor, so an
+   entry is also stale once symbol_generation or setting_generation
+   moves on.  */
+
+#define DISASM_CACHE_SIZE 4
+
+/* Don't cache ranges bigger than this; "disassemble" of a whole
+   library would only push everything else out.  */
+
+#define DISASM_CACHE_MAX_BYTES 0x10000
+
+/* How far past the end of the range we read, so that decoding its
+   last instruction doesn't have to go to the target for the rest.  */
+
+#define DISASM_CACHE_SLACK 16
+
+struct disasm_cache_insn
+{
+  CORE_ADDR pc;
+  int length;
+  char *text;
+};
+
+struct disasm_cache_entry
+{
+  CORE_ADDR low;
+  CORE_ADDR high;
+  struct gdbarch *gdbarch;
+  int symbol_generation;
+  unsigned int setting_generation;
+
+  /* The target's memory at LOW ... LOW + NBYTES when the entry was
+     validated.  */
+  gdb_byte *bytes;
+  int nbytes;
+
+  /* The instructions decoded so far, sorted by pc.  */
+  struct disasm_cache_insn *insns;
+  int ninsns;
+  int insns_allocated;
+};
+
+extern int symbol_generation;
+
+/* The most recently used entry is first.  */
+
+static struct disasm_cache_entry disasm_cache[DISASM_CACHE_SIZE];
+
+static int disasm_cache_enabled = 1;
+
+static void
+show_disasm_cache_enabled (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Caching of disassembled instructions is %s.\n"),
+		    value);
+}
+
+static void
+disasm_cache_clear_insns (struct disasm_cache_entry *entry)
+{
+  int i;
+
+  for (i = 0; i < entry->ninsns; i++)
+    xfree (entry->insns[i].text);
+  entry->ninsns = 0;
+}
+
+static void
+disasm_cache_release (struct disasm_cache_entry *entry)
+{
+  disasm_cache_clear_insns (entry);
+  xfree (entry->insns);
+  xfree (entry->bytes);
+  memset (entry, 0, sizeof (struct disasm_cache_entry));
+}
+
+/* Return the cache entry for LOW ... HIGH, holding the target's
+   current memory for the range and whatever instructions can still be
+   trusted.  Return NULL if the range can't be cached.  */
+
+static struct disasm_cache_entry *
+disasm_cache_get (CORE_ADDR low, CORE_ADDR high)
+{
+  struct disasm_cache_entry *entry;
+  struct disasm_cache_entry found;
+  gdb_byte *bytes;
+  int nbytes;
+  int i;
+
+  if (!disasm_cache_enabled || high <= low
+      || high - low > DISASM_CACHE_MAX_BYTES)
+    return NULL;
+
+  nbytes = (int) (high - low) + DISASM_CACHE_SLACK;
+  bytes = xmalloc (nbytes);
+  if (target_read_memory (low, bytes, nbytes) != 0)
+    {
+      /* The range may end right at the end of the mapping.  */
+      nbytes = (int) (high - low);
+      if (target_read_memory (low, bytes, nbytes) != 0)
+	{
+	  xfree (bytes);
+	  return NULL;
+	}
+    }
+
+  for (i = 0; i < DISASM_CACHE_SIZE; i++)
+    {
+      entry = &disasm_cache[i];
+      if (entry->bytes != NULL && entry->low == low && entry->high == high
+	  && entry->gdbarch == current_gdbarch)
+	break;
+    }
+
+  if (i < DISASM_CACHE_SIZE)
+    {
+      found = disasm_cache[i];
+      memmove (&disasm_cache[1], &disasm_cache[0],
+	       i * sizeof (struct disasm_cache_entry));
+    }
+  else
+    {
+      disasm_cache_release (&disasm_cache[DISASM_CACHE_SIZE - 1]);
+      memmove (&disasm_cache[1], &disasm_cache[0],
+	       (DISASM_CACHE_SIZE - 1) * sizeof (struct disasm_cache_entry));
+      memset (&found, 0, sizeof (found));
+      found.low = low;
+      found.high = high;
+      found.gdbarch = current_gdbarch;
+    }
+
+  if (found.symbol_generation != symbol_generation
+      || found.setting_generation != setting_generation
+      || found.nbytes != nbytes
+      || memcmp (found.bytes, bytes, nbytes) != 0)
+    {
+      disasm_cache_clear_insns (&found);
+      xfree (found.bytes);
+      found.bytes = bytes;
+      found.nbytes = nbytes;
+      found.symbol_generation = symbol_generation;
+      found.setting_generation = setting_generation;
+    }
+  else
+    xfree (bytes);
+
+  disasm_cache[0] = found;
+  return &disasm_cache[0];
+}
+
+/* Return the index of the first instruction in ENTRY at or after PC.  */
+
+static int
+disasm_cache_search (struct disasm_cache_entry *entry, CORE_ADDR pc)
+{
+  int lo = 0;
+  int hi = entry->ninsns;
+
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+
+      if (entry->insns[mid].pc < pc)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Remember that the instruction at PC is LENGTH bytes long and reads
+   TEXT, which the cache now owns.  SLOT is where disasm_cache_search
+   said it goes.  */
+
+static void
+disasm_cache_add (struct disasm_cache_entry *entry, int slot, CORE_ADDR pc,
+		  int length, char *text)
+{
+  if (entry->ninsns == entry->insns_allocated)
+    {
+      entry->insns_allocated = entry->insns_allocated * 2 + 16;
+      entry->insns = xrealloc (entry->insns,
+			       entry->insns_allocated
+			       * sizeof (struct disasm_cache_insn));
+    }
+  memmove (&entry->insns[slot + 1], &entry->insns[slot],
+	   (entry->ninsns - slot) * sizeof (struct disasm_cache_insn));
+  entry->insns[slot].pc = pc;
+  entry->insns[slot].length = length;
+  entry->insns[slot].text = text;
+  entry->ninsns++;
+}
+
+/* Like dis_asm_read_memory, but serve what we can from the memory
+   read into the cache entry in INFO->application_data.  */
+
+static int
+dis_asm_read_cached_memory (bfd_vma memaddr, gdb_byte *myaddr,
+			    unsigned int len, struct disassemble_info *info)
+{
+  struct disasm_cache_entry *entry = info->application_data;
+
+  if (memaddr >= entry->low
+      && memaddr + len <= entry->low + entry->nbytes)
+    {
+      memcpy (myaddr, entry->bytes + (memaddr - entry->low), len);
+      return 0;
+    }
+  return target_read_memory (memaddr, myaddr, len);
+}
+/* APPLE LOCAL end disassembly cache  */
+
 static int
 compare_lines (const void *mle1p, const void *mle2p)
 {
@@ -99,11 +326,21 @@ dump_insns (struct ui_out *uiout, struct disassemble_info * di,
   int offset;
   int line;
   struct cleanup *ui_out_chain;
+  /* APPLE LOCAL begin disassembly cache  */
+  struct disasm_cache_entry *cache = NULL;
+
+  if (di->read_memory_func == dis_asm_read_cached_memory)
+    cache = di->application_data;
+  /* APPLE LOCAL end disassembly cache  */
 
   for (pc = low; pc < high;)
     {
       char *filename = NULL;
       char *name = NULL;
+      /* APPLE LOCAL begin disassembly cache  */
+      int slot = 0;
+      int length;
+      /* APPLE LOCAL end disassembly cache  */
 
       QUIT;
       if (how_many >= 0)
@@ -135,8 +372,31 @@ dump_insns (struct ui_out *uiout, struct disassemble_info * di,
       if (name != NULL)
 	xfree (name);
 
+      /* APPLE LOCAL begin disassembly cache  */
+      if (cache != NULL)
+	{
+	  slot = disasm_cache_search (cache, pc);
+	  if (slot < cache->ninsns && cache->insns[slot].pc == pc)
+	    {
+	      ui_out_field_string (uiout, "inst", cache->insns[slot].text);
+	      pc += cache->insns[slot].length;
+	      do_cleanups (ui_out_chain);
+	      ui_out_text (uiout, "\n");
+	      continue;
+	    }
+	}
+
       ui_file_rewind (stb->stream);
-      pc += TARGET_PRINT_INSN (pc, di);
+      length = TARGET_PRINT_INSN (pc, di);
+      if (cache != NULL && length > 0)
+	{
+	  long text_length;
+
+	  disasm_cache_add (cache, slot, pc, length,
+			    ui_file_xstrdup (stb->stream, &text_length));
+	}
+      pc += length;
+      /* APPLE LOCAL end disassembly cache  */
       ui_out_field_stream (uiout, "inst", stb);
       ui_file_rewind (stb->stream);
       do_cleanups (ui_out_chain);
@@ -373,6 +633,17 @@ gdb_disassembly (struct ui_out *uiout,
   struct symtab *symtab = NULL;
   struct linetable_entry *le = NULL;
   int nlines = -1;
+  /* APPLE LOCAL disassembly cache  */
+  struct disasm_cache_entry *cache;
+
+  /* APPLE LOCAL begin disassembly cache  */
+  cache = disasm_cache_get (low, high);
+  if (cache != NULL)
+    {
+      di.application_data = cache;
+      di.read_memory_func = dis_asm_read_cached_memory;
+    }
+  /* APPLE LOCAL end disassembly cache  */
 
   /* Assume symtab is valid for whole PC range */
   symtab = find_pc_symtab (low);
@@ -646,3 +917,21 @@ gdb_print_insn (CORE_ADDR memaddr, struct ui_file *stream)
   struct disassemble_info di = gdb_disassemble_info (current_gdbarch, stream);
   return TARGET_PRINT_INSN (memaddr, &di);
 }
+
+/* APPLE LOCAL begin disassembly cache  */
+void _initialize_disasm (void);
+
+void
+_initialize_disasm (void)
+{
+  add_setshow_boolean_cmd ("disassembly-cache", class_maintenance,
+			   &disasm_cache_enabled, _("\
+Set whether disassembled instructions are remembered."), _("\
+Show whether disassembled instructions are remembered."), _("\
+When on, the instructions of the last few ranges disassembled are kept,\n\
+and reused while the memory they were decoded from is unchanged."),
+			   NULL, show_disasm_cache_enabled,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+}
+/* APPLE LOCAL end disassembly cache  */
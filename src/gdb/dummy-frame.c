@@ -127,6 +127,24 @@ dummy_frame_push (struct regcache *caller_regcache,
   dummy_frame_stack = dummy_frame;
 }
 
+/* APPLE LOCAL begin dummy frame sniffing  */
+/* Return non-zero if some dummy frame's ID has PC as its code
+   address.  */
+
+static int
+dummy_frame_with_code_addr (CORE_ADDR pc)
+{
+  struct dummy_frame *dummyframe;
+
+  for (dummyframe = dummy_frame_stack;
+       dummyframe != NULL;
+       dummyframe = dummyframe->next)
+    if (dummyframe->id.code_addr == pc)
+      return 1;
+  return 0;
+}
+/* APPLE LOCAL end dummy frame sniffing  */
+
 /* Return the dummy frame cache, it contains both the ID, and a
    pointer to the regcache.  */
 struct dummy_frame_cache
@@ -151,8 +169,14 @@ dummy_frame_sniffer (const struct frame_unwind *self,
      that PC to apply standard frame ID unwind techniques is just
      asking for trouble.  */
   
-  /* Don't bother unles there is at least one dummy frame.  */
-  if (dummy_frame_stack != NULL)
+  /* Don't bother unles there is at least one dummy frame.  APPLE
+     LOCAL: Nor unless one of them returns to this frame's pc.  Every
+     unwind_dummy_id uses the frame's unwound pc as the ID's code
+     address, and that pc is already cached in NEXT_FRAME, so this
+     saves unwinding the stack and frame pointers for every frame of
+     every backtrace taken under a hand-called function.  */
+  if (dummy_frame_stack != NULL
+      && dummy_frame_with_code_addr (frame_pc_unwind (next_frame)))
     {
       /* Use an architecture specific method to extract the prev's
 	 dummy ID from the next frame.  Note that this method uses
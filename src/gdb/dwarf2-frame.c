@@ -107,7 +107,32 @@ struct dwarf2_fde
   struct dwarf2_fde *next;
 };
 
-static struct dwarf2_fde *dwarf2_frame_find_fde (CORE_ADDR *pc);
+/* APPLE LOCAL begin sorted fde table  */
+/* The FDEs of one objfile, hung off dwarf2_frame_objfile_data.  */
+
+struct dwarf2_fde_table
+{
+  /* Every FDE read, most recently added first.  */
+  struct dwarf2_fde *list;
+
+  /* LIST sorted by initial location, with empty FDEs dropped and
+     only the FDE that comes first in LIST kept for any address.
+     NULL until the first lookup after LIST changes.  */
+  struct dwarf2_fde **entries;
+  int num_entries;
+
+  /* APPLE LOCAL unwind row cache  */
+  /* DWARF2_FRAME_ROW_CACHE_SIZE decoded rows, or NULL until the first
+     frame in this objfile is unwound.  */
+  struct dwarf2_frame_row *rows;
+};
+/* APPLE LOCAL end sorted fde table  */
+
+static struct dwarf2_fde *dwarf2_frame_find_fde (CORE_ADDR *pc,
+						 struct objfile **objfile);
+
+/* APPLE LOCAL: Each objfile's struct dwarf2_fde_table.  */
+const struct objfile_data *dwarf2_frame_objfile_data;
 
 
 
@@ -784,6 +809,111 @@ dwarf2_frame_find_quirks (struct dwarf2_frame_state *fs,
 }
 
 
+/* APPLE LOCAL begin unwind row cache  */
+/* The register rules the CFA program of an FDE arrives at for one
+   stopping pc.  Running the program depends only on the FDE, that pc
+   and the architecture, so repeated backtraces through the same code
+   can reuse the row instead of interpreting the instructions again.  */
+
+struct dwarf2_frame_row
+{
+  /* The key; FDE is NULL for an empty slot.  */
+  struct dwarf2_fde *fde;
+  struct gdbarch *gdbarch;
+  CORE_ADDR pc;
+
+  /* The parts of the frame state dwarf2_frame_cache uses once the
+     program has run.  */
+  int cfa_how;
+  ULONGEST cfa_reg;
+  LONGEST cfa_offset;
+  gdb_byte *cfa_exp;
+  int num_regs;
+  struct dwarf2_frame_state_reg *reg;
+};
+
+/* Rows cached per objfile.  A power of two; each key has one slot,
+   and a new row simply replaces the old one.  */
+
+#define DWARF2_FRAME_ROW_CACHE_SIZE 1024
+
+/* Return the slot in OBJFILE's row cache for FDE, GDBARCH and PC,
+   which may hold some other row.  */
+
+static struct dwarf2_frame_row *
+dwarf2_frame_row_slot (struct objfile *objfile, struct gdbarch *gdbarch,
+		       struct dwarf2_fde *fde, CORE_ADDR pc)
+{
+  struct dwarf2_fde_table *table;
+  unsigned long hash;
+
+  table = objfile_data (objfile, dwarf2_frame_objfile_data);
+  gdb_assert (table != NULL);
+  if (table->rows == NULL)
+    table->rows = XCALLOC (DWARF2_FRAME_ROW_CACHE_SIZE,
+			   struct dwarf2_frame_row);
+
+  hash = (unsigned long) pc;
+  hash ^= hash >> 12;
+  hash ^= (unsigned long) fde >> 4;
+  return &table->rows[hash & (DWARF2_FRAME_ROW_CACHE_SIZE - 1)];
+}
+
+/* Record the state FS reached in ROW, under the given key.  */
+
+static void
+dwarf2_frame_row_save (struct dwarf2_frame_row *row,
+		       struct dwarf2_frame_state *fs, struct dwarf2_fde *fde,
+		       struct gdbarch *gdbarch, CORE_ADDR pc)
+{
+  size_t size = fs->regs.num_regs * sizeof (struct dwarf2_frame_state_reg);
+
+  row->reg = xrealloc (row->reg, size ? size : 1);
+  if (size)
+    memcpy (row->reg, fs->regs.reg, size);
+  row->num_regs = fs->regs.num_regs;
+  row->cfa_how = fs->cfa_how;
+  row->cfa_reg = fs->cfa_reg;
+  row->cfa_offset = fs->cfa_offset;
+  row->cfa_exp = fs->cfa_exp;
+  row->fde = fde;
+  row->gdbarch = gdbarch;
+  row->pc = pc;
+}
+
+/* Set up FS as if the CFA program had run and produced ROW.  */
+
+static void
+dwarf2_frame_row_restore (struct dwarf2_frame_row *row,
+			  struct dwarf2_frame_state *fs)
+{
+  dwarf2_frame_state_alloc_regs (&fs->regs, row->num_regs);
+  if (row->num_regs)
+    memcpy (fs->regs.reg, row->reg,
+	    row->num_regs * sizeof (struct dwarf2_frame_state_reg));
+  fs->cfa_how = row->cfa_how;
+  fs->cfa_reg = row->cfa_reg;
+  fs->cfa_offset = row->cfa_offset;
+  fs->cfa_exp = row->cfa_exp;
+}
+
+/* Free the row cache when the FDE table's objfile goes away.  */
+
+static void
+dwarf2_frame_free_fde_table (struct objfile *objfile, void *data)
+{
+  struct dwarf2_fde_table *table = data;
+  int i;
+
+  if (table->rows == NULL)
+    return;
+  for (i = 0; i < DWARF2_FRAME_ROW_CACHE_SIZE; i++)
+    xfree (table->rows[i].reg);
+  xfree (table->rows);
+  table->rows = NULL;
+}
+/* APPLE LOCAL end unwind row cache  */
+
 struct dwarf2_frame_cache
 {
   /* DWARF Call Frame Address.  */
@@ -823,6 +953,11 @@ dwarf2_frame_cache (struct frame_info *next_frame, void **this_cache)
   struct dwarf2_frame_cache *cache;
   struct dwarf2_frame_state *fs;
   struct dwarf2_fde *fde;
+  /* APPLE LOCAL begin unwind row cache  */
+  struct objfile *fde_objfile = NULL;
+  struct dwarf2_frame_row *row;
+  CORE_ADDR stop_pc;
+  /* APPLE LOCAL end unwind row cache  */
 
   if (*this_cache)
     return *this_cache;
@@ -854,7 +989,8 @@ dwarf2_frame_cache (struct frame_info *next_frame, void **this_cache)
   fs->pc = frame_unwind_address_in_block (next_frame);
 
   /* Find the correct FDE.  */
-  fde = dwarf2_frame_find_fde (&fs->pc);
+  /* APPLE LOCAL unwind row cache  */
+  fde = dwarf2_frame_find_fde (&fs->pc, &fde_objfile);
   gdb_assert (fde != NULL);
 
   /* Extract any interesting information from the CIE.  */
@@ -867,17 +1003,31 @@ dwarf2_frame_cache (struct frame_info *next_frame, void **this_cache)
 
   cache->eh_frame_p = fde->eh_frame_p;
 
-  /* First decode all the insns in the CIE.  */
-  execute_cfa_program (fde->cie->initial_instructions,
-		       fde->cie->end, next_frame, fs, fde->eh_frame_p);
+  /* APPLE LOCAL begin unwind row cache  */
+  /* execute_cfa_program stops at the unwound pc, so that (with the
+     FDE and the architecture) is what the result depends on.  */
+  stop_pc = frame_pc_unwind (next_frame);
+  gdb_assert (fde_objfile != NULL);
+  row = dwarf2_frame_row_slot (fde_objfile, gdbarch, fde, stop_pc);
+  if (row->fde == fde && row->gdbarch == gdbarch && row->pc == stop_pc)
+    dwarf2_frame_row_restore (row, fs);
+  else
+    {
+      /* First decode all the insns in the CIE.  */
+      execute_cfa_program (fde->cie->initial_instructions,
+			   fde->cie->end, next_frame, fs, fde->eh_frame_p);
 
-  /* Save the initialized register set.  */
-  fs->initial = fs->regs;
-  fs->initial.reg = dwarf2_frame_state_copy_regs (&fs->regs);
+      /* Save the initialized register set.  */
+      fs->initial = fs->regs;
+      fs->initial.reg = dwarf2_frame_state_copy_regs (&fs->regs);
 
-  /* Then decode the insns in the FDE up to our target PC.  */
-  execute_cfa_program (fde->instructions, fde->end, next_frame, fs,
-		       fde->eh_frame_p);
+      /* Then decode the insns in the FDE up to our target PC.  */
+      execute_cfa_program (fde->instructions, fde->end, next_frame, fs,
+			   fde->eh_frame_p);
+
+      dwarf2_frame_row_save (row, fs, fde, gdbarch, stop_pc);
+    }
+  /* APPLE LOCAL end unwind row cache  */
 
   /* Caclulate the CFA.  */
   switch (fs->cfa_how)
@@ -1228,7 +1378,7 @@ dwarf2_frame_sniffer (struct frame_info *next_frame)
      extend one byte before its start address or we will miss it.  */
   CORE_ADDR block_addr = frame_unwind_address_in_block (next_frame);
 
-  struct dwarf2_fde *fde = dwarf2_frame_find_fde (&block_addr);
+  struct dwarf2_fde *fde = dwarf2_frame_find_fde (&block_addr, NULL);
   if (!fde)
     return NULL;
 
@@ -1273,7 +1423,7 @@ dwarf2_frame_base_sniffer (struct frame_info *next_frame)
 {
   CORE_ADDR block_addr = frame_unwind_address_in_block (next_frame);
 
-  if (dwarf2_frame_find_fde (&block_addr))
+  if (dwarf2_frame_find_fde (&block_addr, NULL))
     return &dwarf2_frame_base;
 
   return NULL;
@@ -1308,8 +1458,6 @@ struct comp_unit
   bfd_vma tbase;
 };
 
-const struct objfile_data *dwarf2_frame_objfile_data;
-
 static unsigned int
 read_1_byte (bfd *abfd, gdb_byte *buf)
 {
@@ -1581,37 +1729,145 @@ add_cie (struct comp_unit *unit, struct dwarf2_cie *cie)
   unit->cie = cie;
 }
 
+/* APPLE LOCAL begin sorted fde table  */
+/* An FDE being sorted, with its position in the objfile's list.  */
+
+struct dwarf2_fde_sort_entry
+{
+  struct dwarf2_fde *fde;
+  int order;
+};
+
+/* qsort comparison for FDEs: by initial location, and for the same
+   location by position in the list.  */
+
+static int
+compare_fde_sort_entries (const void *a, const void *b)
+{
+  const struct dwarf2_fde_sort_entry *aa = a;
+  const struct dwarf2_fde_sort_entry *bb = b;
+
+  if (aa->fde->initial_location < bb->fde->initial_location)
+    return -1;
+  if (aa->fde->initial_location > bb->fde->initial_location)
+    return 1;
+  return aa->order - bb->order;
+}
+
+/* Build TABLE's sorted array of FDEs from its list.  The linear
+   search this replaces took the first FDE in the list that covered
+   the pc, so where FDEs overlap, keep the one earlier in the list;
+   in practice that is a .debug_frame FDE shadowing the .eh_frame one
+   for the same function.  */
+
+static void
+dwarf2_frame_sort_fdes (struct objfile *objfile,
+			struct dwarf2_fde_table *table)
+{
+  struct dwarf2_fde_sort_entry *sorted;
+  struct dwarf2_fde *fde;
+  int count = 0;
+  int i, n;
+
+  for (fde = table->list; fde != NULL; fde = fde->next)
+    if (fde->address_range != 0)
+      count++;
+
+  sorted = xmalloc ((count + 1) * sizeof (struct dwarf2_fde_sort_entry));
+  for (fde = table->list, i = 0; fde != NULL; fde = fde->next)
+    if (fde->address_range != 0)
+      {
+	sorted[i].fde = fde;
+	sorted[i].order = i;
+	i++;
+      }
+  qsort (sorted, count, sizeof (struct dwarf2_fde_sort_entry),
+	 compare_fde_sort_entries);
+
+  /* Drop any FDE that starts inside the previous one kept, unless it
+     comes before it in the list, in which case it replaces it.
+     Replacing can leave a tail of the old FDE uncovered; the linear
+     search would have found the old FDE there, but FDEs that
+     partially overlap don't happen in real code.  */
+  n = 0;
+  for (i = 0; i < count; i++)
+    {
+      if (n > 0)
+	{
+	  struct dwarf2_fde *prev = sorted[n - 1].fde;
+	  if (sorted[i].fde->initial_location
+	      < prev->initial_location + prev->address_range)
+	    {
+	      if (sorted[i].order < sorted[n - 1].order)
+		sorted[n - 1] = sorted[i];
+	      continue;
+	    }
+	}
+      sorted[n++] = sorted[i];
+    }
+
+  table->entries = (struct dwarf2_fde **)
+    obstack_alloc (&objfile->objfile_obstack,
+		   (n + 1) * sizeof (struct dwarf2_fde *));
+  for (i = 0; i < n; i++)
+    table->entries[i] = sorted[i].fde;
+  table->num_entries = n;
+  xfree (sorted);
+}
+/* APPLE LOCAL end sorted fde table  */
+
 /* Find the FDE for *PC.  Return a pointer to the FDE, and store the
-   inital location associated with it into *PC.  */
+   inital location associated with it into *PC.  APPLE LOCAL: If
+   OUT_OBJFILE is non-NULL, store the objfile the FDE came from in it.  */
 
 static struct dwarf2_fde *
-dwarf2_frame_find_fde (CORE_ADDR *pc)
+dwarf2_frame_find_fde (CORE_ADDR *pc, struct objfile **out_objfile)
 {
   struct objfile *objfile;
 
   ALL_OBJFILES (objfile)
     {
+      /* APPLE LOCAL begin sorted fde table  */
+      struct dwarf2_fde_table *table;
       struct dwarf2_fde *fde;
       CORE_ADDR offset;
+      CORE_ADDR addr;
+      int lo, hi;
 
-      fde = objfile_data (objfile, dwarf2_frame_objfile_data);
-      if (fde == NULL)
+      table = objfile_data (objfile, dwarf2_frame_objfile_data);
+      if (table == NULL || table->list == NULL)
 	continue;
 
       gdb_assert (objfile->section_offsets);
       offset = objfile_text_section_offset (objfile);
+      addr = *pc - offset;
+
+      if (table->entries == NULL)
+	dwarf2_frame_sort_fdes (objfile, table);
 
-      while (fde)
+      /* Find the last FDE starting at or before ADDR.  */
+      lo = 0;
+      hi = table->num_entries;
+      while (lo < hi)
 	{
-	  if (*pc >= fde->initial_location + offset
-	      && *pc < fde->initial_location + offset + fde->address_range)
-	    {
-	      *pc = fde->initial_location + offset;
-	      return fde;
-	    }
+	  int mid = lo + (hi - lo) / 2;
+	  if (table->entries[mid]->initial_location <= addr)
+	    lo = mid + 1;
+	  else
+	    hi = mid;
+	}
+      if (lo == 0)
+	continue;
 
-	  fde = fde->next;
+      fde = table->entries[lo - 1];
+      if (addr < fde->initial_location + fde->address_range)
+	{
+	  *pc = fde->initial_location + offset;
+	  if (out_objfile != NULL)
+	    *out_objfile = objfile;
+	  return fde;
 	}
+      /* APPLE LOCAL end sorted fde table  */
     }
 
   return NULL;
@@ -1620,8 +1876,23 @@ dwarf2_frame_find_fde (CORE_ADDR *pc)
 static void
 add_fde (struct comp_unit *unit, struct dwarf2_fde *fde)
 {
-  fde->next = objfile_data (unit->objfile, dwarf2_frame_objfile_data);
-  set_objfile_data (unit->objfile, dwarf2_frame_objfile_data, fde);
+  /* APPLE LOCAL begin sorted fde table  */
+  struct dwarf2_fde_table *table;
+
+  table = objfile_data (unit->objfile, dwarf2_frame_objfile_data);
+  if (table == NULL)
+    {
+      table = OBSTACK_ZALLOC (&unit->objfile->objfile_obstack,
+			      struct dwarf2_fde_table);
+      set_objfile_data (unit->objfile, dwarf2_frame_objfile_data, table);
+    }
+
+  fde->next = table->list;
+  table->list = fde;
+  /* Sort again at the next lookup.  */
+  table->entries = NULL;
+  table->num_entries = 0;
+  /* APPLE LOCAL end sorted fde table  */
 }
 
 #ifdef CC_HAS_LONG_LONG
@@ -2009,7 +2280,9 @@ dwarf2_build_frame_info (struct objfile *objfile)
       unit.dwarf_frame_buffer = dwarf2_read_section (objfile,  objfile->obfd,
 						     dwarf_eh_frame_section);
 
-      unit.dwarf_frame_size = bfd_get_section_size (dwarf_eh_frame_section);
+      /* APPLE LOCAL compressed debug sections  */
+      unit.dwarf_frame_size = dwarf2_section_size (objfile->obfd,
+						   dwarf_eh_frame_section);
       unit.dwarf_frame_section = dwarf_eh_frame_section;
 
       /* FIXME: kettenis/20030602: This is the DW_EH_PE_datarel base
@@ -2036,7 +2309,9 @@ dwarf2_build_frame_info (struct objfile *objfile)
       unit.cie = NULL;
       unit.dwarf_frame_buffer = dwarf2_read_section (objfile,  objfile->obfd,
 						     dwarf_frame_section);
-      unit.dwarf_frame_size = bfd_get_section_size (dwarf_frame_section);
+      /* APPLE LOCAL compressed debug sections  */
+      unit.dwarf_frame_size = dwarf2_section_size (objfile->obfd,
+						   dwarf_frame_section);
       unit.dwarf_frame_section = dwarf_frame_section;
 
       frame_ptr = unit.dwarf_frame_buffer;
@@ -2052,5 +2327,7 @@ void
 _initialize_dwarf2_frame (void)
 {
   dwarf2_frame_data = gdbarch_data_register_pre_init (dwarf2_frame_init);
-  dwarf2_frame_objfile_data = register_objfile_data ();
+  /* APPLE LOCAL unwind row cache  */
+  dwarf2_frame_objfile_data
+    = register_objfile_data_with_cleanup (dwarf2_frame_free_fde_table);
 }
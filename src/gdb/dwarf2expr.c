@@ -523,14 +523,23 @@ execute_stack_op (struct dwarf_expr_context *ctx,
 	       afterwards, effectively erasing whatever the recursive
 	       call put there.  */
 	    before_stack_len = ctx->stack_len;
-	    /* FIXME: cagney/2003-03-26: This code should be using
-               get_frame_base_address(), and then implement a dwarf2
-               specific this_base method.  */
-	    (ctx->get_frame_base) (ctx->baton, &datastart, &datalen);
-	    dwarf_expr_eval (ctx, datastart, datalen, eh_frame_p, addr_translation);
-	    result = dwarf_expr_fetch (ctx, 0);
-	    if (ctx->in_reg)
-	      result = (ctx->read_reg) (ctx->baton, result);
+	    /* APPLE LOCAL begin frame base cache  */
+	    if (ctx->get_cached_frame_base == NULL
+		|| !(ctx->get_cached_frame_base) (ctx->baton, &result))
+	      {
+		/* FIXME: cagney/2003-03-26: This code should be using
+		   get_frame_base_address(), and then implement a dwarf2
+		   specific this_base method.  */
+		(ctx->get_frame_base) (ctx->baton, &datastart, &datalen);
+		dwarf_expr_eval (ctx, datastart, datalen, eh_frame_p,
+				 addr_translation);
+		result = dwarf_expr_fetch (ctx, 0);
+		if (ctx->in_reg)
+		  result = (ctx->read_reg) (ctx->baton, result);
+		if (ctx->cache_frame_base != NULL)
+		  (ctx->cache_frame_base) (ctx->baton, result);
+	      }
+	    /* APPLE LOCAL end frame base cache  */
 	    result = result + offset;
 	    ctx->stack_len = before_stack_len;
 	    ctx->in_reg = 0;
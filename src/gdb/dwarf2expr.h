@@ -52,6 +52,17 @@ struct dwarf_expr_context
      expression evaluation is complete.  */
   void (*get_frame_base) (void *baton, gdb_byte **start, size_t *length);
 
+  /* APPLE LOCAL begin frame base cache  */
+  /* If not NULL, store in *BASE the frame base an earlier evaluation
+     worked out and return nonzero, or return zero to have it computed
+     from the get_frame_base expression.  */
+  int (*get_cached_frame_base) (void *baton, CORE_ADDR *base);
+
+  /* If not NULL, called with the frame base once it has been
+     computed.  */
+  void (*cache_frame_base) (void *baton, CORE_ADDR base);
+  /* APPLE LOCAL end frame base cache  */
+
   /* Return the thread-local storage address for
      DW_OP_GNU_push_tls_address.  */
   CORE_ADDR (*get_tls_address) (void *baton, CORE_ADDR offset);
@@ -38,6 +38,8 @@
 #include "dwarf2expr.h"
 #include "dwarf2loc.h"
 #include "dwarf2read.h"
+/* APPLE LOCAL compiled locations  */
+#include "dwarf2-frame.h"
 
 #include "gdb_string.h"
 
@@ -51,32 +53,207 @@ print_single_dwarf_location (struct ui_file *, gdb_byte **, gdb_byte *,
 			     struct dwarf_expr_context *);
 /* APPLE LOCAL end print location lists  */
 
-/* A helper function for dealing with location lists.  Given a
-   symbol baton (BATON) and a pc value (PC), find the appropriate
-   location expression, set *LOCEXPR_LENGTH, and return a pointer
-   to the beginning of the expression.  Returns NULL on failure.
+/* APPLE LOCAL begin compiled locations  */
+/* Almost every location expression a compiler emits is one of a few
+   shapes: a register, a register plus an offset, the frame base plus
+   an offset, or a fixed address.  Rather than run each of those
+   through the stack machine every time a variable is printed, the
+   first evaluation of a location decodes it into a
+   dwarf2_compiled_expr, and later ones use that to build the value
+   directly.  Anything else is marked DWARF2_LOC_GENERIC and goes to
+   dwarf_expr_eval as before.
+
+   A location list is decoded once into a table of its entries, with
+   their address ranges already based and translated, and each entry's
+   expression compiled the same way.  When the entries don't overlap,
+   which is the usual case, they are sorted by address and the entry
+   for a pc is found by binary search.  The table depends on how far
+   the objfile's text has been slid, and is rebuilt if that changes.
+
+   All of this lives on the objfile's obstack, hung off the symbol's
+   dwarf2_address_translation baton.  */
+
+enum dwarf2_compiled_kind
+{
+  /* Not decoded yet.  */
+  DWARF2_LOC_UNKNOWN = 0,
 
-   For now, only return the first matching location expression; there
-   can be more than one in the list.  */
+  /* Needs the full evaluator.  */
+  DWARF2_LOC_GENERIC,
 
-static gdb_byte *
-find_location_expression (struct dwarf2_address_translation *baton,
-			  size_t *locexpr_length, CORE_ADDR pc)
+  /* The value is in DWARF register REG.  */
+  DWARF2_LOC_REG,
+
+  /* The value is in memory at DWARF register REG plus OFFSET.  */
+  DWARF2_LOC_BREG,
+
+  /* The value is in memory at the frame base plus OFFSET.  */
+  DWARF2_LOC_FBREG,
+
+  /* The value is in memory at ADDR, before translation.  */
+  DWARF2_LOC_ADDR
+};
+
+struct dwarf2_compiled_expr
+{
+  enum dwarf2_compiled_kind kind;
+  int reg;
+  LONGEST offset;
+  CORE_ADDR addr;
+};
+
+struct dwarf2_loclist_entry
+{
+  CORE_ADDR low;
+  CORE_ADDR high;
+  gdb_byte *data;
+  size_t size;
+  struct dwarf2_compiled_expr expr;
+};
+
+struct dwarf2_loc_compiled
+{
+  /* For a location expression, the expression itself.  */
+  struct dwarf2_compiled_expr expr;
+
+  /* For a location list, the objfile_text_section_offset the table
+     was built with, its entries, and whether they are disjoint and
+     sorted by LOW.  If they aren't they are in list order.  */
+  int loclist_built;
+  CORE_ADDR base_offset;
+  int nentries;
+  int sorted;
+  struct dwarf2_loclist_entry *entries;
+};
+
+/* Whether to use the compiled forms at all; "maint set dwarf2
+   compiled-locations".  */
+
+int dwarf2_compiled_locations = 1;
+
+/* Decode the location expression at DATA, SIZE bytes long, into
+   *EXPR.  */
+
+static void
+dwarf2_compile_expr (gdb_byte *data, size_t size,
+		     struct dwarf2_compiled_expr *expr)
+{
+  gdb_byte *op_ptr = data;
+  gdb_byte *op_end = data + size;
+  ULONGEST reg;
+  LONGEST offset;
+  int bytes_read;
+  gdb_byte op;
+
+  expr->kind = DWARF2_LOC_GENERIC;
+  if (size == 0)
+    return;
+
+  op = *op_ptr++;
+  if (op >= DW_OP_reg0 && op <= DW_OP_reg31)
+    {
+      expr->kind = DWARF2_LOC_REG;
+      expr->reg = op - DW_OP_reg0;
+    }
+  else if (op == DW_OP_regx)
+    {
+      op_ptr = read_uleb128 (op_ptr, op_end, &reg);
+      expr->kind = DWARF2_LOC_REG;
+      expr->reg = reg;
+    }
+  else if (op >= DW_OP_breg0 && op <= DW_OP_breg31)
+    {
+      op_ptr = read_sleb128 (op_ptr, op_end, &offset);
+      expr->kind = DWARF2_LOC_BREG;
+      expr->reg = op - DW_OP_breg0;
+      expr->offset = offset;
+    }
+  else if (op == DW_OP_bregx)
+    {
+      op_ptr = read_uleb128 (op_ptr, op_end, &reg);
+      op_ptr = read_sleb128 (op_ptr, op_end, &offset);
+      expr->kind = DWARF2_LOC_BREG;
+      expr->reg = reg;
+      expr->offset = offset;
+    }
+  else if (op == DW_OP_fbreg)
+    {
+      op_ptr = read_sleb128 (op_ptr, op_end, &offset);
+      expr->kind = DWARF2_LOC_FBREG;
+      expr->offset = offset;
+    }
+  else if (op == DW_OP_addr)
+    {
+      expr->addr = dwarf2_read_address (op_ptr, op_end, &bytes_read);
+      op_ptr += bytes_read;
+      expr->kind = DWARF2_LOC_ADDR;
+    }
+  else
+    return;
+
+  /* DW_OP_APPLE_uninit is a no-op as far as the evaluator goes; any
+     other trailing operation, or a register number the evaluator
+     would reject, means it has work to do.  */
+  while (op_ptr < op_end && *op_ptr == DW_OP_APPLE_uninit)
+    op_ptr++;
+  if (op_ptr != op_end
+      || ((expr->kind == DWARF2_LOC_REG || expr->kind == DWARF2_LOC_BREG)
+	  && expr->reg < 0))
+    expr->kind = DWARF2_LOC_GENERIC;
+}
+
+/* Return the compiled form of BATON, allocating it if need be.  */
+
+static struct dwarf2_loc_compiled *
+dwarf2_loc_compiled (struct dwarf2_address_translation *baton)
+{
+  if (baton->compiled == NULL)
+    {
+      baton->compiled = (struct dwarf2_loc_compiled *)
+	obstack_alloc (&baton->objfile->objfile_obstack,
+		       sizeof (struct dwarf2_loc_compiled));
+      memset (baton->compiled, 0, sizeof (struct dwarf2_loc_compiled));
+    }
+  return baton->compiled;
+}
+
+static int
+compare_loclist_entries (const void *a, const void *b)
+{
+  const struct dwarf2_loclist_entry *ea = a;
+  const struct dwarf2_loclist_entry *eb = b;
+
+  if (ea->low != eb->low)
+    return ea->low < eb->low ? -1 : 1;
+  return 0;
+}
+
+/* Decode every entry of the location list BATON into COMPILED.  */
+
+static void
+dwarf2_build_loclist (struct dwarf2_address_translation *baton,
+		      struct dwarf2_loc_compiled *compiled,
+		      CORE_ADDR base_offset)
 {
   CORE_ADDR low, high;
   gdb_byte *loc_ptr, *buf_end;
-  int length;
+  int length, n, i;
   unsigned int addr_size = TARGET_ADDR_BIT / TARGET_CHAR_BIT;
   CORE_ADDR base_mask = ~(~(CORE_ADDR)1 << (addr_size * 8 - 1));
-  /* Adjust base_address for relocatable objects.  */
-  CORE_ADDR base_offset = objfile_text_section_offset (baton->objfile);
   CORE_ADDR base_address = baton->base_address_untranslated;
+  struct obstack *obstack = &baton->objfile->objfile_obstack;
+
+  /* The list has no explicit length, so entries are collected on the
+     obstack as they are found.  */
 
   loc_ptr = baton->data;
   buf_end = baton->data + baton->size;
+  n = 0;
 
-  while (1)
+  while (loc_ptr + 2 * addr_size <= buf_end)
     {
+      struct dwarf2_loclist_entry entry;
+
       low = dwarf2_read_address (loc_ptr, buf_end, &length);
       loc_ptr += length;
       high = dwarf2_read_address (loc_ptr, buf_end, &length);
@@ -84,7 +261,7 @@ find_location_expression (struct dwarf2_address_translation *baton,
 
       /* An end-of-list entry.  */
       if (low == 0 && high == 0)
-	return NULL;
+	break;
 
       /* A base-address-selection entry.  */
       if ((low & base_mask) == base_mask)
@@ -114,17 +291,113 @@ find_location_expression (struct dwarf2_address_translation *baton,
       low += base_offset;
       high += base_offset;
 
+      if (loc_ptr + 2 > buf_end)
+	break;
       length = extract_unsigned_integer (loc_ptr, 2);
       loc_ptr += 2;
 
-      if (pc >= low && pc < high)
+      entry.low = low;
+      entry.high = high;
+      entry.data = loc_ptr;
+      entry.size = length;
+      entry.expr.kind = DWARF2_LOC_UNKNOWN;
+      obstack_grow (obstack, &entry, sizeof (entry));
+      n++;
+
+      loc_ptr += length;
+    }
+
+  compiled->entries = (struct dwarf2_loclist_entry *) obstack_finish (obstack);
+  compiled->nentries = n;
+  compiled->base_offset = base_offset;
+  compiled->loclist_built = 1;
+
+  /* Sort the entries only if no two of them overlap; otherwise the
+     first one in the list that contains the pc has to win.  */
+  compiled->sorted = 0;
+  if (n > 1)
+    {
+      struct dwarf2_loclist_entry *sorted;
+
+      sorted = (struct dwarf2_loclist_entry *)
+	obstack_alloc (obstack, n * sizeof (struct dwarf2_loclist_entry));
+      memcpy (sorted, compiled->entries,
+	      n * sizeof (struct dwarf2_loclist_entry));
+      qsort (sorted, n, sizeof (struct dwarf2_loclist_entry),
+	     compare_loclist_entries);
+      for (i = 1; i < n; i++)
+	if (sorted[i - 1].low < sorted[i - 1].high
+	    && sorted[i].low < sorted[i - 1].high)
+	  break;
+      if (i == n)
 	{
-	  *locexpr_length = length;
-	  return loc_ptr;
+	  compiled->entries = sorted;
+	  compiled->sorted = 1;
 	}
+    }
+}
 
-      loc_ptr += length;
+/* Return the entry of the location list BATON whose range contains
+   PC, or NULL if there is none.  */
+
+static struct dwarf2_loclist_entry *
+find_location_entry (struct dwarf2_address_translation *baton, CORE_ADDR pc)
+{
+  struct dwarf2_loc_compiled *compiled = dwarf2_loc_compiled (baton);
+  /* Adjust base_address for relocatable objects.  */
+  CORE_ADDR base_offset = objfile_text_section_offset (baton->objfile);
+  int i;
+
+  if (!compiled->loclist_built || compiled->base_offset != base_offset)
+    dwarf2_build_loclist (baton, compiled, base_offset);
+
+  if (compiled->sorted)
+    {
+      int low = 0;
+      int high = compiled->nentries;
+
+      /* Find the first entry that starts after PC.  */
+      while (low < high)
+	{
+	  int mid = low + (high - low) / 2;
+
+	  if (compiled->entries[mid].low <= pc)
+	    low = mid + 1;
+	  else
+	    high = mid;
+	}
+      if (low > 0 && pc < compiled->entries[low - 1].high)
+	return &compiled->entries[low - 1];
+      return NULL;
     }
+
+  for (i = 0; i < compiled->nentries; i++)
+    if (pc >= compiled->entries[i].low && pc < compiled->entries[i].high)
+      return &compiled->entries[i];
+  return NULL;
+}
+/* APPLE LOCAL end compiled locations  */
+
+/* A helper function for dealing with location lists.  Given a
+   symbol baton (BATON) and a pc value (PC), find the appropriate
+   location expression, set *LOCEXPR_LENGTH, and return a pointer
+   to the beginning of the expression.  Returns NULL on failure.
+
+   For now, only return the first matching location expression; there
+   can be more than one in the list.  */
+
+static gdb_byte *
+find_location_expression (struct dwarf2_address_translation *baton,
+			  size_t *locexpr_length, CORE_ADDR pc)
+{
+  /* APPLE LOCAL begin compiled locations  */
+  struct dwarf2_loclist_entry *entry = find_location_entry (baton, pc);
+
+  if (entry == NULL)
+    return NULL;
+  *locexpr_length = entry->size;
+  return entry->data;
+  /* APPLE LOCAL end compiled locations  */
 }
 
 /* This is the baton used when performing dwarf2 expression
@@ -205,6 +478,27 @@ dwarf_expr_frame_base (void *baton, gdb_byte **start, size_t * length)
 	   SYMBOL_NATURAL_NAME (framefunc));
 }
 
+/* APPLE LOCAL begin frame base cache  */
+/* The frame base is the same for every variable in a frame, so it is
+   remembered in the frame itself once something has evaluated it.  */
+
+static int
+dwarf_expr_cached_frame_base (void *baton, CORE_ADDR *base)
+{
+  struct dwarf_expr_baton *debaton = (struct dwarf_expr_baton *) baton;
+
+  return get_frame_dwarf2_base (debaton->frame, base);
+}
+
+static void
+dwarf_expr_cache_frame_base (void *baton, CORE_ADDR base)
+{
+  struct dwarf_expr_baton *debaton = (struct dwarf_expr_baton *) baton;
+
+  set_frame_dwarf2_base (debaton->frame, base);
+}
+/* APPLE LOCAL end frame base cache  */
+
 /* Using the objfile specified in BATON, find the address for the
    current thread's thread-local storage with offset OFFSET.  */
 static CORE_ADDR
@@ -293,13 +587,144 @@ dwarf_expr_tls_address (void *baton, CORE_ADDR offset)
   return addr;
 }
 
+/* APPLE LOCAL begin compiled locations  */
+/* Find the frame base for the frame in BATON from the compiled form of
+   its function's DW_AT_frame_base, and store it in *BASE.  Return zero
+   if that isn't one of the shapes handled here.  */
+
+static int
+dwarf2_compiled_frame_base (struct dwarf_expr_baton *baton, CORE_ADDR *base)
+{
+  struct symbol *framefunc;
+  struct dwarf2_address_translation *symbaton;
+  struct dwarf2_compiled_expr *expr;
+  gdb_byte *data;
+  size_t size;
+  int reg;
+
+  /* APPLE LOCAL frame base cache  */
+  if (get_frame_dwarf2_base (baton->frame, base))
+    return 1;
+
+  framefunc = get_frame_function (baton->frame);
+  if (framefunc == NULL || SYMBOL_LOCATION_BATON (framefunc) == NULL)
+    return 0;
+  symbaton = SYMBOL_LOCATION_BATON (framefunc);
+
+  if (SYMBOL_OPS (framefunc) == &dwarf2_loclist_funcs)
+    {
+      struct dwarf2_loclist_entry *entry;
+
+      entry = find_location_entry (symbaton, get_frame_pc (baton->frame));
+      if (entry == NULL)
+	return 0;
+      expr = &entry->expr;
+      data = entry->data;
+      size = entry->size;
+    }
+  else if (SYMBOL_OPS (framefunc) == &dwarf2_locexpr_funcs)
+    {
+      expr = &dwarf2_loc_compiled (symbaton)->expr;
+      data = symbaton->data;
+      size = symbaton->size;
+    }
+  else
+    return 0;
+
+  if (expr->kind == DWARF2_LOC_UNKNOWN)
+    dwarf2_compile_expr (data, size, expr);
+
+  if (expr->kind != DWARF2_LOC_REG && expr->kind != DWARF2_LOC_BREG)
+    return 0;
+
+  reg = dwarf2_frame_adjust_regnum (current_gdbarch, expr->reg, 0);
+  *base = dwarf_expr_read_reg (baton, reg);
+  if (expr->kind == DWARF2_LOC_BREG)
+    *base += expr->offset;
+  /* APPLE LOCAL frame base cache  */
+  set_frame_dwarf2_base (baton->frame, *base);
+  return 1;
+}
+
+/* Build the value of VAR in FRAME from the compiled location EXPR the
+   same way dwarf2_evaluate_loc_desc would from the evaluator's
+   result.  Return NULL if EXPR needs the evaluator after all.  */
+
+static struct value *
+dwarf2_evaluate_compiled (struct symbol *var, struct frame_info *frame,
+			  struct dwarf2_compiled_expr *expr,
+			  struct objfile *objfile)
+{
+  struct dwarf2_address_translation *addr_translation;
+  struct dwarf_expr_baton baton;
+  struct value *retval;
+  CORE_ADDR address;
+  int reg;
+
+  baton.frame = frame;
+  baton.objfile = objfile;
+
+  switch (expr->kind)
+    {
+    case DWARF2_LOC_REG:
+      if (frame == NULL)
+	return NULL;
+      reg = DWARF2_REG_TO_REGNUM (dwarf2_frame_adjust_regnum (current_gdbarch,
+								expr->reg, 0));
+      if (reg < 0)
+	return NULL;
+      retval = value_from_register (SYMBOL_TYPE (var), reg, frame);
+      set_var_status (retval, 1);
+      return retval;
+
+    case DWARF2_LOC_BREG:
+      if (frame == NULL)
+	return NULL;
+      reg = dwarf2_frame_adjust_regnum (current_gdbarch, expr->reg, 0);
+      address = dwarf_expr_read_reg (&baton, reg) + expr->offset;
+      break;
+
+    case DWARF2_LOC_FBREG:
+      if (frame == NULL || !dwarf2_compiled_frame_base (&baton, &address))
+	return NULL;
+      address += expr->offset;
+      break;
+
+    case DWARF2_LOC_ADDR:
+      /* Translated as execute_stack_op translates DW_OP_addr.  */
+      address = expr->addr;
+      addr_translation = SYMBOL_LOCATION_BATON (var);
+      if (addr_translation && addr_translation->addr_map)
+	translate_debug_map_address (addr_translation->addr_map, address,
+				     &address, 0);
+      else if (addr_translation && addr_translation->objfile
+	       && addr_translation->section >= 0)
+	address += objfile_section_offset (addr_translation->objfile,
+					   addr_translation->section);
+      break;
+
+    default:
+      return NULL;
+    }
+
+  retval = allocate_value (SYMBOL_TYPE (var));
+  VALUE_LVAL (retval) = lval_memory;
+  set_value_lazy (retval, 1);
+  VALUE_ADDRESS (retval) = address;
+  set_var_status (retval, 1);
+  return retval;
+}
+/* APPLE LOCAL end compiled locations  */
+
 /* Evaluate a location description, starting at DATA and with length
    SIZE, to find the current location of variable VAR in the context
-   of FRAME.  */
+   of FRAME.  APPLE LOCAL: If EXPR is not NULL, it is where the
+   compiled form of the description is, or is to be, kept.  */
 static struct value *
 dwarf2_evaluate_loc_desc (struct symbol *var, struct frame_info *frame,
 			  gdb_byte *data, unsigned short size,
-			  struct objfile *objfile)
+			  struct objfile *objfile,
+			  struct dwarf2_compiled_expr *expr)
 {
   struct value *retval;
   struct dwarf_expr_baton baton;
@@ -312,6 +737,16 @@ dwarf2_evaluate_loc_desc (struct symbol *var, struct frame_info *frame,
       /* APPLE LOCAL variable opt states.  */
       set_value_optimized_out (retval, opt_away);
     }
+  /* APPLE LOCAL begin compiled locations  */
+  else if (expr != NULL && dwarf2_compiled_locations)
+    {
+      if (expr->kind == DWARF2_LOC_UNKNOWN)
+	dwarf2_compile_expr (data, size, expr);
+      retval = dwarf2_evaluate_compiled (var, frame, expr, objfile);
+      if (retval != NULL)
+	return retval;
+    }
+  /* APPLE LOCAL end compiled locations  */
 
   baton.frame = frame;
   baton.objfile = objfile;
@@ -321,6 +756,10 @@ dwarf2_evaluate_loc_desc (struct symbol *var, struct frame_info *frame,
   ctx->read_reg = dwarf_expr_read_reg;
   ctx->read_mem = dwarf_expr_read_mem;
   ctx->get_frame_base = dwarf_expr_frame_base;
+  /* APPLE LOCAL begin frame base cache  */
+  ctx->get_cached_frame_base = dwarf_expr_cached_frame_base;
+  ctx->cache_frame_base = dwarf_expr_cache_frame_base;
+  /* APPLE LOCAL end frame base cache  */
   ctx->get_tls_address = dwarf_expr_tls_address;
 
   dwarf_expr_eval (ctx, data, size, 0, SYMBOL_LOCATION_BATON (var));
@@ -547,8 +986,10 @@ locexpr_read_variable (struct symbol *symbol, struct frame_info *frame)
 {
   struct dwarf2_address_translation *dlbaton = SYMBOL_LOCATION_BATON (symbol);
   struct value *val;
+  /* APPLE LOCAL compiled locations  */
   val = dwarf2_evaluate_loc_desc (symbol, frame, dlbaton->data, dlbaton->size,
-				  dlbaton->objfile);
+				  dlbaton->objfile,
+				  &dwarf2_loc_compiled (dlbaton)->expr);
 
   return val;
 }
@@ -672,12 +1113,11 @@ loclist_read_variable (struct symbol *symbol, struct frame_info *frame)
 {
   struct dwarf2_address_translation *dlbaton = SYMBOL_LOCATION_BATON (symbol);
   struct value *val;
-  gdb_byte *data;
-  size_t size;
+  /* APPLE LOCAL begin compiled locations  */
+  struct dwarf2_loclist_entry *entry;
 
-  data = find_location_expression (dlbaton, &size,
-				   frame ? get_frame_pc (frame) : 0);
-  if (data == NULL)
+  entry = find_location_entry (dlbaton, frame ? get_frame_pc (frame) : 0);
+  if (entry == NULL)
     {
       val = allocate_value (SYMBOL_TYPE (symbol));
       VALUE_LVAL (val) = not_lval;
@@ -685,8 +1125,9 @@ loclist_read_variable (struct symbol *symbol, struct frame_info *frame)
       set_value_optimized_out (val, opt_evicted);
     }
   else
-    val = dwarf2_evaluate_loc_desc (symbol, frame, data, size,
-				    dlbaton->objfile);
+    val = dwarf2_evaluate_loc_desc (symbol, frame, entry->data, entry->size,
+				    dlbaton->objfile, &entry->expr);
+  /* APPLE LOCAL end compiled locations  */
 
   return val;
 }
@@ -60,8 +60,20 @@ struct dwarf2_address_translation
   /* APPLE LOCAL we need to translate addresses for location list expressions
      from .o file addresses to final executable addresses.  */
   struct oso_to_final_addr_map *addr_map;
+
+  /* APPLE LOCAL begin compiled locations  */
+  /* The decoded form of the location, built by dwarf2loc.c the first
+     time it is evaluated.  NULL until then.  */
+  struct dwarf2_loc_compiled *compiled;
+  /* APPLE LOCAL end compiled locations  */
 };
 
+/* APPLE LOCAL begin compiled locations  */
+/* Nonzero if dwarf2loc.c may evaluate common location expressions
+   without the DWARF expression evaluator.  */
+extern int dwarf2_compiled_locations;
+/* APPLE LOCAL end compiled locations  */
+
 extern const struct symbol_ops dwarf2_locexpr_funcs;
 extern const struct symbol_ops dwarf2_loclist_funcs;
 
@@ -61,6 +61,8 @@
 #include "inlining.h"
 /* APPLE LOCAL - address ranges  */
 #include "block.h"
+/* APPLE LOCAL lazy function symbols  */
+#include "dictionary.h"
 /* APPLE LOCAL - pubtypes reading for "gnutarget"  */
 #include "gdbcore.h"
 /* APPLE LOCAL - .o file translation data structure  */
@@ -69,15 +71,41 @@
 #include <ctype.h>
 /* APPLE LOCAL objc_invalidate_objc_class */
 #include "objc-lang.h"
+/* APPLE LOCAL dwarf2 structure sharing  */
+#include "md5.h"
+/* APPLE LOCAL parallel psymtab scan  */
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+/* APPLE LOCAL debug map prefetch  */
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+/* APPLE LOCAL psymtab cache  */
+#include "mach-o.h"
+#include "gdb_stat.h"
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+/* APPLE LOCAL compressed debug sections  */
+#if defined (HAVE_ZLIB_H) && defined (HAVE_LIBZ)
+#include <zlib.h>
+#endif
 
 /* A note on memory usage for this file.
    
-   At the present time, this code reads the debug info sections into
-   the objfile's objfile_obstack.  A definite improvement for startup
-   time, on platforms which do not emit relocations for debug
-   sections, would be to use mmap instead.  The object's complete
-   debug information is loaded into memory, partly to simplify
-   absolute DIE references.
+   The debug info sections of an objfile's own bfd are mapped with mmap
+   when the host supports it and the sections need no relocation (see
+   dwarf2_read_section); otherwise, and for the .o files of a debug map
+   whose bfds are closed once they have been read, they are read into
+   the objfile's objfile_obstack.  The object's complete debug
+   information is loaded into memory, partly to simplify absolute DIE
+   references.
 
    Whether using obstacks or mmap, the sections should remain loaded
    until the objfile is released, and pointers into the section data
@@ -211,21 +239,6 @@ struct dwarf2_per_objfile
   /* APPLE LOCAL debug inlined section  */
   char *inlined_buffer;
   
-  /* APPLE LOCAL: use mmap for dwarf sections.  */
-#if 0
-#ifdef HAVE_MMAP
-  /* BFD mmap windows from the sections.  */
-  bfd_window info_window;
-  bfd_window abbrev_window;
-  bfd_window line_window;
-  bfd_window str_window;
-  bfd_window macinfo_window;
-  bfd_window ranges_window;
-  bfd_window loc_window;
-#endif /* HAVE_MMAP */
-#endif
-  /* END APPLE LOCAL */
-
   /* A list of all the compilation units.  This is used to locate
      the target compilation unit of a particular reference.  */
   struct dwarf2_per_cu_data **all_comp_units;
@@ -236,6 +249,12 @@ struct dwarf2_per_objfile
   /* A chain of compilation units that are currently read in, so that
      they can be freed later.  */
   struct dwarf2_per_cu_data *read_in_chain;
+
+  /* APPLE LOCAL begin compressed debug sections  */
+  /* If .debug_info is chunk compressed and being decompressed on
+     demand, the state dwarf2_ensure_info needs; otherwise NULL.  */
+  struct dwarf2_compressed_section *info_compressed;
+  /* APPLE LOCAL end compressed debug sections  */
 };
 
 
@@ -408,9 +427,10 @@ struct comp_unit_head
   int base_known;
 };
 
-/* Fixed size for the DIE hash table.  */
-#ifndef REF_HASH_SIZE
-#define REF_HASH_SIZE 1021
+/* APPLE LOCAL packed dies: The chunk size of the obstacks holding a
+   compilation unit's full DIEs and their attributes.  */
+#ifndef DIE_OBSTACK_CHUNK_SIZE
+#define DIE_OBSTACK_CHUNK_SIZE (64 * 1024)
 #endif
 
 /* Internal state when decoding a particular compilation unit.  */
@@ -427,6 +447,16 @@ struct dwarf2_cu
 
   struct function_range *first_fn, *last_fn, *cached_fn;
 
+  /* APPLE LOCAL begin line table decoding  */
+  /* The functions on FIRST_FN sorted by lowpc, built the first time
+     check_cu_functions needs them; NULL until then.  Non-zero
+     SORTED_FNS_OVERLAP means some of the ranges overlap, and the list
+     has to be searched in order after all.  */
+  struct function_range **sorted_fns;
+  int num_sorted_fns;
+  int sorted_fns_overlap;
+  /* APPLE LOCAL end line table decoding  */
+
   /* The language we are debugging.  */
   enum language language;
   const struct language_defn *language_defn;
@@ -466,7 +496,8 @@ struct dwarf2_cu
   struct obstack abbrev_obstack;
 
   /* Hash table holding all the loaded partial DIEs.  */
-  htab_t partial_dies;
+  /* APPLE LOCAL die offset map  */
+  struct die_offset_map *partial_dies;
 
   /* Storage for things with the same lifetime as this read-in compilation
      unit, including partial DIEs.  */
@@ -484,12 +515,27 @@ struct dwarf2_cu
   /* How many compilation units ago was this CU last referenced?  */
   int last_used;
 
-  /* A hash table of die offsets for following references.  */
-  struct die_info *die_ref_table[REF_HASH_SIZE];
-
+  /* APPLE LOCAL begin packed dies  */
   /* Full DIEs if read in.  */
   struct die_info *dies;
 
+  /* Storage for the full DIEs and for their attribute arrays.  The
+     DIEs are read in .debug_info order, so a parent is followed by its
+     children and the records for neighbouring DIEs are neighbours in
+     memory; keeping the attributes in a pool of their own keeps the
+     DIE records themselves densely packed.  Valid iff
+     HAS_DIE_STORAGE is set.  */
+  struct obstack die_obstack;
+  struct obstack die_attr_obstack;
+
+  /* All the full DIEs with a non-zero tag, in increasing offset order,
+     for following references.  DIE_INDEX has room for
+     DIE_INDEX_SIZE entries, of which the first N_DIES are used.  */
+  struct die_info **die_index;
+  unsigned int n_dies;
+  unsigned int die_index_size;
+  /* APPLE LOCAL end packed dies  */
+
   /* A set of pointers to dwarf2_per_cu_data objects for compilation
      units referenced by this one.  Only set during full symbol processing;
      partial symbol tables do not have dependencies.  */
@@ -508,6 +554,10 @@ struct dwarf2_cu
      from mangled names.  */
   unsigned int has_namespace_info : 1;
 
+  /* APPLE LOCAL packed dies: Set once DIE_OBSTACK, DIE_ATTR_OBSTACK
+     and DIE_INDEX have been initialized.  */
+  unsigned int has_die_storage : 1;
+
   /* APPLE LOCAL begin Inform users about debugging optimized code  */
   /* This flag will be set if the compilation unit die has the
      DW_AT_APPLE_optimized attribute.  It means the entire compilation
@@ -550,12 +600,52 @@ struct dwarf2_per_cu_data
      holds a map of DIE offsets to types.  It isn't always possible
      to reconstruct this information later, so we have to preserve
      it.  */
-  htab_t type_hash;
+  /* APPLE LOCAL die offset map  */
+  struct die_offset_map *type_hash;
 
   /* The partial symbol table associated with this compilation unit.  */
   struct partial_symtab *psymtab;
 };
 
+/* APPLE LOCAL begin parallel psymtab scan  */
+/* A decoded abbreviation table, plus the flags dwarf2_read_abbrevs
+   used to set directly in the dwarf2_cu while decoding it.  Keeping
+   them apart from the dwarf2_cu lets the tables for all the
+   compilation units of an objfile be decoded up front, possibly on
+   several threads, and installed later.  */
+
+struct dwarf2_abbrev_table
+{
+  struct abbrev_info **abbrevs;
+
+  unsigned int has_namespace_info : 1;
+  unsigned int has_form_ref_addr : 1;
+};
+
+/* The result of prescanning every compilation unit of an objfile
+   before building its partial symbols.  TABLES is indexed like
+   dwarf2_per_objfile->all_comp_units; an entry whose ABBREVS is NULL
+   was not (or could not safely be) prescanned and is read the normal
+   way.  */
+
+struct dwarf2_prescan
+{
+  int n_comp_units;
+  struct dwarf2_abbrev_table *tables;
+
+  /* One obstack per worker, so the workers never share an
+     allocator.  */
+  int n_workers;
+  struct obstack *obstacks;
+
+#ifdef USE_PTHREADS
+  /* Index of the next compilation unit to hand out.  */
+  pthread_mutex_t lock;
+  int next_cu;
+#endif
+};
+/* APPLE LOCAL end parallel psymtab scan  */
+
 /* APPLE LOCAL begin psym equivalences */
 
 /* This is a global flag indicating that we found partial dies with
@@ -603,6 +693,10 @@ struct line_header
     unsigned int mod_time;
     unsigned int length;
     int included_p; /* Non-zero if referenced by the Line Number Program.  */
+    /* APPLE LOCAL line table decoding: The subfile dwarf_decode_lines
+       started for this file, so that switching back to it doesn't
+       search the subfile list with a freshly built path each time.  */
+    struct subfile *subfile;
   } *file_names;
 
   /* The start and end of the statement program following this
@@ -724,7 +818,6 @@ struct die_info
     unsigned int repository_id; /* Id number in debug repository */
     unsigned int num_attrs;	/* Number of attributes */
     struct attribute *attrs;	/* An array of attributes */
-    struct die_info *next_ref;	/* Next die in ref hash table */
 
     /* The dies in a compilation unit form an n-ary tree.  PARENT
        points to this die's parent; CHILD points to the first child of
@@ -889,6 +982,46 @@ The upper bound on the age of cached dwarf2 compilation units is %s.\n"),
 		    value);
 }
 
+/* APPLE LOCAL begin compiled locations  */
+static void
+show_dwarf2_compiled_locations (struct ui_file *file, int from_tty,
+				struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Evaluating common location expressions without the DWARF evaluator is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end compiled locations  */
+
+/* APPLE LOCAL begin dwarf2 cache limit  */
+/* The most memory, in bytes, that the compilation units kept in the
+   cache of an objfile may use.  When they use more, the least
+   recently used ones are released early, regardless of
+   dwarf2_max_cache_age.  UINT_MAX (set as 0) means no limit.  */
+static unsigned int dwarf2_max_cache_bytes = UINT_MAX;
+static void
+show_dwarf2_max_cache_bytes (struct ui_file *file, int from_tty,
+			     struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+The upper bound on the memory used by cached dwarf2 compilation units \
+is %s.\n"),
+		    value);
+}
+
+/* Counters for "maint info dwarf2-cache".  A hit is a reference to a
+   compilation unit that was already in the cache, a miss one that had
+   to be read in, and an eviction a unit age_cached_comp_units
+   released.  */
+
+static struct
+{
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long evictions;
+} dwarf2_cache_stats;
+/* APPLE LOCAL end dwarf2 cache limit  */
+
 /* APPLE LOCAL: A way to find out what how the DWARF debug map is translating
    addresses.  Results in a lot of output.  */
 static int debug_debugmap = 0;
@@ -900,6 +1033,192 @@ show_debug_debugmap (struct ui_file *file, int from_tty,
 }
 
 
+/* APPLE LOCAL begin parallel psymtab scan  */
+/* The number of threads used to prescan the compilation units of an
+   objfile while building its partial symbol tables.  The prescan
+   decodes every compilation unit's abbreviation table; turning the
+   DIEs into partial symbols is still done on the main thread, in
+   .debug_info order, so the resulting psymtabs are the same whatever
+   this is set to.  Zero or one means don't start any threads.  */
+static int dwarf2_parallel_scan_threads = 0;
+static void
+show_dwarf2_parallel_scan_threads (struct ui_file *file, int from_tty,
+				   struct cmd_list_element *c,
+				   const char *value)
+{
+  fprintf_filtered (file, _("\
+The number of threads used to prescan dwarf2 compilation units is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end parallel psymtab scan  */
+
+/* APPLE LOCAL begin debug map prefetch  */
+/* The number of threads used to read the debug map .o files of an
+   executable that has no dSYM into the buffer cache while its partial
+   symbols are being built.  The threads only pull the files in; the
+   .o files are still opened and scanned by the main thread, in symbol
+   table order.  Zero means don't start any threads.  */
+static int dwarf2_oso_prefetch_threads = 0;
+static void
+show_dwarf2_oso_prefetch_threads (struct ui_file *file, int from_tty,
+				  struct cmd_list_element *c,
+				  const char *value)
+{
+  fprintf_filtered (file, _("\
+The number of threads used to prefetch debug map object files is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end debug map prefetch  */
+
+/* APPLE LOCAL begin lazy function symbols  */
+/* If non-zero, the parameters and local variables of functions and
+   lexical blocks aren't turned into symbols when their compilation
+   unit is expanded, but when their block is first looked at.  See
+   dwarf2_can_defer_scope.  */
+static int dwarf2_lazy_function_symbols = 0;
+static void
+show_dwarf2_lazy_function_symbols (struct ui_file *file, int from_tty,
+				   struct cmd_list_element *c,
+				   const char *value)
+{
+  fprintf_filtered (file, _("\
+Lazy reading of dwarf2 local symbols is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end lazy function symbols  */
+
+/* APPLE LOCAL begin lazy macro tables  */
+/* If non-zero, a compilation unit's .debug_macinfo isn't decoded when
+   the unit is expanded, only when something first asks for its macro
+   table.  See dwarf2_defer_macros.  */
+static int dwarf2_lazy_macros = 1;
+static void
+show_dwarf2_lazy_macros (struct ui_file *file, int from_tty,
+			 struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Lazy reading of dwarf2 macro information is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end lazy macro tables  */
+
+/* APPLE LOCAL begin mmap dwarf sections  */
+/* If non-zero, dwarf2_read_section maps the sections of an objfile's
+   own bfd with mmap rather than copying them onto the objfile_obstack.  */
+static int dwarf2_mmap_sections = 1;
+static void
+show_dwarf2_mmap_sections (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Mapping dwarf2 debug sections with mmap is %s.\n"),
+		    value);
+}
+
+#ifdef HAVE_MMAP
+/* The bfd windows dwarf2_read_section has mapped for an objfile,
+   chained off dwarf2_section_windows_key and released, by
+   dwarf2_free_section_windows, along with the objfile.  */
+
+struct dwarf2_section_window
+{
+  bfd_window window;
+  struct dwarf2_section_window *next;
+};
+
+static const struct objfile_data *dwarf2_section_windows_key;
+#endif /* HAVE_MMAP */
+/* APPLE LOCAL end mmap dwarf sections  */
+
+/* APPLE LOCAL begin dwarf2 name index  */
+/* If non-zero, and an objfile has both .debug_pubnames and
+   .debug_pubtypes, we don't build partial symbols for its compilation
+   units at all.  The psymtabs are only shells carrying each CU's
+   address range, and name lookups go through an index of the
+   pubnames and pubtypes tables instead; see dwarf2_build_name_index.  */
+static int dwarf2_use_name_index = 0;
+static void
+show_dwarf2_use_name_index (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Looking up dwarf2 names through .debug_pubnames and .debug_pubtypes is %s.\n"),
+		    value);
+}
+
+/* One name from an objfile's pubnames or pubtypes table, with the
+   psymtabs of every compilation unit it appears in.  The entries
+   live on the objfile_obstack; only the hash table itself, hung off
+   dwarf2_name_index_key, is malloc'ed.  */
+
+struct dwarf2_name_index_pst
+{
+  struct partial_symtab *pst;
+  struct dwarf2_name_index_pst *next;
+};
+
+struct dwarf2_name_index_entry
+{
+  /* The name, without any parameter list.  */
+  const char *name;
+  struct dwarf2_name_index_pst *psymtabs;
+};
+
+static const struct objfile_data *dwarf2_name_index_key;
+/* APPLE LOCAL end dwarf2 name index  */
+
+/* APPLE LOCAL begin dwarf2 structure sharing  */
+/* If non-zero, a named structure, union or class whose DIEs are
+   identical to one already read from another compilation unit of
+   the same objfile - as happens for every class in a header that
+   several source files include - gets the type built for that one
+   instead of a fresh copy.  See dwarf2_structure_digest.  */
+static int dwarf2_share_structure_types = 0;
+static void
+show_dwarf2_share_structure_types (struct ui_file *file, int from_tty,
+				   struct cmd_list_element *c,
+				   const char *value)
+{
+  fprintf_filtered (file, _("\
+Sharing of identical dwarf2 structure types between compilation units is %s.\n"),
+		    value);
+}
+
+/* One structure type already read from this objfile, keyed by an
+   MD5 digest of the DIEs it was read from.  The entries live on the
+   objfile_obstack along with the types; only the hash table itself,
+   hung off dwarf2_shared_structures_key, is malloc'ed.  */
+
+struct dwarf2_shared_structure
+{
+  md5_uint32 digest[4];
+  struct type *type;
+};
+
+static const struct objfile_data *dwarf2_shared_structures_key;
+/* APPLE LOCAL end dwarf2 structure sharing  */
+
+/* APPLE LOCAL begin psymtab cache  */
+/* If set, the directory in which the partial symbol tables built from
+   an objfile's DWARF are saved, in a file named after the objfile's
+   Mach-O UUID, and from which they are read back the next time an
+   objfile with that UUID is loaded.  */
+static char *dwarf2_psymtab_cache_directory = NULL;
+static void
+show_dwarf2_psymtab_cache_directory (struct ui_file *file, int from_tty,
+				     struct cmd_list_element *c,
+				     const char *value)
+{
+  if (value == NULL || *value == '\0')
+    fprintf_filtered (file, _("\
+The dwarf2 partial symbol table cache is disabled.\n"));
+  else
+    fprintf_filtered (file, _("\
+The dwarf2 partial symbol table cache directory is \"%s\".\n"),
+		      value);
+}
+/* APPLE LOCAL end psymtab cache  */
+
 /* Various complaints about symbol reading that don't abort the process */
 
 static void
@@ -956,6 +1275,22 @@ static void scan_partial_inlined_function_symbols (struct dwarf2_cu *);
 static void fix_inlined_subroutine_symbols (void);
 /* APPLE LOCAL end debug inlined section  */
 
+/* APPLE LOCAL begin compressed debug sections  */
+enum dwarf2_section_compression
+{
+  dwarf2_section_plain,
+  dwarf2_section_zlib,
+  dwarf2_section_chunked
+};
+
+static enum dwarf2_section_compression
+  dwarf2_section_compression (bfd *, asection *, bfd_size_type *,
+			      unsigned int *);
+static char *dwarf2_read_compressed_section
+  (struct objfile *, bfd *, asection *, struct dwarf2_compressed_section **);
+static void dwarf2_ensure_info (ULONGEST, ULONGEST);
+/* APPLE LOCAL end compressed debug sections  */
+
 #if 0
 static void dwarf2_build_psymtabs_easy (struct objfile *, int);
 #endif
@@ -967,7 +1302,11 @@ static void dwarf2_build_include_psymtabs (struct dwarf2_cu *,
                                            struct partial_die_info *,
                                            struct partial_symtab *);
 
-static void dwarf2_build_psymtabs_hard (struct objfile *, int);
+/* APPLE LOCAL dwarf2 name index: Add SKIM argument.  */
+static void dwarf2_build_psymtabs_hard (struct objfile *, int, int);
+
+/* APPLE LOCAL dwarf2 name index  */
+static void dwarf2_build_name_index (struct objfile *);
 
 /* APPLE LOCAL begin psym equivalences  */
 static void scan_partial_symbols (struct partial_die_info *,
@@ -995,10 +1334,38 @@ static char *locate_pdi_sibling (struct partial_die_info *orig_pdi,
 
 static void dwarf2_psymtab_to_symtab (struct partial_symtab *);
 
+/* APPLE LOCAL begin psymtab cache  */
+static int dwarf2_read_psymtab_cache (struct objfile *);
+
+static struct dwarf2_per_cu_data *dwarf2_find_comp_unit_noerror
+  (unsigned long);
+
+static void add_equiv_psym (struct equiv_psym_list **, char *);
+
+static void dwarf2_write_psymtab_cache (struct objfile *,
+					struct partial_symtab *);
+/* APPLE LOCAL end psymtab cache  */
+
 static void psymtab_to_symtab_1 (struct partial_symtab *);
 
 static void dwarf2_read_abbrevs (bfd *abfd, struct dwarf2_cu *cu);
 
+/* APPLE LOCAL mmap dwarf sections  */
+#ifdef HAVE_MMAP
+static char *dwarf2_map_section (struct objfile *, bfd *, asection *);
+#endif
+
+/* APPLE LOCAL begin parallel psymtab scan  */
+static void dwarf2_decode_abbrevs (bfd *, unsigned int, struct obstack *,
+				   struct dwarf2_abbrev_table *);
+
+static void dwarf2_install_abbrevs (struct dwarf2_cu *,
+				    struct dwarf2_abbrev_table *);
+
+static struct abbrev_info *lookup_abbrev_in_table (unsigned int,
+						   struct abbrev_info **);
+/* APPLE LOCAL end parallel psymtab scan  */
+
 static void dwarf2_free_abbrev_table (void *);
 
 static struct abbrev_info *peek_die_abbrev (char *, int *, struct dwarf2_cu *);
@@ -1211,7 +1578,10 @@ static struct die_info *read_die_and_siblings (char *info_ptr, bfd *abfd,
 					       char **new_info_ptr,
 					       struct die_info *parent);
 
-static void free_die_list (struct die_info *);
+/* APPLE LOCAL packed dies  */
+static void init_die_storage (struct dwarf2_cu *);
+
+static void free_die_storage (struct dwarf2_cu *);
 
 static void process_die (struct die_info *, struct dwarf2_cu *);
 
@@ -1249,6 +1619,16 @@ static void dump_die_list (struct die_info *);
 static void store_in_ref_table (unsigned int, struct die_info *,
 				struct dwarf2_cu *);
 
+/* APPLE LOCAL packed dies  */
+static struct die_info *find_die_in_ref_table (unsigned int,
+					       struct dwarf2_cu *);
+
+/* APPLE LOCAL begin lazy function symbols  */
+static void dwarf2_find_base_address (struct dwarf2_cu *);
+
+static struct dictionary *dwarf2_expand_lazy_scope (void *);
+/* APPLE LOCAL end lazy function symbols  */
+
 static unsigned int dwarf2_get_ref_die_offset (struct attribute *,
 					       struct dwarf2_cu *);
 
@@ -1265,9 +1645,9 @@ static struct type *dwarf2_fundamental_type (struct objfile *, int,
 
 static struct dwarf_block *dwarf_alloc_block (struct dwarf2_cu *);
 
-static struct abbrev_info *dwarf_alloc_abbrev (struct dwarf2_cu *);
+static struct abbrev_info *dwarf_alloc_abbrev (struct obstack *);
 
-static struct die_info *dwarf_alloc_die (void);
+static struct die_info *dwarf_alloc_die (struct dwarf2_cu *);
 
 static void initialize_cu_func_list (struct dwarf2_cu *);
 
@@ -1277,6 +1657,10 @@ static void add_to_cu_func_list (const char *, CORE_ADDR, CORE_ADDR,
 static void dwarf_decode_macros (struct line_header *, unsigned int,
                                  char *, bfd *, struct dwarf2_cu *);
 
+/* APPLE LOCAL lazy macro tables  */
+static void dwarf2_defer_macros (unsigned int, unsigned int, char *,
+				 struct dwarf2_cu *);
+
 static int attr_form_is_block (struct attribute *);
 
 static void
@@ -1292,9 +1676,14 @@ static void *hashtab_obstack_allocate (void *data, size_t size, size_t count);
 
 static void dummy_obstack_deallocate (void *object, void *data);
 
-static hashval_t partial_die_hash (const void *item);
+/* APPLE LOCAL begin die offset map  */
+static struct die_offset_map *die_offset_map_create (unsigned int,
+						     struct obstack *);
 
-static int partial_die_eq (const void *item_lhs, const void *item_rhs);
+static void **die_offset_map_slot (struct die_offset_map *, unsigned int);
+
+static void *die_offset_map_find (struct die_offset_map *, unsigned int);
+/* APPLE LOCAL end die offset map  */
 
 static struct dwarf2_per_cu_data *dwarf2_find_containing_comp_unit
   (unsigned long offset, struct objfile *objfile);
@@ -1308,6 +1697,9 @@ static void free_cached_comp_units (void *);
 
 static void age_cached_comp_units (void);
 
+/* APPLE LOCAL dwarf2 cache limit  */
+static void maintenance_info_dwarf2_cache (char *, int);
+
 static void free_one_cached_comp_unit (void *);
 
 static void set_die_type (struct die_info *, struct type *,
@@ -1378,66 +1770,68 @@ dwarf2_has_info (struct objfile *objfile)
    offset and size of each of the debugging sections we are interested
    in.  */
 
+/* APPLE LOCAL: Sizes are those of the sections' uncompressed contents.  */
+
 static void
 dwarf2_locate_sections (bfd *ignore_abfd, asection *sectp, void *ignore_ptr)
 {
   if (strcmp (sectp->name, INFO_SECTION) == 0)
     {
-      dwarf2_per_objfile->info_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->info_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_info_section = sectp;
     }
   else if (strcmp (sectp->name, ABBREV_SECTION) == 0)
     {
-      dwarf2_per_objfile->abbrev_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->abbrev_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_abbrev_section = sectp;
     }
   else if (strcmp (sectp->name, LINE_SECTION) == 0)
     {
-      dwarf2_per_objfile->line_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->line_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_line_section = sectp;
     }
   else if (strcmp (sectp->name, PUBNAMES_SECTION) == 0)
     {
-      dwarf2_per_objfile->pubnames_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->pubnames_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_pubnames_section = sectp;
     }
   /* APPLE LOCAL: pubtypes */
   else if (strcmp (sectp->name, PUBTYPES_SECTION) == 0)
     {
-      dwarf2_per_objfile->pubtypes_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->pubtypes_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_pubtypes_section = sectp;
     }
   /* END APPLE LOCAL */
   /* APPLE LOCAL begin debug inlined section  */
   else if (strcmp (sectp->name, INLINED_SECTION) == 0)
     {
-      dwarf2_per_objfile->inlined_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->inlined_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_inlined_section = sectp;
     }
   /* APPLE LOCAL end debug inlined section */
   else if (strcmp (sectp->name, ARANGES_SECTION) == 0)
     {
-      dwarf2_per_objfile->aranges_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->aranges_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_aranges_section = sectp;
     }
   else if (strcmp (sectp->name, LOC_SECTION) == 0)
     {
-      dwarf2_per_objfile->loc_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->loc_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_loc_section = sectp;
     }
   else if (strcmp (sectp->name, MACINFO_SECTION) == 0)
     {
-      dwarf2_per_objfile->macinfo_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->macinfo_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_macinfo_section = sectp;
     }
   else if (strcmp (sectp->name, STR_SECTION) == 0)
     {
-      dwarf2_per_objfile->str_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->str_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_str_section = sectp;
     }
   else if (strcmp (sectp->name, FRAME_SECTION) == 0)
     {
-      dwarf2_per_objfile->frame_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->frame_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_frame_section = sectp;
     }
   else if (strcmp (sectp->name, EH_FRAME_SECTION) == 0)
@@ -1445,13 +1839,13 @@ dwarf2_locate_sections (bfd *ignore_abfd, asection *sectp, void *ignore_ptr)
       flagword aflag = bfd_get_section_flags (ignore_abfd, sectp);
       if (aflag & SEC_HAS_CONTENTS)
         {
-          dwarf2_per_objfile->eh_frame_size = bfd_get_section_size (sectp);
+          dwarf2_per_objfile->eh_frame_size = dwarf2_section_size (ignore_abfd, sectp);
           dwarf_eh_frame_section = sectp;
         }
     }
   else if (strcmp (sectp->name, RANGES_SECTION) == 0)
     {
-      dwarf2_per_objfile->ranges_size = bfd_get_section_size (sectp);
+      dwarf2_per_objfile->ranges_size = dwarf2_section_size (ignore_abfd, sectp);
       dwarf_ranges_section = sectp;
     }
 }
@@ -1463,8 +1857,23 @@ dwarf2_locate_sections (bfd *ignore_abfd, asection *sectp, void *ignore_ptr)
 static void
 dwarf2_copy_dwarf_from_file (struct objfile *objfile, bfd *abfd)
 {
+  /* APPLE LOCAL begin compressed debug sections  */
+  bfd_size_type size;
+  unsigned int chunk_size;
+  /* APPLE LOCAL end compressed debug sections  */
+
   /* We definitely need the .debug_info and .debug_abbrev sections */
 
+  /* APPLE LOCAL begin compressed debug sections  */
+  dwarf2_per_objfile->info_compressed = NULL;
+  if (dwarf2_section_compression (abfd, dwarf_info_section,
+				  &size, &chunk_size)
+      == dwarf2_section_chunked)
+    dwarf2_per_objfile->info_buffer
+      = dwarf2_read_compressed_section (objfile, abfd, dwarf_info_section,
+					&dwarf2_per_objfile->info_compressed);
+  else
+  /* APPLE LOCAL end compressed debug sections  */
   dwarf2_per_objfile->info_buffer = dwarf2_read_section (objfile, abfd, 
                                                          dwarf_info_section);
   dwarf2_per_objfile->abbrev_buffer = dwarf2_read_section (objfile, abfd, 
@@ -1525,6 +1934,21 @@ dwarf2_build_psymtabs (struct objfile *objfile, int mainline)
       init_psymbol_list (objfile, 1024);
     }
 
+  /* APPLE LOCAL begin dwarf2 name index  */
+  if (dwarf2_use_name_index
+      && dwarf2_per_objfile->pubnames_size != 0
+      && dwarf2_per_objfile->pubtypes_size != 0)
+    {
+      dwarf2_build_psymtabs_hard (objfile, mainline, 1);
+      dwarf2_build_name_index (objfile);
+      return;
+    }
+  /* APPLE LOCAL end dwarf2 name index  */
+
+  /* APPLE LOCAL psymtab cache  */
+  if (dwarf2_read_psymtab_cache (objfile))
+    return;
+
 #if 0
   if (dwarf_aranges_offset && dwarf_pubnames_offset)
     {
@@ -1537,10 +1961,253 @@ dwarf2_build_psymtabs (struct objfile *objfile, int mainline)
 #endif
     /* only test this case for now */
     {
+      /* APPLE LOCAL psymtab cache  */
+      struct partial_symtab *old_psymtabs = objfile->psymtabs;
+
       /* In this case we have to work a bit harder */
-      dwarf2_build_psymtabs_hard (objfile, mainline);
+      /* APPLE LOCAL dwarf2 name index  */
+      dwarf2_build_psymtabs_hard (objfile, mainline, 0);
+
+      /* APPLE LOCAL psymtab cache  */
+      dwarf2_write_psymtab_cache (objfile, old_psymtabs);
+    }
+}
+
+/* APPLE LOCAL begin dwarf2 name index  */
+
+/* The htab callbacks for an objfile's name index.  Entries are found
+   by name, with the same whitespace and parameter list blind
+   matching strcmp_iw does, so that "foo(int)" and "foo" hit the same
+   entry.  */
+
+static hashval_t
+dwarf2_name_index_hash (const void *item)
+{
+  const struct dwarf2_name_index_entry *entry = item;
+
+  return msymbol_hash_iw (entry->name);
+}
+
+static int
+dwarf2_name_index_eq (const void *item, const void *name)
+{
+  const struct dwarf2_name_index_entry *entry = item;
+
+  return strcmp_iw (name, entry->name) == 0;
+}
+
+static void
+dwarf2_free_name_index (struct objfile *objfile, void *arg)
+{
+  htab_delete (arg);
+}
+
+/* Record that NAME is defined in the compilation unit of PST.  */
+
+static void
+dwarf2_name_index_add (struct objfile *objfile, htab_t index,
+		       const char *name, struct partial_symtab *pst)
+{
+  struct dwarf2_name_index_entry *entry;
+  struct dwarf2_name_index_pst *link;
+  void **slot;
+
+  slot = htab_find_slot_with_hash (index, name, msymbol_hash_iw (name),
+				   INSERT);
+  entry = *slot;
+  if (entry == NULL)
+    {
+      entry = obstack_alloc (&objfile->objfile_obstack, sizeof (*entry));
+      entry->name = obsavestring (name, strcspn (name, "("),
+				  &objfile->objfile_obstack);
+      entry->psymtabs = NULL;
+      *slot = entry;
+    }
+
+  /* A table lists all the names for one compilation unit together,
+     so we only need to look at the most recent psymtab to avoid
+     recording one twice.  */
+  if (entry->psymtabs != NULL && entry->psymtabs->pst == pst)
+    return;
+
+  link = obstack_alloc (&objfile->objfile_obstack, sizeof (*link));
+  link->pst = pst;
+  link->next = entry->psymtabs;
+  entry->psymtabs = link;
+}
+
+/* Add the names in DATA, the SIZE bytes of a .debug_pubnames or
+   .debug_pubtypes section, to INDEX.  Both are made up of sets with a
+   header naming the compilation unit they describe, followed by
+   {offset, name} pairs terminated by a 0 offset.  */
+
+static void
+dwarf2_name_index_scan (struct objfile *objfile, htab_t index,
+			char *data, unsigned int size)
+{
+  bfd *abfd = objfile->obfd;
+  struct comp_unit_head fake_cu_header; /* This is just to pass info to
+					   read_offset.  */
+  char *ptr = data;
+  int bytes_read;
+
+  memset (&fake_cu_header, 0, sizeof (fake_cu_header));
+
+  while (ptr < data + size)
+    {
+      LONGEST length, info_offset;
+      struct dwarf2_per_cu_data *this_cu;
+      char *set_end;
+
+      length = read_initial_length (abfd, ptr, &fake_cu_header, &bytes_read);
+      ptr += bytes_read;
+      set_end = ptr + length;
+      if (length == 0 || set_end > data + size)
+	{
+	  complaint (&symfile_complaints,
+		     _("malformed name table set at offset 0x%lx"),
+		     (unsigned long) (ptr - bytes_read - data));
+	  return;
+	}
+
+      /* Skip the version.  */
+      ptr += 2;
+      info_offset = read_offset (abfd, ptr, &fake_cu_header, &bytes_read);
+      ptr += bytes_read;
+      /* And the length of the compilation unit.  */
+      read_offset (abfd, ptr, &fake_cu_header, &bytes_read);
+      ptr += bytes_read;
+
+      this_cu = dwarf2_find_comp_unit_noerror (info_offset);
+      if (this_cu == NULL || this_cu->psymtab == NULL)
+	{
+	  complaint (&symfile_complaints,
+		     _("name table refers to unknown compilation unit "
+		       "at offset 0x%lx"), (unsigned long) info_offset);
+	  ptr = set_end;
+	  continue;
+	}
+
+      while (ptr < set_end)
+	{
+	  LONGEST offset;
+	  unsigned int name_length;
+	  char *name;
+
+	  offset = read_offset (abfd, ptr, &fake_cu_header, &bytes_read);
+	  ptr += bytes_read;
+	  if (offset == 0)
+	    break;
+
+	  /* read_string returns the length of the string WITH the null.  */
+	  name = read_string (abfd, ptr, &name_length);
+	  ptr += name_length;
+	  if (name != NULL)
+	    dwarf2_name_index_add (objfile, index, name, this_cu->psymtab);
+	}
+      ptr = set_end;
+    }
+}
+
+/* Build the name index for OBJFILE, whose psymtabs have just been
+   made by dwarf2_build_psymtabs_hard in skim mode, from its
+   .debug_pubnames and .debug_pubtypes.  */
+
+static void
+dwarf2_build_name_index (struct objfile *objfile)
+{
+  htab_t index;
+  char *data;
+
+  index = objfile_data (objfile, dwarf2_name_index_key);
+  if (index != NULL)
+    htab_delete (index);
+
+  index = htab_create_alloc (dwarf2_per_objfile->n_comp_units * 32 + 1,
+			     dwarf2_name_index_hash, dwarf2_name_index_eq,
+			     NULL, xcalloc, xfree);
+  set_objfile_data (objfile, dwarf2_name_index_key, index);
+
+  data = dwarf2_read_section (objfile, objfile->obfd, dwarf_pubnames_section);
+  dwarf2_name_index_scan (objfile, index, data,
+			  dwarf2_per_objfile->pubnames_size);
+  data = dwarf2_read_section (objfile, objfile->obfd, dwarf_pubtypes_section);
+  dwarf2_name_index_scan (objfile, index, data,
+			  dwarf2_per_objfile->pubtypes_size);
+}
+
+/* Non-zero while dwarf2_name_index_expand is reading in symtabs, so
+   the lookups that reading does don't start it off again.  */
+static int dwarf2_name_index_expanding = 0;
+
+static void
+dwarf2_name_index_expand_done (void *ignore)
+{
+  dwarf2_name_index_expanding = 0;
+}
+
+/* Read in the symtab of every compilation unit that the name index of
+   any objfile says defines NAME, so that a symtab lookup of NAME
+   finds it.  Objfiles without a name index have real partial symbols
+   and are left to the usual psymtab search.  */
+
+void
+dwarf2_name_index_expand (const char *name)
+{
+  struct objfile *objfile;
+  struct cleanup *back_to;
+
+  if (name == NULL || dwarf2_name_index_expanding)
+    return;
+
+  dwarf2_name_index_expanding = 1;
+  back_to = make_cleanup (dwarf2_name_index_expand_done, NULL);
+
+  ALL_OBJFILES (objfile)
+    {
+      htab_t index = objfile_data (objfile, dwarf2_name_index_key);
+      struct dwarf2_name_index_entry *entry;
+      struct dwarf2_name_index_pst *link;
+
+      if (index == NULL)
+	continue;
+
+      entry = htab_find_with_hash (index, name, msymbol_hash_iw (name));
+      if (entry == NULL)
+	continue;
+
+      for (link = entry->psymtabs; link != NULL; link = link->next)
+	if (!link->pst->readin)
+	  PSYMTAB_TO_SYMTAB (link->pst);
     }
+
+  do_cleanups (back_to);
+}
+
+/* Return non-zero if the name index of PST's objfile says that NAME
+   is defined in PST.  */
+
+int
+dwarf2_name_index_psymtab_match (struct partial_symtab *pst,
+				 const char *name)
+{
+  htab_t index = objfile_data (pst->objfile, dwarf2_name_index_key);
+  struct dwarf2_name_index_entry *entry;
+  struct dwarf2_name_index_pst *link;
+
+  if (index == NULL || name == NULL)
+    return 0;
+
+  entry = htab_find_with_hash (index, name, msymbol_hash_iw (name));
+  if (entry == NULL)
+    return 0;
+
+  for (link = entry->psymtabs; link != NULL; link = link->next)
+    if (link->pst == pst)
+      return 1;
+  return 0;
 }
+/* APPLE LOCAL end dwarf2 name index  */
 
 /* APPLE LOCAL begin debug inlined section  */
 
@@ -2154,6 +2821,12 @@ static struct objfile *build_dummy_objfile (struct objfile *);
 static void read_in_db_abbrev_table (struct abbrev_info **, sqlite3 *);
 static void db_error (char *, char *, sqlite3 *);
 static struct die_info *db_lookup_type (int , sqlite3 *, struct abbrev_info *);
+/* APPLE LOCAL begin repository batch lookup  */
+static struct die_info *db_build_die (int, const uint8_t *, int,
+				      struct abbrev_info *, sqlite3 *);
+static void db_lookup_types (int, int *, struct die_info **, sqlite3 *,
+			     struct abbrev_info *);
+/* APPLE LOCAL end repository batch lookup  */
 static void fill_in_die_info (struct die_info *, int, uint8_t *,  uint8_t *, 
 			      struct abbrev_info *, sqlite3 *);
 static uint32_t get_uleb128 (uint8_t **);
@@ -2320,11 +2993,389 @@ scan_partial_inlined_function_symbols (struct dwarf2_cu *cu)
 }
 /* APPLE LOCAL end debug inlined section  */
 
+/* APPLE LOCAL begin parallel psymtab scan  */
+
+/* Don't bother starting a prescan thread for fewer than this many
+   compilation units.  */
+#define DWARF2_PRESCAN_MIN_CUS_PER_THREAD 16
+
+/* Prescan the compilation unit at INDEX in all_comp_units, putting
+   its abbreviation table in PRESCAN's TABLES and allocating it on
+   OBSTACK.  Anything that doesn't look right is left for the serial
+   reader to complain about, since a prescan worker must not call
+   complaint or error.  */
+
+static void
+dwarf2_prescan_one_comp_unit (bfd *abfd, struct dwarf2_prescan *prescan,
+			      int index, struct obstack *obstack)
+{
+  struct dwarf2_per_cu_data *per_cu
+    = dwarf2_per_objfile->all_comp_units[index];
+  struct comp_unit_head header;
+
+  /* Make sure the fixed part of the header is all there.  */
+  if (per_cu->length < 11)
+    return;
+
+  memset (&header, 0, sizeof (header));
+  read_comp_unit_head (&header,
+		       dwarf2_per_objfile->info_buffer + per_cu->offset,
+		       abfd);
+
+  if (header.version != 2
+      || header.abbrev_offset >= dwarf2_per_objfile->abbrev_size
+      || (per_cu->offset + header.length + header.initial_length_size
+	  > dwarf2_per_objfile->info_size))
+    return;
+
+  dwarf2_decode_abbrevs (abfd, header.abbrev_offset, obstack,
+			 &prescan->tables[index]);
+}
+
+#ifdef USE_PTHREADS
+struct dwarf2_prescan_worker
+{
+  struct dwarf2_prescan *prescan;
+  bfd *abfd;
+  struct obstack *obstack;
+};
+
+/* Thread body for the prescan: keep taking the next compilation unit
+   off PRESCAN until there are none left.  */
+
+static void *
+dwarf2_prescan_worker (void *arg)
+{
+  struct dwarf2_prescan_worker *worker = arg;
+  struct dwarf2_prescan *prescan = worker->prescan;
+  int index;
+
+  while (1)
+    {
+      pthread_mutex_lock (&prescan->lock);
+      index = prescan->next_cu++;
+      pthread_mutex_unlock (&prescan->lock);
+
+      if (index >= prescan->n_comp_units)
+	break;
+
+      dwarf2_prescan_one_comp_unit (worker->abfd, prescan, index,
+				    worker->obstack);
+    }
+
+  return NULL;
+}
+#endif /* USE_PTHREADS */
+
+/* Decode the abbreviation tables of all the compilation units in
+   OBJFILE, using up to dwarf2_parallel_scan_threads threads.  The
+   calling thread does its share of the work and returns once all the
+   others are finished.  Returns NULL if no prescan was done.  */
+
+static struct dwarf2_prescan *
+dwarf2_prescan_comp_units (struct objfile *objfile)
+{
+#ifdef USE_PTHREADS
+  struct dwarf2_prescan *prescan;
+  struct dwarf2_prescan_worker *workers;
+  pthread_t *threads;
+  int n_comp_units = dwarf2_per_objfile->n_comp_units;
+  int n_workers, n_started, i;
+
+  n_workers = dwarf2_parallel_scan_threads;
+  if (n_workers > n_comp_units / DWARF2_PRESCAN_MIN_CUS_PER_THREAD)
+    n_workers = n_comp_units / DWARF2_PRESCAN_MIN_CUS_PER_THREAD;
+  if (n_workers <= 1)
+    return NULL;
+
+  prescan = xmalloc (sizeof (struct dwarf2_prescan));
+  memset (prescan, 0, sizeof (struct dwarf2_prescan));
+  prescan->n_comp_units = n_comp_units;
+  prescan->tables = xcalloc (n_comp_units,
+			     sizeof (struct dwarf2_abbrev_table));
+  prescan->n_workers = n_workers;
+  prescan->obstacks = xmalloc (n_workers * sizeof (struct obstack));
+  for (i = 0; i < n_workers; i++)
+    obstack_init (&prescan->obstacks[i]);
+  pthread_mutex_init (&prescan->lock, NULL);
+  prescan->next_cu = 0;
+
+  workers = xmalloc (n_workers * sizeof (struct dwarf2_prescan_worker));
+  threads = xmalloc (n_workers * sizeof (pthread_t));
+  for (i = 0; i < n_workers; i++)
+    {
+      workers[i].prescan = prescan;
+      workers[i].abfd = objfile->obfd;
+      workers[i].obstack = &prescan->obstacks[i];
+    }
+
+  /* Worker 0 is this thread.  If we can't start some of the others,
+     the ones that did start simply take more of the units.  */
+  n_started = 0;
+  for (i = 1; i < n_workers; i++)
+    {
+      if (pthread_create (&threads[n_started], NULL, dwarf2_prescan_worker,
+			  &workers[i]) != 0)
+	break;
+      n_started++;
+    }
+
+  dwarf2_prescan_worker (&workers[0]);
+
+  for (i = 0; i < n_started; i++)
+    pthread_join (threads[i], NULL);
+
+  xfree (threads);
+  xfree (workers);
+
+  return prescan;
+#else
+  return NULL;
+#endif /* USE_PTHREADS */
+}
+
+/* Cleanup function for dwarf2_prescan_comp_units.  */
+
+static void
+free_dwarf2_prescan (void *arg)
+{
+  struct dwarf2_prescan *prescan = arg;
+  int i;
+
+  if (prescan == NULL)
+    return;
+
+  for (i = 0; i < prescan->n_workers; i++)
+    obstack_free (&prescan->obstacks[i], NULL);
+#ifdef USE_PTHREADS
+  pthread_mutex_destroy (&prescan->lock);
+#endif
+  xfree (prescan->obstacks);
+  xfree (prescan->tables);
+  xfree (prescan);
+}
+
+/* If PRESCAN decoded the abbreviation table of the compilation unit
+   at INDEX, install it in CU and return 1.  Otherwise return 0, and
+   the caller should read the table itself.  */
+
+static int
+dwarf2_use_prescanned_abbrevs (struct dwarf2_prescan *prescan, int index,
+			       struct dwarf2_cu *cu)
+{
+  if (prescan == NULL
+      || index >= prescan->n_comp_units
+      || prescan->tables[index].abbrevs == NULL
+      || dwarf2_per_objfile->all_comp_units[index]->offset
+	 != cu->header.offset)
+    return 0;
+
+  /* The table lives on the prescan's obstacks, but the abbrev cleanup
+     still frees the CU's own obstack.  */
+  obstack_init (&cu->abbrev_obstack);
+  dwarf2_install_abbrevs (cu, &prescan->tables[index]);
+  return 1;
+}
+/* APPLE LOCAL end parallel psymtab scan  */
+
+/* APPLE LOCAL begin debug map prefetch  */
+
+/* How much of a .o file a prefetch thread reads at a time.  */
+#define DWARF2_OSO_PREFETCH_CHUNK (64 * 1024)
+
+struct dwarf2_oso_prefetch
+{
+  /* The files to read, in the order the main thread will want them.  */
+  char **names;
+  int n_names;
+
+#ifdef USE_PTHREADS
+  /* Index of the next file to hand out, and whether the main thread
+     has asked the workers to give up.  */
+  pthread_mutex_t lock;
+  int next_name;
+  int stop;
+
+  int n_threads;
+  pthread_t *threads;
+#endif
+};
+
+/* Free NAMES, an xmalloc'ed array of N_NAMES xmalloc'ed strings.  */
+
+static void
+free_oso_prefetch_names (char **names, int n_names)
+{
+  int i;
+
+  for (i = 0; i < n_names; i++)
+    xfree (names[i]);
+  xfree (names);
+}
+
+#ifdef USE_PTHREADS
+/* Return the index of the next file PREFETCH should read, or
+   N_NAMES if the workers should stop.  If ADVANCE, the file is
+   handed out to the caller.  */
+
+static int
+dwarf2_oso_prefetch_next (struct dwarf2_oso_prefetch *prefetch, int advance)
+{
+  int index;
+
+  pthread_mutex_lock (&prefetch->lock);
+  if (prefetch->stop)
+    index = prefetch->n_names;
+  else if (advance)
+    index = prefetch->next_name++;
+  else
+    index = prefetch->next_name;
+  pthread_mutex_unlock (&prefetch->lock);
+
+  return index;
+}
+
+/* Thread body for the prefetch: read each file we're handed from
+   start to end and throw the data away.  That is enough to get the
+   file into the buffer cache, so the main thread's open and nlist
+   scan don't wait on the disk or the network.  A worker must not
+   call anything that can error, so it uses the bare system calls and
+   silently skips files it can't open.  */
+
+static void *
+dwarf2_oso_prefetch_worker (void *arg)
+{
+  struct dwarf2_oso_prefetch *prefetch = arg;
+  char *buf;
+  int index, fd;
+
+  buf = malloc (DWARF2_OSO_PREFETCH_CHUNK);
+  if (buf == NULL)
+    return NULL;
+
+  while ((index = dwarf2_oso_prefetch_next (prefetch, 1)) < prefetch->n_names)
+    {
+      fd = open (prefetch->names[index], O_RDONLY);
+      if (fd < 0)
+	continue;
+
+      while (read (fd, buf, DWARF2_OSO_PREFETCH_CHUNK) > 0
+	     && dwarf2_oso_prefetch_next (prefetch, 0) < prefetch->n_names)
+	;
+
+      close (fd);
+    }
+
+  free (buf);
+  return NULL;
+}
+#endif /* USE_PTHREADS */
+
+/* Return non-zero if dwarf2_start_oso_prefetch would start any
+   threads, so callers can skip collecting the file names.  */
+
+int
+dwarf2_oso_prefetch_wanted (void)
+{
+#ifdef USE_PTHREADS
+  return dwarf2_oso_prefetch_threads > 0;
+#else
+  return 0;
+#endif
+}
+
+/* Start up to dwarf2_oso_prefetch_threads threads reading the
+   N_NAMES files in NAMES into the buffer cache, in order.  NAMES
+   becomes the prefetch's, and is freed along with it.  The threads
+   run until they run out of files or dwarf2_finish_oso_prefetch is
+   called.  Returns NULL if no threads were started.  */
+
+struct dwarf2_oso_prefetch *
+dwarf2_start_oso_prefetch (char **names, int n_names)
+{
+#ifdef USE_PTHREADS
+  struct dwarf2_oso_prefetch *prefetch;
+  int n_threads, i;
+
+  n_threads = dwarf2_oso_prefetch_threads;
+  if (n_threads > n_names)
+    n_threads = n_names;
+  if (n_threads <= 0)
+    {
+      free_oso_prefetch_names (names, n_names);
+      return NULL;
+    }
+
+  prefetch = xmalloc (sizeof (struct dwarf2_oso_prefetch));
+  memset (prefetch, 0, sizeof (struct dwarf2_oso_prefetch));
+  prefetch->names = names;
+  prefetch->n_names = n_names;
+  pthread_mutex_init (&prefetch->lock, NULL);
+  prefetch->threads = xmalloc (n_threads * sizeof (pthread_t));
+
+  for (i = 0; i < n_threads; i++)
+    {
+      if (pthread_create (&prefetch->threads[prefetch->n_threads], NULL,
+			  dwarf2_oso_prefetch_worker, prefetch) != 0)
+	break;
+      prefetch->n_threads++;
+    }
+
+  if (prefetch->n_threads == 0)
+    {
+      dwarf2_finish_oso_prefetch (prefetch);
+      return NULL;
+    }
+
+  return prefetch;
+#else
+  free_oso_prefetch_names (names, n_names);
+  return NULL;
+#endif /* USE_PTHREADS */
+}
+
+/* Stop the threads of PREFETCH, wait for them, and free it.  Files
+   the workers haven't got to yet are the ones the main thread has
+   already read itself, so there's no point finishing them.  This is
+   a cleanup function; PREFETCH may be NULL.  */
+
+void
+dwarf2_finish_oso_prefetch (void *arg)
+{
+  struct dwarf2_oso_prefetch *prefetch = arg;
+
+  if (prefetch == NULL)
+    return;
+
+#ifdef USE_PTHREADS
+  {
+    int i;
+
+    pthread_mutex_lock (&prefetch->lock);
+    prefetch->stop = 1;
+    pthread_mutex_unlock (&prefetch->lock);
+
+    for (i = 0; i < prefetch->n_threads; i++)
+      pthread_join (prefetch->threads[i], NULL);
+
+    pthread_mutex_destroy (&prefetch->lock);
+    xfree (prefetch->threads);
+  }
+#endif
+
+  free_oso_prefetch_names (prefetch->names, prefetch->n_names);
+  xfree (prefetch);
+}
+/* APPLE LOCAL end debug map prefetch  */
+
 /* Build the partial symbol table by doing a quick pass through the
    .debug_info and .debug_abbrev sections.  */
+/* APPLE LOCAL dwarf2 name index: If SKIM is non-zero, only read each
+   compilation unit's DIE, and don't look at its children unless we
+   need them to work out its address range.  */
 
 static void
-dwarf2_build_psymtabs_hard (struct objfile *objfile, int mainline)
+dwarf2_build_psymtabs_hard (struct objfile *objfile, int mainline, int skim)
 {
   /* Instead of reading this into a big buffer, we should probably use
      mmap()  on architectures that support it. (FIXME) */
@@ -2335,6 +3386,9 @@ dwarf2_build_psymtabs_hard (struct objfile *objfile, int mainline)
   struct partial_symtab *pst;
   struct cleanup *back_to;
   CORE_ADDR lowpc, highpc, baseaddr;
+  /* APPLE LOCAL parallel psymtab scan  */
+  struct dwarf2_prescan *prescan;
+  int cu_index = 0;
 
   /* APPLE LOCAL begin dwarf repository  */
   if (bfd_big_endian (abfd) == BFD_ENDIAN_BIG)
@@ -2344,12 +3398,20 @@ dwarf2_build_psymtabs_hard (struct objfile *objfile, int mainline)
   /* APPLE LOCAL end dwarf repository  */
   info_ptr = dwarf2_per_objfile->info_buffer;
 
+  /* APPLE LOCAL compressed debug sections: We are about to walk all
+     of it, possibly from the prescan threads too.  */
+  dwarf2_ensure_info (0, dwarf2_per_objfile->info_size);
+
   /* Any cached compilation units will be linked by the per-objfile
      read_in_chain.  Make sure to free them when we're done.  */
   back_to = make_cleanup (free_cached_comp_units, NULL);
 
   create_all_comp_units (objfile);
 
+  /* APPLE LOCAL parallel psymtab scan  */
+  prescan = dwarf2_prescan_comp_units (objfile);
+  make_cleanup (free_dwarf2_prescan, prescan);
+
   /* Since the objects we're extracting from .debug_info vary in
      length, only the individual functions to extract them (like
      read_comp_unit_head and load_partial_die) can really know whether
@@ -2391,7 +3453,9 @@ dwarf2_build_psymtabs_hard (struct objfile *objfile, int mainline)
       cu.list_in_scope = &file_symbols;
 
       /* Read the abbrevs for this compilation unit into a table */
-      dwarf2_read_abbrevs (abfd, &cu);
+      /* APPLE LOCAL parallel psymtab scan  */
+      if (!dwarf2_use_prescanned_abbrevs (prescan, cu_index++, &cu))
+	dwarf2_read_abbrevs (abfd, &cu);
       make_cleanup (dwarf2_free_abbrev_table, &cu);
 
       this_cu = dwarf2_find_comp_unit (cu.header.offset, objfile);
@@ -2451,7 +3515,8 @@ dwarf2_build_psymtabs_hard (struct objfile *objfile, int mainline)
       /* Check if comp unit has_children.
          If so, read the rest of the partial symbols from this comp unit.
          If not, there's no more debug_info for this comp unit. */
-      if (comp_unit_die.has_children)
+      /* APPLE LOCAL dwarf2 name index  */
+      if (comp_unit_die.has_children && !(skim && comp_unit_die.has_pc_info))
 	{
 	  struct partial_die_info *first_die;
 	  /* APPLE LOCAL psym equivalences  */
@@ -2509,14 +3574,641 @@ dwarf2_build_psymtabs_hard (struct objfile *objfile, int mainline)
           dwarf2_build_include_psymtabs (&cu, &comp_unit_die, pst);
         }
 
-      do_cleanups (back_to_inner);
+      do_cleanups (back_to_inner);
+    }
+
+  sort_objfile_thumb_psyms (objfile);
+    
+  do_cleanups (back_to);
+
+}
+
+/* APPLE LOCAL begin psymtab cache  */
+
+/* The partial symbol table cache.
+
+   Building the partial symbol tables for a large dSYM means walking
+   every DIE in its .debug_info, and the result only depends on the
+   DWARF itself.  So when "maint set dwarf2 psymtab-cache-directory"
+   is set, the psymtabs dwarf2_build_psymtabs_hard builds are written
+   to a file in that directory named after the objfile's Mach-O UUID,
+   and the next time we see an objfile with that UUID we rebuild them
+   straight from the file instead.
+
+   The file is laid out so it can be mapped and used in place: a
+   header, then arrays of fixed size records for the psymtabs, the
+   partial symbols and the psym equivalence names, then a string
+   table that all the names are offsets into.  Addresses are stored
+   as they were computed for the objfile's text offset at the time the
+   file was written, and are slid by the difference when read back.
+   Only the DWARF reader's psymtabs are cached; they're the only ones
+   whose read_symtab_private can be rebuilt from a .debug_info
+   offset.  */
+
+#define PSYMTAB_CACHE_MAGIC "GDBPSYM"
+#define PSYMTAB_CACHE_VERSION 1
+
+/* Marks a missing string.  */
+#define PSYMTAB_CACHE_NO_STRING ((unsigned int) -1)
+
+struct psymtab_cache_header
+{
+  char magic[8];
+  unsigned int version;
+
+  /* sizeof the header and each record type, so that a file written
+     by a gdb with a different layout is discarded.  */
+  unsigned short header_size;
+  unsigned short pst_size;
+  unsigned short psym_size;
+  unsigned short addr_size;
+
+  unsigned char uuid[16];
+
+  /* Sizes of the sections the psymtabs were built from.  */
+  unsigned int info_size;
+  unsigned int abbrev_size;
+  unsigned int str_size;
+
+  unsigned int n_psymtabs;
+  unsigned int n_psymbols;
+  unsigned int n_equivs;
+  unsigned int strings_size;
+
+  /* objfile_text_section_offset when the file was written.  */
+  ULONGEST baseaddr;
+};
+
+struct psymtab_cache_pst
+{
+  unsigned int filename;
+  unsigned int dirname;
+
+  /* For a compilation unit's psymtab, the offset of the unit in
+     .debug_info.  */
+  unsigned int cu_offset;
+
+  /* For an include psymtab, the index of the psymtab it depends on;
+     -1 for a compilation unit's psymtab.  */
+  int parent;
+
+  ULONGEST textlow;
+  ULONGEST texthigh;
+
+  /* Indexes into the psymbol and equivalence arrays.  */
+  unsigned int first_global;
+  unsigned int n_global;
+  unsigned int first_static;
+  unsigned int n_static;
+  unsigned int first_equiv;
+  unsigned int n_equiv;
+};
+
+struct psymtab_cache_psym
+{
+  unsigned int name;
+  unsigned char domain;
+  unsigned char aclass;
+  unsigned char language;
+  unsigned char pad;
+  ULONGEST value;
+};
+
+/* Return the full name of the cache file for OBJFILE in a string
+   allocated with xmalloc, or NULL if the cache is disabled or OBJFILE
+   has no UUID.  If UUID is non-NULL it is set to OBJFILE's UUID.  */
+
+static char *
+psymtab_cache_file_name (struct objfile *objfile, unsigned char *uuid)
+{
+  unsigned char buf[16];
+  char *name;
+  int i, len;
+
+  if (dwarf2_psymtab_cache_directory == NULL
+      || *dwarf2_psymtab_cache_directory == '\0')
+    return NULL;
+
+  if (!bfd_mach_o_get_uuid (objfile->obfd, buf, sizeof (buf)))
+    return NULL;
+
+  if (uuid != NULL)
+    memcpy (uuid, buf, sizeof (buf));
+
+  len = strlen (dwarf2_psymtab_cache_directory);
+  name = xmalloc (len + 1 + 2 * sizeof (buf) + sizeof (".psymtabs"));
+  strcpy (name, dwarf2_psymtab_cache_directory);
+  name[len++] = '/';
+  for (i = 0; i < sizeof (buf); i++)
+    len += sprintf (name + len, "%02X", buf[i]);
+  strcpy (name + len, ".psymtabs");
+
+  return name;
+}
+
+/* Slide ADDR for a partial symbol of class ACLASS by DELTA, if it's
+   something that moves with the objfile.  */
+
+static CORE_ADDR
+psymtab_cache_slide (enum address_class aclass, ULONGEST addr,
+		     CORE_ADDR delta)
+{
+  if (aclass == LOC_BLOCK || aclass == LOC_STATIC)
+    return (CORE_ADDR) addr + delta;
+  return (CORE_ADDR) addr;
+}
+
+/* Try to build OBJFILE's partial symbol tables from the psymtab
+   cache.  The DWARF sections must already be read in.  Returns 1 on
+   success, 0 if there is no usable cache file, in which case OBJFILE
+   is untouched.  */
+
+static int
+dwarf2_read_psymtab_cache (struct objfile *objfile)
+{
+  unsigned char uuid[16];
+  char *filename;
+  int fd;
+  struct stat st;
+  char *data;
+  const struct psymtab_cache_header *header;
+  const struct psymtab_cache_pst *psts;
+  const struct psymtab_cache_psym *psyms;
+  const unsigned int *equivs;
+  const char *strings;
+  struct partial_symtab **made;
+  CORE_ADDR baseaddr, delta;
+  unsigned long expected;
+  unsigned int i, j;
+  int ok = 0;
+
+  filename = psymtab_cache_file_name (objfile, uuid);
+  if (filename == NULL)
+    return 0;
+
+  fd = open (filename, O_RDONLY | O_BINARY);
+  xfree (filename);
+  if (fd < 0)
+    return 0;
+
+  if (fstat (fd, &st) != 0 || st.st_size < sizeof (struct psymtab_cache_header))
+    {
+      close (fd);
+      return 0;
+    }
+
+#ifdef HAVE_MMAP
+  data = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == (char *) MAP_FAILED)
+    {
+      close (fd);
+      return 0;
+    }
+#else
+  data = xmalloc (st.st_size);
+  if (read (fd, data, st.st_size) != st.st_size)
+    {
+      xfree (data);
+      close (fd);
+      return 0;
+    }
+#endif
+  close (fd);
+
+  header = (const struct psymtab_cache_header *) data;
+  if (memcmp (header->magic, PSYMTAB_CACHE_MAGIC, sizeof (header->magic)) != 0
+      || header->version != PSYMTAB_CACHE_VERSION
+      || header->header_size != sizeof (struct psymtab_cache_header)
+      || header->pst_size != sizeof (struct psymtab_cache_pst)
+      || header->psym_size != sizeof (struct psymtab_cache_psym)
+      || header->addr_size != sizeof (CORE_ADDR)
+      || memcmp (header->uuid, uuid, sizeof (uuid)) != 0
+      || header->info_size != dwarf2_per_objfile->info_size
+      || header->abbrev_size != dwarf2_per_objfile->abbrev_size
+      || header->str_size != dwarf2_per_objfile->str_size)
+    goto done;
+
+  expected = (sizeof (struct psymtab_cache_header)
+	      + header->n_psymtabs * sizeof (struct psymtab_cache_pst)
+	      + header->n_psymbols * sizeof (struct psymtab_cache_psym)
+	      + header->n_equivs * sizeof (unsigned int)
+	      + header->strings_size);
+  if (expected != st.st_size || header->strings_size == 0)
+    goto done;
+
+  psts = (const struct psymtab_cache_pst *) (header + 1);
+  psyms = (const struct psymtab_cache_psym *) (psts + header->n_psymtabs);
+  equivs = (const unsigned int *) (psyms + header->n_psymbols);
+  strings = (const char *) (equivs + header->n_equivs);
+
+  /* The string table must be terminated, after which checking that
+     each offset is in range is enough to make every name safe.  */
+  if (strings[header->strings_size - 1] != '\0')
+    goto done;
+
+#define CACHE_STRING_OK(off) \
+  ((off) == PSYMTAB_CACHE_NO_STRING || (off) < header->strings_size)
+
+  /* Validate everything before creating anything, so that a corrupt
+     file leaves the objfile alone.  */
+  for (i = 0; i < header->n_psymtabs; i++)
+    {
+      const struct psymtab_cache_pst *p = &psts[i];
+
+      if (p->filename == PSYMTAB_CACHE_NO_STRING
+	  || !CACHE_STRING_OK (p->filename)
+	  || !CACHE_STRING_OK (p->dirname)
+	  || p->parent >= (int) i
+	  || (p->parent < 0 && p->cu_offset >= dwarf2_per_objfile->info_size)
+	  || p->first_global > header->n_psymbols
+	  || p->n_global > header->n_psymbols - p->first_global
+	  || p->first_static > header->n_psymbols
+	  || p->n_static > header->n_psymbols - p->first_static
+	  || p->first_equiv > header->n_equivs
+	  || p->n_equiv > header->n_equivs - p->first_equiv)
+	goto done;
+    }
+  for (i = 0; i < header->n_psymbols; i++)
+    if (psyms[i].name >= header->strings_size)
+      goto done;
+  for (i = 0; i < header->n_equivs; i++)
+    if (equivs[i] >= header->strings_size)
+      goto done;
+
+#undef CACHE_STRING_OK
+
+  create_all_comp_units (objfile);
+
+  /* Every compilation unit psymtab must start a unit in this
+     .debug_info.  */
+  for (i = 0; i < header->n_psymtabs; i++)
+    if (psts[i].parent < 0
+	&& dwarf2_find_comp_unit_noerror (psts[i].cu_offset) == NULL)
+      goto done;
+
+  baseaddr = objfile_text_section_offset (objfile);
+  delta = baseaddr - (CORE_ADDR) header->baseaddr;
+
+  made = xmalloc ((header->n_psymtabs + 1) * sizeof (struct partial_symtab *));
+  for (i = 0; i < header->n_psymtabs; i++)
+    {
+      const struct psymtab_cache_pst *p = &psts[i];
+      struct partial_symtab *pst;
+      struct dwarf2_per_cu_data *this_cu;
+
+      if (p->parent >= 0)
+	{
+	  dwarf2_create_include_psymtab ((char *) strings + p->filename,
+					 made[p->parent], objfile);
+	  made[i] = objfile->psymtabs;
+	  continue;
+	}
+
+      this_cu = dwarf2_find_comp_unit_noerror (p->cu_offset);
+
+      pst = start_psymtab_common (objfile, objfile->section_offsets,
+				  (char *) strings + p->filename,
+				  (CORE_ADDR) p->textlow + delta,
+				  objfile->global_psymbols.next,
+				  objfile->static_psymbols.next);
+      if (p->dirname != PSYMTAB_CACHE_NO_STRING)
+	pst->dirname = obsavestring (strings + p->dirname,
+				     strlen (strings + p->dirname),
+				     &objfile->objfile_obstack);
+      pst->read_symtab_private = (char *) this_cu;
+      pst->read_symtab = dwarf2_psymtab_to_symtab;
+      this_cu->psymtab = pst;
+
+      for (j = 0; j < p->n_global + p->n_static; j++)
+	{
+	  const struct psymtab_cache_psym *q;
+	  struct psymbol_allocation_list *list;
+
+	  if (j < p->n_global)
+	    {
+	      q = &psyms[p->first_global + j];
+	      list = &objfile->global_psymbols;
+	    }
+	  else
+	    {
+	      q = &psyms[p->first_static + j - p->n_global];
+	      list = &objfile->static_psymbols;
+	    }
+
+	  add_psymbol_to_list ((char *) strings + q->name,
+			       strlen (strings + q->name),
+			       (domain_enum) q->domain,
+			       (enum address_class) q->aclass, list, 0,
+			       psymtab_cache_slide (q->aclass, q->value, delta),
+			       (enum language) q->language, objfile);
+	}
+
+      for (j = 0; j < p->n_equiv; j++)
+	{
+	  add_equiv_psym (&pst->equiv_psyms,
+			  xstrdup (strings + equivs[p->first_equiv + j]));
+	  psym_equivalences = 1;
+	}
+
+      pst->texthigh = (CORE_ADDR) p->texthigh + delta;
+      pst->n_global_syms = objfile->global_psymbols.next -
+	(objfile->global_psymbols.list + pst->globals_offset);
+      pst->n_static_syms = objfile->static_psymbols.next -
+	(objfile->static_psymbols.list + pst->statics_offset);
+      sort_pst_symbols (pst);
+
+      free_named_symtabs (pst->filename);
+      made[i] = pst;
+    }
+  xfree (made);
+
+  sort_objfile_thumb_psyms (objfile);
+  ok = 1;
+
+ done:
+#ifdef HAVE_MMAP
+  munmap (data, st.st_size);
+#else
+  xfree (data);
+#endif
+  return ok;
+}
+
+/* State for dwarf2_write_psymtab_cache.  */
+
+struct psymtab_cache_writer
+{
+  /* The string table being built, and a map from the names already
+     in it (by address - they're almost all bcached) to offsets.  */
+  struct obstack strings;
+  unsigned int strings_size;
+  htab_t string_offsets;
+};
+
+struct psymtab_cache_string
+{
+  const char *name;
+  unsigned int offset;
+};
+
+static hashval_t
+psymtab_cache_string_hash (const void *p)
+{
+  return htab_hash_pointer (((const struct psymtab_cache_string *) p)->name);
+}
+
+static int
+psymtab_cache_string_eq (const void *a, const void *b)
+{
+  return (((const struct psymtab_cache_string *) a)->name
+	  == ((const struct psymtab_cache_string *) b)->name);
+}
+
+/* Return the offset of NAME in WRITER's string table, adding it if
+   necessary.  */
+
+static unsigned int
+psymtab_cache_add_string (struct psymtab_cache_writer *writer,
+			  const char *name)
+{
+  struct psymtab_cache_string key, *entry;
+  void **slot;
+  int len;
+
+  if (name == NULL)
+    return PSYMTAB_CACHE_NO_STRING;
+
+  key.name = name;
+  slot = htab_find_slot (writer->string_offsets, &key, INSERT);
+  if (*slot != NULL)
+    return ((struct psymtab_cache_string *) *slot)->offset;
+
+  entry = xmalloc (sizeof (struct psymtab_cache_string));
+  entry->name = name;
+  entry->offset = writer->strings_size;
+  *slot = entry;
+
+  len = strlen (name) + 1;
+  obstack_grow (&writer->strings, name, len);
+  writer->strings_size += len;
+
+  return entry->offset;
+}
+
+/* Append a cache record for each of the N partial symbols at SYMS to
+   PSYMS, which has room for them.  */
+
+static void
+psymtab_cache_add_psyms (struct psymtab_cache_writer *writer,
+			 struct psymtab_cache_psym *psyms,
+			 struct partial_symbol **syms, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      struct partial_symbol *sym = syms[i];
+
+      memset (&psyms[i], 0, sizeof (struct psymtab_cache_psym));
+      psyms[i].name = psymtab_cache_add_string (writer,
+						DEPRECATED_SYMBOL_NAME (sym));
+      psyms[i].domain = PSYMBOL_DOMAIN (sym);
+      psyms[i].aclass = PSYMBOL_CLASS (sym);
+      psyms[i].language = SYMBOL_LANGUAGE (sym);
+      if (PSYMBOL_CLASS (sym) == LOC_CONST)
+	psyms[i].value = (ULONGEST) SYMBOL_VALUE (sym);
+      else
+	psyms[i].value = (ULONGEST) SYMBOL_VALUE_ADDRESS (sym);
+    }
+}
+
+static void
+psymtab_cache_free_writer (void *arg)
+{
+  struct psymtab_cache_writer *writer = arg;
+
+  obstack_free (&writer->strings, NULL);
+  htab_delete (writer->string_offsets);
+}
+
+/* Write the psymtabs dwarf2_build_psymtabs_hard just made for OBJFILE
+   - everything on the psymtab chain in front of OLD_PSYMTABS - to the
+   psymtab cache.  Any problem just means there's no cache file.  */
+
+static void
+dwarf2_write_psymtab_cache (struct objfile *objfile,
+			    struct partial_symtab *old_psymtabs)
+{
+  struct psymtab_cache_header header;
+  struct psymtab_cache_pst *psts;
+  struct psymtab_cache_psym *psyms;
+  unsigned int *equivs;
+  struct partial_symtab *pst, **order;
+  struct psymtab_cache_writer writer;
+  struct cleanup *back_to;
+  char *filename, *tmpname;
+  unsigned int n, i, k, n_psyms, n_equivs;
+  FILE *f;
+  int ok;
+
+  memset (&header, 0, sizeof (header));
+  filename = psymtab_cache_file_name (objfile, header.uuid);
+  if (filename == NULL)
+    return;
+  back_to = make_cleanup (xfree, filename);
+
+  /* The psymtabs are chained newest first; put them back in the order
+     they were made, so that include psymtabs follow their parents.  */
+  n = 0;
+  for (pst = objfile->psymtabs; pst != old_psymtabs; pst = pst->next)
+    {
+      if (pst->read_symtab != dwarf2_psymtab_to_symtab)
+	{
+	  do_cleanups (back_to);
+	  return;
+	}
+      n++;
+    }
+  if (n == 0)
+    {
+      do_cleanups (back_to);
+      return;
+    }
+
+  order = xmalloc (n * sizeof (struct partial_symtab *));
+  make_cleanup (xfree, order);
+  i = n;
+  for (pst = objfile->psymtabs; pst != old_psymtabs; pst = pst->next)
+    order[--i] = pst;
+
+  n_psyms = 0;
+  n_equivs = 0;
+  for (i = 0; i < n; i++)
+    {
+      n_psyms += order[i]->n_global_syms + order[i]->n_static_syms;
+      if (order[i]->equiv_psyms != NULL)
+	n_equivs += order[i]->equiv_psyms->num_syms;
+    }
+
+  psts = xcalloc (n, sizeof (struct psymtab_cache_pst));
+  make_cleanup (xfree, psts);
+  psyms = xcalloc (n_psyms + 1, sizeof (struct psymtab_cache_psym));
+  make_cleanup (xfree, psyms);
+  equivs = xcalloc (n_equivs + 1, sizeof (unsigned int));
+  make_cleanup (xfree, equivs);
+
+  obstack_init (&writer.strings);
+  writer.strings_size = 0;
+  writer.string_offsets = htab_create_alloc (n_psyms / 2 + 1,
+					     psymtab_cache_string_hash,
+					     psymtab_cache_string_eq,
+					     xfree, xcalloc, xfree);
+  make_cleanup (psymtab_cache_free_writer, &writer);
+
+  n_psyms = 0;
+  n_equivs = 0;
+  for (i = 0; i < n; i++)
+    {
+      struct psymtab_cache_pst *p = &psts[i];
+      struct dwarf2_per_cu_data *per_cu;
+
+      pst = order[i];
+      p->filename = psymtab_cache_add_string (&writer, pst->filename);
+      p->dirname = psymtab_cache_add_string (&writer, pst->dirname);
+      p->textlow = pst->textlow;
+      p->texthigh = pst->texthigh;
+
+      if (pst->read_symtab_private == NULL)
+	{
+	  /* An include psymtab; find the psymtab it belongs to.  */
+	  p->parent = -1;
+	  for (k = 0; k < i; k++)
+	    if (pst->number_of_dependencies == 1
+		&& order[k] == pst->dependencies[0])
+	      p->parent = k;
+	  if (p->parent < 0)
+	    {
+	      do_cleanups (back_to);
+	      return;
+	    }
+	  continue;
+	}
+
+      per_cu = (struct dwarf2_per_cu_data *) pst->read_symtab_private;
+      p->parent = -1;
+      p->cu_offset = per_cu->offset;
+
+      p->first_global = n_psyms;
+      p->n_global = pst->n_global_syms;
+      psymtab_cache_add_psyms (&writer, &psyms[n_psyms],
+			       objfile->global_psymbols.list
+			       + pst->globals_offset,
+			       pst->n_global_syms);
+      n_psyms += pst->n_global_syms;
+
+      p->first_static = n_psyms;
+      p->n_static = pst->n_static_syms;
+      psymtab_cache_add_psyms (&writer, &psyms[n_psyms],
+			       objfile->static_psymbols.list
+			       + pst->statics_offset,
+			       pst->n_static_syms);
+      n_psyms += pst->n_static_syms;
+
+      p->first_equiv = n_equivs;
+      if (pst->equiv_psyms != NULL)
+	for (k = 0; k < pst->equiv_psyms->num_syms; k++)
+	  equivs[n_equivs++]
+	    = psymtab_cache_add_string (&writer,
+					pst->equiv_psyms->sym_list[k]);
+      p->n_equiv = n_equivs - p->first_equiv;
+    }
+
+  /* Terminate the string table even if it's empty.  */
+  obstack_1grow (&writer.strings, '\0');
+  writer.strings_size++;
+
+  memcpy (header.magic, PSYMTAB_CACHE_MAGIC, sizeof (header.magic));
+  header.version = PSYMTAB_CACHE_VERSION;
+  header.header_size = sizeof (struct psymtab_cache_header);
+  header.pst_size = sizeof (struct psymtab_cache_pst);
+  header.psym_size = sizeof (struct psymtab_cache_psym);
+  header.addr_size = sizeof (CORE_ADDR);
+  header.info_size = dwarf2_per_objfile->info_size;
+  header.abbrev_size = dwarf2_per_objfile->abbrev_size;
+  header.str_size = dwarf2_per_objfile->str_size;
+  header.n_psymtabs = n;
+  header.n_psymbols = n_psyms;
+  header.n_equivs = n_equivs;
+  header.strings_size = writer.strings_size;
+  header.baseaddr = objfile_text_section_offset (objfile);
+
+  /* Write to a temporary file and rename it into place, so a reader
+     never sees a partial file.  */
+  tmpname = xstrprintf ("%s.%ld", filename, (long) getpid ());
+  make_cleanup (xfree, tmpname);
+  f = fopen (tmpname, FOPEN_WB);
+  if (f == NULL)
+    {
+      do_cleanups (back_to);
+      return;
     }
 
-  sort_objfile_thumb_psyms (objfile);
-    
-  do_cleanups (back_to);
+  ok = (fwrite (&header, sizeof (header), 1, f) == 1
+	&& fwrite (psts, sizeof (struct psymtab_cache_pst), n, f) == n
+	&& fwrite (psyms, sizeof (struct psymtab_cache_psym), n_psyms,
+		   f) == n_psyms
+	&& fwrite (equivs, sizeof (unsigned int), n_equivs, f) == n_equivs
+	&& fwrite (obstack_finish (&writer.strings), 1, writer.strings_size,
+		   f) == writer.strings_size);
+  if (fclose (f) != 0)
+    ok = 0;
 
+  if (!ok || rename (tmpname, filename) != 0)
+    unlink (tmpname);
+
+  do_cleanups (back_to);
 }
+/* APPLE LOCAL end psymtab cache  */
 
 /* Load the DIEs for a secondary CU into memory.  */
 
@@ -2531,6 +4223,8 @@ load_comp_unit (struct dwarf2_per_cu_data *this_cu, struct objfile *objfile)
   unsigned int bytes_read;
   struct cleanup *back_to;
 
+  /* APPLE LOCAL compressed debug sections  */
+  dwarf2_ensure_info (this_cu->offset, this_cu->length);
   info_ptr = dwarf2_per_objfile->info_buffer + this_cu->offset;
   beg_of_comp_unit = info_ptr;
 
@@ -2604,6 +4298,8 @@ create_all_comp_units (struct objfile *objfile)
 
       /* Read just enough information to find out where the next
 	 compilation unit is.  */
+      /* APPLE LOCAL compressed debug sections  */
+      dwarf2_ensure_info (offset, 12);
       cu_header.initial_length_size = 0;
       cu_header.length = read_initial_length (objfile->obfd, info_ptr,
 					      &cu_header, &bytes_read);
@@ -4461,6 +6157,8 @@ find_debug_info_for_pst (struct partial_symtab *pst, int match_amount)
   /* Any cached compilation units will be linked by the per-objfile 
      read_in_chain.  Make sure to free them when we're done.  */
   info_ptr = dwarf2_per_objfile->info_buffer;
+  /* APPLE LOCAL compressed debug sections  */
+  dwarf2_ensure_info (0, dwarf2_per_objfile->info_size);
   back_to = make_cleanup (free_cached_comp_units, NULL);
 
   const char *pst_filename = pst->filename;
@@ -4585,6 +6283,8 @@ process_queue (struct objfile *objfile)
     {
       /* Read in this compilation unit.  This may add new items to
 	 the end of the queue.  */
+      /* APPLE LOCAL dwarf2 cache limit  */
+      dwarf2_cache_stats.misses++;
       /* APPLE LOCAL debug map: NULL second argument. */
       load_full_comp_unit (item->per_cu, NULL);
 
@@ -4696,8 +6396,8 @@ psymtab_to_symtab_1 (struct partial_symtab *pst)
 /* APPLE LOCAL debug map: Accept an optional 2nd parameter ADDR_MAP */
 
 static struct dwarf2_cu *
-load_full_comp_unit (struct dwarf2_per_cu_data *per_cu,
-                     struct oso_to_final_addr_map *addr_map)
+load_full_comp_unit_1 (struct dwarf2_per_cu_data *per_cu,
+                       struct oso_to_final_addr_map *addr_map)
 {
   struct partial_symtab *pst = per_cu->psymtab;
   bfd *abfd = pst->objfile->obfd;
@@ -4712,6 +6412,8 @@ load_full_comp_unit (struct dwarf2_per_cu_data *per_cu,
   /* Set local variables from the partial symbol table info.  */
   offset = per_cu->offset;
 
+  /* APPLE LOCAL compressed debug sections  */
+  dwarf2_ensure_info (offset, per_cu->length);
   info_ptr = dwarf2_per_objfile->info_buffer + offset;
 
   cu = xmalloc (sizeof (struct dwarf2_cu));
@@ -4740,6 +6442,8 @@ load_full_comp_unit (struct dwarf2_per_cu_data *per_cu,
   /* We use this obstack for block values in dwarf_alloc_block.  */
   obstack_init (&cu->comp_unit_obstack);
 
+  /* APPLE LOCAL packed dies  */
+  init_die_storage (cu);
   cu->dies = read_comp_unit (info_ptr, abfd, cu);
 
   /* We try not to read any attributes in this function, because not
@@ -4761,6 +6465,21 @@ load_full_comp_unit (struct dwarf2_per_cu_data *per_cu,
   return cu;
 }
 
+/* APPLE LOCAL begin gdb stats  */
+static struct dwarf2_cu *
+load_full_comp_unit (struct dwarf2_per_cu_data *per_cu,
+                     struct oso_to_final_addr_map *addr_map)
+{
+  struct gdb_stat_timer timer;
+  struct dwarf2_cu *cu;
+
+  gdb_stat_start (GDB_STAT_CU_READ, &timer);
+  cu = load_full_comp_unit_1 (per_cu, addr_map);
+  gdb_stat_stop (GDB_STAT_CU_READ, &timer, per_cu->length);
+  return cu;
+}
+/* APPLE LOCAL end gdb stats  */
+
 /* APPLE LOCAL begin inlined function symbols & blocks  */
 static void
 fix_inlined_subroutine_symbols (void)
@@ -4781,32 +6500,16 @@ fix_inlined_subroutine_symbols (void)
 }
 /* APPLE LOCAL end inlined function symbols & blocks  */
 
-/* Generate full symbol information for PST and CU, whose DIEs have
-   already been loaded into memory.  */
+/* APPLE LOCAL lazy function symbols: Split out of
+   process_full_comp_unit, so that dwarf2_expand_lazy_scope can set up a
+   reloaded compilation unit the same way.  */
+
+/* Set CU's base address for range lists and location lists.  */
 
 static void
-process_full_comp_unit (struct dwarf2_per_cu_data *per_cu)
+dwarf2_find_base_address (struct dwarf2_cu *cu)
 {
-  struct partial_symtab *pst = per_cu->psymtab;
-  struct dwarf2_cu *cu = per_cu->cu;
-  struct objfile *objfile = pst->objfile;
-  /* APPLE LOCAL avoid unused var warning.  */
-  /* bfd *abfd = objfile->obfd; */
-  CORE_ADDR lowpc, highpc;
-  struct symtab *symtab;
-  struct cleanup *back_to;
   struct attribute *attr;
-  CORE_ADDR baseaddr;
-
-  baseaddr = objfile_text_section_offset (objfile);
-
-  /* We're in the global namespace.  */
-  processing_current_prefix = "";
-
-  buildsym_init ();
-  back_to = make_cleanup (really_free_pendings, NULL);
-
-  cu->list_in_scope = &file_symbols;
 
   /* Find the base address of the compilation unit for range lists and
      location lists.  It will normally be specified by DW_AT_low_pc.
@@ -4845,6 +6548,36 @@ process_full_comp_unit (struct dwarf2_per_cu_data *per_cu)
       cu->header.base_address_untranslated = cu->per_cu->psymtab->textlow;
       cu->header.base_known = 1;
     }
+}
+
+/* Generate full symbol information for PST and CU, whose DIEs have
+   already been loaded into memory.  */
+
+static void
+process_full_comp_unit (struct dwarf2_per_cu_data *per_cu)
+{
+  struct partial_symtab *pst = per_cu->psymtab;
+  struct dwarf2_cu *cu = per_cu->cu;
+  struct objfile *objfile = pst->objfile;
+  /* APPLE LOCAL avoid unused var warning.  */
+  /* bfd *abfd = objfile->obfd; */
+  CORE_ADDR lowpc, highpc;
+  struct symtab *symtab;
+  struct cleanup *back_to;
+  CORE_ADDR baseaddr;
+
+  baseaddr = objfile_text_section_offset (objfile);
+
+  /* We're in the global namespace.  */
+  processing_current_prefix = "";
+
+  buildsym_init ();
+  back_to = make_cleanup (really_free_pendings, NULL);
+
+  cu->list_in_scope = &file_symbols;
+
+  /* APPLE LOCAL lazy function symbols  */
+  dwarf2_find_base_address (cu);
 
   /* Do line number decoding in read_file_scope () */
   /* APPLE LOCAL begin inlined function symbols & blocks  */
@@ -5015,6 +6748,8 @@ static void
 initialize_cu_func_list (struct dwarf2_cu *cu)
 {
   cu->first_fn = cu->last_fn = cu->cached_fn = NULL;
+  /* APPLE LOCAL line table decoding  */
+  cu->sorted_fns = NULL;
 }
 
 static void
@@ -5154,8 +6889,18 @@ read_file_scope (struct die_info *die, struct dwarf2_cu *cu)
   if (attr && line_header)
     {
       unsigned int macro_offset = DW_UNSND (attr);
-      dwarf_decode_macros (line_header, macro_offset,
-                           comp_dir, abfd, cu);
+      /* APPLE LOCAL begin lazy macro tables  */
+      struct attribute *stmt_list = dwarf2_attr (die, DW_AT_stmt_list, cu);
+
+      if (dwarf2_lazy_macros
+	  && dwarf2_per_objfile == objfile_data (objfile,
+						 dwarf2_objfile_data_key))
+	dwarf2_defer_macros (DW_UNSND (stmt_list), macro_offset, comp_dir,
+			     cu);
+      else
+	dwarf_decode_macros (line_header, macro_offset,
+			     comp_dir, abfd, cu);
+      /* APPLE LOCAL end lazy macro tables  */
     }
   do_cleanups (back_to);
 }
@@ -5180,6 +6925,8 @@ add_to_cu_func_list (const char *name, CORE_ADDR lowpc, CORE_ADDR highpc,
       cu->last_fn->next = thisfn;
 
   cu->last_fn = thisfn;
+  /* APPLE LOCAL line table decoding  */
+  cu->sorted_fns = NULL;
 }
 
 /* APPLE LOCAL begin subroutine inlining  */
@@ -5384,6 +7131,194 @@ read_inlined_subroutine_scope (struct die_info *die, struct dwarf2_cu *cu)
 }
 /* APPLE LOCAL end subroutine inlining  */
 
+/* APPLE LOCAL begin lazy function symbols  */
+/* What dwarf2_expand_lazy_scope needs to find the DIE of a function
+   or lexical block whose local symbols were deferred.  */
+
+struct dwarf2_lazy_scope
+{
+  struct objfile *objfile;
+  struct dwarf2_per_cu_data *per_cu;
+
+  /* The offset of the DW_TAG_subprogram or DW_TAG_lexical_block DIE.  */
+  unsigned int offset;
+
+  /* Non-zero for the outermost block of a function, whose dictionary
+     must keep the parameters in order.  */
+  int is_function;
+};
+
+/* The global state dwarf2_expand_lazy_scope changes, saved so that it
+   can be put back even if reading the symbols errors out.  */
+
+struct dwarf2_lazy_scope_state
+{
+  struct dwarf2_per_objfile *per_objfile;
+  const char *prefix;
+  struct pending *symbols;
+};
+
+/* Return non-zero if the local symbols of the scope described by DIE
+   - a function or a lexical block - can be left for
+   dwarf2_expand_lazy_scope to read.  That is only done when the
+   scope's direct children are nothing but parameters, local
+   variables and nested lexical blocks (which decide for themselves),
+   and at least one of them will make a symbol: anything else may add
+   to the file's global symbols or types, which have to be complete
+   when the symtab is finished.  The .o files of a debug map and the
+   dwarf repository aren't around any more when the symbols are
+   finally needed, so their scopes are never deferred.  */
+
+static int
+dwarf2_can_defer_scope (struct die_info *die, struct dwarf2_cu *cu)
+{
+  struct die_info *child_die;
+  struct attribute *attr;
+  int has_symbols = 0;
+
+  if (!dwarf2_lazy_function_symbols
+      || cu->per_cu == NULL
+      || cu->addr_map != NULL
+      || cu->repository != NULL)
+    return 0;
+
+  for (child_die = die->child;
+       child_die != NULL && child_die->tag != 0;
+       child_die = sibling_die (child_die))
+    switch (child_die->tag)
+      {
+      case DW_TAG_variable:
+	attr = dwarf2_attr (child_die, DW_AT_external, cu);
+	if (attr && DW_UNSND (attr) != 0)
+	  return 0;
+	/* Fall through.  */
+      case DW_TAG_formal_parameter:
+	if (dwarf2_linkage_name (child_die, cu) != NULL)
+	  has_symbols = 1;
+	break;
+      case DW_TAG_unspecified_parameters:
+      case DW_TAG_lexical_block:
+      case DW_TAG_try_block:
+      case DW_TAG_catch_block:
+	break;
+      default:
+	return 0;
+      }
+
+  return has_symbols;
+}
+
+/* Return non-zero if a child DIE with tag TAG of a deferred scope is
+   left for dwarf2_expand_lazy_scope.  */
+
+static int
+dwarf2_deferred_tag_p (enum dwarf_tag tag)
+{
+  return (tag == DW_TAG_variable
+	  || tag == DW_TAG_formal_parameter
+	  || tag == DW_TAG_unspecified_parameters);
+}
+
+/* Return a lazy dictionary for the block of the scope DIE in CU,
+   whose local symbols dwarf2_can_defer_scope said can wait.
+   IS_FUNCTION is non-zero for the outermost block of a function.  */
+
+static struct dictionary *
+dwarf2_lazy_scope_dict (struct die_info *die, int is_function,
+			struct dwarf2_cu *cu)
+{
+  struct dwarf2_lazy_scope *scope;
+
+  scope = obstack_alloc (&cu->objfile->objfile_obstack, sizeof (*scope));
+  scope->objfile = cu->objfile;
+  scope->per_cu = cu->per_cu;
+  scope->offset = die->offset;
+  scope->is_function = is_function;
+
+  return dict_create_lazy (&cu->objfile->objfile_obstack,
+			   dwarf2_expand_lazy_scope, scope);
+}
+
+static void
+restore_lazy_scope_state (void *arg)
+{
+  struct dwarf2_lazy_scope_state *state = arg;
+
+  dwarf2_per_objfile = state->per_objfile;
+  processing_current_prefix = state->prefix;
+  add_free_pendings (state->symbols);
+  state->symbols = NULL;
+}
+
+/* The expand function of the lazy dictionaries made by
+   dwarf2_lazy_scope_dict.  Bring the scope's compilation unit back
+   into the cache if it has been flushed, make symbols for the
+   scope's parameters and local variables, just as process_die would
+   have, and return them as a dictionary.  */
+
+static struct dictionary *
+dwarf2_expand_lazy_scope (void *data)
+{
+  struct dwarf2_lazy_scope *scope = data;
+  struct objfile *objfile = scope->objfile;
+  struct dwarf2_lazy_scope_state state;
+  struct cleanup *back_to;
+  struct dwarf2_cu *cu;
+  struct die_info *die, *child_die;
+  struct dictionary *dict;
+
+  state.per_objfile = dwarf2_per_objfile;
+  state.prefix = processing_current_prefix;
+  state.symbols = NULL;
+  back_to = make_cleanup (restore_lazy_scope_state, &state);
+
+  dwarf2_per_objfile = objfile_data (objfile, dwarf2_objfile_data_key);
+  processing_current_prefix = "";
+
+  if (scope->per_cu->cu == NULL)
+    {
+      /* The queue can't be shared with a symtab expansion that is
+	 already under way.  */
+      if (dwarf2_queue != NULL)
+	error (_("Dwarf Error: can't read deferred local symbols while "
+		 "reading other symbols [in module %s]"), objfile->name);
+      make_cleanup (dwarf2_release_queue, NULL);
+      queue_comp_unit (scope->per_cu);
+      process_queue (objfile);
+    }
+  /* APPLE LOCAL dwarf2 cache limit  */
+  else
+    dwarf2_cache_stats.hits++;
+  cu = scope->per_cu->cu;
+  cu->last_used = 0;
+
+  die = find_die_in_ref_table (scope->offset, cu);
+  if (die == NULL)
+    error (_("Dwarf Error: Cannot find DIE at 0x%lx [in module %s]"),
+	   (long) scope->offset, objfile->name);
+
+  dwarf2_find_base_address (cu);
+  cu->list_in_scope = &state.symbols;
+
+  for (child_die = die->child;
+       child_die != NULL && child_die->tag != 0;
+       child_die = sibling_die (child_die))
+    if (dwarf2_deferred_tag_p (child_die->tag))
+      process_die (child_die, cu);
+
+  if (scope->is_function)
+    dict = dict_create_linear (&objfile->objfile_obstack, state.symbols);
+  else
+    dict = dict_create_hashed (&objfile->objfile_obstack, state.symbols);
+
+  do_cleanups (back_to);
+
+  age_cached_comp_units ();
+
+  return dict;
+}
+/* APPLE LOCAL end lazy function symbols  */
+
 static void
 read_func_scope (struct die_info *die, struct dwarf2_cu *cu)
 {
@@ -5400,6 +7335,10 @@ read_func_scope (struct die_info *die, struct dwarf2_cu *cu)
   /* APPLE LOCAL begin address ranges  */
   struct address_range_list *ranges = NULL;
   /* APPLE LOCAL end address ranges  */
+  /* APPLE LOCAL begin lazy function symbols  */
+  struct block *block;
+  int lazy;
+  /* APPLE LOCAL end lazy function symbols  */
 
   baseaddr = objfile_text_section_offset (objfile);
 
@@ -5487,12 +7426,17 @@ read_func_scope (struct die_info *die, struct dwarf2_cu *cu)
 
   cu->list_in_scope = &local_symbols;
 
+  /* APPLE LOCAL lazy function symbols  */
+  lazy = dwarf2_can_defer_scope (die, cu);
+
   if (die->child != NULL)
     {
       child_die = die->child;
       while (child_die && child_die->tag)
 	{
-	  process_die (child_die, cu);
+	  /* APPLE LOCAL lazy function symbols  */
+	  if (!lazy || !dwarf2_deferred_tag_p (child_die->tag))
+	    process_die (child_die, cu);
 	  child_die = sibling_die (child_die);
 	}
     }
@@ -5500,9 +7444,14 @@ read_func_scope (struct die_info *die, struct dwarf2_cu *cu)
   new = pop_context ();
   /* Make a block for the local symbols within.  */
   /* APPLE LOCAL begin address ranges  */
-  finish_block (new->name, &local_symbols, new->old_blocks,
-		lowpc, highpc, ranges, objfile);
+  block = finish_block (new->name, &local_symbols, new->old_blocks,
+			lowpc, highpc, ranges, objfile);
   /* APPLE LOCAL end address ranges  */
+
+  /* APPLE LOCAL begin lazy function symbols  */
+  if (lazy)
+    BLOCK_DICT (block) = dwarf2_lazy_scope_dict (die, 1, cu);
+  /* APPLE LOCAL end lazy function symbols  */
   
   /* In C++, we can have functions nested inside functions (e.g., when
      a function declares a class that has methods).  This means that
@@ -5535,6 +7484,10 @@ read_lexical_block_scope (struct die_info *die, struct dwarf2_cu *cu)
   /* APPLE LOCAL begin address ranges  */
   struct address_range_list *ranges = NULL;
   /* APPLE LOCAL end address ranges  */
+  /* APPLE LOCAL begin lazy function symbols  */
+  struct block *block;
+  int lazy;
+  /* APPLE LOCAL end lazy function symbols  */
 
   baseaddr = objfile_text_section_offset (objfile);
 
@@ -5560,24 +7513,35 @@ read_lexical_block_scope (struct die_info *die, struct dwarf2_cu *cu)
     }
   /* APPLE LOCAL end address ranges  */
 
+  /* APPLE LOCAL lazy function symbols  */
+  lazy = dwarf2_can_defer_scope (die, cu);
+
   push_context (0, lowpc);
   if (die->child != NULL)
     {
       child_die = die->child;
       while (child_die && child_die->tag)
 	{
-	  process_die (child_die, cu);
+	  /* APPLE LOCAL lazy function symbols  */
+	  if (!lazy || !dwarf2_deferred_tag_p (child_die->tag))
+	    process_die (child_die, cu);
 	  child_die = sibling_die (child_die);
 	}
     }
   new = pop_context ();
 
-  if (local_symbols != NULL)
+  /* APPLE LOCAL lazy function symbols: A deferred block has symbols
+     even though none have been made yet.  */
+  if (local_symbols != NULL || lazy)
     {
       /* APPLE LOCAL begin address ranges  */
-      finish_block (0, &local_symbols, new->old_blocks, new->start_addr,
-		    highpc, ranges, objfile);
+      block = finish_block (0, &local_symbols, new->old_blocks,
+			    new->start_addr, highpc, ranges, objfile);
       /* APPLE LOCAL end address ranges  */
+
+      /* APPLE LOCAL lazy function symbols  */
+      if (lazy)
+	BLOCK_DICT (block) = dwarf2_lazy_scope_dict (die, 0, cu);
     }
   local_symbols = new->locals;
 }
@@ -6258,59 +8222,284 @@ dwarf2_add_member_fn (struct field_info *fip, struct die_info *die,
    }
 }
 
-/* Create the vector of member function fields, and attach it to the type.  */
+/* Create the vector of member function fields, and attach it to the type.  */
+
+static void
+dwarf2_attach_fn_fields_to_type (struct field_info *fip, struct type *type,
+				 struct dwarf2_cu *cu)
+{
+  struct fnfieldlist *flp;
+  int total_length = 0;
+  int i;
+
+  ALLOCATE_CPLUS_STRUCT_TYPE (type);
+  TYPE_FN_FIELDLISTS (type) = (struct fn_fieldlist *)
+    TYPE_ALLOC (type, sizeof (struct fn_fieldlist) * fip->nfnfields);
+
+  for (i = 0, flp = fip->fnfieldlists; i < fip->nfnfields; i++, flp++)
+    {
+      struct nextfnfield *nfp = flp->head;
+      struct fn_fieldlist *fn_flp = &TYPE_FN_FIELDLIST (type, i);
+      int k;
+
+      TYPE_FN_FIELDLIST_NAME (type, i) = flp->name;
+      TYPE_FN_FIELDLIST_LENGTH (type, i) = flp->length;
+      fn_flp->fn_fields = (struct fn_field *)
+	TYPE_ALLOC (type, sizeof (struct fn_field) * flp->length);
+      for (k = flp->length; (k--, nfp); nfp = nfp->next)
+	fn_flp->fn_fields[k] = nfp->fnfield;
+
+      total_length += flp->length;
+    }
+
+  TYPE_NFN_FIELDS (type) = fip->nfnfields;
+  TYPE_NFN_FIELDS_TOTAL (type) = total_length;
+}
+
+
+/* Returns non-zero if NAME is the name of a vtable member in CU's
+   language, zero otherwise.  */
+static int
+is_vtable_name (const char *name, struct dwarf2_cu *cu)
+{
+  static const char vptr[] = "_vptr";
+  static const char vtable[] = "vtable";
+
+  /* Look for the C++ and Java forms of the vtable.  */
+  if ((cu->language == language_java
+       && strncmp (name, vtable, sizeof (vtable) - 1) == 0)
+       || (strncmp (name, vptr, sizeof (vptr) - 1) == 0
+       && is_cplus_marker (name[sizeof (vptr) - 1])))
+    return 1;
+
+  return 0;
+}
+
+
+/* APPLE LOCAL begin dwarf2 structure sharing  */
+
+/* How many references deep dwarf2_digest_die follows from the members
+   of a structure into the types they use.  */
+
+#define DWARF2_DIGEST_REF_DEPTH 4
+
+static void
+dwarf2_digest_uint (struct md5_ctx *ctx, ULONGEST value)
+{
+  md5_process_bytes (&value, sizeof (value), ctx);
+}
+
+static void
+dwarf2_digest_string (struct md5_ctx *ctx, const char *str)
+{
+  if (str == NULL)
+    str = "";
+  md5_process_bytes (str, strlen (str) + 1, ctx);
+}
+
+/* Add DIE to the digest in CTX: its tag and attributes and, if
+   CHILDREN is non-zero or DIE has no name, its children.  A reference
+   to another DIE adds that DIE in turn, DEPTH more levels at most, so
+   that two members are only the same if their types look the same.
+   The DIE's source position is left out; it is what differs between
+   two copies of a header.  Return zero if DIE has something we can't
+   compare, such as a reference into another compilation unit, in
+   which case the digest is useless.  */
+
+static int
+dwarf2_digest_die (struct md5_ctx *ctx, struct die_info *die,
+		   struct dwarf2_cu *cu, int depth, int children)
+{
+  struct die_info *child_die;
+  unsigned int i;
+
+  dwarf2_digest_uint (ctx, die->tag);
+
+  for (i = 0; i < die->num_attrs; i++)
+    {
+      struct attribute *attr = &die->attrs[i];
+
+      if (attr->name == DW_AT_decl_file
+	  || attr->name == DW_AT_decl_line
+	  || attr->name == DW_AT_decl_column
+	  || attr->name == DW_AT_sibling)
+	continue;
+
+      dwarf2_digest_uint (ctx, attr->name);
+      dwarf2_digest_uint (ctx, attr->form);
+      switch (attr->form)
+	{
+	case DW_FORM_string:
+	case DW_FORM_strp:
+	  dwarf2_digest_string (ctx, DW_STRING (attr));
+	  break;
+	case DW_FORM_data1:
+	case DW_FORM_data2:
+	case DW_FORM_data4:
+	case DW_FORM_data8:
+	case DW_FORM_udata:
+	case DW_FORM_flag:
+	case DW_FORM_flag_present:
+	  dwarf2_digest_uint (ctx, DW_UNSND (attr));
+	  break;
+	case DW_FORM_sdata:
+	  dwarf2_digest_uint (ctx, (ULONGEST) DW_SND (attr));
+	  break;
+	case DW_FORM_addr:
+	  dwarf2_digest_uint (ctx, DW_ADDR (attr));
+	  break;
+	case DW_FORM_block:
+	case DW_FORM_block1:
+	case DW_FORM_block2:
+	case DW_FORM_block4:
+	  dwarf2_digest_uint (ctx, DW_BLOCK (attr)->size);
+	  md5_process_bytes (DW_BLOCK (attr)->data, DW_BLOCK (attr)->size,
+			     ctx);
+	  break;
+	case DW_FORM_ref1:
+	case DW_FORM_ref2:
+	case DW_FORM_ref4:
+	case DW_FORM_ref8:
+	case DW_FORM_ref_udata:
+	  if (depth == 0)
+	    dwarf2_digest_uint (ctx, follow_die_ref (die, attr, cu)->tag);
+	  else if (!dwarf2_digest_die (ctx, follow_die_ref (die, attr, cu),
+				       cu, depth - 1, 0))
+	    return 0;
+	  break;
+	default:
+	  return 0;
+	}
+    }
+  dwarf2_digest_uint (ctx, 0);
+
+  if (!children && depth > 0 && dwarf2_attr (die, DW_AT_name, cu) == NULL)
+    {
+      children = 1;
+      depth--;
+    }
+  if (children)
+    for (child_die = die->child;
+	 child_die != NULL && child_die->tag;
+	 child_die = sibling_die (child_die))
+      if (!dwarf2_digest_die (ctx, child_die, cu, depth, children))
+	return 0;
+  dwarf2_digest_uint (ctx, 0);
+
+  return 1;
+}
+
+/* If the structure type at DIE may share its type with an identical
+   definition read from another compilation unit, store the digest
+   that identifies it in DIGEST and return non-zero.  Only complete,
+   named types are shared; they are the ones repeated by headers.  */
 
-static void
-dwarf2_attach_fn_fields_to_type (struct field_info *fip, struct type *type,
-				 struct dwarf2_cu *cu)
+static int
+dwarf2_structure_digest (struct die_info *die, struct dwarf2_cu *cu,
+			 md5_uint32 *digest)
 {
-  struct fnfieldlist *flp;
-  int total_length = 0;
-  int i;
+  struct md5_ctx ctx;
+  struct attribute *attr;
+  int ok;
 
-  ALLOCATE_CPLUS_STRUCT_TYPE (type);
-  TYPE_FN_FIELDLISTS (type) = (struct fn_fieldlist *)
-    TYPE_ALLOC (type, sizeof (struct fn_fieldlist) * fip->nfnfields);
+  if (!dwarf2_share_structure_types
+      || cu->repository != NULL
+      || die->child == NULL
+      || die_is_declaration (die, cu)
+      || dwarf2_attr (die, DW_AT_byte_size, cu) == NULL)
+    return 0;
+  attr = dwarf2_attr (die, DW_AT_name, cu);
+  if (attr == NULL || DW_STRING (attr) == NULL)
+    return 0;
 
-  for (i = 0, flp = fip->fnfieldlists; i < fip->nfnfields; i++, flp++)
-    {
-      struct nextfnfield *nfp = flp->head;
-      struct fn_fieldlist *fn_flp = &TYPE_FN_FIELDLIST (type, i);
-      int k;
+  md5_init_ctx (&ctx);
+  dwarf2_digest_uint (&ctx, cu->language);
+  dwarf2_digest_uint (&ctx, cu->header.addr_size);
 
-      TYPE_FN_FIELDLIST_NAME (type, i) = flp->name;
-      TYPE_FN_FIELDLIST_LENGTH (type, i) = flp->length;
-      fn_flp->fn_fields = (struct fn_field *)
-	TYPE_ALLOC (type, sizeof (struct fn_field) * flp->length);
-      for (k = flp->length; (k--, nfp); nfp = nfp->next)
-	fn_flp->fn_fields[k] = nfp->fnfield;
+  /* Two classes of the same name in different namespaces can have
+     the same DIEs; the qualified name tells them apart.  */
+  if (cu->language == language_cplus
+      || cu->language == language_objcplus
+      || cu->language == language_java)
+    {
+      const char *previous_prefix = processing_current_prefix;
+      char *name = determine_class_name (die, cu);
 
-      total_length += flp->length;
+      processing_current_prefix = previous_prefix;
+      dwarf2_digest_string (&ctx, name);
+      xfree (name);
     }
 
-  TYPE_NFN_FIELDS (type) = fip->nfnfields;
-  TYPE_NFN_FIELDS_TOTAL (type) = total_length;
+  ok = dwarf2_digest_die (&ctx, die, cu, DWARF2_DIGEST_REF_DEPTH, 1);
+  md5_finish_ctx (&ctx, digest);
+  return ok;
 }
 
+static hashval_t
+dwarf2_shared_structure_hash (const void *item)
+{
+  const struct dwarf2_shared_structure *entry = item;
+
+  return entry->digest[0];
+}
 
-/* Returns non-zero if NAME is the name of a vtable member in CU's
-   language, zero otherwise.  */
 static int
-is_vtable_name (const char *name, struct dwarf2_cu *cu)
+dwarf2_shared_structure_eq (const void *item, const void *digest)
 {
-  static const char vptr[] = "_vptr";
-  static const char vtable[] = "vtable";
+  const struct dwarf2_shared_structure *entry = item;
 
-  /* Look for the C++ and Java forms of the vtable.  */
-  if ((cu->language == language_java
-       && strncmp (name, vtable, sizeof (vtable) - 1) == 0)
-       || (strncmp (name, vptr, sizeof (vptr) - 1) == 0
-       && is_cplus_marker (name[sizeof (vptr) - 1])))
-    return 1;
+  return memcmp (entry->digest, digest, sizeof (entry->digest)) == 0;
+}
 
-  return 0;
+static void
+dwarf2_free_shared_structures (struct objfile *objfile, void *arg)
+{
+  htab_delete (arg);
+}
+
+/* Return the type already read from OBJFILE for a structure with
+   DIGEST, or NULL.  */
+
+static struct type *
+dwarf2_lookup_shared_structure (struct objfile *objfile, md5_uint32 *digest)
+{
+  htab_t table = objfile_data (objfile, dwarf2_shared_structures_key);
+  struct dwarf2_shared_structure *entry;
+
+  if (table == NULL)
+    return NULL;
+  entry = htab_find_with_hash (table, digest, digest[0]);
+  return entry != NULL ? entry->type : NULL;
 }
 
+/* Remember TYPE as OBJFILE's type for structures with DIGEST.  */
+
+static void
+dwarf2_record_shared_structure (struct objfile *objfile, md5_uint32 *digest,
+				struct type *type)
+{
+  htab_t table = objfile_data (objfile, dwarf2_shared_structures_key);
+  struct dwarf2_shared_structure *entry;
+  void **slot;
+
+  if (table == NULL)
+    {
+      table = htab_create_alloc (64, dwarf2_shared_structure_hash,
+				 dwarf2_shared_structure_eq,
+				 NULL, xcalloc, xfree);
+      set_objfile_data (objfile, dwarf2_shared_structures_key, table);
+    }
+
+  slot = htab_find_slot_with_hash (table, digest, digest[0], INSERT);
+  if (*slot != NULL)
+    return;
+  entry = obstack_alloc (&objfile->objfile_obstack,
+			 sizeof (struct dwarf2_shared_structure));
+  memcpy (entry->digest, digest, sizeof (entry->digest));
+  entry->type = type;
+  *slot = entry;
+}
+/* APPLE LOCAL end dwarf2 structure sharing  */
 
 /* Called when we find the DIE that starts a structure or union scope
    (definition) to process all dies that define the members of the
@@ -6336,10 +8525,27 @@ read_structure_type (struct die_info *die, struct dwarf2_cu *cu)
   struct attribute *attr;
   const char *previous_prefix = processing_current_prefix;
   struct cleanup *back_to = NULL;
+  /* APPLE LOCAL begin dwarf2 structure sharing  */
+  md5_uint32 digest[4];
+  int shareable;
+  /* APPLE LOCAL end dwarf2 structure sharing  */
 
   if (die->type)
     return;
 
+  /* APPLE LOCAL begin dwarf2 structure sharing  */
+  shareable = dwarf2_structure_digest (die, cu, digest);
+  if (shareable)
+    {
+      type = dwarf2_lookup_shared_structure (objfile, digest);
+      if (type != NULL)
+	{
+	  set_die_type (die, type, cu);
+	  return;
+	}
+    }
+  /* APPLE LOCAL end dwarf2 structure sharing  */
+
   type = alloc_type (objfile);
 
   INIT_CPLUS_SPECIFIC (type);
@@ -6579,6 +8785,10 @@ read_structure_type (struct die_info *die, struct dwarf2_cu *cu)
   attr = dwarf2_attr (die, DW_AT_APPLE_block, cu);
   if (attr)
     TYPE_FLAGS (type) |= TYPE_FLAG_APPLE_CLOSURE;
+
+  /* APPLE LOCAL dwarf2 structure sharing  */
+  if (shareable)
+    dwarf2_record_shared_structure (objfile, digest, type);
   
   processing_current_prefix = previous_prefix;
   if (back_to != NULL)
@@ -7659,141 +9869,601 @@ read_subrange_type (struct die_info *die, struct dwarf2_cu *cu)
   if (attr)
     TYPE_LENGTH_ASSIGN (range_type) = DW_UNSND (attr);
 
-  set_die_type (die, range_type, cu);
-}
-  
+  set_die_type (die, range_type, cu);
+}
+  
+
+/* Read a whole compilation unit into a linked list of dies.  */
+
+static struct die_info *
+read_comp_unit (char *info_ptr, bfd *abfd, struct dwarf2_cu *cu)
+{
+  return read_die_and_children (info_ptr, abfd, cu, &info_ptr, NULL);
+}
+
+/* Read a single die and all its descendents.  Set the die's sibling
+   field to NULL; set other fields in the die correctly, and set all
+   of the descendents' fields correctly.  Set *NEW_INFO_PTR to the
+   location of the info_ptr after reading all of those dies.  PARENT
+   is the parent of the die in question.  */
+
+static struct die_info *
+read_die_and_children (char *info_ptr, bfd *abfd,
+		       struct dwarf2_cu *cu,
+		       char **new_info_ptr,
+		       struct die_info *parent)
+{
+  struct die_info *die;
+  char *cur_ptr;
+  int has_children;
+
+  cur_ptr = read_full_die (&die, abfd, info_ptr, cu, &has_children);
+  store_in_ref_table (die->offset, die, cu);
+
+  if (has_children)
+    {
+      die->child = read_die_and_siblings (cur_ptr, abfd, cu,
+					  new_info_ptr, die);
+    }
+  else
+    {
+      die->child = NULL;
+      *new_info_ptr = cur_ptr;
+    }
+
+  die->sibling = NULL;
+  die->parent = parent;
+  return die;
+}
+
+/* Read a die, all of its descendents, and all of its siblings; set
+   all of the fields of all of the dies correctly.  Arguments are as
+   in read_die_and_children.  */
+
+static struct die_info *
+read_die_and_siblings (char *info_ptr, bfd *abfd,
+		       struct dwarf2_cu *cu,
+		       char **new_info_ptr,
+		       struct die_info *parent)
+{
+  struct die_info *first_die, *last_sibling;
+  char *cur_ptr;
+
+  cur_ptr = info_ptr;
+  first_die = last_sibling = NULL;
+
+  while (1)
+    {
+      struct die_info *die
+	= read_die_and_children (cur_ptr, abfd, cu, &cur_ptr, parent);
+
+      if (!first_die)
+	{
+	  first_die = die;
+	}
+      else
+	{
+	  last_sibling->sibling = die;
+	}
+
+      if (die->tag == 0)
+	{
+	  *new_info_ptr = cur_ptr;
+	  return first_die;
+	}
+      else
+	{
+	  last_sibling = die;
+	}
+    }
+}
+
+/* APPLE LOCAL begin packed dies  */
+/* Set up the storage for CU's full DIEs.  */
+
+static void
+init_die_storage (struct dwarf2_cu *cu)
+{
+  obstack_specify_allocation (&cu->die_obstack, DIE_OBSTACK_CHUNK_SIZE, 0,
+			      xmalloc, xfree);
+  obstack_specify_allocation (&cu->die_attr_obstack, DIE_OBSTACK_CHUNK_SIZE,
+			      0, xmalloc, xfree);
+
+  /* A DIE takes up at least a few bytes of .debug_info; start from a
+     guess based on the size of the compilation unit and let
+     store_in_ref_table grow the index from there.  */
+  cu->die_index_size = cu->header.length / 16 + 16;
+  cu->die_index = XCALLOC (cu->die_index_size, struct die_info *);
+  cu->n_dies = 0;
+  cu->has_die_storage = 1;
+}
+
+/* Release CU's full DIEs, all at once.  */
+
+static void
+free_die_storage (struct dwarf2_cu *cu)
+{
+  if (!cu->has_die_storage)
+    return;
+
+  obstack_free (&cu->die_obstack, NULL);
+  obstack_free (&cu->die_attr_obstack, NULL);
+  xfree (cu->die_index);
+  cu->die_index = NULL;
+  cu->n_dies = cu->die_index_size = 0;
+  cu->dies = NULL;
+  cu->has_die_storage = 0;
+}
+/* APPLE LOCAL end packed dies  */
+
+/* Read the contents of the section at OFFSET and of size SIZE from the
+   object file specified by OBJFILE into the objfile_obstack and return it.  */
+
+/* APPLE LOCAL debug map: New argument ABFD */
+
+char *
+dwarf2_read_section (struct objfile *objfile, bfd *abfd, asection *sectp)
+{
+  char *buf, *retbuf;
+  bfd_size_type size = bfd_get_section_size (sectp);
+  /* APPLE LOCAL compressed debug sections  */
+  unsigned int chunk_size;
+
+  if (size == 0)
+    return NULL;
+
+  /* APPLE LOCAL begin compressed debug sections  */
+  if (dwarf2_section_compression (abfd, sectp, &size, &chunk_size)
+      != dwarf2_section_plain)
+    return dwarf2_read_compressed_section (objfile, abfd, sectp, NULL);
+  /* APPLE LOCAL end compressed debug sections  */
+
+  /* APPLE LOCAL mmap dwarf sections  */
+#ifdef HAVE_MMAP
+  buf = dwarf2_map_section (objfile, abfd, sectp);
+  if (buf != NULL)
+    return buf;
+#endif
+
+  buf = (char *) obstack_alloc (&objfile->objfile_obstack, size);
+  retbuf
+    = (char *) symfile_relocate_debug_section (abfd, sectp, (bfd_byte *) buf);
+  if (retbuf != NULL)
+    return retbuf;
+
+  if (bfd_seek (abfd, sectp->filepos, SEEK_SET) != 0
+      || bfd_bread (buf, size, abfd) != size)
+    error (_("Dwarf Error: Can't read DWARF data from '%s'"),
+	   bfd_get_filename (abfd));
+
+  return buf;
+}
+
+/* APPLE LOCAL begin mmap dwarf sections  */
+#ifdef HAVE_MMAP
+/* Map SECTP of ABFD into memory for OBJFILE and return its contents,
+   or return NULL if the section has to be read in the ordinary way.
+   Only OBJFILE's own bfd is mapped: it stays open as long as OBJFILE
+   does, whereas the .o files of a debug map are closed as soon as
+   their DWARF has been read, and symbols keep pointing into the
+   section contents.  Sections with relocations need to be fixed up
+   in a private copy, so they are not mapped either.
+
+   The window is mapped private and writable, since a few places
+   (e.g. the psymbol equivalence code) patch strings in place; those
+   pages are copied on write, the file itself is never modified.  */
+
+static char *
+dwarf2_map_section (struct objfile *objfile, bfd *abfd, asection *sectp)
+{
+  struct dwarf2_section_window *win;
+
+  if (!dwarf2_mmap_sections
+      || abfd != objfile->obfd
+      || (bfd_get_section_flags (abfd, sectp) & SEC_RELOC) != 0)
+    return NULL;
+
+  win = XMALLOC (struct dwarf2_section_window);
+  bfd_init_window (&win->window);
+  if (!bfd_get_section_contents_in_window_with_mode
+	 (abfd, sectp, &win->window, 0, bfd_get_section_size (sectp), 1))
+    {
+      bfd_free_window (&win->window);
+      xfree (win);
+      return NULL;
+    }
+
+  win->next = objfile_data (objfile, dwarf2_section_windows_key);
+  set_objfile_data (objfile, dwarf2_section_windows_key, win);
+  return (char *) win->window.data;
+}
+
+/* Release the section windows mapped for OBJFILE.  This is the cleanup
+   for dwarf2_section_windows_key, run when OBJFILE is freed.  */
+
+static void
+dwarf2_free_section_windows (struct objfile *objfile, void *arg)
+{
+  struct dwarf2_section_window *win = arg;
+
+  while (win != NULL)
+    {
+      struct dwarf2_section_window *next = win->next;
+
+      bfd_free_window (&win->window);
+      xfree (win);
+      win = next;
+    }
+}
+#endif /* HAVE_MMAP */
+/* APPLE LOCAL end mmap dwarf sections  */
+
+/* APPLE LOCAL begin compressed debug sections  */
+/* Compressed debug sections.
+
+   A debug section may be stored compressed with zlib, in one of two
+   forms, told apart by the first four bytes of its contents:
+
+   "ZLIB", then the uncompressed size as 8 big-endian bytes, then one
+   zlib stream - the format of GNU's .zdebug sections.  This has to be
+   decompressed all at once.
+
+   "ZCHK", then the uncompressed size as 8 big-endian bytes and the
+   chunk size as 4 big-endian bytes, then N + 1 offsets of 8
+   big-endian bytes each, where N is the number of chunks needed to
+   cover the uncompressed size.  Offset I is where chunk I's zlib
+   stream starts, relative to the start of the section; offset N is
+   the end of the last one.  Every chunk but the last decompresses to
+   exactly the chunk size.
+
+   A chunked .debug_info of the objfile's own bfd is decompressed on
+   demand: dwarf2_ensure_info is called with the range of a
+   compilation unit before it is read, and only the chunks that cover
+   it are inflated.  The buffer for the whole section is allocated up
+   front, but its pages aren't touched until a chunk lands on them.
+   Every other compressed section, and a .debug_info that has to be
+   walked from end to end to build psymtabs, is decompressed whole.  */
+
+#define DWARF2_ZLIB_HEADER_SIZE 12
+#define DWARF2_ZCHK_HEADER_SIZE 16
+
+struct dwarf2_compressed_section
+{
+  bfd *abfd;
+  asection *sectp;
+
+  /* The uncompressed contents, SIZE bytes, of which the chunks marked
+     in CHUNK_DONE have been filled in.  */
+  char *buffer;
+  bfd_size_type size;
+
+  unsigned int chunk_size;
+  unsigned int n_chunks;
+
+  /* N_CHUNKS + 1 offsets of the chunks' zlib streams in the
+     section.  */
+  ULONGEST *chunk_offsets;
+  unsigned char *chunk_done;
+  unsigned int n_done;
+
+  struct dwarf2_compressed_section *next;
+};
+
+/* The compressed sections of an objfile whose buffers have to be
+   freed along with it.  */
+
+static const struct objfile_data *dwarf2_compressed_sections_key;
 
-/* Read a whole compilation unit into a linked list of dies.  */
+/* "maint set dwarf2 decompress-on-demand".  */
 
-static struct die_info *
-read_comp_unit (char *info_ptr, bfd *abfd, struct dwarf2_cu *cu)
+static int dwarf2_decompress_on_demand = 1;
+
+static void
+show_dwarf2_decompress_on_demand (struct ui_file *file, int from_tty,
+				  struct cmd_list_element *c,
+				  const char *value)
 {
-  return read_die_and_children (info_ptr, abfd, cu, &info_ptr, NULL);
+  fprintf_filtered (file, _("\
+Decompressing chunked .debug_info sections one compilation unit at a time is %s.\n"),
+		    value);
 }
 
-/* Read a single die and all its descendents.  Set the die's sibling
-   field to NULL; set other fields in the die correctly, and set all
-   of the descendents' fields correctly.  Set *NEW_INFO_PTR to the
-   location of the info_ptr after reading all of those dies.  PARENT
-   is the parent of the die in question.  */
+static ULONGEST
+dwarf2_read_be (const gdb_byte *p, int len)
+{
+  ULONGEST val = 0;
+  int i;
 
-static struct die_info *
-read_die_and_children (char *info_ptr, bfd *abfd,
-		       struct dwarf2_cu *cu,
-		       char **new_info_ptr,
-		       struct die_info *parent)
+  for (i = 0; i < len; i++)
+    val = (val << 8) | p[i];
+  return val;
+}
+
+/* Work out whether SECTP of ABFD is compressed.  If it is, store its
+   uncompressed size in *SIZE and, for a chunked section, the chunk
+   size in *CHUNK_SIZE.  */
+
+static enum dwarf2_section_compression
+dwarf2_section_compression (bfd *abfd, asection *sectp, bfd_size_type *size,
+			    unsigned int *chunk_size)
 {
-  struct die_info *die;
-  char *cur_ptr;
-  int has_children;
+  gdb_byte header[DWARF2_ZCHK_HEADER_SIZE];
+  bfd_size_type raw_size = bfd_get_section_size (sectp);
 
-  cur_ptr = read_full_die (&die, abfd, info_ptr, cu, &has_children);
-  store_in_ref_table (die->offset, die, cu);
+  if (raw_size < DWARF2_ZLIB_HEADER_SIZE
+      || (bfd_get_section_flags (abfd, sectp) & SEC_HAS_CONTENTS) == 0
+      || !bfd_get_section_contents (abfd, sectp, header, 0,
+				    DWARF2_ZLIB_HEADER_SIZE))
+    return dwarf2_section_plain;
 
-  if (has_children)
+  if (memcmp (header, "ZLIB", 4) == 0)
     {
-      die->child = read_die_and_siblings (cur_ptr, abfd, cu,
-					  new_info_ptr, die);
+      *size = dwarf2_read_be (header + 4, 8);
+      return dwarf2_section_zlib;
     }
-  else
+
+  if (memcmp (header, "ZCHK", 4) == 0
+      && raw_size >= DWARF2_ZCHK_HEADER_SIZE
+      && bfd_get_section_contents (abfd, sectp, header, 0,
+				   DWARF2_ZCHK_HEADER_SIZE))
     {
-      die->child = NULL;
-      *new_info_ptr = cur_ptr;
+      *size = dwarf2_read_be (header + 4, 8);
+      *chunk_size = dwarf2_read_be (header + 12, 4);
+      if (*chunk_size != 0)
+	return dwarf2_section_chunked;
     }
 
-  die->sibling = NULL;
-  die->parent = parent;
-  return die;
+  return dwarf2_section_plain;
 }
 
-/* Read a die, all of its descendents, and all of its siblings; set
-   all of the fields of all of the dies correctly.  Arguments are as
-   in read_die_and_children.  */
+/* The size of SECTP's contents once decompressed.  */
 
-static struct die_info *
-read_die_and_siblings (char *info_ptr, bfd *abfd,
-		       struct dwarf2_cu *cu,
-		       char **new_info_ptr,
-		       struct die_info *parent)
+bfd_size_type
+dwarf2_section_size (bfd *abfd, asection *sectp)
 {
-  struct die_info *first_die, *last_sibling;
-  char *cur_ptr;
+  bfd_size_type size;
+  unsigned int chunk_size;
 
-  cur_ptr = info_ptr;
-  first_die = last_sibling = NULL;
+  if (dwarf2_section_compression (abfd, sectp, &size, &chunk_size)
+      == dwarf2_section_plain)
+    return bfd_get_section_size (sectp);
+  return size;
+}
 
-  while (1)
-    {
-      struct die_info *die
-	= read_die_and_children (cur_ptr, abfd, cu, &cur_ptr, parent);
+/* Inflate the IN_SIZE bytes of zlib data at IN into exactly OUT_SIZE
+   bytes at OUT.  Return nonzero on success.  */
 
-      if (!first_die)
-	{
-	  first_die = die;
-	}
-      else
-	{
-	  last_sibling->sibling = die;
-	}
+static int
+dwarf2_inflate (gdb_byte *in, bfd_size_type in_size, char *out,
+		bfd_size_type out_size)
+{
+#if defined (HAVE_ZLIB_H) && defined (HAVE_LIBZ)
+  z_stream strm;
+  int rc;
 
-      if (die->tag == 0)
-	{
-	  *new_info_ptr = cur_ptr;
-	  return first_die;
-	}
-      else
-	{
-	  last_sibling = die;
-	}
+  memset (&strm, 0, sizeof (strm));
+  if (inflateInit (&strm) != Z_OK)
+    return 0;
+  strm.next_in = in;
+  strm.avail_in = in_size;
+  strm.next_out = (Bytef *) out;
+  strm.avail_out = out_size;
+  rc = inflate (&strm, Z_FINISH);
+  inflateEnd (&strm);
+  return rc == Z_STREAM_END && strm.avail_out == 0;
+#else
+  error (_("Dwarf Error: DWARF data is compressed, but this GDB was built "
+	   "without zlib"));
+#endif
+}
+
+/* Read LEN bytes at OFFSET in Z's section into a buffer allocated
+   with xmalloc.  */
+
+static gdb_byte *
+dwarf2_read_compressed_bytes (struct dwarf2_compressed_section *z,
+			      ULONGEST offset, bfd_size_type len)
+{
+  gdb_byte *buf = xmalloc (len > 0 ? len : 1);
+
+  if (bfd_seek (z->abfd, z->sectp->filepos + offset, SEEK_SET) != 0
+      || bfd_bread (buf, len, z->abfd) != len)
+    {
+      xfree (buf);
+      error (_("Dwarf Error: Can't read DWARF data from '%s'"),
+	     bfd_get_filename (z->abfd));
     }
+  return buf;
 }
 
-/* Free a linked list of dies.  */
+/* Make sure the bytes from OFFSET to OFFSET + LENGTH of Z's
+   uncompressed contents have been filled in.  */
 
 static void
-free_die_list (struct die_info *dies)
+dwarf2_compressed_ensure (struct dwarf2_compressed_section *z,
+			  ULONGEST offset, ULONGEST length)
 {
-  struct die_info *die, *next;
+  unsigned int first, last, i;
 
-  die = dies;
-  while (die)
+  if (z->n_done == z->n_chunks || offset >= z->size || length == 0)
+    return;
+  if (length > z->size - offset)
+    length = z->size - offset;
+
+  first = offset / z->chunk_size;
+  last = (offset + length - 1) / z->chunk_size;
+  for (i = first; i <= last; i++)
     {
-      if (die->child != NULL)
-	free_die_list (die->child);
-      next = die->sibling;
-      xfree (die->attrs);
-      xfree (die);
-      die = next;
+      ULONGEST start = (ULONGEST) i * z->chunk_size;
+      bfd_size_type out_size;
+      gdb_byte *in;
+      int ok;
+
+      if (z->chunk_done[i])
+	continue;
+
+      out_size = z->size - start;
+      if (out_size > z->chunk_size)
+	out_size = z->chunk_size;
+      in = dwarf2_read_compressed_bytes (z, z->chunk_offsets[i],
+					 z->chunk_offsets[i + 1]
+					 - z->chunk_offsets[i]);
+      ok = dwarf2_inflate (in, z->chunk_offsets[i + 1] - z->chunk_offsets[i],
+			   z->buffer + start, out_size);
+      xfree (in);
+      if (!ok)
+	error (_("Dwarf Error: Can't decompress DWARF data from '%s'"),
+	       bfd_get_filename (z->abfd));
+      z->chunk_done[i] = 1;
+      z->n_done++;
     }
 }
 
-/* Read the contents of the section at OFFSET and of size SIZE from the
-   object file specified by OBJFILE into the objfile_obstack and return it.  */
-
-/* APPLE LOCAL debug map: New argument ABFD */
+/* Make sure the bytes from OFFSET to OFFSET + LENGTH of the current
+   objfile's .debug_info are there to be read.  */
 
-char *
-dwarf2_read_section (struct objfile *objfile, bfd *abfd, asection *sectp)
+static void
+dwarf2_ensure_info (ULONGEST offset, ULONGEST length)
 {
-  char *buf, *retbuf;
-  bfd_size_type size = bfd_get_section_size (sectp);
+  if (dwarf2_per_objfile->info_compressed != NULL)
+    dwarf2_compressed_ensure (dwarf2_per_objfile->info_compressed,
+			      offset, length);
+}
 
-  if (size == 0)
-    return NULL;
+/* Set up the chunked section SECTP of ABFD, whose uncompressed size is
+   SIZE, for OBJFILE.  Nothing is decompressed yet.  If it was already
+   set up by an earlier read of the same section, return that.  */
 
-  buf = (char *) obstack_alloc (&objfile->objfile_obstack, size);
-  retbuf
-    = (char *) symfile_relocate_debug_section (abfd, sectp, (bfd_byte *) buf);
-  if (retbuf != NULL)
-    return retbuf;
+static struct dwarf2_compressed_section *
+dwarf2_open_chunked_section (struct objfile *objfile, bfd *abfd,
+			     asection *sectp, bfd_size_type size,
+			     unsigned int chunk_size)
+{
+  struct dwarf2_compressed_section *z;
+  bfd_size_type raw_size = bfd_get_section_size (sectp);
+  ULONGEST n_chunks;
+  gdb_byte *table;
+  unsigned int i;
 
-  if (bfd_seek (abfd, sectp->filepos, SEEK_SET) != 0
-      || bfd_bread (buf, size, abfd) != size)
-    error (_("Dwarf Error: Can't read DWARF data from '%s'"),
+  for (z = objfile_data (objfile, dwarf2_compressed_sections_key);
+       z != NULL; z = z->next)
+    if (z->abfd == abfd && z->sectp == sectp)
+      return z;
+
+  n_chunks = (size + chunk_size - 1) / chunk_size;
+  if (n_chunks == 0
+      || (raw_size - DWARF2_ZCHK_HEADER_SIZE) / 8 < n_chunks + 1)
+    error (_("Dwarf Error: bad compressed section header in '%s'"),
 	   bfd_get_filename (abfd));
 
-  return buf;
+  z = XZALLOC (struct dwarf2_compressed_section);
+  z->abfd = abfd;
+  z->sectp = sectp;
+  z->size = size;
+  z->chunk_size = chunk_size;
+  z->n_chunks = n_chunks;
+
+  table = dwarf2_read_compressed_bytes (z, DWARF2_ZCHK_HEADER_SIZE,
+					(n_chunks + 1) * 8);
+  z->chunk_offsets = xmalloc ((n_chunks + 1) * sizeof (ULONGEST));
+  for (i = 0; i <= n_chunks; i++)
+    z->chunk_offsets[i] = dwarf2_read_be (table + 8 * i, 8);
+  xfree (table);
+
+  for (i = 0; i < n_chunks; i++)
+    if (z->chunk_offsets[i] > z->chunk_offsets[i + 1]
+	|| z->chunk_offsets[i + 1] > raw_size)
+      {
+	xfree (z->chunk_offsets);
+	xfree (z);
+	error (_("Dwarf Error: bad compressed section header in '%s'"),
+	       bfd_get_filename (abfd));
+      }
+
+  z->buffer = xmalloc (size);
+  z->chunk_done = xcalloc (n_chunks, 1);
+
+  z->next = objfile_data (objfile, dwarf2_compressed_sections_key);
+  set_objfile_data (objfile, dwarf2_compressed_sections_key, z);
+  return z;
+}
+
+/* Read the compressed section SECTP of ABFD for OBJFILE and return its
+   uncompressed contents.  If ON_DEMAND is non-NULL the section is
+   chunked and may be decompressed lazily, and it is set to the state
+   to pass to dwarf2_compressed_ensure; otherwise the whole section is
+   decompressed now.  */
+
+static char *
+dwarf2_read_compressed_section (struct objfile *objfile, bfd *abfd,
+				asection *sectp,
+				struct dwarf2_compressed_section **on_demand)
+{
+  enum dwarf2_section_compression kind;
+  struct dwarf2_compressed_section *z;
+  bfd_size_type size;
+  unsigned int chunk_size;
+
+  kind = dwarf2_section_compression (abfd, sectp, &size, &chunk_size);
+  if (on_demand != NULL)
+    *on_demand = NULL;
+
+  if (kind == dwarf2_section_zlib)
+    {
+      bfd_size_type raw_size = bfd_get_section_size (sectp);
+      char *buf = obstack_alloc (&objfile->objfile_obstack, size);
+      gdb_byte *in;
+      int ok;
+
+      in = xmalloc (raw_size);
+      if (!bfd_get_section_contents (abfd, sectp, in, 0, raw_size))
+	{
+	  xfree (in);
+	  error (_("Dwarf Error: Can't read DWARF data from '%s'"),
+		 bfd_get_filename (abfd));
+	}
+      ok = dwarf2_inflate (in + DWARF2_ZLIB_HEADER_SIZE,
+			   raw_size - DWARF2_ZLIB_HEADER_SIZE, buf, size);
+      xfree (in);
+      if (!ok)
+	error (_("Dwarf Error: Can't decompress DWARF data from '%s'"),
+	       bfd_get_filename (abfd));
+      return buf;
+    }
+
+  gdb_assert (kind == dwarf2_section_chunked);
+  z = dwarf2_open_chunked_section (objfile, abfd, sectp, size, chunk_size);
+
+  /* The bfd of a debug map's .o file is closed once its DWARF has
+     been read, so it can't be decompressed from later.  */
+  if (on_demand != NULL && dwarf2_decompress_on_demand
+      && abfd == objfile->obfd)
+    *on_demand = z;
+  else
+    dwarf2_compressed_ensure (z, 0, z->size);
+  return z->buffer;
+}
+
+/* Free the buffers of OBJFILE's compressed sections.  This is the
+   cleanup for dwarf2_compressed_sections_key.  */
+
+static void
+dwarf2_free_compressed_sections (struct objfile *objfile, void *arg)
+{
+  struct dwarf2_compressed_section *z = arg;
+
+  while (z != NULL)
+    {
+      struct dwarf2_compressed_section *next = z->next;
+
+      xfree (z->buffer);
+      xfree (z->chunk_offsets);
+      xfree (z->chunk_done);
+      xfree (z);
+      z = next;
+    }
 }
+/* APPLE LOCAL end compressed debug sections  */
 
 /* In DWARF version 2, the description of the debugging information is
    stored in a separate .debug_abbrev section.  Before we read any
@@ -7804,7 +10474,25 @@ dwarf2_read_section (struct objfile *objfile, bfd *abfd, asection *sectp)
 static void
 dwarf2_read_abbrevs (bfd *abfd, struct dwarf2_cu *cu)
 {
-  struct comp_unit_head *cu_header = &cu->header;
+  struct dwarf2_abbrev_table table;
+
+  obstack_init (&cu->abbrev_obstack);
+  dwarf2_decode_abbrevs (abfd, cu->header.abbrev_offset,
+			 &cu->abbrev_obstack, &table);
+  dwarf2_install_abbrevs (cu, &table);
+}
+
+/* APPLE LOCAL begin parallel psymtab scan  */
+/* Decode the abbreviation table starting at ABBREV_OFFSET in the
+   .debug_abbrev section into TABLE, allocating it on OBSTACK.  This
+   touches nothing but OBSTACK and TABLE - no complaints, no errors - so
+   it is safe to call from the psymtab prescan worker threads.  */
+
+static void
+dwarf2_decode_abbrevs (bfd *abfd, unsigned int abbrev_offset,
+		       struct obstack *obstack,
+		       struct dwarf2_abbrev_table *table)
+{
   char *abbrev_ptr;
   struct abbrev_info *cur_abbrev;
   unsigned int abbrev_number, bytes_read, abbrev_name;
@@ -7812,15 +10500,16 @@ dwarf2_read_abbrevs (bfd *abfd, struct dwarf2_cu *cu)
   struct attr_abbrev *cur_attrs;
   unsigned int allocated_attrs;
 
+  memset (table, 0, sizeof (struct dwarf2_abbrev_table));
+
   /* Initialize dwarf2 abbrevs */
-  obstack_init (&cu->abbrev_obstack);
-  cu->dwarf2_abbrevs = obstack_alloc (&cu->abbrev_obstack,
-				      (ABBREV_HASH_SIZE
-				       * sizeof (struct abbrev_info *)));
-  memset (cu->dwarf2_abbrevs, 0,
+  table->abbrevs = obstack_alloc (obstack,
+				  (ABBREV_HASH_SIZE
+				   * sizeof (struct abbrev_info *)));
+  memset (table->abbrevs, 0,
           ABBREV_HASH_SIZE * sizeof (struct abbrev_info *));
 
-  abbrev_ptr = dwarf2_per_objfile->abbrev_buffer + cu_header->abbrev_offset;
+  abbrev_ptr = dwarf2_per_objfile->abbrev_buffer + abbrev_offset;
   abbrev_number = read_unsigned_leb128 (abfd, abbrev_ptr, &bytes_read);
   abbrev_ptr += bytes_read;
 
@@ -7830,7 +10519,7 @@ dwarf2_read_abbrevs (bfd *abfd, struct dwarf2_cu *cu)
   /* loop until we reach an abbrev number of 0 */
   while (abbrev_number)
     {
-      cur_abbrev = dwarf_alloc_abbrev (cu);
+      cur_abbrev = dwarf_alloc_abbrev (obstack);
 
       /* read in abbrev header */
       cur_abbrev->number = abbrev_number;
@@ -7840,7 +10529,7 @@ dwarf2_read_abbrevs (bfd *abfd, struct dwarf2_cu *cu)
       abbrev_ptr += 1;
 
       if (cur_abbrev->tag == DW_TAG_namespace)
-	cu->has_namespace_info = 1;
+	table->has_namespace_info = 1;
 
       /* now read in declarations */
       abbrev_name = read_unsigned_leb128 (abfd, abbrev_ptr, &bytes_read);
@@ -7865,7 +10554,7 @@ dwarf2_read_abbrevs (bfd *abfd, struct dwarf2_cu *cu)
 
 	  if (abbrev_form == DW_FORM_ref_addr
 	      || abbrev_form == DW_FORM_indirect)
-	    cu->has_form_ref_addr = 1;
+	    table->has_form_ref_addr = 1;
 
 	  cur_attrs[cur_abbrev->num_attrs].name = abbrev_name;
 	  cur_attrs[cur_abbrev->num_attrs++].form = abbrev_form;
@@ -7875,15 +10564,15 @@ dwarf2_read_abbrevs (bfd *abfd, struct dwarf2_cu *cu)
 	  abbrev_ptr += bytes_read;
 	}
 
-      cur_abbrev->attrs = obstack_alloc (&cu->abbrev_obstack,
+      cur_abbrev->attrs = obstack_alloc (obstack,
 					 (cur_abbrev->num_attrs
 					  * sizeof (struct attr_abbrev)));
       memcpy (cur_abbrev->attrs, cur_attrs,
 	      cur_abbrev->num_attrs * sizeof (struct attr_abbrev));
 
       hash_number = abbrev_number % ABBREV_HASH_SIZE;
-      cur_abbrev->next = cu->dwarf2_abbrevs[hash_number];
-      cu->dwarf2_abbrevs[hash_number] = cur_abbrev;
+      cur_abbrev->next = table->abbrevs[hash_number];
+      table->abbrevs[hash_number] = cur_abbrev;
 
       /* Get next abbreviation.
          Under Irix6 the abbreviations for a compilation unit are not
@@ -7897,13 +10586,29 @@ dwarf2_read_abbrevs (bfd *abfd, struct dwarf2_cu *cu)
 	break;
       abbrev_number = read_unsigned_leb128 (abfd, abbrev_ptr, &bytes_read);
       abbrev_ptr += bytes_read;
-      if (dwarf2_lookup_abbrev (abbrev_number, cu) != NULL)
+      if (lookup_abbrev_in_table (abbrev_number, table->abbrevs) != NULL)
 	break;
     }
 
   xfree (cur_attrs);
 }
 
+/* Make TABLE the abbreviation table of CU.  CU's abbrev_obstack must
+   already be initialized; TABLE itself may live on some other obstack
+   (the prescan's) as long as it outlives CU.  */
+
+static void
+dwarf2_install_abbrevs (struct dwarf2_cu *cu,
+			struct dwarf2_abbrev_table *table)
+{
+  cu->dwarf2_abbrevs = table->abbrevs;
+  if (table->has_namespace_info)
+    cu->has_namespace_info = 1;
+  if (table->has_form_ref_addr)
+    cu->has_form_ref_addr = 1;
+}
+/* APPLE LOCAL end parallel psymtab scan  */
+
 /* Release the memory used by the abbrev table for a compilation unit.  */
 
 static void
@@ -7919,12 +10624,20 @@ dwarf2_free_abbrev_table (void *ptr_to_cu)
 
 static struct abbrev_info *
 dwarf2_lookup_abbrev (unsigned int number, struct dwarf2_cu *cu)
+{
+  return lookup_abbrev_in_table (number, cu->dwarf2_abbrevs);
+}
+
+/* Lookup NUMBER in the abbrev hash table ABBREVS.  */
+
+static struct abbrev_info *
+lookup_abbrev_in_table (unsigned int number, struct abbrev_info **abbrevs)
 {
   unsigned int hash_number;
   struct abbrev_info *abbrev;
 
   hash_number = number % ABBREV_HASH_SIZE;
-  abbrev = cu->dwarf2_abbrevs[hash_number];
+  abbrev = abbrevs[hash_number];
 
   while (abbrev)
     {
@@ -7983,14 +10696,9 @@ load_partial_dies (bfd *abfd, char *info_ptr, int building_psymtab,
   parent_die = NULL;
   last_die = NULL;
 
-  cu->partial_dies
-    = htab_create_alloc_ex (cu->header.length / 12,
-			    partial_die_hash,
-			    partial_die_eq,
-			    NULL,
-			    &cu->comp_unit_obstack,
-			    hashtab_obstack_allocate,
-			    dummy_obstack_deallocate);
+  /* APPLE LOCAL die offset map  */
+  cu->partial_dies = die_offset_map_create (cu->header.length / 12,
+					    &cu->comp_unit_obstack);
 
   part_die = obstack_alloc (&cu->comp_unit_obstack,
 			    sizeof (struct partial_die_info));
@@ -8132,11 +10840,8 @@ load_partial_dies (bfd *abfd, char *info_ptr, int building_psymtab,
 	  || abbrev->tag == DW_TAG_namespace
 	  || part_die->is_declaration)
 	{
-	  void **slot;
-
-	  slot = htab_find_slot_with_hash (cu->partial_dies, part_die,
-					   part_die->offset, INSERT);
-	  *slot = part_die;
+	  /* APPLE LOCAL die offset map  */
+	  *die_offset_map_slot (cu->partial_dies, part_die->offset) = part_die;
 	}
 
       part_die = obstack_alloc (&cu->comp_unit_obstack,
@@ -8408,10 +11113,9 @@ static struct partial_die_info *
 find_partial_die_in_comp_unit (unsigned long offset, struct dwarf2_cu *cu)
 {
   struct partial_die_info *lookup_die = NULL;
-  struct partial_die_info part_die;
 
-  part_die.offset = offset;
-  lookup_die = htab_find_with_hash (cu->partial_dies, &part_die, offset);
+  /* APPLE LOCAL die offset map  */
+  lookup_die = die_offset_map_find (cu->partial_dies, offset);
 
   /* FIXME: Remove this once <rdar://problem/6193416> is fixed */
   if (lookup_die == NULL)
@@ -8442,10 +11146,15 @@ find_partial_die (unsigned long offset, struct dwarf2_cu *cu)
 
   if (per_cu->cu == NULL)
     {
+      /* APPLE LOCAL dwarf2 cache limit  */
+      dwarf2_cache_stats.misses++;
       load_comp_unit (per_cu, cu->objfile);
       per_cu->cu->read_in_chain = dwarf2_per_objfile->read_in_chain;
       dwarf2_per_objfile->read_in_chain = per_cu;
     }
+  /* APPLE LOCAL dwarf2 cache limit  */
+  else
+    dwarf2_cache_stats.hits++;
 
   per_cu->cu->last_used = 0;
   return find_partial_die_in_comp_unit (offset, per_cu->cu);
@@ -8515,7 +11224,7 @@ read_full_die (struct die_info **diep, bfd *abfd, char *info_ptr,
   info_ptr += bytes_read;
   if (!abbrev_number)
     {
-      die = dwarf_alloc_die ();
+      die = dwarf_alloc_die (cu);
       die->tag = 0;
       die->abbrev = abbrev_number;
       die->type = NULL;
@@ -8531,7 +11240,7 @@ read_full_die (struct die_info **diep, bfd *abfd, char *info_ptr,
 	     abbrev_number,
 	     bfd_get_filename (abfd));
     }
-  die = dwarf_alloc_die ();
+  die = dwarf_alloc_die (cu);
   die->offset = offset;
   /* APPLE LOCAL - dwarf repository  */
   die->repository_id = 0;
@@ -8540,8 +11249,10 @@ read_full_die (struct die_info **diep, bfd *abfd, char *info_ptr,
   die->type = NULL;
 
   die->num_attrs = abbrev->num_attrs;
+  /* APPLE LOCAL packed dies  */
   die->attrs = (struct attribute *)
-    xmalloc (die->num_attrs * sizeof (struct attribute));
+    obstack_alloc (&cu->die_attr_obstack,
+		   die->num_attrs * sizeof (struct attribute));
 
   for (i = 0; i < abbrev->num_attrs; ++i)
     {
@@ -8579,6 +11290,8 @@ read_full_die (struct die_info **diep, bfd *abfd, char *info_ptr,
 	     used.  */
 	  if (per_cu->cu != NULL)
 	    {
+	      /* APPLE LOCAL dwarf2 cache limit  */
+	      dwarf2_cache_stats.hits++;
 	      per_cu->cu->last_used = 0;
 	      continue;
 	    }
@@ -9272,6 +11985,8 @@ add_file_name (struct line_header *lh,
   fe->mod_time = mod_time;
   fe->length = length;
   fe->included_p = 0;
+  /* APPLE LOCAL line table decoding  */
+  fe->subfile = NULL;
 }
  
 
@@ -9395,6 +12110,46 @@ dwarf_decode_line_header (unsigned int offset, bfd *abfd,
    to the beginning of the function if necessary, and is called on
    addresses passed to record_line.  */
 
+/* APPLE LOCAL begin line table decoding  */
+static int
+compare_function_range_lowpc (const void *ap, const void *bp)
+{
+  const struct function_range *a = *(const struct function_range **) ap;
+  const struct function_range *b = *(const struct function_range **) bp;
+
+  if (a->lowpc < b->lowpc)
+    return -1;
+  if (a->lowpc > b->lowpc)
+    return 1;
+  return 0;
+}
+
+/* Build CU's table of functions sorted by lowpc.  */
+
+static void
+sort_cu_functions (struct dwarf2_cu *cu)
+{
+  struct function_range *fn;
+  int i, n = 0;
+
+  for (fn = cu->first_fn; fn != NULL; fn = fn->next)
+    n++;
+
+  cu->sorted_fns = obstack_alloc (&cu->comp_unit_obstack,
+				  n * sizeof (struct function_range *));
+  for (i = 0, fn = cu->first_fn; fn != NULL; fn = fn->next)
+    cu->sorted_fns[i++] = fn;
+  qsort (cu->sorted_fns, n, sizeof (struct function_range *),
+	 compare_function_range_lowpc);
+
+  cu->num_sorted_fns = n;
+  cu->sorted_fns_overlap = 0;
+  for (i = 0; i + 1 < n; i++)
+    if (cu->sorted_fns[i]->highpc > cu->sorted_fns[i + 1]->lowpc)
+      cu->sorted_fns_overlap = 1;
+}
+/* APPLE LOCAL end line table decoding  */
+
 static CORE_ADDR
 check_cu_functions (CORE_ADDR address, struct dwarf2_cu *cu)
 {
@@ -9404,6 +12159,32 @@ check_cu_functions (CORE_ADDR address, struct dwarf2_cu *cu)
   if (!cu->first_fn)
     return address;
 
+  /* APPLE LOCAL begin line table decoding  */
+  /* This is called for every row of the line table, so when no two
+     functions overlap, binary search for the one containing ADDRESS
+     rather than walking the whole list.  */
+  if (cu->sorted_fns == NULL)
+    sort_cu_functions (cu);
+  if (!cu->sorted_fns_overlap)
+    {
+      int lo = 0, hi = cu->num_sorted_fns;
+
+      /* Find the last function starting at or before ADDRESS.  */
+      while (lo < hi)
+	{
+	  int mid = lo + (hi - lo) / 2;
+	  if (cu->sorted_fns[mid]->lowpc <= address)
+	    lo = mid + 1;
+	  else
+	    hi = mid;
+	}
+      if (lo == 0 || cu->sorted_fns[lo - 1]->highpc <= address)
+	return address;
+      fn = cu->sorted_fns[lo - 1];
+      goto found;
+    }
+  /* APPLE LOCAL end line table decoding  */
+
   if (!cu->cached_fn)
     cu->cached_fn = cu->first_fn;
 
@@ -10049,6 +12830,36 @@ dwarf2_record_line (struct line_header *lh, char *comp_dir, struct dwarf2_cu *cu
       the potential for inconsistency - a partial symtab and its associated
       symbtab having a different fullname -).  */
 
+/* APPLE LOCAL begin line table decoding  */
+/* Make the subfile for the line program's file number FILE current,
+   starting it the first time.  */
+
+static void
+dwarf2_start_line_subfile (struct line_header *lh, unsigned int file,
+			   char *comp_dir, struct dwarf2_cu *cu)
+{
+  /* lh->include_dirs and lh->file_names are 0-based, but the
+     directory and file name numbers in the statement program are
+     1-based.  */
+  struct file_entry *fe = &lh->file_names[file - 1];
+  char *dir;
+
+  if (fe->subfile != NULL)
+    {
+      current_subfile = fe->subfile;
+      return;
+    }
+
+  if (fe->dir_index)
+    dir = lh->include_dirs[fe->dir_index - 1];
+  else
+    dir = comp_dir;
+  /* APPLE LOCAL: Pass in the compilation directory of this CU.  */
+  dwarf2_start_subfile (fe->name, dir, cu->comp_dir);
+  fe->subfile = current_subfile;
+}
+/* APPLE LOCAL end line table decoding  */
+
 static void
 dwarf_decode_lines (struct line_header *lh, char *comp_dir, bfd *abfd,
 		    struct dwarf2_cu *cu, struct partial_symtab *pst)
@@ -10066,6 +12877,15 @@ dwarf_decode_lines (struct line_header *lh, char *comp_dir, bfd *abfd,
   line_ptr = lh->statement_program_start;
   line_end = lh->statement_program_end;
 
+  /* APPLE LOCAL begin line table decoding  */
+  /* Subfiles only last as long as the symtab being built.  */
+  {
+    unsigned int i;
+    for (i = 0; i < lh->num_file_names; i++)
+      lh->file_names[i].subfile = NULL;
+  }
+  /* APPLE LOCAL end line table decoding  */
+
   /* Read the statement sequences until there's nothing left.  */
   while (line_ptr < line_end)
     {
@@ -10079,21 +12899,9 @@ dwarf_decode_lines (struct line_header *lh, char *comp_dir, bfd *abfd,
       int end_sequence = 0;
 
       if (!decode_for_pst_p && lh->num_file_names >= file)
-	{
-          /* Start a subfile for the current file of the state machine.  */
-	  /* lh->include_dirs and lh->file_names are 0-based, but the
-	     directory and file name numbers in the statement program
-	     are 1-based.  */
-          struct file_entry *fe = &lh->file_names[file - 1];
-          char *dir;
-
-          if (fe->dir_index)
-            dir = lh->include_dirs[fe->dir_index - 1];
-          else
-            dir = comp_dir;
-          /* APPLE LOCAL: Pass in the compilation directory of this CU.  */
-	  dwarf2_start_subfile (fe->name, dir, cu->comp_dir);
-	}
+	/* Start a subfile for the current file of the state machine.  */
+	/* APPLE LOCAL line table decoding  */
+	dwarf2_start_line_subfile (lh, file, comp_dir, cu);
 
       /* Decode the table.  */
       while (!end_sequence)
@@ -10200,22 +13008,11 @@ dwarf_decode_lines (struct line_header *lh, char *comp_dir, bfd *abfd,
 	      break;
 	    case DW_LNS_set_file:
               {
-                /* The arrays lh->include_dirs and lh->file_names are
-                   0-based, but the directory and file name numbers in
-                   the statement program are 1-based.  */
-                struct file_entry *fe;
-                char *dir;
-
                 file = read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
                 line_ptr += bytes_read;
-                fe = &lh->file_names[file - 1];
-                if (fe->dir_index)
-                  dir = lh->include_dirs[fe->dir_index - 1];
-                else
-                  dir = comp_dir;
-                /* APPLE LOCAL: Pass in the compilation dir of this CU.  */
+                /* APPLE LOCAL line table decoding  */
                 if (!decode_for_pst_p)
-                  dwarf2_start_subfile (fe->name, dir, cu->comp_dir);
+                  dwarf2_start_line_subfile (lh, file, comp_dir, cu);
               }
 	      break;
 	    case DW_LNS_set_column:
@@ -12258,18 +15055,53 @@ dump_die_list (struct die_info *die)
     }
 }
 
+/* APPLE LOCAL begin packed dies  */
+/* Record DIE, found at OFFSET, in CU's DIE index.  The DIEs of a
+   compilation unit are read in order, so the index stays sorted by
+   offset.  The null entries terminating sibling chains are never the
+   target of a reference and are not recorded.  */
+
 static void
 store_in_ref_table (unsigned int offset, struct die_info *die,
 		    struct dwarf2_cu *cu)
 {
-  int h;
-  struct die_info *old;
+  if (die->tag == 0)
+    return;
+
+  gdb_assert (cu->n_dies == 0
+	      || cu->die_index[cu->n_dies - 1]->offset < offset);
+
+  if (cu->n_dies == cu->die_index_size)
+    {
+      cu->die_index_size *= 2;
+      cu->die_index = xrealloc (cu->die_index,
+				cu->die_index_size * sizeof (struct die_info *));
+    }
+  cu->die_index[cu->n_dies++] = die;
+}
+
+/* Return the DIE at OFFSET in CU, or NULL if CU has no such DIE.  */
+
+static struct die_info *
+find_die_in_ref_table (unsigned int offset, struct dwarf2_cu *cu)
+{
+  unsigned int low = 0, high = cu->n_dies;
+
+  while (low < high)
+    {
+      unsigned int mid = low + (high - low) / 2;
 
-  h = (offset % REF_HASH_SIZE);
-  old = cu->die_ref_table[h];
-  die->next_ref = old;
-  cu->die_ref_table[h] = die;
+      if (cu->die_index[mid]->offset < offset)
+	low = mid + 1;
+      else
+	high = mid;
+    }
+
+  if (low < cu->n_dies && cu->die_index[low]->offset == offset)
+    return cu->die_index[low];
+  return NULL;
 }
+/* APPLE LOCAL end packed dies  */
 
 static unsigned int
 dwarf2_get_ref_die_offset (struct attribute *attr, struct dwarf2_cu *cu)
@@ -12323,7 +15155,6 @@ follow_die_ref (struct die_info *src_die, struct attribute *attr,
 {
   struct die_info *die;
   unsigned int offset;
-  int h;
   /* APPLE LOCAL avoid unused var warning.  */
   /* struct die_info temp_die; */
   struct dwarf2_cu *target_cu;
@@ -12345,14 +15176,10 @@ follow_die_ref (struct die_info *src_die, struct attribute *attr,
   else
     target_cu = cu;
 
-  h = (offset % REF_HASH_SIZE);
-  die = target_cu->die_ref_table[h];
-  while (die)
-    {
-      if (die->offset == offset)
-	return die;
-      die = die->next_ref;
-    }
+  /* APPLE LOCAL packed dies  */
+  die = find_die_in_ref_table (offset, target_cu);
+  if (die)
+    return die;
 
   error (_("Dwarf Error: Cannot find DIE at 0x%lx referenced from DIE "
 	 "at 0x%lx [in module %s]"),
@@ -12663,22 +15490,25 @@ dwarf_alloc_block (struct dwarf2_cu *cu)
 }
 
 static struct abbrev_info *
-dwarf_alloc_abbrev (struct dwarf2_cu *cu)
+dwarf_alloc_abbrev (struct obstack *obstack)
 {
   struct abbrev_info *abbrev;
 
   abbrev = (struct abbrev_info *)
-    obstack_alloc (&cu->abbrev_obstack, sizeof (struct abbrev_info));
+    obstack_alloc (obstack, sizeof (struct abbrev_info));
   memset (abbrev, 0, sizeof (struct abbrev_info));
   return (abbrev);
 }
 
+/* APPLE LOCAL packed dies: Allocate the DIE on CU's die_obstack.  */
+
 static struct die_info *
-dwarf_alloc_die (void)
+dwarf_alloc_die (struct dwarf2_cu *cu)
 {
   struct die_info *die;
 
-  die = (struct die_info *) xmalloc (sizeof (struct die_info));
+  die = (struct die_info *) obstack_alloc (&cu->die_obstack,
+					   sizeof (struct die_info));
   memset (die, 0, sizeof (struct die_info));
   return (die);
 }
@@ -12909,19 +15739,120 @@ parse_macro_definition (struct macro_source_file *file, int line,
         /* Just complain.  */
 	dwarf2_macro_malformed_definition_complaint (body);
 
-      xfree (name);
-      {
-        int i;
+      xfree (name);
+      {
+        int i;
+
+        for (i = 0; i < argc; i++)
+          xfree (argv[i]);
+      }
+      xfree (argv);
+    }
+  else
+    dwarf2_macro_malformed_definition_complaint (body);
+}
+
+
+/* APPLE LOCAL begin lazy macro tables  */
+/* Where dwarf2_read_lazy_macros finds a compilation unit's macros.  */
+
+struct dwarf2_lazy_macros
+{
+  struct objfile *objfile;
+
+  /* The unit's DW_AT_stmt_list and DW_AT_macro_info.  */
+  unsigned int line_offset;
+  unsigned int macro_offset;
+
+  char *comp_dir;
+
+  struct lazy_macro_table lazy;
+};
+
+struct dwarf2_lazy_macros_state
+{
+  struct dwarf2_per_objfile *per_objfile;
+  struct macro_table *macros;
+};
 
-        for (i = 0; i < argc; i++)
-          xfree (argv[i]);
-      }
-      xfree (argv);
+static void
+restore_lazy_macros_state (void *arg)
+{
+  struct dwarf2_lazy_macros_state *state = arg;
+
+  dwarf2_per_objfile = state->per_objfile;
+  pending_macros = state->macros;
+}
+
+/* The read function of the lazy macro tables dwarf2_defer_macros
+   makes.  Decode the line number program header again for its file
+   names, and then the macros, just as read_file_scope would have.  */
+
+static struct macro_table *
+dwarf2_read_lazy_macros (void *data)
+{
+  struct dwarf2_lazy_macros *m = data;
+  struct objfile *objfile = m->objfile;
+  struct dwarf2_lazy_macros_state state;
+  struct cleanup *back_to;
+  struct dwarf2_cu cu;
+  struct line_header *lh;
+  struct macro_table *table = NULL;
+
+  state.per_objfile = dwarf2_per_objfile;
+  state.macros = pending_macros;
+  back_to = make_cleanup (restore_lazy_macros_state, &state);
+
+  dwarf2_per_objfile = objfile_data (objfile, dwarf2_objfile_data_key);
+  pending_macros = NULL;
+  if (dwarf2_per_objfile != NULL)
+    {
+      /* Only the unit header's offset size and the objfile are
+	 looked at.  */
+      memset (&cu, 0, sizeof (cu));
+      cu.objfile = objfile;
+
+      lh = dwarf_decode_line_header (m->line_offset, objfile->obfd, &cu);
+      if (lh != NULL)
+	{
+	  make_cleanup ((make_cleanup_ftype *) free_line_header, lh);
+	  dwarf_decode_macros (lh, m->macro_offset, m->comp_dir,
+			       objfile->obfd, &cu);
+	  table = pending_macros;
+	}
     }
-  else
-    dwarf2_macro_malformed_definition_complaint (body);
+
+  do_cleanups (back_to);
+  return table;
 }
 
+/* Arrange for the macros at MACRO_OFFSET in .debug_macinfo, whose file
+   numbers refer to the line number program at LINE_OFFSET, to be read
+   the first time the macro table of one of CU's symtabs is asked for.
+   Most units are expanded for their symbols alone, and a -g3 unit's
+   macros can take more time and memory than everything else in it.  */
+
+static void
+dwarf2_defer_macros (unsigned int line_offset, unsigned int macro_offset,
+		     char *comp_dir, struct dwarf2_cu *cu)
+{
+  struct objfile *objfile = cu->objfile;
+  struct dwarf2_lazy_macros *m;
+
+  m = obstack_alloc (&objfile->objfile_obstack, sizeof (*m));
+  m->objfile = objfile;
+  m->line_offset = line_offset;
+  m->macro_offset = macro_offset;
+  m->comp_dir = comp_dir ? obsavestring (comp_dir, strlen (comp_dir),
+					 &objfile->objfile_obstack) : NULL;
+  m->lazy.read = dwarf2_read_lazy_macros;
+  m->lazy.data = m;
+  m->lazy.read_p = 0;
+  m->lazy.table = NULL;
+
+  pending_lazy_macro_table = &m->lazy;
+}
+/* APPLE LOCAL end lazy macro tables  */
 
 static void
 dwarf_decode_macros (struct line_header *lh, unsigned int offset,
@@ -13086,6 +16017,8 @@ dwarf2_symbol_mark_computed (struct attribute *attr, struct symbol *sym,
 			     sizeof (struct dwarf2_address_translation));
       baton->objfile = cu->objfile;
       baton->section = SYMBOL_SECTION (sym);
+      /* APPLE LOCAL compiled locations  */
+      baton->compiled = NULL;
 
       /* The memory for addr_map is xmalloc'ed and never freed so we can
          save a pointer to it in our baton.  */
@@ -13114,6 +16047,8 @@ dwarf2_symbol_mark_computed (struct attribute *attr, struct symbol *sym,
 			     sizeof (struct dwarf2_address_translation));
       baton->objfile = cu->objfile;
       baton->section = SYMBOL_SECTION (sym);
+      /* APPLE LOCAL compiled locations  */
+      baton->compiled = NULL;
       baton->base_address_untranslated = INVALID_ADDRESS;
 
       /* The memory for addr_map is xmalloc'ed and never freed so we can
@@ -13202,6 +16137,33 @@ dwarf2_find_comp_unit (unsigned long offset, struct objfile *objfile)
   return this_cu;
 }
 
+/* APPLE LOCAL begin psymtab cache  */
+/* Like dwarf2_find_comp_unit, but return NULL instead of raising an
+   error if there is no compilation unit at exactly OFFSET.  */
+
+static struct dwarf2_per_cu_data *
+dwarf2_find_comp_unit_noerror (unsigned long offset)
+{
+  int low, high;
+
+  low = 0;
+  high = dwarf2_per_objfile->n_comp_units - 1;
+  while (low <= high)
+    {
+      int mid = low + (high - low) / 2;
+      unsigned long mid_offset = dwarf2_per_objfile->all_comp_units[mid]->offset;
+
+      if (mid_offset == offset)
+	return dwarf2_per_objfile->all_comp_units[mid];
+      if (mid_offset < offset)
+	low = mid + 1;
+      else
+	high = mid - 1;
+    }
+  return NULL;
+}
+/* APPLE LOCAL end psymtab cache  */
+
 /* Release one cached compilation unit, CU.  We unlink it from the tree
    of compilation units, but we don't remove it from the read_in_chain;
    the caller is responsible for that.  */
@@ -13216,8 +16178,8 @@ free_one_comp_unit (void *data)
   cu->per_cu = NULL;
 
   obstack_free (&cu->comp_unit_obstack, NULL);
-  if (cu->dies)
-    free_die_list (cu->dies);
+  /* APPLE LOCAL packed dies  */
+  free_die_storage (cu);
 
   xfree (cu);
 }
@@ -13272,24 +16234,86 @@ free_cached_comp_units (void *data)
     }
 }
 
+/* APPLE LOCAL begin dwarf2 cache limit  */
+/* Return roughly how much memory CU is using.  */
+
+static unsigned long
+dwarf2_cu_memory_used (struct dwarf2_cu *cu)
+{
+  unsigned long total = sizeof (struct dwarf2_cu);
+
+  total += obstack_memory_used (&cu->comp_unit_obstack);
+  if (cu->has_die_storage)
+    total += (obstack_memory_used (&cu->die_obstack)
+	      + obstack_memory_used (&cu->die_attr_obstack)
+	      + cu->die_index_size * sizeof (struct die_info *));
+  return total;
+}
+
+/* Return how much memory the marked compilation units on the
+   read_in_chain starting at PER_CU are using.  */
+
+static unsigned long
+dwarf2_marked_memory_used (struct dwarf2_per_cu_data *per_cu)
+{
+  unsigned long total = 0;
+
+  for (; per_cu != NULL; per_cu = per_cu->cu->read_in_chain)
+    if (per_cu->cu->mark)
+      total += dwarf2_cu_memory_used (per_cu->cu);
+  return total;
+}
+/* APPLE LOCAL end dwarf2 cache limit  */
+
 /* Increase the age counter on each cached compilation unit, and free
    any that are too old.  */
+/* APPLE LOCAL dwarf2 cache limit: Also free the least recently used
+   ones while the rest use more than dwarf2_max_cache_bytes.  */
 
 static void
 age_cached_comp_units (void)
 {
   struct dwarf2_per_cu_data *per_cu, **last_chain;
+  /* APPLE LOCAL dwarf2 cache limit  */
+  int max_age = dwarf2_max_cache_age;
 
-  dwarf2_clear_marks (dwarf2_per_objfile->read_in_chain);
   per_cu = dwarf2_per_objfile->read_in_chain;
   while (per_cu != NULL)
     {
       per_cu->cu->last_used ++;
-      if (per_cu->cu->last_used <= dwarf2_max_cache_age)
-	dwarf2_mark (per_cu->cu);
       per_cu = per_cu->cu->read_in_chain;
     }
 
+  /* APPLE LOCAL begin dwarf2 cache limit  */
+  /* Keep the units no older than MAX_AGE, and whatever they depend
+     on.  If that is too much memory, lower MAX_AGE to just below the
+     age of the oldest unit kept and try again; the units that are
+     kept together because of dependencies go together.  */
+  while (1)
+    {
+      int oldest = 0;
+
+      dwarf2_clear_marks (dwarf2_per_objfile->read_in_chain);
+      for (per_cu = dwarf2_per_objfile->read_in_chain;
+	   per_cu != NULL;
+	   per_cu = per_cu->cu->read_in_chain)
+	if (per_cu->cu->last_used <= max_age)
+	  {
+	    dwarf2_mark (per_cu->cu);
+	    if (per_cu->cu->last_used > oldest)
+	      oldest = per_cu->cu->last_used;
+	  }
+
+      if (oldest == 0
+	  || dwarf2_max_cache_bytes == UINT_MAX
+	  || (dwarf2_marked_memory_used (dwarf2_per_objfile->read_in_chain)
+	      <= dwarf2_max_cache_bytes))
+	break;
+
+      max_age = oldest - 1;
+    }
+  /* APPLE LOCAL end dwarf2 cache limit  */
+
   per_cu = dwarf2_per_objfile->read_in_chain;
   last_chain = &dwarf2_per_objfile->read_in_chain;
   while (per_cu != NULL)
@@ -13302,6 +16326,8 @@ age_cached_comp_units (void)
 	{
 	  free_one_comp_unit (per_cu->cu);
 	  *last_chain = next_cu;
+	  /* APPLE LOCAL dwarf2 cache limit  */
+	  dwarf2_cache_stats.evictions++;
 	}
       else
 	last_chain = &per_cu->cu->read_in_chain;
@@ -13338,80 +16364,37 @@ free_one_cached_comp_unit (void *target_cu)
     }
 }
 
-/* A pair of DIE offset and GDB type pointer.  We store these
-   in a hash table separate from the DIEs, and preserve them
-   when the DIEs are flushed out of cache.  */
-
-struct dwarf2_offset_and_type
-{
-  unsigned int offset;
-  struct type *type;
-};
-
-/* Hash function for a dwarf2_offset_and_type.  */
-
-static hashval_t
-offset_and_type_hash (const void *item)
-{
-  const struct dwarf2_offset_and_type *ofs = item;
-  return ofs->offset;
-}
-
-/* Equality function for a dwarf2_offset_and_type.  */
-
-static int
-offset_and_type_eq (const void *item_lhs, const void *item_rhs)
-{
-  const struct dwarf2_offset_and_type *ofs_lhs = item_lhs;
-  const struct dwarf2_offset_and_type *ofs_rhs = item_rhs;
-  return ofs_lhs->offset == ofs_rhs->offset;
-}
-
 /* Set the type associated with DIE to TYPE.  Save it in CU's hash
-   table if necessary.  */
+   table if necessary.  The table maps DIE offsets to types; it is
+   kept separate from the DIEs, and preserved when the DIEs are
+   flushed out of cache.  */
 
 static void
 set_die_type (struct die_info *die, struct type *type, struct dwarf2_cu *cu)
 {
-  struct dwarf2_offset_and_type **slot, ofs;
-
   die->type = type;
 
   if (cu->per_cu == NULL)
     return;
 
+  /* APPLE LOCAL begin die offset map  */
   if (cu->per_cu->type_hash == NULL)
     cu->per_cu->type_hash
-      = htab_create_alloc_ex (cu->header.length / 24,
-			      offset_and_type_hash,
-			      offset_and_type_eq,
-			      NULL,
-			      &cu->objfile->objfile_obstack,
-			      hashtab_obstack_allocate,
-			      dummy_obstack_deallocate);
+      = die_offset_map_create (cu->header.length / 24,
+			       &cu->objfile->objfile_obstack);
 
-  ofs.offset = die->offset;
-  ofs.type = type;
-  slot = (struct dwarf2_offset_and_type **)
-    htab_find_slot_with_hash (cu->per_cu->type_hash, &ofs, ofs.offset, INSERT);
-  *slot = obstack_alloc (&cu->objfile->objfile_obstack, sizeof (**slot));
-  **slot = ofs;
+  *die_offset_map_slot (cu->per_cu->type_hash, die->offset) = type;
+  /* APPLE LOCAL end die offset map  */
 }
 
 /* Find the type for DIE in TYPE_HASH, or return NULL if DIE does not
    have a saved type.  */
 
 static struct type *
-get_die_type (struct die_info *die, htab_t type_hash)
+get_die_type (struct die_info *die, struct die_offset_map *type_hash)
 {
-  struct dwarf2_offset_and_type *slot, ofs;
-
-  ofs.offset = die->offset;
-  slot = htab_find_with_hash (type_hash, &ofs, ofs.offset);
-  if (slot)
-    return slot->type;
-  else
-    return NULL;
+  /* APPLE LOCAL die offset map  */
+  return die_offset_map_find (type_hash, die->offset);
 }
 
 /* Restore the types of the DIE tree starting at START_DIE from the hash
@@ -13517,26 +16500,145 @@ dummy_obstack_deallocate (void *object, void *data)
   return;
 }
 
-/* Trivial hash function for partial_die_info: the hash value of a DIE
-   is its offset in .debug_info for this objfile.  */
+/* APPLE LOCAL begin die offset map  */
+/* A hash table from DIE offsets to pointers, for the tables whose
+   only key is the offset: a compilation unit's partial DIEs, and the
+   types its DIEs were given.  Each slot holds the offset beside the
+   pointer, so a probe never has to follow the pointer or call out to
+   compare, and growing the table needs no hash function.  Probing is
+   linear over a power-of-two table that is sized from the length of
+   the compilation unit, so that it seldom has to grow.  Entries are
+   never removed.  Like the libiberty tables these replaced, the
+   memory comes from an obstack and is freed with it.  */
 
-static hashval_t
-partial_die_hash (const void *item)
+struct die_offset_entry
+{
+  unsigned int offset;
+
+  /* What OFFSET maps to, or NULL if the slot is empty.  */
+  void *value;
+};
+
+struct die_offset_map
+{
+  struct obstack *obstack;
+
+  /* The number of slots, always a power of two, and the number of
+     them in use.  */
+  unsigned int size;
+  unsigned int count;
+
+  struct die_offset_entry *entries;
+};
+
+static unsigned int
+die_offset_map_index (struct die_offset_map *map, unsigned int offset)
 {
-  const struct partial_die_info *part_die = item;
-  return part_die->offset;
+  /* DIE offsets are mostly small multiples of a few bytes; spread
+     them over the whole table.  */
+  unsigned int hash = offset * 0x9e3779b1U;
+
+  return (hash ^ (hash >> 15)) & (map->size - 1);
 }
 
-/* Trivial comparison function for partial_die_info structures: two DIEs
-   are equal if they have the same offset.  */
+static struct die_offset_entry *
+die_offset_map_alloc_entries (struct obstack *obstack, unsigned int size)
+{
+  struct die_offset_entry *entries;
 
-static int
-partial_die_eq (const void *item_lhs, const void *item_rhs)
+  entries = obstack_alloc (obstack, size * sizeof (struct die_offset_entry));
+  memset (entries, 0, size * sizeof (struct die_offset_entry));
+  return entries;
+}
+
+/* Create a map on OBSTACK with room for about EXPECTED entries.  */
+
+static struct die_offset_map *
+die_offset_map_create (unsigned int expected, struct obstack *obstack)
+{
+  struct die_offset_map *map;
+  unsigned int size = 16;
+
+  /* Keep the table at most half full.  */
+  while (size < expected * 2 && size < 0x40000000U)
+    size *= 2;
+
+  map = obstack_alloc (obstack, sizeof (struct die_offset_map));
+  map->obstack = obstack;
+  map->size = size;
+  map->count = 0;
+  map->entries = die_offset_map_alloc_entries (obstack, size);
+  return map;
+}
+
+/* Double the size of MAP, moving its entries to their new slots.  */
+
+static void
+die_offset_map_expand (struct die_offset_map *map)
+{
+  struct die_offset_entry *old_entries = map->entries;
+  unsigned int old_size = map->size;
+  unsigned int i;
+
+  map->size = old_size * 2;
+  map->entries = die_offset_map_alloc_entries (map->obstack, map->size);
+
+  for (i = 0; i < old_size; i++)
+    if (old_entries[i].value != NULL)
+      {
+	unsigned int j = die_offset_map_index (map, old_entries[i].offset);
+
+	while (map->entries[j].value != NULL)
+	  j = (j + 1) & (map->size - 1);
+	map->entries[j] = old_entries[i];
+      }
+}
+
+/* Return the place in MAP where the value for OFFSET is stored,
+   making one if there isn't one.  The caller must store a non-NULL
+   pointer there.  */
+
+static void **
+die_offset_map_slot (struct die_offset_map *map, unsigned int offset)
+{
+  struct die_offset_entry *entry;
+  unsigned int i;
+
+  if ((map->count + 1) * 4 > map->size * 3)
+    die_offset_map_expand (map);
+
+  i = die_offset_map_index (map, offset);
+  while (1)
+    {
+      entry = &map->entries[i];
+      if (entry->value == NULL)
+	{
+	  entry->offset = offset;
+	  map->count++;
+	  return &entry->value;
+	}
+      if (entry->offset == offset)
+	return &entry->value;
+      i = (i + 1) & (map->size - 1);
+    }
+}
+
+/* Return the value MAP has for OFFSET, or NULL if there is none.  */
+
+static void *
+die_offset_map_find (struct die_offset_map *map, unsigned int offset)
 {
-  const struct partial_die_info *part_die_lhs = item_lhs;
-  const struct partial_die_info *part_die_rhs = item_rhs;
-  return part_die_lhs->offset == part_die_rhs->offset;
+  unsigned int i = die_offset_map_index (map, offset);
+
+  while (map->entries[i].value != NULL)
+    {
+      if (map->entries[i].offset == offset)
+	return map->entries[i].value;
+      i = (i + 1) & (map->size - 1);
+    }
+  return NULL;
 }
+/* APPLE LOCAL end die offset map  */
 
 static struct cmd_list_element *set_dwarf2_cmdlist;
 static struct cmd_list_element *show_dwarf2_cmdlist;
@@ -13559,6 +16661,20 @@ void
 _initialize_dwarf2_read (void)
 {
   dwarf2_objfile_data_key = register_objfile_data ();
+  /* APPLE LOCAL mmap dwarf sections  */
+#ifdef HAVE_MMAP
+  dwarf2_section_windows_key
+    = register_objfile_data_with_cleanup (dwarf2_free_section_windows);
+#endif
+  /* APPLE LOCAL compressed debug sections  */
+  dwarf2_compressed_sections_key
+    = register_objfile_data_with_cleanup (dwarf2_free_compressed_sections);
+  /* APPLE LOCAL dwarf2 name index  */
+  dwarf2_name_index_key
+    = register_objfile_data_with_cleanup (dwarf2_free_name_index);
+  /* APPLE LOCAL dwarf2 structure sharing  */
+  dwarf2_shared_structures_key
+    = register_objfile_data_with_cleanup (dwarf2_free_shared_structures);
 
   add_prefix_cmd ("dwarf2", class_maintenance, set_dwarf2_cmd, _("\
 Set DWARF 2 specific variables.\n\
@@ -13593,6 +16709,167 @@ caching, which can slow down startup."),
 			    &set_dwarf2_cmdlist,
 			    &show_dwarf2_cmdlist);
 
+  /* APPLE LOCAL begin dwarf2 cache limit  */
+  add_setshow_uinteger_cmd ("max-cache-bytes", class_obscure,
+			    &dwarf2_max_cache_bytes, _("\
+Set the upper bound on the memory used by cached dwarf2 compilation units."), _("\
+Show the upper bound on the memory used by cached dwarf2 compilation units."), _("\
+When the compilation units cached for an objfile use more than this many\n\
+bytes, the least recently used ones are released without waiting for\n\
+them to reach max-cache-age.  Zero means no limit."),
+			    NULL,
+			    show_dwarf2_max_cache_bytes,
+			    &set_dwarf2_cmdlist,
+			    &show_dwarf2_cmdlist);
+
+  /* APPLE LOCAL begin compiled locations  */
+  add_setshow_boolean_cmd ("compiled-locations", class_maintenance,
+			   &dwarf2_compiled_locations, _("\
+Set whether common DWARF location expressions bypass the evaluator."), _("\
+Show whether common DWARF location expressions bypass the evaluator."), _("\
+When on, a location expression that is just a register, a register or\n\
+the frame base plus an offset, or an address is decoded once and the\n\
+variable's location is then worked out from that directly."),
+			   NULL,
+			   show_dwarf2_compiled_locations,
+			   &set_dwarf2_cmdlist,
+			   &show_dwarf2_cmdlist);
+  /* APPLE LOCAL end compiled locations  */
+
+  add_cmd ("dwarf2-cache", class_maintenance, maintenance_info_dwarf2_cache,
+	   _("\
+Show statistics about the cache of dwarf2 compilation units.\n\
+This prints the number of cache hits, misses and evictions so far, and\n\
+the number of compilation units and bytes each objfile has cached."),
+	   &maintenanceinfolist);
+  /* APPLE LOCAL end dwarf2 cache limit  */
+
+  /* APPLE LOCAL psymtab cache  */
+  add_setshow_optional_filename_cmd ("psymtab-cache-directory",
+				     class_obscure,
+				     &dwarf2_psymtab_cache_directory, _("\
+Set the directory used to cache dwarf2 partial symbol tables."), _("\
+Show the directory used to cache dwarf2 partial symbol tables."), _("\
+When set, the partial symbol tables built from an objfile's DWARF are\n\
+saved in this directory under the objfile's UUID, and read back instead\n\
+of being rebuilt when an objfile with the same UUID is loaded again.\n\
+An empty value disables the cache."),
+				     NULL,
+				     show_dwarf2_psymtab_cache_directory,
+				     &set_dwarf2_cmdlist,
+				     &show_dwarf2_cmdlist);
+
+  /* APPLE LOCAL lazy function symbols  */
+  add_setshow_boolean_cmd ("lazy-function-symbols", class_obscure,
+			   &dwarf2_lazy_function_symbols, _("\
+Set whether dwarf2 local symbols are read only when they are needed."), _("\
+Show whether dwarf2 local symbols are read only when they are needed."), _("\
+When on, expanding a compilation unit doesn't make symbols for the\n\
+parameters and local variables of its functions; those of a function\n\
+or lexical block are read the first time that block is searched.\n\
+This only affects compilation units expanded after it is changed."),
+			   NULL,
+			   show_dwarf2_lazy_function_symbols,
+			   &set_dwarf2_cmdlist,
+			   &show_dwarf2_cmdlist);
+
+  /* APPLE LOCAL lazy macro tables  */
+  add_setshow_boolean_cmd ("lazy-macros", class_obscure,
+			   &dwarf2_lazy_macros, _("\
+Set whether dwarf2 macro information is read only when it is needed."), _("\
+Show whether dwarf2 macro information is read only when it is needed."), _("\
+When on, expanding a compilation unit doesn't read its .debug_macinfo;\n\
+its macro table is built the first time a macro is looked up in its\n\
+scope.  This only affects compilation units expanded after it is changed."),
+			   NULL,
+			   show_dwarf2_lazy_macros,
+			   &set_dwarf2_cmdlist,
+			   &show_dwarf2_cmdlist);
+
+  /* APPLE LOCAL dwarf2 name index  */
+  add_setshow_boolean_cmd ("name-index", class_obscure,
+			   &dwarf2_use_name_index, _("\
+Set whether dwarf2 names are looked up through the pubnames tables."), _("\
+Show whether dwarf2 names are looked up through the pubnames tables."), _("\
+When on, an objfile with both .debug_pubnames and .debug_pubtypes\n\
+gets no partial symbols for its compilation units.  A compilation unit\n\
+is read in when one of the names those tables list for it is looked\n\
+up instead.  This only affects objfiles read after it is changed."),
+			   NULL,
+			   show_dwarf2_use_name_index,
+			   &set_dwarf2_cmdlist,
+			   &show_dwarf2_cmdlist);
+
+  /* APPLE LOCAL dwarf2 structure sharing  */
+  add_setshow_boolean_cmd ("share-structure-types", class_obscure,
+			   &dwarf2_share_structure_types, _("\
+Set whether identical dwarf2 structure types are shared between compilation units."), _("\
+Show whether identical dwarf2 structure types are shared between compilation units."), _("\
+When on, a named structure, union or class defined the same way in\n\
+several compilation units of an objfile, typically by a header they\n\
+all include, is read once and the one type is used by all of them.\n\
+This only affects compilation units expanded after it is changed."),
+			   NULL,
+			   show_dwarf2_share_structure_types,
+			   &set_dwarf2_cmdlist,
+			   &show_dwarf2_cmdlist);
+
+  /* APPLE LOCAL mmap dwarf sections  */
+  add_setshow_boolean_cmd ("mmap-sections", class_obscure,
+			   &dwarf2_mmap_sections, _("\
+Set whether dwarf2 debug sections are mapped with mmap."), _("\
+Show whether dwarf2 debug sections are mapped with mmap."), _("\
+When on, the debug sections of an objfile that need no relocation are\n\
+mapped from the file instead of being copied into gdb's memory.  This\n\
+only affects objfiles read after the setting is changed."),
+			   NULL,
+			   show_dwarf2_mmap_sections,
+			   &set_dwarf2_cmdlist,
+			   &show_dwarf2_cmdlist);
+
+  /* APPLE LOCAL compressed debug sections  */
+  add_setshow_boolean_cmd ("decompress-on-demand", class_obscure,
+			   &dwarf2_decompress_on_demand, _("\
+Set whether chunked compressed .debug_info is decompressed as it is used."), _("\
+Show whether chunked compressed .debug_info is decompressed as it is used."), _("\
+When on, only the chunks of a compressed .debug_info that hold the\n\
+compilation units GDB actually reads are decompressed.  When off, the\n\
+whole section is decompressed as the objfile is read.  This only affects\n\
+objfiles read after the setting is changed."),
+			   NULL,
+			   show_dwarf2_decompress_on_demand,
+			   &set_dwarf2_cmdlist,
+			   &show_dwarf2_cmdlist);
+
+  /* APPLE LOCAL parallel psymtab scan  */
+  add_setshow_zinteger_cmd ("parallel-scan-threads", class_obscure,
+			    &dwarf2_parallel_scan_threads, _("\
+Set the number of threads used to prescan dwarf2 compilation units."), _("\
+Show the number of threads used to prescan dwarf2 compilation units."), _("\
+When greater than one, the abbreviation tables of all the compilation\n\
+units in an objfile are decoded by this many threads before its partial\n\
+symbols are built.  The partial symbols themselves are still built in\n\
+order on the main thread.  Zero or one disables the prescan."),
+			    NULL,
+			    show_dwarf2_parallel_scan_threads,
+			    &set_dwarf2_cmdlist,
+			    &show_dwarf2_cmdlist);
+
+  /* APPLE LOCAL debug map prefetch  */
+  add_setshow_zinteger_cmd ("oso-prefetch-threads", class_obscure,
+			    &dwarf2_oso_prefetch_threads, _("\
+Set the number of threads used to prefetch debug map object files."), _("\
+Show the number of threads used to prefetch debug map object files."), _("\
+When greater than zero, and an executable without a dSYM is read, this\n\
+many threads read the .o files named by its debug map ahead of the\n\
+pubtypes scan, so that the scan finds them in the buffer cache.  The\n\
+.o files are still opened and scanned in order on the main thread.\n\
+Zero disables the prefetch."),
+			    NULL,
+			    show_dwarf2_oso_prefetch_threads,
+			    &set_dwarf2_cmdlist,
+			    &show_dwarf2_cmdlist);
+
   /* APPLE LOCAL begin subroutine inlining  */
   add_setshow_boolean_cmd ("inlined-stepping", class_support, 
 			   &dwarf2_allow_inlined_stepping,
@@ -13616,6 +16893,78 @@ caching, which can slow down startup."),
   /* APPLE LOCAL end Inform users about debugging optimized code  */
 }
 
+/* APPLE LOCAL begin dwarf2 cache limit  */
+/* Implement "maint info dwarf2-cache".  */
+
+static void
+maintenance_info_dwarf2_cache (char *args, int from_tty)
+{
+  struct objfile *objfile;
+  unsigned long total_units = 0, total_bytes = 0;
+
+  printf_filtered (_("Cache hits: %lu\n"), dwarf2_cache_stats.hits);
+  printf_filtered (_("Cache misses: %lu\n"), dwarf2_cache_stats.misses);
+  printf_filtered (_("Cache evictions: %lu\n"),
+		   dwarf2_cache_stats.evictions);
+
+  ALL_OBJFILES (objfile)
+    {
+      struct dwarf2_per_objfile *data;
+      struct dwarf2_per_cu_data *per_cu;
+      unsigned long units = 0, bytes = 0;
+
+      data = objfile_data (objfile, dwarf2_objfile_data_key);
+      if (data == NULL)
+	continue;
+
+      for (per_cu = data->read_in_chain;
+	   per_cu != NULL;
+	   per_cu = per_cu->cu->read_in_chain)
+	{
+	  units++;
+	  bytes += dwarf2_cu_memory_used (per_cu->cu);
+	}
+
+      if (units != 0)
+	printf_filtered (_("  %s: %lu units, %lu bytes\n"),
+			 objfile->name, units, bytes);
+      total_units += units;
+      total_bytes += bytes;
+    }
+
+  printf_filtered (_("Units cached: %lu\n"), total_units);
+  printf_filtered (_("Bytes held: %lu\n"), total_bytes);
+}
+/* APPLE LOCAL end dwarf2 cache limit  */
+
+/* APPLE LOCAL begin objfile memory  */
+/* Return how much memory the compilation units OBJFILE has cached
+   (their DIEs, attributes and DIE indexes) are using, and store how
+   many there are in *UNITS.  */
+
+unsigned long
+dwarf2_objfile_cache_memory_used (struct objfile *objfile, int *units)
+{
+  struct dwarf2_per_objfile *data;
+  struct dwarf2_per_cu_data *per_cu;
+  unsigned long bytes = 0;
+
+  *units = 0;
+  data = objfile_data (objfile, dwarf2_objfile_data_key);
+  if (data == NULL)
+    return 0;
+
+  for (per_cu = data->read_in_chain;
+       per_cu != NULL;
+       per_cu = per_cu->cu->read_in_chain)
+    {
+      (*units)++;
+      bytes += dwarf2_cu_memory_used (per_cu->cu);
+    }
+  return bytes;
+}
+/* APPLE LOCAL end objfile memory  */
+
 /* APPLE LOCAL begin dwarf repository  */
 /* NOTE:  Everything from here to the end of the file is APPLE LOCAL  */
 /* *********************** REPOSITORY STUFF STARTS HERE *********************** */
@@ -14676,6 +18025,7 @@ dwarf2_read_repository_abbrevs (struct dwarf2_cu *cu)
 
        SELECT_DIE_STR  (global constant)
        FIND_STRING_STR (global constant)
+       SELECT_DIES_STR (global constant)
 
        struct attr_pair (struct type);
 
@@ -14685,6 +18035,8 @@ dwarf2_read_repository_abbrevs (struct dwarf2_cu *cu)
        get_uleb128             (function)
        read_in_db_abbrev_table (function)
        fill_in_die_info        (function)
+       db_build_die            (function)
+       db_lookup_types         (function)
        db_lookup_type          (function)
        db_error                (function)
        build_dummy_cu          (function)
@@ -14708,6 +18060,9 @@ dwarf2_read_repository_abbrevs (struct dwarf2_cu *cu)
 
 #define SELECT_DIE_STR "SELECT long_canonical FROM debug_info WHERE die_id == ?"
 #define FIND_STRING_STR   "SELECT string FROM debug_str WHERE string_id == ?"
+/* APPLE LOCAL repository batch lookup  */
+#define SELECT_DIES_STR \
+  "SELECT die_id, long_canonical FROM debug_info WHERE die_id IN ("
 
 sqlite3_stmt *db_stmt1 = NULL;
 sqlite3_stmt *db_stmt2 = NULL;
@@ -14871,42 +18226,186 @@ fill_in_die_info (struct die_info *new_die, int die_len, uint8_t *die_bytes,
 
   if (abbrev.has_children)
     {
-      int j;
+      int j, n_ids;
       int num_children = get_uleb128 (&d_ptr);
+      int *child_ids;
+      struct die_info **children;
       struct die_info *last_child = NULL;
-
-      for (j = 0; (j < num_children
-		   && (d_ptr < (die_bytes + die_len))); j++)
+      struct cleanup *back_to;
+
+      /* APPLE LOCAL repository batch lookup: Collect all the child ids
+	 first, so db_lookup_types can fetch them in a few queries
+	 rather than one query per child.  */
+      child_ids = (int *) xmalloc ((num_children + 1) * sizeof (int));
+      back_to = make_cleanup (xfree, child_ids);
+      children = (struct die_info **) 
+	xmalloc ((num_children + 1) * sizeof (struct die_info *));
+      make_cleanup (xfree, children);
+
+      for (n_ids = 0; (n_ids < num_children
+		       && (d_ptr < (die_bytes + die_len))); n_ids++)
 	{
-	  int child_id = get_uleb128 (&d_ptr);
-	  if (child_id == new_die->repository_id)
+	  child_ids[n_ids] = get_uleb128 (&d_ptr);
+	  if (child_ids[n_ids] == new_die->repository_id)
 	    internal_error (__FILE__, __LINE__,
 		    _("Recursive child id in repository?\n"));
-	  if (!last_child)
+	}
+
+      db_lookup_types (n_ids, child_ids, children, db, abbrev_table);
+
+      for (j = 0; j < n_ids; j++)
+	{
+	  if (children[j] == NULL)
 	    {
-	      new_die->child = db_lookup_type (child_id, db, abbrev_table);
-	      last_child = new_die->child;
-	      last_child->parent = new_die;
+	      complaint (&symfile_complaints,
+			 _("repository child die %d not found"), child_ids[j]);
+	      continue;
 	    }
+	  if (!last_child)
+	    new_die->child = children[j];
+	  else
+	    last_child->sibling = children[j];
+	  last_child = children[j];
+	  last_child->parent = new_die;
+	}
+
+      do_cleanups (back_to);
+    }
+  
+}
+
+/* Build the die for repository TYPE_ID out of the DIE_LEN bytes of
+   its long canonical form at TMP_BYTES.  The bytes are copied, since
+   the die's attributes point into them.  */
+
+static struct die_info *
+db_build_die (int type_id, const uint8_t *tmp_bytes, int die_len,
+	      struct abbrev_info *abbrev_table, sqlite3 *db)
+{
+  uint8_t *die_bytes;
+  uint8_t *d_ptr;
+  struct die_info *new_die;
+
+  die_bytes = (uint8_t *) xmalloc (die_len);
+  memcpy (die_bytes, tmp_bytes, die_len);
+  d_ptr = die_bytes;
+
+  new_die = (struct die_info *) xmalloc (sizeof (struct die_info));
+
+  new_die->abbrev = get_uleb128 (&d_ptr);
+  new_die->tag = abbrev_table[new_die->abbrev].tag;
+  new_die->offset = 0;
+  new_die->repository_id = type_id;
+  new_die->type = NULL;
+  new_die->child = NULL;
+  new_die->sibling = NULL;
+  new_die->parent = NULL;
+  new_die->num_attrs = abbrev_table[new_die->abbrev].num_attrs;
+  fill_in_die_info (new_die, die_len, die_bytes, d_ptr, abbrev_table, db);
+
+  return new_die;
+}
+
+/* APPLE LOCAL begin repository batch lookup  */
+
+/* The most dies db_lookup_types asks for in one query.  This has to
+   stay under SQLite's limit on the number of host parameters in a
+   statement, which is 999 by default.  */
+#define DB_LOOKUP_BATCH_SIZE 256
+
+/* Look up the N_IDS repository dies in TYPE_IDS, putting the die for
+   TYPE_IDS[i] in DIES[i], or NULL if the repository doesn't have it.
+   The dies are fetched DB_LOOKUP_BATCH_SIZE at a time, and the rows
+   of each batch are all read before any of them is decoded, since
+   decoding a die looks up its own children.  */
+
+static void
+db_lookup_types (int n_ids, int *type_ids, struct die_info **dies,
+		 sqlite3 *db, struct abbrev_info *abbrev_table)
+{
+  int start;
+
+  for (start = 0; start < n_ids; start += DB_LOOKUP_BATCH_SIZE)
+    {
+      int count = n_ids - start;
+      uint8_t *bytes[DB_LOOKUP_BATCH_SIZE];
+      int lengths[DB_LOOKUP_BATCH_SIZE];
+      char *select_string, *p;
+      const char *pzTail;
+      sqlite3_stmt *stmt = NULL;
+      int db_status;
+      int i;
+
+      if (count > DB_LOOKUP_BATCH_SIZE)
+	count = DB_LOOKUP_BATCH_SIZE;
+
+      /* One "?," per id; the last comma becomes the closing paren.  */
+      select_string = xmalloc (sizeof (SELECT_DIES_STR) + 2 * count);
+      strcpy (select_string, SELECT_DIES_STR);
+      p = select_string + strlen (select_string);
+      for (i = 0; i < count; i++)
+	{
+	  *p++ = '?';
+	  *p++ = ',';
+	}
+      p[-1] = ')';
+      *p = '\0';
+
+      db_status = sqlite3_prepare_v2 (db, select_string,
+				      strlen (select_string), &stmt, &pzTail);
+      xfree (select_string);
+      if (db_status != SQLITE_OK)
+	db_error ("db_lookup_types", "sqlite3_prepare_v2 failed", db);
+
+      for (i = 0; i < count; i++)
+	{
+	  bytes[i] = NULL;
+	  lengths[i] = 0;
+	  if (sqlite3_bind_int (stmt, i + 1, type_ids[start + i]) != SQLITE_OK)
+	    db_error ("db_lookup_types", "sqlite3_bind_int failed", db);
+	}
+
+      while ((db_status = sqlite3_step (stmt)) == SQLITE_ROW)
+	{
+	  int die_id = sqlite3_column_int (stmt, 0);
+	  int die_len = sqlite3_column_bytes (stmt, 1);
+	  const uint8_t *blob = sqlite3_column_blob (stmt, 1);
+
+	  /* A die can be listed more than once among the children,
+	     and each mention gets a die of its own.  */
+	  for (i = 0; i < count; i++)
+	    if (type_ids[start + i] == die_id && bytes[i] == NULL)
+	      {
+		bytes[i] = (uint8_t *) xmalloc (die_len);
+		memcpy (bytes[i], blob, die_len);
+		lengths[i] = die_len;
+	      }
+	}
+      if (db_status != SQLITE_DONE)
+	db_error ("db_lookup_types", "sqlite3_step failed", db);
+
+      if (sqlite3_finalize (stmt) != SQLITE_OK)
+	db_error ("db_lookup_types", "sqlite3_finalize failed", db);
+
+      for (i = 0; i < count; i++)
+	{
+	  if (bytes[i] == NULL)
+	    dies[start + i] = NULL;
 	  else
 	    {
-	      last_child->sibling = db_lookup_type (child_id, db, abbrev_table);
-	      last_child = last_child->sibling;
-	      last_child->parent = new_die;
+	      dies[start + i] = db_build_die (type_ids[start + i], bytes[i],
+					      lengths[i], abbrev_table, db);
+	      xfree (bytes[i]);
 	    }
 	}
     }
-  
 }
+/* APPLE LOCAL end repository batch lookup  */
 
 static struct die_info *
 db_lookup_type (int type_id, sqlite3 *db, struct abbrev_info *abbrev_table)
 {
   int db_status;
-  int die_len;
-  uint8_t *tmp_bytes;
-  uint8_t *die_bytes;
-  uint8_t *d_ptr;
   const char *pzTail;
   struct die_info *new_die = NULL;
 
@@ -14922,27 +18421,10 @@ db_lookup_type (int type_id, sqlite3 *db, struct abbrev_info *abbrev_table)
       db_status = sqlite3_step (db_stmt1);
 
       if (db_status == SQLITE_ROW)
-	{
-	  die_len = sqlite3_column_bytes (db_stmt1, 0);
-	  tmp_bytes = (uint8_t *) sqlite3_column_blob (db_stmt1, 0);
-	  die_bytes = (uint8_t *) xmalloc (die_len);
-	  memcpy (die_bytes, tmp_bytes, die_len);
-	  d_ptr = die_bytes;
-
-	  new_die = (struct die_info *) xmalloc (sizeof (struct die_info));
-
-	  new_die->abbrev = get_uleb128 (&d_ptr);
-	  new_die->tag = abbrev_table[new_die->abbrev].tag;
-	  new_die->offset = 0;
-	  new_die->repository_id = type_id;
-	  new_die->next_ref = NULL;
-	  new_die->type = NULL;
-	  new_die->child = NULL;
-	  new_die->sibling = NULL;
-	  new_die->parent = NULL;
-	  new_die->num_attrs = abbrev_table[new_die->abbrev].num_attrs;
-	  fill_in_die_info (new_die, die_len, die_bytes, d_ptr, abbrev_table, db);
-	}
+	new_die = db_build_die (type_id,
+				(uint8_t *) sqlite3_column_blob (db_stmt1, 0),
+				sqlite3_column_bytes (db_stmt1, 0),
+				abbrev_table, db);
       else if (db_status != SQLITE_OK && db_status != SQLITE_DONE)
 	db_error ("db_lookup_type", "sqlite3_step failed", db);
 
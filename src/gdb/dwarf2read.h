@@ -9,6 +9,10 @@ extern asection *dwarf_eh_frame_section;
 /* APPLE LOCAL debug map take a bfd parameter */
 char *dwarf2_read_section (struct objfile *, bfd *, asection *);
 
+/* APPLE LOCAL compressed debug sections: The size of a debug section's
+   contents once uncompressed.  */
+bfd_size_type dwarf2_section_size (bfd *, asection *);
+
 /* When expanding a psymtab to a symtab we get the
    addresses of all the symbols in the executable (the "final"
    addresses) and the minimal symbols (linker symbols, etc) from
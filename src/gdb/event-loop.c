@@ -39,6 +39,30 @@
 #include <sys/time.h>
 #include "exceptions.h"
 #include "gdb_assert.h"
+/* APPLE LOCAL begin kernel event queue */
+#include "gdbcmd.h"
+
+/* Where the kernel offers an event queue, the event loop can keep its
+   file descriptors registered there instead of handing the whole set
+   to select on every trip around the loop.  kqueue is preferred,
+   since it is what Darwin has.  */
+#if defined (HAVE_KQUEUE) && defined (HAVE_SYS_EVENT_H)
+#include <sys/event.h>
+#define USE_KQUEUE 1
+#elif defined (HAVE_EPOLL_CREATE) && defined (HAVE_SYS_EPOLL_H)
+#include <sys/epoll.h>
+#define USE_EPOLL 1
+#endif
+
+#if defined (USE_KQUEUE) || defined (USE_EPOLL)
+#define HAVE_KERNEL_QUEUE 1
+#include <fcntl.h>
+#include <unistd.h>
+
+/* Most events gdb_wait_for_event collects from the queue at once.  */
+#define KERNEL_QUEUE_EVENTS 16
+#endif
+/* APPLE LOCAL end kernel event queue */
 
 typedef struct gdb_event gdb_event;
 /* APPLE LOCAL async make globally visible */
@@ -186,9 +210,30 @@ static struct
 
     /* Flag to tell whether the timeout should be used. */
     int timeout_valid;
+
+    /* APPLE LOCAL begin kernel event queue */
+#ifdef HAVE_KERNEL_QUEUE
+    /* Nonzero if KERNEL_QUEUE_FD is a kqueue or epoll instance that
+       every handler above is registered with.  The select masks are
+       kept up to date regardless, so we can fall back on them.  */
+    int kernel_queue_open;
+    int kernel_queue_fd;
+
+    /* Nonzero if the queue couldn't be created or refused one of our
+       descriptors; we stick with select until the setting is
+       changed.  */
+    int kernel_queue_failed;
+#endif
+    /* APPLE LOCAL end kernel event queue */
   }
 gdb_notifier;
 
+/* APPLE LOCAL begin kernel event queue */
+/* Whether to wait for events with the kernel's event queue rather
+   than with select.  */
+static int event_loop_kernel_queue = 0;
+/* APPLE LOCAL end kernel event queue */
+
 /* Structure associated with a timer. PROC will be executed at the
    first occasion after WHEN. */
 struct gdb_timer
@@ -247,6 +292,12 @@ static int process_event (void);
 /* APPLE LOCAL async */
 static void handle_timer_event (void *dummy);
 static void poll_timers (void);
+/* APPLE LOCAL begin kernel event queue */
+#ifdef HAVE_KERNEL_QUEUE
+static int kernel_queue_update (int fd, int old_mask, int new_mask);
+static void kernel_queue_abandon (void);
+#endif
+/* APPLE LOCAL end kernel event queue */
 
 /* APPLE LOCAL begin async */
 void
@@ -636,6 +687,14 @@ create_file_handler (int fd, int mask, handler_func * proc, gdb_client_data clie
 
 	  if (gdb_notifier.num_fds <= fd)
 	    gdb_notifier.num_fds = fd + 1;
+
+	  /* APPLE LOCAL begin kernel event queue */
+#ifdef HAVE_KERNEL_QUEUE
+	  if (gdb_notifier.kernel_queue_open
+	      && !kernel_queue_update (fd, 0, mask))
+	    kernel_queue_abandon ();
+#endif
+	  /* APPLE LOCAL end kernel event queue */
 	}
     }
 
@@ -704,6 +763,13 @@ delete_file_handler (int fd)
       if (file_ptr->mask & GDB_EXCEPTION)
 	FD_CLR (fd, &gdb_notifier.check_masks[2]);
 
+      /* APPLE LOCAL begin kernel event queue */
+#ifdef HAVE_KERNEL_QUEUE
+      if (gdb_notifier.kernel_queue_open)
+	kernel_queue_update (fd, file_ptr->mask, 0);
+#endif
+      /* APPLE LOCAL end kernel event queue */
+
       /* Find current max fd. */
 
       if ((fd + 1) == gdb_notifier.num_fds)
@@ -901,6 +967,225 @@ gdb_select (int n, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
 #endif
 }
 
+/* APPLE LOCAL begin kernel event queue */
+#ifdef HAVE_KERNEL_QUEUE
+
+/* Close the kernel queue, if it is open.  The handlers stay in the
+   select masks, so nothing is lost.  */
+
+static void
+kernel_queue_close (void)
+{
+  if (!gdb_notifier.kernel_queue_open)
+    return;
+  close (gdb_notifier.kernel_queue_fd);
+  gdb_notifier.kernel_queue_open = 0;
+}
+
+/* The kernel queue let us down.  Close it and use select from now
+   on, the way add_file_handler gives up on poll for descriptors it
+   can't handle.  */
+
+static void
+kernel_queue_abandon (void)
+{
+  kernel_queue_close ();
+  gdb_notifier.kernel_queue_failed = 1;
+}
+
+/* Change what the kernel queue watches FD for from OLD_MASK to
+   NEW_MASK, both combinations of GDB_READABLE, GDB_WRITABLE and
+   GDB_EXCEPTION.  Return zero if the queue wouldn't take FD.  Removing
+   a descriptor always succeeds: the kernel forgets closed descriptors
+   by itself, so a failure there means nothing.  */
+
+static int
+kernel_queue_update (int fd, int old_mask, int new_mask)
+{
+#ifdef USE_KQUEUE
+  struct kevent changes[2];
+  int num_changes = 0;
+
+  /* kqueue has no filter for select's exceptional conditions; an
+     error or hangup is reported as the descriptor being readable,
+     which is what select does too.  */
+  if ((old_mask ^ new_mask) & GDB_READABLE)
+    {
+      EV_SET (&changes[num_changes], fd, EVFILT_READ,
+	      (new_mask & GDB_READABLE) ? EV_ADD : EV_DELETE, 0, 0, 0);
+      num_changes++;
+    }
+  if ((old_mask ^ new_mask) & GDB_WRITABLE)
+    {
+      EV_SET (&changes[num_changes], fd, EVFILT_WRITE,
+	      (new_mask & GDB_WRITABLE) ? EV_ADD : EV_DELETE, 0, 0, 0);
+      num_changes++;
+    }
+  if (num_changes == 0)
+    return 1;
+  if (kevent (gdb_notifier.kernel_queue_fd, changes, num_changes,
+	      NULL, 0, NULL) == 0)
+    return 1;
+  return new_mask == 0;
+#else
+  struct epoll_event event;
+
+  if (new_mask == 0)
+    {
+      /* Old kernels insist on a non-NULL event even here.  */
+      epoll_ctl (gdb_notifier.kernel_queue_fd, EPOLL_CTL_DEL, fd, &event);
+      return 1;
+    }
+
+  memset (&event, 0, sizeof (event));
+  if (new_mask & GDB_READABLE)
+    event.events |= EPOLLIN;
+  if (new_mask & GDB_WRITABLE)
+    event.events |= EPOLLOUT;
+  if (new_mask & GDB_EXCEPTION)
+    event.events |= EPOLLPRI;
+  event.data.fd = fd;
+
+  if (epoll_ctl (gdb_notifier.kernel_queue_fd,
+		 old_mask == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD,
+		 fd, &event) == 0)
+    return 1;
+  /* Someone may have registered FD again without deleting it first.  */
+  if (old_mask == 0 && errno == EEXIST
+      && epoll_ctl (gdb_notifier.kernel_queue_fd, EPOLL_CTL_MOD,
+		    fd, &event) == 0)
+    return 1;
+  /* Most likely FD is a plain file, which epoll won't watch.  */
+  return 0;
+#endif
+}
+
+/* Return nonzero if gdb_wait_for_event should use the kernel queue,
+   creating it and registering all the current handlers with it if
+   this is the first time.  */
+
+static int
+kernel_queue_ready (void)
+{
+  file_handler *file_ptr;
+  int fd;
+
+  if (!event_loop_kernel_queue || use_poll
+      || gdb_notifier.kernel_queue_failed)
+    return 0;
+  if (gdb_notifier.kernel_queue_open)
+    return 1;
+
+#ifdef USE_KQUEUE
+  fd = kqueue ();
+#else
+  fd = epoll_create (KERNEL_QUEUE_EVENTS);
+#endif
+  if (fd < 0)
+    {
+      gdb_notifier.kernel_queue_failed = 1;
+      return 0;
+    }
+  /* Don't leak the queue into the inferior.  */
+  fcntl (fd, F_SETFD, FD_CLOEXEC);
+
+  gdb_notifier.kernel_queue_fd = fd;
+  gdb_notifier.kernel_queue_open = 1;
+
+  for (file_ptr = gdb_notifier.first_file_handler; file_ptr != NULL;
+       file_ptr = file_ptr->next_file)
+    if (!kernel_queue_update (file_ptr->fd, 0, file_ptr->mask))
+      {
+	kernel_queue_abandon ();
+	return 0;
+      }
+  return 1;
+}
+
+/* Wait on the kernel queue the way gdb_wait_for_event waits in
+   select, using the same timeout, and queue an event for each
+   descriptor that became ready.  Return -1 if the queue itself failed
+   and the caller should wait with select instead, 0 otherwise.  */
+
+static int
+kernel_queue_wait (void)
+{
+  file_handler *file_ptr;
+  gdb_event *file_event_ptr;
+  int num_found;
+  int i;
+#ifdef USE_KQUEUE
+  struct kevent events[KERNEL_QUEUE_EVENTS];
+  struct timespec timeout;
+
+  timeout.tv_sec = gdb_notifier.select_timeout.tv_sec;
+  timeout.tv_nsec = gdb_notifier.select_timeout.tv_usec * 1000;
+  num_found = kevent (gdb_notifier.kernel_queue_fd, NULL, 0,
+		      events, KERNEL_QUEUE_EVENTS,
+		      gdb_notifier.timeout_valid ? &timeout : NULL);
+#else
+  struct epoll_event events[KERNEL_QUEUE_EVENTS];
+  int timeout = -1;
+
+  /* Round up, so a timer due in less than a millisecond doesn't turn
+     into a busy loop.  */
+  if (gdb_notifier.timeout_valid)
+    timeout = (gdb_notifier.select_timeout.tv_sec * 1000
+	       + (gdb_notifier.select_timeout.tv_usec + 999) / 1000);
+  num_found = epoll_wait (gdb_notifier.kernel_queue_fd,
+			  events, KERNEL_QUEUE_EVENTS, timeout);
+#endif
+
+  if (num_found == -1)
+    /* Don't print anything if we got a signal, let gdb handle it.  */
+    return errno == EINTR ? 0 : -1;
+
+  for (i = 0; i < num_found; i++)
+    {
+      int fd;
+      int mask = 0;
+
+#ifdef USE_KQUEUE
+      fd = (int) events[i].ident;
+      if (events[i].filter == EVFILT_READ)
+	mask = GDB_READABLE;
+      else if (events[i].filter == EVFILT_WRITE)
+	mask = GDB_WRITABLE;
+#else
+      fd = events[i].data.fd;
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+	mask |= GDB_READABLE;
+      if (events[i].events & EPOLLOUT)
+	mask |= GDB_WRITABLE;
+      if (events[i].events & EPOLLPRI)
+	mask |= GDB_EXCEPTION;
+#endif
+
+      for (file_ptr = gdb_notifier.first_file_handler; file_ptr != NULL;
+	   file_ptr = file_ptr->next_file)
+	if (file_ptr->fd == fd)
+	  break;
+
+      /* The handler may have been deleted by a descriptor that was
+	 closed and reused; only report what it still asks for.  */
+      if (file_ptr == NULL || (mask & file_ptr->mask) == 0)
+	continue;
+
+      /* Enqueue an event only if this is still a new event for this
+	 fd.  kqueue reports reading and writing separately, so
+	 accumulate the mask.  */
+      if (file_ptr->ready_mask == 0)
+	{
+	  file_event_ptr = create_file_event (file_ptr->fd);
+	  async_queue_event (file_event_ptr, TAIL);
+	}
+      file_ptr->ready_mask |= mask;
+    }
+  return 0;
+}
+#endif /* HAVE_KERNEL_QUEUE */
+/* APPLE LOCAL end kernel event queue */
+
 /* Called by gdb_do_one_event to wait for new events on the 
    monitored file descriptors. Queue file events as they are 
    detected by the poll. 
@@ -923,6 +1208,19 @@ gdb_wait_for_event (void)
   if (gdb_notifier.num_fds == 0)
     return -1;
 
+  /* APPLE LOCAL begin kernel event queue */
+#ifdef HAVE_KERNEL_QUEUE
+  if (kernel_queue_ready ())
+    {
+      if (kernel_queue_wait () == 0)
+	return 0;
+      /* The queue itself failed; forget about it and wait in select
+	 as we would have without it.  */
+      kernel_queue_abandon ();
+    }
+#endif
+  /* APPLE LOCAL end kernel event queue */
+
   if (use_poll)
     {
 #ifdef HAVE_POLL
@@ -1370,3 +1668,50 @@ poll_timers (void)
   else
     gdb_notifier.timeout_valid = 0;
 }
+
+/* APPLE LOCAL begin kernel event queue */
+static void
+set_event_loop_kernel_queue (char *args, int from_tty,
+			     struct cmd_list_element *c)
+{
+#ifdef HAVE_KERNEL_QUEUE
+  /* Start over with a fresh queue, or none at all.  */
+  kernel_queue_close ();
+  gdb_notifier.kernel_queue_failed = 0;
+#endif
+}
+
+static void
+show_event_loop_kernel_queue (struct ui_file *file, int from_tty,
+			      struct cmd_list_element *c, const char *value)
+{
+#ifdef HAVE_KERNEL_QUEUE
+  fprintf_filtered (file, _("\
+Waiting for events with the kernel event queue is %s%s.\n"),
+		    value,
+		    event_loop_kernel_queue && gdb_notifier.kernel_queue_failed
+		    ? _(" (but select is being used)") : "");
+#else
+  fprintf_filtered (file, _("\
+Waiting for events with the kernel event queue is %s \
+(not available on this host).\n"),
+		    value);
+#endif
+}
+
+void
+_initialize_event_loop (void)
+{
+  add_setshow_boolean_cmd ("event-loop-kernel-queue", class_obscure,
+			   &event_loop_kernel_queue, _("\
+Set whether the event loop waits with kqueue or epoll instead of select."), _("\
+Show whether the event loop waits with kqueue or epoll instead of select."), _("\
+When on, the descriptors the event loop listens to are kept registered\n\
+with the kernel's event queue, so waiting costs the same however many\n\
+of them there are.  GDB goes back to select if the queue refuses one\n\
+of the descriptors."),
+			   set_event_loop_kernel_queue,
+			   show_event_loop_kernel_queue,
+			   &setlist, &showlist);
+}
+/* APPLE LOCAL end kernel event queue */
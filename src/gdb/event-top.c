@@ -32,6 +32,8 @@
 #include "interps.h"
 #include <signal.h>
 #include "exceptions.h"
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
 
 /* For dont_repeat() */
 #include "gdbcmd.h"
@@ -551,6 +553,8 @@ command_handler (char *command)
     quit_command ((char *) 0, stdin == instream);
 
   time_at_cmd_start = get_run_time ();
+  /* APPLE LOCAL gdb stats  */
+  gdb_stats_command_start ();
 
   if (display_space)
     {
@@ -609,6 +613,8 @@ command_handler (char *command)
 			     space_diff);
 #endif
 	}
+      /* APPLE LOCAL gdb stats  */
+      gdb_stats_command_end ();
     }
 }
 
@@ -647,6 +653,8 @@ command_line_handler_continuation (struct continuation_arg *arg)
 			 space_diff);
 #endif
     }
+  /* APPLE LOCAL gdb stats  */
+  gdb_stats_command_end ();
 }
 
 /* Handle a complete line of input. This is called by the callback
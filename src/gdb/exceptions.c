@@ -31,6 +31,8 @@
 #include "gdb_assert.h"
 #include "gdb_string.h"
 #include "serial.h"
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
 
 const struct gdb_exception exception_none = { 0, NO_ERROR, NULL };
 
@@ -63,6 +65,8 @@ struct catcher
   int mask;
   struct ui_out *saved_uiout;
   struct cleanup *saved_cleanup_chain;
+  /* APPLE LOCAL gdb stats  */
+  unsigned int saved_stats_active;
   /* Back link.  */
   struct catcher *prev;
 };
@@ -93,6 +97,9 @@ exceptions_state_mc_init (struct ui_out *func_uiout,
      prior to here. */
   new_catcher->saved_cleanup_chain = save_cleanups ();
 
+  /* APPLE LOCAL gdb stats: An error may unwind past running timers.  */
+  new_catcher->saved_stats_active = gdb_stats_active;
+
   /* Push this new catcher on the top.  */
   new_catcher->prev = current_catcher;
   current_catcher = new_catcher;
@@ -114,6 +121,9 @@ catcher_pop (void)
 
   uiout = old_catcher->saved_uiout;
 
+  /* APPLE LOCAL gdb stats  */
+  gdb_stats_active = old_catcher->saved_stats_active;
+
   xfree (old_catcher);
 }
 
@@ -379,6 +379,12 @@ struct expression
 
 extern struct expression *parse_expression (char *);
 
+/* APPLE LOCAL begin expression cache  */
+extern struct expression *parse_expression_cached (char *);
+
+extern void parsed_expression_cache_flush (void);
+/* APPLE LOCAL end expression cache  */
+
 extern struct expression *parse_expression_in_context (char *, int);
 
 extern struct expression *parse_exp_1 (char **, struct block *, int);
@@ -58,6 +58,8 @@
 #include "osabi.h"
 #include "exceptions.h"
 #include "filenames.h"
+/* APPLE LOCAL prologue analysis cache  */
+#include "prologue-memo.h"
 
 #if defined (TARGET_I386)
 #include "i386-tdep.h"
@@ -269,11 +271,17 @@ void do_final_fix_fixups_global_syms (struct block *newglobals, struct objfile *
 
 static void do_final_fix_fixups_static_syms (struct block *newstatics, struct objfile *oldobj, struct fixinfo *curfixinfo);
 
+/* APPLE LOCAL fix and continue name index  */
+static struct block *find_fixed_file_block (struct objfile *, 
+                                            struct fixinfo *, int);
+
 static void pre_load_and_check_file (struct fixinfo *);
 
 static void force_psymtab_expansion (struct objfile *, const char *, const char *);
 
-static void expand_all_objfile_psymtabs (struct objfile *);
+/* APPLE LOCAL fix and continue name index  */
+static struct symbol *expand_psymtabs_defining (struct objfile *,
+                                                struct symbol *);
 
 static void free_active_threads_struct (struct active_threads *);
 
@@ -895,6 +903,34 @@ redirect_file_statics (struct fixinfo *cur)
   do_cleanups (wipe);
 }
 
+/* APPLE LOCAL begin fix and continue name index  */
+/* One LOC_STATIC symbol of the just-loaded objfile, keyed by address.
+   SEQ remembers the order the symbols were found in, so that the sort
+   is stable and, among several symbols at the same address, the first
+   one found wins.  */
+
+struct static_sym_addr {
+  CORE_ADDR addr;
+  int seq;
+  struct symbol *sym;
+};
+
+static int
+compare_static_sym_addr (const void *a, const void *b)
+{
+  const struct static_sym_addr *x = a;
+  const struct static_sym_addr *y = b;
+
+  if (x->addr != y->addr)
+    return x->addr < y->addr ? -1 : 1;
+  return x->seq - y->seq;
+}
+
+/* Match each indirect pointer's target address against the static
+   data symbols of the fixed file.  Rather than rescanning every block
+   of the fixed objfile for each pointer, collect the candidates once,
+   sort them by address, and binary search.  */
+
 static void
 find_new_static_symbols (struct fixinfo *cur, 
                          struct file_static_fixups *indirect_entries,
@@ -903,60 +939,80 @@ find_new_static_symbols (struct fixinfo *cur,
   struct symtab *symtab;
   struct block *b;
   struct symbol *sym;
-  int j;
+  int j, k, bl;
   struct dict_iterator i;
   struct objfile *most_recent_fix_objfile;
+  struct static_sym_addr *syms;
+  struct cleanup *wipe;
+  int nsyms = 0, allocated = 64;
 
   most_recent_fix_objfile = find_objfile_by_name 
                                   (cur->most_recent_fix->bundle_filename, 1);
+  if (most_recent_fix_objfile == NULL)
+    return;
 
-   for (j = 0; j < indirect_entry_count; j++)
-     {
-       CORE_ADDR addr = indirect_entries[j].value;
-       int matched = 0;
- 
-       ALL_OBJFILE_SYMTABS (most_recent_fix_objfile, symtab)
-         {
-           if (symtab->primary != 1)
-             continue;
- 
-           b = BLOCKVECTOR_BLOCK (BLOCKVECTOR (symtab), STATIC_BLOCK);
-           ALL_BLOCK_SYMBOLS (b, i, sym)
-             {
-               if (SYMBOL_CLASS (sym) == LOC_STATIC && 
-                   SYMBOL_VALUE_ADDRESS (sym) == addr)
-                 {
-                   indirect_entries[j].new_sym = sym;
-                   matched = 1;
-                   break;
-                 }
-             }
-           if (!matched)
-             {
- 
-               b = BLOCKVECTOR_BLOCK (BLOCKVECTOR (symtab), GLOBAL_BLOCK);
-               ALL_BLOCK_SYMBOLS (b, i, sym)
-                 {
-                   if (SYMBOL_CLASS (sym) == LOC_STATIC && 
-                       SYMBOL_VALUE_ADDRESS (sym) == addr)
-                    {
-                       indirect_entries[j].new_sym = sym;
-                       matched = 1;
-                       break;
-                     }
-                 }
-              }
- 
-           if (matched)
-             {
-               indirect_entries[j].new_msym =
-                  lookup_minimal_symbol
-                        (SYMBOL_LINKAGE_NAME (indirect_entries[j].new_sym),
-                        NULL, most_recent_fix_objfile);
-             }
-         }
+  syms = xmalloc (allocated * sizeof (struct static_sym_addr));
+
+  /* A linear scan looked at each symtab's static block before its
+     global block, so collect them in that order.  */
+  ALL_OBJFILE_SYMTABS (most_recent_fix_objfile, symtab)
+    {
+      if (symtab->primary != 1)
+        continue;
+
+      for (bl = 0; bl < 2; bl++)
+        {
+          b = BLOCKVECTOR_BLOCK (BLOCKVECTOR (symtab), 
+                                 bl == 0 ? STATIC_BLOCK : GLOBAL_BLOCK);
+          ALL_BLOCK_SYMBOLS (b, i, sym)
+            {
+              if (SYMBOL_CLASS (sym) != LOC_STATIC)
+                continue;
+              if (nsyms == allocated)
+                {
+                  allocated *= 2;
+                  syms = xrealloc (syms, 
+                                   allocated * sizeof (struct static_sym_addr));
+                }
+              syms[nsyms].addr = SYMBOL_VALUE_ADDRESS (sym);
+              syms[nsyms].seq = nsyms;
+              syms[nsyms].sym = sym;
+              nsyms++;
+            }
+        }
     }
+
+  wipe = make_cleanup (xfree, syms);
+  qsort (syms, nsyms, sizeof (struct static_sym_addr), 
+         compare_static_sym_addr);
+
+  for (j = 0; j < indirect_entry_count; j++)
+    {
+      CORE_ADDR addr = indirect_entries[j].value;
+      int lo = 0, hi = nsyms;
+
+      /* Find the first candidate at ADDR.  */
+      while (lo < hi)
+        {
+          k = lo + (hi - lo) / 2;
+          if (syms[k].addr < addr)
+            lo = k + 1;
+          else
+            hi = k;
+        }
+      if (lo == nsyms || syms[lo].addr != addr)
+        continue;
+
+      indirect_entries[j].new_sym = syms[lo].sym;
+      indirect_entries[j].new_msym =
+         lookup_minimal_symbol
+               (SYMBOL_LINKAGE_NAME (indirect_entries[j].new_sym),
+               NULL, most_recent_fix_objfile);
+    }
+
+  do_cleanups (wipe);
 }
+/* APPLE LOCAL end fix and continue name index  */
 
 static void
 find_orig_static_symbols (struct fixinfo *cur, 
@@ -1238,6 +1294,27 @@ build_list_of_objfiles_to_update (struct fixinfo *cur)
 }
 
 
+/* APPLE LOCAL begin fix and continue name index  */
+/* Return the BLOCK_INDEX block of OLDOBJ's symtab for the source file
+   being fixed, or NULL if OLDOBJ has no such symtab.  */
+
+static struct block *
+find_fixed_file_block (struct objfile *oldobj, struct fixinfo *cur, 
+                       int block_index)
+{
+  struct symtab *s;
+
+  if (cur->canonical_source_filename == NULL)
+    return NULL;
+
+  s = find_symtab_by_name (oldobj, cur->canonical_source_filename);
+  if (s == NULL || BLOCKVECTOR (s) == NULL)
+    return NULL;
+
+  return BLOCKVECTOR_BLOCK (BLOCKVECTOR (s), block_index);
+}
+/* APPLE LOCAL end fix and continue name index  */
+
 /* Look for function names in the global scope of a just-loaded object file.
    When found, try to find that same function name in the old object file,
    and stomp on that function's prologue if found.  */
@@ -1253,6 +1330,14 @@ do_final_fix_fixups_global_syms (struct block *newglobals,
   struct symbol *oldsym = NULL;
   struct dict_iterator j;
   struct symbol *cursym, *newsym;         
+  /* APPLE LOCAL fix and continue name index  */
+  struct block *oldfileblock;
+
+  if (!oldobj)
+    return;
+
+  /* APPLE LOCAL fix and continue name index  */
+  oldfileblock = find_fixed_file_block (oldobj, curfixinfo, GLOBAL_BLOCK);
 
   ALL_BLOCK_SYMBOLS (newglobals, j, cursym)
     {
@@ -1262,9 +1347,17 @@ do_final_fix_fixups_global_syms (struct block *newglobals,
       if (!newsym || SYMBOL_CLASS (newsym) == LOC_TYPEDEF)
         continue;
 
-      if (!oldobj)
-        continue;
-
+      /* APPLE LOCAL begin fix and continue name index  */
+      /* Nearly everything the fixed file defines was defined by the 
+         same file last time around, so look there before trying every
+         symtab in the objfile.  */
+      oldsym = NULL;
+      if (oldfileblock != NULL && oldfileblock != newglobals)
+        oldsym = lookup_block_symbol (oldfileblock, 
+                       SYMBOL_PRINT_NAME (cursym), 
+                       SYMBOL_LINKAGE_NAME (cursym), VAR_DOMAIN);
+      if (!oldsym)
+      /* APPLE LOCAL end fix and continue name index  */
       ALL_OBJFILE_SYMTABS_INCL_OBSOLETED (oldobj, oldsymtab)
         {
           /* All code-less symtabs will have links to a single codeful
@@ -1320,9 +1413,15 @@ do_final_fix_fixups_static_syms (struct block *newstatics,
   struct symbol *cursym, *newsym;         
   struct objfile *original_objfile = find_original_object_file (curfixinfo);
 
+  /* APPLE LOCAL fix and continue name index  */
+  struct block *oldfileblock;
+
   if (!oldobj)
     return;
 
+  /* APPLE LOCAL fix and continue name index  */
+  oldfileblock = find_fixed_file_block (oldobj, curfixinfo, STATIC_BLOCK);
+
   ALL_BLOCK_SYMBOLS (newstatics, j, cursym)
     {
       newsym = lookup_block_symbol (newstatics, SYMBOL_PRINT_NAME (cursym),
@@ -1336,6 +1435,14 @@ do_final_fix_fixups_static_syms (struct block *newstatics,
           || TYPE_CODE (SYMBOL_TYPE (newsym)) != TYPE_CODE_FUNC)
         continue;
 
+      /* APPLE LOCAL begin fix and continue name index  */
+      oldsym = NULL;
+      if (oldfileblock != NULL && oldfileblock != newstatics)
+        oldsym = lookup_block_symbol (oldfileblock, 
+                       SYMBOL_PRINT_NAME (cursym), 
+                       SYMBOL_LINKAGE_NAME (cursym), VAR_DOMAIN);
+      if (!oldsym)
+      /* APPLE LOCAL end fix and continue name index  */
       ALL_OBJFILE_SYMTABS_INCL_OBSOLETED (oldobj, oldsymtab)
         {
           /* All code-less symtabs will have links to a single codeful
@@ -1969,17 +2076,51 @@ force_psymtab_expansion (struct objfile *obj, const char *source_fn,
       PSYMTAB_TO_SYMTAB (ps);
 }
 
-/* Expand all partial symtabs for all source files in an objfile (application,
-   library).  In C++, coalesced symbols will end up in an arbitrary symtab,
-   so we'll need to expand all of them to find it.  */
+/* APPLE LOCAL begin fix and continue name index  */
+/* In C++, coalesced symbols will end up in an arbitrary symtab of an
+   objfile (application, library).  Rather than expanding every partial
+   symtab to find it, use the sorted partial symbol lists to find the
+   psymtabs that mention SYM's name, expand just those, and look for
+   SYM in their blocks.  */
 
-static void
-expand_all_objfile_psymtabs (struct objfile *obj)
+static struct symbol *
+expand_psymtabs_defining (struct objfile *obj, struct symbol *sym)
 {
   struct partial_symtab *pst;
+  struct symtab *s;
+  struct symbol *found;
+  const char *name = SYMBOL_SEARCH_NAME (sym);
+
   ALL_OBJFILE_PSYMTABS_INCL_OBSOLETED (obj, pst)
-    PSYMTAB_TO_SYMTAB (pst);
+    {
+      if (lookup_partial_symbol (pst, name, NULL, 1, SYMBOL_DOMAIN (sym)) 
+          == NULL
+          && lookup_partial_symbol (pst, name, NULL, 0, SYMBOL_DOMAIN (sym))
+             == NULL)
+        continue;
+
+      s = PSYMTAB_TO_SYMTAB (pst);
+      if (s == NULL || BLOCKVECTOR (s) == NULL)
+        continue;
+
+      found = lookup_block_symbol (BLOCKVECTOR_BLOCK (BLOCKVECTOR (s), 
+                                                      STATIC_BLOCK),
+                                   SYMBOL_PRINT_NAME (sym),
+                                   SYMBOL_LINKAGE_NAME (sym), 
+                                   SYMBOL_DOMAIN (sym));
+      if (found == NULL)
+        found = lookup_block_symbol (BLOCKVECTOR_BLOCK (BLOCKVECTOR (s), 
+                                                        GLOBAL_BLOCK),
+                                     SYMBOL_PRINT_NAME (sym),
+                                     SYMBOL_LINKAGE_NAME (sym), 
+                                     SYMBOL_DOMAIN (sym));
+      if (found != NULL)
+        return found;
+    }
+
+  return NULL;
 }
+/* APPLE LOCAL end fix and continue name index  */
 
 
 /* Returns 1 if the file is found.  0 if error or not found.  
@@ -2156,6 +2297,10 @@ redirect_old_function (struct fixinfo *fixinfo, struct symbol *new_sym,
   target_write_memory (oldfuncstart, buf, 6);
 #endif
 
+  /* APPLE LOCAL prologue analysis cache: OLD_SYM's prologue is no
+     longer what we scanned.  */
+  prologue_memo_invalidate ();
+
   SYMBOL_OBSOLETED (old_sym) = 1;
   msym = lookup_minimal_symbol_by_pc (oldfuncstart);
   if (msym)
@@ -2326,10 +2471,8 @@ find_symtab_by_name (struct objfile *obj, const char *name)
    each source file symtab is its own objfile, and each one will have its
    own copy of all these coalesced items.  
 
-   FIXME: I'm searching the minsyms right now, but it would be more
-   reliable to base this off of the partial symtabs.  symtab.c
-   doesn't expose either of the two psymtab-searching functions
-   globally, though, so for now I'll just use minsyms.
+   The minsyms tell us cheaply whether the symbol is in OBJ at all;
+   the partial symtabs then tell us which symtabs to expand.
   */
 
 static struct symbol *
@@ -2340,11 +2483,11 @@ search_for_coalesced_symbol (struct objfile *obj, struct symbol *sym)
   minsym = lookup_minimal_symbol (SYMBOL_LINKAGE_NAME (sym), 0, obj);
   if (minsym)
     {
-      /* It's in there somewhere... expand symtabs and re-search. */
-      expand_all_objfile_psymtabs (obj);
-
-      return (lookup_symbol (SYMBOL_LINKAGE_NAME (sym), NULL,
-                              SYMBOL_DOMAIN (sym), NULL, NULL));
+      /* APPLE LOCAL begin fix and continue name index  */
+      /* It's in there somewhere... expand the symtabs that define
+         it and re-search.  */
+      return expand_psymtabs_defining (obj, sym);
+      /* APPLE LOCAL end fix and continue name index  */
     }
 
   return (NULL);
@@ -81,6 +81,76 @@ escape_bang_in_quoted_argument (const char *shell_file)
   return 0;
 }
 
+/* APPLE LOCAL begin start with shell */
+/* Non-zero if the last fork_inferior started the program through a
+   shell, so the shell's exec will stop the program before its own.  */
+
+int startup_used_shell;
+
+#ifdef USE_POSIX_SPAWN
+/* If non-zero, "start-with-shell" only goes through the shell when
+   the program's arguments need something that only a shell does.
+   Otherwise the program is spawned directly; buildargv splits the
+   arguments the way the shell would, and posix_spawn picks the
+   architecture that "arch" would have.  */
+
+static int start_with_shell_only_if_needed = 1;
+
+static void
+show_start_with_shell_only_if_needed (struct ui_file *file, int from_tty,
+				      struct cmd_list_element *c,
+				      const char *value)
+{
+  fprintf_filtered (file, _("\
+Using the shell only when the arguments need it is %s.\n"),
+		    value);
+}
+
+/* Return non-zero if ALLARGS has anything in it that the shell would
+   expand or act on: variables, globs, redirections, pipes, command
+   lists and so on.  Plain words and simple quoting don't count.  */
+
+static int
+inferior_args_need_shell (const char *allargs)
+{
+  const char *p;
+
+  if (allargs == NULL)
+    return 0;
+
+  for (p = allargs; *p != '\0'; p++)
+    switch (*p)
+      {
+      case '$':
+      case '`':
+      case '\\':
+      case '*':
+      case '?':
+      case '[':
+      case ']':
+      case '{':
+      case '}':
+      case '~':
+      case '<':
+      case '>':
+      case '|':
+      case '&':
+      case ';':
+      case '(':
+      case ')':
+      case '!':
+      case '#':
+      case '^':
+      case '\n':
+	return 1;
+      default:
+	break;
+      }
+  return 0;
+}
+#endif
+/* APPLE LOCAL end start with shell */
+
 /* Start an inferior Unix child process and sets inferior_ptid to its
    pid.  EXEC_FILE is the file to run.  ALLARGS is a string containing
    the arguments to the program.  ENV is the environment vector to
@@ -121,7 +191,16 @@ fork_inferior (char *exec_file_arg, char *allargs, char **env,
    * bother figuring out what shell.
    */
   shell_file = shell_file_arg;
-  if (start_with_shell_flag)
+  /* APPLE LOCAL begin start with shell: Skip the shell if it would
+     only exec the program.  A caller that names a shell gets it.  */
+  if (start_with_shell_flag
+#ifdef USE_POSIX_SPAWN
+      && (shell_file_arg != NULL
+	  || !start_with_shell_only_if_needed
+	  || inferior_args_need_shell (allargs))
+#endif
+      )
+    /* APPLE LOCAL end start with shell */
     {
       /* Figure out what shell to start up the user program under.  */
       if (shell_file == NULL)
@@ -152,6 +231,9 @@ fork_inferior (char *exec_file_arg, char *allargs, char **env,
   shell_command[0] = '\0';
 #endif
 
+  /* APPLE LOCAL start with shell  */
+  startup_used_shell = shell;
+
   if (!shell)
     {
       unsigned int i;
@@ -704,5 +786,17 @@ Set if GDB should use shell to invoke inferior (performs argument expansion in s
 Show if GDB should use shell to invoke inferior (performs argument expansion in shell)."), NULL,
 			   NULL, NULL,
 			   &setlist, &showlist);
+
+#ifdef USE_POSIX_SPAWN
+  add_setshow_boolean_cmd ("start-with-shell-only-if-needed", class_obscure,
+			   &start_with_shell_only_if_needed, _("\
+Set if GDB should only use the shell when the inferior's arguments need it."), _("\
+Show if GDB should only use the shell when the inferior's arguments need it."), _("\
+When on, and start-with-shell is on, an inferior whose arguments have no\n\
+variables, globs, redirections or other shell syntax in them is spawned\n\
+directly, which saves starting the shell and stopping at its exec."),
+			   NULL, show_start_with_shell_only_if_needed,
+			   &setlist, &showlist);
+#endif
 }
 /* APPLE LOCAL end start with shell */
@@ -27,6 +27,11 @@
 #include "gdb_obstack.h"
 /* APPLE LOCAL - subroutine inlining  */
 #include "inlining.h"
+/* APPLE LOCAL begin unwinder cache  */
+#include "objfiles.h"
+#include "gdbcmd.h"
+#include "gdb_string.h"
+/* APPLE LOCAL end unwinder cache  */
 
 static struct gdbarch_data *frame_unwind_data;
 
@@ -91,28 +96,181 @@ frame_unwind_prepend_unwinder (struct gdbarch *gdbarch,
   (*table->osabi_head) = entry;
 }
 
+/* APPLE LOCAL begin unwinder cache  */
+/* Return the unwinder ENTRY offers for the frame before NEXT_FRAME,
+   or NULL if it doesn't apply.  */
+
+static const struct frame_unwind *
+frame_unwind_try_entry (struct frame_unwind_table_entry *entry,
+			struct frame_info *next_frame, void **this_cache)
+{
+  if (entry->sniffer != NULL)
+    {
+      const struct frame_unwind *desc = NULL;
+      desc = entry->sniffer (next_frame);
+      if (desc != NULL)
+	return desc;
+    }
+  if (entry->unwinder != NULL)
+    {
+      if (entry->unwinder->sniffer (entry->unwinder, next_frame,
+				    this_cache))
+	return entry->unwinder;
+    }
+  return NULL;
+}
+
+/* The sniffers after the dummy and inlined ones look at nothing but
+   the frame's pc and the code around it, so the one that claimed a
+   pc last time will claim it again.  Remember it per objfile, keyed
+   by the pc and the kind of frame the pc was unwound from, so that a
+   backtrace going back through the same call sites tries one sniffer
+   per frame instead of all of them.  The key is the pc rather than
+   the function, because epilogue sniffers claim only part of a
+   function.  The table is direct mapped; a collision simply replaces
+   the older entry.  */
+
+#define FRAME_UNWIND_CACHE_SIZE 1024
+
+struct frame_unwind_cache_entry
+{
+  CORE_ADDR pc;
+  enum frame_type next_type;
+  struct gdbarch *gdbarch;
+
+  /* The entry whose sniffer claimed PC, or NULL if the slot is
+     empty.  */
+  struct frame_unwind_table_entry *entry;
+};
+
+struct frame_unwind_cache
+{
+  /* How far the objfile's text had slid when these entries were
+     stored.  If it has moved since, none of them can be trusted.  */
+  CORE_ADDR slide;
+
+  /* The value of objfile_chain_generation then.  A new objfile, a
+     dSYM say, can bring unwind information for this one's code.  */
+  unsigned int generation;
+
+  struct frame_unwind_cache_entry entries[FRAME_UNWIND_CACHE_SIZE];
+};
+
+static const struct objfile_data *frame_unwind_cache_objfile_data;
+
+static int frame_unwinder_cache = 1;
+
+static void
+show_frame_unwinder_cache (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Caching of the unwinder chosen for each pc "
+			    "is %s.\n"), value);
+}
+
+static void
+frame_unwind_cache_free (struct objfile *objfile, void *data)
+{
+  xfree (data);
+}
+
+/* Find the slot for the frame before NEXT_FRAME in the cache of the
+   objfile containing its pc, and store the key in *PCP and
+   *NEXT_TYPEP.  Return NULL if the pc isn't in any objfile.  */
+
+static struct frame_unwind_cache_entry *
+frame_unwind_cache_slot (struct frame_info *next_frame, CORE_ADDR *pcp,
+			 enum frame_type *next_typep)
+{
+  struct obj_section *osect;
+  struct frame_unwind_cache *cache;
+  CORE_ADDR pc, slide;
+  enum frame_type next_type;
+  unsigned long hash;
+
+  if (!frame_unwinder_cache)
+    return NULL;
+
+  pc = frame_pc_unwind (next_frame);
+  next_type = get_frame_type (next_frame);
+  osect = find_pc_section (pc);
+  if (osect == NULL || osect->objfile == NULL
+      || osect->the_bfd_section == NULL)
+    return NULL;
+  slide = osect->addr - bfd_section_vma (osect->objfile->obfd,
+					 osect->the_bfd_section);
+
+  cache = objfile_data (osect->objfile, frame_unwind_cache_objfile_data);
+  if (cache == NULL)
+    {
+      cache = xcalloc (1, sizeof (struct frame_unwind_cache));
+      cache->slide = slide;
+      cache->generation = objfile_chain_generation;
+      set_objfile_data (osect->objfile, frame_unwind_cache_objfile_data,
+			cache);
+    }
+  else if (cache->slide != slide
+	   || cache->generation != objfile_chain_generation)
+    {
+      memset (cache->entries, 0, sizeof (cache->entries));
+      cache->slide = slide;
+      cache->generation = objfile_chain_generation;
+    }
+
+  *pcp = pc;
+  *next_typep = next_type;
+  hash = (unsigned long) (pc >> 1) * 31 + (unsigned long) next_type;
+  hash ^= hash >> 11;
+  return &cache->entries[hash % FRAME_UNWIND_CACHE_SIZE];
+}
+/* APPLE LOCAL end unwinder cache  */
+
 const struct frame_unwind *
 frame_unwind_find_by_frame (struct frame_info *next_frame, void **this_cache)
 {
   struct gdbarch *gdbarch = get_frame_arch (next_frame);
   struct frame_unwind_table *table = gdbarch_data (gdbarch, frame_unwind_data);
   struct frame_unwind_table_entry *entry;
-  for (entry = table->list; entry != NULL; entry = entry->next)
+  /* APPLE LOCAL begin unwinder cache  */
+  const struct frame_unwind *desc;
+  struct frame_unwind_cache_entry *slot;
+  CORE_ADDR pc = 0;
+  enum frame_type next_type = NORMAL_FRAME;
+
+  /* The dummy and inlined sniffers depend on more than the pc, so
+     they are always asked first.  */
+  for (entry = table->list; entry != *table->osabi_head; entry = entry->next)
     {
-      if (entry->sniffer != NULL)
-	{
-	  const struct frame_unwind *desc = NULL;
-	  desc = entry->sniffer (next_frame);
-	  if (desc != NULL)
-	    return desc;
-	}
-      if (entry->unwinder != NULL)
+      desc = frame_unwind_try_entry (entry, next_frame, this_cache);
+      if (desc != NULL)
+	return desc;
+    }
+
+  slot = frame_unwind_cache_slot (next_frame, &pc, &next_type);
+  if (slot != NULL && slot->entry != NULL && slot->pc == pc
+      && slot->next_type == next_type && slot->gdbarch == gdbarch)
+    {
+      desc = frame_unwind_try_entry (slot->entry, next_frame, this_cache);
+      if (desc != NULL)
+	return desc;
+    }
+
+  for (; entry != NULL; entry = entry->next)
+    {
+      desc = frame_unwind_try_entry (entry, next_frame, this_cache);
+      if (desc != NULL)
 	{
-	  if (entry->unwinder->sniffer (entry->unwinder, next_frame,
-					this_cache))
-	    return entry->unwinder;
+	  if (slot != NULL)
+	    {
+	      slot->pc = pc;
+	      slot->next_type = next_type;
+	      slot->gdbarch = gdbarch;
+	      slot->entry = entry;
+	    }
+	  return desc;
 	}
     }
+  /* APPLE LOCAL end unwinder cache  */
   internal_error (__FILE__, __LINE__, _("frame_unwind_find_by_frame failed"));
 }
 
@@ -122,4 +280,19 @@ void
 _initialize_frame_unwind (void)
 {
   frame_unwind_data = gdbarch_data_register_pre_init (frame_unwind_init);
+
+  /* APPLE LOCAL begin unwinder cache  */
+  frame_unwind_cache_objfile_data
+    = register_objfile_data_with_cleanup (frame_unwind_cache_free);
+
+  add_setshow_boolean_cmd ("frame-unwinder-cache", class_maintenance,
+			   &frame_unwinder_cache, _("\
+Set whether the unwinder chosen for each pc is remembered."), _("\
+Show whether the unwinder chosen for each pc is remembered."), _("\
+When on, the sniffer that claimed a frame's pc is kept with the pc's\n\
+objfile and asked first the next time a frame is unwound at that pc."),
+			   NULL, show_frame_unwinder_cache,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end unwinder cache  */
 }
@@ -46,6 +46,8 @@
 #include "inlining.h"
 /* APPLE LOCAL - Inform users about debugging optimized code  */
 #include "top.h"
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
 
 static struct frame_info *get_prev_frame_1 (struct frame_info *this_frame);
 
@@ -111,6 +113,21 @@ struct frame_info
   struct frame_info *next; /* down, inner, younger */
   int prev_p;
   struct frame_info *prev; /* up, outer, older */
+
+  /* APPLE LOCAL frame reuse  */
+  /* With frame_reuse_across_stops, the two words just below this
+     frame's stack address (the saved frame pointer and return address
+     on the ABIs we support) as they were when PREV was unwound, or
+     NULL if they couldn't be read.  */
+  gdb_byte *link_words;
+
+  /* APPLE LOCAL frame base cache  */
+  /* The value of this frame's DW_AT_frame_base, once a DWARF location
+     expression has had to work it out.  */
+  struct {
+    int p;
+    CORE_ADDR value;
+  } dwarf2_frame_base;
 };
 
 /* Flag to control debugging.  */
@@ -856,6 +873,208 @@ frame_obstack_zalloc (unsigned long size)
   return data;
 }
 
+/* APPLE LOCAL begin frame reuse  */
+/* When set, the frame chain built at one stop is kept around, and
+   when the next stop's chain reaches a frame with the same ID whose
+   link words in memory haven't changed, the old frames above it are
+   reused instead of being unwound again.  */
+
+static int frame_reuse_across_stops = 0;
+
+static void
+show_frame_reuse_across_stops (struct ui_file *file, int from_tty,
+			       struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Reusing unchanged frames from the previous stop is %s.\n"),
+		    value);
+}
+
+/* The obstacks of frame chains from earlier stops that may still be
+   referenced, newest first.  A reused frame's caches can live in any
+   of them, so they are only freed together, when a chain made no use
+   of them or when there are FRAME_MAX_GENERATIONS of them.  */
+
+struct frame_generation
+{
+  struct obstack obstack;
+  struct frame_generation *next;
+};
+
+#define FRAME_MAX_GENERATIONS 8
+
+static struct frame_generation *frame_generations;
+static int frame_num_generations;
+
+/* The innermost frame of the previous stop's chain, and the thread it
+   belongs to.  SAVED_FRAME_CURSOR is how far get_prev_frame_1 has
+   looked along it for a frame matching the new chain.  */
+
+static struct frame_info *saved_current_frame;
+static struct frame_info *saved_frame_cursor;
+static ptid_t saved_frame_ptid;
+
+/* Set when the current chain has reused frames from an earlier one.  */
+
+static int frames_reused;
+
+static void
+free_frame_generations (void)
+{
+  while (frame_generations != NULL)
+    {
+      struct frame_generation *gen = frame_generations;
+      frame_generations = gen->next;
+      obstack_free (&gen->obstack, 0);
+      xfree (gen);
+    }
+  frame_num_generations = 0;
+  saved_current_frame = NULL;
+  saved_frame_cursor = NULL;
+  frames_reused = 0;
+}
+
+/* The size of one link word.  */
+
+static int
+frame_link_word_size (void)
+{
+  return gdbarch_ptr_bit (current_gdbarch) / TARGET_CHAR_BIT;
+}
+
+/* Record THIS_FRAME's link words, whose ID is THIS_ID, as they are
+   now, just before its previous frame is unwound.  */
+
+static void
+frame_record_link_words (struct frame_info *this_frame,
+			 struct frame_id this_id)
+{
+  int size = 2 * frame_link_word_size ();
+  gdb_byte *buf;
+
+  if (!frame_reuse_across_stops || this_frame->level < 0
+      || !this_id.stack_addr_p)
+    return;
+
+  buf = frame_obstack_zalloc (size);
+  if (target_read_memory (this_id.stack_addr - size, buf, size) == 0)
+    this_frame->link_words = buf;
+}
+
+/* Are FRAME's link words still what they were when it was unwound?  */
+
+static int
+frame_link_words_unchanged (struct frame_info *frame)
+{
+  int size = 2 * frame_link_word_size ();
+  gdb_byte *buf;
+
+  if (frame->link_words == NULL || !frame->this_id.p
+      || !frame->this_id.value.stack_addr_p)
+    return 0;
+
+  buf = alloca (size);
+  if (target_read_memory (frame->this_id.value.stack_addr - size,
+			  buf, size) != 0)
+    return 0;
+  return memcmp (buf, frame->link_words, size) == 0;
+}
+
+/* Can FRAME, from an earlier stop, be used in the new chain?  Frames
+   whose unwinding depends on gdb state other than the target's
+   registers and memory can't.  */
+
+static int
+frame_reusable_type_p (struct frame_info *frame)
+{
+  return (frame->unwind != NULL
+	  && frame->unwind->type != INLINED_FRAME
+	  && frame->unwind->type != DUMMY_FRAME
+	  && frame->unwind->type != SENTINEL_FRAME);
+}
+
+/* THIS_FRAME, with ID THIS_ID, is about to be unwound.  If the
+   previous stop's chain has a frame with the same ID whose return
+   address and saved frame pointer are unchanged, link the frames
+   above it in as THIS_FRAME's callers and return the first of them.
+   Each reused frame's own link words are checked too; the chain is
+   cut, to be unwound afresh, at the first one that changed.  */
+
+static struct frame_info *
+frame_reuse_saved_frames (struct frame_info *this_frame,
+			  struct frame_id this_id)
+{
+  struct frame_info *old, *prev, *frame;
+  int delta;
+
+  if (saved_current_frame == NULL || !ptid_equal (saved_frame_ptid,
+						   inferior_ptid)
+      || this_frame->level < 0 || !this_id.stack_addr_p
+      || !frame_reusable_type_p (this_frame))
+    return NULL;
+
+  /* Both chains run from inner to outer stack addresses, so the
+     cursor only has to move forwards.  */
+  if (saved_frame_cursor == NULL)
+    saved_frame_cursor = saved_current_frame;
+  while (saved_frame_cursor != NULL
+	 && (saved_frame_cursor->level < 0
+	     || (saved_frame_cursor->this_id.p
+		 && frame_id_inner (saved_frame_cursor->this_id.value,
+				    this_id))))
+    saved_frame_cursor = (saved_frame_cursor->prev_p
+			  ? saved_frame_cursor->prev : NULL);
+
+  old = saved_frame_cursor;
+  if (old == NULL || !old->this_id.p
+      || !frame_id_eq (old->this_id.value, this_id))
+    return NULL;
+
+  prev = old->prev;
+  if (!old->prev_p || prev == NULL
+      || old->unwind != this_frame->unwind
+      || !frame_reusable_type_p (prev)
+      || !frame_link_words_unchanged (old)
+      || !old->prev_pc.p
+      || frame_pc_unwind (this_frame) != old->prev_pc.value)
+    return NULL;
+
+  /* Keep each frame's caller while its link words hold; otherwise
+     make it unwind again when someone asks.  */
+  delta = this_frame->level - old->level;
+  for (frame = prev; frame != NULL; frame = frame->prev)
+    {
+      frame->level += delta;
+      if (!frame->prev_p)
+	break;
+      if (frame->prev == NULL
+	  || !frame_reusable_type_p (frame->prev)
+	  || !frame_link_words_unchanged (frame))
+	{
+	  frame->prev_p = 0;
+	  frame->prev = NULL;
+	  frame->prev_pc.p = 0;
+	  frame->prev_func.p = 0;
+	  break;
+	}
+    }
+
+  this_frame->prev = prev;
+  prev->next = this_frame;
+  frames_reused = 1;
+  saved_current_frame = NULL;
+  saved_frame_cursor = NULL;
+
+  if (frame_debug)
+    {
+      fprintf_unfiltered (gdb_stdlog, "-> ");
+      fprint_frame (gdb_stdlog, prev);
+      fprintf_unfiltered (gdb_stdlog, " // reused from last stop }\n");
+    }
+  return prev;
+}
+/* APPLE LOCAL end frame reuse  */
+
 /* Return the innermost (currently executing) stack frame.  This is
    split into two functions.  The function unwind_to_current_frame()
    is wrapped in catch exceptions so that, even when the unwind of the
@@ -1066,6 +1285,10 @@ flush_cached_frames (void)
   /* Since we can't really be sure what the first object allocated was */
   obstack_free (&frame_cache_obstack, 0);
   obstack_init (&frame_cache_obstack);
+  /* APPLE LOCAL frame reuse  */
+  free_frame_generations ();
+  /* APPLE LOCAL stop generation  */
+  target_bump_stop_generation ();
 
   current_frame = NULL;		/* Invalidate cache */
   select_frame (NULL);
@@ -1077,6 +1300,53 @@ flush_cached_frames (void)
   /* APPLE LOCAL begin subroutine inlining  */
 }
 
+/* APPLE LOCAL begin frame reuse  */
+/* Like flush_cached_frames, for when the inferior has just stopped:
+   with frame_reuse_across_stops, the old chain is kept so the new one
+   can reuse what hasn't changed.  Anything else that invalidates the
+   frames (register or memory writes, new symbols, switching threads)
+   should still use flush_cached_frames, which drops them all.  */
+
+void
+flush_cached_frames_at_stop (void)
+{
+  struct frame_generation *gen;
+
+  if (!frame_reuse_across_stops || current_frame == NULL
+      || (frames_reused && frame_num_generations >= FRAME_MAX_GENERATIONS))
+    {
+      flush_cached_frames ();
+      return;
+    }
+
+  /* The old generations are only still needed if the current chain
+     reused frames from them.  */
+  if (!frames_reused)
+    free_frame_generations ();
+
+  gen = XMALLOC (struct frame_generation);
+  gen->obstack = frame_cache_obstack;
+  gen->next = frame_generations;
+  frame_generations = gen;
+  frame_num_generations++;
+  obstack_init (&frame_cache_obstack);
+
+  saved_current_frame = current_frame;
+  saved_frame_cursor = NULL;
+  saved_frame_ptid = inferior_ptid;
+  frames_reused = 0;
+  /* APPLE LOCAL stop generation  */
+  target_bump_stop_generation ();
+
+  current_frame = NULL;
+  select_frame (NULL);
+  annotate_frames_invalid ();
+  if (frame_debug)
+    fprintf_unfiltered (gdb_stdlog, "{ flush_cached_frames_at_stop () }\n");
+  flush_inlined_subroutine_frames ();
+}
+/* APPLE LOCAL end frame reuse  */
+
 /* Flush the frame cache, and start a new one if necessary.  */
 
 void
@@ -1097,8 +1367,9 @@ reinit_frame_cache (void)
    Unlike get_prev_frame, this function always tries to unwind the
    frame.  */
 
+/* APPLE LOCAL gdb stats: Called through get_prev_frame_1.  */
 static struct frame_info *
-get_prev_frame_1 (struct frame_info *this_frame)
+compute_prev_frame (struct frame_info *this_frame)
 {
   struct frame_info *prev_frame;
   struct frame_id this_id;
@@ -1171,6 +1442,16 @@ get_prev_frame_1 (struct frame_info *this_frame)
     error (_("Previous frame identical to this frame (gdb could not unwind past this frame)"));
   /* APPLE LOCAL end subroutine inlining  */
 
+  /* APPLE LOCAL begin frame reuse  */
+  frame_record_link_words (this_frame, this_id);
+  if (frame_reuse_across_stops)
+    {
+      prev_frame = frame_reuse_saved_frames (this_frame, this_id);
+      if (prev_frame != NULL)
+	return prev_frame;
+    }
+  /* APPLE LOCAL end frame reuse  */
+
   /* Allocate the new frame but do not wire it in to the frame chain.
      Some (bad) code in INIT_FRAME_EXTRA_INFO tries to look along
      frame->next to pull some fancy tricks (of course such code is, by
@@ -1217,6 +1498,28 @@ get_prev_frame_1 (struct frame_info *this_frame)
   return prev_frame;
 }
 
+/* APPLE LOCAL begin gdb stats  */
+/* Charge the unwinds compute_prev_frame actually does, rather than
+   the ones it finds already done, to GDB_STAT_FRAME_UNWIND.  */
+
+static struct frame_info *
+get_prev_frame_1 (struct frame_info *this_frame)
+{
+  struct gdb_stat_timer timer;
+  struct frame_info *prev_frame;
+
+  gdb_assert (this_frame != NULL);
+
+  if (this_frame->prev_p)
+    return compute_prev_frame (this_frame);
+
+  gdb_stat_start (GDB_STAT_FRAME_UNWIND, &timer);
+  prev_frame = compute_prev_frame (this_frame);
+  gdb_stat_stop (GDB_STAT_FRAME_UNWIND, &timer, 0);
+  return prev_frame;
+}
+/* APPLE LOCAL end gdb stats  */
+
 /* Debug routine to print a NULL frame being returned.  */
 
 static void
@@ -1548,6 +1851,24 @@ find_frame_sal (struct frame_info *frame, struct symtab_and_line *sal)
   /* APPLE LOCAL end subroutine inlining  */
 }
 
+/* APPLE LOCAL begin frame base cache  */
+int
+get_frame_dwarf2_base (struct frame_info *fi, CORE_ADDR *base)
+{
+  if (!fi->dwarf2_frame_base.p)
+    return 0;
+  *base = fi->dwarf2_frame_base.value;
+  return 1;
+}
+
+void
+set_frame_dwarf2_base (struct frame_info *fi, CORE_ADDR base)
+{
+  fi->dwarf2_frame_base.value = base;
+  fi->dwarf2_frame_base.p = 1;
+}
+/* APPLE LOCAL end frame base cache  */
+
 /* Per "frame.h", return the ``address'' of the frame.  Code should
    really be using get_frame_id().  */
 CORE_ADDR
@@ -1896,6 +2217,22 @@ Zero is unlimited."),
 			   &set_backtrace_cmdlist,
 			   &show_backtrace_cmdlist);
 
+  /* APPLE LOCAL frame reuse  */
+  add_setshow_boolean_cmd ("frame-reuse-across-stops", class_maintenance,
+			   &frame_reuse_across_stops, _("\
+Set whether frames from the previous stop are reused when unchanged."), _("\
+Show whether frames from the previous stop are reused when unchanged."), _("\
+When on, the frame chain is kept when the inferior stops.  When the new\n\
+chain reaches a frame with the same frame ID as an old one, and the saved\n\
+frame pointer and return address below it are unchanged in memory, the old\n\
+frames above it are reused instead of being unwound again.  This assumes\n\
+the saved frame pointer and return address sit just below the frame's\n\
+stack address, as on Mac OS X i386, x86_64 and ARM."),
+			   NULL,
+			   show_frame_reuse_across_stops,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+
   /* Debug this files internals. */
   add_setshow_zinteger_cmd ("frame", class_maintenance, &frame_debug,  _("\
 Set frame debugging."), _("\
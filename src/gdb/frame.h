@@ -221,6 +221,11 @@ extern struct frame_info *get_current_frame (void);
 extern void flush_cached_frames (void);
 extern void reinit_frame_cache (void);
 
+/* APPLE LOCAL frame reuse  */
+/* Like flush_cached_frames, but for when the inferior has just
+   stopped; see "maint set frame-reuse-across-stops".  */
+extern void flush_cached_frames_at_stop (void);
+
 /* On demand, create the selected frame and then return it.  If the
    selected frame can not be created, this function prints then throws
    an error.  When MESSAGE is non-NULL, use it for the error message,
@@ -327,6 +332,15 @@ extern void find_frame_sal (struct frame_info *frame,
 
 extern CORE_ADDR get_frame_base (struct frame_info *);
 
+/* APPLE LOCAL begin frame base cache  */
+/* The value of the frame's DWARF DW_AT_frame_base, remembered for as
+   long as the frame is.  get_frame_dwarf2_base returns zero if it
+   hasn't been recorded yet.  */
+
+extern int get_frame_dwarf2_base (struct frame_info *, CORE_ADDR *);
+extern void set_frame_dwarf2_base (struct frame_info *, CORE_ADDR);
+/* APPLE LOCAL end frame base cache  */
+
 /* Return the per-frame unique identifer.  Can be used to relocate a
    frame after a frame cache flush (and other similar operations).  If
    FI is NULL, return the null_frame_id.
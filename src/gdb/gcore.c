@@ -26,6 +26,10 @@
 #include "gdbcore.h"
 #include "objfiles.h"
 #include "symfile.h"
+/* APPLE LOCAL gcore chunked copy  */
+#include "gdbcmd.h"
+/* APPLE LOCAL minimal core files  */
+#include "mach-o.h"
 
 #include "cli/cli-decode.h"
 
@@ -36,6 +40,95 @@ static enum bfd_architecture default_gcore_arch (void);
 static unsigned long default_gcore_mach (void);
 static int gcore_memory_sections (bfd *);
 
+/* APPLE LOCAL begin gcore chunked copy  */
+/* Section contents are copied into the core file this many bytes at
+   a time, so a heap of many gigabytes doesn't have to be read into one
+   buffer of the same size before any of it is written.  A multiple of
+   any page size we're likely to meet, so chunks stay page aligned.  */
+
+#define GCORE_COPY_CHUNK (1024 * 1024)
+
+/* If set, chunks of memory that turn out to be all zeros are left as
+   holes in the core file rather than written out.  */
+
+static int gcore_skip_zero_pages = 0;
+
+static void
+show_gcore_skip_zero_pages (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Skipping zero-filled memory in \
+generated core files is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end gcore chunked copy  */
+
+/* APPLE LOCAL begin minimal core files  */
+/* If set, gcore writes the contents of writable memory only.  Read-only
+   mappings - the text of the executable and its libraries, the dyld
+   shared cache, mapped resource files - get a section header but no
+   contents, since whoever looks at the core can get them back from the
+   images on disk.  Only the first GCORE_MINIMAL_HEAD bytes of each one
+   are kept, so that the Mach-O headers dyld's image list points at can
+   still be read from the core.  */
+
+static int gcore_minimal = 0;
+
+#define GCORE_MINIMAL_HEAD 0x1000
+
+static void
+show_gcore_minimal (struct ui_file *file, int from_tty,
+		    struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Writing minimal core files is %s.\n"), value);
+}
+
+/* Return a buffer holding the image manifest of a minimal core file,
+   and store its length in *SIZE.  Returns NULL if there are no images
+   to list.  */
+
+static char *
+gcore_make_image_manifest (int *size)
+{
+  struct objfile *objfile;
+  struct ui_file *buf = mem_fileopen ();
+  struct cleanup *old_chain = make_cleanup_ui_file_delete (buf);
+  char *manifest;
+  long len;
+
+  ALL_OBJFILES (objfile)
+    {
+      unsigned char uuid[16];
+      CORE_ADDR slide = 0;
+      int i;
+
+      if (objfile->obfd == NULL
+	  || (objfile->flags & OBJF_SEPARATE_DEBUG_FILE)
+	  || (bfd_get_file_flags (objfile->obfd) & BFD_IN_MEMORY)
+	  || !bfd_mach_o_get_uuid (objfile->obfd, uuid, sizeof (uuid)))
+	continue;
+
+      if (objfile->section_offsets != NULL && objfile->sect_index_text >= 0)
+	slide = ANOFFSET (objfile->section_offsets, objfile->sect_index_text);
+
+      for (i = 0; i < sizeof (uuid); i++)
+	fprintf_unfiltered (buf, "%02x", uuid[i]);
+      fprintf_unfiltered (buf, " 0x%s %s\n", paddr_nz (slide),
+			  objfile->name);
+    }
+
+  manifest = ui_file_xstrdup (buf, &len);
+  do_cleanups (old_chain);
+  if (len == 0)
+    {
+      xfree (manifest);
+      return NULL;
+    }
+  *size = len;
+  return manifest;
+}
+/* APPLE LOCAL end minimal core files  */
+
 /* Generate a core file from the inferior process.  */
 
 static void
@@ -47,6 +140,11 @@ gcore_command (char *args, int from_tty)
   bfd *obfd;
   void *note_data = NULL;
   int note_size = 0;
+  /* APPLE LOCAL begin minimal core files  */
+  asection *images_sec = NULL;
+  char *images_data = NULL;
+  int images_size = 0;
+  /* APPLE LOCAL end minimal core files  */
 
   /* No use generating a corefile without a target process.  */
   if (!target_has_execution)
@@ -94,6 +192,25 @@ gcore_command (char *args, int from_tty)
       bfd_set_section_size (obfd, note_sec, note_size);
     }
 
+  /* APPLE LOCAL begin minimal core files  */
+  if (gcore_minimal)
+    images_data = gcore_make_image_manifest (&images_size);
+  if (images_data != NULL)
+    {
+      make_cleanup (xfree, images_data);
+      images_sec = bfd_make_section_anyway (obfd, GCORE_IMAGES_SECTION_NAME);
+      if (images_sec == NULL)
+	error (_("Failed to create image list section for corefile: %s"),
+	       bfd_errmsg (bfd_get_error ()));
+
+      bfd_set_section_vma (obfd, images_sec, 0);
+      bfd_set_section_flags (obfd, images_sec,
+			     SEC_HAS_CONTENTS | SEC_READONLY);
+      bfd_set_section_alignment (obfd, images_sec, 0);
+      bfd_set_section_size (obfd, images_sec, images_size);
+    }
+  /* APPLE LOCAL end minimal core files  */
+
   /* Now create the memory/load sections.  */
   if (gcore_memory_sections (obfd) == 0)
     error (_("gcore: failed to get corefile memory sections from target."));
@@ -105,6 +222,16 @@ gcore_command (char *args, int from_tty)
 	warning (_("writing note section (%s)"), bfd_errmsg (bfd_get_error ()));
     }
 
+  /* APPLE LOCAL begin minimal core files  */
+  if (images_data != NULL)
+    {
+      if (!bfd_set_section_contents (obfd, images_sec, images_data, 0,
+				     images_size))
+	warning (_("writing image list section (%s)"),
+		 bfd_errmsg (bfd_get_error ()));
+    }
+  /* APPLE LOCAL end minimal core files  */
+
   /* Succeeded.  */
   fprintf_filtered (gdb_stdout, "Saved corefile %s\n", corefilename);
 
@@ -306,12 +433,44 @@ make_output_phdrs (bfd *obfd, asection *osec, void *ignored)
   bfd_record_phdr (obfd, p_type, 1, p_flags, 0, 0, 0, 0, 1, &osec);
 }
 
+/* APPLE LOCAL begin minimal core files  */
+/* Add a "load" section to OBFD for the SIZE bytes at VADDR, with
+   FLAGS.  Returns non-zero on failure.  */
+
+static int
+gcore_make_load_section (bfd *obfd, CORE_ADDR vaddr, unsigned long size,
+			 flagword flags)
+{
+  asection *osec;
+
+  osec = bfd_make_section_anyway (obfd, "load");
+  if (osec == NULL)
+    {
+      warning (_("Couldn't make gcore segment: %s"),
+	       bfd_errmsg (bfd_get_error ()));
+      return 1;
+    }
+
+  if (info_verbose)
+    {
+      fprintf_filtered (gdb_stdout, "Save segment, %s bytes at 0x%s%s\n",
+			paddr_d (size), paddr_nz (vaddr),
+			(flags & SEC_LOAD) ? "" : " (no contents)");
+    }
+
+  bfd_set_section_size (obfd, osec, size);
+  bfd_set_section_vma (obfd, osec, vaddr);
+  bfd_section_lma (obfd, osec) = 0; /* ??? bfd_set_section_lma?  */
+  bfd_set_section_flags (obfd, osec, flags);
+  return 0;
+}
+/* APPLE LOCAL end minimal core files  */
+
 static int
 gcore_create_callback (CORE_ADDR vaddr, unsigned long size,
 		       int read, int write, int exec, void *data)
 {
   bfd *obfd = data;
-  asection *osec;
   flagword flags = SEC_ALLOC | SEC_HAS_CONTENTS | SEC_LOAD;
 
   /* If the memory segment has no permissions set, ignore it, otherwise
@@ -368,25 +527,21 @@ gcore_create_callback (CORE_ADDR vaddr, unsigned long size,
   else
     flags |= SEC_DATA;
 
-  osec = bfd_make_section_anyway (obfd, "load");
-  if (osec == NULL)
+  /* APPLE LOCAL begin minimal core files  */
+  if (gcore_minimal && write == 0 && (flags & SEC_LOAD))
     {
-      warning (_("Couldn't make gcore segment: %s"),
-	       bfd_errmsg (bfd_get_error ()));
-      return 1;
-    }
-
-  if (info_verbose)
-    {
-      fprintf_filtered (gdb_stdout, "Save segment, %s bytes at 0x%s\n",
-			paddr_d (size), paddr_nz (vaddr));
+      if (size > GCORE_MINIMAL_HEAD)
+	{
+	  if (gcore_make_load_section (obfd, vaddr, GCORE_MINIMAL_HEAD, flags))
+	    return 1;
+	  vaddr += GCORE_MINIMAL_HEAD;
+	  size -= GCORE_MINIMAL_HEAD;
+	  flags &= ~SEC_LOAD;
+	}
     }
 
-  bfd_set_section_size (obfd, osec, size);
-  bfd_set_section_vma (obfd, osec, vaddr);
-  bfd_section_lma (obfd, osec) = 0; /* ??? bfd_set_section_lma?  */
-  bfd_set_section_flags (obfd, osec, flags);
-  return 0;
+  return gcore_make_load_section (obfd, vaddr, size, flags);
+  /* APPLE LOCAL end minimal core files  */
 }
 
 static int
@@ -441,12 +596,32 @@ objfile_find_memory_regions (int (*func) (CORE_ADDR, unsigned long,
   return 0;
 }
 
+/* APPLE LOCAL begin gcore chunked copy  */
+static int
+gcore_all_zero (const gdb_byte *buf, bfd_size_type len)
+{
+  bfd_size_type i;
+
+  for (i = 0; i < len; i++)
+    if (buf[i] != 0)
+      return 0;
+  return 1;
+}
+/* APPLE LOCAL end gcore chunked copy  */
+
 static void
 gcore_copy_callback (bfd *obfd, asection *osec, void *ignored)
 {
   bfd_size_type size = bfd_section_size (obfd, osec);
   struct cleanup *old_chain = NULL;
-  void *memhunk;
+  /* APPLE LOCAL begin gcore chunked copy  */
+  bfd_vma vma = bfd_section_vma (obfd, osec);
+  const gdb_byte *mapping;
+  gdb_byte *memhunk = NULL;
+  bfd_size_type offset;
+  /* APPLE LOCAL end gcore chunked copy  */
+  /* APPLE LOCAL map target memory  */
+  void *handle;
 
   /* Read-only sections are marked; we don't have to copy their contents.  */
   if ((bfd_get_section_flags (obfd, osec) & SEC_LOAD) == 0)
@@ -456,21 +631,56 @@ gcore_copy_callback (bfd *obfd, asection *osec, void *ignored)
   if (strncmp ("load", bfd_section_name (obfd, osec), 4) != 0)
     return;
 
-  memhunk = xmalloc (size);
-  /* ??? This is crap since xmalloc should never return NULL.  */
-  if (memhunk == NULL)
-    error (_("Not enough memory to create corefile."));
-  old_chain = make_cleanup (xfree, memhunk);
-
-  if (target_read_memory (bfd_section_vma (obfd, osec),
-			  memhunk, size) != 0)
-    warning (_("Memory read failed for corefile section, %s bytes at 0x%s."),
-	     paddr_d (size), paddr (bfd_section_vma (obfd, osec)));
-  if (!bfd_set_section_contents (obfd, osec, memhunk, 0, size))
-    warning (_("Failed to write corefile contents (%s)."),
-	     bfd_errmsg (bfd_get_error ()));
-
-  do_cleanups (old_chain);	/* Frees MEMHUNK.  */
+  /* APPLE LOCAL begin map target memory  */
+  /* Large sections like the heap are best written straight out of a
+     mapping of the inferior's memory.  */
+  mapping = target_map_memory (vma, size, &handle);
+  if (mapping != NULL)
+    old_chain = make_cleanup (target_unmap_memory, handle);
+  /* APPLE LOCAL end map target memory  */
+  /* APPLE LOCAL begin gcore chunked copy  */
+  else
+    {
+      memhunk = xmalloc (size < GCORE_COPY_CHUNK ? size : GCORE_COPY_CHUNK);
+      old_chain = make_cleanup (xfree, memhunk);
+    }
+
+  for (offset = 0; offset < size; offset += GCORE_COPY_CHUNK)
+    {
+      bfd_size_type len = size - offset;
+      const gdb_byte *chunk;
+
+      if (len > GCORE_COPY_CHUNK)
+	len = GCORE_COPY_CHUNK;
+
+      if (mapping != NULL)
+	chunk = mapping + offset;
+      else
+	{
+	  if (target_read_memory (vma + offset, memhunk, len) != 0)
+	    warning (_("Memory read failed for corefile section, \
+%s bytes at 0x%s."),
+		     paddr_d (len), paddr (vma + offset));
+	  chunk = memhunk;
+	}
+
+      /* The last chunk is always written, so the file is as long as
+	 the sections in it say it is and any holes read back as
+	 zeros.  */
+      if (gcore_skip_zero_pages && offset + len < size
+	  && gcore_all_zero (chunk, len))
+	continue;
+
+      if (!bfd_set_section_contents (obfd, osec, chunk, offset, len))
+	{
+	  warning (_("Failed to write corefile contents (%s)."),
+		   bfd_errmsg (bfd_get_error ()));
+	  break;
+	}
+    }
+
+  do_cleanups (old_chain);	/* Frees MEMHUNK or unmaps MAPPING.  */
+  /* APPLE LOCAL end gcore chunked copy  */
 }
 
 static int
@@ -496,5 +706,29 @@ Save a core file with the current state of the debugged process.\n\
 Argument is optional filename.  Default filename is 'core.<process_id>'."));
 
   add_com_alias ("gcore", "generate-core-file", class_files, 1);
+
+  /* APPLE LOCAL gcore chunked copy  */
+  add_setshow_boolean_cmd ("gcore-skip-zero-pages", class_files,
+			   &gcore_skip_zero_pages, _("\
+Set whether gcore leaves zero-filled memory out of the core file."), _("\
+Show whether gcore leaves zero-filled memory out of the core file."), _("\
+When on, memory that reads as all zeros is not written to the core file,\n\
+leaving a hole in it instead.  On file systems with sparse file support\n\
+this saves both time and disk space for processes with large heaps."),
+			   NULL, show_gcore_skip_zero_pages,
+			   &setlist, &showlist);
+
+  /* APPLE LOCAL minimal core files  */
+  add_setshow_boolean_cmd ("gcore-minimal", class_files,
+			   &gcore_minimal, _("\
+Set whether gcore leaves read-only memory out of the core file."), _("\
+Show whether gcore leaves read-only memory out of the core file."), _("\
+When on, gcore writes the contents of writable memory only, along with a\n\
+list of the images loaded into the process (path, UUID and slide).  The\n\
+text of those images is read back from the files on disk when the core\n\
+is examined, so a minimal core is only useful on a machine that has\n\
+the same images."),
+			   NULL, show_gcore_minimal,
+			   &setlist, &showlist);
   exec_set_find_memory_regions (objfile_find_memory_regions);
 }
@@ -68,6 +68,13 @@ struct dbx_symfile_info
     int n_header_files;
     int n_allocated_header_files;
 
+    /* APPLE LOCAL begin header file hash  */
+    /* Heads of the hash chains through HEADER_FILES, so that an N_EXCL
+       doesn't have to search every header file seen so far.  */
+    int *header_file_buckets;
+    int n_header_file_buckets;
+    /* APPLE LOCAL end header file hash  */
+
     /* APPLE LOCAL: Pointers to struct obj_sections.
        We need the slid addresses of these sections; FSF gdb uses BFD asections
        which have the original file's intended load address.
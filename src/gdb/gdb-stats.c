@@ -0,0 +1,623 @@
+/* APPLE LOCAL begin gdb stats. This entire file is APPLE LOCAL  */
+/* Cumulative counters for where GDB spends its time.
+
+   Copyright 2026.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.  */
+
+#include "defs.h"
+#include "gdbcmd.h"
+#include "gdb_string.h"
+#include "gdb_assert.h"
+#include "gdb-stats.h"
+#include "ui-out.h"
+
+#include <sys/time.h>
+
+static struct gdb_stats gdb_stats;
+
+unsigned int gdb_stats_active;
+
+static const char *const gdb_stat_names[GDB_STAT_COUNT] =
+{
+  "symbol_lookup",
+  "memory_read",
+  "frame_unwind",
+  "varobj_eval",
+  "output",
+  "psymtab_expand",
+  "cu_read",
+  "target_xfer",
+  "demangle"
+};
+
+/* "maint set per-command stats".  */
+
+static int per_command_stats;
+
+/* The totals when the current command started.  */
+
+static struct gdb_stats per_command_start;
+
+static ULONGEST
+gdb_stats_now (void)
+{
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return (ULONGEST) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+void
+gdb_stat_start (enum gdb_stat stat, struct gdb_stat_timer *timer)
+{
+  unsigned int bit = 1 << stat;
+
+  gdb_stats.counters[stat].count++;
+  if (gdb_stats_active & bit)
+    {
+      timer->outermost = 0;
+      return;
+    }
+  gdb_stats_active |= bit;
+  timer->outermost = 1;
+  timer->start = gdb_stats_now ();
+}
+
+void
+gdb_stat_stop (enum gdb_stat stat, struct gdb_stat_timer *timer,
+	       ULONGEST bytes)
+{
+  ULONGEST now;
+
+  gdb_stats.counters[stat].bytes += bytes;
+  if (!timer->outermost)
+    return;
+  gdb_stats_active &= ~(1 << stat);
+
+  /* Don't let the clock being set back show up as years of work.  */
+  now = gdb_stats_now ();
+  if (now > timer->start)
+    gdb_stats.counters[stat].time += now - timer->start;
+}
+
+void
+gdb_stats_snapshot (struct gdb_stats *stats)
+{
+  memcpy (stats, &gdb_stats, sizeof (struct gdb_stats));
+}
+
+void
+gdb_stats_reset (void)
+{
+  memset (&gdb_stats, 0, sizeof (struct gdb_stats));
+}
+
+const char *
+gdb_stat_name (enum gdb_stat stat)
+{
+  gdb_assert (stat >= 0 && stat < GDB_STAT_COUNT);
+  return gdb_stat_names[stat];
+}
+
+void
+gdb_stats_command_start (void)
+{
+  if (per_command_stats)
+    gdb_stats_snapshot (&per_command_start);
+}
+
+/* Print what each counter gained between BEFORE and AFTER, leaving out
+   the ones that didn't move.  */
+
+static void
+gdb_stats_print_delta (const struct gdb_stats *before,
+		       const struct gdb_stats *after)
+{
+  int i;
+
+  for (i = 0; i < GDB_STAT_COUNT; i++)
+    {
+      const struct gdb_stat_counter *b = &before->counters[i];
+      const struct gdb_stat_counter *a = &after->counters[i];
+
+      if (a->count == b->count)
+	continue;
+      printf_unfiltered ("  %-16s %10lu calls", gdb_stat_names[i],
+			 (unsigned long) (a->count - b->count));
+      if (a->bytes != b->bytes)
+	printf_unfiltered (" %12lu bytes",
+			   (unsigned long) (a->bytes - b->bytes));
+      else
+	printf_unfiltered ("%19s", "");
+      printf_unfiltered (" %10.5f s\n", (a->time - b->time) / 1000000.0);
+    }
+}
+
+void
+gdb_stats_command_end (void)
+{
+  struct gdb_stats now;
+
+  if (!per_command_stats)
+    return;
+
+  gdb_stats_snapshot (&now);
+  printf_unfiltered (_("Command statistics:\n"));
+  gdb_stats_print_delta (&per_command_start, &now);
+}
+
+void
+gdb_stats_report_at_exit (void)
+{
+  struct gdb_stats zero;
+
+  if (!per_command_stats)
+    return;
+
+  memset (&zero, 0, sizeof (zero));
+  printf_unfiltered (_("Statistics for this session:\n"));
+  gdb_stats_print_delta (&zero, &gdb_stats);
+  gdb_flush (gdb_stdout);
+}
+
+int startup_stats;
+
+/* More phases than this are charged to the last one.  */
+
+#define STARTUP_MAX_PHASES 24
+
+/* How many of the slowest file initializers are reported.  */
+
+#define STARTUP_SLOWEST_INITS 10
+
+struct startup_phase
+{
+  const char *name;
+  /* Microseconds.  */
+  ULONGEST wall;
+  long cpu;
+};
+
+struct startup_init
+{
+  const char *name;
+  ULONGEST wall;
+};
+
+static struct startup_phase startup_phases[STARTUP_MAX_PHASES];
+static int startup_nphases;
+
+/* When startup began, and when the last phase ended.  */
+
+static ULONGEST startup_begin_wall, startup_mark_wall;
+static long startup_begin_cpu, startup_mark_cpu;
+
+/* The slowest initializers, slowest first, and the count and total
+   time of all of them.  */
+
+static struct startup_init startup_slowest[STARTUP_SLOWEST_INITS];
+static int startup_ninits;
+static ULONGEST startup_inits_wall;
+
+void
+startup_stats_start (void)
+{
+  startup_begin_wall = startup_mark_wall = gdb_stats_now ();
+  startup_begin_cpu = startup_mark_cpu = get_run_time ();
+}
+
+void
+startup_stats_phase (const char *name)
+{
+  struct startup_phase *phase;
+  ULONGEST wall;
+  long cpu;
+
+  if (!startup_stats)
+    return;
+
+  wall = gdb_stats_now ();
+  cpu = get_run_time ();
+
+  if (startup_nphases < STARTUP_MAX_PHASES)
+    {
+      phase = &startup_phases[startup_nphases++];
+      phase->name = name;
+    }
+  else
+    phase = &startup_phases[STARTUP_MAX_PHASES - 1];
+
+  if (wall > startup_mark_wall)
+    phase->wall += wall - startup_mark_wall;
+  phase->cpu += cpu - startup_mark_cpu;
+  startup_mark_wall = wall;
+  startup_mark_cpu = cpu;
+}
+
+void
+startup_stats_initialize (const char *name, initialize_file_ftype *fn)
+{
+  ULONGEST start, now, wall;
+  int i;
+
+  if (!startup_stats)
+    {
+      fn ();
+      return;
+    }
+
+  start = gdb_stats_now ();
+  fn ();
+  now = gdb_stats_now ();
+  wall = now > start ? now - start : 0;
+
+  startup_ninits++;
+  startup_inits_wall += wall;
+
+  /* Keep STARTUP_SLOWEST sorted, slowest first.  */
+  for (i = STARTUP_SLOWEST_INITS;
+       i > 0 && (startup_slowest[i - 1].name == NULL
+		 || startup_slowest[i - 1].wall < wall);
+       i--)
+    if (i < STARTUP_SLOWEST_INITS)
+      startup_slowest[i] = startup_slowest[i - 1];
+  if (i < STARTUP_SLOWEST_INITS)
+    {
+      startup_slowest[i].name = name;
+      startup_slowest[i].wall = wall;
+    }
+}
+
+void
+startup_stats_report (void)
+{
+  struct gdb_stats zero;
+  int i;
+
+  if (!startup_stats)
+    return;
+
+  printf_unfiltered (_("Startup statistics:\n"));
+  printf_unfiltered ("  %-28s %12s %12s\n", "Phase", "Wall (s)", "CPU (s)");
+  for (i = 0; i < startup_nphases; i++)
+    printf_unfiltered ("  %-28s %12.5f %12.5f\n", startup_phases[i].name,
+		       startup_phases[i].wall / 1000000.0,
+		       startup_phases[i].cpu / 1000000.0);
+  printf_unfiltered ("  %-28s %12.5f %12.5f\n", "total",
+		     (startup_mark_wall - startup_begin_wall) / 1000000.0,
+		     (startup_mark_cpu - startup_begin_cpu) / 1000000.0);
+
+  printf_unfiltered (_("Slowest of %d file initializers (%.5f s in all):\n"),
+		     startup_ninits, startup_inits_wall / 1000000.0);
+  for (i = 0; i < STARTUP_SLOWEST_INITS && startup_slowest[i].name; i++)
+    printf_unfiltered ("  %-28s %12.5f\n", startup_slowest[i].name,
+		       startup_slowest[i].wall / 1000000.0);
+
+  printf_unfiltered (_("Counters during startup:\n"));
+  memset (&zero, 0, sizeof (zero));
+  gdb_stats_print_delta (&zero, &gdb_stats);
+  gdb_flush (gdb_stdout);
+}
+
+/* The upper bounds, in microseconds, of the stop latency histogram's
+   buckets.  Slower stops go in a last, unbounded bucket.  */
+
+static const ULONGEST stop_latency_bounds[] =
+{
+  1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000,
+  1000000, 2000000, 5000000
+};
+
+#define STOP_LATENCY_BUCKETS \
+  (sizeof (stop_latency_bounds) / sizeof (stop_latency_bounds[0]) + 1)
+
+static const char *const stop_phase_names[STOP_PHASE_COUNT] =
+{
+  "target-wait",
+  "handle-event",
+  "normal-stop",
+  "shlibs",
+  "print",
+  "displays",
+  "hooks",
+  "observers"
+};
+
+struct stop_phase_stats
+{
+  ULONGEST calls;
+  /* Microseconds, over all stops, and in the slowest one.  */
+  ULONGEST total;
+  ULONGEST max;
+};
+
+/* The stop in progress.  */
+
+static ULONGEST stop_current_time[STOP_PHASE_COUNT];
+static ULONGEST stop_current_calls[STOP_PHASE_COUNT];
+
+/* Every stop since GDB started or "maint info stop-latency reset".  */
+
+static struct stop_phase_stats stop_phases[STOP_PHASE_COUNT];
+static ULONGEST stop_latency_histogram[STOP_LATENCY_BUCKETS];
+static ULONGEST stop_latency_count;
+static ULONGEST stop_latency_total;
+static ULONGEST stop_latency_max;
+
+/* "maint set stop-latency-records".  */
+
+static int stop_latency_records;
+
+void
+stop_latency_start (struct gdb_stat_timer *timer)
+{
+  timer->start = gdb_stats_now ();
+  timer->outermost = 1;
+}
+
+void
+stop_latency_stop (enum stop_phase phase, struct gdb_stat_timer *timer)
+{
+  ULONGEST now = gdb_stats_now ();
+
+  gdb_assert (phase >= 0 && phase < STOP_PHASE_COUNT);
+  stop_current_calls[phase]++;
+  if (now > timer->start)
+    stop_current_time[phase] += now - timer->start;
+}
+
+/* Report the stop that just finished, whose latency was LATENCY
+   microseconds, as an MI "=stop-latency" record.  */
+
+static void
+stop_latency_print_record (ULONGEST latency)
+{
+  struct cleanup *notify_cleanup;
+  int i;
+
+  notify_cleanup = make_cleanup_ui_out_notify_begin_end (uiout,
+							 "stop-latency");
+  ui_out_field_fmt (uiout, "latency", "%0.6f", latency / 1000000.0);
+  ui_out_field_fmt (uiout, "events", "%lu",
+		    (unsigned long) stop_current_calls[STOP_PHASE_HANDLE_EVENT]);
+  for (i = 0; i < STOP_PHASE_COUNT; i++)
+    ui_out_field_fmt (uiout, stop_phase_names[i], "%0.6f",
+		      stop_current_time[i] / 1000000.0);
+  do_cleanups (notify_cleanup);
+}
+
+void
+stop_latency_finish (void)
+{
+  ULONGEST latency;
+  int i;
+
+  latency = stop_current_time[STOP_PHASE_HANDLE_EVENT]
+    + stop_current_time[STOP_PHASE_NORMAL_STOP];
+
+  for (i = 0; i < STOP_LATENCY_BUCKETS - 1; i++)
+    if (latency < stop_latency_bounds[i])
+      break;
+  stop_latency_histogram[i]++;
+  stop_latency_count++;
+  stop_latency_total += latency;
+  if (latency > stop_latency_max)
+    stop_latency_max = latency;
+
+  for (i = 0; i < STOP_PHASE_COUNT; i++)
+    {
+      stop_phases[i].calls += stop_current_calls[i];
+      stop_phases[i].total += stop_current_time[i];
+      if (stop_current_time[i] > stop_phases[i].max)
+	stop_phases[i].max = stop_current_time[i];
+    }
+
+  if (stop_latency_records && ui_out_is_mi_like_p (uiout))
+    stop_latency_print_record (latency);
+
+  memset (stop_current_time, 0, sizeof (stop_current_time));
+  memset (stop_current_calls, 0, sizeof (stop_current_calls));
+}
+
+/* Print a bucket bound of USEC microseconds for the histogram.  */
+
+static void
+stop_latency_print_bound (ULONGEST usec)
+{
+  if (usec >= 1000000)
+    printf_filtered ("%5lu s ", (unsigned long) (usec / 1000000));
+  else
+    printf_filtered ("%5lu ms", (unsigned long) (usec / 1000));
+}
+
+static void
+maintenance_info_stop_latency (char *args, int from_tty)
+{
+  ULONGEST most = 0;
+  int reset = 0;
+  int i;
+
+  if (args != NULL && strcmp (args, "reset") == 0)
+    reset = 1;
+  else if (args != NULL && *args != '\0')
+    error (_("Usage: maintenance info stop-latency [reset]"));
+
+  if (stop_latency_count == 0)
+    printf_filtered (_("No stops have been timed.\n"));
+  else
+    {
+      printf_filtered (_("%lu stops, %.5f s on average, %.5f s at most.\n"),
+		       (unsigned long) stop_latency_count,
+		       stop_latency_total / 1000000.0 / stop_latency_count,
+		       stop_latency_max / 1000000.0);
+
+      for (i = 0; i < STOP_LATENCY_BUCKETS; i++)
+	if (stop_latency_histogram[i] > most)
+	  most = stop_latency_histogram[i];
+      for (i = 0; i < STOP_LATENCY_BUCKETS; i++)
+	{
+	  int width = (int) (stop_latency_histogram[i] * 40 / most);
+
+	  if (i < STOP_LATENCY_BUCKETS - 1)
+	    {
+	      printf_filtered ("  < ");
+	      stop_latency_print_bound (stop_latency_bounds[i]);
+	    }
+	  else
+	    {
+	      printf_filtered (" >= ");
+	      stop_latency_print_bound (stop_latency_bounds[i - 1]);
+	    }
+	  printf_filtered (" %8lu ", (unsigned long) stop_latency_histogram[i]);
+	  while (width-- > 0)
+	    printf_filtered ("#");
+	  printf_filtered ("\n");
+	}
+
+      printf_filtered ("%-14s %10s %12s %12s %12s\n",
+		       "Phase", "Calls", "Total (s)", "Average (s)", "Max (s)");
+      for (i = 0; i < STOP_PHASE_COUNT; i++)
+	printf_filtered ("%-14s %10lu %12.5f %12.5f %12.5f\n",
+			 stop_phase_names[i],
+			 (unsigned long) stop_phases[i].calls,
+			 stop_phases[i].total / 1000000.0,
+			 stop_phases[i].total / 1000000.0 / stop_latency_count,
+			 stop_phases[i].max / 1000000.0);
+    }
+
+  if (reset)
+    {
+      memset (stop_phases, 0, sizeof (stop_phases));
+      memset (stop_latency_histogram, 0, sizeof (stop_latency_histogram));
+      stop_latency_count = 0;
+      stop_latency_total = 0;
+      stop_latency_max = 0;
+    }
+}
+
+static void
+show_stop_latency_records (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Reporting the latency of each stop to MI is %s.\n"),
+		    value);
+}
+
+static void
+show_per_command_stats (struct ui_file *file, int from_tty,
+			struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Per-command statistics are %s.\n"), value);
+}
+
+static struct cmd_list_element *per_command_setlist;
+static struct cmd_list_element *per_command_showlist;
+
+static void
+set_per_command_cmd (char *args, int from_tty)
+{
+  help_list (per_command_setlist, "maintenance set per-command ", -1,
+	     gdb_stdout);
+}
+
+static void
+show_per_command_cmd (char *args, int from_tty)
+{
+  cmd_show_list (per_command_showlist, from_tty, "");
+}
+
+static void
+maintenance_time_report (char *args, int from_tty)
+{
+  int reset = 0;
+  int i;
+
+  if (args != NULL && strcmp (args, "reset") == 0)
+    reset = 1;
+  else if (args != NULL && *args != '\0')
+    error (_("Usage: maintenance time-report [reset]"));
+
+  printf_filtered ("%-16s %12s %14s %12s\n",
+		   "Category", "Calls", "Bytes", "Seconds");
+  for (i = 0; i < GDB_STAT_COUNT; i++)
+    {
+      struct gdb_stat_counter *c = &gdb_stats.counters[i];
+
+      printf_filtered ("%-16s %12lu %14lu %12.5f\n", gdb_stat_names[i],
+		       (unsigned long) c->count, (unsigned long) c->bytes,
+		       c->time / 1000000.0);
+    }
+
+  if (reset)
+    gdb_stats_reset ();
+}
+
+void
+_initialize_gdb_stats (void)
+{
+  add_cmd ("time-report", class_maintenance, maintenance_time_report, _("\
+Report the time GDB has spent in each of its main activities.\n\
+Lists the calls made to, bytes moved by and seconds spent in symbol\n\
+lookup, target memory reads, frame unwinding, varobj evaluation,\n\
+value and MI output, psymtab expansion, DWARF compilation unit reads,\n\
+target transfers and demangling since GDB started or the counters were\n\
+last reset.\n\
+With the argument \"reset\", the counters are cleared after reporting."),
+	   &maintenancelist);
+
+  add_prefix_cmd ("per-command", class_maintenance, set_per_command_cmd, _("\
+Set per-command reporting."),
+		  &per_command_setlist, "maintenance set per-command ",
+		  0/*allow-unknown*/, &maintenance_set_cmdlist);
+  add_prefix_cmd ("per-command", class_maintenance, show_per_command_cmd, _("\
+Show per-command reporting."),
+		  &per_command_showlist, "maintenance show per-command ",
+		  0/*allow-unknown*/, &maintenance_show_cmdlist);
+
+  add_setshow_boolean_cmd ("stats", class_maintenance,
+			   &per_command_stats, _("\
+Set whether to report GDB's internal counters after each command."), _("\
+Show whether to report GDB's internal counters after each command."), _("\
+When on, each command is followed by what it added to the counters\n\
+\"maintenance time-report\" lists, and the session's totals are\n\
+printed when GDB exits."),
+			   NULL, show_per_command_stats,
+			   &per_command_setlist, &per_command_showlist);
+
+  add_cmd ("stop-latency", class_maintenance, maintenance_info_stop_latency,
+	   _("\
+Report how long GDB has taken to handle the inferior stopping.\n\
+Lists how many stops took how long, from the target reporting the first\n\
+event to GDB being ready for the next command, and how that time splits\n\
+between handling events, reading shared libraries, printing the stop\n\
+location, displays, hooks and observers.  Time the inferior spent\n\
+running, which \"target-wait\" includes, is not counted.\n\
+With the argument \"reset\", the counts are cleared after reporting."),
+	   &maintenanceinfolist);
+
+  add_setshow_boolean_cmd ("stop-latency-records", class_maintenance,
+			   &stop_latency_records, _("\
+Set whether each stop's latency is reported to MI."), _("\
+Show whether each stop's latency is reported to MI."), _("\
+When on, the MI interpreter prints a \"=stop-latency\" record at the end\n\
+of every stop, giving the seconds spent in each phase of handling it."),
+			   NULL, show_stop_latency_records,
+			   &maintenance_set_cmdlist, &maintenance_show_cmdlist);
+}
+/* APPLE LOCAL end gdb stats  */
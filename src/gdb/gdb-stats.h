@@ -0,0 +1,187 @@
+/* APPLE LOCAL begin gdb stats. This entire file is APPLE LOCAL  */
+/* Cumulative counters for where GDB spends its time.
+
+   Copyright 2026.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.  */
+
+#if !defined (GDB_STATS_H)
+#define GDB_STATS_H
+
+/* Unlike the "maint interval" timers, which are started by name and
+   report every interval as it ends, these are a fixed set of counters
+   cheap enough to leave running around GDB's hot paths.  Each one
+   counts its calls, any bytes they moved, and the wall clock time
+   spent in the outermost of them.  A category's time includes time
+   spent in the others while it runs: memory read while unwinding a
+   frame is charged to both.
+
+   The MI timing output ("-mi-enable-timings yes") and, for CLI
+   commands, "maint set per-command stats on" report how much each
+   command added to these; "-gdb-stats" and "maint time-report" report
+   the totals.  */
+
+enum gdb_stat
+{
+  GDB_STAT_SYMBOL_LOOKUP,
+  GDB_STAT_MEMORY_READ,
+  GDB_STAT_FRAME_UNWIND,
+  GDB_STAT_VAROBJ_EVAL,
+  GDB_STAT_OUTPUT,
+  GDB_STAT_PSYMTAB_EXPAND,
+  GDB_STAT_CU_READ,
+  GDB_STAT_TARGET_XFER,
+  GDB_STAT_DEMANGLE,
+  GDB_STAT_COUNT
+};
+
+struct gdb_stat_counter
+{
+  ULONGEST count;
+  ULONGEST bytes;
+  /* Microseconds.  */
+  ULONGEST time;
+};
+
+struct gdb_stats
+{
+  struct gdb_stat_counter counters[GDB_STAT_COUNT];
+};
+
+/* Filled in by gdb_stat_start, and handed back to gdb_stat_stop.  */
+
+struct gdb_stat_timer
+{
+  ULONGEST start;
+  int outermost;
+};
+
+/* A bit per category that has an outermost timer running.  The
+   exception catchers save and restore this, so that a timer an error
+   unwinds past doesn't stay running.  */
+
+extern unsigned int gdb_stats_active;
+
+extern void gdb_stat_start (enum gdb_stat stat, struct gdb_stat_timer *timer);
+
+/* Stop TIMER, and charge BYTES bytes to STAT.  */
+
+extern void gdb_stat_stop (enum gdb_stat stat, struct gdb_stat_timer *timer,
+			   ULONGEST bytes);
+
+/* Copy the current totals into STATS.  */
+
+extern void gdb_stats_snapshot (struct gdb_stats *stats);
+
+extern void gdb_stats_reset (void);
+
+/* The name STAT is reported under, e.g. "memory_read".  */
+
+extern const char *gdb_stat_name (enum gdb_stat stat);
+
+/* Called by the command loops around each CLI command.  If
+   "maint set per-command stats" is on, the second reports what the
+   command added to each counter.  */
+
+extern void gdb_stats_command_start (void);
+extern void gdb_stats_command_end (void);
+
+/* Called as GDB exits, to report the totals if per-command stats are
+   on.  */
+
+extern void gdb_stats_report_at_exit (void);
+
+/* With --startup-stats, captured_main and gdb_init mark the end of
+   each phase of startup (building the command tables, running the
+   _initialize_* functions, sourcing the init files, reading the
+   executable, ...).  Just before the first prompt, or before exiting
+   in batch mode, the wall clock and CPU time of each phase is
+   printed, along with the slowest of the _initialize_* functions and
+   what the counters above gained while starting up.  */
+
+/* Nonzero if --startup-stats was given.  */
+
+extern int startup_stats;
+
+/* Start the startup clock.  Called once, first thing in main.  */
+
+extern void startup_stats_start (void);
+
+/* Charge the time since the previous mark to the phase NAME, which
+   must be a string that lives forever.  */
+
+extern void startup_stats_phase (const char *name);
+
+/* Run the file initializer FN, whose name is NAME, timing it when
+   --startup-stats was given.  The generated init.c calls this for
+   each _initialize_* function.  */
+
+extern void startup_stats_initialize (const char *name,
+				      initialize_file_ftype *fn);
+
+/* Print the startup report if --startup-stats was given.  */
+
+extern void startup_stats_report (void);
+
+/* The phases of getting from the target reporting an event to GDB
+   being ready for the next command, timed on every stop so that a
+   slow stop can be pinned on one of them.  A stop runs from the
+   first target_wait after the inferior was resumed to the end of
+   normal_stop, and may take several events (every internal
+   breakpoint, single-step and shared library event up to the one
+   that stops for good).  STOP_PHASE_TARGET_WAIT includes the time
+   the inferior spent running, so it isn't counted as stop latency;
+   the other phases nest inside STOP_PHASE_NORMAL_STOP.  */
+
+enum stop_phase
+{
+  /* target_wait, including the inferior running.  */
+  STOP_PHASE_TARGET_WAIT,
+  /* handle_inferior_event, once per event.  */
+  STOP_PHASE_HANDLE_EVENT,
+  /* All of normal_stop.  */
+  STOP_PHASE_NORMAL_STOP,
+  /* Reading shared libraries whose notifications were put off.  */
+  STOP_PHASE_SHLIBS,
+  /* Working out and printing where we stopped.  */
+  STOP_PHASE_PRINT,
+  /* The "display" expressions.  */
+  STOP_PHASE_DISPLAYS,
+  /* hook-stop and the interpreters' state and stack change hooks.  */
+  STOP_PHASE_HOOKS,
+  /* The normal_stop observers.  */
+  STOP_PHASE_OBSERVERS,
+  STOP_PHASE_COUNT
+};
+
+extern void stop_latency_start (struct gdb_stat_timer *timer);
+
+/* Charge the time since TIMER was started to PHASE of the current
+   stop.  */
+
+extern void stop_latency_stop (enum stop_phase phase,
+			       struct gdb_stat_timer *timer);
+
+/* Called at the end of normal_stop.  Add the stop to the histogram
+   "maint info stop-latency" prints, report it to MI if asked to, and
+   start timing the next one.  */
+
+extern void stop_latency_finish (void);
+
+#endif /* GDB_STATS_H */
+/* APPLE LOCAL end gdb stats  */
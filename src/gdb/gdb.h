@@ -72,4 +72,10 @@ struct cleanup *make_cleanup_restore_current_thread (ptid_t inferior_ptid, int p
 enum gdb_rc gdb_list_thread_ids (struct ui_out *uiout,
 				 char **error_message);
 
+/* APPLE LOCAL begin thread-info  */
+/* Print every known thread with its details and innermost frame.  */
+enum gdb_rc gdb_list_thread_info (struct ui_out *uiout,
+				  char **error_message);
+/* APPLE LOCAL end thread-info  */
+
 #endif
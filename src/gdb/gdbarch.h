@@ -1475,6 +1475,29 @@ typedef int (gdbarch_adjust_ehframe_regnum_ftype) (struct gdbarch *gdbarch, int
 extern int gdbarch_adjust_ehframe_regnum (struct gdbarch *gdbarch, int regnum, int eh_frame_p);
 extern void set_gdbarch_adjust_ehframe_regnum (struct gdbarch *gdbarch, gdbarch_adjust_ehframe_regnum_ftype *adjust_ehframe_regnum);
 
+/* APPLE LOCAL: displaced stepping.  Copy the instruction at FROM into
+   BUF, which has room for DISPLACED_STEP_MAX_INSN bytes, so that it
+   can be single-stepped at some other address, and return its length.
+   Set *KIND to whatever displaced_step_fixup will need to know about
+   the instruction.  Return zero if it can't be stepped out of place. */
+
+extern int gdbarch_displaced_step_copy_insn_p (struct gdbarch *gdbarch);
+
+typedef int (gdbarch_displaced_step_copy_insn_ftype) (struct gdbarch *gdbarch, CORE_ADDR from, gdb_byte *buf, int *kind);
+extern int gdbarch_displaced_step_copy_insn (struct gdbarch *gdbarch, CORE_ADDR from, gdb_byte *buf, int *kind);
+extern void set_gdbarch_displaced_step_copy_insn (struct gdbarch *gdbarch, gdbarch_displaced_step_copy_insn_ftype *displaced_step_copy_insn);
+
+/* APPLE LOCAL: displaced stepping.  The instruction copied from FROM,
+   of kind KIND, has just been single-stepped at TO; adjust the
+   registers in REGCACHE (and the stack, if need be) to look as if it
+   had been stepped in place. */
+
+extern int gdbarch_displaced_step_fixup_p (struct gdbarch *gdbarch);
+
+typedef void (gdbarch_displaced_step_fixup_ftype) (struct gdbarch *gdbarch, int kind, CORE_ADDR from, CORE_ADDR to, struct regcache *regcache);
+extern void gdbarch_displaced_step_fixup (struct gdbarch *gdbarch, int kind, CORE_ADDR from, CORE_ADDR to, struct regcache *regcache);
+extern void set_gdbarch_displaced_step_fixup (struct gdbarch *gdbarch, gdbarch_displaced_step_fixup_ftype *displaced_step_fixup);
+
 extern struct gdbarch_tdep *gdbarch_tdep (struct gdbarch *gdbarch);
 
 
@@ -671,6 +671,18 @@ M::const struct regset *:regset_from_core_section:const char *sect_name, size_t
 
 # APPLE LOCAL: Translate eh frame regnums into dwarf regnums
 m::int:adjust_ehframe_regnum:int regnum, int eh_frame_p:regnum, eh_frame_p::default_adjust_ehframe_regnum::0
+
+# APPLE LOCAL: displaced stepping.  Copy the instruction at FROM into
+# BUF, which has room for DISPLACED_STEP_MAX_INSN bytes, so that it
+# can be single-stepped at some other address, and return its length.
+# Set *KIND to whatever displaced_step_fixup will need to know about
+# the instruction.  Return zero if it can't be stepped out of place.
+M::int:displaced_step_copy_insn:CORE_ADDR from, gdb_byte *buf, int *kind:from, buf, kind
+# APPLE LOCAL: displaced stepping.  The instruction copied from FROM,
+# of kind KIND, has just been single-stepped at TO; adjust the
+# registers in REGCACHE (and the stack, if need be) to look as if it
+# had been stepped in place.
+M::void:displaced_step_fixup:int kind, CORE_ADDR from, CORE_ADDR to, struct regcache *regcache:kind, from, to, regcache
 EOF
 }
 
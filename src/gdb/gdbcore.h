@@ -122,6 +122,14 @@ extern bfd *exec_bfd;
 
 extern int write_files;
 
+/* APPLE LOCAL begin minimal core files  */
+/* The section of a core written by "set gcore-minimal on" that lists
+   the images it was written against, one "UUID SLIDE PATH" line per
+   image.  The contents of their read-only mappings are left out.  */
+
+#define GCORE_IMAGES_SECTION_NAME "gdb-images"
+/* APPLE LOCAL end minimal core files  */
+
 extern void core_file_command (char *filename, int from_tty);
 
 extern void core_file_attach (char *filename, int from_tty);
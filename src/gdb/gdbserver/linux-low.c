@@ -260,6 +260,9 @@ linux_kill (void)
       /* Make sure it died.  The loop is most likely unnecessary.  */
       wstat = linux_wait_for_event (thread);
     } while (WIFSTOPPED (wstat));
+
+  /* APPLE LOCAL proc mem  */
+  linux_proc_mem_close ();
 }
 
 static void
@@ -275,6 +278,9 @@ static void
 linux_detach (void)
 {
   for_each_inferior (&all_threads, linux_detach_one_process);
+
+  /* APPLE LOCAL proc mem  */
+  linux_proc_mem_close ();
 }
 
 /* Return nonzero if the given thread is still alive.  */
@@ -1372,6 +1378,76 @@ linux_store_registers (int regno)
 }
 
 
+/* APPLE LOCAL begin proc mem  */
+/* The open /proc/PID/mem of the process we last transferred memory
+   for.  Going through it moves a whole buffer in one system call,
+   where PTRACE_PEEKTEXT and PTRACE_POKETEXT need one per word.  */
+
+static int proc_mem_fd = -1;
+static unsigned long proc_mem_pid;
+
+static void
+linux_proc_mem_close (void)
+{
+  if (proc_mem_fd != -1)
+    close (proc_mem_fd);
+  proc_mem_fd = -1;
+  proc_mem_pid = 0;
+}
+
+/* Move LEN bytes between inferior memory at MEMADDR and READBUF or
+   WRITEBUF through /proc/PID/mem.  Return zero if all of them were
+   transferred, or -1 if the caller should fall back to ptrace.  */
+
+static int
+linux_proc_mem_xfer (CORE_ADDR memaddr, unsigned char *readbuf,
+		     const unsigned char *writebuf, int len)
+{
+  unsigned long pid = inferior_pid;
+  char filename[64];
+  ssize_t ret;
+  int attempt;
+
+  /* Don't bother for a word or two.  */
+  if (len < 3 * (int) sizeof (PTRACE_XFER_TYPE))
+    return -1;
+
+  /* Addresses that don't fit in an off_t can't be reached this way.  */
+  if ((CORE_ADDR) (off_t) memaddr != memaddr || (off_t) memaddr < 0)
+    return -1;
+
+  for (attempt = 0; attempt < 2; attempt++)
+    {
+      if (proc_mem_fd == -1 || proc_mem_pid != pid)
+	{
+	  linux_proc_mem_close ();
+	  sprintf (filename, "/proc/%lu/mem", pid);
+	  proc_mem_fd = open (filename, O_RDWR);
+	  if (proc_mem_fd == -1)
+	    proc_mem_fd = open (filename, O_RDONLY);
+	  if (proc_mem_fd == -1)
+	    return -1;
+	  proc_mem_pid = pid;
+	}
+
+      if (writebuf != NULL)
+	ret = pwrite (proc_mem_fd, writebuf, len, (off_t) memaddr);
+      else
+	ret = pread (proc_mem_fd, readbuf, len, (off_t) memaddr);
+      if (ret == len)
+	return 0;
+
+      /* A descriptor opened before the process exec'd refers to the
+	 old address space, so retry once with a fresh one.  A
+	 read-only descriptor, or an old kernel that doesn't allow
+	 writing this file, ends up with ptrace.  */
+      linux_proc_mem_close ();
+    }
+
+  return -1;
+}
+/* APPLE LOCAL end proc mem  */
+
 /* Copy LEN bytes from inferior's memory starting at MEMADDR
    to debugger memory starting at MYADDR.  */
 
@@ -1385,9 +1461,14 @@ linux_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
   register int count
     = (((memaddr + len) - addr) + sizeof (PTRACE_XFER_TYPE) - 1)
       / sizeof (PTRACE_XFER_TYPE);
+  register PTRACE_XFER_TYPE *buffer;
+
+  /* APPLE LOCAL proc mem  */
+  if (linux_proc_mem_xfer (memaddr, myaddr, NULL, len) == 0)
+    return 0;
+
   /* Allocate buffer of that many longwords.  */
-  register PTRACE_XFER_TYPE *buffer
-    = (PTRACE_XFER_TYPE *) alloca (count * sizeof (PTRACE_XFER_TYPE));
+  buffer = (PTRACE_XFER_TYPE *) alloca (count * sizeof (PTRACE_XFER_TYPE));
 
   /* Read all the longwords */
   for (i = 0; i < count; i++, addr += sizeof (PTRACE_XFER_TYPE))
@@ -1419,7 +1500,7 @@ linux_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
   register int count
   = (((memaddr + len) - addr) + sizeof (PTRACE_XFER_TYPE) - 1) / sizeof (PTRACE_XFER_TYPE);
   /* Allocate buffer of that many longwords.  */
-  register PTRACE_XFER_TYPE *buffer = (PTRACE_XFER_TYPE *) alloca (count * sizeof (PTRACE_XFER_TYPE));
+  register PTRACE_XFER_TYPE *buffer;
   extern int errno;
 
   if (debug_threads)
@@ -1427,6 +1508,12 @@ linux_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
       fprintf (stderr, "Writing %02x to %08lx\n", (unsigned)myaddr[0], (long)memaddr);
     }
 
+  /* APPLE LOCAL proc mem  */
+  if (linux_proc_mem_xfer (memaddr, NULL, myaddr, len) == 0)
+    return 0;
+
+  buffer = (PTRACE_XFER_TYPE *) alloca (count * sizeof (PTRACE_XFER_TYPE));
+
   /* Fill start and end extra bytes of buffer with existing memory data.  */
 
   buffer[0] = ptrace (PTRACE_PEEKTEXT, inferior_pid,
@@ -1552,6 +1639,41 @@ linux_stopped_data_address (void)
     return 0;
 }
 
+/* APPLE LOCAL begin thread summaries  */
+/* Return the command name the kernel keeps for lwp THREAD_ID.  */
+
+static const char *
+linux_thread_name (unsigned long thread_id)
+{
+  static char name[64];
+  char buf[256];
+  char *start, *end;
+  FILE *f;
+
+  sprintf (buf, "/proc/%ld/stat", thread_id);
+  f = fopen (buf, "r");
+  if (f == NULL)
+    return NULL;
+  if (fgets (buf, sizeof (buf), f) == NULL)
+    {
+      fclose (f);
+      return NULL;
+    }
+  fclose (f);
+
+  /* The name is in parentheses after the pid, and may itself contain
+     parentheses.  */
+  start = strchr (buf, '(');
+  end = strrchr (buf, ')');
+  if (start == NULL || end == NULL || end <= start + 1
+      || end - start - 1 >= sizeof (name))
+    return NULL;
+  memcpy (name, start + 1, end - start - 1);
+  name[end - start - 1] = '\0';
+  return name;
+}
+/* APPLE LOCAL end thread summaries  */
+
 static struct target_ops linux_target_ops = {
   linux_create_inferior,
   linux_attach,
@@ -1571,6 +1693,8 @@ static struct target_ops linux_target_ops = {
   linux_remove_watchpoint,
   linux_stopped_by_watchpoint,
   linux_stopped_data_address,
+  /* APPLE LOCAL thread summaries  */
+  linux_thread_name,
 };
 
 static void
@@ -41,6 +41,10 @@ static struct reg *reg_defs;
 static int num_registers;
 
 const char **gdbserver_expedite_regs;
+/* APPLE LOCAL: The frame pointer register, whose chain of saved
+   frame pointers and return addresses we send with stop replies, or
+   NULL if the target's frames don't look like that.  */
+const char *gdbserver_frame_chain_reg;
 
 static struct inferior_regcache_data *
 get_regcache (struct thread_info *inf, int fetch)
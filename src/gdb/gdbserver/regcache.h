@@ -58,6 +58,8 @@ int register_size (int n);
 int find_regno (const char *name);
 
 extern const char **gdbserver_expedite_regs;
+/* APPLE LOCAL */
+extern const char *gdbserver_frame_chain_reg;
 
 void supply_register (int n, const void *buf);
 
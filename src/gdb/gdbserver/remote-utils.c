@@ -36,23 +36,54 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <arpa/inet.h>
+/* APPLE LOCAL multi-session  */
+#include <sys/wait.h>
+#include <errno.h>
+/* APPLE LOCAL symbol cache  */
+#include <sys/stat.h>
+/* APPLE LOCAL shared memory reads  */
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 #ifndef HAVE_SOCKLEN_T
 typedef int socklen_t;
 #endif
 
-/* A cache entry for a successfully looked-up symbol.  */
+/* APPLE LOCAL begin symbol cache  */
+/* A cache entry for a looked-up symbol.  FOUND is zero if gdb told us
+   it doesn't know the symbol; such an answer only holds until gdb
+   offers us new symbols, i.e. until the generation changes.  */
 struct sym_cache
 {
   const char *name;
   CORE_ADDR addr;
+  int found;
+  unsigned int generation;
   struct sym_cache *next;
 };
 
-/* The symbol cache.  */
-static struct sym_cache *symbol_cache;
+/* The symbol cache, hashed on the symbol name.  It lives as long as
+   the inferior it was filled for, so a debugger that reconnects to the
+   same process doesn't have to answer the same questions again.  */
+#define SYMBOL_CACHE_SIZE 61
+static struct sym_cache *symbol_cache[SYMBOL_CACHE_SIZE];
+
+/* Bumped each time gdb invites us to look up symbols.  */
+static unsigned int symbol_cache_generation = 1;
+
+/* The inferior the cache was filled for: its process id and the
+   identity of its executable, if we could stat it.  */
+static unsigned long symbol_cache_pid;
+static dev_t symbol_cache_dev;
+static ino_t symbol_cache_ino;
+static time_t symbol_cache_mtime;
+/* APPLE LOCAL end symbol cache  */
 
 int remote_debug = 0;
+/* APPLE LOCAL: How many frame records to send with each stop reply;
+   set with --frame-chain.  */
+int frame_chain_depth = 8;
 struct ui_file *gdb_stdlog;
 
 static int remote_desc;
@@ -61,14 +92,119 @@ static int remote_desc;
 extern int using_threads;
 extern int debug_threads;
 
+/* APPLE LOCAL begin multi-session  */
+/* Listen for TCP connections on the port in NAME, which looks like
+   "HOST:PORT", queueing up to BACKLOG of them.  Return the listening
+   socket.  */
+
+static int
+remote_listen (char *name, int backlog)
+{
+  char *port_str;
+  int port;
+  struct sockaddr_in sockaddr;
+  socklen_t tmp;
+  int tmp_desc;
+
+  port_str = strchr (name, ':');
+
+  port = atoi (port_str + 1);
+
+  tmp_desc = socket (PF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (tmp_desc < 0)
+    perror_with_name ("Can't open socket");
+
+  /* Allow rapid reuse of this port. */
+  tmp = 1;
+  setsockopt (tmp_desc, SOL_SOCKET, SO_REUSEADDR, (char *) &tmp,
+	      sizeof (tmp));
+
+  sockaddr.sin_family = PF_INET;
+  sockaddr.sin_port = htons (port);
+  sockaddr.sin_addr.s_addr = INADDR_ANY;
+
+  if (bind (tmp_desc, (struct sockaddr *) &sockaddr, sizeof (sockaddr))
+      || listen (tmp_desc, backlog))
+    perror_with_name ("Can't bind address");
+
+  /* If port is zero, a random port will be selected, and the
+     fprintf below needs to know what port was selected.  */
+  if (port == 0)
+    {
+      socklen_t len = sizeof (sockaddr);
+      if (getsockname (tmp_desc, (struct sockaddr *) &sockaddr, &len) < 0
+	  || len < sizeof (sockaddr))
+	perror_with_name ("Can't determine port");
+      port = ntohs (sockaddr.sin_port);
+    }
+
+  fprintf (stderr, "Listening on port %d\n", port);
+  fflush (stderr);
+
+  return tmp_desc;
+}
+
+/* Wait for a debugger to connect to the socket TMP_DESC is listening
+   on, and make that connection the remote descriptor.  */
+
+static void
+remote_accept (int tmp_desc)
+{
+  struct sockaddr_in sockaddr;
+  socklen_t tmp;
+
+  do
+    {
+      tmp = sizeof (sockaddr);
+      remote_desc = accept (tmp_desc, (struct sockaddr *) &sockaddr, &tmp);
+    }
+  /* A session ending interrupts the wait for the next in --multi.  */
+  while (remote_desc == -1 && errno == EINTR);
+  if (remote_desc == -1)
+    perror_with_name ("Accept failed");
+
+  /* Enable TCP keep alive process. */
+  tmp = 1;
+  setsockopt (tmp_desc, SOL_SOCKET, SO_KEEPALIVE, (char *) &tmp, sizeof (tmp));
+
+  /* Tell TCP not to delay small packets.  This greatly speeds up
+     interactive response. */
+  tmp = 1;
+  setsockopt (remote_desc, IPPROTO_TCP, TCP_NODELAY,
+	      (char *) &tmp, sizeof (tmp));
+
+  signal (SIGPIPE, SIG_IGN);	/* If we don't do this, then gdbserver simply
+				   exits when the remote side dies.  */
+
+  /* Convert IP address to string.  */
+  fprintf (stderr, "Remote debugging from host %s\n", 
+     inet_ntoa (sockaddr.sin_addr));
+}
+
+/* Set up the remote descriptor once it is connected.  */
+
+static void
+remote_open_finish (void)
+{
+  int save_fcntl_flags;
+
+#if defined(F_SETFL) && defined (FASYNC)
+  save_fcntl_flags = fcntl (remote_desc, F_GETFL, 0);
+  fcntl (remote_desc, F_SETFL, save_fcntl_flags | FASYNC);
+#if defined (F_SETOWN)
+  fcntl (remote_desc, F_SETOWN, getpid ());
+#endif
+#endif
+  disable_async_io ();
+}
+/* APPLE LOCAL end multi-session  */
+
 /* Open a connection to a remote debugger.
    NAME is the filename used for communication.  */
 
 void
 remote_open (char *name)
 {
-  int save_fcntl_flags;
-  
   if (!strchr (name, ':'))
     {
       remote_desc = open (name, O_RDWR);
@@ -123,86 +259,80 @@ remote_open (char *name)
     }
   else
     {
-      char *port_str;
-      int port;
-      struct sockaddr_in sockaddr;
-      socklen_t tmp;
-      int tmp_desc;
-
-      port_str = strchr (name, ':');
+      /* APPLE LOCAL begin multi-session  */
+      int tmp_desc = remote_listen (name, 1);
 
-      port = atoi (port_str + 1);
-
-      tmp_desc = socket (PF_INET, SOCK_STREAM, IPPROTO_TCP);
-      if (tmp_desc < 0)
-	perror_with_name ("Can't open socket");
+      remote_accept (tmp_desc);
+      close (tmp_desc);		/* No longer need this */
+      /* APPLE LOCAL end multi-session  */
+    }
 
-      /* Allow rapid reuse of this port. */
-      tmp = 1;
-      setsockopt (tmp_desc, SOL_SOCKET, SO_REUSEADDR, (char *) &tmp,
-		  sizeof (tmp));
+  /* APPLE LOCAL multi-session  */
+  remote_open_finish ();
+}
 
-      sockaddr.sin_family = PF_INET;
-      sockaddr.sin_port = htons (port);
-      sockaddr.sin_addr.s_addr = INADDR_ANY;
+/* APPLE LOCAL begin multi-session  */
+/* Collect the sessions that have finished, so they don't linger as
+   zombies.  */
 
-      if (bind (tmp_desc, (struct sockaddr *) &sockaddr, sizeof (sockaddr))
-	  || listen (tmp_desc, 1))
-	perror_with_name ("Can't bind address");
+static void
+reap_sessions (int sig)
+{
+  int saved_errno = errno;
 
-      /* If port is zero, a random port will be selected, and the
-	 fprintf below needs to know what port was selected.  */
-      if (port == 0)
-	{
-	  socklen_t len = sizeof (sockaddr);
-	  if (getsockname (tmp_desc, (struct sockaddr *) &sockaddr, &len) < 0
-	      || len < sizeof (sockaddr))
-	    perror_with_name ("Can't determine port");
-	  port = ntohs (sockaddr.sin_port);
-	}
+  while (waitpid (-1, NULL, WNOHANG) > 0)
+    ;
+  errno = saved_errno;
+}
 
-      fprintf (stderr, "Listening on port %d\n", port);
-      fflush (stderr);
+/* Serve every debugger that connects to the port in NAME, "HOST:PORT",
+   from a separate gdbserver process, so that the sessions and the
+   inferiors they debug don't wait on one another.  This process goes
+   on accepting connections and never returns; each session's process
+   returns connected to its debugger, with nothing else set up yet.  */
 
-      tmp = sizeof (sockaddr);
-      remote_desc = accept (tmp_desc, (struct sockaddr *) &sockaddr, &tmp);
-      if (remote_desc == -1)
-	perror_with_name ("Accept failed");
+void
+remote_open_multi (char *name)
+{
+  int listen_desc;
+  int sessions = 0;
 
-      /* Enable TCP keep alive process. */
-      tmp = 1;
-      setsockopt (tmp_desc, SOL_SOCKET, SO_KEEPALIVE, (char *) &tmp, sizeof (tmp));
+  if (!strchr (name, ':'))
+    error ("--multi needs a HOST:PORT to listen on");
 
-      /* Tell TCP not to delay small packets.  This greatly speeds up
-         interactive response. */
-      tmp = 1;
-      setsockopt (remote_desc, IPPROTO_TCP, TCP_NODELAY,
-		  (char *) &tmp, sizeof (tmp));
+  listen_desc = remote_listen (name, SOMAXCONN);
+  signal (SIGCHLD, reap_sessions);
 
-      close (tmp_desc);		/* No longer need this */
+  while (1)
+    {
+      pid_t pid;
 
-      signal (SIGPIPE, SIG_IGN);	/* If we don't do this, then gdbserver simply
-					   exits when the remote side dies.  */
+      remote_accept (listen_desc);
+      pid = fork ();
+      if (pid == 0)
+	{
+	  /* The session waits for its own inferior, not for siblings.  */
+	  signal (SIGCHLD, SIG_DFL);
+	  close (listen_desc);
+	  remote_open_finish ();
+	  return;
+	}
 
-      /* Convert IP address to string.  */
-      fprintf (stderr, "Remote debugging from host %s\n", 
-         inet_ntoa (sockaddr.sin_addr));
+      if (pid < 0)
+	perror ("Can't start a session");
+      else
+	fprintf (stderr, "Session %d is process %d\n", ++sessions, (int) pid);
+      close (remote_desc);
     }
-
-#if defined(F_SETFL) && defined (FASYNC)
-  save_fcntl_flags = fcntl (remote_desc, F_GETFL, 0);
-  fcntl (remote_desc, F_SETFL, save_fcntl_flags | FASYNC);
-#if defined (F_SETOWN)
-  fcntl (remote_desc, F_SETOWN, getpid ());
-#endif
-#endif
-  disable_async_io ();
 }
+/* APPLE LOCAL end multi-session  */
 
 void
 remote_close (void)
 {
   close (remote_desc);
+  /* APPLE LOCAL shared memory reads  */
+  shm_release ();
 }
 
 /* Convert hex digit A to a number.  */
@@ -285,16 +415,17 @@ hexify (char *hex, const char *bin, int count)
 }
 
 /* Send a packet to the remote machine, with error checking.
-   The data of the packet is in BUF.  Returns >= 0 on success, -1 otherwise. */
+   The data of the packet is the CNT bytes in BUF, which may include
+   NULs.  Returns >= 0 on success, -1 otherwise. */
 
+/* APPLE LOCAL: Binary memory reads.  */
 int
-putpkt (char *buf)
+putpkt_binary (char *buf, int cnt)
 {
   int i;
   unsigned char csum = 0;
   char *buf2;
   char buf3[1];
-  int cnt = strlen (buf);
   char *p;
 
   buf2 = malloc (PBUFSIZ);
@@ -365,6 +496,16 @@ putpkt (char *buf)
   return 1;			/* Success! */
 }
 
+/* Send a packet to the remote machine, with error checking.
+   The data of the packet is the NUL-terminated string in BUF.
+   Returns >= 0 on success, -1 otherwise. */
+
+int
+putpkt (char *buf)
+{
+  return putpkt_binary (buf, strlen (buf));
+}
+
 /* Come here when we get an input interrupt from the remote side.  This
    interrupt should only be active while we are waiting for the child to do
    something.  About the only thing that should come through is a ^C, which
@@ -455,8 +596,10 @@ readchar (void)
   static int bufcnt = 0;
   static char *bufp;
 
+  /* APPLE LOCAL memory search: Keep all eight bits, so that binary
+     data such as a search pattern survives.  */
   if (bufcnt-- > 0)
-    return *bufp++ & 0x7f;
+    return *bufp++ & 0xff;
 
   bufcnt = read (remote_desc, buf, sizeof (buf));
 
@@ -472,7 +615,8 @@ readchar (void)
 
   bufp = buf;
   bufcnt--;
-  return *bufp++ & 0x7f;
+  /* APPLE LOCAL memory search  */
+  return *bufp++ & 0xff;
 }
 
 /* Read a packet from the remote machine, with error checking,
@@ -586,6 +730,59 @@ convert_int_to_ascii (unsigned char *from, char *to, int n)
 }
 
 
+/* APPLE LOCAL begin binary memory reads  */
+/* Build the reply to an 'x' packet in TO: a 'b' followed by the N
+   bytes at FROM.  The characters '$', '#', '}' and '*' are escaped
+   with '}' and XORed with 0x20, and runs of any other byte are
+   run-length encoded, so a zero-filled page costs a few characters
+   per hundred bytes.  Returns the length of the reply, which may
+   contain NULs; it is never more than 2 * N + 1.  */
+
+int
+convert_int_to_binary (unsigned char *from, char *to, int n)
+{
+  char *p = to;
+  int i = 0;
+
+  *p++ = 'b';
+  while (i < n)
+    {
+      unsigned char c = from[i++];
+      int repeat;
+
+      switch (c)
+	{
+	case '$':
+	case '#':
+	case '}':
+	case '*':
+	  *p++ = '}';
+	  *p++ = c ^ 0x20;
+	  continue;
+	}
+
+      *p++ = c;
+
+      /* GDB copies the character before a '*' as many more times as
+	 the following character minus 29 says.  The count has to be a
+	 printable character other than '#' and '$', and it is only
+	 worth sending for three or more copies.  */
+      for (repeat = 0; i + repeat < n && repeat < 126 - 29; repeat++)
+	if (from[i + repeat] != c)
+	  break;
+      if (repeat < 3)
+	continue;
+      if (repeat == '#' - 29 || repeat == '$' - 29)
+	repeat = '#' - 29 - 1;
+      *p++ = '*';
+      *p++ = repeat + 29;
+      i += repeat;
+    }
+
+  return p - to;
+}
+/* APPLE LOCAL end binary memory reads  */
+
 void
 convert_ascii_to_int (char *from, unsigned char *to, int n)
 {
@@ -648,9 +845,85 @@ dead_thread_notify (int id)
   enable_async_io ();
 }
 
+/* APPLE LOCAL begin stop reply memory  */
+/* Return the SIZE byte pointer at P, in the inferior's (that is, our
+   own) byte order.  */
+
+static CORE_ADDR
+extract_frame_chain_pointer (unsigned char *p, int size)
+{
+  if (size == 8)
+    {
+      unsigned long long value;
+      memcpy (&value, p, 8);
+      return (CORE_ADDR) value;
+    }
+  else
+    {
+      unsigned int value;
+      memcpy (&value, p, 4);
+      return (CORE_ADDR) value;
+    }
+}
+
+/* Append a "memory:ADDR=XX...;" field to BUF for each of the first
+   FRAME_CHAIN_DEPTH frame records, found by following the register
+   named by gdbserver_frame_chain_reg.  A frame record is the caller's
+   frame pointer followed by the return address.  Stop at a record
+   we can't read, at one that doesn't move up the stack, or when
+   another field might not fit before LIMIT.  Returns the new end of
+   BUF.  */
+
+static char *
+outframechain (char *buf, char *limit)
+{
+  unsigned char record[16];
+  CORE_ADDR fp, next;
+  int regno, size, depth, i;
+
+  if (gdbserver_frame_chain_reg == NULL || frame_chain_depth <= 0)
+    return buf;
+
+  regno = find_regno (gdbserver_frame_chain_reg);
+  size = register_size (regno);
+  if (size != 4 && size != 8)
+    return buf;
+
+  collect_register (regno, record);
+  fp = extract_frame_chain_pointer (record, size);
+
+  for (depth = 0; depth < frame_chain_depth && fp != 0; depth++)
+    {
+      /* "memory:" + address + "=" + two hex pointers + ";".  */
+      if (limit - buf < 7 + 16 + 1 + 4 * size + 1)
+	break;
+      if (read_inferior_memory (fp, record, 2 * size) != 0)
+	break;
+
+      strncpy (buf, "memory:", 7);
+      buf += 7;
+      for (i = size * 2; i > 0; i--)
+	*buf++ = tohex ((fp >> (i - 1) * 4) & 0xf);
+      *buf++ = '=';
+      convert_int_to_ascii (record, buf, 2 * size);
+      buf += 4 * size;
+      *buf++ = ';';
+
+      next = extract_frame_chain_pointer (record, size);
+      if ((unsigned long long) next <= (unsigned long long) fp)
+	break;
+      fp = next;
+    }
+
+  return buf;
+}
+/* APPLE LOCAL end stop reply memory  */
+
 void
 prepare_resume_reply (char *buf, char status, unsigned char signo)
 {
+  /* APPLE LOCAL stop reply memory  */
+  char *limit = buf + PBUFSIZ - 64;
   int nib, sig;
 
   *buf++ = status;
@@ -693,6 +966,10 @@ prepare_resume_reply (char *buf, char status, unsigned char signo)
 	  regp ++;
 	}
 
+      /* APPLE LOCAL: Send the frame pointer chain too, so GDB can
+	 unwind the first few frames without asking for memory.  */
+      buf = outframechain (buf, limit);
+
       /* Formerly, if the debugger had not used any thread features we would not
 	 burden it with a thread status response.  This was for the benefit of
 	 GDB 4.13 and older.  However, in recent GDB versions the check
@@ -726,6 +1003,68 @@ prepare_resume_reply (char *buf, char status, unsigned char signo)
   *buf++ = 0;
 }
 
+/* APPLE LOCAL begin thread summaries  */
+/* Build the reply to qfThreadSummary or qsThreadSummary in BUF,
+   starting with the thread at *THREAD_PTR and leaving *THREAD_PTR at
+   the first thread that didn't fit.  The reply is an 'm' followed by,
+   for each thread, a "thread:ID;" field, the expedited registers as in
+   a 'T' stop reply, and a "name:HEX;" field if the thread has a name.
+   Once every thread has been sent, the reply is an 'l'.  */
+
+void
+prepare_thread_summary (char *buf, struct inferior_list_entry **thread_ptr)
+{
+  struct thread_info *saved_inferior = current_inferior;
+  /* Any one thread's fields fit easily in the other half.  */
+  char *limit = buf + PBUFSIZ / 2;
+
+  if (*thread_ptr == NULL)
+    {
+      strcpy (buf, "l");
+      return;
+    }
+
+  *buf++ = 'm';
+  while (*thread_ptr != NULL && buf < limit)
+    {
+      struct thread_info *thread = (struct thread_info *) *thread_ptr;
+      const char **regp = gdbserver_expedite_regs;
+      const char *name = NULL;
+
+      sprintf (buf, "thread:%x;", thread_to_gdb_id (thread));
+      buf += strlen (buf);
+
+      /* The registers come from the current inferior's cache.  */
+      current_inferior = thread;
+      while (*regp)
+	{
+	  buf = outreg (find_regno (*regp), buf);
+	  regp ++;
+	}
+
+      if (the_target->thread_name != NULL)
+	name = (*the_target->thread_name) ((*thread_ptr)->id);
+      if (name != NULL && *name != '\0')
+	{
+	  int n = strlen (name);
+
+	  if (n > 32)
+	    n = 32;
+	  strncpy (buf, "name:", 5);
+	  buf += 5;
+	  convert_int_to_ascii ((unsigned char *) name, buf, n);
+	  buf += 2 * n;
+	  *buf++ = ';';
+	}
+
+      *thread_ptr = (*thread_ptr)->next;
+    }
+  *buf = '\0';
+
+  current_inferior = saved_inferior;
+}
+/* APPLE LOCAL end thread summaries  */
+
 void
 decode_m_packet (char *from, CORE_ADDR *mem_addr_ptr, unsigned int *len_ptr)
 {
@@ -774,20 +1113,333 @@ decode_M_packet (char *from, CORE_ADDR *mem_addr_ptr, unsigned int *len_ptr,
 /* Ask GDB for the address of NAME, and return it in ADDRP if found.
    Returns 1 if the symbol is found, 0 if it is not, -1 on error.  */
 
+/* APPLE LOCAL begin shared memory reads  */
+/* The mapping gdb shared with us through "vShmOpen", if any.  */
+static unsigned char *shm_base;
+static unsigned long shm_size;
+
+/* Forget the current shared mapping.  */
+
+void
+shm_release (void)
+{
+#ifdef HAVE_SYS_MMAN_H
+  if (shm_base != NULL)
+    munmap (shm_base, shm_size);
+#endif
+  shm_base = NULL;
+  shm_size = 0;
+}
+
+/* Handle "vShmOpen;HEXPATH,SIZE": map the first SIZE bytes of the file
+   gdb named.  Reply OK, or ENN if we can't, in which case gdb goes on
+   reading memory through packets.  */
+
+void
+handle_shm_open (char *own_buf)
+{
+  char path[1024];
+  char *p = own_buf + strlen ("vShmOpen;");
+  char *comma = strchr (p, ',');
+  unsigned long size;
+  int fd;
+
+  shm_release ();
+
+#ifdef HAVE_SYS_MMAN_H
+  if (comma != NULL && (comma - p) / 2 < sizeof (path))
+    {
+      struct stat st;
+      void *base;
+
+      convert_ascii_to_int (p, (unsigned char *) path, (comma - p) / 2);
+      path[(comma - p) / 2] = '\0';
+      size = strtoul (comma + 1, NULL, 16);
+
+      fd = open (path, O_RDWR);
+      if (fd >= 0)
+	{
+	  base = MAP_FAILED;
+	  if (size > 0 && fstat (fd, &st) == 0 && st.st_size >= size)
+	    base = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			 fd, 0);
+	  close (fd);
+	  if (base != MAP_FAILED)
+	    {
+	      shm_base = base;
+	      shm_size = size;
+	      write_ok (own_buf);
+	      return;
+	    }
+	}
+    }
+#endif
+
+  write_enn (own_buf);
+}
+
+/* Handle "vShmRead;ADDR,LENGTH": copy LENGTH bytes of memory at ADDR
+   to the start of the shared mapping, and reply "L" and how many bytes
+   were copied, in hex.  */
+
+void
+handle_shm_read (char *own_buf)
+{
+  CORE_ADDR mem_addr;
+  unsigned int len;
+
+  if (shm_base == NULL)
+    {
+      write_enn (own_buf);
+      return;
+    }
+
+  decode_m_packet (own_buf + strlen ("vShmRead;"), &mem_addr, &len);
+  if (len > shm_size)
+    len = shm_size;
+
+  if (read_inferior_memory (mem_addr, shm_base, len) != 0)
+    {
+      write_enn (own_buf);
+      return;
+    }
+  sprintf (own_buf, "L%x", len);
+}
+/* APPLE LOCAL end shared memory reads  */
+
+/* APPLE LOCAL begin memory search  */
+/* How much inferior memory handle_search_memory reads at once.  */
+#define SEARCH_CHUNK_SIZE 16000
+
+/* Undo the escaping of the LEN characters at ESCAPED, done as for an
+   'X' packet, into OUT.  Returns the number of bytes stored.  */
+
+static int
+unescape_binary (const char *escaped, int len, unsigned char *out)
+{
+  int i, n = 0;
+
+  for (i = 0; i < len; i++)
+    {
+      unsigned char c = escaped[i];
+
+      if (c == '}' && i + 1 < len)
+	c = escaped[++i] ^ 0x20;
+      out[n++] = c;
+    }
+  return n;
+}
+
+/* Return the first place in the LEN bytes at BUF where the PATTERN_LEN
+   bytes at PATTERN start, or NULL.  */
+
+static unsigned char *
+search_buffer (unsigned char *buf, CORE_ADDR len,
+	       const unsigned char *pattern, int pattern_len)
+{
+  unsigned char *p = buf;
+  unsigned char *last;
+
+  if (len < pattern_len)
+    return NULL;
+
+  last = buf + len - pattern_len;
+  while (p <= last)
+    {
+      p = memchr (p, pattern[0], last - p + 1);
+      if (p == NULL)
+	return NULL;
+      if (memcmp (p + 1, pattern + 1, pattern_len - 1) == 0)
+	return p;
+      p++;
+    }
+  return NULL;
+}
+
+/* Answer "qSearch:memory:ADDR;LEN;PATTERN", the PACKET_LEN characters
+   in OWN_BUF, with "1,ADDR" for the first match, "0" if there is
+   none, or an error if the memory can't be read.  */
+
+void
+handle_search_memory (char *own_buf, int packet_len)
+{
+  CORE_ADDR start_addr, search_space_len;
+  unsigned char *pattern, *search_buf, *found;
+  int pattern_len, search_buf_size;
+  char *p, *q;
+
+  p = own_buf + strlen ("qSearch:memory:");
+  q = strchr (p, ';');
+  if (q == NULL)
+    goto error;
+  decode_address (&start_addr, p, q - p);
+  p = q + 1;
+  q = strchr (p, ';');
+  if (q == NULL)
+    goto error;
+  decode_address (&search_space_len, p, q - p);
+  p = q + 1;
+
+  pattern = malloc (own_buf + packet_len - p + 1);
+  pattern_len = unescape_binary (p, own_buf + packet_len - p, pattern);
+  if (pattern_len == 0 || search_space_len < pattern_len)
+    {
+      free (pattern);
+      strcpy (own_buf, pattern_len == 0 ? "E01" : "0");
+      return;
+    }
+
+  /* Keep the last PATTERN_LEN - 1 bytes of each chunk at the start of
+     the buffer, so that a match straddling two chunks is found.  */
+  search_buf_size = SEARCH_CHUNK_SIZE + pattern_len - 1;
+  if (search_space_len < search_buf_size)
+    search_buf_size = search_space_len;
+  search_buf = malloc (search_buf_size);
+
+  if (read_inferior_memory (start_addr, search_buf, search_buf_size) != 0)
+    goto read_error;
+
+  while (search_space_len >= pattern_len)
+    {
+      CORE_ADDR nr_search_bytes = search_space_len;
+
+      if (nr_search_bytes > search_buf_size)
+	nr_search_bytes = search_buf_size;
+      found = search_buffer (search_buf, nr_search_bytes,
+			     pattern, pattern_len);
+      if (found != NULL)
+	{
+	  sprintf (own_buf, "1,%llx",
+		   (unsigned long long) (start_addr + (found - search_buf)));
+	  free (search_buf);
+	  free (pattern);
+	  return;
+	}
+
+      if (search_space_len > SEARCH_CHUNK_SIZE)
+	search_space_len -= SEARCH_CHUNK_SIZE;
+      else
+	search_space_len = 0;
+
+      if (search_space_len >= pattern_len)
+	{
+	  int keep_len = search_buf_size - SEARCH_CHUNK_SIZE;
+	  CORE_ADDR nr_to_read = search_space_len - keep_len;
+
+	  if (nr_to_read > SEARCH_CHUNK_SIZE)
+	    nr_to_read = SEARCH_CHUNK_SIZE;
+	  memmove (search_buf, search_buf + SEARCH_CHUNK_SIZE, keep_len);
+	  if (read_inferior_memory (start_addr + SEARCH_CHUNK_SIZE + keep_len,
+				    search_buf + keep_len, nr_to_read) != 0)
+	    goto read_error;
+	  start_addr += SEARCH_CHUNK_SIZE;
+	}
+    }
+
+  free (search_buf);
+  free (pattern);
+  strcpy (own_buf, "0");
+  return;
+
+read_error:
+  free (search_buf);
+  free (pattern);
+error:
+  write_enn (own_buf);
+}
+/* APPLE LOCAL end memory search  */
+
+/* APPLE LOCAL begin symbol cache  */
+static unsigned int
+symbol_cache_hash (const char *name)
+{
+  unsigned int hash = 0;
+
+  while (*name)
+    hash = hash * 31 + (unsigned char) *name++;
+  return hash % SYMBOL_CACHE_SIZE;
+}
+
+static void
+free_symbol_cache (void)
+{
+  struct sym_cache *sym, *next;
+  int i;
+
+  for (i = 0; i < SYMBOL_CACHE_SIZE; i++)
+    {
+      for (sym = symbol_cache[i]; sym; sym = next)
+	{
+	  next = sym->next;
+	  free ((char *) sym->name);
+	  free (sym);
+	}
+      symbol_cache[i] = NULL;
+    }
+}
+
+/* Note that the inferior is now process PID, running PROGRAM (which
+   may be NULL if we don't know it).  The symbol cache is kept if this
+   is the process it was filled for, and emptied otherwise.  */
+
+void
+symbol_cache_set_inferior (unsigned long pid, const char *program)
+{
+  struct stat st;
+
+  memset (&st, 0, sizeof (st));
+  if (program != NULL && stat (program, &st) != 0)
+    memset (&st, 0, sizeof (st));
+
+  if (pid == symbol_cache_pid
+      && st.st_dev == symbol_cache_dev
+      && st.st_ino == symbol_cache_ino
+      && st.st_mtime == symbol_cache_mtime)
+    return;
+
+  free_symbol_cache ();
+  symbol_cache_pid = pid;
+  symbol_cache_dev = st.st_dev;
+  symbol_cache_ino = st.st_ino;
+  symbol_cache_mtime = st.st_mtime;
+}
+
+/* Note that gdb is offering new symbols, so that anything it couldn't
+   find before is worth asking about again.  */
+
+void
+symbol_cache_new_symbols (void)
+{
+  symbol_cache_generation++;
+  if (symbol_cache_generation == 0)
+    symbol_cache_generation = 1;
+}
+/* APPLE LOCAL end symbol cache  */
+
 int
 look_up_one_symbol (const char *name, CORE_ADDR *addrp)
 {
   char own_buf[266], *p, *q;
   int len;
   struct sym_cache *sym;
+  /* APPLE LOCAL symbol cache  */
+  struct sym_cache **slot = &symbol_cache[symbol_cache_hash (name)];
 
   /* Check the cache first.  */
-  for (sym = symbol_cache; sym; sym = sym->next)
+  /* APPLE LOCAL begin symbol cache  */
+  for (sym = *slot; sym; sym = sym->next)
     if (strcmp (name, sym->name) == 0)
       {
-	*addrp = sym->addr;
-	return 1;
+	if (sym->found)
+	  {
+	    *addrp = sym->addr;
+	    return 1;
+	  }
+	if (sym->generation == symbol_cache_generation)
+	  return 0;
+	break;
       }
+  /* APPLE LOCAL end symbol cache  */
 
   /* Send the request.  */
   strcpy (own_buf, "qSymbol:");
@@ -817,18 +1469,28 @@ look_up_one_symbol (const char *name, CORE_ADDR *addrp)
   while (*q && *q != ':')
     q++;
 
+  /* APPLE LOCAL begin symbol cache  */
+  /* Save the answer in our cache, reusing a stale negative entry.  */
+  if (sym == NULL)
+    {
+      sym = malloc (sizeof (*sym));
+      sym->name = strdup (name);
+      sym->next = *slot;
+      *slot = sym;
+    }
+  sym->generation = symbol_cache_generation;
+
   /* Make sure we found a value for the symbol.  */
   if (p == q || *q == '\0')
-    return 0;
+    {
+      sym->found = 0;
+      return 0;
+    }
 
   decode_address (addrp, p, q - p);
-
-  /* Save the symbol in our cache.  */
-  sym = malloc (sizeof (*sym));
-  sym->name = strdup (name);
   sym->addr = *addrp;
-  sym->next = symbol_cache;
-  symbol_cache = sym;
+  sym->found = 1;
 
   return 1;
+  /* APPLE LOCAL end symbol cache  */
 }
@@ -68,6 +68,8 @@ start_inferior (char *argv[], char *statusptr)
 #endif
 
   signal_pid = create_inferior (argv[0], argv);
+  /* APPLE LOCAL symbol cache  */
+  symbol_cache_set_inferior (signal_pid, argv[0]);
 
   fprintf (stderr, "Process %s created; pid = %ld\n", argv[0],
 	   signal_pid);
@@ -102,6 +104,8 @@ attach_inferior (int pid, char *statusptr, int *sigptr)
      attach function, so that it can be the main thread instead of
      whichever we were told to attach to.  */
   signal_pid = pid;
+  /* APPLE LOCAL symbol cache  */
+  symbol_cache_set_inferior (signal_pid, NULL);
 
   *sigptr = mywait (statusptr, 0);
 
@@ -117,13 +121,19 @@ attach_inferior (int pid, char *statusptr, int *sigptr)
 extern int remote_debug;
 
 /* Handle all of the extended 'q' packets.  */
+/* APPLE LOCAL memory search: PACKET_LEN is the length of the packet,
+   which may hold binary data.  */
 void
-handle_query (char *own_buf)
+handle_query (char *own_buf, int packet_len)
 {
   static struct inferior_list_entry *thread_ptr;
+  /* APPLE LOCAL thread summaries  */
+  static struct inferior_list_entry *summary_ptr;
 
   if (strcmp ("qSymbol::", own_buf) == 0)
     {
+      /* APPLE LOCAL symbol cache  */
+      symbol_cache_new_symbols ();
       if (the_target->look_up_symbols != NULL)
 	(*the_target->look_up_symbols) ();
 
@@ -154,6 +164,21 @@ handle_query (char *own_buf)
 	}
     }
 
+  /* APPLE LOCAL begin thread summaries  */
+  if (strcmp ("qfThreadSummary", own_buf) == 0)
+    {
+      summary_ptr = all_threads.head;
+      prepare_thread_summary (own_buf, &summary_ptr);
+      return;
+    }
+
+  if (strcmp ("qsThreadSummary", own_buf) == 0)
+    {
+      prepare_thread_summary (own_buf, &summary_ptr);
+      return;
+    }
+  /* APPLE LOCAL end thread summaries  */
+
   if (the_target->read_auxv != NULL
       && strncmp ("qPart:auxv:read::", own_buf, 17) == 0)
     {
@@ -174,6 +199,14 @@ handle_query (char *own_buf)
       return;
     }
 
+  /* APPLE LOCAL begin memory search  */
+  if (strncmp ("qSearch:memory:", own_buf, 15) == 0)
+    {
+      handle_search_memory (own_buf, packet_len);
+      return;
+    }
+  /* APPLE LOCAL end memory search  */
+
   /* Otherwise we didn't know what packet it was.  Say we didn't
      understand it.  */
   own_buf[0] = 0;
@@ -308,6 +341,20 @@ handle_v_requests (char *own_buf, char *status, int *signal)
       return;
     }
 
+  /* APPLE LOCAL begin shared memory reads  */
+  if (strncmp (own_buf, "vShmOpen;", 9) == 0)
+    {
+      handle_shm_open (own_buf);
+      return;
+    }
+
+  if (strncmp (own_buf, "vShmRead;", 9) == 0)
+    {
+      handle_shm_read (own_buf);
+      return;
+    }
+  /* APPLE LOCAL end shared memory reads  */
+
   /* Otherwise we didn't know what packet it was.  Say we didn't
      understand it.  */
   own_buf[0] = 0;
@@ -342,11 +389,15 @@ static int attached;
 static void
 gdbserver_usage (void)
 {
-  error ("Usage:\tgdbserver COMM PROG [ARGS ...]\n"
-	 "\tgdbserver COMM --attach PID\n"
+  error ("Usage:\tgdbserver [--frame-chain=N] COMM PROG [ARGS ...]\n"
+	 "\tgdbserver [--frame-chain=N] COMM --attach PID\n"
+	 "\tgdbserver [--frame-chain=N] --multi HOST:PORT PROG [ARGS ...]\n"
 	 "\n"
 	 "COMM may either be a tty device (for serial debugging), or \n"
-	 "HOST:PORT to listen for a TCP connection.\n");
+	 "HOST:PORT to listen for a TCP connection.\n"
+	 "--frame-chain=N sends N frame records with each stop reply.\n"
+	 "--multi serves each connection from its own process, running\n"
+	 "its own copy of PROG.\n");
 }
 
 int
@@ -355,12 +406,16 @@ main (int argc, char *argv[])
   char ch, status, *own_buf;
   unsigned char mem_buf[2000];
   int i = 0;
+  /* APPLE LOCAL memory search  */
+  int packet_len;
   int signal;
   unsigned int len;
   CORE_ADDR mem_addr;
   int bad_attach;
   int pid;
   char *arg_end;
+  /* APPLE LOCAL multi-session  */
+  int multi_session = 0;
 
   if (setjmp (toplevel))
     {
@@ -381,6 +436,26 @@ main (int argc, char *argv[])
       for (i = 1; i < argc-1; i++)
 	argv[i] = argv[i+1];
 	    
+      argc--;
+    }
+  if (argc > 1 && strncmp (argv[1], "--frame-chain=", 14) == 0)
+    {
+      int i;
+      frame_chain_depth = atoi (argv[1] + 14);
+
+      for (i = 1; i < argc-1; i++)
+	argv[i] = argv[i+1];
+
+      argc--;
+    }
+  if (argc > 1 && strcmp (argv[1], "--multi") == 0)
+    {
+      int i;
+      multi_session = 1;
+
+      for (i = 1; i < argc-1; i++)
+	argv[i] = argv[i+1];
+
       argc--;
     }
   /* APPLE LOCAL END */
@@ -403,6 +478,18 @@ main (int argc, char *argv[])
   if (argc < 3 || bad_attach)
     gdbserver_usage();
 
+  /* APPLE LOCAL begin multi-session  */
+  /* Each session attaching the same process makes no sense, so every
+     one starts its own inferior.  Fork before the low level code sets
+     anything up, so that each session gets its own.  */
+  if (multi_session)
+    {
+      if (pid != 0)
+	error ("--multi can't be used with --attach");
+      remote_open_multi (argv[1]);
+    }
+  /* APPLE LOCAL end multi-session  */
+
   initialize_low ();
 
   own_buf = malloc (PBUFSIZ);
@@ -436,19 +523,25 @@ main (int argc, char *argv[])
 
   while (1)
     {
-      remote_open (argv[1]);
+      /* APPLE LOCAL multi-session: Already connected.  */
+      if (!multi_session)
+	remote_open (argv[1]);
 
     restart:
       setjmp (toplevel);
-      while (getpkt (own_buf) > 0)
+      /* APPLE LOCAL memory search  */
+      while ((packet_len = getpkt (own_buf)) > 0)
 	{
 	  unsigned char sig;
+	  /* APPLE LOCAL: Length of a binary reply, -1 for a string.  */
+	  int reply_len = -1;
 	  i = 0;
 	  ch = own_buf[i++];
 	  switch (ch)
 	    {
 	    case 'q':
-	      handle_query (own_buf);
+	      /* APPLE LOCAL memory search  */
+	      handle_query (own_buf, packet_len);
 	      break;
 	    case 'd':
 	      /* APPLE LOCAL: Handle all the debug flags here. */
@@ -554,6 +647,17 @@ main (int argc, char *argv[])
 	      else
 		write_enn (own_buf);
 	      break;
+	    /* APPLE LOCAL begin binary memory reads  */
+	    case 'x':
+	      decode_m_packet (&own_buf[1], &mem_addr, &len);
+	      /* GDB probes for this packet with a zero length read.  */
+	      if (len == 0
+		  || read_inferior_memory (mem_addr, mem_buf, len) == 0)
+		reply_len = convert_int_to_binary (mem_buf, own_buf, len);
+	      else
+		write_enn (own_buf);
+	      break;
+	    /* APPLE LOCAL end binary memory reads  */
 	    case 'M':
 	      decode_M_packet (&own_buf[1], &mem_addr, &len, mem_buf);
 	      if (write_inferior_memory (mem_addr, mem_buf, len) == 0)
@@ -728,7 +832,11 @@ main (int argc, char *argv[])
 	      break;
 	    }
 
-	  putpkt (own_buf);
+	  /* APPLE LOCAL: Binary memory reads.  */
+	  if (reply_len >= 0)
+	    putpkt_binary (own_buf, reply_len);
+	  else
+	    putpkt (own_buf);
 
 	  if (status == 'W')
 	    fprintf (stderr,
@@ -771,6 +879,19 @@ main (int argc, char *argv[])
 	  remote_close ();
 	  exit (0);
 	}
+      /* APPLE LOCAL begin multi-session  */
+      /* The listening process has the port, so a session can't wait
+	 for its debugger to come back.  */
+      else if (multi_session)
+	{
+	  fprintf (stderr, "Remote side has terminated connection.  "
+			   "GDBserver session exiting.\n");
+	  remote_close ();
+	  if (!attached)
+	    kill_inferior ();
+	  exit (0);
+	}
+      /* APPLE LOCAL end multi-session  */
       else
 	{
 	  fprintf (stderr, "Remote side has terminated connection.  "
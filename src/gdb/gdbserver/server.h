@@ -135,8 +135,11 @@ extern jmp_buf toplevel;
 /* Functions from remote-utils.c */
 
 int putpkt (char *buf);
+int putpkt_binary (char *buf, int cnt);
 int getpkt (char *buf);
 void remote_open (char *name);
+/* APPLE LOCAL multi-session  */
+void remote_open_multi (char *name);
 void remote_close (void);
 void write_ok (char *buf);
 void write_enn (char *buf);
@@ -146,9 +149,15 @@ void unblock_async_io (void);
 void block_async_io (void);
 void convert_ascii_to_int (char *from, unsigned char *to, int n);
 void convert_int_to_ascii (unsigned char *from, char *to, int n);
+int convert_int_to_binary (unsigned char *from, char *to, int n);
 void new_thread_notify (int id);
 void dead_thread_notify (int id);
 void prepare_resume_reply (char *buf, char status, unsigned char sig);
+/* APPLE LOCAL */
+extern int frame_chain_depth;
+/* APPLE LOCAL thread summaries  */
+void prepare_thread_summary (char *buf,
+			     struct inferior_list_entry **thread_ptr);
 
 void decode_m_packet (char *from, CORE_ADDR * mem_addr_ptr,
 		      unsigned int *len_ptr);
@@ -159,6 +168,17 @@ int unhexify (char *bin, const char *hex, int count);
 int hexify (char *hex, const char *bin, int count);
 
 int look_up_one_symbol (const char *name, CORE_ADDR *addrp);
+/* APPLE LOCAL begin shared memory reads  */
+void shm_release (void);
+void handle_shm_open (char *own_buf);
+void handle_shm_read (char *own_buf);
+/* APPLE LOCAL end shared memory reads  */
+/* APPLE LOCAL memory search  */
+void handle_search_memory (char *own_buf, int packet_len);
+/* APPLE LOCAL begin symbol cache  */
+void symbol_cache_set_inferior (unsigned long pid, const char *program);
+void symbol_cache_new_symbols (void);
+/* APPLE LOCAL end symbol cache  */
 
 /* Functions from ``signals.c''.  */
 enum target_signal target_signal_from_host (int hostsig);
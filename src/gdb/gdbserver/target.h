@@ -156,6 +156,10 @@ struct target_ops
 
   CORE_ADDR (*stopped_data_address) (void);
 
+  /* APPLE LOCAL: Return the name of thread THREAD_ID, or NULL if it
+     has none.  The result may live in a static buffer.  */
+
+  const char *(*thread_name) (unsigned long thread_id);
 };
 
 extern struct target_ops *the_target;
@@ -40,6 +40,14 @@ struct symtab;
 struct thread_info
 {
   struct thread_info *next;
+  /* APPLE LOCAL begin thread hash  */
+  /* The pointer to this thread in thread_list, so that removing it
+     doesn't need to walk the list.  */
+  struct thread_info **pprev;
+  /* Chain of threads in the same find_thread_pid hash bucket.  */
+  struct thread_info *hash_next;
+  struct thread_info **hash_pprev;
+  /* APPLE LOCAL end thread hash  */
   ptid_t ptid;			/* "Actual process id";
 				    In fact, this may be overloaded with 
 				    kernel thread id, etc.  */
@@ -89,6 +97,10 @@ struct thread_info
 /* APPLE LOCAL begin threads */
 extern struct thread_info *thread_list;
 extern int highest_thread_num;
+/* APPLE LOCAL thread hash  */
+/* Bumped each time init_thread_list throws the thread list away, so a
+   target can tell whether threads it added are still there.  */
+extern unsigned int thread_list_generation;
 
 struct thread_info *find_thread_id (int num);
 void prune_threads (void);
@@ -39,6 +39,8 @@
 #include "cp-abi.h"
 #include "gdb_assert.h"
 #include "exceptions.h"
+/* APPLE LOCAL check_typedef cache  */
+#include "hashtab.h"
 
 /* These variables point to the objects
    representing the predefined C data types.  */
@@ -1605,6 +1607,148 @@ remove_all_typedefs (struct type *type)
 }
 
 
+/* APPLE LOCAL begin check_typedef cache  */
+/* When check_typedef completes an opaque or stub type with a
+   definition from another objfile, it can't patch the stub, and when
+   it finds no definition at all, it has nothing to patch it with; so
+   it used to look the name up again, through every objfile, on every
+   call.  Remember both outcomes here instead, keyed by the stub.
+
+   The symbols a lookup could find only change when an objfile is
+   added or re-read, which bumps symbol_generation, so the whole
+   table is dropped when that moves on.  It's also dropped when an
+   objfile whose types it mentions is freed.  */
+
+struct check_typedef_cache_entry
+{
+  struct type *stub;
+
+  /* The definition found for STUB, or NULL if there was none.  */
+  struct type *resolved;
+};
+
+extern int symbol_generation;
+
+static htab_t check_typedef_cache;
+static int check_typedef_cache_generation;
+static const struct objfile_data *check_typedef_cache_objfile_data;
+
+static int check_typedef_cache_enabled = 1;
+
+static void
+show_check_typedef_cache_enabled (struct ui_file *file, int from_tty,
+				  struct cmd_list_element *c,
+				  const char *value)
+{
+  fprintf_filtered (file, _("\
+Caching of opaque and stub type resolution is %s.\n"),
+		    value);
+}
+
+static hashval_t
+check_typedef_cache_hash (const void *p)
+{
+  const struct check_typedef_cache_entry *entry = p;
+
+  return htab_hash_pointer (entry->stub);
+}
+
+static int
+check_typedef_cache_eq (const void *a, const void *b)
+{
+  const struct check_typedef_cache_entry *ea = a;
+  const struct check_typedef_cache_entry *eb = b;
+
+  return ea->stub == eb->stub;
+}
+
+static void
+check_typedef_cache_flush (void)
+{
+  if (check_typedef_cache != NULL)
+    htab_empty (check_typedef_cache);
+}
+
+static void
+check_typedef_cache_objfile_freed (struct objfile *objfile, void *data)
+{
+  check_typedef_cache_flush ();
+}
+
+/* Look STUB up in the cache.  Return 1 and set *RESOLVED if it is
+   there, otherwise return 0.  */
+
+static int
+check_typedef_cache_lookup (struct type *stub, struct type **resolved)
+{
+  struct check_typedef_cache_entry key;
+  struct check_typedef_cache_entry *entry;
+
+  if (!check_typedef_cache_enabled || check_typedef_cache == NULL)
+    return 0;
+
+  if (check_typedef_cache_generation != symbol_generation)
+    {
+      check_typedef_cache_flush ();
+      check_typedef_cache_generation = symbol_generation;
+      return 0;
+    }
+
+  key.stub = stub;
+  entry = htab_find (check_typedef_cache, &key);
+  if (entry == NULL)
+    return 0;
+  *resolved = entry->resolved;
+  return 1;
+}
+
+static void
+check_typedef_cache_note_objfile (struct objfile *objfile)
+{
+  if (objfile != NULL
+      && objfile_data (objfile, check_typedef_cache_objfile_data) == NULL)
+    set_objfile_data (objfile, check_typedef_cache_objfile_data, objfile);
+}
+
+static void
+check_typedef_cache_store (struct type *stub, struct type *resolved)
+{
+  struct check_typedef_cache_entry key;
+  struct check_typedef_cache_entry *entry;
+  void **slot;
+
+  if (!check_typedef_cache_enabled)
+    return;
+
+  if (check_typedef_cache == NULL)
+    check_typedef_cache = htab_create_alloc (64, check_typedef_cache_hash,
+					     check_typedef_cache_eq, xfree,
+					     xcalloc, xfree);
+
+  if (check_typedef_cache_generation != symbol_generation)
+    {
+      check_typedef_cache_flush ();
+      check_typedef_cache_generation = symbol_generation;
+    }
+
+  key.stub = stub;
+  slot = htab_find_slot (check_typedef_cache, &key, INSERT);
+  if (*slot == NULL)
+    {
+      entry = XMALLOC (struct check_typedef_cache_entry);
+      entry->stub = stub;
+      *slot = entry;
+    }
+  else
+    entry = *slot;
+  entry->resolved = resolved;
+
+  check_typedef_cache_note_objfile (TYPE_OBJFILE (stub));
+  if (resolved != NULL)
+    check_typedef_cache_note_objfile (TYPE_OBJFILE (resolved));
+}
+/* APPLE LOCAL end check_typedef cache  */
+
 /* Added by Bryan Boreham, Kewill, Sun Sep 17 18:07:17 1989.
 
    If this is a stubbed struct (i.e. declared as struct foo *), see if
@@ -1688,12 +1832,23 @@ check_typedef (struct type *type)
     {
       char *name = type_name_no_tag (type);
       struct type *newtype;
+      /* APPLE LOCAL check_typedef cache  */
+      struct type *stub = type;
       if (name == NULL)
 	{
 	  stub_noname_complaint ();
 	  return type;
 	}
-      newtype = lookup_transparent_type (name);
+      /* APPLE LOCAL begin check_typedef cache  */
+      if (!check_typedef_cache_lookup (stub, &newtype))
+	{
+	  newtype = lookup_transparent_type (name);
+	  /* A definition in the stub's objfile replaces the stub below, so
+	     there is no need to remember it.  */
+	  if (newtype == NULL || TYPE_OBJFILE (newtype) != TYPE_OBJFILE (stub))
+	    check_typedef_cache_store (stub, newtype);
+	}
+      /* APPLE LOCAL end check_typedef cache  */
 
       if (newtype)
 	{
@@ -1722,19 +1877,32 @@ check_typedef (struct type *type)
          as appropriate?  (this code was written before TYPE_NAME and
          TYPE_TAG_NAME were separate).  */
       struct symbol *sym;
+      /* APPLE LOCAL begin check_typedef cache  */
+      struct type *stub = type;
+      struct type *newtype;
+      /* APPLE LOCAL end check_typedef cache  */
       if (name == NULL)
 	{
 	  stub_noname_complaint ();
 	  return type;
 	}
-      sym = lookup_symbol (name, 0, STRUCT_DOMAIN, 0, (struct symtab **) NULL);
-      if (sym)
+      /* APPLE LOCAL begin check_typedef cache  */
+      if (!check_typedef_cache_lookup (stub, &newtype))
+	{
+	  sym = lookup_symbol (name, 0, STRUCT_DOMAIN, 0,
+			       (struct symtab **) NULL);
+	  newtype = sym ? SYMBOL_TYPE (sym) : NULL;
+	  if (newtype == NULL || TYPE_OBJFILE (newtype) != TYPE_OBJFILE (stub))
+	    check_typedef_cache_store (stub, newtype);
+	}
+      if (newtype)
         {
-          if (TYPE_OBJFILE (type) == TYPE_OBJFILE (SYMBOL_TYPE (sym)))
-            make_cvr_type (is_const, is_volatile, is_restrict, SYMBOL_TYPE (sym), &type);
+          if (TYPE_OBJFILE (type) == TYPE_OBJFILE (newtype))
+            make_cvr_type (is_const, is_volatile, is_restrict, newtype, &type);
           else
-            type = SYMBOL_TYPE (sym);
+            type = newtype;
         }
+      /* APPLE LOCAL end check_typedef cache  */
     }
 
   if (TYPE_TARGET_STUB (type))
@@ -3566,6 +3734,22 @@ Show resolution of opaque struct/class/union types (if set before loading symbol
 			   &setlist, &showlist);
   opaque_type_resolution = 1;
 
+  /* APPLE LOCAL begin check_typedef cache  */
+  check_typedef_cache_objfile_data
+    = register_objfile_data_with_cleanup (check_typedef_cache_objfile_freed);
+
+  add_setshow_boolean_cmd ("check-typedef-cache", class_maintenance,
+			   &check_typedef_cache_enabled, _("\
+Set whether the resolution of opaque and stub types is remembered."), _("\
+Show whether the resolution of opaque and stub types is remembered."), _("\
+When on, a definition of an opaque or stub type found in another objfile,\n\
+or the lack of one, is remembered until symbols are next added or freed,\n\
+instead of being looked up by name each time the type is used."),
+			   NULL, show_check_typedef_cache_enabled,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end check_typedef cache  */
+
   /* Build SIMD types.  */
   builtin_type_v4sf
     = init_simd_type ("__builtin_v4sf", builtin_type_float, "f", 4);
@@ -27,9 +27,82 @@
 #include "demangle.h"
 #include "gdb_assert.h"
 #include "gdb_string.h"
+/* APPLE LOCAL begin rtti cache  */
+#include "objfiles.h"
+#include "target.h"
+#include "gdbcmd.h"
+/* APPLE LOCAL end rtti cache  */
 
 static struct cp_abi_ops gnu_v3_abi_ops;
 
+/* APPLE LOCAL begin rtti cache  */
+/* Finding an object's dynamic type means looking up the minimal
+   symbol for its vtable, demangling it and looking up the class by
+   name, which is a lot of work to repeat for every element of a
+   container of polymorphic objects.  So remember, for each vtable
+   address, the type it was found to belong to.
+
+   The type and the vtable symbol belong to objfiles; if either
+   objfile goes away the whole cache is dropped (loading libraries
+   leaves it alone).  The offset to the top of the object is read from
+   the vtable itself, so it is read again in each new
+   target_stop_generation in case the vtable has been written.  */
+
+#define RTTI_CACHE_SIZE 1024
+
+struct rtti_cache_entry
+{
+  CORE_ADDR vtable_address;
+  struct type *run_time_type;
+  LONGEST offset_to_top;
+
+  /* The target_stop_generation OFFSET_TO_TOP was read in.  */
+  unsigned int generation;
+};
+
+static struct rtti_cache_entry rtti_cache[RTTI_CACHE_SIZE];
+
+/* Set on the objfiles cached types and vtables come from, so that
+   freeing one of them flushes the cache.  */
+static const struct objfile_data *rtti_cache_objfile_data;
+
+static int rtti_cache_enabled = 1;
+
+static void
+show_rtti_cache_enabled (struct ui_file *file, int from_tty,
+			 struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Caching of dynamic types by vtable is %s.\n"),
+		    value);
+}
+
+static void
+rtti_cache_flush (void)
+{
+  memset (rtti_cache, 0, sizeof (rtti_cache));
+}
+
+static void
+rtti_cache_objfile_freed (struct objfile *objfile, void *data)
+{
+  rtti_cache_flush ();
+}
+
+static void
+rtti_cache_note_objfile (struct objfile *objfile)
+{
+  if (objfile != NULL
+      && objfile_data (objfile, rtti_cache_objfile_data) == NULL)
+    set_objfile_data (objfile, rtti_cache_objfile_data, objfile);
+}
+
+static struct rtti_cache_entry *
+rtti_cache_slot (CORE_ADDR vtable_address)
+{
+  return &rtti_cache[(vtable_address >> 3) % RTTI_CACHE_SIZE];
+}
+/* APPLE LOCAL end rtti cache  */
+
 static int
 gnuv3_is_vtable_name (const char *name)
 {
@@ -200,6 +273,8 @@ gnuv3_rtti_type (struct value *value,
   struct type *run_time_type;
   struct type *base_type;
   LONGEST offset_to_top;
+  /* APPLE LOCAL rtti cache  */
+  struct rtti_cache_entry *entry;
 
   /* We only have RTTI for class objects.  */
   if (TYPE_CODE (values_type) != TYPE_CODE_CLASS)
@@ -232,6 +307,23 @@ gnuv3_rtti_type (struct value *value,
     = value_as_address (value_field (value, TYPE_VPTR_FIELDNO (values_type)));
   vtable = value_at_lazy (vtable_type,
                           vtable_address - vtable_address_point_offset ());
+
+  /* APPLE LOCAL begin rtti cache  */
+  entry = rtti_cache_slot (vtable_address);
+  if (rtti_cache_enabled && entry->run_time_type != NULL
+      && entry->vtable_address == vtable_address)
+    {
+      run_time_type = entry->run_time_type;
+      if (entry->generation != target_stop_generation)
+	{
+	  entry->offset_to_top
+	    = value_as_long (value_field (vtable, vtable_field_offset_to_top));
+	  entry->generation = target_stop_generation;
+	}
+      offset_to_top = entry->offset_to_top;
+      goto found;
+    }
+  /* APPLE LOCAL end rtti cache  */
   
   /* Find the linker symbol for this vtable.  */
   vtable_symbol
@@ -269,6 +361,24 @@ gnuv3_rtti_type (struct value *value,
   offset_to_top
     = value_as_long (value_field (vtable, vtable_field_offset_to_top));
 
+  /* APPLE LOCAL begin rtti cache  */
+  if (rtti_cache_enabled)
+    {
+      struct obj_section *osect;
+
+      osect = find_pc_section (vtable_address);
+      if (osect != NULL)
+	rtti_cache_note_objfile (osect->objfile);
+      rtti_cache_note_objfile (TYPE_OBJFILE (run_time_type));
+
+      entry->vtable_address = vtable_address;
+      entry->run_time_type = run_time_type;
+      entry->offset_to_top = offset_to_top;
+      entry->generation = target_stop_generation;
+    }
+
+ found:
+  /* APPLE LOCAL end rtti cache  */
   if (full_p)
     *full_p = (- offset_to_top == value_embedded_offset (value)
                && (TYPE_LENGTH (value_enclosing_type (value))
@@ -456,4 +566,20 @@ _initialize_gnu_v3_abi (void)
   init_gnuv3_ops ();
 
   register_cp_abi (&gnu_v3_abi_ops);
+
+  /* APPLE LOCAL begin rtti cache  */
+  rtti_cache_objfile_data
+    = register_objfile_data_with_cleanup (rtti_cache_objfile_freed);
+
+  add_setshow_boolean_cmd ("rtti-cache", class_maintenance,
+			   &rtti_cache_enabled, _("\
+Set whether dynamic types are remembered by vtable address."), _("\
+Show whether dynamic types are remembered by vtable address."), _("\
+When on, the dynamic type found for an object with a given vtable is\n\
+reused for later objects with the same vtable, until the objfile the\n\
+type or the vtable came from is freed."),
+			   NULL, show_rtti_cache_enabled,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end rtti cache  */
 }
@@ -217,6 +217,84 @@ wordsize (void)
   return TARGET_PTR_BIT / 8;
 }
 
+/* APPLE LOCAL begin debug register multiplexing  */
+/* Return the number of bytes watched by LEN_RW_BITS.  */
+
+static int
+i386_length_of_rw_bits (unsigned len_rw_bits)
+{
+  switch (len_rw_bits & (0x3 << 2))
+    {
+    case DR_LEN_2:
+      return 2;
+    case DR_LEN_4:
+      return 4;
+    case DR_LEN_8:
+      return 8;
+    default:
+      return 1;
+    }
+}
+
+/* Watchpoints for writes don't need to know exactly which bytes were
+   hit - breakpoint.c decides whether one triggered by comparing
+   values - so a write watchpoint can be served by any write slot that
+   covers it.  Return the index of an occupied write slot whose region
+   contains the LEN bytes at ADDR, or -1.  */
+
+static int
+i386_covering_write_slot (CORE_ADDR addr, int len)
+{
+  int i;
+
+  ALL_DEBUG_REGISTERS(i)
+    {
+      unsigned rw_len = I386_DR_GET_RW_LEN (i);
+
+      if (!I386_DR_VACANT (i)
+	  && (rw_len & 0x3) == DR_RW_WRITE
+	  && dr_mirror[i] <= addr
+	  && addr + len <= dr_mirror[i] + i386_length_of_rw_bits (rw_len))
+	return i;
+    }
+  return -1;
+}
+
+/* With every debug register taken, try to widen an occupied write
+   slot to an aligned region that also covers the LEN bytes at ADDR,
+   e.g. two adjacent ints watched with one 8-byte slot.  Return 0 if
+   that worked, -1 otherwise.  */
+
+static int
+i386_widen_write_slot (CORE_ADDR addr, int len)
+{
+  int i, width;
+
+  for (width = 2; width <= wordsize (); width *= 2)
+    ALL_DEBUG_REGISTERS(i)
+      {
+	unsigned rw_len = I386_DR_GET_RW_LEN (i);
+	CORE_ADDR base = dr_mirror[i] & ~((CORE_ADDR) width - 1);
+	CORE_ADDR slot_end;
+
+	if (I386_DR_VACANT (i) || (rw_len & 0x3) != DR_RW_WRITE)
+	  continue;
+	slot_end = dr_mirror[i] + i386_length_of_rw_bits (rw_len);
+	if (addr < base || addr + len > base + width
+	    || slot_end > base + width)
+	  continue;
+
+	dr_mirror[i] = base;
+	dr_ref_count[i]++;
+	I386_DR_SET_RW_LEN (i, i386_length_and_rw_bits (width, hw_write));
+	I386_DR_LOW_SET_ADDR (i, base);
+	I386_DR_LOW_SET_CONTROL (dr_control_mirror);
+	return 0;
+      }
+  return -1;
+}
+/* APPLE LOCAL end debug register multiplexing  */
+
 /* Implementation.  */
 
 /* Clear the reference counts and forget everything we knew about the
@@ -362,6 +440,20 @@ i386_insert_aligned_watchpoint (CORE_ADDR addr, unsigned len_rw_bits)
 	}
     }
 
+  /* APPLE LOCAL begin debug register multiplexing  */
+  /* A write watchpoint can also ride along in a slot that already
+     covers its bytes.  */
+  if ((len_rw_bits & 0x3) == DR_RW_WRITE)
+    {
+      i = i386_covering_write_slot (addr, i386_length_of_rw_bits (len_rw_bits));
+      if (i >= 0)
+	{
+	  dr_ref_count[i]++;
+	  return 0;
+	}
+    }
+  /* APPLE LOCAL end debug register multiplexing  */
+
   /* Next, look for a vacant debug register.  */
   ALL_DEBUG_REGISTERS(i)
     {
@@ -369,9 +461,15 @@ i386_insert_aligned_watchpoint (CORE_ADDR addr, unsigned len_rw_bits)
 	break;
     }
 
-  /* No more debug registers!  */
+  /* No more debug registers!  APPLE LOCAL debug register multiplexing:
+     Unless a write slot can be stretched to cover this one too.  */
   if (i >= DR_NADDR)
-    return -1;
+    {
+      if ((len_rw_bits & 0x3) == DR_RW_WRITE)
+	return i386_widen_write_slot (addr,
+				      i386_length_of_rw_bits (len_rw_bits));
+      return -1;
+    }
 
   /* Now set up the register I to watch our region.  */
 
@@ -427,6 +525,26 @@ i386_remove_aligned_watchpoint (CORE_ADDR addr, unsigned len_rw_bits)
 	}
     }
 
+  /* APPLE LOCAL begin debug register multiplexing  */
+  /* A write watchpoint that shared or widened another slot is found by
+     what that slot covers.  */
+  if (retval != 0 && (len_rw_bits & 0x3) == DR_RW_WRITE)
+    {
+      i = i386_covering_write_slot (addr, i386_length_of_rw_bits (len_rw_bits));
+      if (i >= 0)
+	{
+	  if (--dr_ref_count[i] == 0)
+	    {
+	      dr_mirror[i] = 0;
+	      I386_DR_DISABLE (i);
+	      I386_DR_LOW_SET_CONTROL (dr_control_mirror);
+	      I386_DR_LOW_RESET_ADDR (i);
+	    }
+	  retval = 0;
+	}
+    }
+  /* APPLE LOCAL end debug register multiplexing  */
+
   return retval;
 }
 
@@ -531,6 +649,45 @@ i386_insert_watchpoint (CORE_ADDR addr, int len, int type)
   return retval;
 }
 
+/* APPLE LOCAL begin debug register multiplexing  */
+/* Insert a watchpoint on the LEN bytes at ADDR for accesses of type
+   TYPE, all or nothing.  Return 0 on success; on failure put back the
+   debug registers as they were and return -1, so the caller can try
+   something else for this region.  */
+
+int
+i386_insert_watchpoint_whole (CORE_ADDR addr, int len, int type)
+{
+  CORE_ADDR saved_mirror[DR_NADDR];
+  int saved_ref_count[DR_NADDR];
+  unsigned saved_control = dr_control_mirror;
+  int i;
+
+  memcpy (saved_mirror, dr_mirror, sizeof (dr_mirror));
+  memcpy (saved_ref_count, dr_ref_count, sizeof (dr_ref_count));
+
+  if (i386_insert_watchpoint (addr, len, type) == 0)
+    return 0;
+
+  dr_control_mirror = saved_control;
+  ALL_DEBUG_REGISTERS(i)
+    {
+      if (dr_mirror[i] != saved_mirror[i])
+	{
+	  dr_mirror[i] = saved_mirror[i];
+	  if (I386_DR_VACANT (i))
+	    I386_DR_LOW_RESET_ADDR (i);
+	  else
+	    I386_DR_LOW_SET_ADDR (i, dr_mirror[i]);
+	}
+      dr_ref_count[i] = saved_ref_count[i];
+    }
+  I386_DR_LOW_SET_CONTROL (dr_control_mirror);
+
+  return -1;
+}
+/* APPLE LOCAL end debug register multiplexing  */
+
 /* Remove a watchpoint that watched the memory region which starts at
    address ADDR, whose length is LEN bytes, and for accesses of the
    type TYPE.  Return 0 on success, -1 on failure.  */
@@ -51,6 +51,8 @@
 #include "bfd.h"
 #include "elf-bfd.h"
 #include "dis-asm.h"
+/* APPLE LOCAL displaced stepping  */
+#include "disasm.h"
 
 #include "gdb_assert.h"
 #include "gdb_string.h"
@@ -1660,6 +1662,217 @@ i386_gdbarch_init (struct gdbarch_info info, struct gdbarch_list *arches)
   return gdbarch;
 }
 
+/* APPLE LOCAL begin displaced stepping  */
+/* Displaced stepping.  The instruction at the breakpoint is copied to
+   a scratch area and stepped there, so the breakpoint can stay in
+   place for the other threads.  Anything whose effect depends on
+   where it executes has to be fixed up afterwards; anything we can't
+   fix up is refused and stepped over the old way.  */
+
+/* Which ModR/M-taking opcodes we need to look at: for the one byte
+   and 0x0f-prefixed opcode maps, whether the opcode has a ModR/M
+   byte.  */
+
+static const unsigned char i386_onebyte_has_modrm[256] = {
+  /*	   0 1 2 3 4 5 6 7 8 9 a b c d e f	  */
+  /* 00 */ 1,1,1,1,0,0,0,0,1,1,1,1,0,0,0,0, /* 00 */
+  /* 10 */ 1,1,1,1,0,0,0,0,1,1,1,1,0,0,0,0, /* 10 */
+  /* 20 */ 1,1,1,1,0,0,0,0,1,1,1,1,0,0,0,0, /* 20 */
+  /* 30 */ 1,1,1,1,0,0,0,0,1,1,1,1,0,0,0,0, /* 30 */
+  /* 40 */ 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 40 */
+  /* 50 */ 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 50 */
+  /* 60 */ 0,0,1,1,0,0,0,0,0,1,0,1,0,0,0,0, /* 60 */
+  /* 70 */ 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 70 */
+  /* 80 */ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, /* 80 */
+  /* 90 */ 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 90 */
+  /* a0 */ 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* a0 */
+  /* b0 */ 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* b0 */
+  /* c0 */ 1,1,0,0,1,1,1,1,0,0,0,0,0,0,0,0, /* c0 */
+  /* d0 */ 1,1,1,1,0,0,0,0,1,1,1,1,1,1,1,1, /* d0 */
+  /* e0 */ 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* e0 */
+  /* f0 */ 0,0,0,0,0,0,1,1,0,0,0,0,0,0,1,1  /* f0 */
+  /*	   0 1 2 3 4 5 6 7 8 9 a b c d e f	  */
+};
+
+static const unsigned char i386_twobyte_has_modrm[256] = {
+  /*	   0 1 2 3 4 5 6 7 8 9 a b c d e f	  */
+  /* 00 */ 1,1,1,1,0,0,0,0,0,0,0,0,0,1,0,1, /* 0f */
+  /* 10 */ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, /* 1f */
+  /* 20 */ 1,1,1,1,1,1,1,0,1,1,1,1,1,1,1,1, /* 2f */
+  /* 30 */ 0,0,0,0,0,0,0,0,1,0,1,0,0,0,0,0, /* 3f */
+  /* 40 */ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, /* 4f */
+  /* 50 */ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, /* 5f */
+  /* 60 */ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, /* 6f */
+  /* 70 */ 1,1,1,1,1,1,1,0,1,1,1,1,1,1,1,1, /* 7f */
+  /* 80 */ 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 8f */
+  /* 90 */ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, /* 9f */
+  /* a0 */ 0,0,0,1,1,1,1,1,0,0,0,1,1,1,1,1, /* af */
+  /* b0 */ 1,1,1,1,1,1,1,1,1,0,1,1,1,1,1,1, /* bf */
+  /* c0 */ 1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0, /* cf */
+  /* d0 */ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, /* df */
+  /* e0 */ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, /* ef */
+  /* f0 */ 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0  /* ff */
+  /*	   0 1 2 3 4 5 6 7 8 9 a b c d e f	  */
+};
+
+/* How i386_displaced_step_fixup should treat the pc after the step.
+   The low bits of the KIND it is handed hold one of these, the
+   I386_DISPLACED_CALL bit, and the instruction length above that.  */
+
+enum
+{
+  /* The pc just moved past the copy; move it past the original.  */
+  I386_DISPLACED_PLAIN,
+  /* A pc-relative jump or call: wherever the copy went, the original
+     would have gone the same distance.  */
+  I386_DISPLACED_RELATIVE,
+  /* The new pc came from a register or memory, and is already
+     right.  */
+  I386_DISPLACED_ABSOLUTE
+};
+
+#define I386_DISPLACED_CLASS_MASK 0x3
+#define I386_DISPLACED_CALL 0x4
+#define I386_DISPLACED_LEN_SHIFT 8
+
+static int
+i386_prefix_byte_p (gdb_byte b, int amd64)
+{
+  switch (b)
+    {
+    case 0x26: case 0x2e: case 0x36: case 0x3e:
+    case 0x64: case 0x65: case 0x66: case 0x67:
+    case 0xf0: case 0xf2: case 0xf3:
+      return 1;
+    }
+  /* REX.  */
+  return amd64 && (b & 0xf0) == 0x40;
+}
+
+int
+i386_displaced_step_copy_insn (struct gdbarch *gdbarch, CORE_ADDR from,
+			       gdb_byte *buf, int *kind)
+{
+  int amd64 = (gdbarch_tdep (gdbarch)->wordsize == 8);
+  int len, i, opcode, modrm = -1;
+  int class = I386_DISPLACED_PLAIN;
+
+  /* Let the disassembler work out how long the instruction is.  */
+  len = gdb_print_insn (from, gdb_null);
+  if (len <= 0 || len > DISPLACED_STEP_MAX_INSN)
+    return 0;
+  if (deprecated_read_memory_nobpt (from, buf, len) != 0)
+    return 0;
+
+  for (i = 0; i < len && i386_prefix_byte_p (buf[i], amd64); i++)
+    ;
+  if (i >= len)
+    return 0;
+
+  opcode = buf[i++];
+  if (opcode == 0x0f)
+    {
+      if (i >= len)
+	return 0;
+      opcode = 0x100 | buf[i++];
+      /* The three byte maps (0f 38, 0f 3a) all take a ModR/M.  */
+      if (opcode == 0x138 || opcode == 0x13a)
+	{
+	  i++;
+	  if (i < len)
+	    modrm = buf[i];
+	}
+      else if (i386_twobyte_has_modrm[opcode & 0xff] && i < len)
+	modrm = buf[i];
+    }
+  else if (i386_onebyte_has_modrm[opcode] && i < len)
+    modrm = buf[i];
+
+  /* A %rip-relative operand would address memory relative to the
+     copy.  */
+  if (amd64 && modrm != -1 && (modrm & 0xc7) == 0x05)
+    return 0;
+
+  if (opcode == 0xe8)
+    class = I386_DISPLACED_RELATIVE | I386_DISPLACED_CALL;
+  else if (opcode == 0xe9 || opcode == 0xeb
+	   || (opcode >= 0x70 && opcode <= 0x7f)
+	   || (opcode >= 0xe0 && opcode <= 0xe3)
+	   || (opcode >= 0x180 && opcode <= 0x18f))
+    class = I386_DISPLACED_RELATIVE;
+  else if (opcode == 0xc2 || opcode == 0xc3
+	   || opcode == 0xca || opcode == 0xcb)
+    class = I386_DISPLACED_ABSOLUTE;
+  else if (opcode == 0xff && modrm != -1)
+    {
+      switch ((modrm >> 3) & 7)
+	{
+	case 2:
+	  class = I386_DISPLACED_ABSOLUTE | I386_DISPLACED_CALL;
+	  break;
+	case 4:
+	  class = I386_DISPLACED_ABSOLUTE;
+	  break;
+	case 3:
+	case 5:
+	  /* Far call and jump.  */
+	  return 0;
+	}
+    }
+  else
+    switch (opcode)
+      {
+      case 0x9a:		/* lcall */
+      case 0xea:		/* ljmp */
+      case 0xcc:		/* int3 */
+      case 0xcd:		/* int */
+      case 0xce:		/* into */
+      case 0xcf:		/* iret */
+      case 0xf1:		/* icebp */
+      case 0x105:		/* syscall */
+      case 0x107:		/* sysret */
+      case 0x134:		/* sysenter */
+      case 0x135:		/* sysexit */
+	return 0;
+      }
+
+  *kind = class | (len << I386_DISPLACED_LEN_SHIFT);
+  return len;
+}
+
+void
+i386_displaced_step_fixup (struct gdbarch *gdbarch, int kind,
+			   CORE_ADDR from, CORE_ADDR to,
+			   struct regcache *regcache)
+{
+  int len = kind >> I386_DISPLACED_LEN_SHIFT;
+  int ptr_size = gdbarch_ptr_bit (gdbarch) / TARGET_CHAR_BIT;
+  ULONGEST pc;
+
+  regcache_cooked_read_unsigned (regcache, PC_REGNUM, &pc);
+
+  /* An absolute transfer leaves the pc alone, unless it somehow fell
+     through.  */
+  if ((kind & I386_DISPLACED_CLASS_MASK) != I386_DISPLACED_ABSOLUTE
+      || pc == to + len)
+    {
+      pc += from - to;
+      regcache_cooked_write_unsigned (regcache, PC_REGNUM, pc);
+    }
+
+  /* A call pushed the address after the copy; make it return to the
+     instruction after the original instead.  */
+  if (kind & I386_DISPLACED_CALL)
+    {
+      ULONGEST sp;
+
+      regcache_cooked_read_unsigned (regcache, SP_REGNUM, &sp);
+      if (read_memory_unsigned_integer (sp, ptr_size) == to + len)
+	write_memory_unsigned_integer (sp, ptr_size, from + len);
+    }
+}
+/* APPLE LOCAL end displaced stepping  */
+
 /* APPLE LOCAL: a function for checking the prologue parser by hand. */
 
 static void
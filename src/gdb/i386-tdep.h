@@ -195,6 +195,13 @@ extern void i386_svr4_init_abi (struct gdbarch_info, struct gdbarch *);
 
 /* APPLE LOCAL */
 int i386_find_picbase_setup (CORE_ADDR, CORE_ADDR *, enum i386_regnum *);
+
+/* APPLE LOCAL begin displaced stepping  */
+extern int i386_displaced_step_copy_insn (struct gdbarch *, CORE_ADDR,
+					  gdb_byte *, int *);
+extern void i386_displaced_step_fixup (struct gdbarch *, int, CORE_ADDR,
+				       CORE_ADDR, struct regcache *);
+/* APPLE LOCAL end displaced stepping  */
 
 
 /* Functions and variables exported from i386bsd-tdep.c.  */
@@ -371,6 +371,76 @@ push_dummy_code (struct gdbarch *gdbarch,
 static int timer_fired;
 static int hand_call_function_timeout;
 
+/* APPLE LOCAL begin hand call fast path  */
+/* When set, function calls run only the current thread and the work
+   that doesn't have to be redone while the other threads stay put is
+   done once per stop.  */
+
+static int hand_call_fast_path = 0;
+
+static void
+show_hand_call_fast_path (struct ui_file *file, int from_tty,
+			  struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Running only the current thread for repeated function calls is %s.\n"),
+		    value);
+}
+
+/* The number returned by hand_call_stop_id, or 0.  */
+
+static unsigned int hand_call_current_stop_id;
+static unsigned int hand_call_last_stop_id;
+
+#if defined (NM_NEXTSTEP)
+/* The stop, and thread, for which we last aborted the current thread
+   out of whatever it was doing in the kernel.  */
+
+static unsigned int hand_call_aborted_stop_id;
+static ptid_t hand_call_aborted_ptid;
+#endif
+
+unsigned int
+hand_call_stop_id (void)
+{
+  return hand_call_current_stop_id;
+}
+
+/* Run from the hand call cleanup chain when the inferior is resumed
+   for real.  */
+
+static void
+reset_hand_call_stop_id (void *ignore)
+{
+  hand_call_current_stop_id = 0;
+}
+
+/* Called as a function call starts.  Arrange for it to run just the
+   current thread if the fast path is on, and keep track of whether the
+   other threads have been left alone since the stop.  */
+
+static void
+hand_call_fast_path_setup (void)
+{
+  if (!hand_call_fast_path || !target_can_lock_scheduler)
+    {
+      /* This call may let the other threads run.  */
+      hand_call_current_stop_id = 0;
+      return;
+    }
+
+  if (hand_call_current_stop_id == 0)
+    {
+      if (++hand_call_last_stop_id == 0)
+	hand_call_last_stop_id = 1;
+      hand_call_current_stop_id = hand_call_last_stop_id;
+      make_hand_call_cleanup (reset_hand_call_stop_id, NULL);
+    }
+
+  make_cleanup_set_restore_scheduler_locking_mode (scheduler_locking_on);
+}
+/* APPLE LOCAL end hand call fast path  */
+
 int 
 set_hand_function_call_timeout (int newval)
 {
@@ -476,6 +546,9 @@ hand_function_call (struct value *function, struct type *expect_type,
   retbuf = regcache_xmalloc (current_gdbarch);
   retbuf_cleanup = make_cleanup_regcache_xfree (retbuf);
 
+  /* APPLE LOCAL hand call fast path  */
+  hand_call_fast_path_setup ();
+
   /* APPLE LOCAL: Calling into the ObjC runtime can block against other threads
      that hold the runtime lock.  Since any random function call might go into 
      the runtime, we added a gdb mode where hand_function_call ALWAYS checks
@@ -523,7 +596,19 @@ hand_function_call (struct value *function, struct type *expect_type,
 
   /* APPLE LOCAL begin inferior function call */
 #if defined (NM_NEXTSTEP)
-  macosx_setup_registers_before_hand_call ();
+  /* APPLE LOCAL begin hand call fast path  */
+  /* Once the thread has made one call since the stop, it is sitting at
+     the call's breakpoint rather than in the kernel, so there is
+     nothing left to abort.  */
+  if (hand_call_stop_id () == 0
+      || hand_call_aborted_stop_id != hand_call_stop_id ()
+      || !ptid_equal (hand_call_aborted_ptid, inferior_ptid))
+    {
+      macosx_setup_registers_before_hand_call ();
+      hand_call_aborted_stop_id = hand_call_stop_id ();
+      hand_call_aborted_ptid = inferior_ptid;
+    }
+  /* APPLE LOCAL end hand call fast path  */
 
 #endif
   /* FIXME: This really needs to go in the target vector....  */
@@ -1260,5 +1345,19 @@ A value of zero disables the timer.",
                             NULL,
                             NULL,
 			    &setlist, &showlist);
+
+  /* APPLE LOCAL begin hand call fast path  */
+  add_setshow_boolean_cmd ("hand-call-fast-path", class_obscure,
+			   &hand_call_fast_path, _("\
+Set whether function calls run only the current thread and share setup."), _("\
+Show whether function calls run only the current thread and share setup."), _("\
+When on, a function called in the program being debugged runs only the\n\
+current thread, and the safety checks made before a call are done once\n\
+per stop and reused by any further calls made before the program is\n\
+resumed.  This makes calling a function repeatedly much cheaper, but a\n\
+called function that waits for another thread will hang."),
+			   NULL, show_hand_call_fast_path,
+			   &setlist, &showlist);
+  /* APPLE LOCAL end hand call fast path  */
    
 }
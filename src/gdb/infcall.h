@@ -45,4 +45,14 @@ extern int inferior_function_calls_disabled_p;
 int set_hand_function_call_timeout (int newval);
 int hand_function_call_timeout_p ();
 
+/* APPLE LOCAL begin hand call fast path  */
+/* Return a nonzero number identifying the current stop, if every
+   function call gdb has made since the user last resumed the inferior
+   ran only the current thread.  Results that depend only on the state
+   of the other threads (for instance, whether some lock is held) may
+   be cached under this number.  Return 0 if there's no such
+   guarantee.  */
+extern unsigned int hand_call_stop_id (void);
+/* APPLE LOCAL end hand call fast path  */
+
 #endif
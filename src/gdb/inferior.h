@@ -202,6 +202,21 @@ extern void reopen_exec_file (void);
 
 extern void resume (int, enum target_signal);
 
+/* APPLE LOCAL range stepping  */
+extern int range_step_bounds (CORE_ADDR *start, CORE_ADDR *end);
+
+/* APPLE LOCAL begin displaced stepping  */
+/* The longest instruction a gdbarch_displaced_step_copy_insn method
+   may hand back.  */
+#define DISPLACED_STEP_MAX_INSN 16
+
+extern int displaced_step_in_progress (void);
+/* APPLE LOCAL end displaced stepping  */
+
+/* APPLE LOCAL non-stop: If non-zero, a target that supports it stops
+   only the threads that reported an event, and lets the rest run.  */
+extern int non_stop;
+
 /* From misc files */
 
 extern void default_print_registers_info (struct gdbarch *gdbarch,
@@ -477,6 +492,11 @@ extern int attach_flag;
 
 extern int start_with_shell_flag;
 
+/* APPLE LOCAL start with shell: Whether the last fork_inferior went
+   through the shell after all; defined in fork-child.c.  */
+
+extern int startup_used_shell;
+
 /* APPLE LOCAL - Keep track of recent breakpoint locations, for correctly
    handling multi-threaded programs.  */
 
@@ -51,6 +51,8 @@
 
 #include "gdb_assert.h"
 #include "mi/mi-common.h"
+/* APPLE LOCAL stop latency  */
+#include "gdb-stats.h"
 /* APPLE LOCAL - subroutine inlining  */
 #include "inlining.h"
 
@@ -103,6 +105,9 @@ struct execution_control_state;
 
 static int currently_stepping (struct execution_control_state *ecs);
 
+/* APPLE LOCAL displaced stepping  */
+static int displaced_step_prepare (CORE_ADDR pc);
+
 static void xdb_handle_command (char *args, int from_tty);
 
 static int prepare_to_proceed (void);
@@ -127,6 +132,18 @@ show_step_stop_if_no_debug (struct ui_file *file, int from_tty,
   fprintf_filtered (file, _("Mode of the step operation is %s.\n"), value);
 }
 
+/* APPLE LOCAL begin range stepping  */
+/* If non-zero, a target may keep single-stepping a thread on its own
+   while it stays inside the line being stepped; see range_step_bounds.  */
+static int range_stepping = 0;
+static void
+show_range_stepping (struct ui_file *file, int from_tty,
+		     struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Range stepping is %s.\n"), value);
+}
+/* APPLE LOCAL end range stepping  */
+
 /* In asynchronous mode, but simulating synchronous execution. */
 
 /* APPLE LOCAL: async support */
@@ -773,6 +790,13 @@ resume (int step, enum target_signal sig)
 
       resume_ptid = RESUME_ALL;	/* Default */
 
+      /* APPLE LOCAL begin displaced stepping  */
+      /* With the instruction moved out of the way, the breakpoints can
+	 go back in and the other threads needn't be held back.  */
+      if (step && trap_expected)
+	displaced_step_prepare (read_pc ());
+      /* APPLE LOCAL end displaced stepping  */
+
       if ((step || singlestep_breakpoints_inserted_p)
 	  && (stepping_past_singlestep_breakpoint
 	      || (!breakpoints_inserted && breakpoint_here_p (read_pc ()))))
@@ -819,6 +843,229 @@ resume (int step, enum target_signal sig)
 
   discard_cleanups (old_cleanups);
 }
+
+/* APPLE LOCAL begin range stepping  */
+/* Called by a target's to_resume method when it is asked to step.
+   If the step is one of many through [*START, *END) that
+   handle_inferior_event would answer with nothing more than another
+   step, set *START and *END and return non-zero; the target may then
+   keep stepping the thread itself, and only report a stop once the pc
+   leaves the range, lands on a breakpoint, or anything other than a
+   single-step happens.  Return zero if every step must be reported:
+   when we are stepping over a breakpoint with breakpoints lifted,
+   when a step-resume breakpoint is in charge, when watchpoints need
+   to see each instruction, and so on.  */
+
+int
+range_step_bounds (CORE_ADDR *start, CORE_ADDR *end)
+{
+  if (!range_stepping)
+    return 0;
+
+  /* A range end of zero means we aren't stepping a line at all, and
+     "stepi" uses one.  */
+  if (step_range_end <= 1 || step_range_start >= step_range_end)
+    return 0;
+
+  if (trap_expected || !breakpoints_inserted
+      || step_resume_breakpoint != NULL
+      || stop_soon != NO_STOP_QUIETLY
+      || SOFTWARE_SINGLE_STEP_P ()
+      || bpstat_should_step ()
+      || bpstat_have_active_hw_watchpoints ())
+    return 0;
+
+  *start = step_range_start;
+  *end = step_range_end;
+  return 1;
+}
+/* APPLE LOCAL end range stepping  */
+
+/* APPLE LOCAL begin displaced stepping  */
+/* A displaced step: instead of lifting the breakpoint under a thread
+   and stepping it with every other thread stopped, copy the
+   instruction to a scratch area, step the copy with the breakpoints
+   in and the other threads running, then let the architecture fix up
+   the registers as if the original had been executed.  */
+
+/* The thread taking a displaced step, or null_ptid if none is.  */
+static ptid_t displaced_step_ptid;
+
+/* Where the instruction came from and where the copy was put.  */
+static CORE_ADDR displaced_step_from;
+static CORE_ADDR displaced_step_to;
+
+/* How long the copy is, what gdbarch_displaced_step_copy_insn said
+   about it, and what it overwrote.  */
+static int displaced_step_len;
+static int displaced_step_kind;
+static gdb_byte displaced_step_saved[DISPLACED_STEP_MAX_INSN];
+
+/* Non-zero if we are allowed to step over breakpoints this way.  */
+static int use_displaced_stepping = 0;
+static void
+show_use_displaced_stepping (struct ui_file *file, int from_tty,
+			     struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Displaced stepping is %s.\n"), value);
+}
+
+/* APPLE LOCAL begin non-stop  */
+int non_stop = 0;
+static void
+show_non_stop (struct ui_file *file, int from_tty,
+	       struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Controlling the inferior in non-stop mode is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end non-stop  */
+
+/* Called by a target's to_resume method: non-zero if the step it has
+   been asked for is a displaced one, so the other threads may be let
+   go along with it.  */
+
+int
+displaced_step_in_progress (void)
+{
+  return !ptid_equal (displaced_step_ptid, null_ptid);
+}
+
+static void
+displaced_step_restore_scratch (void *ignore)
+{
+  if (target_write_memory (displaced_step_to, displaced_step_saved,
+			   displaced_step_len) != 0)
+    warning (_("Could not restore the text at 0x%s after a displaced step."),
+	     paddr_nz (displaced_step_to));
+}
+
+/* Try to set up a displaced step of the instruction at PC in
+   inferior_ptid, which is sitting on a breakpoint we were about to
+   step over with breakpoints lifted.  On success the breakpoints are
+   back in, the thread's pc points at the copy, and we return
+   non-zero.  Return zero if the step has to be done the usual way.
+
+   The copy goes at the program's entry point: that is text that is
+   already mapped executable and won't be run again.  We only do this
+   for a plain step-over on the way to a continue - while stepping a
+   line, handle_inferior_event wants to see this thread alone move.  */
+
+static int
+displaced_step_prepare (CORE_ADDR pc)
+{
+  gdb_byte insn[DISPLACED_STEP_MAX_INSN];
+  struct obj_section *osect;
+  struct cleanup *old_chain;
+  CORE_ADDR scratch;
+  int len, kind, i;
+
+  if (!use_displaced_stepping
+      || !gdbarch_displaced_step_copy_insn_p (current_gdbarch)
+      || SOFTWARE_SINGLE_STEP_P ()
+      || scheduler_mode != schedlock_off
+      || step_range_end != 0
+      || breakpoint_here_p (pc) != ordinary_breakpoint_here)
+    return 0;
+
+  scratch = entry_point_address ();
+  if (scratch == 0 || scratch == INVALID_ENTRY_POINT)
+    return 0;
+  if (pc + DISPLACED_STEP_MAX_INSN > scratch
+      && pc < scratch + DISPLACED_STEP_MAX_INSN)
+    return 0;
+  osect = find_pc_section (scratch);
+  if (osect == NULL || osect->the_bfd_section == NULL
+      || !(bfd_get_section_flags (osect->objfile->obfd,
+				  osect->the_bfd_section) & SEC_CODE))
+    return 0;
+
+  len = gdbarch_displaced_step_copy_insn (current_gdbarch, pc, insn, &kind);
+  if (len <= 0)
+    return 0;
+
+  /* A breakpoint in the scratch area would be written over.  */
+  for (i = 0; i < len; i++)
+    if (breakpoint_here_p (scratch + i) != no_breakpoint_here)
+      return 0;
+
+  displaced_step_from = pc;
+  displaced_step_to = scratch;
+  displaced_step_len = len;
+  displaced_step_kind = kind;
+  if (target_read_memory (scratch, displaced_step_saved, len) != 0
+      || target_write_memory (scratch, insn, len) != 0)
+    return 0;
+
+  old_chain = make_cleanup (displaced_step_restore_scratch, NULL);
+  insert_breakpoints ();
+  breakpoints_inserted = 1;
+  discard_cleanups (old_chain);
+
+  write_pc (scratch);
+  displaced_step_ptid = inferior_ptid;
+
+  if (debug_infrun)
+    fprintf_unfiltered (gdb_stdlog,
+			"infrun: displaced step of 0x%s at 0x%s\n",
+			paddr_nz (pc), paddr_nz (scratch));
+  return 1;
+}
+
+/* Called with each event: if a displaced step was under way, put the
+   scratch area back and move the stepping thread to where it would
+   be had it executed the original instruction.  If the event is
+   somebody else's, the step-over is over either way, so the thread
+   that was stepping will simply be resumed with its peers.  */
+
+static void
+displaced_step_finish (ptid_t event_ptid, struct target_waitstatus *ws)
+{
+  struct cleanup *old_chain;
+  ptid_t ptid = displaced_step_ptid;
+  int switched = 0;
+  CORE_ADDR pc;
+
+  if (ptid_equal (ptid, null_ptid)
+      || ws->kind == TARGET_WAITKIND_IGNORE
+      || ws->kind == TARGET_WAITKIND_SPURIOUS)
+    return;
+
+  displaced_step_ptid = null_ptid;
+  if (ws->kind == TARGET_WAITKIND_EXITED
+      || ws->kind == TARGET_WAITKIND_SIGNALLED)
+    return;
+
+  displaced_step_restore_scratch (NULL);
+
+  old_chain = save_inferior_ptid ();
+  if (!ptid_equal (inferior_ptid, ptid))
+    {
+      registers_changed ();
+      inferior_ptid = ptid;
+      switched = 1;
+    }
+
+  pc = read_pc ();
+  if ((ptid_equal (event_ptid, ptid)
+       && ws->kind == TARGET_WAITKIND_STOPPED
+       && ws->value.sig == TARGET_SIGNAL_TRAP)
+      || pc != displaced_step_to)
+    gdbarch_displaced_step_fixup (current_gdbarch, displaced_step_kind,
+				  displaced_step_from, displaced_step_to,
+				  current_regcache);
+  else
+    /* The copy never ran; put the thread back on the original.  */
+    write_pc (displaced_step_from);
+
+  if (!ptid_equal (event_ptid, ptid))
+    trap_expected = 0;
+
+  if (switched)
+    registers_changed ();
+  do_cleanups (old_chain);
+}
+/* APPLE LOCAL end displaced stepping  */
 
 
 /* Clear out all variables saying what to do when inferior is continued.
@@ -920,6 +1167,27 @@ prepare_to_proceed (void)
    over calls to it and cleared when the inferior is started.  */
 static CORE_ADDR prev_pc;
 
+/* APPLE LOCAL begin breakpoint always-inserted  */
+/* Take out the breakpoints that are in the way of single-stepping a
+   thread off PC.  Normally that is all of them.  In always-inserted
+   mode only the ones at PC are lifted; the rest stay in, which is
+   safe on Mac OS X since the other threads are kept suspended while
+   one is being stepped.  Whatever was lifted is put back by the usual
+   insert_breakpoints call once the step is done.  Returns what
+   remove_breakpoints does.  */
+
+static int
+remove_breakpoints_for_step_over (CORE_ADDR pc)
+{
+  if (breakpoints_always_inserted_mode ())
+    {
+      remove_breakpoints_at (pc);
+      return 0;
+    }
+  return remove_breakpoints ();
+}
+/* APPLE LOCAL end breakpoint always-inserted  */
+
 /* Basic routine for continuing the program in various fashions.
 
    ADDR is the address to resume at, or -1 for resume where stopped.
@@ -1014,9 +1282,21 @@ proceed (CORE_ADDR addr, enum target_signal siggnal, int step)
     oneproc = 1;
 
   if (oneproc)
-    /* We will get a trace trap after one instruction.
-       Continue it automatically and insert breakpoints then.  */
-    trap_expected = 1;
+    {
+      /* APPLE LOCAL begin breakpoint always-inserted  */
+      /* Breakpoints may have been left in at the last stop.  Only the
+	 ones under the pc are in the way of the step; take those out
+	 and let the code below put them back after the trap.  */
+      if (breakpoints_inserted || breakpoints_always_inserted_mode ())
+	{
+	  remove_breakpoints_at (read_pc ());
+	  breakpoints_inserted = 0;
+	}
+      /* APPLE LOCAL end breakpoint always-inserted  */
+      /* We will get a trace trap after one instruction.
+	 Continue it automatically and insert breakpoints then.  */
+      trap_expected = 1;
+    }
   else
     {
       insert_breakpoints ();
@@ -1245,15 +1525,25 @@ wait_for_inferior (void)
 
   while (1)
     {
+      /* APPLE LOCAL stop latency  */
+      struct gdb_stat_timer timer;
+
+      /* APPLE LOCAL stop latency  */
+      stop_latency_start (&timer);
       if (deprecated_target_wait_hook)
 	/* APPLE LOCAL 3rd arg to target_wait*  */
 	ecs->ptid = deprecated_target_wait_hook (ecs->waiton_ptid, ecs->wp, NULL);
       else
 	/* APPLE LOCAL 3rd arg to target_wait*  */
 	ecs->ptid = target_wait (ecs->waiton_ptid, ecs->wp, NULL);
+      /* APPLE LOCAL begin stop latency  */
+      stop_latency_stop (STOP_PHASE_TARGET_WAIT, &timer);
 
       /* Now figure out what to do with the result of the result.  */
+      stop_latency_start (&timer);
       handle_inferior_event (ecs);
+      stop_latency_stop (STOP_PHASE_HANDLE_EVENT, &timer);
+      /* APPLE LOCAL end stop latency  */
 
       if (!ecs->wait_some_more)
 	break;
@@ -1277,6 +1567,8 @@ void
 fetch_inferior_event (void *client_data)
 {
   static struct cleanup *old_cleanups;
+  /* APPLE LOCAL stop latency  */
+  struct gdb_stat_timer timer;
 
   async_ecs = &async_ecss;
 
@@ -1302,6 +1594,8 @@ fetch_inferior_event (void *client_data)
       registers_changed ();
     }
 
+  /* APPLE LOCAL stop latency  */
+  stop_latency_start (&timer);
   if (deprecated_target_wait_hook)
     async_ecs->ptid =
       /* APPLE LOCAL 3rd arg to target_wait*  */
@@ -1309,9 +1603,14 @@ fetch_inferior_event (void *client_data)
   else
     /* APPLE LOCAL 3rd arg to target_wait*  */
     async_ecs->ptid = target_wait (async_ecs->waiton_ptid, async_ecs->wp, client_data);
+  /* APPLE LOCAL begin stop latency  */
+  stop_latency_stop (STOP_PHASE_TARGET_WAIT, &timer);
 
   /* Now figure out what to do with the result of the result.  */
+  stop_latency_start (&timer);
   handle_inferior_event (async_ecs);
+  stop_latency_stop (STOP_PHASE_HANDLE_EVENT, &timer);
+  /* APPLE LOCAL end stop latency  */
 
   if (!async_ecs->wait_some_more)
     {
@@ -1520,6 +1819,9 @@ handle_inferior_event (struct execution_control_state *ecs)
   target_last_wait_ptid = ecs->ptid;
   target_last_waitstatus = *ecs->wp;
 
+  /* APPLE LOCAL displaced stepping  */
+  displaced_step_finish (ecs->ptid, ecs->wp);
+
   adjust_pc_after_break (ecs);
 
   switch (ecs->infwait_state)
@@ -1569,7 +1871,8 @@ handle_inferior_event (struct execution_control_state *ecs)
     }
   ecs->infwait_state = infwait_normal_state;
 
-  flush_cached_frames ();
+  /* APPLE LOCAL frame reuse  */
+  flush_cached_frames_at_stop ();
 
   /* If it's a new process, add it to the thread database */
 
@@ -1932,7 +2235,8 @@ handle_inferior_event (struct execution_control_state *ecs)
 	      singlestep_breakpoints_inserted_p = 0;
 	    }
 
-	  remove_status = remove_breakpoints ();
+	  /* APPLE LOCAL breakpoint always-inserted  */
+	  remove_status = remove_breakpoints_for_step_over (stop_pc);
 	  /* Did we fail to remove breakpoints?  If so, try
 	     to set the PC past the bp.  (There's at least
 	     one situation in which we can fail to remove
@@ -2415,7 +2719,8 @@ extern void macosx_print_extra_stop_info (int, CORE_ADDR);
 	  fprintf_unfiltered (gdb_stdlog, "infrun: BPSTATE_WHAT_SINGLE\n");
 	if (breakpoints_inserted)
 	  {
-	    remove_breakpoints ();
+	    /* APPLE LOCAL breakpoint always-inserted  */
+	    remove_breakpoints_for_step_over (stop_pc);
 	  }
 	breakpoints_inserted = 0;
 	ecs->another_trap = 1;
@@ -2478,7 +2783,8 @@ extern void macosx_print_extra_stop_info (int, CORE_ADDR);
 	       were trying to single-step off a breakpoint.  Go back
 	       to doing that.  */
 	    ecs->step_after_step_resume_breakpoint = 0;
-	    remove_breakpoints ();
+	    /* APPLE LOCAL breakpoint always-inserted  */
+	    remove_breakpoints_for_step_over (stop_pc);
 	    breakpoints_inserted = 0;
 	    ecs->another_trap = 1;
 	    keep_going (ecs);
@@ -3674,9 +3980,32 @@ normal_stop (void)
 {
   struct target_waitstatus last;
   ptid_t last_ptid;
+  /* APPLE LOCAL begin stop latency  */
+  struct gdb_stat_timer stop_timer;
+  struct gdb_stat_timer phase_timer;
+
+  stop_latency_start (&stop_timer);
+  /* APPLE LOCAL end stop latency  */
 
   get_last_target_status (&last_ptid, &last);
 
+  /* APPLE LOCAL begin coalesced dyld notifications  */
+#ifdef MACOSX_DYLD
+  /* Read any shared libraries whose load notifications were put
+     off, before we print where we stopped.  */
+  if (target_has_execution
+      && last.kind != TARGET_WAITKIND_SIGNALLED
+      && last.kind != TARGET_WAITKIND_EXITED)
+    {
+      /* APPLE LOCAL stop latency  */
+      stop_latency_start (&phase_timer);
+      macosx_dyld_flush_pending_notifications ();
+      /* APPLE LOCAL stop latency  */
+      stop_latency_stop (STOP_PHASE_SHLIBS, &phase_timer);
+    }
+#endif
+  /* APPLE LOCAL end coalesced dyld notifications  */
+
   /* As with the notification of thread events, we want to delay
      notifying the user that we've switched thread context until
      the inferior actually stops.
@@ -3706,7 +4035,11 @@ normal_stop (void)
        DECR_PC_AFTER_BREAK needs to just go away.  */
     deprecated_update_frame_pc_hack (get_current_frame (), read_pc ());
 
-  if (target_has_execution && breakpoints_inserted)
+  /* APPLE LOCAL begin breakpoint always-inserted  */
+  /* In always-inserted mode the breakpoints stay where they are until
+     we resume.  */
+  if (target_has_execution && breakpoints_inserted
+      && !breakpoints_always_inserted_mode ())
     {
       if (remove_breakpoints ())
 	{
@@ -3717,7 +4050,9 @@ It might be running in another process.\n\
 Further execution is probably impossible.\n"));
 	}
     }
-  breakpoints_inserted = 0;
+  if (!target_has_execution || !breakpoints_always_inserted_mode ())
+    breakpoints_inserted = 0;
+  /* APPLE LOCAL end breakpoint always-inserted  */
 
   /* APPLE LOCAL: omission of breakpoint_auto_delete call.  */
 
@@ -3746,8 +4081,14 @@ Further execution is probably impossible.\n"));
       /* Look up the hook_stop and run it (CLI internally handles problem
 	 of stop_command's pre-hook not existing).  */
       if (stop_command)
-	catch_errors (hook_stop_stub, stop_command,
-		      "Error while running hook_stop:\n", RETURN_MASK_ALL);
+	{
+	  /* APPLE LOCAL stop latency  */
+	  stop_latency_start (&phase_timer);
+	  catch_errors (hook_stop_stub, stop_command,
+			"Error while running hook_stop:\n", RETURN_MASK_ALL);
+	  /* APPLE LOCAL stop latency  */
+	  stop_latency_stop (STOP_PHASE_HOOKS, &phase_timer);
+	}
       
       goto done;
     }
@@ -3759,6 +4100,8 @@ Further execution is probably impossible.\n"));
 
   if (!stop_stack_dummy)
     {
+      /* APPLE LOCAL stop latency  */
+      stop_latency_start (&phase_timer);
       select_frame (get_current_frame ());
 
       /* Print current location without a level number, if
@@ -3895,9 +4238,19 @@ Further execution is probably impossible.\n"));
 	      }
 	      /* APPLE LOCAL end subroutine inlining  */
 
+	  /* APPLE LOCAL begin stop latency  */
+	  stop_latency_stop (STOP_PHASE_PRINT, &phase_timer);
+
 	  /* Display the auto-display expressions.  */
+	  stop_latency_start (&phase_timer);
 	  do_displays ();
+	  stop_latency_stop (STOP_PHASE_DISPLAYS, &phase_timer);
+	  /* APPLE LOCAL end stop latency  */
 	}
+      /* APPLE LOCAL begin stop latency  */
+      else
+	stop_latency_stop (STOP_PHASE_PRINT, &phase_timer);
+      /* APPLE LOCAL end stop latency  */
     }
 
   /* APPLE LOCAL: This was moved from above the section of code that 
@@ -3906,8 +4259,14 @@ Further execution is probably impossible.\n"));
   /* Look up the hook_stop and run it (CLI internally handles problem
      of stop_command's pre-hook not existing).  */
   if (stop_command)
-    catch_errors (hook_stop_stub, stop_command,
-		  "Error while running hook_stop:\n", RETURN_MASK_ALL);
+    {
+      /* APPLE LOCAL stop latency  */
+      stop_latency_start (&phase_timer);
+      catch_errors (hook_stop_stub, stop_command,
+		    "Error while running hook_stop:\n", RETURN_MASK_ALL);
+      /* APPLE LOCAL stop latency  */
+      stop_latency_stop (STOP_PHASE_HOOKS, &phase_timer);
+    }
 
   /* END APPLE LOCAL  */
 
@@ -3946,6 +4305,8 @@ done:
 
   breakpoint_auto_delete (stop_bpstat);
 
+  /* APPLE LOCAL stop latency  */
+  stop_latency_start (&phase_timer);
   if (!stop_stack_dummy)
     {
        /* APPLE LOCAL: Don't invoke hooks for called-by-hand functions */
@@ -3965,9 +4326,14 @@ done:
 	}
     }
   /* APPLE LOCAL end */
+  /* APPLE LOCAL begin stop latency  */
+  stop_latency_stop (STOP_PHASE_HOOKS, &phase_timer);
 
   annotate_stopped ();
+  stop_latency_start (&phase_timer);
   observer_notify_normal_stop (stop_bpstat);
+  stop_latency_stop (STOP_PHASE_OBSERVERS, &phase_timer);
+  /* APPLE LOCAL end stop latency  */
 
   /* APPLE LOCAL begin checkpoints */
   {
@@ -3988,6 +4354,11 @@ done:
       currently_inside_optimized_code = 0;
   }
   /* APPLE LOCAL end Inform users about debugging optimzied code  */
+
+  /* APPLE LOCAL begin stop latency  */
+  stop_latency_stop (STOP_PHASE_NORMAL_STOP, &stop_timer);
+  stop_latency_finish ();
+  /* APPLE LOCAL end stop latency  */
 }
 
 /* APPLE LOCAL: Sometimes we don't want to
@@ -5018,6 +5389,46 @@ function is skipped and the step command stops at a different source line."),
 			   show_step_stop_if_no_debug,
 			   &setlist, &showlist);
 
+  /* APPLE LOCAL begin range stepping  */
+  add_setshow_boolean_cmd ("range-stepping", class_run, &range_stepping, _("\
+Set whether the target may step a whole source line by itself."), _("\
+Show whether the target may step a whole source line by itself."), _("\
+When on, and the target supports it, \"step\" and \"next\" let the target\n\
+keep single-stepping while the program stays within the line being\n\
+stepped, instead of reporting every instruction back to GDB."),
+			   NULL,
+			   show_range_stepping,
+			   &setlist, &showlist);
+  /* APPLE LOCAL end range stepping  */
+
+  /* APPLE LOCAL begin displaced stepping  */
+  add_setshow_boolean_cmd ("displaced-stepping", class_run,
+			   &use_displaced_stepping, _("\
+Set whether breakpoints are stepped over by stepping a copy of the instruction."), _("\
+Show whether breakpoints are stepped over by stepping a copy of the instruction."), _("\
+When on, and the architecture supports it, GDB steps a thread off a\n\
+breakpoint by single-stepping a copy of the instruction placed elsewhere,\n\
+so the breakpoint can stay inserted and the other threads keep running.\n\
+When off, the breakpoints are removed and the other threads are held\n\
+while the thread steps."),
+			   NULL,
+			   show_use_displaced_stepping,
+			   &setlist, &showlist);
+  /* APPLE LOCAL end displaced stepping  */
+
+  /* APPLE LOCAL begin non-stop  */
+  add_setshow_boolean_cmd ("non-stop", class_run, &non_stop, _("\
+Set whether other threads keep running when one thread stops."), _("\
+Show whether other threads keep running when one thread stops."), _("\
+When on, and the target supports it, only the thread that hit a breakpoint\n\
+or took an exception is stopped; the other threads keep running while you\n\
+examine it, and breakpoints stay inserted.  When off, every thread is\n\
+stopped whenever the program stops."),
+			   NULL,
+			   show_non_stop,
+			   &setlist, &showlist);
+  /* APPLE LOCAL end non-stop  */
+
   /* APPLE LOCAL: minimal-signal-handling mode.  */
   add_setshow_boolean_cmd ("minimal-signal-handling", class_run, &minimal_signal_handling,
 			   "Set whether we run with a minimal signal handling set.",
@@ -86,6 +86,21 @@ struct pending_node {
 
 struct inlined_function_data global_inlined_call_stack;
 
+/* APPLE LOCAL begin inlined entry index  */
+/* The pc the line tables were last consulted for by
+   inlined_function_update_call_stack, the target_stop_generation at
+   the time, and how many records the stack had afterwards.  While
+   those still hold, asking again would only find the same records.  */
+
+static struct
+{
+  int valid;
+  CORE_ADDR pc;
+  unsigned int generation;
+  int nelts;
+} inlined_call_stack_cache;
+/* APPLE LOCAL end inlined entry index  */
+
 /* The following data structure is used mostly for constructing
    accurate backtraces.  Given the pc within any function in the call
    stack, if any functions are inlined at that point, their
@@ -124,12 +139,12 @@ static void reset_temp_frame_stack (void);
 static void insert_pending_node (struct pending_node *, struct pending_node **);
 
 /* APPLE LOCAL begin inlined function symbols & blocks  */
-static void rb_tree_find_all_nodes_in_between (struct rb_tree_node *, CORE_ADDR,
-					       CORE_ADDR, 
-					       struct rb_tree_node_list **);
-static void rb_tree_find_all_exact_matches (struct rb_tree_node *, CORE_ADDR,
-					    CORE_ADDR, 
-					    struct rb_tree_node_list **);
+static void inlined_subroutine_nodes_in_between (struct objfile *, CORE_ADDR,
+						 CORE_ADDR,
+						 struct rb_tree_node_list **);
+static void inlined_subroutine_exact_matches (struct objfile *, CORE_ADDR,
+					      CORE_ADDR,
+					      struct rb_tree_node_list **);
 /* APPLE LOCAL end inlined funciton symbols & blocks  */
 
 /* Given a set of non-contiguous address ranges (presumably for a function), 
@@ -714,6 +729,8 @@ inlined_function_reinitialize_call_stack (void)
 	                          * sizeof (struct inlined_call_stack_record));
 
   reset_saved_call_stack ();
+  /* APPLE LOCAL inlined entry index  */
+  inlined_call_stack_cache.valid = 0;
 }
 
 /* Return flag indicating if global_inlined_call_stack data has been
@@ -936,81 +953,335 @@ verify_stack (void)
 }
 
 
-/* Given a red-black tree (ROOT) containing inlined subroutine
-   records, find all records whose inlining start address (main key)
-   is greater than or equal to START, and whose inlining end address
-   (third_key) is less than or equal to END.  Return all such records
-   in the list MATCHES.  */
+/* APPLE LOCAL begin inlined subroutine index  */
 
-static void
-rb_tree_find_all_nodes_in_between (struct rb_tree_node *root, CORE_ADDR start,
-				   CORE_ADDR end, 
-				   struct rb_tree_node_list **matches)
+/* The inlined subroutine tree of an objfile only grows while its
+   symtabs are being read in; the lookups made every time the inferior
+   stops don't change it.  So for those lookups we flatten the tree
+   into an array of its nodes, in tree order, and binary search that
+   instead of chasing pointers down the tree.  Adding a node throws
+   the array away, and the next lookup builds it again.  */
+
+static int
+count_inlined_subroutine_nodes (struct rb_tree_node *root)
 {
-  struct rb_tree_node_list *tmp_node;
+  if (root == NULL)
+    return 0;
 
-  if (!root)
+  return 1 + count_inlined_subroutine_nodes (root->left)
+    + count_inlined_subroutine_nodes (root->right);
+}
+
+static void
+flatten_inlined_subroutine_tree (struct rb_tree_node *root,
+				 struct rb_tree_node **index, int *n)
+{
+  if (root == NULL)
     return;
 
-    if (start <= root->key
-        && root->key < end
-	&& root->third_key < end)
-      {
-	tmp_node = (struct rb_tree_node_list *) xmalloc (sizeof (struct rb_tree_node_list));
-	tmp_node->node = root;
-	tmp_node->next = *matches;
-	*matches = tmp_node;
-      }
+  flatten_inlined_subroutine_tree (root->left, index, n);
+  index[(*n)++] = root;
+  flatten_inlined_subroutine_tree (root->right, index, n);
+}
 
-    if (start <= root->key)
-      {
-	rb_tree_find_all_nodes_in_between (root->left, start, end, matches);
-	rb_tree_find_all_nodes_in_between (root->right, start, end, matches);
-      }
-    else if (start > root->key)
-      rb_tree_find_all_nodes_in_between (root->right, start, end, matches);
+/* Return OBJFILE's inlined subroutine index, building it if need be.
+   The number of nodes in it is returned in *SIZE.  */
+
+static struct rb_tree_node **
+inlined_subroutine_index (struct objfile *objfile, int *size)
+{
+  if (objfile->inlined_subroutine_index == NULL
+      && objfile->inlined_subroutine_data != NULL)
+    {
+      int n = 0;
+
+      objfile->inlined_subroutine_index_size
+	= count_inlined_subroutine_nodes (objfile->inlined_subroutine_data);
+      objfile->inlined_subroutine_index
+	= xmalloc (objfile->inlined_subroutine_index_size
+		   * sizeof (struct rb_tree_node *));
+      flatten_inlined_subroutine_tree (objfile->inlined_subroutine_data,
+				       objfile->inlined_subroutine_index, &n);
+      gdb_assert (n == objfile->inlined_subroutine_index_size);
+    }
+
+  if (objfile->inlined_subroutine_index == NULL)
+    {
+      *size = 0;
+      return NULL;
+    }
+
+  *size = objfile->inlined_subroutine_index_size;
+  return objfile->inlined_subroutine_index;
 }
 
-/* APPLE LOCAL begin inlined function symbols & blocks  */
+/* Throw away OBJFILE's inlined subroutine index, because the tree it
+   was built from has changed or is going away.  */
+
+void
+inlined_subroutine_invalidate_index (struct objfile *objfile)
+{
+  if (objfile->inlined_subroutine_index != NULL)
+    xfree (objfile->inlined_subroutine_index);
+  objfile->inlined_subroutine_index = NULL;
+  objfile->inlined_subroutine_index_size = 0;
+}
+
+/* Return the position of the first node in INDEX (of SIZE nodes)
+   that sorts at or after KEY, SECONDARY_KEY and THIRD_KEY, in the
+   order plain_tree_insert keeps them in.  */
+
+static int
+inlined_subroutine_lower_bound (struct rb_tree_node **index, int size,
+				CORE_ADDR key, int secondary_key,
+				CORE_ADDR third_key)
+{
+  int low = 0;
+  int high = size;
+
+  while (low < high)
+    {
+      int mid = low + (high - low) / 2;
+      struct rb_tree_node *node = index[mid];
 
-/* Given a red-black tree (ROOT) containing inlined subroutine records, find
-   all records whose inlining start address (main key) equals KEY and whose
-   inlining end address (third key) equals THIRD_KEY.  Return all such records
-   in the list MATCHES.  */
+      if (node->key < key
+	  || (node->key == key
+	      && (node->secondary_key < secondary_key
+		  || (node->secondary_key == secondary_key
+		      && node->third_key < third_key))))
+	low = mid + 1;
+      else
+	high = mid;
+    }
+
+  return low;
+}
+
+/* Add NODE to the end of the list whose last element is *TAIL.  */
 
 static void
-rb_tree_find_all_exact_matches (struct rb_tree_node *root, CORE_ADDR key,
-				CORE_ADDR third_key, 
-				struct rb_tree_node_list **matches)
+append_rb_tree_node (struct rb_tree_node *node,
+		     struct rb_tree_node_list ***tail)
 {
   struct rb_tree_node_list *tmp_node;
-  
-  if (!root)
-    return;
-  
-  if (key == root->key)
+
+  tmp_node = (struct rb_tree_node_list *) xmalloc (sizeof (struct rb_tree_node_list));
+  tmp_node->node = node;
+  tmp_node->next = NULL;
+  **tail = tmp_node;
+  *tail = &tmp_node->next;
+}
+
+/* Find all the inlined subroutine records of OBJFILE whose inlining
+   start address (main key) is greater than or equal to START, and
+   whose inlining end address (third_key) is less than END.  Return
+   all such records in the list MATCHES, lowest start address first.  */
+
+static void
+inlined_subroutine_nodes_in_between (struct objfile *objfile, CORE_ADDR start,
+				     CORE_ADDR end,
+				     struct rb_tree_node_list **matches)
+{
+  struct rb_tree_node_list **tail = matches;
+  struct rb_tree_node **index;
+  int size, i;
+
+  *matches = NULL;
+  index = inlined_subroutine_index (objfile, &size);
+
+  for (i = inlined_subroutine_lower_bound (index, size, start, INT_MIN, 0);
+       i < size && index[i]->key < end; i++)
+    if (index[i]->third_key < end)
+      append_rb_tree_node (index[i], &tail);
+}
+
+/* Find all the inlined subroutine records of OBJFILE whose inlining
+   start address (main key) equals KEY and whose inlining end address
+   (third key) equals THIRD_KEY.  Return all such records in the list
+   MATCHES.  */
+
+static void
+inlined_subroutine_exact_matches (struct objfile *objfile, CORE_ADDR key,
+				  CORE_ADDR third_key,
+				  struct rb_tree_node_list **matches)
+{
+  struct rb_tree_node_list **tail = matches;
+  struct rb_tree_node **index;
+  int size, i;
+
+  *matches = NULL;
+  index = inlined_subroutine_index (objfile, &size);
+
+  for (i = inlined_subroutine_lower_bound (index, size, key, INT_MIN, 0);
+       i < size && index[i]->key == key; i++)
+    if (index[i]->third_key == third_key)
+      append_rb_tree_node (index[i], &tail);
+}
+
+/* Find all the inlined subroutine records of OBJFILE matching KEY,
+   SECONDARY_KEY and THIRD_KEY exactly, and return them in the list
+   MATCHES.  */
+
+static void
+inlined_subroutine_matching_nodes (struct objfile *objfile, CORE_ADDR key,
+				   int secondary_key, CORE_ADDR third_key,
+				   struct rb_tree_node_list **matches)
+{
+  struct rb_tree_node_list **tail = matches;
+  struct rb_tree_node **index;
+  int size, i;
+
+  *matches = NULL;
+  index = inlined_subroutine_index (objfile, &size);
+
+  for (i = inlined_subroutine_lower_bound (index, size, key, secondary_key,
+					   third_key);
+       i < size
+	 && index[i]->key == key
+	 && index[i]->secondary_key == secondary_key
+	 && index[i]->third_key == third_key;
+       i++)
+    append_rb_tree_node (index[i], &tail);
+}
+/* APPLE LOCAL end inlined subroutine index  */
+
+/* APPLE LOCAL begin inlined entry index  */
+
+/* Every time the inferior stops, inlined_function_update_call_stack
+   needs the inlined subroutine and call site entries of the line table
+   whose address ranges contain the stop pc.  Rather than scanning the
+   line table from the beginning each time, we keep, per symtab, the
+   positions of just those entries, in line table order, together with
+   the running maximum of their end addresses.  Finding the entries
+   containing a pc is then a binary search for the last entry starting
+   at or before it, followed by a walk back that stops as soon as no
+   earlier entry reaches the pc.  Since inlined code nests, that walk
+   is about as long as the inlined call stack.
+
+   Only line table positions are stored, so the index stays valid when
+   the objfile is relocated.  It lives on the objfile's obstack and
+   goes away with it.  */
+
+struct inlined_entry_index
+{
+  /* The line table this was built from, and its size at the time.  */
+  struct linetable *linetable;
+  int nitems;
+
+  /* Number of inlined entries.  */
+  int count;
+
+  /* The line table positions of the inlined entries.  */
+  int *entries;
+
+  /* WIDEST[K] is the line table position of the entry with the
+     highest end_pc among ENTRIES[0] through ENTRIES[K].  */
+  int *widest;
+};
+
+/* Return the inlined entry index for symtab S, building it if this is
+   the first time it has been asked for.  */
+
+static struct inlined_entry_index *
+inlined_entry_index (struct symtab *s)
+{
+  struct linetable *l = LINETABLE (s);
+  struct inlined_entry_index *index = s->inlined_entry_index;
+  struct obstack *obstack = &s->objfile->objfile_obstack;
+  int i, n;
+
+  if (index != NULL && index->linetable == l && index->nitems == l->nitems)
+    return index;
+
+  index = (struct inlined_entry_index *)
+    obstack_alloc (obstack, sizeof (struct inlined_entry_index));
+  index->linetable = l;
+  index->nitems = l->nitems;
+
+  n = 0;
+  for (i = 0; i < l->nitems; i++)
+    if (l->item[i].entry_type == INLINED_SUBROUTINE_LT_ENTRY
+	|| l->item[i].entry_type == INLINED_CALL_SITE_LT_ENTRY)
+      n++;
+
+  index->count = n;
+  index->entries = (int *) obstack_alloc (obstack, (n + 1) * sizeof (int));
+  index->widest = (int *) obstack_alloc (obstack, (n + 1) * sizeof (int));
+
+  n = 0;
+  for (i = 0; i < l->nitems; i++)
+    if (l->item[i].entry_type == INLINED_SUBROUTINE_LT_ENTRY
+	|| l->item[i].entry_type == INLINED_CALL_SITE_LT_ENTRY)
+      {
+	index->entries[n] = i;
+	if (n == 0
+	    || l->item[i].end_pc > l->item[index->widest[n - 1]].end_pc)
+	  index->widest[n] = i;
+	else
+	  index->widest[n] = index->widest[n - 1];
+	n++;
+      }
+
+  s->inlined_entry_index = index;
+  return index;
+}
+
+/* Store in *FOUND the line table positions of the inlined entries of
+   symtab S whose address ranges contain PC, in line table order, and
+   return how many there are.  *FOUND is an xmalloc'd buffer of *SIZE
+   elements, grown as needed.  */
+
+static int
+inlined_entries_containing_pc (struct symtab *s, CORE_ADDR pc,
+			       int **found, int *size)
+{
+  struct linetable *l = LINETABLE (s);
+  struct inlined_entry_index *index = inlined_entry_index (s);
+  int low = 0;
+  int high = index->count;
+  int k, n, i;
+
+  /* Find the first entry that starts after PC.  */
+  while (low < high)
     {
-      if (third_key == root->third_key)
-	{
-	  tmp_node = (struct rb_tree_node_list *) xmalloc (sizeof (struct rb_tree_node_list));
-	  tmp_node->node = root;
-	  tmp_node->next = *matches;
-	  *matches = tmp_node;
-	  
-	  rb_tree_find_all_exact_matches (root->left, key, third_key, matches);
-	  rb_tree_find_all_exact_matches (root->right, key, third_key, matches);
-	}
-      else if (third_key < root->third_key)
-	rb_tree_find_all_exact_matches (root->left, key, third_key, matches);
+      int mid = low + (high - low) / 2;
+
+      if (l->item[index->entries[mid]].pc <= pc)
+	low = mid + 1;
       else
-	rb_tree_find_all_exact_matches (root->right, key, third_key, matches);
+	high = mid;
     }
-  else if (key < root->key)
-    rb_tree_find_all_exact_matches (root->left, key, third_key, matches);
-  else
-    rb_tree_find_all_exact_matches (root->right, key, third_key, matches);
+
+  n = 0;
+  for (k = low - 1;
+       k >= 0 && l->item[index->widest[k]].end_pc > pc;
+       k--)
+    if (l->item[index->entries[k]].end_pc > pc)
+      {
+	if (n == *size)
+	  {
+	    *size = *size ? 2 * *size : 16;
+	    *found = (int *) xrealloc (*found, *size * sizeof (int));
+	  }
+	(*found)[n++] = index->entries[k];
+      }
+
+  /* We walked backwards; put them back in line table order.  */
+  for (i = 0; i < n / 2; i++)
+    {
+      int tmp = (*found)[i];
+      (*found)[i] = (*found)[n - 1 - i];
+      (*found)[n - 1 - i] = tmp;
+    }
+
+  return n;
 }
-/* APPLE LOCAL end inlined function symbols & blocks  */
+/* APPLE LOCAL end inlined entry index  */
+
+/* Given a red-black tree (ROOT) containing inlined subroutine records,
+   find all records matching KEY, SECONDARY_KEY and THIRD_KEY, and
+   return them in the list MATCHES.  This searches the tree itself, so
+   it is what we use while the tree is still being added to.  */
 
 static void
 rb_tree_find_all_matching_nodes (struct rb_tree_node *root, CORE_ADDR key,
@@ -1146,9 +1417,8 @@ find_function_names_and_address_ranges (struct objfile *objfile,
   struct rb_tree_node_list *current;
   int match_found = 0;
 
-  rb_tree_find_all_matching_nodes (objfile->inlined_subroutine_data,
-				   record->start_pc, 0, record->end_pc,
-				   &matches);
+  inlined_subroutine_matching_nodes (objfile, record->start_pc, 0,
+				     record->end_pc, &matches);
 
 
   for (current = matches; current && !match_found; current = current->next)
@@ -1484,21 +1754,12 @@ void
 inlined_function_update_call_stack (CORE_ADDR pc)
 {
   struct symtab *s;
-  struct symtab *orig_s;
-  struct symtab *alt_symtab = 0;
   struct linetable *l;
-  int len;
-  struct linetable_entry *alt = NULL;
-  struct linetable_entry *item;
-  struct linetable_entry *prev;
   struct blockvector *bv;
   asection *section_tmp;
   struct bfd_section *section;
   int i;
   int done;
-  struct linetable_entry *best = NULL;
-  CORE_ADDR best_end = 0;
-  struct symtab *best_symtab = 0;
   struct pending_node *pending_list;
   struct pending_node *temp;
   struct pending_node *cur_pend;
@@ -1583,10 +1844,24 @@ inlined_function_update_call_stack (CORE_ADDR pc)
     pc = overlay_mapped_address (pc, section_tmp);
   section = (struct bfd_section *) section_tmp;
 
-  s = find_pc_sect_symtab (pc, section);
-  orig_s = s;
+  /* APPLE LOCAL begin inlined entry index  */
+  /* If we've already brought the stack up to date for this pc since
+     the inferior last stopped, the line tables can't tell us anything
+     new.  */
+  if (inlined_call_stack_cache.valid
+      && inlined_call_stack_cache.pc == pc
+      && inlined_call_stack_cache.generation == target_stop_generation
+      && inlined_call_stack_cache.nelts == global_inlined_call_stack.nelts)
+    s = NULL;
+  else
+    s = find_pc_sect_symtab (pc, section);
+
   if (s)
     {
+      int *found = NULL;
+      int found_size = 0;
+      int nfound;
+
       bv = BLOCKVECTOR (s);
 
       /* Look at all the symtabs that share this blockvector.
@@ -1596,92 +1871,44 @@ inlined_function_update_call_stack (CORE_ADDR pc)
       for ( ; s && BLOCKVECTOR (s) == bv; s = s->next)
 	{
 	  l = LINETABLE (s);
-	  if (!l)
-	    continue;
-	  len = l->nitems;
-	  if (len <= 0)
+	  if (!l || l->nitems <= 0)
 	    continue;
 
+	  /* Store the item(s) in a sorted list; after all of the items
+	     for a particular pc have been collected and sorted, they get
+	     added to the call stack in the correct order.  */
+
 	  pending_list = NULL;
-	  prev = NULL;
-	  item = l->item;
-	  if (item->pc > pc && (!alt || item->pc < alt->pc))
+	  nfound = inlined_entries_containing_pc (s, pc, &found, &found_size);
+	  for (i = 0; i < nfound; i++)
 	    {
-	      alt = item;
-	      alt_symtab = s;
+	      temp = (struct pending_node *) xmalloc (sizeof (struct pending_node));
+	      temp->entry = &l->item[found[i]];
+	      temp->s = s;
+	      temp->next = NULL;
+	      insert_pending_node (temp, &pending_list);
 	    }
 
-	  for (i = 0; i < len; i++, item++)
-	    {
-	      if ((item->entry_type == INLINED_SUBROUTINE_LT_ENTRY
-		   || item->entry_type == INLINED_CALL_SITE_LT_ENTRY)
-		  && item->pc <= pc
-		  && item->end_pc > pc)
-		{
-		  /* Store the item(s) in a sorted list; after all
-		     of the items for a particular pc have been
-		     collected and sorted, they get added to the
-		     call stack in the correct order.  */
+	  for (cur_pend = pending_list; cur_pend; cur_pend = cur_pend->next)
+	    add_item_to_inlined_subroutine_stack (cur_pend->entry, cur_pend->s,
+						  section);
 
-		  temp = (struct pending_node *) xmalloc (sizeof (struct pending_node));
-		  temp->entry = item;
-		  temp->s = s;
-		  temp->next = NULL;
-		  insert_pending_node (temp, &pending_list);
-		}
-	      
-	      if (item->pc > pc
-		  || (item->pc == pc
-		      && prev
-		      && item->pc == prev->pc))
-		break;
-	      
-	      prev = item;
-	    }	  
-	  
-	  if (prev && prev->line && (!best || prev->pc > best->pc))
+	  while (pending_list)
 	    {
-	      best = prev;
-	      best_symtab = s;
-	      
-	      if (best_end <= best->pc)
-		best_end = 0;
+	      temp = pending_list->next;
+	      xfree (pending_list);
+	      pending_list = temp;
 	    }
-	  
-	  if (best_symtab
-	      && best->line != 0
-	      && prev 
-	      && prev->pc == item->pc)
-	    {
-	      while (prev->pc == item->pc)
-		{
-		  prev = item;
-		  item++;
-		  if ((item->entry_type ==  INLINED_SUBROUTINE_LT_ENTRY
-		       || item->entry_type == INLINED_CALL_SITE_LT_ENTRY)
-		      && item->pc <= pc
-		      && item->end_pc > pc)
-		    {
-		      /* Store the item(s) in a sorted list; after all
-			 of the items for a particular pc have been
-			 collected and sorted, they get added to the
-			 call stack in the correct order.  */
+	}
 
-		      temp = (struct pending_node *) xmalloc (sizeof (struct pending_node));
-		      temp->entry = item;
-		      temp->s = s;
-		      temp->next = NULL;
-		      insert_pending_node (temp, &pending_list);
-		    }
-		}
-	      best = prev;
-	    }
+      xfree (found);
 
-	  for (cur_pend = pending_list; cur_pend; cur_pend = cur_pend->next)
-	    add_item_to_inlined_subroutine_stack (cur_pend->entry, cur_pend->s,
-						  section);
-	}
+      inlined_call_stack_cache.valid = 1;
+      inlined_call_stack_cache.pc = pc;
+      inlined_call_stack_cache.generation = target_stop_generation;
+      inlined_call_stack_cache.nelts = global_inlined_call_stack.nelts;
     }
+  /* APPLE LOCAL end inlined entry index  */
 
   /* If there's anything in the inlined call stack, then the stop_pc
      is in the middle of some inlined code, so at the very least
@@ -1847,6 +2074,8 @@ inlined_function_add_function_names (struct objfile *objfile,
 
       rb_tree_insert (&(objfile->inlined_subroutine_data), 
 		      objfile->inlined_subroutine_data, tmp_rb_node);
+      /* APPLE LOCAL inlined subroutine index  */
+      inlined_subroutine_invalidate_index (objfile);
     }
 
   /* Clean up the 'matches' list.  */
@@ -2957,6 +3186,8 @@ inlined_subroutine_restore_after_dummy_call (void)
 	}
 
       reset_saved_call_stack ();
+      /* APPLE LOCAL inlined entry index  */
+      inlined_call_stack_cache.valid = 0;
     }
 }
 
@@ -3122,9 +3353,8 @@ rest_of_line_contains_inlined_subroutine (CORE_ADDR *end_of_line)
       struct rb_tree_node *tmp_node;
       struct inlined_call_stack_record *tmp_record;
       
-      rb_tree_find_all_nodes_in_between 
-	                         (sal.symtab->objfile->inlined_subroutine_data,
-				  stop_pc, current_end, &matches);
+      inlined_subroutine_nodes_in_between (sal.symtab->objfile,
+					   stop_pc, current_end, &matches);
       
       for (current = matches; current; current = current->next)
 	{
@@ -3194,9 +3424,8 @@ find_next_inlined_subroutine (CORE_ADDR pc, CORE_ADDR *inline_start_pc,
       struct rb_tree_node *tmp_node;
       struct inlined_call_stack_record *tmp_record;
 
-      rb_tree_find_all_nodes_in_between 
-	                         (sal_symtab->objfile->inlined_subroutine_data,
-				  stop_pc, end_of_line, &matches);
+      inlined_subroutine_nodes_in_between (sal_symtab->objfile,
+					   stop_pc, end_of_line, &matches);
 
       for (current = matches; current; current = current->next)
 	{
@@ -3554,8 +3783,8 @@ block_inlined_function (struct block *bl, struct bfd_section *section)
   /* Find all inlined subroutines (if any) with the same starting and
      ending addresses as the block.  */
   
-  rb_tree_find_all_exact_matches (objfile->inlined_subroutine_data,
-				  bl->startaddr, bl->endaddr, &matches);
+  inlined_subroutine_exact_matches (objfile, bl->startaddr, bl->endaddr,
+				    &matches);
   /* APPLE LOCAL end radar 6381384  add section to symtab lookups  */
 
   if (!matches)
@@ -3744,10 +3973,8 @@ func_sym_is_inlined_function (struct symbol *function)
   if (objfile == NULL)
     return 0;
 
-  rb_tree_find_all_exact_matches (objfile->inlined_subroutine_data,
-                                  func_block->startaddr,
-                                  func_block->endaddr,
-                                  &matches);
+  inlined_subroutine_exact_matches (objfile, func_block->startaddr,
+                                    func_block->endaddr, &matches);
 
   /* The funciton's addresses match; it may be inlined. */
 
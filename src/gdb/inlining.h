@@ -333,6 +333,8 @@ extern void rb_tree_insert (struct rb_tree_node **, struct rb_tree_node *,
 			    struct rb_tree_node *);
 
 extern void inlined_subroutine_free_objfile_data (struct rb_tree_node *);
+/* APPLE LOCAL inlined subroutine index  */
+extern void inlined_subroutine_invalidate_index (struct objfile *);
 extern void inlined_subroutine_free_objfile_call_sites (struct rb_tree_node *);
 
 extern void inlined_subroutine_objfile_relocate (struct objfile *,
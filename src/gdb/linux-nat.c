@@ -1019,6 +1019,9 @@ linux_nat_detach (char *args, int from_tty)
   sigprocmask (SIG_SETMASK, &normal_mask, NULL);
   sigemptyset (&blocked_mask);
 
+  /* APPLE LOCAL proc mem  */
+  linux_proc_mem_close ();
+
   inferior_ptid = pid_to_ptid (GET_PID (inferior_ptid));
   deprecated_child_ops.to_detach (args, from_tty);
 }
@@ -2322,6 +2325,9 @@ linux_nat_mourn_inferior (void)
   sigprocmask (SIG_SETMASK, &normal_mask, NULL);
   sigemptyset (&blocked_mask);
 
+  /* APPLE LOCAL proc mem  */
+  linux_proc_mem_close ();
+
   deprecated_child_ops.to_mourn_inferior ();
 }
 
@@ -2945,43 +2951,107 @@ linux_nat_info_proc_cmd (char *args, int from_tty)
     }
 }
 
-int
-linux_proc_xfer_memory (CORE_ADDR addr, gdb_byte *myaddr, int len, int write,
-			struct mem_attrib *attrib, struct target_ops *target)
+/* APPLE LOCAL begin proc mem  */
+/* The open /proc/PID/mem of the process we last transferred memory
+   for, so that a stream of large reads doesn't pay for an open and a
+   close each time.  */
+
+static int linux_proc_mem_fd = -1;
+static int linux_proc_mem_pid;
+static int linux_proc_mem_writable;
+
+void
+linux_proc_mem_close (void)
+{
+  if (linux_proc_mem_fd != -1)
+    close (linux_proc_mem_fd);
+  linux_proc_mem_fd = -1;
+  linux_proc_mem_pid = 0;
+}
+
+/* Return a descriptor for PID's /proc/PID/mem, or -1.  Kernels
+   before 2.6.39 don't allow writing it, so fall back to read-only.  */
+
+static int
+linux_proc_mem_open (int pid)
 {
-  int fd, ret;
   char filename[64];
 
-  if (write)
-    return 0;
+  if (linux_proc_mem_fd != -1 && linux_proc_mem_pid == pid)
+    return linux_proc_mem_fd;
 
-  /* Don't bother for one word.  */
-  if (len < 3 * sizeof (long))
-    return 0;
+  linux_proc_mem_close ();
+  sprintf (filename, "/proc/%d/mem", pid);
+  linux_proc_mem_fd = open (filename, O_RDWR | O_LARGEFILE);
+  linux_proc_mem_writable = (linux_proc_mem_fd != -1);
+  if (linux_proc_mem_fd == -1)
+    linux_proc_mem_fd = open (filename, O_RDONLY | O_LARGEFILE);
+  if (linux_proc_mem_fd != -1)
+    linux_proc_mem_pid = pid;
+  return linux_proc_mem_fd;
+}
 
-  /* We could keep this file open and cache it - possibly one per
-     thread.  That requires some juggling, but is even faster.  */
-  sprintf (filename, "/proc/%d/mem", PIDGET (inferior_ptid));
-  fd = open (filename, O_RDONLY | O_LARGEFILE);
-  if (fd == -1)
-    return 0;
+/* Transfer LEN bytes between MYADDR and ADDR in FD in one pread or
+   pwrite.  Return the number of bytes moved, or zero.  */
+
+static int
+linux_proc_mem_xfer (int fd, CORE_ADDR addr, gdb_byte *myaddr, int len,
+		     int write)
+{
+  ssize_t ret;
 
   /* If pread64 is available, use it.  It's faster if the kernel
      supports it (only one syscall), and it's 64-bit safe even on
      32-bit platforms (for instance, SPARC debugging a SPARC64
-     application).  */
+     application).  glibc provides pwrite64 alongside it.  */
 #ifdef HAVE_PREAD64
-  if (pread64 (fd, myaddr, len, addr) != len)
+  if (write)
+    ret = pwrite64 (fd, myaddr, len, addr);
+  else
+    ret = pread64 (fd, myaddr, len, addr);
 #else
-  if (lseek (fd, addr, SEEK_SET) == -1 || read (fd, myaddr, len) != len)
-#endif
-    ret = 0;
+  if (lseek (fd, addr, SEEK_SET) == -1)
+    return 0;
+  if (write)
+    ret = write (fd, myaddr, len);
   else
-    ret = len;
+    ret = read (fd, myaddr, len);
+#endif
+  return ret > 0 ? ret : 0;
+}
 
-  close (fd);
-  return ret;
+int
+linux_proc_xfer_memory (CORE_ADDR addr, gdb_byte *myaddr, int len, int write,
+			struct mem_attrib *attrib, struct target_ops *target)
+{
+  int pid = PIDGET (inferior_ptid);
+  int attempt, fd, ret;
+
+  /* Don't bother for one word.  */
+  if (len < 3 * sizeof (long))
+    return 0;
+
+  for (attempt = 0; attempt < 2; attempt++)
+    {
+      fd = linux_proc_mem_open (pid);
+      if (fd == -1)
+	return 0;
+      if (write && !linux_proc_mem_writable)
+	return 0;
+
+      ret = linux_proc_mem_xfer (fd, addr, myaddr, len, write);
+      if (ret > 0)
+	return ret;
+
+      /* A descriptor opened before the process exec'd refers to the
+	 old address space and fails every transfer, so try once more
+	 with a fresh one before letting ptrace have a go.  */
+      linux_proc_mem_close ();
+    }
+
+  return 0;
 }
+/* APPLE LOCAL end proc mem  */
 
 /* Parse LINE as a signal set and add its set bits to SIGS.  */
 
@@ -72,6 +72,12 @@ extern int linux_proc_xfer_memory (CORE_ADDR addr, gdb_byte *myaddr, int len,
 				   int write, struct mem_attrib *attrib,
 				   struct target_ops *target);
 
+/* APPLE LOCAL begin proc mem  */
+/* Close the /proc/PID/mem descriptor linux_proc_xfer_memory keeps
+   open, e.g. because the process has gone away.  */
+extern void linux_proc_mem_close (void);
+/* APPLE LOCAL end proc mem  */
+
 /* Find process PID's pending signal set from /proc/pid/status.  */
 void linux_proc_pending_signals (int pid, sigset_t *pending, sigset_t *blocked, sigset_t *ignored);
 
@@ -130,6 +130,19 @@ static CORE_ADDR td_create_bp_addr;
 /* Location of the thread death event breakpoint.  */
 static CORE_ADDR td_death_bp_addr;
 
+/* APPLE LOCAL begin incremental thread list  */
+/* Nonzero if GDB's thread list already holds every thread the thread
+   library knows about.  Once td_ta_thr_iter has been run with the
+   creation event breakpoint in place, each new thread is reported by
+   a TD_CREATE event and each exited one is dropped by prune_threads,
+   so later calls to thread_db_find_new_threads have nothing to add and
+   can skip walking the library's thread list again.
+   THREAD_LIST_GENERATION_SEEN is the thread_list_generation at that
+   point; if GDB's list has been thrown away since, walk it again.  */
+static int thread_list_complete;
+static unsigned int thread_list_generation_seen;
+/* APPLE LOCAL end incremental thread list  */
+
 /* Prototypes for local functions.  */
 static void thread_db_find_new_threads (void);
 static void attach_thread (ptid_t ptid, const td_thrhandle_t *th_p,
@@ -558,6 +571,8 @@ enable_thread_event_reporting (void)
   remove_thread_event_breakpoints ();
   td_create_bp_addr = 0;
   td_death_bp_addr = 0;
+  /* APPLE LOCAL incremental thread list  */
+  thread_list_complete = 0;
 
   /* Set up the thread creation event.  */
   err = enable_thread_event (thread_agent, TD_CREATE, &td_create_bp_addr);
@@ -592,6 +607,8 @@ disable_thread_event_reporting (void)
   remove_thread_event_breakpoints ();
   td_create_bp_addr = 0;
   td_death_bp_addr = 0;
+  /* APPLE LOCAL incremental thread list  */
+  thread_list_complete = 0;
 }
 
 static void
@@ -1113,6 +1130,8 @@ thread_db_mourn_inferior (void)
   /* Forget about the child's process ID.  We shouldn't need it
      anymore.  */
   proc_handle.pid = 0;
+  /* APPLE LOCAL incremental thread list  */
+  thread_list_complete = 0;
 
   target_beneath->to_mourn_inferior ();
 
@@ -1169,6 +1188,8 @@ find_new_threads_callback (const td_thrhandle_t *th_p, void *data)
   td_thrinfo_t ti;
   td_err_e err;
   ptid_t ptid;
+  /* APPLE LOCAL incremental thread list  */
+  struct thread_info *thread_info;
 
   err = td_thr_get_info_p (th_p, &ti);
   if (err != TD_OK)
@@ -1180,8 +1201,25 @@ find_new_threads_callback (const td_thrhandle_t *th_p, void *data)
 
   ptid = ptid_build (GET_PID (inferior_ptid), ti.ti_lid, ti.ti_tid);
 
-  if (!in_thread_list (ptid))
-    attach_thread (ptid, th_p, &ti, 1);
+  /* APPLE LOCAL begin incremental thread list  */
+  thread_info = find_thread_pid (ptid);
+  if (thread_info == NULL)
+    {
+      attach_thread (ptid, th_p, &ti, 1);
+      thread_info = find_thread_pid (ptid);
+    }
+
+  /* We have the thread's handle and info in hand, so keep them; the
+     thread_alive and pid_to_str calls that follow a thread list
+     update would otherwise ask the library for them again.  */
+  if (thread_info != NULL && thread_info->private != NULL)
+    {
+      memcpy (&thread_info->private->th, th_p, sizeof (*th_p));
+      thread_info->private->th_valid = 1;
+      memcpy (&thread_info->private->ti, &ti, sizeof (ti));
+      thread_info->private->ti_valid = 1;
+    }
+  /* APPLE LOCAL end incremental thread list  */
 
   return 0;
 }
@@ -1191,12 +1229,28 @@ thread_db_find_new_threads (void)
 {
   td_err_e err;
 
+  /* APPLE LOCAL begin incremental thread list  */
+  if (thread_list_complete
+      && thread_list_generation_seen == thread_list_generation)
+    return;
+  /* APPLE LOCAL end incremental thread list  */
+
   /* Iterate over all user-space threads to discover new threads.  */
   err = td_ta_thr_iter_p (thread_agent, find_new_threads_callback, NULL,
 			  TD_THR_ANY_STATE, TD_THR_LOWEST_PRIORITY,
 			  TD_SIGNO_MASK, TD_THR_ANY_USER_FLAGS);
   if (err != TD_OK)
     error (_("Cannot find new threads: %s"), thread_db_err_str (err));
+
+  /* APPLE LOCAL begin incremental thread list  */
+  /* Without the creation breakpoint nothing tells us about new
+     threads, so keep walking the whole list each time.  */
+  if (td_create_bp_addr != 0)
+    {
+      thread_list_complete = 1;
+      thread_list_generation_seen = thread_list_generation;
+    }
+  /* APPLE LOCAL end incremental thread list  */
 }
 
 static char *
@@ -62,11 +62,264 @@
 #include "osabi.h"
 #include "gdbarch.h"
 #include "objfiles.h"
+/* APPLE LOCAL begin mmap core file  */
+#include "gdbcmd.h"
+#include "gdb_stat.h"
+#include <sys/mman.h>
+/* APPLE LOCAL end mmap core file  */
 
 #include "ui-out.h"
 
 struct target_ops macho_core_ops;
 
+/* APPLE LOCAL begin mmap core file  */
+/* Cores of big processes run to tens of gigabytes.  Rather than read
+   every byte of memory through bfd, which seeks and copies through its
+   own buffers, the core is mapped when it's opened and memory reads
+   are served straight from the mapping.  CORE_MAPPED_REGIONS lists the
+   core's memory sections sorted by address, with where each one's
+   contents start in the file.  */
+
+struct core_mapped_region
+{
+  CORE_ADDR addr;
+  CORE_ADDR endaddr;
+  file_ptr filepos;
+};
+
+static char *core_mapping = NULL;
+static size_t core_mapping_size = 0;
+static struct core_mapped_region *core_mapped_regions = NULL;
+static int core_mapped_region_count = 0;
+
+static int mmap_core_files = 1;
+
+static void
+show_mmap_core_files (struct ui_file *file, int from_tty,
+		      struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Mapping of Mach-O core files is %s.\n"), value);
+}
+
+static int
+compare_core_mapped_regions (const void *a, const void *b)
+{
+  const struct core_mapped_region *ra = a;
+  const struct core_mapped_region *rb = b;
+
+  if (ra->addr < rb->addr)
+    return -1;
+  if (ra->addr > rb->addr)
+    return 1;
+  return 0;
+}
+
+static void
+core_unmap_file (void)
+{
+  if (core_mapping != NULL)
+    munmap (core_mapping, core_mapping_size);
+  core_mapping = NULL;
+  core_mapping_size = 0;
+  xfree (core_mapped_regions);
+  core_mapped_regions = NULL;
+  core_mapped_region_count = 0;
+}
+
+/* Map the core file open on DESC, which ABFD was read from, and
+   index its memory sections.  If it can't be mapped - the address
+   space of a 32-bit gdb won't hold a big core - memory is just read
+   through bfd as before.  */
+
+static void
+core_map_file (bfd *abfd, int desc)
+{
+  struct stat st;
+  struct bfd_section *sect;
+  void *mapping;
+  int n = 0;
+
+  core_unmap_file ();
+
+  /* A core we may write to has to be read through bfd, or the
+     mapping would go stale underneath us.  */
+  if (!mmap_core_files || write_files)
+    return;
+  if (fstat (desc, &st) < 0 || st.st_size <= 0
+      || (off_t) (size_t) st.st_size != st.st_size)
+    return;
+
+  mapping = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, desc, 0);
+  if (mapping == MAP_FAILED)
+    return;
+  core_mapping = mapping;
+  core_mapping_size = (size_t) st.st_size;
+
+  core_mapped_regions = xmalloc (bfd_count_sections (abfd)
+				 * sizeof (struct core_mapped_region));
+  for (sect = abfd->sections; sect != NULL; sect = sect->next)
+    {
+      flagword flags = bfd_get_section_flags (abfd, sect);
+      bfd_size_type size = bfd_section_size (abfd, sect);
+
+      /* The same sections build_section_table puts in the target's
+	 section table, less any whose contents aren't all in the file.  */
+      if (!(flags & SEC_ALLOC) || !(flags & SEC_HAS_CONTENTS) || size == 0)
+	continue;
+      if (sect->filepos < 0
+	  || (ULONGEST) sect->filepos + size > core_mapping_size)
+	continue;
+
+      core_mapped_regions[n].addr = bfd_section_vma (abfd, sect);
+      core_mapped_regions[n].endaddr = core_mapped_regions[n].addr + size;
+      core_mapped_regions[n].filepos = sect->filepos;
+      n++;
+    }
+  core_mapped_region_count = n;
+  qsort (core_mapped_regions, n, sizeof (struct core_mapped_region),
+	 compare_core_mapped_regions);
+}
+
+/* Read memory from the mapped core where we can; anything else -
+   writes, the sections of shared libraries added to the target's
+   section table, bytes the core doesn't have - goes through
+   xfer_memory_from_corefile.  */
+
+static int
+core_xfer_memory (CORE_ADDR memaddr, gdb_byte *myaddr, int len, int write,
+		  struct mem_attrib *attrib, struct target_ops *target)
+{
+  if (!write && core_mapping != NULL && len > 0)
+    {
+      int lo = 0;
+      int hi = core_mapped_region_count;
+
+      /* Find the last region starting at or below MEMADDR.  */
+      while (lo < hi)
+	{
+	  int mid = (lo + hi) / 2;
+
+	  if (core_mapped_regions[mid].addr <= memaddr)
+	    lo = mid + 1;
+	  else
+	    hi = mid;
+	}
+
+      if (lo > 0 && memaddr < core_mapped_regions[lo - 1].endaddr)
+	{
+	  struct core_mapped_region *region = &core_mapped_regions[lo - 1];
+
+	  if ((CORE_ADDR) len > region->endaddr - memaddr)
+	    len = region->endaddr - memaddr;
+	  memcpy (myaddr,
+		  core_mapping + region->filepos + (memaddr - region->addr),
+		  len);
+	  return len;
+	}
+    }
+
+  return xfer_memory_from_corefile (memaddr, myaddr, len, write, attrib,
+				    target);
+}
+/* APPLE LOCAL end mmap core file  */
+
+/* APPLE LOCAL begin minimal core files  */
+/* A core written by "set gcore-minimal on" has none of the contents
+   of the process's read-only mappings, only a list of the images they
+   came from.  Reads of those addresses fall through the core's
+   section table to the exec target, which has the sections of the
+   images dyld loaded for us, so all that's left to do here is to tell
+   the user about images we couldn't find, or found at a different
+   slide, since their text will be missing or wrong.  */
+
+static int
+core_hex_digit (int c)
+{
+  if (isdigit (c))
+    return c - '0';
+  return tolower (c) - 'a' + 10;
+}
+
+static void
+core_check_image_manifest (bfd *abfd)
+{
+  asection *sect;
+  bfd_size_type size;
+  char *manifest, *line, *next;
+  struct cleanup *old_chain;
+  int missing = 0;
+
+  sect = bfd_get_section_by_name (abfd, GCORE_IMAGES_SECTION_NAME);
+  if (sect == NULL || bfd_section_size (abfd, sect) == 0)
+    return;
+
+  size = bfd_section_size (abfd, sect);
+  manifest = xmalloc (size + 1);
+  old_chain = make_cleanup (xfree, manifest);
+  if (!bfd_get_section_contents (abfd, sect, manifest, 0, size))
+    {
+      warning (_("Couldn't read the image list of core file \"%s\": %s"),
+	       bfd_get_filename (abfd), bfd_errmsg (bfd_get_error ()));
+      do_cleanups (old_chain);
+      return;
+    }
+  manifest[size] = '\0';
+
+  for (line = manifest; line != NULL && *line != '\0'; line = next)
+    {
+      unsigned char uuid[16];
+      ULONGEST slide;
+      char *p, *path;
+      struct objfile *objfile;
+      int i;
+
+      next = strchr (line, '\n');
+      if (next != NULL)
+	*next++ = '\0';
+
+      p = line;
+      for (i = 0; i < sizeof (uuid); i++, p += 2)
+	{
+	  if (!isxdigit (p[0]) || !isxdigit (p[1]))
+	    break;
+	  uuid[i] = (core_hex_digit (p[0]) << 4) | core_hex_digit (p[1]);
+	}
+      if (i < sizeof (uuid) || *p != ' ')
+	continue;
+      slide = strtoull (p + 1, &path, 16);
+      while (*path == ' ')
+	path++;
+
+      objfile = find_objfile_by_uuid (uuid);
+      if (objfile == NULL)
+	{
+	  warning (_("Minimal core image \"%s\" is not loaded; its text \
+can't be read from this core."), path);
+	  missing++;
+	}
+      else if (objfile->section_offsets != NULL
+	       && objfile->sect_index_text >= 0
+	       && ANOFFSET (objfile->section_offsets,
+			    objfile->sect_index_text) != slide)
+	{
+	  warning (_("Minimal core image \"%s\" was loaded at a slide of \
+0x%s, but the core was written with it at 0x%s."),
+		   path,
+		   paddr_nz (ANOFFSET (objfile->section_offsets,
+				       objfile->sect_index_text)),
+		   paddr_nz (slide));
+	  missing++;
+	}
+    }
+
+  if (missing)
+    printf_filtered (_("This core file was written without the contents of \
+read-only memory, which is read from the images on disk instead.\n"));
+
+  do_cleanups (old_chain);
+}
+/* APPLE LOCAL end minimal core files  */
+
 static struct bfd_section *
 lookup_section (bfd *abfd, unsigned int n)
 {
@@ -155,6 +408,8 @@ core_close_1 (void *arg)
 
   core_bfd = NULL;
   inferior_ptid = null_ptid;
+  /* APPLE LOCAL mmap core file  */
+  core_unmap_file ();
 
 #ifdef CLEAR_SOLIB
   CLEAR_SOLIB ();
@@ -231,6 +486,9 @@ core_open (char *filename, int from_tty)
   core_bfd = temp_bfd;
   old_chain = make_cleanup (core_close_1, core_bfd);
 
+  /* APPLE LOCAL mmap core file  */
+  core_map_file (core_bfd, scratch_chan);
+
   validate_files ();
 
   /* Find the data section */
@@ -389,6 +647,9 @@ core_open (char *filename, int from_tty)
 	  macosx_init_dyld_from_core ();
 	}
 #endif
+      /* APPLE LOCAL minimal core files  */
+      core_check_image_manifest (core_bfd);
+
       /* Fetch all registers from core file.  */
       target_fetch_registers (-1);
 
@@ -856,11 +1117,14 @@ core_fetch_registers (int regno)
      when reading and writing registers.  */
   if (thrd_info->private == NULL || thrd_info->private->core_thread_state == NULL)
     {
-      for (tid = ptid_get_tid (inferior_ptid);
-	   tid < bfd_count_sections (abfd)
-	   && (sec = lookup_section (abfd, tid)) != NULL;
-	   tid++)
+      /* APPLE LOCAL begin mmap core file: Walk the section list rather
+	 than looking each section up from the start of it.  */
+      tid = ptid_get_tid (inferior_ptid);
+      if (tid >= bfd_count_sections (abfd))
+	return;
+      for (sec = lookup_section (abfd, tid); sec != NULL; sec = sec->next)
 	{
+      /* APPLE LOCAL end mmap core file  */
 	  const char *sname = bfd_section_name (abfd, sec);
 	  
 	  /* See if the section names starts with "LC_THREAD.".  */
@@ -878,8 +1142,10 @@ core_fetch_registers (int regno)
 		     thread.  */
 		  if (thread_index_str == NULL)
 		    thread_index_str = strrchr(sname, '.');
+		  /* APPLE LOCAL mmap core file: The thread's flavours are
+		     all together; the next thread's mean we're done.  */
 		  else if (strcmp (thread_index_str, dot) != 0)
-		    continue;
+		    break;
 		    
 		  /* NULL terminate the flavour string and lookup the flavour
 		     by name.  */
@@ -1015,7 +1281,8 @@ init_macho_core_ops ()
   macho_core_ops.to_fetch_registers = core_fetch_registers;
   macho_core_ops.to_prepare_to_store = core_prepare_to_store;
   macho_core_ops.to_store_registers = core_store_registers;
-  macho_core_ops.deprecated_xfer_memory = xfer_memory_from_corefile;
+  /* APPLE LOCAL mmap core file  */
+  macho_core_ops.deprecated_xfer_memory = core_xfer_memory;
   macho_core_ops.to_files_info = core_files_info;
   macho_core_ops.to_create_inferior = find_default_create_inferior;
   macho_core_ops.to_pid_to_str = macosx_core_ptid_to_str;
@@ -1034,4 +1301,16 @@ _initialize_core_macho ()
 {
   init_macho_core_ops ();
   add_target (&macho_core_ops);
+
+  /* APPLE LOCAL mmap core file  */
+  add_setshow_boolean_cmd ("mmap-core-files", class_maintenance,
+			   &mmap_core_files, _("\
+Set whether Mach-O core files are mapped into memory."), _("\
+Show whether Mach-O core files are mapped into memory."), _("\
+When on, a core file opened read-only is mapped with mmap, and its memory\n\
+is read straight from the mapping instead of through bfd.  This only\n\
+affects core files opened after it is changed."),
+			   NULL, show_mmap_core_files,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
 }
@@ -40,6 +40,10 @@
 
 #include "macosx-nat-mutils.h"
 #include "macosx-nat-inferior.h"
+/* APPLE LOCAL trace bit  */
+#include "macosx-nat-infthread.h"
+/* APPLE LOCAL debug register multiplexing  */
+#include "macosx-nat-watchpoint.h"
 
 extern macosx_inferior_status *macosx_status;
 
@@ -128,7 +132,8 @@ fetch_inferior_registers (int regno)
       gdb_x86_thread_state_t gp_regs;
       struct gdbarch_info info;
       unsigned int gp_count = GDB_x86_THREAD_STATE_COUNT;
-      kern_return_t ret = thread_get_state
+      /* APPLE LOCAL thread state cache  */
+      kern_return_t ret = macosx_thread_get_state
         (current_thread, GDB_x86_THREAD_STATE, (thread_state_t) & gp_regs,
          &gp_count);
       if (ret != KERN_SUCCESS)
@@ -160,7 +165,8 @@ fetch_inferior_registers (int regno)
         {
           gdb_x86_thread_state_t gp_regs;
           unsigned int gp_count = GDB_x86_THREAD_STATE_COUNT;
-          kern_return_t ret = thread_get_state
+          /* APPLE LOCAL thread state cache  */
+          kern_return_t ret = macosx_thread_get_state
             (current_thread, GDB_x86_THREAD_STATE, (thread_state_t) & gp_regs,
              &gp_count);
 	  if (ret != KERN_SUCCESS)
@@ -168,6 +174,9 @@ fetch_inferior_registers (int regno)
 	      printf_unfiltered ("Error calling thread_get_state for GP registers for thread 0x%x\n", (int) current_thread);
 	      MACH_CHECK_ERROR (ret);
 	    }
+          /* APPLE LOCAL trace bit: Don't show gdb's own single-stepping.  */
+          if (macosx_thread_trace_bit_set_p (current_thread))
+            gp_regs.uts.ts64.rflags &= ~0x100UL;
           x86_64_macosx_fetch_gp_registers (&gp_regs.uts.ts64);
           fetched++;
         }
@@ -179,7 +188,8 @@ fetch_inferior_registers (int regno)
         {
           gdb_x86_float_state_t fp_regs;
           unsigned int fp_count = GDB_x86_FLOAT_STATE_COUNT;
-          kern_return_t ret = thread_get_state
+          /* APPLE LOCAL thread state cache  */
+          kern_return_t ret = macosx_thread_get_state
             (current_thread, GDB_x86_FLOAT_STATE, (thread_state_t) & fp_regs,
              &fp_count);
 	  if (ret != KERN_SUCCESS)
@@ -197,7 +207,8 @@ fetch_inferior_registers (int regno)
         {
           gdb_x86_thread_state_t gp_regs;
           unsigned int gp_count = GDB_x86_THREAD_STATE_COUNT;
-          kern_return_t ret = thread_get_state
+          /* APPLE LOCAL thread state cache  */
+          kern_return_t ret = macosx_thread_get_state
             (current_thread, GDB_x86_THREAD_STATE, (thread_state_t) & gp_regs,
              &gp_count);
 	  if (ret != KERN_SUCCESS)
@@ -205,6 +216,9 @@ fetch_inferior_registers (int regno)
 	      printf_unfiltered ("Error calling thread_get_state for GP registers for thread 0x%x\n", (int) current_thread);
 	      MACH_CHECK_ERROR (ret);
 	    }
+          /* APPLE LOCAL trace bit: Don't show gdb's own single-stepping.  */
+          if (macosx_thread_trace_bit_set_p (current_thread))
+            gp_regs.uts.ts32.eflags &= ~0x100UL;
           i386_macosx_fetch_gp_registers (&(gp_regs.uts.ts32));
           fetched++;
         }
@@ -216,7 +230,8 @@ fetch_inferior_registers (int regno)
         {
           gdb_i386_float_state_t fp_regs;
           unsigned int fp_count = GDB_i386_FLOAT_STATE_COUNT;
-          kern_return_t ret = thread_get_state
+          /* APPLE LOCAL thread state cache  */
+          kern_return_t ret = macosx_thread_get_state
             (current_thread, GDB_i386_FLOAT_STATE, (thread_state_t) & fp_regs,
              &fp_count);
 	  if (ret != KERN_SUCCESS)
@@ -260,7 +275,8 @@ store_inferior_registers (int regno)
           gp_regs.tsh.flavor = GDB_x86_THREAD_STATE64;
           gp_regs.tsh.count = GDB_x86_THREAD_STATE64_COUNT;
           x86_64_macosx_store_gp_registers (&gp_regs.uts.ts64);
-          ret = thread_set_state (current_thread, GDB_x86_THREAD_STATE,
+          /* APPLE LOCAL thread state cache  */
+          ret = macosx_thread_set_state (current_thread, GDB_x86_THREAD_STATE,
                                   (thread_state_t) & gp_regs,
                                   GDB_x86_THREAD_STATE_COUNT);
           MACH_CHECK_ERROR (ret);
@@ -277,7 +293,8 @@ store_inferior_registers (int regno)
           fp_regs.fsh.count = GDB_x86_FLOAT_STATE64_COUNT;
           if (x86_64_macosx_store_fp_registers (&fp_regs.ufs.fs64))
             {
-               ret = thread_set_state (current_thread, GDB_x86_FLOAT_STATE,
+               /* APPLE LOCAL thread state cache  */
+               ret = macosx_thread_set_state (current_thread, GDB_x86_FLOAT_STATE,
                                       (thread_state_t) & fp_regs,
                                       GDB_x86_FLOAT_STATE_COUNT);
                MACH_CHECK_ERROR (ret);
@@ -293,7 +310,8 @@ store_inferior_registers (int regno)
           gp_regs.tsh.flavor = GDB_x86_THREAD_STATE32;
           gp_regs.tsh.count = GDB_x86_THREAD_STATE32_COUNT;
           i386_macosx_store_gp_registers (&(gp_regs.uts.ts32));
-          ret = thread_set_state (current_thread, GDB_x86_THREAD_STATE,
+          /* APPLE LOCAL thread state cache  */
+          ret = macosx_thread_set_state (current_thread, GDB_x86_THREAD_STATE,
                                   (thread_state_t) & gp_regs,
                                   GDB_x86_THREAD_STATE_COUNT);
           MACH_CHECK_ERROR (ret);
@@ -308,7 +326,8 @@ store_inferior_registers (int regno)
           kern_return_t ret;
           if (i386_macosx_store_fp_registers (&fp_regs))
             {
-               ret = thread_set_state (current_thread, GDB_i386_FLOAT_STATE,
+               /* APPLE LOCAL thread state cache  */
+               ret = macosx_thread_set_state (current_thread, GDB_i386_FLOAT_STATE,
                                       (thread_state_t) & fp_regs,
                                       GDB_i386_FLOAT_STATE_COUNT);
                MACH_CHECK_ERROR (ret);
@@ -618,9 +637,171 @@ int
 i386_macosx_target_stopped_data_address (struct target_ops *target, 
                                          CORE_ADDR *addr)
 {
-  return i386_stopped_data_address (addr);
+  /* APPLE LOCAL debug register multiplexing  */
+  return i386_stopped_data_address (addr) || macosx_page_watch_triggered (addr);
 }
 
+/* APPLE LOCAL begin debug register multiplexing  */
+/* There are only four debug registers.  i386-nat.c shares them
+   between watchpoints on the same or overlapping writes; when that
+   still isn't enough, a write watchpoint falls back to protecting
+   the pages it covers, the way the other Darwin targets do it.  We
+   remember which way each watched region went, so it is removed the
+   same way and so the user can be told.  */
+
+enum i386_macosx_watch_strategy
+{
+  watch_by_debug_registers,
+  watch_by_page_protection
+};
+
+struct i386_macosx_watch
+{
+  CORE_ADDR addr;
+  int len;
+  int type;
+
+  /* How many times the region is currently inserted each way.  */
+  int dr_count;
+  int page_count;
+
+  /* The way the region was last inserted.  */
+  enum i386_macosx_watch_strategy strategy;
+
+  /* Non-zero once we've told the user about falling back.  */
+  int announced;
+
+  struct i386_macosx_watch *next;
+};
+
+static struct i386_macosx_watch *i386_macosx_watches = NULL;
+
+static int i386_macosx_watchpoint_page_fallback = 1;
+
+static struct i386_macosx_watch *
+i386_macosx_find_watch (CORE_ADDR addr, int len, int type, int create)
+{
+  struct i386_macosx_watch *w;
+
+  for (w = i386_macosx_watches; w != NULL; w = w->next)
+    if (w->addr == addr && w->len == len && w->type == type)
+      return w;
+
+  if (!create)
+    return NULL;
+
+  w = (struct i386_macosx_watch *) xcalloc (1, sizeof (*w));
+  w->addr = addr;
+  w->len = len;
+  w->type = type;
+  w->next = i386_macosx_watches;
+  i386_macosx_watches = w;
+  return w;
+}
+
+static void
+i386_macosx_clear_watches (void)
+{
+  while (i386_macosx_watches != NULL)
+    {
+      struct i386_macosx_watch *w = i386_macosx_watches;
+
+      i386_macosx_watches = w->next;
+      xfree (w);
+    }
+  macosx_page_watch_set_continuable (0);
+}
+
+static int
+i386_macosx_page_fallback_ok (void)
+{
+  return i386_macosx_watchpoint_page_fallback
+    && strcmp (current_target.to_shortname, "remote-kdp") != 0;
+}
+
+int
+i386_macosx_region_ok_for_watchpoint (CORE_ADDR addr, int len)
+{
+  return i386_region_ok_for_watchpoint (addr, len)
+    || i386_macosx_page_fallback_ok ();
+}
+
+static int
+i386_macosx_insert_watchpoint (CORE_ADDR addr, int len, int type)
+{
+  struct i386_macosx_watch *w = i386_macosx_find_watch (addr, len, type, 1);
+
+  if (i386_insert_watchpoint_whole (addr, len, type) == 0)
+    {
+      w->dr_count++;
+      w->strategy = watch_by_debug_registers;
+      return 0;
+    }
+
+  if (type != hw_write || !i386_macosx_page_fallback_ok ())
+    return -1;
+
+  if (macosx_insert_watchpoint (addr, len, type) == -1)
+    return -1;
+
+  w->page_count++;
+  w->strategy = watch_by_page_protection;
+  macosx_page_watch_set_continuable (1);
+  if (!w->announced)
+    {
+      w->announced = 1;
+      printf_filtered (_("Watchpoint on %d bytes at 0x%s uses page "
+			 "protection; no debug register is free.\n"),
+		       len, paddr_nz (addr));
+    }
+  return 0;
+}
+
+static int
+i386_macosx_remove_watchpoint (CORE_ADDR addr, int len, int type)
+{
+  struct i386_macosx_watch *w = i386_macosx_find_watch (addr, len, type, 0);
+
+  if (w != NULL && w->page_count > 0)
+    {
+      w->page_count--;
+      return macosx_remove_watchpoint (addr, len, type) == -1 ? -1 : 0;
+    }
+
+  if (w != NULL && w->dr_count > 0)
+    w->dr_count--;
+  return i386_remove_watchpoint (addr, len, type);
+}
+
+static int
+i386_macosx_stopped_by_watchpoint (void)
+{
+  return i386_stopped_by_watchpoint () || macosx_page_watch_triggered (NULL);
+}
+
+static void
+maintenance_info_watchpoint_strategies (char *args, int from_tty)
+{
+  struct i386_macosx_watch *w;
+  int found = 0;
+
+  for (w = i386_macosx_watches; w != NULL; w = w->next)
+    {
+      if (w->dr_count == 0 && w->page_count == 0)
+	continue;
+      found = 1;
+      printf_filtered (_("%d bytes at 0x%s (%s): %s\n"), w->len,
+		       paddr_nz (w->addr),
+		       w->type == hw_write ? "write"
+		       : w->type == hw_read ? "read" : "access",
+		       w->strategy == watch_by_page_protection
+		       ? "page protection" : "debug registers");
+    }
+  if (!found)
+    printf_filtered (_("No watchpoints are inserted.\n"));
+}
+/* APPLE LOCAL end debug register multiplexing  */
+
 int 
 i386_macosx_can_use_hw_breakpoint (int unused1, int unused2, int unused3)
 {
@@ -631,19 +812,43 @@ void
 i386_macosx_child_post_startup_inferior (ptid_t pid)
 {
   i386_cleanup_dregs();
+  /* APPLE LOCAL debug register multiplexing  */
+  i386_macosx_clear_watches ();
 }
 
 void
 macosx_complete_child_target (struct target_ops *target)
 {
   target->to_can_use_hw_breakpoint = i386_macosx_can_use_hw_breakpoint;
-  target->to_stopped_by_watchpoint = i386_stopped_by_watchpoint;
+  /* APPLE LOCAL begin debug register multiplexing  */
+  target->to_stopped_by_watchpoint = i386_macosx_stopped_by_watchpoint;
   target->to_stopped_data_address = i386_macosx_target_stopped_data_address;
-  target->to_insert_watchpoint = i386_insert_watchpoint;
-  target->to_remove_watchpoint = i386_remove_watchpoint;
+  target->to_insert_watchpoint = i386_macosx_insert_watchpoint;
+  target->to_remove_watchpoint = i386_macosx_remove_watchpoint;
+  /* APPLE LOCAL end debug register multiplexing  */
   target->to_insert_hw_breakpoint = i386_insert_hw_breakpoint;
   target->to_remove_hw_breakpoint = i386_remove_hw_breakpoint;
   target->to_have_continuable_watchpoint = 1;
   target->to_post_startup_inferior = i386_macosx_child_post_startup_inferior;
 }
 
+/* APPLE LOCAL begin debug register multiplexing  */
+void
+_initialize_i386_macosx_nat_exec (void)
+{
+  add_setshow_boolean_cmd ("watchpoint-page-fallback", class_obscure,
+			   &i386_macosx_watchpoint_page_fallback, _("\
+Set if write watchpoints may use page protection when debug registers run out."), _("\
+Show if write watchpoints may use page protection when debug registers run out."), _("\
+When on, a write watchpoint that can't get one of the four debug registers\n\
+is implemented by write-protecting the pages it covers instead.  This is\n\
+slower, but lets any number of write watchpoints be set."),
+			   NULL, NULL,
+			   &setlist, &showlist);
+
+  add_cmd ("watchpoint-strategies", class_maintenance,
+	   maintenance_info_watchpoint_strategies,
+	   _("Show how each inserted watchpoint is being implemented."),
+	   &maintenanceinfolist);
+}
+/* APPLE LOCAL end debug register multiplexing  */
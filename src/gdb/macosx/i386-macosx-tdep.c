@@ -46,216 +46,196 @@
 
 #include "i386-macosx-tdep.h"
 
-#define supply_unsigned_int(regnum, val)\
-store_unsigned_integer (buf, 4, val); \
-regcache_raw_supply (current_regcache, regnum, buf);
+static int x86_64_macosx_get_longjmp_target (CORE_ADDR *pc);
+static int i386_macosx_get_longjmp_target (CORE_ADDR *pc);
 
-#define collect_unsigned_int(regnum, addr)\
-regcache_raw_collect (current_regcache, regnum, buf); \
-(* (addr)) = extract_unsigned_integer (buf, 4);
+/* APPLE LOCAL begin register descriptors  */
+/* Where each general purpose register lives in the Mach thread state.
+   The Mach structures don't order the registers the way GDB numbers
+   them, so a flavor can't be copied into the regcache in one go; but
+   walking one of these tables does every register of the flavor in a
+   single pass, with no per-register code.  */
 
-#define supply_unsigned_int64(regnum, val)\
-store_unsigned_integer (buf, 8, val); \
-regcache_raw_supply (current_regcache, regnum, buf);
+struct macosx_gp_reg
+{
+  int regnum;
+  size_t offset;
+};
 
-#define collect_unsigned_int64(regnum, addr)\
-regcache_raw_collect (current_regcache, regnum, buf); \
-(* (addr)) = extract_unsigned_integer (buf, 8);
+#define I386_GP_REG(regnum, field) \
+  { regnum, offsetof (gdb_i386_thread_state_t, field) }
+
+static const struct macosx_gp_reg i386_macosx_gp_regs[] =
+{
+  I386_GP_REG (0, eax),
+  I386_GP_REG (1, ecx),
+  I386_GP_REG (2, edx),
+  I386_GP_REG (3, ebx),
+  I386_GP_REG (4, esp),
+  I386_GP_REG (5, ebp),
+  I386_GP_REG (6, esi),
+  I386_GP_REG (7, edi),
+  I386_GP_REG (8, eip),
+  I386_GP_REG (9, eflags),
+  I386_GP_REG (10, cs),
+  I386_GP_REG (11, ss),
+  I386_GP_REG (12, ds),
+  I386_GP_REG (13, es),
+  I386_GP_REG (14, fs),
+  I386_GP_REG (15, gs)
+};
 
-static int x86_64_macosx_get_longjmp_target (CORE_ADDR *pc);
-static int i386_macosx_get_longjmp_target (CORE_ADDR *pc);
+#define X86_64_GP_REG(regnum, field) \
+  { regnum, offsetof (gdb_x86_thread_state64_t, field) }
+
+static const struct macosx_gp_reg x86_64_macosx_gp_regs[] =
+{
+  X86_64_GP_REG (AMD64_RAX_REGNUM, rax),
+  X86_64_GP_REG (AMD64_RBX_REGNUM, rbx),
+  X86_64_GP_REG (AMD64_RCX_REGNUM, rcx),
+  X86_64_GP_REG (AMD64_RDX_REGNUM, rdx),
+  X86_64_GP_REG (AMD64_RDI_REGNUM, rdi),
+  X86_64_GP_REG (AMD64_RSI_REGNUM, rsi),
+  X86_64_GP_REG (AMD64_RBP_REGNUM, rbp),
+  X86_64_GP_REG (AMD64_RSP_REGNUM, rsp),
+  X86_64_GP_REG (AMD64_R8_REGNUM, r8),
+  X86_64_GP_REG (AMD64_R8_REGNUM + 1, r9),
+  X86_64_GP_REG (AMD64_R8_REGNUM + 2, r10),
+  X86_64_GP_REG (AMD64_R8_REGNUM + 3, r11),
+  X86_64_GP_REG (AMD64_R8_REGNUM + 4, r12),
+  X86_64_GP_REG (AMD64_R8_REGNUM + 5, r13),
+  X86_64_GP_REG (AMD64_R8_REGNUM + 6, r14),
+  X86_64_GP_REG (AMD64_R8_REGNUM + 7, r15),
+  X86_64_GP_REG (AMD64_RIP_REGNUM, rip),
+  X86_64_GP_REG (AMD64_EFLAGS_REGNUM, rflags),
+  X86_64_GP_REG (AMD64_CS_REGNUM, cs),
+  X86_64_GP_REG (AMD64_FS_REGNUM, fs),
+  X86_64_GP_REG (AMD64_GS_REGNUM, gs)
+};
+
+#define NUM_GP_REGS(table) (sizeof (table) / sizeof ((table)[0]))
+
+/* Supply the NREGS registers of REGS, each SIZE bytes, from the thread
+   state at STATE.  If RAW, the state is already in target byte order;
+   otherwise its fields are host integers.  */
+
+static void
+macosx_supply_gp_regs (const struct macosx_gp_reg *regs, int nregs,
+		       int size, const gdb_byte *state, int raw)
+{
+  gdb_byte buf[8];
+  ULONGEST val;
+  int i;
+
+  for (i = 0; i < nregs; i++)
+    {
+      const gdb_byte *field = state + regs[i].offset;
+
+      if (raw)
+	{
+	  regcache_raw_supply (current_regcache, regs[i].regnum, field);
+	  continue;
+	}
+      if (size == 8)
+	val = *(const uint64_t *) field;
+      else
+	val = *(const unsigned int *) field;
+      store_unsigned_integer (buf, size, val);
+      regcache_raw_supply (current_regcache, regs[i].regnum, buf);
+    }
+}
+
+/* The reverse of macosx_supply_gp_regs: fill in the thread state at
+   STATE from the regcache.  */
+
+static void
+macosx_collect_gp_regs (const struct macosx_gp_reg *regs, int nregs,
+			int size, gdb_byte *state, int raw)
+{
+  gdb_byte buf[8];
+  int i;
+
+  for (i = 0; i < nregs; i++)
+    {
+      gdb_byte *field = state + regs[i].offset;
+
+      if (raw)
+	{
+	  regcache_raw_collect (current_regcache, regs[i].regnum, field);
+	  continue;
+	}
+      regcache_raw_collect (current_regcache, regs[i].regnum, buf);
+      if (size == 8)
+	*(uint64_t *) field = extract_unsigned_integer (buf, 8);
+      else
+	*(unsigned int *) field = extract_unsigned_integer (buf, 4);
+    }
+}
 
 void
 i386_macosx_fetch_gp_registers (gdb_i386_thread_state_t *sp_regs)
 {
-  gdb_byte buf[4];
-  supply_unsigned_int (0, sp_regs->eax);
-  supply_unsigned_int (1, sp_regs->ecx);
-  supply_unsigned_int (2, sp_regs->edx);
-  supply_unsigned_int (3, sp_regs->ebx);
-  supply_unsigned_int (4, sp_regs->esp);
-  supply_unsigned_int (5, sp_regs->ebp);
-  supply_unsigned_int (6, sp_regs->esi);
-  supply_unsigned_int (7, sp_regs->edi);
-  supply_unsigned_int (8, sp_regs->eip);
-  supply_unsigned_int (9, sp_regs->eflags);
-  supply_unsigned_int (10, sp_regs->cs);
-  supply_unsigned_int (11, sp_regs->ss);
-  supply_unsigned_int (12, sp_regs->ds);
-  supply_unsigned_int (13, sp_regs->es);
-  supply_unsigned_int (14, sp_regs->fs);
-  supply_unsigned_int (15, sp_regs->gs);
+  macosx_supply_gp_regs (i386_macosx_gp_regs,
+			 NUM_GP_REGS (i386_macosx_gp_regs), 4,
+			 (const gdb_byte *) sp_regs, 0);
 }
 
 void
 i386_macosx_fetch_gp_registers_raw (gdb_i386_thread_state_t *sp_regs)
 {
-  regcache_raw_supply (current_regcache, 0, &sp_regs->eax);
-  regcache_raw_supply (current_regcache, 1, &sp_regs->ecx);
-  regcache_raw_supply (current_regcache, 2, &sp_regs->edx);
-  regcache_raw_supply (current_regcache, 3, &sp_regs->ebx);
-  regcache_raw_supply (current_regcache, 4, &sp_regs->esp);
-  regcache_raw_supply (current_regcache, 5, &sp_regs->ebp);
-  regcache_raw_supply (current_regcache, 6, &sp_regs->esi);
-  regcache_raw_supply (current_regcache, 7, &sp_regs->edi);
-  regcache_raw_supply (current_regcache, 8, &sp_regs->eip);
-  regcache_raw_supply (current_regcache, 9, &sp_regs->eflags);
-  regcache_raw_supply (current_regcache, 10, &sp_regs->cs);
-  regcache_raw_supply (current_regcache, 11, &sp_regs->ss);
-  regcache_raw_supply (current_regcache, 12, &sp_regs->ds);
-  regcache_raw_supply (current_regcache, 13, &sp_regs->es);
-  regcache_raw_supply (current_regcache, 14, &sp_regs->fs);
-  regcache_raw_supply (current_regcache, 15, &sp_regs->gs);
+  macosx_supply_gp_regs (i386_macosx_gp_regs,
+			 NUM_GP_REGS (i386_macosx_gp_regs), 4,
+			 (const gdb_byte *) sp_regs, 1);
 }
 
 void
 i386_macosx_store_gp_registers (gdb_i386_thread_state_t *sp_regs)
 {
-  unsigned char buf[4];
-  collect_unsigned_int (0, &sp_regs->eax);
-  collect_unsigned_int (1, &sp_regs->ecx);
-  collect_unsigned_int (2, &sp_regs->edx);
-  collect_unsigned_int (3, &sp_regs->ebx);
-  collect_unsigned_int (4, &sp_regs->esp);
-  collect_unsigned_int (5, &sp_regs->ebp);
-  collect_unsigned_int (6, &sp_regs->esi);
-  collect_unsigned_int (7, &sp_regs->edi);
-  collect_unsigned_int (8, &sp_regs->eip);
-  collect_unsigned_int (9, &sp_regs->eflags);
-  collect_unsigned_int (10, &sp_regs->cs);
-  collect_unsigned_int (11, &sp_regs->ss);
-  collect_unsigned_int (12, &sp_regs->ds);
-  collect_unsigned_int (13, &sp_regs->es);
-  collect_unsigned_int (14, &sp_regs->fs);
-  collect_unsigned_int (15, &sp_regs->gs);
+  macosx_collect_gp_regs (i386_macosx_gp_regs,
+			  NUM_GP_REGS (i386_macosx_gp_regs), 4,
+			  (gdb_byte *) sp_regs, 0);
 }
 
 void
 i386_macosx_store_gp_registers_raw (gdb_i386_thread_state_t *sp_regs)
 {
-  regcache_raw_collect (current_regcache, 0, &sp_regs->eax);
-  regcache_raw_collect (current_regcache, 1, &sp_regs->ecx);
-  regcache_raw_collect (current_regcache, 2, &sp_regs->edx);
-  regcache_raw_collect (current_regcache, 3, &sp_regs->ebx);
-  regcache_raw_collect (current_regcache, 4, &sp_regs->esp);
-  regcache_raw_collect (current_regcache, 5, &sp_regs->ebp);
-  regcache_raw_collect (current_regcache, 6, &sp_regs->esi);
-  regcache_raw_collect (current_regcache, 7, &sp_regs->edi);
-  regcache_raw_collect (current_regcache, 8, &sp_regs->eip);
-  regcache_raw_collect (current_regcache, 9, &sp_regs->eflags);
-  regcache_raw_collect (current_regcache, 10, &sp_regs->cs);
-  regcache_raw_collect (current_regcache, 11, &sp_regs->ss);
-  regcache_raw_collect (current_regcache, 12, &sp_regs->ds);
-  regcache_raw_collect (current_regcache, 13, &sp_regs->es);
-  regcache_raw_collect (current_regcache, 14, &sp_regs->fs);
-  regcache_raw_collect (current_regcache, 15, &sp_regs->gs);
+  macosx_collect_gp_regs (i386_macosx_gp_regs,
+			  NUM_GP_REGS (i386_macosx_gp_regs), 4,
+			  (gdb_byte *) sp_regs, 1);
 }
 
 void
 x86_64_macosx_fetch_gp_registers (gdb_x86_thread_state64_t *sp_regs)
 {
-  unsigned char buf[8];
-  supply_unsigned_int64 (AMD64_RAX_REGNUM, sp_regs->rax);
-  supply_unsigned_int64 (AMD64_RBX_REGNUM, sp_regs->rbx);
-  supply_unsigned_int64 (AMD64_RCX_REGNUM, sp_regs->rcx);
-  supply_unsigned_int64 (AMD64_RDX_REGNUM, sp_regs->rdx);
-  supply_unsigned_int64 (AMD64_RDI_REGNUM, sp_regs->rdi);
-  supply_unsigned_int64 (AMD64_RSI_REGNUM, sp_regs->rsi);
-  supply_unsigned_int64 (AMD64_RBP_REGNUM, sp_regs->rbp);
-  supply_unsigned_int64 (AMD64_RSP_REGNUM, sp_regs->rsp);
-  supply_unsigned_int64 (AMD64_R8_REGNUM, sp_regs->r8);
-  supply_unsigned_int64 (AMD64_R8_REGNUM + 1, sp_regs->r9);
-  supply_unsigned_int64 (AMD64_R8_REGNUM + 2, sp_regs->r10);
-  supply_unsigned_int64 (AMD64_R8_REGNUM + 3, sp_regs->r11);
-  supply_unsigned_int64 (AMD64_R8_REGNUM + 4, sp_regs->r12);
-  supply_unsigned_int64 (AMD64_R8_REGNUM + 5, sp_regs->r13);
-  supply_unsigned_int64 (AMD64_R8_REGNUM + 6, sp_regs->r14);
-  supply_unsigned_int64 (AMD64_R8_REGNUM + 7, sp_regs->r15);
-  supply_unsigned_int64 (AMD64_RIP_REGNUM, sp_regs->rip);
-  supply_unsigned_int64 (AMD64_EFLAGS_REGNUM, sp_regs->rflags);
-  supply_unsigned_int64 (AMD64_CS_REGNUM, sp_regs->cs);
-  supply_unsigned_int64 (AMD64_FS_REGNUM, sp_regs->fs);
-  supply_unsigned_int64 (AMD64_GS_REGNUM, sp_regs->gs);
+  macosx_supply_gp_regs (x86_64_macosx_gp_regs,
+			 NUM_GP_REGS (x86_64_macosx_gp_regs), 8,
+			 (const gdb_byte *) sp_regs, 0);
 }
 
 void
 x86_64_macosx_fetch_gp_registers_raw (gdb_x86_thread_state64_t *sp_regs)
 {
-  regcache_raw_supply (current_regcache, AMD64_RAX_REGNUM, &sp_regs->rax);
-  regcache_raw_supply (current_regcache, AMD64_RBX_REGNUM, &sp_regs->rbx);
-  regcache_raw_supply (current_regcache, AMD64_RCX_REGNUM, &sp_regs->rcx);
-  regcache_raw_supply (current_regcache, AMD64_RDX_REGNUM, &sp_regs->rdx);
-  regcache_raw_supply (current_regcache, AMD64_RDI_REGNUM, &sp_regs->rdi);
-  regcache_raw_supply (current_regcache, AMD64_RSI_REGNUM, &sp_regs->rsi);
-  regcache_raw_supply (current_regcache, AMD64_RBP_REGNUM, &sp_regs->rbp);
-  regcache_raw_supply (current_regcache, AMD64_RSP_REGNUM, &sp_regs->rsp);
-  regcache_raw_supply (current_regcache, AMD64_R8_REGNUM, &sp_regs->r8);
-  regcache_raw_supply (current_regcache, AMD64_R8_REGNUM + 1, &sp_regs->r9);
-  regcache_raw_supply (current_regcache, AMD64_R8_REGNUM + 2, &sp_regs->r10);
-  regcache_raw_supply (current_regcache, AMD64_R8_REGNUM + 3, &sp_regs->r11);
-  regcache_raw_supply (current_regcache, AMD64_R8_REGNUM + 4, &sp_regs->r12);
-  regcache_raw_supply (current_regcache, AMD64_R8_REGNUM + 5, &sp_regs->r13);
-  regcache_raw_supply (current_regcache, AMD64_R8_REGNUM + 6, &sp_regs->r14);
-  regcache_raw_supply (current_regcache, AMD64_R8_REGNUM + 7, &sp_regs->r15);
-  regcache_raw_supply (current_regcache, AMD64_RIP_REGNUM, &sp_regs->rip);
-  regcache_raw_supply (current_regcache, AMD64_EFLAGS_REGNUM, &sp_regs->rflags);
-  regcache_raw_supply (current_regcache, AMD64_CS_REGNUM, &sp_regs->cs);
-  regcache_raw_supply (current_regcache, AMD64_FS_REGNUM, &sp_regs->fs);
-  regcache_raw_supply (current_regcache, AMD64_GS_REGNUM, &sp_regs->gs);
+  macosx_supply_gp_regs (x86_64_macosx_gp_regs,
+			 NUM_GP_REGS (x86_64_macosx_gp_regs), 8,
+			 (const gdb_byte *) sp_regs, 1);
 }
 
 void
 x86_64_macosx_store_gp_registers (gdb_x86_thread_state64_t *sp_regs)
 {
-  unsigned char buf[8];
-  collect_unsigned_int64 (AMD64_RAX_REGNUM, &sp_regs->rax);
-  collect_unsigned_int64 (AMD64_RBX_REGNUM, &sp_regs->rbx);
-  collect_unsigned_int64 (AMD64_RCX_REGNUM, &sp_regs->rcx);
-  collect_unsigned_int64 (AMD64_RDX_REGNUM, &sp_regs->rdx);
-  collect_unsigned_int64 (AMD64_RDI_REGNUM, &sp_regs->rdi);
-  collect_unsigned_int64 (AMD64_RSI_REGNUM, &sp_regs->rsi);
-  collect_unsigned_int64 (AMD64_RBP_REGNUM, &sp_regs->rbp);
-  collect_unsigned_int64 (AMD64_RSP_REGNUM, &sp_regs->rsp);
-  collect_unsigned_int64 (AMD64_R8_REGNUM, &sp_regs->r8);
-  collect_unsigned_int64 (AMD64_R8_REGNUM + 1, &sp_regs->r9);
-  collect_unsigned_int64 (AMD64_R8_REGNUM + 2, &sp_regs->r10);
-  collect_unsigned_int64 (AMD64_R8_REGNUM + 3, &sp_regs->r11);
-  collect_unsigned_int64 (AMD64_R8_REGNUM + 4, &sp_regs->r12);
-  collect_unsigned_int64 (AMD64_R8_REGNUM + 5, &sp_regs->r13);
-  collect_unsigned_int64 (AMD64_R8_REGNUM + 6, &sp_regs->r14);
-  collect_unsigned_int64 (AMD64_R8_REGNUM + 7, &sp_regs->r15);
-  collect_unsigned_int64 (AMD64_RIP_REGNUM, &sp_regs->rip);
-  collect_unsigned_int64 (AMD64_EFLAGS_REGNUM, &sp_regs->rflags);
-  collect_unsigned_int64 (AMD64_CS_REGNUM, &sp_regs->cs);
-  collect_unsigned_int64 (AMD64_FS_REGNUM, &sp_regs->fs);
-  collect_unsigned_int64 (AMD64_GS_REGNUM, &sp_regs->gs);
+  macosx_collect_gp_regs (x86_64_macosx_gp_regs,
+			  NUM_GP_REGS (x86_64_macosx_gp_regs), 8,
+			  (gdb_byte *) sp_regs, 0);
 }
 
 void
 x86_64_macosx_store_gp_registers_raw (gdb_x86_thread_state64_t *sp_regs)
 {
-  regcache_raw_collect (current_regcache, AMD64_RAX_REGNUM, &sp_regs->rax);
-  regcache_raw_collect (current_regcache, AMD64_RBX_REGNUM, &sp_regs->rbx);
-  regcache_raw_collect (current_regcache, AMD64_RCX_REGNUM, &sp_regs->rcx);
-  regcache_raw_collect (current_regcache, AMD64_RDX_REGNUM, &sp_regs->rdx);
-  regcache_raw_collect (current_regcache, AMD64_RDI_REGNUM, &sp_regs->rdi);
-  regcache_raw_collect (current_regcache, AMD64_RSI_REGNUM, &sp_regs->rsi);
-  regcache_raw_collect (current_regcache, AMD64_RBP_REGNUM, &sp_regs->rbp);
-  regcache_raw_collect (current_regcache, AMD64_RSP_REGNUM, &sp_regs->rsp);
-  regcache_raw_collect (current_regcache, AMD64_R8_REGNUM, &sp_regs->r8);
-  regcache_raw_collect (current_regcache, AMD64_R8_REGNUM + 1, &sp_regs->r9);
-  regcache_raw_collect (current_regcache, AMD64_R8_REGNUM + 2, &sp_regs->r10);
-  regcache_raw_collect (current_regcache, AMD64_R8_REGNUM + 3, &sp_regs->r11);
-  regcache_raw_collect (current_regcache, AMD64_R8_REGNUM + 4, &sp_regs->r12);
-  regcache_raw_collect (current_regcache, AMD64_R8_REGNUM + 5, &sp_regs->r13);
-  regcache_raw_collect (current_regcache, AMD64_R8_REGNUM + 6, &sp_regs->r14);
-  regcache_raw_collect (current_regcache, AMD64_R8_REGNUM + 7, &sp_regs->r15);
-  regcache_raw_collect (current_regcache, AMD64_RIP_REGNUM, &sp_regs->rip);
-  regcache_raw_collect (current_regcache, AMD64_EFLAGS_REGNUM, &sp_regs->rflags);
-  regcache_raw_collect (current_regcache, AMD64_CS_REGNUM, &sp_regs->cs);
-  regcache_raw_collect (current_regcache, AMD64_FS_REGNUM, &sp_regs->fs);
-  regcache_raw_collect (current_regcache, AMD64_GS_REGNUM, &sp_regs->gs);
+  macosx_collect_gp_regs (x86_64_macosx_gp_regs,
+			  NUM_GP_REGS (x86_64_macosx_gp_regs), 8,
+			  (gdb_byte *) sp_regs, 1);
 }
+/* APPLE LOCAL end register descriptors  */
 
 /* Fetching the the registers from the inferior into our reg cache.
    FP_REGS is a structure that mirrors the Mach structure
@@ -574,6 +554,12 @@ i386_macosx_init_abi (struct gdbarch_info info, struct gdbarch *gdbarch)
   tdep->jb_pc_offset = 20;
   set_gdbarch_integer_to_address (gdbarch, i386_integer_to_address);
   set_gdbarch_frame_align (gdbarch, i386_macosx_frame_align);
+
+  /* APPLE LOCAL begin displaced stepping  */
+  set_gdbarch_displaced_step_copy_insn (gdbarch,
+					i386_displaced_step_copy_insn);
+  set_gdbarch_displaced_step_fixup (gdbarch, i386_displaced_step_fixup);
+  /* APPLE LOCAL end displaced stepping  */
 }
 
 static void
@@ -599,6 +585,12 @@ x86_macosx_init_abi_64 (struct gdbarch_info info, struct gdbarch *gdbarch)
 
   tdep->jb_pc_offset = 148;
   set_gdbarch_integer_to_address (gdbarch, i386_integer_to_address);
+
+  /* APPLE LOCAL begin displaced stepping  */
+  set_gdbarch_displaced_step_copy_insn (gdbarch,
+					i386_displaced_step_copy_insn);
+  set_gdbarch_displaced_step_fixup (gdbarch, i386_displaced_step_fixup);
+  /* APPLE LOCAL end displaced stepping  */
 }
 
 static int
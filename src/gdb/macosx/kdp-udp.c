@@ -40,6 +40,10 @@
 
 #include "defs.h"
 #include "event-loop.h"
+/* APPLE LOCAL remote wire stats  */
+#include "remote.h"
+
+struct remote_wire_stats kdp_wire_stats;
 
 #define assert CHECK_FATAL
 
@@ -110,6 +114,14 @@ kdp_transmit_fd (kdp_connection *c, kdp_pkt_t * packet, int fd)
       return RR_BYTE_COUNT;
     }
 
+  /* APPLE LOCAL remote wire stats: Requests on the debug port get
+     replies; exception acks don't.  */
+  {
+    const char *type = kdp_req_string (packet->hdr.request);
+    remote_wire_stats_send (&kdp_wire_stats, type, strlen (type), plen,
+                            fd == c->reqfd && !packet->hdr.is_reply);
+  }
+
   return RR_SUCCESS;
 }
 
@@ -188,6 +200,10 @@ kdp_receive_fd (kdp_connection *c, kdp_pkt_t * packet, int fd, int timeout)
   c->logger (KDP_LOG_DEBUG, "kdp_receive_fd: received packet\n");
   kdp_log_packet (c->logger, KDP_LOG_DEBUG, packet);
 
+  /* APPLE LOCAL remote wire stats  */
+  remote_wire_stats_receive (&kdp_wire_stats, rlen,
+                             fd == c->reqfd && packet->hdr.is_reply);
+
   return RR_SUCCESS;
 }
 
@@ -48,6 +48,11 @@ struct kdp_connection
 
 typedef struct kdp_connection kdp_connection;
 
+/* APPLE LOCAL: Traffic on every KDP connection, for "maint info
+   remote-stats".  */
+struct remote_wire_stats;
+extern struct remote_wire_stats kdp_wire_stats;
+
 kdp_return_t kdp_transmit_fd (kdp_connection *c, kdp_pkt_t * packet, int fd);
 
 kdp_return_t kdp_receive_fd
@@ -56,6 +56,19 @@
 #include "macosx-nat-inferior.h"
 
 #include <string.h>
+/* APPLE LOCAL begin symfile cache */
+#include "gdb_stat.h"
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+/* APPLE LOCAL end symfile cache */
 
 #if HAVE_MMAP
 static int mmap_strtabflag = 1;
@@ -65,6 +78,10 @@ static int use_eh_frames_info = 0;
 
 static int mach_o_process_exports_flag = 1;
 
+/* APPLE LOCAL shared names: If non-zero, objfiles for dylibs in the
+   dyld shared cache keep their symbol names in one shared table.  */
+static int share_shared_cache_names = 1;
+
 struct macho_symfile_info
 {
   asymbol **syms;
@@ -513,6 +530,329 @@ macho_build_psymtabs (struct objfile *objfile, int mainline,
   dbx_symfile_read (objfile, mainline);
 }
 
+/* APPLE LOCAL begin symfile cache */
+/* The symfile cache.
+
+   Most of the time spent reading a system library's symbols goes into
+   walking its nlist entries and building minimal symbols from them.
+   System libraries carry no stabs or DWARF, so the minimal symbols are
+   all there is, and they are the same on every machine running the
+   same build of the OS.  "sharedlibrary cache-symfiles DIR" writes the
+   minimal symbols of each such objfile to DIR/<UUID>.symfile, and when
+   "maint set mach-o-symfile-cache-directory DIR" is set,
+   macho_symfile_read maps that file and records its symbols instead
+   of reading the nlists.
+
+   The file is a header, then one record per minimal symbol, then the
+   symbols' names.  Addresses are stored without the objfile's section
+   offsets, which are added back when the file is read, so one file
+   serves every load address.  Only objfiles that end up with no
+   psymtabs and no DWARF are cached, so nothing but the minimal symbols
+   needs saving; the section table is still made from the bfd.  */
+
+#define SYMFILE_CACHE_MAGIC "GDBSYMF"
+#define SYMFILE_CACHE_VERSION 1
+
+struct symfile_cache_header
+{
+  char magic[8];
+  unsigned int version;
+  unsigned int header_size;
+  unsigned char uuid[16];
+  /* The levels of OBJF_SYM_* the symbols were read with.  */
+  unsigned int symflags;
+  unsigned int n_msymbols;
+  unsigned int strings_size;
+  unsigned int pad;
+};
+
+struct symfile_cache_msymbol
+{
+  ULONGEST address;
+  ULONGEST size;
+  unsigned int name_offset;
+  /* The msymbol's info word; on Darwin targets it only carries flag
+     bits such as the ARM thumb bit.  */
+  unsigned int info;
+  int section;
+  int bfd_section;
+  unsigned int type;
+  unsigned int pad;
+};
+
+static char *symfile_cache_directory = NULL;
+
+static void
+show_symfile_cache_directory (struct ui_file *file, int from_tty,
+			      struct cmd_list_element *c, const char *value)
+{
+  if (value == NULL || *value == '\0')
+    fprintf_filtered (file, _("The symfile cache is disabled.\n"));
+  else
+    fprintf_filtered (file, _("The symfile cache directory is \"%s\".\n"),
+		      value);
+}
+
+/* Return the name of OBJFILE's cache file in DIRECTORY, allocated with
+   xmalloc, or NULL if OBJFILE has no UUID.  Store the UUID in UUID.  */
+
+static char *
+symfile_cache_file_name (struct objfile *objfile, const char *directory,
+			 unsigned char *uuid)
+{
+  char *name;
+  int i, len;
+
+  if (objfile->obfd == NULL
+      || !bfd_mach_o_get_uuid (objfile->obfd, uuid, 16))
+    return NULL;
+
+  len = strlen (directory);
+  name = xmalloc (len + 1 + 2 * 16 + sizeof (".symfile"));
+  strcpy (name, directory);
+  name[len++] = '/';
+  for (i = 0; i < 16; i++)
+    len += sprintf (name + len, "%02X", uuid[i]);
+  strcpy (name + len, ".symfile");
+
+  return name;
+}
+
+/* Return the bfd section of OBJFILE whose index is INDEX, or NULL.  */
+
+static asection *
+symfile_cache_bfd_section (struct objfile *objfile, int index)
+{
+  asection *sect;
+
+  if (index < 0)
+    return NULL;
+  for (sect = objfile->obfd->sections; sect != NULL; sect = sect->next)
+    if (sect->index == index)
+      return sect;
+  return NULL;
+}
+
+/* Record OBJFILE's minimal symbols from its cache file, if the cache
+   is enabled and the file checks out.  Return nonzero if it did; the
+   caller still has to install them.  */
+
+static int
+macho_read_symfile_cache (struct objfile *objfile)
+{
+  unsigned char uuid[16];
+  char *filename;
+  int fd;
+  struct stat st;
+  char *data;
+  const struct symfile_cache_header *header;
+  const struct symfile_cache_msymbol *msyms;
+  const char *strings;
+  unsigned int i;
+  int ret = 0;
+
+  if (symfile_cache_directory == NULL || *symfile_cache_directory == '\0'
+      || objfile->prefix != NULL)
+    return 0;
+
+  filename = symfile_cache_file_name (objfile, symfile_cache_directory, uuid);
+  if (filename == NULL)
+    return 0;
+
+  fd = open (filename, O_RDONLY | O_BINARY);
+  xfree (filename);
+  if (fd < 0)
+    return 0;
+
+  if (fstat (fd, &st) != 0
+      || st.st_size < sizeof (struct symfile_cache_header))
+    {
+      close (fd);
+      return 0;
+    }
+
+#ifdef HAVE_MMAP
+  data = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == (char *) MAP_FAILED)
+    {
+      close (fd);
+      return 0;
+    }
+#else
+  data = xmalloc (st.st_size);
+  if (read (fd, data, st.st_size) != st.st_size)
+    {
+      xfree (data);
+      close (fd);
+      return 0;
+    }
+#endif
+  close (fd);
+
+  header = (const struct symfile_cache_header *) data;
+  if (memcmp (header->magic, SYMFILE_CACHE_MAGIC, sizeof (header->magic)) != 0
+      || header->version != SYMFILE_CACHE_VERSION
+      || header->header_size != sizeof (struct symfile_cache_header)
+      || memcmp (header->uuid, uuid, sizeof (uuid)) != 0
+      || header->symflags != (objfile->symflags & OBJF_SYM_LEVELS_MASK)
+      || header->strings_size == 0
+      || (ULONGEST) st.st_size
+	 != (sizeof (*header)
+	     + (ULONGEST) header->n_msymbols * sizeof (*msyms)
+	     + header->strings_size))
+    goto done;
+
+  msyms = (const struct symfile_cache_msymbol *) (header + 1);
+  strings = (const char *) (msyms + header->n_msymbols);
+  if (strings[header->strings_size - 1] != '\0')
+    goto done;
+  for (i = 0; i < header->n_msymbols; i++)
+    if (msyms[i].name_offset >= header->strings_size
+	|| msyms[i].section >= objfile->num_sections)
+      goto done;
+
+  for (i = 0; i < header->n_msymbols; i++)
+    {
+      const struct symfile_cache_msymbol *m = &msyms[i];
+      struct minimal_symbol *msym;
+      CORE_ADDR address = m->address;
+
+      if (m->section >= 0)
+	address += ANOFFSET (objfile->section_offsets, m->section);
+      msym = prim_record_minimal_symbol_and_info
+	(strings + m->name_offset, address, (enum minimal_symbol_type) m->type,
+	 (char *) (unsigned long) m->info, m->section,
+	 symfile_cache_bfd_section (objfile, m->bfd_section), objfile);
+      if (msym != NULL)
+	MSYMBOL_SIZE (msym) = m->size;
+    }
+  ret = 1;
+
+ done:
+#ifdef HAVE_MMAP
+  munmap (data, st.st_size);
+#else
+  xfree (data);
+#endif
+  return ret;
+}
+
+/* Write OBJFILE's minimal symbols to its cache file in DIRECTORY.
+   Return 1 if it was written, or 0 if OBJFILE can't be cached because
+   it has no UUID or has symbols other than its minimal symbols.
+   Errors writing the file are reported with error.  */
+
+int
+macho_write_symfile_cache (struct objfile *objfile, const char *directory)
+{
+  unsigned char uuid[16];
+  struct symfile_cache_header header;
+  struct symfile_cache_msymbol *msyms;
+  struct cleanup *cleanups;
+  char *filename, *tmpname;
+  unsigned int strings_size;
+  int i, n;
+  FILE *f;
+
+  if (objfile->psymtabs != NULL || objfile->symtabs != NULL
+      || objfile->prefix != NULL
+      || (objfile->flags & OBJF_SEPARATE_DEBUG_FILE)
+      || objfile->separate_debug_objfile != NULL
+      || dwarf2_has_info (objfile))
+    return 0;
+
+  filename = symfile_cache_file_name (objfile, directory, uuid);
+  if (filename == NULL)
+    return 0;
+  cleanups = make_cleanup (xfree, filename);
+
+  n = objfile->minimal_symbol_count;
+  msyms = xcalloc (n > 0 ? n : 1, sizeof (struct symfile_cache_msymbol));
+  make_cleanup (xfree, msyms);
+
+  /* The names go after the records, each one NUL terminated.  The
+     first byte of the table is a NUL so it is never empty.  */
+  strings_size = 1;
+  for (i = 0; i < n; i++)
+    {
+      struct minimal_symbol *msym = &objfile->msymbols[i];
+      int section = SYMBOL_SECTION (msym);
+
+      /* Anything but flag bits in the info word can't be saved.  */
+      if ((unsigned long) MSYMBOL_INFO (msym) > 0xffffffffUL)
+	{
+	  do_cleanups (cleanups);
+	  return 0;
+	}
+
+      msyms[i].address = SYMBOL_VALUE_ADDRESS (msym);
+      if (section >= 0 && section < objfile->num_sections)
+	msyms[i].address -= ANOFFSET (objfile->section_offsets, section);
+      else
+	section = -1;
+      msyms[i].section = section;
+      msyms[i].size = MSYMBOL_SIZE (msym);
+      msyms[i].info = (unsigned long) MSYMBOL_INFO (msym);
+      msyms[i].bfd_section = (SYMBOL_BFD_SECTION (msym) != NULL
+			      ? SYMBOL_BFD_SECTION (msym)->index : -1);
+      msyms[i].type = MSYMBOL_TYPE (msym);
+      msyms[i].name_offset = strings_size;
+      strings_size += strlen (SYMBOL_LINKAGE_NAME (msym)) + 1;
+    }
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, SYMFILE_CACHE_MAGIC, sizeof (header.magic));
+  header.version = SYMFILE_CACHE_VERSION;
+  header.header_size = sizeof (header);
+  memcpy (header.uuid, uuid, sizeof (uuid));
+  header.symflags = objfile->symflags & OBJF_SYM_LEVELS_MASK;
+  header.n_msymbols = n;
+  header.strings_size = strings_size;
+
+  /* Write to a temporary name and rename it into place, so that a
+     gdb reading the cache never sees half a file.  */
+  tmpname = xstrprintf ("%s.%d", filename, (int) getpid ());
+  make_cleanup (xfree, tmpname);
+  f = fopen (tmpname, "wb");
+  if (f == NULL)
+    error (_("Unable to create \"%s\": %s"), tmpname, safe_strerror (errno));
+
+  if (fwrite (&header, sizeof (header), 1, f) != 1
+      || (n > 0
+	  && fwrite (msyms, sizeof (struct symfile_cache_msymbol), n, f) != n)
+      || fputc ('\0', f) == EOF)
+    goto write_error;
+  for (i = 0; i < n; i++)
+    {
+      const char *name = SYMBOL_LINKAGE_NAME (&objfile->msymbols[i]);
+
+      if (fwrite (name, 1, strlen (name) + 1, f) != strlen (name) + 1)
+	goto write_error;
+    }
+  if (fclose (f) != 0)
+    {
+      f = NULL;
+      goto write_error;
+    }
+
+  if (rename (tmpname, filename) != 0)
+    {
+      unlink (tmpname);
+      error (_("Unable to rename \"%s\" to \"%s\": %s"), tmpname, filename,
+	     safe_strerror (errno));
+    }
+
+  do_cleanups (cleanups);
+  return 1;
+
+ write_error:
+  if (f != NULL)
+    fclose (f);
+  unlink (tmpname);
+  error (_("Unable to write \"%s\": %s"), tmpname, safe_strerror (errno));
+}
+/* APPLE LOCAL end symfile cache */
+
 static void
 macho_symfile_read (struct objfile *objfile, int mainline)
 {
@@ -542,6 +882,10 @@ macho_symfile_read (struct objfile *objfile, int mainline)
   if (bfd_mach_o_encrypted_binary (abfd))
     return;
 
+  /* APPLE LOCAL shared names  */
+  if (share_shared_cache_names && bfd_mach_o_in_shared_cached_memory (abfd))
+    objfile_use_shared_names (objfile);
+
   init_minimal_symbol_collection ();
   minsym_cleanup = make_cleanup_discard_minimal_symbols ();
 
@@ -554,6 +898,17 @@ macho_symfile_read (struct objfile *objfile, int mainline)
       mainline = 0;
     }
 
+  /* APPLE LOCAL begin symfile cache */
+  if (!dwarf2_has_info (objfile) && macho_read_symfile_cache (objfile))
+    {
+      if (dwarf_eh_frame_section != NULL && use_eh_frames_info)
+	dwarf2_build_frame_info (objfile);
+      install_minimal_symbols (objfile);
+      do_cleanups (minsym_cleanup);
+      return;
+    }
+  /* APPLE LOCAL end symfile cache */
+
   if (info_verbose
       && macosx_bfd_is_in_memory (abfd) 
       && target_is_remote () 
@@ -1068,4 +1423,29 @@ Set if GDB should process indirect function stub symbols from object files."), _
 Show if GDB should process indirect function stub symbols from object files."), NULL,
 			   NULL, NULL,
 			   &setlist, &showlist);
+
+  /* APPLE LOCAL shared names  */
+  add_setshow_boolean_cmd ("share-shared-cache-names", class_obscure,
+			   &share_shared_cache_names, _("\
+Set if GDB should share symbol names between dyld shared cache libraries."), _("\
+Show if GDB should share symbol names between dyld shared cache libraries."), _("\
+When on, the symbol names of all the libraries read from the dyld shared\n\
+cache are stored once, in a table they share, instead of once per library.\n\
+This only affects libraries read after it is changed."),
+			   NULL, NULL,
+			   &setlist, &showlist);
+
+  /* APPLE LOCAL symfile cache */
+  add_setshow_optional_filename_cmd ("mach-o-symfile-cache-directory",
+				     class_obscure,
+				     &symfile_cache_directory, _("\
+Set the directory GDB reads cached minimal symbols of system libraries from."), _("\
+Show the directory GDB reads cached minimal symbols of system libraries from."), _("\
+When set, a library with no debug information whose UUID matches a file\n\
+written to this directory by \"sharedlibrary cache-symfiles\" gets its\n\
+minimal symbols from that file instead of from its symbol table.\n\
+An empty directory name disables the cache."),
+				     NULL, show_symfile_cache_directory,
+				     &maintenance_set_cmdlist,
+				     &maintenance_show_cmdlist);
 }
@@ -247,6 +247,7 @@ dyld_objfile_entry_clear (struct dyld_objfile_entry *e)
   e->loaded_error = 0;
 
   e->load_flag = -1;
+  e->deferred_load_flag = -1;
 
   e->reason = 0;
 
@@ -562,18 +563,12 @@ dyld_entry_filename (const struct dyld_objfile_entry *e,
     return name;
 
 
-  resolved = dyld_resolve_image (d, name);
+  /* APPLE LOCAL dyld path cache  */
+  resolved = dyld_resolve_image_realpath (d, name);
   if (resolved == NULL)
     return name;
 
-  char buf[PATH_MAX];
-  resolved = realpath (resolved, buf);
-  if (resolved == NULL)
-    return name;
-
-  name = xstrdup (resolved);
-
-  return name;
+  return resolved;
 }
 
 char *
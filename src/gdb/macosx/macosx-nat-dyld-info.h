@@ -119,6 +119,14 @@ struct dyld_objfile_entry
 
   int load_flag;
 
+  /* When "set sharedlibrary background-load" is on, only the minimal
+     symbols are read when the library is first seen; the load level
+     it would otherwise have gotten is kept here until the background
+     loader (or a lookup that needs it) raises it.  -1 if nothing is
+     pending.  */
+
+  int deferred_load_flag;
+
   enum dyld_objfile_reason reason;
 
   /* The array of dyld_objfile_entry's for the inferior process is a little
@@ -33,6 +33,12 @@
 
 #include <string.h>
 #include <sys/stat.h>
+/* APPLE LOCAL begin remote image cache  */
+#include <sys/time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+/* APPLE LOCAL end remote image cache  */
 
 #include <mach-o/nlist.h>
 #include <mach-o/loader.h>
@@ -44,6 +50,35 @@
 #include "macosx-nat-inferior.h"
 #include "macosx-nat-mutils.h"
 #include "macosx-nat-dyld-info.h"
+/* APPLE LOCAL host shared cache  */
+#include "macosx-tdep.h"
+
+/* Reading a Mach-O image out of the inferior through bfd turns into a
+   great many small reads: bfd walks the load commands a few bytes at
+   a time, and the symbol and string tables are pulled in piecemeal.
+   Over a slow link (an iOS device on USB, say) each of those is a
+   round trip.  So we keep a few blocks of inferior memory that we
+   fetch in one go and serve the small reads from: the mach header and
+   load commands when the bfd is opened, and the symbol and string
+   tables the first time bfd reaches into __LINKEDIT.
+
+   A block is dropped once as many bytes as it holds have been handed
+   out -- by then the reader has had what it came for, and we don't
+   want to hold a second copy of a big string table for the life of
+   the bfd.  Blocks bigger than INFERIOR_CACHE_MAX_BLOCK aren't
+   fetched at all (the shared cache's __LINKEDIT can be enormous);
+   those reads just go to the target as before.  */
+
+#define INFERIOR_CACHE_BLOCKS 3
+#define INFERIOR_CACHE_MAX_BLOCK (16 * 1024 * 1024)
+
+struct inferior_cache_block
+{
+  bfd_vma addr;
+  bfd_vma len;
+  bfd_vma served;
+  gdb_byte *data;
+};
 
 struct inferior_info
 {
@@ -51,18 +86,158 @@ struct inferior_info
   bfd_vma offset;
   bfd_vma len;
   void *read;
+
+  struct inferior_cache_block blocks[INFERIOR_CACHE_BLOCKS];
+  int linkedit_primed;
+
+  /* APPLE LOCAL begin remote image cache  */
+  /* Set once we've looked for this image in the remote image cache.
+     IMAGE_CACHE_FD is the cached copy, or -1.  */
+  int image_cache_checked;
+  int image_cache_fd;
+  /* APPLE LOCAL end remote image cache  */
 };
 
+static int valid_target_for_inferior_bfd ();
+
+/* APPLE LOCAL begin remote image cache  */
+/* Images read out of a remote target's memory are kept on the host,
+   in ~/Library/Caches/com.apple.gdb.images, one file per image named
+   by its UUID.  The first session that reads an image copies all of
+   its read-only segments over in large blocks; later sessions - and
+   later reads in this one - get them from the file.  Each file has the
+   same layout as the image, with its writable segments left as holes:
+   those hold pointers dyld has slid and data the program has changed,
+   so they are always read from the target.  The directory is kept
+   under REMOTE_IMAGE_CACHE_SIZE megabytes by deleting the files that
+   were least recently used.  */
+
+static int remote_image_cache_flag = 1;
+static int remote_image_cache_size = 1024;
+
+#define INFERIOR_IMAGE_CACHE_CHUNK (1024 * 1024)
+/* APPLE LOCAL end remote image cache  */
+
+/* Fetch LEN bytes of inferior memory at ADDR into a free cache block
+   of IPTR.  Quietly does nothing if there's no room, the block would
+   be too big, or the whole range can't be read.  */
+
+static void
+inferior_cache_fill (struct inferior_info *iptr, bfd_vma addr, bfd_vma len)
+{
+  struct inferior_cache_block *b = NULL;
+  int i;
+
+  if (len == 0 || len > INFERIOR_CACHE_MAX_BLOCK)
+    return;
+
+  for (i = 0; i < INFERIOR_CACHE_BLOCKS; i++)
+    if (iptr->blocks[i].data == NULL)
+      {
+        b = &iptr->blocks[i];
+        break;
+      }
+  if (b == NULL)
+    return;
+
+  b->data = xmalloc (len);
+  if (inferior_read_memory_partial (addr, len, b->data) != len)
+    {
+      xfree (b->data);
+      b->data = NULL;
+      return;
+    }
+  b->addr = addr;
+  b->len = len;
+  b->served = 0;
+}
+
+static void
+inferior_cache_free (struct inferior_info *iptr)
+{
+  int i;
+
+  for (i = 0; i < INFERIOR_CACHE_BLOCKS; i++)
+    if (iptr->blocks[i].data != NULL)
+      {
+        xfree (iptr->blocks[i].data);
+        iptr->blocks[i].data = NULL;
+      }
+}
+
+/* Read NBYTES at inferior address ADDR into DATA for IPTR, from a
+   cache block if one covers the whole range.  */
+
+static file_ptr
+inferior_read_cached (struct inferior_info *iptr, bfd_vma addr,
+                      file_ptr nbytes, void *data)
+{
+  int i;
+
+  for (i = 0; i < INFERIOR_CACHE_BLOCKS; i++)
+    {
+      struct inferior_cache_block *b = &iptr->blocks[i];
+      if (b->data == NULL)
+        continue;
+      if (addr >= b->addr && addr + nbytes <= b->addr + b->len)
+        {
+          memcpy (data, b->data + (addr - b->addr), nbytes);
+          b->served += nbytes;
+          if (b->served >= b->len)
+            {
+              xfree (b->data);
+              b->data = NULL;
+            }
+          return nbytes;
+        }
+    }
+
+  return inferior_read_memory_partial (addr, nbytes, data);
+}
+
 static void *
 inferior_open (bfd *abfd, void *open_closure)
 {
   struct inferior_info *in = NULL;
   struct inferior_info *ret = NULL;
+  gdb_byte header[32];
 
   in = (struct inferior_info *) open_closure;
   ret = bfd_zalloc (abfd, sizeof (struct inferior_info));
 
   *ret = *in;
+  memset (ret->blocks, 0, sizeof (ret->blocks));
+  ret->linkedit_primed = 0;
+  /* APPLE LOCAL begin remote image cache  */
+  ret->image_cache_checked = 0;
+  ret->image_cache_fd = -1;
+  /* APPLE LOCAL end remote image cache  */
+
+  /* bfd is about to read the mach header and then every load command
+     in turn, so fetch them all at once.  */
+  if (valid_target_for_inferior_bfd ()
+      && inferior_read_memory_partial (ret->addr, sizeof (header), header)
+         == sizeof (header))
+    {
+      unsigned long sizeofcmds = 0;
+      unsigned long hdrsize = 0;
+
+      if (bfd_getl32 (header) == MH_MAGIC || bfd_getb32 (header) == MH_MAGIC)
+        hdrsize = 28;
+      else if (bfd_getl32 (header) == MH_MAGIC_64
+               || bfd_getb32 (header) == MH_MAGIC_64)
+        hdrsize = 32;
+
+      if (hdrsize != 0)
+        {
+          if (bfd_getl32 (header) == MH_MAGIC
+              || bfd_getl32 (header) == MH_MAGIC_64)
+            sizeofcmds = bfd_getl32 (header + 20);
+          else
+            sizeofcmds = bfd_getb32 (header + 20);
+          inferior_cache_fill (ret, ret->addr, hdrsize + sizeofcmds);
+        }
+    }
 
   return ret;
 }
@@ -101,6 +276,13 @@ inferior_read_memory_partial (CORE_ADDR addr, int nbytes, gdb_byte *mbuf)
 
   volatile struct gdb_exception except;
 
+  /* APPLE LOCAL begin host shared cache  */
+  /* Read-only shared cache contents can come from a copy on the host
+     rather than over the wire.  */
+  if (nbytes > 0 && macosx_host_shared_cache_read (addr, mbuf, nbytes))
+    return nbytes;
+  /* APPLE LOCAL end host shared cache  */
+
   int old_trust_readonly = set_trust_readonly (0);
   TRY_CATCH (except, RETURN_MASK_ERROR)
     {
@@ -145,17 +327,21 @@ inferior_read_generic (bfd *abfd, void *stream, void *data, file_ptr nbytes, fil
       return 0;
     }
 
-  return inferior_read_memory_partial (iptr->addr + offset, nbytes, data);
+  return inferior_read_cached (iptr, iptr->addr + offset, nbytes, data);
 }
 
-static file_ptr
-inferior_read_mach_o (bfd *abfd, void *stream, void *data, file_ptr nbytes, file_ptr offset)
+/* Translate file offset OFFSET in the Mach-O image ABFD into an
+   address in the inferior, using the segment load commands.  Stores
+   the address in *ADDRP and the name of the segment holding it in
+   *SEGNAMEP and returns 1, or sets the bfd error and returns 0.  */
+
+static int
+inferior_mach_o_address (bfd *abfd, struct inferior_info *iptr,
+                         file_ptr offset, bfd_vma *addrp,
+                         const char **segnamep)
 {
-  struct inferior_info *iptr = (struct inferior_info *) stream;
   unsigned int i;
 
-  CHECK_FATAL (iptr != NULL);
-
   if (!valid_target_for_inferior_bfd ())
     {
       bfd_set_error (bfd_error_no_contents);
@@ -290,7 +476,9 @@ inferior_read_mach_o (bfd *abfd, void *stream, void *data, file_ptr nbytes, file
 		    infaddr = infaddr + iptr->offset + process_shared_cache_slide;
 		  }
 		
-		return inferior_read_memory_partial (infaddr, nbytes, data);
+		*addrp = infaddr;
+		*segnamep = segment->segname;
+		return 1;
               }
           }
       }
@@ -300,6 +488,308 @@ inferior_read_mach_o (bfd *abfd, void *stream, void *data, file_ptr nbytes, file
   return 0;
 }
 
+/* The first read that lands in __LINKEDIT means bfd has got round to
+   the symbols.  Fetch the whole symbol table and string table now,
+   since it's going to want all of both.  */
+
+static void
+inferior_prime_linkedit (bfd *abfd, struct inferior_info *iptr)
+{
+  struct mach_o_data_struct *mdata = abfd->tdata.mach_o_data;
+  unsigned int i;
+
+  iptr->linkedit_primed = 1;
+
+  for (i = 0; i < mdata->header.ncmds; i++)
+    {
+      struct bfd_mach_o_load_command *cmd = &mdata->commands[i];
+      struct bfd_mach_o_symtab_command *symtab;
+      unsigned long nlist_size;
+      const char *segname;
+      bfd_vma addr;
+
+      if (cmd->type == 0)
+        break;
+      if (cmd->type != BFD_MACH_O_LC_SYMTAB)
+        continue;
+
+      symtab = &cmd->command.symtab;
+      nlist_size = (mdata->header.version == 2) ? 16 : 12;
+
+      if (symtab->nsyms != 0
+          && inferior_mach_o_address (abfd, iptr, symtab->symoff, &addr,
+                                      &segname))
+        inferior_cache_fill (iptr, addr, symtab->nsyms * nlist_size);
+
+      if (symtab->strsize != 0
+          && inferior_mach_o_address (abfd, iptr, symtab->stroff, &addr,
+                                      &segname))
+        inferior_cache_fill (iptr, addr, symtab->strsize);
+      break;
+    }
+}
+
+/* APPLE LOCAL begin remote image cache  */
+/* Return the read-only, file-backed segment of ABFD holding the
+   NBYTES at file offset OFFSET, or NULL.  */
+
+static struct bfd_mach_o_segment_command *
+inferior_image_cache_segment (bfd *abfd, file_ptr offset, file_ptr nbytes)
+{
+  struct mach_o_data_struct *mdata = abfd->tdata.mach_o_data;
+  unsigned int i;
+
+  for (i = 0; i < mdata->header.ncmds; i++)
+    {
+      struct bfd_mach_o_load_command *cmd = &mdata->commands[i];
+      struct bfd_mach_o_segment_command *segment;
+
+      if (cmd->type == 0)
+        break;
+      if (cmd->type != BFD_MACH_O_LC_SEGMENT
+          && cmd->type != BFD_MACH_O_LC_SEGMENT_64)
+        continue;
+
+      segment = &cmd->command.segment;
+      if (offset >= segment->fileoff
+          && offset + nbytes <= segment->fileoff + segment->filesize)
+        return (segment->initprot & VM_PROT_WRITE) ? NULL : segment;
+    }
+  return NULL;
+}
+
+static char *
+remote_image_cache_directory (void)
+{
+  const char *home = getenv ("HOME");
+
+  if (home == NULL || *home == '\0')
+    return NULL;
+  return xstrprintf ("%s/Library/Caches/com.apple.gdb.images", home);
+}
+
+struct remote_image_cache_file
+{
+  char *path;
+  off_t size;
+  time_t used;
+};
+
+static int
+compare_remote_image_cache_files (const void *a, const void *b)
+{
+  const struct remote_image_cache_file *fa = a;
+  const struct remote_image_cache_file *fb = b;
+
+  if (fa->used < fb->used)
+    return -1;
+  if (fa->used > fb->used)
+    return 1;
+  return 0;
+}
+
+/* Delete the least recently used files in DIRNAME until what is left
+   fits in REMOTE_IMAGE_CACHE_SIZE megabytes.  */
+
+static void
+remote_image_cache_prune (const char *dirname)
+{
+  struct remote_image_cache_file *files = NULL;
+  int nfiles = 0;
+  int maxfiles = 0;
+  off_t total = 0;
+  off_t limit;
+  struct dirent *ent;
+  DIR *dir;
+  int i;
+
+  if (remote_image_cache_size <= 0)
+    return;
+  limit = (off_t) remote_image_cache_size * 1024 * 1024;
+
+  dir = opendir (dirname);
+  if (dir == NULL)
+    return;
+  while ((ent = readdir (dir)) != NULL)
+    {
+      struct stat st;
+      char *path;
+
+      if (ent->d_name[0] == '.')
+        continue;
+      path = xstrprintf ("%s/%s", dirname, ent->d_name);
+      if (stat (path, &st) != 0 || !S_ISREG (st.st_mode))
+        {
+          xfree (path);
+          continue;
+        }
+      if (nfiles == maxfiles)
+        {
+          maxfiles = maxfiles ? maxfiles * 2 : 64;
+          files = xrealloc (files, maxfiles * sizeof (*files));
+        }
+      files[nfiles].path = path;
+      files[nfiles].size = st.st_size;
+      files[nfiles].used = st.st_mtime;
+      total += st.st_size;
+      nfiles++;
+    }
+  closedir (dir);
+
+  qsort (files, nfiles, sizeof (*files), compare_remote_image_cache_files);
+  for (i = 0; i < nfiles; i++)
+    {
+      if (total > limit && unlink (files[i].path) == 0)
+        total -= files[i].size;
+      xfree (files[i].path);
+    }
+  xfree (files);
+}
+
+/* Copy the read-only segments of the image ABFD reads from IPTR into a
+   new cache file at PATH.  Return 1 if the whole copy succeeded.  */
+
+static int
+remote_image_cache_fill (bfd *abfd, struct inferior_info *iptr,
+                         const char *path)
+{
+  struct mach_o_data_struct *mdata = abfd->tdata.mach_o_data;
+  char *tmppath;
+  gdb_byte *buf;
+  unsigned int i;
+  int ok = 1;
+  int fd;
+
+  tmppath = xstrprintf ("%s.%d", path, (int) getpid ());
+  fd = open (tmppath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      xfree (tmppath);
+      return 0;
+    }
+
+  buf = xmalloc (INFERIOR_IMAGE_CACHE_CHUNK);
+  for (i = 0; ok && i < mdata->header.ncmds; i++)
+    {
+      struct bfd_mach_o_load_command *cmd = &mdata->commands[i];
+      struct bfd_mach_o_segment_command *segment;
+      bfd_vma done;
+
+      if (cmd->type == 0)
+        break;
+      if (cmd->type != BFD_MACH_O_LC_SEGMENT
+          && cmd->type != BFD_MACH_O_LC_SEGMENT_64)
+        continue;
+      segment = &cmd->command.segment;
+      if (segment->initprot & VM_PROT_WRITE)
+        continue;
+
+      for (done = 0; ok && done < segment->filesize; )
+        {
+          bfd_vma n = segment->filesize - done;
+          const char *segname;
+          bfd_vma addr;
+
+          if (n > INFERIOR_IMAGE_CACHE_CHUNK)
+            n = INFERIOR_IMAGE_CACHE_CHUNK;
+          if (!inferior_mach_o_address (abfd, iptr, segment->fileoff + done,
+                                        &addr, &segname)
+              || inferior_read_memory_partial (addr, n, buf) != n
+              || pwrite (fd, buf, n, segment->fileoff + done) != n)
+            ok = 0;
+          done += n;
+        }
+    }
+  xfree (buf);
+
+  if (close (fd) != 0)
+    ok = 0;
+  if (ok && rename (tmppath, path) != 0)
+    ok = 0;
+  if (!ok)
+    unlink (tmppath);
+  xfree (tmppath);
+  return ok;
+}
+
+/* Find the cached copy of the image ABFD reads from IPTR, making it if
+   this is the first time we've seen the image, and keep it open in
+   IPTR->IMAGE_CACHE_FD.  */
+
+static void
+remote_image_cache_attach (bfd *abfd, struct inferior_info *iptr)
+{
+  unsigned char uuid[16];
+  char *dirname;
+  char *path;
+  int i;
+
+  iptr->image_cache_checked = 1;
+
+  if (!remote_image_cache_flag || !target_is_remote ()
+      || bfd_mach_o_in_shared_cached_memory (abfd)
+      || !bfd_mach_o_get_uuid (abfd, uuid, sizeof (uuid)))
+    return;
+
+  dirname = remote_image_cache_directory ();
+  if (dirname == NULL)
+    return;
+
+  path = xmalloc (strlen (dirname) + 1 + 2 * sizeof (uuid) + 1);
+  sprintf (path, "%s/", dirname);
+  for (i = 0; i < sizeof (uuid); i++)
+    sprintf (path + strlen (path), "%02X", uuid[i]);
+
+  iptr->image_cache_fd = open (path, O_RDONLY);
+  if (iptr->image_cache_fd >= 0)
+    {
+      /* Its modification time is when we last used it.  */
+      utimes (path, NULL);
+    }
+  else
+    {
+      mkdir (dirname, 0755);
+      if (remote_image_cache_fill (abfd, iptr, path))
+        {
+          iptr->image_cache_fd = open (path, O_RDONLY);
+          remote_image_cache_prune (dirname);
+        }
+    }
+
+  xfree (path);
+  xfree (dirname);
+}
+/* APPLE LOCAL end remote image cache  */
+
+static file_ptr
+inferior_read_mach_o (bfd *abfd, void *stream, void *data, file_ptr nbytes, file_ptr offset)
+{
+  struct inferior_info *iptr = (struct inferior_info *) stream;
+  const char *segname;
+  bfd_vma infaddr;
+
+  CHECK_FATAL (iptr != NULL);
+
+  if (!inferior_mach_o_address (abfd, iptr, offset, &infaddr, &segname))
+    return 0;
+
+  /* APPLE LOCAL begin remote image cache  */
+  /* The load commands are all in by now, so we know the image's UUID
+     and segments.  */
+  if (!iptr->image_cache_checked)
+    remote_image_cache_attach (abfd, iptr);
+  if (iptr->image_cache_fd >= 0
+      && inferior_image_cache_segment (abfd, offset, nbytes) != NULL
+      && pread (iptr->image_cache_fd, data, nbytes, offset) == nbytes)
+    return nbytes;
+  /* APPLE LOCAL end remote image cache  */
+
+  if (!iptr->linkedit_primed && strncmp (segname, "__LINKEDIT", 16) == 0)
+    inferior_prime_linkedit (abfd, iptr);
+
+  return inferior_read_cached (iptr, infaddr, nbytes, data);
+}
+
 static file_ptr
 inferior_read (bfd *abfd, void *stream, void *data, file_ptr nbytes, file_ptr offset)
 {
@@ -319,6 +809,12 @@ inferior_read (bfd *abfd, void *stream, void *data, file_ptr nbytes, file_ptr of
 static int
 inferior_close (bfd *abfd, void *stream)
 {
+  struct inferior_info *iptr = (struct inferior_info *) stream;
+
+  inferior_cache_free (iptr);
+  /* APPLE LOCAL remote image cache  */
+  if (iptr->image_cache_fd >= 0)
+    close (iptr->image_cache_fd);
   return 0;
 }
 
@@ -410,3 +906,28 @@ macosx_bfd_is_in_memory (bfd *abfd)
     }
   return 0;
 }
+
+/* APPLE LOCAL begin remote image cache  */
+void
+_initialize_macosx_nat_dyld_io ()
+{
+  add_setshow_boolean_cmd ("remote-image-cache", class_obscure,
+			   &remote_image_cache_flag, _("\
+Set if GDB should keep copies of images it reads from a remote target's memory."), _("\
+Show if GDB should keep copies of images it reads from a remote target's memory."), _("\
+When on, the read-only segments of a shared library read out of a remote\n\
+target's memory are copied to ~/Library/Caches/com.apple.gdb.images, by\n\
+UUID, and later sessions read them from there."),
+			   NULL, NULL,
+			   &setshliblist, &showshliblist);
+
+  add_setshow_zinteger_cmd ("remote-image-cache-size", class_obscure,
+			    &remote_image_cache_size, _("\
+Set how many megabytes the remote image cache may use."), _("\
+Show how many megabytes the remote image cache may use."), _("\
+When the cache grows past this, the images least recently used are\n\
+deleted.  Zero means no limit."),
+			    NULL, NULL,
+			    &setshliblist, &showshliblist);
+}
+/* APPLE LOCAL end remote image cache  */
@@ -29,6 +29,8 @@
 #include "inferior.h"
 #include "environ.h"
 #include "gdbcore.h"
+/* APPLE LOCAL dyld path cache  */
+#include "hashtab.h"
 
 #include "macosx-nat-dyld-path.h"
 #include "macosx-nat-dyld-info.h"
@@ -437,8 +439,11 @@ dyld_library_basename (const char *path, const char **s, int *len,
   return;
 }
 
-char *
-dyld_resolve_image (const struct dyld_path_info *d, const char *dylib_name)
+/* APPLE LOCAL dyld path cache: Renamed from dyld_resolve_image.  */
+
+static char *
+dyld_resolve_image_uncached (const struct dyld_path_info *d,
+                             const char *dylib_name)
 {
   struct stat stat_buf;
 
@@ -608,6 +613,175 @@ dyld_resolve_image (const struct dyld_path_info *d, const char *dylib_name)
   return NULL;
 }
 
+/* APPLE LOCAL begin dyld path cache  */
+/* Resolving a library name can stat a dozen candidates, a slow business
+   on a network home directory, and every shared library update asks
+   again for every library.  The answers, including the names that
+   resolve to nothing, are kept here until the search settings they
+   were found with change.  Names that didn't resolve are also
+   forgotten whenever dyld_init_paths rereads the settings, which
+   happens on every run, so a library that has been built since shows
+   up.  */
+
+struct dyld_path_cache_entry
+{
+  char *name;
+
+  /* What dyld_resolve_image_uncached returned for NAME.  */
+  char *resolved;
+
+  /* The real path of RESOLVED, once REAL_VALID is set.  */
+  char *real;
+  int real_valid;
+};
+
+static htab_t dyld_path_cache = NULL;
+
+/* The search settings, and the executable's name, that the cached
+   answers were found with.  */
+
+static char *dyld_path_cache_settings = NULL;
+
+static hashval_t
+dyld_path_cache_hash (const void *p)
+{
+  const struct dyld_path_cache_entry *e = p;
+
+  return htab_hash_string (e->name);
+}
+
+static int
+dyld_path_cache_eq (const void *a, const void *b)
+{
+  const struct dyld_path_cache_entry *e = a;
+  const char *name = b;
+
+  return strcmp (e->name, name) == 0;
+}
+
+static void
+dyld_path_cache_del (void *p)
+{
+  struct dyld_path_cache_entry *e = p;
+
+  xfree (e->name);
+  xfree (e->resolved);
+  xfree (e->real);
+  xfree (e);
+}
+
+void
+dyld_path_cache_flush (void)
+{
+  if (dyld_path_cache != NULL)
+    htab_empty (dyld_path_cache);
+}
+
+static int
+dyld_path_cache_drop_unresolved (void **slot, void *unused)
+{
+  struct dyld_path_cache_entry *e = *slot;
+
+  if (e->resolved == NULL)
+    htab_clear_slot (dyld_path_cache, slot);
+  return 1;
+}
+
+static char *
+dyld_path_settings_string (const struct dyld_path_info *d)
+{
+  return xstrprintf ("%s\n%s\n%s\n%s\n%s\n%s",
+                     d->framework_path ? d->framework_path : "",
+                     d->library_path ? d->library_path : "",
+                     d->image_suffix ? d->image_suffix : "",
+                     d->fallback_framework_path
+                       ? d->fallback_framework_path : "",
+                     d->fallback_library_path
+                       ? d->fallback_library_path : "",
+                     exec_bfd != NULL && exec_bfd->filename != NULL
+                       ? exec_bfd->filename : "");
+}
+
+/* Find DYLIB_NAME's entry in the cache, resolving it with D if it
+   isn't there yet.  */
+
+static struct dyld_path_cache_entry *
+dyld_path_cache_lookup (const struct dyld_path_info *d,
+                        const char *dylib_name)
+{
+  struct dyld_path_cache_entry *e;
+  char *settings;
+  void **slot;
+
+  if (dyld_path_cache == NULL)
+    dyld_path_cache = htab_create_alloc (256, dyld_path_cache_hash,
+                                         dyld_path_cache_eq,
+                                         dyld_path_cache_del,
+                                         xcalloc, xfree);
+
+  settings = dyld_path_settings_string (d);
+  if (dyld_path_cache_settings == NULL
+      || strcmp (settings, dyld_path_cache_settings) != 0)
+    {
+      dyld_path_cache_flush ();
+      xfree (dyld_path_cache_settings);
+      dyld_path_cache_settings = settings;
+    }
+  else
+    xfree (settings);
+
+  slot = htab_find_slot_with_hash (dyld_path_cache, dylib_name,
+                                   htab_hash_string (dylib_name), INSERT);
+  if (*slot != NULL)
+    return *slot;
+
+  e = xcalloc (1, sizeof (struct dyld_path_cache_entry));
+  e->name = xstrdup (dylib_name);
+  e->resolved = dyld_resolve_image_uncached (d, dylib_name);
+  *slot = e;
+  return e;
+}
+
+/* Return the file DYLIB_NAME would be loaded from given the dyld search
+   settings in D, or NULL if there is none.  The result is xmalloc'ed.  */
+
+char *
+dyld_resolve_image (const struct dyld_path_info *d, const char *dylib_name)
+{
+  struct dyld_path_cache_entry *e;
+
+  if (dylib_name == NULL)
+    return NULL;
+
+  e = dyld_path_cache_lookup (d, dylib_name);
+  return e->resolved != NULL ? xstrdup (e->resolved) : NULL;
+}
+
+/* Like dyld_resolve_image, but return the real path of the file, with
+   symbolic links resolved.  */
+
+char *
+dyld_resolve_image_realpath (const struct dyld_path_info *d,
+                             const char *dylib_name)
+{
+  struct dyld_path_cache_entry *e;
+
+  if (dylib_name == NULL)
+    return NULL;
+
+  e = dyld_path_cache_lookup (d, dylib_name);
+  if (!e->real_valid && e->resolved != NULL)
+    {
+      char buf[PATH_MAX];
+
+      if (realpath (e->resolved, buf) != NULL)
+        e->real = xstrdup (buf);
+      e->real_valid = 1;
+    }
+  return e->real != NULL ? xstrdup (e->real) : NULL;
+}
+/* APPLE LOCAL end dyld path cache  */
+
 /* This function ensures that we have all zero's in our path_info structure D
    so that dyld_init_paths() doesn't try to xfree() a pointer that is random
    garbage sitting in memory. */
@@ -706,4 +880,11 @@ dyld_init_paths (dyld_path_info * d)
     }
 
   xfree (home);
+
+  /* APPLE LOCAL begin dyld path cache  */
+  /* A library that didn't resolve may have been built since.  */
+  if (dyld_path_cache != NULL)
+    htab_traverse_noresize (dyld_path_cache, dyld_path_cache_drop_unresolved,
+                            NULL);
+  /* APPLE LOCAL end dyld path cache  */
 }
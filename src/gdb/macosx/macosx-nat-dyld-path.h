@@ -20,6 +20,13 @@ void dyld_library_basename (const char *path, const char **s, int *len,
 char *dyld_resolve_image (const struct dyld_path_info *d, 
                           const char *dylib_name);
 
+/* APPLE LOCAL begin dyld path cache  */
+char *dyld_resolve_image_realpath (const struct dyld_path_info *d,
+                                   const char *dylib_name);
+
+void dyld_path_cache_flush (void);
+/* APPLE LOCAL end dyld path cache  */
+
 void dyld_zero_path_info (dyld_path_info *d);
 
 void dyld_init_paths (dyld_path_info * d);
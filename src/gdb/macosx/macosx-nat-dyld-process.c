@@ -37,6 +37,7 @@
 #include "arch-utils.h"
 #include "gdbarch.h"
 #include "symfile.h"
+#include "hashtab.h"
 
 #include "gdb_stat.h"
 
@@ -77,11 +78,15 @@ extern int dyld_load_dyld_shlib_symbols_flag;
 extern int dyld_load_cfm_shlib_symbols_flag;
 extern int dyld_print_basenames_flag;
 extern int dyld_reload_on_downgrade_flag;
+extern int dyld_background_load_flag;
 extern char *dyld_load_rules;
 extern char *dyld_minimal_load_rules;
 
 static int dyld_check_uuids_flag = 0;
 
+/* APPLE LOCAL reuse objfiles by uuid  */
+static int dyld_reuse_by_uuid_flag = 1;
+
 /* For the gdbarch_tdep structure so we can get the wordsize. */
 #if defined(TARGET_POWERPC)
 #include "ppc-tdep.h"
@@ -545,144 +550,293 @@ dyld_parse_load_level (const char *s)
     }
 }
 
-int
-dyld_resolve_load_flag (const struct dyld_path_info *d,
-                        struct dyld_objfile_entry *e, const char *rules)
+/* APPLE LOCAL begin compiled load rules  */
+/* A "set sharedlibrary load-rules" string, parsed and with its regular
+   expressions compiled, plus the level it resolved to for each
+   (reason, filename) pair asked about so far.  The same two rule
+   strings are consulted for every library at every dyld update, so
+   keeping a few of these around saves re-parsing and recompiling the
+   rules, and running them at all for libraries already seen.  */
+
+struct dyld_load_rule
 {
-  const char *name = NULL;
-  const char *leaf = NULL;
+  regex_t reason;
+  regex_t name;
+  int valid;
+  int level;
+};
 
-  char **prules = NULL;
-  char **trule = NULL;
-  int nrules = 0;
-  int crule = 0;
+struct dyld_load_decision
+{
+  const char *reason;
+  char *name;
+  int level;
+};
 
-  name = dyld_entry_string (e, 1);
+struct dyld_compiled_load_rules
+{
+  char *text;
+  int nrules;
+  struct dyld_load_rule *rules;
 
-  if (name == NULL)
-    return OBJF_SYM_NONE;
+  /* Nonzero if TEXT could not be parsed; every library gets "none".  */
+  int parse_error;
 
-  leaf = strrchr (name, '/');
-  leaf = ((leaf != NULL) ? leaf : name);
+  /* struct dyld_load_decision, by reason and name.  */
+  htab_t decisions;
+};
 
-  if (rules != NULL)
-    {
-      prules = buildargv (rules);
-      if (prules == NULL)
-        {
-          warning ("unable to parse load rules");
-          return OBJF_SYM_NONE;
-        }
-    }
+#define DYLD_COMPILED_LOAD_RULES_CACHE_SIZE 4
+
+static struct dyld_compiled_load_rules
+  *dyld_compiled_load_rules_cache[DYLD_COMPILED_LOAD_RULES_CACHE_SIZE];
+static int dyld_compiled_load_rules_next;
+
+static hashval_t
+dyld_load_decision_hash (const void *p)
+{
+  const struct dyld_load_decision *dec = p;
+  return htab_hash_string (dec->name) ^ htab_hash_pointer (dec->reason);
+}
 
-  nrules = 0;
+static int
+dyld_load_decision_eq (const void *a, const void *b)
+{
+  const struct dyld_load_decision *x = a;
+  const struct dyld_load_decision *y = b;
+  return x->reason == y->reason && strcmp (x->name, y->name) == 0;
+}
 
-  if (prules != NULL)
+static void
+dyld_load_decision_del (void *p)
+{
+  struct dyld_load_decision *dec = p;
+  xfree (dec->name);
+  xfree (dec);
+}
+
+static void
+dyld_free_compiled_load_rules (struct dyld_compiled_load_rules *c)
+{
+  int i;
+
+  if (c == NULL)
+    return;
+  for (i = 0; i < c->nrules; i++)
+    if (c->rules[i].valid)
+      {
+        regfree (&c->rules[i].reason);
+        regfree (&c->rules[i].name);
+      }
+  xfree (c->rules);
+  htab_delete (c->decisions);
+  xfree (c->text);
+  xfree (c);
+}
+
+/* Parse and compile RULES.  The warnings are the ones resolving a
+   library against RULES used to give, but now only once per rule
+   string.  */
+
+static struct dyld_compiled_load_rules *
+dyld_compile_load_rules (const char *rules)
+{
+  struct dyld_compiled_load_rules *c;
+  char **prules;
+  int nargs = 0;
+  int i;
+
+  c = xcalloc (1, sizeof (struct dyld_compiled_load_rules));
+  c->text = xstrdup (rules);
+  c->decisions = htab_create_alloc (64, dyld_load_decision_hash,
+                                    dyld_load_decision_eq,
+                                    dyld_load_decision_del,
+                                    xcalloc, xfree);
+
+  prules = buildargv (rules);
+  if (prules == NULL)
     {
-      for (trule = prules; *trule != NULL; trule++)
-        {
-          nrules++;
-        }
+      warning ("unable to parse load rules");
+      c->parse_error = 1;
+      return c;
     }
 
-  if ((nrules % 3) != 0)
+  while (prules[nargs] != NULL)
+    nargs++;
+
+  if ((nargs % 3) != 0)
     {
       warning
         ("unable to parse load-rules (number of rule clauses must be a "
          "multiple of 3)");
-      return OBJF_SYM_NONE;
+      c->parse_error = 1;
+      freeargv (prules);
+      return c;
     }
-  nrules /= 3;
 
-  for (crule = 0; crule < nrules; crule++)
+  c->nrules = nargs / 3;
+  c->rules = xcalloc (c->nrules + 1, sizeof (struct dyld_load_rule));
+  for (i = 0; i < c->nrules; i++)
     {
+      struct dyld_load_rule *r = &c->rules[i];
+      char *matchreason = prules[i * 3];
+      char *matchname = prules[(i * 3) + 1];
+      char *setting = prules[(i * 3) + 2];
 
-      char *matchreason = prules[crule * 3];
-      char *matchname = prules[(crule * 3) + 1];
-      char *setting = prules[(crule * 3) + 2];
+      if (regcomp (&r->reason, matchreason, REG_NOSUB) != 0)
+        {
+          warning ("unable to compile regular expression \"%s\"",
+                   matchreason);
+          continue;
+        }
+      if (regcomp (&r->name, matchname, REG_NOSUB) != 0)
+        {
+          warning ("unable to compile regular expression \"%s\"",
+                   matchname);
+          regfree (&r->reason);
+          continue;
+        }
+      r->level = dyld_parse_load_level (setting);
+      r->valid = 1;
+    }
 
-      const char *reason = NULL;
-      const char *name = NULL;
+  freeargv (prules);
+  return c;
+}
 
-      regex_t reasonbuf;
-      regex_t namebuf;
+/* Return the compiled form of RULES, compiling it if it isn't one of
+   the rule strings we have seen recently.  */
 
-      int ret;
+static struct dyld_compiled_load_rules *
+dyld_get_compiled_load_rules (const char *rules)
+{
+  struct dyld_compiled_load_rules *c;
+  int i;
 
-      switch (e->reason & dyld_reason_type_mask)
-        {
-        case dyld_reason_user:
-          reason = "user";
-          break;
-        case dyld_reason_init:
-          reason = "dyld";
-          break;
-        case dyld_reason_executable:
-          reason = "exec";
-          break;
-        case dyld_reason_dyld:
-          reason = "dyld";
-          break;
-        case dyld_reason_cfm:
-          reason = "cfm";
-          break;
-        default:
-          reason = "INVALID";
-          break;
-        }
+  for (i = 0; i < DYLD_COMPILED_LOAD_RULES_CACHE_SIZE; i++)
+    {
+      c = dyld_compiled_load_rules_cache[i];
+      if (c != NULL && strcmp (c->text, rules) == 0)
+        return c;
+    }
+
+  i = dyld_compiled_load_rules_next;
+  dyld_compiled_load_rules_next
+    = (i + 1) % DYLD_COMPILED_LOAD_RULES_CACHE_SIZE;
+  dyld_free_compiled_load_rules (dyld_compiled_load_rules_cache[i]);
+  c = dyld_compile_load_rules (rules);
+  dyld_compiled_load_rules_cache[i] = c;
+  return c;
+}
+/* APPLE LOCAL end compiled load rules  */
+
+int
+dyld_resolve_load_flag (const struct dyld_path_info *d,
+                        struct dyld_objfile_entry *e, const char *rules)
+{
+  const char *name = NULL;
+  const char *reason = NULL;
+  /* APPLE LOCAL compiled load rules  */
+  struct dyld_compiled_load_rules *compiled;
+  struct dyld_load_decision key, *dec;
+  void **slot;
+  int crule;
+  int level = -1;
 
-      if (e->objfile)
+  name = dyld_entry_string (e, 1);
+
+  if (name == NULL)
+    return OBJF_SYM_NONE;
+
+  if (rules == NULL)
+    return -1;
+
+  /* APPLE LOCAL begin compiled load rules  */
+  compiled = dyld_get_compiled_load_rules (rules);
+  if (compiled->parse_error)
+    return OBJF_SYM_NONE;
+  if (compiled->nrules == 0)
+    return -1;
+  /* APPLE LOCAL end compiled load rules  */
+
+  switch (e->reason & dyld_reason_type_mask)
+    {
+    case dyld_reason_user:
+      reason = "user";
+      break;
+    case dyld_reason_init:
+      reason = "dyld";
+      break;
+    case dyld_reason_executable:
+      reason = "exec";
+      break;
+    case dyld_reason_dyld:
+      reason = "dyld";
+      break;
+    case dyld_reason_cfm:
+      reason = "cfm";
+      break;
+    default:
+      reason = "INVALID";
+      break;
+    }
+
+  if (e->objfile)
+    {
+      if (e->loaded_from_memory)
         {
-          if (e->loaded_from_memory)
-            {
-              name = "memory";
-            }
-          else
-            {
-              name = e->loaded_name;
-            }
+          name = "memory";
         }
       else
         {
-          name = dyld_entry_filename (e, d, DYLD_ENTRY_FILENAME_LOADED);
-          if (name == NULL)
+          name = e->loaded_name;
+        }
+    }
+  else
+    {
+      name = dyld_entry_filename (e, d, DYLD_ENTRY_FILENAME_LOADED);
+      if (name == NULL)
+        {
+          if (!(e->reason & dyld_reason_weak_mask))
             {
-              if (!(e->reason & dyld_reason_weak_mask))
-                {
-                  warning ("Unable to resolve \"%s\"; not loading.", name);
-                }
-              return OBJF_SYM_NONE;
+              warning ("Unable to resolve \"%s\"; not loading.", name);
             }
+          return OBJF_SYM_NONE;
         }
+    }
 
-      ret = regcomp (&reasonbuf, matchreason, REG_NOSUB);
-      if (ret != 0)
-        {
-          warning ("unable to compile regular expression \"%s\"",
-                   matchreason);
-          continue;
-        }
+  /* APPLE LOCAL begin compiled load rules  */
+  if (name == NULL)
+    return -1;
 
-      ret = regcomp (&namebuf, matchname, REG_NOSUB);
-      if (ret != 0)
-        {
-          warning ("unable to compile regular expression \"%s\"",
-                   matchreason);
-          continue;
-        }
+  key.reason = reason;
+  key.name = (char *) name;
+  slot = htab_find_slot (compiled->decisions, &key, INSERT);
+  if (*slot != NULL)
+    return ((struct dyld_load_decision *) *slot)->level;
 
-      ret = regexec (&reasonbuf, reason, 0, 0, 0);
-      if (ret != 0)
-        continue;
+  for (crule = 0; crule < compiled->nrules; crule++)
+    {
+      struct dyld_load_rule *r = &compiled->rules[crule];
 
-      ret = regexec (&namebuf, name, 0, 0, 0);
-      if (ret != 0)
+      if (!r->valid)
         continue;
-
-      return dyld_parse_load_level (setting);
+      if (regexec (&r->reason, reason, 0, 0, 0) != 0)
+        continue;
+      if (regexec (&r->name, name, 0, 0, 0) != 0)
+        continue;
+      level = r->level;
+      break;
     }
 
-  return -1;
+  dec = xmalloc (sizeof (struct dyld_load_decision));
+  dec->reason = reason;
+  dec->name = xstrdup (name);
+  dec->level = level;
+  *slot = dec;
+  /* APPLE LOCAL end compiled load rules  */
+
+  return level;
 }
 
 int
@@ -715,6 +869,35 @@ dyld_default_load_flag (const struct dyld_path_info *d,
   return OBJF_SYM_NONE;
 }
 
+/* Work out the load level E gets when it is first seen.  Normally
+   that is just the default level combined with the minimal rules.
+   With background loading on, a library that would get more than its
+   minimal symbols is only read to that level now, and the rest is
+   left in E->DEFERRED_LOAD_FLAG for dyld_schedule_background_load to
+   pick up once the prompt comes back.  The main executable is always
+   read in full, since that is where the user is most likely to look
+   first.  */
+
+static int
+dyld_initial_load_flag (const struct dyld_path_info *d,
+                        struct dyld_objfile_entry *e)
+{
+  int minimal = dyld_minimal_load_flag (d, e);
+  int full = dyld_default_load_flag (d, e) | minimal;
+  int now;
+
+  if (!dyld_background_load_flag
+      || (e->reason & dyld_reason_executable_mask))
+    return full;
+
+  now = (full & OBJF_SYM_FLAGS_MASK) | OBJF_SYM_EXTERN | minimal;
+  if ((full & OBJF_SYM_LEVELS_MASK) <= (now & OBJF_SYM_LEVELS_MASK))
+    return full;
+
+  e->deferred_load_flag = full;
+  return now;
+}
+
 #define IS_ALIGNED_TO_4096_P(num) (((num) & ~(4096 - 1)) == (num))
 #define ALIGN_TO_4096(num) (IS_ALIGNED_TO_4096_P((num)) ? \
                               (num) : \
@@ -898,8 +1081,10 @@ create_pre_run_memory_map (struct bfd *abfd)
       map->bucket_size &= ~(4096 - 1);
     }
 
-  map->buckets = (int *) xmalloc (sizeof (int) * map->number_of_buckets);
-  memset (map->buckets, 0, map->number_of_buckets * sizeof (int));
+  /* APPLE LOCAL pre-run memory map ranges  */
+  map->used = NULL;
+  map->num_used = 0;
+  map->num_used_allocated = 0;
 
   /* Figure out which bucket this executable will start loading at; 
      mark its memory areas as used.  */
@@ -910,6 +1095,29 @@ create_pre_run_memory_map (struct bfd *abfd)
   return map;
 }
 
+/* APPLE LOCAL begin pre-run memory map ranges  */
+/* Return the index of the first used run in MAP that ends after
+   BUCKET, or MAP->num_used if there is none.  */
+
+static int
+first_used_range_after (struct pre_run_memory_map *map, int bucket)
+{
+  int lo = 0;
+  int hi = map->num_used;
+
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      if (map->used[mid].end > bucket)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+  return lo;
+}
+/* APPLE LOCAL end pre-run memory map ranges  */
+
 /* Search the address map for the first range of free buckets that will fit
    a given request.  
    STARTING_BUCKET specifies where to start our search; this helps to reduce
@@ -924,44 +1132,23 @@ find_next_hole (struct pre_run_memory_map *map,
                 int starting_bucket, 
                 int buckets)
 {
-  int i;
-  i = starting_bucket;
+  /* APPLE LOCAL begin pre-run memory map ranges  */
+  int i = starting_bucket;
+  int needed = buckets > 0 ? buckets : 1;
+  int r = first_used_range_after (map, i);
 
-  while (i < map->number_of_buckets)
+  /* Step from the end of one used run to the next until the gap
+     before the next one is big enough.  */
+  while (i + buckets < map->number_of_buckets)
     {
-      int j;
-      if (i + buckets >= map->number_of_buckets)
-        return -1;
-
-      /* Skip over used buckets.  */
-      if (map->buckets[i] == 1)
-        {
-          i++;
-          continue;
-        }
-
-      /* Found one open bucket; see if we have enough sequential buckets for
-         this memory group.  */
-      j = i;
-      while (j - i < buckets)
-        {
-          if (map->buckets[j] == 0)
-            j++;
-          else
-            break;
-        }
-
-      /* Found an empty region big enough.  */
-      if (j - i == buckets)
-        {
-          return i;
-        }
-
-      /* Skip past the end of this region we were just examining.  */
-      i = j + 1;
+      if (r == map->num_used || map->used[r].start >= i + needed)
+        return i;
+      i = map->used[r].end;
+      r++;
     }
 
   return -1;
+  /* APPLE LOCAL end pre-run memory map ranges  */
 }
 
 /* Determine if the address map at STARTING_BUCKET has BUCKETS unused
@@ -973,23 +1160,70 @@ hole_at_p (struct pre_run_memory_map *map,
            int starting_bucket,
            int buckets)
 {
-  int i = starting_bucket;
+  /* APPLE LOCAL begin pre-run memory map ranges  */
+  int r;
 
-  if (starting_bucket >= map->number_of_buckets)
+  if (starting_bucket >= map->number_of_buckets
+      || starting_bucket + buckets > map->number_of_buckets)
     return 0;
+  if (buckets <= 0)
+    return 1;
+
+  r = first_used_range_after (map, starting_bucket);
+  return r == map->num_used
+         || map->used[r].start >= starting_bucket + buckets;
+  /* APPLE LOCAL end pre-run memory map ranges  */
+}
+
+/* APPLE LOCAL begin pre-run memory map ranges  */
+/* Mark buckets [START, END) of MAP as used, merging the run with any
+   it overlaps or touches.  */
 
-  while (i - starting_bucket < buckets 
-         && i < map->number_of_buckets
-         && map->buckets[i] == 0)
+static void
+mark_range_as_used (struct pre_run_memory_map *map, int start, int end)
+{
+  int lo, hi;
+
+  if (start < 0)
+    start = 0;
+  if (end > map->number_of_buckets)
+    end = map->number_of_buckets;
+  if (start >= end)
+    return;
+
+  lo = first_used_range_after (map, start - 1);
+  for (hi = lo; hi < map->num_used && map->used[hi].start <= end; hi++)
     {
-      i++;
+      if (map->used[hi].start < start)
+        start = map->used[hi].start;
+      if (map->used[hi].end > end)
+        end = map->used[hi].end;
     }
 
-  if (i - starting_bucket == buckets)
-    return 1;
-  else 
-    return 0;
+  if (hi == lo)
+    {
+      if (map->num_used == map->num_used_allocated)
+        {
+          map->num_used_allocated = map->num_used_allocated == 0
+                                    ? 16 : map->num_used_allocated * 2;
+          map->used = (struct pre_run_memory_range *)
+            xrealloc (map->used, map->num_used_allocated
+                                 * sizeof (struct pre_run_memory_range));
+        }
+      memmove (&map->used[lo + 1], &map->used[lo],
+               (map->num_used - lo) * sizeof (struct pre_run_memory_range));
+      map->num_used++;
+    }
+  else if (hi - lo > 1)
+    {
+      memmove (&map->used[lo + 1], &map->used[hi],
+               (map->num_used - hi) * sizeof (struct pre_run_memory_range));
+      map->num_used -= hi - lo - 1;
+    }
+  map->used[lo].start = start;
+  map->used[lo].end = end;
 }
+/* APPLE LOCAL end pre-run memory map ranges  */
 
 /* Given a list of memory buckets required for this bfd in FP, and a
    starting bucket number in MAP, mark the appropriate buckets in 
@@ -999,7 +1233,7 @@ static void
 mark_buckets_as_used (struct pre_run_memory_map *map, int startingbucket, 
                       struct bfd_memory_footprint *fp)
 {
-  int memgrp, k;
+  int memgrp;
   for (memgrp = 0; memgrp < fp->num; memgrp++)
     {
       struct bfd_memory_footprint_group *group = &fp->groups[memgrp];
@@ -1008,17 +1242,17 @@ mark_buckets_as_used (struct pre_run_memory_map *map, int startingbucket,
       if (initial_bkt + group->length > map->number_of_buckets)
         warning ("sharedlibrary preload-libraries exceeded map array while "
                  "processing '%s'", fp->filename);
-      for (k = 0; k < group->length; k++)
-        if (initial_bkt + k < map->number_of_buckets)
-          map->buckets[initial_bkt + k] = 1;
+      /* APPLE LOCAL pre-run memory map ranges  */
+      mark_range_as_used (map, initial_bkt, initial_bkt + group->length);
     }
 }
 
 void
 free_pre_run_memory_map (struct pre_run_memory_map *map)
 {
+  /* APPLE LOCAL pre-run memory map ranges  */
   if (map)
-    xfree (map->buckets);
+    xfree (map->used);
   xfree (map);
 }
 
@@ -1054,7 +1288,10 @@ slide_bfd_in_pre_run_memory_map (struct bfd *abfd,
   intended_loadaddr_bucket = fp->seg1addr / map->bucket_size;
   can_load_at_preferred_addr = 1;
   for (k = 0; k < fp->num; k++)
-    if (!hole_at_p (map, intended_loadaddr_bucket, fp->groups[k].length))
+    /* APPLE LOCAL pre-run memory map ranges: Check each group where it
+       would go, not all of them at the first one.  */
+    if (!hole_at_p (map, intended_loadaddr_bucket + fp->groups[k].offset,
+                    fp->groups[k].length))
       {
         can_load_at_preferred_addr = 0;
         break;
@@ -1500,8 +1737,7 @@ dyld_load_libraries (const struct dyld_path_info *d,
     {
       if (e->load_flag < 0)
         {
-          e->load_flag =
-            dyld_default_load_flag (d, e) | dyld_minimal_load_flag (d, e);
+          e->load_flag = dyld_initial_load_flag (d, e);
         }
       if (e->load_flag)
         {
@@ -2102,8 +2338,7 @@ dyld_remove_objfiles (const struct dyld_path_info *d,
 
       if (e->load_flag < 0)
         {
-          e->load_flag =
-            dyld_default_load_flag (d, e) | dyld_minimal_load_flag (d, e);
+          e->load_flag = dyld_initial_load_flag (d, e);
         }
 
       if (e->reason & dyld_reason_executable_mask)
@@ -2414,23 +2649,353 @@ dyld_check_discarded (struct dyld_objfile_info *info)
     }
 }
 
+/* An index of the entries in a dyld_objfile_info by load address.
+
+   Each dyld notification tells us about a handful of images, and for
+   each of those we used to walk every entry we know about looking
+   for a match, calling dyld_libraries_compatible or
+   dyld_libraries_similar on each -- and those resolve filenames and
+   allocate basenames as they go.  With a few hundred libraries and
+   an app that dlopens plugins in a loop, that adds up.
+
+   All of the matching predicates end up in dyld_libraries_similar,
+   which can only succeed when the two entries have the same
+   library_offset, or when one of them has no address at all (then it
+   falls back to comparing names).  So for an entry with an address,
+   the only entries worth looking at are the ones at that address plus
+   the few that have none.  The index keeps those two lists; a cursor
+   then hands them back in the same order the linear walk would have,
+   so the first match is the same as before.
+
+   The index stores entry numbers rather than pointers, since
+   dyld_objfile_entry_alloc may move the array.  Entries cleared after
+   the index was built are skipped by the cursor.  */
+
+struct dyld_image_index_bucket
+{
+  CORE_ADDR addr;
+  int nents;
+  int maxents;
+  int *ents;
+};
+
+struct dyld_image_index
+{
+  htab_t by_addr;
+
+  /* Entries with no load address.  */
+  int nunslid;
+  int maxunslid;
+  int *unslid;
+};
+
+static hashval_t
+dyld_image_index_hash (const void *p)
+{
+  const struct dyld_image_index_bucket *b = p;
+  return (hashval_t) (b->addr ^ (b->addr >> 32));
+}
+
+static int
+dyld_image_index_eq (const void *a, const void *b)
+{
+  return ((const struct dyld_image_index_bucket *) a)->addr
+    == ((const struct dyld_image_index_bucket *) b)->addr;
+}
+
+static void
+dyld_image_index_del (void *p)
+{
+  struct dyld_image_index_bucket *b = p;
+  xfree (b->ents);
+  xfree (b);
+}
+
+static void
+dyld_image_index_push (int **ents, int *nents, int *maxents, int n)
+{
+  if (*nents == *maxents)
+    {
+      *maxents = (*maxents > 0) ? (*maxents * 2) : 4;
+      *ents = xrealloc (*ents, *maxents * sizeof (int));
+    }
+  (*ents)[(*nents)++] = n;
+}
+
+/* Add entry number N of INFO to INDEX.  Entries must be added in
+   increasing order of N.  */
+
+void
+dyld_image_index_add (struct dyld_image_index *index,
+                      struct dyld_objfile_info *info, int n)
+{
+  struct dyld_image_index_bucket key, *b;
+  void **slot;
+
+  key.addr = library_offset (&info->entries[n]);
+  if (key.addr == 0)
+    {
+      dyld_image_index_push (&index->unslid, &index->nunslid,
+                             &index->maxunslid, n);
+      return;
+    }
+
+  slot = htab_find_slot (index->by_addr, &key, INSERT);
+  if (*slot == NULL)
+    {
+      b = xmalloc (sizeof (struct dyld_image_index_bucket));
+      b->addr = key.addr;
+      b->nents = 0;
+      b->maxents = 0;
+      b->ents = NULL;
+      *slot = b;
+    }
+  b = *slot;
+  dyld_image_index_push (&b->ents, &b->nents, &b->maxents, n);
+}
+
+struct dyld_image_index *
+dyld_image_index_build (struct dyld_objfile_info *info)
+{
+  struct dyld_image_index *index;
+  struct dyld_objfile_entry *e;
+  int i;
+
+  index = xmalloc (sizeof (struct dyld_image_index));
+  index->by_addr = htab_create_alloc (info->nents + 1, dyld_image_index_hash,
+                                      dyld_image_index_eq,
+                                      dyld_image_index_del, xcalloc, xfree);
+  index->nunslid = 0;
+  index->maxunslid = 0;
+  index->unslid = NULL;
+
+  DYLD_ALL_OBJFILE_INFO_ENTRIES (info, e, i)
+    dyld_image_index_add (index, info, i);
+
+  return index;
+}
+
+void
+dyld_image_index_free (struct dyld_image_index *index)
+{
+  if (index == NULL)
+    return;
+  htab_delete (index->by_addr);
+  xfree (index->unslid);
+  xfree (index);
+}
+
+static void
+dyld_image_index_free_cleanup (void *index)
+{
+  dyld_image_index_free (index);
+}
+
+struct cleanup *
+make_cleanup_dyld_image_index_free (struct dyld_image_index *index)
+{
+  return make_cleanup (dyld_image_index_free_cleanup, index);
+}
+
+/* Start walking the entries of INFO that might match E.  With a NULL
+   INDEX, or for an entry we can't look up by address, that is all of
+   them.  Executables are matched against each other by
+   dyld_prune_shlib whatever their address, so those get the full walk
+   too.  */
+
+void
+dyld_image_cursor_init (struct dyld_image_cursor *c,
+                        struct dyld_image_index *index,
+                        struct dyld_objfile_info *info,
+                        struct dyld_objfile_entry *e)
+{
+  struct dyld_image_index_bucket key, *b;
+
+  c->info = info;
+  c->linear = 1;
+  c->pos = 0;
+  c->naddr = c->nunslid = 0;
+  c->iaddr = c->iunslid = 0;
+  c->addr = c->unslid = NULL;
+
+  if (index == NULL || (e->reason & dyld_reason_executable_mask))
+    return;
+
+  key.addr = library_offset (e);
+  if (key.addr == 0)
+    return;
+
+  c->linear = 0;
+  b = htab_find (index->by_addr, &key);
+  if (b != NULL)
+    {
+      c->addr = b->ents;
+      c->naddr = b->nents;
+    }
+  c->unslid = index->unslid;
+  c->nunslid = index->nunslid;
+}
+
+/* Return the next candidate entry from C, storing its number in *N,
+   or NULL when there are no more.  */
+
+struct dyld_objfile_entry *
+dyld_image_cursor_next (struct dyld_image_cursor *c, int *n)
+{
+  if (c->linear)
+    {
+      c->pos = dyld_next_allocated_shlib (c->info, c->pos);
+      if (c->pos >= c->info->nents)
+        return NULL;
+      *n = c->pos++;
+      return &c->info->entries[*n];
+    }
+
+  for (;;)
+    {
+      int next;
+
+      if (c->iaddr < c->naddr
+          && (c->iunslid >= c->nunslid
+              || c->addr[c->iaddr] < c->unslid[c->iunslid]))
+        next = c->addr[c->iaddr++];
+      else if (c->iunslid < c->nunslid)
+        next = c->unslid[c->iunslid++];
+      else
+        return NULL;
+
+      if (next < c->info->nents && c->info->entries[next].allocated)
+        {
+          *n = next;
+          return &c->info->entries[next];
+        }
+    }
+}
+
 /* We're adding NEWENT to the list of dylib/bundle/etcs loaded in the
    inferior in a little while.  Look through the existing entries
    in OLDINFOS and see if we had one for this dylib/bundle/etc
    already.  If so, copy over the load data into NEWENT and clear
    them from the old entry in OLDINFOS.  (I think the old entry is
-   marked as obsolete over in the purge_shlib function or something.)  */
+   marked as obsolete over in the purge_shlib function or something.)
+
+   INDEX is as for dyld_prune_shlib.  */
+
+/* APPLE LOCAL begin reuse objfiles by uuid  */
+/* Read the LC_UUID of the Mach-O image whose header is at ADDR in the
+   inferior into UUID.  Return 1 if there was one.  */
+
+static int
+dyld_read_image_uuid (CORE_ADDR addr, unsigned char *uuid)
+{
+  struct gdb_exception exc;
+  int found = 0;
+
+  TRY_CATCH (exc, RETURN_MASK_ERROR)
+    {
+      struct mach_header header;
+      struct load_command cmd;
+      CORE_ADDR curpos;
+      int i;
+
+      if (target_read_mach_header (addr, &header) == 0)
+	{
+	  curpos = addr + target_get_mach_header_size (&header);
+	  for (i = 0; i < header.ncmds; i++)
+	    {
+	      if (target_read_load_command (curpos, &cmd) != 0)
+		break;
+	      if (cmd.cmd == BFD_MACH_O_LC_UUID)
+		{
+		  found = (target_read_uuid (curpos, uuid) == 0);
+		  break;
+		}
+	      curpos += cmd.cmdsize;
+	    }
+	}
+    }
+  if (exc.reason < 0)
+    return 0;
+  return found;
+}
+
+/* Return the bfd the symbols for E were, or will be, read from.  */
+
+static bfd *
+dyld_objfile_entry_bfd (struct dyld_objfile_entry *e)
+{
+  if (e->abfd != NULL)
+    return e->abfd;
+  if (e->objfile != NULL)
+    return e->objfile->obfd;
+  return NULL;
+}
+
+/* NEWENT is an image dyld has just told us about that didn't match
+   any entry we had by name.  If it is the same image, by UUID, as an
+   objfile we read for an earlier run (a symlinked or @rpath'ed path
+   will give it a different name this time), return that entry so its
+   objfile can simply be slid to NEWENT's address.  */
+
+static struct dyld_objfile_entry *
+dyld_find_entry_by_uuid (struct dyld_objfile_info *oldinfos,
+			 struct dyld_objfile_entry *newent)
+{
+  unsigned char new_uuid[16];
+  unsigned char old_uuid[16];
+  struct dyld_objfile_entry *oldent;
+  int have_new_uuid = 0;
+  int i;
+
+  if (!dyld_reuse_by_uuid_flag || !newent->dyld_valid)
+    return NULL;
+
+  DYLD_ALL_OBJFILE_INFO_ENTRIES (oldinfos, oldent, i)
+    {
+      bfd *abfd;
+
+      /* Only entries left over from a previous run are candidates;
+	 anything dyld has reported this time is its own image.  */
+      if (oldent->objfile == NULL || oldent->dyld_valid
+	  || oldent->loaded_from_memory)
+	continue;
+      if ((oldent->reason & dyld_reason_executable_mask)
+	  != (newent->reason & dyld_reason_executable_mask))
+	continue;
+
+      abfd = dyld_objfile_entry_bfd (oldent);
+      if (abfd == NULL
+	  || !bfd_mach_o_get_uuid (abfd, old_uuid, sizeof (old_uuid)))
+	continue;
+
+      if (!have_new_uuid)
+	{
+	  if (!dyld_read_image_uuid (newent->dyld_addr, new_uuid))
+	    return NULL;
+	  have_new_uuid = 1;
+	}
+
+      if (memcmp (old_uuid, new_uuid, sizeof (new_uuid)) == 0)
+	return oldent;
+    }
+
+  return NULL;
+}
+/* APPLE LOCAL end reuse objfiles by uuid  */
 
 void
 dyld_merge_shlib (const struct macosx_dyld_thread_status *s,
                   struct dyld_path_info *d,
                   struct dyld_objfile_info *oldinfos,
-                  struct dyld_objfile_entry *newent)
+                  struct dyld_objfile_entry *newent,
+                  struct dyld_image_index *index)
 {
   int i;
   struct dyld_objfile_entry *oldent;
+  struct dyld_image_cursor c;
 
-  DYLD_ALL_OBJFILE_INFO_ENTRIES (oldinfos, oldent, i)
+  dyld_image_cursor_init (&c, index, oldinfos, newent);
+  while ((oldent = dyld_image_cursor_next (&c, &i)) != NULL)
     if (dyld_libraries_compatible (d, newent, oldent))
       {
         dyld_objfile_move_load_data (oldent, newent);
@@ -2440,14 +3005,31 @@ dyld_merge_shlib (const struct macosx_dyld_thread_status *s,
       }
 
   if (newent->reason & dyld_reason_image_mask)
-    DYLD_ALL_OBJFILE_INFO_ENTRIES (oldinfos, oldent, i)
-      if (oldent->objfile != NULL && dyld_libraries_similar (d, newent, oldent))
-        {
-          dyld_objfile_move_load_data (oldent, newent);
-          if (newent->reason & dyld_reason_executable_mask)
-            symfile_objfile = newent->objfile;
-          return;
-        }
+    {
+      dyld_image_cursor_init (&c, index, oldinfos, newent);
+      while ((oldent = dyld_image_cursor_next (&c, &i)) != NULL)
+        if (oldent->objfile != NULL
+            && dyld_libraries_similar (d, newent, oldent))
+          {
+            dyld_objfile_move_load_data (oldent, newent);
+            if (newent->reason & dyld_reason_executable_mask)
+              symfile_objfile = newent->objfile;
+            return;
+          }
+    }
+
+  /* APPLE LOCAL begin reuse objfiles by uuid  */
+  oldent = dyld_find_entry_by_uuid (oldinfos, newent);
+  if (oldent != NULL)
+    {
+      dyld_debug ("Reusing objfile \"%s\" for the image at 0x%s "
+		  "with the same UUID\n", oldent->objfile->name,
+		  paddr_nz (newent->dyld_addr));
+      dyld_objfile_move_load_data (oldent, newent);
+      if (newent->reason & dyld_reason_executable_mask)
+	symfile_objfile = newent->objfile;
+    }
+  /* APPLE LOCAL end reuse objfiles by uuid  */
 }
 
 /* Go through all the dyld_objfile_entry's in OBJINFO, looking for
@@ -2460,17 +3042,24 @@ dyld_merge_shlib (const struct macosx_dyld_thread_status *s,
    point we want to toss the pre-execution speculative dyld_objfile_entry
    and standardize on the actually-seen image file.
 
-   That's one instance where we'll be using this function.  */
+   That's one instance where we'll be using this function.
+
+   If INDEX is non-NULL, it is an index of OBJ_INFO from
+   dyld_image_index_build and only the entries it turns up are
+   looked at.  */
 
 void
 dyld_prune_shlib (struct dyld_path_info *d,
 		  struct dyld_objfile_info *obj_info,
-                  struct dyld_objfile_entry *new)
+                  struct dyld_objfile_entry *new,
+                  struct dyld_image_index *index)
 {
   struct dyld_objfile_entry *o;
+  struct dyld_image_cursor c;
   int i;
 
-  DYLD_ALL_OBJFILE_INFO_ENTRIES (obj_info, o, i)
+  dyld_image_cursor_init (&c, index, obj_info, new);
+  while ((o = dyld_image_cursor_next (&c, &i)) != NULL)
     {
       if ((o->reason & dyld_reason_executable_mask)
           && (new->reason & dyld_reason_executable_mask))
@@ -2505,6 +3094,8 @@ dyld_merge_shlibs (const struct macosx_dyld_thread_status *s,
 {
   struct dyld_objfile_entry *n = NULL;
   struct dyld_objfile_entry *o = NULL;
+  struct dyld_image_index *index;
+  struct cleanup *index_cleanup;
   int i;
 
   CHECK_FATAL (old != NULL);
@@ -2513,12 +3104,19 @@ dyld_merge_shlibs (const struct macosx_dyld_thread_status *s,
 
   dyld_resolve_filenames (s, new);
 
+  /* Nothing is added to OLD until the end, so one index serves for
+     both passes.  */
+  index = dyld_image_index_build (old);
+  index_cleanup = make_cleanup_dyld_image_index_free (index);
+
   DYLD_ALL_OBJFILE_INFO_ENTRIES (new, n, i)
     if (n->objfile == NULL)
-      dyld_merge_shlib (s, d, old, n);
+      dyld_merge_shlib (s, d, old, n, index);
 
   DYLD_ALL_OBJFILE_INFO_ENTRIES (new, n, i)
-    dyld_prune_shlib (d, old, n);
+    dyld_prune_shlib (d, old, n, index);
+
+  do_cleanups (index_cleanup);
 
   DYLD_ALL_OBJFILE_INFO_ENTRIES (old, o, i)
     {
@@ -2560,6 +3158,7 @@ dyld_update_shlibs (struct dyld_path_info *d, struct dyld_objfile_info *result)
   dyld_load_symfiles (result);
 
   dyld_shlibs_updated (result);
+  dyld_schedule_background_load ();
   if (maint_use_timers)
     do_cleanups (timer_cleanup);
 
@@ -2591,4 +3190,16 @@ Set if GDB should check the binary UUID between the file on disk and the one loa
 Set if GDB should check the binary UUID between the file on disk and the one loaded in memory."), NULL,
 			   NULL, NULL,
 			   &setshliblist, &showshliblist);
+
+  /* APPLE LOCAL begin reuse objfiles by uuid  */
+  add_setshow_boolean_cmd ("reuse-by-uuid", class_obscure,
+			   &dyld_reuse_by_uuid_flag, _("\
+Set if GDB should reuse an objfile from an earlier run for an image with the same UUID."), _("\
+Show if GDB should reuse an objfile from an earlier run for an image with the same UUID."), _("\
+When on, a shared library that a re-run program loads from a different\n\
+path than last time, but whose UUID matches a library gdb has already\n\
+read, keeps that library's symbols and is just slid to its new address."),
+			   NULL, NULL,
+			   &setshliblist, &showshliblist);
+  /* APPLE LOCAL end reuse objfiles by uuid  */
 }
@@ -50,9 +50,43 @@ void dyld_merge_libraries (struct dyld_objfile_info * old,
                            struct dyld_objfile_info * new,
                            struct dyld_objfile_info * result);
 
+struct dyld_image_index;
+
+/* A walk over the entries of a dyld_objfile_info that might match a
+   given entry; see dyld_image_cursor_init.  */
+
+struct dyld_image_cursor
+{
+  struct dyld_objfile_info *info;
+  int linear;
+  int pos;
+  const int *addr;
+  int naddr, iaddr;
+  const int *unslid;
+  int nunslid, iunslid;
+};
+
+struct dyld_image_index *dyld_image_index_build (struct dyld_objfile_info *info);
+
+void dyld_image_index_add (struct dyld_image_index *index,
+                           struct dyld_objfile_info *info, int n);
+
+void dyld_image_index_free (struct dyld_image_index *index);
+
+struct cleanup *make_cleanup_dyld_image_index_free (struct dyld_image_index *index);
+
+void dyld_image_cursor_init (struct dyld_image_cursor *c,
+                             struct dyld_image_index *index,
+                             struct dyld_objfile_info *info,
+                             struct dyld_objfile_entry *e);
+
+struct dyld_objfile_entry *dyld_image_cursor_next (struct dyld_image_cursor *c,
+                                                   int *n);
+
 void dyld_prune_shlib (struct dyld_path_info * d,
 		       struct dyld_objfile_info * old,
-                       struct dyld_objfile_entry * n);
+                       struct dyld_objfile_entry * n,
+                       struct dyld_image_index * index);
 
 void dyld_merge_shlibs (const struct macosx_dyld_thread_status *s,
                         struct dyld_path_info * d,
@@ -83,7 +117,8 @@ void dyld_update_shlibs (struct dyld_path_info * d,
 void dyld_merge_shlib (const struct macosx_dyld_thread_status *s,
                        struct dyld_path_info * d,
                        struct dyld_objfile_info * old,
-                       struct dyld_objfile_entry * n);
+                       struct dyld_objfile_entry * n,
+                       struct dyld_image_index * index);
 
 int dyld_libraries_compatible (struct dyld_path_info *d,
                            struct dyld_objfile_entry *f,
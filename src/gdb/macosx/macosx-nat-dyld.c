@@ -53,6 +53,9 @@
 #include "osabi.h"
 #include "exceptions.h"
 #include "remote.h"
+#include "event-loop.h"
+/* APPLE LOCAL symfile cache */
+#include "readline/tilde.h"
 
 #ifdef USE_MMALLOC
 #include <mmalloc.h>
@@ -115,6 +118,7 @@ int dyld_load_dyld_shlib_symbols_flag = 1;
 int dyld_load_cfm_shlib_symbols_flag = 1;
 int dyld_print_basenames_flag = 0;
 int dyld_reload_on_downgrade_flag = 0;
+int dyld_background_load_flag = 0;
 static int pre_slide_libraries_flag = 1;
 char *dyld_load_rules = NULL;
 char *dyld_minimal_load_rules = NULL;
@@ -135,6 +139,21 @@ int dyld_stop_on_shlibs_added = 1;
 int dyld_stop_on_shlibs_updated = 1;
 int dyld_combine_shlibs_added = 1;
 
+/* APPLE LOCAL begin coalesced dyld notifications  */
+/* When on, the images an "added" notification tells us about are
+   queued and the inferior is let go; they are read as one batch when
+   some later event needs them, or once the oldest has waited
+   DYLD_COALESCE_INTERVAL milliseconds.  */
+
+static int dyld_coalesce_notifications_flag = 1;
+static unsigned int dyld_coalesce_interval = 250;
+
+static struct dyld_objfile_entry *dyld_pending_added = NULL;
+static int dyld_num_pending_added = 0;
+static int dyld_max_pending_added = 0;
+static struct timeval dyld_pending_added_since;
+/* APPLE LOCAL end coalesced dyld notifications  */
+
 /* This is the function that libSystem calls to tell dyld that 
    the malloc system has been initialized.  
    This function name can be mangled in one of two ways.  We must check
@@ -1397,14 +1416,23 @@ macosx_dyld_remove_libraries (struct macosx_dyld_thread_status *dyld_status,
                            int num)
 {
   int i;
+  struct dyld_image_index *index;
+  struct cleanup *index_cleanup;
+
+  index = dyld_image_index_build (&dyld_status->current_info);
+  index_cleanup = make_cleanup_dyld_image_index_free (index);
+
   for (i = 0; i < num; i++)
     {
       struct dyld_objfile_entry *e;
+      struct dyld_image_cursor c;
       int found_it = 0;
 
       int k;
       
-      DYLD_ALL_OBJFILE_INFO_ENTRIES (&dyld_status->current_info, e, k)
+      dyld_image_cursor_init (&c, index, &dyld_status->current_info,
+			      &entries[i]);
+      while ((e = dyld_image_cursor_next (&c, &k)) != NULL)
 	{
 	  if (dyld_libraries_compatible (&dyld_status->path_info, e, &entries[i]))
 	    {
@@ -1432,6 +1460,8 @@ macosx_dyld_remove_libraries (struct macosx_dyld_thread_status *dyld_status,
 	warning ("Tried to remove a non-existent library: %s", 
 		 entries[i].dyld_name ? entries[i].dyld_name : "<unknown>");
     }
+
+  do_cleanups (index_cleanup);
 }
 /* Add the dyld_objfile_entry ENTRIES (an array of N of them) to the
    inferior process' DYLD_OBJFILE_INFO list of known images.
@@ -1439,7 +1469,12 @@ macosx_dyld_remove_libraries (struct macosx_dyld_thread_status *dyld_status,
    We may already have dyld_objfile_entry records for some of the ENTRIES,
    e.g. because we looked at the program's load commands before starting it
    and now we're getting dylib-loaded notifications from dyld.  So we want
-   to replace the old entries with these newer, shinier ones.  */
+   to replace the old entries with these newer, shinier ones.
+
+   Only the entries dyld told us about are read, and they are matched
+   against the ones we already have through a dyld_image_index, so a
+   notification costs one pass over the known images rather than one
+   per new image.  */
 
 void
 macosx_dyld_add_libraries (struct macosx_dyld_thread_status *dyld_status,
@@ -1450,22 +1485,32 @@ macosx_dyld_add_libraries (struct macosx_dyld_thread_status *dyld_status,
   int shlibnum;
   static int timer_id = -1;
   struct cleanup *timer_cleanup = NULL;
+  struct dyld_image_index *index;
+  struct cleanup *index_cleanup;
 
   if (maint_use_timers)
    timer_cleanup = start_timer (&timer_id, "macosx_dyld_add_libraries", "");
 
+  index = dyld_image_index_build (&dyld_status->current_info);
+  index_cleanup = make_cleanup_dyld_image_index_free (index);
+
   for (i = 0; i < num; i++)
     {
       struct dyld_objfile_entry *pentry;
       dyld_merge_shlib (dyld_status, &dyld_status->path_info,
-                        &dyld_status->current_info, &entries[i]);
+                        &dyld_status->current_info, &entries[i], index);
       dyld_prune_shlib (&dyld_status->path_info, 
-			&dyld_status->current_info, &entries[i]);
+			&dyld_status->current_info, &entries[i], index);
 
       pentry = dyld_objfile_entry_alloc (&dyld_status->current_info);
       *pentry = entries[i];
+      dyld_image_index_add (index, &dyld_status->current_info,
+                            pentry - dyld_status->current_info.entries);
     }
 
+  /* dyld_update_shlibs packs the entry list, which renumbers it.  */
+  do_cleanups (index_cleanup);
+
   dyld_update_shlibs (&dyld_status->path_info, &dyld_status->current_info);
 
   if (! ui_out_is_mi_like_p (uiout))
@@ -1475,11 +1520,18 @@ macosx_dyld_add_libraries (struct macosx_dyld_thread_status *dyld_status,
       return;
     }
 
+  index = dyld_image_index_build (&dyld_status->current_info);
+  index_cleanup = make_cleanup_dyld_image_index_free (index);
+
   for (i = 0; i < num; i++)
     {
       struct dyld_objfile_entry *entry;
+      struct dyld_image_cursor c;
       int j;
-      DYLD_ALL_OBJFILE_INFO_ENTRIES (&dyld_status->current_info, entry, j)
+
+      dyld_image_cursor_init (&c, index, &dyld_status->current_info,
+                              &entries[i]);
+      while ((entry = dyld_image_cursor_next (&c, &j)) != NULL)
         if (dyld_libraries_compatible (&dyld_status->path_info, entry,
                                        &entries[i]))
           {
@@ -1515,11 +1567,102 @@ macosx_dyld_add_libraries (struct macosx_dyld_thread_status *dyld_status,
 	      breakpoint_re_set (entry->objfile);
           }
     }
+  do_cleanups (index_cleanup);
   if (maint_use_timers)
     do_cleanups (timer_cleanup);
 
 }
 
+/* APPLE LOCAL begin coalesced dyld notifications  */
+/* Queue the NUM images in ENTRIES, which dyld just reported as added,
+   to be read later.  ENTRIES is reused by the next notification, so
+   they are copied.  */
+
+static void
+dyld_queue_added_libraries (struct dyld_objfile_entry *entries, int num)
+{
+  if (dyld_num_pending_added + num > dyld_max_pending_added)
+    {
+      dyld_max_pending_added = dyld_num_pending_added + num;
+      if (dyld_max_pending_added < 64)
+	dyld_max_pending_added = 64;
+      dyld_pending_added
+	= xrealloc (dyld_pending_added,
+		    dyld_max_pending_added * sizeof (struct dyld_objfile_entry));
+    }
+
+  if (dyld_num_pending_added == 0)
+    gettimeofday (&dyld_pending_added_since, NULL);
+
+  memcpy (dyld_pending_added + dyld_num_pending_added, entries,
+	  num * sizeof (struct dyld_objfile_entry));
+  dyld_num_pending_added += num;
+}
+
+/* Return 1 if the queued images have to be read now rather than at
+   the next notification.  */
+
+static int
+dyld_must_process_added_libraries (void)
+{
+  struct timeval now;
+  long waited;
+
+  /* A breakpoint might resolve in one of the new images, and the
+     inferior could reach it before we read them.  */
+  if (breakpoints_waiting_for_shlibs ())
+    return 1;
+
+  /* Stepping has to know about the code it steps into.  */
+  if (step_range_end != 0)
+    return 1;
+
+  if (dyld_coalesce_interval == 0)
+    return 0;
+
+  gettimeofday (&now, NULL);
+  waited = (now.tv_sec - dyld_pending_added_since.tv_sec) * 1000
+    + (now.tv_usec - dyld_pending_added_since.tv_usec) / 1000;
+  return waited >= (long) dyld_coalesce_interval;
+}
+
+/* Read every image queued by dyld_queue_added_libraries, and bring the
+   breakpoints up to date with them.  Return 1 if there were any.  */
+
+int
+macosx_dyld_flush_pending_notifications (void)
+{
+  static int breakpoint_timer = -1;
+  struct cleanup *timer_cleanup = NULL;
+  int num = dyld_num_pending_added;
+
+  if (num == 0)
+    return 0;
+
+  /* Empty the queue first so an error below doesn't leave the images
+     to be added a second time.  */
+  dyld_num_pending_added = 0;
+
+  macosx_solib_add_dyld_objfile_entries = dyld_pending_added;
+  num_macosx_solib_add_dyld_objfile_entries = num;
+  macosx_dyld_add_libraries (&macosx_dyld_status, dyld_pending_added, num);
+
+#if WITH_CFM
+  if (macosx_status != NULL)
+    macosx_cfm_init (&macosx_status->cfm_status);
+#endif
+
+  if (maint_use_timers)
+    timer_cleanup = start_timer (&breakpoint_timer, "shlib-bkpt-reset", "");
+  breakpoint_update ();
+  objc_note_libraries_changed ();
+  if (maint_use_timers)
+    do_cleanups (timer_cleanup);
+
+  return 1;
+}
+/* APPLE LOCAL end coalesced dyld notifications  */
+
 int
 macosx_solib_add (const char *filename, int from_tty,
                   struct target_ops *targ, int loadsyms)
@@ -1574,6 +1717,13 @@ macosx_solib_add (const char *filename, int from_tty,
       macosx_set_malloc_inited (dyld_status->libsystem_initialized);
     }
 
+  /* APPLE LOCAL begin coalesced dyld notifications  */
+  /* Only another dyld notification may leave queued images unread.  */
+  if (dyld_status->dyld_breakpoint == NULL
+      || dyld_status->dyld_breakpoint->loc->address != read_pc ())
+    macosx_dyld_flush_pending_notifications ();
+  /* APPLE LOCAL end coalesced dyld notifications  */
+
   /* If the inferior stopped at the dyld notification function,
      some file images have been loaded or removed.  */
 
@@ -1642,6 +1792,27 @@ macosx_solib_add (const char *filename, int from_tty,
             j++;
         }
 
+      /* APPLE LOCAL begin coalesced dyld notifications  */
+      /* Put off reading added images, merging them with any we have
+	 already put off, for as long as nothing needs them.  */
+      if (mode == 0 && dyld_coalesce_notifications_flag)
+	{
+	  dyld_queue_added_libraries (tinfo, j);
+	  if (!dyld_must_process_added_libraries ())
+	    return 0;
+	  return macosx_dyld_flush_pending_notifications ()
+	    && dyld_stop_on_shlibs_updated;
+	}
+
+      /* Images removed after ones we haven't read yet: read those
+	 first, so the removal finds them.  */
+      if (macosx_dyld_flush_pending_notifications ())
+	{
+	  macosx_solib_add_dyld_objfile_entries = tinfo;
+	  num_macosx_solib_add_dyld_objfile_entries = j;
+	}
+      /* APPLE LOCAL end coalesced dyld notifications  */
+
       /* MODE == 0 is shared libraries added.
 	 MODE == 1 is shared libraries removed.  */
       if (mode == 0)
@@ -1674,7 +1845,8 @@ macosx_solib_add (const char *filename, int from_tty,
 	 breakpoints here after we've added all the libraries.  */
 
       breakpoint_update ();
-      objc_clear_caches ();
+      /* APPLE LOCAL objc cache invalidation  */
+      objc_note_libraries_changed ();
 
       if (maint_use_timers)
 	do_cleanups (timer_cleanup);
@@ -2429,6 +2601,8 @@ struct dyld_all_image_infos_offsets
   int errorTargetDylibPath;             /* version 11 */
   int errorSymbol;                      /* version 11 */
   int sharedCacheSlide;                 /* version 12 */
+  /* APPLE LOCAL host shared cache  */
+  int sharedCacheUUID;                  /* version 13 */
 };
 
 /* Given the ADDR of the struct dyld_all_image_infos in the inferior,
@@ -2473,6 +2647,8 @@ dyld_read_raw_infos (CORE_ADDR addr, struct dyld_raw_infos *info)
       .errorTargetDylibPath            = i + i + p + p + b + b + (p - 2 * b) + p + p + p + p + p + p + p + p + p + p + p + p + p,
       .errorSymbol                     = i + i + p + p + b + b + (p - 2 * b) + p + p + p + p + p + p + p + p + p + p + p + p + p + p,
       .sharedCacheSlide                = i + i + p + p + b + b + (p - 2 * b) + p + p + p + p + p + p + p + p + p + p + p + p + p + p + p,
+      /* APPLE LOCAL host shared cache  */
+      .sharedCacheUUID                 = i + i + p + p + b + b + (p - 2 * b) + p + p + p + p + p + p + p + p + p + p + p + p + p + p + p + p,
     };
 
   uint8_t version_buf[4];
@@ -2484,7 +2660,10 @@ dyld_read_raw_infos (CORE_ADDR addr, struct dyld_raw_infos *info)
 
   /* we are only interested in a v9 version of the struct
      or a version 2 copy of the struct.  */
-  if (version >= 9)
+  /* APPLE LOCAL host shared cache  */
+  if (version >= 13)
+    image_infos_size = offsets.sharedCacheUUID + 16;
+  else if (version >= 9)
     image_infos_size = offsets.dyldAllImageInfosAddress + p;
   else if (version >= 2)
     image_infos_size = offsets.jitInfo;
@@ -2512,6 +2691,17 @@ dyld_read_raw_infos (CORE_ADDR addr, struct dyld_raw_infos *info)
   info->dyld_actual_load_address = extract_unsigned_integer 
                              (buf + offsets.dyldImageLoadAddress, wordsize);
 
+  /* APPLE LOCAL begin host shared cache  */
+  /* Let a local copy of the inferior's shared cache stand in for its
+     memory, if the user has one.  */
+  if (info->version >= 13 && !info->process_detached_from_shared_region)
+    macosx_set_target_shared_cache
+      (buf + offsets.sharedCacheUUID,
+       extract_unsigned_integer (buf + offsets.sharedCacheSlide, wordsize));
+  else
+    macosx_set_target_shared_cache (NULL, 0);
+  /* APPLE LOCAL end host shared cache  */
+
   // If we're attaching to a process very early in its startup -- before
   // dyld has had a chance to update the addresses of these fields -- we
   // can tell what the adjustment will be that'll be applied to them soon
@@ -2829,6 +3019,10 @@ macosx_dyld_mourn_inferior (void)
   struct dyld_objfile_entry *e;
   int i;
   struct macosx_dyld_thread_status *status = &macosx_dyld_status;
+
+  /* APPLE LOCAL coalesced dyld notifications  */
+  dyld_num_pending_added = 0;
+
   DYLD_ALL_OBJFILE_INFO_ENTRIES (&status->current_info, e, i)
     {
       e->dyld_addr = 0;
@@ -3082,6 +3276,118 @@ dyld_objfile_set_load_state (struct objfile *o, int load_state)
   return found_it;
 }
 
+/* Return the load level still pending for objfile O from background
+   loading, or -1 if O is not waiting on the background loader.  */
+
+int
+dyld_objfile_deferred_load_state (struct objfile *o)
+{
+  struct dyld_objfile_entry *e;
+  int i;
+
+  DYLD_ALL_OBJFILE_INFO_ENTRIES (&macosx_dyld_status.current_info, e, i)
+    if (e->objfile == o)
+      return e->deferred_load_flag;
+  return -1;
+}
+
+/* The background loader.  Rather than reading every library's symbols
+   before the prompt comes back, dyld_initial_load_flag leaves the
+   libraries at their minimal level and notes the level they should
+   end up at.  We then raise them one library at a time off an event
+   loop timer, so the user can type commands in between, and anything
+   that needs one of those libraries sooner just raises that one
+   (see objfile_set_load_state).  The symbol readers are not
+   reentrant, so this all happens on gdb's own thread.  */
+
+/* Milliseconds between libraries.  This only needs to be long enough
+   that handle_timer_event doesn't run our rescheduled timer in the
+   same pass.  */
+#define DYLD_BACKGROUND_LOAD_INTERVAL 10
+
+static int dyld_background_load_timer = -1;
+
+struct dyld_background_load_args
+{
+  struct dyld_objfile_entry *e;
+  int index;
+  int load_state;
+};
+
+static int
+dyld_background_load_one (void *data)
+{
+  struct dyld_background_load_args *args = data;
+
+  set_load_state_1 (args->e, &macosx_dyld_status.path_info,
+                    args->index, args->load_state);
+  re_enable_breakpoints_in_shlibs (1);
+  return 1;
+}
+
+static void
+dyld_background_load_handler (gdb_client_data client_data)
+{
+  struct dyld_background_load_args args;
+  struct dyld_objfile_entry *e;
+  int i;
+
+  dyld_background_load_timer = -1;
+
+  /* Leave the inferior alone while it is running; just check back
+     later.  */
+  if (target_executing)
+    {
+      dyld_schedule_background_load ();
+      return;
+    }
+
+  args.e = NULL;
+  DYLD_ALL_OBJFILE_INFO_ENTRIES (&macosx_dyld_status.current_info, e, i)
+    if (e->deferred_load_flag >= 0 && e->objfile != NULL)
+      {
+        args.e = e;
+        args.index = i + 1;
+        args.load_state = e->deferred_load_flag;
+        break;
+      }
+
+  if (args.e == NULL)
+    return;
+
+  /* Queue up the next library before reading this one, so that an
+     error reading one library doesn't strand the rest.  */
+  args.e->deferred_load_flag = -1;
+  dyld_schedule_background_load ();
+
+  dyld_debug ("dyld_background_load: reading symbols for \"%s\"\n",
+              args.e->objfile->name);
+  catch_errors (dyld_background_load_one, &args,
+                "Error reading shared library symbols:\n", RETURN_MASK_ALL);
+}
+
+/* Arrange for the background loader to run if any library still has
+   a deferred load level pending.  */
+
+void
+dyld_schedule_background_load (void)
+{
+  struct dyld_objfile_entry *e;
+  int i;
+
+  if (dyld_background_load_timer != -1)
+    return;
+
+  DYLD_ALL_OBJFILE_INFO_ENTRIES (&macosx_dyld_status.current_info, e, i)
+    if (e->deferred_load_flag >= 0 && e->objfile != NULL)
+      {
+        dyld_background_load_timer =
+          create_timer (DYLD_BACKGROUND_LOAD_INTERVAL,
+                        dyld_background_load_handler, NULL);
+        return;
+      }
+}
+
 static void
 apply_load_rules_helper (struct dyld_path_info *d, 
                        struct dyld_objfile_entry *e,
@@ -3128,6 +3434,13 @@ set_load_state_1 (struct dyld_objfile_entry *e,
 
   e->load_flag = load_state;
 
+  /* Whoever is raising the level now has taken over from the
+     background loader.  */
+  if (e->deferred_load_flag >= 0
+      && (load_state & OBJF_SYM_LEVELS_MASK)
+      >= (e->deferred_load_flag & OBJF_SYM_LEVELS_MASK))
+    e->deferred_load_flag = -1;
+
   /* If there is no existing objfile, load it (if appropriate) and return. */
 
   if (e->objfile == NULL)
@@ -3501,17 +3814,109 @@ dyld_lookup_and_bind_function (char *name)
   return 1;
 }
 
+/* APPLE LOCAL begin symfile cache */
+/* Expand and check the cache directory argument DIR.  The result is
+   freed by the caller's cleanups.  */
+
+static char *
+dyld_symfile_cache_directory (const char *dir)
+{
+  char *directory;
+  struct stat st;
+
+  directory = tilde_expand (dir);
+  make_cleanup (xfree, directory);
+  if (stat (directory, &st) != 0 || !S_ISDIR (st.st_mode))
+    error ("\"%s\" is not a directory.", directory);
+  return directory;
+}
+
 static void
 dyld_cache_symfiles_command (char *args, int from_tty)
 {
-  error ("Cached symfiles are not supported on this configuration of GDB.");
+  struct cleanup *cleanups = make_cleanup (null_cleanup, NULL);
+  struct objfile *objfile;
+  char *directory;
+  int written = 0;
+  int skipped = 0;
+
+  dont_repeat ();
+  if (args == NULL || *args == '\0')
+    error ("usage: sharedlibrary cache-symfiles DIR");
+  directory = dyld_symfile_cache_directory (args);
+
+  ALL_OBJFILES (objfile)
+    {
+      if (macho_write_symfile_cache (objfile, directory))
+	written++;
+      else
+	skipped++;
+    }
+
+  printf_filtered ("Wrote %d cached symfile%s to \"%s\".\n",
+		   written, written == 1 ? "" : "s", directory);
+  if (skipped != 0)
+    printf_filtered ("Skipped %d objfile%s with debug information or "
+		     "no UUID.\n", skipped, skipped == 1 ? "" : "s");
+  do_cleanups (cleanups);
 }
 
 static void
 dyld_cache_symfile_command (char *args, int from_tty)
 {
-  error ("Cached symfiles are not supported on this configuration of GDB.");
+  struct cleanup *cleanups = make_cleanup (null_cleanup, NULL);
+  struct objfile *objfile;
+  char **argv;
+  char *filename, *directory;
+  int written;
+
+  dont_repeat ();
+  argv = (args != NULL) ? buildargv (args) : NULL;
+  if (argv == NULL || argv[0] == NULL || argv[1] == NULL || argv[2] != NULL)
+    {
+      if (argv != NULL)
+	freeargv (argv);
+      error ("usage: sharedlibrary cache-symfile FILE DIR");
+    }
+  make_cleanup_freeargv (argv);
+
+  filename = tilde_expand (argv[0]);
+  make_cleanup (xfree, filename);
+  directory = dyld_symfile_cache_directory (argv[1]);
+
+  /* Read FILE on its own, write its cache, and throw it away again.  */
+  objfile = symbol_file_add (filename, 0, NULL, 0, OBJF_USERLOADED);
+  if (objfile == NULL)
+    error ("Unable to read symbols from \"%s\".", filename);
+
+  written = 0;
+  {
+    struct gdb_exception e;
+
+    TRY_CATCH (e, RETURN_MASK_ALL)
+      {
+	written = macho_write_symfile_cache (objfile, directory);
+      }
+
+    tell_breakpoints_objfile_changed (objfile);
+    tell_objc_msgsend_cacher_objfile_changed (objfile);
+    free_objfile (objfile);
+    symtab_clear_cached_lookup_values ();
+    clear_symtab_users ();
+
+    if (e.reason < 0)
+      throw_exception (e);
+  }
+
+  if (written)
+    printf_filtered ("Wrote cached symfile for \"%s\" to \"%s\".\n",
+		     filename, directory);
+  else
+    printf_filtered ("\"%s\" can't be cached: it has debug information "
+		     "or no UUID.\n", filename);
+  do_cleanups (cleanups);
 }
+/* APPLE LOCAL end symfile cache */
 
 
 void
@@ -3770,6 +4175,9 @@ set_shlib_path_substitutions_cmd (char *args, int from_tty,
 				    struct cmd_list_element * c)
 {
   int success = 0;
+
+  /* APPLE LOCAL dyld path cache  */
+  dyld_path_cache_flush ();
   
   /* Free our old path array if we had one.  */
   if (shlib_path_substitutions != NULL)
@@ -3946,6 +4354,17 @@ Show the prefix that GDB should prepend to all symbols for the dynamic linker.")
 
   dyld_symbols_prefix = xstrdup (dyld_symbols_prefix);
 
+  add_setshow_boolean_cmd ("background-load", class_support,
+			   &dyld_background_load_flag, _("\
+Set if GDB should finish reading shared library symbols in the background."), _("\
+Show if GDB should finish reading shared library symbols in the background."), _("\
+When on, only the minimal symbols for each new shared library are read\n\
+before control returns to the prompt.  The rest are read one library at a\n\
+time while GDB is waiting for input, or right away for a library that a\n\
+command needs."),
+			   NULL, NULL,
+			   &setshliblist, &showshliblist);
+
   add_setshow_boolean_cmd ("always-read-from-memory", class_obscure,
 			   &dyld_always_read_from_memory_flag, _("\
 Set if GDB should always read loaded images from the inferior's memory."), _("\
@@ -4021,6 +4440,29 @@ Show if GDB should combine shlibs-added events from the same image into a single
 			    NULL, NULL,
 			    &setshliblist, &showshliblist);
 
+  /* APPLE LOCAL begin coalesced dyld notifications  */
+  add_setshow_boolean_cmd ("coalesce-notifications", class_support,
+			   &dyld_coalesce_notifications_flag, _("\
+Set if GDB should merge dyld shlibs-added notifications that arrive close together."), _("\
+Show if GDB should merge dyld shlibs-added notifications that arrive close together."), _("\
+When on, the images a shlibs-added notification reports are not read\n\
+right away; the inferior is continued, and the images from several\n\
+notifications are read together.  They are read at once if a pending\n\
+breakpoint might resolve in them, while stepping, when the inferior\n\
+stops, and when the oldest has waited \"coalesce-interval\" milliseconds."),
+			   NULL, NULL,
+			   &setshliblist, &showshliblist);
+
+  add_setshow_uinteger_cmd ("coalesce-interval", class_support,
+			    &dyld_coalesce_interval, _("\
+Set how many milliseconds GDB may put off reading newly loaded shlibs."), _("\
+Show how many milliseconds GDB may put off reading newly loaded shlibs."), _("\
+Only used when \"coalesce-notifications\" is on.  Zero means there is\n\
+no limit, and queued shlibs are read only when something needs them."),
+			    NULL, NULL,
+			    &setshliblist, &showshliblist);
+  /* APPLE LOCAL end coalesced dyld notifications  */
+
   add_setshow_zinteger_cmd ("reload-on-downgrade", class_support,
 			    &dyld_reload_on_downgrade_flag, _("\
 Set if GDB should re-read symbol files in order to remove symbol information."), _("\
@@ -4045,13 +4487,18 @@ Show if GDB should enable debugging of CFM shared libraries."), NULL,
 			   NULL, NULL,
 			   &setlist, &showlist);
 
+  /* APPLE LOCAL begin symfile cache */
   add_cmd ("cache-symfiles", class_run, dyld_cache_symfiles_command,
-           "Generate persistent caches of symbol files for the current executable state.",
+           "Write the minimal symbols of the loaded libraries to a directory.\n"
+           "usage: cache-symfiles DIR\n"
+           "Each library without debug information is saved to DIR/<UUID>.symfile;\n"
+           "\"maint set mach-o-symfile-cache-directory DIR\" reads them back.",
            &shliblist);
 
   add_cmd ("cache-symfile", class_run, dyld_cache_symfile_command,
-           "Generate persistent caches of symbol files for a specified executable.\n"
-           "usage: cache-symfile <source> <target> [prefix]", &shliblist);
+           "Write the minimal symbols of a single file to a directory.\n"
+           "usage: cache-symfile FILE DIR", &shliblist);
+  /* APPLE LOCAL end symfile cache */
 
   add_setshow_string_cmd ("shlib-path-substitutions", class_support,
 			  &shlib_path_subst_cmd_args, _("\
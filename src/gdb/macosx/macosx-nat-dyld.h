@@ -24,11 +24,25 @@ struct dyld_objfile_entry;
    starts.  Once we've started execution we can rely on dyld to keep everything
    separate.  */
 
+/* APPLE LOCAL begin pre-run memory map ranges  */
+/* A run of used buckets, [START, END).  */
+
+struct pre_run_memory_range {
+  int start;
+  int end;
+};
+
 struct pre_run_memory_map {
   int number_of_buckets;
   CORE_ADDR bucket_size;
-  int *buckets;
+
+  /* The used buckets, as runs sorted by address.  Runs never overlap
+     or touch; marking a run that does merges them.  */
+  struct pre_run_memory_range *used;
+  int num_used;
+  int num_used_allocated;
 };
+/* APPLE LOCAL end pre-run memory map ranges  */
 
 /* Imported definitions from <mach/machine.h> which may not be available on
    older systems.  */
@@ -101,6 +115,8 @@ void dyld_debug (const char *fmt, ...);
 void dyld_print_status_info (macosx_dyld_thread_status *s, unsigned int mask,
                              char *args);
 int dyld_objfile_set_load_state (struct objfile *o, int load_state);
+int dyld_objfile_deferred_load_state (struct objfile *o);
+void dyld_schedule_background_load (void);
 void macosx_clear_start_breakpoint ();
 void macosx_set_start_breakpoint (macosx_dyld_thread_status *s,
                                   bfd *exec_bfd);
@@ -118,6 +134,8 @@ void macosx_init_dyld (struct macosx_dyld_thread_status *s,
 void macosx_init_dyld_symfile (struct objfile *o, bfd *abfd);
 enum gdb_osabi macosx_get_osabi_from_dyld_entry (bfd *abfd);
 void macosx_dyld_mourn_inferior (void);
+/* APPLE LOCAL coalesced dyld notifications  */
+int macosx_dyld_flush_pending_notifications (void);
 
 int target_is_remote ();
 int target_is_kdp_remote ();
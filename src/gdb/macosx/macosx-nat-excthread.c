@@ -39,6 +39,8 @@
 
 #include <sys/time.h>
 #include <sys/select.h>
+/* APPLE LOCAL coalesced exception events  */
+#include <errno.h>
 
 #include <mach/mach_error.h>
 #include <pthread.h>
@@ -96,6 +98,13 @@ struct mach_msg_data
 static struct mach_msg_data *msg_data = NULL;
 static int msg_data_size = MACOSX_EXCEPTION_ARRAY_SIZE;
 
+/* APPLE LOCAL begin coalesced exception events  */
+/* Where a batch of messages is gathered so it can be written to the
+   main thread in one go.  Grown as needed, never shrunk.  */
+static macosx_exception_thread_message *msg_batch = NULL;
+static int msg_batch_size = 0;
+/* APPLE LOCAL end coalesced exception events  */
+
 /* This either allocates space for the DATA_ARR if NULL is past
    in, or realloc's it to NUM_ELEM if not.  */
 
@@ -324,6 +333,8 @@ macosx_exception_thread_init (macosx_exception_thread_status *s)
   s->saved_exceptions_stepping = 0;
   s->exception_thread = THREAD_NULL;
   s->shutting_down = 0;
+  /* APPLE LOCAL non-stop  */
+  s->non_stop = 0;
 }
 
 pthread_mutex_t excthread_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -449,6 +460,11 @@ macosx_exception_thread_destroy (macosx_exception_thread_status *s)
   xfree (msg_data);
   msg_data = NULL;
   msg_data_size = MACOSX_EXCEPTION_ARRAY_SIZE;
+  /* APPLE LOCAL begin coalesced exception events  */
+  xfree (msg_batch);
+  msg_batch = NULL;
+  msg_batch_size = 0;
+  /* APPLE LOCAL end coalesced exception events  */
 
   pthread_mutex_destroy (&write_mutex);
   macosx_exception_thread_init (s);
@@ -473,6 +489,8 @@ macosx_exception_thread (void *arg)
       mach_msg_option_t receive_options;
       kern_return_t kret;
       int counter;
+      /* APPLE LOCAL non-stop  */
+      int suspended = 0;
 
       excthread_debug_re (1, "waiting for exceptions\n");
       receive_options = MACH_RCV_MSG | MACH_RCV_INTERRUPT;
@@ -565,11 +583,14 @@ macosx_exception_thread (void *arg)
 	      break;
 	    }
 
-	  if (next_msg_ctr == 0)
+	  /* APPLE LOCAL begin non-stop  */
+	  if (next_msg_ctr == 0 && !s->non_stop)
 	    {
 	      excthread_debug_re (2, "suspending task\n");
 	      task_suspend (s->task);
+	      suspended = 1;
 	    }
+	  /* APPLE LOCAL end non-stop  */
 	  excthread_debug_re (3, "parsing exception\n");
 	  static_message = &msg_data[next_msg_ctr].msgsend;
 	  kret = mach_exc_server (&msg_data[next_msg_ctr].msgin.hdr, 
@@ -598,7 +619,11 @@ macosx_exception_thread (void *arg)
 	  next_msg_ctr++;
 	  if (next_msg_ctr == msg_data_size)
 	    {
-	      msg_data_size += MACOSX_EXCEPTION_ARRAY_SIZE;
+	      /* APPLE LOCAL coalesced exception events: Grow
+		 geometrically; when hundreds of threads hit the same
+		 breakpoint, adding a few slots at a time copied the
+		 whole array over and over.  */
+	      msg_data_size *= 2;
 	      alloc_msg_data (&msg_data, msg_data_size);
 	    }
 	  receive_options |= MACH_RCV_TIMEOUT;
@@ -606,15 +631,45 @@ macosx_exception_thread (void *arg)
 	}
 
       macosx_exception_get_write_lock (s);
-      for (counter = 0; counter < next_msg_ctr; counter++) 
+      /* APPLE LOCAL begin coalesced exception events  */
+      /* Send the whole batch in one write, so that the main thread can
+	 pick it up with one read instead of a select and a read per
+	 message.  */
+      if (next_msg_ctr > 0)
 	{
+	  size_t size, done;
 
-	  excthread_debug_re (1, "sending exception to main thread: %d ", counter);
-	  excthread_debug_message (1, &msg_data[counter].msgsend);
-	  excthread_debug_re_endline (1);
-	  write (s->transmit_from_fd, &msg_data[counter].msgsend, sizeof (msg_data[counter].msgsend));
-	  
+	  if (next_msg_ctr > msg_batch_size)
+	    {
+	      msg_batch_size = msg_data_size;
+	      msg_batch = (macosx_exception_thread_message *)
+		xrealloc (msg_batch, msg_batch_size * sizeof (*msg_batch));
+	    }
+	  for (counter = 0; counter < next_msg_ctr; counter++) 
+	    {
+	      excthread_debug_re (1, "sending exception to main thread: %d ", counter);
+	      excthread_debug_message (1, &msg_data[counter].msgsend);
+	      excthread_debug_re_endline (1);
+	      msg_batch[counter] = msg_data[counter].msgsend;
+	    }
+
+	  size = next_msg_ctr * sizeof (*msg_batch);
+	  for (done = 0; done < size; )
+	    {
+	      ssize_t n = write (s->transmit_from_fd,
+				 (char *) msg_batch + done, size - done);
+	      if (n < 0 && errno == EINTR)
+		continue;
+	      if (n <= 0)
+		{
+		  excthread_debug_re (0, "error sending exceptions to main thread: %s\n",
+				      strerror (errno));
+		  break;
+		}
+	      done += n;
+	    }
 	}
+      /* APPLE LOCAL end coalesced exception events  */
       macosx_exception_release_write_lock (s);
 
       excthread_debug_re (3, "waiting for gdb\n");
@@ -664,12 +719,17 @@ macosx_exception_thread (void *arg)
 	     made when we received the data above.  */
 	  xfree (msg_data[counter].msgsend.exception_data);
 	}
-      excthread_debug_re (2, "Resuming task\n");
-      task_resume (s->task);
-      if (kret != KERN_SUCCESS)
-	excthread_debug_re (2, "resumed task.\n");
-      else
-	excthread_debug_re (2, "resume task failed\n");
+      /* APPLE LOCAL begin non-stop  */
+      if (suspended)
+	{
+	  excthread_debug_re (2, "Resuming task\n");
+	  task_resume (s->task);
+	  if (kret != KERN_SUCCESS)
+	    excthread_debug_re (2, "resumed task.\n");
+	  else
+	    excthread_debug_re (2, "resume task failed\n");
+	}
+      /* APPLE LOCAL end non-stop  */
 
     }
 }
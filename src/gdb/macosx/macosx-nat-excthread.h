@@ -52,6 +52,12 @@ struct macosx_exception_thread_status
      exception thread not to complain about the exception port
      going away out from under it on shutting down.  */
   int shutting_down;
+  /* APPLE LOCAL begin non-stop  */
+  /* Set by the main thread before it lets the task go.  When set, an
+     exception stops only the threads that raised it - they wait for
+     our reply - and the task itself is left running.  */
+  int non_stop;
+  /* APPLE LOCAL end non-stop  */
 };
 typedef struct macosx_exception_thread_status macosx_exception_thread_status;
 
@@ -0,0 +1,104 @@
+/* APPLE LOCAL begin inferior helper. This entire file is APPLE LOCAL  */
+/* Mac OS X support for GDB, the GNU debugger.
+   Copyright 2026 Free Software Foundation, Inc.
+
+   Contributed by Apple Computer, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.  */
+
+#ifndef __GDB_MACOSX_NAT_HELPER_H__
+#define __GDB_MACOSX_NAT_HELPER_H__
+
+/* The interface between gdb and the helper library it can load into
+   the inferior to answer many questions with one function call.
+
+   This header is shared with the helper, so it uses only fixed-size
+   types and nothing from gdb.
+
+   The helper exports two functions:
+
+     struct gdb_helper_ring *gdb_helper_get_ring (void);
+
+   returns a buffer the helper owns, with MAGIC, VERSION and SIZE
+   filled in.  gdb asks for it once per process.
+
+     int gdb_helper_run_batch (struct gdb_helper_ring *ring);
+
+   answers the NREQUESTS requests gdb has written after the header,
+   filling in each one's STATUS and results, and copying any strings
+   into the space that follows the requests.  STRINGS_OFFSET says where
+   that space starts, relative to the start of the ring.  The helper
+   sets STRINGS_USED to the number of bytes it has written there.  It
+   returns the number of requests it answered.  */
+
+#define GDB_HELPER_RING_MAGIC	0x67646268	/* 'gdbh' */
+#define GDB_HELPER_RING_VERSION	1
+
+#define GDB_HELPER_GET_RING_FUNCTION	"gdb_helper_get_ring"
+#define GDB_HELPER_RUN_BATCH_FUNCTION	"gdb_helper_run_batch"
+
+enum gdb_helper_op
+{
+  GDB_HELPER_OP_NONE = 0,
+
+  /* ARG is an Objective-C object.  RESULT is the class [ARG class]
+     returns, AUX the object's isa pointer, and the string the name of
+     the class.  */
+  GDB_HELPER_OP_OBJC_CLASS = 1
+};
+
+enum gdb_helper_status
+{
+  GDB_HELPER_STATUS_UNANSWERED = 0,
+  GDB_HELPER_STATUS_OK = 1,
+  GDB_HELPER_STATUS_FAILED = 2,
+  GDB_HELPER_STATUS_UNKNOWN_OP = 3
+};
+
+struct gdb_helper_request
+{
+  uint32_t op;
+  uint32_t status;
+  uint64_t arg;
+  uint64_t result;
+  uint64_t aux;
+
+  /* Where the request's string result is, relative to the start of
+     the ring, and its length not counting the terminating nul.  Zero
+     length if there is none.  */
+  uint32_t string_offset;
+  uint32_t string_length;
+};
+
+struct gdb_helper_ring
+{
+  uint32_t magic;
+  uint32_t version;
+
+  /* The size of the whole ring, header included.  */
+  uint32_t size;
+
+  uint32_t nrequests;
+  uint32_t strings_offset;
+  uint32_t strings_used;
+
+  /* NREQUESTS struct gdb_helper_request follow.  */
+};
+
+#endif /* __GDB_MACOSX_NAT_HELPER_H__ */
+/* APPLE LOCAL end inferior helper  */
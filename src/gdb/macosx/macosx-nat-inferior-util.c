@@ -107,6 +107,11 @@ call_ptrace (int request, int pid, PTRACE_ARG3_TYPE arg3, int arg4)
 void
 macosx_inferior_reset (macosx_inferior_status *s)
 {
+  /* APPLE LOCAL stop memory cache  */
+  macosx_invalidate_memory_cache ();
+  /* APPLE LOCAL thread state cache  */
+  macosx_invalidate_thread_state_cache ();
+
   s->pid = 0;
   s->task = TASK_NULL;
 
@@ -205,8 +210,10 @@ macosx_inferior_check_stopped (macosx_inferior_status *s)
       CHECK (s->attached_in_ptrace);
     }
 
+  /* APPLE LOCAL non-stop: In non-stop mode only the threads that
+     raised an exception have stopped; the task isn't suspended.  */
   CHECK ((s->stopped_in_ptrace == 1) || (s->stopped_in_softexc == 1)
-         || (s->suspend_count > 0));
+         || (s->suspend_count > 0) || s->exception_status.non_stop);
   CHECK ((s->suspend_count == 0) || (s->suspend_count == 1));
 }
 
@@ -242,6 +249,12 @@ macosx_inferior_resume_mach (macosx_inferior_status *s, int count)
   CHECK (s != NULL);
   CHECK (macosx_task_valid (s->task));
 
+  /* APPLE LOCAL stop memory cache: Once the task runs, its memory may
+     change.  */
+  macosx_invalidate_memory_cache ();
+  /* APPLE LOCAL thread state cache  */
+  macosx_invalidate_thread_state_cache ();
+
   for (;;)
     {
       if (s->suspend_count == 0)
@@ -314,6 +327,11 @@ macosx_inferior_resume_ptrace (macosx_inferior_status *s, unsigned int thread,
 
   macosx_inferior_suspend_mach (s);
 
+  /* APPLE LOCAL stop memory cache  */
+  macosx_invalidate_memory_cache ();
+  /* APPLE LOCAL thread state cache  */
+  macosx_invalidate_thread_state_cache ();
+
   if ((s->stopped_in_softexc) && (thread != 0))
     {
       inferior_debug (2, "Calling ptrace (%s, 0x%x, 0x%x, %d).\n",ptrace_request_unparse (PTRACE_THUPDATE),
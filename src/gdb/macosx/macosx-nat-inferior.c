@@ -76,6 +76,7 @@
 #include "macosx-nat-excthread.h"
 #include "macosx-nat-sigthread.h"
 #include "macosx-nat-threads.h"
+#include "macosx-nat-watchpoint.h"
 #include "macosx-xdep.h"
 /* classic-inferior-support */
 #include "macosx-nat.h"
@@ -144,6 +145,53 @@ extern int inferior_auto_start_dyld_flag;
 
 int macosx_fake_resume = 0;
 
+/* APPLE LOCAL begin range stepping  */
+/* The thread macosx_child_resume last single-stepped on infrun's
+   behalf with range stepping allowed, and the range it may be stepped
+   through before infrun has to look at it; THREAD_NULL if the current
+   step must be reported.  */
+static thread_t macosx_range_step_thread = THREAD_NULL;
+static CORE_ADDR macosx_range_step_start;
+static CORE_ADDR macosx_range_step_end;
+
+/* Non-zero if the stop macosx_process_events just serviced was a
+   lone single-step exception.  */
+static int macosx_last_event_single_step = 0;
+/* APPLE LOCAL end range stepping  */
+
+/* APPLE LOCAL begin page watchpoint engine  */
+/* How macosx_child_resume last set the threads running, so that we
+   can go back to that after stepping a thread over a write that only
+   hit a watched page by accident.  */
+static int macosx_resume_step;
+static thread_t macosx_resume_thread;
+static int macosx_resume_stop_others;
+
+/* The thread being stepped over such a write with its page
+   unprotected, and the address it faulted on; THREAD_NULL if none.  */
+static thread_t macosx_watch_step_thread = THREAD_NULL;
+static CORE_ADDR macosx_watch_step_addr;
+/* Non-zero if the write being stepped over really hit a watched
+   range, rather than just a watched page.  */
+static int macosx_watch_step_hit;
+/* APPLE LOCAL end page watchpoint engine  */
+
+/* APPLE LOCAL begin native ignore counts  */
+/* Non-zero if gdb should step threads over breakpoints whose ignore
+   counts are all that stand between a hit and a resume, without
+   reporting the hit to infrun.  */
+static int inferior_step_over_ignored_flag = 1;
+
+/* Non-zero if the stop macosx_process_events just serviced was a
+   lone breakpoint exception.  */
+static int macosx_last_event_breakpoint = 0;
+
+/* The thread being stepped over an ignored breakpoint, with the
+   breakpoints at the address it hit taken out; THREAD_NULL if none.  */
+static thread_t macosx_ignore_step_thread = THREAD_NULL;
+static CORE_ADDR macosx_ignore_step_addr;
+/* APPLE LOCAL end native ignore counts  */
+
 static int announce_attach = 1;
 
 extern int disable_aslr_flag;
@@ -178,6 +226,25 @@ struct pid_list
 };
 
 struct macosx_pending_event *pending_event_chain, *pending_event_tail;
+/* APPLE LOCAL coalesced exception events: The length of the chain,
+   so nobody has to walk it to find out.  */
+static int pending_event_count;
+
+/* APPLE LOCAL begin coalesced exception events  */
+/* The exception thread writes each batch of messages in one go; we read
+   as much of it as is there into this buffer, and hand the messages out
+   from it, rather than making a select and a read call for each one.
+   EXC_READ_FD is the pipe the buffered data came from, so nothing is
+   carried over to a new exception thread.  */
+
+#define MACOSX_EXC_READ_BATCH 64
+
+static unsigned char exc_read_buf[MACOSX_EXC_READ_BATCH
+				  * sizeof (macosx_exception_thread_message)];
+static size_t exc_read_start;
+static size_t exc_read_end;
+static int exc_read_fd = -1;
+/* APPLE LOCAL end coalesced exception events  */
 
 static void (*async_client_callback) (enum inferior_event_type event_type,
                                       void *context);
@@ -346,8 +413,15 @@ macosx_handle_exception (macosx_exception_thread_message *msg,
 
   macosx_status->last_thread = msg->thread_port;
 
-  kret = macosx_inferior_suspend_mach (macosx_status);
-  MACH_CHECK_ERROR (kret);
+  /* APPLE LOCAL begin non-stop  */
+  /* In non-stop mode the threads that raised exceptions are held by
+     the exception thread until it replies; leave the rest running.  */
+  if (!macosx_status->exception_status.non_stop)
+    {
+      kret = macosx_inferior_suspend_mach (macosx_status);
+      MACH_CHECK_ERROR (kret);
+    }
+  /* APPLE LOCAL end non-stop  */
 
   prepare_threads_after_stop (macosx_status);
 
@@ -432,6 +506,57 @@ macosx_add_to_port_set (struct macosx_inferior_status *inferior,
     }
 }
 
+/* APPLE LOCAL begin coalesced exception events  */
+/* If a whole exception message is buffered, copy it to BUF and return
+   1.  Otherwise return 0.  */
+
+static int
+macosx_take_buffered_exception (unsigned char *buf)
+{
+  size_t size = sizeof (macosx_exception_thread_message);
+
+  if (exc_read_end - exc_read_start < size)
+    return 0;
+  memcpy (buf, exc_read_buf + exc_read_start, size);
+  exc_read_start += size;
+  if (exc_read_start == exc_read_end)
+    exc_read_start = exc_read_end = 0;
+  return 1;
+}
+
+/* FD has something to read: read as much of it as fits into the
+   buffer, and at least one whole message.  Return 0 if the pipe went
+   away under us.  */
+
+static int
+macosx_read_exception_batch (int fd)
+{
+  size_t size = sizeof (macosx_exception_thread_message);
+
+  if (exc_read_start != 0)
+    {
+      memmove (exc_read_buf, exc_read_buf + exc_read_start,
+	       exc_read_end - exc_read_start);
+      exc_read_end -= exc_read_start;
+      exc_read_start = 0;
+    }
+
+  do
+    {
+      ssize_t n = read (fd, exc_read_buf + exc_read_end,
+			sizeof (exc_read_buf) - exc_read_end);
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	return 0;
+      exc_read_end += n;
+    }
+  while (exc_read_end < size);
+
+  return 1;
+}
+/* APPLE LOCAL end coalesced exception events  */
+
 /* TIMEOUT is either -1, 0, or greater than 0.
    For 0, check if there is anything to read, but don't block.
    For -1, block until there is something to read.
@@ -452,6 +577,17 @@ macosx_fetch_event (struct macosx_inferior_status *inferior,
   CHECK_FATAL (len >= sizeof (macosx_exception_thread_message));
   CHECK_FATAL (len >= sizeof (macosx_signal_thread_message));
 
+  /* APPLE LOCAL begin coalesced exception events  */
+  if (exc_read_fd != inferior->exception_status.receive_from_fd)
+    {
+      exc_read_fd = inferior->exception_status.receive_from_fd;
+      exc_read_start = exc_read_end = 0;
+    }
+  if ((flags & NEXT_SOURCE_EXCEPTION)
+      && macosx_take_buffered_exception (buf))
+    return NEXT_SOURCE_EXCEPTION;
+  /* APPLE LOCAL end coalesced exception events  */
+
   tv.tv_sec = 0;
   tv.tv_usec = timeout;
 
@@ -493,7 +629,11 @@ macosx_fetch_event (struct macosx_inferior_status *inferior,
   fd = inferior->exception_status.receive_from_fd;
   if (fd > 0 && FD_ISSET (fd, &fds))
     {
-      read (fd, buf, sizeof (macosx_exception_thread_message));
+      /* APPLE LOCAL begin coalesced exception events  */
+      if (!macosx_read_exception_batch (fd)
+	  || !macosx_take_buffered_exception (buf))
+	return NEXT_SOURCE_ERROR;
+      /* APPLE LOCAL end coalesced exception events  */
       return NEXT_SOURCE_EXCEPTION;
     }
 
@@ -545,6 +685,8 @@ macosx_add_to_pending_events (enum macosx_source_type type,
     }
 
   new_event->next = NULL;
+  /* APPLE LOCAL coalesced exception events  */
+  pending_event_count++;
 
   if (pending_event_chain == NULL)
     {
@@ -571,13 +713,8 @@ macosx_free_pending_event (struct macosx_pending_event *event_ptr)
 static int 
 macosx_count_pending_events ()
 {
-  int counter = 0;
-  struct macosx_pending_event *event_ptr;
-
-  for (event_ptr = pending_event_chain; event_ptr != NULL; event_ptr = event_ptr->next)
-    counter++;
-
-  return counter;
+  /* APPLE LOCAL coalesced exception events  */
+  return pending_event_count;
 }
       
 static void
@@ -592,6 +729,8 @@ macosx_remove_pending_event (struct macosx_pending_event *event_ptr, int delete)
     event_ptr->prev->next = event_ptr->next;
   if (event_ptr->next != NULL)
     event_ptr->next->prev = event_ptr->prev;
+  /* APPLE LOCAL coalesced exception events  */
+  pending_event_count--;
   
   if (delete)
     macosx_free_pending_event (event_ptr);
@@ -608,6 +747,10 @@ macosx_clear_pending_events ()
       macosx_free_pending_event (event_ptr);
       event_ptr = pending_event_chain;
     }
+  /* APPLE LOCAL begin coalesced exception events  */
+  pending_event_tail = NULL;
+  pending_event_count = 0;
+  /* APPLE LOCAL end coalesced exception events  */
 }
 
 /* This extracts the top of the pending event chain and posts a gdb event
@@ -898,6 +1041,11 @@ macosx_process_events (struct macosx_inferior_status *inferior,
 
   CHECK_FATAL (status->kind == TARGET_WAITKIND_SPURIOUS);
 
+  /* APPLE LOCAL range stepping  */
+  macosx_last_event_single_step = 0;
+  /* APPLE LOCAL native ignore counts  */
+  macosx_last_event_breakpoint = 0;
+
   event_count = macosx_count_pending_events ();
   if (event_count != 0)
     {
@@ -1064,6 +1212,10 @@ macosx_process_events (struct macosx_inferior_status *inferior,
     {
       int retval;
 
+      /* APPLE LOCAL range stepping  */
+      macosx_last_event_single_step = (get_event_type (event) == ss_event);
+      /* APPLE LOCAL native ignore counts  */
+      macosx_last_event_breakpoint = (get_event_type (event) == bp_event);
       if (macosx_service_event (event->type, 
 				event->buf, status) == 0)
 	retval = 0;
@@ -1245,6 +1397,23 @@ macosx_child_resume (ptid_t ptid, int step, enum target_signal signal)
   thread_t thread;
 
   status.code = -1;
+  /* APPLE LOCAL range stepping  */
+  macosx_range_step_thread = THREAD_NULL;
+  /* APPLE LOCAL begin native ignore counts  */
+  if (macosx_ignore_step_thread != THREAD_NULL)
+    {
+      reinsert_breakpoints_at (macosx_ignore_step_addr);
+      macosx_ignore_step_thread = THREAD_NULL;
+    }
+  /* APPLE LOCAL end native ignore counts  */
+  /* APPLE LOCAL begin page watchpoint engine  */
+  if (macosx_watch_step_thread != THREAD_NULL)
+    {
+      macosx_page_watch_reprotect (macosx_watch_step_addr);
+      macosx_watch_step_thread = THREAD_NULL;
+    }
+  macosx_page_watch_clear_triggered ();
+  /* APPLE LOCAL end page watchpoint engine  */
 
   if (ptid_equal (ptid, minus_one_ptid))
     {
@@ -1261,6 +1430,10 @@ macosx_child_resume (ptid_t ptid, int step, enum target_signal signal)
   if (!macosx_inferior_valid (macosx_status))
     return;
 
+  /* APPLE LOCAL non-stop: Tell the exception thread how to treat the
+     next exception before anything lets it go.  */
+  macosx_status->exception_status.non_stop = non_stop;
+
   /* Check for pending events.  If we find any, then we won't really resume,
      but rather we will extract the first event from the pending events
      queue, and post it to the gdb event queue, and then "pretend" that we
@@ -1291,10 +1464,26 @@ macosx_child_resume (ptid_t ptid, int step, enum target_signal signal)
   if (!macosx_inferior_valid (macosx_status))
     return;
 
+  /* APPLE LOCAL begin range stepping  */
+  if (step && range_step_bounds (&macosx_range_step_start,
+				 &macosx_range_step_end))
+    macosx_range_step_thread = thread;
+  /* APPLE LOCAL end range stepping  */
+
+  /* APPLE LOCAL begin displaced stepping  */
+  /* A displaced step leaves the breakpoints in, so the other threads
+     can run while this one steps the copy.  APPLE LOCAL non-stop: So
+     does any step that isn't lifting a breakpoint in non-stop mode.  */
   if (step)
-    prepare_threads_before_run (macosx_status, step, thread, 1);
-  else
-    prepare_threads_before_run (macosx_status, 0, thread, stop_others);
+    stop_others = stop_others || !(displaced_step_in_progress () || non_stop);
+  prepare_threads_before_run (macosx_status, step, thread, stop_others);
+  /* APPLE LOCAL end displaced stepping  */
+
+  /* APPLE LOCAL begin page watchpoint engine  */
+  macosx_resume_step = step;
+  macosx_resume_thread = thread;
+  macosx_resume_stop_others = stop_others;
+  /* APPLE LOCAL end page watchpoint engine  */
 
   macosx_inferior_resume_mach (macosx_status, -1);
 
@@ -1305,6 +1494,215 @@ macosx_child_resume (ptid_t ptid, int step, enum target_signal signal)
     target_executing = 1;
 }
 
+/* APPLE LOCAL begin range stepping  */
+/* STATUS is the stop macosx_process_events just decoded.  If it is
+   the single-step we are range stepping, and the thread is still
+   inside the range and not sitting on a breakpoint, set the thread up
+   to take another step and return non-zero; the caller then resumes
+   the task without telling infrun anything.  Otherwise end the range
+   step and return zero, so the stop gets reported.  */
+
+static int
+macosx_range_step_again (struct macosx_inferior_status *ns,
+			 struct target_waitstatus *status)
+{
+  CORE_ADDR pc;
+
+  if (macosx_range_step_thread == THREAD_NULL)
+    return 0;
+
+  if (status->kind != TARGET_WAITKIND_STOPPED
+      || status->value.sig != TARGET_SIGNAL_TRAP
+      || !macosx_last_event_single_step
+      || ns->last_thread != macosx_range_step_thread
+      || macosx_count_pending_events () != 0)
+    {
+      macosx_range_step_thread = THREAD_NULL;
+      return 0;
+    }
+
+  /* The thread has moved since anybody last read its registers.  */
+  registers_changed ();
+  pc = read_pc_pid (ptid_build (ns->pid, 0, macosx_range_step_thread));
+  if (pc < macosx_range_step_start || pc >= macosx_range_step_end
+      || breakpoint_here_p (pc) != no_breakpoint_here)
+    {
+      macosx_range_step_thread = THREAD_NULL;
+      return 0;
+    }
+
+  inferior_debug (6, "macosx_range_step_again: pc 0x%s still in "
+		  "[0x%s, 0x%s), stepping again\n", paddr_nz (pc),
+		  paddr_nz (macosx_range_step_start),
+		  paddr_nz (macosx_range_step_end));
+  prepare_threads_before_run (ns, 1, macosx_range_step_thread, 1);
+  return 1;
+}
+/* APPLE LOCAL end range stepping  */
+
+/* APPLE LOCAL begin page watchpoint engine  */
+/* STATUS is the stop macosx_process_events just decoded.  Watchpoints
+   write-protect whole pages, so a busy heap page faults on every
+   write to it, not just on writes to the watched object.  If this
+   stop is such a fault, and it is too far from every watched range
+   to have touched one, lift the protection on that one page, set the
+   thread up to step the store by itself, and return non-zero; the
+   caller then resumes without telling infrun.  When the step comes
+   back, protect the page again and restart the threads the way
+   infrun last asked for.
+
+   Where watchpoints are continuable (i386 falling back to page
+   protection when it runs out of debug registers), a write that does
+   hit a watched range is stepped over the same way, and the trap that
+   ends the step is reported to infrun as the watchpoint stop.  */
+
+static int
+macosx_watch_step_again (struct macosx_inferior_status *ns,
+			 struct target_waitstatus *status)
+{
+  if (macosx_watch_step_thread != THREAD_NULL)
+    {
+      thread_t thread = macosx_watch_step_thread;
+
+      macosx_page_watch_reprotect (macosx_watch_step_addr);
+      macosx_watch_step_thread = THREAD_NULL;
+
+      if (status->kind != TARGET_WAITKIND_STOPPED
+	  || status->value.sig != TARGET_SIGNAL_TRAP
+	  || !macosx_last_event_single_step
+	  || ns->last_thread != thread
+	  || macosx_count_pending_events () != 0)
+	return 0;
+
+      if (macosx_watch_step_hit)
+	{
+	  macosx_page_watch_set_triggered (macosx_watch_step_addr);
+	  return 0;
+	}
+
+      /* If infrun was stepping this thread anyway, this is the step
+	 it asked for.  */
+      if (macosx_resume_step && macosx_resume_thread == thread)
+	return 0;
+
+      inferior_debug (6, "macosx_watch_step_again: stepped thread 0x%x "
+		      "over the write to 0x%s, resuming\n", thread,
+		      paddr_nz (macosx_watch_step_addr));
+      registers_changed ();
+      prepare_threads_before_run (ns, macosx_resume_step, macosx_resume_thread,
+				  macosx_resume_stop_others);
+      return 1;
+    }
+
+  if (status->kind != TARGET_WAITKIND_STOPPED
+      || status->value.sig != TARGET_EXC_BAD_ACCESS
+      || ns->exception_status.non_stop
+      || macosx_count_pending_events () != 0)
+    return 0;
+
+  if (macosx_page_watch_false_hit (status->code, status->address))
+    {
+      inferior_debug (6, "macosx_watch_step_again: write to 0x%s is on a "
+		      "watched page but misses every watched range\n",
+		      paddr_nz (status->address));
+      macosx_watch_step_hit = 0;
+    }
+  else if (macosx_page_watch_continuable ()
+	   && macosx_page_watch_fault_p (status->code, status->address))
+    {
+      inferior_debug (6, "macosx_watch_step_again: finishing the write "
+		      "to watched 0x%s before reporting it\n",
+		      paddr_nz (status->address));
+      macosx_watch_step_hit = 1;
+    }
+  else
+    return 0;
+
+  macosx_page_watch_unprotect (status->address);
+  macosx_watch_step_thread = ns->last_thread;
+  macosx_watch_step_addr = status->address;
+  registers_changed ();
+  prepare_threads_before_run (ns, 1, ns->last_thread, 1);
+  return 1;
+}
+/* APPLE LOCAL end page watchpoint engine  */
+
+/* APPLE LOCAL begin native ignore counts  */
+/* STATUS is the stop macosx_process_events just decoded.  A hit on a
+   breakpoint that still has an ignore count would only go up to
+   bpstat_stop_status to have the count run down, and come straight
+   back down as a resume.  If this stop is such a hit, count it, take
+   the breakpoint out, set the thread up to step past it by itself,
+   and return non-zero; the caller then resumes without telling
+   infrun.  When the step comes back, put the breakpoint back and
+   restart the threads the way infrun last asked for.
+
+   Anything that needs infrun to look at the hit -- a condition,
+   commands, a thread or frame restriction, another event in the same
+   batch, or a step infrun asked for -- is left to the normal path.  */
+
+static int
+macosx_ignore_step_again (struct macosx_inferior_status *ns,
+			  struct target_waitstatus *status)
+{
+  ptid_t ptid;
+  CORE_ADDR pc;
+
+  if (macosx_ignore_step_thread != THREAD_NULL)
+    {
+      thread_t thread = macosx_ignore_step_thread;
+
+      macosx_ignore_step_thread = THREAD_NULL;
+      if (status->kind == TARGET_WAITKIND_EXITED
+	  || status->kind == TARGET_WAITKIND_SIGNALLED)
+	return 0;
+      reinsert_breakpoints_at (macosx_ignore_step_addr);
+
+      if (status->kind != TARGET_WAITKIND_STOPPED
+	  || status->value.sig != TARGET_SIGNAL_TRAP
+	  || !macosx_last_event_single_step
+	  || ns->last_thread != thread
+	  || macosx_count_pending_events () != 0)
+	return 0;
+
+      inferior_debug (6, "macosx_ignore_step_again: stepped thread 0x%x "
+		      "over the ignored breakpoint at 0x%s, resuming\n",
+		      thread, paddr_nz (macosx_ignore_step_addr));
+      registers_changed ();
+      prepare_threads_before_run (ns, macosx_resume_step, macosx_resume_thread,
+				  macosx_resume_stop_others);
+      return 1;
+    }
+
+  if (!inferior_step_over_ignored_flag
+      || status->kind != TARGET_WAITKIND_STOPPED
+      || status->value.sig != TARGET_SIGNAL_TRAP
+      || !macosx_last_event_breakpoint
+      || macosx_resume_step
+      || ns->exception_status.non_stop
+      || displaced_step_in_progress ()
+      || macosx_count_pending_events () != 0)
+    return 0;
+
+  ptid = ptid_build (ns->pid, 0, ns->last_thread);
+  registers_changed ();
+  pc = read_pc_pid (ptid) - DECR_PC_AFTER_BREAK;
+  if (!breakpoint_count_ignored_hit (pc))
+    return 0;
+
+  inferior_debug (6, "macosx_ignore_step_again: thread 0x%x hit ignored "
+		  "breakpoint at 0x%s, stepping over it\n", ns->last_thread,
+		  paddr_nz (pc));
+  if (DECR_PC_AFTER_BREAK)
+    write_pc_pid (pc, ptid);
+  remove_breakpoints_at (pc);
+  macosx_ignore_step_thread = ns->last_thread;
+  macosx_ignore_step_addr = pc;
+  prepare_threads_before_run (ns, 1, ns->last_thread, 1);
+  return 1;
+}
+/* APPLE LOCAL end native ignore counts  */
+
 static ptid_t
 macosx_process_pending_event (struct macosx_inferior_status *ns,
                               struct target_waitstatus *status,
@@ -1348,6 +1746,16 @@ macosx_wait (struct macosx_inferior_status *ns,
 	  macosx_inferior_resume_mach (ns, -1);
 
       macosx_process_events (ns, status, -1, 1);
+
+      /* APPLE LOCAL page watchpoint engine  */
+      if (macosx_watch_step_again (ns, status))
+	status->kind = TARGET_WAITKIND_SPURIOUS;
+      /* APPLE LOCAL range stepping  */
+      else if (macosx_range_step_again (ns, status))
+	status->kind = TARGET_WAITKIND_SPURIOUS;
+      /* APPLE LOCAL native ignore counts  */
+      else if (macosx_ignore_step_again (ns, status))
+	status->kind = TARGET_WAITKIND_SPURIOUS;
     }
 
   clear_sigio_trap ();
@@ -2325,10 +2733,12 @@ macosx_ptrace_him (int pid)
      and one for the exec command.  For "arch" there's one more
      for the "arch" command running.  */
 
+  /* APPLE LOCAL start with shell: fork_inferior may have decided the
+     shell wasn't needed.  */
 #ifdef USE_ARCH_FOR_EXEC
-  traps_expected = (start_with_shell_flag ? 3 : 1);
+  traps_expected = (startup_used_shell ? 3 : 1);
 #else
-  traps_expected = (start_with_shell_flag ? 2 : 1);
+  traps_expected = (startup_used_shell ? 2 : 1);
 #endif
 
   /* Okay, the exception & signal listeners are set up,
@@ -3027,6 +3437,83 @@ cpfork_info (char *args, int from_tty)
   printf ("%d regions total.\n", total);
 }
 
+/* APPLE LOCAL begin gcore region walk  */
+/* The to_find_memory_regions method, used by gcore.  Without it gcore
+   falls back on the objfiles' sections plus a guessed stack and heap,
+   and misses most of what a real process has mapped.  Walk the task's
+   VM map instead, merging neighbouring entries with the same
+   protection so that a heap made of thousands of malloc zones doesn't
+   turn into thousands of core file sections.  Entries nobody has ever
+   touched have no pages to save and are left out.  */
+
+static int
+macosx_find_memory_regions (int (*func) (CORE_ADDR, unsigned long,
+					 int, int, int, void *),
+			    void *data)
+{
+  task_t itask = macosx_status->task;
+  vm_address_t address = 0;
+  vm_size_t size = 0;
+  natural_t nesting_depth = 0;
+  CORE_ADDR run_start = 0;
+  unsigned long run_size = 0;
+  vm_prot_t run_prot = VM_PROT_NONE;
+  kern_return_t kret;
+  int ret;
+
+  if (itask == TASK_NULL)
+    error ("unable to locate task");
+
+  while (1)
+    {
+      mach_msg_type_number_t count = VM_REGION_SUBMAP_INFO_COUNT_64;
+      struct vm_region_submap_info_64 info;
+
+      kret = vm_region_recurse_64 (itask, &address, &size, &nesting_depth,
+				   (vm_region_info_64_t) &info, &count);
+      if (kret != KERN_SUCCESS)
+	break;
+
+      if (info.is_submap)
+	{
+	  nesting_depth++;
+	  continue;
+	}
+
+      if (info.protection != VM_PROT_NONE && info.share_mode != SM_EMPTY)
+	{
+	  if (run_size != 0 && run_prot == info.protection
+	      && run_start + run_size == address)
+	    run_size += size;
+	  else
+	    {
+	      if (run_size != 0)
+		{
+		  ret = func (run_start, run_size,
+			      (run_prot & VM_PROT_READ) != 0,
+			      (run_prot & VM_PROT_WRITE) != 0,
+			      (run_prot & VM_PROT_EXECUTE) != 0, data);
+		  if (ret != 0)
+		    return ret;
+		}
+	      run_start = address;
+	      run_size = size;
+	      run_prot = info.protection;
+	    }
+	}
+
+      address += size;
+    }
+
+  if (run_size != 0)
+    return func (run_start, run_size,
+		 (run_prot & VM_PROT_READ) != 0,
+		 (run_prot & VM_PROT_WRITE) != 0,
+		 (run_prot & VM_PROT_EXECUTE) != 0, data);
+  return 0;
+}
+/* APPLE LOCAL end gcore region walk  */
+
 /* Checkpoint support.  */
 
 /* Given a checkpoint, collect blocks of memory from the inferior and
@@ -3037,18 +3524,17 @@ void
 direct_memcache_get (struct checkpoint *cp)
 {
   task_t itask;
-  int kret;
-  int pid = cp->pid;
   vm_address_t        address = 0;
   vm_size_t           size = 0;
   kern_return_t       err = 0;
-
-  kret = task_for_pid (mach_task_self (), pid, &itask);
-  if (kret != KERN_SUCCESS)
-    {
-      error ("Unable to locate task for process-id %d: %s.", pid,
-	     MACH_ERROR_STRING (kret));
-    }
+  /* APPLE LOCAL checkpoint restore  */
+  natural_t nesting_depth = 0;
+
+  /* APPLE LOCAL begin checkpoint restore: There's no fork to look up
+     here - we only get called when the checkpoint doesn't have one -
+     so read the inferior itself.  */
+  itask = macosx_status->task;
+  /* APPLE LOCAL end checkpoint restore  */
   if (itask == TASK_NULL)
     {
       error ("unable to locate task");
@@ -3059,7 +3545,6 @@ direct_memcache_get (struct checkpoint *cp)
     {
       mach_msg_type_number_t  count;
       struct vm_region_submap_info_64 info;
-      natural_t nesting_depth;
 
       count = VM_REGION_SUBMAP_INFO_COUNT_64;
       err = vm_region_recurse_64 (itask, &address, &size, &nesting_depth,
@@ -3076,7 +3561,8 @@ direct_memcache_get (struct checkpoint *cp)
 
       if (info.protection & VM_PROT_WRITE)
 	{
-	  memcache_get (cp, address, size);
+	  /* APPLE LOCAL incremental checkpoints  */
+	  memcache_get_incremental (cp, current_checkpoint, address, size);
 	}
       
       if (info.is_submap)
@@ -3086,6 +3572,40 @@ direct_memcache_get (struct checkpoint *cp)
     }
 }
 
+/* APPLE LOCAL begin checkpoint restore  */
+/* FORK_INFO describes the checkpoint fork's map entry at ADDRESS, of
+   SIZE bytes and NESTING_DEPTH deep.  Return non-zero if the
+   inferior's entry there still refers to the same VM object.  The
+   fork shares its parent's pages copy-on-write, and the first write
+   to such an entry in either process gives that process a shadow
+   object of its own, so an entry still on the same object holds the
+   same data in both.  */
+
+static int
+checkpoint_region_unchanged (vm_address_t address, vm_size_t size,
+			     natural_t nesting_depth,
+			     struct vm_region_submap_info_64 *fork_info)
+{
+  vm_address_t r_address = address;
+  vm_size_t r_size = 0;
+  natural_t r_depth = nesting_depth;
+  struct vm_region_submap_info_64 info;
+  mach_msg_type_number_t count = VM_REGION_SUBMAP_INFO_COUNT_64;
+  kern_return_t kret;
+
+  if (fork_info->object_id == 0 || fork_info->is_submap)
+    return 0;
+
+  kret = vm_region_recurse_64 (macosx_status->task, &r_address, &r_size,
+			       &r_depth, (vm_region_info_64_t) &info, &count);
+  if (kret != KERN_SUCCESS)
+    return 0;
+
+  return (r_address == address && r_size == size && !info.is_submap
+	  && info.object_id == fork_info->object_id);
+}
+/* APPLE LOCAL end checkpoint restore  */
+
 /* Given a checkpoint, collect blocks of memory from the fork that is serving
    as its "backing store", and install them into the current inferior.  */
 
@@ -3098,6 +3618,10 @@ fork_memcache_put (struct checkpoint *cp)
   vm_address_t        address = 0;
   vm_size_t           size = 0;
   kern_return_t       err = 0;
+  /* APPLE LOCAL begin checkpoint restore  */
+  natural_t nesting_depth = 0;
+  int skipped = 0, copied = 0;
+  /* APPLE LOCAL end checkpoint restore  */
 
   kret = task_for_pid (mach_task_self (), pid, &itask);
   if (kret != KERN_SUCCESS)
@@ -3115,7 +3639,6 @@ fork_memcache_put (struct checkpoint *cp)
     {
       mach_msg_type_number_t  count;
       struct vm_region_submap_info_64 info;
-      natural_t nesting_depth;
 
       count = VM_REGION_SUBMAP_INFO_COUNT_64;
       err = vm_region_recurse_64 (itask, &address, &size, &nesting_depth,
@@ -3130,7 +3653,13 @@ fork_memcache_put (struct checkpoint *cp)
 	  break; // reached last region
 	}
 
-      if (info.protection & VM_PROT_WRITE)
+      /* APPLE LOCAL begin checkpoint restore: Only the entries that
+	 somebody wrote to since the fork need copying back.  */
+      if ((info.protection & VM_PROT_WRITE)
+	  && checkpoint_region_unchanged (address, size, nesting_depth, &info))
+	skipped++;
+      else if (info.protection & VM_PROT_WRITE)
+      /* APPLE LOCAL end checkpoint restore  */
 	{
 	  int rslt;
 	  vm_offset_t mempointer;       /* local copy of inferior's memory */
@@ -3147,8 +3676,17 @@ fork_memcache_put (struct checkpoint *cp)
 
 	  if (rslt == KERN_SUCCESS)
 	    {
-	      target_write (&current_target, TARGET_OBJECT_MEMORY, NULL,
-			    (bfd_byte *) mempointer, address, memcopied);
+	      /* APPLE LOCAL begin checkpoint restore: Hand the pages
+		 straight to the kernel, which can overwrite the
+		 inferior's copy-on-write, rather than pushing them
+		 through gdb a chunk at a time.  */
+	      if (mach_vm_write (macosx_status->task, address, mempointer,
+				 memcopied) != KERN_SUCCESS)
+		target_write (&current_target, TARGET_OBJECT_MEMORY, NULL,
+			      (bfd_byte *) mempointer, address, memcopied);
+	      vm_deallocate (mach_task_self (), mempointer, memcopied);
+	      copied++;
+	      /* APPLE LOCAL end checkpoint restore  */
 	    }
 	}
       
@@ -3157,6 +3695,15 @@ fork_memcache_put (struct checkpoint *cp)
       else
 	address += size;
     }
+
+  /* APPLE LOCAL begin checkpoint restore: We went behind the back of
+     gdb's memory caches.  */
+  macosx_invalidate_memory_cache ();
+  dcache_invalidate (target_dcache);
+  inferior_debug (2, "fork_memcache_put: restored %d regions from "
+		  "checkpoint %d, %d unchanged since the fork\n",
+		  copied, cp->number, skipped);
+  /* APPLE LOCAL end checkpoint restore  */
 }
 
 
@@ -3239,6 +3786,13 @@ _initialize_macosx_inferior ()
   macosx_child_ops.to_check_safe_call = macosx_check_safe_call;
   macosx_child_ops.to_setup_safe_print = objc_setup_safe_print;
   macosx_child_ops.to_allocate_memory = macosx_allocate_space_in_inferior;
+  /* APPLE LOCAL map target memory  */
+  macosx_child_ops.to_map_memory = macosx_map_inferior_memory;
+  macosx_child_ops.to_unmap_memory = macosx_unmap_inferior_memory;
+  /* APPLE LOCAL memory ranges  */
+  macosx_child_ops.to_read_memory_ranges = macosx_read_memory_ranges;
+  /* APPLE LOCAL gcore region walk  */
+  macosx_child_ops.to_find_memory_regions = macosx_find_memory_regions;
   macosx_child_ops.to_check_is_objfile_loaded = dyld_is_objfile_loaded;
 #if defined (TARGET_ARM)
   macosx_child_ops.to_keep_going = arm_macosx_keep_going;
@@ -3294,5 +3848,17 @@ Show if GDB should attach to the subprocess using ptrace ()."), NULL,
 			   NULL, NULL,
 			   &setlist, &showlist);
 
+  /* APPLE LOCAL begin native ignore counts  */
+  add_setshow_boolean_cmd ("inferior-step-over-ignored", class_obscure,
+			   &inferior_step_over_ignored_flag, _("\
+Set if GDB should step over ignored breakpoints without stopping."), _("\
+Show if GDB should step over ignored breakpoints without stopping."), _("\
+When on, a hit on a breakpoint with nothing but an ignore count to\n\
+check is counted, and the thread stepped past it, as soon as the\n\
+exception arrives, instead of stopping the inferior for infrun."),
+			   NULL, NULL,
+			   &setlist, &showlist);
+  /* APPLE LOCAL end native ignore counts  */
+
   add_info ("fork", cpfork_info, "help");
 }
@@ -56,6 +56,10 @@ struct private_thread_info
   void* core_thread_state;
   int gdb_suspend_count;
   int gdb_dont_suspend_stepping;
+  /* APPLE LOCAL targeted thread resume: Set when gdb has turned on
+     single-stepping in this thread, so that only such threads need
+     it turned off again when the task stops.  */
+  int gdb_trace_bit_set;
 };
 
 void macosx_check_new_threads (thread_array_t thread_list, unsigned int nthreads);
@@ -91,6 +95,10 @@ macho_calculate_offsets_for_dsym (struct objfile *main_objfile,
 				  struct section_offsets **sym_offsets,
 				  int *sym_num_offsets);
 
+/* APPLE LOCAL symfile cache */
+int macho_write_symfile_cache (struct objfile *objfile,
+			       const char *directory);
+
 /* This one is called in macosx-nat-inferior.c, but needs to be provided by the
    platform specific nat code.  It allows each platform to add platform specific
    stuff to the macosx_child_target.  */
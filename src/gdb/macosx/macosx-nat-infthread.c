@@ -83,28 +83,33 @@ modify_trace_bit (thread_t thread, int value)
   unsigned int state_count = GDB_x86_THREAD_STATE_COUNT;
   kern_return_t kret;
 
-  kret = thread_get_state (thread, GDB_x86_THREAD_STATE, 
+  /* APPLE LOCAL thread state cache  */
+  kret = macosx_thread_get_state (thread, GDB_x86_THREAD_STATE, 
                            (thread_state_t) &state, &state_count);
   if (kret == KERN_SUCCESS &&
       (state.tsh.flavor == GDB_x86_THREAD_STATE32 ||
        state.tsh.flavor == GDB_x86_THREAD_STATE64))
     {
+      /* APPLE LOCAL trace bit: Only write the state back if the bit
+         really changes.  */
       if (state.tsh.flavor == GDB_x86_THREAD_STATE32 
-          && (state.uts.ts32.eflags & 0x100UL) != (value ? 1 : 0))
+          && ((state.uts.ts32.eflags & 0x100UL) != 0) != (value != 0))
         {
           state.uts.ts32.eflags = 
                     (state.uts.ts32.eflags & ~0x100UL) | (value ? 0x100UL : 0);
-          kret = thread_set_state (thread, GDB_x86_THREAD_STATE32, 
+          /* APPLE LOCAL thread state cache  */
+          kret = macosx_thread_set_state (thread, GDB_x86_THREAD_STATE32, 
                                    (thread_state_t) & state.uts.ts32,
                                    GDB_x86_THREAD_STATE32_COUNT);
           MACH_PROPAGATE_ERROR (kret);
         }
       else if (state.tsh.flavor == GDB_x86_THREAD_STATE64 
-               && (state.uts.ts64.rflags & 0x100UL) != (value ? 1 : 0))
+               && ((state.uts.ts64.rflags & 0x100UL) != 0) != (value != 0))
         {
           state.uts.ts64.rflags = 
                      (state.uts.ts64.rflags & ~0x100UL) | (value ? 0x100UL : 0);
-          kret = thread_set_state (thread, GDB_x86_THREAD_STATE, 
+          /* APPLE LOCAL thread state cache  */
+          kret = macosx_thread_set_state (thread, GDB_x86_THREAD_STATE, 
                                    (thread_state_t) &state, state_count);
           MACH_PROPAGATE_ERROR (kret);
         }
@@ -114,14 +119,17 @@ modify_trace_bit (thread_t thread, int value)
       gdb_i386_thread_state_t state;
       
       state_count = GDB_i386_THREAD_STATE_COUNT;
-      kret = thread_get_state (thread, GDB_i386_THREAD_STATE, 
+      /* APPLE LOCAL thread state cache  */
+      kret = macosx_thread_get_state (thread, GDB_i386_THREAD_STATE, 
                                (thread_state_t) &state, &state_count);
       MACH_PROPAGATE_ERROR (kret);
 
-      if ((state.eflags & 0x100UL) != (value ? 1 : 0))
+      /* APPLE LOCAL trace bit  */
+      if (((state.eflags & 0x100UL) != 0) != (value != 0))
         {
           state.eflags = (state.eflags & ~0x100UL) | (value ? 0x100UL : 0);
-          kret = thread_set_state (thread, GDB_i386_THREAD_STATE, 
+          /* APPLE LOCAL thread state cache  */
+          kret = macosx_thread_set_state (thread, GDB_i386_THREAD_STATE, 
                                    (thread_state_t) &state, state_count);
           MACH_PROPAGATE_ERROR (kret);
         }
@@ -146,7 +154,8 @@ modify_trace_bit (thread_t thread, int value)
                       (thread_state_t) & state, &state_count);
   MACH_PROPAGATE_ERROR (kret);
 
-  if ((state.srr1 & 0x400UL) != (value ? 1 : 0))
+  /* APPLE LOCAL trace bit  */
+  if (((state.srr1 & 0x400UL) != 0) != (value != 0))
     {
       state.srr1 = (state.srr1 & ~0x400UL) | (value ? 0x400UL : 0);
       kret =
@@ -222,6 +231,11 @@ modify_trace_bit (thread_t thread, int value)
 
   if (value)
     {
+      /* APPLE LOCAL begin trace bit  */
+      uint32_t old_bvr = dbg.bvr[hw_idx];
+      uint32_t old_bcr = dbg.bcr[hw_idx];
+      /* APPLE LOCAL end trace bit  */
+
       /* Enable trace bit.  */
       arm_macosx_tdep_inf_status.macosx_half_step_pc = (CORE_ADDR)-1;
 
@@ -284,7 +298,10 @@ modify_trace_bit (thread_t thread, int value)
 	  // ARM breakpoint, stop when any address bits change
 	  dbg.bcr[hw_idx] |= BAS_IMVA_ALL;
 	}
-      update_dregs = 1;
+      /* APPLE LOCAL trace bit: A thread stepped again from where it
+         stopped already has the mismatch breakpoint it needs.  */
+      update_dregs = (dbg.bvr[hw_idx] != old_bvr
+                      || dbg.bcr[hw_idx] != old_bcr);
     }
   else
     {
@@ -317,13 +334,140 @@ modify_trace_bit (thread_t thread, int value)
 #error "unknown architecture"
 #endif
 
+/* APPLE LOCAL begin targeted thread resume  */
+/* The process whose threads all had their trace bits cleared, so that
+   only the ones gdb sets since need attention.  */
+
+static int trace_bits_known_pid = -1;
+
+/* APPLE LOCAL begin trace bit  */
+/* A thread's trace bit is left alone when it stops, and only cleared
+   when the inferior is resumed without stepping that thread, so
+   back-to-back steps of one thread don't turn it off and on again.
+   Until then the bit is hidden from the registers gdb reads; see
+   macosx_thread_trace_bit_set_p.  */
+
+struct restore_threads_args
+{
+  struct macosx_inferior_status *inferior;
+
+  /* When the task stops: clear the trace bit of every thread.  */
+  int sweep;
+
+  /* Before it runs: clear the trace bits gdb set, except THREAD_KEEP's.  */
+  thread_t thread_keep;
+};
+/* APPLE LOCAL end trace bit  */
+
+/* Undo whatever gdb did to TP's suspend count and trace bit before
+   the inferior last ran.  Callback for iterate_over_threads.  */
+
+static int
+restore_thread_after_stop (struct thread_info *tp, void *data)
+{
+  struct restore_threads_args *args = data;
+  thread_t thread;
+  kern_return_t kret;
+
+  if (ptid_get_pid (tp->ptid) != args->inferior->pid || tp->private == NULL)
+    return 0;
+  thread = ptid_get_tid (tp->ptid);
+
+  if (inferior_debug_flag >= 2)
+    {
+      struct thread_basic_info info;
+      unsigned int info_count = THREAD_BASIC_INFO_COUNT;
+
+      kret =
+        thread_info (thread, THREAD_BASIC_INFO,
+                     (thread_info_t) & info, &info_count);
+      MACH_CHECK_ERROR (kret);
+
+      if (tp->private->gdb_suspend_count > 0)
+        inferior_debug (3, "**  Resuming thread 0x%x, gdb suspend count: "
+                        "%d, real suspend count: %d\n",
+                        thread, tp->private->gdb_suspend_count,
+                        info.suspend_count);
+      else if (tp->private->gdb_suspend_count < 0)
+        inferior_debug (3, "**  Re-suspending thread 0x%x, original suspend count: "
+                        "%d\n",
+                        thread, tp->private->gdb_suspend_count);
+      else
+        inferior_debug (3, "**  Thread 0x%x was not suspended from gdb, "
+                        "real suspend count: %d\n",
+                        thread, info.suspend_count);
+    }
+
+  while (tp->private->gdb_suspend_count > 0)
+    {
+      thread_resume (thread);
+      tp->private->gdb_suspend_count--;
+    }
+  while (tp->private->gdb_suspend_count < 0)
+    {
+      thread_suspend (thread);
+      tp->private->gdb_suspend_count++;
+    }
+
+  /* APPLE LOCAL trace bit: Leave the bits gdb set until the next
+     resume; see clear_trace_bit_before_run.  */
+  if (args->sweep)
+    {
+      kret = clear_trace_bit (thread);
+      MACH_WARN_ERROR (kret);
+      tp->private->gdb_trace_bit_set = 0;
+    }
+
+  return 0;
+}
+
+/* APPLE LOCAL begin trace bit  */
+/* Callback for iterate_over_threads: clear the trace bits gdb set,
+   except in the thread ARGS->thread_keep.  */
+
+static int
+clear_trace_bit_before_run (struct thread_info *tp, void *data)
+{
+  struct restore_threads_args *args = data;
+  thread_t thread;
+  kern_return_t kret;
+
+  if (ptid_get_pid (tp->ptid) != args->inferior->pid || tp->private == NULL
+      || !tp->private->gdb_trace_bit_set)
+    return 0;
+  thread = ptid_get_tid (tp->ptid);
+  if (thread == args->thread_keep)
+    return 0;
+
+  kret = clear_trace_bit (thread);
+  MACH_WARN_ERROR (kret);
+  tp->private->gdb_trace_bit_set = 0;
+  return 0;
+}
+
+/* Return non-zero if gdb has left THREAD of the current inferior
+   single-stepping since it last stopped.  The register fetching code
+   uses this to hide the trace bit.  */
+
+int
+macosx_thread_trace_bit_set_p (thread_t thread)
+{
+  struct thread_info *tp;
+
+  if (macosx_status == NULL)
+    return 0;
+  tp = find_thread_pid (ptid_build (macosx_status->pid, 0, thread));
+  return tp != NULL && tp->private != NULL && tp->private->gdb_trace_bit_set;
+}
+/* APPLE LOCAL end trace bit  */
+/* APPLE LOCAL end targeted thread resume  */
+
 void
 prepare_threads_after_stop (struct macosx_inferior_status *inferior)
 {
   thread_array_t thread_list = NULL;
   unsigned int nthreads = 0;
   kern_return_t kret;
-  unsigned int i;
 
   if (inferior->exception_status.saved_exceptions_stepping)
     {
@@ -339,61 +483,23 @@ prepare_threads_after_stop (struct macosx_inferior_status *inferior)
 
   macosx_check_new_threads (thread_list, nthreads);
 
-  for (i = 0; i < nthreads; i++)
-    {
-
-      ptid_t ptid;
-      struct thread_info *tp = NULL;
-
-      ptid = ptid_build (inferior->pid, 0, thread_list[i]);
-      tp = find_thread_pid (ptid);
-      CHECK_FATAL (tp != NULL);
-      if (inferior_debug_flag >= 2)
-        {
-          struct thread_basic_info info;
-          unsigned int info_count = THREAD_BASIC_INFO_COUNT;
-          kern_return_t kret;
-
-          kret =
-            thread_info (thread_list[i], THREAD_BASIC_INFO,
-                         (thread_info_t) & info, &info_count);
-          MACH_CHECK_ERROR (kret);
-
-          if (tp->private->gdb_suspend_count > 0)
-            inferior_debug (3, "**  Resuming thread 0x%x, gdb suspend count: "
-                            "%d, real suspend count: %d\n",
-                            thread_list[i], tp->private->gdb_suspend_count,
-                            info.suspend_count);
-	  else if (tp->private->gdb_suspend_count < 0)
-	    inferior_debug (3, "**  Re-suspending thread 0x%x, original suspend count: "
-                            "%d\n",
-                            thread_list[i], tp->private->gdb_suspend_count);
-          else
-            inferior_debug (3, "**  Thread 0x%x was not suspended from gdb, "
-                            "real suspend count: %d\n",
-                            thread_list[i], info.suspend_count);
-        }
-      if (tp->private->gdb_suspend_count > 0)
-	{
-	  while (tp->private->gdb_suspend_count > 0)
-	    {
-	      thread_resume (thread_list[i]);
-	      tp->private->gdb_suspend_count--;
-	    }
-	}
-      else if (tp->private->gdb_suspend_count < 0)
-	{
-	  while (tp->private->gdb_suspend_count < 0)
-	    {
-	      thread_suspend (thread_list[i]);
-	      tp->private->gdb_suspend_count++;
-	    }
-	}
-
-
-      kret = clear_trace_bit (thread_list[i]);
-      MACH_WARN_ERROR (kret);
-    }
+  /* APPLE LOCAL begin targeted thread resume  */
+  /* gdb's thread list now matches the task's.  Walk it rather than
+     looking each task thread up in it, and only make Mach calls for
+     the threads gdb actually changed.  The first time we see a
+     process we don't know what it has been left with, so clear the
+     trace bit everywhere.  */
+  {
+    struct restore_threads_args args;
+
+    args.inferior = inferior;
+    args.sweep = (inferior->pid != trace_bits_known_pid);
+    /* APPLE LOCAL trace bit  */
+    args.thread_keep = THREAD_NULL;
+    iterate_over_threads (restore_thread_after_stop, &args);
+    trace_bits_known_pid = inferior->pid;
+  }
+  /* APPLE LOCAL end targeted thread resume  */
 
   kret =
     vm_deallocate (mach_task_self (), (vm_address_t) thread_list,
@@ -413,6 +519,17 @@ prepare_threads_before_run (struct macosx_inferior_status *inferior,
 
   prepare_threads_after_stop (inferior);
 
+  /* APPLE LOCAL begin trace bit  */
+  {
+    struct restore_threads_args args;
+
+    args.inferior = inferior;
+    args.sweep = 0;
+    args.thread_keep = step ? current : THREAD_NULL;
+    iterate_over_threads (clear_trace_bit_before_run, &args);
+  }
+  /* APPLE LOCAL end trace bit  */
+
   if (step || stop_others)
     {
       struct thread_basic_info info;
@@ -508,7 +625,14 @@ prepare_threads_before_run (struct macosx_inferior_status *inferior,
 
   if (step)
     {
+      /* APPLE LOCAL begin targeted thread resume  */
+      struct thread_info *tp
+        = find_thread_pid (ptid_build (inferior->pid, 0, current));
+
       set_trace_bit (current);
+      if (tp != NULL && tp->private != NULL)
+        tp->private->gdb_trace_bit_set = 1;
+      /* APPLE LOCAL end targeted thread resume  */
     }
 
   if (step)
@@ -615,72 +739,129 @@ struct dispatch_offsets_info {
    v. libdispatch's (non-public) src/queue_private.h for the definition of this 
    structure.  */
 
+/* APPLE LOCAL begin dispatch queue cache  */
+/* The offsets are constant data in libdispatch, so they are read once
+   and kept with the objfile the structure was found in; a new copy of
+   libdispatch means a new objfile.  If there is no libdispatch we
+   don't look again until the inferior has stopped again.  */
+
+static const struct objfile_data *dispatch_offsets_objfile_data;
+static struct objfile *dispatch_offsets_objfile;
+static unsigned int dispatch_offsets_missing_generation;
+
+static void
+dispatch_offsets_objfile_freed (struct objfile *objfile, void *data)
+{
+  xfree (data);
+  if (objfile == dispatch_offsets_objfile)
+    dispatch_offsets_objfile = NULL;
+}
+
 static struct dispatch_offsets_info *
 read_dispatch_offsets ()
 {
   struct minimal_symbol *dispatch_queue_offsets;
-  static struct dispatch_offsets_info *dispatch_offsets = NULL;
-  if (dispatch_offsets != NULL)
-    return dispatch_offsets;
+  static struct dispatch_offsets_info unowned_offsets;
+  struct dispatch_offsets_info *dispatch_offsets;
+  struct obj_section *osect;
+  gdb_byte buf[10];
+  CORE_ADDR addr;
+
+  if (dispatch_offsets_objfile != NULL)
+    return objfile_data (dispatch_offsets_objfile,
+                         dispatch_offsets_objfile_data);
+  if (dispatch_offsets_missing_generation == target_stop_generation)
+    return NULL;
 
   dispatch_queue_offsets = lookup_minimal_symbol 
                            ("dispatch_queue_offsets", NULL, NULL);
   if (dispatch_queue_offsets == NULL
       || SYMBOL_VALUE_ADDRESS (dispatch_queue_offsets) == 0
       || SYMBOL_VALUE_ADDRESS (dispatch_queue_offsets) == -1)
-    return NULL;
-
-  dispatch_offsets = (struct dispatch_offsets_info *)
-                      xmalloc (sizeof (struct dispatch_offsets_info));
-
-  if (safe_read_memory_unsigned_integer 
-       (SYMBOL_VALUE_ADDRESS (dispatch_queue_offsets), 2, 
-        &dispatch_offsets->version) == 0)
     {
-      xfree (dispatch_offsets);
-      dispatch_offsets = NULL;
+      dispatch_offsets_missing_generation = target_stop_generation;
       return NULL;
     }
 
-  if (safe_read_memory_unsigned_integer 
-       (SYMBOL_VALUE_ADDRESS (dispatch_queue_offsets) + 2, 2, 
-        &dispatch_offsets->label_offset) == 0)
-    {
-      xfree (dispatch_offsets);
-      dispatch_offsets = NULL;
-      return NULL;
-    }
+  /* The five 2-byte fields are read in one go.  */
+  addr = SYMBOL_VALUE_ADDRESS (dispatch_queue_offsets);
+  if (target_read_memory (addr, buf, sizeof (buf)) != 0)
+    return NULL;
 
-  if (safe_read_memory_unsigned_integer 
-       (SYMBOL_VALUE_ADDRESS (dispatch_queue_offsets) + 4, 2, 
-        &dispatch_offsets->label_size) == 0)
-    {
-      xfree (dispatch_offsets);
-      dispatch_offsets = NULL;
-      return NULL;
-    }
+  osect = find_pc_section (addr);
+  if (osect != NULL && osect->objfile != NULL)
+    dispatch_offsets = (struct dispatch_offsets_info *)
+                        xmalloc (sizeof (struct dispatch_offsets_info));
+  else
+    dispatch_offsets = &unowned_offsets;
 
-  if (safe_read_memory_unsigned_integer 
-       (SYMBOL_VALUE_ADDRESS (dispatch_queue_offsets) + 6, 2, 
-        &dispatch_offsets->flags_offset) == 0)
-    {
-      xfree (dispatch_offsets);
-      dispatch_offsets = NULL;
-      return NULL;
-    }
+  dispatch_offsets->version = extract_unsigned_integer (buf, 2);
+  dispatch_offsets->label_offset = extract_unsigned_integer (buf + 2, 2);
+  dispatch_offsets->label_size = extract_unsigned_integer (buf + 4, 2);
+  dispatch_offsets->flags_offset = extract_unsigned_integer (buf + 6, 2);
+  dispatch_offsets->flags_size = extract_unsigned_integer (buf + 8, 2);
 
-  if (safe_read_memory_unsigned_integer 
-       (SYMBOL_VALUE_ADDRESS (dispatch_queue_offsets) + 8, 2, 
-        &dispatch_offsets->flags_size) == 0)
+  if (dispatch_offsets != &unowned_offsets)
     {
-      xfree (dispatch_offsets);
-      dispatch_offsets = NULL;
-      return NULL;
+      set_objfile_data (osect->objfile, dispatch_offsets_objfile_data,
+                        dispatch_offsets);
+      dispatch_offsets_objfile = osect->objfile;
     }
-  
   return dispatch_offsets;
 }
 
+/* What we have read about each queue since the inferior last stopped,
+   keyed by the dispatch_qaddr from THREAD_IDENTIFIER_INFO.  Listing
+   the threads asks for the queue's address, name and flags one after
+   the other, and many threads share a queue.  */
+
+#define DISPATCH_QUEUE_CACHE_SLOTS 64
+
+struct dispatch_queue_cache_entry
+{
+  CORE_ADDR dispatch_qaddr;
+  unsigned int generation;
+
+  /* The queue structure's address, or 0 if it couldn't be read.  */
+  CORE_ADDR queue;
+
+  int have_name;
+  int name_found;
+  char name[96];
+
+  int have_flags;
+  int flags_found;
+  uint32_t flags;
+};
+
+static struct dispatch_queue_cache_entry
+  dispatch_queue_cache[DISPATCH_QUEUE_CACHE_SLOTS];
+
+static struct dispatch_queue_cache_entry *
+dispatch_queue_cache_lookup (CORE_ADDR dispatch_qaddr)
+{
+  struct dispatch_queue_cache_entry *entry;
+  int wordsize = TARGET_PTR_BIT / 8;
+  ULONGEST queue = 0;
+
+  entry = &dispatch_queue_cache[(dispatch_qaddr >> 3)
+                                % DISPATCH_QUEUE_CACHE_SLOTS];
+  if (entry->generation == target_stop_generation
+      && entry->dispatch_qaddr == dispatch_qaddr)
+    return entry;
+
+  if (safe_read_memory_unsigned_integer (dispatch_qaddr, wordsize,
+                                         &queue) == 0)
+    queue = 0;
+
+  memset (entry, 0, sizeof (struct dispatch_queue_cache_entry));
+  entry->dispatch_qaddr = dispatch_qaddr;
+  entry->generation = target_stop_generation;
+  entry->queue = queue;
+  return entry;
+}
+/* APPLE LOCAL end dispatch queue cache  */
+
 /* Return the address of the dispatch queue structure in memory - can be
    used by the UI to disambiguate between queues on multiple threads (same
    dispatch queue struct addr) and multiple queues on multiple threads with
@@ -691,13 +872,10 @@ read_dispatch_offsets ()
 static CORE_ADDR
 get_dispatch_queue_addr (CORE_ADDR dispatch_qaddr)
 {
-  ULONGEST queue = 0;
   if (dispatch_qaddr == 0)
     return 0;
-  int wordsize = TARGET_PTR_BIT / 8;
-  if (safe_read_memory_unsigned_integer (dispatch_qaddr, wordsize, &queue) != 0)
-    return queue;
-  return 0;
+  /* APPLE LOCAL dispatch queue cache  */
+  return dispatch_queue_cache_lookup (dispatch_qaddr)->queue;
 }
 
 /* Retrieve the libdispatch work queue name given the dispatch_qaddr
@@ -710,21 +888,55 @@ get_dispatch_queue_name (CORE_ADDR dispatch_qaddr)
 {
   static char namebuf[96];
   struct dispatch_offsets_info *dispatch_offsets = read_dispatch_offsets ();
-  int wordsize = TARGET_PTR_BIT / 8;
+  /* APPLE LOCAL dispatch queue cache  */
+  struct dispatch_queue_cache_entry *entry;
   ULONGEST queue;
 
   namebuf[0] = '\0';
 
-  if (dispatch_offsets->version > 3)
+  /* APPLE LOCAL begin thread state cache  */
+  if (dispatch_offsets == NULL || dispatch_offsets->version > 3)
     return NULL;
 
-  if (dispatch_qaddr != 0 
-      && dispatch_offsets != NULL
-      && safe_read_memory_unsigned_integer (dispatch_qaddr, wordsize,
-                                            &queue) != 0
-      && queue != 0)
+  /* APPLE LOCAL begin dispatch queue cache  */
+  if (dispatch_qaddr == 0)
+    return namebuf;
+  entry = dispatch_queue_cache_lookup (dispatch_qaddr);
+  if (entry->have_name)
+    {
+      if (entry->name_found)
+        strcpy (namebuf, entry->name);
+      return namebuf;
+    }
+  entry->have_name = 1;
+  queue = entry->queue;
+
+  if (queue != 0)
+    /* APPLE LOCAL end dispatch queue cache  */
     {
       char *queue_buf = NULL;
+      size_t len = sizeof (namebuf) - 1;
+
+      /* The label is stored inline in the queue, so try to get it with
+         one read rather than letting target_read_string fetch it a few
+         bytes at a time.  That read can fail if a short label sits
+         right at the end of a mapping; fall back for that case.  */
+      if (dispatch_offsets->label_size != 0
+          && dispatch_offsets->label_size < len)
+        len = dispatch_offsets->label_size;
+      if (target_read_memory (queue + dispatch_offsets->label_offset,
+                              (gdb_byte *) namebuf, len) == 0)
+        {
+          namebuf[len] = '\0';
+          /* APPLE LOCAL begin dispatch queue cache  */
+          strcpy (entry->name, namebuf);
+          entry->name_found = 1;
+          /* APPLE LOCAL end dispatch queue cache  */
+          return namebuf;
+        }
+      namebuf[0] = '\0';
+      /* APPLE LOCAL end thread state cache  */
+
       errno = 0;
       if (target_read_string (queue + dispatch_offsets->label_offset, 
                               &queue_buf, sizeof (namebuf) - 1, &errno) > 1
@@ -735,6 +947,10 @@ get_dispatch_queue_name (CORE_ADDR dispatch_qaddr)
         }
       if (queue_buf)
         xfree (queue_buf);
+      /* APPLE LOCAL begin dispatch queue cache  */
+      strcpy (entry->name, namebuf);
+      entry->name_found = 1;
+      /* APPLE LOCAL end dispatch queue cache  */
     }
   return namebuf;
 }
@@ -746,28 +962,33 @@ get_dispatch_queue_name (CORE_ADDR dispatch_qaddr)
 static int
 get_dispatch_queue_flags (CORE_ADDR dispatch_qaddr, uint32_t *flags)
 {
-  int wordsize = TARGET_PTR_BIT / 8;
   struct dispatch_offsets_info *dispatch_offsets = read_dispatch_offsets ();
-  ULONGEST queue;
+  /* APPLE LOCAL begin dispatch queue cache  */
+  struct dispatch_queue_cache_entry *entry;
   ULONGEST buf;
 
-  if (flags == NULL)
+  if (flags == NULL || dispatch_qaddr == 0 || dispatch_offsets == NULL)
     return 0;
 
-  if (dispatch_qaddr != 0
-      && dispatch_offsets != NULL
-      && safe_read_memory_unsigned_integer (dispatch_qaddr, wordsize,
-                                            &queue) != 0
-      && queue != 0
-      && safe_read_memory_unsigned_integer 
-                            (queue + dispatch_offsets->flags_offset, 
-                             dispatch_offsets->flags_size, &buf) != 0)
+  entry = dispatch_queue_cache_lookup (dispatch_qaddr);
+  if (!entry->have_flags)
     {
-      *flags = buf;
-      return 1;
+      entry->have_flags = 1;
+      if (entry->queue != 0
+          && safe_read_memory_unsigned_integer 
+                            (entry->queue + dispatch_offsets->flags_offset, 
+                             dispatch_offsets->flags_size, &buf) != 0)
+        {
+          entry->flags = buf;
+          entry->flags_found = 1;
+        }
     }
 
-  return 0;
+  if (!entry->flags_found)
+    return 0;
+  *flags = entry->flags;
+  return 1;
+  /* APPLE LOCAL end dispatch queue cache  */
 }
 
 static void
@@ -1089,22 +1310,35 @@ thread_resume_command (char *tidstr, int from_tty)
   MACH_CHECK_ERROR (kret);
 }
 
+/* APPLE LOCAL begin thread state cache  */
+/* qsort/bsearch comparison for the ptids in a struct ptid_list.  */
+
+static int
+compare_ptids (const void *a, const void *b)
+{
+  const ptid_t *pa = a;
+  const ptid_t *pb = b;
+
+  if (ptid_get_pid (*pa) != ptid_get_pid (*pb))
+    return ptid_get_pid (*pa) < ptid_get_pid (*pb) ? -1 : 1;
+  if (ptid_get_lwp (*pa) != ptid_get_lwp (*pb))
+    return ptid_get_lwp (*pa) < ptid_get_lwp (*pb) ? -1 : 1;
+  if (ptid_get_tid (*pa) != ptid_get_tid (*pb))
+    return ptid_get_tid (*pa) < ptid_get_tid (*pb) ? -1 : 1;
+  return 0;
+}
+
+/* DATA is a struct ptid_list whose ptids have been sorted with
+   compare_ptids.  */
+
 static int
 mark_dead_if_thread_is_gone (struct thread_info *tp, void *data)
 {
   struct ptid_list *ptids = (struct ptid_list *) data;
-  int i;
-  int found_it = 0;
 
-  for (i = 0; i < ptids->nthreads; i++)
-    {
-      if (ptid_equal(tp->ptid, ptids->ptids[i]))
-	{
-	  found_it = 1;
-	  break;
-	}      
-    }
-  if (!found_it)
+  if (bsearch (&tp->ptid, ptids->ptids, ptids->nthreads,
+               sizeof (ptid_t), compare_ptids) == NULL)
+/* APPLE LOCAL end thread state cache  */
     {
       tp->ptid = pid_to_ptid (-1);
     }
@@ -1147,7 +1381,14 @@ macosx_prune_threads (thread_array_t thread_list, unsigned int nthreads)
       MACH_CHECK_ERROR (kret);
     }
 
+  /* APPLE LOCAL begin thread state cache  */
+  /* Sort the live threads so that checking each of gdb's threads
+     against them doesn't go quadratic in processes with thousands of
+     threads.  */
+  qsort (ptid_list.ptids, nthreads, sizeof (ptid_t), compare_ptids);
   iterate_over_threads (mark_dead_if_thread_is_gone, &ptid_list);
+  xfree (ptid_list.ptids);
+  /* APPLE LOCAL end thread state cache  */
   prune_threads ();
 }
 
@@ -1214,6 +1455,10 @@ macosx_print_thread_details (struct ui_out *uiout, ptid_t ptid)
 void
 _initialize_threads ()
 {
+  /* APPLE LOCAL dispatch queue cache  */
+  dispatch_offsets_objfile_data
+    = register_objfile_data_with_cleanup (dispatch_offsets_objfile_freed);
+
 #if defined (TARGET_ARM)
   arm_macosx_tdep_inf_status.macosx_half_step_pc = (CORE_ADDR)-1;
 #endif
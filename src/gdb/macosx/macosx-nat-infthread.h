@@ -12,6 +12,9 @@ void prepare_threads_before_run (struct macosx_inferior_status *inferior,
 
 void prepare_threads_after_stop (struct macosx_inferior_status *inferior);
 
+/* APPLE LOCAL trace bit  */
+int macosx_thread_trace_bit_set_p (thread_t thread);
+
 char *unparse_run_state (int run_state);
 
 void macosx_setup_registers_before_hand_call (void);
@@ -38,6 +38,8 @@
 #include "dictionary.h"
 #include "block.h"
 #include "objc-lang.h"
+/* APPLE LOCAL malloc history cache  */
+#include "hashtab.h"
 
 #include <dlfcn.h>
 
@@ -125,6 +127,237 @@ child_get_pagesize ()
   return g_cached_child_page_size;
 }
 
+/* APPLE LOCAL begin stop memory cache  */
+/* While the task is suspended its memory can't change except through
+   us, so the pages mach_vm_read hands us during one stop are kept in
+   this small direct-mapped cache, and reads that fall entirely within
+   cached pages are answered without another trip into the kernel.
+   Bumping mach_page_cache_generation invalidates every slot at once;
+   that is done whenever the task is resumed (which includes hand
+   function calls), whenever we write to it, and when the inferior
+   goes away.
+
+   The cache is shared by every thread's backtrace during one stop,
+   so "thread apply all bt" on a task with many threads streams
+   thousands of distinct stack pages through it.  Keep it big enough
+   that the text and data pages the unwinders read for every thread
+   aren't evicted by aliasing stack pages; slots only get a buffer
+   once they are used.  */
+
+#define MACH_PAGE_CACHE_SLOTS 1024
+
+struct mach_page_cache_slot
+{
+  CORE_ADDR addr;
+  unsigned int generation;
+  gdb_byte *data;
+};
+
+static struct mach_page_cache_slot mach_page_cache[MACH_PAGE_CACHE_SLOTS];
+static unsigned int mach_page_cache_generation = 1;
+static int mach_page_cache_enabled = 1;
+
+/* Throw away everything in the page cache.  */
+
+void
+macosx_invalidate_memory_cache (void)
+{
+  mach_page_cache_generation++;
+  if (mach_page_cache_generation == 0)
+    {
+      int i;
+
+      /* Wrapped around; make sure no old slot looks current.  */
+      for (i = 0; i < MACH_PAGE_CACHE_SLOTS; i++)
+	mach_page_cache[i].generation = 0;
+      mach_page_cache_generation = 1;
+    }
+}
+
+/* We can only trust cached pages while the task is suspended.  */
+
+static int
+mach_page_cache_usable (void)
+{
+  return (mach_page_cache_enabled
+	  && macosx_status != NULL
+	  && macosx_status->suspend_count > 0);
+}
+
+static struct mach_page_cache_slot *
+mach_page_cache_slot (CORE_ADDR pageaddr, vm_size_t pagesize)
+{
+  return &mach_page_cache[(pageaddr / pagesize) % MACH_PAGE_CACHE_SLOTS];
+}
+
+/* Remember the PAGESIZE bytes at PAGE as the contents of the
+   inferior's page at PAGEADDR.  */
+
+static void
+mach_page_cache_fill (CORE_ADDR pageaddr, const gdb_byte *page,
+		      vm_size_t pagesize)
+{
+  struct mach_page_cache_slot *slot;
+
+  if (!mach_page_cache_usable ())
+    return;
+
+  slot = mach_page_cache_slot (pageaddr, pagesize);
+  if (slot->data == NULL)
+    slot->data = xmalloc (pagesize);
+  memcpy (slot->data, page, pagesize);
+  slot->addr = pageaddr;
+  slot->generation = mach_page_cache_generation;
+}
+
+/* If all LEN bytes at MEMADDR are in cached pages, copy them to MYADDR
+   and return 1.  Otherwise return 0.  */
+
+static int
+mach_page_cache_read (CORE_ADDR memaddr, gdb_byte *myaddr, int len)
+{
+  vm_size_t pagesize = child_get_pagesize ();
+  CORE_ADDR addr;
+  int done;
+
+  if (!mach_page_cache_usable () || pagesize == 0)
+    return 0;
+
+  /* Check first, so we don't copy anything for a partial hit.  */
+  for (addr = memaddr - (memaddr % pagesize); addr < memaddr + len;
+       addr += pagesize)
+    {
+      struct mach_page_cache_slot *slot
+	= mach_page_cache_slot (addr, pagesize);
+
+      if (slot->generation != mach_page_cache_generation
+	  || slot->addr != addr)
+	return 0;
+      if (addr + pagesize < addr)
+	break;
+    }
+
+  for (done = 0; done < len; )
+    {
+      CORE_ADDR cur = memaddr + done;
+      CORE_ADDR pageaddr = cur - (cur % pagesize);
+      struct mach_page_cache_slot *slot
+	= mach_page_cache_slot (pageaddr, pagesize);
+      int chunk = pagesize - (cur - pageaddr);
+
+      if (chunk > len - done)
+	chunk = len - done;
+      memcpy (myaddr + done, slot->data + (cur - pageaddr), chunk);
+      done += chunk;
+    }
+
+  return 1;
+}
+/* APPLE LOCAL end stop memory cache  */
+
+/* APPLE LOCAL begin thread state cache  */
+/* Like the page cache above, but for thread states: while the task is
+   suspended a thread's registers can only change through
+   macosx_thread_set_state, so each flavor thread_get_state hands us
+   is kept until the task is resumed.  Switching between threads for
+   "info threads" or "thread apply all bt" throws away the regcache
+   each time; with this the registers don't have to be fetched from the
+   kernel again when we come back to a thread.  */
+
+#define THREAD_STATE_CACHE_SLOTS 512
+
+struct thread_state_cache_slot
+{
+  thread_t thread;
+  thread_state_flavor_t flavor;
+  unsigned int generation;
+  mach_msg_type_number_t count;
+  mach_msg_type_number_t alloc;
+  natural_t *data;
+};
+
+static struct thread_state_cache_slot thread_state_cache[THREAD_STATE_CACHE_SLOTS];
+static unsigned int thread_state_cache_generation = 1;
+
+void
+macosx_invalidate_thread_state_cache (void)
+{
+  thread_state_cache_generation++;
+  if (thread_state_cache_generation == 0)
+    {
+      int i;
+
+      for (i = 0; i < THREAD_STATE_CACHE_SLOTS; i++)
+	thread_state_cache[i].generation = 0;
+      thread_state_cache_generation = 1;
+    }
+}
+
+static struct thread_state_cache_slot *
+thread_state_cache_slot (thread_t thread, thread_state_flavor_t flavor)
+{
+  unsigned long hash = (unsigned long) thread * 31 + (unsigned long) flavor;
+
+  hash ^= hash >> 9;
+  return &thread_state_cache[hash % THREAD_STATE_CACHE_SLOTS];
+}
+
+/* thread_get_state, answered from the cache if we can.  */
+
+kern_return_t
+macosx_thread_get_state (thread_t thread, thread_state_flavor_t flavor,
+			 thread_state_t state, mach_msg_type_number_t *count)
+{
+  struct thread_state_cache_slot *slot;
+  kern_return_t kret;
+
+  if (!mach_page_cache_usable ())
+    return thread_get_state (thread, flavor, state, count);
+
+  slot = thread_state_cache_slot (thread, flavor);
+  if (slot->generation == thread_state_cache_generation
+      && slot->thread == thread && slot->flavor == flavor
+      && slot->count <= *count)
+    {
+      memcpy (state, slot->data, slot->count * sizeof (natural_t));
+      *count = slot->count;
+      return KERN_SUCCESS;
+    }
+
+  kret = thread_get_state (thread, flavor, state, count);
+  if (kret != KERN_SUCCESS)
+    return kret;
+
+  if (slot->alloc < *count)
+    {
+      slot->data = xrealloc (slot->data, *count * sizeof (natural_t));
+      slot->alloc = *count;
+    }
+  memcpy (slot->data, state, *count * sizeof (natural_t));
+  slot->count = *count;
+  slot->thread = thread;
+  slot->flavor = flavor;
+  slot->generation = thread_state_cache_generation;
+  return KERN_SUCCESS;
+}
+
+/* thread_set_state, forgetting whatever we had cached for THREAD -
+   its flavors overlap, so all of them are dropped.  */
+
+kern_return_t
+macosx_thread_set_state (thread_t thread, thread_state_flavor_t flavor,
+			 thread_state_t state, mach_msg_type_number_t count)
+{
+  int i;
+
+  for (i = 0; i < THREAD_STATE_CACHE_SLOTS; i++)
+    if (thread_state_cache[i].thread == thread)
+      thread_state_cache[i].generation = 0;
+
+  return thread_set_state (thread, flavor, state, count);
+}
+/* APPLE LOCAL end thread state cache  */
+
 /* Copy LEN bytes to or from inferior's memory starting at MEMADDR
    to debugger memory starting at MYADDR.   Copy to inferior if
    WRITE is nonzero.
@@ -181,6 +414,9 @@ mach_xfer_memory_remainder (CORE_ADDR memaddr, gdb_byte *myaddr,
       
       memcpy (myaddr, ((unsigned char *) 0) + mempointer
               + (memaddr - pageaddr), len);
+      /* APPLE LOCAL stop memory cache  */
+      mach_page_cache_fill (pageaddr, ((gdb_byte *) 0) + mempointer,
+			    pagesize);
       kret = vm_deallocate (mach_task_self (), mempointer, memcopied);
       if (kret != KERN_SUCCESS)
 	{
@@ -290,6 +526,16 @@ mach_xfer_memory_block (CORE_ADDR memaddr, gdb_byte *myaddr,
           return 0;
         }
       memcpy (myaddr, ((unsigned char *) 0) + mempointer, len);
+      /* APPLE LOCAL begin stop memory cache  */
+      {
+	vm_size_t off;
+
+	for (off = 0; off < len; off += pagesize)
+	  mach_page_cache_fill (memaddr + off,
+				((gdb_byte *) 0) + mempointer + off,
+				pagesize);
+      }
+      /* APPLE LOCAL end stop memory cache  */
       kret = vm_deallocate (mach_task_self (), mempointer, memcopied);
       if (kret != KERN_SUCCESS)
         {
@@ -675,6 +921,13 @@ mach_xfer_memory (CORE_ADDR memaddr, gdb_byte *myaddr,
   
   CHECK_FATAL (myaddr != NULL);
   errno = 0;
+
+  /* APPLE LOCAL begin stop memory cache  */
+  if (write)
+    macosx_invalidate_memory_cache ();
+  else if (mach_page_cache_read (memaddr, myaddr, len))
+    return len;
+  /* APPLE LOCAL end stop memory cache  */
   
   /* check for case where memory available only at address greater than address specified */
   {
@@ -877,6 +1130,122 @@ mach_xfer_memory (CORE_ADDR memaddr, gdb_byte *myaddr,
 }
 
 
+/* APPLE LOCAL begin map target memory  */
+/* A mapping of inferior memory made by macosx_map_inferior_memory.  */
+
+struct macosx_memory_mapping
+{
+  mach_vm_address_t address;
+  mach_vm_size_t size;
+};
+
+/* Map the LEN bytes of inferior memory at ADDR read-only into our own
+   address space with mach_vm_remap, and return a pointer to them.
+   The mapping is copy-on-write, so nothing is copied unless the
+   inferior changes the pages while we hold it.  *HANDLE is set for
+   macosx_unmap_inferior_memory.  Returns NULL if any of the range
+   isn't mapped or readable in the inferior, in which case the caller
+   should read it the usual way.  */
+
+const gdb_byte *
+macosx_map_inferior_memory (CORE_ADDR addr, ULONGEST len, void **handle)
+{
+  vm_size_t pagesize = child_get_pagesize ();
+  mach_vm_address_t start = addr - (addr % pagesize);
+  mach_vm_address_t end = addr + len;
+  mach_vm_address_t local = 0;
+  vm_prot_t cur_protection, max_protection;
+  struct macosx_memory_mapping *mapping;
+  kern_return_t kret;
+
+  if (macosx_status == NULL || macosx_status->task == TASK_NULL
+      || len == 0 || end < addr)
+    return NULL;
+
+  if ((end % pagesize) != 0)
+    end += pagesize - (end % pagesize);
+
+  kret = mach_vm_remap (mach_task_self (), &local, end - start, 0,
+			VM_FLAGS_ANYWHERE, macosx_status->task, start,
+			TRUE, &cur_protection, &max_protection,
+			VM_INHERIT_NONE);
+  if (kret != KERN_SUCCESS)
+    {
+      mutils_debug
+	("Unable to remap region at 0x%s with length %lu from inferior: %s (0x%lx)
+",
+	 paddr_nz (start), (unsigned long) (end - start),
+	 MACH_ERROR_STRING (kret), (unsigned long) kret);
+      return NULL;
+    }
+
+  if ((cur_protection & VM_PROT_READ) == 0)
+    {
+      mach_vm_deallocate (mach_task_self (), local, end - start);
+      return NULL;
+    }
+
+  /* Make sure nothing in gdb writes through the mapping by accident.  */
+  mach_vm_protect (mach_task_self (), local, end - start, FALSE,
+		   VM_PROT_READ);
+
+  mapping = XMALLOC (struct macosx_memory_mapping);
+  mapping->address = local;
+  mapping->size = end - start;
+  *handle = mapping;
+
+  return ((const gdb_byte *) 0) + local + (addr - start);
+}
+
+/* Release a mapping made by macosx_map_inferior_memory.  */
+
+void
+macosx_unmap_inferior_memory (void *handle)
+{
+  struct macosx_memory_mapping *mapping = handle;
+  kern_return_t kret;
+
+  kret = mach_vm_deallocate (mach_task_self (), mapping->address,
+			     mapping->size);
+  if (kret != KERN_SUCCESS)
+    warning ("Unable to deallocate mapping of inferior memory: %s (0x%lx)",
+	     MACH_ERROR_STRING (kret), (unsigned long) kret);
+  xfree (mapping);
+}
+/* APPLE LOCAL end map target memory  */
+
+/* APPLE LOCAL begin memory ranges  */
+/* Read each of the NRANGES RANGES straight from the task, without
+   going back through the target stack for every one.  Ranges on pages
+   the stop memory cache already holds cost no Mach call at all.  */
+
+void
+macosx_read_memory_ranges (struct target_memory_range *ranges, int nranges)
+{
+  int i;
+
+  if (macosx_status == NULL || macosx_status->task == TASK_NULL)
+    return;
+
+  for (i = 0; i < nranges; i++)
+    {
+      int done = 0;
+
+      while (done < ranges[i].len)
+	{
+	  int got = mach_xfer_memory (ranges[i].addr + done,
+				      ranges[i].buf + done,
+				      ranges[i].len - done, 0, NULL, NULL);
+	  if (got <= 0)
+	    break;
+	  done += got;
+	}
+      if (done == ranges[i].len)
+	ranges[i].status = 0;
+    }
+}
+/* APPLE LOCAL end memory ranges  */
+
 LONGEST
 mach_xfer_partial (struct target_ops *ops,
 		   enum target_object object, const char *annex,
@@ -1229,6 +1598,216 @@ struct current_record_state
   vm_address_t block_address;
 };
 
+/* APPLE LOCAL begin malloc history cache  */
+/* A long stack log has many records for each uniqued stack, and the
+   same few thousand pcs show up in most of the stacks.  So for the
+   duration of one "info malloc-history" fetch each uniqued stack from
+   libc once, and symbolize each distinct pc once.  */
+
+struct malloc_history_stack
+{
+  uint64_t identifier;
+  unsigned num_frames;
+  CORE_ADDR *frames;
+};
+
+struct malloc_history_pc
+{
+  CORE_ADDR pc;
+
+  /* Nonzero if we couldn't raise the load level of PC's objfile.  */
+  int load_failed;
+
+  /* The function containing PC, and its file and line, or NULL if
+     they aren't known.  */
+  char *func;
+  char *file;
+  int line;
+};
+
+static htab_t malloc_history_stacks;
+static htab_t malloc_history_pcs;
+
+static hashval_t
+malloc_history_stack_hash (const void *p)
+{
+  const struct malloc_history_stack *stack = p;
+
+  return (hashval_t) (stack->identifier ^ (stack->identifier >> 32));
+}
+
+static int
+malloc_history_stack_eq (const void *p1, const void *p2)
+{
+  const struct malloc_history_stack *s1 = p1;
+  const struct malloc_history_stack *s2 = p2;
+
+  return s1->identifier == s2->identifier;
+}
+
+static void
+malloc_history_stack_del (void *p)
+{
+  struct malloc_history_stack *stack = p;
+
+  xfree (stack->frames);
+  xfree (stack);
+}
+
+static hashval_t
+malloc_history_pc_hash (const void *p)
+{
+  const struct malloc_history_pc *entry = p;
+
+  return (hashval_t) (entry->pc ^ (entry->pc >> 16));
+}
+
+static int
+malloc_history_pc_eq (const void *p1, const void *p2)
+{
+  const struct malloc_history_pc *e1 = p1;
+  const struct malloc_history_pc *e2 = p2;
+
+  return e1->pc == e2->pc;
+}
+
+static void
+malloc_history_pc_del (void *p)
+{
+  struct malloc_history_pc *entry = p;
+
+  xfree (entry->func);
+  xfree (entry->file);
+  xfree (entry);
+}
+
+static void
+malloc_history_create_tables (void)
+{
+  malloc_history_stacks = htab_create_alloc (1024, malloc_history_stack_hash,
+					     malloc_history_stack_eq,
+					     malloc_history_stack_del,
+					     xcalloc, xfree);
+  malloc_history_pcs = htab_create_alloc (4096, malloc_history_pc_hash,
+					  malloc_history_pc_eq,
+					  malloc_history_pc_del,
+					  xcalloc, xfree);
+}
+
+static void
+malloc_history_delete_tables (void *unused)
+{
+  if (malloc_history_stacks != NULL)
+    htab_delete (malloc_history_stacks);
+  malloc_history_stacks = NULL;
+  if (malloc_history_pcs != NULL)
+    htab_delete (malloc_history_pcs);
+  malloc_history_pcs = NULL;
+}
+
+/* Return the frames of the uniqued stack IDENTIFIER, asking libc for
+   them only the first time.  Returns NULL, after a warning, if libc
+   can't supply them.  */
+
+static struct malloc_history_stack *
+malloc_history_get_stack (uint64_t identifier)
+{
+#if HAVE_64_BIT_STACK_LOGGING
+  mach_vm_address_t frames[MAX_NUM_FRAMES];
+#elif HAVE_32_BIT_STACK_LOGGING
+  vm_address_t frames[MAX_NUM_FRAMES];
+#endif
+  struct malloc_history_stack key, *stack;
+  unsigned num_frames;
+  void **slot;
+  int i;
+
+  key.identifier = identifier;
+  slot = htab_find_slot (malloc_history_stacks, &key, INSERT);
+  if (*slot != NULL)
+    return *slot;
+
+#if HAVE_64_BIT_STACK_LOGGING
+  if (__mach_stack_logging_frames_for_uniqued_stack (macosx_status->task, 
+						     identifier,
+						     frames, MAX_NUM_FRAMES, &num_frames))
+#elif HAVE_32_BIT_STACK_LOGGING
+  if (stack_logging_frames_for_uniqued_stack (macosx_status->task, 
+					      gdb_malloc_reader, 
+					      (unsigned) identifier,
+					      frames, MAX_NUM_FRAMES, &num_frames))
+#endif
+    {
+      htab_clear_slot (malloc_history_stacks, slot);
+      warning ("Error running stack_logging_frames_for_uniqued_stack");
+      return NULL;
+    }
+
+  stack = xmalloc (sizeof (struct malloc_history_stack));
+  stack->identifier = identifier;
+  stack->num_frames = num_frames;
+  stack->frames = xmalloc ((num_frames + 1) * sizeof (CORE_ADDR));
+  for (i = 0; i < num_frames; i++)
+    stack->frames[i] = (CORE_ADDR) frames[i];
+  *slot = stack;
+  return stack;
+}
+
+/* Return what we know about PC, working it out the first time.  */
+
+static struct malloc_history_pc *
+malloc_history_symbolize (CORE_ADDR pc)
+{
+  struct malloc_history_pc key, *entry;
+  struct gdb_exception e;
+  struct symtab_and_line sal;
+  char *name;
+  int found = 0;
+  void **slot;
+
+  key.pc = pc;
+  slot = htab_find_slot (malloc_history_pcs, &key, INSERT);
+  if (*slot != NULL)
+    return *slot;
+
+  entry = xcalloc (1, sizeof (struct malloc_history_pc));
+  entry->pc = pc;
+  *slot = entry;
+
+  /* Since we're going to do pc->symbol, we should raise the load level
+     of the library involved before doing so.  */
+
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    {
+      pc_set_load_state (pc, OBJF_SYM_ALL, 1);
+    }
+  if (e.reason != NO_ERROR)
+    {
+      entry->load_failed = 1;
+      return entry;
+    }
+
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    {
+      found = find_pc_partial_function_no_inlined (pc, &name, NULL, NULL);
+    }
+  if (e.reason == NO_ERROR && found != 0 && name != NULL)
+    entry->func = xstrdup (name);
+
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    {
+      sal = find_pc_line (pc, 0);
+    }
+  if (e.reason == NO_ERROR && sal.symtab != 0)
+    {
+      entry->file = xstrdup (sal.symtab->filename);
+      entry->line = sal.line;
+    }
+
+  return entry;
+}
+/* APPLE LOCAL end malloc history cache  */
+
 /* This is the iterator function that libc uses in
    stack_logging_enumerate_records.  It calls this function for each
    uniqued stack that allocated a given address.  We just
@@ -1243,16 +1822,16 @@ struct current_record_state
 static void 
 do_over_unique_frames (mach_stack_logging_record_t record, void *data) 
 {
-  mach_vm_address_t frames[MAX_NUM_FRAMES];
 #elif HAVE_32_BIT_STACK_LOGGING
 static void 
 do_over_unique_frames (stack_logging_record_t record, void *data) 
 {
-  vm_address_t frames[MAX_NUM_FRAMES];
 #endif
+  /* APPLE LOCAL malloc history cache  */
+  struct malloc_history_stack *stack;
+  CORE_ADDR *frames;
   unsigned num_frames;
   struct cleanup *cleanup;
-  struct symtab_and_line sal;
   int i;
   CORE_ADDR thread;
   int final_return = 0;
@@ -1283,23 +1862,17 @@ do_over_unique_frames (stack_logging_record_t record, void *data)
 	return;
     }
 
+  /* APPLE LOCAL begin malloc history cache  */
 #if HAVE_64_BIT_STACK_LOGGING
-  if (__mach_stack_logging_frames_for_uniqued_stack (macosx_status->task, 
-						     record.stack_identifier,
-						     frames, MAX_NUM_FRAMES, &num_frames))
+  stack = malloc_history_get_stack (record.stack_identifier);
 #elif HAVE_32_BIT_STACK_LOGGING
-  if (stack_logging_frames_for_uniqued_stack (macosx_status->task, 
-					      gdb_malloc_reader, 
-					      record.uniqued_stack,
-					      frames, MAX_NUM_FRAMES, &num_frames))
+  stack = malloc_history_get_stack (record.uniqued_stack);
 #endif
-    {
-      warning ("Error running stack_logging_frames_for_uniqued_stack");
-      return;
-    }
-
-  if (num_frames == 0)
+  if (stack == NULL || stack->num_frames == 0)
     return;
+  frames = stack->frames;
+  num_frames = stack->num_frames;
+  /* APPLE LOCAL end malloc history cache  */
 
   /* The last element of the frame array always points to the result of pthread_self()
      (plus 1 for no apparent reason).  The second to the last element seems to
@@ -1339,9 +1912,8 @@ do_over_unique_frames (stack_logging_record_t record, void *data)
     {
       struct cleanup *frame_cleanup
 	= make_cleanup_ui_out_tuple_begin_end (uiout, "frame");
-      char *name;
-      int err = 0;
-      struct gdb_exception e;
+      /* APPLE LOCAL malloc history cache  */
+      struct malloc_history_pc *entry;
       /* This is cheesy spacing, but we really won't get
 	 more than 1000 frames, so more work would be overkill.  */
       if (i < 10)
@@ -1356,41 +1928,29 @@ do_over_unique_frames (stack_logging_record_t record, void *data)
 
       ui_out_field_fmt (uiout, "addr", "0x%s", paddr_nz (frames[i]));
 
-      /* Since we're going to do pc->symbol, we should raise the load level
-	 of the library involved before doing so.  */
-
-      TRY_CATCH (e, RETURN_MASK_ERROR)
-	{
-	  pc_set_load_state (frames[i], OBJF_SYM_ALL, 1);
-	}
-      if (e.reason != NO_ERROR)
+      /* APPLE LOCAL begin malloc history cache  */
+      entry = malloc_history_symbolize (frames[i]);
+      if (entry->load_failed)
 	{
 	  ui_out_text (uiout, "\n");
 	  warning ("Could not raise load level for objfile at pc: 0x%s.", paddr_nz (frames[i]));
 	  continue;
 	}
 
-      TRY_CATCH (e, RETURN_MASK_ERROR)
-	{
-	  err = find_pc_partial_function_no_inlined (frames[i], &name, NULL, NULL);
-	}
-      if (e.reason == NO_ERROR && err != 0)
+      if (entry->func != NULL)
 	{
 	  ui_out_text(uiout, " in ");
-	  ui_out_field_string (uiout, "func", name);
+	  ui_out_field_string (uiout, "func", entry->func);
 	}
 
-      TRY_CATCH (e, RETURN_MASK_ERROR)
-	{
-	  sal = find_pc_line (frames[i], 0);
-	}
-      if (e.reason == NO_ERROR && sal.symtab != 0)
+      if (entry->file != NULL)
 	{
 	  ui_out_text (uiout, " at ");
-	  ui_out_field_string (uiout, "file", sal.symtab->filename);
+	  ui_out_field_string (uiout, "file", entry->file);
 	  ui_out_text (uiout, ":");
-	  ui_out_field_int (uiout, "line", sal.line);
+	  ui_out_field_int (uiout, "line", entry->line);
 	}
+      /* APPLE LOCAL end malloc history cache  */
       ui_out_text (uiout, "\n");
       do_cleanups (frame_cleanup);
     }
@@ -1471,6 +2031,10 @@ malloc_history_info_command (char *arg, int from_tty)
 	       " so the malloc history will not be available.");
     }
   cleanup = make_cleanup_ui_out_list_begin_end (uiout, "stacks");
+  /* APPLE LOCAL begin malloc history cache  */
+  malloc_history_create_tables ();
+  make_cleanup (malloc_history_delete_tables, NULL);
+  /* APPLE LOCAL end malloc history cache  */
 
   if (exact)
     {
@@ -1740,6 +2304,369 @@ get_symbol_at_address_on_stack (CORE_ADDR stack_address, int *frame_level)
  found_symbol:
   return symbol_name;
 }
+/* APPLE LOCAL begin inferior helper  */
+/* Questions like "what class is this object" cost gdb a hand function
+   call each, and a hand function call means resuming the inferior.
+   When the user allows it, gdb loads a small helper library into the
+   inferior instead, writes a batch of such questions into a buffer the
+   helper owns, and has the helper answer them all in one call.  The
+   interface is described in macosx-nat-helper.h.  */
+
+static int use_inferior_helper = 0;
+static char *inferior_helper_library;
+
+#define INFERIOR_HELPER_LIBRARY "/usr/libexec/gdb/libgdbhelper.dylib"
+
+#define HELPER_RING_HEADER_SIZE 24
+#define HELPER_REQUEST_SIZE 40
+
+struct inferior_helper_state
+{
+  /* The process this describes.  */
+  int pid;
+
+  /* Set once we have failed to load or talk to the helper in PID, so
+     that we don't keep trying on every request.  */
+  int unavailable;
+
+  /* The helper's ring, and its size.  */
+  CORE_ADDR ring;
+  unsigned int ring_size;
+};
+
+static struct inferior_helper_state inferior_helper;
+
+static struct cached_value *helper_get_ring_fn;
+static struct cached_value *helper_run_batch_fn;
+
+struct inferior_helper_request
+{
+  enum gdb_helper_op op;
+  CORE_ADDR arg;
+
+  enum gdb_helper_status status;
+  CORE_ADDR result;
+  CORE_ADDR aux;
+  char *string;
+};
+
+struct inferior_helper_batch
+{
+  int count;
+  int allocated;
+  struct inferior_helper_request *requests;
+};
+
+static void
+set_inferior_helper_library (char *args, int from_tty,
+			     struct cmd_list_element *c)
+{
+  /* Give the new library a chance in the current process.  */
+  memset (&inferior_helper, 0, sizeof (inferior_helper));
+}
+
+/* Find the helper's ring in the current process, loading the helper
+   there first if need be.  Return 1 if the helper can be used.  */
+
+static int
+inferior_helper_setup (void)
+{
+  int pid = ptid_get_pid (inferior_ptid);
+  struct gdb_exception e;
+
+  if (!use_inferior_helper || !target_has_execution)
+    return 0;
+
+  if (inferior_helper.pid != pid)
+    {
+      memset (&inferior_helper, 0, sizeof (inferior_helper));
+      inferior_helper.pid = pid;
+    }
+
+  if (inferior_helper.unavailable)
+    return 0;
+  if (inferior_helper.ring != 0)
+    return 1;
+
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    {
+      struct cleanup *cleanup;
+      struct value *ring_val;
+      gdb_byte header[HELPER_RING_HEADER_SIZE];
+      CORE_ADDR ring;
+      unsigned int size;
+
+      if (lookup_minimal_symbol (GDB_HELPER_RUN_BATCH_FUNCTION, 0, 0) == NULL)
+	macosx_dlopen (inferior_helper_library, "RTLD_NOW|RTLD_LOCAL");
+
+      if (lookup_minimal_symbol (GDB_HELPER_GET_RING_FUNCTION, 0, 0) == NULL
+	  || lookup_minimal_symbol (GDB_HELPER_RUN_BATCH_FUNCTION, 0, 0) == NULL)
+	error ("\"%s\" doesn't define the helper functions.",
+	       inferior_helper_library);
+
+      if (helper_get_ring_fn == NULL)
+	helper_get_ring_fn
+	  = create_cached_function (GDB_HELPER_GET_RING_FUNCTION,
+				    builtin_type_voidptrfuncptr);
+      if (helper_run_batch_fn == NULL)
+	helper_run_batch_fn
+	  = create_cached_function (GDB_HELPER_RUN_BATCH_FUNCTION,
+				    lookup_pointer_type
+				      (lookup_function_type (builtin_type_int)));
+      if (helper_get_ring_fn == NULL || helper_run_batch_fn == NULL)
+	error ("Couldn't look up the helper functions.");
+
+      cleanup = make_cleanup_set_restore_unwind_on_signal (1);
+      make_cleanup_set_restore_scheduler_locking_mode (scheduler_locking_on);
+      ring_val
+	= call_function_by_hand (lookup_cached_function (helper_get_ring_fn),
+				 0, NULL);
+      do_cleanups (cleanup);
+
+      ring = value_as_address (ring_val);
+      if (ring == 0)
+	error ("%s returned NULL.", GDB_HELPER_GET_RING_FUNCTION);
+
+      read_memory (ring, header, sizeof (header));
+      if (extract_unsigned_integer (header, 4) != GDB_HELPER_RING_MAGIC)
+	error ("The helper's ring at %s is corrupt.", paddr_nz (ring));
+      if (extract_unsigned_integer (header + 4, 4) != GDB_HELPER_RING_VERSION)
+	error ("The helper speaks version %d of the protocol, not %d.",
+	       (int) extract_unsigned_integer (header + 4, 4),
+	       GDB_HELPER_RING_VERSION);
+
+      size = extract_unsigned_integer (header + 8, 4);
+      if (size < HELPER_RING_HEADER_SIZE + 2 * HELPER_REQUEST_SIZE)
+	error ("The helper's ring is too small.");
+
+      inferior_helper.ring = ring;
+      inferior_helper.ring_size = size;
+    }
+  if (e.reason != NO_ERROR)
+    {
+      warning ("Couldn't use the inferior helper \"%s\": %s",
+	       inferior_helper_library, e.message);
+      inferior_helper.unavailable = 1;
+      return 0;
+    }
+
+  return 1;
+}
+
+int
+inferior_helper_available_p (void)
+{
+  return inferior_helper_setup ();
+}
+
+struct inferior_helper_batch *
+inferior_helper_batch_new (void)
+{
+  return xcalloc (1, sizeof (struct inferior_helper_batch));
+}
+
+void
+inferior_helper_batch_free (struct inferior_helper_batch *batch)
+{
+  int i;
+
+  if (batch == NULL)
+    return;
+  for (i = 0; i < batch->count; i++)
+    xfree (batch->requests[i].string);
+  xfree (batch->requests);
+  xfree (batch);
+}
+
+static void
+inferior_helper_batch_free_cleanup (void *batch)
+{
+  inferior_helper_batch_free (batch);
+}
+
+struct cleanup *
+make_cleanup_inferior_helper_batch_free (struct inferior_helper_batch *batch)
+{
+  return make_cleanup (inferior_helper_batch_free_cleanup, batch);
+}
+
+/* Queue a request for OP on ARG, and return its index in BATCH.  */
+
+int
+inferior_helper_batch_add (struct inferior_helper_batch *batch,
+			   enum gdb_helper_op op, CORE_ADDR arg)
+{
+  struct inferior_helper_request *req;
+
+  if (batch->count == batch->allocated)
+    {
+      batch->allocated = batch->allocated ? 2 * batch->allocated : 32;
+      batch->requests
+	= xrealloc (batch->requests,
+		    batch->allocated * sizeof (struct inferior_helper_request));
+    }
+
+  req = &batch->requests[batch->count];
+  memset (req, 0, sizeof (struct inferior_helper_request));
+  req->op = op;
+  req->arg = arg;
+  req->status = GDB_HELPER_STATUS_UNANSWERED;
+  return batch->count++;
+}
+
+/* Send requests FIRST through FIRST + COUNT - 1 of BATCH to the helper
+   in one call, and read back the answers.  */
+
+static void
+inferior_helper_run_chunk (struct inferior_helper_batch *batch,
+			   int first, int count)
+{
+  unsigned int ring_size = inferior_helper.ring_size;
+  unsigned int strings_offset, strings_used;
+  CORE_ADDR ring = inferior_helper.ring;
+  struct cleanup *cleanup;
+  struct value *arg;
+  const gdb_byte *answers;
+  gdb_byte *buf;
+  void *handle = NULL;
+  int i;
+
+  strings_offset = HELPER_RING_HEADER_SIZE + count * HELPER_REQUEST_SIZE;
+
+  buf = xcalloc (1, ring_size);
+  cleanup = make_cleanup (xfree, buf);
+
+  store_unsigned_integer (buf, 4, GDB_HELPER_RING_MAGIC);
+  store_unsigned_integer (buf + 4, 4, GDB_HELPER_RING_VERSION);
+  store_unsigned_integer (buf + 8, 4, ring_size);
+  store_unsigned_integer (buf + 12, 4, count);
+  store_unsigned_integer (buf + 16, 4, strings_offset);
+  store_unsigned_integer (buf + 20, 4, 0);
+  for (i = 0; i < count; i++)
+    {
+      gdb_byte *p = buf + HELPER_RING_HEADER_SIZE + i * HELPER_REQUEST_SIZE;
+
+      store_unsigned_integer (p, 4, batch->requests[first + i].op);
+      store_unsigned_integer (p + 4, 4, GDB_HELPER_STATUS_UNANSWERED);
+      store_unsigned_integer (p + 8, 8, batch->requests[first + i].arg);
+    }
+  write_memory (ring, buf, strings_offset);
+
+  arg = value_from_pointer (builtin_type_void_data_ptr, ring);
+  make_cleanup_set_restore_unwind_on_signal (1);
+  make_cleanup_set_restore_scheduler_locking_mode (scheduler_locking_on);
+  make_cleanup_set_restore_debugger_mode (NULL, 0);
+  call_function_by_hand (lookup_cached_function (helper_run_batch_fn),
+			 1, &arg);
+
+  /* Take the answers straight out of the inferior's pages if we can,
+     otherwise copy the part of the ring that was used.  */
+  answers = target_map_memory (ring, ring_size, &handle);
+  if (answers == NULL)
+    {
+      read_memory (ring, buf, strings_offset);
+      strings_used = extract_unsigned_integer (buf + 20, 4);
+      if (strings_used > ring_size - strings_offset)
+	strings_used = ring_size - strings_offset;
+      if (strings_used > 0)
+	read_memory (ring + strings_offset, buf + strings_offset,
+		     strings_used);
+      answers = buf;
+    }
+  else
+    {
+      strings_used = extract_unsigned_integer (answers + 20, 4);
+      if (strings_used > ring_size - strings_offset)
+	strings_used = ring_size - strings_offset;
+    }
+
+  for (i = 0; i < count; i++)
+    {
+      const gdb_byte *p
+	= answers + HELPER_RING_HEADER_SIZE + i * HELPER_REQUEST_SIZE;
+      struct inferior_helper_request *req = &batch->requests[first + i];
+      unsigned int offset, length;
+
+      req->status = extract_unsigned_integer (p + 4, 4);
+      if (req->status != GDB_HELPER_STATUS_OK)
+	continue;
+      req->result = extract_unsigned_integer (p + 16, 8);
+      req->aux = extract_unsigned_integer (p + 24, 8);
+
+      offset = extract_unsigned_integer (p + 32, 4);
+      length = extract_unsigned_integer (p + 36, 4);
+      if (length > 0 && offset >= strings_offset
+	  && offset - strings_offset < strings_used
+	  && length <= strings_used - (offset - strings_offset))
+	req->string = savestring ((const char *) answers + offset, length);
+    }
+
+  if (handle != NULL)
+    target_unmap_memory (handle);
+  do_cleanups (cleanup);
+}
+
+/* Have the helper answer every request queued in BATCH, in as few
+   calls as will fit through its ring.  Return the number of requests
+   answered, or -1 if the helper can't be used, in which case the
+   caller should fall back on asking one question at a time.  */
+
+int
+inferior_helper_batch_run (struct inferior_helper_batch *batch)
+{
+  struct gdb_exception e;
+  int chunk, first, answered;
+
+  if (batch->count == 0)
+    return 0;
+  if (!inferior_helper_setup ())
+    return -1;
+
+  /* Leave at least half of the ring for the strings that come back.  */
+  chunk = (inferior_helper.ring_size - HELPER_RING_HEADER_SIZE)
+	  / (2 * HELPER_REQUEST_SIZE);
+
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    {
+      for (first = 0; first < batch->count; first += chunk)
+	inferior_helper_run_chunk (batch, first,
+				   min (chunk, batch->count - first));
+    }
+  if (e.reason != NO_ERROR)
+    {
+      warning ("The inferior helper failed: %s", e.message);
+      inferior_helper.unavailable = 1;
+    }
+
+  answered = 0;
+  for (first = 0; first < batch->count; first++)
+    if (batch->requests[first].status == GDB_HELPER_STATUS_OK)
+      answered++;
+  return answered;
+}
+
+/* Return the answer to request INDEX of BATCH, after it has been run.
+   Returns 0 if the helper couldn't answer it.  */
+
+int
+inferior_helper_batch_result (struct inferior_helper_batch *batch, int index,
+			      CORE_ADDR *result, CORE_ADDR *aux,
+			      const char **string)
+{
+  struct inferior_helper_request *req = &batch->requests[index];
+
+  if (req->status != GDB_HELPER_STATUS_OK)
+    return 0;
+  if (result != NULL)
+    *result = req->result;
+  if (aux != NULL)
+    *aux = req->aux;
+  if (string != NULL)
+    *string = req->string;
+  return 1;
+}
+/* APPLE LOCAL end inferior helper  */
+
 /* This stuff all comes from auto_gdb_interface.h */
 #define AUTO_BLOCK_GLOBAL       0
 #define AUTO_BLOCK_STACK        1
@@ -1749,11 +2676,188 @@ get_symbol_at_address_on_stack (CORE_ADDR stack_address, int *frame_level)
 
 static char *auto_kind_strings[5] = {"global", "stack", "object", "bytes", "assoc"};
 static char *auto_kind_spacer[5] = {"", " ", "", " ", " "};
+
+/* APPLE LOCAL begin gc tracing bulk reads  */
+/* Each entry of an auto_memory_reference_list is an address and an
+   offset, each a word, then a 4-byte kind and a 4-byte retain count.  */
+
+#define GC_REFERENCE_SIZE(wordsize) (2 * (wordsize) + 8)
+
+/* The same stack slots turn up under many roots, and finding the
+   variable at a stack address means walking the frames and evaluating
+   every local of the one it is in.  So while a tracing command runs,
+   remember what was found for each stack address.  Hand-called
+   functions leave the stack as they found it, so the answers hold for
+   the whole command.  */
+
+struct gc_stack_symbol
+{
+  CORE_ADDR address;
+  int frame_level;
+  char *symbol_name;
+};
+
+static htab_t gc_stack_symbols;
+
+static hashval_t
+gc_stack_symbol_hash (const void *p)
+{
+  const struct gc_stack_symbol *entry = p;
+
+  return (hashval_t) (entry->address ^ (entry->address >> 16));
+}
+
+static int
+gc_stack_symbol_eq (const void *p1, const void *p2)
+{
+  const struct gc_stack_symbol *e1 = p1;
+  const struct gc_stack_symbol *e2 = p2;
+
+  return e1->address == e2->address;
+}
+
+static void
+gc_stack_symbol_del (void *p)
+{
+  struct gc_stack_symbol *entry = p;
+
+  xfree (entry->symbol_name);
+  xfree (entry);
+}
+
+static void
+gc_stack_symbols_delete (void *unused)
+{
+  if (gc_stack_symbols != NULL)
+    htab_delete (gc_stack_symbols);
+  gc_stack_symbols = NULL;
+}
+
+/* Set up the table for one tracing command, and return a cleanup that
+   frees it.  */
+
+static struct cleanup *
+make_cleanup_gc_stack_symbols (void)
+{
+  gc_stack_symbols = htab_create_alloc (64, gc_stack_symbol_hash,
+					gc_stack_symbol_eq,
+					gc_stack_symbol_del,
+					xcalloc, xfree);
+  return make_cleanup (gc_stack_symbols_delete, NULL);
+}
+
+/* As get_symbol_at_address_on_stack, but answering from the table when
+   STACK_ADDRESS has been seen before.  */
+
+static char *
+gc_symbol_at_address_on_stack (CORE_ADDR stack_address, int *frame_level)
+{
+  struct gc_stack_symbol key, *entry;
+  void **slot;
+
+  if (gc_stack_symbols == NULL)
+    return get_symbol_at_address_on_stack (stack_address, frame_level);
+
+  key.address = stack_address;
+  slot = htab_find_slot (gc_stack_symbols, &key, INSERT);
+  entry = *slot;
+  if (entry == NULL)
+    {
+      entry = xmalloc (sizeof (struct gc_stack_symbol));
+      entry->address = stack_address;
+      entry->symbol_name
+	= get_symbol_at_address_on_stack (stack_address, &entry->frame_level);
+      *slot = entry;
+    }
+
+  *frame_level = entry->frame_level;
+  return entry->symbol_name != NULL ? xstrdup (entry->symbol_name) : NULL;
+}
+/* APPLE LOCAL end gc tracing bulk reads  */
+
+/* APPLE LOCAL begin inferior helper  */
+/* Before printing the NUM_REFS references in REFS, a copy of the
+   reference list read from the inferior, have the inferior helper look
+   up the classes of all the objects among them in one go, so that
+   printing each one finds its class in the ObjC caches rather than
+   calling into the inferior.  */
+
+static void
+gc_prefetch_object_classes (const gdb_byte *refs, LONGEST num_refs,
+			    int wordsize)
+{
+  struct inferior_helper_batch *batch;
+  struct cleanup *cleanup;
+  /* APPLE LOCAL gc tracing bulk reads  */
+  int entry_size = GC_REFERENCE_SIZE (wordsize);
+  CORE_ADDR *isas;
+  LONGEST i;
+
+  if (num_refs <= 0 || !inferior_helper_available_p ())
+    return;
+
+  isas = xmalloc (num_refs * sizeof (CORE_ADDR));
+  cleanup = make_cleanup (xfree, isas);
+  batch = inferior_helper_batch_new ();
+  make_cleanup_inferior_helper_batch_free (batch);
+
+  for (i = 0; i < num_refs; i++)
+    {
+      const gdb_byte *p = refs + i * entry_size;
+      CORE_ADDR address = extract_unsigned_integer (p, wordsize);
+      ULONGEST kind = extract_unsigned_integer (p + 2 * wordsize, 4);
+      CORE_ADDR isa = 0;
+      struct gdb_exception e;
+      int j, index;
+
+      if ((kind != AUTO_BLOCK_OBJECT && kind != AUTO_BLOCK_ASSOCIATION)
+	  || address == 0)
+	continue;
+
+      TRY_CATCH (e, RETURN_MASK_ERROR)
+	{
+	  isa = objc_object_isa_needing_lookup (address);
+	}
+      if (e.reason != NO_ERROR || isa == 0)
+	continue;
+
+      /* One question per class is enough.  */
+      for (j = 0; j < batch->count; j++)
+	if (isas[j] == isa)
+	  break;
+      if (j < batch->count)
+	continue;
+
+      index = inferior_helper_batch_add (batch, GDB_HELPER_OP_OBJC_CLASS,
+					 address);
+      isas[index] = isa;
+    }
+
+  if (inferior_helper_batch_run (batch) > 0)
+    for (i = 0; i < batch->count; i++)
+      {
+	CORE_ADDR real_class;
+	const char *class_name;
+
+	if (inferior_helper_batch_result (batch, i, &real_class, NULL,
+					  &class_name))
+	  objc_remember_object_class (isas[i], real_class, class_name);
+      }
+
+  do_cleanups (cleanup);
+}
+/* APPLE LOCAL end inferior helper  */
+
 static CORE_ADDR
 gc_print_references (CORE_ADDR list_addr, int wordsize)
 {
   int ref_index;
   LONGEST num_refs;
+  /* APPLE LOCAL begin gc tracing bulk reads  */
+  int entry_size = GC_REFERENCE_SIZE (wordsize);
+  struct cleanup *refs_cleanup;
+  gdb_byte *refs = NULL;
+  /* APPLE LOCAL end gc tracing bulk reads  */
 
   if (safe_read_memory_integer (list_addr, 4, &num_refs) == 0)
     error ("Could not read number of references at %s",
@@ -1769,6 +2873,23 @@ gc_print_references (CORE_ADDR list_addr, int wordsize)
        reading a 4-byte integer out of the struct.  */
 
   list_addr += wordsize;
+
+  /* APPLE LOCAL begin gc tracing bulk reads  */
+  /* Read the whole list in one go rather than field by field.  */
+  if (num_refs > 0)
+    {
+      refs = xmalloc (num_refs * entry_size);
+      refs_cleanup = make_cleanup (xfree, refs);
+      if (target_read_memory (list_addr, refs, num_refs * entry_size) != 0)
+	error ("Could not read the %d references at %s.",
+	       (int) num_refs, paddr_nz (list_addr));
+    }
+  else
+    refs_cleanup = make_cleanup (null_cleanup, NULL);
+
+  /* APPLE LOCAL inferior helper  */
+  gc_prefetch_object_classes (refs, num_refs, wordsize);
+  /* APPLE LOCAL end gc tracing bulk reads  */
   //ui_out_field_int (uiout, "depth", num_refs);
   //ui_out_text (uiout, "\n");
 
@@ -1779,25 +2900,17 @@ gc_print_references (CORE_ADDR list_addr, int wordsize)
       ULONGEST address;
       ULONGEST kind;
       ULONGEST retain_cnt;
+      /* APPLE LOCAL gc tracing bulk reads  */
+      const gdb_byte *p = refs + ref_index * entry_size;
       
       ref_cleanup = make_cleanup_ui_out_tuple_begin_end (uiout, "reference");
       
-      if (safe_read_memory_unsigned_integer (list_addr, wordsize, &address) == 0)
-	error ("Could not read address and reference %d at %s.",
-	       ref_index, paddr_nz (list_addr));
-      list_addr += wordsize;
-      if (safe_read_memory_integer (list_addr, wordsize, &offset) == 0)
-	error ("Could not read offset and reference %d at %s.",
-	       ref_index, paddr_nz (list_addr));
-      list_addr += wordsize;
-      if (safe_read_memory_unsigned_integer (list_addr, 4, &kind) == 0)
-	error ("Could not read kind and reference %d at %s.",
-	       ref_index, paddr_nz (list_addr));
-      list_addr += 4;
-      if (safe_read_memory_unsigned_integer (list_addr, 4, &retain_cnt) == 0)
-	error ("Could not read retainCount and reference %d at %s.",
-	       ref_index, paddr_nz (list_addr));
-      list_addr += 4;
+      /* APPLE LOCAL begin gc tracing bulk reads  */
+      address = extract_unsigned_integer (p, wordsize);
+      offset = extract_signed_integer (p + wordsize, wordsize);
+      kind = extract_unsigned_integer (p + 2 * wordsize, 4);
+      retain_cnt = extract_unsigned_integer (p + 2 * wordsize + 4, 4);
+      /* APPLE LOCAL end gc tracing bulk reads  */
       
       if (ref_index < 10)
 	ui_out_text (uiout, "   ");
@@ -1837,7 +2950,9 @@ gc_print_references (CORE_ADDR list_addr, int wordsize)
 	  ui_out_text (uiout, "  Address: ");
 	  ui_out_field_core_addr (uiout, "address", stack_address);
 
-	  symbol_name = get_symbol_at_address_on_stack (stack_address, &frame_level);
+	  /* APPLE LOCAL gc tracing bulk reads  */
+	  symbol_name = gc_symbol_at_address_on_stack (stack_address,
+						       &frame_level);
 
 	  if (frame_level >= 0)
 	    {
@@ -1979,6 +3094,11 @@ gc_print_references (CORE_ADDR list_addr, int wordsize)
       
       do_cleanups (ref_cleanup);
     }
+  /* APPLE LOCAL begin gc tracing bulk reads  */
+  do_cleanups (refs_cleanup);
+  if (num_refs > 0)
+    list_addr += num_refs * entry_size;
+  /* APPLE LOCAL end gc tracing bulk reads  */
   return list_addr;
 }
 
@@ -2102,6 +3222,8 @@ gc_root_tracing_command (char *arg, int from_tty)
 	   paddr_nz (list_addr));
 
   cleanup_chain = make_cleanup_ui_out_tuple_begin_end (uiout, "roots");
+  /* APPLE LOCAL gc tracing bulk reads  */
+  make_cleanup_gc_stack_symbols ();
   ui_out_text (uiout, "Number of roots: ");
   ui_out_field_int (uiout, "num_roots", num_roots);
 
@@ -2216,7 +3338,11 @@ gc_reference_tracing_command (char *arg, int from_tty)
     error ("Could not read the reference list at address: %s.",
 	   paddr_nz (list_addr));
 
+  /* APPLE LOCAL begin gc tracing bulk reads  */
+  cleanup_chain = make_cleanup_gc_stack_symbols ();
   list_addr = gc_print_references (list_addr, wordsize);
+  do_cleanups (cleanup_chain);
+  /* APPLE LOCAL end gc tracing bulk reads  */
       
   if (num_refs > 0)
     gc_free_data (ref_list_val);
@@ -2234,6 +3360,37 @@ Show if printing inferior memory debugging statements."), NULL,
 			   NULL, NULL,
 			   &setdebuglist, &showdebuglist);
 
+  /* APPLE LOCAL stop memory cache  */
+  add_setshow_boolean_cmd ("mach-memory-cache", class_obscure,
+			   &mach_page_cache_enabled, _("\
+Set if GDB should cache inferior memory pages while the inferior is stopped."), _("\
+Show if GDB should cache inferior memory pages while the inferior is stopped."), _("\
+When on, pages read from a stopped inferior are kept until it is next\n\
+resumed or written to, and reads within them don't call into the kernel."),
+			   NULL, NULL,
+			   &setlist, &showlist);
+
+  /* APPLE LOCAL begin inferior helper  */
+  add_setshow_boolean_cmd ("inferior-helper", class_obscure,
+			   &use_inferior_helper, _("\
+Set if GDB should load a helper library into the inferior for bulk queries."), _("\
+Show if GDB should load a helper library into the inferior for bulk queries."), _("\
+When on, commands that need to ask the inferior many questions, like\n\
+\"info gc-references\" looking up the class of each object, load the\n\
+library named by \"set inferior-helper-library\" and ask them all in\n\
+one function call instead of one call per question."),
+			   NULL, NULL,
+			   &setlist, &showlist);
+
+  inferior_helper_library = xstrdup (INFERIOR_HELPER_LIBRARY);
+  add_setshow_filename_cmd ("inferior-helper-library", class_obscure,
+			    &inferior_helper_library, _("\
+Set the helper library GDB loads into the inferior for bulk queries."), _("\
+Show the helper library GDB loads into the inferior for bulk queries."), NULL,
+			    set_inferior_helper_library, NULL,
+			    &setlist, &showlist);
+  /* APPLE LOCAL end inferior helper  */
+
   add_info ("malloc-history", malloc_history_info_command, 
 	    "List the stack(s) where malloc or free occurred for the address\n"
 	    "resulting from expression given in the argument to the command.\n"
@@ -27,6 +27,31 @@ mach_xfer_partial (struct target_ops *ops,
 		   gdb_byte *readbuf, const gdb_byte *writebuf,
 		   ULONGEST offset, LONGEST len);
 
+/* APPLE LOCAL stop memory cache  */
+void macosx_invalidate_memory_cache (void);
+
+/* APPLE LOCAL begin thread state cache  */
+void macosx_invalidate_thread_state_cache (void);
+kern_return_t macosx_thread_get_state (thread_t thread,
+				       thread_state_flavor_t flavor,
+				       thread_state_t state,
+				       mach_msg_type_number_t *count);
+kern_return_t macosx_thread_set_state (thread_t thread,
+				       thread_state_flavor_t flavor,
+				       thread_state_t state,
+				       mach_msg_type_number_t count);
+/* APPLE LOCAL end thread state cache  */
+
+/* APPLE LOCAL begin map target memory  */
+const gdb_byte *macosx_map_inferior_memory (CORE_ADDR addr, ULONGEST len,
+					    void **handle);
+void macosx_unmap_inferior_memory (void *handle);
+/* APPLE LOCAL end map target memory  */
+
+/* APPLE LOCAL memory ranges  */
+void macosx_read_memory_ranges (struct target_memory_range *ranges,
+				int nranges);
+
 int macosx_port_valid (mach_port_t port);
 int macosx_task_valid (task_t task);
 int macosx_thread_valid (task_t task, thread_t thread);
@@ -41,6 +66,24 @@ extern int call_ptrace (int, int, PTRACE_ARG3_TYPE, int);
 
 CORE_ADDR macosx_allocate_space_in_inferior (int len);
 
+/* APPLE LOCAL begin inferior helper  */
+#include "macosx-nat-helper.h"
+
+struct inferior_helper_batch;
+
+int inferior_helper_available_p (void);
+struct inferior_helper_batch *inferior_helper_batch_new (void);
+void inferior_helper_batch_free (struct inferior_helper_batch *batch);
+struct cleanup *make_cleanup_inferior_helper_batch_free
+  (struct inferior_helper_batch *batch);
+int inferior_helper_batch_add (struct inferior_helper_batch *batch,
+			       enum gdb_helper_op op, CORE_ADDR arg);
+int inferior_helper_batch_run (struct inferior_helper_batch *batch);
+int inferior_helper_batch_result (struct inferior_helper_batch *batch,
+				  int index, CORE_ADDR *result,
+				  CORE_ADDR *aux, const char **string);
+/* APPLE LOCAL end inferior helper  */
+
 #if HAVE_64_BIT_STACK_LOGGING
 void macosx_clear_logging_path ();
 #endif
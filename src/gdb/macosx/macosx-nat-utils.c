@@ -54,6 +54,8 @@
 #include <CoreFoundation/CFURLAccess.h>
 #include <CoreFoundation/CFPropertyList.h>
 #include "macosx-nat-utils.h"
+/* APPLE LOCAL hand call fast path  */
+#include "infcall.h"
 #include "macosx-nat-dyld.h"
 
 static const char *make_info_plist_path (const char *bundle, 
@@ -550,9 +552,8 @@ static char *macosx_unsafe_regexes[] = {"(^(m|c|re|v)?alloca*)|(::[^ ]*allocator
 					"(_class_lookup)|(^objc_lookUpClass)|(^look_up_class)",
                                         "(^__spin_lock)|(^pthread_mutex_lock)|(^pthread_mutex_unlock)|(^__spin_unlock)"};
 
-/* This is the Mac OS X implementation of target_check_safe_call.  */
-int
-macosx_check_safe_call (int which, enum check_which_threads thread_mode)
+static int
+macosx_check_safe_call_1 (int which, enum check_which_threads thread_mode)
 {
   int retval = 1;
   regex_t unsafe_patterns[LAST_SUBSYSTEM_INDEX];
@@ -757,6 +758,47 @@ macosx_check_safe_call (int which, enum check_which_threads thread_mode)
   return retval;
 }
 
+/* APPLE LOCAL begin hand call fast path  */
+/* The subsystems macosx_check_safe_call_1 has found safe to call into
+   during the stop SAFE_CALL_CACHE_STOP_ID, indexed by the thread mode
+   and whether the scheduler was locked.  Only answers of "safe" are
+   remembered, so that a refusal is always reported.  */
+
+static unsigned int safe_call_cache_stop_id;
+static int safe_call_cache[2 * (CHECK_ALL_THREADS + 1)];
+
+/* This is the Mac OS X implementation of target_check_safe_call.
+   While hand_call_stop_id says the other threads haven't run since the
+   stop, the threads' stacks and the locks they hold can't have changed
+   either, so a subsystem found safe once stays safe.  */
+
+int
+macosx_check_safe_call (int which, enum check_which_threads thread_mode)
+{
+  unsigned int stop_id = hand_call_stop_id ();
+  int slot = 2 * thread_mode + (scheduler_lock_on_p () ? 1 : 0);
+  int retval;
+
+  if (stop_id != 0 && stop_id == safe_call_cache_stop_id
+      && (safe_call_cache[slot] & which) == which)
+    return 1;
+
+  retval = macosx_check_safe_call_1 (which, thread_mode);
+
+  if (retval == 1 && stop_id != 0 && stop_id == hand_call_stop_id ())
+    {
+      if (safe_call_cache_stop_id != stop_id)
+	{
+	  memset (safe_call_cache, 0, sizeof (safe_call_cache));
+	  safe_call_cache_stop_id = stop_id;
+	}
+      safe_call_cache[slot] |= which;
+    }
+
+  return retval;
+}
+/* APPLE LOCAL end hand call fast path  */
+
 
 #ifndef RTLD_LAZY
 
@@ -774,8 +816,14 @@ macosx_check_safe_call (int which, enum check_which_threads thread_mode)
 
 static struct cached_value *dlerror_function;
 
+/* APPLE LOCAL begin inferior helper  */
+/* Load the dylib NAME into the inferior with dlopen, passing FLAGS
+   (RTLD_ names separated by '|'), and return dlopen's result.  Errors
+   out if that isn't safe to do right now or dlopen fails.  */
+
 struct value *
-macosx_load_dylib (char *name, char *flags)
+macosx_dlopen (char *name, char *flags)
+/* APPLE LOCAL end inferior helper  */
 {
   /* We're basically just going to call dlopen, and return the
      cookie that it returns.  BUT, we also have to make sure that
@@ -911,17 +959,30 @@ macosx_load_dylib (char *name, char *flags)
 		   name);
 	  
 	}
-      else
-	{
-	  ui_out_field_core_addr (uiout, "handle", value_as_address (ret_val));
-	  if (info_verbose)
-	    printf_unfiltered("Return token was: %s.\n", paddr_nz (value_as_address (ret_val)));
-	}
+    }
+
+  return ret_val;
+}
+
+/* APPLE LOCAL begin inferior helper  */
+/* This is the Mac OS X implementation of target_load_solib.  */
+
+struct value *
+macosx_load_dylib (char *name, char *flags)
+{
+  struct value *ret_val = macosx_dlopen (name, flags);
+
+  if (ret_val != NULL)
+    {
+      ui_out_field_core_addr (uiout, "handle", value_as_address (ret_val));
+      if (info_verbose)
+	printf_unfiltered("Return token was: %s.\n", paddr_nz (value_as_address (ret_val)));
     }
   else if (info_verbose)
     printf_unfiltered("Return value was NULL.\n");
 
   return ret_val;
 }
+/* APPLE LOCAL end inferior helper  */
 
 
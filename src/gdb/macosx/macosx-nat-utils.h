@@ -26,6 +26,8 @@ const void *macosx_parse_plist (const char *plist_path);
 void macosx_free_plist (const void **plist);
 
 struct value *macosx_load_dylib (char *name, char *flags);
+/* APPLE LOCAL inferior helper  */
+struct value *macosx_dlopen (char *name, char *flags);
 
 int macosx_check_safe_call (int which, enum check_which_threads thread_mode);
 
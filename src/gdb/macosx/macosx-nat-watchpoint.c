@@ -73,28 +73,80 @@ typedef struct memory_page
 }
 memory_page_t;
 
-#define MEMORY_PAGE_DICTIONARY_BUCKET_COUNT  128
+/* APPLE LOCAL begin page watchpoint engine  */
+#define MEMORY_PAGE_DICTIONARY_INITIAL_BUCKET_COUNT  128
 
 static struct
 {
   LONGEST page_count;
   int page_size;
   int page_protections_allowed;
-  /* These are just the heads of chains of actual page descriptors. */
-  memory_page_t buckets[MEMORY_PAGE_DICTIONARY_BUCKET_COUNT];
+  /* These are just the heads of chains of actual page descriptors.
+     The table is doubled whenever the chains get longer than two
+     entries on average, so that watching thousands of pages doesn't
+     turn every lookup into a list walk.  */
+  int bucket_count;
+  memory_page_t **buckets;
 }
 memory_page_dictionary;
 
+/* The page dictionary can only say whether a page is watched; to
+   tell a write to a watched variable from a write to its neighbour on
+   the same page we also keep every watched address range, sorted by
+   start address.  A range watched by several watchpoints appears once
+   with a reference count.  MAX_END[I] is the largest END of RANGES[0]
+   through RANGES[I], which lets a lookup stop walking backwards once
+   no earlier range can reach the address in question.  */
+
+struct watched_range
+{
+  CORE_ADDR start;
+  CORE_ADDR end;
+  int reference_count;
+};
+
+static struct
+{
+  int count;
+  int alloc;
+  struct watched_range *ranges;
+  CORE_ADDR *max_end;
+}
+watched_ranges;
+
+/* An access this many bytes or fewer away from a watched range is
+   always reported, since a store-multiple or vector store can fault
+   on its first byte and still reach into the range.  */
+
+#define PAGE_WATCH_FAULT_SLOP 128
+
+/* Non-zero if faults on watched pages that can't have touched a
+   watched range are stepped over by the native target instead of
+   being handed to infrun.  */
+
+static int page_watch_filter_enabled = 1;
+
+/* Non-zero if the target reports watchpoints after the write, so
+   that a real hit on a watched page is stepped over by the native
+   target too, and then handed to infrun as a plain trap.  */
+static int page_watch_continuable = 0;
+
+/* Set when such a step has completed, with the address written.  */
+static int page_watch_was_triggered = 0;
+static CORE_ADDR page_watch_triggered_addr;
+
 static memory_page_t *get_dictionary_entry_of_page (int pid,
                                                     CORE_ADDR page_start);
 
+static memory_page_t *find_dictionary_entry_of_page (CORE_ADDR page_start);
+
+static int get_dictionary_bucket_of_page (CORE_ADDR page_start);
+
 static void remove_dictionary_entry_of_page (int pid, memory_page_t * page);
 
 static void
 require_memory_page_dictionary (void)
 {
-  int i;
-
   /* Is the memory page dictionary ready for use?  If so, we're done. */
   if (memory_page_dictionary.page_count >= (LONGEST) 0)
     return;
@@ -102,15 +154,160 @@ require_memory_page_dictionary (void)
   /* Else, initialize it. */
   memory_page_dictionary.page_count = (LONGEST) 0;
   memory_page_dictionary.page_size = 4096;
+  memory_page_dictionary.bucket_count
+    = MEMORY_PAGE_DICTIONARY_INITIAL_BUCKET_COUNT;
+  memory_page_dictionary.buckets = (memory_page_t **)
+    xcalloc (memory_page_dictionary.bucket_count, sizeof (memory_page_t *));
+}
+
+/* Double the number of buckets in the page dictionary and rehash
+   every page into the new table.  */
+
+static void
+grow_memory_page_dictionary (void)
+{
+  memory_page_t **old_buckets = memory_page_dictionary.buckets;
+  int old_count = memory_page_dictionary.bucket_count;
+  int i;
+
+  memory_page_dictionary.bucket_count = old_count * 2;
+  memory_page_dictionary.buckets = (memory_page_t **)
+    xcalloc (memory_page_dictionary.bucket_count, sizeof (memory_page_t *));
+
+  for (i = 0; i < old_count; i++)
+    {
+      memory_page_t *page = old_buckets[i];
+
+      while (page != NULL)
+        {
+          memory_page_t *next = page->next;
+          int bucket = get_dictionary_bucket_of_page (page->page_start);
+
+          page->previous = NULL;
+          page->next = memory_page_dictionary.buckets[bucket];
+          if (page->next != NULL)
+            page->next->previous = page;
+          memory_page_dictionary.buckets[bucket] = page;
+          page = next;
+        }
+    }
+
+  xfree (old_buckets);
+}
+
+/* Return the number of watched ranges that start at or below ADDR,
+   which is also the index at which a range starting just above ADDR
+   would go.  */
+
+static int
+watched_range_upper_bound (CORE_ADDR addr)
+{
+  int lo = 0;
+  int hi = watched_ranges.count;
+
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      if (watched_ranges.ranges[mid].start <= addr)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
+/* Recompute the MAX_END entries from index FROM onwards.  */
+
+static void
+watched_range_update_max_end (int from)
+{
+  int i;
+
+  for (i = from; i < watched_ranges.count; i++)
+    {
+      CORE_ADDR end = watched_ranges.ranges[i].end;
+
+      if (i > 0 && watched_ranges.max_end[i - 1] > end)
+        end = watched_ranges.max_end[i - 1];
+      watched_ranges.max_end[i] = end;
+    }
+}
+
+static void
+add_watched_range (CORE_ADDR start, CORE_ADDR end)
+{
+  int i = watched_range_upper_bound (start);
+  int j;
+
+  for (j = i - 1; j >= 0 && watched_ranges.ranges[j].start == start; j--)
+    if (watched_ranges.ranges[j].end == end)
+      {
+        watched_ranges.ranges[j].reference_count++;
+        return;
+      }
+
+  if (watched_ranges.count == watched_ranges.alloc)
+    {
+      watched_ranges.alloc = watched_ranges.alloc ? watched_ranges.alloc * 2
+                                                  : 32;
+      watched_ranges.ranges = (struct watched_range *)
+        xrealloc (watched_ranges.ranges,
+                  watched_ranges.alloc * sizeof (struct watched_range));
+      watched_ranges.max_end = (CORE_ADDR *)
+        xrealloc (watched_ranges.max_end,
+                  watched_ranges.alloc * sizeof (CORE_ADDR));
+    }
+
+  memmove (&watched_ranges.ranges[i + 1], &watched_ranges.ranges[i],
+           (watched_ranges.count - i) * sizeof (struct watched_range));
+  watched_ranges.ranges[i].start = start;
+  watched_ranges.ranges[i].end = end;
+  watched_ranges.ranges[i].reference_count = 1;
+  watched_ranges.count++;
+  watched_range_update_max_end (i);
+}
+
+static void
+remove_watched_range (CORE_ADDR start, CORE_ADDR end)
+{
+  int j;
+
+  for (j = watched_range_upper_bound (start) - 1;
+       j >= 0 && watched_ranges.ranges[j].start == start; j--)
+    if (watched_ranges.ranges[j].end == end)
+      {
+        if (--watched_ranges.ranges[j].reference_count > 0)
+          return;
+        memmove (&watched_ranges.ranges[j], &watched_ranges.ranges[j + 1],
+                 (watched_ranges.count - j - 1)
+                 * sizeof (struct watched_range));
+        watched_ranges.count--;
+        watched_range_update_max_end (j);
+        return;
+      }
+}
+
+/* Return non-zero if any watched range overlaps [LO, HI).  */
+
+static int
+watched_range_overlaps (CORE_ADDR lo, CORE_ADDR hi)
+{
+  int j;
 
-  for (i = 0; i < MEMORY_PAGE_DICTIONARY_BUCKET_COUNT; i++)
+  if (hi <= lo)
+    return 0;
+
+  for (j = watched_range_upper_bound (hi - 1) - 1; j >= 0; j--)
     {
-      memory_page_dictionary.buckets[i].page_start = (CORE_ADDR) 0;
-      memory_page_dictionary.buckets[i].reference_count = 0;
-      memory_page_dictionary.buckets[i].next = NULL;
-      memory_page_dictionary.buckets[i].previous = NULL;
+      if (watched_ranges.max_end[j] <= lo)
+        break;
+      if (watched_ranges.ranges[j].end > lo)
+        return 1;
     }
+  return 0;
 }
+/* APPLE LOCAL end page watchpoint engine  */
 
 /* Write-protect the memory page that starts at this address.
 
@@ -136,7 +333,9 @@ write_protect_page (int pid, CORE_ADDR page_start)
 			 &r_object_name);
   if (kret != KERN_SUCCESS)
     return -1;
-  if (r_start != page_start)
+  /* APPLE LOCAL page watchpoint engine: A page in the middle of a
+     region is just as watchable as the first one.  */
+  if (page_start < r_start || page_start >= r_start + r_size)
     return -1;
 
   if (memory_page_dictionary.page_protections_allowed)
@@ -159,6 +358,12 @@ static void
 unwrite_protect_page (int pid, CORE_ADDR page_start, int original_permissions)
 {
   kern_return_t kret;
+
+  /* APPLE LOCAL page watchpoint engine: We never protected a page we
+     couldn't look up.  */
+  if (original_permissions == -1)
+    return;
+
   kret =
     mach_vm_protect (macosx_status->task, page_start, 4096, 0,
                 original_permissions);
@@ -178,11 +383,12 @@ macosx_enable_page_protection_events (int pid)
 
   memory_page_dictionary.page_protections_allowed = 1;
 
-  for (bucket = 0; bucket < MEMORY_PAGE_DICTIONARY_BUCKET_COUNT; bucket++)
+  /* APPLE LOCAL page watchpoint engine  */
+  for (bucket = 0; bucket < memory_page_dictionary.bucket_count; bucket++)
     {
       memory_page_t *page;
 
-      page = memory_page_dictionary.buckets[bucket].next;
+      page = memory_page_dictionary.buckets[bucket];
       while (page != NULL)
         {
           page->original_permissions =
@@ -203,11 +409,12 @@ macosx_disable_page_protection_events (int pid)
 {
   int bucket;
 
-  for (bucket = 0; bucket < MEMORY_PAGE_DICTIONARY_BUCKET_COUNT; bucket++)
+  /* APPLE LOCAL page watchpoint engine  */
+  for (bucket = 0; bucket < memory_page_dictionary.bucket_count; bucket++)
     {
       memory_page_t *page;
 
-      page = memory_page_dictionary.buckets[bucket].next;
+      page = memory_page_dictionary.buckets[bucket];
       while (page != NULL)
         {
           unwrite_protect_page (pid, page->page_start,
@@ -250,8 +457,11 @@ hppa_insert_hw_watchpoint (int pid, CORE_ADDR start, LONGEST len, int type)
 
   page_size = memory_page_dictionary.page_size;
   page_start = (start / page_size) * page_size;
+  /* APPLE LOCAL page watchpoint engine: Count the pages the range
+     touches, not the pages its length would fill.  */
   range_size_in_pages =
-    ((LONGEST) len + (LONGEST) page_size - 1) / (LONGEST) page_size;
+    ((LONGEST) (start + len - 1) / page_size) - (LONGEST) (start / page_size)
+    + 1;
 
   for (page_id = 0; page_id < range_size_in_pages;
        page_id++, page_start += page_size)
@@ -265,6 +475,9 @@ hppa_insert_hw_watchpoint (int pid, CORE_ADDR start, LONGEST len, int type)
       page->reference_count++;
     }
 
+  /* APPLE LOCAL page watchpoint engine  */
+  add_watched_range (start, start + len);
+
   /* Our implementation depends on seeing calls to kernel code, for the
      following reason.  Here we ask to be notified of syscalls.
 
@@ -326,8 +539,11 @@ hppa_remove_hw_watchpoint (int pid, CORE_ADDR start, LONGEST len,
 
   page_size = memory_page_dictionary.page_size;
   page_start = (start / page_size) * page_size;
+  /* APPLE LOCAL page watchpoint engine: Count the pages the range
+     touches, not the pages its length would fill.  */
   range_size_in_pages =
-    ((LONGEST) len + (LONGEST) page_size - 1) / (LONGEST) page_size;
+    ((LONGEST) (start + len - 1) / page_size) - (LONGEST) (start / page_size)
+    + 1;
 
   for (page_id = 0; page_id < range_size_in_pages;
        page_id++, page_start += page_size)
@@ -345,6 +561,9 @@ hppa_remove_hw_watchpoint (int pid, CORE_ADDR start, LONGEST len,
         remove_dictionary_entry_of_page (pid, page);
     }
 
+  /* APPLE LOCAL page watchpoint engine  */
+  remove_watched_range (start, start + len);
+
   dictionary_is_empty = (memory_page_dictionary.page_count == (LONGEST) 0);
 
   /* If write protections are currently disallowed, then that implies that
@@ -394,7 +613,8 @@ get_dictionary_bucket_of_page (CORE_ADDR page_start)
   CORE_ADDR hash;
 
   hash = (page_start / memory_page_dictionary.page_size);
-  hash = hash % MEMORY_PAGE_DICTIONARY_BUCKET_COUNT;
+  /* APPLE LOCAL page watchpoint engine  */
+  hash = hash % memory_page_dictionary.bucket_count;
 
   return hash;
 }
@@ -409,7 +629,6 @@ get_dictionary_entry_of_page (int pid, CORE_ADDR page_start)
 {
   int bucket;
   memory_page_t *page = NULL;
-  memory_page_t *previous_page = NULL;
 
   /* We're going to be using the dictionary now, than-kew. */
   require_memory_page_dictionary ();
@@ -417,15 +636,8 @@ get_dictionary_entry_of_page (int pid, CORE_ADDR page_start)
   /* Try to find an existing dictionary entry for this page.  Hash
      on the page's starting address. */
 
-  bucket = get_dictionary_bucket_of_page (page_start);
-  page = &memory_page_dictionary.buckets[bucket];
-  while (page != NULL)
-    {
-      if (page->page_start == page_start)
-        break;
-      previous_page = page;
-      page = page->next;
-    }
+  /* APPLE LOCAL begin page watchpoint engine  */
+  page = find_dictionary_entry_of_page (page_start);
 
   /* Did we find a dictionary entry for this page?  If not, then
      add it to the dictionary now. */
@@ -436,22 +648,48 @@ get_dictionary_entry_of_page (int pid, CORE_ADDR page_start)
       page = (memory_page_t *) xmalloc (sizeof (memory_page_t));
       page->page_start = page_start;
       page->reference_count = 0;
-      page->next = NULL;
-      page->previous = NULL;
 
       /* We'll write-protect the page now, if that's allowed. */
       page->original_permissions = write_protect_page (pid, page_start);
 
-      /* Add the new entry to the dictionary. */
-      page->previous = previous_page;
-      previous_page->next = page;
+      /* Add the new entry to the head of its chain. */
+      bucket = get_dictionary_bucket_of_page (page_start);
+      page->previous = NULL;
+      page->next = memory_page_dictionary.buckets[bucket];
+      if (page->next != NULL)
+        page->next->previous = page;
+      memory_page_dictionary.buckets[bucket] = page;
 
       memory_page_dictionary.page_count++;
+      if (memory_page_dictionary.page_count
+          > 2 * (LONGEST) memory_page_dictionary.bucket_count)
+        grow_memory_page_dictionary ();
     }
+  /* APPLE LOCAL end page watchpoint engine  */
 
   return page;
 }
 
+/* APPLE LOCAL begin page watchpoint engine  */
+/* Return the dictionary entry for the page starting at PAGE_START, or
+   NULL if that page isn't being watched.  */
+
+static memory_page_t *
+find_dictionary_entry_of_page (CORE_ADDR page_start)
+{
+  memory_page_t *page;
+
+  if (memory_page_dictionary.page_count <= (LONGEST) 0)
+    return NULL;
+
+  page = memory_page_dictionary.buckets[get_dictionary_bucket_of_page
+                                        (page_start)];
+  while (page != NULL && page->page_start != page_start)
+    page = page->next;
+  return page;
+}
+/* APPLE LOCAL end page watchpoint engine  */
+
 static void
 remove_dictionary_entry_of_page (int pid, memory_page_t * page)
 {
@@ -461,6 +699,10 @@ remove_dictionary_entry_of_page (int pid, memory_page_t * page)
   /* Kick the page out of the dictionary. */
   if (page->previous != NULL)
     page->previous->next = page->next;
+  /* APPLE LOCAL page watchpoint engine  */
+  else
+    memory_page_dictionary.buckets[get_dictionary_bucket_of_page
+                                   (page->page_start)] = page->next;
   if (page->next != NULL)
     page->next->previous = page->previous;
 
@@ -492,12 +734,134 @@ int macosx_stopped_by_watchpoint
     ((w->kind == TARGET_WAITKIND_STOPPED)
      && (stop_signal == TARGET_EXC_BAD_ACCESS)
      && (!stepped_after_stopped_by_watchpoint)
-     && bpstat_have_active_hw_watchpoints ());
+     && bpstat_have_active_hw_watchpoints ()
+     /* APPLE LOCAL page watchpoint engine: A fault outside the pages
+        we protected is a real crash, not a watchpoint.  A CODE of -1
+        means the exception didn't tell us where it happened.  */
+     && (w->code == -1 || macosx_page_watch_fault_p (w->code, w->address)));
+}
+
+/* APPLE LOCAL begin page watchpoint engine  */
+/* Return non-zero if an EXC_BAD_ACCESS with code CODE at ADDR was
+   caused by our write-protecting a watched page.  */
+
+int
+macosx_page_watch_fault_p (int code, CORE_ADDR addr)
+{
+  CORE_ADDR page_start;
+
+  if (code != KERN_PROTECTION_FAILURE
+      || !memory_page_dictionary.page_protections_allowed)
+    return 0;
+
+  page_start = (addr / memory_page_dictionary.page_size)
+               * memory_page_dictionary.page_size;
+  return find_dictionary_entry_of_page (page_start) != NULL;
+}
+
+/* Return non-zero if the fault with CODE at ADDR hit a watched page
+   but can't have written to anything being watched, so that the
+   native target may step the faulting instruction with the page
+   unprotected and carry on without telling infrun.  */
+
+int
+macosx_page_watch_false_hit (int code, CORE_ADDR addr)
+{
+  CORE_ADDR lo;
+
+  if (!page_watch_filter_enabled || !macosx_page_watch_fault_p (code, addr))
+    return 0;
+
+  lo = addr > PAGE_WATCH_FAULT_SLOP ? addr - PAGE_WATCH_FAULT_SLOP : 0;
+  return !watched_range_overlaps (lo, addr + PAGE_WATCH_FAULT_SLOP + 1);
 }
 
+/* Lift the write protection from the watched page holding ADDR, or
+   put it back, around the native target stepping over a false hit on
+   that page.  */
+
+void
+macosx_page_watch_unprotect (CORE_ADDR addr)
+{
+  CORE_ADDR page_start = (addr / memory_page_dictionary.page_size)
+                         * memory_page_dictionary.page_size;
+  memory_page_t *page = find_dictionary_entry_of_page (page_start);
+
+  if (page != NULL)
+    unwrite_protect_page (PIDGET (inferior_ptid), page_start,
+                          page->original_permissions);
+}
+
+void
+macosx_page_watch_reprotect (CORE_ADDR addr)
+{
+  CORE_ADDR page_start = (addr / memory_page_dictionary.page_size)
+                         * memory_page_dictionary.page_size;
+  memory_page_t *page = find_dictionary_entry_of_page (page_start);
+
+  if (page != NULL && memory_page_dictionary.page_protections_allowed)
+    write_protect_page (PIDGET (inferior_ptid), page_start);
+}
+
+/* Targets with continuable watchpoints (i386) call this with
+   CONTINUABLE non-zero when they fall back to page protection, so
+   that the native target finishes the faulting write before telling
+   infrun about it.  */
+
+void
+macosx_page_watch_set_continuable (int continuable)
+{
+  page_watch_continuable = continuable;
+}
+
+int
+macosx_page_watch_continuable (void)
+{
+  return page_watch_continuable;
+}
+
+/* Record that the write to ADDR on a watched page has been stepped
+   over and the stop being reported is due to it.  */
+
+void
+macosx_page_watch_set_triggered (CORE_ADDR addr)
+{
+  page_watch_was_triggered = 1;
+  page_watch_triggered_addr = addr;
+}
+
+void
+macosx_page_watch_clear_triggered (void)
+{
+  page_watch_was_triggered = 0;
+}
+
+/* Return non-zero if the last stop finished a write to a watched
+   page, storing the address written in *ADDR if ADDR isn't NULL.  */
+
+int
+macosx_page_watch_triggered (CORE_ADDR *addr)
+{
+  if (page_watch_was_triggered && addr != NULL)
+    *addr = page_watch_triggered_addr;
+  return page_watch_was_triggered;
+}
+/* APPLE LOCAL end page watchpoint engine  */
+
 void
 _initialize_macosx_nat_watchpoint (void)
 {
   memory_page_dictionary.page_count = (LONGEST) - 1;
   memory_page_dictionary.page_protections_allowed = 1;
+
+  /* APPLE LOCAL page watchpoint engine  */
+  add_setshow_boolean_cmd ("watchpoint-page-filter", class_obscure,
+			   &page_watch_filter_enabled, _("\
+Set if GDB should skip writes near, but not to, watched memory by itself."), _("\
+Show if GDB should skip writes near, but not to, watched memory by itself."), _("\
+Watchpoints are implemented by write-protecting whole pages.  When on,\n\
+a write to a watched page that is well clear of every watched range is\n\
+stepped over by the native target without stopping the debugger."),
+			   NULL, NULL,
+			   &setlist, &showlist);
 }
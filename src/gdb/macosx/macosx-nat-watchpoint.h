@@ -13,4 +13,16 @@ int macosx_insert_watchpoint (CORE_ADDR addr, size_t len, int type);
 int macosx_remove_watchpoint (CORE_ADDR addr, size_t len, int type);
 int macosx_stopped_by_watchpoint (struct target_waitstatus *w, int, int);
 
+/* APPLE LOCAL begin page watchpoint engine  */
+int macosx_page_watch_fault_p (int code, CORE_ADDR addr);
+int macosx_page_watch_false_hit (int code, CORE_ADDR addr);
+void macosx_page_watch_unprotect (CORE_ADDR addr);
+void macosx_page_watch_reprotect (CORE_ADDR addr);
+void macosx_page_watch_set_continuable (int continuable);
+int macosx_page_watch_continuable (void);
+void macosx_page_watch_set_triggered (CORE_ADDR addr);
+void macosx_page_watch_clear_triggered (void);
+int macosx_page_watch_triggered (CORE_ADDR *addr);
+/* APPLE LOCAL end page watchpoint engine  */
+
 #endif /* __GDB_MACOSX_NAT_WATCHPOINT_H__ */
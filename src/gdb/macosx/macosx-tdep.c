@@ -69,8 +69,16 @@ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.  */
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/param.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <mach/machine.h>
 #include <mach/kmod.h>
+/* APPLE LOCAL host shared cache  */
+#include <mach/vm_prot.h>
+/* APPLE LOCAL kext path cache  */
+#include <pthread.h>
+/* APPLE LOCAL dyld stub map  */
+#include "hashtab.h"
 
 #include <CoreFoundation/CoreFoundation.h>
 #include <CoreFoundation/CFPropertyList.h>
@@ -122,6 +130,8 @@ static const int  dsym_extension_len = (sizeof (dsym_extension) - 1);
 static const int  dsym_bundle_subdir_len = (sizeof (dsym_bundle_subdir) - 1);
 static int dsym_locate_enabled = 1;
 static int kaslr_memory_search_enabled = 1;
+/* APPLE LOCAL kext path cache  */
+static int kext_path_cache_enabled = 1;
 #define APPLE_DSYM_EXT_AND_SUBDIRECTORY ".dSYM/Contents/Resources/DWARF/"
 
 int
@@ -331,8 +341,157 @@ macosx_internalize_symbol (in, sect_p, ext, abfd)
   in->n_other = ext->e_other[0];
 }
 
+/* APPLE LOCAL begin dyld stub map  */
+/* Every step that stops in a new function asks whether it is in a
+   dyld stub, and resolving a stub means a global symbol lookup for
+   its target.  Remember the answer for each pc asked about, stubs
+   and non-stubs alike, with the objfile the pc is in.  A stub's
+   target may be in any objfile, so the whole map is dropped when an
+   objfile comes or goes, as well as when this one slides.  */
+
+struct dyld_stub_entry
+{
+  CORE_ADDR pc;
+
+  /* What dyld_symbol_stub_function_address returns for PC, and the
+     stub's target name, or NULL if PC isn't a stub.  */
+  CORE_ADDR target;
+  const char *name;
+};
+
+struct dyld_stub_map
+{
+  CORE_ADDR slide;
+  unsigned int generation;
+  htab_t entries;
+};
+
+static const struct objfile_data *dyld_stub_map_objfile_data;
+
+static int dyld_stub_cache_enabled = 1;
+
+static void
+show_dyld_stub_cache (struct ui_file *file, int from_tty,
+		      struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Caching of dyld stub targets is %s.\n"),
+		    value);
+}
+
+static hashval_t
+dyld_stub_entry_hash (const void *p)
+{
+  const struct dyld_stub_entry *e = p;
+  return (hashval_t) (e->pc >> 1);
+}
+
+static int
+dyld_stub_entry_eq (const void *a, const void *b)
+{
+  const struct dyld_stub_entry *ea = a;
+  const struct dyld_stub_entry *eb = b;
+  return ea->pc == eb->pc;
+}
+
+static void
+dyld_stub_map_free (struct objfile *objfile, void *data)
+{
+  struct dyld_stub_map *map = data;
+
+  htab_delete (map->entries);
+  xfree (map);
+}
+
+/* Return the slot for PC in the stub map of the objfile PC is in,
+   creating the map if need be, or NULL if PC isn't in an objfile.  */
+
+static void **
+dyld_stub_map_slot (CORE_ADDR pc)
+{
+  struct obj_section *osect;
+  struct dyld_stub_map *map;
+  struct dyld_stub_entry key;
+  CORE_ADDR slide;
+
+  if (!dyld_stub_cache_enabled)
+    return NULL;
+
+  osect = find_pc_section (pc);
+  if (osect == NULL || osect->objfile == NULL
+      || osect->the_bfd_section == NULL)
+    return NULL;
+  slide = osect->addr - bfd_section_vma (osect->objfile->obfd,
+					 osect->the_bfd_section);
+
+  map = objfile_data (osect->objfile, dyld_stub_map_objfile_data);
+  if (map == NULL)
+    {
+      map = XZALLOC (struct dyld_stub_map);
+      map->entries = htab_create_alloc (64, dyld_stub_entry_hash,
+					dyld_stub_entry_eq, xfree,
+					xcalloc, xfree);
+      map->slide = slide;
+      map->generation = objfile_chain_generation;
+      set_objfile_data (osect->objfile, dyld_stub_map_objfile_data, map);
+    }
+  else if (map->slide != slide
+	   || map->generation != objfile_chain_generation)
+    {
+      htab_empty (map->entries);
+      map->slide = slide;
+      map->generation = objfile_chain_generation;
+    }
+
+  key.pc = pc;
+  return htab_find_slot (map->entries, &key, INSERT);
+}
+
+static CORE_ADDR dyld_symbol_stub_function_address_1 (CORE_ADDR pc,
+						      const char **name);
+
 CORE_ADDR
 dyld_symbol_stub_function_address (CORE_ADDR pc, const char **name)
+{
+  void **slot;
+  struct dyld_stub_entry *entry;
+  const char *lname = NULL;
+  CORE_ADDR target;
+  unsigned int generation;
+
+  slot = dyld_stub_map_slot (pc);
+  if (slot == NULL)
+    return dyld_symbol_stub_function_address_1 (pc, name);
+
+  entry = *slot;
+  if (entry == NULL)
+    {
+      generation = objfile_chain_generation;
+      target = dyld_symbol_stub_function_address_1 (pc, &lname);
+
+      /* The lookup may have raised some objfile's load level, which
+	 can free the name and the map along with the old symbols.  */
+      if (generation != objfile_chain_generation
+	  || (slot = dyld_stub_map_slot (pc)) == NULL)
+	{
+	  if (name)
+	    *name = lname;
+	  return target;
+	}
+      entry = XNEW (struct dyld_stub_entry);
+      entry->pc = pc;
+      entry->target = target;
+      entry->name = lname;
+      *slot = entry;
+    }
+
+  if (name)
+    *name = entry->name;
+  return entry->target;
+}
+/* APPLE LOCAL end dyld stub map  */
+
+static CORE_ADDR
+dyld_symbol_stub_function_address_1 (CORE_ADDR pc, const char **name)
 {
   struct symbol *sym = NULL;
   struct minimal_symbol *msym = NULL;
@@ -1256,6 +1415,232 @@ locate_dsym_using_framework (struct objfile *objfile)
 }
 #endif
 
+/* APPLE LOCAL begin dsym path cache  */
+/* Persistent UUID -> path caches.  Each one is a file under
+   ~/Library/Caches with one "UUID MTIME PATH" line per entry, appended
+   to as answers are found; MTIME is the modification time the file at
+   PATH had then, or 0 if the user of the cache checks the answer some
+   other way.  A cache with no NAME is a read-only index whose file the
+   user names - e.g. one built by a symbol server for its own tree.  */
+
+struct uuid_path_entry
+{
+  uuid_t uuid;
+  time_t mtime;
+  char *path;
+  struct uuid_path_entry *next;
+};
+
+struct uuid_path_cache
+{
+  /* The file's name under ~/Library/Caches, or NULL for an index.  */
+  const char *name;
+
+  /* The setting that turns this cache on and off.  */
+  int *enabled;
+
+  int loaded;
+  struct uuid_path_entry *entries;
+};
+
+/* The file named by "set dsym-index-file", if any.  */
+
+static char *dsym_index_filename = NULL;
+
+static int dsym_path_cache_enabled = 1;
+
+static struct uuid_path_cache dsym_path_cache =
+  { "com.apple.gdb.dsym-paths", &dsym_path_cache_enabled };
+
+static int dsym_index_enabled = 1;
+
+static struct uuid_path_cache dsym_index =
+  { NULL, &dsym_index_enabled };
+
+static char *
+uuid_path_cache_filename (struct uuid_path_cache *cache)
+{
+  const char *home;
+
+  if (cache->name == NULL)
+    {
+      if (dsym_index_filename == NULL || *dsym_index_filename == '\0')
+	return NULL;
+      return tilde_expand (dsym_index_filename);
+    }
+
+  home = getenv ("HOME");
+  if (home == NULL || *home == '\0')
+    return NULL;
+  return xstrprintf ("%s/Library/Caches/%s", home, cache->name);
+}
+
+static void
+uuid_path_cache_add (struct uuid_path_cache *cache, uuid_t uuid,
+		     const char *path, time_t mtime)
+{
+  struct uuid_path_entry *e = xmalloc (sizeof (struct uuid_path_entry));
+
+  memcpy (e->uuid, uuid, sizeof (uuid_t));
+  e->mtime = mtime;
+  e->path = xstrdup (path);
+  e->next = cache->entries;
+  cache->entries = e;
+}
+
+static void
+uuid_path_cache_clear (struct uuid_path_cache *cache)
+{
+  while (cache->entries != NULL)
+    {
+      struct uuid_path_entry *e = cache->entries;
+
+      cache->entries = e->next;
+      xfree (e->path);
+      xfree (e);
+    }
+  cache->loaded = 0;
+}
+
+static void
+uuid_path_cache_load (struct uuid_path_cache *cache)
+{
+  char *filename;
+  FILE *fp;
+  char line[PATH_MAX + 64];
+
+  if (cache->loaded)
+    return;
+  cache->loaded = 1;
+
+  filename = uuid_path_cache_filename (cache);
+  if (filename == NULL)
+    return;
+  fp = fopen (filename, "r");
+  xfree (filename);
+  if (fp == NULL)
+    return;
+
+  while (fgets (line, sizeof (line), fp) != NULL)
+    {
+      char *mtime_str, *path, *nl;
+      uuid_t uuid;
+
+      mtime_str = strchr (line, ' ');
+      if (mtime_str == NULL)
+	continue;
+      *mtime_str++ = '\0';
+      path = strchr (mtime_str, ' ');
+      if (path == NULL)
+	continue;
+      *path++ = '\0';
+      nl = strchr (path, '\n');
+      if (nl != NULL)
+	*nl = '\0';
+      if (*path == '\0' || uuid_parse (line, uuid) != 0)
+	continue;
+      uuid_path_cache_add (cache, uuid, path,
+			   (time_t) strtoll (mtime_str, NULL, 10));
+    }
+  fclose (fp);
+}
+
+/* Return CACHE's entry for UUID, or NULL.  Later lines in the file are
+   pushed onto the front of the list, so they win.  */
+
+static struct uuid_path_entry *
+uuid_path_cache_lookup (struct uuid_path_cache *cache, uuid_t uuid)
+{
+  struct uuid_path_entry *e;
+
+  if (!*cache->enabled)
+    return NULL;
+  uuid_path_cache_load (cache);
+  for (e = cache->entries; e != NULL; e = e->next)
+    if (memcmp (e->uuid, uuid, sizeof (uuid_t)) == 0)
+      return e;
+  return NULL;
+}
+
+/* Return non-zero if the file E names is still there and, if E has a
+   modification time, still has it.  */
+
+static int
+uuid_path_entry_current (struct uuid_path_entry *e)
+{
+  struct stat st;
+
+  if (stat (e->path, &st) != 0 || !S_ISREG (st.st_mode))
+    return 0;
+  return e->mtime == 0 || e->mtime == st.st_mtime;
+}
+
+static void
+uuid_path_cache_record (struct uuid_path_cache *cache, uuid_t uuid,
+			const char *path, time_t mtime)
+{
+  struct uuid_path_entry *known;
+  char *filename;
+  FILE *fp;
+  char uuid_str[37];
+
+  if (cache->name == NULL)
+    return;
+  known = uuid_path_cache_lookup (cache, uuid);
+  if (!*cache->enabled
+      || (known != NULL && known->mtime == mtime
+	  && strcmp (known->path, path) == 0))
+    return;
+  uuid_path_cache_add (cache, uuid, path, mtime);
+
+  filename = uuid_path_cache_filename (cache);
+  if (filename == NULL)
+    return;
+  fp = fopen (filename, "a");
+  xfree (filename);
+  if (fp == NULL)
+    return;
+  uuid_unparse_upper (uuid, uuid_str);
+  fprintf (fp, "%s %lld %s\n", uuid_str, (long long) mtime, path);
+  fclose (fp);
+}
+
+static void
+set_dsym_index_file (char *args, int from_tty, struct cmd_list_element *c)
+{
+  uuid_path_cache_clear (&dsym_index);
+}
+
+/* Find OBJFILE's dSYM - whose UUID is UUID - in the dSYM path cache or
+   the index.  Returns an xmalloc'ed path, or NULL.  */
+
+static char *
+dsym_path_cache_find (struct objfile *objfile, uuid_t uuid)
+{
+  struct uuid_path_entry *e;
+
+  e = uuid_path_cache_lookup (&dsym_path_cache, uuid);
+  if (e == NULL || !uuid_path_entry_current (e))
+    e = uuid_path_cache_lookup (&dsym_index, uuid);
+  if (e == NULL || !uuid_path_entry_current (e))
+    return NULL;
+
+#if USE_DEBUG_SYMBOLS_FRAMEWORK
+  find_source_path_mappings_posix (objfile, e->path);
+#endif
+  return xstrdup (e->path);
+}
+
+static void
+dsym_path_cache_remember (uuid_t uuid, const char *path)
+{
+  struct stat st;
+
+  if (stat (path, &st) == 0)
+    uuid_path_cache_record (&dsym_path_cache, uuid, path, st.st_mtime);
+}
+/* APPLE LOCAL end dsym path cache  */
+
 /* Locate a full path to the dSYM Mach-O file within the dSYM bundle given
    OJBFILE. This function will first search in the same directory as the
    executable for OBJFILE, then it will traverse the directory structure
@@ -1264,8 +1649,11 @@ locate_dsym_using_framework (struct objfile *objfile)
    DebugSymbols.framework will used using the current set of global 
    DebugSymbols.framework defaults from com.apple.DebugSymbols.plist.  */
 
-char *
-macosx_locate_dsym (struct objfile *objfile)
+/* APPLE LOCAL dsym path cache: The search itself, for
+   macosx_locate_dsym.  */
+
+static char *
+macosx_locate_dsym_1 (struct objfile *objfile)
 {
   char *basename_str;
   char *dot_ptr;
@@ -1273,13 +1661,6 @@ macosx_locate_dsym (struct objfile *objfile)
   char *dsymfile;
   const char *executable_name;
 
-  /* Don't load a dSYM file unless we our load level is set to ALL.  If a
-     load level gets raised, then the old objfile will get destroyed and
-     it will get rebuilt, and this function will get called again and get
-     its chance to locate the dSYM file.  */
-  if (objfile->symflags != OBJF_SYM_ALL)
-    return NULL;
-
   /* When we're debugging a kext with dSYM, OBJFILE is the kext syms
      output by kextload (com.apple.IOKitHello.syms), 
      objfile->not_loaded_kext_filename is the name of the kext bundle
@@ -1390,6 +1771,53 @@ macosx_locate_dsym (struct objfile *objfile)
   return NULL;
 }
 
+/* APPLE LOCAL begin dsym path cache  */
+char *
+macosx_locate_dsym (struct objfile *objfile)
+{
+  /* Don't load a dSYM file unless we our load level is set to ALL.  If a
+     load level gets raised, then the old objfile will get destroyed and
+     it will get rebuilt, and this function will get called again and get
+     its chance to locate the dSYM file.  */
+  if (objfile->symflags != OBJF_SYM_ALL)
+    return NULL;
+
+  return macosx_locate_dsym_any_level (objfile);
+}
+
+/* APPLE LOCAL debug info on demand: Like macosx_locate_dsym, but
+   whatever OBJFILE's load level.  */
+
+char *
+macosx_locate_dsym_any_level (struct objfile *objfile)
+{
+  unsigned char uuid[16];
+  int have_uuid;
+  char *dsym;
+
+  /* A dSYM has the same UUID as its executable; don't find it as its
+     own dSYM.  */
+  if (strcasestr (objfile->name, ".dSYM") != NULL)
+    return NULL;
+
+  /* One lookup in place of all the stat calls and bundle scans of the
+     search, which with a few hundred libraries on a network file
+     system is what loading their symbols spends its time on.  */
+  have_uuid = bfd_mach_o_get_uuid (objfile->obfd, uuid, sizeof (uuid));
+  if (have_uuid)
+    {
+      dsym = dsym_path_cache_find (objfile, uuid);
+      if (dsym != NULL)
+	return dsym;
+    }
+
+  dsym = macosx_locate_dsym_1 (objfile);
+  if (dsym != NULL && have_uuid)
+    dsym_path_cache_remember (uuid, dsym);
+  return dsym;
+}
+/* APPLE LOCAL end dsym path cache  */
+
 /* Returns 1 if the directory is found.  0 if error or not found.
    Files return 0. */
 int
@@ -1814,15 +2242,74 @@ look_for_kext_binary_next_to_dsym (const char *dsym_path, CFUUIDRef kext_uuid)
 }
 
 
+/* APPLE LOCAL begin kext path cache  */
+/* Finding a kext's symbol-rich executable means a Spotlight query for
+   its dSYM, reading the dSYM's plist and quite possibly running the
+   DBGShellCommands script - per kext, and add-all-kexts does it for a
+   couple of hundred of them.  The answers are kept in a uuid_path_cache,
+   and checked against the executable's UUID before being used.  */
+
+#if USE_DEBUG_SYMBOLS_FRAMEWORK
+static struct uuid_path_cache kext_path_cache =
+  { "com.apple.gdb.kext-paths", &kext_path_cache_enabled };
+
+static const char *
+kext_path_cache_lookup (uuid_t uuid)
+{
+  struct uuid_path_entry *e = uuid_path_cache_lookup (&kext_path_cache, uuid);
+
+  return e != NULL ? e->path : NULL;
+}
+
+static void
+kext_path_cache_record (uuid_t uuid, const char *path)
+{
+  uuid_path_cache_record (&kext_path_cache, uuid, path, 0);
+}
+
+/* Return non-zero if the executable at PATH has the UUID KEXT_UUID.  */
+
+static int
+kext_executable_matches_uuid (const char *path, CFUUIDRef kext_uuid)
+{
+  bfd *abfd;
+  CFUUIDRef file_uuid;
+  CFUUIDBytes kext_uuid_bytes, file_uuid_bytes;
+  int matches = 0;
+
+  if (!file_exists_p (path))
+    return 0;
+  abfd = symfile_bfd_open_safe (path, 0, GDB_OSABI_UNKNOWN);
+  if (abfd == NULL)
+    return 0;
+  file_uuid = get_uuidref_for_bfd (abfd);
+  if (file_uuid != NULL)
+    {
+      kext_uuid_bytes = CFUUIDGetUUIDBytes (kext_uuid);
+      file_uuid_bytes = CFUUIDGetUUIDBytes (file_uuid);
+      matches = memcmp (&kext_uuid_bytes, &file_uuid_bytes,
+			sizeof (CFUUIDBytes)) == 0;
+      CFRelease (file_uuid);
+    }
+  bfd_close (abfd);
+  return matches;
+}
+#endif
+/* APPLE LOCAL end kext path cache  */
+
 /* Given a UUIDRef for a kext, returns the path to the kext's corresponding 
    symbol-rich executable, or NULL on error. 
    KEXT_NAME is the bundle ID, reverse-dns style name, for the kext, used for
    error reporting.
    Caller is responsible for freeing the returned xmalloc'd filename. */
 
+/* APPLE LOCAL kext path cache: KNOWN_DSYM_URL, if not NULL, is the
+   result of looking up KEXT_UUID's dSYM already.  */
+
 static char *
 macosx_locate_kext_executable_by_symfile_helper (CFUUIDRef kext_uuid, 
-                                                 const char *kext_name)
+                                                 const char *kext_name,
+						 CFURLRef known_dsym_url)
 {
 #if USE_DEBUG_SYMBOLS_FRAMEWORK
   char *result = NULL;
@@ -1837,9 +2324,22 @@ macosx_locate_kext_executable_by_symfile_helper (CFUUIDRef kext_uuid,
   uuid_t uuid;
   get_uuid_t_for_uuidref (kext_uuid, &uuid); // Convert CFUUIDRef to uuid_t
 
+  /* APPLE LOCAL begin kext path cache  */
+  const char *cached_path = kext_path_cache_lookup (uuid);
+  if (cached_path != NULL && kext_executable_matches_uuid (cached_path,
+							    kext_uuid))
+    return xstrdup (cached_path);
+
   /* Find the dSYM using the DebugSymbols framework */
 
-  dsym_url = DBGCopyDSYMURLForUUID (kext_uuid);
+  if (known_dsym_url != NULL)
+    {
+      CFRetain (known_dsym_url);
+      dsym_url = known_dsym_url;
+    }
+  else
+    dsym_url = DBGCopyDSYMURLForUUID (kext_uuid);
+  /* APPLE LOCAL end kext path cache  */
   if (!dsym_url)
     {
       const char *basep = strrchr (kext_name, '/');
@@ -1865,6 +2365,8 @@ macosx_locate_kext_executable_by_symfile_helper (CFUUIDRef kext_uuid,
     {
       if (dsym_url) 
         CFRelease (dsym_url);
+      /* APPLE LOCAL kext path cache  */
+      kext_path_cache_record (uuid, kext_next_to_dsym);
       return kext_next_to_dsym;
     }
 
@@ -1927,6 +2429,8 @@ macosx_locate_kext_executable_by_symfile_helper (CFUUIDRef kext_uuid,
 
   result = kext_executable_name;
   kext_executable_name = NULL;
+  /* APPLE LOCAL kext path cache  */
+  kext_path_cache_record (uuid, result);
 finish:
   if (dsym_url) 
     CFRelease (dsym_url);
@@ -1962,7 +2466,8 @@ macosx_locate_kext_executable_by_symfile (bfd *abfd)
 
   char *ret;
   ret = macosx_locate_kext_executable_by_symfile_helper (symfile_uuid, 
-                                                         abfd->filename);
+                                                         abfd->filename,
+							 NULL);
   CFRelease (symfile_uuid);
   return ret;
 }
@@ -3066,11 +3571,11 @@ macosx_get_kext_sect_addrs_from_kernel (const char *filename,
           j++;
         }
     }
+  /* APPLE LOCAL kext path cache: Don't leak the table on a miss.  */
+  free_list_of_loaded_kexts (loaded_kexts);
   if (mh_addr == INVALID_ADDRESS)
     return NULL;
 
-  free_list_of_loaded_kexts (loaded_kexts);
-
   // We found a matching UUID.
   // Now look at the load commands in memory (create a temporary
   // memory bfd) to get the load addresses of each text/data section.
@@ -3078,6 +3583,69 @@ macosx_get_kext_sect_addrs_from_kernel (const char *filename,
   return get_section_addresses_for_macho_in_memory (mh_addr);
 }
 
+/* APPLE LOCAL begin kext path cache  */
+#if USE_DEBUG_SYMBOLS_FRAMEWORK
+/* The Spotlight queries behind DBGCopyDSYMURLForUUID are most of the
+   time add-all-kexts takes, and they're independent of each other and
+   of gdb, so they're run up front on a few threads.  Nothing else
+   about loading a kext - reading its plist, opening and reading its
+   symbols - is safe to do off the main thread.  */
+
+#define KEXT_DSYM_LOOKUP_THREADS 8
+
+struct kext_dsym_lookup
+{
+  CFUUIDRef *uuids;
+  CFURLRef *urls;
+  int count;
+  int next;
+  pthread_mutex_t lock;
+};
+
+static void *
+kext_dsym_lookup_worker (void *arg)
+{
+  struct kext_dsym_lookup *lookup = arg;
+
+  for (;;)
+    {
+      int i;
+
+      pthread_mutex_lock (&lookup->lock);
+      i = lookup->next++;
+      pthread_mutex_unlock (&lookup->lock);
+      if (i >= lookup->count)
+	break;
+      if (lookup->uuids[i] != NULL)
+	lookup->urls[i] = DBGCopyDSYMURLForUUID (lookup->uuids[i]);
+    }
+  return NULL;
+}
+
+static void
+kext_dsym_lookup_all (struct kext_dsym_lookup *lookup)
+{
+  pthread_t threads[KEXT_DSYM_LOOKUP_THREADS];
+  int nthreads, i;
+
+  pthread_mutex_init (&lookup->lock, NULL);
+  lookup->next = 0;
+  for (nthreads = 0; nthreads < KEXT_DSYM_LOOKUP_THREADS - 1
+		     && nthreads < lookup->count; nthreads++)
+    if (pthread_create (&threads[nthreads], NULL, kext_dsym_lookup_worker,
+			lookup) != 0)
+      break;
+
+  /* Help out, and do the lot if no thread could be started.  */
+  kext_dsym_lookup_worker (lookup);
+
+  for (i = 0; i < nthreads; i++)
+    pthread_join (threads[i], NULL);
+  pthread_mutex_destroy (&lookup->lock);
+}
+#endif
+/* APPLE LOCAL end kext path cache  */
+
 static void
 add_all_kexts_command (char *args, int from_tty)
 {
@@ -3088,38 +3656,39 @@ add_all_kexts_command (char *args, int from_tty)
   if (lks == NULL)
     error ("Unable to read list of kexts from the kernel memroy.");
 
+  /* APPLE LOCAL begin kext path cache: Look up the dSYMs of the kexts
+     we don't already know about all at once.  */
+  struct kext_dsym_lookup lookup;
+  CFUUIDRef *kext_uuids;
   int i;
+
+  kext_uuids = (CFUUIDRef *) xcalloc (lks->count, sizeof (CFUUIDRef));
+  lookup.count = lks->count;
+  lookup.uuids = (CFUUIDRef *) xcalloc (lks->count, sizeof (CFUUIDRef));
+  lookup.urls = (CFURLRef *) xcalloc (lks->count, sizeof (CFURLRef));
   for (i = 0; i < lks->count; i++)
     {
       // If we've already added the kext, don't add it a second time
       if (find_objfile_by_uuid (lks->kexts[i].uuid))
         continue;
+      kext_uuids[i] = get_uuidref_for_uuid_t (lks->kexts[i].uuid);
+      if (kext_path_cache_lookup (lks->kexts[i].uuid) == NULL)
+	lookup.uuids[i] = kext_uuids[i];
+    }
+  kext_dsym_lookup_all (&lookup);
 
-      CFUUIDRef kext_uuid_ref = get_uuidref_for_uuid_t (lks->kexts[i].uuid);
+  for (i = 0; i < lks->count; i++)
+    {
+      CFUUIDRef kext_uuid_ref = kext_uuids[i];
       if (kext_uuid_ref == NULL)
         continue;
       const char *symbol_rich = macosx_locate_kext_executable_by_symfile_helper
-                                           (kext_uuid_ref, lks->kexts[i].name);
+                                           (kext_uuid_ref, lks->kexts[i].name,
+					    lookup.urls[i]);
       int have_symbol_rich_exe = 0;
       if (symbol_rich && file_exists_p (symbol_rich))
         have_symbol_rich_exe = 1;
-
-      CFURLRef dsym_url = DBGCopyDSYMURLForUUID (kext_uuid_ref);
-      char dsym_path[PATH_MAX];
-      dsym_path[0] = '\0';
-      int have_dsym_path = 0;
-      if (dsym_url)
-        if (CFURLGetFileSystemRepresentation (dsym_url, 1, (UInt8*) dsym_path, PATH_MAX))
-          {
-            dsym_path[PATH_MAX - 1] = '\0';
-            if (file_exists_p (dsym_path))
-              have_dsym_path = 1;
-          }
-      CFRelease (kext_uuid_ref);
-
-      // At this point we may have the pathanme to the kext bundle executable
-      // file (the "symbol rich executable") and we may have the pathname to
-      // a dSYM ("dsym_path").
+      /* APPLE LOCAL end kext path cache  */
 
       struct section_addr_info *sect_addrs;
       sect_addrs = get_section_addresses_for_macho_in_memory (lks->kexts[i].address);
@@ -3193,6 +3762,19 @@ add_all_kexts_command (char *args, int from_tty)
      frameless.  */
   reinit_frame_cache ();
 
+  /* APPLE LOCAL begin kext path cache  */
+  for (i = 0; i < lks->count; i++)
+    {
+      if (kext_uuids[i] != NULL)
+        CFRelease (kext_uuids[i]);
+      if (lookup.urls[i] != NULL)
+        CFRelease (lookup.urls[i]);
+    }
+  xfree (kext_uuids);
+  xfree (lookup.uuids);
+  xfree (lookup.urls);
+  /* APPLE LOCAL end kext path cache  */
+
   free_list_of_loaded_kexts (lks);
 #endif // USE_DEBUG_SYMBOLS_FRAMEWORK
 }
@@ -3231,6 +3813,87 @@ mach_kernel_starts_here_p (CORE_ADDR addr, uuid_t *file_uuid, uuid_t *discovered
   return 1;
 }
 
+/* APPLE LOCAL begin kernel address cache  */
+/* Finding a slid kernel can take thousands of probes, each a round trip
+   over KDP.  The addresses kernels were found at are kept in a
+   uuid_path_cache, keyed by UUID, with the address standing in for the
+   path.  They are candidates only: each one is checked against the
+   Mach-O header and UUID in memory before it is believed.  */
+
+static int kernel_address_cache_enabled = 1;
+
+static struct uuid_path_cache kernel_address_cache =
+  { "com.apple.gdb.kernel-addresses", &kernel_address_cache_enabled };
+
+/* The most remembered addresses tried before falling back to a search;
+   one per boot of the kernel in question is remembered.  */
+
+#define KERNEL_ADDRESS_CACHE_PROBES 8
+
+/* Try the addresses the kernel address cache has for the kernel whose
+   UUID is *UUID or, if UUID is NULL, for any kernel, newest first.
+   Only addresses in [LOW, HIGH) are tried.  If a kernel with the
+   remembered UUID is there, store its address, UUID and osabi in
+   *ADDR, *FOUND_UUID and *OSABI and return 1.  */
+
+static int
+kernel_address_cache_find (uuid_t *uuid, CORE_ADDR low, CORE_ADDR high,
+			   CORE_ADDR *addr, uuid_t *found_uuid,
+			   enum gdb_osabi *osabi)
+{
+  struct uuid_path_entry *e;
+  CORE_ADDR tried[KERNEL_ADDRESS_CACHE_PROBES];
+  int ntried = 0;
+
+  if (!kernel_address_cache_enabled)
+    return 0;
+  uuid_path_cache_load (&kernel_address_cache);
+
+  for (e = kernel_address_cache.entries;
+       e != NULL && ntried < KERNEL_ADDRESS_CACHE_PROBES;
+       e = e->next)
+    {
+      CORE_ADDR candidate;
+      uuid_t mem_uuid;
+      enum gdb_osabi mem_osabi;
+      int i;
+
+      if (uuid != NULL && memcmp (*uuid, e->uuid, sizeof (uuid_t)) != 0)
+	continue;
+      candidate = (CORE_ADDR) strtoull (e->path, NULL, 16);
+      if (candidate < low || candidate >= high)
+	continue;
+      for (i = 0; i < ntried; i++)
+	if (tried[i] == candidate)
+	  break;
+      if (i < ntried)
+	continue;
+      tried[ntried++] = candidate;
+
+      if (get_information_about_macho (NULL, candidate, NULL, 1, 1,
+				       &mem_uuid, &mem_osabi,
+				       NULL, NULL, NULL, NULL)
+	  && memcmp (mem_uuid, e->uuid, sizeof (uuid_t)) == 0)
+	{
+	  *addr = candidate;
+	  memcpy (*found_uuid, mem_uuid, sizeof (uuid_t));
+	  *osabi = mem_osabi;
+	  return 1;
+	}
+    }
+  return 0;
+}
+
+static void
+kernel_address_cache_record (uuid_t uuid, CORE_ADDR addr)
+{
+  char *addr_str = xstrprintf ("0x%s", paddr_nz (addr));
+
+  uuid_path_cache_record (&kernel_address_cache, uuid, addr_str, 0);
+  xfree (addr_str);
+}
+/* APPLE LOCAL end kernel address cache  */
+
 /* Search the inferior's memory space for a kernel image.
    INPUT:  OFILE  optional - the mach_kernel objfile.  If we provided, UUID matching is enforced
    OUTPUT:  ADDR  optional - set to the address of mach_kernel in inferior, if found
@@ -3327,6 +3990,22 @@ exhaustive_search_for_kernel_in_mem (struct objfile *ofile, CORE_ADDR *addr, uui
         }
     }
 
+  /* APPLE LOCAL begin kernel address cache  */
+  /* Then see if the kernel is where it was the last few times we
+     found it.  */
+  if (!found_kernel)
+    {
+      CORE_ADDR cached_addr;
+
+      if (kernel_address_cache_find (uuid, cur_addr, stop_addr, &cached_addr,
+				     &in_memory_uuid, &in_memory_osabi))
+	{
+	  cur_addr = cached_addr;
+	  found_kernel = 1;
+	}
+    }
+  /* APPLE LOCAL end kernel address cache  */
+
   /* Second, when the appropriate boot-args are set, the load 
      address of the kernel is written at a fixed address in 
      the kernel's low globals page.  See what's there.  */
@@ -3465,6 +4144,8 @@ exhaustive_search_for_kernel_in_mem (struct objfile *ofile, CORE_ADDR *addr, uui
 
       if (succeeded)
         {
+          /* APPLE LOCAL kernel address cache  */
+          kernel_address_cache_record (in_memory_uuid, cur_addr);
           do_cleanups (override_trust_readonly);
           if (uuid_output)
             memcpy (*uuid_output, &in_memory_uuid, sizeof (uuid_t));
@@ -3583,7 +4264,7 @@ try_to_find_and_load_kernel_via_uuid (CORE_ADDR in_memory_addr, uuid_t in_memory
              to it.  */
           if (kernel_path != NULL)
             xfree (kernel_path);
-          kernel_path = macosx_locate_kext_executable_by_symfile_helper (uuidref, "mach kernel");
+          kernel_path = macosx_locate_kext_executable_by_symfile_helper (uuidref, "mach kernel", NULL);
         }
       CORE_ADDR on_disk_load_addr;
       if (get_information_about_macho (kernel_path, 0, NULL, 1, 0, NULL, NULL, NULL, &on_disk_load_addr, NULL, NULL))
@@ -3715,7 +4396,20 @@ struct gdb_copy_dyld_cache_header
         uint64_t        slideInfoSize;
         uint64_t        localSymbolsOffset;
         uint64_t        localSymbolsSize;
+        /* APPLE LOCAL host shared cache  */
+        uint8_t         uuid[16];
+};
+
+/* APPLE LOCAL begin host shared cache  */
+struct gdb_copy_dyld_cache_mapping_info
+{
+        uint64_t        address;
+        uint64_t        size;
+        uint64_t        fileOffset;
+        uint32_t        maxProt;
+        uint32_t        initProt;
 };
+/* APPLE LOCAL end host shared cache  */
 struct gdb_copy_dyld_cache_local_symbols_info
 {
         uint32_t        nlistOffset;
@@ -3731,8 +4425,24 @@ struct gdb_copy_dyld_cache_local_symbols_info
    followed by the array of struct dyld_cache_local_symbols_entry's,
    followed by the nlist entries for all the dylibs in the shared
    cache, followed by the strings for those nlist records.  All in
-   one big chunk.  The other pointers all point in to this buffer.  */
+   one big chunk.  The other pointers all point in to this buffer.
+
+   The chunk is mmapped straight out of the cache file and stays
+   mapped for the rest of the session, so the minsym readers can use
+   the nlist records and strings where they sit.  It is tens of
+   megabytes on a device that doesn't have many to spare, so we'd
+   rather not copy it.  DYLD_SHARED_CACHE_MAP is the start of the
+   page-aligned mapping, which may begin a little before
+   DYLD_SHARED_CACHE_RAW; if mmap isn't available we fall back to
+   reading the chunk into DYLD_SHARED_CACHE_RAW and leave
+   DYLD_SHARED_CACHE_MAP NULL.  */
 uint8_t *dyld_shared_cache_raw;
+static void *dyld_shared_cache_map = NULL;
+static size_t dyld_shared_cache_map_size = 0;
+
+/* Set once we've looked for the cache file, so we don't go back to
+   the filesystem for every shared cache dylib when it isn't there.  */
+static int dyld_shared_cache_local_syms_tried = 0;
 
 uint8_t *dyld_shared_cache_local_nlists = NULL;
 int dyld_shared_cache_local_nlists_count = 0;
@@ -3741,11 +4451,19 @@ int dyld_shared_cache_strings_size = 0;
 struct gdb_copy_dyld_cache_local_symbols_entry *dyld_shared_cache_entries = NULL;
 int dyld_shared_cache_entries_count = 0;
 
+/* DYLD_SHARED_CACHE_ENTRIES sorted by dylibOffset, built the first
+   time someone looks up an entry.  */
+static struct gdb_copy_dyld_cache_local_symbols_entry **dyld_shared_cache_sorted_entries = NULL;
+
 void
 free_dyld_shared_cache_local_syms ()
 {
-  if (dyld_shared_cache_raw)
+  if (dyld_shared_cache_map != NULL)
+    munmap (dyld_shared_cache_map, dyld_shared_cache_map_size);
+  else if (dyld_shared_cache_raw)
     xfree (dyld_shared_cache_raw);
+  dyld_shared_cache_map = NULL;
+  dyld_shared_cache_map_size = 0;
   dyld_shared_cache_raw = NULL;
   dyld_shared_cache_local_nlists = NULL;
   dyld_shared_cache_local_nlists_count = 0;
@@ -3753,6 +4471,9 @@ free_dyld_shared_cache_local_syms ()
   dyld_shared_cache_strings_size = 0;
   dyld_shared_cache_entries = NULL;
   dyld_shared_cache_entries_count = 0;
+  if (dyld_shared_cache_sorted_entries != NULL)
+    xfree (dyld_shared_cache_sorted_entries);
+  dyld_shared_cache_sorted_entries = NULL;
 }
 
 
@@ -3761,8 +4482,9 @@ get_dyld_shared_cache_local_syms ()
 {
 #if defined (TARGET_ARM) && defined (NM_NEXTSTEP)
 
-  if (dyld_shared_cache_raw != NULL)
+  if (dyld_shared_cache_raw != NULL || dyld_shared_cache_local_syms_tried)
     return;
+  dyld_shared_cache_local_syms_tried = 1;
 
   /* TODO: If the processDetachedFromSharedRegion flag is set in the
      dyld_all_image_infos struct (imported into the struct dyld_raw_infos
@@ -3795,41 +4517,68 @@ get_dyld_shared_cache_local_syms ()
   snprintf(dsc_path, sizeof(dsc_path), 
          "/System/Library/Caches/com.apple.dyld/dyld_shared_cache_%s",
          arch_name);
-  FILE *dsc = fopen (dsc_path, "r");
-  if (dsc == NULL)
+  int dsc = open (dsc_path, O_RDONLY);
+  if (dsc < 0)
     return;
   struct gdb_copy_dyld_cache_header dsc_header;
-  if (fread (&dsc_header, sizeof (dsc_header), 1, dsc) != 1)
+  if (read (dsc, &dsc_header, sizeof (dsc_header)) != sizeof (dsc_header))
     {
-      fclose (dsc);
+      close (dsc);
       return;
     }
 
   // We're dealing with an older dyld shared cache file that doesn't have 
   // this info.
-  if (dsc_header.mappingOffset < sizeof (struct gdb_copy_dyld_cache_header))
+  if (dsc_header.mappingOffset < offsetof (struct gdb_copy_dyld_cache_header, uuid)
+      || dsc_header.localSymbolsSize < sizeof (struct gdb_copy_dyld_cache_local_symbols_info))
     {
-      fclose (dsc);
+      close (dsc);
       return;
     }
 
-  if (fseek (dsc, dsc_header.localSymbolsOffset, SEEK_SET) != 0)
+  /* mmap wants a page-aligned file offset, so map from the start of
+     the page holding the local symbols.  */
+  off_t page_mask = getpagesize () - 1;
+  off_t map_offset = dsc_header.localSymbolsOffset & ~page_mask;
+  size_t map_slop = dsc_header.localSymbolsOffset - map_offset;
+  dyld_shared_cache_map_size = dsc_header.localSymbolsSize + map_slop;
+  dyld_shared_cache_map = mmap (NULL, dyld_shared_cache_map_size, PROT_READ,
+                                MAP_PRIVATE, dsc, map_offset);
+  if (dyld_shared_cache_map != MAP_FAILED)
+    dyld_shared_cache_raw = (uint8_t *) dyld_shared_cache_map + map_slop;
+  else
     {
-      fclose (dsc);
-      return;
+      dyld_shared_cache_map = NULL;
+      dyld_shared_cache_map_size = 0;
+      dyld_shared_cache_raw = (uint8_t *) xmalloc (dsc_header.localSymbolsSize);
+      if (lseek (dsc, dsc_header.localSymbolsOffset, SEEK_SET) == -1
+          || read (dsc, dyld_shared_cache_raw, dsc_header.localSymbolsSize)
+             != dsc_header.localSymbolsSize)
+        {
+          free_dyld_shared_cache_local_syms ();
+          close (dsc);
+          return;
+        }
     }
+  close (dsc);
 
-  dyld_shared_cache_raw = (uint8_t *) xmalloc (dsc_header.localSymbolsSize);
-  if (fread (dyld_shared_cache_raw, dsc_header.localSymbolsSize, 1, dsc) != 1)
+  struct gdb_copy_dyld_cache_local_symbols_info *locsyms_header;
+  locsyms_header = (struct gdb_copy_dyld_cache_local_symbols_info *) dyld_shared_cache_raw;
+
+  /* Don't trust a header that points outside the region we have.  */
+  if (locsyms_header->nlistOffset
+        + (uint64_t) locsyms_header->nlistCount * nlist_entry_size
+        > dsc_header.localSymbolsSize
+      || locsyms_header->stringsOffset + (uint64_t) locsyms_header->stringsSize
+        > dsc_header.localSymbolsSize
+      || locsyms_header->entriesOffset
+        + (uint64_t) locsyms_header->entriesCount
+          * sizeof (struct gdb_copy_dyld_cache_local_symbols_entry)
+        > dsc_header.localSymbolsSize)
     {
       free_dyld_shared_cache_local_syms ();
-      fclose (dsc);
       return;
     }
-  fclose (dsc);
-
-  struct gdb_copy_dyld_cache_local_symbols_info *locsyms_header;
-  locsyms_header = (struct gdb_copy_dyld_cache_local_symbols_info *) dyld_shared_cache_raw;
 
   dyld_shared_cache_local_nlists = dyld_shared_cache_raw + locsyms_header->nlistOffset;
   dyld_shared_cache_local_nlists_count = locsyms_header->nlistCount;
@@ -3837,25 +4586,252 @@ get_dyld_shared_cache_local_syms ()
   dyld_shared_cache_strings = (char *) dyld_shared_cache_raw + locsyms_header->stringsOffset;
   dyld_shared_cache_strings_size = locsyms_header->stringsSize;
 
-  dyld_shared_cache_entries = (struct gdb_copy_dyld_cache_local_symbols_entry *) dyld_shared_cache_raw + locsyms_header->entriesOffset;
+  dyld_shared_cache_entries = (struct gdb_copy_dyld_cache_local_symbols_entry *) (dyld_shared_cache_raw + locsyms_header->entriesOffset);
   dyld_shared_cache_entries_count = locsyms_header->entriesCount;
 #endif
 }
 
+static int
+compare_dyld_shared_cache_entries (const void *a, const void *b)
+{
+  const struct gdb_copy_dyld_cache_local_symbols_entry *ea
+    = *(struct gdb_copy_dyld_cache_local_symbols_entry * const *) a;
+  const struct gdb_copy_dyld_cache_local_symbols_entry *eb
+    = *(struct gdb_copy_dyld_cache_local_symbols_entry * const *) b;
+
+  if (ea->dylibOffset < eb->dylibOffset)
+    return -1;
+  if (ea->dylibOffset > eb->dylibOffset)
+    return 1;
+  return 0;
+}
+
 struct gdb_copy_dyld_cache_local_symbols_entry *
 get_dyld_shared_cache_entry (CORE_ADDR intended_load_addr)
 {
   get_dyld_shared_cache_local_syms ();
-  int i = 0;
-  while (i < dyld_shared_cache_entries_count)
+  if (dyld_shared_cache_entries_count == 0)
+    return NULL;
+
+  if (dyld_shared_cache_sorted_entries == NULL)
+    {
+      int i;
+      dyld_shared_cache_sorted_entries
+        = xmalloc (dyld_shared_cache_entries_count
+                   * sizeof (struct gdb_copy_dyld_cache_local_symbols_entry *));
+      for (i = 0; i < dyld_shared_cache_entries_count; i++)
+        dyld_shared_cache_sorted_entries[i] = &dyld_shared_cache_entries[i];
+      qsort (dyld_shared_cache_sorted_entries, dyld_shared_cache_entries_count,
+             sizeof (struct gdb_copy_dyld_cache_local_symbols_entry *),
+             compare_dyld_shared_cache_entries);
+    }
+
+  CORE_ADDR want = intended_load_addr - 0x30000000;
+  int lo = 0;
+  int hi = dyld_shared_cache_entries_count - 1;
+  while (lo <= hi)
     {
-      if (dyld_shared_cache_entries[i].dylibOffset == intended_load_addr - 0x30000000)
-        return &dyld_shared_cache_entries[i];
-      i++;
+      int mid = lo + (hi - lo) / 2;
+      CORE_ADDR here = dyld_shared_cache_sorted_entries[mid]->dylibOffset;
+      if (here == want)
+        return dyld_shared_cache_sorted_entries[mid];
+      if (here < want)
+        lo = mid + 1;
+      else
+        hi = mid - 1;
     }
   return NULL;
 }
 
+/* APPLE LOCAL begin host shared cache  */
+/* When debugging a process on a device, the libraries in the dyld
+   shared cache are read out of the device's memory -- headers, load
+   commands, symbol and string tables -- which is hundreds of
+   megabytes over the wire.  If the user has a copy of the same cache
+   on the host, we map it and serve those reads from it instead.
+
+   The copy is only used once its UUID has been checked against the
+   one dyld reports for the cache the inferior is running with, and
+   only for the cache's read-only mappings.  __DATA is written by dyld
+   and by the program, so it is always read from the target.  */
+
+static char *host_shared_cache_filename = NULL;
+
+/* What dyld told us about the inferior's shared cache.  */
+static uint8_t target_shared_cache_uuid[16];
+static int target_shared_cache_uuid_valid = 0;
+static CORE_ADDR target_shared_cache_slide = 0;
+
+/* The mapped copy of HOST_SHARED_CACHE_FILENAME, if it matched.
+   HOST_SHARED_CACHE_CHECKED is set once we have looked at the file for
+   the current target UUID, whatever we found.  */
+static void *host_shared_cache_map = NULL;
+static size_t host_shared_cache_map_size = 0;
+static struct gdb_copy_dyld_cache_mapping_info *host_shared_cache_mappings;
+static int host_shared_cache_mappings_count = 0;
+static int host_shared_cache_checked = 0;
+
+static void
+host_shared_cache_close (void)
+{
+  if (host_shared_cache_map != NULL)
+    munmap (host_shared_cache_map, host_shared_cache_map_size);
+  host_shared_cache_map = NULL;
+  host_shared_cache_map_size = 0;
+  host_shared_cache_mappings = NULL;
+  host_shared_cache_mappings_count = 0;
+  host_shared_cache_checked = 0;
+}
+
+/* Map HOST_SHARED_CACHE_FILENAME if that hasn't been tried yet, and
+   return 1 if it is a cache with the inferior's UUID.  */
+
+static int
+host_shared_cache_open (void)
+{
+  struct gdb_copy_dyld_cache_header *header;
+  struct stat st;
+  char *filename;
+  int fd;
+
+  if (host_shared_cache_checked)
+    return host_shared_cache_map != NULL;
+
+  if (!target_shared_cache_uuid_valid
+      || host_shared_cache_filename == NULL
+      || *host_shared_cache_filename == '\0')
+    return 0;
+  host_shared_cache_checked = 1;
+
+  filename = tilde_expand (host_shared_cache_filename);
+  fd = open (filename, O_RDONLY);
+  if (fd < 0)
+    {
+      warning ("Unable to open dyld shared cache \"%s\": %s",
+               filename, safe_strerror (errno));
+      xfree (filename);
+      return 0;
+    }
+
+  if (fstat (fd, &st) != 0
+      || st.st_size < sizeof (struct gdb_copy_dyld_cache_header))
+    {
+      close (fd);
+      xfree (filename);
+      return 0;
+    }
+
+  host_shared_cache_map_size = st.st_size;
+  host_shared_cache_map = mmap (NULL, host_shared_cache_map_size, PROT_READ,
+                                MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (host_shared_cache_map == MAP_FAILED)
+    {
+      host_shared_cache_map = NULL;
+      host_shared_cache_map_size = 0;
+      xfree (filename);
+      return 0;
+    }
+
+  header = (struct gdb_copy_dyld_cache_header *) host_shared_cache_map;
+  if (strncmp (header->magic, "dyld_v1", 7) != 0
+      || header->mappingOffset < sizeof (struct gdb_copy_dyld_cache_header)
+      || header->mappingOffset
+         + (uint64_t) header->mappingCount
+           * sizeof (struct gdb_copy_dyld_cache_mapping_info)
+         > host_shared_cache_map_size)
+    {
+      warning ("\"%s\" is not a dyld shared cache gdb can use.", filename);
+      host_shared_cache_close ();
+      host_shared_cache_checked = 1;
+      xfree (filename);
+      return 0;
+    }
+
+  if (memcmp (header->uuid, target_shared_cache_uuid,
+              sizeof (target_shared_cache_uuid)) != 0)
+    {
+      warning ("The UUID of dyld shared cache \"%s\" doesn't match the "
+               "inferior's; reading shared cache libraries from the target.",
+               filename);
+      host_shared_cache_close ();
+      host_shared_cache_checked = 1;
+      xfree (filename);
+      return 0;
+    }
+
+  host_shared_cache_mappings = (struct gdb_copy_dyld_cache_mapping_info *)
+    ((uint8_t *) host_shared_cache_map + header->mappingOffset);
+  host_shared_cache_mappings_count = header->mappingCount;
+  xfree (filename);
+  return 1;
+}
+
+void
+macosx_set_target_shared_cache (const uint8_t *uuid, CORE_ADDR slide)
+{
+  static const uint8_t null_uuid[16];
+
+  if (uuid == NULL || memcmp (uuid, null_uuid, sizeof (null_uuid)) == 0)
+    {
+      if (target_shared_cache_uuid_valid)
+        host_shared_cache_close ();
+      target_shared_cache_uuid_valid = 0;
+      return;
+    }
+
+  if (target_shared_cache_uuid_valid
+      && memcmp (uuid, target_shared_cache_uuid,
+                 sizeof (target_shared_cache_uuid)) == 0)
+    {
+      target_shared_cache_slide = slide;
+      return;
+    }
+
+  host_shared_cache_close ();
+  memcpy (target_shared_cache_uuid, uuid, sizeof (target_shared_cache_uuid));
+  target_shared_cache_uuid_valid = 1;
+  target_shared_cache_slide = slide;
+}
+
+int
+macosx_host_shared_cache_read (CORE_ADDR addr, gdb_byte *buf, size_t len)
+{
+  CORE_ADDR unslid;
+  int i;
+
+  if (!host_shared_cache_open ())
+    return 0;
+
+  unslid = addr - target_shared_cache_slide;
+  for (i = 0; i < host_shared_cache_mappings_count; i++)
+    {
+      struct gdb_copy_dyld_cache_mapping_info *m;
+      m = &host_shared_cache_mappings[i];
+      if (unslid < m->address || unslid + len > m->address + m->size)
+        continue;
+
+      if (m->initProt & VM_PROT_WRITE)
+        return 0;
+      if (m->fileOffset + (unslid - m->address) + len
+          > host_shared_cache_map_size)
+        return 0;
+
+      memcpy (buf, (uint8_t *) host_shared_cache_map + m->fileOffset
+                   + (unslid - m->address), len);
+      return 1;
+    }
+  return 0;
+}
+
+static void
+set_host_shared_cache_file (char *args, int from_tty,
+                            struct cmd_list_element *c)
+{
+  host_shared_cache_close ();
+}
+/* APPLE LOCAL end host shared cache  */
+
 
 void
 _initialize_macosx_tdep ()
@@ -3880,6 +4856,22 @@ Also takes file:line to hilight the file at the given line."));
 
   add_com ("update", class_obscure, update_command,
            "Re-read current state information from inferior.");
+
+  /* APPLE LOCAL begin dyld stub map  */
+  dyld_stub_map_objfile_data
+    = register_objfile_data_with_cleanup (dyld_stub_map_free);
+
+  add_setshow_boolean_cmd ("dyld-stub-cache", class_maintenance,
+			   &dyld_stub_cache_enabled, _("\
+Set whether the targets of dyld stubs are remembered."), _("\
+Show whether the targets of dyld stubs are remembered."), _("\
+When on, the function each dyld stub resolves to, and whether a pc is a\n\
+stub at all, is kept with the pc's objfile until an objfile is added or\n\
+removed, so stepping through the same stub again skips the lookups."),
+			   NULL, show_dyld_stub_cache,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end dyld stub map  */
   
   add_setshow_boolean_cmd ("locate-dsym", class_obscure,
 			    &dsym_locate_enabled, _("\
@@ -3889,6 +4881,64 @@ If set, gdb will try and locate dSYM files using the DebugSymbols framework."),
 			    NULL, NULL,
 			    &setlist, &showlist);
 
+  /* APPLE LOCAL begin dsym path cache  */
+  add_setshow_boolean_cmd ("dsym-path-cache", class_obscure,
+			    &dsym_path_cache_enabled, _("\
+Set whether gdb remembers where it found dSYM files."), _("\
+Show whether gdb remembers where it found dSYM files."), _("\
+If set, the path of each dSYM found is kept in\n\
+~/Library/Caches/com.apple.gdb.dsym-paths, with its UUID and modification\n\
+time, and used on later loads instead of searching for the dSYM again."),
+			    NULL, NULL,
+			    &setlist, &showlist);
+
+  add_setshow_filename_cmd ("dsym-index-file", class_obscure,
+			    &dsym_index_filename, _("\
+Set a file listing the dSYMs of a symbol store by UUID."), _("\
+Show the file listing the dSYMs of a symbol store by UUID."), _("\
+The file has one \"UUID MTIME PATH\" line per dSYM, PATH being the dSYM's\n\
+Mach-O file and MTIME its modification time, or 0 not to check it.\n\
+It is consulted before searching the file system for a dSYM."),
+			    set_dsym_index_file, NULL,
+			    &setlist, &showlist);
+  /* APPLE LOCAL end dsym path cache  */
+
+  /* APPLE LOCAL begin host shared cache  */
+  add_setshow_filename_cmd ("dyld-shared-cache-file", class_obscure,
+			    &host_shared_cache_filename, _("\
+Set a local copy of the dyld shared cache the inferior is using."), _("\
+Show the local copy of the dyld shared cache the inferior is using."), _("\
+When the file's UUID matches the inferior's shared cache, the headers,\n\
+load commands and symbols of shared cache libraries are read from it\n\
+instead of from the target's memory.  Writable data is still read from\n\
+the target."),
+			    set_host_shared_cache_file, NULL,
+			    &setlist, &showlist);
+  /* APPLE LOCAL end host shared cache  */
+
+  /* APPLE LOCAL kext path cache  */
+  add_setshow_boolean_cmd ("kext-path-cache", class_obscure,
+			    &kext_path_cache_enabled, _("\
+Set whether gdb remembers where it found kext executables."), _("\
+Show whether gdb remembers where it found kext executables."), _("\
+If set, the path of each kext's symbol-rich executable is kept in\n\
+~/Library/Caches/com.apple.gdb.kext-paths, keyed by UUID, and used on\n\
+later loads instead of searching for the kext's dSYM again."),
+			    NULL, NULL,
+			    &setlist, &showlist);
+
+  /* APPLE LOCAL begin kernel address cache  */
+  add_setshow_boolean_cmd ("kernel-address-cache", class_obscure,
+			    &kernel_address_cache_enabled, _("\
+Set whether gdb remembers where it found kernels in memory."), _("\
+Show whether gdb remembers where it found kernels in memory."), _("\
+If set, the address each kernel was found at by the search through memory\n\
+is kept in ~/Library/Caches/com.apple.gdb.kernel-addresses, keyed by UUID,\n\
+and checked before searching again."),
+			    NULL, NULL,
+			    &setlist, &showlist);
+  /* APPLE LOCAL end kernel address cache  */
+
   add_setshow_boolean_cmd ("kaslr-memory-search", class_obscure,
 			    &kaslr_memory_search_enabled, _("\
 Set whether gdb should do a search through memory for the kernel on 'target remote'."), _("\
@@ -37,6 +37,8 @@ int macosx_record_symbols_from_sect_p (bfd *abfd, unsigned char macho_type,
 				       unsigned char macho_sect);
 
 char *macosx_locate_dsym (struct objfile *objfile);
+/* APPLE LOCAL debug info on demand  */
+char *macosx_locate_dsym_any_level (struct objfile *objfile);
 char *macosx_locate_kext_executable_by_symfile(bfd *abfd);
 struct objfile *macosx_find_objfile_matching_dsym_in_bundle (char *dsym_bundle_path, 
 							     char **out_full_path);
@@ -116,5 +118,17 @@ void free_dyld_shared_cache_local_syms ();
 void get_dyld_shared_cache_local_syms ();
 struct gdb_copy_dyld_cache_local_symbols_entry *get_dyld_shared_cache_entry (CORE_ADDR intended_load_addr);
 
+/* APPLE LOCAL begin host shared cache  */
+/* Tell the host shared cache code the UUID and slide of the shared
+   cache the inferior uses, or pass a NULL UUID if it has none.  */
+void macosx_set_target_shared_cache (const uint8_t *uuid, CORE_ADDR slide);
+
+/* If the LEN bytes at inferior address ADDR lie in a read-only part of
+   the shared cache, and "set dyld-shared-cache-file" names a matching
+   copy of it, copy them from there into BUF and return 1.  Otherwise
+   return 0.  */
+int macosx_host_shared_cache_read (CORE_ADDR addr, gdb_byte *buf, size_t len);
+/* APPLE LOCAL end host shared cache  */
+
 
 #endif /* __GDB_MACOSX_TDEP_H__ */
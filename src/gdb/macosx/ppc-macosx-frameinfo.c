@@ -37,6 +37,8 @@
 #include "command.h"
 #include "regcache.h"
 #include "ppc-tdep.h"
+/* APPLE LOCAL prologue analysis cache  */
+#include "prologue-memo.h"
 
 /* Limit the number of skipped non-prologue instructions, as the
    examining of the prologue is expensive.  The current use that
@@ -185,9 +187,12 @@ ppc_print_properties (ppc_function_properties * props)
 /* Return $pc value after skipping a function prologue and also return
    information about a function frame. */
 
-CORE_ADDR
-ppc_parse_instructions (CORE_ADDR start, CORE_ADDR end,
-                        ppc_function_properties * props)
+/* APPLE LOCAL prologue analysis cache: The scanner proper;
+   ppc_parse_instructions below remembers its results.  */
+
+static CORE_ADDR
+ppc_parse_instructions_1 (CORE_ADDR start, CORE_ADDR end,
+                          ppc_function_properties * props)
 {
   CORE_ADDR pc = start;
   CORE_ADDR last_recognized_insn = start;
@@ -817,6 +822,40 @@ ppc_parse_instructions (CORE_ADDR start, CORE_ADDR end,
     return last_recognized_insn + 4;
 }
 
+/* APPLE LOCAL begin prologue analysis cache  */
+/* What prologue_memo_store keeps for one ppc_parse_instructions call.  */
+
+struct ppc_prologue_memo
+{
+  CORE_ADDR body_start;
+  ppc_function_properties props;
+};
+
+CORE_ADDR
+ppc_parse_instructions (CORE_ADDR start, CORE_ADDR end,
+                        ppc_function_properties * props)
+{
+  struct ppc_prologue_memo memo;
+
+  CHECK_FATAL (props != NULL);
+
+  /* Both ppc_find_function_boundaries and ppc_frame_function_properties
+     scan the same prologue for every frame they look at, and the
+     result only depends on the text between START and END.  */
+  if (prologue_memo_lookup (start, end, 0, &memo, sizeof (memo)))
+    {
+      *props = memo.props;
+      return memo.body_start;
+    }
+
+  memset (&memo, 0, sizeof (memo));
+  memo.body_start = ppc_parse_instructions_1 (start, end, props);
+  memo.props = *props;
+  prologue_memo_store (start, end, 0, &memo, sizeof (memo));
+  return memo.body_start;
+}
+/* APPLE LOCAL end prologue analysis cache  */
+
 void
 ppc_clear_function_boundaries_request (ppc_function_boundaries_request *
                                        request)
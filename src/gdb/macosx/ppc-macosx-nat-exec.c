@@ -37,6 +37,8 @@
 #include "ppc-macosx-regs.h"
 #include "macosx-nat-mutils.h"
 #include "macosx-nat-inferior.h"
+/* APPLE LOCAL trace bit  */
+#include "macosx-nat-infthread.h"
 
 extern macosx_inferior_status *macosx_status;
 
@@ -80,6 +82,9 @@ fetch_inferior_registers (int regno)
 	  printf ("Error calling thread_get_state for GP registers for thread 0x%ulx", current_thread);
 	  MACH_CHECK_ERROR (ret);
 	}
+      /* APPLE LOCAL trace bit: Don't show gdb's own single-stepping.  */
+      if (macosx_thread_trace_bit_set_p (current_thread))
+        gp_regs.srr1 &= ~0x400UL;
       ppc_macosx_fetch_gp_registers_64 (&gp_regs);
     }
 
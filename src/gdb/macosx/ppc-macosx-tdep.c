@@ -1003,6 +1003,92 @@ ppc_macosx_frame_align (struct gdbarch *gdbarch, CORE_ADDR addr)
    return (addr & -16);
 }
 
+/* APPLE LOCAL begin displaced stepping  */
+/* How ppc_macosx_displaced_step_fixup should treat the pc after a
+   displaced step, plus PPC_DISPLACED_LINK if the branch set LR.  */
+
+enum
+{
+  PPC_DISPLACED_PLAIN,
+  PPC_DISPLACED_RELATIVE,
+  PPC_DISPLACED_ABSOLUTE
+};
+
+#define PPC_DISPLACED_CLASS_MASK 0x3
+#define PPC_DISPLACED_LINK 0x4
+
+static int
+ppc_macosx_displaced_step_copy_insn (struct gdbarch *gdbarch,
+				     CORE_ADDR from, gdb_byte *buf,
+				     int *kind)
+{
+  unsigned long insn;
+  int op, xo;
+
+  if (deprecated_read_memory_nobpt (from, buf, 4) != 0)
+    return 0;
+  insn = extract_unsigned_integer (buf, 4);
+  op = insn >> 26;
+  xo = (insn >> 1) & 0x3ff;
+
+  switch (op)
+    {
+    case 16:			/* bc */
+    case 18:			/* b */
+      *kind = (insn & 2) ? PPC_DISPLACED_ABSOLUTE : PPC_DISPLACED_RELATIVE;
+      break;
+    case 19:
+      if (xo == 16 || xo == 528)	/* bclr, bcctr */
+	*kind = PPC_DISPLACED_ABSOLUTE;
+      else
+	*kind = PPC_DISPLACED_PLAIN;
+      break;
+    case 2:			/* tdi */
+    case 3:			/* twi */
+    case 17:			/* sc */
+      return 0;
+    case 31:
+      if (xo == 4 || xo == 68)	/* tw, td */
+	return 0;
+      *kind = PPC_DISPLACED_PLAIN;
+      break;
+    default:
+      *kind = PPC_DISPLACED_PLAIN;
+      break;
+    }
+
+  if (*kind != PPC_DISPLACED_PLAIN && (insn & 1))
+    *kind |= PPC_DISPLACED_LINK;
+  return 4;
+}
+
+static void
+ppc_macosx_displaced_step_fixup (struct gdbarch *gdbarch, int kind,
+				 CORE_ADDR from, CORE_ADDR to,
+				 struct regcache *regcache)
+{
+  struct gdbarch_tdep *tdep = gdbarch_tdep (gdbarch);
+  ULONGEST pc, lr;
+
+  regcache_cooked_read_unsigned (regcache, PC_REGNUM, &pc);
+
+  /* A relative branch lands the same distance away as the original
+     would have; anything that fell through is just past the copy.  An
+     absolute branch that was taken is already right.  */
+  if ((kind & PPC_DISPLACED_CLASS_MASK) != PPC_DISPLACED_ABSOLUTE
+      || pc == to + 4)
+    regcache_cooked_write_unsigned (regcache, PC_REGNUM, pc + from - to);
+
+  if (kind & PPC_DISPLACED_LINK)
+    {
+      regcache_cooked_read_unsigned (regcache, tdep->ppc_lr_regnum, &lr);
+      if (lr == to + 4)
+	regcache_cooked_write_unsigned (regcache, tdep->ppc_lr_regnum,
+					from + 4);
+    }
+}
+/* APPLE LOCAL end displaced stepping  */
+
 static struct gdbarch *
 ppc_gdbarch_init (struct gdbarch_info info, struct gdbarch_list *arches)
 {
@@ -1131,6 +1217,13 @@ ppc_gdbarch_init (struct gdbarch_info info, struct gdbarch_list *arches)
 
   set_gdbarch_fetch_pointer_argument (gdbarch, ppc_fetch_pointer_argument);
 
+  /* APPLE LOCAL begin displaced stepping  */
+  set_gdbarch_displaced_step_copy_insn (gdbarch,
+					ppc_macosx_displaced_step_copy_insn);
+  set_gdbarch_displaced_step_fixup (gdbarch,
+				    ppc_macosx_displaced_step_fixup);
+  /* APPLE LOCAL end displaced stepping  */
+
   /* Hook in ABI-specific overrides, if they have been registered.  */
   gdbarch_init_osabi (info, gdbarch);
 
@@ -77,6 +77,8 @@
 
 #include "kdp-udp.h"
 #include "kdp-transactions.h"
+/* APPLE LOCAL remote wire stats  */
+#include "remote.h"
 
 #include <CoreFoundation/CoreFoundation.h>
 #include <CoreFoundation/CFPropertyList.h>
@@ -141,6 +143,8 @@ static int remote_kdp_feature = 0;
 struct target_ops kdp_ops;
 
 static void kdp_mourn_inferior ();
+/* APPLE LOCAL kdp read cache  */
+static void kdp_read_cache_flush (void);
 
 static void
 set_timeouts (char *args, int from_tty, struct cmd_list_element *cmd)
@@ -568,6 +572,9 @@ kdp_attach (char *args, int from_tty)
       args = "";
     }
 
+  /* APPLE LOCAL kdp read cache: This may be a different kernel.  */
+  kdp_read_cache_flush ();
+
   {
     char *s = args;
     while ((*s != '\0') && isspace (*s))
@@ -704,6 +711,8 @@ kdp_attach (char *args, int from_tty)
 
   inferior_ptid = pid_to_ptid (KDP_REMOTE_ID);
   kdp_stopped = 1;
+  /* APPLE LOCAL remote wire stats  */
+  remote_wire_stats_stopped (&kdp_wire_stats, 1);
 
   printf_unfiltered ("Connected.\n");
 }
@@ -983,6 +992,9 @@ kdp_resume (ptid_t pid, int step, enum target_signal sig)
       error ("kdp: unable to resume (not connected)");
     }
 
+  /* APPLE LOCAL kdp read cache  */
+  kdp_read_cache_flush ();
+
   if (step)
     {
       kdp_set_trace_bit (1);
@@ -1007,6 +1019,8 @@ kdp_resume (ptid_t pid, int step, enum target_signal sig)
     }
 
   kdp_stopped = 0;
+  /* APPLE LOCAL remote wire stats  */
+  remote_wire_stats_stopped (&kdp_wire_stats, 0);
 
   if (target_can_async_p ())
     target_async (inferior_event_handler, 0);
@@ -1054,6 +1068,8 @@ kdp_wait (ptid_t pid,
   kdp_set_trace_bit (0);
 
   kdp_stopped = 1;
+  /* APPLE LOCAL remote wire stats  */
+  remote_wire_stats_stopped (&kdp_wire_stats, 1);
   select_frame (get_current_frame ());
 
   status->kind = TARGET_WAITKIND_STOPPED;
@@ -1844,9 +1860,105 @@ kdp_prepare_to_store (void)
   kdp_fetch_registers (-1);
 }
 
+/* APPLE LOCAL begin kdp read cache  */
+/* Every kdp request is a full UDP round trip to the remote kernel,
+   which can't have more than one outstanding, and gdb's own reads are
+   mostly a word or two at a time - walking a stack, or a kext's load
+   commands, costs a round trip per word.  So reads are done a whole
+   packet's worth at a time, aligned to KDP_MAX_DATA_SIZE, and the
+   blocks kept until the kernel next runs.  The kernel is stopped
+   while we're talking to it, so a block only goes stale when gdb
+   writes to it, or target_stop_generation says the kernel has run.  */
+
+#define KDP_READ_CACHE_BLOCKS 64
+
+struct kdp_read_cache_block
+{
+  CORE_ADDR addr;
+  unsigned int generation;
+  gdb_byte data[KDP_MAX_DATA_SIZE];
+};
+
+static struct kdp_read_cache_block kdp_read_cache[KDP_READ_CACHE_BLOCKS];
+
+static int kdp_read_cache_enabled = 1;
+
+static void
+show_kdp_read_cache_enabled (struct ui_file *file, int from_tty,
+			     struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Caching of memory read over KDP is %s.\n"),
+		    value);
+}
+
+static void
+kdp_read_cache_flush (void)
+{
+  int i;
+
+  for (i = 0; i < KDP_READ_CACHE_BLOCKS; i++)
+    kdp_read_cache[i].generation = 0;
+}
+
+static void
+kdp_read_cache_invalidate (CORE_ADDR memaddr, int len)
+{
+  int i;
+
+  for (i = 0; i < KDP_READ_CACHE_BLOCKS; i++)
+    if (kdp_read_cache[i].addr < memaddr + len
+	&& memaddr < kdp_read_cache[i].addr + KDP_MAX_DATA_SIZE)
+      kdp_read_cache[i].generation = 0;
+}
+
+static int kdp_xfer_memory_1 (CORE_ADDR memaddr, gdb_byte *myaddr, int len,
+			      int write);
+
 static int
 kdp_xfer_memory (CORE_ADDR memaddr, gdb_byte *myaddr, int len, int write,
                  struct mem_attrib *attrib, struct target_ops *target)
+{
+  CORE_ADDR blockaddr;
+  struct kdp_read_cache_block *block;
+  int offset;
+
+  if (write)
+    {
+      kdp_read_cache_invalidate (memaddr, len);
+      return kdp_xfer_memory_1 (memaddr, myaddr, len, write);
+    }
+
+  if (!kdp_read_cache_enabled || len <= 0 || !kdp_is_connected (&c))
+    return kdp_xfer_memory_1 (memaddr, myaddr, len, write);
+
+  blockaddr = memaddr & ~(CORE_ADDR) (KDP_MAX_DATA_SIZE - 1);
+  block = &kdp_read_cache[(blockaddr / KDP_MAX_DATA_SIZE)
+			  % KDP_READ_CACHE_BLOCKS];
+  if (block->generation != target_stop_generation
+      || block->addr != blockaddr)
+    {
+      /* Part of the block may not be mapped, in which case the kernel
+	 refuses all of it; just read what we were asked for.  */
+      block->generation = 0;
+      if (kdp_xfer_memory_1 (blockaddr, block->data, KDP_MAX_DATA_SIZE, 0)
+	  != KDP_MAX_DATA_SIZE)
+	return kdp_xfer_memory_1 (memaddr, myaddr, len, write);
+      block->addr = blockaddr;
+      block->generation = target_stop_generation;
+    }
+
+  offset = memaddr - blockaddr;
+  if (len > KDP_MAX_DATA_SIZE - offset)
+    len = KDP_MAX_DATA_SIZE - offset;
+  memcpy (myaddr, block->data + offset, len);
+  return len;
+}
+/* APPLE LOCAL end kdp read cache  */
+
+/* Transfer at most LEN bytes at MEMADDR with a single kdp request.  */
+
+static int
+kdp_xfer_memory_1 (CORE_ADDR memaddr, gdb_byte *myaddr, int len, int write)
 {
   kdp_return_t kdpret;
 
@@ -2325,6 +2437,12 @@ _initialize_remote_kdp (void)
   init_kdp_ops ();
   add_target (&kdp_ops);
 
+  /* APPLE LOCAL remote wire stats: KDP retransmits a request that
+     times out, so only the latest one can be waiting.  */
+  kdp_wire_stats.name = "KDP";
+  kdp_wire_stats.max_in_flight = 1;
+  remote_wire_stats_register (&kdp_wire_stats);
+
   add_com ("kdp-reattach", class_run, kdp_reattach_command,
            "Re-attach to a (possibly connected) remote Mac OS X kernel.\nThe kernel must support the reattach packet.");
   add_com ("kdp-reboot", class_run, kdp_reboot_command,
@@ -2398,5 +2516,16 @@ No additional help."),
      NULL,
      &setlist, &showlist);
 
+  /* APPLE LOCAL kdp read cache  */
+  add_setshow_boolean_cmd ("kdp-read-cache", class_maintenance,
+			   &kdp_read_cache_enabled, _("\
+Set whether memory read over KDP is cached while the kernel is stopped."), _("\
+Show whether memory read over KDP is cached while the kernel is stopped."), _("\
+When on, memory is read from the remote kernel a whole packet at a time\n\
+and kept until the kernel next runs, instead of one request per read."),
+			   NULL, show_kdp_read_cache_enabled,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+
   kdp_reset (&c);
 }
@@ -484,6 +484,8 @@ sym_read_type (struct objfile *objfile,
   bfd_sym_type_table_entry index;
   bfd_sym_type_information_table_entry entry;
   unsigned char buf[4096];
+  /* APPLE LOCAL mapped xsym  */
+  unsigned char *data;
 
   struct type *type = NULL;
   struct symbol *symbol = NULL;
@@ -528,15 +530,13 @@ sym_read_type (struct objfile *objfile,
       return;
     }
 
-  if (bfd_seek (abfd, entry.offset, SEEK_SET) < 0)
-    {
-      return;
-    }
-
-  if (bfd_bread (buf, entry.physical_size, abfd) != entry.physical_size)
+  /* APPLE LOCAL begin mapped xsym  */
+  data = bfd_sym_read_data (abfd, entry.offset, entry.physical_size, buf);
+  if (data == NULL)
     {
       return;
     }
+  /* APPLE LOCAL end mapped xsym  */
 
   typename = bfd_sym_symbol_name (objfile->obfd, entry.nte_index);
 
@@ -556,7 +556,7 @@ sym_read_type (struct objfile *objfile,
     }
 
   ret =
-    sym_parse_type (objfile, typevec, ntypes, buf, entry.physical_size, 0,
+    sym_parse_type (objfile, typevec, ntypes, data, entry.physical_size, 0,
                     NULL, &type, NULL, NULL);
   if ((ret != 0) || (type == NULL))
     {
@@ -35,14 +35,20 @@ sal_macro_scope (struct symtab_and_line sal)
 {
   struct macro_source_file *mainfile, *inclusion;
   struct macro_scope *ms;
+  /* APPLE LOCAL lazy macro tables  */
+  struct macro_table *table;
 
-  if (! sal.symtab
-      || ! sal.symtab->macro_table)
+  /* APPLE LOCAL begin lazy macro tables  */
+  if (! sal.symtab)
     return 0;
+  table = symtab_macro_table (sal.symtab);
+  if (! table)
+    return 0;
+  /* APPLE LOCAL end lazy macro tables  */
 
   ms = (struct macro_scope *) xmalloc (sizeof (*ms));
 
-  mainfile = macro_main (sal.symtab->macro_table);
+  mainfile = macro_main (table);
   inclusion = macro_lookup_inclusion (mainfile, sal.symtab->filename);
 
   if (inclusion)
@@ -43,6 +43,8 @@
 
 #include "interps.h"
 #include "main.h"
+/* APPLE LOCAL startup stats */
+#include "gdb-stats.h"
 
 #include <pthread.h>
 
@@ -165,6 +167,9 @@ captured_main (void *data)
 
   long time_at_startup = get_run_time ();
 
+  /* APPLE LOCAL startup stats */
+  startup_stats_start ();
+
 #if defined (HAVE_SETLOCALE) && defined (HAVE_LC_MESSAGES)
   setlocale (LC_MESSAGES, "");
 #endif
@@ -275,7 +280,8 @@ captured_main (void *data)
       OPT_WINDOWS,
       OPT_WAITFOR,  /* APPLE LOCAL */
       OPT_ARCH,     /* APPLE LOCAL */
-      OPT_OSABI	    /* APPLE LOCAL */
+      OPT_OSABI,    /* APPLE LOCAL */
+      OPT_STARTUP_STATS	/* APPLE LOCAL */
     };
     static struct option long_options[] =
     {
@@ -341,6 +347,8 @@ captured_main (void *data)
       {"arch", required_argument, 0, OPT_ARCH},
 /* APPLE LOCAL: */
       {"osabi", required_argument, 0, OPT_OSABI},
+/* APPLE LOCAL: */
+      {"startup-stats", no_argument, &startup_stats, 1},
       {"l", required_argument, 0, 'l'},
       {0, no_argument, 0, 0}
     };
@@ -583,6 +591,9 @@ extern int gdbtk_test (char *);
       quiet = 1;
   }
 
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("argument parsing");
+
   /* Initialize all files.  Give the interpreter a chance to take
      control of the console via the deprecated_init_ui_hook ().  */
   gdb_init (argv[0]);
@@ -648,6 +659,8 @@ extern int gdbtk_test (char *);
         exit (1);
       }
   }
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("interpreter setup");
 
   /* FIXME: cagney/2003-02-03: The big hack (part 2 of 2) that lets
      GDB retain the old MI1 interpreter startup behavior.  Output the
@@ -687,6 +700,8 @@ extern int gdbtk_test (char *);
     }
   do_cleanups (ALL_CLEANUPS);
   /* APPLE LOCAL end global gdbinit */
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("global init file");
  
   /* APPLE LOCAL: Set the $_Xcode convenience variable at '0' before sourcing
      any .gdbinit files.  Xcode will override this to 1 when it is launching
@@ -713,6 +728,8 @@ extern int gdbtk_test (char *);
 	    catch_command_errors (source_file, homeinit, 0, RETURN_MASK_ALL);
 	  }
     }
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("home init file");
 
   /* Now perform all the actions indicated by the arguments.  */
   if (cdarg != NULL)
@@ -822,6 +839,8 @@ extern int gdbtk_test (char *);
   if (osabiarg != NULL)
     set_osabi_option (osabiarg);
   /* APPLE LOCAL END */
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("directories and architecture");
 
   if (execarg != NULL
       && symarg != NULL
@@ -840,6 +859,8 @@ extern int gdbtk_test (char *);
       if (symarg != NULL)
 	catch_command_errors (symbol_file_add_main, symarg, 0, RETURN_MASK_ALL);
     }
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("executable and symbols");
 
   /* APPLE LOCAL begin */
   if (state_change_hook && symarg != NULL)
@@ -887,6 +908,8 @@ extern int gdbtk_test (char *);
 
   if (ttyarg != NULL)
     catch_command_errors (tty_command, ttyarg, !batch, RETURN_MASK_ALL);
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("attach, core and tty");
 
   /* Error messages should no longer be distinguished with extra output. */
   error_pre_print = NULL;
@@ -905,6 +928,8 @@ extern int gdbtk_test (char *);
         if (cwdbuf.st_uid == getuid ())
 	  catch_command_errors (source_file, gdbinit, 0, RETURN_MASK_ALL);
       }
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("local init file");
   
   /* These need to be set this late in the initialization to ensure that
      they are defined for the current environment.  They define the
@@ -939,10 +964,19 @@ extern int gdbtk_test (char *);
       catch_command_errors (source_file, cmdarg[i], !batch, RETURN_MASK_ALL);
     }
   xfree (cmdarg);
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("command files");
 
   /* Read in the old history after all the command files have been read. */
   init_history ();
 
+  /* APPLE LOCAL begin startup stats */
+  /* Report before a batch run exits, since that is how the scripts
+     that launch gdb over and over run it.  */
+  startup_stats_phase ("history");
+  startup_stats_report ();
+  /* APPLE LOCAL end startup stats */
+
   if (batch)
     {
       if (attach_flag)
@@ -1097,6 +1131,7 @@ Options:\n\n\
   --waitfor=PROCNAME Poll continuously for PROCNAME to launch; attach to it.\n\
   --arch=ARCH        Run the slice of a Universal file given by ARCH.\n\
   --osabi=OSABI      Set the osabi prior to loading any executables.\n\
+  --startup-stats    Report where the time went while starting up.\n\
 "), stream);
   fputs_unfiltered (_("\n\
 For more information, type \"help\" from within GDB, or consult the\n\
@@ -426,9 +426,32 @@ maintenance_info_sections (char *arg, int from_tty)
 void
 maintenance_print_statistics (char *args, int from_tty)
 {
+  /* APPLE LOCAL bfd cache  */
+  struct bfd_cache_statistics bfd_stats;
+
   print_objfile_statistics ();
   print_symbol_bcache_statistics ();
+
+  /* APPLE LOCAL begin bfd cache  */
+  bfd_cache_get_statistics (&bfd_stats);
+  printf_filtered (_("BFD file cache:\n"));
+  printf_filtered (_("  Files open: %u of at most %u\n"),
+		   bfd_stats.open_files, bfd_stats.max_open);
+  printf_filtered (_("  Lookups that found the file open: %lu\n"),
+		   bfd_stats.hits);
+  printf_filtered (_("  Files reopened: %lu\n"), bfd_stats.misses);
+  printf_filtered (_("  Files closed to make room: %lu\n"),
+		   bfd_stats.evictions);
+  /* APPLE LOCAL end bfd cache  */
+}
+
+/* APPLE LOCAL begin objfile memory  */
+static void
+maintenance_info_objfile_memory (char *args, int from_tty)
+{
+  print_objfile_memory (args);
 }
+/* APPLE LOCAL end objfile memory  */
 
 static void
 maintenance_print_architecture (char *args, int from_tty)
@@ -1125,6 +1148,18 @@ just the symbol table structures themselves."),
 	   _("Print statistics about internal gdb state."),
 	   &maintenanceprintlist);
 
+  /* APPLE LOCAL begin objfile memory  */
+  add_cmd ("objfile-memory", class_maintenance,
+	   maintenance_info_objfile_memory, _("\
+Show where the memory for each objfile goes.\n\
+Lists the objfile obstack, with estimates of what the minimal symbols,\n\
+partial symbol tables, full symbols, types and line tables on it use,\n\
+then the partial symbol lists and caches, the macro cache and any DWARF\n\
+compilation units kept read in.\n\
+With an argument REGEXP, only the objfiles whose names match it are shown."),
+	   &maintenanceinfolist);
+  /* APPLE LOCAL end objfile memory  */
+
   add_cmd ("architecture", class_maintenance,
 	   maintenance_print_architecture, _("\
 Print the internal architecture configuration.\n\
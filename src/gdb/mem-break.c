@@ -70,6 +70,10 @@ default_memory_insert_breakpoint (CORE_ADDR addr, bfd_byte *contents_cache)
   /* APPLE LOCAL: For breakpoints we should override the trust_readonly setting.  */
   old_readonly = set_trust_readonly (0);
   reset_trust_readonly = make_cleanup (set_trust_readonly_cleanup, (void *) old_readonly);
+  /* APPLE LOCAL breakpoint always-inserted: Look at the real
+     memory, not the shadowed view.  */
+  make_cleanup (set_breakpoint_shadowing_cleanup,
+		(void *) set_breakpoint_shadowing (0));
   /* END APPLE LOCAL */
   /* Save the memory contents.  */
   val = target_read_memory (addr, contents_cache, bplen);
@@ -109,6 +113,10 @@ default_memory_remove_breakpoint (CORE_ADDR addr, bfd_byte *contents_cache)
 
   old_readonly = set_trust_readonly (0);
   reset_trust_readonly = make_cleanup (set_trust_readonly_cleanup, (void *) old_readonly);
+  /* APPLE LOCAL breakpoint always-inserted: Look at the real
+     memory, not the shadowed view.  */
+  make_cleanup (set_breakpoint_shadowing_cleanup,
+		(void *) set_breakpoint_shadowing (0));
   val = target_read_memory (addr, cur_contents, bplen);
   
   /* I don't know why we wouldn't be able to read the memory where we
@@ -40,6 +40,60 @@ const struct mem_attrib default_mem_attrib =
 static struct mem_region *mem_region_chain = NULL;
 static int mem_number = 0;
 
+/* APPLE LOCAL begin memory region index  */
+/* The enabled regions on mem_region_chain, sorted by their low
+   address, so that lookup_mem_region (which the dcache calls for
+   every transfer) can binary search them.  Regions never overlap, so
+   neither do these.  Rebuilt by lookup_mem_region when
+   MEM_REGION_INDEX_VALID is zero; anything that adds, deletes,
+   enables or disables a region must clear it.  */
+
+static struct mem_region **mem_region_index = NULL;
+static int mem_region_index_count = 0;
+static int mem_region_index_size = 0;
+static int mem_region_index_valid = 0;
+
+static int
+compare_mem_region_lo (const void *a, const void *b)
+{
+  const struct mem_region *ra = *(const struct mem_region **) a;
+  const struct mem_region *rb = *(const struct mem_region **) b;
+
+  if (ra->lo < rb->lo)
+    return -1;
+  if (ra->lo > rb->lo)
+    return 1;
+  return 0;
+}
+
+static void
+build_mem_region_index (void)
+{
+  struct mem_region *m;
+  int count = 0;
+
+  for (m = mem_region_chain; m; m = m->next)
+    if (m->enabled_p == 1)
+      count++;
+
+  if (count > mem_region_index_size)
+    {
+      mem_region_index_size = count;
+      mem_region_index = xrealloc (mem_region_index,
+				   count * sizeof (struct mem_region *));
+    }
+
+  mem_region_index_count = 0;
+  for (m = mem_region_chain; m; m = m->next)
+    if (m->enabled_p == 1)
+      mem_region_index[mem_region_index_count++] = m;
+
+  qsort (mem_region_index, mem_region_index_count,
+	 sizeof (struct mem_region *), compare_mem_region_lo);
+  mem_region_index_valid = 1;
+}
+/* APPLE LOCAL end memory region index  */
+
 static struct mem_region *
 create_mem_region (CORE_ADDR lo, CORE_ADDR hi,
 		   const struct mem_attrib *attrib)
@@ -77,6 +131,8 @@ create_mem_region (CORE_ADDR lo, CORE_ADDR hi,
   /* link in new node */
   new->next = mem_region_chain;
   mem_region_chain = new;
+  /* APPLE LOCAL memory region index  */
+  mem_region_index_valid = 0;
 
   return new;
 }
@@ -84,6 +140,8 @@ create_mem_region (CORE_ADDR lo, CORE_ADDR hi,
 static void
 delete_mem_region (struct mem_region *m)
 {
+  /* APPLE LOCAL memory region index  */
+  mem_region_index_valid = 0;
   xfree (m);
 }
 
@@ -97,6 +155,8 @@ lookup_mem_region (CORE_ADDR addr)
   struct mem_region *m;
   CORE_ADDR lo;
   CORE_ADDR hi;
+  /* APPLE LOCAL memory region index  */
+  int low, high;
 
   /* First we initialize LO and HI so that they describe the entire
      memory space.  As we process the memory region chain, they are
@@ -108,20 +168,35 @@ lookup_mem_region (CORE_ADDR addr)
   lo = (CORE_ADDR) 0;
   hi = (CORE_ADDR) ~ 0;
 
-  for (m = mem_region_chain; m; m = m->next)
+  /* APPLE LOCAL begin memory region index  */
+  if (!mem_region_index_valid)
+    build_mem_region_index ();
+
+  /* Find the first enabled region that starts above ADDR.  Only the
+     one before it can contain ADDR; if that doesn't, ADDR is in the
+     gap between the two.  */
+  low = 0;
+  high = mem_region_index_count;
+  while (low < high)
     {
-      if (m->enabled_p == 1)
-	{
-	  if (addr >= m->lo && (addr < m->hi || m->hi == 0))
-	    return m;
+      int mid = low + (high - low) / 2;
 
-	  if (addr >= m->hi && lo < m->hi)
-	    lo = m->hi;
+      if (mem_region_index[mid]->lo <= addr)
+	low = mid + 1;
+      else
+	high = mid;
+    }
 
-	  if (addr <= m->lo && hi > m->lo)
-	    hi = m->lo;
-	}
+  if (low > 0)
+    {
+      m = mem_region_index[low - 1];
+      if (addr < m->hi || m->hi == 0)
+	return m;
+      lo = m->hi;
     }
+  if (low < mem_region_index_count)
+    hi = mem_region_index[low]->lo;
+  /* APPLE LOCAL end memory region index  */
 
   /* Because no region was found, we must cons up one based on what
      was learned above.  */
@@ -354,6 +429,8 @@ mem_enable (int num)
     if (m->number == num)
       {
 	m->enabled_p = 1;
+	/* APPLE LOCAL memory region index  */
+	mem_region_index_valid = 0;
 	return;
       }
   printf_unfiltered (_("No memory region number %d.\n"), num);
@@ -373,6 +450,8 @@ mem_enable_command (char *args, int from_tty)
     {
       for (m = mem_region_chain; m; m = m->next)
 	m->enabled_p = 1;
+      /* APPLE LOCAL memory region index  */
+      mem_region_index_valid = 0;
     }
   else
     while (*p)
@@ -404,6 +483,8 @@ mem_disable (int num)
     if (m->number == num)
       {
 	m->enabled_p = 0;
+	/* APPLE LOCAL memory region index  */
+	mem_region_index_valid = 0;
 	return;
       }
   printf_unfiltered (_("No memory region number %d.\n"), num);
@@ -423,6 +504,8 @@ mem_disable_command (char *args, int from_tty)
     {
       for (m = mem_region_chain; m; m = m->next)
 	m->enabled_p = 0;
+      /* APPLE LOCAL memory region index  */
+      mem_region_index_valid = 0;
     }
   else
     while (*p)
@@ -76,6 +76,8 @@ struct mem_region
      list.  This probably won't scale to handle hundreds of memory
      regions --- that many could be needed to describe the allowed
      access modes for memory mapped i/o device registers. */
+  /* APPLE LOCAL: lookup_mem_region uses a sorted index of the
+     enabled regions instead of walking this list.  */
   struct mem_region *next;
   
   CORE_ADDR lo;
@@ -39,6 +39,11 @@
 #include "gdb_regex.h"
 /* APPLE LOCAL - subroutine inlining  */
 #include "inlining.h"
+/* APPLE LOCAL begin frame variable cache  */
+#include "mi-out.h"
+#include "gdbcmd.h"
+#include "inferior.h"
+/* APPLE LOCAL end frame variable cache  */
 
 /* FIXME: There is no general mi header to put this kind of utility function.*/
 extern void mi_report_var_creation (struct ui_out *uiout, struct varobj *var);
@@ -72,6 +77,10 @@ static void list_args_or_locals (int locals, enum print_values values,
 				 struct frame_info *fi,
 				 int all_blocks);
 
+/* APPLE LOCAL frame variable cache  */
+static void compute_args_or_locals (int locals, enum print_values values,
+				    struct frame_info *fi, int all_blocks);
+
 static void print_syms_for_block (struct block *block, 
 				  struct frame_info *fi, 
 				  struct ui_stream *stb,
@@ -602,6 +611,186 @@ mi_cmd_stack_list_args (char *command, char **argv, int argc)
   return MI_CMD_DONE;
 }
 
+/* APPLE LOCAL begin frame variable cache  */
+/* IDEs ask for the same frame's locals and arguments several times
+   around each stop.  When mi_frame_variable_cache is on, the finished
+   "locals=[...]" or "args=[...]" field is kept, keyed by the frame,
+   its pc and everything else that went into it, and handed back as
+   long as target_stop_generation says nothing it was read from can
+   have changed.  Results that create varobjs aren't cached, since
+   making the varobjs is the point of asking.  */
+
+static int mi_frame_variable_cache = 0;
+
+#define FRAME_VARIABLE_CACHE_SIZE 32
+
+struct frame_variable_cache_entry
+{
+  struct frame_id id;
+  CORE_ADDR pc;
+  ptid_t ptid;
+  int locals;
+  enum print_values values;
+  int all_blocks;
+  int mi_version;
+
+  /* The formatted field, or NULL if the slot is empty.  */
+  char *text;
+};
+
+static struct frame_variable_cache_entry
+  frame_variable_cache[FRAME_VARIABLE_CACHE_SIZE];
+
+/* The slot the next new result goes in.  */
+static int frame_variable_cache_next;
+
+/* The target_stop_generation the cached results were read in.  */
+static unsigned int frame_variable_cache_generation;
+
+/* The ui_out results are formatted into before being cached, and
+   whether it is in use.  */
+static struct ui_out *frame_variable_miout;
+static int frame_variable_miout_busy;
+
+static void
+show_mi_frame_variable_cache (struct ui_file *file, int from_tty,
+			      struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Caching of mi frame locals and arguments is %s.\n"),
+		    value);
+}
+
+static void
+frame_variable_cache_clear (void)
+{
+  int i;
+
+  for (i = 0; i < FRAME_VARIABLE_CACHE_SIZE; i++)
+    {
+      xfree (frame_variable_cache[i].text);
+      frame_variable_cache[i].text = NULL;
+    }
+  frame_variable_cache_next = 0;
+}
+
+static struct frame_variable_cache_entry *
+frame_variable_cache_lookup (struct frame_id id, CORE_ADDR pc, int locals,
+			     enum print_values values, int all_blocks)
+{
+  int i;
+
+  if (frame_variable_cache_generation != target_stop_generation)
+    {
+      frame_variable_cache_clear ();
+      frame_variable_cache_generation = target_stop_generation;
+      return NULL;
+    }
+
+  for (i = 0; i < FRAME_VARIABLE_CACHE_SIZE; i++)
+    {
+      struct frame_variable_cache_entry *entry = &frame_variable_cache[i];
+
+      if (entry->text != NULL
+	  && entry->pc == pc
+	  && entry->locals == locals
+	  && entry->values == values
+	  && entry->all_blocks == all_blocks
+	  && entry->mi_version == mi_version (uiout)
+	  && ptid_equal (entry->ptid, inferior_ptid)
+	  && frame_id_eq (entry->id, id))
+	return entry;
+    }
+  return NULL;
+}
+
+/* Remember TEXT, which is xmalloc'd, as the result for the given key.  */
+
+static void
+frame_variable_cache_store (struct frame_id id, CORE_ADDR pc, int locals,
+			    enum print_values values, int all_blocks,
+			    char *text)
+{
+  struct frame_variable_cache_entry *entry;
+
+  entry = &frame_variable_cache[frame_variable_cache_next];
+  frame_variable_cache_next
+    = (frame_variable_cache_next + 1) % FRAME_VARIABLE_CACHE_SIZE;
+
+  xfree (entry->text);
+  entry->id = id;
+  entry->pc = pc;
+  entry->ptid = inferior_ptid;
+  entry->locals = locals;
+  entry->values = values;
+  entry->all_blocks = all_blocks;
+  entry->mi_version = mi_version (uiout);
+  entry->text = text;
+}
+
+static void
+release_frame_variable_miout (void *unused)
+{
+  mi_out_rewind (frame_variable_miout);
+  frame_variable_miout_busy = 0;
+}
+
+static void
+list_args_or_locals (int locals, enum print_values values,
+		     struct frame_info *fi, int all_blocks)
+{
+  struct frame_variable_cache_entry *entry;
+  struct cleanup *cleanup;
+  struct frame_id id;
+  CORE_ADDR pc;
+  unsigned int generation;
+  char *text;
+
+  if (!mi_frame_variable_cache
+      || values == PRINT_MAKE_VAROBJ
+      || !ui_out_is_mi_like_p (uiout)
+      || frame_variable_miout_busy)
+    {
+      compute_args_or_locals (locals, values, fi, all_blocks);
+      return;
+    }
+
+  id = get_frame_id (fi);
+  pc = get_frame_pc (fi);
+  entry = frame_variable_cache_lookup (id, pc, locals, values, all_blocks);
+  if (entry != NULL)
+    {
+      mi_out_field_raw (uiout, entry->text);
+      return;
+    }
+
+  if (frame_variable_miout == NULL)
+    frame_variable_miout = mi_out_new (mi_version (uiout));
+  else if (mi_version (frame_variable_miout) != mi_version (uiout))
+    {
+      ui_out_delete (frame_variable_miout);
+      frame_variable_miout = mi_out_new (mi_version (uiout));
+    }
+
+  generation = target_stop_generation;
+  cleanup = make_cleanup_restore_uiout (uiout);
+  make_cleanup (release_frame_variable_miout, NULL);
+  frame_variable_miout_busy = 1;
+  uiout = frame_variable_miout;
+  compute_args_or_locals (locals, values, fi, all_blocks);
+  text = mi_out_xstrdup (frame_variable_miout);
+  do_cleanups (cleanup);
+
+  mi_out_field_raw (uiout, text);
+
+  /* If printing the values ran the inferior or wrote to it, what we
+     printed may already be out of date.  */
+  if (generation == target_stop_generation)
+    frame_variable_cache_store (id, pc, locals, values, all_blocks, text);
+  else
+    xfree (text);
+}
+/* APPLE LOCAL end frame variable cache  */
+
 /* Print a list of the locals or the arguments for the currently
    selected frame.  If the argument passed is 0, printonly the names
    of the variables, if an argument of 1 is passed, print the values
@@ -609,8 +798,9 @@ mi_cmd_stack_list_args (char *command, char **argv, int argc)
    blocks in the function that is in frame FI.*/
 
 static void
-list_args_or_locals (int locals, enum print_values values, 
-                     struct frame_info *fi, int all_blocks)
+/* APPLE LOCAL frame variable cache  */
+compute_args_or_locals (int locals, enum print_values values, 
+			struct frame_info *fi, int all_blocks)
 {
   struct block *block = NULL;
   /* APPLE LOCAL begin address ranges  */
@@ -1524,3 +1714,20 @@ mi_interp_context_hook (int thread_id)
   uiout = saved_ui_out;
 }
 /* APPLE LOCAL end hooks */
+
+/* APPLE LOCAL begin frame variable cache  */
+void
+_initialize_mi_cmd_stack (void)
+{
+  add_setshow_boolean_cmd ("mi-frame-variable-cache", class_obscure,
+			   &mi_frame_variable_cache, _("\
+Set whether mi locals and arguments listings are cached per frame."), _("\
+Show whether mi locals and arguments listings are cached per frame."), _("\
+When on, -stack-list-locals and -stack-list-args answer a repeated\n\
+request for the same frame from the result of the previous one, until\n\
+the inferior runs, or its memory or registers are written.  Changing\n\
+print settings doesn't invalidate the cached results."),
+			   NULL, show_mi_frame_variable_cache,
+			   &setlist, &showlist);
+}
+/* APPLE LOCAL end frame variable cache  */
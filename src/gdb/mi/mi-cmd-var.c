@@ -673,8 +673,11 @@ mi_cmd_var_list_children (char *command, char **argv, int argc)
   int saw_fake_child, saw_public, saw_other;
   int num_fake_childs_children;
 
+  /* APPLE LOCAL varobj child window  */
+  int from = 0, to = -1;
+
   const char *usage = "mi_cmd_var_list_children: Usage: [--suppress-protection|--show-protection] "
-    "[--no-values|--all-values] NAME [PRINT_VALUE]";
+    "[--from FROM] [--to TO] [--no-values|--all-values] NAME [PRINT_VALUE]";
 
   /* APPLE LOCAL: We added the protection control flags.  */
 
@@ -694,6 +697,30 @@ mi_cmd_var_list_children (char *command, char **argv, int argc)
       argc--;
     }
 
+  /* APPLE LOCAL begin varobj child window  */
+  /* Only list the children with indices FROM up to but not including
+     TO, so that an IDE can page through a huge array without GDB
+     making a varobj for every element.  */
+  while (argc >= 2
+	 && (strcmp (argv[0], "--from") == 0 || strcmp (argv[0], "--to") == 0))
+    {
+      char *end;
+      long n = strtol (argv[1], &end, 10);
+
+      if (*argv[1] == '\0' || *end != '\0' || n < 0)
+	error ("%s", usage);
+      if (strcmp (argv[0], "--from") == 0)
+	from = n;
+      else
+	to = n;
+      argv += 2;
+      argc -= 2;
+    }
+
+  if (argc == 0)
+    error ("%s", usage);
+  /* APPLE LOCAL end varobj child window  */
+
   /* APPLE LOCAL: In our impl, arguments are reversed.  We use
      'varobj-handle show-value', at the FSF they use 
      'show-value varobj-handle'.  */
@@ -752,7 +779,8 @@ mi_cmd_var_list_children (char *command, char **argv, int argc)
   if (var == NULL)
     error (_("Variable object not found"));
 
-  numchild = varobj_list_children (var, &childlist);
+  /* APPLE LOCAL varobj child window  */
+  numchild = varobj_list_children_range (var, from, to, &childlist);
 
   if (numchild <= 0)
     {
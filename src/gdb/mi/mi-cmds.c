@@ -51,6 +51,8 @@ struct mi_cmd mi_cmds[] =
   { "data-list-register-names", { NULL, 0 }, 0, mi_cmd_data_list_register_names},
   { "data-list-register-values", { NULL, 0 }, 0, mi_cmd_data_list_register_values},
   { "data-read-memory", { NULL, 0 }, 0, mi_cmd_data_read_memory},
+  /* APPLE LOCAL data-read-memory-bytes  */
+  { "data-read-memory-bytes", { NULL, 0 }, 0, mi_cmd_data_read_memory_bytes},
   { "data-write-memory", { NULL, 0 }, 0, mi_cmd_data_write_memory},
   { "data-write-register-values", { NULL, 0 }, 0, mi_cmd_data_write_register_values},
   { "display-delete", { NULL, 0 }, NULL, NULL },
@@ -111,6 +113,8 @@ struct mi_cmd mi_cmds[] =
   { "gdb-exit", { NULL, 0 }, 0, mi_cmd_gdb_exit},
   { "gdb-set", { "set", 1 }, NULL, NULL },
   { "gdb-show", { "show", 1 }, NULL, NULL },
+  /* APPLE LOCAL gdb stats  */
+  { "gdb-stats", { NULL, 0 }, NULL, mi_cmd_gdb_stats },
   { "gdb-source", { NULL, 0 }, NULL, NULL },
   { "gdb-unset", { "unset", 1 }, NULL, NULL },
   { "gdb-version", { NULL, 0 }, NULL, mi_cmd_show_version },
@@ -128,6 +132,8 @@ struct mi_cmd mi_cmds[] =
   { "mi-verify-command", { NULL, 0 }, 0, mi_cmd_mi_verify_command},
   { "mi-enable-timings", { NULL, 0 }, 0, mi_cmd_enable_timings},
   { "mi-no-op", { NULL, 0 }, 0, mi_cmd_mi_no_op},
+  /* APPLE LOCAL mi batch  */
+  { "mi-batch", { NULL, 0 }, 0, mi_cmd_mi_batch},
   { "overlay-auto", { NULL, 0 }, NULL, NULL },
   { "overlay-list-mapping-state", { NULL, 0 }, NULL, NULL },
   { "overlay-list-overlays", { NULL, 0 }, NULL, NULL },
@@ -174,7 +180,8 @@ struct mi_cmd mi_cmds[] =
   { "target-load-solib", { NULL, 0 }, 0, mi_cmd_target_load_solib },
   { "target-unload-solib", { NULL, 0 }, 0, mi_cmd_target_unload_solib },
   { "target-select", { NULL, 0 }, mi_cmd_target_select},
-  { "thread-info", { NULL, 0 }, NULL, NULL },
+  /* APPLE LOCAL thread-info  */
+  { "thread-info", { NULL, 0 }, 0, mi_cmd_thread_info},
   { "thread-list-all-threads", { NULL, 0 }, NULL, NULL },
   { "thread-list-ids", { NULL, 0 }, 0, mi_cmd_thread_list_ids},
   { "thread-select", { NULL, 0 }, 0, mi_cmd_thread_select},
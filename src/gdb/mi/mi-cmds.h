@@ -76,6 +76,8 @@ extern mi_cmd_argv_ftype mi_cmd_data_list_register_names;
 extern mi_cmd_argv_ftype mi_cmd_data_list_register_values;
 extern mi_cmd_argv_ftype mi_cmd_data_list_changed_registers;
 extern mi_cmd_argv_ftype mi_cmd_data_read_memory;
+/* APPLE LOCAL data-read-memory-bytes  */
+extern mi_cmd_argv_ftype mi_cmd_data_read_memory_bytes;
 extern mi_cmd_argv_ftype mi_cmd_data_write_memory;
 extern mi_cmd_argv_ftype mi_cmd_data_write_register_values;
 extern mi_cmd_argv_ftype mi_cmd_enable_timings;
@@ -112,6 +114,10 @@ extern mi_cmd_argv_ftype mi_cmd_interpreter_exec;
 extern mi_cmd_argv_ftype mi_cmd_interpreter_complete;
 extern mi_cmd_argv_ftype mi_cmd_mi_verify_command;
 extern mi_cmd_argv_ftype mi_cmd_mi_no_op;
+/* APPLE LOCAL mi batch  */
+extern mi_cmd_argv_ftype mi_cmd_mi_batch;
+/* APPLE LOCAL gdb stats  */
+extern mi_cmd_argv_ftype mi_cmd_gdb_stats;
 extern mi_cmd_argv_ftype mi_cmd_pid_info;
 extern mi_cmd_argv_ftype mi_cmd_show_version;
 extern mi_cmd_argv_ftype mi_cmd_stack_check_threads;
@@ -126,6 +132,8 @@ extern mi_cmd_argv_ftype mi_cmd_symbol_list_lines;
 extern mi_cmd_argv_ftype mi_cmd_target_attach;
 extern mi_cmd_args_ftype mi_cmd_target_download;
 extern mi_cmd_args_ftype mi_cmd_target_select;
+/* APPLE LOCAL thread-info  */
+extern mi_cmd_argv_ftype mi_cmd_thread_info;
 extern mi_cmd_argv_ftype mi_cmd_thread_list_ids;
 extern mi_cmd_argv_ftype mi_cmd_thread_select;
 extern mi_cmd_argv_ftype mi_cmd_thread_set_pc;
@@ -23,6 +23,8 @@
 
 #include "defs.h"
 #include "mi-console.h"
+/* APPLE LOCAL mi streaming  */
+#include "mi-out.h"
 #include "gdb_string.h"
 
 /* MI-console: send output to std-out but correcty encapsulated */
@@ -91,25 +93,35 @@ mi_console_raw_packet (void *data,
 		       long length_buf)
 {
   struct mi_console_file *mi_console = data;
+  /* APPLE LOCAL mi streaming  */
+  struct ui_file *raw;
+
   if (mi_console->magic != &mi_console_file_magic)
     internal_error (__FILE__, __LINE__,
 		    _("mi_console_file_transform: bad magic number"));
 
+  /* APPLE LOCAL begin mi streaming  */
+  /* Don't break into a result that is still being streamed out.  */
+  raw = mi_out_stream_deferred ();
+  if (raw == NULL)
+    raw = mi_console->raw;
+  /* APPLE LOCAL end mi streaming  */
+
   if (length_buf > 0)
     {
-      fputs_unfiltered (mi_console->prefix, mi_console->raw);
+      fputs_unfiltered (mi_console->prefix, raw);
       if (mi_console->quote)
 	{
-	  fputs_unfiltered ("\"", mi_console->raw);
-	  fputstrn_unfiltered (buf, length_buf, mi_console->quote, mi_console->raw);
-	  fputs_unfiltered ("\"\n", mi_console->raw);
+	  fputs_unfiltered ("\"", raw);
+	  fputstrn_unfiltered (buf, length_buf, mi_console->quote, raw);
+	  fputs_unfiltered ("\"\n", raw);
 	}
       else
 	{
-	  fputstrn_unfiltered (buf, length_buf, 0, mi_console->raw);
-	  fputs_unfiltered ("\n", mi_console->raw);
+	  fputstrn_unfiltered (buf, length_buf, 0, raw);
+	  fputs_unfiltered ("\n", raw);
 	}
-      gdb_flush (mi_console->raw);
+      gdb_flush (raw);
     }
 }
 
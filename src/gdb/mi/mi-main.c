@@ -170,6 +170,14 @@ extern void return_command_wrapper (char *, int);
 static void output_control_change_notification(char *notification);
 
 static int mi_command_completes_while_target_executing (char *command);
+
+/* APPLE LOCAL begin mi streaming  */
+static int mi_command_streams_result (char *command);
+
+/* If non-zero, the results of the commands listed in
+   mi_command_streams_result are written out as they are built.  */
+static int mi_stream_results = 0;
+/* APPLE LOCAL end mi streaming  */
 static void timestamp (struct mi_timestamp *tv);
 static void print_diff_now (struct mi_timestamp *start);
 static void copy_timestamp (struct mi_timestamp *dst, struct mi_timestamp *src);
@@ -847,6 +855,29 @@ mi_cmd_thread_list_ids (char *command, char **argv, int argc)
     return MI_CMD_DONE;
 }
 
+/* APPLE LOCAL begin thread-info  */
+enum mi_cmd_result
+mi_cmd_thread_info (char *command, char **argv, int argc)
+{
+  enum gdb_rc rc;
+
+  if (argc != 0)
+    {
+      mi_error_message = xstrprintf ("mi_cmd_thread_info: No arguments required.");
+      return MI_CMD_ERROR;
+    }
+  else
+    rc = gdb_list_thread_info (uiout, &mi_error_message);
+
+  /* RC is enum gdb_rc if it is successful (>=0)
+     enum return_reason if not (<0). */
+  if ((int) rc < 0 || rc == GDB_RC_FAIL)
+    return MI_CMD_ERROR;
+  else
+    return MI_CMD_DONE;
+}
+/* APPLE LOCAL end thread-info  */
+
 enum mi_cmd_result
 mi_cmd_data_list_register_names (char *command, char **argv, int argc)
 {
@@ -1288,7 +1319,8 @@ mi_cmd_data_evaluate_expression (char *command, char **argv, int argc)
   if (unwinding_was_requested)
     make_cleanup_set_restore_unwind_on_signal (1);
 
-  expr = parse_expression (expr_string);
+  /* APPLE LOCAL expression cache  */
+  expr = parse_expression_cached (expr_string);
 
   make_cleanup (free_current_contents, &expr);
 
@@ -1689,6 +1721,165 @@ mi_cmd_data_read_memory (char *command, char **argv, int argc)
   return MI_CMD_DONE;
 }
 
+/* APPLE LOCAL begin data-read-memory-bytes  */
+/* Encode the LEN bytes at DATA into BUF as base64, and nul-terminate
+   it.  BUF must have room for 4 * ((LEN + 2) / 3) + 1 bytes.  */
+
+static void
+mi_encode_base64 (const gdb_byte *data, LONGEST len, char *buf)
+{
+  static const char digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  LONGEST i;
+
+  for (i = 0; i + 2 < len; i += 3)
+    {
+      unsigned long w = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+
+      *buf++ = digits[(w >> 18) & 0x3f];
+      *buf++ = digits[(w >> 12) & 0x3f];
+      *buf++ = digits[(w >> 6) & 0x3f];
+      *buf++ = digits[w & 0x3f];
+    }
+  if (i < len)
+    {
+      unsigned long w = data[i] << 16;
+
+      if (i + 1 < len)
+	w |= data[i + 1] << 8;
+      *buf++ = digits[(w >> 18) & 0x3f];
+      *buf++ = digits[(w >> 12) & 0x3f];
+      *buf++ = i + 1 < len ? digits[(w >> 6) & 0x3f] : '=';
+      *buf++ = '=';
+    }
+  *buf = '\0';
+}
+
+/* DATA-READ-MEMORY-BYTES:
+
+   BYTE-OFFSET: optional, preceded by '-o'.  Added to ADDR.
+   ENCODING: optional, preceded by '-e'.  "hex" (the default) or
+   "base64".
+   ADDR: start address of the memory to read.
+   COUNT: number of bytes to read.
+
+   Reads COUNT bytes at ADDR with a single target read, and returns
+   them as one string rather than a field per word:
+
+   addr="...",nr-bytes="...",total-bytes="...",encoding="...",
+   contents="..."
+
+   NR-BYTES is how many bytes could be read, from the start of the
+   range; CONTENTS encodes just those.  */
+
+enum mi_cmd_result
+mi_cmd_data_read_memory_bytes (char *command, char **argv, int argc)
+{
+  struct cleanup *cleanups = make_cleanup (null_cleanup, NULL);
+  CORE_ADDR addr;
+  LONGEST total_bytes;
+  LONGEST nr_bytes;
+  long offset = 0;
+  int base64 = 0;
+  gdb_byte *mbuf;
+  char *contents;
+  int optind = 0;
+  char *optarg;
+  enum opt
+    {
+      OFFSET_OPT, ENCODING_OPT
+    };
+  static struct mi_opt opts[] =
+  {
+    {"o", OFFSET_OPT, 1},
+    {"e", ENCODING_OPT, 1},
+    {0, 0, 0},
+  };
+
+  while (1)
+    {
+      int opt = mi_getopt ("mi_cmd_data_read_memory_bytes", argc, argv, opts,
+			   &optind, &optarg);
+      if (opt < 0)
+	break;
+      switch ((enum opt) opt)
+	{
+	case OFFSET_OPT:
+	  offset = atol (optarg);
+	  break;
+	case ENCODING_OPT:
+	  if (strcmp (optarg, "base64") == 0)
+	    base64 = 1;
+	  else if (strcmp (optarg, "hex") == 0)
+	    base64 = 0;
+	  else
+	    {
+	      mi_error_message = xstrprintf ("mi_cmd_data_read_memory_bytes: unknown encoding \"%s\".", optarg);
+	      return MI_CMD_ERROR;
+	    }
+	  break;
+	}
+    }
+  argv += optind;
+  argc -= optind;
+
+  if (argc != 2)
+    {
+      mi_error_message = xstrprintf ("mi_cmd_data_read_memory_bytes: Usage: [-o BYTE-OFFSET] [-e hex|base64] ADDR COUNT.");
+      return MI_CMD_ERROR;
+    }
+
+  addr = parse_and_eval_address (argv[0]) + offset;
+  total_bytes = parse_and_eval_long (argv[1]);
+  if (total_bytes <= 0)
+    {
+      mi_error_message = xstrprintf ("mi_cmd_data_read_memory_bytes: invalid number of bytes.");
+      return MI_CMD_ERROR;
+    }
+
+  mbuf = xmalloc (total_bytes);
+  make_cleanup (xfree, mbuf);
+
+  nr_bytes = target_read (&current_target, TARGET_OBJECT_MEMORY, NULL,
+			  mbuf, addr, total_bytes);
+  if (nr_bytes <= 0)
+    {
+      do_cleanups (cleanups);
+      mi_error_message = xstrdup ("Unable to read memory.");
+      return MI_CMD_ERROR;
+    }
+
+  if (base64)
+    {
+      contents = xmalloc (4 * ((nr_bytes + 2) / 3) + 1);
+      mi_encode_base64 (mbuf, nr_bytes, contents);
+    }
+  else
+    {
+      static const char hexdigits[] = "0123456789abcdef";
+      LONGEST i;
+
+      contents = xmalloc (2 * nr_bytes + 1);
+      for (i = 0; i < nr_bytes; i++)
+	{
+	  contents[2 * i] = hexdigits[mbuf[i] >> 4];
+	  contents[2 * i + 1] = hexdigits[mbuf[i] & 0xf];
+	}
+      contents[2 * nr_bytes] = '\0';
+    }
+  make_cleanup (xfree, contents);
+
+  ui_out_field_core_addr (uiout, "addr", addr);
+  ui_out_field_fmt (uiout, "nr-bytes", "%s", paddr_d (nr_bytes));
+  ui_out_field_fmt (uiout, "total-bytes", "%s", paddr_d (total_bytes));
+  ui_out_field_string (uiout, "encoding", base64 ? "base64" : "hex");
+  ui_out_field_string (uiout, "contents", contents);
+
+  do_cleanups (cleanups);
+  return MI_CMD_DONE;
+}
+/* APPLE LOCAL end data-read-memory-bytes  */
+
 /* DATA-MEMORY-WRITE:
 
    COLUMN_OFFSET: optional argument. Must be preceeded by '-o'. The
@@ -1802,6 +1993,52 @@ mi_cmd_enable_timings (char *command, char **argv, int argc)
   
 }
 
+/* APPLE LOCAL begin gdb stats  */
+/* -gdb-stats [--reset]
+
+   Report the cumulative counts from gdb-stats.h, e.g.
+   stats={memory_read={count="12",bytes="4096",time="0.00210"},...}
+   With --reset, clear them afterwards.  */
+
+enum mi_cmd_result
+mi_cmd_gdb_stats (char *command, char **argv, int argc)
+{
+  struct gdb_stats stats;
+  struct cleanup *stats_cleanup;
+  int reset = 0;
+  int i;
+
+  if (argc == 1 && strcmp (argv[0], "--reset") == 0)
+    reset = 1;
+  else if (argc != 0)
+    error ("mi_cmd_gdb_stats: Usage: -gdb-stats [--reset]");
+
+  gdb_stats_snapshot (&stats);
+  stats_cleanup = make_cleanup_ui_out_tuple_begin_end (uiout, "stats");
+  for (i = 0; i < GDB_STAT_COUNT; i++)
+    {
+      struct cleanup *tuple_cleanup;
+
+      tuple_cleanup = make_cleanup_ui_out_tuple_begin_end (uiout,
+							   gdb_stat_name (i));
+      ui_out_field_fmt (uiout, "count", "%lu",
+			(unsigned long) stats.counters[i].count);
+      if (i == GDB_STAT_MEMORY_READ || i == GDB_STAT_TARGET_XFER
+	  || i == GDB_STAT_CU_READ)
+	ui_out_field_fmt (uiout, "bytes", "%lu",
+			  (unsigned long) stats.counters[i].bytes);
+      ui_out_field_fmt (uiout, "time", "%0.5f",
+			stats.counters[i].time / 1000000.0);
+      do_cleanups (tuple_cleanup);
+    }
+  do_cleanups (stats_cleanup);
+
+  if (reset)
+    gdb_stats_reset ();
+  return MI_CMD_DONE;
+}
+/* APPLE LOCAL end gdb stats  */
+
 enum mi_cmd_result
 mi_cmd_mi_verify_command (char *command, char **argv, int argc)
 {
@@ -1855,6 +2092,149 @@ mi_cmd_mi_no_op (char *command, char **argv, int argc)
   return MI_CMD_DONE;
 }
 
+/* APPLE LOCAL begin mi batch  */
+/* Return non-zero if COMMAND may not be run inside -mi-batch, because
+   it runs or replaces the target, or touches the interpreter that is
+   collecting the batch's results.  */
+
+static int
+mi_command_refused_in_batch (const char *command)
+{
+  static const char *const prefixes[] =
+    { "exec-", "target-", "file-", NULL };
+  static const char *const names[] =
+    {
+      "mi-batch",
+      "interpreter-exec",
+      "interpreter-set",
+      "mi-enable-timings",
+      "gdb-exit",
+      NULL
+    };
+  int i;
+
+  for (i = 0; prefixes[i] != NULL; i++)
+    if (strncmp (command, prefixes[i], strlen (prefixes[i])) == 0)
+      return 1;
+  for (i = 0; names[i] != NULL; i++)
+    if (strcmp (command, names[i]) == 0)
+      return 1;
+  return 0;
+}
+
+static void
+mi_parse_free_cleanup (void *parse)
+{
+  mi_parse_free ((struct mi_parse *) parse);
+}
+
+/* Run the parsed command PARSE as one element of a batch.  */
+
+static enum mi_cmd_result
+mi_batch_execute_1 (struct mi_parse *parse)
+{
+  if (parse->cmd->args_func != NULL)
+    return parse->cmd->args_func (parse->args, 0 /*from_tty */ );
+  if (parse->cmd->argv_func != NULL)
+    return parse->cmd->argv_func (parse->command, parse->argv, parse->argc);
+  if (parse->cmd->cli.cmd != NULL)
+    {
+      mi_execute_cli_command (parse->cmd->cli.cmd, parse->cmd->cli.args_p,
+			      parse->args);
+      return MI_CMD_DONE;
+    }
+  error ("Undefined mi command: %s (missing implementation)",
+	 parse->command);
+}
+
+/* -mi-batch "COMMAND" ...
+
+   Run each COMMAND, a complete MI command line, against the current
+   stop and return all of their results in one record:
+
+     ^done,batch=[{command="var-update",changelist=[...],status="done"},
+                  {command="foo",status="error",msg="..."}]
+
+   The commands share one memory snapshot, so the locals, varobjs and
+   frames they look at are read from the target only once; the frame
+   and register caches are shared anyway since nothing resumes the
+   target in between.  A failing command doesn't stop the batch.  */
+
+enum mi_cmd_result
+mi_cmd_mi_batch (char *command, char **argv, int argc)
+{
+  struct cleanup *old_chain;
+  int i;
+
+  if (argc == 0)
+    error ("mi_cmd_mi_batch: Usage: -mi-batch \"COMMAND\" ...");
+
+  old_chain = make_cleanup_memory_snapshot ();
+  make_cleanup_ui_out_list_begin_end (uiout, "batch");
+
+  for (i = 0; i < argc; i++)
+    {
+      struct cleanup *tuple_chain;
+      struct mi_parse *parse;
+      char *msg = NULL;
+
+      tuple_chain = make_cleanup_ui_out_tuple_begin_end (uiout, NULL);
+
+      parse = mi_parse_with_error (argv[i], &msg);
+      if (parse != NULL)
+	{
+	  make_cleanup (mi_parse_free_cleanup, parse);
+	  ui_out_field_string (uiout, "command", parse->command);
+	  if (parse->op != MI_COMMAND)
+	    msg = xstrdup ("Only MI commands can be batched");
+	  else
+	    {
+	      if (parse->token[0] != '\0')
+		ui_out_field_string (uiout, "token", parse->token);
+
+	      if (mi_command_refused_in_batch (parse->command))
+		msg = xstrprintf ("Cannot execute command %s in a batch",
+				  parse->command);
+	      else if (target_executing)
+		msg = xstrprintf ("Cannot execute command %s while target running",
+				  parse->command);
+	      else
+		{
+		  struct gdb_exception e;
+		  enum mi_cmd_result rc = MI_CMD_DONE;
+
+		  TRY_CATCH (e, RETURN_MASK_ERROR)
+		    {
+		      rc = mi_batch_execute_1 (parse);
+		    }
+		  if (e.reason < 0)
+		    msg = xstrdup (e.message != NULL ? e.message : "");
+		  else if (rc == MI_CMD_ERROR)
+		    {
+		      msg = mi_error_message != NULL
+			? mi_error_message : xstrdup ("Unknown error");
+		      mi_error_message = NULL;
+		    }
+		}
+	    }
+	}
+
+      if (msg == NULL)
+	ui_out_field_string (uiout, "status", "done");
+      else
+	{
+	  ui_out_field_string (uiout, "status", "error");
+	  ui_out_field_string (uiout, "msg", msg);
+	  xfree (msg);
+	}
+      do_cleanups (tuple_chain);
+    }
+
+  do_cleanups (old_chain);
+  return MI_CMD_DONE;
+}
+/* APPLE LOCAL end mi batch  */
+
 /* Execute a command within a safe environment.  Return >0 for
    ok. Return <0 for supress prompt.  Return 0 to have the error
    extracted from error_last_message(). 
@@ -1872,6 +2252,8 @@ captured_mi_execute_command (struct ui_out *uiout, void *data)
 
   struct ui_out *saved_uiout = uiout;
   struct mi_timestamp cmd_finished;
+  /* APPLE LOCAL mi streaming  */
+  int streamed = 0;
 
   switch (context->op)
     {
@@ -1901,7 +2283,17 @@ captured_mi_execute_command (struct ui_out *uiout, void *data)
       /* Set this to 0 so we don't mistakenly think this command
         caused the target to run under interpreter-exec.  */
       mi_interp_exec_cmd_did_run = 0;
+      /* APPLE LOCAL begin mi streaming  */
+      if (mi_stream_results && mi_command_streams_result (context->command))
+	{
+	  char *prefix = concat (context->token, "^done", (char *) NULL);
+
+	  mi_out_stream_begin (saved_uiout, raw_stdout, prefix);
+	  xfree (prefix);
+	}
       args->rc = mi_cmd_execute (context);
+      streamed = mi_out_stream_end (saved_uiout);
+      /* APPLE LOCAL end mi streaming  */
 
       /* Check if CURRENT_COMMAND_TS has been nulled out ... if the
          mi_cmd_execute command completed the command and printed out
@@ -1941,6 +2333,30 @@ captured_mi_execute_command (struct ui_out *uiout, void *data)
 	     will most likely crash in the mi_out_* routines. 
 	  */
 			    
+	  /* APPLE LOCAL begin mi streaming  */
+	  if (streamed)
+	    {
+	      /* "^done" and part of the result are already out, so
+		 all we can do with an error now is finish the record
+		 (the cleanups have closed its open lists and tuples)
+		 and say what went wrong on the log stream.  */
+	      mi_out_put (saved_uiout, raw_stdout);
+	      mi_out_rewind (saved_uiout);
+	      if (do_timings && context->cmd_start)
+		print_diff (context->cmd_start, &cmd_finished);
+	      fputs_unfiltered ("\n", raw_stdout);
+	      if (args->rc == MI_CMD_ERROR && mi_error_message)
+		{
+		  fputs_unfiltered ("&\"", raw_stdout);
+		  fputstr_unfiltered (mi_error_message, '"', raw_stdout);
+		  fputs_unfiltered ("\\n\"\n", raw_stdout);
+		  xfree (mi_error_message);
+		  mi_error_message = NULL;
+		}
+	      mi_out_stream_finish (raw_stdout);
+	    }
+	  else
+	  /* APPLE LOCAL end mi streaming  */
 	  if (args->rc == MI_CMD_DONE)
 	    {
 	      fputs_unfiltered (context->token, raw_stdout);
@@ -2166,6 +2582,20 @@ mi_execute_command (char *cmd, int from_tty)
 	  mi_parse_free (command);
 	  return;
 	}
+      /* APPLE LOCAL begin mi streaming  */
+      if (result.reason < 0 && mi_out_stream_end (saved_uiout))
+	{
+	  /* Part of the result went out under "^done" before the
+	     error; finish that record.  exception_print has put the
+	     message on the log stream, to go out right after it.  */
+          ui_out_cleanup_after_error (saved_uiout);
+          mi_out_put (saved_uiout, raw_stdout);
+          mi_out_rewind (saved_uiout);
+	  fputs_unfiltered ("\n", raw_stdout);
+	  mi_out_stream_finish (raw_stdout);
+	}
+      else
+      /* APPLE LOCAL end mi streaming  */
       if (result.reason < 0)
 	{
 	  /* The command execution failed and error() was called
@@ -2202,6 +2632,37 @@ mi_execute_command (char *cmd, int from_tty)
   gdb_flush (raw_stdout);
 }
 
+/* APPLE LOCAL begin mi streaming  */
+/* Return non-zero if COMMAND's result is a list that can get very
+   long, and the command doesn't run the target or print anything but
+   its result, so that it is safe to write the result out as it is
+   built.  */
+
+static int
+mi_command_streams_result (char *command)
+{
+  static const char *const streamed[] =
+    {
+      "stack-list-frames",
+      "stack-list-arguments",
+      "stack-list-locals",
+      "var-list-children",
+      "data-disassemble",
+      "data-read-memory",
+      "data-read-memory-bytes",
+      "file-list-exec-source-files",
+      "symbol-list-lines",
+      NULL
+    };
+  int i;
+
+  for (i = 0; streamed[i] != NULL; i++)
+    if (strcmp (command, streamed[i]) == 0)
+      return 1;
+  return 0;
+}
+/* APPLE LOCAL end mi streaming  */
+
 static int 
 mi_command_completes_while_target_executing (char *command)
 {
@@ -2574,6 +3035,19 @@ Set whether timing information is displayed for mi commands."), _("\
 Show whether timing information is displayed for mi commands."), NULL,
 			   NULL, NULL,
 			   &setlist, &showlist);
+
+  /* APPLE LOCAL begin mi streaming  */
+  add_setshow_boolean_cmd ("mi-stream-results", class_obscure,
+			   &mi_stream_results, _("\
+Set whether long mi results are written out as they are built."), _("\
+Show whether long mi results are written out as they are built."), _("\
+When on, the results of commands like -stack-list-frames and\n\
+-var-list-children are sent a finished element at a time, instead of\n\
+being held in memory until the command completes.  An error partway\n\
+through then cuts the result short and is reported on the log stream."),
+			   NULL, NULL,
+			   &setlist, &showlist);
+  /* APPLE LOCAL end mi streaming  */
   /* APPLE LOCAL end mi */
 }
 
@@ -2784,6 +3258,8 @@ timestamp (struct mi_timestamp *tv)
   getrusage (RUSAGE_SELF, &tv->rusage);
   tv->remotestats.mi_token[0] = '\0';
   tv->remotestats.assigned_to_global = 0;
+  /* APPLE LOCAL gdb stats  */
+  gdb_stats_snapshot (&tv->stats);
 }
 
 /* The remote protocol packet counts are updated over in remote.c
@@ -2862,6 +3338,35 @@ print_diff (struct mi_timestamp *start, struct mi_timestamp *end)
         (double) ((start->remotestats.totaltime.tv_sec * 1000000) + start->remotestats.totaltime.tv_usec) / 1000000.0,
         total_packets_sent, total_packets_received);
     }
+
+  /* APPLE LOCAL begin gdb stats  */
+  /* And where the time went, for whatever this command did.  */
+  {
+    int i;
+    int printed = 0;
+
+    for (i = 0; i < GDB_STAT_COUNT; i++)
+      {
+	struct gdb_stat_counter *s = &start->stats.counters[i];
+	struct gdb_stat_counter *e = &end->stats.counters[i];
+
+	if (e->count == s->count)
+	  continue;
+	fprintf_unfiltered (raw_stdout, "%s%s={count=\"%lu\",",
+			    printed ? "," : ",profile={",
+			    gdb_stat_name (i),
+			    (unsigned long) (e->count - s->count));
+	if (e->bytes != s->bytes)
+	  fprintf_unfiltered (raw_stdout, "bytes=\"%lu\",",
+			      (unsigned long) (e->bytes - s->bytes));
+	fprintf_unfiltered (raw_stdout, "time=\"%0.5f\"}",
+			    (e->time - s->time) / 1000000.0);
+	printed = 1;
+      }
+    if (printed)
+      fputs_unfiltered ("}", raw_stdout);
+  }
+  /* APPLE LOCAL end gdb stats  */
 }
 
 static long 
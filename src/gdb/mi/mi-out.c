@@ -25,6 +25,10 @@
 #include "ui-out.h"
 #include "ui-file.h"
 #include "mi-out.h"
+/* APPLE LOCAL mi raw field  */
+#include "gdb_string.h"
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
 
 /* This comes from the mi-main.c.  I need it because the notify
    code has to "put" the temporary notify buffer before discarding
@@ -38,9 +42,30 @@ struct ui_out_data
     int suppress_output;
     int mi_version;
     struct ui_file *buffer;
+    /* APPLE LOCAL begin mi streaming  */
+    /* While streaming, where finished elements go, what goes in front
+       of the first of them, and whether that has been written yet.  */
+    struct ui_file *stream;
+    char *stream_prefix;
+    int stream_started;
+    int stream_elements;
+    /* APPLE LOCAL end mi streaming  */
   };
 typedef struct ui_out_data mi_out_data;
 
+/* APPLE LOCAL begin mi streaming  */
+/* The stream is flushed to the output fd after this many finished
+   elements, so the reader can get going before the result is done.  */
+#define MI_STREAM_FLUSH_ELEMENTS 32
+
+/* Records held back while a streamed result is still open, and
+   whether one is: part of it has been written but not its end.  */
+static struct ui_file *mi_stream_deferred = NULL;
+static int mi_stream_open = 0;
+
+static void mi_out_stream_flush (mi_out_data *data);
+/* APPLE LOCAL end mi streaming  */
+
 /* These are the MI output functions */
 
 static void mi_table_begin (struct ui_out *uiout, int nbrofcols,
@@ -216,6 +241,12 @@ mi_end (struct ui_out *uiout,
   if (data->suppress_output)
     return;
   mi_close (uiout, type);
+  /* APPLE LOCAL begin mi streaming  */
+  /* Level 1 is the result's own list or tuple, level 2 each element
+     of it; once one of those is closed, its text can't change.  */
+  if (data->stream != NULL && level <= 2)
+    mi_out_stream_flush (data);
+  /* APPLE LOCAL end mi streaming  */
 }
 
 /* output an int field */
@@ -350,6 +381,8 @@ mi_notify_begin (struct ui_out *uiout, char *class)
   data->buffer = notify_buffer;
   data->suppress_field_separator = 0;
   data->suppress_output = 0;
+  /* APPLE LOCAL mi streaming  */
+  data->stream = NULL;
   fprintf_unfiltered (data->buffer, "=%s", class);
 }
 
@@ -357,9 +390,15 @@ static void
 mi_notify_end (struct ui_out *uiout)
 {
   struct ui_out_data *data = ui_out_data (uiout);
-  mi_out_put (uiout, raw_stdout);
-  fputs_unfiltered ("\n", raw_stdout);  
-  gdb_flush (raw_stdout);
+  /* APPLE LOCAL begin mi streaming  */
+  struct ui_file *out = mi_out_stream_deferred ();
+
+  if (out == NULL)
+    out = raw_stdout;
+  mi_out_put (uiout, out);
+  fputs_unfiltered ("\n", out);  
+  gdb_flush (out);
+  /* APPLE LOCAL end mi streaming  */
 
   ui_file_delete (data->buffer);
   notify_buffer = NULL;
@@ -438,6 +477,36 @@ mi_out_buffered (struct ui_out *uiout, char *string)
   fprintf_unfiltered (data->buffer, "%s", string);
 }
 
+/* APPLE LOCAL begin mi raw field  */
+/* Add TEXT, a complete field ("name=value") formatted earlier by
+   another MI ui_out, as the next field of UIOUT.  */
+
+void
+mi_out_field_raw (struct ui_out *uiout, const char *text)
+{
+  mi_out_data *data = ui_out_data (uiout);
+  if (data->suppress_output)
+    return;
+  field_separator (uiout);
+  fputs_unfiltered (text, data->buffer);
+}
+
+/* Return what UIOUT has buffered so far as an xmalloc'd string,
+   without the separator before its first field.  */
+
+char *
+mi_out_xstrdup (struct ui_out *uiout)
+{
+  mi_out_data *data = ui_out_data (uiout);
+  long length;
+  char *text = ui_file_xstrdup (data->buffer, &length);
+
+  if (text[0] == ',')
+    memmove (text, text + 1, length);
+  return text;
+}
+/* APPLE LOCAL end mi raw field  */
+
 /* clear the buffer */
 
 void
@@ -460,9 +529,83 @@ mi_out_put (struct ui_out *uiout,
 	    struct ui_file *stream)
 {
   mi_out_data *data = ui_out_data (uiout);
+  /* APPLE LOCAL gdb stats  */
+  struct gdb_stat_timer timer;
+
+  gdb_stat_start (GDB_STAT_OUTPUT, &timer);
   ui_file_put (data->buffer, do_write, stream);
   ui_file_rewind (data->buffer);
+  /* APPLE LOCAL gdb stats  */
+  gdb_stat_stop (GDB_STAT_OUTPUT, &timer, 0);
+}
+
+/* APPLE LOCAL begin mi streaming  */
+/* Write out the finished part of DATA's result.  */
+
+static void
+mi_out_stream_flush (mi_out_data *data)
+{
+  if (!data->stream_started)
+    {
+      fputs_unfiltered (data->stream_prefix, data->stream);
+      data->stream_started = 1;
+      mi_stream_open = 1;
+    }
+  ui_file_put (data->buffer, do_write, data->stream);
+  ui_file_rewind (data->buffer);
+  if (++data->stream_elements % MI_STREAM_FLUSH_ELEMENTS == 0)
+    gdb_flush (data->stream);
+}
+
+void
+mi_out_stream_begin (struct ui_out *uiout, struct ui_file *stream,
+		     const char *prefix)
+{
+  mi_out_data *data = ui_out_data (uiout);
+
+  xfree (data->stream_prefix);
+  data->stream = stream;
+  data->stream_prefix = xstrdup (prefix);
+  data->stream_started = 0;
+  data->stream_elements = 0;
+  if (mi_stream_deferred == NULL)
+    mi_stream_deferred = mem_fileopen ();
+}
+
+int
+mi_out_stream_end (struct ui_out *uiout)
+{
+  mi_out_data *data = ui_out_data (uiout);
+  int started = data->stream_started;
+
+  data->stream = NULL;
+  xfree (data->stream_prefix);
+  data->stream_prefix = NULL;
+  data->stream_started = 0;
+  return started;
+}
+
+void
+mi_out_stream_finish (struct ui_file *stream)
+{
+  mi_stream_open = 0;
+  if (mi_stream_deferred == NULL)
+    return;
+  ui_file_put (mi_stream_deferred, do_write, stream);
+  ui_file_rewind (mi_stream_deferred);
+  gdb_flush (stream);
+}
+
+struct ui_file *
+mi_out_stream_deferred (void)
+{
+  /* Only hold things back once part of the result is out.  Before
+     that, and after the line is done, records go out as usual.  */
+  if (!mi_stream_open)
+    return NULL;
+  return mi_stream_deferred;
 }
+/* APPLE LOCAL end mi streaming  */
 
 /* Current MI version.  */
 
@@ -486,6 +629,12 @@ mi_out_new (int mi_version)
   /* FIXME: This code should be using a ``string_file'' and not the
      TUI buffer hack. */
   data->buffer = mem_fileopen ();
+  /* APPLE LOCAL begin mi streaming  */
+  data->stream = NULL;
+  data->stream_prefix = NULL;
+  data->stream_started = 0;
+  data->stream_elements = 0;
+  /* APPLE LOCAL end mi streaming  */
   return ui_out_new (&mi_ui_out_impl, data, flags);
 }
 
@@ -29,6 +29,30 @@ extern struct ui_out *mi_out_new (int mi_version);
 extern void mi_out_put (struct ui_out *uiout, struct ui_file *stream);
 extern void mi_out_rewind (struct ui_out *uiout);
 extern void mi_out_buffered (struct ui_out *uiout, char *string);
+/* APPLE LOCAL begin mi raw field  */
+extern void mi_out_field_raw (struct ui_out *uiout, const char *text);
+extern char *mi_out_xstrdup (struct ui_out *uiout);
+/* APPLE LOCAL end mi raw field  */
+
+/* APPLE LOCAL begin mi streaming  */
+/* Start writing the result UIOUT builds to STREAM as each top-level
+   element of it is finished, preceded by PREFIX (the token and
+   "^done").  Until mi_out_stream_finish, other records that would go
+   to the same stream are held back so they don't land in the middle
+   of the result.  */
+extern void mi_out_stream_begin (struct ui_out *uiout, struct ui_file *stream,
+				 const char *prefix);
+/* Stop streaming UIOUT.  Return non-zero if any of its result (and so
+   PREFIX) has been written already; the caller must then put the rest
+   and end the line itself.  */
+extern int mi_out_stream_end (struct ui_out *uiout);
+/* Once the streamed record's line is finished, write out whatever was
+   held back to STREAM.  */
+extern void mi_out_stream_finish (struct ui_file *stream);
+/* Where other MI records should go while a streamed result is still
+   being written, or NULL if they can go straight out.  */
+extern struct ui_file *mi_out_stream_deferred (void);
+/* APPLE LOCAL end mi streaming  */
 
 /* Return the version number of the current MI.  */
 extern int mi_version (struct ui_out *uiout);
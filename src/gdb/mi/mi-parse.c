@@ -152,10 +152,35 @@ mi_parse_free (struct mi_parse *parse)
 }
 
 
+/* APPLE LOCAL begin mi batch  */
+/* Report the parse failure MSG, which is xmalloc'd: into
+   *ERROR_MESSAGE if the caller asked for it, otherwise straight to
+   the MI output as an ^error record.  */
+
+static void
+mi_parse_error (char **error_message, const char *token, char *msg)
+{
+  if (error_message != NULL)
+    {
+      *error_message = msg;
+      return;
+    }
+  /* FIXME: This should be a function call. */
+  fprintf_unfiltered (raw_stdout, "%s^error,msg=\"%s\"\n", token, msg);
+  xfree (msg);
+}
+
 struct mi_parse *
 mi_parse (char *cmd)
+{
+  return mi_parse_with_error (cmd, NULL);
+}
+
+struct mi_parse *
+mi_parse_with_error (char *cmd, char **error_message)
 {
   char *chp;
+/* APPLE LOCAL end mi batch  */
   struct mi_parse *parse = XMALLOC (struct mi_parse);
   memset (parse, 0, sizeof (*parse));
 
@@ -194,11 +219,10 @@ mi_parse (char *cmd)
   parse->cmd = mi_lookup (parse->command);
   if (parse->cmd == NULL)
     {
-      /* FIXME: This should be a function call. */
-      fprintf_unfiltered
-	(raw_stdout,
-	 "%s^error,msg=\"Undefined MI command: %s\"\n",
-	 parse->token, parse->command);
+      /* APPLE LOCAL mi batch  */
+      mi_parse_error (error_message, parse->token,
+		      xstrprintf ("Undefined MI command: %s",
+				  parse->command));
       mi_parse_free (parse);
       return NULL;
     }
@@ -214,11 +238,10 @@ mi_parse (char *cmd)
       mi_parse_argv (chp, parse);
       if (parse->argv == NULL)
 	{
-	  /* FIXME: This should be a function call. */
-	  fprintf_unfiltered
-	    (raw_stdout,
-	     "%s^error,msg=\"Problem parsing arguments: %s %s\"\n",
-	     parse->token, parse->command, chp);
+	  /* APPLE LOCAL mi batch  */
+	  mi_parse_error (error_message, parse->token,
+			  xstrprintf ("Problem parsing arguments: %s %s",
+				      parse->command, chp));
 	  mi_parse_free (parse);
 	  return NULL;
 	}
@@ -23,6 +23,8 @@
 #define MI_PARSE_H
 
 #include "remote.h"  /* for gdb remote protocol stats */
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
 
 /* MI parser */
 
@@ -32,6 +34,8 @@ struct mi_timestamp {
     struct rusage rusage;
     struct remote_stats remotestats; /* gdb remote protocol stats, this cmd */
     struct remote_stats *saved_remotestats;
+    /* APPLE LOCAL gdb stats  */
+    struct gdb_stats stats;
 };
 
 enum mi_command_type
@@ -59,6 +63,15 @@ struct mi_parse
 
 extern struct mi_parse *mi_parse (char *cmd);
 
+/* APPLE LOCAL begin mi batch  */
+/* Like mi_parse, but if ERROR_MESSAGE is non-NULL, a failure is
+   reported by storing an xmalloc'd message there rather than by
+   printing an ^error record.  */
+
+extern struct mi_parse *mi_parse_with_error (char *cmd,
+					     char **error_message);
+/* APPLE LOCAL end mi batch  */
+
 /* Free a command returned by mi_parse_command. */
 
 extern void mi_parse_free (struct mi_parse *cmd);
@@ -50,6 +50,11 @@
 #include "demangle.h"
 #include "value.h"
 #include "cp-abi.h"
+#include "gdbcmd.h"
+/* APPLE LOCAL parallel minsym install  */
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
 
 /* Accumulate the minimal symbols for each objfile in bunches of BUNCH_SIZE.
    At the end, copy them all into one newly allocated location on an objfile's
@@ -76,6 +81,29 @@ static int msym_bunch_index;
 
 static int msym_count;
 
+/* APPLE LOCAL begin lazy minsym demangling  */
+/* If set, prim_record_minimal_symbol only enters the linkage name of
+   each symbol, and the names are demangled - and the demangled hash
+   table built - by minimal_symbols_demangle the first time something
+   needs them.  */
+static int minsym_lazy_demangle = 0;
+static void
+show_minsym_lazy_demangle (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Demangling minimal symbols only when they are needed is %s.\n"),
+		    value);
+}
+
+/* Incremented for every symbol in the msym bunches whose name was
+   not demangled.  */
+static int msym_lazy_count;
+
+static void minimal_symbol_demangle (struct objfile *,
+				     struct minimal_symbol *);
+/* APPLE LOCAL end lazy minsym demangling  */
+
 /* Compute a hash code based using the same criteria as `strcmp_iw'.  */
 
 unsigned int
@@ -113,8 +141,8 @@ add_minsym_to_hash_table (struct minimal_symbol *sym,
 {
   if (sym->hash_next == NULL)
     {
-      unsigned int hash
-	= msymbol_hash (SYMBOL_LINKAGE_NAME (sym)) % MINIMAL_SYMBOL_HASH_SIZE;
+      /* APPLE LOCAL: Use the hash install_minimal_symbols stored.  */
+      unsigned int hash = sym->hash % MINIMAL_SYMBOL_HASH_SIZE;
       sym->hash_next = table[hash];
       table[hash] = sym;
     }
@@ -128,7 +156,8 @@ add_minsym_to_demangled_hash_table (struct minimal_symbol *sym,
 {
   if (sym->demangled_hash_next == NULL)
     {
-      unsigned int hash = msymbol_hash_iw (SYMBOL_DEMANGLED_NAME (sym)) % MINIMAL_SYMBOL_HASH_SIZE;
+      /* APPLE LOCAL: Use the hash install_minimal_symbols stored.  */
+      unsigned int hash = sym->demangled_hash % MINIMAL_SYMBOL_HASH_SIZE;
       sym->demangled_hash_next = table[hash];
       table[hash] = sym;
     }
@@ -182,7 +211,11 @@ lookup_minimal_symbol_all (const char *name, const char *sfile,
 	      if (pass == 1)
 		msymbol = objfile->msymbol_hash[hash];
 	      else
-		msymbol = objfile->msymbol_demangled_hash[dem_hash];
+		{
+		  /* APPLE LOCAL lazy minsym demangling  */
+		  minimal_symbols_demangle (objfile);
+		  msymbol = objfile->msymbol_demangled_hash[dem_hash];
+		}
 
 	      while (msymbol != NULL 
 		     && found_symbol == NULL
@@ -194,6 +227,8 @@ lookup_minimal_symbol_all (const char *name, const char *sfile,
 					(name)) == 0))
 		      && (!MSYMBOL_OBSOLETED (msymbol)))
 		    {
+		      /* APPLE LOCAL lazy minsym demangling  */
+		      minimal_symbol_demangle (objfile, msymbol);
 		      switch (MSYMBOL_TYPE (msymbol))
 			{
 			case mst_file_text:
@@ -256,6 +291,8 @@ lookup_minimal_symbol_all (const char *name, const char *sfile,
 					(name)) == 0))
 		      && (!MSYMBOL_OBSOLETED (msym)))
 		    {
+		      /* APPLE LOCAL lazy minsym demangling  */
+		      minimal_symbol_demangle (objfile, msym);
 
 		      node = (struct symbol_search *) xmalloc 
 			                                 (sizeof (struct symbol_search));
@@ -345,7 +382,11 @@ lookup_minimal_symbol (const char *name, const char *sfile,
 	      if (pass == 1)
 		msymbol = objfile->msymbol_hash[hash];
 	      else
-		msymbol = objfile->msymbol_demangled_hash[dem_hash];
+		{
+		  /* APPLE LOCAL lazy minsym demangling  */
+		  minimal_symbols_demangle (objfile);
+		  msymbol = objfile->msymbol_demangled_hash[dem_hash];
+		}
 
 	      while (msymbol != NULL && found_symbol == NULL)
 		{
@@ -362,6 +403,8 @@ lookup_minimal_symbol (const char *name, const char *sfile,
 		      /* APPLE LOCAL fix-and-continue */
 		      && (!MSYMBOL_OBSOLETED (msymbol)))
 		    {
+		      /* APPLE LOCAL lazy minsym demangling  */
+		      minimal_symbol_demangle (objfile, msymbol);
 		      switch (MSYMBOL_TYPE (msymbol))
 			{
 			case mst_file_text:
@@ -462,6 +505,8 @@ lookup_minimal_symbol_text (const char *name, struct objfile *objf)
 		   MSYMBOL_TYPE (msymbol) == mst_file_text) &&
                   !MSYMBOL_OBSOLETED (msymbol))
 		{
+		  /* APPLE LOCAL lazy minsym demangling  */
+		  minimal_symbol_demangle (objfile, msymbol);
 		  switch (MSYMBOL_TYPE (msymbol))
 		    {
 		    case mst_file_text:
@@ -518,7 +563,11 @@ lookup_minimal_symbol_solib_trampoline (const char *name,
 	      if (strcmp (SYMBOL_LINKAGE_NAME (msymbol), name) == 0 &&
 		  MSYMBOL_TYPE (msymbol) == mst_solib_trampoline &&
                   !MSYMBOL_OBSOLETED (msymbol))
-		return msymbol;
+		{
+		  /* APPLE LOCAL lazy minsym demangling  */
+		  minimal_symbol_demangle (objfile, msymbol);
+		  return msymbol;
+		}
 	    }
 	}
     }
@@ -537,13 +586,148 @@ lookup_minimal_symbol_solib_trampoline (const char *name,
    overlap, for example objfile A has .text at 0x100 and .data at
    0x40000 and objfile B has .text at 0x234 and .data at 0x40048.  */
 
+/* APPLE LOCAL: Build OBJFILE's packed address array and coarse index
+   over its (sorted) minimal symbols.  */
+
+static void
+build_minimal_symbol_addr_index (struct objfile *objfile)
+{
+  int count = objfile->minimal_symbol_count;
+  CORE_ADDR *addrs;
+  int *index;
+  CORE_ADDR base;
+  int shift;
+  int i, b;
+
+  objfile->msymbol_addrs = NULL;
+  objfile->msymbol_addr_index = NULL;
+  objfile->msymbol_addr_shift = 0;
+
+  if (objfile->msymbols == NULL || count == 0)
+    return;
+
+  addrs = (CORE_ADDR *) obstack_alloc (&objfile->objfile_obstack,
+				       count * sizeof (CORE_ADDR));
+  for (i = 0; i < count; i++)
+    addrs[i] = SYMBOL_VALUE_ADDRESS (&objfile->msymbols[i]);
+
+  base = addrs[0];
+  shift = 0;
+  while (((addrs[count - 1] - base) >> shift) >= MSYMBOL_ADDR_INDEX_SIZE)
+    shift++;
+
+  index = (int *) obstack_alloc (&objfile->objfile_obstack,
+				 (MSYMBOL_ADDR_INDEX_SIZE + 1) * sizeof (int));
+  i = 0;
+  for (b = 0; b <= MSYMBOL_ADDR_INDEX_SIZE; b++)
+    {
+      while (i < count && ((addrs[i] - base) >> shift) < b)
+	i++;
+      index[b] = i;
+    }
+
+  objfile->msymbol_addrs = addrs;
+  objfile->msymbol_addr_index = index;
+  objfile->msymbol_addr_shift = shift;
+}
+
+/* APPLE LOCAL: Return the index of the last minimal symbol in OBJFILE
+   whose address is less than or equal to PC, or -1 if PC is below
+   all of them.  */
+
+static int
+minimal_symbol_index_by_pc (struct objfile *objfile, CORE_ADDR pc)
+{
+  struct minimal_symbol *msymbol = objfile->msymbols;
+  int lo;
+  int hi;
+  int new;
+
+  if (objfile->msymbol_addrs != NULL)
+    {
+      CORE_ADDR *addrs = objfile->msymbol_addrs;
+      CORE_ADDR bucket;
+
+      if (pc < addrs[0])
+	return -1;
+
+      /* Everything in an earlier bucket is at or below PC and
+	 everything in a later one is above it, so only PC's own bucket
+	 needs searching.  Find the first address in it above PC.  */
+      bucket = (pc - addrs[0]) >> objfile->msymbol_addr_shift;
+      if (bucket >= MSYMBOL_ADDR_INDEX_SIZE)
+	return objfile->minimal_symbol_count - 1;
+
+      lo = objfile->msymbol_addr_index[bucket];
+      hi = objfile->msymbol_addr_index[bucket + 1];
+      while (lo < hi)
+	{
+	  new = lo + (hi - lo) / 2;
+	  if (addrs[new] <= pc)
+	    lo = new + 1;
+	  else
+	    hi = new;
+	}
+      return lo - 1;
+    }
+
+  lo = 0;
+  hi = objfile->minimal_symbol_count - 1;
+
+  /* This code assumes that the minimal symbols are sorted by
+     ascending address values.  If the pc value is greater than or
+     equal to the first symbol's address, then some symbol in this
+     minimal symbol table is a suitable candidate for being the
+     "best" symbol.  This includes the last real symbol, for cases
+     where the pc value is larger than any address in this vector.
+
+     By iterating until the address associated with the current
+     hi index (the endpoint of the test interval) is less than
+     or equal to the desired pc value, we accomplish two things:
+     (1) the case where the pc value is larger than any minimal
+     symbol address is trivially solved, (2) the address associated
+     with the hi index is always the one we want when the iteration
+     terminates.  In essence, we are iterating the test interval
+     down until the pc value is pushed out of it from the high end.
+
+     Warning: this code is trickier than it would appear at first. */
+
+  /* Should also require that pc is <= end of objfile.  FIXME! */
+  if (pc < SYMBOL_VALUE_ADDRESS (&msymbol[lo]))
+    return -1;
+
+  while (SYMBOL_VALUE_ADDRESS (&msymbol[hi]) > pc)
+    {
+      /* pc is still strictly less than highest address */
+      /* Note "new" will always be >= lo */
+      new = (lo + hi) / 2;
+      if ((SYMBOL_VALUE_ADDRESS (&msymbol[new]) >= pc) ||
+	  (lo == new))
+	{
+	  hi = new;
+	}
+      else
+	{
+	  lo = new;
+	}
+    }
+
+  /* If we have multiple symbols at the same address, we want
+     hi to point to the last one.  That way we can find the
+     right symbol if it has an index greater than hi.  */
+  while (hi < objfile->minimal_symbol_count - 1
+	 && (SYMBOL_VALUE_ADDRESS (&msymbol[hi])
+	     == SYMBOL_VALUE_ADDRESS (&msymbol[hi + 1])))
+    hi++;
+
+  return hi;
+}
+
 struct minimal_symbol *
 lookup_minimal_symbol_by_pc_section_from_objfile
   (CORE_ADDR pc, asection *section, struct objfile *objfile)
 {
-  int lo;
   int hi;
-  int new;
   struct minimal_symbol *msymbol;
   struct minimal_symbol *best_symbol = NULL;
 
@@ -574,54 +758,9 @@ lookup_minimal_symbol_by_pc_section_from_objfile
 
   if ((msymbol = objfile->msymbols) != NULL)
     {
-      lo = 0;
-      hi = objfile->minimal_symbol_count - 1;
-
-      /* This code assumes that the minimal symbols are sorted by
-         ascending address values.  If the pc value is greater than or
-         equal to the first symbol's address, then some symbol in this
-         minimal symbol table is a suitable candidate for being the
-         "best" symbol.  This includes the last real symbol, for cases
-         where the pc value is larger than any address in this vector.
-
-         By iterating until the address associated with the current
-         hi index (the endpoint of the test interval) is less than
-         or equal to the desired pc value, we accomplish two things:
-         (1) the case where the pc value is larger than any minimal
-         symbol address is trivially solved, (2) the address associated
-         with the hi index is always the one we want when the iteration
-         terminates.  In essence, we are iterating the test interval
-         down until the pc value is pushed out of it from the high end.
-
-         Warning: this code is trickier than it would appear at first. */
-
-      /* Should also require that pc is <= end of objfile.  FIXME! */
-      if (pc >= SYMBOL_VALUE_ADDRESS (&msymbol[lo]))
+      hi = minimal_symbol_index_by_pc (objfile, pc);
+      if (hi >= 0)
 	{
-	  while (SYMBOL_VALUE_ADDRESS (&msymbol[hi]) > pc)
-	    {
-	      /* pc is still strictly less than highest address */
-	      /* Note "new" will always be >= lo */
-	      new = (lo + hi) / 2;
-	      if ((SYMBOL_VALUE_ADDRESS (&msymbol[new]) >= pc) ||
-		  (lo == new))
-		{
-		  hi = new;
-		}
-	      else
-		{
-		  lo = new;
-		}
-	    }
-
-	  /* If we have multiple symbols at the same address, we want
-	     hi to point to the last one.  That way we can find the
-	     right symbol if it has an index greater than hi.  */
-	  while (hi < objfile->minimal_symbol_count - 1
-		 && (SYMBOL_VALUE_ADDRESS (&msymbol[hi])
-		     == SYMBOL_VALUE_ADDRESS (&msymbol[hi + 1])))
-	    hi++;
-
 	  /* The minimal symbol indexed by hi now is the best one in this
 	     objfile's minimal symbol table.  See if it is the best one
 	     overall. */
@@ -664,6 +803,9 @@ lookup_minimal_symbol_by_pc_section_from_objfile
 	      best_symbol = &msymbol[hi];
 	}
     }
+  /* APPLE LOCAL lazy minsym demangling  */
+  if (best_symbol != NULL)
+    minimal_symbol_demangle (objfile, best_symbol);
   return (best_symbol);
 }
 
@@ -764,6 +906,8 @@ void
 init_minimal_symbol_collection (void)
 {
   msym_count = 0;
+  /* APPLE LOCAL lazy minsym demangling  */
+  msym_lazy_count = 0;
   msym_bunch = NULL;
   msym_bunch_index = BUNCH_SIZE;
 }
@@ -852,7 +996,15 @@ prim_record_minimal_symbol_and_info (const char *name, CORE_ADDR address,
 #endif
   SYMBOL_INIT_LANGUAGE_SPECIFIC (msymbol, language_unknown);
   SYMBOL_LANGUAGE (msymbol) = language_auto;
-  SYMBOL_SET_NAMES (msymbol, (char *)name, strlen (name), objfile);
+  /* APPLE LOCAL begin lazy minsym demangling  */
+  if (minsym_lazy_demangle)
+    {
+      SYMBOL_SET_LINKAGE_NAME (msymbol, (char *)name, strlen (name), objfile);
+      msym_lazy_count++;
+    }
+  else
+    SYMBOL_SET_NAMES (msymbol, (char *)name, strlen (name), objfile);
+  /* APPLE LOCAL end lazy minsym demangling  */
 
   SYMBOL_VALUE_ADDRESS (msymbol) = address;
   SYMBOL_SECTION (msymbol) = section;
@@ -915,6 +1067,207 @@ compare_minimal_symbols (const void *fn1p, const void *fn2p)
     }
 }
 
+/* APPLE LOCAL begin parallel minsym install  */
+/* The number of threads install_minimal_symbols uses to sort the
+   minimal symbols of an objfile and to hash their names.  The hash
+   tables are still linked up on the main thread, in table order, so
+   the result is the same whatever this is set to.  Zero or one means
+   don't start any threads.  */
+static int minsym_install_threads = 0;
+static void
+show_minsym_install_threads (struct ui_file *file, int from_tty,
+			     struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+The number of threads used to install minimal symbols is %s.\n"),
+		    value);
+}
+
+/* Don't bother starting a thread for fewer symbols than this.  */
+#define MINSYM_INSTALL_MIN_PER_THREAD 20000
+
+/* How many threads to use for COUNT minimal symbols.  */
+
+static int
+minsym_install_n_workers (int count)
+{
+  int n_workers = minsym_install_threads;
+
+#ifndef USE_PTHREADS
+  n_workers = 1;
+#endif
+  if (n_workers > count / MINSYM_INSTALL_MIN_PER_THREAD)
+    n_workers = count / MINSYM_INSTALL_MIN_PER_THREAD;
+  if (n_workers < 1)
+    n_workers = 1;
+  return n_workers;
+}
+
+struct minsym_install_chunk
+{
+  struct minimal_symbol *msymbols;
+  int count;
+};
+
+/* Hash the linkage and demangled names of the symbols in a chunk.
+   This is only reading the names, so it is safe to do on any thread.
+   It goes straight to the demangled name field rather than through
+   SYMBOL_DEMANGLED_NAME, which for Ada decodes (and allocates) on
+   demand; Ada msymbols never go in the demangled table anyway.  */
+
+static void *
+minsym_hash_chunk (void *arg)
+{
+  struct minsym_install_chunk *chunk = arg;
+  struct minimal_symbol *msym;
+  int i;
+
+  for (i = 0, msym = chunk->msymbols; i < chunk->count; i++, msym++)
+    {
+      msym->hash = msymbol_hash (SYMBOL_LINKAGE_NAME (msym));
+      msym->demangled_hash = 0;
+      if (SYMBOL_LANGUAGE (msym) != language_ada
+	  && SYMBOL_CPLUS_DEMANGLED_NAME (msym) != NULL)
+	msym->demangled_hash
+	  = msymbol_hash_iw (SYMBOL_CPLUS_DEMANGLED_NAME (msym));
+    }
+  return NULL;
+}
+
+static void *
+minsym_sort_chunk (void *arg)
+{
+  struct minsym_install_chunk *chunk = arg;
+
+  qsort (chunk->msymbols, chunk->count, sizeof (struct minimal_symbol),
+	 compare_minimal_symbols);
+  return NULL;
+}
+
+/* Split the COUNT symbols at MSYMBOLS into N_WORKERS chunks, storing
+   them in CHUNKS, and run FUNC over each one.  The calling thread
+   does the first chunk, and any chunk whose thread can't be started
+   as well.  */
+
+static void
+minsym_run_chunks (struct minimal_symbol *msymbols, int count,
+		   int n_workers, struct minsym_install_chunk *chunks,
+		   void *(*func) (void *))
+{
+  int i;
+#ifdef USE_PTHREADS
+  pthread_t *threads;
+  int *started;
+#endif
+
+  for (i = 0; i < n_workers; i++)
+    {
+      int start = (int) ((long long) count * i / n_workers);
+      int end = (int) ((long long) count * (i + 1) / n_workers);
+      chunks[i].msymbols = msymbols + start;
+      chunks[i].count = end - start;
+    }
+
+#ifdef USE_PTHREADS
+  threads = xmalloc (n_workers * sizeof (pthread_t));
+  started = xcalloc (n_workers, sizeof (int));
+  for (i = 1; i < n_workers; i++)
+    started[i] = (pthread_create (&threads[i], NULL, func, &chunks[i]) == 0);
+
+  func (&chunks[0]);
+
+  for (i = 1; i < n_workers; i++)
+    if (started[i])
+      pthread_join (threads[i], NULL);
+    else
+      func (&chunks[i]);
+
+  xfree (started);
+  xfree (threads);
+#else
+  for (i = 0; i < n_workers; i++)
+    func (&chunks[i]);
+#endif
+}
+
+/* Sort the COUNT minimal symbols at MSYMBOLS by address.  With more
+   than one worker, each sorts a chunk and the sorted chunks are then
+   merged pairwise.  */
+
+static void
+sort_minimal_symbols (struct minimal_symbol *msymbols, int count)
+{
+  struct minsym_install_chunk *chunks;
+  struct minimal_symbol *from, *to, *tmp, *buf;
+  int n_workers = minsym_install_n_workers (count);
+  int n_runs, i;
+
+  if (n_workers == 1)
+    {
+      qsort (msymbols, count, sizeof (struct minimal_symbol),
+	     compare_minimal_symbols);
+      return;
+    }
+
+  chunks = xmalloc (n_workers * sizeof (struct minsym_install_chunk));
+  minsym_run_chunks (msymbols, count, n_workers, chunks, minsym_sort_chunk);
+
+  buf = xmalloc (count * sizeof (struct minimal_symbol));
+  from = msymbols;
+  to = buf;
+  n_runs = n_workers;
+  while (n_runs > 1)
+    {
+      int out = 0;
+      for (i = 0; i < n_runs; i += 2)
+	{
+	  struct minimal_symbol *a = from + (chunks[i].msymbols - msymbols);
+	  struct minimal_symbol *a_end = a + chunks[i].count;
+	  struct minimal_symbol *dest = to + (chunks[i].msymbols - msymbols);
+	  struct minsym_install_chunk merged = chunks[i];
+
+	  if (i + 1 < n_runs)
+	    {
+	      struct minimal_symbol *b = a_end;
+	      struct minimal_symbol *b_end = b + chunks[i + 1].count;
+	      while (a < a_end && b < b_end)
+		*dest++ = (compare_minimal_symbols (b, a) < 0) ? *b++ : *a++;
+	      while (b < b_end)
+		*dest++ = *b++;
+	      merged.count += chunks[i + 1].count;
+	    }
+	  while (a < a_end)
+	    *dest++ = *a++;
+	  chunks[out++] = merged;
+	}
+      n_runs = out;
+      tmp = from;
+      from = to;
+      to = tmp;
+    }
+
+  if (from != msymbols)
+    memcpy (msymbols, from, count * sizeof (struct minimal_symbol));
+
+  xfree (buf);
+  xfree (chunks);
+}
+
+/* Work out the stored name hashes for the COUNT minimal symbols at
+   MSYMBOLS.  */
+
+static void
+hash_minimal_symbols (struct minimal_symbol *msymbols, int count)
+{
+  struct minsym_install_chunk *chunks;
+  int n_workers = minsym_install_n_workers (count);
+
+  chunks = xmalloc (n_workers * sizeof (struct minsym_install_chunk));
+  minsym_run_chunks (msymbols, count, n_workers, chunks, minsym_hash_chunk);
+  xfree (chunks);
+}
+/* APPLE LOCAL end parallel minsym install  */
+
 /* Discard the currently collected minimal symbols, if any.  If we wish
    to save them for later use, we must have already copied them somewhere
    else before calling this function.
@@ -1045,6 +1398,84 @@ build_minimal_symbol_hash_tables (struct objfile *objfile)
     }
 }
 
+/* APPLE LOCAL begin lazy minsym demangling  */
+/* Demangle the name of MSYM, one of OBJFILE's minimal symbols, if
+   that was put off, and if it has a demangled name enter it in the
+   demangled hash table.  */
+
+static void
+minimal_symbol_demangle_1 (struct objfile *objfile,
+			   struct minimal_symbol *msym)
+{
+  /* A symbol whose name demangled has had its language set, and one
+     whose didn't has no demangled name to hash.  */
+  if (SYMBOL_LANGUAGE (msym) != language_auto)
+    return;
+
+  SYMBOL_SET_NAMES (msym, SYMBOL_LINKAGE_NAME (msym),
+		    strlen (SYMBOL_LINKAGE_NAME (msym)), objfile);
+  if (SYMBOL_SEARCH_NAME (msym) != SYMBOL_LINKAGE_NAME (msym))
+    {
+      msym->demangled_hash = msymbol_hash_iw (SYMBOL_DEMANGLED_NAME (msym));
+      msym->demangled_hash_next = NULL;
+      add_minsym_to_demangled_hash_table (msym,
+					  objfile->msymbol_demangled_hash);
+    }
+}
+
+static void
+minimal_symbol_demangle (struct objfile *objfile,
+			 struct minimal_symbol *msym)
+{
+  if (!objfile->minimal_symbols_demangled)
+    minimal_symbol_demangle_1 (objfile, msym);
+}
+
+/* Try to guess the appropriate C++ ABI by looking at the names of
+   OBJFILE's minimal symbols.  */
+
+static void
+guess_cp_abi_from_msymbols (struct objfile *objfile)
+{
+  int i;
+
+  for (i = 0; i < objfile->minimal_symbol_count; i++)
+    {
+      /* If a symbol's name starts with _Z and was successfully
+	 demangled, then we can assume we've found a GNU v3 symbol.
+	 For now we set the C++ ABI globally; if the user is
+	 mixing ABIs then the user will need to "set cp-abi"
+	 manually.  */
+      const char *name = SYMBOL_LINKAGE_NAME (&objfile->msymbols[i]);
+      if (name[0] == '_' && name[1] == 'Z' && cp_abi_is_auto_p ())
+	{
+	  minimal_symbol_demangle (objfile, &objfile->msymbols[i]);
+	  if (SYMBOL_DEMANGLED_NAME (&objfile->msymbols[i]) != NULL)
+	    {
+	      set_cp_abi_as_auto_default ("gnu-v3");
+	      break;
+	    }
+	}
+    }
+}
+
+/* Demangle any of OBJFILE's minimal symbols that prim_record_minimal_symbol
+   didn't, so that the demangled hash table is complete.  */
+
+void
+minimal_symbols_demangle (struct objfile *objfile)
+{
+  int i;
+
+  if (objfile->minimal_symbols_demangled)
+    return;
+  objfile->minimal_symbols_demangled = 1;
+
+  for (i = 0; i < objfile->minimal_symbol_count; i++)
+    minimal_symbol_demangle_1 (objfile, &objfile->msymbols[i]);
+}
+/* APPLE LOCAL end lazy minsym demangling  */
+
 /* Add the minimal symbols in the existing bunches to the objfile's official
    minimal symbol table.  In most cases there is no minimal symbol table yet
    for this objfile, and the existing bunches are used to create one.  Once
@@ -1115,14 +1546,18 @@ install_minimal_symbols (struct objfile *objfile)
 
       /* Sort the minimal symbols by address.  */
 
-      qsort (msymbols, mcount, sizeof (struct minimal_symbol),
-	     compare_minimal_symbols);
+      /* APPLE LOCAL parallel minsym install  */
+      sort_minimal_symbols (msymbols, mcount);
 
       /* Compact out any duplicates, and free up whatever space we are
          no longer using.  */
 
       mcount = compact_minimal_symbols (msymbols, mcount, objfile);
 
+      /* APPLE LOCAL: Hash the names now, while we're going over them
+	 anyway, so build_minimal_symbol_hash_tables doesn't have to.  */
+      hash_minimal_symbols (msymbols, mcount);
+
       obstack_blank (&objfile->objfile_obstack,
 	       (mcount + 1 - alloc_count) * sizeof (struct minimal_symbol));
       msymbols = (struct minimal_symbol *)
@@ -1149,37 +1584,27 @@ install_minimal_symbols (struct objfile *objfile)
          The strings themselves are also located in the objfile_obstack
          of this objfile.  */
 
+      /* APPLE LOCAL begin lazy minsym demangling  */
+      if (msym_lazy_count > 0)
+	objfile->minimal_symbols_demangled = 0;
+      else if (objfile->minimal_symbol_count == 0)
+	objfile->minimal_symbols_demangled = 1;
+      /* APPLE LOCAL end lazy minsym demangling  */
+
       objfile->minimal_symbol_count = mcount;
       objfile->msymbols = msymbols;
 
       /* Try to guess the appropriate C++ ABI by looking at the names 
 	 of the minimal symbols in the table.  */
-      {
-	int i;
-
-	for (i = 0; i < mcount; i++)
-	  {
-	    /* If a symbol's name starts with _Z and was successfully
-	       demangled, then we can assume we've found a GNU v3 symbol.
-	       For now we set the C++ ABI globally; if the user is
-	       mixing ABIs then the user will need to "set cp-abi"
-	       manually.  */
-	    const char *name = SYMBOL_LINKAGE_NAME (&objfile->msymbols[i]);
-	    if (name[0] == '_' && name[1] == 'Z' 
-		&& SYMBOL_DEMANGLED_NAME (&objfile->msymbols[i]) != NULL
-		&& cp_abi_is_auto_p())
-	      {
-		set_cp_abi_as_auto_default ("gnu-v3");
-		break;
-	      }
-	  }
-      }
+      /* APPLE LOCAL lazy minsym demangling  */
+      guess_cp_abi_from_msymbols (objfile);
       
       /* Now build the hash tables; we can't do this incrementally
          at an earlier point since we weren't finished with the obstack
 	 yet.  (And if the msymbol obstack gets moved, all the internal
 	 pointers to other msymbols need to be adjusted.) */
       build_minimal_symbol_hash_tables (objfile);
+      build_minimal_symbol_addr_index (objfile);
 
       /* APPLE LOCAL: We build a table of correspondence for symbols that are the
 	 Posix compatiblity variants of symbols that exist in the library. */
@@ -1192,9 +1617,10 @@ install_minimal_symbols (struct objfile *objfile)
 void
 msymbols_sort (struct objfile *objfile)
 {
-  qsort (objfile->msymbols, objfile->minimal_symbol_count,
-	 sizeof (struct minimal_symbol), compare_minimal_symbols);
+  /* APPLE LOCAL parallel minsym install  */
+  sort_minimal_symbols (objfile->msymbols, objfile->minimal_symbol_count);
   build_minimal_symbol_hash_tables (objfile);
+  build_minimal_symbol_addr_index (objfile);
   /* APPLE LOCAL: sorting the msymbols shuffles them around so that
      the pointers inthe equivalence table are no longer valid.  So
      we have to rebuild them too.  */
@@ -1235,13 +1661,52 @@ find_solib_trampoline_target (CORE_ADDR pc)
 
   if (tsymbol != NULL)
     {
-      ALL_MSYMBOLS (objfile, msymbol)
-      {
-	if (MSYMBOL_TYPE (msymbol) == mst_text
-	    && strcmp (SYMBOL_LINKAGE_NAME (msymbol),
-		       SYMBOL_LINKAGE_NAME (tsymbol)) == 0)
-	  return SYMBOL_VALUE_ADDRESS (msymbol);
-      }
+      /* APPLE LOCAL begin trampoline targets  */
+      /* Walk just the name's hash chain in each objfile, rather than
+	 every minimal symbol there is.  */
+      const char *name = SYMBOL_LINKAGE_NAME (tsymbol);
+      unsigned int hash = msymbol_hash (name) % MINIMAL_SYMBOL_HASH_SIZE;
+
+      ALL_OBJFILES (objfile)
+	for (msymbol = objfile->msymbol_hash[hash];
+	     msymbol != NULL;
+	     msymbol = msymbol->hash_next)
+	  if (MSYMBOL_TYPE (msymbol) == mst_text
+	      && strcmp (SYMBOL_LINKAGE_NAME (msymbol), name) == 0)
+	    return SYMBOL_VALUE_ADDRESS (msymbol);
+      /* APPLE LOCAL end trampoline targets  */
     }
   return 0;
 }
+
+/* APPLE LOCAL parallel minsym install  */
+void
+_initialize_minsyms (void)
+{
+  add_setshow_zinteger_cmd ("minimal-symbol-threads", class_obscure,
+			    &minsym_install_threads, _("\
+Set the number of threads used to install minimal symbols."), _("\
+Show the number of threads used to install minimal symbols."), _("\
+When greater than one, the minimal symbols of a large objfile are sorted\n\
+and their names hashed by this many threads.  The hash tables themselves\n\
+are still built on the main thread.  Zero or one uses no threads."),
+			    NULL,
+			    show_minsym_install_threads,
+			    &maintenance_set_cmdlist,
+			    &maintenance_show_cmdlist);
+
+  /* APPLE LOCAL lazy minsym demangling  */
+  add_setshow_boolean_cmd ("minimal-symbol-lazy-demangling", class_obscure,
+			   &minsym_lazy_demangle, _("\
+Set whether minimal symbol names are demangled only when they are needed."), _("\
+Show whether minimal symbol names are demangled only when they are needed."), _("\
+When on, reading an objfile's minimal symbols doesn't demangle their\n\
+names.  A symbol's name is demangled when it is first found by address\n\
+or linkage name, and all of them are the first time the objfile's\n\
+minimal symbols are searched by demangled name or walked.\n\
+This only affects objfiles read after it is changed."),
+			   NULL,
+			   show_minsym_lazy_demangle,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+}
@@ -876,14 +876,16 @@ objc_read_trampoline_region (CORE_ADDR addr)
   int i;
   struct cleanup *region_cleanup;
   int entry_size;
-
-  /* First read in the header.  */
-  header_size = read_memory_unsigned_integer (addr, 2);
-  addr += 2;
-  desc_size = read_memory_unsigned_integer (addr, 2);
-  addr += 2;
-  num_records = read_memory_unsigned_integer (addr, 4);
-  addr += 4;
+  /* APPLE LOCAL begin objc trampoline reading  */
+  gdb_byte header[8 + 8];
+  gdb_byte *records;
+
+  /* First read in the header, next region pointer and all.  */
+  read_memory (addr, header, 8 + wordsize);
+  header_size = extract_unsigned_integer (header, 2);
+  desc_size = extract_unsigned_integer (header + 2, 2);
+  num_records = extract_unsigned_integer (header + 4, 4);
+  /* APPLE LOCAL end objc trampoline reading  */
   
   /* There are two versions of the trampoline at present.  One has two
      uint32_t's.  The other has two intptr_t's.  This is a bit ambiguous
@@ -909,15 +911,23 @@ objc_read_trampoline_region (CORE_ADDR addr)
 
   region_cleanup = make_cleanup (xfree, region);
 
-  region->next_region_start = read_memory_unsigned_integer (addr, wordsize);
+  /* APPLE LOCAL begin objc trampoline reading  */
+  region->next_region_start = extract_unsigned_integer (header + 8, wordsize);
   region->num_records = num_records;
 
-  /* Now skip to the start of the records using the header size.  */
+  /* Now skip to the start of the records using the header size, and
+     read them all at once.  */
   addr = orig_addr + header_size;
+  if (desc_size < 2 * entry_size)
+    error (_("Objective-C trampoline records at 0x%s are too small."),
+	   paddr_nz (addr));
+  records = xmalloc (num_records * desc_size);
+  make_cleanup (xfree, records);
+  read_memory (addr, records, num_records * desc_size);
 
   for (i = 0; i < region->num_records; i++)
     {
-      CORE_ADDR record_start = addr;
+      const gdb_byte *record = records + i * desc_size;
       CORE_ADDR offset;
 
       /* The address in the ObjC trampoline itself is the
@@ -925,13 +935,12 @@ objc_read_trampoline_region (CORE_ADDR addr)
 	 is the first field of the record.  We just store the trampoline
          code address, since that is more convenient.  */
 
-      offset = read_memory_unsigned_integer (addr, entry_size);
-      region->records[i].start_addr = addr + offset;
-      addr += entry_size;
-
-      region->records[i].flags = read_memory_unsigned_integer (addr, entry_size);
-      addr = record_start + desc_size;
+      offset = extract_unsigned_integer (record, entry_size);
+      region->records[i].start_addr = addr + i * desc_size + offset;
+      region->records[i].flags = extract_unsigned_integer (record + entry_size,
+							   entry_size);
     }
+  /* APPLE LOCAL end objc trampoline reading  */
 
   /* Get the bound of the trampoline code.  I'm assuming it is all contiguous,
      which Greg says it will be.  */
@@ -942,6 +951,8 @@ objc_read_trampoline_region (CORE_ADDR addr)
     }
 
   discard_cleanups (region_cleanup);
+  /* APPLE LOCAL objc trampoline reading  */
+  xfree (records);
   return region;
 }
 
@@ -1156,14 +1167,25 @@ pc_in_objc_trampoline_p (CORE_ADDR pc, uint32_t *flags)
 	     to be filled in.  */
 	  if (flags != NULL)
 	    {
-	      for (i = region->num_records - 1; i >= 0; i--)
+	      /* APPLE LOCAL begin objc trampoline reading  */
+	      /* Find the last record starting at or before PC.  */
+	      int lo = 0, hi = region->num_records;
+
+	      while (lo < hi)
 		{
-		  if (region->records[i].start_addr <= pc)
-		    {
-		      *flags = region->records[i].flags;
-		      return in_tramp;
-		    }
+		  int mid = lo + (hi - lo) / 2;
+		  if (region->records[mid].start_addr <= pc)
+		    lo = mid + 1;
+		  else
+		    hi = mid;
+		}
+	      i = lo - 1;
+	      if (i >= 0)
+		{
+		  *flags = region->records[i].flags;
+		  return in_tramp;
 		}
+	      /* APPLE LOCAL end objc trampoline reading  */
 	    }
 	}
     }
@@ -1430,6 +1452,232 @@ specialcmp (char *a, char *b)
   return    0;		/* a and b are identical */
 }
 
+/* APPLE LOCAL begin objc method index  */
+/* An index of the Objective-C method symbols in one objfile, so that
+   "info selectors", "info classes" and breakpoints on -[Class sel]
+   don't have to look at every minimal symbol of every objfile, and
+   don't have to parse every method name again each time.  It is
+   built the first time it's wanted after the objfile's minimal
+   symbols are installed, and lives on the objfile's obstack.  */
+
+struct objc_method_entry
+{
+  struct minimal_symbol *msymbol;
+
+  /* The method symbol's name, "-[Class(Category) selector]".  */
+  char *name;
+
+  /* The pieces of NAME as parse_method picks them apart.  CLASS is
+     NULL if NAME isn't entirely a method name (for instance the
+     "[Class message].eh" symbols -fexceptions generates).  */
+  char type;
+  char *class;
+  char *category;
+  char *selector;
+
+  /* The position of the entry in the msymbol order.  */
+  int index;
+};
+
+struct objc_method_index
+{
+  /* The minimal symbols the index was built from; if the objfile's
+     are replaced, the index is rebuilt.  */
+  struct minimal_symbol *msymbols;
+  int minimal_symbol_count;
+
+  /* Every minimal symbol whose name starts with "-[" or "+[", in
+     msymbol order.  */
+  struct objc_method_entry *methods;
+  int nmethods;
+
+  /* The entries with a well-formed name, sorted by class and by
+     selector.  Entries with equal keys stay in msymbol order.  */
+  struct objc_method_entry **by_class;
+  struct objc_method_entry **by_selector;
+  int nsorted;
+};
+
+static const struct objfile_data *objc_method_index_objfile_data;
+
+static int
+compare_method_entries_by_class (const void *a, const void *b)
+{
+  const struct objc_method_entry *ea = *(struct objc_method_entry **) a;
+  const struct objc_method_entry *eb = *(struct objc_method_entry **) b;
+  int cmp;
+
+  cmp = strcmp (ea->class, eb->class);
+  if (cmp != 0)
+    return cmp;
+  return ea->index - eb->index;
+}
+
+static int
+compare_method_entries_by_selector (const void *a, const void *b)
+{
+  const struct objc_method_entry *ea = *(struct objc_method_entry **) a;
+  const struct objc_method_entry *eb = *(struct objc_method_entry **) b;
+  int cmp;
+
+  cmp = strcmp (ea->selector, eb->selector);
+  if (cmp != 0)
+    return cmp;
+  return ea->index - eb->index;
+}
+
+static char *
+objc_method_index_copy (struct objfile *objfile, const char *str)
+{
+  if (str == NULL)
+    return NULL;
+  return obstack_copy0 (&objfile->objfile_obstack, str, strlen (str));
+}
+
+/* Return the method index of OBJFILE, building it if need be.  */
+
+static struct objc_method_index *
+objc_method_index (struct objfile *objfile)
+{
+  struct objc_method_index *method_index;
+  struct minimal_symbol *msymbol;
+  struct cleanup *old_chain;
+  char *tmp = NULL;
+  unsigned int tmplen = 0;
+  int nmethods;
+  int i;
+
+  method_index = objfile_data (objfile, objc_method_index_objfile_data);
+  if (method_index != NULL
+      && method_index->msymbols == objfile->msymbols
+      && (method_index->minimal_symbol_count
+	  == objfile->minimal_symbol_count))
+    return method_index;
+
+  method_index = obstack_alloc (&objfile->objfile_obstack,
+				sizeof (struct objc_method_index));
+  memset (method_index, 0, sizeof (struct objc_method_index));
+  method_index->msymbols = objfile->msymbols;
+  method_index->minimal_symbol_count = objfile->minimal_symbol_count;
+
+  nmethods = 0;
+  ALL_OBJFILE_MSYMBOLS (objfile, msymbol)
+    {
+      char *name = SYMBOL_NATURAL_NAME (msymbol);
+
+      if (name != NULL && (name[0] == '-' || name[0] == '+')
+	  && name[1] == '[')
+	nmethods++;
+    }
+
+  if (nmethods > 0)
+    method_index->methods
+      = obstack_alloc (&objfile->objfile_obstack,
+		       nmethods * sizeof (struct objc_method_entry));
+
+  old_chain = make_cleanup (free_current_contents, &tmp);
+  ALL_OBJFILE_MSYMBOLS (objfile, msymbol)
+    {
+      char *name = SYMBOL_NATURAL_NAME (msymbol);
+      struct objc_method_entry *entry;
+      char ntype = '\0';
+      char *nclass = NULL;
+      char *ncategory = NULL;
+      char *nselector = NULL;
+      char *name_end;
+
+      if (name == NULL || (name[0] != '-' && name[0] != '+')
+	  || name[1] != '[')
+	continue;
+
+      entry = &method_index->methods[method_index->nmethods];
+      memset (entry, 0, sizeof (struct objc_method_entry));
+      entry->msymbol = msymbol;
+      entry->name = name;
+      entry->index = method_index->nmethods++;
+
+      while ((strlen (name) + 1) >= tmplen)
+	{
+	  tmplen = (tmplen == 0) ? 1024 : tmplen * 2;
+	  tmp = xrealloc (tmp, tmplen);
+	}
+      strcpy (tmp, name);
+
+      name_end = parse_method (tmp, &ntype, &nclass, &ncategory, &nselector);
+      if (name_end == NULL || *name_end != '\0'
+	  || nclass == NULL || nselector == NULL)
+	continue;
+
+      entry->type = ntype;
+      entry->class = objc_method_index_copy (objfile, nclass);
+      entry->category = objc_method_index_copy (objfile, ncategory);
+      entry->selector = objc_method_index_copy (objfile, nselector);
+      method_index->nsorted++;
+    }
+  do_cleanups (old_chain);
+
+  if (method_index->nsorted > 0)
+    {
+      int nsorted = 0;
+      size_t size;
+
+      size = method_index->nsorted * sizeof (struct objc_method_entry *);
+
+      method_index->by_class = obstack_alloc (&objfile->objfile_obstack, size);
+      method_index->by_selector = obstack_alloc (&objfile->objfile_obstack,
+						 size);
+      for (i = 0; i < method_index->nmethods; i++)
+	if (method_index->methods[i].class != NULL)
+	  {
+	    method_index->by_class[nsorted] = &method_index->methods[i];
+	    method_index->by_selector[nsorted] = &method_index->methods[i];
+	    nsorted++;
+	  }
+      qsort (method_index->by_class, nsorted,
+	     sizeof (struct objc_method_entry *),
+	     compare_method_entries_by_class);
+      qsort (method_index->by_selector, nsorted,
+	     sizeof (struct objc_method_entry *),
+	     compare_method_entries_by_selector);
+    }
+
+  set_objfile_data (objfile, objc_method_index_objfile_data, method_index);
+  return method_index;
+}
+
+/* Find the run of entries in SORTED (of which there are NSORTED)
+   whose class (if BY_CLASS) or selector is KEY.  Store its length in
+   *COUNT and return its start.  */
+
+static struct objc_method_entry **
+objc_method_index_range (struct objc_method_entry **sorted, int nsorted,
+			 int by_class, const char *key, int *count)
+{
+  int low = 0;
+  int high = nsorted;
+  int end;
+
+  while (low < high)
+    {
+      int mid = low + (high - low) / 2;
+      const char *name = by_class ? sorted[mid]->class : sorted[mid]->selector;
+
+      if (strcmp (name, key) < 0)
+	low = mid + 1;
+      else
+	high = mid;
+    }
+
+  for (end = low; end < nsorted; end++)
+    if (strcmp (by_class ? sorted[end]->class : sorted[end]->selector,
+		key) != 0)
+      break;
+
+  *count = end - low;
+  return sorted + low;
+}
+/* APPLE LOCAL end objc method index  */
+
 /*
  * Function: compare_selectors (const void *, const void *)
  *
@@ -1509,19 +1757,22 @@ selectors_info (char *regexp, int from_tty)
     }
 
   /* First time thru is JUST to get max length and count.  */
-  ALL_MSYMBOLS (objfile, msymbol)
+  /* APPLE LOCAL begin objc method index  */
+  ALL_OBJFILES (objfile)
     {
-      QUIT;
-      name = SYMBOL_NATURAL_NAME (msymbol);
-      if (name &&
-	 (name[0] == '-' || name[0] == '+') &&
-	  name[1] == '[')		/* Got a method name.  */
+      struct objc_method_index *method_index = objc_method_index (objfile);
+
+      for (ix = 0; ix < method_index->nmethods; ix++)
 	{
+	  QUIT;
+	  name = method_index->methods[ix].name;
 	  /* Filter for class/instance methods.  */
 	  if (plusminus && name[0] != plusminus)
 	    continue;
 	  /* Find selector part.  */
 	  name = (char *) strchr(name+2, ' ');
+	  if (name == NULL)
+	    continue;
 	  if (regexp == NULL || re_exec(++name) != 0)
 	    { 
 	      char *mystart = name;
@@ -1540,23 +1791,27 @@ selectors_info (char *regexp, int from_tty)
 
       sym_arr = alloca (matches * sizeof (struct symbol *));
       matches = 0;
-      ALL_MSYMBOLS (objfile, msymbol)
+      ALL_OBJFILES (objfile)
 	{
-	  QUIT;
-	  name = SYMBOL_NATURAL_NAME (msymbol);
-	  if (name &&
-	     (name[0] == '-' || name[0] == '+') &&
-	      name[1] == '[')		/* Got a method name.  */
+	  struct objc_method_index *method_index = objc_method_index (objfile);
+
+	  for (ix = 0; ix < method_index->nmethods; ix++)
 	    {
+	      QUIT;
+	      msymbol = method_index->methods[ix].msymbol;
+	      name = method_index->methods[ix].name;
 	      /* Filter for class/instance methods.  */
 	      if (plusminus && name[0] != plusminus)
 		continue;
 	      /* Find selector part.  */
 	      name = (char *) strchr(name+2, ' ');
+	      if (name == NULL)
+		continue;
 	      if (regexp == NULL || re_exec(++name) != 0)
 		sym_arr[matches++] = (struct symbol *) msymbol;
 	    }
 	}
+      /* APPLE LOCAL end objc method index  */
 
       qsort (sym_arr, matches, sizeof (struct minimal_symbol *), 
 	     compare_selectors);
@@ -1649,23 +1904,26 @@ classes_info (char *regexp, int from_tty)
     }
 
   /* First time thru is JUST to get max length and count.  */
-  ALL_MSYMBOLS (objfile, msymbol)
+  /* APPLE LOCAL begin objc method index  */
+  ALL_OBJFILES (objfile)
     {
-      QUIT;
-      name = SYMBOL_NATURAL_NAME (msymbol);
-      if (name &&
-	 (name[0] == '-' || name[0] == '+') &&
-	  name[1] == '[')			/* Got a method name.  */
-	if (regexp == NULL || re_exec(name+2) != 0)
-	  { 
-	    /* Compute length of classname part.  */
-	    char *mystart = name + 2;
-	    char *myend   = (char *) strchr(mystart, ' ');
-	    
-	    if (myend && (myend - mystart > maxlen))
-	      maxlen = myend - mystart;
-	    matches++;
-	  }
+      struct objc_method_index *method_index = objc_method_index (objfile);
+
+      for (ix = 0; ix < method_index->nmethods; ix++)
+	{
+	  QUIT;
+	  name = method_index->methods[ix].name;
+	  if (regexp == NULL || re_exec(name+2) != 0)
+	    { 
+	      /* Compute length of classname part.  */
+	      char *mystart = name + 2;
+	      char *myend   = (char *) strchr(mystart, ' ');
+	      
+	      if (myend && (myend - mystart > maxlen))
+		maxlen = myend - mystart;
+	      matches++;
+	    }
+	}
     }
   if (matches)
     {
@@ -1673,16 +1931,20 @@ classes_info (char *regexp, int from_tty)
 		       regexp ? regexp : "*");
       sym_arr = alloca (matches * sizeof (struct symbol *));
       matches = 0;
-      ALL_MSYMBOLS (objfile, msymbol)
+      ALL_OBJFILES (objfile)
 	{
-	  QUIT;
-	  name = SYMBOL_NATURAL_NAME (msymbol);
-	  if (name &&
-	     (name[0] == '-' || name[0] == '+') &&
-	      name[1] == '[')			/* Got a method name.  */
-	    if (regexp == NULL || re_exec(name+2) != 0)
+	  struct objc_method_index *method_index = objc_method_index (objfile);
+
+	  for (ix = 0; ix < method_index->nmethods; ix++)
+	    {
+	      QUIT;
+	      msymbol = method_index->methods[ix].msymbol;
+	      name = method_index->methods[ix].name;
+	      if (regexp == NULL || re_exec(name+2) != 0)
 		sym_arr[matches++] = (struct symbol *) msymbol;
+	    }
 	}
+      /* APPLE LOCAL end objc method index  */
 
       qsort (sym_arr, matches, sizeof (struct minimal_symbol *), 
 	     compare_classes);
@@ -1924,139 +2186,141 @@ find_methods (struct symtab *symtab, char type,
   
   char *symname = NULL;
 
-  char ntype = '\0';
-  char *nclass = NULL;
-  char *ncategory = NULL;
-  char *nselector = NULL;
-  char *name_end = NULL;
-
   unsigned int csym = 0;
   unsigned int cdebug = 0;
 
-  static char *tmp = NULL;
-  static unsigned int tmplen = 0;
-
   gdb_assert (nsym != NULL);
   gdb_assert (ndebug != NULL);
 
   if (symtab)
     block = BLOCKVECTOR_BLOCK (BLOCKVECTOR (symtab), STATIC_BLOCK);
 
-  ALL_MSYMBOLS (objfile, msymbol)
+  /* APPLE LOCAL begin objc method index  */
+  ALL_OBJFILES (objfile)
     {
-      QUIT;
+      struct objc_method_index *method_index = objc_method_index (objfile);
+      struct objc_method_entry **range = NULL;
+      int nentries = method_index->nmethods;
+      int ix;
+
+      /* Only look at the methods of the class or selector asked for, if
+	 we can.  */
+      if (class != NULL)
+	range = objc_method_index_range (method_index->by_class, method_index->nsorted,
+					 1, class, &nentries);
+      else if (selector != NULL)
+	range = objc_method_index_range (method_index->by_selector, method_index->nsorted,
+					 0, selector, &nentries);
+
+      for (ix = 0; ix < nentries; ix++)
+	{
+	  struct objc_method_entry *entry;
 
-      /* APPLE LOCAL fix-and-continue */
-      if (MSYMBOL_OBSOLETED (msymbol))
-        continue;
+	  entry = (range != NULL) ? range[ix] : &method_index->methods[ix];
+	  msymbol = entry->msymbol;
+	  /* APPLE LOCAL end objc method index  */
 
-      if ((msymbol->type != mst_text) && (msymbol->type != mst_file_text))
-	/* Not a function or method.  */
-	continue;
+	  QUIT;
 
-      if (symtab)
-	/* APPLE LOCAL begin address ranges  */
-	if (!block_contains_pc (block, SYMBOL_VALUE_ADDRESS (msymbol)))
-       /* APPLE LOCAL end address ranges  */
-	  /* Not in the specified symtab.  */
-	  continue;
+	  /* APPLE LOCAL fix-and-continue */
+	  if (MSYMBOL_OBSOLETED (msymbol))
+	    continue;
 
-      symname = SYMBOL_NATURAL_NAME (msymbol);
-      if (symname == NULL)
-	continue;
+	  if ((msymbol->type != mst_text) && (msymbol->type != mst_file_text))
+	    /* Not a function or method.  */
+	    continue;
 
-      if ((symname[0] != '-' && symname[0] != '+') || (symname[1] != '['))
-	/* Not a method name.  */
-	continue;
-      
-      while ((strlen (symname) + 1) >= tmplen)
-	{
-	  tmplen = (tmplen == 0) ? 1024 : tmplen * 2;
-	  tmp = xrealloc (tmp, tmplen);
-	}
-      strcpy (tmp, symname);
+	  if (symtab)
+	    /* APPLE LOCAL begin address ranges  */
+	    if (!block_contains_pc (block, SYMBOL_VALUE_ADDRESS (msymbol)))
+	   /* APPLE LOCAL end address ranges  */
+	      /* Not in the specified symtab.  */
+	      continue;
 
-      name_end = parse_method (tmp, &ntype, &nclass, &ncategory, &nselector);
+	  /* APPLE LOCAL begin objc method index  */
+	  symname = entry->name;
 
-      /* Only accept the symbol if the WHOLE name is an ObjC method name.
-	 If you compile an objc file with -fexceptions, then you will end up
-	 with [Class message].eh symbols for all the real ObjC symbols, and
-	 we don't want to match those.  */
+	  /* Only accept the symbol if the WHOLE name is an ObjC method name.
+	     If you compile an objc file with -fexceptions, then you will end up
+	     with [Class message].eh symbols for all the real ObjC symbols, and
+	     we don't want to match those.  The index leaves the class of
+	     those NULL.  */
 
-      if (name_end == NULL || *name_end != '\0')
-	continue;
+	  if (entry->class == NULL)
+	    continue;
       
-      if ((type != '\0') && (ntype != type))
-	continue;
+	  if ((type != '\0') && (entry->type != type))
+	    continue;
 
-      if ((class != NULL) 
-	  && ((nclass == NULL) || (strcmp (class, nclass) != 0)))
-	continue;
+	  if ((class != NULL) && (strcmp (class, entry->class) != 0))
+	    continue;
 
-      if ((category != NULL) && 
-	  ((ncategory == NULL) || (strcmp (category, ncategory) != 0)))
-	continue;
+	  if ((category != NULL) && 
+	      ((entry->category == NULL)
+	       || (strcmp (category, entry->category) != 0)))
+	    continue;
 
-      if ((selector != NULL) && 
-	  ((nselector == NULL) || (strcmp (selector, nselector) != 0)))
-	continue;
+	  if ((selector != NULL) && (strcmp (selector, entry->selector) != 0))
+	    continue;
+	  /* APPLE LOCAL end objc method index  */
 
-      /* APPLE LOCAL: Restrict the scope of the search when calling
-	 find_pc_sect_function() to the current objfile that we
-	 already have else we will get a recursive call that can
-	 modify the restrict list and can cause an infinite loop.  */
-      /* Set this to null to start, don't want it to carry over from
-	 the last time through the loop.  */
-      sym = NULL;
+	  /* APPLE LOCAL: Restrict the scope of the search when calling
+	     find_pc_sect_function() to the current objfile that we
+	     already have else we will get a recursive call that can
+	     modify the restrict list and can cause an infinite loop.  */
+	  /* Set this to null to start, don't want it to carry over from
+	     the last time through the loop.  */
+	  sym = NULL;
 
-      if (objfile->separate_debug_objfile)
-        {
-	  old_list = 
-             make_cleanup_restrict_to_objfile (objfile->separate_debug_objfile);
-	  sym = find_pc_sect_function (SYMBOL_VALUE_ADDRESS (msymbol), 
-                                       SYMBOL_BFD_SECTION (msymbol));
-	  do_cleanups (old_list);
-        }
-      if (sym == NULL)
-        {
-	  old_list = make_cleanup_restrict_to_objfile (objfile);
-	  sym = find_pc_sect_function (SYMBOL_VALUE_ADDRESS (msymbol), 
-                                       SYMBOL_BFD_SECTION (msymbol));
-	  do_cleanups (old_list);
-        }
+	  if (objfile->separate_debug_objfile)
+	    {
+	      old_list = 
+		 make_cleanup_restrict_to_objfile (objfile->separate_debug_objfile);
+	      sym = find_pc_sect_function (SYMBOL_VALUE_ADDRESS (msymbol), 
+					   SYMBOL_BFD_SECTION (msymbol));
+	      do_cleanups (old_list);
+	    }
+	  if (sym == NULL)
+	    {
+	      old_list = make_cleanup_restrict_to_objfile (objfile);
+	      sym = find_pc_sect_function (SYMBOL_VALUE_ADDRESS (msymbol), 
+					   SYMBOL_BFD_SECTION (msymbol));
+	      do_cleanups (old_list);
+	    }
       
-      if (sym != NULL)
-        {
-          const char *newsymname = SYMBOL_NATURAL_NAME (sym);
+	  if (sym != NULL)
+	    {
+	      const char *newsymname = SYMBOL_NATURAL_NAME (sym);
 	  
-          if (strcmp (symname, newsymname) == 0)
-            {
-              /* Found a high-level method sym: swap it into the
-                 lower part of sym_arr (below num_debuggable).  */
-              if (syms != NULL)
-                {
-                  syms[csym] = syms[cdebug];
-                  syms[cdebug] = sym;
-                }
-              csym++;
-              cdebug++;
-            }
-          else
-            {
-              warning (
+	      if (strcmp (symname, newsymname) == 0)
+		{
+		  /* Found a high-level method sym: swap it into the
+		     lower part of sym_arr (below num_debuggable).  */
+		  if (syms != NULL)
+		    {
+		      syms[csym] = syms[cdebug];
+		      syms[cdebug] = sym;
+		    }
+		  csym++;
+		  cdebug++;
+		}
+	      else
+		{
+		  warning (
 "debugging symbol \"%s\" does not match minimal symbol (\"%s\"); ignoring",
-                       newsymname, symname);
-              if (syms != NULL)
-                syms[csym] = (struct symbol *) msymbol;
-              csym++;
-            }
-        }
-      else 
-	{
-	  /* Found a non-debuggable method symbol.  */
-	  if (syms != NULL)
-	    syms[csym] = (struct symbol *) msymbol;
-	  csym++;
+			   newsymname, symname);
+		  if (syms != NULL)
+		    syms[csym] = (struct symbol *) msymbol;
+		  csym++;
+		}
+	    }
+	  else 
+	    {
+	      /* Found a non-debuggable method symbol.  */
+	      if (syms != NULL)
+		syms[csym] = (struct symbol *) msymbol;
+	      csym++;
+	    }
 	}
     }
 
@@ -3043,9 +3307,15 @@ static void
 read_objc_method (CORE_ADDR addr, struct objc_method *method)
 {
   int addrsize = TARGET_ADDRESS_BYTES;
-  method->name  = read_memory_unsigned_integer (addr + 0, addrsize);
-  method->types = read_memory_unsigned_integer (addr + addrsize, addrsize);
-  method->imp   = read_memory_unsigned_integer (addr + addrsize * 2, addrsize);
+  /* APPLE LOCAL begin bulk objc metadata  */
+  gdb_byte buf[3 * 8];
+
+  gdb_assert (addrsize <= 8);
+  read_memory (addr, buf, 3 * addrsize);
+  method->name  = extract_unsigned_integer (buf, addrsize);
+  method->types = extract_unsigned_integer (buf + addrsize, addrsize);
+  method->imp   = extract_unsigned_integer (buf + addrsize * 2, addrsize);
+  /* APPLE LOCAL end bulk objc metadata  */
 }
 
 static unsigned long 
@@ -3071,6 +3341,58 @@ read_objc_method_list_method (CORE_ADDR addr, unsigned long num,
   gdb_assert (num < read_objc_method_list_nmethods (addr));
   read_objc_method (addr + offset + (3 * addrsize * num), method);
 }
+
+/* APPLE LOCAL begin bulk objc metadata  */
+/* Read the whole method list at MLIST, but no more than LIMIT of its
+   methods, with one read for the count and one for the methods.  Set
+   *NMETHODS to the number read, and return them in an xmalloc'd
+   array, or NULL if there are none.  */
+
+static struct objc_method *
+read_objc_method_list (CORE_ADDR mlist, unsigned long limit,
+		       unsigned long *nmethods)
+{
+  int addrsize = TARGET_ADDRESS_BYTES;
+  int entry_size = 3 * addrsize;
+  struct objc_method *methods;
+  struct cleanup *old_chain;
+  gdb_byte *buf;
+  unsigned long count;
+  unsigned long i;
+  int offset;
+
+  count = read_objc_method_list_nmethods (mlist);
+  if (count > limit)
+    count = limit;
+  *nmethods = count;
+  if (count == 0)
+    return NULL;
+
+  /* 64-bit objc runtime has an extra field in here.  */
+  if (addrsize == 8)
+    offset = addrsize + 4 + 4;
+  else
+    offset = addrsize + 4;
+
+  buf = xmalloc (count * entry_size);
+  old_chain = make_cleanup (xfree, buf);
+  read_memory (mlist + offset, buf, count * entry_size);
+
+  methods = xmalloc (count * sizeof (struct objc_method));
+  for (i = 0; i < count; i++)
+    {
+      gdb_byte *entry = buf + i * entry_size;
+
+      methods[i].name = extract_unsigned_integer (entry, addrsize);
+      methods[i].types = extract_unsigned_integer (entry + addrsize,
+						   addrsize);
+      methods[i].imp = extract_unsigned_integer (entry + addrsize * 2,
+						 addrsize);
+    }
+  do_cleanups (old_chain);
+  return methods;
+}
+/* APPLE LOCAL end bulk objc metadata  */
   
 static void 
 read_objc_object (CORE_ADDR addr, struct objc_object *object)
@@ -3265,18 +3587,25 @@ static void
 read_objc_class (CORE_ADDR addr, struct objc_class *class)
 {
   int addrsize = TARGET_ADDRESS_BYTES;
-  class->isa = read_memory_unsigned_integer (addr, addrsize);
-  class->super_class = read_memory_unsigned_integer (addr + addrsize, addrsize);
-  class->name = read_memory_unsigned_integer (addr + addrsize * 2, addrsize);
-  class->version = read_memory_unsigned_integer (addr + addrsize * 3, addrsize);
-  class->info = read_memory_unsigned_integer (addr + addrsize * 4, addrsize); 
-  class->instance_size = read_memory_unsigned_integer 
-                                               (addr + addrsize * 5, addrsize);
-  class->ivars = read_memory_unsigned_integer (addr + addrsize * 6, addrsize);
-  class->methods = read_memory_unsigned_integer (addr + addrsize * 7, addrsize);
-  class->cache = read_memory_unsigned_integer (addr + addrsize * 8, addrsize);
-  class->protocols = read_memory_unsigned_integer 
-                                                (addr + addrsize * 9, addrsize);
+  /* APPLE LOCAL begin bulk objc metadata  */
+  /* Fetch the whole structure with one read; over a remote connection
+     each of the ten fields used to cost a round trip.  */
+  gdb_byte buf[10 * 8];
+
+  gdb_assert (addrsize <= 8);
+  read_memory (addr, buf, 10 * addrsize);
+  class->isa = extract_unsigned_integer (buf, addrsize);
+  class->super_class = extract_unsigned_integer (buf + addrsize, addrsize);
+  class->name = extract_unsigned_integer (buf + addrsize * 2, addrsize);
+  class->version = extract_unsigned_integer (buf + addrsize * 3, addrsize);
+  class->info = extract_unsigned_integer (buf + addrsize * 4, addrsize);
+  class->instance_size = extract_unsigned_integer (buf + addrsize * 5,
+						   addrsize);
+  class->ivars = extract_unsigned_integer (buf + addrsize * 6, addrsize);
+  class->methods = extract_unsigned_integer (buf + addrsize * 7, addrsize);
+  class->cache = extract_unsigned_integer (buf + addrsize * 8, addrsize);
+  class->protocols = extract_unsigned_integer (buf + addrsize * 9, addrsize);
+  /* APPLE LOCAL end bulk objc metadata  */
 }
 
 /* When the ObjC garbage collection has a selector we should ignore
@@ -3316,14 +3645,23 @@ reinitialize_objc ()
   cached_objc_objfile = NULL;
 }
 
-void
-objc_clear_caches ()
+/* APPLE LOCAL begin objc cache invalidation  */
+static void
+objc_clear_implementation_cache (void)
 {
   if (implementation_tree != NULL)
     {
       free_rb_tree_data (implementation_tree, xfree);
       implementation_tree = NULL;
     }
+}
+/* APPLE LOCAL end objc cache invalidation  */
+
+void
+objc_clear_caches ()
+{
+  /* APPLE LOCAL objc cache invalidation  */
+  objc_clear_implementation_cache ();
   if (classname_tree != NULL)
     {
       free_rb_tree_data (classname_tree, xfree);
@@ -3336,6 +3674,86 @@ objc_clear_caches ()
     }
 }
 
+/* APPLE LOCAL begin objc cache invalidation  */
+/* The caches above describe the classes of the images loaded when
+   they were filled in.  Each objfile objc_note_libraries_changed has
+   looked at is tagged with one of these markers, so it can tell which
+   images are new and whether they contain Objective-C.  */
+
+static const struct objfile_data *objc_cache_objfile_data;
+static int objc_cache_image_with_objc;
+static int objc_cache_image_without_objc;
+
+/* Set when an image containing Objective-C goes away; the class
+   addresses we have cached may then name nothing, or something
+   else.  */
+static int objc_cache_image_unloaded;
+
+static void
+objc_cache_objfile_freed (struct objfile *objfile, void *data)
+{
+  if (data == &objc_cache_image_with_objc)
+    objc_cache_image_unloaded = 1;
+}
+
+static int
+objc_cache_objfile_has_objc (struct objfile *objfile)
+{
+  if (objfile->obfd == NULL)
+    return 0;
+  return (bfd_get_section_by_name (objfile->obfd, "LC_SEGMENT.__OBJC") != NULL
+	  || bfd_get_section_by_name (objfile->obfd,
+				      "LC_SEGMENT.__DATA.__objc_imageinfo")
+	     != NULL);
+}
+
+/* Called after the dynamic linker has added or removed images.
+   Loading an image without Objective-C in it can't change how any
+   message is dispatched, so the caches survive that.  An image with
+   Objective-C may bring categories or swizzle methods from its +load
+   methods, so the implementation cache has to go, but the names and
+   real classes we know of stay the same.  Only unloading such an
+   image throws everything away.  */
+
+void
+objc_note_libraries_changed (void)
+{
+  struct objfile *objfile;
+  int new_objc = 0;
+
+  ALL_OBJFILES (objfile)
+    {
+      if (objfile_data (objfile, objc_cache_objfile_data) != NULL)
+	continue;
+      if (objc_cache_objfile_has_objc (objfile))
+	{
+	  set_objfile_data (objfile, objc_cache_objfile_data,
+			    &objc_cache_image_with_objc);
+	  new_objc = 1;
+	}
+      else
+	set_objfile_data (objfile, objc_cache_objfile_data,
+			  &objc_cache_image_without_objc);
+    }
+
+  if (objc_cache_image_unloaded)
+    {
+      if (debug_objc)
+	fprintf_unfiltered (gdb_stdlog,
+			    "Objective-C image unloaded, clearing caches.\n");
+      objc_clear_caches ();
+      objc_cache_image_unloaded = 0;
+    }
+  else if (new_objc)
+    {
+      if (debug_objc)
+	fprintf_unfiltered (gdb_stdlog, "Objective-C image loaded, "
+			    "clearing the implementation cache.\n");
+      objc_clear_implementation_cache ();
+    }
+}
+/* APPLE LOCAL end objc cache invalidation  */
+
 /* APPLE LOCAL: We keep a cache of the (class,selector)->implementation lookups
    that we do.  These are actually fairly expensive, and for inspecting ObjC
    objects, we tend to do the same ones over & over.  */
@@ -3369,6 +3787,29 @@ add_implementation_to_cache (CORE_ADDR class, CORE_ADDR sel, CORE_ADDR implement
   rb_tree_insert (&implementation_tree, implementation_tree, new_node);
 }
 
+/* APPLE LOCAL begin bulk objc metadata  */
+/* Having read the NMETHODS METHODS of one of CLASS's method lists (or
+   one of its superclasses'), remember what each of their selectors
+   resolves to for CLASS, unless an earlier list already answered that.
+   Lists must be passed in the order the runtime searches them.  */
+
+static void
+cache_objc_method_list (CORE_ADDR class, struct objc_method *methods,
+			unsigned long nmethods)
+{
+  unsigned long i;
+
+  for (i = 0; i < nmethods; i++)
+    {
+      if (methods[i].name == 0 || methods[i].name == GC_IGNORED_SELECTOR_LE
+	  || methods[i].imp == 0)
+	continue;
+      if (lookup_implementation_in_cache (class, methods[i].name) == 0)
+	add_implementation_to_cache (class, methods[i].name, methods[i].imp);
+    }
+}
+/* APPLE LOCAL end bulk objc metadata  */
+
 static CORE_ADDR
 find_implementation_from_class (CORE_ADDR class, CORE_ADDR sel)
 {
@@ -3509,6 +3950,10 @@ find_implementation_from_class (CORE_ADDR class, CORE_ADDR sel)
 	  CORE_ADDR mlist;
 	  unsigned long nmethods;
 	  unsigned long i;
+	  /* APPLE LOCAL begin bulk objc metadata  */
+	  struct objc_method *methods;
+	  struct cleanup *methods_cleanup;
+	  /* APPLE LOCAL end bulk objc metadata  */
 	  npasses++;
 
 	  /* As an optimization, if the ObjC runtime can tell that 
@@ -3543,7 +3988,13 @@ find_implementation_from_class (CORE_ADDR class, CORE_ADDR sel)
 		break;
 	    }
 
-	  nmethods = read_objc_method_list_nmethods (mlist);
+	  /* APPLE LOCAL begin bulk objc metadata  */
+	  methods = read_objc_method_list (mlist,
+					   objc_class_method_limit
+					   - total_methods,
+					   &nmethods);
+	  methods_cleanup = make_cleanup (xfree, methods);
+	  /* APPLE LOCAL end bulk objc metadata  */
 
 	  for (i = 0; i < nmethods; i++) 
 	    {
@@ -3560,10 +4011,13 @@ find_implementation_from_class (CORE_ADDR class, CORE_ADDR sel)
 			     " really has this many methods.",
 			     total_methods);
 		  only_warn_once++;
+		  /* APPLE LOCAL bulk objc metadata  */
+		  do_cleanups (methods_cleanup);
 		  return 0;
 		}
 
-	      read_objc_method_list_method (mlist, i, &meth_str);
+	      /* APPLE LOCAL bulk objc metadata  */
+	      meth_str = methods[i];
 
               /* The GC_IGNORED_SELECTOR_LE  bit pattern indicates
                  that the selector is the ObjC GC's way of telling
@@ -3596,9 +4050,24 @@ find_implementation_from_class (CORE_ADDR class, CORE_ADDR sel)
 		   here. There needs to be a better way to do that.  */
 		{
 		  add_implementation_to_cache (class, sel, meth_str.imp);
+		  /* APPLE LOCAL begin bulk objc metadata  */
+		  /* The rest of the list is read already; keep what it
+		     says about other selectors too.  */
+		  if (class_initialized)
+		    cache_objc_method_list (class, methods, nmethods);
+		  do_cleanups (methods_cleanup);
+		  /* APPLE LOCAL end bulk objc metadata  */
 		  return meth_str.imp;
 		}
 	    }
+	  /* APPLE LOCAL begin bulk objc metadata  */
+	  /* Selectors are only uniqued once the class is initialized, so
+	     until then the names in the list mean nothing to the
+	     cache.  */
+	  if (class_initialized)
+	    cache_objc_method_list (class, methods, nmethods);
+	  do_cleanups (methods_cleanup);
+	  /* APPLE LOCAL end bulk objc metadata  */
 	  mlistnum++;
 	}
       subclass = class_str.super_class;
@@ -5374,6 +5843,53 @@ get_class_address_from_object (CORE_ADDR object_addr)
 }
 /* APPLE LOCAL end use '[object class]' rather than isa  */
 
+/* APPLE LOCAL begin inferior helper  */
+/* If finding the class of the object at OBJECT_ADDR would mean
+   calling into the inferior, return the object's isa so the caller
+   can look the class up some cheaper way and hand it to
+   objc_remember_object_class.  Otherwise return 0.  */
+
+CORE_ADDR
+objc_object_isa_needing_lookup (CORE_ADDR object_addr)
+{
+  struct objc_object orig_object;
+  CORE_ADDR real_class;
+
+  if (!new_objc_runtime_internals () || !target_has_execution)
+    return 0;
+
+  read_objc_object (object_addr, &orig_object);
+  if (orig_object.isa == 0)
+    return 0;
+
+  real_class = lookup_real_class_in_cache (orig_object.isa);
+  if (real_class != 0 && lookup_classname_in_cache (real_class) != NULL)
+    return 0;
+
+  return orig_object.isa;
+}
+
+/* Record that objects whose isa is ISA belong to REAL_CLASS, named
+   CLASS_NAME, as if get_class_address_from_object and
+   new_objc_runtime_get_classname had found that out themselves.
+   CLASS_NAME may be NULL if it isn't known.  */
+
+void
+objc_remember_object_class (CORE_ADDR isa, CORE_ADDR real_class,
+			    const char *class_name)
+{
+  if (isa == 0 || real_class == 0)
+    return;
+
+  if (lookup_real_class_in_cache (isa) == 0)
+    add_real_class_to_cache (isa, real_class);
+
+  if (class_name != NULL && *class_name != '\0'
+      && lookup_classname_in_cache (real_class) == NULL)
+    add_classname_to_cache (real_class, (char *) class_name);
+}
+/* APPLE LOCAL end inferior helper  */
+
 /* APPLE LOCAL begin Disable breakpoints while updating data formatters.  */
 /* Return an integer-boolean indicating whether or not the
    breakpoint passed in is the special breakpoint gdb sets in
@@ -5409,6 +5925,12 @@ set_non_blocking_mode_func (char *args, int from_tty,
 void
 _initialize_objc_lang ()
 {
+  /* APPLE LOCAL objc cache invalidation  */
+  objc_cache_objfile_data
+    = register_objfile_data_with_cleanup (objc_cache_objfile_freed);
+  /* APPLE LOCAL objc method index  */
+  objc_method_index_objfile_data = register_objfile_data ();
+
   add_setshow_boolean_cmd ("po-and-print-run-all-threads", no_class, &po_and_print_run_all_threads, 
 			   "Set whether to override the check for potentially unsafe"
 			   " situations before calling print-object.",
@@ -42,6 +42,9 @@ void tell_objc_msgsend_cacher_objfile_changed (struct objfile *);
 
 void objc_clear_caches ();
 
+/* APPLE LOCAL objc cache invalidation  */
+void objc_note_libraries_changed (void);
+
 CORE_ADDR find_implementation (CORE_ADDR object, CORE_ADDR sel, int stret);
 
 extern char *parse_selector (char *method, char **selector);
@@ -62,6 +65,12 @@ extern struct type *objc_target_type_from_object (CORE_ADDR isa_addr,
 						  char **class_name);
 
 extern struct type *value_objc_target_type (struct value *, struct block *, char **);
+
+/* APPLE LOCAL begin inferior helper  */
+extern CORE_ADDR objc_object_isa_needing_lookup (CORE_ADDR object_addr);
+extern void objc_remember_object_class (CORE_ADDR isa, CORE_ADDR real_class,
+					const char *class_name);
+/* APPLE LOCAL end inferior helper  */
 int should_lookup_objc_class ();
 
 /* for parsing Objective C */
@@ -47,6 +47,8 @@
 #include "breakpoint.h"
 #include "block.h"
 #include "dictionary.h"
+/* APPLE LOCAL C++ lookup caches  */
+#include "cp-support.h"
 #include "objc-lang.h"
 #include "macosx-nat-inferior.h"  // need to pick up macho_calculate_offsets_for_dsym() in machoread.c
 
@@ -106,7 +108,7 @@ struct objfile *rt_common_objfile;	/* For runtime common symbols */
 /* APPLE LOCAL - with the advent of ZeroLink, it is not uncommon for Mac OS X 
    applications to consist of 500+ shared libraries.  At that point searching
    linearly for address->obj_section becomes very costly, and it is a common
-   operation.  So we maintain an ordered array of obj_sections, and use that
+   operation.  So we maintain an ordered table of obj_sections, and use that
    to do a binary search for the matching section. 
 
    N.B. We could just use an array of pointers to the obj_section
@@ -115,6 +117,20 @@ struct objfile *rt_common_objfile;	/* For runtime common symbols */
    can do the search only touching a couple of pages of memory, rather
    than wandering all over the heap.  
 
+   The table is kept in blocks of at most ORDERED_SECTIONS_BLOCK_SIZE
+   entries, sorted by start address within each block and from one
+   block to the next.  Adding or removing a section only shifts the
+   entries of its own block, and splits or drops that block if it has
+   filled up or emptied, so loading and unloading a library doesn't
+   move the whole table around.
+
+   Sections may overlap - before the program runs many of them are
+   still at 0 - so each entry also records the highest end address of
+   it and the entries before it in its block, and each block the
+   highest end address of it and every block before it.  A lookup
+   walks back from the last section starting at or below the pc only
+   while one of those says some earlier section still reaches it.
+
    FIXME: We really should merge this array with the to_sections array in
    the target, but that doesn't have back-pointers to the obj_section.  I
    am not sure how hard it would be to get that working.  This is simpler 
@@ -126,34 +142,51 @@ struct ordered_obj_section
   struct bfd_section *the_bfd_section;
   CORE_ADDR addr;
   CORE_ADDR endaddr;
+
+  /* The highest ENDADDR of this entry and the ones before it in its
+     block.  */
+  CORE_ADDR reach;
 };
 
-/* This is the table of ordered_sections.  It is malloc'ed to
-   ORDERED_SECTIONS_CHUNK_SIZE originally, and then realloc'ed if we
-   get more sections. */
+#define ORDERED_SECTIONS_BLOCK_SIZE 128
 
-static struct ordered_obj_section *ordered_sections;
+struct ordered_sections_block
+{
+  int count;
+  struct ordered_obj_section entries[ORDERED_SECTIONS_BLOCK_SIZE];
+};
 
-/* This is the number of entries currently in the ordered_sections table.  */
-static int num_ordered_sections = 0;
+/* What the lookup needs to know about each block, kept in one array
+   so that choosing a block only touches that array.  */
 
-#define ORDERED_SECTIONS_CHUNK_SIZE 3000
+struct ordered_sections_block_info
+{
+  /* The start address of the block's first entry.  */
+  CORE_ADDR addr;
 
-static int max_num_ordered_sections = ORDERED_SECTIONS_CHUNK_SIZE;
+  /* The highest end address of any entry in this block or an earlier
+     one.  */
+  CORE_ADDR reach;
 
-static int find_in_ordered_sections_index (CORE_ADDR addr, struct bfd_section *bfd_section);
-static int get_insert_index_in_ordered_sections (struct obj_section *section);
+  struct ordered_sections_block *block;
+};
 
-/* When we want to add a bunch of obj_sections at a time, we will
-   find all the insert points, make an array of type OJB_SECTION_WITH_INDEX
-   sort that in reverse order, then sweep the ordered_sections list
-   shifting and adding them all.  */
+/* This is the table of ordered_sections.  The blocks are malloc'ed
+   one at a time, and the array describing them is realloc'ed as
+   blocks are added.  */
 
-struct obj_section_with_index
-{
-  int index;
-  struct obj_section *section;
-};
+static struct ordered_sections_block_info *ordered_blocks;
+static int num_ordered_blocks = 0;
+static int max_num_ordered_blocks = 0;
+
+/* This is the number of entries currently in the ordered_sections table.  */
+static int num_ordered_sections = 0;
+
+/* APPLE LOCAL deferred psymbol relocation  */
+static int deferred_psymbol_relocation = 1;
+
+/* APPLE LOCAL debug info on demand  */
+static int debug_info_on_demand = 1;
 
 #if 0 /* APPLE LOCAL unused */
 /* Called via bfd_map_over_sections to build up the section table that
@@ -383,6 +416,40 @@ create_objfile (bfd *abfd)
 
 }
 
+/* APPLE LOCAL begin objfile memory  */
+/* The size of the chunks an objfile's obstack grows by.  Reading
+   symbols puts a great many small objects on it, and with the
+   default chunk size of about 4K that is a malloc (and later a free)
+   for every hundred or so of them.  Chunks this big come straight
+   from the VM system and go back to it, whole, when the objfile's
+   obstack is freed.  Zero means use the obstack default.  */
+
+static int objfile_obstack_chunk_size = 256 * 1024;
+
+static void
+show_objfile_obstack_chunk_size (struct ui_file *file, int from_tty,
+				 struct cmd_list_element *c,
+				 const char *value)
+{
+  fprintf_filtered (file, _("\
+The chunk size for objfile obstacks is %s bytes.\n"),
+		    value);
+}
+
+/* Initialize OBJFILE's objfile_obstack so that it is empty.  */
+
+void
+objfile_obstack_init (struct objfile *objfile)
+{
+  int size = objfile_obstack_chunk_size;
+
+  if (size < 0)
+    size = 0;
+  obstack_specify_allocation (&objfile->objfile_obstack, size, 0,
+			      xmalloc, xfree);
+}
+/* APPLE LOCAL end objfile memory  */
+
 struct objfile *
 create_objfile_using_objfile (struct objfile *objfile, bfd *abfd)
 {
@@ -391,8 +458,8 @@ create_objfile_using_objfile (struct objfile *objfile, bfd *abfd)
   objfile->macro_cache = bcache_xmalloc (NULL);
   bcache_specify_allocation (objfile->psymbol_cache, xmalloc, xfree);
   bcache_specify_allocation (objfile->macro_cache, xmalloc, xfree);
-  obstack_specify_allocation (&objfile->objfile_obstack, 0, 0, xmalloc,
-                              xfree);
+  /* APPLE LOCAL objfile memory  */
+  objfile_obstack_init (objfile);
 
   /* FIXME: This needs to be converted to use objfile-specific data. */
   objfile_alloc_data (objfile);
@@ -412,59 +479,262 @@ create_objfile_using_objfile (struct objfile *objfile, bfd *abfd)
   return objfile;
 }
 
-/* This is the quicksort compare routine for OBJ_SECTION_WITH_INDEX
-   objects.  It sorts by section start address in decreasing 
-   order.  */
+/* Return nonzero if obj_section S belongs in the ordered_sections
+   table.  */
 
 static int
-backward_section_compare (const void *left_ptr, 
-		 const void *right_ptr)
+ordered_section_wanted (struct obj_section *s)
 {
-  
-  struct obj_section_with_index *left 
-    = (struct obj_section_with_index *) left_ptr;
-  struct obj_section_with_index * right 
-    = (struct obj_section_with_index *) right_ptr;
+  /* APPLE LOCAL: Oh, hacky, hacky...  The bfd Mach-O reader makes
+     bfd_sections for both the sections & segments (the container of
+     the sections).  This would make pc->bfd_section lookup non-unique.
+     so we just drop the segments from our list.  */
+  if (s->the_bfd_section && s->the_bfd_section->segment_mark == 1)
+    return 0;
+  return 1;
+}
 
-  if (left->section->addr > right->section->addr)
-    return -1;
-  else if (left->section->addr < right->section->addr)
-    return 1;
-  else
-      return 0;
+/* Recompute the REACH of the entries of BLOCK from entry FROM on.  */
+
+static void
+ordered_block_update_reach (struct ordered_sections_block *block, int from)
+{
+  int i;
+
+  for (i = from; i < block->count; i++)
+    {
+      CORE_ADDR reach = block->entries[i].endaddr;
+
+      if (i > 0 && block->entries[i - 1].reach > reach)
+	reach = block->entries[i - 1].reach;
+      block->entries[i].reach = reach;
+    }
 }
 
-/* Simple integer compare for quicksort */
+/* Recompute the ADDR and REACH of every block.  */
+
+static void
+ordered_blocks_update_info (void)
+{
+  int b;
+
+  for (b = 0; b < num_ordered_blocks; b++)
+    {
+      struct ordered_sections_block *block = ordered_blocks[b].block;
+      CORE_ADDR reach = block->entries[block->count - 1].reach;
+
+      if (b > 0 && ordered_blocks[b - 1].reach > reach)
+	reach = ordered_blocks[b - 1].reach;
+      ordered_blocks[b].addr = block->entries[0].addr;
+      ordered_blocks[b].reach = reach;
+    }
+}
+
+/* Return the index of the last block whose first entry starts at or
+   below ADDR, or -1 if there is none.  */
 
 static int
-forward_int_compare (const void *left_ptr, 
-		 const void *right_ptr)
+ordered_block_for_addr (CORE_ADDR addr)
 {
-  int *left = (int *) left_ptr;
-  int *right = (int *) right_ptr;
+  int bot = 0;
+  int top = num_ordered_blocks;
 
-  if (*left < *right)
-    return -1;
-  else if (*left > *right)
-    return 1;
-  else
-      return 0;
+  while (bot < top)
+    {
+      int mid = bot + (top - bot) / 2;
+
+      if (ordered_blocks[mid].addr <= addr)
+	bot = mid + 1;
+      else
+	top = mid;
+    }
+  return bot - 1;
+}
+
+/* Return the number of entries of BLOCK that start at or below ADDR
+   (if UPPER) or strictly below it (if not).  */
+
+static int
+ordered_block_bound (struct ordered_sections_block *block, CORE_ADDR addr,
+		     int upper)
+{
+  int bot = 0;
+  int top = block->count;
+
+  while (bot < top)
+    {
+      int mid = bot + (top - bot) / 2;
+
+      if (block->entries[mid].addr < addr
+	  || (upper && block->entries[mid].addr == addr))
+	bot = mid + 1;
+      else
+	top = mid;
+    }
+  return bot;
+}
+
+/* Make room for another block at index B, and return it.  */
+
+static struct ordered_sections_block *
+ordered_blocks_insert_block (int b)
+{
+  struct ordered_sections_block *block;
+
+  if (num_ordered_blocks == max_num_ordered_blocks)
+    {
+      max_num_ordered_blocks = (max_num_ordered_blocks == 0
+				? 16 : max_num_ordered_blocks * 2);
+      ordered_blocks = (struct ordered_sections_block_info *)
+	xrealloc (ordered_blocks, max_num_ordered_blocks
+		  * sizeof (struct ordered_sections_block_info));
+    }
+  memmove (&ordered_blocks[b + 1], &ordered_blocks[b],
+	   (num_ordered_blocks - b)
+	   * sizeof (struct ordered_sections_block_info));
+  num_ordered_blocks++;
+
+  block = (struct ordered_sections_block *)
+    xmalloc (sizeof (struct ordered_sections_block));
+  block->count = 0;
+  ordered_blocks[b].block = block;
+  return block;
+}
+
+/* Put obj_section S into the table, after any entries with the same
+   start address.  This keeps the blocks' start addresses right, but
+   the caller has to recompute their reach.  */
+
+static void
+ordered_sections_insert (struct obj_section *s)
+{
+  struct ordered_sections_block *block;
+  struct ordered_obj_section *entry;
+  int b, pos;
+
+  b = ordered_block_for_addr (s->addr);
+  if (b < 0)
+    b = 0;
+  if (num_ordered_blocks == 0)
+    ordered_blocks_insert_block (0);
+
+  block = ordered_blocks[b].block;
+  pos = ordered_block_bound (block, s->addr, 1);
+
+  if (block->count == ORDERED_SECTIONS_BLOCK_SIZE)
+    {
+      struct ordered_sections_block *next;
+      int half = ORDERED_SECTIONS_BLOCK_SIZE / 2;
+
+      next = ordered_blocks_insert_block (b + 1);
+      memcpy (next->entries, &block->entries[half],
+	      (block->count - half) * sizeof (struct ordered_obj_section));
+      next->count = block->count - half;
+      block->count = half;
+      ordered_block_update_reach (next, 0);
+      ordered_blocks[b + 1].addr = next->entries[0].addr;
+
+      if (pos > half)
+	{
+	  block = next;
+	  pos -= half;
+	  b++;
+	}
+    }
+
+
+  memmove (&block->entries[pos + 1], &block->entries[pos],
+	   (block->count - pos) * sizeof (struct ordered_obj_section));
+  block->count++;
+
+  entry = &block->entries[pos];
+  entry->addr = s->addr;
+  entry->endaddr = s->endaddr;
+  entry->obj_section = s;
+  entry->the_bfd_section = s->the_bfd_section;
+  ordered_block_update_reach (block, pos);
+  ordered_blocks[b].addr = block->entries[0].addr;
+
+  num_ordered_sections++;
 }
 
-/* APPLE LOCAL: The difference between the segment names and the section
-   names is the segment names always only have one dot.  Use this to count
-   the dots quickly...  */
+/* Find obj_section S in the table, and store its block and position
+   in *BP and *POSP.  Return zero if it isn't there.  */
+
 static int
-number_of_dots (const char *s)
+ordered_sections_find (struct obj_section *s, int *bp, int *posp)
 {
-  int numdots = 0;
-  while (*s != '\0')
+  struct ordered_sections_block *block;
+  int b, pos;
+
+  /* S normally still has the address it was entered with, and few
+     entries start at any one address.  */
+  for (b = ordered_block_for_addr (s->addr); b >= 0; b--)
+    {
+      block = ordered_blocks[b].block;
+      pos = ordered_block_bound (block, s->addr, 1) - 1;
+      while (pos >= 0 && block->entries[pos].addr == s->addr
+	     && block->entries[pos].obj_section != s)
+	pos--;
+      if (pos >= 0 && block->entries[pos].addr == s->addr)
+	{
+	  *bp = b;
+	  *posp = pos;
+	  return 1;
+	}
+      if (pos >= 0)
+	break;
+    }
+
+  /* If it was moved anyway, look at every entry.  */
+  for (b = 0; b < num_ordered_blocks; b++)
     {
-      if (*s == '.')
-	numdots++;
-      s++;
+      block = ordered_blocks[b].block;
+      for (pos = 0; pos < block->count; pos++)
+	if (block->entries[pos].obj_section == s)
+	  {
+	    *bp = b;
+	    *posp = pos;
+	    return 1;
+	  }
     }
-  return numdots;
+  return 0;
+}
+
+/* Take obj_section S out of the table.  Return zero if it wasn't
+   there.  This keeps the blocks' start addresses right, but the
+   caller has to recompute their reach.  */
+
+static int
+ordered_sections_remove (struct obj_section *s)
+{
+  struct ordered_sections_block *block;
+  int b, pos;
+
+  if (!ordered_sections_find (s, &b, &pos))
+    return 0;
+
+  block = ordered_blocks[b].block;
+  memmove (&block->entries[pos], &block->entries[pos + 1],
+	   (block->count - pos - 1) * sizeof (struct ordered_obj_section));
+  block->count--;
+  num_ordered_sections--;
+
+  if (block->count == 0)
+    {
+      xfree (block);
+      memmove (&ordered_blocks[b], &ordered_blocks[b + 1],
+	       (num_ordered_blocks - b - 1)
+	       * sizeof (struct ordered_sections_block_info));
+      num_ordered_blocks--;
+    }
+  else
+    {
+      ordered_block_update_reach (block, pos);
+      ordered_blocks[b].addr = block->entries[0].addr;
+    }
+
+  return 1;
 }
 
 /* Delete all the obj_sections in OBJFILE from the ordered_sections
@@ -474,17 +744,9 @@ number_of_dots (const char *s)
    call this BEFORE you relocate, then relocate, then call 
    objfile_add_to_ordered_sections.  */
 
-#define STATIC_DELETE_LIST_SIZE 256
-
 void 
 objfile_delete_from_ordered_sections (struct objfile *objfile)
 {
-  int i;
-  int ndeleted;
-  int delete_list_size;
-  int static_delete_list[STATIC_DELETE_LIST_SIZE];
-  int *delete_list = static_delete_list;
-  
   struct obj_section *s;
   
   /* APPLE LOCAL: we need to check if this is a separate debug files and try to 
@@ -495,128 +757,27 @@ objfile_delete_from_ordered_sections (struct objfile *objfile)
       objfile->flags & OBJF_SEPARATE_DEBUG_FILE)
 	return;	
 
-  /* Do deletion of the sections by building up an array of
-     "to be removed" indices, and then block compact the array using
-     these indices.  */
-  
-  delete_list_size = objfile->sections_end - objfile->sections;
-  if (delete_list_size > STATIC_DELETE_LIST_SIZE)
-    delete_list = (int *) xmalloc (delete_list_size * sizeof (int));
-
-  ndeleted = 0;
-
   ALL_OBJFILE_OSECTIONS (objfile, s)
     {
-      int index;
-      /* APPLE LOCAL: Oh, hacky, hacky...  The bfd Mach-O reader makes
-         bfd_sections for both the sections & segments (the container of
-         the sections).  This would make pc->bfd_section lookup non-unique.
-         so we just drop the segments from our list.  */
-      if (s->the_bfd_section && s->the_bfd_section->name &&
-          number_of_dots (s->the_bfd_section->name) == 1)
+      if (!ordered_section_wanted (s))
         continue;
 
-      index = find_in_ordered_sections_index (s->addr, s->the_bfd_section);
-      if (index == -1)
+      if (!ordered_sections_remove (s))
 	warning ("Trying to remove a section from"
 			" the ordered section list that did not exist"
 			" at 0x%s.", paddr_nz (s->addr));
-      else
-	{
-	  delete_list[ndeleted] = index;
-	  ndeleted++;
-	}
-    }
-  qsort (delete_list, ndeleted, sizeof (int),
-	 forward_int_compare);
-
-  /* Stick a boundary on the end of the delete list - it makes the block
-     shuffle algorithm easier.  I also have to set the boundary to one
-     past the list end because it is supposed to be the next element
-     deleted, and I don't want to delete the last element.  */
-
-  delete_list[ndeleted] = num_ordered_sections;
-
-  for (i = 0; i < ndeleted; i++)
-    {
-      struct ordered_obj_section *src, *dest;
-      size_t len;
-
-      src = &(ordered_sections[delete_list[i] + 1]);
-      dest = &(ordered_sections[delete_list[i] - i]);
-      len = (delete_list[i+1] - delete_list[i] - 1)
-	* sizeof (struct ordered_obj_section);
-
-      bcopy (src, dest, len);
-    }
-
-  
-  num_ordered_sections -= ndeleted;
-  if (delete_list != static_delete_list)
-    xfree (delete_list);
-}
-
-/* This returns the index before which the obj_section SECTION
-   should be added in the ordered_sections list.  This only sorts
-   by addr, and pays no attention to endaddr, or the_bfd_section.  */
-
-static int
-get_insert_index_in_ordered_sections (struct obj_section *section)
-{
-  int insert = -1;
-
-  if (num_ordered_sections > 0)
-    {
-      int bot = 0;
-      int top = num_ordered_sections - 1;
-
-      do
-	{
-	  int mid = (top + bot) / 2;
-
-	  if (ordered_sections[mid].addr < section->addr)
-	    {
-	      if ((mid == num_ordered_sections - 1) 
-		  || (ordered_sections[mid + 1].addr >= section->addr))
-		{
-		  insert = mid;
-		  break;
-		}
-	      else if (mid + 1 == num_ordered_sections - 1)
-		{
-		  insert = mid + 1;
-		  break;
-		}
-	      bot = mid + 1;
-	    }
-	  else
-	    {
-	      if (mid == 0 || ordered_sections[mid - 1].addr <= section->addr)
-		{
-		  insert = mid - 1;
-		  break;
-		}
-	      top = mid - 1;
-	    }
-	} while (top > bot);
     }
 
-  return insert + 1;
+  ordered_blocks_update_info ();
 }
 
 /* This adds all the obj_sections for OBJFILE to the ordered_sections
    array */
 
-#define STATIC_INSERT_LIST_SIZE 256
-
 void
 objfile_add_to_ordered_sections (struct objfile *objfile)
 {
   struct obj_section *s;
-  int i, num_left, total;
-  struct obj_section_with_index static_insert_list[STATIC_INSERT_LIST_SIZE];
-  struct obj_section_with_index *insert_list = static_insert_list;
-  int insert_list_size;
 
   /* APPLE LOCAL: we need to check if this is a separate debug files and not 
      add the sections to the ordered list if so. The backlink will not be setup
@@ -628,183 +789,61 @@ objfile_add_to_ordered_sections (struct objfile *objfile)
 	
   CHECK_FATAL (objfile != NULL);
 
-  /* First find the index for insertion of all the sections in
-     this objfile.  The sort that array in reverse order by address,
-     then go through the ordered list block moving the bits between
-     the insert points, then adding the pieces we need to add.  */
-
-  insert_list_size = objfile->sections_end - objfile->sections;
-  if (insert_list_size > STATIC_INSERT_LIST_SIZE)
-    insert_list = (struct obj_section_with_index *) 
-      xmalloc (insert_list_size * sizeof (struct obj_section_with_index));
-
-  total = 0;
   ALL_OBJFILE_OSECTIONS (objfile, s)
     {
-      /* APPLE LOCAL: Oh, hacky, hacky...  The bfd Mach-O reader makes
-         bfd_sections for both the sections & segments (the container of
-         the sections).  This would make pc->bfd_section lookup non-unique.
-         so we just drop the segments from our list.  */
-      if (s->the_bfd_section && s->the_bfd_section->segment_mark == 1)
+      if (!ordered_section_wanted (s))
         continue;
 
-      insert_list[total].index = get_insert_index_in_ordered_sections (s);
-      insert_list[total].section = s;
-      total++;
-    }
-
-  qsort (insert_list, total, sizeof (struct obj_section_with_index), 
-	 backward_section_compare);
-
-  /* Grow the array if needed */
-
-  if (ordered_sections == NULL)
-    {
-      max_num_ordered_sections = ORDERED_SECTIONS_CHUNK_SIZE;
-      ordered_sections = (struct ordered_obj_section *)
-	xmalloc (max_num_ordered_sections 
-		 * sizeof (struct ordered_obj_section));
-    }
-  else if (num_ordered_sections + total >= max_num_ordered_sections)
-    {
-      /* TOTAL should be small, but on the off chance that it is not, 
-	 just add it to the allocation as well.  */
-      max_num_ordered_sections += ORDERED_SECTIONS_CHUNK_SIZE + total;
-      ordered_sections = (struct ordered_obj_section *) 
-	xrealloc (ordered_sections, 
-		  max_num_ordered_sections 
-		  * sizeof (struct ordered_obj_section));
-    }
-  
-  num_left = total;
-
-  for (i = 0; i < total; i++)
-    {
-      struct ordered_obj_section *src;
-      struct ordered_obj_section *dest;
-      struct obj_section *s;
-      size_t len;
-      int pos;
-
-      src = &(ordered_sections[insert_list[i].index]);
-      dest = &(ordered_sections[insert_list[i].index + num_left]);
-
-      if (i == 0)
-	len = num_ordered_sections - insert_list[i].index;
-      else
-	len = insert_list[i - 1].index - insert_list[i].index;
-      len *= sizeof (struct ordered_obj_section);
-      bcopy (src, dest, len);
-
-      /* Now put the new element in place */
-      s = insert_list[i].section;
-      pos = insert_list[i].index + num_left - 1;
-      ordered_sections[pos].addr = s->addr;
-      ordered_sections[pos].endaddr = s->endaddr;
-      ordered_sections[pos].obj_section = s;
-      ordered_sections[pos].the_bfd_section = s->the_bfd_section;
-
-      num_left--;
-      if (num_left == 0)
-	break;
+      ordered_sections_insert (s);
     }
 
-  num_ordered_sections += total;
-  if (insert_list != static_insert_list)
-    xfree (insert_list);
-
+  ordered_blocks_update_info ();
 }
 
-/* This returns the index in the ordered_sections array corresponding
-   to the pair ADDR, BFD_SECTION (can be null), or -1 if not found. */
+/* This returns the obj_section corresponding to the pair ADDR and
+   BFD_SECTION (can be NULL) in the ordered sections array, or NULL
+   if not found.  If several sections contain ADDR, the one that
+   starts last wins.  */
 
-static int
-find_in_ordered_sections_index (CORE_ADDR addr, struct bfd_section *bfd_section)
+struct obj_section *
+find_pc_sect_in_ordered_sections (CORE_ADDR addr, struct bfd_section *bfd_section)
 {
-  int bot = 0;
-  int top = num_ordered_sections;
-  struct ordered_obj_section *obj_sect_ptr;
+  struct ordered_sections_block *block;
+  int b, pos;
 
-  if (num_ordered_sections == 0)
-    return -1;
+  b = ordered_block_for_addr (addr);
+  if (b < 0)
+    return NULL;
 
-  do 
-    {
-      int mid = (top + bot) / 2;
+  block = ordered_blocks[b].block;
+  pos = ordered_block_bound (block, addr, 1) - 1;
 
-      obj_sect_ptr = &ordered_sections[mid]; 
-      if (obj_sect_ptr->addr <= addr)
-	{
-	  if (addr < obj_sect_ptr->endaddr)
-	    {
-	      /* It is possible that the sections overlap.  This will
-		 happen in two cases that I know of.  One is when you
-		 have not run the app yet, so that a bunch of the
-		 sections are still mapped at 0, and haven't been.
-		 relocated yet.  The other is because on MacOS X we (I
-		 think errantly) make sections both for the segment
-		 command, and for the sections it contains.  In the former
-	         case, this becomes a linear search just like the original
-	         algorithm.  In the latter, we should find it in the
-	         near neighborhood pretty soon.  */
-
-	      if ((bfd_section == NULL )
-		  || (bfd_section == obj_sect_ptr->the_bfd_section))
-		return mid;
-	      else
-		{
-		  /* So to find the containing element, we can look
-		     to increasing indices, till the start address
-		     of our element is above the addr, but we have to go
-		     all the way to the left to find the address. */
-
-		  int pos;
-		  for (pos = mid + 1; pos < num_ordered_sections; pos++)
-		    {
-		      if (ordered_sections[pos].addr > addr)
-			break;
-		      else if ((ordered_sections[pos].endaddr > addr)
-			       && (ordered_sections[pos].the_bfd_section == bfd_section))
-			return pos;
-		    }
-		  for (pos = mid - 1; pos >= 0; pos--)
-		    {
-		      if ((ordered_sections[pos].endaddr > addr)
-			  && (ordered_sections[pos].the_bfd_section == bfd_section))
-			return pos;
-		    }
-
-		  /* If we don't find one that matches BOTH the address and the 
-		     section, then return -1.  Callers should be prepared to either
-		     fail in this case, or to look more broadly.  */
-		  return -1;
-		}
-	    }
-	  bot = mid + 1;
-	}
-      else
-	{
-	  top = mid - 1;
-	}
-    } while (bot <= top);
+  /* It is possible that the sections overlap.  This will happen in
+     two cases that I know of.  One is when you have not run the app
+     yet, so that a bunch of the sections are still mapped at 0, and
+     haven't been relocated yet.  The other is because on MacOS X we
+     (I think errantly) make sections both for the segment command,
+     and for the sections it contains.  So walk back towards lower
+     start addresses for as long as the reach says something there
+     might still cover ADDR.  */
 
-  /* If we got here, we didn't find anything, so return -1. */
-  return -1;
-}
+  for (;;)
+    {
+      for (; pos >= 0 && block->entries[pos].reach > addr; pos--)
+	{
+	  struct ordered_obj_section *entry = &block->entries[pos];
 
-/* This returns the obj_section corresponding to the pair ADDR and
-   BFD_SECTION (can be NULL) in the ordered sections array, or NULL
-   if not found.  */
+	  if (addr < entry->endaddr
+	      && (bfd_section == NULL || bfd_section == entry->the_bfd_section))
+	    return entry->obj_section;
+	}
 
-struct obj_section *
-find_pc_sect_in_ordered_sections (CORE_ADDR addr, struct bfd_section *bfd_section)
-{
-  int index = find_in_ordered_sections_index (addr, bfd_section);
-  
-  if (index == -1)
-    return NULL;
-  else
-    return ordered_sections[index].obj_section;
+      b--;
+      if (b < 0 || ordered_blocks[b].reach <= addr)
+	return NULL;
+      block = ordered_blocks[b].block;
+      pos = block->count - 1;
+    }
 }
 
 /* Initialize entry point information for this objfile. */
@@ -888,6 +927,13 @@ put_objfile_before (struct objfile *objfile, struct objfile *before_this)
 		  _("put_objfile_before: before objfile not in list"));
 }
 
+/* APPLE LOCAL begin unwinder cache  */
+/* Bumped whenever an objfile is linked into or unlinked from
+   OBJECT_FILES, or has its load level raised.  */
+
+unsigned int objfile_chain_generation = 1;
+/* APPLE LOCAL end unwinder cache  */
+
 /* Put OBJFILE at the front of the list.  */
 
 void
@@ -938,6 +984,8 @@ link_objfile (struct objfile *objfile)
 	   last_one = last_one->next);
       last_one->next = objfile;
     }
+  /* APPLE LOCAL unwinder cache  */
+  objfile_chain_generation++;
 }
 
 /* Unlink OBJFILE from the list of known objfiles, clearing its NEXT
@@ -955,6 +1003,8 @@ unlink_objfile (struct objfile *objfile)
 	{
 	  *objpp = (*objpp)->next;
 	  objfile->next = NULL;
+	  /* APPLE LOCAL unwinder cache  */
+	  objfile_chain_generation++;
 	  return;
 	}
     }
@@ -993,6 +1043,10 @@ free_objfile_internal (struct objfile *objfile)
   
   objfile_delete_from_ordered_sections (objfile);
 
+  /* APPLE LOCAL demangled names cache: This needs the bfd for the
+     UUID.  */
+  save_demangled_names_cache (objfile);
+
   /* We always close the bfd. */
 
   if (objfile->obfd != NULL)
@@ -1032,6 +1086,8 @@ free_objfile_internal (struct objfile *objfile)
   /* I *think* all our callers call clear_symtab_users.  If so, no need
      to call this here.  */
   clear_pc_function_cache ();
+  /* APPLE LOCAL C++ lookup caches  */
+  cp_flush_namespace_cache ();
 
   /* The last thing we do is free the objfile struct itself. */
 
@@ -1052,6 +1108,8 @@ free_objfile_internal (struct objfile *objfile)
   /* END APPLE LOCAL */
   if (objfile->demangled_names_hash)
     htab_delete (objfile->demangled_names_hash);
+  /* APPLE LOCAL shared names  */
+  objfile_release_shared_names (objfile);
   obstack_free (&objfile->objfile_obstack, 0);
   /* APPLE LOCAL begin dwarf repository  */
   if (objfile->uses_sql_repository)
@@ -1061,6 +1119,8 @@ free_objfile_internal (struct objfile *objfile)
   /* APPLE LOCAL begin subroutine inlining  */
   if (objfile->inlined_subroutine_data)
     inlined_subroutine_free_objfile_data (objfile->inlined_subroutine_data);
+  /* APPLE LOCAL inlined subroutine index  */
+  inlined_subroutine_invalidate_index (objfile);
   if (objfile->inlined_call_sites)
     inlined_subroutine_free_objfile_call_sites (objfile->inlined_call_sites);
   /* APPLE LOCAL end subroutine inlining  */
@@ -1182,6 +1242,69 @@ free_all_objfiles (void)
   clear_symtab_users ();
 }
 
+/* APPLE LOCAL begin deferred psymbol relocation  */
+/* Add DELTA to the address of every psymbol in OBJFILE's global and
+   static lists.  */
+
+static void
+relocate_psymbol_lists (struct objfile *objfile, struct section_offsets *delta)
+{
+  struct partial_symbol **psym;
+
+  for (psym = objfile->global_psymbols.list;
+       psym < objfile->global_psymbols.next;
+       psym++)
+    {
+      fixup_psymbol_section (*psym, objfile);
+      if (SYMBOL_SECTION (*psym) >= 0)
+	SYMBOL_VALUE_ADDRESS (*psym) += ANOFFSET (delta,
+						  SYMBOL_SECTION (*psym));
+    }
+  for (psym = objfile->static_psymbols.list;
+       psym < objfile->static_psymbols.next;
+       psym++)
+    {
+      fixup_psymbol_section (*psym, objfile);
+      if (SYMBOL_SECTION (*psym) >= 0)
+	SYMBOL_VALUE_ADDRESS (*psym) += ANOFFSET (delta,
+						  SYMBOL_SECTION (*psym));
+    }
+}
+
+/* If OBJFILE has been slid since its psymbol addresses were last
+   brought up to date, apply the outstanding relocation to them now.
+   However many slides happened in between, this is one pass over the
+   psymbols.  */
+
+void
+objfile_relocate_psymbols (struct objfile *objfile)
+{
+  struct section_offsets *delta;
+  int i;
+  int something_changed = 0;
+
+  if (objfile == NULL || !objfile->psymbol_relocation_pending)
+    return;
+
+  /* Clear this first so that anything we call on the way can look at
+     the psymbols without coming back here.  */
+  objfile->psymbol_relocation_pending = 0;
+
+  delta = (struct section_offsets *)
+    alloca (SIZEOF_N_SECTION_OFFSETS (objfile->num_sections));
+  for (i = 0; i < objfile->num_sections; i++)
+    {
+      delta->offsets[i] = ANOFFSET (objfile->section_offsets, i)
+	- ANOFFSET (objfile->psymbol_offsets, i);
+      if (delta->offsets[i] != 0)
+	something_changed = 1;
+    }
+
+  if (something_changed)
+    relocate_psymbol_lists (objfile, delta);
+}
+/* APPLE LOCAL end deferred psymbol relocation  */
+
 /* Relocate OBJFILE to NEW_OFFSETS.  There should be OBJFILE->NUM_SECTIONS
    entries in new_offsets.  */
 void
@@ -1332,32 +1455,43 @@ objfile_relocate (struct objfile *objfile, struct section_offsets *new_offsets)
     }
   }
 
-  {
-    struct partial_symbol **psym;
-
-    for (psym = objfile->global_psymbols.list;
-	 psym < objfile->global_psymbols.next;
-	 psym++)
-      {
-	fixup_psymbol_section (*psym, objfile);
-	if (SYMBOL_SECTION (*psym) >= 0)
-	  SYMBOL_VALUE_ADDRESS (*psym) += ANOFFSET (delta,
-						    SYMBOL_SECTION (*psym));
-      }
-    for (psym = objfile->static_psymbols.list;
-	 psym < objfile->static_psymbols.next;
-	 psym++)
-      {
-	fixup_psymbol_section (*psym, objfile);
-	if (SYMBOL_SECTION (*psym) >= 0)
-	  SYMBOL_VALUE_ADDRESS (*psym) += ANOFFSET (delta,
-						    SYMBOL_SECTION (*psym));
-      }
-  }
+  /* APPLE LOCAL begin deferred psymbol relocation  */
+  /* Walking every psymbol is most of the cost of a slide, and most
+     psymbols are never looked at by address before the next slide (or
+     ever).  Just remember what offsets they reflect now and let
+     objfile_relocate_psymbols catch them up when someone asks.  */
+  if (deferred_psymbol_relocation)
+    {
+      if (!objfile->psymbol_relocation_pending)
+	{
+	  int i;
+
+	  if (objfile->psymbol_offsets == NULL)
+	    objfile->psymbol_offsets = (struct section_offsets *)
+	      obstack_alloc (&objfile->objfile_obstack,
+			     SIZEOF_N_SECTION_OFFSETS (objfile->num_sections));
+	  for (i = 0; i < objfile->num_sections; i++)
+	    objfile->psymbol_offsets->offsets[i]
+	      = ANOFFSET (objfile->section_offsets, i);
+	  objfile->psymbol_relocation_pending = 1;
+	}
+    }
+  else
+    {
+      objfile_relocate_psymbols (objfile);
+      relocate_psymbol_lists (objfile, delta);
+    }
+  /* APPLE LOCAL end deferred psymbol relocation  */
 
   {
     struct minimal_symbol *msym;
-    ALL_OBJFILE_MSYMBOLS (objfile, msym)
+    int i;
+
+    /* APPLE LOCAL lazy minsym demangling: Not ALL_OBJFILE_MSYMBOLS;
+       relocating doesn't need the demangled names.  */
+    for (i = 0, msym = objfile->msymbols;
+	 i < objfile->minimal_symbol_count;
+	 i++, msym++)
       if (SYMBOL_SECTION (msym) >= 0)
       SYMBOL_VALUE_ADDRESS (msym) += ANOFFSET (delta, SYMBOL_SECTION (msym));
   }
@@ -1686,6 +1820,36 @@ objfile_clear_restrict_list ()
     }
 }
 
+/* APPLE LOCAL begin incremental breakpoint re-set  */
+/* Return -1 if the restricted search list is empty, 1 if one of the
+   objfiles on it (or its separate debug file) matches NAME as
+   objfile_matches_name would have it, and 0 otherwise.  */
+
+int
+objfile_restrict_list_matches_name (char *name)
+{
+  struct objfile_list *list_ptr;
+
+  if (objfile_list == NULL)
+    return -1;
+
+  for (list_ptr = objfile_list; list_ptr != NULL; list_ptr = list_ptr->next)
+    {
+      struct objfile *objfile = list_ptr->objfile;
+
+      if (objfile == NULL)
+	continue;
+      if (objfile_matches_name (objfile, name) != objfile_no_match)
+	return 1;
+      if (objfile->separate_debug_objfile != NULL
+	  && (objfile_matches_name (objfile->separate_debug_objfile, name)
+	      != objfile_no_match))
+	return 1;
+    }
+  return 0;
+}
+/* APPLE LOCAL end incremental breakpoint re-set  */
+
 static struct objfile_list *
 objfile_set_restrict_list (struct objfile_list *objlist)
 {
@@ -2057,7 +2221,21 @@ objfile_set_load_state (struct objfile *o, int load_state, int force)
 {
 
   if (!force && !should_auto_raise_load_state)
-    return -2;
+    {
+#ifdef MACOSX_DYLD
+      /* A library still waiting on the background loader was going to
+	 get these symbols anyway, so read it now rather than making
+	 the caller wait for the rest of the queue.  Don't go past what
+	 the load rules asked for, though.  */
+      int deferred = dyld_objfile_deferred_load_state (o);
+      if (deferred < 0)
+	return -2;
+      if (load_state > deferred)
+	load_state = deferred;
+#else
+      return -2;
+#endif
+    }
 
   if (o->symflags & OBJF_SYM_DONT_CHANGE)
     return -2;
@@ -2071,7 +2249,26 @@ objfile_set_load_state (struct objfile *o, int load_state, int force)
     return load_state;
 
 #ifdef MACOSX_DYLD
-  return dyld_objfile_set_load_state (o, load_state);
+  /* APPLE LOCAL begin debug info on demand  */
+  /* Someone looking at a pc or a name in O wants its debug info.  If
+     that lives in a dSYM, read just the dSYM and leave O where it is;
+     the compilation units they need are expanded from the dSYM's
+     psymtabs as usual, and the rest of O stays at the lower level.  */
+  if (!force && debug_info_on_demand
+      && (load_state & OBJF_SYM_LEVELS_MASK) == OBJF_SYM_ALL
+      && symbol_file_add_separate_debug_on_demand (o) != NULL)
+    return o->symflags;
+  /* APPLE LOCAL end debug info on demand  */
+
+  /* APPLE LOCAL begin unwinder cache  */
+  {
+    int ret = dyld_objfile_set_load_state (o, load_state);
+    /* Whatever was read at the new level may say things about any
+       address.  */
+    objfile_chain_generation++;
+    return ret;
+  }
+  /* APPLE LOCAL end unwinder cache  */
 #else
   return -1;
 #endif
@@ -2086,8 +2283,10 @@ pc_set_load_state (CORE_ADDR pc, int load_state, int force)
 {
   struct obj_section *s;
 
+#ifndef MACOSX_DYLD
   if (!force && !should_auto_raise_load_state)
     return -1;
+#endif
 
   s = find_pc_section (pc);
   if (s == NULL)
@@ -2108,8 +2307,10 @@ objfile_name_set_load_state (char *name, int load_state, int force)
 {
   struct objfile *tmp_obj;
 
+#ifndef MACOSX_DYLD
   if (!force && !should_auto_raise_load_state)
     return -2;
+#endif
 
   if (name == NULL)
     return -1;
@@ -2212,6 +2413,8 @@ psymtab_get_next (struct partial_symtab *ps, int skip_obsolete)
 struct objfile_data
 {
   unsigned index;
+  /* APPLE LOCAL: Called on the stored value when it is discarded.  */
+  void (*cleanup) (struct objfile *, void *);
 };
 
 struct objfile_data_registration
@@ -2230,6 +2433,17 @@ static struct objfile_data_registry objfile_data_registry = { NULL, 0 };
 
 const struct objfile_data *
 register_objfile_data (void)
+{
+  return register_objfile_data_with_cleanup (NULL);
+}
+
+/* APPLE LOCAL: Register a per-objfile data pointer whose value needs
+   CLEANUP run on it when the objfile's data is cleared or freed.  This
+   is for values that hold resources outside the objfile_obstack.  */
+
+const struct objfile_data *
+register_objfile_data_with_cleanup (void (*cleanup) (struct objfile *,
+						     void *))
 {
   struct objfile_data_registration **curr;
 
@@ -2241,6 +2455,7 @@ register_objfile_data (void)
   (*curr)->next = NULL;
   (*curr)->data = XMALLOC (struct objfile_data);
   (*curr)->data->index = objfile_data_registry.num_registrations++;
+  (*curr)->data->cleanup = cleanup;
 
   return (*curr)->data;
 }
@@ -2253,10 +2468,26 @@ objfile_alloc_data (struct objfile *objfile)
   objfile->data = XCALLOC (objfile->num_data, void *);
 }
 
+/* APPLE LOCAL: Run the registered cleanups over OBJFILE's data.  */
+
+static void
+objfile_cleanup_data (struct objfile *objfile)
+{
+  struct objfile_data_registration *reg;
+
+  for (reg = objfile_data_registry.registrations; reg != NULL;
+       reg = reg->next)
+    if (reg->data->cleanup != NULL
+	&& reg->data->index < objfile->num_data
+	&& objfile->data[reg->data->index] != NULL)
+      reg->data->cleanup (objfile, objfile->data[reg->data->index]);
+}
+
 static void
 objfile_free_data (struct objfile *objfile)
 {
   gdb_assert (objfile->data != NULL);
+  objfile_cleanup_data (objfile);
   xfree (objfile->data);
   objfile->data = NULL;
 }
@@ -2273,6 +2504,7 @@ void
 clear_objfile_data (struct objfile *objfile)
 {
   gdb_assert (objfile->data != NULL);
+  objfile_cleanup_data (objfile);
   memset (objfile->data, 0, objfile->num_data * sizeof (void *));
 }
 
@@ -2538,6 +2770,9 @@ partial_symbol_special_info (struct objfile *objfile,
   if (objfile->num_thumb_psyms == 0)
     return NULL;
 
+  /* APPLE LOCAL deferred psymbol relocation  */
+  objfile_relocate_psymbols (objfile);
+
   if (PSYMBOL_DOMAIN (psym) != VAR_DOMAIN
       && PSYMBOL_DOMAIN (psym) != FUNCTIONS_DOMAIN
       && PSYMBOL_DOMAIN (psym) != METHODS_DOMAIN)
@@ -2663,6 +2898,28 @@ slide_objfile (struct objfile *objfile, CORE_ADDR slide,
     }
 }
 
+/* APPLE LOCAL begin deferred psymbol relocation  */
+static void
+show_deferred_psymbol_relocation (struct ui_file *file, int from_tty,
+				  struct cmd_list_element *c,
+				  const char *value)
+{
+  fprintf_filtered (file, _("Deferred relocation of partial symbols is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end deferred psymbol relocation  */
+
+/* APPLE LOCAL begin debug info on demand  */
+static void
+show_debug_info_on_demand (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Reading only the dSYM of a library whose debug info is needed is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end debug info on demand  */
+
 void
 _initialize_objfiles (void)
 {
@@ -2675,4 +2932,43 @@ _initialize_objfiles (void)
 Set if GDB should raise the symbol loading level on all frames found in backtraces."), _("\
 Show if GDB should raise the symbol loading level on all frames found in backtraces."), NULL,
 			   NULL, NULL, &setlist, &showlist);
+
+  /* APPLE LOCAL begin deferred psymbol relocation  */
+  add_setshow_boolean_cmd ("deferred-psymbol-relocation", class_maintenance,
+			   &deferred_psymbol_relocation, _("\
+Set whether sliding an objfile defers relocating its partial symbols."), _("\
+Show whether sliding an objfile defers relocating its partial symbols."), _("\
+When on, moving an objfile to a new load address only records the new\n\
+offsets for its partial symbols; their addresses are fixed up the first\n\
+time something looks them up by address or expands them."),
+			   NULL, show_deferred_psymbol_relocation,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end deferred psymbol relocation  */
+
+  /* APPLE LOCAL begin debug info on demand  */
+  add_setshow_boolean_cmd ("debug-info-on-demand", class_maintenance,
+			   &debug_info_on_demand, _("\
+Set whether raising a library's load level for its debug info reads only its dSYM."), _("\
+Show whether raising a library's load level for its debug info reads only its dSYM."), _("\
+When on, a lookup or backtrace that needs debug info from a library\n\
+loaded at a lower level reads just the library's dSYM, and expands only\n\
+the compilation units it needs, instead of re-reading the whole library\n\
+at the \"all\" level.  Libraries without a dSYM are raised as before."),
+			   NULL, show_debug_info_on_demand,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end debug info on demand  */
+
+  /* APPLE LOCAL begin objfile memory  */
+  add_setshow_zinteger_cmd ("objfile-obstack-chunk-size", class_maintenance,
+			    &objfile_obstack_chunk_size, _("\
+Set the size of the chunks objfile obstacks grow by."), _("\
+Show the size of the chunks objfile obstacks grow by."), _("\
+Objfiles read after this is changed get obstacks that allocate memory\n\
+this many bytes at a time.  Zero means use the obstack default."),
+			    NULL, show_objfile_obstack_chunk_size,
+			    &maintenance_set_cmdlist,
+			    &maintenance_show_cmdlist);
+  /* APPLE LOCAL end objfile memory  */
 }
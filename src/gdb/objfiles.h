@@ -208,11 +208,17 @@ struct objstats
 #define OBJSTAT(objfile, expr) (objfile -> stats.expr)
 #define OBJSTATS struct objstats stats
 extern void print_objfile_statistics (void);
+/* APPLE LOCAL objfile memory  */
+extern void print_objfile_memory (char *regexp);
 extern void print_symbol_bcache_statistics (void);
 
 /* Number of entries in the minimal symbol hash table.  */
 #define MINIMAL_SYMBOL_HASH_SIZE 2039
 
+/* APPLE LOCAL: Number of buckets in the coarse address index over an
+   objfile's minimal symbols; see msymbol_addr_index below.  */
+#define MSYMBOL_ADDR_INDEX_SIZE 256
+
 /* Master structure for keeping track of each file from which
    gdb reads symbols.  There are several ways these get allocated: 1.
    The main symbol file, symfile_objfile, set by the symbol-file command,
@@ -300,6 +306,20 @@ struct objfile
        if the name doesn't demangle.  */
     struct htab *demangled_names_hash;
 
+    /* APPLE LOCAL demangled names cache: The number of entries
+       demangled_names_hash had when it was last read from or written
+       to the demangled names cache, so we only write it when it has
+       grown.  */
+    unsigned int demangled_names_saved;
+
+    /* APPLE LOCAL begin shared names  */
+    /* If non-NULL, this objfile's symbol names are entered in this
+       process-wide table, shared with other objfiles from the dyld
+       shared cache, rather than in demangled_names_hash and the
+       objfile_obstack.  See objfile_use_shared_names.  */
+    struct shared_names *shared_names;
+    /* APPLE LOCAL end shared names  */
+
     /* Vectors of all partial symbols read in from file.  The actual data
        is stored in the objfile_obstack. */
 
@@ -318,6 +338,20 @@ struct objfile
     struct minimal_symbol *msymbols;
     int minimal_symbol_count;
 
+    /* APPLE LOCAL: The addresses of MSYMBOLS, packed tightly, so the
+       search by pc in lookup_minimal_symbol_by_pc_section doesn't pull
+       in a whole minimal_symbol at every step.  MSYMBOL_ADDR_INDEX
+       narrows that search first: entry I is the first msymbol whose
+       address, less MSYMBOL_ADDRS[0] and shifted right by
+       MSYMBOL_ADDR_SHIFT, is at least I.  It has
+       MSYMBOL_ADDR_INDEX_SIZE + 1 entries.  Both live on the
+       objfile_obstack and are rebuilt whenever MSYMBOLS is sorted;
+       NULL means search MSYMBOLS directly.  */
+
+    CORE_ADDR *msymbol_addrs;
+    int *msymbol_addr_index;
+    int msymbol_addr_shift;
+
     /* This is a hash table used to index the minimal symbols by name.  */
 
    struct minimal_symbol *msymbol_hash[MINIMAL_SYMBOL_HASH_SIZE];
@@ -327,6 +361,10 @@ struct objfile
 
     struct minimal_symbol *msymbol_demangled_hash[MINIMAL_SYMBOL_HASH_SIZE];
 
+    /* APPLE LOCAL lazy minsym demangling: Zero if some of MSYMBOLS
+       may have been entered without demangling their names, in which
+       case minimal_symbols_demangle has to be called before
+       MSYMBOL_DEMANGLED_HASH or the demangled names can be used.  */
     int minimal_symbols_demangled;
 
     /* For object file formats which don't specify fundamental types, gdb
@@ -413,6 +451,17 @@ struct objfile
     struct section_offsets *section_offsets;
     int num_sections;
 
+    /* APPLE LOCAL begin deferred psymbol relocation  */
+    /* When PSYMBOL_RELOCATION_PENDING is set, the addresses in the
+       global and static psymbol lists still reflect PSYMBOL_OFFSETS
+       rather than SECTION_OFFSETS.  objfile_relocate_psymbols brings
+       them up to date; anything that looks at a psymbol's address must
+       call it first.  PSYMBOL_OFFSETS is on the objfile_obstack.  */
+
+    struct section_offsets *psymbol_offsets;
+    int psymbol_relocation_pending;
+    /* APPLE LOCAL end deferred psymbol relocation  */
+
     /* Indexes in the section_offsets array. These are initialized by the
        *_symfile_offsets() family of functions (som_symfile_offsets,
        xcoff_symfile_offsets, default_symfile_offsets). In theory they
@@ -514,6 +563,14 @@ struct objfile
     struct rb_tree_node *inlined_call_sites;
     /* APPLE LOCAL end subroutine inlining  */
 
+    /* APPLE LOCAL begin inlined subroutine index  */
+    /* The nodes of INLINED_SUBROUTINE_DATA in tree order, built the
+       first time the tree is searched after it last changed.  NULL if
+       it needs building again.  */
+    struct rb_tree_node **inlined_subroutine_index;
+    int inlined_subroutine_index_size;
+    /* APPLE LOCAL end inlined subroutine index  */
+
     /* APPLE LOCAL begin differentiate arm & thumb msymbols */
     struct partial_symbol **thumb_psyms;
     int num_thumb_psyms;
@@ -616,6 +673,14 @@ extern struct objfile *current_objfile;
 
 extern struct objfile *object_files;
 
+/* APPLE LOCAL begin unwinder cache  */
+/* Changes whenever an objfile is added to or removed from
+   OBJECT_FILES or has its load level raised, so that caches that depend on what every objfile
+   says about an address can tell when to start over.  */
+
+extern unsigned int objfile_chain_generation;
+/* APPLE LOCAL end unwinder cache  */
+
 /* Declarations for functions defined in objfiles.c */
 
 extern struct objfile *allocate_objfile (bfd *, int, int symflags, CORE_ADDR mapaddr, const char *prefix);
@@ -630,6 +695,9 @@ extern CORE_ADDR entry_point_address (void);
 
 extern int build_objfile_section_table (struct objfile *);
 
+/* APPLE LOCAL objfile memory  */
+extern void objfile_obstack_init (struct objfile *);
+
 /* APPLE LOCAL */
 extern int objfile_keeps_section (bfd *abfd, asection *asect);
 
@@ -654,6 +722,9 @@ extern void free_all_objfiles (void);
 
 extern void objfile_relocate (struct objfile *, struct section_offsets *);
 
+/* APPLE LOCAL deferred psymbol relocation  */
+extern void objfile_relocate_psymbols (struct objfile *);
+
 extern int have_partial_symbols (void);
 
 extern int have_full_symbols (void);
@@ -682,6 +753,11 @@ extern int is_in_import_list (char *, struct objfile *);
    modules.  */
 
 extern const struct objfile_data *register_objfile_data (void);
+/* APPLE LOCAL: Like register_objfile_data, but CLEANUP is called with
+   the objfile and the stored value when the data is cleared or the
+   objfile is freed.  */
+extern const struct objfile_data *register_objfile_data_with_cleanup
+  (void (*cleanup) (struct objfile *, void *));
 extern void clear_objfile_data (struct objfile *objfile);
 extern void set_objfile_data (struct objfile *objfile,
 			      const struct objfile_data *data, void *value);
@@ -704,6 +780,8 @@ struct objfile *objfile_get_next (struct objfile *);
 int objfile_restrict_search (int);
 void objfile_add_to_restrict_list (struct objfile *objfile);
 void objfile_clear_restrict_list ();
+/* APPLE LOCAL incremental breakpoint re-set  */
+int objfile_restrict_list_matches_name (char *name);
 
 enum objfile_matches_name_return
   {
@@ -786,9 +864,12 @@ struct partial_symtab *psymtab_get_next (struct partial_symtab *, int );
 
 /* Traverse all minimal symbols in one objfile.  */
 
+/* APPLE LOCAL lazy minsym demangling: Callers may look at the
+   demangled names, so make sure they are there.  */
 #define	ALL_OBJFILE_MSYMBOLS(objfile, m) \
   if ((objfile)->msymbols)	 	 \
-    for ((m) = (objfile) -> msymbols; DEPRECATED_SYMBOL_NAME(m) != NULL; (m)++)
+    for (minimal_symbols_demangle (objfile), (m) = (objfile) -> msymbols; \
+	 DEPRECATED_SYMBOL_NAME(m) != NULL; (m)++)
 
 /* Traverse all symtabs in all objfiles.  */
 
@@ -51,6 +51,10 @@
 #include "doublest.h"
 #include "gdb_assert.h"
 #include "block.h"
+/* APPLE LOCAL begin expression cache  */
+#include "objfiles.h"
+#include "cli/cli-setshow.h"
+/* APPLE LOCAL end expression cache  */
 
 /* Standard set of definitions for printing, dumping, prefixifying,
  * and evaluating expressions.  */
@@ -78,6 +82,8 @@ char *lexptr;
 char *prev_lexptr;
 int paren_depth;
 int comma_terminates;
+/* APPLE LOCAL expression cache  */
+int expression_cacheable;
 
 /* A temporary buffer for identifiers, so we can null-terminate them.
 
@@ -1071,6 +1077,8 @@ parse_exp_in_context (char **stringptr, struct block *block, int comma,
   type_stack_depth = 0;
 
   comma_terminates = comma;
+  /* APPLE LOCAL expression cache  */
+  expression_cacheable = 1;
 
   if (lexptr == 0 || *lexptr == 0)
     error_no_arg (_("expression to compute"));
@@ -1152,6 +1160,163 @@ parse_expression (char *string)
 }
 
 
+/* APPLE LOCAL begin expression cache  */
+/* The IDE sends the same watch expressions to be evaluated after
+   every step, and the parse of each one - through the grammar, with
+   a symbol lookup for every name in it - costs more than evaluating
+   it.  So parse_expression_cached remembers the last few parses.
+
+   A parse depends on the text, the current language, the block names
+   are looked up in, the symbols and the settings; entries are stale
+   once symbol_generation or setting_generation moves on, and all of
+   them are dropped when an objfile is freed or the convenience
+   variables they may point to are.  Parses the parser says
+   aren't repeatable (expression_cacheable) aren't kept.  */
+
+#define PARSED_EXPRESSION_CACHE_SIZE 64
+
+struct parsed_expression_entry
+{
+  char *text;
+  const struct language_defn *language;
+  struct block *block;
+  int symbol_generation;
+  unsigned int setting_generation;
+
+  /* What innermost_block was left as by the parse.  */
+  struct block *innermost_block;
+
+  struct expression *exp;
+};
+
+extern int symbol_generation;
+
+static struct parsed_expression_entry
+  parsed_expression_cache[PARSED_EXPRESSION_CACHE_SIZE];
+
+static const struct objfile_data *parsed_expression_objfile_data;
+
+/* The symbol_generation at which every objfile was last marked with
+   parsed_expression_objfile_data.  */
+
+static int parsed_expression_objfiles_generation;
+
+static int expression_cache = 1;
+
+static void
+show_expression_cache (struct ui_file *file, int from_tty,
+		       struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Caching of parsed expressions is %s.\n"),
+		    value);
+}
+
+/* Return a copy of EXP that the caller owns.  The elements are
+   self-contained: the symbols, blocks and types they point to belong
+   to objfiles, and strings are stored inline.  */
+
+static struct expression *
+copy_expression (struct expression *exp)
+{
+  size_t size = sizeof (struct expression) + EXP_ELEM_TO_BYTES (exp->nelts);
+  struct expression *copy = xmalloc (size);
+
+  memcpy (copy, exp, size);
+  return copy;
+}
+
+void
+parsed_expression_cache_flush (void)
+{
+  int i;
+
+  for (i = 0; i < PARSED_EXPRESSION_CACHE_SIZE; i++)
+    {
+      struct parsed_expression_entry *entry = &parsed_expression_cache[i];
+
+      xfree (entry->text);
+      xfree (entry->exp);
+      memset (entry, 0, sizeof (*entry));
+    }
+}
+
+static void
+parsed_expression_objfile_freed (struct objfile *objfile, void *data)
+{
+  parsed_expression_cache_flush ();
+  parsed_expression_objfiles_generation = 0;
+}
+
+static struct parsed_expression_entry *
+parsed_expression_slot (const char *text, struct block *block)
+{
+  unsigned long hash = (unsigned long) block;
+  const char *p;
+
+  for (p = text; *p != '\0'; p++)
+    hash = hash * 31 + (unsigned char) *p;
+  hash ^= hash >> 11;
+  return &parsed_expression_cache[hash % PARSED_EXPRESSION_CACHE_SIZE];
+}
+
+/* As for parse_expression, but reuse the result of an earlier parse
+   of the same STRING in the same scope if nothing it could depend on
+   has changed.  The caller owns the result, as with
+   parse_expression.  */
+
+struct expression *
+parse_expression_cached (char *string)
+{
+  struct parsed_expression_entry *entry;
+  struct expression *exp;
+  struct block *block;
+
+  if (!expression_cache || string == NULL || *string == '\0')
+    return parse_expression (string);
+
+  block = get_selected_block (0);
+  entry = parsed_expression_slot (string, block);
+
+  if (entry->exp != NULL
+      && entry->language == current_language
+      && entry->block == block
+      && entry->symbol_generation == symbol_generation
+      && entry->setting_generation == setting_generation
+      && strcmp (entry->text, string) == 0)
+    {
+      innermost_block = entry->innermost_block;
+      return copy_expression (entry->exp);
+    }
+
+  exp = parse_expression (string);
+  if (!expression_cacheable)
+    return exp;
+
+  /* Make sure freeing any objfile the entry might point into
+     drops it.  */
+  if (parsed_expression_objfiles_generation != symbol_generation)
+    {
+      struct objfile *objfile;
+
+      ALL_OBJFILES (objfile)
+	if (objfile_data (objfile, parsed_expression_objfile_data) == NULL)
+	  set_objfile_data (objfile, parsed_expression_objfile_data, objfile);
+      parsed_expression_objfiles_generation = symbol_generation;
+    }
+
+  xfree (entry->text);
+  xfree (entry->exp);
+  entry->text = xstrdup (string);
+  entry->language = current_language;
+  entry->block = block;
+  entry->symbol_generation = symbol_generation;
+  entry->setting_generation = setting_generation;
+  entry->innermost_block = innermost_block;
+  entry->exp = copy_expression (exp);
+  return exp;
+}
+/* APPLE LOCAL end expression cache  */
+
 /* As for parse_expression, except that if VOID_CONTEXT_P, then
    no value is expected from the expression.  */
 
@@ -1406,6 +1571,8 @@ fix_references_to_optimized_out_variables (void)
 	memset (&(expout->elts[i]), 0, sizeof (union exp_element));
       expout->nelts = 4;
       expout_ptr = 4;
+      /* APPLE LOCAL expression cache: Say so again next time.  */
+      expression_cacheable = 0;
       parser_fprintf (stderr, "Unable to access variable \"%s\"\n",
 		      SYMBOL_LINKAGE_NAME (expout->elts[2].symbol));
     }
@@ -1439,4 +1606,19 @@ When non-zero, the internal representation of expressions will be printed."),
 			    NULL,
 			    show_expressiondebug,
 			    &setdebuglist, &showdebuglist);
+
+  /* APPLE LOCAL begin expression cache  */
+  parsed_expression_objfile_data
+    = register_objfile_data_with_cleanup (parsed_expression_objfile_freed);
+
+  add_setshow_boolean_cmd ("expression-cache", class_maintenance,
+			   &expression_cache, _("\
+Set whether parsed expressions are remembered."), _("\
+Show whether parsed expressions are remembered."), _("\
+When on, evaluating the same expression again in the same scope reuses\n\
+the earlier parse until symbols or settings change."),
+			   NULL, show_expression_cache,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end expression cache  */
 }
@@ -49,6 +49,14 @@ extern CORE_ADDR expression_context_pc;
    we've encountered so far. */
 extern struct block *innermost_block;
 
+/* APPLE LOCAL begin expression cache  */
+/* Set at the start of each parse; a parser clears it if the result
+   depends on more than the text, language, block, symbols and
+   settings - the exact pc's macro definitions, say - so that
+   parse_expression_cached doesn't keep it.  */
+extern int expression_cacheable;
+/* APPLE LOCAL end expression cache  */
+
 /* The block in which the most recently discovered symbol was found.
    FIXME: Should be declared along with lookup_symbol in symtab.h; is not
    related specifically to parsing.  */
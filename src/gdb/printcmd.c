@@ -44,6 +44,8 @@
 #include "block.h"
 #include "disasm.h"
 #include "objc-lang.h"
+/* APPLE LOCAL batched displays  */
+#include "exceptions.h"
 
 #ifdef TUI
 #include "tui/tui.h"		/* For tui_active et.al.   */
@@ -164,6 +166,21 @@ static void display_info (char *, int);
 
 static void do_one_display (struct display *);
 
+/* APPLE LOCAL begin batched displays  */
+/* What do_displays found when it evaluated a display ahead of time:
+   either its value, or the error evaluating it gave.  */
+
+struct display_prefetch
+{
+  int evaluated;
+  struct value *val;
+  enum errors error;
+  char *message;
+};
+
+static void do_one_display_1 (struct display *, struct display_prefetch *);
+/* APPLE LOCAL end batched displays  */
+
 static void undisplay_command (char *, int);
 
 static void free_display (struct display *);
@@ -1013,7 +1030,8 @@ print_command_1 (char *exp, int inspect, int voidprint)
     {
       /* APPLE LOCAL initialize innermost_block  */
       innermost_block = NULL;
-      expr = parse_expression (exp);
+      /* APPLE LOCAL expression cache  */
+      expr = parse_expression_cached (exp);
       old_chain = make_cleanup (free_current_contents, &expr);
       cleanup = 1;
       val = evaluate_expression (expr);
@@ -1101,7 +1119,8 @@ output_command (char *exp, int from_tty)
 
   /* APPLE LOCAL initialize innermost_block  */
   innermost_block = NULL;
-  expr = parse_expression (exp);
+  /* APPLE LOCAL expression cache  */
+  expr = parse_expression_cached (exp);
   old_chain = make_cleanup (free_current_contents, &expr);
 
   val = evaluate_expression (expr);
@@ -1126,7 +1145,8 @@ set_command (char *exp, int from_tty)
   struct cleanup *old_chain;
 
   innermost_block = NULL;
-  expr = parse_expression (exp);
+  /* APPLE LOCAL expression cache  */
+  expr = parse_expression_cached (exp);
   old_chain = make_cleanup (free_current_contents, &expr);
   /* APPLE LOCAL end initialize innermost_block  */
   evaluate_expression (expr);
@@ -1667,20 +1687,47 @@ undisplay_command (char *args, int from_tty)
    Do nothing if the display cannot be printed in the current context,
    or if the display is disabled. */
 
+/* APPLE LOCAL begin batched displays  */
+static int
+display_enabled_in_scope_p (struct display *d)
+{
+  if (d->enabled_p == 0)
+    return 0;
+
+  if (d->block)
+    return contained_in (get_selected_block (0), d->block);
+  return 1;
+}
+
 static void
 do_one_display (struct display *d)
 {
-  int within_current_scope;
+  do_one_display_1 (d, NULL);
+}
 
-  if (d->enabled_p == 0)
-    return;
+/* Return the value of D's expression: the one PRE found if it has
+   been evaluated already, otherwise a fresh evaluation.  */
 
-  if (d->block)
-    within_current_scope = contained_in (get_selected_block (0), d->block);
-  else
-    within_current_scope = 1;
-  if (!within_current_scope)
+static struct value *
+display_value (struct display *d, struct display_prefetch *pre)
+{
+  if (pre == NULL || !pre->evaluated)
+    return evaluate_expression (d->exp);
+
+  if (pre->message != NULL)
+    throw_error (pre->error, "%s", pre->message);
+  return pre->val;
+}
+
+/* As do_one_display, but use whatever PRE, if non-NULL, has already
+   found out about D's value.  */
+
+static void
+do_one_display_1 (struct display *d, struct display_prefetch *pre)
+{
+  if (!display_enabled_in_scope_p (d))
     return;
+/* APPLE LOCAL end batched displays  */
 
   current_display_number = d->number;
 
@@ -1713,7 +1760,8 @@ do_one_display (struct display *d)
       else
 	printf_filtered ("  ");
 
-      val = evaluate_expression (d->exp);
+      /* APPLE LOCAL batched displays  */
+      val = display_value (d, pre);
       addr = value_as_address (val);
       if (d->format.format == 'i')
 	addr = ADDR_BITS_REMOVE (addr);
@@ -1738,7 +1786,8 @@ do_one_display (struct display *d)
 
       annotate_display_expression ();
 
-      print_formatted (evaluate_expression (d->exp),
+      /* APPLE LOCAL batched displays  */
+      print_formatted (display_value (d, pre),
 		       d->format.format, d->format.size, gdb_stdout);
       printf_filtered ("\n");
     }
@@ -1749,17 +1798,158 @@ do_one_display (struct display *d)
   current_display_number = -1;
 }
 
+/* APPLE LOCAL begin batched displays  */
+/* Return non-zero if evaluating EXP could change the inferior or
+   gdb's state, so that it must not be evaluated ahead of the displays
+   before it.  This looks at every element, operand or not, so it can
+   only err on the side of saying yes.  */
+
+static int
+display_expression_has_side_effects (struct expression *exp)
+{
+  int i;
+
+  for (i = 0; i < exp->nelts; i++)
+    switch (exp->elts[i].opcode)
+      {
+      case OP_FUNCALL:
+      case OP_OBJC_MSGCALL:
+      case OP_F77_UNDETERMINED_ARGLIST:
+      case BINOP_ASSIGN:
+      case BINOP_ASSIGN_MODIFY:
+      case UNOP_PREINCREMENT:
+      case UNOP_POSTINCREMENT:
+      case UNOP_PREDECREMENT:
+      case UNOP_POSTDECREMENT:
+	return 1;
+      default:
+	break;
+      }
+  return 0;
+}
+
+struct display_prefetches
+{
+  int count;
+  struct display_prefetch *pre;
+};
+
+static void
+free_display_prefetches (void *arg)
+{
+  struct display_prefetches *p = arg;
+  int i;
+
+  for (i = 0; i < p->count; i++)
+    {
+      if (p->pre[i].val != NULL)
+	value_free (p->pre[i].val);
+      xfree (p->pre[i].message);
+    }
+  xfree (p->pre);
+}
+
+/* Evaluate the displays in P, in order, up to the first one with side
+   effects, and then read the memory all of the resulting lazy values
+   need with a single target_read_memory_ranges, rather than one read
+   per display as each is printed.  */
+
+static void
+prefetch_displays (struct display_prefetches *p)
+{
+  struct target_memory_range *ranges;
+  struct value **range_vals;
+  struct display *d;
+  int nranges = 0;
+  int i;
+
+  ranges = xmalloc (p->count * sizeof (struct target_memory_range));
+  make_cleanup (xfree, ranges);
+  range_vals = xmalloc (p->count * sizeof (struct value *));
+  make_cleanup (xfree, range_vals);
+
+  for (d = display_chain, i = 0; d; d = d->next, i++)
+    {
+      struct gdb_exception e;
+      struct value *val = NULL;
+
+      if (!display_enabled_in_scope_p (d))
+	continue;
+      if (display_expression_has_side_effects (d->exp))
+	break;
+
+      TRY_CATCH (e, RETURN_MASK_ERROR)
+	{
+	  val = evaluate_expression (d->exp);
+	}
+
+      p->pre[i].evaluated = 1;
+      if (e.reason < 0)
+	{
+	  p->pre[i].error = e.error;
+	  p->pre[i].message = xstrdup (e.message != NULL ? e.message : "");
+	  continue;
+	}
+
+      /* It has to outlive whatever the printing of the displays
+	 before it does with the value chain.  */
+      release_value (val);
+      p->pre[i].val = val;
+
+      if (value_lazy (val) && VALUE_LVAL (val) == lval_memory
+	  && TYPE_LENGTH (value_enclosing_type (val)) > 0)
+	{
+	  ranges[nranges].addr = VALUE_ADDRESS (val) + value_offset (val);
+	  ranges[nranges].len = TYPE_LENGTH (value_enclosing_type (val));
+	  ranges[nranges].buf = value_contents_all_raw (val);
+	  range_vals[nranges] = val;
+	  nranges++;
+	}
+    }
+
+  if (nranges == 0)
+    return;
+
+  /* Any that can't be read stay lazy, and give their usual error when
+     they are printed.  */
+  target_read_memory_ranges (ranges, nranges);
+  for (i = 0; i < nranges; i++)
+    if (ranges[i].status == 0)
+      set_value_lazy (range_vals[i], 0);
+}
+
 /* Display all of the values on the auto-display chain which can be
-   evaluated in the current scope.  */
+   evaluated in the current scope.  When there are several, they are
+   evaluated and their memory is read first, and then printed.  */
 
 void
 do_displays (void)
 {
+  struct display_prefetches p;
+  struct cleanup *old_chain;
   struct display *d;
+  int i;
 
+  p.count = 0;
   for (d = display_chain; d; d = d->next)
-    do_one_display (d);
+    p.count++;
+  if (p.count < 2)
+    {
+      for (d = display_chain; d; d = d->next)
+	do_one_display (d);
+      return;
+    }
+
+  p.pre = xcalloc (p.count, sizeof (struct display_prefetch));
+  old_chain = make_cleanup (free_display_prefetches, &p);
+  prefetch_displays (&p);
+
+  for (d = display_chain, i = 0; d; d = d->next, i++)
+    do_one_display_1 (d, &p.pre[i]);
+
+  do_cleanups (old_chain);
 }
+/* APPLE LOCAL end batched displays  */
 
 /* Delete the auto-display which we were in the process of displaying.
    This is done when there is an error or a signal.  */
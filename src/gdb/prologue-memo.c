@@ -0,0 +1,226 @@
+/* APPLE LOCAL begin prologue analysis cache. This entire file is APPLE LOCAL  */
+/* Memoization of prologue analysis results for GDB.
+
+   Copyright 2026.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.  */
+
+#include "defs.h"
+#include "objfiles.h"
+#include "gdbcmd.h"
+#include "gdb_string.h"
+#include "prologue-memo.h"
+
+/* Number of analyses remembered per objfile.  The table is direct
+   mapped; a collision simply replaces the older result.  */
+
+#define PROLOGUE_MEMO_SIZE 512
+
+struct prologue_memo_entry
+{
+  CORE_ADDR start;
+  CORE_ADDR limit;
+  int flags;
+
+  /* The value of prologue_memo_generation when this entry was
+     stored, or zero if the slot is empty.  */
+  unsigned int generation;
+
+  size_t size;
+  gdb_byte *data;
+};
+
+struct prologue_memo_table
+{
+  /* How far the objfile's text had slid when these entries were
+     stored.  If it has moved since, none of them can be trusted.  */
+  CORE_ADDR slide;
+
+  struct prologue_memo_entry entries[PROLOGUE_MEMO_SIZE];
+};
+
+static const struct objfile_data *prologue_memo_objfile_data;
+
+/* Bumped by prologue_memo_invalidate; entries from an older
+   generation are treated as empty.  */
+
+static unsigned int prologue_memo_generation = 1;
+
+static int prologue_analysis_cache = 1;
+
+static void
+show_prologue_analysis_cache (struct ui_file *file, int from_tty,
+			      struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Caching of prologue analysis results is %s.\n"),
+		    value);
+}
+
+static void
+prologue_memo_clear (struct prologue_memo_table *table)
+{
+  int i;
+
+  for (i = 0; i < PROLOGUE_MEMO_SIZE; i++)
+    {
+      xfree (table->entries[i].data);
+      table->entries[i].data = NULL;
+      table->entries[i].size = 0;
+      table->entries[i].generation = 0;
+    }
+}
+
+static void
+prologue_memo_free_table (struct objfile *objfile, void *data)
+{
+  struct prologue_memo_table *table = data;
+
+  if (table == NULL)
+    return;
+  prologue_memo_clear (table);
+  xfree (table);
+}
+
+/* Find the table for the objfile containing START, creating it if
+   CREATE.  Store the slide of START's section in *SLIDE.  */
+
+static struct prologue_memo_table *
+prologue_memo_find_table (CORE_ADDR start, int create, CORE_ADDR *slide)
+{
+  struct obj_section *osect;
+  struct prologue_memo_table *table;
+
+  if (!prologue_analysis_cache || start == 0 || start == (CORE_ADDR) -1)
+    return NULL;
+
+  osect = find_pc_section (start);
+  if (osect == NULL || osect->objfile == NULL
+      || osect->the_bfd_section == NULL)
+    return NULL;
+
+  *slide = osect->addr - bfd_section_vma (osect->objfile->obfd,
+					  osect->the_bfd_section);
+
+  table = objfile_data (osect->objfile, prologue_memo_objfile_data);
+  if (table == NULL && create)
+    {
+      table = xcalloc (1, sizeof (struct prologue_memo_table));
+      table->slide = *slide;
+      set_objfile_data (osect->objfile, prologue_memo_objfile_data, table);
+    }
+  return table;
+}
+
+static struct prologue_memo_entry *
+prologue_memo_slot (struct prologue_memo_table *table, CORE_ADDR start,
+		    CORE_ADDR limit, int flags)
+{
+  unsigned long hash;
+
+  hash = (unsigned long) (start >> 1) * 31 + (unsigned long) (limit >> 1);
+  hash = hash * 31 + (unsigned long) flags;
+  hash ^= hash >> 11;
+  return &table->entries[hash % PROLOGUE_MEMO_SIZE];
+}
+
+int
+prologue_memo_lookup (CORE_ADDR start, CORE_ADDR limit, int flags,
+		      void *result, size_t size)
+{
+  struct prologue_memo_table *table;
+  struct prologue_memo_entry *entry;
+  CORE_ADDR slide;
+
+  table = prologue_memo_find_table (start, 0, &slide);
+  if (table == NULL)
+    return 0;
+
+  if (table->slide != slide)
+    {
+      prologue_memo_clear (table);
+      table->slide = slide;
+      return 0;
+    }
+
+  entry = prologue_memo_slot (table, start, limit, flags);
+  if (entry->generation != prologue_memo_generation
+      || entry->start != start || entry->limit != limit
+      || entry->flags != flags || entry->size != size)
+    return 0;
+
+  memcpy (result, entry->data, size);
+  return 1;
+}
+
+void
+prologue_memo_store (CORE_ADDR start, CORE_ADDR limit, int flags,
+		     const void *result, size_t size)
+{
+  struct prologue_memo_table *table;
+  struct prologue_memo_entry *entry;
+  CORE_ADDR slide;
+
+  table = prologue_memo_find_table (start, 1, &slide);
+  if (table == NULL)
+    return;
+
+  if (table->slide != slide)
+    {
+      prologue_memo_clear (table);
+      table->slide = slide;
+    }
+
+  entry = prologue_memo_slot (table, start, limit, flags);
+  if (entry->size != size)
+    {
+      entry->data = xrealloc (entry->data, size);
+      entry->size = size;
+    }
+  memcpy (entry->data, result, size);
+  entry->start = start;
+  entry->limit = limit;
+  entry->flags = flags;
+  entry->generation = prologue_memo_generation;
+}
+
+void
+prologue_memo_invalidate (void)
+{
+  prologue_memo_generation++;
+  /* Don't let a wrapped counter resurrect slots marked empty.  */
+  if (prologue_memo_generation == 0)
+    prologue_memo_generation = 1;
+}
+
+void
+_initialize_prologue_memo (void)
+{
+  prologue_memo_objfile_data
+    = register_objfile_data_with_cleanup (prologue_memo_free_table);
+
+  add_setshow_boolean_cmd ("prologue-analysis-cache", class_maintenance,
+			   &prologue_analysis_cache, _("\
+Set whether prologue analysis results are remembered per function."), _("\
+Show whether prologue analysis results are remembered per function."), _("\
+When on, the result of scanning a function's prologue is kept with its\n\
+objfile and reused by later backtraces through the same function and pc."),
+			   NULL, show_prologue_analysis_cache,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+}
+/* APPLE LOCAL end prologue analysis cache  */
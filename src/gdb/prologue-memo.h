@@ -0,0 +1,63 @@
+/* APPLE LOCAL begin prologue analysis cache. This entire file is APPLE LOCAL  */
+/* Memoization of prologue analysis results for GDB.
+
+   Copyright 2026.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.  */
+
+#if !defined (PROLOGUE_MEMO_H)
+#define PROLOGUE_MEMO_H
+
+/* The prologue analyzers in the tdep files are pure functions of the
+   function's start address, the pc they are told to stop at, and the
+   bytes of the text in between.  These routines remember the result
+   of one such analysis - an opaque blob of SIZE bytes chosen by the
+   caller - in the objfile containing START, so that the next backtrace
+   through the same function doesn't have to read and decode the
+   prologue again.
+
+   FLAGS lets a caller fold any other input of its analysis (the
+   "potentially frameless" hint, the frame register it assumed, an
+   instruction set bit, ...) into the key.
+
+   The cached results are dropped when the objfile is freed, when it
+   is found to have slid since the result was stored, and whenever
+   prologue_memo_invalidate is called because the text may have been
+   rewritten underneath us.  */
+
+/* If an analysis of (START, LIMIT, FLAGS) of exactly SIZE bytes has
+   been stored, copy it into RESULT and return 1.  Otherwise return 0
+   and leave RESULT alone.  */
+
+extern int prologue_memo_lookup (CORE_ADDR start, CORE_ADDR limit,
+				 int flags, void *result, size_t size);
+
+/* Remember the SIZE bytes at RESULT as the analysis of
+   (START, LIMIT, FLAGS).  Does nothing if START isn't in a known
+   objfile or the cache is disabled.  */
+
+extern void prologue_memo_store (CORE_ADDR start, CORE_ADDR limit,
+				 int flags, const void *result, size_t size);
+
+/* Forget every stored analysis, e.g. because fix-and-continue just
+   patched the inferior's text.  */
+
+extern void prologue_memo_invalidate (void);
+
+#endif /* PROLOGUE_MEMO_H */
+/* APPLE LOCAL end prologue analysis cache  */
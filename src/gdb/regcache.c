@@ -147,11 +147,34 @@ init_regcache_descr (struct gdbarch *gdbarch)
   return descr;
 }
 
+/* APPLE LOCAL begin regcache descr cache  */
+/* register_size and friends are called for nearly every value GDB
+   unwinds or prints, nearly always for the same architecture, so
+   remember the last architecture's descr rather than going through
+   gdbarch_data each time.  A descr only exists once its architecture
+   has been fully initialized, and initialized architectures are never
+   freed, so the pair can't go stale.  */
+
+static struct gdbarch *regcache_descr_last_gdbarch;
+static struct regcache_descr *regcache_descr_last;
+
 static struct regcache_descr *
 regcache_descr (struct gdbarch *gdbarch)
 {
-  return gdbarch_data (gdbarch, regcache_descr_handle);
+  struct regcache_descr *descr;
+
+  if (gdbarch == regcache_descr_last_gdbarch)
+    return regcache_descr_last;
+
+  descr = gdbarch_data (gdbarch, regcache_descr_handle);
+  if (descr != NULL)
+    {
+      regcache_descr_last_gdbarch = gdbarch;
+      regcache_descr_last = descr;
+    }
+  return descr;
 }
+/* APPLE LOCAL end regcache descr cache  */
 
 /* Utility functions returning useful register attributes stored in
    the regcache descr.  */
@@ -453,6 +476,8 @@ registers_changed (void)
   int i;
 
   registers_ptid = pid_to_ptid (-1);
+  /* APPLE LOCAL stop generation  */
+  target_bump_stop_generation ();
 
   /* Force cleanup of any alloca areas if using C alloca instead of
      a builtin alloca.  This particular call is used to clean up
@@ -752,6 +777,9 @@ regcache_raw_write (struct regcache *regcache, int regnum,
 		  regcache->descr->sizeof_register[regnum]) == 0))
     return;
 
+  /* APPLE LOCAL stop generation  */
+  target_bump_stop_generation ();
+
   target_prepare_to_store ();
   memcpy (register_buffer (regcache, regnum), buf,
 	  regcache->descr->sizeof_register[regnum]);
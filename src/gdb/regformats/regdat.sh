@@ -129,6 +129,7 @@ offset=0
 i=0
 name=x
 expedite=x
+framechain=x
 exec < $1
 while do_read
 do
@@ -139,6 +140,9 @@ do
   elif test "${type}" = "expedite"; then
     expedite="${entry}"
     continue
+  elif test "${type}" = "framechain"; then
+    framechain="${entry}"
+    continue
   elif test "${name}" = x; then
     echo "$0: $1 does not specify \`\`name''." 1>&2
     exit 1
@@ -152,6 +156,11 @@ done
 echo "};"
 echo
 echo "const char *expedite_regs_${name}[] = { \"`echo ${expedite} | sed 's/,/", "/g'`\", 0 };"
+if test "${framechain}" = x; then
+  echo "const char *frame_chain_reg_${name} = 0;"
+else
+  echo "const char *frame_chain_reg_${name} = \"${framechain}\";"
+fi
 echo
 
 cat <<EOF
@@ -161,6 +170,7 @@ init_registers ()
     set_register_cache (regs_${name},
 			sizeof (regs_${name}) / sizeof (regs_${name}[0]));
     gdbserver_expedite_regs = expedite_regs_${name};
+    gdbserver_frame_chain_reg = frame_chain_reg_${name};
 }
 EOF
 
@@ -42,10 +42,20 @@
 #include "value.h"
 #include "gdb_assert.h"
 #include "observer.h"
+/* APPLE LOCAL thread summaries  */
+#include "hashtab.h"
 #include "solib.h"
 
 #include <ctype.h>
 #include <sys/time.h>
+/* APPLE LOCAL begin shared memory reads  */
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+/* APPLE LOCAL end shared memory reads  */
 
 #include "event-loop.h"
 #include "event-top.h"
@@ -71,6 +81,11 @@ static void cleanup_sigint_signal_handler (void *dummy);
 static void initialize_sigint_signal_handler (void);
 static int getpkt_sane (char *buf, long sizeof_buf, int forever);
 
+/* APPLE LOCAL: The number of characters in the last packet
+   getpkt_sane read, not counting the trailing NUL.  Binary replies
+   may contain NULs, so strlen won't do for them.  */
+static long remote_last_packet_length;
+
 static void handle_remote_sigint (int);
 static void handle_remote_sigint_twice (int);
 static void async_remote_interrupt (gdb_client_data);
@@ -99,6 +114,9 @@ static void remote_open_1 (char *, int, struct target_ops *, int extended_p,
 
 static void remote_close (int quitting);
 
+/* APPLE LOCAL shared memory reads  */
+static void remote_shm_release (void);
+
 static void remote_store_registers (int regno);
 
 static void remote_mourn (void);
@@ -188,6 +206,21 @@ static int putpkt_binary (char *buf, int cnt);
 
 static void check_binary_download (CORE_ADDR addr);
 
+/* APPLE LOCAL binary memory reads  */
+static void check_binary_read (CORE_ADDR addr);
+
+/* APPLE LOCAL begin incremental async packets  */
+static void remote_async_packet_reset (void);
+
+static int remote_async_packet_take (char *buf, long sizeof_buf);
+/* APPLE LOCAL end incremental async packets  */
+
+/* APPLE LOCAL stop reply memory  */
+static void remote_flush_stop_memory (void);
+
+/* APPLE LOCAL thread summaries  */
+static void remote_flush_thread_summaries (void);
+
 struct packet_config;
 
 static void show_packet_config_cmd (struct packet_config *config);
@@ -201,6 +234,9 @@ static int remote_macosx_query_qenvironment_hex_packet_supported ();
 /* APPLE LOCAL */
 static void start_remote_timer (void);
 static void end_remote_timer (void);
+/* APPLE LOCAL remote wire stats  */
+static int remote_packet_type_len (const char *buf, int len);
+static int remote_packet_expects_reply (const char *buf, int len);
 static void initialize_protocol_log (void);
 
 /* Description of the remote protocol.  Strictly speaking, when the
@@ -251,6 +287,8 @@ struct remote_state
 struct remote_stats *current_remote_stats = NULL;
 uint64_t total_packets_sent = 0;
 uint64_t total_packets_received = 0;
+/* APPLE LOCAL remote wire stats  */
+static struct remote_wire_stats remote_protocol_wire_stats;
 char *remote_debugflags = NULL;
 
 #define PROTOCOL_LOG_BUFSIZE 3072
@@ -764,6 +802,39 @@ show_memory_read_packet_size (char *args, int from_tty)
   show_memory_packet_size (&memory_read_packet_config);
 }
 
+/* APPLE LOCAL begin pipelined memory reads  */
+/* The most memory-read packets remote_read_bytes keeps outstanding
+   at once, each asking for as much as fits in a memory-read packet.
+   Only used in no-ack mode; with acks, a reply could arrive while
+   putpkt is waiting for the ack of the next request.  */
+static int remote_memory_read_pipeline_depth = 4;
+static void
+show_remote_memory_read_pipeline_depth (struct ui_file *file, int from_tty,
+					struct cmd_list_element *c,
+					const char *value)
+{
+  fprintf_filtered (file, _("\
+The number of memory-read packets kept in flight is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end pipelined memory reads  */
+
+/* APPLE LOCAL begin pipelined memory writes  */
+/* Likewise, the most memory-write packets remote_write_bytes keeps
+   outstanding at once when writing more than fits in one, as "load"
+   does.  */
+static int remote_memory_write_pipeline_depth = 8;
+static void
+show_remote_memory_write_pipeline_depth (struct ui_file *file, int from_tty,
+					 struct cmd_list_element *c,
+					 const char *value)
+{
+  fprintf_filtered (file, _("\
+The number of memory-write packets kept in flight is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end pipelined memory writes  */
+
 static long
 get_memory_read_packet_size (void)
 {
@@ -1322,6 +1393,8 @@ static struct packet_config remote_protocol_binary_download;
 
 static int use_threadinfo_query;
 static int use_threadextra_query;
+/* APPLE LOCAL: Likewise for "qfThreadSummary".  */
+static int use_thread_summary_query;
 
 static void
 set_remote_protocol_binary_download_cmd (char *args,
@@ -1339,6 +1412,80 @@ show_remote_protocol_binary_download_cmd (struct ui_file *file, int from_tty,
   show_packet_config_cmd (&remote_protocol_binary_download);
 }
 
+/* APPLE LOCAL begin binary memory reads  */
+/* Should we try the 'x' (remote binary memory read) packet?
+
+   This variable (available to the user via "set remote
+   binary-read-packet") dictates whether memory reads ask for binary
+   replies, which are half the size of the hex 'm' replies and may be
+   run-length encoded.  Like 'X', this is auto-detected the first
+   time memory is read.  */
+
+static struct packet_config remote_protocol_binary_read;
+
+static void
+set_remote_protocol_binary_read_cmd (char *args, int from_tty,
+				     struct cmd_list_element *c)
+{
+  update_packet_config (&remote_protocol_binary_read);
+}
+
+static void
+show_remote_protocol_binary_read_cmd (struct ui_file *file, int from_tty,
+				      struct cmd_list_element *c,
+				      const char *value)
+{
+  show_packet_config_cmd (&remote_protocol_binary_read);
+}
+/* APPLE LOCAL end binary memory reads  */
+
+/* APPLE LOCAL begin shared memory reads  */
+/* This variable (available to the user via "set remote
+   shared-memory-packet") dictates whether memory reads are passed
+   through a mapping shared with the stub, when gdb and the stub run
+   on the same machine.  Detected the first time memory is read.  */
+
+static struct packet_config remote_protocol_shared_memory;
+
+static void
+set_remote_protocol_shared_memory_cmd (char *args, int from_tty,
+				       struct cmd_list_element *c)
+{
+  update_packet_config (&remote_protocol_shared_memory);
+}
+
+static void
+show_remote_protocol_shared_memory_cmd (struct ui_file *file, int from_tty,
+					struct cmd_list_element *c,
+					const char *value)
+{
+  show_packet_config_cmd (&remote_protocol_shared_memory);
+}
+/* APPLE LOCAL end shared memory reads  */
+
+/* APPLE LOCAL begin memory search  */
+/* Should "find" ask the stub to search memory itself, with the
+   'qSearch:memory' request, rather than reading it all over the
+   link?  */
+static struct packet_config remote_protocol_qSearch_memory;
+
+static void
+set_remote_protocol_qSearch_memory_packet_cmd (char *args, int from_tty,
+					       struct cmd_list_element *c)
+{
+  update_packet_config (&remote_protocol_qSearch_memory);
+}
+
+static void
+show_remote_protocol_qSearch_memory_packet_cmd (struct ui_file *file,
+						int from_tty,
+						struct cmd_list_element *c,
+						const char *value)
+{
+  show_packet_config_cmd (&remote_protocol_qSearch_memory);
+}
+/* APPLE LOCAL end memory search  */
+
 /* Should we try the 'qPart:auxv' (target auxiliary vector read) request?  */
 static struct packet_config remote_protocol_qPart_auxv;
 
@@ -2205,6 +2352,207 @@ remote_find_new_threads (void)
     inferior_ptid = remote_current_thread (inferior_ptid);
 }
 
+/* APPLE LOCAL begin thread summaries  */
+/* What the stub told us about a thread in its reply to
+   qfThreadSummary/qsThreadSummary: the registers it expedites (PC,
+   SP and FP, usually) and the thread's name.  With these, "info
+   threads" and "thread apply all bt" don't need a qThreadExtraInfo,
+   an Hg and a register fetch for each thread.  The summaries are
+   only good until the target resumes or we store registers.  */
+
+#define REMOTE_SUMMARY_MAX_REGS 8
+
+struct remote_thread_summary
+{
+  int tid;
+  int nregs;
+  int regnum[REMOTE_SUMMARY_MAX_REGS];
+  gdb_byte value[REMOTE_SUMMARY_MAX_REGS][MAX_REGISTER_SIZE];
+  char *name;
+};
+
+static htab_t remote_thread_summaries;
+
+static hashval_t
+remote_thread_summary_hash (const void *p)
+{
+  const struct remote_thread_summary *ts = p;
+  return ts->tid;
+}
+
+static int
+remote_thread_summary_eq (const void *a, const void *b)
+{
+  const struct remote_thread_summary *lhs = a;
+  const struct remote_thread_summary *rhs = b;
+  return lhs->tid == rhs->tid;
+}
+
+static void
+remote_thread_summary_del (void *p)
+{
+  struct remote_thread_summary *ts = p;
+  xfree (ts->name);
+  xfree (ts);
+}
+
+static void
+remote_flush_thread_summaries (void)
+{
+  if (remote_thread_summaries != NULL)
+    htab_empty (remote_thread_summaries);
+}
+
+/* Return the summary for thread TID, creating an empty one if
+   CREATE.  */
+
+static struct remote_thread_summary *
+remote_lookup_thread_summary (int tid, int create)
+{
+  struct remote_thread_summary key;
+  void **slot;
+
+  if (remote_thread_summaries == NULL)
+    {
+      if (!create)
+	return NULL;
+      remote_thread_summaries
+	= htab_create_alloc (256, remote_thread_summary_hash,
+			     remote_thread_summary_eq,
+			     remote_thread_summary_del, xcalloc, xfree);
+    }
+
+  key.tid = tid;
+  slot = htab_find_slot (remote_thread_summaries, &key,
+			 create ? INSERT : NO_INSERT);
+  if (slot == NULL)
+    return NULL;
+  if (*slot == NULL)
+    {
+      struct remote_thread_summary *ts = XZALLOC (struct remote_thread_summary);
+      ts->tid = tid;
+      *slot = ts;
+    }
+  return *slot;
+}
+
+/* Parse one reply to qfThreadSummary or qsThreadSummary, in BUF, and
+   add the threads it names to the thread list.  The reply is an 'm'
+   followed by fields in the style of a 'T' stop reply: a
+   "thread:TID;" field starts each thread, and is followed by
+   "NN:VALUE;" fields for its registers and a "name:HEX;" field.  */
+
+static void
+remote_parse_thread_summary (char *buf)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct remote_thread_summary *ts = NULL;
+  char *p = buf + 1;
+
+  while (*p)
+    {
+      char *p1 = strchr (p, ':');
+      char *end = strchr (p, ';');
+      char *p_temp;
+      long pnum;
+
+      if (p1 == NULL || end == NULL || p1 > end)
+	{
+	  warning (_("Malformed thread summary: %s"), buf);
+	  return;
+	}
+
+      pnum = strtol (p, &p_temp, 16);
+      if (p_temp == p1 && p_temp != p)
+	{
+	  struct packet_reg *reg = packet_reg_from_pnum (rs, pnum);
+
+	  if (ts != NULL && reg != NULL
+	      && ts->nregs < REMOTE_SUMMARY_MAX_REGS)
+	    {
+	      int size = register_size (current_gdbarch, reg->regnum);
+	      if (hex2bin (p1 + 1, (char *) ts->value[ts->nregs], size) == size)
+		ts->regnum[ts->nregs++] = reg->regnum;
+	    }
+	}
+      else if (p1 - p == 6 && strncmp (p, "thread", 6) == 0)
+	{
+	  ULONGEST tid;
+
+	  unpack_varlen_hex (p1 + 1, &tid);
+	  ts = NULL;
+	  if (tid != 0)
+	    {
+	      ts = remote_lookup_thread_summary ((int) tid, 1);
+	      ts->nregs = 0;
+	      if (!in_thread_list (ptid_build (tid, 0, tid)))
+		add_thread (ptid_build (tid, 0, tid));
+	    }
+	}
+      else if (p1 - p == 4 && strncmp (p, "name", 4) == 0 && ts != NULL)
+	{
+	  int n = (end - p1 - 1) / 2;
+
+	  xfree (ts->name);
+	  ts->name = xmalloc (n + 1);
+	  n = hex2bin (p1 + 1, ts->name, n);
+	  ts->name[n] = '\0';
+	}
+      /* Silently skip anything else.  */
+
+      p = end + 1;
+    }
+}
+
+/* Fetch summaries of all the threads with qfThreadSummary.  Return
+   zero if the stub doesn't know the packet.  */
+
+static int
+remote_get_thread_summaries (void)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *buf = alloca (rs->remote_packet_size);
+
+  remote_flush_thread_summaries ();
+
+  putpkt ("qfThreadSummary");
+  getpkt (buf, (rs->remote_packet_size), 0);
+  if (buf[0] == '\0')
+    return 0;
+
+  while (buf[0] == 'm')
+    {
+      remote_parse_thread_summary (buf);
+      putpkt ("qsThreadSummary");
+      getpkt (buf, (rs->remote_packet_size), 0);
+    }
+  return 1;
+}
+
+/* If we have a summary for thread TID, supply the registers in it to
+   the regcache.  Return non-zero if REGNUM was one of them.  */
+
+static int
+remote_supply_thread_summary (int tid, int regnum)
+{
+  struct remote_thread_summary *ts;
+  int found = 0;
+  int i;
+
+  ts = remote_lookup_thread_summary (tid, 0);
+  if (ts == NULL)
+    return 0;
+
+  for (i = 0; i < ts->nregs; i++)
+    {
+      regcache_raw_supply (current_regcache, ts->regnum[i], ts->value[i]);
+      if (ts->regnum[i] == regnum)
+	found = 1;
+    }
+  return found;
+}
+/* APPLE LOCAL end thread summaries  */
+
 /*
  * Find all threads for info threads command.
  * Uses new thread protocol contributed by Cisco.
@@ -2223,6 +2571,15 @@ remote_threads_info (void)
   if (remote_desc == 0)		/* paranoia */
     error (_("Command can only be used when connected to the remote target."));
 
+  /* APPLE LOCAL begin thread summaries  */
+  if (use_thread_summary_query)
+    {
+      if (remote_get_thread_summaries ())
+	return;
+      use_thread_summary_query = 0;
+    }
+  /* APPLE LOCAL end thread summaries  */
+
   if (use_threadinfo_query)
     {
       putpkt ("qfThreadInfo");
@@ -2284,6 +2641,19 @@ remote_threads_extra_info (struct thread_info *tp)
     internal_error (__FILE__, __LINE__,
 		    _("remote_threads_extra_info"));
 
+  /* APPLE LOCAL begin thread summaries  */
+  {
+    struct remote_thread_summary *ts;
+
+    ts = remote_lookup_thread_summary (PIDGET (tp->ptid), 0);
+    if (ts != NULL && ts->name != NULL && ts->name[0] != '\0')
+      {
+	xsnprintf (display_buf, sizeof (display_buf), "Name: %s", ts->name);
+	return display_buf;
+      }
+  }
+  /* APPLE LOCAL end thread summaries  */
+
   if (use_threadextra_query)
     {
       xsnprintf (bufp, rs->remote_packet_size, "qThreadExtraInfo,%x", 
@@ -2357,6 +2727,10 @@ remote_close (int quitting)
   if (remote_desc)
     serial_close (remote_desc);
   remote_desc = NULL;
+  /* APPLE LOCAL incremental async packets  */
+  remote_async_packet_reset ();
+  /* APPLE LOCAL shared memory reads  */
+  remote_shm_release ();
 }
 
 /* Query the remote side for the text, data and bss offsets.  */
@@ -2556,6 +2930,12 @@ init_all_packet_configs (void)
   /* Force remote_write_bytes to check whether target supports binary
      downloading.  */
   update_packet_config (&remote_protocol_binary_download);
+  /* APPLE LOCAL binary memory reads  */
+  update_packet_config (&remote_protocol_binary_read);
+  /* APPLE LOCAL shared memory reads  */
+  update_packet_config (&remote_protocol_shared_memory);
+  /* APPLE LOCAL memory search  */
+  update_packet_config (&remote_protocol_qSearch_memory);
   update_packet_config (&remote_protocol_qPart_auxv);
   update_packet_config (&remote_protocol_qGetTLSAddr);
 }
@@ -2673,12 +3053,18 @@ remote_open_1 (char *name, int from_tty, struct target_ops *target,
   push_target (target);		/* Switch to using remote target now.  */
 
   init_all_packet_configs ();
+  /* APPLE LOCAL stop reply memory  */
+  remote_flush_stop_memory ();
+  /* APPLE LOCAL thread summaries  */
+  remote_flush_thread_summaries ();
 
   general_thread = -2;
   continue_thread = -2;
 
   /* Probe for ability to use "ThreadInfo" query, as required.  */
   use_threadinfo_query = 1;
+  /* APPLE LOCAL thread summaries  */
+  use_thread_summary_query = 1;
   use_threadextra_query = 1;
 
   /* Without this, some commands which require an active target (such
@@ -3026,6 +3412,91 @@ remote_vcont_resume (ptid_t ptid, int step, enum target_signal siggnal)
   return 1;
 }
 
+/* APPLE LOCAL begin stop reply memory  */
+/* Memory the stub sent along with the last stop reply, as
+   "memory:ADDR=XX...;" fields.  gdbserver sends the frame pointer
+   chain for the first few frames this way, so unwinding after a
+   stop or a step doesn't need a round trip per frame.  The contents
+   are only good until the target resumes or we write memory.  */
+
+#define REMOTE_STOP_MEMORY_MAX 32
+#define REMOTE_STOP_MEMORY_SIZE 32
+
+struct remote_stop_memory
+{
+  CORE_ADDR addr;
+  int len;
+  gdb_byte contents[REMOTE_STOP_MEMORY_SIZE];
+};
+
+static struct remote_stop_memory remote_stop_memory[REMOTE_STOP_MEMORY_MAX];
+static int remote_stop_memory_count;
+
+static void
+remote_flush_stop_memory (void)
+{
+  remote_stop_memory_count = 0;
+}
+
+/* Record the memory in a "memory:" field of stop reply BUF.  P points
+   just past the colon.  Return a pointer to the ';' that ends the
+   field.  */
+
+static char *
+remote_record_stop_memory (char *p, char *buf)
+{
+  struct remote_stop_memory *mem;
+  ULONGEST addr;
+  char *end;
+
+  end = strchr (p, ';');
+  if (end == NULL)
+    error (_("Malformed packet (missing semicolon): %s\n\
+Packet: '%s'\n"),
+	   p, buf);
+
+  p = unpack_varlen_hex (p, &addr);
+  if (*p != '=')
+    {
+      warning (_("Malformed stop reply memory: %s"), buf);
+      return end;
+    }
+  p++;
+
+  if (remote_stop_memory_count >= REMOTE_STOP_MEMORY_MAX)
+    return end;
+  mem = &remote_stop_memory[remote_stop_memory_count];
+  mem->addr = (CORE_ADDR) addr;
+  mem->len = hex2bin (p, (char *) mem->contents,
+		      min ((end - p) / 2, REMOTE_STOP_MEMORY_SIZE));
+  if (mem->len > 0)
+    remote_stop_memory_count++;
+  return end;
+}
+
+/* If the LEN bytes at MEMADDR all came with the last stop reply,
+   copy them to MYADDR and return non-zero.  */
+
+static int
+remote_lookup_stop_memory (CORE_ADDR memaddr, char *myaddr, int len)
+{
+  int i;
+
+  for (i = 0; i < remote_stop_memory_count; i++)
+    {
+      struct remote_stop_memory *mem = &remote_stop_memory[i];
+
+      if (memaddr >= mem->addr
+	  && memaddr + len <= mem->addr + mem->len)
+	{
+	  memcpy (myaddr, mem->contents + (memaddr - mem->addr), len);
+	  return 1;
+	}
+    }
+  return 0;
+}
+/* APPLE LOCAL end stop reply memory  */
+
 /* Tell the remote machine to resume.  */
 
 static enum target_signal last_sent_signal = TARGET_SIGNAL_0;
@@ -3042,6 +3513,13 @@ remote_resume (ptid_t ptid, int step, enum target_signal siggnal)
   last_sent_signal = siggnal;
   last_sent_step = step;
 
+  /* APPLE LOCAL stop reply memory  */
+  remote_flush_stop_memory ();
+  /* APPLE LOCAL thread summaries  */
+  remote_flush_thread_summaries ();
+  /* APPLE LOCAL remote wire stats  */
+  remote_wire_stats_stopped (&remote_protocol_wire_stats, 0);
+
   /* A hook for when we need to do something at the last moment before
      resumption.  */
   if (deprecated_target_resume_hook)
@@ -3428,6 +3906,11 @@ Packet: '%s'\n"),
                 mach_exc_data_index++;
               }
             /* APPLE LOCAL END: mach exception info.  */
+            /* APPLE LOCAL stop reply memory  */
+            else if (strncmp (p, "memory", p1 - p) == 0)
+              {
+                p = remote_record_stop_memory (++p1, buf);
+              }
 		    else
  		      {
  			/* Silently skip unknown optional info.  */
@@ -3519,6 +4002,9 @@ Packet: '%s'\n"),
 	}
     }
 got_status:
+  /* APPLE LOCAL remote wire stats  */
+  remote_wire_stats_stopped (&remote_protocol_wire_stats,
+			     status->kind == TARGET_WAITKIND_STOPPED);
   if (thread_num != -1)
     {
       return ptid_build (thread_num, 0, thread_num);
@@ -3624,6 +4110,9 @@ Packet: '%s'\n"),
 			p = unpack_varlen_hex (++p1, &addr);
 			remote_watch_data_address = (CORE_ADDR)addr;
 		      }
+		    /* APPLE LOCAL stop reply memory  */
+		    else if (strncmp (p, "memory", p1 - p) == 0)
+		      p = remote_record_stop_memory (++p1, buf);
 		    else
  		      {
  			/* Silently skip unknown optional info.  */
@@ -3717,6 +4206,9 @@ Packet: '%s'\n"),
 	}
     }
 got_status:
+  /* APPLE LOCAL remote wire stats  */
+  remote_wire_stats_stopped (&remote_protocol_wire_stats,
+			     status->kind == TARGET_WAITKIND_STOPPED);
   if (thread_num != -1)
     {
       return ptid_build (thread_num, 0, thread_num);
@@ -3785,6 +4277,12 @@ remote_fetch_registers (int regnum)
   char *p;
   char *regs = alloca (rs->sizeof_g_packet);
 
+  /* APPLE LOCAL: If "info threads" got this register for us, we
+     don't need to switch threads to ask for it.  */
+  if (regnum >= 0
+      && remote_supply_thread_summary (PIDGET (inferior_ptid), regnum))
+    return;
+
   set_thread (PIDGET (inferior_ptid), 1);
 
   if (regnum >= 0)
@@ -3969,6 +4467,9 @@ remote_store_registers (int regnum)
   char *regs;
   char *p;
 
+  /* APPLE LOCAL thread summaries  */
+  remote_flush_thread_summaries ();
+
   set_thread (PIDGET (inferior_ptid), 1);
 
   if (regnum >= 0)
@@ -4139,37 +4640,102 @@ check_binary_download (CORE_ADDR addr)
     }
 }
 
-/* Write memory data directly to the remote machine.
-   This does not inform the data cache; the data cache uses this.
-   MEMADDR is the address in the remote memory space.
-   MYADDR is the address of the buffer in our space.
-   LEN is the number of bytes.
+/* APPLE LOCAL begin binary memory reads  */
+/* Determine whether the remote target supports binary memory reads,
+   by asking for zero bytes at ADDR with an 'x' packet.  A stub that
+   knows the packet answers with a bare "b"; anything else, including
+   an error, means we stay with 'm'.  */
 
-   Returns number of bytes transferred, or 0 (setting errno) for
-   error.  Only transfer a single packet.  */
+static void
+check_binary_read (CORE_ADDR addr)
+{
+  struct remote_state *rs = get_remote_state ();
+  switch (remote_protocol_binary_read.support)
+    {
+    case PACKET_DISABLE:
+      break;
+    case PACKET_ENABLE:
+      break;
+    case PACKET_SUPPORT_UNKNOWN:
+      {
+	char *buf = alloca (rs->remote_packet_size);
+	char *p;
 
-int
-remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr, int len)
+	p = buf;
+	*p++ = 'x';
+	p += hexnumstr (p, (ULONGEST) remote_address_masked (addr));
+	*p++ = ',';
+	p += hexnumstr (p, (ULONGEST) 0);
+	*p = '\0';
+
+	putpkt (buf);
+	getpkt (buf, (rs->remote_packet_size), 0);
+
+	if (strcmp (buf, "b") != 0)
+	  {
+	    if (remote_debug)
+	      fprintf_unfiltered (gdb_stdlog,
+				  "binary memory reads NOT supported by target\n");
+	    remote_protocol_binary_read.support = PACKET_DISABLE;
+	  }
+	else
+	  {
+	    if (remote_debug)
+	      fprintf_unfiltered (gdb_stdlog,
+				  "binary memory reads supported by target\n");
+	    remote_protocol_binary_read.support = PACKET_ENABLE;
+	  }
+	break;
+      }
+    }
+}
+
+/* Copy the binary data in the LEN bytes at BUF, an 'x' reply with
+   its leading 'b' stripped, into MYADDR, undoing the escapes.  At
+   most TODO bytes are stored.  Returns the number stored.  */
+
+static int
+remote_unescape_binary (const char *buf, int len, gdb_byte *myaddr, int todo)
+{
+  int i = 0;
+  int nr_bytes = 0;
+
+  while (i < len && nr_bytes < todo)
+    {
+      if (buf[i] == 0x7d)
+	{
+	  if (i + 1 >= len)
+	    break;
+	  myaddr[nr_bytes++] = (buf[i + 1] & 0xff) ^ 0x20;
+	  i += 2;
+	}
+      else
+	myaddr[nr_bytes++] = buf[i++] & 0xff;
+    }
+  return nr_bytes;
+}
+/* APPLE LOCAL end binary memory reads  */
+
+/* APPLE LOCAL begin pipelined memory writes  */
+/* Build in BUF the packet that writes as much as fits of the LEN bytes
+   at MYADDR to MEMADDR.  BUF must have room for
+   get_memory_write_packet_size () + 1 characters.  Store the number
+   of bytes the packet carries in *NR_BYTESP and return the length of
+   the packet.  */
+
+static int
+remote_build_write_packet (CORE_ADDR memaddr, const gdb_byte *myaddr,
+			   int len, char *buf, int *nr_bytesp)
 {
-  char *buf;
   char *p;
   char *plen;
-  long sizeof_buf;
   int plenlen;
   int todo;
   int nr_bytes;
   int payload_size;
   char *payload_start;
 
-  /* Verify that the target can support a binary download.  */
-  check_binary_download (memaddr);
-
   payload_size = get_memory_write_packet_size ();
-  
-  /* Compute the size, and then allocate space for the largest
-     possible packet.  Include space for an extra trailing NUL.  */
-  sizeof_buf = payload_size + 1;
-  buf = alloca (sizeof_buf);
 
   /* Compute the size of the actual payload by subtracting out the
      packet header and footer overhead: "$M<memaddr>,<len>:...#nn".
@@ -4275,11 +4841,112 @@ remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr, int len)
       internal_error (__FILE__, __LINE__, _("bad switch"));
     }
 
-  putpkt_binary (buf, (int) (p - buf));
-  getpkt (buf, sizeof_buf, 0);
+  *nr_bytesp = nr_bytes;
+  return p - buf;
+}
 
-  if (buf[0] == 'E')
-    {
+/* Write LEN bytes from MYADDR to MEMADDR with as many memory-write
+   packets as it takes, keeping up to remote_memory_write_pipeline_depth
+   of them outstanding before reading the first reply, so that a
+   download isn't paced by the round trip time of the link.  BUF, of
+   SIZEOF_BUF characters, is used for building packets and reading
+   replies.  Returns the number of bytes written before the first
+   packet the stub refused, setting errno to EIO if that was the very
+   first one.  Only valid in no-ack mode.  */
+
+static int
+remote_write_bytes_pipelined (CORE_ADDR memaddr, const gdb_byte *myaddr,
+			      int len, char *buf, long sizeof_buf)
+{
+  int depth = remote_memory_write_pipeline_depth;
+  int *sizes = alloca (depth * sizeof (int));
+  int in_flight = 0;		/* Packets sent but not answered.  */
+  int first = 0;		/* Slot of the oldest of those.  */
+  int sent = 0;			/* Bytes sent so far.  */
+  int written = 0;		/* Bytes the stub has acknowledged.  */
+  int failed = 0;
+
+  while (!failed && (sent < len || in_flight > 0))
+    {
+      while (in_flight < depth && sent < len)
+	{
+	  int nr_bytes;
+	  int pktlen;
+
+	  pktlen = remote_build_write_packet (memaddr + sent, myaddr + sent,
+					      len - sent, buf, &nr_bytes);
+	  putpkt_binary (buf, pktlen);
+	  sizes[(first + in_flight) % depth] = nr_bytes;
+	  in_flight++;
+	  sent += nr_bytes;
+	}
+
+      /* Replies come back in the order the packets went out.  */
+      getpkt (buf, sizeof_buf, 0);
+      if (buf[0] == 'E')
+	failed = 1;
+      else
+	written += sizes[first];
+      first = (first + 1) % depth;
+      in_flight--;
+    }
+
+  /* Don't let the replies to packets past a failure be taken for
+     the answer to some later packet.  */
+  while (in_flight > 0)
+    {
+      getpkt (buf, sizeof_buf, 0);
+      in_flight--;
+    }
+
+  if (written == 0 && failed)
+    errno = EIO;
+  return written;
+}
+/* APPLE LOCAL end pipelined memory writes  */
+
+/* Write memory data directly to the remote machine.
+   This does not inform the data cache; the data cache uses this.
+   MEMADDR is the address in the remote memory space.
+   MYADDR is the address of the buffer in our space.
+   LEN is the number of bytes.
+
+   Returns number of bytes transferred, or 0 (setting errno) for
+   error.  Only transfer a single packet, unless in no-ack mode where
+   several can be kept in flight.  */
+
+int
+remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr, int len)
+{
+  char *buf;
+  long sizeof_buf;
+  int nr_bytes;
+  int pktlen;
+
+  /* Verify that the target can support a binary download.  */
+  check_binary_download (memaddr);
+
+  /* APPLE LOCAL stop reply memory  */
+  remote_flush_stop_memory ();
+
+  /* Allocate space for the largest possible packet.  Include space
+     for an extra trailing NUL.  */
+  sizeof_buf = get_memory_write_packet_size () + 1;
+  buf = alloca (sizeof_buf);
+
+  /* APPLE LOCAL begin pipelined memory writes  */
+  if (no_ack_mode && remote_memory_write_pipeline_depth > 1)
+    return remote_write_bytes_pipelined (memaddr, myaddr, len, buf,
+					 sizeof_buf);
+
+  pktlen = remote_build_write_packet (memaddr, myaddr, len, buf, &nr_bytes);
+  /* APPLE LOCAL end pipelined memory writes  */
+
+  putpkt_binary (buf, pktlen);
+  getpkt (buf, sizeof_buf, 0);
+
+  if (buf[0] == 'E')
+    {
       /* There is no correspondance between what the remote protocol
 	 uses for errors and errno codes.  We would like a cleaner way
 	 of representing errors (big enough to include errno codes,
@@ -4308,6 +4975,165 @@ remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr, int len)
    caller and its callers caller ;-) already contains code for
    handling partial reads.  */
 
+/* APPLE LOCAL begin shared memory reads  */
+/* When gdb and the stub run on the same machine, memory reads can skip
+   the packet encoding altogether.  gdb creates a file, maps it and
+   sends its name in a "vShmOpen" packet; a stub that can map the same
+   file answers OK.  From then on gdb asks for memory with
+   "vShmRead;ADDR,LENGTH", and the stub copies the memory into the
+   mapping and replies with how many bytes it stored.  Only those short
+   packets cross the connection, so requests stay ordered and errors
+   are reported the way 'm' reports them.  The file is removed as soon
+   as the stub has answered; the two mappings keep it alive.  */
+
+/* How big a mapping gdb offers, and so the most one request reads.  */
+#define REMOTE_SHM_SIZE (1024 * 1024)
+
+static gdb_byte *remote_shm_base;
+static int remote_shm_size;
+
+static void
+remote_shm_release (void)
+{
+#ifdef HAVE_MMAP
+  if (remote_shm_base != NULL)
+    munmap (remote_shm_base, remote_shm_size);
+#endif
+  remote_shm_base = NULL;
+  remote_shm_size = 0;
+}
+
+/* Offer the stub a shared mapping.  Return nonzero if it took it.  */
+
+static int
+remote_shm_offer (void)
+{
+#ifdef HAVE_MMAP
+  struct remote_state *rs = get_remote_state ();
+  char *buf = alloca (rs->remote_packet_size);
+  char path[64];
+  gdb_byte *base;
+  char *p;
+  int fd;
+
+  xsnprintf (path, sizeof (path), "/tmp/gdb-shm-%d-XXXXXX", (int) getpid ());
+  fd = mkstemp (path);
+  if (fd < 0)
+    return 0;
+  if (ftruncate (fd, REMOTE_SHM_SIZE) != 0)
+    {
+      close (fd);
+      unlink (path);
+      return 0;
+    }
+  base = mmap (NULL, REMOTE_SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+	       fd, 0);
+  close (fd);
+  if (base == (gdb_byte *) MAP_FAILED)
+    {
+      unlink (path);
+      return 0;
+    }
+
+  p = buf;
+  strcpy (p, "vShmOpen;");
+  p += strlen (p);
+  p += bin2hex (path, p, 0);
+  *p++ = ',';
+  p += hexnumstr (p, (ULONGEST) REMOTE_SHM_SIZE);
+  *p = '\0';
+
+  putpkt (buf);
+  getpkt (buf, (rs->remote_packet_size), 0);
+  unlink (path);
+
+  if (strcmp (buf, "OK") == 0)
+    {
+      remote_shm_base = base;
+      remote_shm_size = REMOTE_SHM_SIZE;
+      return 1;
+    }
+  munmap (base, REMOTE_SHM_SIZE);
+#endif
+  return 0;
+}
+
+/* Return nonzero if memory reads should go through the shared
+   mapping, setting it up the first time we are asked.  */
+
+static int
+check_shared_memory (void)
+{
+  if (remote_protocol_shared_memory.support == PACKET_DISABLE)
+    return 0;
+  if (remote_shm_base != NULL)
+    return 1;
+
+  if (remote_shm_offer ())
+    {
+      if (remote_debug)
+	fprintf_unfiltered (gdb_stdlog,
+			    "shared memory reads supported by target\n");
+      remote_protocol_shared_memory.support = PACKET_ENABLE;
+      return 1;
+    }
+
+  if (remote_debug)
+    fprintf_unfiltered (gdb_stdlog,
+			"shared memory reads NOT supported by target\n");
+  if (remote_protocol_shared_memory.detect == AUTO_BOOLEAN_TRUE)
+    warning (_("The remote target could not map gdb's shared memory; "
+	       "reading memory through packets."));
+  remote_protocol_shared_memory.support = PACKET_DISABLE;
+  return 0;
+}
+
+/* Read LEN bytes at MEMADDR into MYADDR through the shared mapping.
+   Returns the number of bytes read, or 0 with errno set.  */
+
+static int
+remote_read_bytes_shared (CORE_ADDR memaddr, gdb_byte *myaddr, int len)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *buf = alloca (rs->remote_packet_size);
+  int done = 0;
+
+  while (done < len)
+    {
+      int todo = min (len - done, remote_shm_size);
+      ULONGEST got;
+      char *p;
+
+      p = buf;
+      strcpy (p, "vShmRead;");
+      p += strlen (p);
+      p += hexnumstr (p, (ULONGEST) remote_address_masked (memaddr + done));
+      *p++ = ',';
+      p += hexnumstr (p, (ULONGEST) todo);
+      *p = '\0';
+
+      putpkt (buf);
+      getpkt (buf, (rs->remote_packet_size), 0);
+
+      if (buf[0] != 'L')
+	{
+	  if (done == 0)
+	    errno = EIO;
+	  break;
+	}
+      unpack_varlen_hex (buf + 1, &got);
+      if (got > todo)
+	got = todo;
+      memcpy (myaddr + done, remote_shm_base, got);
+      done += got;
+      if (got < todo)
+	break;
+    }
+
+  return done;
+}
+/* APPLE LOCAL end shared memory reads  */
+
 int
 remote_read_bytes (CORE_ADDR memaddr, char *myaddr, int len)
 {
@@ -4315,33 +5141,84 @@ remote_read_bytes (CORE_ADDR memaddr, char *myaddr, int len)
   int max_buf_size;		/* Max size of packet output buffer.  */
   long sizeof_buf;
   int origlen;
+  /* APPLE LOCAL begin pipelined memory reads  */
+  CORE_ADDR send_addr;		/* Where the next request starts.  */
+  int send_len;			/* How much is left to request.  */
+  int in_flight = 0;		/* Requests sent but not answered.  */
+  int depth;
+  int result = -1;
+  /* APPLE LOCAL binary memory reads  */
+  int binary;			/* Use 'x' rather than 'm'.  */
+  int chunk;			/* Bytes asked for in each packet.  */
+
+  /* APPLE LOCAL stop reply memory  */
+  if (remote_lookup_stop_memory (memaddr, myaddr, len))
+    return len;
+
+  /* APPLE LOCAL shared memory reads  */
+  if (check_shared_memory ())
+    return remote_read_bytes_shared (memaddr, (gdb_byte *) myaddr, len);
 
   /* Create a buffer big enough for this packet.  */
   max_buf_size = get_memory_read_packet_size ();
   sizeof_buf = max_buf_size + 1; /* Space for trailing NULL.  */
   buf = alloca (sizeof_buf);
 
+  /* APPLE LOCAL begin binary memory reads  */
+  /* A binary reply escapes at most every byte, and starts with a
+     'b', so ask for no more than fits if everything needs escaping.
+     Usually the reply is much smaller than the hex one would be.  */
+  check_binary_read (memaddr);
+  binary = (remote_protocol_binary_read.support == PACKET_ENABLE);
+  if (binary)
+    chunk = (max_buf_size - 1) / 2;
+  else
+    chunk = max_buf_size / 2;	/* num bytes that will fit */
+  /* APPLE LOCAL end binary memory reads  */
+
+  /* Without acks, we can send the requests for the next few chunks
+     before the reply to the first one comes back, so a large read
+     isn't paced by the round trip time of the link.  The replies come
+     back in the order the requests went out.  */
+  depth = 1;
+  if (no_ack_mode && remote_memory_read_pipeline_depth > 1)
+    depth = remote_memory_read_pipeline_depth;
+
   origlen = len;
+  send_addr = memaddr;
+  send_len = len;
   while (len > 0)
     {
       char *p;
       int todo;
       int i;
 
-      todo = min (len, max_buf_size / 2);	/* num bytes that will fit */
+      while (in_flight < depth && send_len > 0)
+	{
+	  todo = min (send_len, chunk);
+
+	  /* construct "m"<memaddr>","<len>" */
+	  /* sprintf (buf, "m%lx,%x", (unsigned long) memaddr, todo); */
+	  send_addr = remote_address_masked (send_addr);
+	  p = buf;
+	  /* APPLE LOCAL binary memory reads  */
+	  *p++ = binary ? 'x' : 'm';
+	  p += hexnumstr (p, (ULONGEST) send_addr);
+	  *p++ = ',';
+	  p += hexnumstr (p, (ULONGEST) todo);
+	  *p = '\0';
 
-      /* construct "m"<memaddr>","<len>" */
-      /* sprintf (buf, "m%lx,%x", (unsigned long) memaddr, todo); */
-      memaddr = remote_address_masked (memaddr);
-      p = buf;
-      *p++ = 'm';
-      p += hexnumstr (p, (ULONGEST) memaddr);
-      *p++ = ',';
-      p += hexnumstr (p, (ULONGEST) todo);
-      *p = '\0';
+	  putpkt (buf);
+	  in_flight++;
+	  send_addr += todo;
+	  send_len -= todo;
+	}
 
-      putpkt (buf);
+      /* The reply we're about to read answers the request for the
+	 chunk at MEMADDR.  */
+      todo = min (len, chunk);
       getpkt (buf, sizeof_buf, 0);
+      in_flight--;
 
       if (buf[0] == 'E'
 	  && isxdigit (buf[1]) && isxdigit (buf[2])
@@ -4353,26 +5230,150 @@ remote_read_bytes (CORE_ADDR memaddr, char *myaddr, int len)
 	     include errno codes, bfd_error codes, and others).  But
 	     for now just return EIO.  */
 	  errno = EIO;
-	  return 0;
+	  result = 0;
+	  break;
 	}
 
       /* Reply describes memory byte by byte,
          each byte encoded as two hex characters.  */
 
+      /* APPLE LOCAL begin binary memory reads  */
+      /* ...or, for 'x', as itself after a 'b', escaped if need be.
+         The reply may hold NULs, so use the length getpkt saw.  */
       p = buf;
-      if ((i = hex2bin (p, myaddr, todo)) < todo)
+      if (!binary)
+	i = hex2bin (p, myaddr, todo);
+      else if (buf[0] == 'b')
+	i = remote_unescape_binary (p + 1, remote_last_packet_length - 1,
+				    (gdb_byte *) myaddr, todo);
+      else
+	i = 0;
+      /* APPLE LOCAL end binary memory reads  */
+      if (i < todo)
 	{
 	  /* Reply is short.  This means that we were able to read
 	     only part of what we wanted to.  */
-	  return i + (origlen - len);
+	  result = i + (origlen - len);
+	  break;
 	}
       myaddr += todo;
       memaddr += todo;
       len -= todo;
     }
+
+  /* If we stopped early, there may still be replies on the way for
+     requests past the failure; read them so they don't get taken for
+     the answer to some later packet.  */
+  while (in_flight > 0)
+    {
+      getpkt (buf, sizeof_buf, 0);
+      in_flight--;
+    }
+
+  if (result >= 0)
+    return result;
+  /* APPLE LOCAL end pipelined memory reads  */
   return origlen;
 }
 
+/* APPLE LOCAL begin memory ranges  */
+/* Read the NRANGES RANGES with one memory-read packet each, sending
+   up to remote_memory_read_pipeline_depth of them before waiting for
+   the first reply, so that reading many small pieces of memory costs
+   about one round trip rather than one per piece.  Only ranges small
+   enough for a single packet are done here; the rest, and any that
+   come back short or with an error, are left for
+   target_read_memory_ranges to read the ordinary way.  */
+
+static void
+remote_read_memory_ranges (struct target_memory_range *ranges, int nranges)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct cleanup *old_chain;
+  char *buf;
+  long sizeof_buf;
+  int max_buf_size;
+  int binary, chunk, depth;
+  int *pending;
+  int npending = 0;
+  int sent = 0, answered = 0;
+  int i;
+
+  if (!rs->has_target || nranges == 0)
+    return;
+
+  /* Pipelining needs no-ack mode, and the shared mapping is already
+     cheaper than packets.  */
+  if (!no_ack_mode || remote_memory_read_pipeline_depth <= 1
+      || check_shared_memory ())
+    return;
+
+  max_buf_size = get_memory_read_packet_size ();
+  sizeof_buf = max_buf_size + 1;
+  buf = alloca (sizeof_buf);
+
+  check_binary_read (ranges[0].addr);
+  binary = (remote_protocol_binary_read.support == PACKET_ENABLE);
+  if (binary)
+    chunk = (max_buf_size - 1) / 2;
+  else
+    chunk = max_buf_size / 2;
+  depth = remote_memory_read_pipeline_depth;
+
+  pending = xmalloc (nranges * sizeof (int));
+  old_chain = make_cleanup (xfree, pending);
+  for (i = 0; i < nranges; i++)
+    {
+      struct target_memory_range *r = &ranges[i];
+
+      if (remote_lookup_stop_memory (r->addr, (char *) r->buf, r->len))
+	r->status = 0;
+      else if (r->len > 0 && r->len <= chunk)
+	pending[npending++] = i;
+    }
+
+  while (answered < npending)
+    {
+      struct target_memory_range *r;
+      int got;
+
+      while (sent < npending && sent - answered < depth)
+	{
+	  char *p;
+
+	  r = &ranges[pending[sent++]];
+	  p = buf;
+	  *p++ = binary ? 'x' : 'm';
+	  p += hexnumstr (p, (ULONGEST) remote_address_masked (r->addr));
+	  *p++ = ',';
+	  p += hexnumstr (p, (ULONGEST) r->len);
+	  *p = '\0';
+	  putpkt (buf);
+	}
+
+      /* Replies come back in the order the requests went out.  */
+      r = &ranges[pending[answered++]];
+      getpkt (buf, sizeof_buf, 0);
+
+      if (buf[0] == 'E'
+	  && isxdigit (buf[1]) && isxdigit (buf[2])
+	  && buf[3] == '\0')
+	got = 0;
+      else if (!binary)
+	got = hex2bin (buf, r->buf, r->len);
+      else if (buf[0] == 'b')
+	got = remote_unescape_binary (buf + 1, remote_last_packet_length - 1,
+				      r->buf, r->len);
+      else
+	got = 0;
+      if (got == r->len)
+	r->status = 0;
+    }
+
+  do_cleanups (old_chain);
+}
+/* APPLE LOCAL end memory ranges  */
+
 /* Read or write LEN bytes from inferior memory at MEMADDR,
    transferring to or from debugger address BUFFER.  Write to inferior
    if SHOULD_WRITE is nonzero.  Returns length of data written or
@@ -4483,6 +5484,8 @@ putpkt_binary (char *buf, int cnt)
   int ch;
   int tcount = 0;
   char *p;
+  /* APPLE LOCAL remote wire stats  */
+  int expect_reply = remote_packet_expects_reply (buf, cnt);
 
   /* Copy the packet into buffer BUF2, encapsulating it
      and giving it a checksum.  */
@@ -4530,6 +5533,12 @@ putpkt_binary (char *buf, int cnt)
         current_remote_stats->pkt_sent++;
       total_packets_sent++;
       add_outgoing_pkt_to_protocol_log (buf);
+      /* APPLE LOCAL remote wire stats: A retransmission doesn't get a
+	 reply of its own.  */
+      remote_wire_stats_send (&remote_protocol_wire_stats, buf,
+			      remote_packet_type_len (buf, cnt), p - buf2,
+			      expect_reply);
+      expect_reply = 0;
 
       /* APPLE LOCAL: If this is a no acks version of the remote
 	 protocol, send the packet and move on.  */
@@ -4625,6 +5634,104 @@ putpkt_binary (char *buf, int cnt)
   return 0;
 }
 
+/* APPLE LOCAL begin bulk serial reads  */
+/* Return how many of the N characters at P are plain packet data,
+   i.e. come before the first '$', '#' or '*'.  Like readchar, look at
+   each character with its top bit cleared.  */
+
+static long
+remote_frame_data_span (const unsigned char *p, long n)
+{
+  const unsigned char *end = p + n;
+  const unsigned char *q;
+  unsigned char high = 0;
+  long i;
+
+  q = memchr (p, '#', end - p);
+  if (q != NULL)
+    end = q;
+  q = memchr (p, '$', end - p);
+  if (q != NULL)
+    end = q;
+  q = memchr (p, '*', end - p);
+  if (q != NULL)
+    end = q;
+
+  /* A character with the top bit set may turn into one of those once
+     it is masked; look at them one at a time if there are any.  */
+  for (i = 0; i < end - p; i++)
+    high |= p[i];
+  if ((high & 0x80) == 0)
+    return end - p;
+
+  for (i = 0; i < end - p; i++)
+    {
+      unsigned char c = p[i] & 0x7f;
+      if (c == '#' || c == '$' || c == '*')
+	break;
+    }
+  return i;
+}
+
+/* Copy the N characters at SRC to DST with their top bits cleared and
+   return their sum.  This is a plain loop over the bytes so that the
+   compiler can vectorize it.  */
+
+static unsigned char
+remote_copy_frame_data (char *dst, const unsigned char *src, long n)
+{
+  unsigned int sum = 0;
+  long i;
+
+  for (i = 0; i < n; i++)
+    {
+      unsigned char c = src[i] & 0x7f;
+      dst[i] = c;
+      sum += c;
+    }
+  return sum;
+}
+
+/* Copy as much plain data of the frame being read as the serial
+   device already has into BUF at *BC, adding it into *CSUM, and then
+   return the next character as readchar would.  */
+
+static int
+remote_readchar_bulk (char *buf, long sizeof_buf, long *bc,
+		      unsigned char *csum)
+{
+  if (!serial_can_peek (remote_desc))
+    return readchar (remote_timeout);
+
+  while (1)
+    {
+      const unsigned char *data;
+      long span;
+      int avail;
+
+      start_remote_timer ();
+      avail = serial_peek (remote_desc, remote_timeout, &data);
+      end_remote_timer ();
+
+      if (avail == SERIAL_TIMEOUT)
+	return SERIAL_TIMEOUT;
+      /* Let readchar report any other error.  */
+      if (avail <= 0)
+	return readchar (remote_timeout);
+
+      span = remote_frame_data_span (data, avail);
+      if (span > sizeof_buf - 1 - *bc)
+	span = sizeof_buf - 1 - *bc;
+      if (span <= 0)
+	return readchar (remote_timeout);
+
+      *csum += remote_copy_frame_data (buf + *bc, data, span);
+      *bc += span;
+      serial_consume (remote_desc, span);
+    }
+}
+/* APPLE LOCAL end bulk serial reads  */
+
 /* Come here after finding the start of the frame.  Collect the rest
    into BUF, verifying the checksum, length, and handling run-length
    compression.  No more than sizeof_buf-1 characters are read so that
@@ -4648,7 +5755,8 @@ read_frame (char *buf,
   while (1)
     {
       /* ASSERT (bc < sizeof_buf - 1) - space for trailing NULL.  */
-      c = readchar (remote_timeout);
+      /* APPLE LOCAL bulk serial reads  */
+      c = remote_readchar_bulk (buf, sizeof_buf, &bc, &csum);
       switch (c)
 	{
 	case SERIAL_TIMEOUT:
@@ -4714,45 +5822,310 @@ read_frame (char *buf,
 	    int repeat;
  	    csum += c;
 
-	    c = readchar (remote_timeout);
-	    csum += c;
-	    repeat = c - ' ' + 3;	/* Compute repeat count.  */
+	    c = readchar (remote_timeout);
+	    csum += c;
+	    repeat = c - ' ' + 3;	/* Compute repeat count.  */
+
+	    /* The character before ``*'' is repeated.  */
+
+	    if (repeat > 0 && repeat <= 255
+		&& bc > 0
+                && bc + repeat - 1 < sizeof_buf - 1)
+	      {
+		memset (&buf[bc], buf[bc - 1], repeat);
+		bc += repeat;
+		continue;
+	      }
+
+	    buf[bc] = '\0';
+	    printf_filtered (_("Repeat count %d too large for buffer: "), 
+			     repeat);
+	    puts_filtered (buf);
+	    puts_filtered ("\n");
+	    return -1;
+	  }
+	default:
+	  if (bc < sizeof_buf - 1)
+	    {
+	      buf[bc++] = c;
+	      csum += c;
+	      continue;
+	    }
+
+	  buf[bc] = '\0';
+	  puts_filtered ("Remote packet too long: ");
+	  puts_filtered (buf);
+	  puts_filtered ("\n");
+
+	  return -1;
+	}
+    }
+}
+
+/* APPLE LOCAL begin incremental async packets  */
+/* Account for the VAL characters of the packet just read into BUF,
+   and acknowledge it.  */
+
+static void
+remote_packet_received (char *buf, long val)
+{
+  remote_last_packet_length = val;
+  if (current_remote_stats)
+    current_remote_stats->pkt_recvd++;
+  total_packets_received++;
+  /* Console output isn't the reply to anything.  */
+  remote_wire_stats_receive (&remote_protocol_wire_stats, val + 4,
+			     !(buf[0] == 'O' && isxdigit (buf[1])));
+  if (remote_debug)
+    {
+      fprintf_unfiltered (gdb_stdlog, "Packet received: ");
+      fputstr_unfiltered (buf, 0, gdb_stdlog);
+      fprintf_unfiltered (gdb_stdlog, "\n");
+    }
+  add_incoming_pkt_to_protocol_log (buf);
+  /* Skip the ack char if we're in no-ack mode.  */
+  if (!no_ack_mode)
+    {
+      start_remote_timer ();
+      serial_write (remote_desc, "+", 1);
+      end_remote_timer ();
+      if (current_remote_stats)
+	current_remote_stats->acks_sent++;
+    }
+}
+
+/* While the target runs in async mode, the serial handler feeds the
+   characters of the target's next packet into this as they arrive,
+   so the client is only told about the target once a whole packet is
+   here, and remote_async_wait doesn't sit in read_frame waiting for
+   the rest of it while the user interface is frozen.  */
+
+static int remote_async_packets = 1;
+
+enum remote_async_packet_state
+{
+  /* Looking for the '$' that starts a packet.  */
+  ASYNC_PACKET_IDLE,
+  /* Collecting the characters between the '$' and the '#'.  */
+  ASYNC_PACKET_DATA,
+  /* The last character was a '*'; the next one is a repeat count.  */
+  ASYNC_PACKET_REPEAT,
+  /* Waiting for the first or the second checksum character.  */
+  ASYNC_PACKET_CHECKSUM_1,
+  ASYNC_PACKET_CHECKSUM_2,
+  /* A whole packet is in BUF, already acknowledged, waiting for
+     getpkt to pick it up.  */
+  ASYNC_PACKET_DONE
+};
+
+static struct
+{
+  enum remote_async_packet_state state;
+  char *buf;
+  long sizeof_buf;
+  long len;
+  unsigned char csum;
+  int check_0;
+} remote_async_packet;
+
+static void
+show_remote_async_packets (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Collecting packets from a running async target as they arrive is %s.\n"),
+		    value);
+}
+
+/* Drop any partly collected packet, e.g. because the connection is
+   going away.  */
+
+static void
+remote_async_packet_reset (void)
+{
+  remote_async_packet.state = ASYNC_PACKET_IDLE;
+  remote_async_packet.len = 0;
+}
+
+/* The packet being collected is bad.  Ask for it again and start
+   looking for the retransmission, the way getpkt_sane does.  */
+
+static void
+remote_async_packet_reject (const char *why)
+{
+  if (remote_debug)
+    fprintf_filtered (gdb_stdlog, "%s, retrying\n", why);
+  remote_async_packet_reset ();
+  /* Skip the nack char if we're in no-ack mode.  */
+  if (!no_ack_mode)
+    {
+      start_remote_timer ();
+      serial_write (remote_desc, "-", 1);
+      end_remote_timer ();
+      if (current_remote_stats)
+	current_remote_stats->acks_sent++;
+    }
+}
+
+/* Add the character C to the packet being collected, decoding it as
+   read_frame would.  */
+
+static void
+remote_async_packet_feed (int c)
+{
+  int repeat;
+
+  switch (remote_async_packet.state)
+    {
+    case ASYNC_PACKET_IDLE:
+      if (c == '$')
+	{
+	  remote_async_packet.len = 0;
+	  remote_async_packet.csum = 0;
+	  remote_async_packet.state = ASYNC_PACKET_DATA;
+	}
+      break;
+
+    case ASYNC_PACKET_DATA:
+      if (c == '$')
+	{
+	  /* read_frame gives up on the old packet and misses the new
+	     one; we may as well collect it.  */
+	  if (remote_debug)
+	    fputs_filtered ("Saw new packet start in middle of old one\n",
+			    gdb_stdlog);
+	  remote_async_packet.len = 0;
+	  remote_async_packet.csum = 0;
+	}
+      else if (c == '#')
+	{
+	  remote_async_packet.buf[remote_async_packet.len] = '\0';
+	  remote_async_packet.state = ASYNC_PACKET_CHECKSUM_1;
+	}
+      else if (c == '*')
+	{
+	  remote_async_packet.csum += c;
+	  remote_async_packet.state = ASYNC_PACKET_REPEAT;
+	}
+      else if (remote_async_packet.len < remote_async_packet.sizeof_buf - 1)
+	{
+	  remote_async_packet.buf[remote_async_packet.len++] = c;
+	  remote_async_packet.csum += c;
+	}
+      else
+	remote_async_packet_reject ("Remote packet too long");
+      break;
+
+    case ASYNC_PACKET_REPEAT:
+      /* The character before the '*' is repeated.  */
+      remote_async_packet.csum += c;
+      repeat = c - ' ' + 3;
+      if (repeat > 0 && repeat <= 255
+	  && remote_async_packet.len > 0
+	  && (remote_async_packet.len + repeat - 1
+	      < remote_async_packet.sizeof_buf - 1))
+	{
+	  memset (&remote_async_packet.buf[remote_async_packet.len],
+		  remote_async_packet.buf[remote_async_packet.len - 1],
+		  repeat);
+	  remote_async_packet.len += repeat;
+	  remote_async_packet.state = ASYNC_PACKET_DATA;
+	}
+      else
+	remote_async_packet_reject ("Repeat count too large for buffer");
+      break;
+
+    case ASYNC_PACKET_CHECKSUM_1:
+      remote_async_packet.check_0 = c;
+      remote_async_packet.state = ASYNC_PACKET_CHECKSUM_2;
+      break;
+
+    case ASYNC_PACKET_CHECKSUM_2:
+      /* With no acks there is no asking for the packet again, so
+	 don't bother checking.  */
+      if (no_ack_mode
+	  || (((fromhex (remote_async_packet.check_0) << 4) | fromhex (c))
+	      == remote_async_packet.csum))
+	{
+	  remote_async_packet.state = ASYNC_PACKET_DONE;
+	  remote_packet_received (remote_async_packet.buf,
+				  remote_async_packet.len);
+	}
+      else
+	remote_async_packet_reject ("Bad checksum");
+      break;
+
+    case ASYNC_PACKET_DONE:
+      break;
+    }
+}
 
-	    /* The character before ``*'' is repeated.  */
+/* Called by the serial handler while the target runs async.  Collect
+   whatever has arrived without waiting for more, and return nonzero
+   if the client should be woken up: a whole packet is waiting, or the
+   connection failed and getpkt should find out about it.  */
 
-	    if (repeat > 0 && repeat <= 255
-		&& bc > 0
-                && bc + repeat - 1 < sizeof_buf - 1)
-	      {
-		memset (&buf[bc], buf[bc - 1], repeat);
-		bc += repeat;
-		continue;
-	      }
+static int
+remote_async_packet_collect (void)
+{
+  struct remote_state *rs = get_remote_state ();
+  int c;
 
-	    buf[bc] = '\0';
-	    printf_filtered (_("Repeat count %d too large for buffer: "), 
-			     repeat);
-	    puts_filtered (buf);
-	    puts_filtered ("\n");
-	    return -1;
-	  }
-	default:
-	  if (bc < sizeof_buf - 1)
-	    {
-	      buf[bc++] = c;
-	      csum += c;
-	      continue;
-	    }
+  if (remote_async_packet.state == ASYNC_PACKET_IDLE
+      && remote_async_packet.sizeof_buf < rs->remote_packet_size)
+    {
+      remote_async_packet.sizeof_buf = rs->remote_packet_size;
+      remote_async_packet.buf = xrealloc (remote_async_packet.buf,
+					  remote_async_packet.sizeof_buf);
+    }
 
-	  buf[bc] = '\0';
-	  puts_filtered ("Remote packet too long: ");
-	  puts_filtered (buf);
-	  puts_filtered ("\n");
+  while (remote_async_packet.state != ASYNC_PACKET_DONE)
+    {
+      c = serial_readchar (remote_desc, 0);
+      if (c == SERIAL_TIMEOUT)
+	return 0;
+      if (c < 0)
+	return 1;
+      remote_async_packet_feed (c & 0x7f);
+    }
+  return 1;
+}
 
-	  return -1;
+/* If the serial handler has collected all or part of a packet, finish
+   reading it, copy it to BUF and return nonzero.  Return zero if
+   getpkt_sane should read a packet itself.  */
+
+static int
+remote_async_packet_take (char *buf, long sizeof_buf)
+{
+  long len;
+  int c;
+
+  /* Once it has started, the rest of a packet is expected at the
+     brisk pace read_frame expects.  */
+  while (remote_async_packet.state != ASYNC_PACKET_IDLE
+	 && remote_async_packet.state != ASYNC_PACKET_DONE)
+    {
+      c = readchar (remote_timeout);
+      if (c == SERIAL_TIMEOUT)
+	{
+	  remote_async_packet_reject ("Timeout in mid-packet");
+	  return 0;
 	}
+      remote_async_packet_feed (c);
     }
+
+  if (remote_async_packet.state != ASYNC_PACKET_DONE)
+    return 0;
+
+  len = min (remote_async_packet.len, sizeof_buf - 1);
+  memcpy (buf, remote_async_packet.buf, len);
+  buf[len] = '\0';
+  remote_last_packet_length = len;
+  remote_async_packet_reset ();
+  return 1;
 }
+/* APPLE LOCAL end incremental async packets  */
 
 /* Read a packet from the remote machine, with error checking, and
    store it in BUF.  If FOREVER, wait forever rather than timing out;
@@ -4789,7 +6162,13 @@ getpkt_sane (char *buf,
   int timeout;
   int val;
 
+  /* APPLE LOCAL incremental async packets  */
+  if (remote_async_packet_take (buf, sizeof_buf))
+    return 0;
+
   strcpy (buf, "timeout");
+  /* APPLE LOCAL */
+  remote_last_packet_length = strlen (buf);
 
   if (forever)
     {
@@ -4839,27 +6218,8 @@ getpkt_sane (char *buf,
 
       if (val >= 0)
 	{
-          /* APPLE LOCAL */
-          if (current_remote_stats)
-            current_remote_stats->pkt_recvd++;
-          total_packets_received++;
-	  if (remote_debug)
-	    {
-	      fprintf_unfiltered (gdb_stdlog, "Packet received: ");
-	      fputstr_unfiltered (buf, 0, gdb_stdlog);
-	      fprintf_unfiltered (gdb_stdlog, "\n");
-	    }
-          add_incoming_pkt_to_protocol_log (buf);
-          /* APPLE LOCAL: Skip the ack char if we're in no-ack mode */
-          if (!no_ack_mode)
-            {
-              start_remote_timer ();
-	      serial_write (remote_desc, "+", 1);
-              end_remote_timer ();
-              /* APPLE LOCAL */
-              if (current_remote_stats)
-                current_remote_stats->acks_sent++;
-            }
+	  /* APPLE LOCAL incremental async packets  */
+	  remote_packet_received (buf, val);
 	  return 0;
 	}
 
@@ -4881,6 +6241,8 @@ getpkt_sane (char *buf,
      Give up.  */
 
   printf_unfiltered (_("Ignoring packet error, continuing...\n"));
+  /* APPLE LOCAL */
+  remote_last_packet_length = strlen (buf);
   /* APPLE LOCAL: Skip the ack char if we're in no-ack mode */
   if (!no_ack_mode)
     {
@@ -5433,6 +6795,132 @@ crc32 (unsigned char *buf, int len, unsigned int crc)
   return crc;
 }
 
+/* APPLE LOCAL begin verify target memory  */
+/* Compare the SIZE bytes at MEMADDR in the target with DATA by asking
+   the stub for their CRC with a "qCRC:" packet, computing ours while
+   the stub computes its.  Returns -1 if the stub doesn't understand,
+   or couldn't read the memory.  */
+
+static int
+remote_verify_memory (const gdb_byte *data, CORE_ADDR memaddr, ULONGEST size)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *buf = alloca (rs->remote_packet_size);
+  unsigned long host_crc, target_crc;
+  char *tmp;
+
+  if (!rs->has_target || size == 0)
+    return -1;
+
+  xsnprintf (buf, rs->remote_packet_size, "qCRC:%s,%s",
+	     paddr_nz (remote_address_masked (memaddr)), paddr_nz (size));
+  putpkt (buf);
+
+  host_crc = crc32 ((unsigned char *) data, size, 0xffffffff);
+
+  getpkt (buf, rs->remote_packet_size, 0);
+  if (buf[0] != 'C')
+    return -1;
+
+  for (target_crc = 0, tmp = &buf[1]; *tmp; tmp++)
+    target_crc = target_crc * 16 + fromhex (*tmp);
+
+  return host_crc == target_crc;
+}
+/* APPLE LOCAL end verify target memory  */
+
+/* APPLE LOCAL begin memory search  */
+/* Ask the stub to search the SEARCH_SPACE_LEN bytes at START_ADDR for
+   PATTERN with a "qSearch:memory:ADDR;LEN;PATTERN" request, the
+   pattern escaped as in an 'X' packet, so that only the answer comes
+   back over the link.  Falls back on reading the memory here if the
+   stub doesn't understand, or the pattern is too big for a packet.  */
+
+static int
+remote_search_memory (CORE_ADDR start_addr, ULONGEST search_space_len,
+		      const gdb_byte *pattern, ULONGEST pattern_len,
+		      CORE_ADDR *found_addrp)
+{
+  struct remote_state *rs = get_remote_state ();
+  long max_size = get_memory_write_packet_size ();
+  long sizeof_buf = max (max_size, rs->remote_packet_size) + 1;
+  char *buf = alloca (sizeof_buf);
+  ULONGEST found_addr;
+  ULONGEST i;
+  char *p;
+
+  /* Don't go to the stub for these; an answer to a trivial search
+     says nothing about whether it can do real ones.  */
+  if (pattern_len > search_space_len)
+    return 0;
+  if (pattern_len == 0)
+    {
+      *found_addrp = start_addr;
+      return 1;
+    }
+
+  if (!rs->has_target
+      || remote_protocol_qSearch_memory.support == PACKET_DISABLE)
+    return simple_search_memory (start_addr, search_space_len,
+				 pattern, pattern_len, found_addrp);
+
+  p = buf;
+  strcpy (p, "qSearch:memory:");
+  p += strlen (p);
+  p += hexnumstr (p, (ULONGEST) remote_address_masked (start_addr));
+  *p++ = ';';
+  p += hexnumstr (p, search_space_len);
+  *p++ = ';';
+
+  /* Leave room for the "$" and "#NN" around the packet.  */
+  for (i = 0; i < pattern_len; i++)
+    {
+      int c = pattern[i] & 0xff;
+
+      if (p - buf + 2 > max_size - 4)
+	return simple_search_memory (start_addr, search_space_len,
+				     pattern, pattern_len, found_addrp);
+      switch (c)
+	{
+	case '$':
+	case '#':
+	case '*':
+	case 0x7d:
+	  *p++ = 0x7d;
+	  *p++ = c ^ 0x20;
+	  break;
+	default:
+	  *p++ = c;
+	  break;
+	}
+    }
+
+  putpkt_binary (buf, p - buf);
+  getpkt (buf, sizeof_buf, 0);
+
+  switch (packet_ok (buf, &remote_protocol_qSearch_memory))
+    {
+    case PACKET_OK:
+      break;
+    case PACKET_UNKNOWN:
+      return simple_search_memory (start_addr, search_space_len,
+				   pattern, pattern_len, found_addrp);
+    case PACKET_ERROR:
+      error (_("Remote target failed to search memory at 0x%s."),
+	     paddr_nz (start_addr));
+    }
+
+  if (buf[0] == '0')
+    return 0;
+  if (buf[0] != '1' || buf[1] != ',')
+    error (_("Unexpected reply to qSearch:memory: %s"), buf);
+
+  unpack_varlen_hex (buf + 2, &found_addr);
+  *found_addrp = found_addr;
+  return 1;
+}
+/* APPLE LOCAL end memory search  */
+
 /* compare-sections command
 
    With no arguments, compares each loadable section in the exec bfd
@@ -5978,6 +7466,12 @@ Specify the serial device it is connected to\n\
   remote_ops.to_extra_thread_info = remote_threads_extra_info;
   remote_ops.to_stop = remote_stop;
   remote_ops.to_xfer_partial = remote_xfer_partial;
+  /* APPLE LOCAL memory ranges  */
+  remote_ops.to_read_memory_ranges = remote_read_memory_ranges;
+  /* APPLE LOCAL verify target memory  */
+  remote_ops.to_verify_memory = remote_verify_memory;
+  /* APPLE LOCAL memory search  */
+  remote_ops.to_search_memory = remote_search_memory;
   remote_ops.to_rcmd = remote_rcmd;
   remote_ops.to_get_thread_local_address = remote_get_thread_local_address;
   remote_ops.to_stratum = process_stratum;
@@ -6025,9 +7519,9 @@ remote_is_async_p (void)
   return (current_target.to_async_mask_value) && serial_is_async_p (remote_desc);
 }
 
-/* Pass the SERIAL event on and up to the client.  One day this code
-   will be able to delay notifying the client of an event until the
-   point where an entire packet has been received.  */
+/* Pass the SERIAL event on and up to the client.  Unless "set remote
+   async-packets" is off, the client isn't told until an entire packet
+   has been received.  */
 
 static void (*async_client_callback) (enum inferior_event_type event_type,
 				      void *context);
@@ -6037,6 +7531,11 @@ static serial_event_ftype remote_async_serial_handler;
 static void
 remote_async_serial_handler (struct serial *scb, void *context)
 {
+  /* APPLE LOCAL begin incremental async packets  */
+  if (remote_async_packets && !remote_async_packet_collect ())
+    return;
+  /* APPLE LOCAL end incremental async packets  */
+
   /* Don't propogate error information up to the client.  Instead let
      the client find out about the error by querying the target.  */
   async_client_callback (INF_REG_EVENT, async_client_context);
@@ -6106,6 +7605,12 @@ Specify the serial device it is connected to (e.g. /dev/ttya).";
   remote_async_ops.to_extra_thread_info = remote_threads_extra_info;
   remote_async_ops.to_stop = remote_stop;
   remote_async_ops.to_xfer_partial = remote_xfer_partial;
+  /* APPLE LOCAL memory ranges  */
+  remote_async_ops.to_read_memory_ranges = remote_read_memory_ranges;
+  /* APPLE LOCAL verify target memory  */
+  remote_async_ops.to_verify_memory = remote_verify_memory;
+  /* APPLE LOCAL memory search  */
+  remote_async_ops.to_search_memory = remote_search_memory;
   remote_async_ops.to_rcmd = remote_rcmd;
   remote_async_ops.to_stratum = process_stratum;
   remote_async_ops.to_has_all_memory = 1;
@@ -6156,6 +7661,13 @@ show_remote_cmd (char *args, int from_tty)
   show_remote_protocol_qSymbol_packet_cmd (gdb_stdout, from_tty, NULL, NULL);
   show_remote_protocol_vcont_packet_cmd (gdb_stdout, from_tty, NULL, NULL);
   show_remote_protocol_binary_download_cmd (gdb_stdout, from_tty, NULL, NULL);
+  /* APPLE LOCAL binary memory reads  */
+  show_remote_protocol_binary_read_cmd (gdb_stdout, from_tty, NULL, NULL);
+  /* APPLE LOCAL shared memory reads  */
+  show_remote_protocol_shared_memory_cmd (gdb_stdout, from_tty, NULL, NULL);
+  /* APPLE LOCAL memory search  */
+  show_remote_protocol_qSearch_memory_packet_cmd (gdb_stdout, from_tty,
+						  NULL, NULL);
   show_remote_protocol_qPart_auxv_packet_cmd (gdb_stdout, from_tty, NULL, NULL);
   show_remote_protocol_qGetTLSAddr_packet_cmd (gdb_stdout, from_tty, NULL, NULL);
   show_max_remote_packet_size (NULL, from_tty);
@@ -6209,6 +7721,308 @@ end_remote_timer ()
   timerclear (&current_remote_stats->pktstart);
 }
 
+/* APPLE LOCAL begin remote wire stats  */
+
+#define MAX_REMOTE_WIRE_STATS 4
+static struct remote_wire_stats *remote_wire_stats_list[MAX_REMOTE_WIRE_STATS];
+static int remote_wire_stats_count;
+
+void
+remote_wire_stats_register (struct remote_wire_stats *stats)
+{
+  gdb_assert (remote_wire_stats_count < MAX_REMOTE_WIRE_STATS);
+  if (stats->max_in_flight <= 0
+      || stats->max_in_flight > REMOTE_WIRE_STATS_MAX_IN_FLIGHT)
+    stats->max_in_flight = REMOTE_WIRE_STATS_MAX_IN_FLIGHT;
+  remote_wire_stats_list[remote_wire_stats_count++] = stats;
+}
+
+/* Return the index of STATS's entry for the packet type in the first
+   LEN characters of TYPE, adding one if need be.  Once the table is
+   full, everything new is counted as "other".  */
+
+static int
+remote_wire_stats_type (struct remote_wire_stats *stats,
+			const char *type, int len)
+{
+  int i;
+
+  if (len >= sizeof (stats->types[0].name))
+    len = sizeof (stats->types[0].name) - 1;
+  for (i = 0; i < stats->ntypes; i++)
+    if (strncmp (stats->types[i].name, type, len) == 0
+	&& stats->types[i].name[len] == '\0')
+      return i;
+
+  if (stats->ntypes >= REMOTE_WIRE_STATS_MAX_TYPES - 1)
+    {
+      type = "other";
+      len = strlen (type);
+      for (i = 0; i < stats->ntypes; i++)
+	if (strcmp (stats->types[i].name, type) == 0)
+	  return i;
+    }
+
+  i = stats->ntypes++;
+  memcpy (stats->types[i].name, type, len);
+  stats->types[i].name[len] = '\0';
+  return i;
+}
+
+void
+remote_wire_stats_send (struct remote_wire_stats *stats,
+			const char *type, int type_len,
+			size_t bytes, int expect_reply)
+{
+  int i = remote_wire_stats_type (stats, type, type_len);
+
+  stats->packets_out++;
+  stats->bytes_out += bytes;
+  stats->types[i].count++;
+  stats->types[i].bytes_out += bytes;
+
+  if (!expect_reply)
+    return;
+
+  if (stats->in_flight == stats->max_in_flight)
+    {
+      /* We'll never see the oldest one's reply; forget it.  */
+      memmove (&stats->pending[0], &stats->pending[1],
+	       (stats->in_flight - 1) * sizeof (stats->pending[0]));
+      stats->in_flight--;
+    }
+  gettimeofday (&stats->pending[stats->in_flight].sent, NULL);
+  stats->pending[stats->in_flight].type = i;
+  if (stats->in_flight == 0)
+    stats->busy_start = stats->pending[0].sent;
+  stats->in_flight++;
+}
+
+void
+remote_wire_stats_receive (struct remote_wire_stats *stats,
+			   size_t bytes, int is_reply)
+{
+  struct timeval now, rtt, total;
+  unsigned int usec;
+  int i;
+
+  stats->packets_in++;
+  stats->bytes_in += bytes;
+
+  if (!is_reply || stats->in_flight == 0)
+    return;
+
+  gettimeofday (&now, NULL);
+  timersub (&now, &stats->pending[0].sent, &rtt);
+  usec = rtt.tv_sec * 1000000 + rtt.tv_usec;
+  i = stats->pending[0].type;
+  stats->types[i].bytes_in += bytes;
+  stats->types[i].usec += usec;
+  stats->samples[stats->nsamples++ % REMOTE_WIRE_STATS_MAX_SAMPLES] = usec;
+
+  stats->in_flight--;
+  memmove (&stats->pending[0], &stats->pending[1],
+	   stats->in_flight * sizeof (stats->pending[0]));
+
+  if (stats->in_flight == 0)
+    {
+      timersub (&now, &stats->busy_start, &rtt);
+      timeradd (&stats->busy, &rtt, &total);
+      stats->busy = total;
+      if (stats->stopped)
+	{
+	  timeradd (&stats->busy_stopped, &rtt, &total);
+	  stats->busy_stopped = total;
+	}
+    }
+}
+
+void
+remote_wire_stats_stopped (struct remote_wire_stats *stats, int stopped)
+{
+  struct timeval now, elapsed, total;
+
+  if (stopped == stats->stopped)
+    return;
+
+  gettimeofday (&now, NULL);
+  if (stopped)
+    stats->stop_start = now;
+  else
+    {
+      timersub (&now, &stats->stop_start, &elapsed);
+      timeradd (&stats->stopped_time, &elapsed, &total);
+      stats->stopped_time = total;
+    }
+  stats->stopped = stopped;
+}
+
+static int
+compare_wire_samples (const void *a, const void *b)
+{
+  unsigned int lhs = *(const unsigned int *) a;
+  unsigned int rhs = *(const unsigned int *) b;
+  return lhs < rhs ? -1 : lhs > rhs;
+}
+
+static double
+timeval_seconds (struct timeval *tv)
+{
+  return tv->tv_sec + tv->tv_usec / 1000000.0;
+}
+
+static void
+print_remote_wire_stats (struct remote_wire_stats *stats)
+{
+  struct timeval stopped_time = stats->stopped_time;
+  int nsamples;
+  int i;
+
+  printf_filtered (_("%s:\n"), stats->name);
+  printf_filtered (_("  Packets sent: %llu (%llu bytes)\n"),
+		   (unsigned long long) stats->packets_out,
+		   (unsigned long long) stats->bytes_out);
+  printf_filtered (_("  Packets received: %llu (%llu bytes)\n"),
+		   (unsigned long long) stats->packets_in,
+		   (unsigned long long) stats->bytes_in);
+
+  nsamples = min (stats->nsamples, REMOTE_WIRE_STATS_MAX_SAMPLES);
+  if (nsamples > 0)
+    {
+      unsigned int *sorted = xmalloc (nsamples * sizeof (unsigned int));
+      struct cleanup *cleanups = make_cleanup (xfree, sorted);
+
+      memcpy (sorted, stats->samples, nsamples * sizeof (unsigned int));
+      qsort (sorted, nsamples, sizeof (unsigned int), compare_wire_samples);
+      printf_filtered (_("  Round trip (usec, last %d): "
+			 "50%% %u, 90%% %u, 99%% %u, max %u\n"),
+		       nsamples, sorted[nsamples / 2],
+		       sorted[(nsamples * 9) / 10],
+		       sorted[(nsamples * 99) / 100],
+		       sorted[nsamples - 1]);
+      do_cleanups (cleanups);
+    }
+
+  if (stats->stopped)
+    {
+      struct timeval now, elapsed;
+
+      gettimeofday (&now, NULL);
+      timersub (&now, &stats->stop_start, &elapsed);
+      timeradd (&stats->stopped_time, &elapsed, &stopped_time);
+    }
+  printf_filtered (_("  Waiting on the wire: %.3f sec "
+		     "(%.3f sec of %.3f sec stopped"),
+		   timeval_seconds (&stats->busy),
+		   timeval_seconds (&stats->busy_stopped),
+		   timeval_seconds (&stopped_time));
+  if (timeval_seconds (&stopped_time) > 0)
+    printf_filtered (_(", %.1f%%"),
+		     100.0 * timeval_seconds (&stats->busy_stopped)
+		     / timeval_seconds (&stopped_time));
+  printf_filtered (_(")\n"));
+
+  if (stats->ntypes == 0)
+    return;
+  printf_filtered (_("  %-24s %8s %12s %12s %10s\n"),
+		   "Type", "Count", "Bytes out", "Bytes in", "Avg usec");
+  for (i = 0; i < stats->ntypes; i++)
+    {
+      struct remote_wire_stats_type *t = &stats->types[i];
+      printf_filtered ("  %-24s %8lu %12llu %12llu %10llu\n",
+		       t->name, t->count,
+		       (unsigned long long) t->bytes_out,
+		       (unsigned long long) t->bytes_in,
+		       (unsigned long long) (t->count ? t->usec / t->count : 0));
+    }
+}
+
+/* Forget everything in STATS but its name, how it's set up, and
+   whether the inferior is stopped.  */
+
+static void
+reset_remote_wire_stats (struct remote_wire_stats *stats)
+{
+  const char *name = stats->name;
+  int max_in_flight = stats->max_in_flight;
+  int stopped = stats->stopped;
+
+  memset (stats, 0, sizeof (*stats));
+  stats->name = name;
+  stats->max_in_flight = max_in_flight;
+  stats->stopped = stopped;
+  if (stopped)
+    gettimeofday (&stats->stop_start, NULL);
+}
+
+static void
+maintenance_info_remote_stats (char *args, int from_tty)
+{
+  int reset = 0;
+  int i;
+
+  if (args != NULL && *args != '\0')
+    {
+      if (strcmp (args, "reset") != 0)
+	error (_("Usage: maint info remote-stats [reset]"));
+      reset = 1;
+    }
+
+  for (i = 0; i < remote_wire_stats_count; i++)
+    {
+      struct remote_wire_stats *stats = remote_wire_stats_list[i];
+
+      if (reset)
+	reset_remote_wire_stats (stats);
+      else if (stats->packets_out != 0 || stats->packets_in != 0)
+	print_remote_wire_stats (stats);
+    }
+}
+
+/* The length of the part of the LEN character packet BUF that says
+   what kind of packet it is: the name of a 'q', 'Q' or 'v' packet,
+   and otherwise the first character.  */
+
+static int
+remote_packet_type_len (const char *buf, int len)
+{
+  int type_len = 1;
+
+  if (len > 0 && (buf[0] == 'q' || buf[0] == 'Q' || buf[0] == 'v'))
+    while (type_len < len && buf[type_len] != ':' && buf[type_len] != ','
+	   && buf[type_len] != ';')
+      type_len++;
+  return type_len;
+}
+
+/* Return non-zero if the stub answers the LEN character packet BUF
+   right away.  Resuming packets are answered when the target stops,
+   which has nothing to do with the wire.  */
+
+static int
+remote_packet_expects_reply (const char *buf, int len)
+{
+  if (len == 0)
+    return 1;
+  switch (buf[0])
+    {
+    case 'c':
+    case 'C':
+    case 's':
+    case 'S':
+    case 'i':
+    case 'I':
+    case 'k':
+    case 'R':
+      return 0;
+    case 'v':
+      return !(len >= 6 && strncmp (buf, "vCont;", 6) == 0);
+    default:
+      return 1;
+    }
+}
+/* APPLE LOCAL end remote wire stats  */
+
 
 
 /* APPLE LOCAL BEGIN: target remote-macosx.  */
@@ -6852,6 +8666,43 @@ further restriction and ``limit'' to enable that restriction."),
 	   _("Show the maximum number of bytes per memory-read packet."),
 	   &remote_show_cmdlist);
 
+  /* APPLE LOCAL pipelined memory reads  */
+  add_setshow_zinteger_cmd ("memory-read-pipeline-depth", no_class,
+			    &remote_memory_read_pipeline_depth, _("\
+Set the number of memory-read packets kept in flight at once."), _("\
+Show the number of memory-read packets kept in flight at once."), _("\
+When the remote protocol is in no-ack mode, a large memory read sends\n\
+up to this many memory-read packets, each as large as the\n\
+memory-read-packet-size allows, before waiting for the first reply.\n\
+0 or 1 waits for each reply before sending the next packet."),
+			    NULL, show_remote_memory_read_pipeline_depth,
+			    &remote_set_cmdlist, &remote_show_cmdlist);
+
+  /* APPLE LOCAL pipelined memory writes  */
+  add_setshow_zinteger_cmd ("memory-write-pipeline-depth", no_class,
+			    &remote_memory_write_pipeline_depth, _("\
+Set the number of memory-write packets kept in flight at once."), _("\
+Show the number of memory-write packets kept in flight at once."), _("\
+When the remote protocol is in no-ack mode, a large memory write, such\n\
+as a section being downloaded by \"load\", sends up to this many\n\
+memory-write packets before waiting for the first reply.\n\
+0 or 1 waits for each reply before sending the next packet."),
+			    NULL, show_remote_memory_write_pipeline_depth,
+			    &remote_set_cmdlist, &remote_show_cmdlist);
+
+  /* APPLE LOCAL incremental async packets  */
+  add_setshow_boolean_cmd ("async-packets", no_class,
+			   &remote_async_packets, _("\
+Set whether a running async target's packets are collected as they arrive."), _("\
+Show whether a running async target's packets are collected as they arrive."), _("\
+When on, the characters of a packet from a target running under the\n\
+\"async\" or \"extended-async\" targets are gathered from the event loop\n\
+as they arrive, and GDB only stops to handle the packet once all of it\n\
+is here.  When off, GDB reads the rest of the packet as soon as its\n\
+first characters show up, and does nothing else until it has."),
+			   NULL, show_remote_async_packets,
+			   &remote_set_cmdlist, &remote_show_cmdlist);
+
   add_setshow_zinteger_cmd ("hardware-watchpoint-limit", no_class,
 			    &remote_hw_watchpoint_limit, _("\
 Set the maximum number of target hardware watchpoints."), _("\
@@ -6882,6 +8733,30 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
 			 &remote_set_cmdlist, &remote_show_cmdlist,
 			 1);
 
+  /* APPLE LOCAL binary memory reads  */
+  add_packet_config_cmd (&remote_protocol_binary_read,
+			 "x", "binary-read",
+			 set_remote_protocol_binary_read_cmd,
+			 show_remote_protocol_binary_read_cmd,
+			 &remote_set_cmdlist, &remote_show_cmdlist,
+			 0);
+
+  /* APPLE LOCAL shared memory reads  */
+  add_packet_config_cmd (&remote_protocol_shared_memory,
+			 "vShmOpen", "shared-memory",
+			 set_remote_protocol_shared_memory_cmd,
+			 show_remote_protocol_shared_memory_cmd,
+			 &remote_set_cmdlist, &remote_show_cmdlist,
+			 0);
+
+  /* APPLE LOCAL memory search  */
+  add_packet_config_cmd (&remote_protocol_qSearch_memory,
+			 "qSearch:memory", "search-memory",
+			 set_remote_protocol_qSearch_memory_packet_cmd,
+			 show_remote_protocol_qSearch_memory_packet_cmd,
+			 &remote_set_cmdlist, &remote_show_cmdlist,
+			 0);
+
   add_packet_config_cmd (&remote_protocol_vcont,
 			 "vCont", "verbose-resume",
 			 set_remote_protocol_vcont_packet_cmd,
@@ -7011,4 +8886,16 @@ with the same name as the exec-file, but in the location given by this variable.
   /* APPLE LOCAL */
   add_cmd ("dump-packets", class_maintenance, dump_packets_command,
            "Print the packet log buffer.", &maintenancelist);
+
+  /* APPLE LOCAL remote wire stats  */
+  remote_protocol_wire_stats.name = "Remote protocol";
+  remote_wire_stats_register (&remote_protocol_wire_stats);
+  add_cmd ("remote-stats", class_maintenance, maintenance_info_remote_stats,
+	   _("\
+Print statistics about remote protocol traffic.\n\
+Shows the packets and bytes sent and received, for each type of\n\
+packet and in all, how long replies took to come back, and how much\n\
+of the time the program was stopped was spent waiting for the stub.\n\
+With the argument \"reset\", start counting again from zero."),
+	   &maintenanceinfolist);
 }
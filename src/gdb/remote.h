@@ -105,4 +105,89 @@ struct remote_stats {
 extern uint64_t total_packets_sent;
 extern uint64_t total_packets_received;
 
+/* APPLE LOCAL begin remote wire stats
+   Running totals for one debugging protocol's traffic, reported by
+   "maint info remote-stats": how many packets of each type went out,
+   the bytes each way, how long replies took, and how much of the
+   time the inferior was stopped was spent waiting on the wire.
+   remote.c keeps one for the gdb remote protocol and remote-kdp.c
+   keeps one for KDP.  */
+
+#define REMOTE_WIRE_STATS_MAX_TYPES 64
+#define REMOTE_WIRE_STATS_MAX_SAMPLES 4096
+#define REMOTE_WIRE_STATS_MAX_IN_FLIGHT 64
+
+struct remote_wire_stats_type
+{
+  char name[24];
+  unsigned long count;
+  uint64_t bytes_out;
+  uint64_t bytes_in;
+  /* Sum of the round trip times of the replies, in microseconds.  */
+  uint64_t usec;
+};
+
+struct remote_wire_stats
+{
+  /* The protocol's name, for the report.  */
+  const char *name;
+
+  /* How many requests can be waiting for replies at once.  Sending
+     one more forgets the oldest; a protocol that retransmits on a
+     timeout should use 1.  */
+  int max_in_flight;
+
+  uint64_t packets_out;
+  uint64_t packets_in;
+  uint64_t bytes_out;
+  uint64_t bytes_in;
+
+  int ntypes;
+  struct remote_wire_stats_type types[REMOTE_WIRE_STATS_MAX_TYPES];
+
+  /* The requests waiting for replies, oldest first.  */
+  int in_flight;
+  struct
+  {
+    struct timeval sent;
+    int type;
+  } pending[REMOTE_WIRE_STATS_MAX_IN_FLIGHT];
+
+  /* The round trip times of the last REMOTE_WIRE_STATS_MAX_SAMPLES
+     replies, in microseconds, as a ring.  */
+  unsigned long nsamples;
+  unsigned int samples[REMOTE_WIRE_STATS_MAX_SAMPLES];
+
+  /* The time with at least one request outstanding, in all and while
+     the inferior was stopped.  */
+  struct timeval busy_start;
+  struct timeval busy;
+  struct timeval busy_stopped;
+
+  /* The time the inferior has spent stopped.  */
+  int stopped;
+  struct timeval stop_start;
+  struct timeval stopped_time;
+};
+
+/* Start keeping STATS, which "maint info remote-stats" will report.  */
+extern void remote_wire_stats_register (struct remote_wire_stats *stats);
+
+/* Note a packet of BYTES bytes going out.  Its type is the first
+   TYPE_LEN characters of TYPE.  If EXPECT_REPLY, the next reply
+   received completes its round trip.  */
+extern void remote_wire_stats_send (struct remote_wire_stats *stats,
+				    const char *type, int type_len,
+				    size_t bytes, int expect_reply);
+
+/* Note a packet of BYTES bytes coming in, which IS_REPLY if it answers
+   the oldest outstanding request.  */
+extern void remote_wire_stats_receive (struct remote_wire_stats *stats,
+				       size_t bytes, int is_reply);
+
+/* Note that the inferior has stopped, if STOPPED, or resumed.  */
+extern void remote_wire_stats_stopped (struct remote_wire_stats *stats,
+				       int stopped);
+/* APPLE LOCAL end remote wire stats  */
+
 #endif
@@ -26,6 +26,8 @@
 #include "event-loop.h"
 
 #include "gdb_string.h"
+/* APPLE LOCAL bulk serial reads  */
+#include "gdb_assert.h"
 #include <sys/time.h>
 #ifdef USE_WIN32API
 #include <winsock2.h>
@@ -352,6 +354,46 @@ ser_base_readchar (struct serial *scb, int timeout)
   return generic_readchar (scb, timeout, do_ser_base_readchar);
 }
 
+/* APPLE LOCAL begin bulk serial reads  */
+/* Return how many characters are in the input FIFO, calling
+   DO_READCHAR to fill it if it is empty.  */
+
+int
+generic_peek (struct serial *scb, int timeout,
+	      int (do_readchar) (struct serial *scb, int timeout))
+{
+  int ch;
+
+  if (scb->bufcnt != 0)
+    return scb->bufcnt;
+
+  ch = generic_readchar (scb, timeout, do_readchar);
+  if (ch < 0)
+    return ch;
+
+  /* DO_READCHAR handed us the first character it read; it is still
+     in the FIFO, just before BUFP.  Put it back.  */
+  scb->bufp--;
+  scb->bufcnt++;
+  return scb->bufcnt;
+}
+
+int
+ser_base_peek (struct serial *scb, int timeout)
+{
+  return generic_peek (scb, timeout, do_ser_base_readchar);
+}
+
+void
+ser_base_consume (struct serial *scb, int count)
+{
+  gdb_assert (count >= 0 && count <= scb->bufcnt);
+  scb->bufp += count;
+  scb->bufcnt -= count;
+  reschedule (scb);
+}
+/* APPLE LOCAL end bulk serial reads  */
+
 int
 ser_base_write (struct serial *scb, const char *str, int len)
 {
@@ -50,5 +50,12 @@ extern int ser_base_write (struct serial *scb, const char *str, int len);
 
 extern void ser_base_async (struct serial *scb, int async_p);
 extern int ser_base_readchar (struct serial *scb, int timeout);
+/* APPLE LOCAL begin bulk serial reads  */
+extern int generic_peek (struct serial *scb, int timeout,
+			 int (*do_readchar) (struct serial *scb,
+					     int timeout));
+extern int ser_base_peek (struct serial *scb, int timeout);
+extern void ser_base_consume (struct serial *scb, int count);
+/* APPLE LOCAL end bulk serial reads  */
 
 #endif
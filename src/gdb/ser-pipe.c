@@ -166,5 +166,8 @@ _initialize_ser_pipe (void)
   ops->async = ser_base_async;
   ops->read_prim = ser_unix_read_prim;
   ops->write_prim = ser_unix_write_prim;
+  /* APPLE LOCAL bulk serial reads  */
+  ops->peek = ser_base_peek;
+  ops->consume = ser_base_consume;
   serial_add_interface (ops);
 }
@@ -284,5 +284,8 @@ _initialize_ser_tcp (void)
   ops->async = ser_base_async;
   ops->read_prim = net_read_prim;
   ops->write_prim = net_write_prim;
+  /* APPLE LOCAL bulk serial reads  */
+  ops->peek = ser_base_peek;
+  ops->consume = ser_base_consume;
   serial_add_interface (ops);
 }
@@ -626,6 +626,14 @@ hardwire_readchar (struct serial *scb, int timeout)
   return generic_readchar (scb, timeout, do_hardwire_readchar);
 }
 
+/* APPLE LOCAL begin bulk serial reads  */
+static int
+hardwire_peek (struct serial *scb, int timeout)
+{
+  return generic_peek (scb, timeout, do_hardwire_readchar);
+}
+/* APPLE LOCAL end bulk serial reads  */
+
 
 #ifndef B19200
 #define B19200 EXTA
@@ -892,6 +900,9 @@ _initialize_ser_hardwire (void)
   ops->async = ser_base_async;
   ops->read_prim = ser_unix_read_prim;
   ops->write_prim = ser_unix_write_prim;
+  /* APPLE LOCAL bulk serial reads  */
+  ops->peek = hardwire_peek;
+  ops->consume = ser_base_consume;
   serial_add_interface (ops);
 }
 
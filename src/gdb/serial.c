@@ -25,6 +25,8 @@
 #include "serial.h"
 #include "gdb_string.h"
 #include "gdbcmd.h"
+/* APPLE LOCAL bulk serial reads  */
+#include "gdb_assert.h"
 
 extern void _initialize_serial (void);
 
@@ -381,6 +383,53 @@ serial_readchar (struct serial *scb, int timeout)
   return (ch);
 }
 
+/* APPLE LOCAL begin bulk serial reads  */
+int
+serial_can_peek (struct serial *scb)
+{
+  return scb->ops->peek != NULL && scb->ops->consume != NULL;
+}
+
+int
+serial_peek (struct serial *scb, int timeout, const unsigned char **data)
+{
+  int count;
+
+  gdb_assert (serial_can_peek (scb));
+  count = scb->ops->peek (scb, timeout);
+  if (count > 0)
+    *data = scb->bufp;
+  return count;
+}
+
+void
+serial_consume (struct serial *scb, int count)
+{
+  int i;
+
+  /* Log the characters as they are taken, just as serial_readchar
+     does, so a log reads the same whichever way they were read.  */
+  if (serial_logfp != NULL)
+    {
+      for (i = 0; i < count; i++)
+	serial_logchar (serial_logfp, 'r', scb->bufp[i], 0);
+      gdb_flush (serial_logfp);
+    }
+  if (serial_debug_p (scb))
+    {
+      for (i = 0; i < count; i++)
+	{
+	  fprintf_unfiltered (gdb_stdlog, "[");
+	  serial_logchar (gdb_stdlog, 'r', scb->bufp[i], 0);
+	  fprintf_unfiltered (gdb_stdlog, "]");
+	}
+      gdb_flush (gdb_stdlog);
+    }
+
+  scb->ops->consume (scb, count);
+}
+/* APPLE LOCAL end bulk serial reads  */
+
 int
 serial_write (struct serial *scb, const char *str, int len)
 {
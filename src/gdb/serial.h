@@ -72,6 +72,25 @@ enum serial_rc {
 
 extern int serial_readchar (struct serial *scb, int timeout);
 
+/* APPLE LOCAL begin bulk serial reads  */
+/* Return non-zero if SCB supports serial_peek.  */
+
+extern int serial_can_peek (struct serial *scb);
+
+/* Return the number of characters SCB has already read in, waiting up
+   to TIMEOUT seconds (as for serial_readchar) to read some if there
+   are none, and point *DATA at the first of them.  Returns one of the
+   SERIAL_* codes instead if nothing could be read.  The characters
+   stay in SCB until serial_consume or serial_readchar takes them.  */
+
+extern int serial_peek (struct serial *scb, int timeout,
+			const unsigned char **data);
+
+/* Take the first COUNT of the characters serial_peek returned.  */
+
+extern void serial_consume (struct serial *scb, int count);
+/* APPLE LOCAL end bulk serial reads  */
+
 /* Write LEN chars from STRING to the port SCB.  Returns 0 for
    success, non-zero for failure.  */
 
@@ -238,6 +257,13 @@ struct serial_ops
     /* Perform a low-level write operation, writing (at most) COUNT
        bytes from BUF.  */
     int (*write_prim)(struct serial *scb, const void *buf, size_t count);
+    /* APPLE LOCAL begin bulk serial reads  */
+    /* Make sure SCB->BUF holds some input, waiting up to TIMEOUT
+       seconds for it, and return how much; or a SERIAL_* code.  */
+    int (*peek) (struct serial *scb, int timeout);
+    /* Discard the first COUNT characters of SCB->BUF.  */
+    void (*consume) (struct serial *scb, int count);
+    /* APPLE LOCAL end bulk serial reads  */
   };
 
 /* Add a new serial interface to the interface list */
@@ -228,6 +228,8 @@ solib_add_common_symbols (CORE_ADDR rtc_symp)
       obstack_init (&rt_common_objfile->objfile_obstack);
       rt_common_objfile->minimal_symbol_count = 0;
       rt_common_objfile->msymbols = NULL;
+      rt_common_objfile->msymbol_addrs = NULL;
+      rt_common_objfile->msymbol_addr_index = NULL;
       terminate_minimal_symbol_table (rt_common_objfile);
     }
 
@@ -47,6 +47,12 @@
 #include "completer.h"
 #include "ui-out.h"
 #include "readline/readline.h"
+/* APPLE LOCAL begin source text cache  */
+#include "target.h"
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+/* APPLE LOCAL end source text cache  */
 
 #ifndef O_BINARY
 #define O_BINARY 0
@@ -120,6 +126,163 @@ static int first_line_listed;
 
 static struct symtab *last_source_visited = NULL;
 static int last_source_error = 0;
+
+/* APPLE LOCAL begin source text cache  */
+/* The contents of the last few source files listed or indexed, so
+   that listing a few more lines of a big file doesn't read it again.
+   Where we can, the file is mapped rather than copied.  An entry is
+   only used while the file's inode, size and modification time are
+   the ones it was read with.  The most recently used entry is first.  */
+
+#define SOURCE_TEXT_CACHE_SIZE 4
+
+struct source_text
+{
+  char *fullname;
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  time_t mtime;
+
+  char *data;
+  int length;
+  int mapped;
+};
+
+static struct source_text source_text_cache[SOURCE_TEXT_CACHE_SIZE];
+
+static int source_text_cache_enabled = 1;
+
+static void
+show_source_text_cache_enabled (struct ui_file *file, int from_tty,
+				struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Caching of source file contents is %s.\n"),
+		    value);
+}
+
+static void
+source_text_release (struct source_text *text)
+{
+  if (text->data != NULL)
+    {
+#ifdef HAVE_MMAP
+      if (text->mapped)
+	munmap (text->data, text->length);
+      else
+#endif
+	xfree (text->data);
+    }
+  xfree (text->fullname);
+  memset (text, 0, sizeof (struct source_text));
+}
+
+static void
+source_text_flush (void)
+{
+  int i;
+
+  for (i = 0; i < SOURCE_TEXT_CACHE_SIZE; i++)
+    source_text_release (&source_text_cache[i]);
+}
+
+/* Return the contents of the source file of S, which is open on DESC,
+   reading them in if they aren't cached already.  Return NULL if the
+   cache is off or the file can't be read; the caller should then read
+   DESC itself.  DESC's file offset is unspecified afterwards.  */
+
+static struct source_text *
+source_text_get (struct symtab *s, int desc)
+{
+  struct source_text *text;
+  struct source_text found;
+  struct stat st;
+  int i;
+
+  if (!source_text_cache_enabled || s == NULL || s->fullname == NULL)
+    return NULL;
+  if (fstat (desc, &st) < 0 || st.st_size >= INT_MAX)
+    return NULL;
+
+  for (i = 0; i < SOURCE_TEXT_CACHE_SIZE; i++)
+    {
+      text = &source_text_cache[i];
+      if (text->fullname == NULL || strcmp (text->fullname, s->fullname) != 0)
+	continue;
+      if (text->dev != st.st_dev || text->ino != st.st_ino
+	  || text->size != st.st_size || text->mtime != st.st_mtime)
+	{
+	  /* The file has changed since we read it.  */
+	  source_text_release (text);
+	  break;
+	}
+      found = *text;
+      memmove (&source_text_cache[1], &source_text_cache[0],
+	       i * sizeof (struct source_text));
+      source_text_cache[0] = found;
+      return &source_text_cache[0];
+    }
+
+  memset (&found, 0, sizeof (found));
+  found.length = (int) st.st_size;
+#ifdef HAVE_MMAP
+  if (found.length > 0)
+    {
+      found.data = mmap (NULL, found.length, PROT_READ, MAP_PRIVATE, desc, 0);
+      if (found.data == (char *) MAP_FAILED)
+	found.data = NULL;
+      else
+	found.mapped = 1;
+    }
+#endif
+  if (found.data == NULL)
+    {
+      found.data = xmalloc (found.length + 1);
+      if (lseek (desc, 0, SEEK_SET) < 0)
+	found.length = -1;
+      else
+	/* The read may come up short on systems where \r\n -> \n.  */
+	found.length = myread (desc, found.data, found.length);
+      if (found.length < 0)
+	{
+	  xfree (found.data);
+	  return NULL;
+	}
+    }
+
+  found.fullname = xstrdup (s->fullname);
+  found.dev = st.st_dev;
+  found.ino = st.st_ino;
+  found.size = st.st_size;
+  found.mtime = st.st_mtime;
+
+  source_text_release (&source_text_cache[SOURCE_TEXT_CACHE_SIZE - 1]);
+  memmove (&source_text_cache[1], &source_text_cache[0],
+	   (SOURCE_TEXT_CACHE_SIZE - 1) * sizeof (struct source_text));
+  source_text_cache[0] = found;
+  return &source_text_cache[0];
+}
+
+/* Where print_source_lines_base gets its characters from: the cached
+   contents of the file if there are any, otherwise STREAM.  */
+
+struct source_reader
+{
+  FILE *stream;
+  const char *p;
+  const char *end;
+};
+
+static int
+source_reader_getc (struct source_reader *reader)
+{
+  if (reader->stream != NULL)
+    return fgetc (reader->stream);
+  if (reader->p >= reader->end)
+    return EOF;
+  return (unsigned char) *reader->p++;
+}
+/* APPLE LOCAL end source text cache  */
 
 /* Return the first line listed by print_source_lines.
    Used by command interpreters to request listing from
@@ -335,6 +498,8 @@ forget_cached_source_info (void)
 	      xfree (s->fullname);
 	      s->fullname = NULL;
 	    }
+	  /* APPLE LOCAL source fullname misses  */
+	  s->fullname_miss_generation = 0;
 	}
 
       ALL_OBJFILE_PSYMTABS (objfile, pst)
@@ -344,8 +509,13 @@ forget_cached_source_info (void)
 	    xfree (pst->fullname);
 	    pst->fullname = NULL;
 	  }
+	/* APPLE LOCAL source fullname misses  */
+	pst->fullname_miss_generation = 0;
       }
     }
+
+  /* APPLE LOCAL source text cache  */
+  source_text_flush ();
 }
 
 void
@@ -636,8 +806,10 @@ source_info (char *ignore, int from_tty)
 
   printf_filtered (_("Source language is %s.\n"), language_str (s->language));
   printf_filtered (_("Compiled with %s debugging format.\n"), s->debugformat);
+  /* APPLE LOCAL lazy macro tables: Don't read them just to say so.  */
   printf_filtered (_("%s preprocessor macro info.\n"),
-                   s->macro_table ? "Includes" : "Does not include");
+                   (s->macro_table || s->lazy_macro_table)
+		   ? "Includes" : "Does not include");
 }
 
 
@@ -1124,11 +1296,28 @@ find_and_open_source (struct objfile *objfile,
 int
 open_source_file (struct symtab *s)
 {
+  /* APPLE LOCAL source fullname misses  */
+  int desc;
+
   if (!s)
     return -1;
 
-  return find_and_open_source (s->objfile, s->filename, s->dirname, 
+  /* APPLE LOCAL begin source fullname misses  */
+  /* Don't search the source path again for a file we didn't find
+     there since the inferior last stopped.  */
+  if (s->fullname == NULL
+      && s->fullname_miss_generation == target_stop_generation)
+    {
+      errno = ENOENT;
+      return -1;
+    }
+
+  desc = find_and_open_source (s->objfile, s->filename, s->dirname,
 			       &s->fullname);
+  if (desc < 0)
+    s->fullname_miss_generation = target_stop_generation;
+  return desc;
+  /* APPLE LOCAL end source fullname misses  */
 }
 
 /* Finds the fullname that a symtab represents.
@@ -1152,17 +1341,27 @@ symtab_to_fullname (struct symtab *s)
   if (s->fullname)
     return s->fullname;
 
+  /* APPLE LOCAL begin source fullname misses  */
+  /* Every frame printed in a stop can ask for the same file; only
+     search for a missing one once per stop.  */
+  if (s->fullname_miss_generation == target_stop_generation)
+    return NULL;
+  /* APPLE LOCAL end source fullname misses  */
+
   /* Don't check s->fullname here, the file could have been 
      deleted/moved/..., look for it again */
   r = find_and_open_source (s->objfile, s->filename, s->dirname,
 			    &s->fullname);
 
-  if (r)
+  /* APPLE LOCAL source fullname misses: Test for >= 0, not non-zero.  */
+  if (r >= 0)
     {
       close (r);
       return s->fullname;
     }
 
+  /* APPLE LOCAL source fullname misses  */
+  s->fullname_miss_generation = target_stop_generation;
   return NULL;
 }
 
@@ -1187,17 +1386,24 @@ psymtab_to_fullname (struct partial_symtab *ps)
   if (ps->fullname)
     return ps->fullname;
 
+  /* APPLE LOCAL source fullname misses  */
+  if (ps->fullname_miss_generation == target_stop_generation)
+    return NULL;
+
   /* Don't check ps->fullname here, the file could have been
      deleted/moved/..., look for it again */
   r = find_and_open_source (ps->objfile, ps->filename, ps->dirname,
 			    &ps->fullname);
 
-  if (r) 
+  /* APPLE LOCAL source fullname misses: Test for >= 0, not non-zero.  */
+  if (r >= 0)
     {
       close (r);
       return ps->fullname;
     }
 
+  /* APPLE LOCAL source fullname misses  */
+  ps->fullname_miss_generation = target_stop_generation;
   return NULL;
 }
 
@@ -1264,20 +1470,35 @@ find_source_lines (struct symtab *s, int desc)
     int eol = 0;
     char oldc;
     register char *data, *p, *end;
+    /* APPLE LOCAL source text cache  */
+    struct source_text *text;
 
     /* st_size might be a large type, but we only support source files whose 
        size fits in an int.  */
     size = (int) st.st_size;
 
-    /* Use malloc, not alloca, because this may be pretty large, and we may
-       run into various kinds of limits on stack size.  */
-    data = (char *) xmalloc (size);
-    old_cleanups = make_cleanup (xfree, data);
-
-    /* Reassign `size' to result of read for systems where \r\n -> \n.  */
-    size = myread (desc, data, size);
-    if (size < 0)
-      perror_with_name (s->filename);
+    /* APPLE LOCAL begin source text cache  */
+    old_cleanups = make_cleanup (null_cleanup, NULL);
+    text = source_text_get (s, desc);
+    if (text != NULL)
+      {
+	data = text->data;
+	size = text->length;
+      }
+    else
+      {
+	/* Use malloc, not alloca, because this may be pretty large, and
+	   we may run into various kinds of limits on stack size.  */
+	data = (char *) xmalloc (size);
+	make_cleanup (xfree, data);
+
+	/* Reassign `size' to result of read for systems where
+	   \r\n -> \n.  */
+	size = myread (desc, data, size);
+	if (size < 0)
+	  perror_with_name (s->filename);
+      }
+    /* APPLE LOCAL end source text cache  */
     end = data + size;
     p = data;
     line_charpos[0] = 0;
@@ -1428,6 +1649,10 @@ print_source_lines_base (struct symtab *s, int line, int nlines, int noerror)
   int c, oldc;
   int eol;
   int just_kidding_about_error = 0;
+  /* APPLE LOCAL begin source text cache  */
+  struct source_text *text;
+  struct source_reader reader;
+  /* APPLE LOCAL end source text cache  */
 
   /* Regardless of whether we can open the file, set current_source_symtab. */
   current_source_symtab = s;
@@ -1508,16 +1733,31 @@ print_source_lines_base (struct symtab *s, int line, int nlines, int noerror)
 	     line, s->filename, s->nlines);
     }
 
-  if (lseek (desc, s->line_charpos[line - 1], 0) < 0)
+  /* APPLE LOCAL begin source text cache  */
+  text = source_text_get (s, desc);
+  if (text != NULL && s->line_charpos[line - 1] <= text->length)
     {
       close (desc);
-      perror_with_name (s->filename);
+      stream = NULL;
+      reader.stream = NULL;
+      reader.p = text->data + s->line_charpos[line - 1];
+      reader.end = text->data + text->length;
     }
+  else
+    {
+      if (lseek (desc, s->line_charpos[line - 1], 0) < 0)
+	{
+	  close (desc);
+	  perror_with_name (s->filename);
+	}
 
-  stream = fdopen (desc, FDOPEN_MODE);
-  clearerr (stream);
+      stream = fdopen (desc, FDOPEN_MODE);
+      clearerr (stream);
+      reader.stream = stream;
+    }
 
-  c = fgetc (stream);
+  c = source_reader_getc (&reader);
+  /* APPLE LOCAL end source text cache  */
   eol = 0;
 
   while (nlines-- > 0)
@@ -1550,7 +1790,8 @@ print_source_lines_base (struct symtab *s, int line, int nlines, int noerror)
 	    {
 	      ui_out_text_fmt (uiout, "%c", c);
 	    }
-          c = fgetc (stream);
+          /* APPLE LOCAL source text cache  */
+          c = source_reader_getc (&reader);
           if (c == EOF)
             break;
         }
@@ -1558,7 +1799,9 @@ print_source_lines_base (struct symtab *s, int line, int nlines, int noerror)
       ui_out_text (uiout, "\n");
     }
 
-  fclose (stream);
+  /* APPLE LOCAL source text cache  */
+  if (stream != NULL)
+    fclose (stream);
 }
 
 /* Show source lines from the file of symtab S, starting with line
@@ -1994,4 +2237,16 @@ pathname-substitutions /path1/from /new/path1/to '/path2/with space/from' /path2
 			  show_pathname_substitutions,
 			  &setlist, &showlist);
   /* APPLE LOCAL end pathname substitution */
+
+  /* APPLE LOCAL source text cache  */
+  add_setshow_boolean_cmd ("source-text-cache", class_maintenance,
+			   &source_text_cache_enabled, _("\
+Set whether the contents of recently listed source files are kept."), _("\
+Show whether the contents of recently listed source files are kept."), _("\
+When on, the last few source files listed are kept in memory, mapped\n\
+from the file where possible, so that listing more of them doesn't read\n\
+them again.  A file is read again once it changes on disk."),
+			   NULL, show_source_text_cache_enabled,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
 }
@@ -104,6 +104,12 @@ struct header_file
 
     int length;
 
+    /* APPLE LOCAL begin header file hash  */
+    /* The hash of NAME, and the index of the next header file in the
+       same bucket of the objfile's header_file_buckets, or -1.  */
+    unsigned long hash;
+    int next_in_bucket;
+    /* APPLE LOCAL end header file hash  */
   };
 
 /* The table of header_files of this OBJFILE. */
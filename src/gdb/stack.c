@@ -1566,6 +1566,88 @@ backtrace_full_command (char *arg, int from_tty)
   btargs.from_tty = from_tty;
   catch_errors (backtrace_command_stub, (char *)&btargs, "", RETURN_MASK_ERROR);
 }
+
+/* APPLE LOCAL begin backtrace-lite  */
+/* Print one frame for backtrace-lite: its level, pc and the name of
+   the minimal symbol containing the pc, and nothing else.  This has
+   the signature FAST_COUNT_STACK_DEPTH wants for its print function.  */
+
+static void
+print_frame_lite (struct ui_out *uiout, int *frame_num, CORE_ADDR pc,
+		  CORE_ADDR fp)
+{
+  struct cleanup *tuple_chain;
+  struct minimal_symbol *msym;
+
+  tuple_chain = make_cleanup_ui_out_tuple_begin_end (uiout, "frame");
+  ui_out_text (uiout, "#");
+  ui_out_field_fmt_int (uiout, 2, ui_left, "level", *frame_num);
+  ui_out_text (uiout, " ");
+  ui_out_field_core_addr (uiout, "addr", pc);
+  ui_out_text (uiout, " in ");
+
+  pc_set_load_state (pc, OBJF_SYM_ALL, 0);
+  msym = lookup_minimal_symbol_by_pc (pc);
+  if (msym != NULL && SYMBOL_PRINT_NAME (msym) != NULL)
+    ui_out_field_string (uiout, "func", SYMBOL_PRINT_NAME (msym));
+  else
+    ui_out_field_string (uiout, "func", "??");
+  ui_out_text (uiout, "\n");
+  do_cleanups (tuple_chain);
+}
+
+/* Print the pc and function of the innermost COUNT frames, or of all
+   of them.  Unlike "backtrace", this doesn't build symtabs, look up
+   source lines or evaluate arguments, and where the target has a
+   FAST_COUNT_STACK_DEPTH walker it doesn't build frames past the
+   first few either.  It is meant for sampling many threads quickly,
+   e.g. with "thread apply all backtrace-lite".  */
+
+static void
+backtrace_lite_command (char *arg, int from_tty)
+{
+  unsigned int limit = (unsigned int) -1;
+  unsigned int count = 0;
+  int valid;
+
+  if (!target_has_stack)
+    error (_("No stack."));
+
+  if (arg != NULL && *arg != '\0')
+    {
+      LONGEST n = parse_and_eval_long (arg);
+      if (n <= 0)
+	error (_("backtrace-lite takes a positive frame count."));
+      limit = n;
+    }
+
+#ifdef FAST_COUNT_STACK_DEPTH
+  valid = FAST_COUNT_STACK_DEPTH (limit, 0, limit, &count, print_frame_lite);
+#else
+  {
+    struct cleanup *list_chain;
+    struct frame_info *fi;
+    int i;
+
+    list_chain = make_cleanup_ui_out_list_begin_end (uiout, "frames");
+    for (i = 0, fi = get_current_frame ();
+	 fi != NULL && i < limit;
+	 fi = get_prev_frame (fi), i++)
+      {
+	QUIT;
+	print_frame_lite (uiout, &i, get_frame_pc (fi), get_frame_base (fi));
+      }
+    do_cleanups (list_chain);
+    count = i;
+    valid = 1;
+  }
+#endif
+
+  if (!valid)
+    warning (_("Backtrace stopped after %u frames; the stack may be corrupt."),
+	     count);
+}
+/* APPLE LOCAL end backtrace-lite  */
 
 
 /* Print the local variables of a block B active in FRAME.
@@ -2428,6 +2510,12 @@ Print backtrace of all stack frames, or innermost COUNT frames.\n\
 With a negative argument, print outermost -COUNT frames.\n\
 Use of the 'full' qualifier also prints the values of the local variables.\n"));
   add_com_alias ("bt", "backtrace", class_stack, 0);
+  /* APPLE LOCAL backtrace-lite  */
+  add_com ("backtrace-lite", class_stack, backtrace_lite_command, _("\
+Print the pc and function of all stack frames, or innermost COUNT frames.\n\
+No arguments, source lines or debug info are looked up, so this is much\n\
+faster than \"backtrace\" on deep or many-threaded stacks.  The MI\n\
+equivalent is -stack-list-frames-lite -names 1."));
   if (xdb_commands)
     {
       add_com_alias ("t", "backtrace", class_stack, 0);
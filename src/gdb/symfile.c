@@ -70,6 +70,8 @@
 #include <libgen.h>
 
 #include <sys/mman.h>
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
 
 #ifndef TEXT_SECTION_NAME
 #define TEXT_SECTION_NAME ".text"
@@ -358,12 +360,22 @@ psymtab_to_symtab (struct partial_symtab *pst)
   if (!pst->readin)
     {
       struct cleanup *back_to = make_cleanup (decrement_reading_symtab, NULL);
+      /* APPLE LOCAL gdb stats  */
+      struct gdb_stat_timer stat_timer;
+
       start_timer (&timer, "psymtab-to-symtab", 
 				   pst->fullname ?
 				   pst->fullname : pst->filename);
 
+      /* APPLE LOCAL deferred psymbol relocation  */
+      objfile_relocate_psymbols (pst->objfile);
+
       currently_reading_symtab++;
+      /* APPLE LOCAL gdb stats  */
+      gdb_stat_start (GDB_STAT_PSYMTAB_EXPAND, &stat_timer);
       (*pst->read_symtab) (pst);
+      /* APPLE LOCAL gdb stats  */
+      gdb_stat_stop (GDB_STAT_PSYMTAB_EXPAND, &stat_timer, 0);
       do_cleanups (back_to);
     }
 
@@ -1200,6 +1212,9 @@ append_psymbols_as_msymbols (struct objfile *objfile)
   back_to = make_cleanup_discard_minimal_symbols ();
 
 
+  /* APPLE LOCAL deferred psymbol relocation  */
+  objfile_relocate_psymbols (dsym_objfile);
+
   /* Append msymbols for all global partial symbols that are functions.  */
   if (dsym_objfile->global_psymbols.list && dsym_objfile->global_psymbols.next)
     {
@@ -1384,6 +1399,9 @@ replace_psymbols_with_correct_psymbols (struct objfile *exe_obj)
 
   dsym_obj->psymtabs = NULL;
 
+  /* APPLE LOCAL deferred psymbol relocation  */
+  objfile_relocate_psymbols (exe_obj);
+
   ALL_OBJFILE_PSYMTABS (exe_obj, exe_pst)
     {
       struct partial_symbol **psym;
@@ -1647,6 +1665,11 @@ symbol_file_add_with_addrs_or_offsets_using_objfile (struct objfile *in_objfile,
   syms_from_objfile (objfile, addrs, offsets, num_offsets,
 		     mainline, from_tty);
 
+  /* APPLE LOCAL demangled names cache: Save the names now, rather
+     than only when the objfile goes away, since gdb often exits
+     without freeing its objfiles.  */
+  save_demangled_names_cache (objfile);
+
   /* We now have at least a partial symbol table.  Check to see if the
      user requested that all symbols be read on initial access via either
      the gdb startup command line or on a per symbol file basis.  Expand
@@ -2418,6 +2441,18 @@ The write size used when downloading a program is %s.\n"),
 		    value);
 }
 static int validate_download = 0;
+/* APPLE LOCAL begin load skip unchanged  */
+/* Don't download a section the target says it already holds.  */
+static int load_skip_unchanged = 1;
+static void
+show_load_skip_unchanged (struct ui_file *file, int from_tty,
+			  struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Skipping sections already present on the target during \"load\" is %s.\n"),
+		    value);
+}
+/* APPLE LOCAL end load skip unchanged  */
 
 /* Callback service function for generic_load (bfd_map_over_sections).  */
 
@@ -2524,6 +2559,20 @@ load_section_callback (bfd *abfd, asection *asec, void *data)
 
   bfd_get_section_contents (abfd, asec, buffer, 0, size);
 
+  /* APPLE LOCAL begin load skip unchanged  */
+  /* Reloading after a small change usually leaves most sections as
+     they were; if the target can check one without reading it back,
+     don't send it again.  */
+  if (load_skip_unchanged
+      && target_verify_memory (buffer, args->lma, size) == 1)
+    {
+      ui_out_message (uiout, 0, "Section %s unchanged, not loaded\n",
+		      sect_name);
+      do_cleanups (old_chain);
+      return;
+    }
+  /* APPLE LOCAL end load skip unchanged  */
+
   transferred = target_write_with_progress (&current_target,
 					    TARGET_OBJECT_MEMORY,
 					    NULL, buffer, args->lma,
@@ -3591,7 +3640,12 @@ reread_symbols_for_objfile (struct objfile *objfile, long new_modtime,
     {
       htab_delete (objfile->demangled_names_hash);
       objfile->demangled_names_hash = NULL;
+      /* APPLE LOCAL demangled names cache  */
+      objfile->demangled_names_saved = 0;
     }
+  /* APPLE LOCAL shared names: The symbol reader will attach it again
+     if it still wants it.  */
+  objfile_release_shared_names (objfile);
   obstack_free (&objfile->objfile_obstack, 0);
   objfile->sections = NULL;
   objfile->symtabs = NULL;
@@ -3601,11 +3655,15 @@ reread_symbols_for_objfile (struct objfile *objfile, long new_modtime,
   objfile->msymbols = NULL;
   objfile->deprecated_sym_private = NULL;
   objfile->minimal_symbol_count = 0;
+  objfile->msymbol_addrs = NULL;
+  objfile->msymbol_addr_index = NULL;
   memset (&objfile->msymbol_hash, 0,
 	  sizeof (objfile->msymbol_hash));
   memset (&objfile->msymbol_demangled_hash, 0,
 	  sizeof (objfile->msymbol_demangled_hash));
-  objfile->minimal_symbols_demangled = 0;
+  /* APPLE LOCAL lazy minsym demangling: There are no minimal symbols
+     left to demangle.  */
+  objfile->minimal_symbols_demangled = 1;
   objfile->fundamental_types = NULL;
   clear_objfile_data (objfile);
   if (objfile->sf != NULL)
@@ -3617,11 +3675,9 @@ reread_symbols_for_objfile (struct objfile *objfile, long new_modtime,
   objfile->md = NULL;
   objfile->psymbol_cache = bcache_xmalloc (NULL);
   objfile->macro_cache = bcache_xmalloc (NULL);
-  /* obstack_init also initializes the obstack so it is
-     empty.  We could use obstack_specify_allocation but
-     gdb_obstack.h specifies the alloc/dealloc
-     functions.  */
-  obstack_init (&objfile->objfile_obstack);
+  /* APPLE LOCAL objfile memory: Start the obstack again, empty, with
+     the same chunk size a new objfile would get.  */
+  objfile_obstack_init (objfile);
   if (build_objfile_section_table (objfile))
     {
       error (_("Can't find the file sections in `%s': %s"),
@@ -3709,6 +3765,55 @@ reread_symbols_for_objfile (struct objfile *objfile, long new_modtime,
   return 1;
 }
 
+/* APPLE LOCAL begin reread unchanged uuids  */
+/* When set, an objfile whose file on disk has a new mtime but still
+   carries the same Mach-O LC_UUID is assumed not to have changed.  */
+
+static int reread_compare_uuids = 1;
+
+static void
+show_reread_compare_uuids (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Comparing UUIDs before re-reading a touched symbol file is %s.\n"),
+		    value);
+}
+
+/* Return 1 if the file backing OBJFILE has the same UUID as the one
+   OBJFILE was read from, so that a newer mtime only means the file was
+   touched or re-linked identically.  */
+
+static int
+objfile_uuid_unchanged_p (struct objfile *objfile)
+{
+  unsigned char uuid[16];
+  uint8_t **file_uuids;
+  int i;
+  int unchanged = 0;
+
+  if (!reread_compare_uuids || objfile->obfd == NULL)
+    return 0;
+
+  if (!bfd_mach_o_get_uuid (objfile->obfd, uuid, sizeof (uuid)))
+    return 0;
+
+  file_uuids = get_binary_file_uuids (objfile->obfd->filename);
+  if (file_uuids == NULL)
+    return 0;
+
+  for (i = 0; file_uuids[i] != NULL; i++)
+    if (memcmp (file_uuids[i], uuid, sizeof (uuid)) == 0)
+      {
+	unchanged = 1;
+	break;
+      }
+
+  free_uuids_array (file_uuids);
+  return unchanged;
+}
+/* APPLE LOCAL end reread unchanged uuids  */
+
 /* Re-read symbols if a symbol-file has changed.  */
 void
 reread_symbols (void)
@@ -3773,6 +3878,16 @@ reread_symbols (void)
 	      warning ("Can't find backing file for \"%s\".",
 		     objfile->obfd->filename);
 	    }
+	  /* APPLE LOCAL begin reread unchanged uuids  */
+	  else if (new_modtime != objfile->mtime
+		   && objfile_uuid_unchanged_p (objfile))
+	    {
+	      /* Keep the psymtabs, symtabs and breakpoint locations we
+		 already have; just don't look at this file again until
+		 it is touched again.  */
+	      objfile->mtime = new_modtime;
+	    }
+	  /* APPLE LOCAL end reread unchanged uuids  */
 	  else if (new_modtime != objfile->mtime)
 	    {
 	      /* APPLE LOCAL: put the re-reading of an objfile into a separate
@@ -3863,6 +3978,124 @@ remove_symbol_file_command (args, from_tty)
 }
 /* APPLE LOCAL end remove symbol file */
 
+/* APPLE LOCAL begin debug info on demand  */
+/* Read DEBUG_FILE as the separate debug objfile of OBJFILE, if its
+   UUID matches.  */
+
+static void
+add_separate_debug_objfile (struct objfile *objfile, char *debug_file)
+{
+  /* Use the same section offset table as objfile itself.
+     Preserve the flags from objfile that make sense.  */
+  struct section_offsets *sym_offsets = NULL;
+  int num_sym_offsets = 0;
+  bfd *debug_bfd;
+  int uuid_matches;
+  enum gdb_osabi objfile_osabi = GDB_OSABI_UNKNOWN;
+
+  /* APPLE LOCAL: Handle the possible offset of file & separate debug file.  */
+#ifdef MACOSX_DYLD
+  objfile_osabi = macosx_get_osabi_from_dyld_entry (objfile->obfd);
+#endif
+
+  debug_bfd = symfile_bfd_open (debug_file, 0, objfile_osabi); 
+
+  /* Don't bother to make the debug_objfile if the UUID's don't
+     match.  */
+  if (objfile->not_loaded_kext_filename)
+    /* FIXME will kextutil -s copy the uuid over to the output
+       binary?  Drop it?  Modify it?  That will determine what
+       should be done here.  Right now kextutil drops it.  
+       NB we have the original unloaded kext over in
+       objfile->not_loaded_kext_filename and we could try to
+       match that file's UUID with the dSYM's.  */
+    uuid_matches = 1;
+  else
+    uuid_matches = check_bfd_for_matching_uuid (objfile->obfd, debug_bfd);
+
+  if (uuid_matches)
+    {
+#ifdef TM_NEXTSTEP
+      /* This should really be a symbol file reader function to go along with
+	 sym_offsets, but I don't want to have to push all the changes through
+	 for that right now.  NOTE, this is a TM not an NM thing because even
+	 the cross debugger uses dsym's.  */
+      macho_calculate_offsets_for_dsym (objfile, debug_bfd, NULL, 
+					objfile->section_offsets, 
+					objfile->num_sections,
+					&sym_offsets, &num_sym_offsets);
+#endif /* TM_NEXTSTEP */
+      
+      objfile->separate_debug_objfile
+	= (symbol_file_add_with_addrs_or_offsets
+	   (debug_bfd,
+	    info_verbose, /* from_tty: Don't override the default. */
+	    0, /* No addr table.  */
+	    sym_offsets, num_sym_offsets,
+	    0, /* Not mainline.  See comments about this above.  */
+	    objfile->flags & (OBJF_REORDERED | OBJF_SHARED | OBJF_READNOW
+			      /* APPLE LOCAL symfile */
+			      | OBJF_USERLOADED | OBJF_SEPARATE_DEBUG_FILE),
+	    OBJF_SYM_ALL, 0, NULL, 0));
+      
+      xfree (sym_offsets);
+      objfile->separate_debug_objfile->separate_debug_objfile_backlink
+	= objfile;
+      
+      /* APPLE LOCAL: Put the separate debug object before the normal one, 
+	 this is so that usage of the ALL_OBJFILES_SAFE macro will stay 
+	 safe. */
+      put_objfile_before (objfile->separate_debug_objfile, objfile);
+    }
+  else
+    bfd_close (debug_bfd);
+}
+
+/* If OBJFILE was read at a load level too low to look for its dSYM,
+   read just the dSYM now, leaving OBJFILE itself at its current
+   level, and return the dSYM's objfile.  Reading the dSYM only builds
+   its psymtabs (with a dwarf2 name index, little more than each
+   compilation unit's address range); a lookup that needs debug info
+   then expands just the compilation unit covering its pc or name.
+   Return NULL if OBJFILE has no dSYM we can use this way.  */
+
+struct objfile *
+symbol_file_add_separate_debug_on_demand (struct objfile *objfile)
+{
+#ifdef TM_NEXTSTEP
+  char *debug_file;
+
+  if (objfile->separate_debug_objfile != NULL)
+    return objfile->separate_debug_objfile;
+
+  if (objfile->separate_debug_objfile_backlink != NULL
+      || objfile->obfd == NULL
+      || objfile->not_loaded_kext_filename != NULL
+      || (objfile->symflags & OBJF_SYM_DONT_CHANGE)
+      || (objfile->symflags & OBJF_SYM_LEVELS_MASK) == OBJF_SYM_ALL)
+    return NULL;
+
+  debug_file = macosx_locate_dsym_any_level (objfile);
+  if (debug_file == NULL)
+    return NULL;
+
+  add_separate_debug_objfile (objfile, debug_file);
+  xfree (debug_file);
+
+  if (objfile->separate_debug_objfile != NULL)
+    {
+      /* Stepping wants msymbols for everything the dSYM knows about,
+	 just as when it is read along with OBJFILE.  */
+      append_psymbols_as_msymbols (objfile);
+      breakpoint_re_set (objfile->separate_debug_objfile);
+    }
+  return objfile->separate_debug_objfile;
+#else
+  return NULL;
+#endif
+}
+/* APPLE LOCAL end debug info on demand  */
+
 /* Handle separate debug info for OBJFILE, which has just been
    re-read:
    - If we had separate debug info before, but now we don't, get rid
@@ -3911,74 +4144,8 @@ reread_separate_symbols (struct objfile *objfile)
   /* If the new objfile has separate debug info, and we
      haven't loaded it already, do so now.  */
   if (debug_file && ! objfile->separate_debug_objfile)
-    {
-      /* Use the same section offset table as objfile itself.
-         Preserve the flags from objfile that make sense.  */
-      struct section_offsets *sym_offsets = NULL;
-      int num_sym_offsets = 0;
-      bfd *debug_bfd;
-      int uuid_matches;
-      enum gdb_osabi objfile_osabi = GDB_OSABI_UNKNOWN;
-
-      /* APPLE LOCAL: Handle the possible offset of file & separate debug file.  */
-#ifdef MACOSX_DYLD
-      objfile_osabi = macosx_get_osabi_from_dyld_entry (objfile->obfd);
-#endif
+    add_separate_debug_objfile (objfile, debug_file);
 
-      debug_bfd = symfile_bfd_open (debug_file, 0, objfile_osabi); 
-
-      /* Don't bother to make the debug_objfile if the UUID's don't
-	 match.  */
-      if (objfile->not_loaded_kext_filename)
-	/* FIXME will kextutil -s copy the uuid over to the output
-	   binary?  Drop it?  Modify it?  That will determine what
-	   should be done here.  Right now kextutil drops it.  
-	   NB we have the original unloaded kext over in
-	   objfile->not_loaded_kext_filename and we could try to
-	   match that file's UUID with the dSYM's.  */
-	uuid_matches = 1;
-      else
-	uuid_matches = check_bfd_for_matching_uuid (objfile->obfd, debug_bfd);
-
-      if (uuid_matches)
-	{
-#ifdef TM_NEXTSTEP
-	  /* This should really be a symbol file reader function to go along with
-	     sym_offsets, but I don't want to have to push all the changes through
-	     for that right now.  NOTE, this is a TM not an NM thing because even
-	     the cross debugger uses dsym's.  */
-	  macho_calculate_offsets_for_dsym (objfile, debug_bfd, NULL, 
-					    objfile->section_offsets, 
-                                            objfile->num_sections,
-					    &sym_offsets, &num_sym_offsets);
-#endif /* TM_NEXTSTEP */
-	  
-	  objfile->separate_debug_objfile
-	    = (symbol_file_add_with_addrs_or_offsets
-	       (debug_bfd,
-		info_verbose, /* from_tty: Don't override the default. */
-		0, /* No addr table.  */
-		sym_offsets, num_sym_offsets,
-		0, /* Not mainline.  See comments about this above.  */
-		objfile->flags & (OBJF_REORDERED | OBJF_SHARED | OBJF_READNOW
-				  /* APPLE LOCAL symfile */
-				  | OBJF_USERLOADED | OBJF_SEPARATE_DEBUG_FILE),
-		OBJF_SYM_ALL, 0, NULL, 0));
-	  
-	  xfree (sym_offsets);
-	  objfile->separate_debug_objfile->separate_debug_objfile_backlink
-	    = objfile;
-	  
-	  /* APPLE LOCAL: Put the separate debug object before the normal one, 
-	     this is so that usage of the ALL_OBJFILES_SAFE macro will stay 
-             safe. */
-	  put_objfile_before (objfile->separate_debug_objfile, objfile);
-	  
-	}
-      else
-	bfd_close (debug_bfd);
-    }
-    
     /* APPLE LOCAL: Clean up our debug_file.  */
     if (debug_file)
       xfree (debug_file);
@@ -4520,6 +4687,11 @@ start_psymtab_common (struct objfile *objfile,
 {
   struct partial_symtab *psymtab;
 
+  /* APPLE LOCAL deferred psymbol relocation: The psymbols about to be
+     added will be relocated by the current offsets; bring any older
+     ones up to the same offsets first.  */
+  objfile_relocate_psymbols (objfile);
+
   psymtab = allocate_psymtab (filename, objfile);
   psymtab->section_offsets = section_offsets;
   psymtab->textlow = textlow;
@@ -4673,6 +4845,10 @@ add_psymbol_with_dem_name_to_list (char *name, int namelength, char *dem_name,
 void
 init_psymbol_list (struct objfile *objfile, int total_symbols)
 {
+  /* APPLE LOCAL deferred psymbol relocation: the old psymbols are
+     going away, so there is nothing left to relocate.  */
+  objfile->psymbol_relocation_pending = 0;
+
   /* Free any previously allocated psymbol lists.  */
 
   if (objfile->global_psymbols.list)
@@ -5904,6 +6080,19 @@ Show dynamic symbol table reloading multiple times in one run."), NULL,
 			   show_symbol_reloading,
 			   &setlist, &showlist);
 
+  /* APPLE LOCAL begin reread unchanged uuids  */
+  add_setshow_boolean_cmd ("reread-compare-uuids", class_maintenance,
+			   &reread_compare_uuids, _("\
+Set whether a touched symbol file with an unchanged UUID is re-read."), _("\
+Show whether a touched symbol file with an unchanged UUID is re-read."), _("\
+When on, a symbol file whose modification time changed but whose Mach-O\n\
+UUID is still the one gdb read it with keeps its symbols and breakpoint\n\
+locations across a re-run; only files that really changed are re-read."),
+			   NULL, show_reread_compare_uuids,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end reread unchanged uuids  */
+
   add_prefix_cmd ("overlay", class_support, overlay_command,
 		  _("Commands for debugging overlays."), &overlaylist,
 		  "overlay ", 0, &cmdlist);
@@ -5956,6 +6145,18 @@ cache."),
 			   show_download_write_size,
 			   &setlist, &showlist);
 
+  /* APPLE LOCAL load skip unchanged  */
+  add_setshow_boolean_cmd ("load-skip-unchanged", class_obscure,
+			   &load_skip_unchanged, _("\
+Set whether \"load\" skips sections the target already holds."), _("\
+Show whether \"load\" skips sections the target already holds."), _("\
+When on, \"load\" first asks the target, where it can do so without\n\
+reading the memory back (e.g. with the remote \"qCRC\" packet), whether\n\
+each section's contents are already in place, and doesn't download\n\
+the ones that are."),
+			   NULL, show_load_skip_unchanged,
+			   &setlist, &showlist);
+
   /* APPLE LOCAL: For the add-kext command.  */
   add_setshow_optional_filename_cmd ("kext-symbol-file-path", class_support,
 				     &kext_symbol_file_path, _("\
@@ -340,6 +340,9 @@ extern int dwarf2_has_info (struct objfile *);
 
 extern void dwarf2_build_psymtabs (struct objfile *, int);
 extern void dwarf2_build_frame_info (struct objfile *);
+/* APPLE LOCAL objfile memory  */
+extern unsigned long dwarf2_objfile_cache_memory_used (struct objfile *,
+						       int *);
 extern void dwarf2_kext_psymtab_to_symtab (struct partial_symtab *);
 extern void dwarf2_debug_map_psymtab_to_symtab (struct partial_symtab *);
 /* APPLE LOCAL: Scanning pubtypes tables for psymbols.  */
@@ -349,6 +352,15 @@ extern void dwarf2_scan_pubtype_for_psymbols (struct partial_symtab *,
 extern void dwarf2_scan_inlined_section_for_psymbols (struct partial_symtab *, 
 						      struct objfile *, 
 						      enum language);
+/* APPLE LOCAL debug map prefetch  */
+struct dwarf2_oso_prefetch;
+extern int dwarf2_oso_prefetch_wanted (void);
+extern struct dwarf2_oso_prefetch *dwarf2_start_oso_prefetch (char **, int);
+extern void dwarf2_finish_oso_prefetch (void *);
+/* APPLE LOCAL dwarf2 name index  */
+extern void dwarf2_name_index_expand (const char *);
+extern int dwarf2_name_index_psymtab_match (struct partial_symtab *,
+					    const char *);
 
 /* From dbxread.c */
 
@@ -410,6 +422,9 @@ extern struct objfile *symbol_file_add_bfd_using_objfile
 bfd *open_bfd_matching_arch (bfd *archive_bfd, bfd_format expected_format,
 			     enum gdb_osabi osabi);
 
+/* APPLE LOCAL debug info on demand  */
+struct objfile *symbol_file_add_separate_debug_on_demand (struct objfile *);
+
 struct objfile *symbol_file_add_with_addrs_or_offsets_using_objfile (struct objfile *, bfd *, int, struct section_addr_info *, struct section_offsets *, int, int, int, int, CORE_ADDR, const char *, char *);
 
 struct objfile * symbol_file_add_name_with_addrs_or_offsets (const char *name, int from_tty, struct section_addr_info *addrs, struct section_offsets *offsets, int num_offsets, int mainline, int flags, int symflags, CORE_ADDR mapaddr, const char *prefix, char *kext_bundle);
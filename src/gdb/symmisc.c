@@ -244,6 +244,94 @@ print_objfile_statistics (void)
   immediate_quit--;
 }
 
+/* APPLE LOCAL begin objfile memory  */
+/* Print where the memory for each objfile whose name matches REGEXP
+   (or every objfile, if it is NULL) goes.  The objects that live on
+   the objfile obstack are counted, not measured, so their share of it
+   is an estimate; everything else is what the allocator was asked
+   for.  */
+
+void
+print_objfile_memory (char *regexp)
+{
+  struct objfile *objfile;
+  unsigned long grand_total = 0;
+
+  if (regexp)
+    re_comp (regexp);
+
+  immediate_quit++;
+  ALL_OBJFILES (objfile)
+  {
+    struct _obstack_chunk *chunk;
+    struct symtab *s;
+    struct partial_symtab *ps;
+    unsigned long obstack_bytes, lists_bytes, psymbol_bytes, macro_bytes;
+    unsigned long die_bytes, linetable_bytes = 0, total;
+    int chunks = 0, psymtabs = 0, linetables = 0, units;
+
+    if (regexp && !re_exec (objfile->name))
+      continue;
+
+    for (chunk = objfile->objfile_obstack.chunk; chunk; chunk = chunk->prev)
+      chunks++;
+    ALL_OBJFILE_PSYMTABS (objfile, ps)
+      psymtabs++;
+    ALL_OBJFILE_SYMTABS (objfile, s)
+      if (s->linetable != NULL)
+	{
+	  linetables++;
+	  linetable_bytes += (sizeof (struct linetable)
+			      + ((s->linetable->nitems - 1)
+				 * sizeof (struct linetable_entry)));
+	}
+
+    obstack_bytes = obstack_memory_used (&objfile->objfile_obstack);
+    lists_bytes = ((objfile->global_psymbols.size
+		    + objfile->static_psymbols.size)
+		   * sizeof (struct partial_symbol *));
+    psymbol_bytes = bcache_memory_used (objfile->psymbol_cache);
+    macro_bytes = bcache_memory_used (objfile->macro_cache);
+    die_bytes = dwarf2_objfile_cache_memory_used (objfile, &units);
+    total = (obstack_bytes + lists_bytes + psymbol_bytes + macro_bytes
+	     + die_bytes);
+    grand_total += total;
+
+    printf_filtered (_("Memory used by '%s':\n"), objfile->name);
+    printf_filtered (_("  Objfile obstack: %lu bytes in %d chunks\n"),
+		     obstack_bytes, chunks);
+    printf_filtered (_("    Minimal symbols (%d): %lu bytes\n"),
+		     objfile->minimal_symbol_count,
+		     (unsigned long) objfile->minimal_symbol_count
+		     * sizeof (struct minimal_symbol));
+    printf_filtered (_("    Partial symbol tables (%d): %lu bytes\n"),
+		     psymtabs,
+		     (unsigned long) psymtabs * sizeof (struct partial_symtab));
+    printf_filtered (_("    Full symbols (%d): %lu bytes\n"),
+		     OBJSTAT (objfile, n_syms),
+		     (unsigned long) OBJSTAT (objfile, n_syms)
+		     * sizeof (struct symbol));
+    printf_filtered (_("    Types (%d): %lu bytes\n"),
+		     OBJSTAT (objfile, n_types),
+		     (unsigned long) OBJSTAT (objfile, n_types)
+		     * (sizeof (struct type) + sizeof (struct main_type)));
+    printf_filtered (_("    Line tables (%d): %lu bytes\n"),
+		     linetables, linetable_bytes);
+    printf_filtered (_("  Partial symbol lists: %lu bytes\n"), lists_bytes);
+    printf_filtered (_("  Partial symbol cache (%d symbols): %lu bytes\n"),
+		     OBJSTAT (objfile, n_psyms), psymbol_bytes);
+    printf_filtered (_("  Macro cache: %lu bytes\n"), macro_bytes);
+    printf_filtered (_("  Cached DWARF compilation units (%d): %lu bytes\n"),
+		     units, die_bytes);
+    printf_filtered (_("  Total: %lu bytes\n"), total);
+  }
+  immediate_quit--;
+
+  printf_filtered (_("Total for all objfiles shown: %lu bytes\n"),
+		   grand_total);
+}
+/* APPLE LOCAL end objfile memory  */
+
 static void
 dump_objfile (struct objfile *objfile)
 {
@@ -310,6 +398,8 @@ dump_msymbols (struct objfile *objfile, struct ui_file *outfile)
       fprintf_filtered (outfile, "No minimal symbols found.\n");
       return;
     }
+  /* APPLE LOCAL lazy minsym demangling  */
+  minimal_symbols_demangle (objfile);
   for (index = 0, msymbol = objfile->msymbols;
        DEPRECATED_SYMBOL_NAME (msymbol) != NULL; msymbol++, index++)
     {
@@ -424,6 +514,8 @@ dump_psymtab (struct objfile *objfile, struct partial_symtab *psymtab,
       fprintf_filtered (outfile, " %s\n",
 			psymtab->dependencies[i]->filename);
     }
+  /* APPLE LOCAL deferred psymbol relocation  */
+  objfile_relocate_psymbols (objfile);
   if (psymtab->n_global_syms > 0)
     {
       print_partial_symbols (objfile->global_psymbols.list
@@ -61,6 +61,24 @@
 
 /* APPLE LOCAL: So we can complain.  */
 #include "complaints.h"
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
+/* APPLE LOCAL begin demangled names cache  */
+#include "mach-o.h"
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+/* APPLE LOCAL end demangled names cache  */
+/* APPLE LOCAL parallel symbol search  */
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
 
 /* APPLE LOCAL begin cache lookup values for improved performance  */
 
@@ -103,7 +121,8 @@ static void sources_info (char *, int);
 
 static void output_source_filename (const char *, int *);
 
-static int find_line_common (struct linetable *, int, int *);
+/* APPLE LOCAL line table index  */
+static int find_line_common (struct symtab *, int, int *);
 
 /* This one is used by linespec.c */
 
@@ -770,6 +789,278 @@ symbol_init_language_specific (struct general_symbol_info *gsymbol,
 
 /* Functions to initialize a symbol's mangled name.  */
 
+/* APPLE LOCAL begin demangled names cache  */
+/* The demangled names cache.
+
+   Demangling every C++ name in a large binary is one of the more
+   expensive parts of reading its symbols, and the answer only depends
+   on the names.  So when "maint set demangled-names-cache-directory"
+   is set, the contents of an objfile's demangled_names_hash are saved
+   to a file in that directory named after the objfile's Mach-O UUID,
+   and the next time an objfile with that UUID is read the hash is
+   filled from the file before any symbols are read, so that
+   symbol_set_names finds every name already demangled.
+
+   The file is a header followed by one record per name: the language
+   the symbol had when it was first entered, the language the
+   demangling left it with, then the lookup name and demangled name,
+   each NUL terminated - the same layout as a hash entry, with the two
+   language bytes moved to the front.  Since a demangled name only
+   depends on the mangled name, a file left over from some other
+   build of the objfile is harmless; it just misses.  */
+
+#define DEMANGLED_NAMES_CACHE_MAGIC "GDBDMGL"
+#define DEMANGLED_NAMES_CACHE_VERSION 1
+
+struct demangled_names_cache_header
+{
+  char magic[8];
+  unsigned int version;
+  unsigned int header_size;
+  unsigned char uuid[16];
+  unsigned int n_entries;
+  unsigned int data_size;
+};
+
+static char *demangled_names_cache_directory = NULL;
+static void
+show_demangled_names_cache_directory (struct ui_file *file, int from_tty,
+				      struct cmd_list_element *c,
+				      const char *value)
+{
+  if (value == NULL || *value == '\0')
+    fprintf_filtered (file, _("\
+The demangled names cache is disabled.\n"));
+  else
+    fprintf_filtered (file, _("\
+The demangled names cache directory is \"%s\".\n"),
+		      value);
+}
+
+/* Return the full name of OBJFILE's demangled names cache file in a
+   string allocated with xmalloc, or NULL if the cache is disabled,
+   OBJFILE has no UUID or shares its names with other objfiles.  If
+   UUID is non-NULL it is set to OBJFILE's UUID.  */
+
+static char *
+demangled_names_cache_file_name (struct objfile *objfile,
+				 unsigned char *uuid)
+{
+  unsigned char buf[16];
+  char *name;
+  int i, len;
+
+  if (demangled_names_cache_directory == NULL
+      || *demangled_names_cache_directory == '\0'
+      || objfile->shared_names != NULL
+      || objfile->obfd == NULL)
+    return NULL;
+
+  if (!bfd_mach_o_get_uuid (objfile->obfd, buf, sizeof (buf)))
+    return NULL;
+
+  if (uuid != NULL)
+    memcpy (uuid, buf, sizeof (buf));
+
+  len = strlen (demangled_names_cache_directory);
+  name = xmalloc (len + 1 + 2 * sizeof (buf) + sizeof (".demangled"));
+  strcpy (name, demangled_names_cache_directory);
+  name[len++] = '/';
+  for (i = 0; i < sizeof (buf); i++)
+    len += sprintf (name + len, "%02X", buf[i]);
+  strcpy (name + len, ".demangled");
+
+  return name;
+}
+
+/* Fill OBJFILE's (new, empty) demangled_names_hash from its cache
+   file, if there is one.  A file that doesn't check out is ignored;
+   entries are only added once the whole file has been checked.  */
+
+static void
+read_demangled_names_cache (struct objfile *objfile)
+{
+  unsigned char uuid[16];
+  char *filename;
+  int fd;
+  struct stat st;
+  char *data;
+  const struct demangled_names_cache_header *header;
+  const char *p, *end;
+  unsigned int i;
+  int pass;
+
+  filename = demangled_names_cache_file_name (objfile, uuid);
+  if (filename == NULL)
+    return;
+
+  fd = open (filename, O_RDONLY | O_BINARY);
+  xfree (filename);
+  if (fd < 0)
+    return;
+
+  if (fstat (fd, &st) != 0
+      || st.st_size < sizeof (struct demangled_names_cache_header))
+    {
+      close (fd);
+      return;
+    }
+
+#ifdef HAVE_MMAP
+  data = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == (char *) MAP_FAILED)
+    {
+      close (fd);
+      return;
+    }
+#else
+  data = xmalloc (st.st_size);
+  if (read (fd, data, st.st_size) != st.st_size)
+    {
+      xfree (data);
+      close (fd);
+      return;
+    }
+#endif
+  close (fd);
+
+  header = (const struct demangled_names_cache_header *) data;
+  if (memcmp (header->magic, DEMANGLED_NAMES_CACHE_MAGIC,
+	      sizeof (header->magic)) != 0
+      || header->version != DEMANGLED_NAMES_CACHE_VERSION
+      || header->header_size != sizeof (struct demangled_names_cache_header)
+      || memcmp (header->uuid, uuid, sizeof (uuid)) != 0
+      || header->data_size != st.st_size - sizeof (*header))
+    goto done;
+
+  /* The first pass checks that every record is complete; the second
+     enters them.  */
+  end = (const char *) (header + 1) + header->data_size;
+  for (pass = 0; pass < 2; pass++)
+    {
+      p = (const char *) (header + 1);
+      for (i = 0; i < header->n_entries; i++)
+	{
+	  const char *name, *demangled;
+	  unsigned char in_lang, out_lang;
+	  int name_len, demangled_len;
+
+	  if (end - p < 4)
+	    goto done;
+	  in_lang = p[0];
+	  out_lang = p[1];
+	  name = p + 2;
+	  demangled = memchr (name, '\0', end - name);
+	  if (demangled == NULL || ++demangled == end)
+	    goto done;
+	  p = memchr (demangled, '\0', end - demangled);
+	  if (p == NULL)
+	    goto done;
+	  p++;
+
+	  if (pass == 1)
+	    {
+	      char **slot;
+
+	      name_len = demangled - name - 1;
+	      demangled_len = p - demangled - 1;
+	      slot = (char **) htab_find_slot (objfile->demangled_names_hash,
+					       name, INSERT);
+	      if (*slot != NULL)
+		continue;
+	      *slot = obstack_alloc (&objfile->objfile_obstack,
+				     name_len + demangled_len + 4);
+	      memcpy (*slot, name, name_len + demangled_len + 2);
+	      (*slot)[name_len + demangled_len + 2] = in_lang;
+	      (*slot)[name_len + demangled_len + 3] = out_lang;
+	    }
+	}
+      if (p != end)
+	goto done;
+    }
+
+  objfile->demangled_names_saved
+    = htab_elements (objfile->demangled_names_hash);
+
+ done:
+#ifdef HAVE_MMAP
+  munmap (data, st.st_size);
+#else
+  xfree (data);
+#endif
+}
+
+static int
+write_demangled_name (void **slot, void *arg)
+{
+  struct obstack *ob = arg;
+  const char *name = *slot;
+  int name_len = strlen (name);
+  const char *demangled = name + name_len + 1;
+  int demangled_len = strlen (demangled);
+
+  obstack_1grow (ob, demangled[demangled_len + 1]);
+  obstack_1grow (ob, demangled[demangled_len + 2]);
+  obstack_grow (ob, name, name_len + demangled_len + 2);
+  return 1;
+}
+
+/* Save OBJFILE's demangled names to its cache file, if the cache is
+   enabled and OBJFILE has entered names since the file was read or
+   last written.  */
+
+void
+save_demangled_names_cache (struct objfile *objfile)
+{
+  struct demangled_names_cache_header header;
+  struct obstack ob;
+  char *filename, *tmpname;
+  FILE *f;
+  int ok;
+
+  if (objfile->demangled_names_hash == NULL
+      || (htab_elements (objfile->demangled_names_hash)
+	  <= objfile->demangled_names_saved))
+    return;
+
+  memset (&header, 0, sizeof (header));
+  filename = demangled_names_cache_file_name (objfile, header.uuid);
+  if (filename == NULL)
+    return;
+
+  obstack_init (&ob);
+  htab_traverse_noresize (objfile->demangled_names_hash,
+			  write_demangled_name, &ob);
+
+  memcpy (header.magic, DEMANGLED_NAMES_CACHE_MAGIC, sizeof (header.magic));
+  header.version = DEMANGLED_NAMES_CACHE_VERSION;
+  header.header_size = sizeof (header);
+  header.n_entries = htab_elements (objfile->demangled_names_hash);
+  header.data_size = obstack_object_size (&ob);
+
+  /* Write to a temporary file and rename it into place, so a reader
+     never sees a partial file.  */
+  tmpname = xstrprintf ("%s.%ld", filename, (long) getpid ());
+  f = fopen (tmpname, FOPEN_WB);
+  if (f != NULL)
+    {
+      ok = (fwrite (&header, sizeof (header), 1, f) == 1
+	    && fwrite (obstack_finish (&ob), 1, header.data_size,
+		       f) == header.data_size);
+      if (fclose (f) != 0)
+	ok = 0;
+      if (!ok || rename (tmpname, filename) != 0)
+	unlink (tmpname);
+      else
+	objfile->demangled_names_saved = header.n_entries;
+    }
+
+  obstack_free (&ob, NULL);
+  xfree (tmpname);
+  xfree (filename);
+}
+/* APPLE LOCAL end demangled names cache  */
+
 /* Create the hash table used for demangled names.  Each hash entry is
    a pair of strings; one for the mangled name and one for the demangled
    name.  The entry is hashed via just the mangled name.  */
@@ -785,7 +1076,77 @@ create_demangled_names_hash (struct objfile *objfile)
   objfile->demangled_names_hash = htab_create_alloc
     (256, htab_hash_string, (int (*) (const void *, const void *)) streq,
      NULL, xcalloc, xfree);
+
+  /* APPLE LOCAL demangled names cache  */
+  objfile->demangled_names_saved = 0;
+  read_demangled_names_cache (objfile);
+}
+
+/* APPLE LOCAL begin shared names  */
+/* The dylibs in the dyld shared cache define a great many of the same
+   names, so objfiles read from it can keep their symbol names in this
+   one process-wide table instead of each in its own
+   demangled_names_hash.  Entries are laid out just as they are there,
+   and are only freed when the last objfile using the table goes
+   away.  */
+
+struct shared_names
+{
+  struct htab *hash;
+  struct obstack obstack;
+
+  /* The number of objfiles whose shared_names point here.  */
+  int refcount;
+};
+
+static struct shared_names *shared_names_table = NULL;
+
+/* Make OBJFILE's symbol names go in the shared names table.  This has
+   to be done before any of its names have been set.  */
+
+void
+objfile_use_shared_names (struct objfile *objfile)
+{
+  if (objfile->shared_names != NULL
+      || objfile->demangled_names_hash != NULL)
+    return;
+
+  if (shared_names_table == NULL)
+    {
+      shared_names_table = XCALLOC (1, struct shared_names);
+      shared_names_table->hash = htab_create_alloc
+	(4096, htab_hash_string, (int (*) (const void *, const void *)) streq,
+	 NULL, xcalloc, xfree);
+      obstack_init (&shared_names_table->obstack);
+    }
+
+  shared_names_table->refcount++;
+  objfile->shared_names = shared_names_table;
+}
+
+/* Drop OBJFILE's reference to the shared names table, freeing the
+   table if no other objfile is using it.  */
+
+void
+objfile_release_shared_names (struct objfile *objfile)
+{
+  struct shared_names *table = objfile->shared_names;
+
+  if (table == NULL)
+    return;
+
+  objfile->shared_names = NULL;
+  gdb_assert (table->refcount > 0);
+  if (--table->refcount > 0)
+    return;
+
+  htab_delete (table->hash);
+  obstack_free (&table->obstack, 0);
+  xfree (table);
+  if (table == shared_names_table)
+    shared_names_table = NULL;
 }
+/* APPLE LOCAL end shared names  */
 
 /* Try to determine the demangled name for a symbol, based on the
    language of that symbol.  If the language is set to language_auto,
@@ -794,8 +1155,8 @@ create_demangled_names_hash (struct objfile *objfile)
    by the demangler and should be xfree'd.  */
 
 static char *
-symbol_find_demangled_name (struct general_symbol_info *gsymbol,
-			    const char *mangled)
+symbol_find_demangled_name_1 (struct general_symbol_info *gsymbol,
+			      const char *mangled)
 {
   char *demangled = NULL;
 
@@ -847,6 +1208,21 @@ symbol_find_demangled_name (struct general_symbol_info *gsymbol,
   return NULL;
 }
 
+/* APPLE LOCAL begin gdb stats  */
+static char *
+symbol_find_demangled_name (struct general_symbol_info *gsymbol,
+			    const char *mangled)
+{
+  struct gdb_stat_timer timer;
+  char *demangled;
+
+  gdb_stat_start (GDB_STAT_DEMANGLE, &timer);
+  demangled = symbol_find_demangled_name_1 (gsymbol, mangled);
+  gdb_stat_stop (GDB_STAT_DEMANGLE, &timer, 0);
+  return demangled;
+}
+/* APPLE LOCAL end gdb stats  */
+
 /* Set both the mangled and demangled (if any) names for GSYMBOL based
    on LINKAGE_NAME and LEN.  The hash table corresponding to OBJFILE
    is used, and the memory comes from that objfile's objfile_obstack.
@@ -872,9 +1248,40 @@ symbol_find_demangled_name (struct general_symbol_info *gsymbol,
 #define JAVA_PREFIX "##JAVA$$"
 #define JAVA_PREFIX_LEN 8
 
+/* APPLE LOCAL begin lazy minsym demangling  */
+/* The language bytes of a names hash entry made by
+   symbol_set_linkage_name; the name hasn't been demangled yet.  */
+#define NAMES_HASH_PENDING 0xff
+
+static void symbol_set_names_1 (struct general_symbol_info *gsymbol,
+				const char *linkage_name, int len,
+				struct objfile *objfile, int demangle);
+
 void
 symbol_set_names (struct general_symbol_info *gsymbol,
 		  const char *linkage_name, int len, struct objfile *objfile)
+{
+  symbol_set_names_1 (gsymbol, linkage_name, len, objfile, 1);
+}
+
+/* Like symbol_set_names, but don't demangle LINKAGE_NAME if that
+   hasn't been done already, leaving GSYMBOL with no demangled name
+   and its language unchanged.  symbol_set_names can be called on it
+   again later to finish the job.  */
+
+void
+symbol_set_linkage_name (struct general_symbol_info *gsymbol,
+			 const char *linkage_name, int len,
+			 struct objfile *objfile)
+{
+  symbol_set_names_1 (gsymbol, linkage_name, len, objfile, 0);
+}
+
+static void
+symbol_set_names_1 (struct general_symbol_info *gsymbol,
+		    const char *linkage_name, int len,
+		    struct objfile *objfile, int demangle)
+/* APPLE LOCAL end lazy minsym demangling  */
 {
   char **slot;
   /* A 0-terminated copy of the linkage name.  */
@@ -884,9 +1291,23 @@ symbol_set_names (struct general_symbol_info *gsymbol,
   const char *lookup_name;
   /* The length of lookup_name.  */
   int lookup_len;
+  /* APPLE LOCAL begin shared names  */
+  struct htab *names_hash;
+  struct obstack *names_obstack;
 
-  if (objfile->demangled_names_hash == NULL)
-    create_demangled_names_hash (objfile);
+  if (objfile->shared_names != NULL)
+    {
+      names_hash = objfile->shared_names->hash;
+      names_obstack = &objfile->shared_names->obstack;
+    }
+  else
+    {
+      if (objfile->demangled_names_hash == NULL)
+	create_demangled_names_hash (objfile);
+      names_hash = objfile->demangled_names_hash;
+      names_obstack = &objfile->objfile_obstack;
+    }
+  /* APPLE LOCAL end shared names  */
 
   /* The stabs reader generally provides names that are not
      NUL-terminated; most of the other readers don't do this, so we
@@ -923,12 +1344,41 @@ symbol_set_names (struct general_symbol_info *gsymbol,
       linkage_name_copy = linkage_name;
     }
 
-  slot = (char **) htab_find_slot (objfile->demangled_names_hash,
-				   lookup_name, INSERT);
+  /* APPLE LOCAL shared names  */
+  slot = (char **) htab_find_slot (names_hash, lookup_name, INSERT);
+
+  /* APPLE LOCAL begin lazy minsym demangling  */
+  if (*slot == NULL && !demangle)
+    {
+      *slot = obstack_alloc (names_obstack, lookup_len + 4);
+      memcpy (*slot, lookup_name, lookup_len + 1);
+      (*slot)[lookup_len + 1] = '\0';
+      (*slot)[lookup_len + 2] = (char) NAMES_HASH_PENDING;
+      (*slot)[lookup_len + 3] = (char) NAMES_HASH_PENDING;
+    }
+  else if (*slot != NULL
+	   && (unsigned char) (*slot)[lookup_len + 1] == '\0'
+	   && (unsigned char) (*slot)[lookup_len + 2] == NAMES_HASH_PENDING)
+    {
+      /* The name was entered without being demangled.  If we're
+	 still not demangling, leave it that way; otherwise make a new
+	 entry for it below.  Any symbols already pointing at the old
+	 one keep their name.  */
+      if (!demangle)
+	{
+	  gsymbol->name = *slot + lookup_len - len;
+	  gsymbol->language_specific.cplus_specific.demangled_name = NULL;
+	  return;
+	}
+      *slot = NULL;
+    }
+  /* APPLE LOCAL end lazy minsym demangling  */
 
   /* If this name is not in the hash table, add it.  */
   if (*slot == NULL)
     {
+      /* APPLE LOCAL demangled names cache  */
+      enum language in_lang = gsymbol->language;
       char *demangled_name = symbol_find_demangled_name (gsymbol,
 							 linkage_name_copy);
       int demangled_len = demangled_name ? strlen (demangled_name) : 0;
@@ -936,8 +1386,12 @@ symbol_set_names (struct general_symbol_info *gsymbol,
       /* If there is a demangled name, place it right after the mangled name.
 	 Otherwise, just place a second zero byte after the end of the mangled
 	 name.  */
-      *slot = obstack_alloc (&objfile->objfile_obstack,
-			     lookup_len + demangled_len + 2);
+      /* APPLE LOCAL begin demangled names cache: After that come the
+	 symbol's language before and after demangling, a byte each, so
+	 the next symbol with this name and language can just be given
+	 the same language.  */
+      /* APPLE LOCAL shared names  */
+      *slot = obstack_alloc (names_obstack, lookup_len + demangled_len + 4);
       memcpy (*slot, lookup_name, lookup_len + 1);
       if (demangled_name != NULL)
 	{
@@ -946,12 +1400,34 @@ symbol_set_names (struct general_symbol_info *gsymbol,
 	}
       else
 	(*slot)[lookup_len + 1] = '\0';
+      (*slot)[lookup_len + demangled_len + 2] = in_lang;
+      (*slot)[lookup_len + demangled_len + 3] = gsymbol->language;
+      /* APPLE LOCAL end demangled names cache  */
     }
   else
     {
-      /* APPLE LOCAL: We already have this name in the demangled name hash
-         but we still need to set the language in the minsym.  */
-      xfree (symbol_find_demangled_name (gsymbol, linkage_name_copy));
+      /* APPLE LOCAL begin demangled names cache: We already have this
+	 name in the demangled name hash but we still need to set the
+	 language in the minsym.  If it came in with the same language
+	 as last time, it leaves with the same language too, and
+	 there's no need to demangle it again.  */
+      const char *langs = *slot + lookup_len + 1;
+
+      langs += strlen (langs) + 1;
+      if ((unsigned char) langs[0] == gsymbol->language)
+	gsymbol->language = (unsigned char) langs[1];
+      /* APPLE LOCAL lazy minsym demangling: Don't demangle it for a
+	 symbol that is putting that off; it can work out its language
+	 when it does.  */
+      else if (!demangle)
+	{
+	  gsymbol->name = *slot + lookup_len - len;
+	  gsymbol->language_specific.cplus_specific.demangled_name = NULL;
+	  return;
+	}
+      else
+	xfree (symbol_find_demangled_name (gsymbol, linkage_name_copy));
+      /* APPLE LOCAL end demangled names cache  */
     }
 
   gsymbol->name = *slot + lookup_len - len;
@@ -1256,6 +1732,9 @@ find_pc_sect_psymbol (struct partial_symtab *psymtab, CORE_ADDR pc,
   if (!psymtab)
     return 0;
 
+  /* APPLE LOCAL deferred psymbol relocation  */
+  objfile_relocate_psymbols (psymtab->objfile);
+
   /* Cope with programs that start at address 0 */
   best_pc = (psymtab->textlow != 0) ? psymtab->textlow - 1 : 0;
 
@@ -1605,6 +2084,158 @@ lookup_symbol_all (const char *name, const struct block *block,
    BLOCK_FOUND is set to the block in which NAME is found (in the case of
    a field of `this', value_of_this sets BLOCK_FOUND to the proper value.) */
 
+/* APPLE LOCAL begin symbol lookup cache  */
+/* Expressions evaluated over and over, in breakpoint conditions and
+   displays for instance, look up the same names every time, and a
+   name that isn't there has to be searched for in every objfile
+   before we give up.  So remember the outcome of recent lookups,
+   misses included, keyed by everything lookup_symbol_aux looks at.
+
+   The answer can only change when an objfile is added, removed, or
+   read in at a new level, which bump objfile_chain_generation, or
+   when symbols are re-read, which bumps symbol_generation.  An entry
+   stored under older generations is treated as empty.  The table is
+   direct mapped; a collision simply replaces the older result.  */
+
+#define SYMBOL_LOOKUP_CACHE_SIZE 1024
+
+struct symbol_lookup_cache_entry
+{
+  /* Zero if the slot is empty.  */
+  unsigned int symbol_generation;
+  unsigned int chain_generation;
+
+  char *name;
+  char *linkage_name;
+  const struct block *block;
+  domain_enum domain;
+  enum language language;
+
+  /* The block of the selected frame, if the lookup checked whether
+     NAME is a field of `this', since that depends on which method we
+     are stopped in.  NULL otherwise.  */
+  const struct block *this_block;
+  int want_field_of_this;
+
+  /* The result.  SYM is NULL for a miss.  */
+  struct symbol *sym;
+  struct symtab *symtab;
+  int is_a_field_of_this;
+};
+
+extern int symbol_generation;
+
+static struct symbol_lookup_cache_entry
+  symbol_lookup_cache[SYMBOL_LOOKUP_CACHE_SIZE];
+
+static int symbol_lookup_cache_enabled = 1;
+
+static void
+show_symbol_lookup_cache_enabled (struct ui_file *file, int from_tty,
+				  struct cmd_list_element *c,
+				  const char *value)
+{
+  fprintf_filtered (file, _("Caching of symbol lookup results is %s.\n"),
+		    value);
+}
+
+static struct symbol_lookup_cache_entry *
+symbol_lookup_cache_slot (const char *name, const struct block *block,
+			  domain_enum domain)
+{
+  unsigned long hash;
+
+  hash = htab_hash_string (name);
+  hash = hash * 31 + (unsigned long) htab_hash_pointer (block);
+  hash = hash * 31 + (unsigned long) domain;
+  hash ^= hash >> 11;
+  return &symbol_lookup_cache[hash % SYMBOL_LOOKUP_CACHE_SIZE];
+}
+
+static int
+symbol_lookup_cache_matches (struct symbol_lookup_cache_entry *entry,
+			     const char *name, const char *linkage_name,
+			     const struct block *block, domain_enum domain,
+			     const struct block *this_block,
+			     int want_field_of_this)
+{
+  if (entry->symbol_generation != (unsigned int) symbol_generation
+      || entry->chain_generation != objfile_chain_generation)
+    return 0;
+  if (entry->block != block || entry->domain != domain
+      || entry->language != current_language->la_language
+      || entry->this_block != this_block
+      || entry->want_field_of_this != want_field_of_this)
+    return 0;
+  if (strcmp (entry->name, name) != 0)
+    return 0;
+  if (linkage_name == NULL || entry->linkage_name == NULL)
+    return linkage_name == entry->linkage_name;
+  return strcmp (entry->linkage_name, linkage_name) == 0;
+}
+
+/* Do what lookup_symbol_aux does, but answer from the cache when the
+   same lookup has been done since the symbols last changed.  */
+
+static struct symbol *
+lookup_symbol_aux_cached (const char *name, const char *linkage_name,
+			  const struct block *block, const domain_enum domain,
+			  int *is_a_field_of_this, struct symtab **symtab)
+{
+  struct symbol_lookup_cache_entry *entry;
+  const struct block *this_block = NULL;
+  int want_field_of_this = (is_a_field_of_this != NULL);
+  struct symtab *found_symtab = NULL;
+  int found_field_of_this = 0;
+  struct symbol *sym;
+
+  if (!symbol_lookup_cache_enabled)
+    return lookup_symbol_aux (name, linkage_name, block, domain,
+			      is_a_field_of_this, symtab);
+
+  if (want_field_of_this && current_language->la_value_of_this != NULL)
+    this_block = get_selected_block (0);
+
+  entry = symbol_lookup_cache_slot (name, block, domain);
+  if (symbol_lookup_cache_matches (entry, name, linkage_name, block, domain,
+				   this_block, want_field_of_this))
+    {
+      if (entry->symtab != NULL)
+	objfile_add_to_hitlist (entry->symtab->objfile);
+      if (is_a_field_of_this != NULL)
+	*is_a_field_of_this = entry->is_a_field_of_this;
+      if (symtab != NULL)
+	*symtab = entry->symtab;
+      return entry->sym;
+    }
+
+  sym = lookup_symbol_aux (name, linkage_name, block, domain,
+			   want_field_of_this ? &found_field_of_this : NULL,
+			   &found_symtab);
+
+  xfree (entry->name);
+  xfree (entry->linkage_name);
+  entry->name = xstrdup (name);
+  entry->linkage_name = linkage_name ? xstrdup (linkage_name) : NULL;
+  entry->block = block;
+  entry->domain = domain;
+  entry->language = current_language->la_language;
+  entry->this_block = this_block;
+  entry->want_field_of_this = want_field_of_this;
+  entry->sym = sym;
+  entry->symtab = found_symtab;
+  entry->is_a_field_of_this = found_field_of_this;
+  entry->symbol_generation = symbol_generation;
+  entry->chain_generation = objfile_chain_generation;
+
+  if (is_a_field_of_this != NULL)
+    *is_a_field_of_this = found_field_of_this;
+  if (symtab != NULL)
+    *symtab = found_symtab;
+  return sym;
+}
+/* APPLE LOCAL end symbol lookup cache  */
+
 /* This function has a bunch of loops in it and it would seem to be
    attractive to put in some QUIT's (though I'm not really sure
    whether it can run long enough to be really important).  But there
@@ -1625,6 +2256,8 @@ lookup_symbol (const char *name, const struct block *block,
   const char *mangled_name = NULL;
   int needtofreename = 0;
   struct symbol *returnval;
+  /* APPLE LOCAL gdb stats  */
+  struct gdb_stat_timer timer;
 
   modified_name = name;
 
@@ -1667,8 +2300,13 @@ lookup_symbol (const char *name, const struct block *block,
       modified_name = copy;
     }
 
-  returnval = lookup_symbol_aux (modified_name, mangled_name, block,
-				 domain, is_a_field_of_this, symtab);
+  /* APPLE LOCAL gdb stats  */
+  gdb_stat_start (GDB_STAT_SYMBOL_LOOKUP, &timer);
+  /* APPLE LOCAL symbol lookup cache  */
+  returnval = lookup_symbol_aux_cached (modified_name, mangled_name, block,
+					domain, is_a_field_of_this, symtab);
+  /* APPLE LOCAL gdb stats  */
+  gdb_stat_stop (GDB_STAT_SYMBOL_LOOKUP, &timer, 0);
   if (needtofreename)
     xfree (demangled_name);
 
@@ -1928,6 +2566,11 @@ lookup_symbol_aux_symtabs (int block_index,
       return NULL;
     }
 
+  /* APPLE LOCAL dwarf2 name index: Objfiles using a DWARF name index
+     have no partial symbols to find NAME through, so read in the
+     symtabs the index says define it first.  */
+  dwarf2_name_index_expand (name);
+
   /* APPLE LOCAL fix-and-continue */
   ALL_SYMTABS_INCL_OBSOLETED (objfile, s)
   {
@@ -2083,59 +2726,439 @@ lookup_equiv_partial_symbol (struct partial_symtab *pst, const char *name)
 }
 /* APPLE LOCAL end psym equivalences  */
 
-/* Check to see if the symbol is defined in one of the partial
-   symtabs.  BLOCK_INDEX should be either GLOBAL_BLOCK or
-   STATIC_BLOCK, depending on whether or not we want to search global
-   symbols or static symbols. 
+/* APPLE LOCAL begin psymbol name filter  */
+/* Looking a name up in the psymtabs means a binary search of every
+   psymtab's globals and a linear one of its statics, for every
+   psymtab of every objfile; a linespec that names a function in one
+   library pays for all the others.  So each objfile keeps a bitmap
+   with a bit set for the msymbol_hash_iw of the names of each of its
+   partial symbols.  If neither the name nor the linkage name being
+   looked up hits a set bit, none of the objfile's psymtabs can match
+   and they can all be skipped.  msymbol_hash_iw ignores whitespace
+   and stops at the first '(', so any two names strcmp_iw takes to be
+   equal hash alike.
+
+   Alongside the bitmap each objfile keeps an index from the same hash
+   to the psymtabs with a partial symbol of that name, so that a name
+   the objfile does define is looked for only in the psymtabs that
+   might hold it rather than in every one of them.  */
+
+struct psymbol_name_filter
+{
+  /* The partial symbol lists and the psymtab chain the filter was
+     built from.  If psymbols or psymtabs have been added or the lists
+     moved, the filter is rebuilt.  New psymtabs go on the front of
+     the chain, so its head changes whenever one is added.  */
+  struct partial_symbol **global_list;
+  struct partial_symbol **global_next;
+  struct partial_symbol **static_list;
+  struct partial_symbol **static_next;
+  struct partial_symtab *psymtabs;
+
+  /* A power of two.  */
+  unsigned int nbits;
+  unsigned char *bits;
+
+  /* The name index.  The psymtabs with a partial symbol whose name
+     falls in bucket B are BUCKET_PSYMTABS[BUCKET_START[B]] up to
+     BUCKET_PSYMTABS[BUCKET_START[B + 1]], each listed once and in
+     psymtab chain order.  NBUCKETS is a power of two.  */
+  unsigned int nbuckets;
+  unsigned int *bucket_start;
+  struct partial_symtab **bucket_psymtabs;
+};
+
+/* Bits set aside per partial symbol.  */
+#define PSYMBOL_NAME_FILTER_BITS 16
+
+static const struct objfile_data *psymbol_name_filter_key;
+
+static int psymbol_name_filter_enabled = 1;
 
-   APPLE LOCAL: This function can be used in two different ways:  
-   It can be used to find a single symbol by name -- in which case
-   a pointer to the symbol is returned and *SYMTAB is set to the
-   symtab, if we found one.
-              
-   The second way is to return a comprehensive list of all symbols 
-   found in all symtabs.  In that case, *SYM_LIST is set to a linked
-   list of matching symbols which have been xmalloc()'ed, a pointer
-   to one of the symbols is returned and *SYMTAB is set to one of
-   the matched symbols' symtabs.  It is the responsibility of the
-   caller to free *SYM_LIST.  */
+static void
+show_psymbol_name_filter_enabled (struct ui_file *file, int from_tty,
+				  struct cmd_list_element *c,
+				  const char *value)
+{
+  fprintf_filtered (file, _("Filtering psymtab searches by name is %s.\n"),
+		    value);
+}
 
-static struct symbol *
-lookup_symbol_aux_psymtabs (int block_index, const char *name,
-			    const char *linkage_name,
-			    const domain_enum domain,
-			    struct symtab **symtab,
-			    /* APPLE LOCAL begin return multiple symbols  */
-			    struct symbol_search **sym_list,
-			    int find_all_occurrences)
-                             /* APPLE LOCAL end return multiple symbols  */
+static void
+psymbol_name_filter_free (struct objfile *objfile, void *data)
 {
-  struct symbol *sym;
-  struct objfile *objfile;
-  struct blockvector *bv;
-  const struct block *block;
-  struct partial_symtab *ps;
-  struct symtab *s;
-  const int psymtab_index = (block_index == GLOBAL_BLOCK ? 1 : 0);
-  /* APPLE LOCAL begin return multiple symbols  */
-  struct symbol_search *tmp_list;
-  struct symbol_search *prev;
-  struct symbol_search *current;
-  /* APPLE LOCAL end return multiple symbols  */
+  struct psymbol_name_filter *filter = data;
 
-  /* If we're called with a null string for some bizarre reason, just bail.  */
-  if (name == NULL || name[0] == '\0'
-      || (linkage_name && linkage_name[0] == '\0'))
+  if (filter == NULL)
+    return;
+  xfree (filter->bits);
+  xfree (filter->bucket_start);
+  xfree (filter->bucket_psymtabs);
+  xfree (filter);
+}
+
+static unsigned int
+psymbol_name_filter_bit (struct psymbol_name_filter *filter, const char *name)
+{
+  unsigned int hash = msymbol_hash_iw (name);
+
+  hash ^= hash >> 15;
+  return hash & (filter->nbits - 1);
+}
+
+static void
+psymbol_name_filter_add (struct psymbol_name_filter *filter, const char *name)
+{
+  unsigned int bit;
+
+  if (name == NULL)
+    return;
+  bit = psymbol_name_filter_bit (filter, name);
+  filter->bits[bit / 8] |= 1 << (bit % 8);
+}
+
+static int
+psymbol_name_filter_test (struct psymbol_name_filter *filter,
+			  const char *name)
+{
+  unsigned int bit;
+
+  bit = psymbol_name_filter_bit (filter, name);
+  return (filter->bits[bit / 8] & (1 << (bit % 8))) != 0;
+}
+
+static void
+psymbol_name_filter_add_list (struct psymbol_name_filter *filter,
+			      struct partial_symbol **start,
+			      struct partial_symbol **end)
+{
+  struct partial_symbol **psym;
+
+  for (psym = start; psym < end; psym++)
     {
-      if (sym_list)
-        *sym_list = NULL;
-      if (symtab)
-        *symtab = NULL;
-      return NULL;
+      if (*psym == NULL)
+	continue;
+      psymbol_name_filter_add (filter, SYMBOL_LINKAGE_NAME (*psym));
+      psymbol_name_filter_add (filter, SYMBOL_NATURAL_NAME (*psym));
+      psymbol_name_filter_add (filter, SYMBOL_SEARCH_NAME (*psym));
     }
+}
 
-  ALL_PSYMTABS (objfile, ps)
+static unsigned int
+psymbol_name_index_bucket (struct psymbol_name_filter *filter,
+			   const char *name)
+{
+  unsigned int hash = msymbol_hash_iw (name);
+
+  hash ^= hash >> 11;
+  return hash & (filter->nbuckets - 1);
+}
+
+/* Note that PS has a partial symbol called NAME.  LAST[B] is the
+   psymtab most recently noted in bucket B; since the psymtabs are
+   visited one at a time it is enough to keep each bucket from
+   listing the same psymtab twice in a row.  On the counting pass,
+   when FILL is NULL, just count the bucket's psymtabs in COUNT[B];
+   otherwise store PS at FILL[COUNT[B]] and advance COUNT[B].  */
+
+static void
+psymbol_name_index_note (struct psymbol_name_filter *filter,
+			 struct partial_symtab **last, unsigned int *count,
+			 struct partial_symtab **fill,
+			 struct partial_symtab *ps, const char *name)
+{
+  unsigned int b;
+
+  if (name == NULL)
+    return;
+  b = psymbol_name_index_bucket (filter, name);
+  if (last[b] == ps)
+    return;
+  last[b] = ps;
+  if (fill != NULL)
+    fill[count[b]] = ps;
+  count[b]++;
+}
+
+static void
+psymbol_name_index_note_psymtab (struct psymbol_name_filter *filter,
+				 struct partial_symtab **last,
+				 unsigned int *count,
+				 struct partial_symtab **fill,
+				 struct partial_symtab *ps)
+{
+  struct objfile *objfile = ps->objfile;
+  struct partial_symbol **psym, **end;
+  int pass;
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      if (pass == 0)
+	{
+	  psym = objfile->global_psymbols.list + ps->globals_offset;
+	  end = psym + ps->n_global_syms;
+	}
+      else
+	{
+	  psym = objfile->static_psymbols.list + ps->statics_offset;
+	  end = psym + ps->n_static_syms;
+	}
+      for (; psym < end; psym++)
+	{
+	  if (*psym == NULL)
+	    continue;
+	  psymbol_name_index_note (filter, last, count, fill, ps,
+				   SYMBOL_LINKAGE_NAME (*psym));
+	  psymbol_name_index_note (filter, last, count, fill, ps,
+				   SYMBOL_NATURAL_NAME (*psym));
+	  psymbol_name_index_note (filter, last, count, fill, ps,
+				   SYMBOL_SEARCH_NAME (*psym));
+	}
+    }
+}
+
+/* Build FILTER's name index over every psymtab of OBJFILE, obsoleted
+   ones included; lookups skip those themselves.  */
+
+static void
+psymbol_name_index_build (struct psymbol_name_filter *filter,
+			  struct objfile *objfile, unsigned int npsyms)
+{
+  struct partial_symtab **last;
+  struct partial_symtab *ps;
+  unsigned int *count;
+  unsigned int nbuckets, b, total;
+
+  nbuckets = 64;
+  while (nbuckets < npsyms && nbuckets < (1U << 30))
+    nbuckets <<= 1;
+
+  xfree (filter->bucket_start);
+  xfree (filter->bucket_psymtabs);
+  filter->nbuckets = nbuckets;
+  filter->bucket_start = xcalloc (nbuckets + 1, sizeof (unsigned int));
+
+  last = xcalloc (nbuckets, sizeof (struct partial_symtab *));
+  count = xcalloc (nbuckets, sizeof (unsigned int));
+
+  ALL_OBJFILE_PSYMTABS_INCL_OBSOLETED (objfile, ps)
+    psymbol_name_index_note_psymtab (filter, last, count, NULL, ps);
+
+  total = 0;
+  for (b = 0; b < nbuckets; b++)
+    {
+      filter->bucket_start[b] = total;
+      total += count[b];
+      count[b] = filter->bucket_start[b];
+      last[b] = NULL;
+    }
+  filter->bucket_start[nbuckets] = total;
+
+  filter->bucket_psymtabs = xmalloc ((total + 1)
+				     * sizeof (struct partial_symtab *));
+  ALL_OBJFILE_PSYMTABS_INCL_OBSOLETED (objfile, ps)
+    psymbol_name_index_note_psymtab (filter, last, count,
+				     filter->bucket_psymtabs, ps);
+
+  xfree (last);
+  xfree (count);
+}
+
+/* Return the name filter of OBJFILE, (re)building it if its partial
+   symbols have changed since it was last built.  */
+
+static struct psymbol_name_filter *
+psymbol_name_filter_get (struct objfile *objfile)
+{
+  struct psymbol_name_filter *filter;
+  unsigned int npsyms;
+  unsigned int nbits;
+
+  filter = objfile_data (objfile, psymbol_name_filter_key);
+  if (filter != NULL
+      && filter->global_list == objfile->global_psymbols.list
+      && filter->global_next == objfile->global_psymbols.next
+      && filter->static_list == objfile->static_psymbols.list
+      && filter->static_next == objfile->static_psymbols.next
+      && filter->psymtabs == objfile->psymtabs)
+    return filter;
+
+  if (filter == NULL)
+    {
+      filter = XZALLOC (struct psymbol_name_filter);
+      set_objfile_data (objfile, psymbol_name_filter_key, filter);
+    }
+
+  npsyms = ((objfile->global_psymbols.next - objfile->global_psymbols.list)
+	    + (objfile->static_psymbols.next - objfile->static_psymbols.list));
+  nbits = 64;
+  while (nbits < npsyms * PSYMBOL_NAME_FILTER_BITS && nbits < (1U << 31))
+    nbits <<= 1;
+
+  if (nbits != filter->nbits)
+    {
+      xfree (filter->bits);
+      filter->bits = xmalloc (nbits / 8);
+      filter->nbits = nbits;
+    }
+  memset (filter->bits, 0, nbits / 8);
+
+  psymbol_name_filter_add_list (filter, objfile->global_psymbols.list,
+				objfile->global_psymbols.next);
+  psymbol_name_filter_add_list (filter, objfile->static_psymbols.list,
+				objfile->static_psymbols.next);
+
+  psymbol_name_index_build (filter, objfile, npsyms);
+
+  filter->global_list = objfile->global_psymbols.list;
+  filter->global_next = objfile->global_psymbols.next;
+  filter->static_list = objfile->static_psymbols.list;
+  filter->static_next = objfile->static_psymbols.next;
+  filter->psymtabs = objfile->psymtabs;
+  return filter;
+}
+
+/* Return zero if no partial symbol of OBJFILE can be called NAME (or
+   have linkage name LINKAGE_NAME, if that isn't NULL), so that the
+   psymtab searches can skip OBJFILE.  */
+
+static int
+psymbol_name_filter_may_match (struct objfile *objfile, const char *name,
+			       const char *linkage_name)
+{
+  struct psymbol_name_filter *filter;
+
+  /* Psymbol equivalences match names other than the psymbols' own.  */
+  if (!psymbol_name_filter_enabled || psym_equivalences || name == NULL)
+    return 1;
+
+  if (objfile->psymtabs == NULL)
+    return 1;
+
+  filter = psymbol_name_filter_get (objfile);
+  if (psymbol_name_filter_test (filter, name))
+    return 1;
+  if (linkage_name != NULL && psymbol_name_filter_test (filter, linkage_name))
+    return 1;
+  return 0;
+}
+
+/* Return the psymtabs of OBJFILE that might have a partial symbol
+   called NAME (with linkage name LINKAGE_NAME, if that isn't NULL),
+   and store how many there are in *COUNT.  They may include obsoleted
+   psymtabs.  Return NULL if the index can't answer, in which case
+   every psymtab has to be searched.
+
+   The array belongs to OBJFILE's filter.  It stays valid while the
+   caller reads in the psymtabs it lists, since that adds neither
+   psymtabs nor partial symbols.  */
+
+static struct partial_symtab **
+psymbol_name_index_lookup (struct objfile *objfile, const char *name,
+			   const char *linkage_name, unsigned int *count)
+{
+  struct psymbol_name_filter *filter;
+  unsigned int b;
+
+  if (!psymbol_name_filter_enabled || psym_equivalences || name == NULL)
+    return NULL;
+  if (objfile->psymtabs == NULL)
+    return NULL;
+
+  filter = psymbol_name_filter_get (objfile);
+
+  /* lookup_partial_symbol insists on an exact match of LINKAGE_NAME
+     when it's given, and every linkage name is in the index.  */
+  b = psymbol_name_index_bucket (filter,
+				 linkage_name != NULL ? linkage_name : name);
+  *count = filter->bucket_start[b + 1] - filter->bucket_start[b];
+  return filter->bucket_psymtabs + filter->bucket_start[b];
+}
+/* APPLE LOCAL end psymbol name filter  */
+
+/* Check to see if the symbol is defined in one of the partial
+   symtabs.  BLOCK_INDEX should be either GLOBAL_BLOCK or
+   STATIC_BLOCK, depending on whether or not we want to search global
+   symbols or static symbols. 
+
+   APPLE LOCAL: This function can be used in two different ways:  
+   It can be used to find a single symbol by name -- in which case
+   a pointer to the symbol is returned and *SYMTAB is set to the
+   symtab, if we found one.
+              
+   The second way is to return a comprehensive list of all symbols 
+   found in all symtabs.  In that case, *SYM_LIST is set to a linked
+   list of matching symbols which have been xmalloc()'ed, a pointer
+   to one of the symbols is returned and *SYMTAB is set to one of
+   the matched symbols' symtabs.  It is the responsibility of the
+   caller to free *SYM_LIST.  */
+
+static struct symbol *
+lookup_symbol_aux_psymtabs (int block_index, const char *name,
+			    const char *linkage_name,
+			    const domain_enum domain,
+			    struct symtab **symtab,
+			    /* APPLE LOCAL begin return multiple symbols  */
+			    struct symbol_search **sym_list,
+			    int find_all_occurrences)
+                             /* APPLE LOCAL end return multiple symbols  */
+{
+  struct symbol *sym;
+  struct objfile *objfile;
+  struct blockvector *bv;
+  const struct block *block;
+  struct partial_symtab *ps;
+  struct symtab *s;
+  const int psymtab_index = (block_index == GLOBAL_BLOCK ? 1 : 0);
+  /* APPLE LOCAL begin return multiple symbols  */
+  struct symbol_search *tmp_list;
+  struct symbol_search *prev;
+  struct symbol_search *current;
+  /* APPLE LOCAL end return multiple symbols  */
+  /* APPLE LOCAL begin psymbol name filter  */
+  struct partial_symtab **candidates;
+  unsigned int ncandidates;
+  unsigned int ci;
+  /* APPLE LOCAL end psymbol name filter  */
+
+  /* If we're called with a null string for some bizarre reason, just bail.  */
+  if (name == NULL || name[0] == '\0'
+      || (linkage_name && linkage_name[0] == '\0'))
+    {
+      if (sym_list)
+        *sym_list = NULL;
+      if (symtab)
+        *symtab = NULL;
+      return NULL;
+    }
+
+  /* APPLE LOCAL begin psymbol name filter  */
+  /* Search only the psymtabs the objfile's name index lists for NAME,
+     or all of them if it has no answer.  */
+  ALL_OBJFILES (objfile)
+  for (candidates = psymbol_name_index_lookup (objfile, name, linkage_name,
+					       &ncandidates),
+	 ci = 0, ps = NULL;
+       ;
+       ci++)
   {
+    if (candidates != NULL)
+      {
+	if (ci >= ncandidates)
+	  break;
+	ps = candidates[ci];
+	if (PSYMTAB_OBSOLETED (ps) == 51)
+	  continue;
+      }
+    else
+      {
+	ps = (ci == 0 ? psymtab_get_first (objfile, 1)
+	      : psymtab_get_next (ps, 1));
+	if (ps == NULL)
+	  break;
+      }
+    /* APPLE LOCAL end psymbol name filter  */
+
     /* Check to see if there is either a direct match, or a
        psym equivalence match.  */
     if (!ps->readin
@@ -2499,6 +3522,10 @@ lookup_partial_symbol (struct partial_symtab *pst, const char *name,
     {
       return (NULL);
     }
+  /* APPLE LOCAL deferred psymbol relocation: Our callers use the
+     psymbol we return by address too.  */
+  objfile_relocate_psymbols (pst->objfile);
+
   start = (global ?
 	   pst->objfile->global_psymbols.list + pst->globals_offset :
 	   pst->objfile->static_psymbols.list + pst->statics_offset);
@@ -2604,12 +3631,19 @@ basic_lookup_transparent_type (const char *name)
   struct blockvector *bv;
   struct objfile *objfile;
   struct block *block;
+  /* APPLE LOCAL begin psymbol name filter  */
+  struct objfile *filtered_objfile = NULL;
+  int objfile_may_match = 1;
+  /* APPLE LOCAL end psymbol name filter  */
 
   /* Now search all the global symbols.  Do the symtab's first, then
      check the psymtab's. If a psymtab indicates the existence
      of the desired name as a global, then do psymtab-to-symtab
      conversion on the fly and return the found symbol.  */
 
+  /* APPLE LOCAL dwarf2 name index  */
+  dwarf2_name_index_expand (name);
+
   /* APPLE LOCAL fix-and-continue */
   ALL_SYMTABS_INCL_OBSOLETED (objfile, s)
   {
@@ -2625,6 +3659,16 @@ basic_lookup_transparent_type (const char *name)
 
   ALL_PSYMTABS (objfile, ps)
   {
+    /* APPLE LOCAL begin psymbol name filter  */
+    if (objfile != filtered_objfile)
+      {
+	filtered_objfile = objfile;
+	objfile_may_match = psymbol_name_filter_may_match (objfile, name,
+							    NULL);
+      }
+    if (!objfile_may_match)
+      continue;
+    /* APPLE LOCAL end psymbol name filter  */
     if (!ps->readin && lookup_partial_symbol (ps, name, NULL,
 					      1, STRUCT_DOMAIN))
       {
@@ -2681,8 +3725,20 @@ basic_lookup_transparent_type (const char *name)
       }
   }
 
+  /* APPLE LOCAL psymbol name filter  */
+  filtered_objfile = NULL;
   ALL_PSYMTABS (objfile, ps)
   {
+    /* APPLE LOCAL begin psymbol name filter  */
+    if (objfile != filtered_objfile)
+      {
+	filtered_objfile = objfile;
+	objfile_may_match = psymbol_name_filter_may_match (objfile, name,
+							    NULL);
+      }
+    if (!objfile_may_match)
+      continue;
+    /* APPLE LOCAL end psymbol name filter  */
     if (!ps->readin && lookup_partial_symbol (ps, name, NULL, 0, STRUCT_DOMAIN))
       {
         if (info_verbose)
@@ -2731,7 +3787,9 @@ find_main_psymtab (void)
 
   ALL_PSYMTABS (objfile, pst)
   {
-    if (lookup_partial_symbol (pst, main_name (), NULL, 1, VAR_DOMAIN))
+    /* APPLE LOCAL dwarf2 name index  */
+    if (lookup_partial_symbol (pst, main_name (), NULL, 1, VAR_DOMAIN)
+	|| dwarf2_name_index_psymtab_match (pst, main_name ()))
       {
 	return (pst);
       }
@@ -3127,7 +4185,103 @@ copy_sal (struct symtab_and_line *orig)
    find the one whose first PC is closer than that of the next line in this
    symtab.  */
 
-/* If it's worth the effort, we could be using a binary search.  */
+/* APPLE LOCAL begin line table index  */
+/* An index of a symtab's line table, for searching it by address and
+   by line number.  Most readers leave the entries in address order,
+   and then find_pc_sect_line can binary search the table itself; the
+   index just remembers whether that is so.  For line numbers it keeps
+   the entries with a nonzero line sorted by line and then by position.
+
+   Only line table positions are stored, so the index stays valid when
+   the objfile is relocated.  It lives on the objfile's obstack and
+   goes away with it.  */
+
+struct linetable_index_entry
+{
+  int line;
+  int index;
+};
+
+struct linetable_index
+{
+  /* The line table this was built from, and its size at the time.  */
+  struct linetable *linetable;
+  int nitems;
+
+  /* Nonzero if the entries' pcs never decrease.  */
+  int pc_sorted;
+
+  /* Number of entries in BY_LINE.  */
+  int nlines;
+
+  struct linetable_index_entry *by_line;
+};
+
+static int
+compare_linetable_index_entries (const void *a, const void *b)
+{
+  const struct linetable_index_entry *ea = a;
+  const struct linetable_index_entry *eb = b;
+
+  if (ea->line != eb->line)
+    return ea->line < eb->line ? -1 : 1;
+  if (ea->index != eb->index)
+    return ea->index < eb->index ? -1 : 1;
+  return 0;
+}
+
+/* Return the line table index for symtab S, building it if this is
+   the first time it has been asked for.  Returns NULL if S has no
+   line table.  */
+
+static struct linetable_index *
+linetable_index (struct symtab *s)
+{
+  struct linetable *l = LINETABLE (s);
+  struct linetable_index *index = s->linetable_index;
+  struct obstack *obstack;
+  int i, n;
+
+  if (l == NULL || s->objfile == NULL)
+    return NULL;
+  if (index != NULL && index->linetable == l && index->nitems == l->nitems)
+    return index;
+
+  obstack = &s->objfile->objfile_obstack;
+  index = (struct linetable_index *)
+    obstack_alloc (obstack, sizeof (struct linetable_index));
+  index->linetable = l;
+  index->nitems = l->nitems;
+
+  index->pc_sorted = 1;
+  n = 0;
+  for (i = 0; i < l->nitems; i++)
+    {
+      if (i > 0 && l->item[i].pc < l->item[i - 1].pc)
+	index->pc_sorted = 0;
+      if (l->item[i].line > 0)
+	n++;
+    }
+
+  index->nlines = n;
+  index->by_line = (struct linetable_index_entry *)
+    obstack_alloc (obstack, (n + 1) * sizeof (struct linetable_index_entry));
+  n = 0;
+  for (i = 0; i < l->nitems; i++)
+    if (l->item[i].line > 0)
+      {
+	index->by_line[n].line = l->item[i].line;
+	index->by_line[n].index = i;
+	n++;
+      }
+  qsort (index->by_line, n, sizeof (struct linetable_index_entry),
+	 compare_linetable_index_entries);
+
+  s->linetable_index = index;
+  return index;
+}
+/* APPLE LOCAL end line table index  */
+
 struct symtab_and_line
 find_pc_sect_line (CORE_ADDR pc, struct bfd_section *section, int notcurrent)
 {
@@ -3136,6 +4290,8 @@ find_pc_sect_line (CORE_ADDR pc, struct bfd_section *section, int notcurrent)
   int len;
   int i;
   struct linetable_entry *item;
+  /* APPLE LOCAL line table index  */
+  struct linetable_index *index;
   struct symtab_and_line val;
   struct blockvector *bv;
   struct minimal_symbol *msymbol;
@@ -3322,6 +4478,40 @@ find_pc_sect_line (CORE_ADDR pc, struct bfd_section *section, int notcurrent)
 	  alt_symtab = s;
 	}
 
+      /* APPLE LOCAL begin line table index  */
+      /* In a table sorted by pc, the scan below stops just after the
+	 first entry at PC if there is one, and otherwise at the first
+	 entry after PC; find that place by binary search instead.  */
+      index = linetable_index (s);
+      if (index != NULL && index->pc_sorted)
+	{
+	  int low = 0;
+	  int high = len;
+
+	  while (low < high)
+	    {
+	      int mid = low + (high - low) / 2;
+
+	      if (l->item[mid].pc < pc)
+		low = mid + 1;
+	      else
+		high = mid;
+	    }
+
+	  if (low < len && l->item[low].pc == pc)
+	    {
+	      prev = &l->item[low];
+	      i = low + 1;
+	    }
+	  else
+	    {
+	      prev = low > 0 ? &l->item[low - 1] : NULL;
+	      i = low;
+	    }
+	  item = &l->item[i];
+	}
+      else
+      /* APPLE LOCAL end line table index  */
       for (i = 0; i < len; i++, item++)
 	{
 	  /* Leave prev pointing to the linetable entry for the last line
@@ -3699,7 +4889,8 @@ find_line_symtab (struct symtab *symtab, int line, int *index, int *exact_match)
   /* First try looking it up in the given symtab.  */
   best_linetable = LINETABLE (symtab);
   best_symtab = symtab;
-  best_index = find_line_common (best_linetable, line, &exact);
+  /* APPLE LOCAL line table index  */
+  best_index = find_line_common (symtab, line, &exact);
   if (best_index < 0 || !exact)
     {
       /* Didn't find an exact match.  So we better keep looking for
@@ -3730,7 +4921,8 @@ find_line_symtab (struct symtab *symtab, int line, int *index, int *exact_match)
 	if (strcmp (symtab->filename, s->filename) != 0)
 	  continue;
 	l = LINETABLE (s);
-	ind = find_line_common (l, line, &exact);
+	/* APPLE LOCAL line table index  */
+	ind = find_line_common (s, line, &exact);
 	if (ind >= 0)
 	  {
 	    if (exact)
@@ -3879,9 +5071,12 @@ find_line_pc_range (struct symtab_and_line sal, CORE_ADDR *startptr,
    Set *EXACT_MATCH nonzero if the value returned is an exact match.  */
 
 static int
-find_line_common (struct linetable *l, int lineno,
+find_line_common (struct symtab *s, int lineno,
 		  int *exact_match)
 {
+  /* APPLE LOCAL line table index  */
+  struct linetable *l;
+  struct linetable_index *index;
   int i;
   int len;
 
@@ -3894,8 +5089,39 @@ find_line_common (struct linetable *l, int lineno,
 
   if (lineno <= 0)
     return -1;
-  if (l == 0)
+  /* APPLE LOCAL begin line table index  */
+  if (s == NULL || LINETABLE (s) == NULL)
     return -1;
+  l = LINETABLE (s);
+
+  /* The first entry in the by-line index with a line of at least
+     LINENO is the lowest numbered entry of the smallest such line,
+     which is just what the scan below would find.  */
+  index = linetable_index (s);
+  if (index != NULL)
+    {
+      int low = 0;
+      int high = index->nlines;
+
+      while (low < high)
+	{
+	  int mid = low + (high - low) / 2;
+
+	  if (index->by_line[mid].line < lineno)
+	    low = mid + 1;
+	  else
+	    high = mid;
+	}
+
+      if (low == index->nlines)
+	{
+	  *exact_match = 0;
+	  return -1;
+	}
+      *exact_match = (index->by_line[low].line == lineno);
+      return index->by_line[low].index;
+    }
+  /* APPLE LOCAL end line table index  */
 
   len = l->nitems;
   for (i = 0; i < len; i++)
@@ -4423,66 +5649,430 @@ sort_search_symbols (struct symbol_search *prevtail, int nfound)
   return symp;
 }
 
-/* Search the symbol table for matches to the regular expression REGEXP,
-   returning the results in *MATCHES.
-
-   Only symbols of KIND are searched:
-   FUNCTIONS_DOMAIN - search all functions
-   TYPES_DOMAIN     - search all type names
-   METHODS_DOMAIN   - search all methods NOT IMPLEMENTED
-   VARIABLES_DOMAIN - search all symbols, excluding functions, type names,
-   and constants (enums)
+/* APPLE LOCAL begin parallel symbol search  */
+/* The number of threads search_symbols may use to match symbol names
+   against the regexp.  0 or 1 means match everything on the calling
+   thread.  */
 
-   free_search_symbols should be called when *MATCHES is no longer needed.
+static int symbol_search_threads = 0;
 
-   The results are sorted locally; each symtab's global and static blocks are
-   separately alphabetized.
- */
-void
-search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
-		struct symbol_search **matches)
+static void
+show_symbol_search_threads (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
 {
-  struct symtab *s;
-  struct partial_symtab *ps;
-  struct blockvector *bv;
-  struct blockvector *prev_bv = 0;
-  struct block *b;
-  int i = 0;
-  struct dict_iterator iter;
-  struct symbol *sym;
-  struct partial_symbol **psym;
-  struct objfile *objfile;
-  struct minimal_symbol *msymbol;
-  char *val;
-  int found_misc = 0;
-  static enum minimal_symbol_type types[]
-  =
-  {mst_data, mst_text, mst_abs, mst_unknown};
-  static enum minimal_symbol_type types2[]
-  =
-  {mst_bss, mst_file_text, mst_abs, mst_unknown};
-  static enum minimal_symbol_type types3[]
-  =
-  {mst_file_data, mst_solib_trampoline, mst_abs, mst_unknown};
-  static enum minimal_symbol_type types4[]
-  =
-  {mst_file_bss, mst_text, mst_abs, mst_unknown};
-  enum minimal_symbol_type ourtype;
-  enum minimal_symbol_type ourtype2;
-  enum minimal_symbol_type ourtype3;
-  enum minimal_symbol_type ourtype4;
-  struct symbol_search *sr;
-  struct symbol_search *psr;
-  struct symbol_search *tail;
-  struct cleanup *old_chain = NULL;
+  fprintf_filtered (file, _("\
+The number of threads used to match symbols for \"info functions\" and \
+the like is %s.\n"),
+		    value);
+}
 
-  if (kind < VARIABLES_DOMAIN)
-    error (_("must search on specific domain"));
+/* Don't give a thread fewer names than this to match; below it the
+   thread startup costs more than it saves.  */
 
-  ourtype = types[(int) (kind - VARIABLES_DOMAIN)];
-  ourtype2 = types2[(int) (kind - VARIABLES_DOMAIN)];
-  ourtype3 = types3[(int) (kind - VARIABLES_DOMAIN)];
-  ourtype4 = types4[(int) (kind - VARIABLES_DOMAIN)];
+#define SYMBOL_SEARCH_MIN_PER_THREAD 20000
+
+/* What a worker decided about a psymtab or msymbol.  SEARCH_UNKNOWN
+   means the name can't be had without changing the symbol (Ada names
+   are decoded on demand), so the main thread must look again.  */
+
+#define SEARCH_NO_MATCH 0
+#define SEARCH_MATCH 1
+#define SEARCH_UNKNOWN 2
+
+static int
+symbol_search_n_workers (int count)
+{
+  int n_workers = symbol_search_threads;
+
+#ifndef USE_PTHREADS
+  n_workers = 1;
+#endif
+  if (n_workers > count / SYMBOL_SEARCH_MIN_PER_THREAD)
+    n_workers = count / SYMBOL_SEARCH_MIN_PER_THREAD;
+  if (n_workers < 1)
+    n_workers = 1;
+  return n_workers;
+}
+
+/* Does symbol name NAME match RE?  A NULL RE matches everything.  */
+
+static char
+search_name_matches (const regex_t *re, const char *name)
+{
+  return re == NULL || re_exec_buf (re, name) != 0;
+}
+
+/* Return SEARCH_MATCH if a symbol of KIND in PS, from one of the
+   NFILES FILES, matches RE; this is the test search_symbols uses to
+   decide which psymtabs to read in.  Unless SERIAL, this may be
+   called on any thread, so it doesn't QUIT and returns SEARCH_UNKNOWN
+   for names it can't look at safely.  */
+
+static char
+psymtab_search_matches (struct partial_symtab *ps, const regex_t *re,
+			domain_enum kind, int nfiles, char *files[],
+			int serial)
+{
+  struct objfile *objfile = ps->objfile;
+  struct partial_symbol **psym, **bound;
+  char result = SEARCH_NO_MATCH;
+  int pass;
+
+  if (!file_matches (ps->filename, files, nfiles))
+    return SEARCH_NO_MATCH;
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      if (pass == 0)
+	{
+	  psym = objfile->global_psymbols.list + ps->globals_offset;
+	  bound = psym + ps->n_global_syms;
+	}
+      else
+	{
+	  psym = objfile->static_psymbols.list + ps->statics_offset;
+	  bound = psym + ps->n_static_syms;
+	}
+
+      for (; psym < bound; psym++)
+	{
+	  struct general_symbol_info *ginfo = &(*psym)->ginfo;
+
+	  if (serial)
+	    QUIT;
+
+	  if (!((kind == VARIABLES_DOMAIN && SYMBOL_CLASS (*psym) != LOC_TYPEDEF
+		 && SYMBOL_CLASS (*psym) != LOC_BLOCK)
+		|| (kind == FUNCTIONS_DOMAIN && SYMBOL_CLASS (*psym) == LOC_BLOCK)
+		|| (kind == TYPES_DOMAIN && SYMBOL_CLASS (*psym) == LOC_TYPEDEF)
+		|| (kind == METHODS_DOMAIN && SYMBOL_CLASS (*psym) == LOC_BLOCK)))
+	    continue;
+
+	  if (re != NULL && !serial && ginfo->language == language_ada
+	      && ginfo->language_specific.cplus_specific.demangled_name == NULL)
+	    {
+	      result = SEARCH_UNKNOWN;
+	      continue;
+	    }
+
+	  if (search_name_matches (re, SYMBOL_NATURAL_NAME (*psym)))
+	    return SEARCH_MATCH;
+	}
+    }
+
+  return result;
+}
+
+/* One worker's share of a search.  It looks at either the psymtabs
+   PSYMTABS[START..END) or the msymbols MSYMBOLS[START..END), and
+   stores its verdicts in RESULT[START..END).  */
+
+struct symbol_search_chunk
+{
+  const regex_t *re;
+  domain_enum kind;
+  int nfiles;
+  char **files;
+  struct partial_symtab **psymtabs;
+  struct minimal_symbol *msymbols;
+  int start;
+  int end;
+  char *result;
+};
+
+static void *
+psymtab_search_chunk (void *arg)
+{
+  struct symbol_search_chunk *chunk = arg;
+  int i;
+
+  for (i = chunk->start; i < chunk->end; i++)
+    chunk->result[i] = psymtab_search_matches (chunk->psymtabs[i], chunk->re,
+					       chunk->kind, chunk->nfiles,
+					       chunk->files, 0);
+  return NULL;
+}
+
+static void *
+msymbol_search_chunk (void *arg)
+{
+  struct symbol_search_chunk *chunk = arg;
+  int i;
+
+  for (i = chunk->start; i < chunk->end; i++)
+    {
+      struct general_symbol_info *ginfo = &chunk->msymbols[i].ginfo;
+
+      if (ginfo->language == language_ada
+	  && ginfo->language_specific.cplus_specific.demangled_name == NULL)
+	chunk->result[i] = SEARCH_UNKNOWN;
+      else
+	chunk->result[i] = search_name_matches (chunk->re,
+						symbol_natural_name (ginfo));
+    }
+  return NULL;
+}
+
+/* Run FUNC over the N_WORKERS CHUNKS.  The calling thread does the
+   first chunk, and any chunk whose thread can't be started as well.  */
+
+static void
+symbol_search_run_chunks (struct symbol_search_chunk *chunks, int n_workers,
+			  void *(*func) (void *))
+{
+  int i;
+#ifdef USE_PTHREADS
+  pthread_t *threads;
+  int *started;
+
+  threads = xmalloc (n_workers * sizeof (pthread_t));
+  started = xcalloc (n_workers, sizeof (int));
+  for (i = 1; i < n_workers; i++)
+    started[i] = (pthread_create (&threads[i], NULL, func, &chunks[i]) == 0);
+
+  func (&chunks[0]);
+
+  for (i = 1; i < n_workers; i++)
+    if (started[i])
+      pthread_join (threads[i], NULL);
+    else
+      func (&chunks[i]);
+
+  xfree (started);
+  xfree (threads);
+#else
+  for (i = 0; i < n_workers; i++)
+    func (&chunks[i]);
+#endif
+}
+
+/* Read in every unread psymtab with a symbol of KIND, from one of the
+   NFILES FILES, whose name matches RE.  The names are matched on
+   several threads when there are enough of them; the psymtabs are
+   then read in on this thread, in the same order as before.  */
+
+static void
+search_symbols_read_psymtabs (const regex_t *re, domain_enum kind,
+			      int nfiles, char *files[])
+{
+  struct objfile *objfile;
+  struct partial_symtab *ps;
+  struct partial_symtab **psymtabs;
+  struct symbol_search_chunk *chunks;
+  struct cleanup *cleanups;
+  char *result;
+  long long total = 0, done = 0;
+  int count = 0;
+  int n_workers;
+  int i, w;
+
+  ALL_PSYMTABS (objfile, ps)
+    if (!ps->readin)
+      {
+	count++;
+	total += ps->n_global_syms + ps->n_static_syms;
+      }
+
+  n_workers = symbol_search_n_workers (total > INT_MAX ? INT_MAX : total);
+  if (n_workers == 1)
+    {
+      ALL_PSYMTABS (objfile, ps)
+	{
+	  if (ps->readin)
+	    continue;
+	  if (psymtab_search_matches (ps, re, kind, nfiles, files, 1)
+	      == SEARCH_MATCH)
+	    PSYMTAB_TO_SYMTAB (ps);
+	}
+      return;
+    }
+
+  psymtabs = xmalloc (count * sizeof (struct partial_symtab *));
+  cleanups = make_cleanup (xfree, psymtabs);
+  result = xmalloc (count);
+  make_cleanup (xfree, result);
+  chunks = xcalloc (n_workers, sizeof (struct symbol_search_chunk));
+  make_cleanup (xfree, chunks);
+
+  /* Split the psymtabs so that each worker gets about the same number
+     of symbols, rather than the same number of psymtabs.  */
+  i = 0;
+  w = 0;
+  ALL_PSYMTABS (objfile, ps)
+    if (!ps->readin)
+      {
+	while (w < n_workers - 1 && done >= total * (w + 1) / n_workers)
+	  chunks[++w].start = i;
+	psymtabs[i++] = ps;
+	done += ps->n_global_syms + ps->n_static_syms;
+      }
+  while (w < n_workers - 1)
+    chunks[++w].start = count;
+
+  for (w = 0; w < n_workers; w++)
+    {
+      chunks[w].re = re;
+      chunks[w].kind = kind;
+      chunks[w].nfiles = nfiles;
+      chunks[w].files = files;
+      chunks[w].psymtabs = psymtabs;
+      chunks[w].end = (w == n_workers - 1) ? count : chunks[w + 1].start;
+      chunks[w].result = result;
+    }
+
+  symbol_search_run_chunks (chunks, n_workers, psymtab_search_chunk);
+  QUIT;
+
+  for (i = 0; i < count; i++)
+    {
+      ps = psymtabs[i];
+      /* Reading an earlier psymtab may have read this one in as one
+	 of its dependencies.  */
+      if (ps->readin)
+	continue;
+      if (result[i] == SEARCH_UNKNOWN)
+	result[i] = psymtab_search_matches (ps, re, kind, nfiles, files, 1);
+      if (result[i] == SEARCH_MATCH)
+	PSYMTAB_TO_SYMTAB (ps);
+    }
+
+  do_cleanups (cleanups);
+}
+
+/* Fill *MATCHED, growing it to *SIZE as needed, with whether each of
+   OBJFILE's msymbols matches RE, using several threads.  Return zero,
+   leaving *MATCHED alone, if there are too few msymbols to be worth
+   it; the caller should then match them itself.  */
+
+static int
+msymbol_search_fill (struct objfile *objfile, const regex_t *re,
+		     char **matched, int *size)
+{
+  struct symbol_search_chunk *chunks;
+  int count, n_workers, w;
+
+  if (re == NULL)
+    return 0;
+
+  /* Demangling changes the msymbols, so do it before looking at
+     them from other threads.  */
+  minimal_symbols_demangle (objfile);
+
+  count = objfile->minimal_symbol_count;
+  n_workers = symbol_search_n_workers (count);
+  if (n_workers == 1)
+    return 0;
+
+  if (*size < count)
+    {
+      *matched = xrealloc (*matched, count);
+      *size = count;
+    }
+
+  chunks = xcalloc (n_workers, sizeof (struct symbol_search_chunk));
+  for (w = 0; w < n_workers; w++)
+    {
+      chunks[w].re = re;
+      chunks[w].msymbols = objfile->msymbols;
+      chunks[w].start = (int) ((long long) count * w / n_workers);
+      chunks[w].end = (int) ((long long) count * (w + 1) / n_workers);
+      chunks[w].result = *matched;
+    }
+  symbol_search_run_chunks (chunks, n_workers, msymbol_search_chunk);
+  xfree (chunks);
+  return 1;
+}
+
+/* Does MSYMBOL, one of OBJFILE's msymbols, match RE?  MATCHED holds
+   what msymbol_search_fill found, or is NULL if it found nothing.  */
+
+static int
+msymbol_search_matches (struct objfile *objfile,
+			struct minimal_symbol *msymbol,
+			const regex_t *re, const char *matched)
+{
+  if (matched != NULL)
+    {
+      char result = matched[msymbol - objfile->msymbols];
+      if (result != SEARCH_UNKNOWN)
+	return result == SEARCH_MATCH;
+    }
+  return search_name_matches (re, SYMBOL_NATURAL_NAME (msymbol));
+}
+
+static void
+do_regfree_cleanup (void *re)
+{
+  regfree ((regex_t *) re);
+}
+/* APPLE LOCAL end parallel symbol search  */
+
+/* Search the symbol table for matches to the regular expression REGEXP,
+   returning the results in *MATCHES.
+
+   Only symbols of KIND are searched:
+   FUNCTIONS_DOMAIN - search all functions
+   TYPES_DOMAIN     - search all type names
+   METHODS_DOMAIN   - search all methods NOT IMPLEMENTED
+   VARIABLES_DOMAIN - search all symbols, excluding functions, type names,
+   and constants (enums)
+
+   free_search_symbols should be called when *MATCHES is no longer needed.
+
+   The results are sorted locally; each symtab's global and static blocks are
+   separately alphabetized.
+ */
+void
+search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
+		struct symbol_search **matches)
+{
+  struct symtab *s;
+  struct blockvector *bv;
+  struct blockvector *prev_bv = 0;
+  struct block *b;
+  int i = 0;
+  struct dict_iterator iter;
+  struct symbol *sym;
+  struct objfile *objfile;
+  struct minimal_symbol *msymbol;
+  char *val;
+  int found_misc = 0;
+  static enum minimal_symbol_type types[]
+  =
+  {mst_data, mst_text, mst_abs, mst_unknown};
+  static enum minimal_symbol_type types2[]
+  =
+  {mst_bss, mst_file_text, mst_abs, mst_unknown};
+  static enum minimal_symbol_type types3[]
+  =
+  {mst_file_data, mst_solib_trampoline, mst_abs, mst_unknown};
+  static enum minimal_symbol_type types4[]
+  =
+  {mst_file_bss, mst_text, mst_abs, mst_unknown};
+  enum minimal_symbol_type ourtype;
+  enum minimal_symbol_type ourtype2;
+  enum minimal_symbol_type ourtype3;
+  enum minimal_symbol_type ourtype4;
+  struct symbol_search *sr;
+  struct symbol_search *psr;
+  struct symbol_search *tail;
+  struct cleanup *old_chain = NULL;
+  /* APPLE LOCAL begin parallel symbol search  */
+  struct cleanup *search_chain;
+  regex_t re;
+  const regex_t *rep = NULL;
+  char *matched_buf = NULL;
+  int matched_size = 0;
+  char *matched;
+  /* APPLE LOCAL end parallel symbol search  */
+
+  if (kind < VARIABLES_DOMAIN)
+    error (_("must search on specific domain"));
+
+  ourtype = types[(int) (kind - VARIABLES_DOMAIN)];
+  ourtype2 = types2[(int) (kind - VARIABLES_DOMAIN)];
+  ourtype3 = types3[(int) (kind - VARIABLES_DOMAIN)];
+  ourtype4 = types4[(int) (kind - VARIABLES_DOMAIN)];
 
   sr = *matches = NULL;
   tail = NULL;
@@ -4519,64 +6109,27 @@ search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
 	    }
 	}
 
-      if (0 != (val = re_comp (regexp)))
+      /* APPLE LOCAL begin parallel symbol search  */
+      /* Compile the regexp into a buffer of our own rather than with
+	 re_comp, so that the worker threads can all match against it.  */
+      if (0 != (val = re_comp_buf (&re, regexp)))
 	error (_("Invalid regexp (%s): %s"), val, regexp);
+      rep = &re;
+      /* APPLE LOCAL end parallel symbol search  */
     }
 
+  /* APPLE LOCAL begin parallel symbol search  */
+  search_chain = make_cleanup (free_current_contents, &matched_buf);
+  if (rep != NULL)
+    make_cleanup (do_regfree_cleanup, &re);
+  /* APPLE LOCAL end parallel symbol search  */
+
   /* Search through the partial symtabs *first* for all symbols
      matching the regexp.  That way we don't have to reproduce all of
      the machinery below. */
 
-  ALL_PSYMTABS (objfile, ps)
-  {
-    struct partial_symbol **bound, **gbound, **sbound;
-    int keep_going = 1;
-
-    if (ps->readin)
-      continue;
-
-    gbound = objfile->global_psymbols.list + ps->globals_offset + ps->n_global_syms;
-    sbound = objfile->static_psymbols.list + ps->statics_offset + ps->n_static_syms;
-    bound = gbound;
-
-    /* Go through all of the symbols stored in a partial
-       symtab in one loop. */
-    psym = objfile->global_psymbols.list + ps->globals_offset;
-    while (keep_going)
-      {
-	if (psym >= bound)
-	  {
-	    if (bound == gbound && ps->n_static_syms != 0)
-	      {
-		psym = objfile->static_psymbols.list + ps->statics_offset;
-		bound = sbound;
-	      }
-	    else
-	      keep_going = 0;
-	    continue;
-	  }
-	else
-	  {
-	    QUIT;
-
-	    /* If it would match (logic taken from loop below)
-	       load the file and go on to the next one */
-	    if (file_matches (ps->filename, files, nfiles)
-		&& ((regexp == NULL
-		     || re_exec (SYMBOL_NATURAL_NAME (*psym)) != 0)
-		    && ((kind == VARIABLES_DOMAIN && SYMBOL_CLASS (*psym) != LOC_TYPEDEF
-			 && SYMBOL_CLASS (*psym) != LOC_BLOCK)
-			|| (kind == FUNCTIONS_DOMAIN && SYMBOL_CLASS (*psym) == LOC_BLOCK)
-			|| (kind == TYPES_DOMAIN && SYMBOL_CLASS (*psym) == LOC_TYPEDEF)
-			|| (kind == METHODS_DOMAIN && SYMBOL_CLASS (*psym) == LOC_BLOCK))))
-	      {
-		PSYMTAB_TO_SYMTAB (ps);
-		keep_going = 0;
-	      }
-	  }
-	psym++;
-      }
-  }
+  /* APPLE LOCAL parallel symbol search  */
+  search_symbols_read_psymtabs (rep, kind, nfiles, files);
 
   /* APPLE LOCAL: Make an additional pass over the msymbols raising
      the load level of any objfiles that contain the symbol of interest.
@@ -4588,6 +6141,9 @@ search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
       struct objfile *tmp;
       ALL_OBJFILES_SAFE (objfile, tmp)
         {
+          /* APPLE LOCAL parallel symbol search  */
+          matched = msymbol_search_fill (objfile, rep, &matched_buf,
+                                         &matched_size) ? matched_buf : NULL;
           ALL_OBJFILE_MSYMBOLS (objfile, msymbol)
             {
               /* APPLE LOCAL fix-and-continue */
@@ -4599,8 +6155,8 @@ search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
 	          MSYMBOL_TYPE (msymbol) == ourtype3 ||
 	          MSYMBOL_TYPE (msymbol) == ourtype4)
 	        {
-	          if (regexp == NULL
-                       || re_exec (SYMBOL_NATURAL_NAME (msymbol)) != 0)
+	          /* APPLE LOCAL parallel symbol search  */
+	          if (msymbol_search_matches (objfile, msymbol, rep, matched))
                     {
                       objfile_set_load_state (objfile, OBJF_SYM_ALL, 1);
                       /* On to the next objfile.  */
@@ -4628,6 +6184,9 @@ search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
     {
       ALL_OBJFILES (objfile)
       {
+      /* APPLE LOCAL parallel symbol search  */
+      matched = msymbol_search_fill (objfile, rep, &matched_buf,
+				     &matched_size) ? matched_buf : NULL;
       ALL_OBJFILE_MSYMBOLS (objfile, msymbol)
       {
         /* APPLE LOCAL fix-and-continue */
@@ -4645,8 +6204,8 @@ search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
             if (strncmp (SYMBOL_LINKAGE_NAME (msymbol), "dyld_stub_", 10) == 0)
               continue;
 
-	    if (regexp == NULL
-		|| re_exec (SYMBOL_NATURAL_NAME (msymbol)) != 0)
+	    /* APPLE LOCAL parallel symbol search  */
+	    if (msymbol_search_matches (objfile, msymbol, rep, matched))
 	      {
 		if (0 == find_pc_symtab (SYMBOL_VALUE_ADDRESS (msymbol)))
 		  {
@@ -4700,7 +6259,7 @@ search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
 
 	      if (file_matches (s->filename, files, nfiles)
 		  && ((regexp == NULL
-		       || re_exec (SYMBOL_NATURAL_NAME (sym)) != 0)
+		       || re_exec_buf (rep, SYMBOL_NATURAL_NAME (sym)) != 0)
 		      && ((kind == VARIABLES_DOMAIN && SYMBOL_CLASS (sym) != LOC_TYPEDEF
 			   && SYMBOL_CLASS (sym) != LOC_BLOCK
 			   && SYMBOL_CLASS (sym) != LOC_CONST)
@@ -4749,6 +6308,9 @@ search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
     {
       ALL_OBJFILES (objfile)
       {
+      /* APPLE LOCAL parallel symbol search  */
+      matched = msymbol_search_fill (objfile, rep, &matched_buf,
+				     &matched_size) ? matched_buf : NULL;
       ALL_OBJFILE_MSYMBOLS (objfile, msymbol)
       {
         /* APPLE LOCAL fix-and-continue */
@@ -4760,8 +6322,8 @@ search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
 	    MSYMBOL_TYPE (msymbol) == ourtype3 ||
 	    MSYMBOL_TYPE (msymbol) == ourtype4)
 	  {
-	    if (regexp == NULL
-		|| re_exec (SYMBOL_NATURAL_NAME (msymbol)) != 0)
+	    /* APPLE LOCAL parallel symbol search  */
+	    if (msymbol_search_matches (objfile, msymbol, rep, matched))
 	      {
 		/* Functions:  Look up by address. */
 		if (kind != FUNCTIONS_DOMAIN ||
@@ -4800,6 +6362,8 @@ search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
   *matches = sr;
   if (sr != NULL)
     discard_cleanups (old_chain);
+  /* APPLE LOCAL parallel symbol search  */
+  do_cleanups (search_chain);
 }
 
 /* Helper function for symtab_symbol_info, this function uses
@@ -5066,6 +6630,27 @@ rbreak_command (char *regexp, int from_tty)
 }
 
 
+/* APPLE LOCAL begin lazy macro tables  */
+struct macro_table *
+symtab_macro_table (struct symtab *s)
+{
+  struct lazy_macro_table *lazy = s->lazy_macro_table;
+
+  if (s->macro_table != NULL || lazy == NULL)
+    return s->macro_table;
+
+  /* Mark it read first, so that an error part way through doesn't
+     make every later lookup try again.  */
+  if (!lazy->read_p)
+    {
+      lazy->read_p = 1;
+      lazy->table = lazy->read (lazy->data);
+    }
+  s->macro_table = lazy->table;
+  return s->macro_table;
+}
+/* APPLE LOCAL end lazy macro tables  */
+
 /* Helper routine for make_symbol_completion_list.  */
 
 static int return_val_size;
@@ -5187,6 +6772,233 @@ completion_list_objc_symbol (struct minimal_symbol *msymbol, char *sym_text,
     }
 }
 
+/* APPLE LOCAL begin completion index  */
+/* Completing a symbol used to look at every partial symbol and every
+   minimal symbol in the program, which takes seconds on a large app.
+   Instead each objfile gets a sorted array of the names those would
+   have offered, built the first time a completion needs it, and a
+   completion looks only at the run of names that start with the text
+   typed so far.
+
+   Fully read-in symtabs are still walked; there are few of them, and
+   what's in them can change as psymtabs are expanded.  */
+
+struct completion_index_entry
+{
+  const char *name;
+
+  /* The psymtab the name comes from, or NULL for a minimal symbol
+     or one of the names derived from an ObjC method.  A psymtab's
+     names are skipped once it has been read in, since the symtab
+     walk will find them.  */
+  struct partial_symtab *psymtab;
+};
+
+struct completion_index
+{
+  struct completion_index_entry *entries;
+  int nentries;
+  int allocated;
+
+  /* What the objfile had when the index was built.  If any of these
+     change, the index is rebuilt.  */
+  int minimal_symbol_count;
+  int nglobal_psymbols;
+  int nstatic_psymbols;
+
+  /* Holds the names made up from ObjC method symbols.  */
+  struct obstack names;
+};
+
+static const struct objfile_data *completion_index_objfile_data;
+
+static int symbol_completion_index = 1;
+
+static void
+show_symbol_completion_index (struct ui_file *file, int from_tty,
+			      struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Use of the symbol completion index is %s.\n"),
+		    value);
+}
+
+static void
+completion_index_free (struct completion_index *index)
+{
+  xfree (index->entries);
+  obstack_free (&index->names, NULL);
+  xfree (index);
+}
+
+static void
+completion_index_objfile_freed (struct objfile *objfile, void *data)
+{
+  if (data != NULL)
+    completion_index_free (data);
+}
+
+static void
+completion_index_add (struct completion_index *index, const char *name,
+		      struct partial_symtab *psymtab)
+{
+  if (index->nentries == index->allocated)
+    {
+      index->allocated = index->allocated ? index->allocated * 2 : 1024;
+      index->entries = xrealloc (index->entries, index->allocated
+				 * sizeof (struct completion_index_entry));
+    }
+  index->entries[index->nentries].name = name;
+  index->entries[index->nentries].psymtab = psymtab;
+  index->nentries++;
+}
+
+/* Add the names completion_list_objc_symbol would offer for METHOD, an
+   ObjC method's "-[Class(Category) selector]" name.  */
+
+static void
+completion_index_add_objc (struct completion_index *index, char *method)
+{
+  char *category, *selector, *end;
+
+  if (method[0] != '-' && method[0] != '+')
+    return;
+
+  /* Only offered when completing on "[...".  */
+  completion_index_add (index, method + 1, NULL);
+
+  selector = strchr (method, ' ');
+  if (selector != NULL)
+    selector++;
+
+  category = strchr (method, '(');
+  if (category != NULL && selector != NULL)
+    {
+      char *name;
+
+      obstack_grow (&index->names, method, category - method);
+      obstack_1grow (&index->names, ' ');
+      obstack_grow0 (&index->names, selector, strlen (selector));
+      name = obstack_finish (&index->names);
+      completion_index_add (index, name, NULL);
+      completion_index_add (index, name + 1, NULL);
+    }
+
+  if (selector != NULL)
+    {
+      end = strchr (selector, ']');
+      if (end == NULL)
+	end = selector + strlen (selector);
+      completion_index_add (index, obstack_copy0 (&index->names, selector,
+						   end - selector), NULL);
+    }
+}
+
+static int
+compare_completion_index_entries (const void *a, const void *b)
+{
+  const struct completion_index_entry *ea = a;
+  const struct completion_index_entry *eb = b;
+
+  return strcmp (ea->name, eb->name);
+}
+
+/* Return OBJFILE's completion index, building it if there isn't an
+   up-to-date one.  */
+
+static struct completion_index *
+completion_index_get (struct objfile *objfile)
+{
+  struct completion_index *index;
+  struct partial_symtab *ps;
+  struct partial_symbol **psym;
+  struct minimal_symbol *msymbol;
+  int nglobal = objfile->global_psymbols.next - objfile->global_psymbols.list;
+  int nstatic = objfile->static_psymbols.next - objfile->static_psymbols.list;
+
+  index = objfile_data (objfile, completion_index_objfile_data);
+  if (index != NULL)
+    {
+      if (index->minimal_symbol_count == objfile->minimal_symbol_count
+	  && index->nglobal_psymbols == nglobal
+	  && index->nstatic_psymbols == nstatic)
+	return index;
+      completion_index_free (index);
+    }
+
+  index = xcalloc (1, sizeof (struct completion_index));
+  obstack_init (&index->names);
+  index->minimal_symbol_count = objfile->minimal_symbol_count;
+  index->nglobal_psymbols = nglobal;
+  index->nstatic_psymbols = nstatic;
+  set_objfile_data (objfile, completion_index_objfile_data, index);
+
+  ALL_OBJFILE_PSYMTABS (objfile, ps)
+    {
+      QUIT;
+      for (psym = objfile->global_psymbols.list + ps->globals_offset;
+	   psym < (objfile->global_psymbols.list + ps->globals_offset
+		   + ps->n_global_syms);
+	   psym++)
+	completion_index_add (index, SYMBOL_NATURAL_NAME (*psym), ps);
+
+      for (psym = objfile->static_psymbols.list + ps->statics_offset;
+	   psym < (objfile->static_psymbols.list + ps->statics_offset
+		   + ps->n_static_syms);
+	   psym++)
+	completion_index_add (index, SYMBOL_NATURAL_NAME (*psym), ps);
+    }
+
+  ALL_OBJFILE_MSYMBOLS (objfile, msymbol)
+    {
+      QUIT;
+      completion_index_add (index, SYMBOL_NATURAL_NAME (msymbol), NULL);
+      completion_index_add_objc (index, SYMBOL_NATURAL_NAME (msymbol));
+    }
+
+  qsort (index->entries, index->nentries,
+	 sizeof (struct completion_index_entry),
+	 compare_completion_index_entries);
+  return index;
+}
+
+/* Add every name in OBJFILE's completion index that starts with the
+   SYM_TEXT_LEN characters of SYM_TEXT.  */
+
+static void
+completion_index_add_matches (struct objfile *objfile, char *sym_text,
+			      int sym_text_len, char *text, char *word)
+{
+  struct completion_index *index = completion_index_get (objfile);
+  int lo = 0, hi = index->nentries;
+
+  /* Find the first name not less than SYM_TEXT's prefix.  */
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      if (strncmp (index->entries[mid].name, sym_text, sym_text_len) < 0)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  for (; lo < index->nentries; lo++)
+    {
+      struct completion_index_entry *entry = &index->entries[lo];
+
+      if (strncmp (entry->name, sym_text, sym_text_len) != 0)
+	break;
+      QUIT;
+      if (entry->psymtab != NULL && entry->psymtab->readin)
+	continue;
+      if (entry->name[0] == '[' && sym_text[0] != '[')
+	continue;
+      completion_list_add_name ((char *) entry->name, sym_text, sym_text_len,
+				text, word);
+    }
+}
+/* APPLE LOCAL end completion index  */
+
 /* Break the non-quoted text based on the characters which are in
    symbols. FIXME: This should probably be language-specific. */
 
@@ -5234,6 +7046,61 @@ language_search_unquoted_string (char *text, char *p)
 }
 
 
+/* APPLE LOCAL begin completion index  */
+/* Add every partial and minimal symbol that matches SYM_TEXT, the way
+   completion worked before the index.  */
+
+static void
+completion_list_add_all_symbols (char *sym_text, int sym_text_len,
+				 char *text, char *word)
+{
+  struct objfile *objfile;
+  struct partial_symtab *ps;
+  struct partial_symbol **psym;
+  struct minimal_symbol *msymbol;
+
+  ALL_PSYMTABS (objfile, ps)
+  {
+    /* If the psymtab's been read in we'll get it when we search
+       through the blockvector.  */
+    if (ps->readin)
+      continue;
+
+    for (psym = objfile->global_psymbols.list + ps->globals_offset;
+	 psym < (objfile->global_psymbols.list + ps->globals_offset
+		 + ps->n_global_syms);
+	 psym++)
+      {
+	/* If interrupted, then quit. */
+	QUIT;
+	COMPLETION_LIST_ADD_SYMBOL (*psym, sym_text, sym_text_len, text, word);
+      }
+
+    for (psym = objfile->static_psymbols.list + ps->statics_offset;
+	 psym < (objfile->static_psymbols.list + ps->statics_offset
+		 + ps->n_static_syms);
+	 psym++)
+      {
+	QUIT;
+	COMPLETION_LIST_ADD_SYMBOL (*psym, sym_text, sym_text_len, text, word);
+      }
+  }
+
+  /* At this point scan through the misc symbol vectors and add each
+     symbol you find to the list.  Eventually we want to ignore
+     anything that isn't a text symbol (everything else will be
+     handled by the psymtab code above).  */
+
+  ALL_MSYMBOLS (objfile, msymbol)
+  {
+    QUIT;
+    COMPLETION_LIST_ADD_SYMBOL (msymbol, sym_text, sym_text_len, text, word);
+
+    completion_list_objc_symbol (msymbol, sym_text, sym_text_len, text, word);
+  }
+}
+/* APPLE LOCAL end completion index  */
+
 /* Return a NULL terminated array of all symbols (regardless of class)
    which begin by matching TEXT.  If the answer is no symbols, then
    the return value is an array which contains only a NULL pointer.
@@ -5246,13 +7113,10 @@ make_symbol_completion_list (char *text, char *word)
 {
   struct symbol *sym;
   struct symtab *s;
-  struct partial_symtab *ps;
-  struct minimal_symbol *msymbol;
   struct objfile *objfile;
   struct block *b, *surrounding_static_block = 0;
   struct dict_iterator iter;
   int j;
-  struct partial_symbol **psym;
   /* The symbol we are completing on.  Points in same buffer as text.  */
   char *sym_text;
   /* Length of sym_text.  */
@@ -5321,45 +7185,16 @@ make_symbol_completion_list (char *text, char *word)
 
   sym_text_len = strlen (sym_text);
 
-  ALL_PSYMTABS (objfile, ps)
-  {
-    /* If the psymtab's been read in we'll get it when we search
-       through the blockvector.  */
-    if (ps->readin)
-      continue;
-
-    for (psym = objfile->global_psymbols.list + ps->globals_offset;
-	 psym < (objfile->global_psymbols.list + ps->globals_offset
-		 + ps->n_global_syms);
-	 psym++)
-      {
-	/* If interrupted, then quit. */
-	QUIT;
-	COMPLETION_LIST_ADD_SYMBOL (*psym, sym_text, sym_text_len, text, word);
-      }
-
-    for (psym = objfile->static_psymbols.list + ps->statics_offset;
-	 psym < (objfile->static_psymbols.list + ps->statics_offset
-		 + ps->n_static_syms);
-	 psym++)
-      {
-	QUIT;
-	COMPLETION_LIST_ADD_SYMBOL (*psym, sym_text, sym_text_len, text, word);
-      }
-  }
-
-  /* At this point scan through the misc symbol vectors and add each
-     symbol you find to the list.  Eventually we want to ignore
-     anything that isn't a text symbol (everything else will be
-     handled by the psymtab code above).  */
-
-  ALL_MSYMBOLS (objfile, msymbol)
-  {
-    QUIT;
-    COMPLETION_LIST_ADD_SYMBOL (msymbol, sym_text, sym_text_len, text, word);
-
-    completion_list_objc_symbol (msymbol, sym_text, sym_text_len, text, word);
-  }
+  /* APPLE LOCAL begin completion index  */
+  if (symbol_completion_index)
+    {
+      ALL_OBJFILES (objfile)
+	completion_index_add_matches (objfile, sym_text, sym_text_len,
+				      text, word);
+    }
+  else
+    completion_list_add_all_symbols (sym_text, sym_text_len, text, word);
+  /* APPLE LOCAL end completion index  */
 
   /* Search upwards from currently selected frame (so that we can
      complete on local vars.  */
@@ -5936,6 +7771,35 @@ symtab_observer_executable_changed (void *unused)
 void
 _initialize_symtab (void)
 {
+  /* APPLE LOCAL begin completion index  */
+  completion_index_objfile_data
+    = register_objfile_data_with_cleanup (completion_index_objfile_freed);
+
+  add_setshow_boolean_cmd ("symbol-completion-index", class_maintenance,
+			   &symbol_completion_index, _("\
+Set whether symbol completion uses a per-objfile index of names."), _("\
+Show whether symbol completion uses a per-objfile index of names."), _("\
+When on, completing a symbol name searches a sorted index of each objfile's\n\
+partial and minimal symbol names, built the first time it is needed,\n\
+instead of walking every symbol."),
+			   NULL, show_symbol_completion_index,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end completion index  */
+
+  /* APPLE LOCAL begin symbol lookup cache  */
+  add_setshow_boolean_cmd ("symbol-lookup-cache", class_maintenance,
+			   &symbol_lookup_cache_enabled, _("\
+Set whether the results of symbol lookups are remembered."), _("\
+Show whether the results of symbol lookups are remembered."), _("\
+When on, looking up a name again in the same block and domain, before\n\
+any objfile is added, removed or re-read, reuses the earlier answer,\n\
+including the answer that there is no such symbol."),
+			   NULL, show_symbol_lookup_cache_enabled,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end symbol lookup cache  */
+
   add_info ("variables", variables_info, _("\
 All global and static variable names, or those matching REGEXP."));
   if (dbx_commands)
@@ -5976,6 +7840,54 @@ All global and static variable names, or those matching REGEXP."));
 				  "<unknown type>", (struct objfile *) NULL);
 
   observer_attach_executable_changed (symtab_observer_executable_changed);
+
+  /* APPLE LOCAL demangled names cache  */
+  add_setshow_optional_filename_cmd ("demangled-names-cache-directory",
+				     class_obscure,
+				     &demangled_names_cache_directory, _("\
+Set the directory used to cache demangled symbol names."), _("\
+Show the directory used to cache demangled symbol names."), _("\
+When set, the symbol names read from an objfile and their demangled\n\
+forms are saved in this directory under the objfile's UUID, and are\n\
+read back instead of being demangled again when an objfile with the\n\
+same UUID is loaded.  An empty value disables the cache."),
+				     NULL,
+				     show_demangled_names_cache_directory,
+				     &maintenance_set_cmdlist,
+				     &maintenance_show_cmdlist);
+
+  /* APPLE LOCAL parallel symbol search  */
+  add_setshow_zinteger_cmd ("symbol-search-threads", class_obscure,
+			    &symbol_search_threads, _("\
+Set the number of threads used to match symbols against a regexp."), _("\
+Show the number of threads used to match symbols against a regexp."), _("\
+\"info functions\", \"info variables\", \"rbreak\" and the like match every\n\
+partial and minimal symbol name against the regexp they are given.\n\
+With a value above 1, that matching is split across this many threads\n\
+when there are enough symbols to make it worthwhile.  0 or 1 does all\n\
+of it on gdb's own thread."),
+			    NULL,
+			    show_symbol_search_threads,
+			    &maintenance_set_cmdlist,
+			    &maintenance_show_cmdlist);
+
+  /* APPLE LOCAL begin psymbol name filter  */
+  psymbol_name_filter_key
+    = register_objfile_data_with_cleanup (psymbol_name_filter_free);
+
+  add_setshow_boolean_cmd ("psymbol-name-filter", class_maintenance,
+			   &psymbol_name_filter_enabled, _("\
+Set whether psymtab searches skip objfiles that can't define the name."), _("\
+Show whether psymtab searches skip objfiles that can't define the name."), _("\
+When on, every objfile keeps a bitmap of the hashes of its partial symbol\n\
+names, and looking a name up in the partial symtabs doesn't search the\n\
+psymtabs of an objfile whose bitmap rules the name out.  Symbol lookups\n\
+also use an index of those hashes to search only the psymtabs that may\n\
+define the name."),
+			   NULL, show_psymbol_name_filter_enabled,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end psymbol name filter  */
 }
 
 /* APPLE LOCAL begin address ranges  */
@@ -143,7 +143,11 @@ struct general_symbol_info
   /* APPLE LOCAL fix-and-continue */
   /* Mark this symbol as obsolete if a newer version of this symbol has
      been loaded into the program.  */
-  int obsoleted;
+  /* APPLE LOCAL: A bitfield, so that it shares a word with LANGUAGE
+     and SECTION instead of taking a word (and its padding) of its own.
+     This is worth eight bytes in every symbol, partial symbol and
+     minimal symbol on a 64-bit host.  */
+  unsigned int obsoleted : 1;
 
   /* Which section is this symbol in?  This is an index into
      section_offsets for this objfile.  Negative means that the symbol
@@ -202,6 +206,22 @@ extern void symbol_set_names (struct general_symbol_info *symbol,
 			      const char *linkage_name, int len,
 			      struct objfile *objfile);
 
+/* APPLE LOCAL begin lazy minsym demangling  */
+#define SYMBOL_SET_LINKAGE_NAME(symbol,linkage_name,len,objfile) \
+  symbol_set_linkage_name (&(symbol)->ginfo, linkage_name, len, objfile)
+extern void symbol_set_linkage_name (struct general_symbol_info *symbol,
+				     const char *linkage_name, int len,
+				     struct objfile *objfile);
+/* APPLE LOCAL end lazy minsym demangling  */
+
+/* APPLE LOCAL begin shared names  */
+extern void objfile_use_shared_names (struct objfile *objfile);
+extern void objfile_release_shared_names (struct objfile *objfile);
+/* APPLE LOCAL end shared names  */
+
+/* APPLE LOCAL demangled names cache  */
+extern void save_demangled_names_cache (struct objfile *objfile);
+
 /* Now come lots of name accessor macros.  Short version as to when to
    use which: Use SYMBOL_NATURAL_NAME to refer to the name of the
    symbol in the original source code.  Use SYMBOL_LINKAGE_NAME if you
@@ -372,6 +392,16 @@ struct minimal_symbol
      the `next' pointer for the demangled hash table.  */
 
   struct minimal_symbol *demangled_hash_next;
+
+  /* APPLE LOCAL: msymbol_hash of the linkage name and msymbol_hash_iw
+     of the demangled name, worked out once by install_minimal_symbols
+     so that rebuilding the hash tables (after a relocation, say)
+     doesn't hash every name again.  DEMANGLED_HASH is only meaningful
+     if the symbol goes in the demangled table.  Neither is reduced
+     modulo the table size.  */
+
+  unsigned int hash;
+  unsigned int demangled_hash;
 };
 
 #define MSYMBOL_INFO(msymbol)		(msymbol)->info
@@ -801,6 +831,20 @@ struct section_offsets
 /* Each source file or header is represented by a struct symtab. 
    These objects are chained through the `next' field.  */
 
+/* APPLE LOCAL begin lazy macro tables  */
+/* A macro table a symbol reader hasn't read yet.  READ reads it,
+   given DATA, and returns it, or NULL if there turn out to be no
+   macros.  It is called at most once.  */
+
+struct lazy_macro_table
+{
+  struct macro_table *(*read) (void *data);
+  void *data;
+  int read_p;
+  struct macro_table *table;
+};
+/* APPLE LOCAL end lazy macro tables  */
+
 struct symtab
 {
 
@@ -835,6 +879,13 @@ struct symtab
      all the symtabs in a given compilation unit.  */
   struct macro_table *macro_table;
 
+  /* APPLE LOCAL begin lazy macro tables  */
+  /* If non-NULL, the reader put off reading this symtab's macro
+     table; use symtab_macro_table rather than MACRO_TABLE.  Shared
+     like MACRO_TABLE.  */
+  struct lazy_macro_table *lazy_macro_table;
+  /* APPLE LOCAL end lazy macro tables  */
+
   /* Name of this source file.  */
 
   char *filename;
@@ -895,6 +946,38 @@ struct symtab
 
   char *fullname;
 
+  /* APPLE LOCAL begin source fullname misses  */
+  /* The value of target_stop_generation when the source path was last
+     searched for this file without finding it, or zero.  */
+
+  unsigned int fullname_miss_generation;
+  /* APPLE LOCAL end source fullname misses  */
+
+  /* APPLE LOCAL begin inlined entry index  */
+  /* The inlined subroutine and call site entries of this symtab's
+     line table, indexed by inlining.c the first time it looks for the
+     ones containing a pc.  NULL until then.  */
+
+  struct inlined_entry_index *inlined_entry_index;
+  /* APPLE LOCAL end inlined entry index  */
+
+  /* APPLE LOCAL begin line table index  */
+  /* Lets find_pc_sect_line and find_line_common search this symtab's
+     line table by address and by line number without a linear scan.
+     Built by symtab.c the first time either is asked about this
+     symtab; NULL until then.  */
+
+  struct linetable_index *linetable_index;
+  /* APPLE LOCAL end line table index  */
+
+  /* APPLE LOCAL begin block pc index  */
+  /* Maps addresses to the innermost local block of this symtab's
+     blockvector that contains them, for blockvector_for_pc_sect.
+     Built by block.c the first time it is needed; NULL until then.  */
+
+  struct block_pc_index *block_pc_index;
+  /* APPLE LOCAL end block pc index  */
+
   /* Object file from which this symbol information was read.  */
 
   struct objfile *objfile;
@@ -1023,6 +1106,10 @@ struct partial_symtab
 
   char *fullname;
 
+  /* APPLE LOCAL source fullname misses: As for struct symtab.  */
+
+  unsigned int fullname_miss_generation;
+
   /* Directory in which it was compiled, or NULL if we don't know.  */
 
   char *dirname;
@@ -1175,6 +1262,12 @@ extern int asm_demangle;
 
 extern struct symtab *lookup_symtab (const char *);
 
+/* APPLE LOCAL begin lazy macro tables  */
+/* Return S's macro table, reading it in first if that was put off.  */
+
+extern struct macro_table *symtab_macro_table (struct symtab *s);
+/* APPLE LOCAL end lazy macro tables  */
+
 /* APPLE LOCAL: lookup a symbol table by source file name,
    returning all matches.  */
 extern struct symtab **lookup_symtab_all (const char *);
@@ -1404,6 +1497,9 @@ extern struct cleanup *make_cleanup_discard_minimal_symbols (void);
 
 extern void install_minimal_symbols (struct objfile *);
 
+/* APPLE LOCAL lazy minsym demangling  */
+extern void minimal_symbols_demangle (struct objfile *);
+
 /* Sort all the minimal symbols in OBJFILE.  */
 
 extern void msymbols_sort (struct objfile *objfile);
@@ -47,6 +47,10 @@
 #include "gdbarch.h"
 #include "exceptions.h"
 #include "exec.h"
+/* APPLE LOCAL breakpoint always-inserted  */
+#include "breakpoint.h"
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
 
 static void target_info (char *, int);
 
@@ -245,6 +249,16 @@ static void setup_target_debug (void);
 
 DCACHE *target_dcache;
 
+/* APPLE LOCAL begin memory snapshot  */
+/* While non-zero, memory that isn't explicitly uncached is read
+   through target_dcache as well; see target_begin_memory_snapshot.  */
+
+static int memory_snapshot_depth;
+/* APPLE LOCAL end memory snapshot  */
+
+/* APPLE LOCAL stop generation  */
+unsigned int target_stop_generation = 1;
+
 /* Non-zero if we are overriding the target's async behavior as far as
    user commands go... */
 int gdb_override_async = 0;
@@ -300,6 +314,38 @@ target_ignore (void)
 {
 }
 
+/* APPLE LOCAL begin memory snapshot  */
+void
+target_begin_memory_snapshot (void)
+{
+  if (memory_snapshot_depth++ == 0)
+    dcache_invalidate (target_dcache);
+}
+
+void
+target_end_memory_snapshot (void)
+{
+  gdb_assert (memory_snapshot_depth > 0);
+  /* Lines from regions that aren't normally cached mustn't outlive
+     the snapshot.  */
+  if (--memory_snapshot_depth == 0)
+    dcache_invalidate (target_dcache);
+}
+
+static void
+do_end_memory_snapshot (void *unused)
+{
+  target_end_memory_snapshot ();
+}
+
+struct cleanup *
+make_cleanup_memory_snapshot (void)
+{
+  target_begin_memory_snapshot ();
+  return make_cleanup (do_end_memory_snapshot, NULL);
+}
+/* APPLE LOCAL end memory snapshot  */
+
 void
 target_load (char *arg, int from_tty)
 {
@@ -528,6 +574,15 @@ update_current_target (void)
       INHERIT (to_save_thread_inferior_status, t);
       INHERIT (to_restore_thread_inferior_status, t);
       INHERIT (to_free_thread_inferior_status, t);
+      /* APPLE LOCAL map target memory  */
+      INHERIT (to_map_memory, t);
+      INHERIT (to_unmap_memory, t);
+      /* APPLE LOCAL memory ranges  */
+      INHERIT (to_read_memory_ranges, t);
+      /* APPLE LOCAL verify target memory  */
+      INHERIT (to_verify_memory, t);
+      /* APPLE LOCAL memory search  */
+      INHERIT (to_search_memory, t);
       
       INHERIT (to_magic, t);
     }
@@ -745,6 +800,18 @@ update_current_target (void)
   de_fault (to_save_thread_inferior_status, (void *(*)()) return_zero);
   de_fault (to_restore_thread_inferior_status, (void (*)(void *)) target_ignore);
   de_fault (to_free_thread_inferior_status, (void (*)(void *)) target_ignore);
+  /* APPLE LOCAL map target memory  */
+  de_fault (to_map_memory,
+	    (const gdb_byte * (*) (CORE_ADDR, ULONGEST, void **)) return_zero);
+  de_fault (to_unmap_memory, (void (*)(void *)) target_ignore);
+  /* APPLE LOCAL memory ranges: Leaving this NULL makes
+     target_read_memory_ranges read each range on its own.  */
+  /* APPLE LOCAL verify target memory  */
+  de_fault (to_verify_memory,
+	    (int (*) (const gdb_byte *, CORE_ADDR, ULONGEST))
+	    return_minus_one);
+  /* APPLE LOCAL memory search  */
+  de_fault (to_search_memory, simple_search_memory);
 
   /* APPLE LOCAL end target */
 #undef de_fault
@@ -892,61 +959,72 @@ pop_target (void)
    is responsible for freeing it.  Return the number of bytes successfully
    read.  */
 
+/* APPLE LOCAL begin chunked string reads  */
+/* The first and largest reads target_read_string makes.  Each read
+   ends on a boundary of its own size, and each is twice as big as the
+   last, so short strings cost one small read and no read crosses a
+   page.  */
+#define TARGET_STRING_MIN_CHUNK 64
+#define TARGET_STRING_MAX_CHUNK 4096
+/* APPLE LOCAL end chunked string reads  */
+
 int
 target_read_string (CORE_ADDR memaddr, char **string, int len, int *errnop)
 {
-  int tlen, origlen, offset, i;
-  gdb_byte buf[4];
+  int tlen;
   int errcode = 0;
   char *buffer;
   int buffer_allocated;
   char *bufptr;
   unsigned int nbytes_read = 0;
+  /* APPLE LOCAL chunked string reads  */
+  int chunk = TARGET_STRING_MIN_CHUNK;
 
-  /* Small for testing.  */
-  buffer_allocated = 4;
+  buffer_allocated = TARGET_STRING_MIN_CHUNK;
   buffer = xmalloc (buffer_allocated);
   bufptr = buffer;
 
-  origlen = len;
-
   while (len > 0)
     {
-      tlen = MIN (len, 4 - (memaddr & 3));
-      offset = memaddr & 3;
+      char *nul;
 
-      errcode = target_read_memory (memaddr & ~3, buf, sizeof buf);
-      if (errcode != 0)
-	{
-	  /* The transfer request might have crossed the boundary to an
-	     unallocated region of memory. Retry the transfer, requesting
-	     a single byte.  */
-	  tlen = 1;
-	  offset = 0;
-	  errcode = target_read_memory (memaddr, buf, 1);
-	  if (errcode != 0)
-	    goto done;
-	}
+      /* APPLE LOCAL begin chunked string reads  */
+      tlen = MIN (len, chunk - (memaddr & (chunk - 1)));
+      if (chunk < TARGET_STRING_MAX_CHUNK)
+	chunk *= 2;
 
       if (bufptr - buffer + tlen > buffer_allocated)
 	{
 	  unsigned int bytes;
 	  bytes = bufptr - buffer;
-	  buffer_allocated *= 2;
+	  while (bytes + tlen > buffer_allocated)
+	    buffer_allocated *= 2;
 	  buffer = xrealloc (buffer, buffer_allocated);
 	  bufptr = buffer + bytes;
 	}
 
-      for (i = 0; i < tlen; i++)
+      errcode = target_read_memory (memaddr, (gdb_byte *) bufptr, tlen);
+      if (errcode != 0)
 	{
-	  *bufptr++ = buf[i + offset];
-	  if (buf[i + offset] == '\000')
-	    {
-	      nbytes_read += i + 1;
-	      goto done;
-	    }
+	  /* The transfer request might have crossed the boundary to an
+	     unallocated region of memory. Retry the transfer, requesting
+	     a single byte, and go on a byte at a time from there.  */
+	  tlen = 1;
+	  chunk = 1;
+	  errcode = target_read_memory (memaddr, (gdb_byte *) bufptr, 1);
+	  if (errcode != 0)
+	    goto done;
 	}
 
+      nul = memchr (bufptr, 0, tlen);
+      if (nul != NULL)
+	{
+	  nbytes_read += nul - bufptr + 1;
+	  goto done;
+	}
+      bufptr += tlen;
+      /* APPLE LOCAL end chunked string reads  */
+
       memaddr += tlen;
       len -= tlen;
       nbytes_read += tlen;
@@ -1040,7 +1118,11 @@ memory_xfer_partial (struct target_ops *ops, void *readbuf,
     }
 
   /* APPLE LOCAL: We use -1 to mean "caching temporarily disabled.  */
-  if (region->attrib.cache == 1 && !only_read_from_live_memory)
+  /* APPLE LOCAL memory snapshot: inside a snapshot, regions without
+     an explicit cache attribute are cached too.  */
+  if ((region->attrib.cache == 1
+       || (region->attrib.cache == 0 && memory_snapshot_depth > 0))
+      && !only_read_from_live_memory)
     {
       /* FIXME drow/2006-08-09: This call discards OPS, so the raw
 	 memory request will start back at current_target.  */
@@ -1094,13 +1176,45 @@ target_xfer_partial (struct target_ops *ops,
 {
   LONGEST retval;
 
+  /* APPLE LOCAL gdb stats  */
+  struct gdb_stat_timer xfer_timer;
+
   gdb_assert (ops->to_xfer_partial != NULL);
 
+  /* APPLE LOCAL gdb stats: Only the outermost call, not the layers it
+     passes the request down through, is charged bytes.  */
+  gdb_stat_start (GDB_STAT_TARGET_XFER, &xfer_timer);
+
+  /* APPLE LOCAL breakpoint always-inserted: Don't write over a
+     breakpoint we left inserted, or have its removal undo the write.  */
+  if (object == TARGET_OBJECT_MEMORY && writebuf != NULL)
+    remove_breakpoints_overlapping (offset, len);
+
+  /* APPLE LOCAL stop generation  */
+  if (writebuf != NULL
+      && (object == TARGET_OBJECT_MEMORY
+	  || object == TARGET_OBJECT_RAW_MEMORY))
+    target_bump_stop_generation ();
+
   /* If this is a memory transfer, let the memory-specific code
      have a look at it instead.  Memory transfers are more
      complicated.  */
   if (object == TARGET_OBJECT_MEMORY)
-    retval = memory_xfer_partial (ops, readbuf, writebuf, offset, len);
+    {
+      /* APPLE LOCAL begin gdb stats  */
+      struct gdb_stat_timer timer;
+
+      if (readbuf != NULL)
+	gdb_stat_start (GDB_STAT_MEMORY_READ, &timer);
+      retval = memory_xfer_partial (ops, readbuf, writebuf, offset, len);
+      if (readbuf != NULL)
+	gdb_stat_stop (GDB_STAT_MEMORY_READ, &timer,
+		       retval > 0 ? retval : 0);
+      /* APPLE LOCAL end gdb stats  */
+      /* APPLE LOCAL breakpoint always-inserted  */
+      if (readbuf != NULL && retval > 0)
+	breakpoint_restore_shadows (readbuf, offset, retval);
+    }
   else
     {
       enum target_object raw_object = object;
@@ -1114,6 +1228,10 @@ target_xfer_partial (struct target_ops *ops,
 				     writebuf, offset, len);
     }
 
+  /* APPLE LOCAL gdb stats  */
+  gdb_stat_stop (GDB_STAT_TARGET_XFER, &xfer_timer,
+		 xfer_timer.outermost && retval > 0 ? retval : 0);
+
   if (debug_target_writes && writebuf)
     {
       fprintf_filtered (gdb_stdlog, "%s:target_xfer_partial write to addr 0x%s %d bytes: ",
@@ -1192,6 +1310,112 @@ target_read_memory (CORE_ADDR memaddr, gdb_byte *myaddr, int len)
     return EIO;
 }
 
+/* APPLE LOCAL begin memory ranges  */
+/* Return nonzero if a read of LEN bytes at MEMADDR would reach the
+   target's own to_xfer_partial, so that the target's vectored read
+   can stand in for it.  Reads memory_xfer_partial would satisfy from
+   the executable, the data cache or a region with special attributes
+   go through target_read_memory instead.  */
+
+static int
+memory_range_direct_p (CORE_ADDR memaddr, int len)
+{
+  struct mem_region *region;
+
+  if (len <= 0)
+    return 0;
+
+  if (trust_readonly)
+    {
+      struct obj_section *osect;
+
+      osect = find_pc_sect_in_ordered_sections (memaddr, NULL);
+      if (osect != NULL
+	  && (bfd_get_section_flags (osect->the_bfd_section->owner,
+				     osect->the_bfd_section)
+	      & SEC_READONLY))
+	return 0;
+    }
+
+  region = lookup_mem_region (memaddr);
+  if (region->hi != 0 && memaddr + len > region->hi)
+    return 0;
+  if (region->attrib.mode != MEM_RW && region->attrib.mode != MEM_RO)
+    return 0;
+  if ((region->attrib.cache == 1
+       || (region->attrib.cache == 0 && memory_snapshot_depth > 0))
+      && !only_read_from_live_memory)
+    return 0;
+
+  return 1;
+}
+
+int
+target_read_memory_ranges (struct target_memory_range *ranges, int nranges)
+{
+  int i, nfailed = 0;
+
+  for (i = 0; i < nranges; i++)
+    ranges[i].status = -1;
+
+  if (current_target.to_read_memory_ranges != NULL && nranges > 1)
+    {
+      struct target_memory_range *direct;
+      struct gdb_stat_timer timer;
+      struct cleanup *old_chain;
+      LONGEST bytes = 0;
+      int *index;
+      int ndirect = 0;
+
+      direct = xmalloc (nranges * sizeof (struct target_memory_range));
+      old_chain = make_cleanup (xfree, direct);
+      index = xmalloc (nranges * sizeof (int));
+      make_cleanup (xfree, index);
+
+      for (i = 0; i < nranges; i++)
+	if (memory_range_direct_p (ranges[i].addr, ranges[i].len))
+	  {
+	    direct[ndirect] = ranges[i];
+	    index[ndirect] = i;
+	    ndirect++;
+	  }
+
+      if (ndirect > 0)
+	{
+	  gdb_stat_start (GDB_STAT_MEMORY_READ, &timer);
+	  current_target.to_read_memory_ranges (direct, ndirect);
+	  for (i = 0; i < ndirect; i++)
+	    if (direct[i].status == 0)
+	      {
+		struct target_memory_range *r = &ranges[index[i]];
+
+		r->status = 0;
+		breakpoint_restore_shadows (r->buf, r->addr, r->len);
+		bytes += r->len;
+	      }
+	  gdb_stat_stop (GDB_STAT_MEMORY_READ, &timer, bytes);
+	}
+
+      do_cleanups (old_chain);
+    }
+
+  for (i = 0; i < nranges; i++)
+    {
+      if (ranges[i].status == 0)
+	continue;
+      if (ranges[i].len == 0)
+	ranges[i].status = 0;
+      else
+	ranges[i].status = target_read_memory (ranges[i].addr, ranges[i].buf,
+					       ranges[i].len);
+      if (ranges[i].status != 0)
+	nfailed++;
+    }
+
+  return nfailed;
+}
+/* APPLE LOCAL end memory ranges  */
+
 int
 target_write_memory (CORE_ADDR memaddr, const gdb_byte *myaddr, int len)
 {
@@ -1369,12 +1593,139 @@ target_write_with_progress (struct target_ops *ops,
       if (xfer <= 0)
 	/* Call memory_error?  */
 	return -1;
+      /* APPLE LOCAL: Tell the caller how far we've got.  */
+      if (progress)
+	(*progress) (xfer, baton);
       xfered += xfer;
       QUIT;
     }
   return len;
 }
 
+/* APPLE LOCAL begin memory search  */
+/* How much target memory simple_search_memory reads at once.  */
+#define SEARCH_CHUNK_SIZE 16000
+
+/* Return the first place in the LEN bytes at BUF where the PATTERN_LEN
+   bytes at PATTERN start, or NULL.  memchr finds the candidates, so
+   the scan runs at whatever speed the C library manages for it.  */
+
+static const gdb_byte *
+search_buffer (const gdb_byte *buf, ULONGEST len,
+	       const gdb_byte *pattern, ULONGEST pattern_len)
+{
+  const gdb_byte *p = buf;
+  const gdb_byte *last;
+
+  if (len < pattern_len)
+    return NULL;
+
+  last = buf + len - pattern_len;
+  while (p <= last)
+    {
+      p = memchr (p, pattern[0], last - p + 1);
+      if (p == NULL)
+	return NULL;
+      if (memcmp (p + 1, pattern + 1, pattern_len - 1) == 0)
+	return p;
+      p++;
+    }
+  return NULL;
+}
+
+int
+simple_search_memory (CORE_ADDR start_addr, ULONGEST search_space_len,
+		      const gdb_byte *pattern, ULONGEST pattern_len,
+		      CORE_ADDR *found_addrp)
+{
+  const gdb_byte *mapped;
+  const gdb_byte *found_ptr;
+  void *handle;
+  gdb_byte *search_buf;
+  ULONGEST search_buf_size;
+  struct cleanup *old_cleanups;
+
+  gdb_assert (pattern_len > 0);
+
+  /* If the target will let us see the whole range in place, look at
+     it there rather than copying it.  */
+  mapped = target_map_memory (start_addr, search_space_len, &handle);
+  if (mapped != NULL)
+    {
+      found_ptr = search_buffer (mapped, search_space_len,
+				 pattern, pattern_len);
+      if (found_ptr != NULL)
+	*found_addrp = start_addr + (found_ptr - mapped);
+      target_unmap_memory (handle);
+      return found_ptr != NULL;
+    }
+
+  /* Otherwise read a chunk at a time, keeping the last PATTERN_LEN - 1
+     bytes of each chunk at the start of the buffer so that a match
+     straddling two chunks is still found.  */
+  search_buf_size = SEARCH_CHUNK_SIZE + pattern_len - 1;
+  if (search_space_len < search_buf_size)
+    search_buf_size = search_space_len;
+
+  search_buf = xmalloc (search_buf_size);
+  old_cleanups = make_cleanup (xfree, search_buf);
+
+  if (target_read_memory (start_addr, search_buf, search_buf_size) != 0)
+    {
+      warning (_("Unable to access target memory at 0x%s, halting search."),
+	       paddr_nz (start_addr));
+      do_cleanups (old_cleanups);
+      return -1;
+    }
+
+  while (search_space_len >= pattern_len)
+    {
+      ULONGEST nr_search_bytes = min (search_space_len, search_buf_size);
+
+      found_ptr = search_buffer (search_buf, nr_search_bytes,
+				 pattern, pattern_len);
+      if (found_ptr != NULL)
+	{
+	  *found_addrp = start_addr + (found_ptr - search_buf);
+	  do_cleanups (old_cleanups);
+	  return 1;
+	}
+
+      if (search_space_len > SEARCH_CHUNK_SIZE)
+	search_space_len -= SEARCH_CHUNK_SIZE;
+      else
+	search_space_len = 0;
+
+      if (search_space_len >= pattern_len)
+	{
+	  ULONGEST keep_len = search_buf_size - SEARCH_CHUNK_SIZE;
+	  CORE_ADDR read_addr = start_addr + SEARCH_CHUNK_SIZE + keep_len;
+	  ULONGEST nr_to_read;
+
+	  gdb_assert (keep_len == pattern_len - 1);
+	  memmove (search_buf, search_buf + SEARCH_CHUNK_SIZE, keep_len);
+
+	  nr_to_read = min (search_space_len - keep_len, SEARCH_CHUNK_SIZE);
+	  if (target_read_memory (read_addr, search_buf + keep_len,
+				  nr_to_read) != 0)
+	    {
+	      warning (_("\
+Unable to access target memory at 0x%s, halting search."),
+		       paddr_nz (read_addr));
+	      do_cleanups (old_cleanups);
+	      return -1;
+	    }
+
+	  start_addr += SEARCH_CHUNK_SIZE;
+	  QUIT;
+	}
+    }
+
+  do_cleanups (old_cleanups);
+  return 0;
+}
+/* APPLE LOCAL end memory search  */
+
 /* Memory transfer methods.  */
 
 void
@@ -1468,12 +1819,19 @@ target_detach (char *args, int from_tty)
   /* Make sure to turn off debugger mode - 
      we will let the target run a bit before killing it.  */
   do_hand_call_cleanups (ALL_CLEANUPS);
+  /* APPLE LOCAL breakpoint always-inserted: Don't leave traps behind
+     in a process we're letting go of.  */
+  if (breakpoints_always_inserted_mode () && target_has_execution)
+    remove_breakpoints ();
   (current_target.to_detach) (args, from_tty);
 }
 
 void
 target_disconnect (char *args, int from_tty)
 {
+  /* APPLE LOCAL breakpoint always-inserted  */
+  if (breakpoints_always_inserted_mode () && target_has_execution)
+    remove_breakpoints ();
   (current_target.to_disconnect) (args, from_tty);
 }
 
@@ -304,6 +304,8 @@ extern int target_activity_fd;
 extern int (*target_activity_function) (void);
 
 struct thread_info;		/* fwd decl for parameter list below: */
+/* APPLE LOCAL memory ranges  */
+struct target_memory_range;
 
 struct target_ops
   {
@@ -504,6 +506,40 @@ struct target_ops
     void (*to_restore_thread_inferior_status) (void *);
     void (*to_free_thread_inferior_status) (void *);
 
+    /* APPLE LOCAL: Map the LEN bytes of target memory at ADDR read-only
+       into gdb's address space, without copying them.  Returns a
+       pointer to the data and sets *HANDLE to pass to
+       to_unmap_memory when done, or returns NULL if the target can't
+       do that for this range; the caller should then fall back on
+       target_read_memory.  */
+    const gdb_byte *(*to_map_memory) (CORE_ADDR addr, ULONGEST len,
+				      void **handle);
+    void (*to_unmap_memory) (void *handle);
+
+    /* APPLE LOCAL: Read the NRANGES RANGES of target memory in one
+       go, setting the STATUS of each range read in full to zero.
+       Ranges left with a nonzero STATUS are read again one at a time
+       by target_read_memory_ranges, so a target need only handle the
+       cases it can do cheaply.  */
+    void (*to_read_memory_ranges) (struct target_memory_range *ranges,
+				   int nranges);
+
+    /* APPLE LOCAL: Compare the SIZE bytes at MEMADDR in the target
+       with the SIZE bytes at DATA, without reading them back.
+       Returns 1 if they match, 0 if they don't, and -1 if the target
+       can't tell cheaply.  */
+    int (*to_verify_memory) (const gdb_byte *data, CORE_ADDR memaddr,
+			     ULONGEST size);
+
+    /* APPLE LOCAL: Search the SEARCH_SPACE_LEN bytes of target memory
+       at START_ADDR for the PATTERN_LEN bytes at PATTERN.  If they are
+       found, store the address of the first match in *FOUND_ADDRP and
+       return 1.  Return 0 if they aren't, and -1 if the search
+       couldn't be done.  */
+    int (*to_search_memory) (CORE_ADDR start_addr, ULONGEST search_space_len,
+			     const gdb_byte *pattern, ULONGEST pattern_len,
+			     CORE_ADDR *found_addrp);
+
     int to_magic;
     /* Need sub-structure for target machine related rather than comm related?
      */
@@ -627,10 +663,69 @@ extern void target_disconnect (char *, int);
 
 extern DCACHE *target_dcache;
 
+/* APPLE LOCAL begin memory snapshot  */
+/* Between these calls, reads of target memory are served from
+   target_dcache even in regions that aren't normally cached, so a
+   group of commands run against one stop reads each line of memory
+   only once.  Calls nest.  Resuming the target still flushes the
+   cache, and it is flushed again when the outermost snapshot ends.  */
+
+extern void target_begin_memory_snapshot (void);
+extern void target_end_memory_snapshot (void);
+
+/* Begin a memory snapshot and return a cleanup that ends it.  */
+
+extern struct cleanup *make_cleanup_memory_snapshot (void);
+/* APPLE LOCAL end memory snapshot  */
+
+/* APPLE LOCAL begin stop generation  */
+/* Changes whenever anything a frame's variables are read from may
+   have changed: the frame cache is flushed (the inferior ran, a
+   variable was assigned, a thread was switched to), registers were
+   invalidated or written, or target memory was written.  Caches of
+   values read through frames are tagged with it.  */
+
+extern unsigned int target_stop_generation;
+
+#define target_bump_stop_generation() (target_stop_generation++)
+/* APPLE LOCAL end stop generation  */
+
 extern int target_read_string (CORE_ADDR, char **, int, int *);
 
 extern int target_read_memory (CORE_ADDR memaddr, gdb_byte *myaddr, int len);
 
+/* APPLE LOCAL begin memory ranges  */
+/* One piece of a vectored memory read: LEN bytes at ADDR, to be
+   stored in BUF.  STATUS is set to zero if they were all read, or to
+   the errno value target_read_memory would have returned.  */
+
+struct target_memory_range
+{
+  CORE_ADDR addr;
+  int len;
+  gdb_byte *buf;
+  int status;
+};
+
+/* Read each of the NRANGES RANGES, as target_read_memory would, but
+   let the target do as many of them as it can in one request.
+   Returns the number of ranges that could not be read.  */
+
+extern int target_read_memory_ranges (struct target_memory_range *ranges,
+				      int nranges);
+/* APPLE LOCAL end memory ranges  */
+
+/* APPLE LOCAL begin memory search  */
+/* Do what to_search_memory says by reading target memory a chunk at
+   a time and searching it here.  This is the default for targets
+   that can't search inside the inferior.  */
+
+extern int simple_search_memory (CORE_ADDR start_addr,
+				 ULONGEST search_space_len,
+				 const gdb_byte *pattern, ULONGEST pattern_len,
+				 CORE_ADDR *found_addrp);
+/* APPLE LOCAL end memory search  */
+
 extern int target_write_memory (CORE_ADDR memaddr, const gdb_byte *myaddr,
 				int len);
 
@@ -1162,6 +1257,25 @@ extern void (*deprecated_target_new_objfile_hook) (struct objfile *);
 #define target_free_thread_inferior_status(VOID_PTR) \
     (current_target.to_free_thread_inferior_status) (VOID_PTR)
 
+/*
+ * APPLE LOCAL: Map target memory without copying it.  target_unmap_memory
+ * takes a single void * so it can be used directly as a cleanup.
+ */
+
+#define target_map_memory(ADDR,LEN,HANDLE) \
+    (current_target.to_map_memory) (ADDR, LEN, HANDLE)
+
+#define target_unmap_memory \
+    (current_target.to_unmap_memory)
+
+/* APPLE LOCAL verify target memory  */
+#define target_verify_memory(DATA,MEMADDR,SIZE) \
+    (current_target.to_verify_memory) (DATA, MEMADDR, SIZE)
+
+/* APPLE LOCAL memory search  */
+#define target_search_memory(START,LEN,PATTERN,PATTERN_LEN,FOUND) \
+    (current_target.to_search_memory) (START, LEN, PATTERN, PATTERN_LEN, FOUND)
+
 /* Thread-local values.  */
 #define target_get_thread_local_address \
     (current_target.to_get_thread_local_address)
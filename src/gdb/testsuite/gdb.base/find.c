@@ -0,0 +1,57 @@
+/* Copyright 2026.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
+
+/* Test file for the "find" command.  */
+
+#include <string.h>
+
+/* Larger than the chunk size gdb searches in, so that a pattern can
+   straddle two chunks.  */
+#define CHUNK_SIZE 16000
+#define BIG_BUF_SIZE (CHUNK_SIZE * 4)
+
+static void
+stop_here (void)
+{
+}
+
+char int8_search_buf[100];
+short int16_search_buf[100];
+int int32_search_buf[100];
+long long int64_search_buf[100];
+
+unsigned char search_buf[BIG_BUF_SIZE];
+
+int
+main (void)
+{
+  memset (int8_search_buf, 0, sizeof (int8_search_buf));
+  int8_search_buf[10] = 'h';
+  int8_search_buf[11] = 'i';
+  int8_search_buf[40] = 'h';
+  int8_search_buf[41] = 'i';
+
+  int16_search_buf[10] = 0x1234;
+  int32_search_buf[10] = 0x12345678;
+  int64_search_buf[10] = 0xfedcba9876543210LL;
+
+  /* Put the pattern across the boundary of the first two chunks.  */
+  memset (search_buf, 0, sizeof (search_buf));
+  memcpy (&search_buf[CHUNK_SIZE - 1], "search", 6);
+
+  stop_here ();
+  return 0;
+}
@@ -0,0 +1,83 @@
+/* APPLE LOCAL begin performance tests. This entire file is APPLE LOCAL  */
+/* Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
+
+/* Start NTHREADS threads that each recurse DEPTH frames deep and then
+   wait, so that gdb has NTHREADS deep stacks to walk.  */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifndef NTHREADS
+#define NTHREADS 16
+#endif
+
+#ifndef DEPTH
+#define DEPTH 100
+#endif
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static int ready;
+
+void
+all_threads_ready (void)
+{
+}
+
+int
+recurse (int depth, int arg)
+{
+  if (depth > 0)
+    return recurse (depth - 1, arg + 1) + 1;
+
+  pthread_mutex_lock (&mutex);
+  ready++;
+  pthread_cond_broadcast (&cond);
+  pthread_mutex_unlock (&mutex);
+
+  /* Park here for as long as the test needs.  */
+  for (;;)
+    sleep (1);
+  return arg;
+}
+
+static void *
+thread_function (void *arg)
+{
+  recurse (DEPTH, (int) (long) arg);
+  return NULL;
+}
+
+int
+main (int argc, char **argv)
+{
+  pthread_t threads[NTHREADS];
+  int i;
+
+  for (i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[i], NULL, thread_function, (void *) (long) i);
+
+  pthread_mutex_lock (&mutex);
+  while (ready < NTHREADS)
+    pthread_cond_wait (&cond, &mutex);
+  pthread_mutex_unlock (&mutex);
+
+  all_threads_ready ();
+  return 0;
+}
+/* APPLE LOCAL end performance tests  */
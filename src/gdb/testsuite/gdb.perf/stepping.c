@@ -0,0 +1,55 @@
+/* APPLE LOCAL begin performance tests. This entire file is APPLE LOCAL  */
+/* Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
+
+/* A loop to "next" over, calling a function with a deep inline-free
+   call tree so that each step has a little work to look at.  */
+
+#include <unistd.h>
+
+volatile int counter;
+
+int
+leaf (int x)
+{
+  return x * 2 + 1;
+}
+
+int
+middle (int x)
+{
+  return leaf (x) + leaf (x + 1);
+}
+
+int
+main (int argc, char **argv)
+{
+  int i;
+
+  for (i = 0; i < 1000000; i++)
+    {
+      counter += middle (i);	/* loop body */
+      counter -= i;
+    }
+
+  /* For attach.exp: wait to be attached to.  */
+  if (argc > 1)
+    for (;;)
+      sleep (1);
+
+  return 0;
+}
+/* APPLE LOCAL end performance tests  */
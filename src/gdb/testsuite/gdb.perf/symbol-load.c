@@ -0,0 +1,27 @@
+/* APPLE LOCAL begin performance tests. This entire file is APPLE LOCAL  */
+/* Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
+
+/* The bulk of this program is written by perftest_gen_c_sources.  */
+
+extern int perftest_entry (int x);
+
+int
+main (int argc, char **argv)
+{
+  return perftest_entry (argc) == 0;
+}
+/* APPLE LOCAL end performance tests  */
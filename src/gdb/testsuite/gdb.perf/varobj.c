@@ -0,0 +1,54 @@
+/* APPLE LOCAL begin performance tests. This entire file is APPLE LOCAL  */
+/* Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
+
+/* An array of structs to make many variable objects of, changing a
+   few of its elements on each iteration of a loop.  */
+
+#ifndef NELEMS
+#define NELEMS 1000
+#endif
+
+struct element
+{
+  int id;
+  double value;
+  struct element *next;
+  char name[8];
+};
+
+struct element elements[NELEMS];
+
+int
+main (int argc, char **argv)
+{
+  int i, j;
+
+  for (i = 0; i < NELEMS; i++)
+    {
+      elements[i].id = i;
+      elements[i].next = &elements[(i + 1) % NELEMS];
+    }
+
+  for (j = 0; j < 1000; j++)
+    {
+      elements[j % NELEMS].value += 1.0;	/* update here */
+      elements[(j * 7) % NELEMS].id++;
+    }
+
+  return 0;
+}
+/* APPLE LOCAL end performance tests  */
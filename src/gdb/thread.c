@@ -37,6 +37,8 @@
 #include "gdb.h"
 #include "gdb_string.h"
 #include "wrapper.h"
+/* APPLE LOCAL thread-info  */
+#include "source.h"
 
 #include <ctype.h>
 #include <sys/types.h>
@@ -61,6 +63,43 @@ void _initialize_thread (void);
 
 struct thread_info *thread_list = NULL;
 int highest_thread_num;
+/* APPLE LOCAL thread hash  */
+unsigned int thread_list_generation;
+
+/* APPLE LOCAL begin thread hash  */
+/* The threads hashed by ptid, so that find_thread_pid doesn't have to
+   walk the whole list.  Targets like Mac OS X look up every thread at
+   every stop, which made stopping a program with hundreds of threads
+   quadratic.  */
+
+#define THREAD_HASH_SIZE 256
+
+static struct thread_info *thread_hash[THREAD_HASH_SIZE];
+
+static struct thread_info **
+thread_hash_bucket (ptid_t ptid)
+{
+  unsigned long hash;
+
+  hash = (unsigned long) ptid_get_pid (ptid);
+  hash = hash * 31 + (unsigned long) ptid_get_lwp (ptid);
+  hash = hash * 31 + (unsigned long) ptid_get_tid (ptid);
+  hash ^= hash >> 8;
+  return &thread_hash[hash % THREAD_HASH_SIZE];
+}
+
+static void
+thread_hash_remove (struct thread_info *tp)
+{
+  if (tp->hash_pprev == NULL)
+    return;
+  *tp->hash_pprev = tp->hash_next;
+  if (tp->hash_next != NULL)
+    tp->hash_next->hash_pprev = tp->hash_pprev;
+  tp->hash_next = NULL;
+  tp->hash_pprev = NULL;
+}
+/* APPLE LOCAL end thread hash  */
 
 static void thread_command (char *tidstr, int from_tty);
 static void thread_apply_all_command (char *, int);
@@ -111,6 +150,8 @@ init_thread_list (void)
   struct thread_info *tp, *tpnext;
 
   highest_thread_num = 0;
+  /* APPLE LOCAL thread hash  */
+  thread_list_generation++;
   if (!thread_list)
     return;
 
@@ -121,6 +162,8 @@ init_thread_list (void)
     }
 
   thread_list = NULL;
+  /* APPLE LOCAL thread hash  */
+  memset (thread_hash, 0, sizeof (thread_hash));
 }
 
 /* add_thread now returns a pointer to the new thread_info, 
@@ -137,30 +180,47 @@ add_thread (ptid_t ptid)
   tp->num = ++highest_thread_num; 
   tp->next = thread_list; 
   thread_list = tp; 
+  /* APPLE LOCAL begin thread hash  */
+  tp->pprev = &thread_list;
+  if (tp->next != NULL)
+    tp->next->pprev = &tp->next;
+  {
+    struct thread_info **bucket = thread_hash_bucket (ptid);
+
+    tp->hash_next = *bucket;
+    if (*bucket != NULL)
+      (*bucket)->hash_pprev = &tp->hash_next;
+    tp->hash_pprev = bucket;
+    *bucket = tp;
+  }
+  /* APPLE LOCAL end thread hash  */
   return tp; 
 }
 
-void
-delete_thread (ptid_t ptid)
+/* APPLE LOCAL begin thread hash  */
+static void
+delete_thread_1 (struct thread_info *tp)
 {
-  struct thread_info *tp, *tpprev;
+  *tp->pprev = tp->next;
+  if (tp->next != NULL)
+    tp->next->pprev = tp->pprev;
 
-  tpprev = NULL;
+  thread_hash_remove (tp);
+  free_thread (tp);
+}
 
-  for (tp = thread_list; tp; tpprev = tp, tp = tp->next)
-    if (ptid_equal (tp->ptid, ptid))
-      break;
+void
+delete_thread (ptid_t ptid)
+{
+  struct thread_info *tp;
 
+  tp = find_thread_pid (ptid);
   if (!tp)
     return;
 
-  if (tpprev)
-    tpprev->next = tp->next;
-  else
-    thread_list = tp->next;
-
-  free_thread (tp);
+  delete_thread_1 (tp);
 }
+/* APPLE LOCAL end thread hash  */
 
 struct thread_info *
 find_thread_id (int num)
@@ -180,10 +240,19 @@ find_thread_pid (ptid_t ptid)
 {
   struct thread_info *tp;
 
-  for (tp = thread_list; tp; tp = tp->next)
+  /* APPLE LOCAL begin thread hash  */
+  for (tp = *thread_hash_bucket (ptid); tp; tp = tp->hash_next)
     if (ptid_equal (tp->ptid, ptid))
       return tp;
 
+  /* Dead threads get their ptid overwritten in place, so they are
+     still filed under their old one.  */
+  if (ptid_get_pid (ptid) == -1)
+    for (tp = thread_list; tp; tp = tp->next)
+      if (ptid_equal (tp->ptid, ptid))
+	return tp;
+  /* APPLE LOCAL end thread hash  */
+
   return NULL;
 }
 
@@ -231,9 +300,10 @@ pid_to_thread_id (ptid_t ptid)
 {
   struct thread_info *tp;
 
-  for (tp = thread_list; tp; tp = tp->next)
-    if (ptid_equal (tp->ptid, ptid))
-      return tp->num;
+  /* APPLE LOCAL thread hash  */
+  tp = find_thread_pid (ptid);
+  if (tp)
+    return tp->num;
 
   return 0;
 }
@@ -251,11 +321,9 @@ thread_id_to_pid (int num)
 int
 in_thread_list (ptid_t ptid)
 {
-  struct thread_info *tp;
-
-  for (tp = thread_list; tp; tp = tp->next)
-    if (ptid_equal (tp->ptid, ptid))
-      return 1;
+  /* APPLE LOCAL thread hash  */
+  if (find_thread_pid (ptid) != NULL)
+    return 1;
 
   return 0;			/* Never heard of 'im */
 }
@@ -315,6 +383,115 @@ gdb_list_thread_ids (struct ui_out *uiout, char **error_message)
 				    error_message, RETURN_MASK_ALL);
 }
 
+/* APPLE LOCAL begin thread-info  */
+/* Print a "frame" tuple for the innermost frame of thread TP: its pc,
+   sp, function and line.  Only the pc and sp registers are read, and
+   no frame is built, so this doesn't disturb the selected frame and
+   costs one register fetch per thread.  */
+
+static void
+print_thread_top_frame (struct ui_out *uiout, struct thread_info *tp)
+{
+  struct cleanup *frame_cleanup;
+  struct symtab_and_line sal;
+  struct symbol *func;
+  CORE_ADDR pc;
+
+  pc = read_pc_pid (tp->ptid);
+
+  frame_cleanup = make_cleanup_ui_out_tuple_begin_end (uiout, "frame");
+  ui_out_field_core_addr (uiout, "addr", pc);
+  if (SP_REGNUM >= 0)
+    ui_out_field_core_addr (uiout, "sp",
+			    read_register_pid (SP_REGNUM, tp->ptid));
+
+  func = find_pc_function (pc);
+  if (func != NULL)
+    ui_out_field_string (uiout, "func", SYMBOL_PRINT_NAME (func));
+  else
+    {
+      struct minimal_symbol *msymbol = lookup_minimal_symbol_by_pc (pc);
+
+      if (msymbol != NULL)
+	ui_out_field_string (uiout, "func", SYMBOL_PRINT_NAME (msymbol));
+    }
+
+  sal = find_pc_line (pc, 0);
+  if (sal.symtab != NULL && sal.symtab->filename != NULL)
+    {
+      char *fullname;
+
+      ui_out_field_string (uiout, "file", sal.symtab->filename);
+      fullname = symtab_to_fullname (sal.symtab);
+      if (fullname != NULL)
+	ui_out_field_string (uiout, "fullname", fullname);
+      ui_out_field_int (uiout, "line", sal.line);
+    }
+
+  do_cleanups (frame_cleanup);
+}
+
+/* Print, for every known thread, its id, the target's details about
+   it, and its innermost frame, so that a front end can fill in its
+   thread list with one command instead of selecting each thread in
+   turn.  To be used from within catch_errors.  */
+
+static int
+do_captured_list_thread_info (struct ui_out *uiout, void *arg)
+{
+  struct thread_info *tp;
+  struct cleanup *cleanup_chain;
+  int num = 0;
+
+  if (!target_has_stack)
+    error ("No stack.");
+
+  prune_threads ();
+  target_find_new_threads ();
+
+  cleanup_chain = make_cleanup_ui_out_list_begin_end (uiout, "threads");
+
+  for (tp = thread_list; tp; tp = tp->next)
+    {
+      struct cleanup *a_thread_cleanup;
+      struct gdb_exception e;
+
+      a_thread_cleanup = make_cleanup_ui_out_tuple_begin_end (uiout, "thread");
+      num++;
+      ui_out_field_int (uiout, "thread-id", tp->num);
+#ifdef NM_NEXTSTEP
+      macosx_print_thread_details (uiout, tp->ptid);
+#endif
+      /* A thread we can't read registers for still gets listed,
+	 just without a frame.  */
+      TRY_CATCH (e, RETURN_MASK_ERROR)
+	{
+	  print_thread_top_frame (uiout, tp);
+	}
+      do_cleanups (a_thread_cleanup);
+    }
+
+  do_cleanups (cleanup_chain);
+
+  if (pid_to_thread_id (inferior_ptid) > 0)
+    ui_out_field_int (uiout, "current-thread-id",
+		      pid_to_thread_id (inferior_ptid));
+  ui_out_field_int (uiout, "number-of-threads", num);
+
+  return GDB_RC_OK;
+}
+
+/* Official gdblib interface function to list every thread with its
+   details and innermost frame.  */
+
+enum gdb_rc
+gdb_list_thread_info (struct ui_out *uiout, char **error_message)
+{
+  return catch_exceptions_with_msg (uiout, do_captured_list_thread_info, NULL,
+				    error_message, RETURN_MASK_ALL);
+}
+/* APPLE LOCAL end thread-info  */
+
 /* Load infrun state for the thread PID.  */
 
 void
@@ -429,8 +606,9 @@ prune_threads (void)
   for (tp = thread_list; tp; tp = next)
     {
       next = tp->next;
+      /* APPLE LOCAL thread hash  */
       if (!thread_alive (tp))
-	delete_thread (tp->ptid);
+	delete_thread_1 (tp);
     }
 }
 
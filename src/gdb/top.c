@@ -66,6 +66,8 @@
 #include <ctype.h>
 #include "ui-out.h"
 #include "cli-out.h"
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
 
 /* Default command line prompt.  This is overriden in some configs. */
 
@@ -595,6 +597,8 @@ command_loop (void)
 	return;
 
       time_at_cmd_start = get_run_time ();
+      /* APPLE LOCAL gdb stats  */
+      gdb_stats_command_start ();
 
       if (display_space)
 	{
@@ -630,6 +634,8 @@ command_loop (void)
 			     space_diff);
 #endif
 	}
+      /* APPLE LOCAL gdb stats  */
+      gdb_stats_command_end ();
     }
 }
 
@@ -1295,6 +1301,9 @@ quit_force (char *args, int from_tty)
   catch_errors (quit_target, &qt,
 	        "Quitting: ", RETURN_MASK_ALL);
 
+  /* APPLE LOCAL gdb stats  */
+  gdb_stats_report_at_exit ();
+
   exit (exit_code);
 }
 
@@ -1652,8 +1661,14 @@ gdb_init (char *argv0)
   init_cmd_lists ();		/* This needs to be done first */
   initialize_targets ();	/* Setup target_terminal macros for utils.c */
   initialize_utils ();		/* Make errors and warnings possible */
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("core tables");
   initialize_all_files ();
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("file initializers");
   initialize_current_architecture ();
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("current architecture");
   init_cli_cmds();
   init_main ();			/* But that omits this file!  Do it now */
 
@@ -1670,4 +1685,6 @@ gdb_init (char *argv0)
      deprecated_init_ui_hook.  */
   if (deprecated_init_ui_hook)
     deprecated_init_ui_hook (argv0);
+  /* APPLE LOCAL startup stats */
+  startup_stats_phase ("cli, signals and language");
 }
@@ -49,6 +49,11 @@
 #include "readline/readline.h"
 #include "readline/history.h"
 
+/* APPLE LOCAL trace file  */
+#include "filenames.h"
+/* APPLE LOCAL fast tracepoints  */
+#include "disasm.h"
+
 /* readline defines this.  */
 #undef savestring
 
@@ -83,6 +88,7 @@ extern void output_command (char *, int);
 
    This module defines the following debugger commands:
    trace            : set a tracepoint on a function, line, or address.
+   ftrace           : likewise, but collected without a trap.
    info trace       : list all debugger-defined tracepoints.
    delete trace     : delete one or more tracepoints.
    enable trace     : enable one or more tracepoints.
@@ -95,6 +101,8 @@ extern void output_command (char *, int);
    tfind            : find a trace frame in the trace buffer.
    tdump            : print everything collected at the current tracepoint.
    save-tracepoints : write tracepoint setup into a file.
+   tsave            : copy the trace buffer into a file.
+   target tfile     : debug the trace frames in such a file.
 
    This module defines the following user-visible debugger variables:
    $trace_frame : sequence number of trace frame currently being debugged.
@@ -129,6 +137,8 @@ static struct cmd_list_element *tfindlist;
 
 /* ======= Important command functions: ======= */
 static void trace_command (char *, int);
+/* APPLE LOCAL fast tracepoints  */
+static void ftrace_command (char *, int);
 static void tracepoints_info (char *, int);
 static void delete_trace_command (char *, int);
 static void enable_trace_command (char *, int);
@@ -146,6 +156,8 @@ static void trace_find_range_command (char *, int);
 static void trace_find_outside_command (char *, int);
 static void tracepoint_save_command (char *, int);
 static void trace_dump_command (char *, int);
+/* APPLE LOCAL trace file  */
+static void trace_save_command (char *, int);
 
 /* support routines */
 static void trace_mention (struct tracepoint *);
@@ -153,6 +165,11 @@ static void trace_mention (struct tracepoint *);
 struct collection_list;
 static void add_aexpr (struct collection_list *, struct agent_expr *);
 static char *mem2hex (gdb_byte *, char *, int);
+/* APPLE LOCAL begin trace file  */
+static int hex2mem (char *, gdb_byte *, int);
+static int fromhex (int);
+static int tfile_target_p (void);
+/* APPLE LOCAL end trace file  */
 static void add_register (struct collection_list *collection,
 			  unsigned int regno);
 static struct cleanup *make_cleanup_free_actions (struct tracepoint *t);
@@ -173,6 +190,16 @@ target_is_remote (void)
     return 0;
 }
 
+/* APPLE LOCAL begin trace file  */
+/* Utility: returns true if the target can select trace frames, either
+   because it is a remote stub or because it is a trace file.  */
+static int
+trace_buffer_target_p (void)
+{
+  return target_is_remote () || tfile_target_p ();
+}
+/* APPLE LOCAL end trace file  */
+
 /* Utility: generate error from an incoming stub packet.  */
 static void
 trace_error (char *buf)
@@ -383,8 +410,45 @@ set_raw_tracepoint (struct symtab_and_line sal)
 }
 
 /* Set a tracepoint according to ARG (function, linenum or *address).  */
+/* APPLE LOCAL begin fast tracepoints  */
+/* Return the length of the jump a stub puts in place of the
+   instruction at a fast tracepoint, or zero if we don't know how this
+   architecture would do it.  */
+
+static int
+fast_tracepoint_jump_length (void)
+{
+  /* A jmp rel32, for both 32- and 64-bit code.  */
+  if (gdbarch_bfd_arch_info (current_gdbarch)->arch == bfd_arch_i386)
+    return 5;
+  return 0;
+}
+
+/* Return the length of the instruction at ADDR, erroring if it is too
+   short to be replaced with a jump to a fast tracepoint's pad.  */
+
+static int
+fast_tracepoint_insn_length (CORE_ADDR addr)
+{
+  int jump_len = fast_tracepoint_jump_length ();
+  int insn_len;
+
+  if (jump_len == 0)
+    error (_("Fast tracepoints are not supported on this architecture."));
+
+  insn_len = gdb_print_insn (addr, gdb_null);
+  if (insn_len < jump_len)
+    error (_("Cannot set a fast tracepoint at 0x%s: the instruction there "
+	     "is %d bytes long, but the jump needs %d."),
+	   paddr_nz (addr), insn_len, jump_len);
+  return insn_len;
+}
+
+/* Worker for the trace and ftrace commands.  FAST_P says which.  */
+
 static void
-trace_command (char *arg, int from_tty)
+trace_command_1 (char *arg, int from_tty, int fast_p)
+/* APPLE LOCAL end fast tracepoints  */
 {
   char **canonical = (char **) NULL;
   struct symtabs_and_lines sals;
@@ -412,6 +476,13 @@ trace_command (char *arg, int from_tty)
   for (i = 0; i < sals.nelts; i++)
     resolve_sal_pc (&sals.sals[i]);
 
+  /* APPLE LOCAL begin fast tracepoints  */
+  /* Check every location before setting any of them.  */
+  if (fast_p)
+    for (i = 0; i < sals.nelts; i++)
+      fast_tracepoint_insn_length (sals.sals[i].pc);
+  /* APPLE LOCAL end fast tracepoints  */
+
   /* Now set all the tracepoints.  */
   for (i = 0; i < sals.nelts; i++)
     {
@@ -420,6 +491,13 @@ trace_command (char *arg, int from_tty)
       t = set_raw_tracepoint (sal);
       set_tracepoint_count (tracepoint_count + 1);
       t->number = tracepoint_count;
+      /* APPLE LOCAL begin fast tracepoints  */
+      if (fast_p)
+	{
+	  t->fast_p = 1;
+	  t->fast_insn_len = fast_tracepoint_insn_length (t->address);
+	}
+      /* APPLE LOCAL end fast tracepoints  */
 
       /* If a canonical line spec is needed use that instead of the
          command string.  */
@@ -438,12 +516,28 @@ trace_command (char *arg, int from_tty)
     }
 }
 
+/* APPLE LOCAL begin fast tracepoints  */
+static void
+trace_command (char *arg, int from_tty)
+{
+  trace_command_1 (arg, from_tty, 0);
+}
+
+static void
+ftrace_command (char *arg, int from_tty)
+{
+  trace_command_1 (arg, from_tty, 1);
+}
+/* APPLE LOCAL end fast tracepoints  */
+
 /* Tell the user we have just set a tracepoint TP.  */
 
 static void
 trace_mention (struct tracepoint *tp)
 {
-  printf_filtered ("Tracepoint %d", tp->number);
+  /* APPLE LOCAL fast tracepoints  */
+  printf_filtered ("%s %d", tp->fast_p ? "Fast tracepoint" : "Tracepoint",
+		   tp->number);
 
   if (addressprint || (tp->source_file == NULL))
     {
@@ -531,6 +625,9 @@ tracepoints_info (char *tpnum_exp, int from_tty)
       else
 	print_address_symbolic (t->address, gdb_stdout, demangle, " ");
 
+      /* APPLE LOCAL fast tracepoints  */
+      if (t->fast_p)
+	printf_filtered (" (fast)");
       printf_filtered ("\n");
       if (t->actions)
 	{
@@ -1772,11 +1869,19 @@ trace_start_command (char *args, int from_tty)
 		 tmp, /* address */
 		 t->enabled_p ? 'E' : 'D',
 		 t->step_count, t->pass_count);
+	/* APPLE LOCAL begin fast tracepoints  */
+	if (t->fast_p)
+	  sprintf (buf + strlen (buf), ":F%x", t->fast_insn_len);
+	/* APPLE LOCAL end fast tracepoints  */
 
 	if (t->actions)
 	  strcat (buf, "-");
 	putpkt (buf);
 	remote_get_noisy_reply (target_buf, sizeof (target_buf));
+	/* APPLE LOCAL begin fast tracepoints  */
+	if (strcmp (target_buf, "OK") && t->fast_p)
+	  error (_("Target does not support fast tracepoints."));
+	/* APPLE LOCAL end fast tracepoints  */
 	if (strcmp (target_buf, "OK"))
 	  error (_("Target does not support tracepoints."));
 
@@ -1886,22 +1991,840 @@ trace_status_command (char *args, int from_tty)
     error (_("Trace can only be run on remote targets."));
 }
 
-/* Worker function for the various flavors of the tfind command.  */
+/* APPLE LOCAL begin trace file  */
+/* Trace files.
+
+   "tsave FILE" copies the stub's whole trace buffer into FILE, and
+   "target tfile FILE" then debugs the trace frames in it without a
+   stub: tfind searches an index built when the file is opened, and
+   tdump, print, backtrace and the rest read the selected frame's
+   registers and memory straight from the file.
+
+   A trace file is a short text header
+
+     "\x7fTRACE0\n"
+     "R <size>\n"			a register block's size
+     "tp <number>:<address>\n"	one line for each tracepoint
+     "\n"
+
+   with numbers in hex, followed by the trace frames as the stub keeps
+   them and hands them over in reply to "qTBuffer:<offset>,<length>":
+
+     2 bytes	tracepoint number, or zero for the end of the buffer
+     4 bytes	length of the blocks that follow
+     blocks, each one of
+       'R' <register block>			in 'g' packet layout
+       'M' <8-byte address> <2-byte length> <bytes>
+       'V' <4-byte number> <8-byte value>	a trace state variable
+
+   with numbers in target byte order.  A frame without a register
+   block is taken to be at its tracepoint's address.  */
+
+#define TRACE_FILE_MAGIC "\x7fTRACE0\n"
+
+/* The process id a trace file claims to be.  */
+#define TFILE_PID 1
+
+/* How much of the trace buffer tsave asks for in each qTBuffer
+   request.  The stub may send less.  */
+#define TSAVE_CHUNK_SIZE (16 * 1024)
+
+struct tfile_tracepoint
+{
+  int number;
+  CORE_ADDR address;
+};
+
+struct tfile_frame
+{
+  /* Where the frame's blocks are in the file, and their length.  */
+  long offset;
+  unsigned int size;
+
+  int tpnum;
+
+  /* The pc in the frame's register block, or its tracepoint's
+     address.  */
+  CORE_ADDR pc;
+};
+
+static struct target_ops tfile_ops;
+
+static FILE *tfile_fp;
+static char *tfile_filename;
+
+/* A register block's size, as the file's header gives it.  */
+static unsigned int tfile_regblock_size;
+
+static struct tfile_tracepoint *tfile_tracepoints;
+static int tfile_ntracepoints;
+
+static struct tfile_frame *tfile_frames;
+static int tfile_nframes;
+
+/* The numbers of all the frames, sorted by pc and by tracepoint and
+   within those by frame number, so that finding the next frame with a
+   given pc or tracepoint is a binary search.  */
+static int *tfile_frames_by_pc;
+static int *tfile_frames_by_tp;
+
+/* The selected frame, or -1, and its blocks.  */
+static int tfile_current = -1;
+static gdb_byte *tfile_data;
+
+/* The kinds of trace frame search the tfind commands ask for.  */
+enum trace_find_type
+{
+  tfind_number,
+  tfind_pc,
+  tfind_tp,
+  tfind_range,
+  tfind_outside
+};
+
+static int
+tfile_target_p (void)
+{
+  return tfile_fp != NULL;
+}
+
+/* The size of a register block in 'g' packet layout.  */
+static unsigned int
+trace_regblock_size (void)
+{
+  unsigned int size = 0;
+  int regnum;
+
+  for (regnum = 0; regnum < NUM_REGS; regnum++)
+    size += register_size (current_gdbarch, regnum);
+  return size;
+}
+
+/* Return non-zero if register REGNUM is in a trace file's register
+   blocks.  */
+static int
+tfile_register_in_block (int regnum)
+{
+  return (regnum >= 0 && regnum < NUM_REGS
+	  && (DEPRECATED_REGISTER_BYTE (regnum)
+	      + register_size (current_gdbarch, regnum)
+	      <= tfile_regblock_size));
+}
+
+/* Read LEN bytes at OFFSET in the trace file into BUF.  */
 static void
-finish_tfind_command (char *msg,
-		      long sizeof_msg,
-		      int from_tty)
+tfile_read (long offset, gdb_byte *buf, unsigned int len)
+{
+  if (fseek (tfile_fp, offset, SEEK_SET) != 0)
+    perror_with_name (tfile_filename);
+  if (fread (buf, 1, len, tfile_fp) != len)
+    error (_("Premature end of trace file \"%s\"."), tfile_filename);
+}
+
+/* Return the length of the block at BLOCK, which is AVAIL bytes from
+   the end of its frame.  */
+static unsigned int
+tfile_block_length (const gdb_byte *block, unsigned int avail)
+{
+  unsigned int len;
+
+  switch (block[0])
+    {
+    case 'R':
+      len = 1 + tfile_regblock_size;
+      break;
+    case 'M':
+      len = 1 + 8 + 2;
+      if (len <= avail)
+	len += extract_unsigned_integer (block + 1 + 8, 2);
+      break;
+    case 'V':
+      len = 1 + 4 + 8;
+      break;
+    default:
+      error (_("Unknown block type '%c' in trace file \"%s\"."),
+	     block[0], tfile_filename);
+    }
+
+  if (len > avail)
+    error (_("Truncated block in trace file \"%s\"."), tfile_filename);
+  return len;
+}
+
+/* Return the first block of type TYPE in the SIZE bytes of blocks at
+   DATA, or NULL.  */
+static const gdb_byte *
+tfile_find_block (const gdb_byte *data, unsigned int size, int type)
+{
+  unsigned int pos, len;
+
+  for (pos = 0; pos < size; pos += len)
+    {
+      len = tfile_block_length (data + pos, size - pos);
+      if (data[pos] == type)
+	return data + pos;
+    }
+  return NULL;
+}
+
+static CORE_ADDR
+tfile_tracepoint_address (int tpnum)
+{
+  struct tracepoint *t;
+  int i;
+
+  for (i = 0; i < tfile_ntracepoints; i++)
+    if (tfile_tracepoints[i].number == tpnum)
+      return tfile_tracepoints[i].address;
+
+  ALL_TRACEPOINTS (t)
+    if (t->number == tpnum)
+      return t->address;
+
+  return 0;
+}
+
+/* Return the pc of the frame of tracepoint TPNUM whose SIZE bytes of
+   blocks are at DATA.  */
+static CORE_ADDR
+tfile_frame_pc (const gdb_byte *data, unsigned int size, int tpnum)
+{
+  const gdb_byte *regs = tfile_find_block (data, size, 'R');
+
+  if (regs != NULL && tfile_register_in_block (PC_REGNUM))
+    return extract_unsigned_integer (regs + 1
+				     + DEPRECATED_REGISTER_BYTE (PC_REGNUM),
+				     register_size (current_gdbarch,
+						    PC_REGNUM));
+  return tfile_tracepoint_address (tpnum);
+}
+
+static ULONGEST
+tfile_parse_hex (char **pp)
+{
+  ULONGEST val = 0;
+  char *p = *pp;
+
+  while (isxdigit (*p))
+    val = (val << 4) | fromhex (*p++);
+  *pp = p;
+  return val;
+}
+
+static void
+tfile_read_header (void)
+{
+  char line[256];
+  char *p;
+
+  if (fgets (line, sizeof (line), tfile_fp) == NULL
+      || strcmp (line, TRACE_FILE_MAGIC) != 0)
+    error (_("\"%s\" is not a trace file."), tfile_filename);
+
+  while (1)
+    {
+      if (fgets (line, sizeof (line), tfile_fp) == NULL)
+	error (_("Premature end of trace file \"%s\"."), tfile_filename);
+      if (line[0] == '\n')
+	break;
+
+      if (strncmp (line, "R ", 2) == 0)
+	{
+	  p = line + 2;
+	  tfile_regblock_size = tfile_parse_hex (&p);
+	}
+      else if (strncmp (line, "tp ", 3) == 0)
+	{
+	  struct tfile_tracepoint *tp;
+
+	  tfile_tracepoints = xrealloc (tfile_tracepoints,
+					(tfile_ntracepoints + 1)
+					* sizeof (struct tfile_tracepoint));
+	  tp = &tfile_tracepoints[tfile_ntracepoints++];
+	  p = line + 3;
+	  tp->number = tfile_parse_hex (&p);
+	  if (*p == ':')
+	    p++;
+	  tp->address = tfile_parse_hex (&p);
+	}
+      /* Skip anything else, for the sake of newer files.  */
+    }
+
+  if (tfile_regblock_size != trace_regblock_size ())
+    warning (_("Trace file \"%s\" has %u bytes of registers, "
+	       "but the current architecture has %u."),
+	     tfile_filename, tfile_regblock_size, trace_regblock_size ());
+}
+
+static int
+tfile_compare_by_pc (const void *a, const void *b)
+{
+  int fa = *(const int *) a;
+  int fb = *(const int *) b;
+
+  if (tfile_frames[fa].pc != tfile_frames[fb].pc)
+    return tfile_frames[fa].pc < tfile_frames[fb].pc ? -1 : 1;
+  return fa - fb;
+}
+
+static int
+tfile_compare_by_tp (const void *a, const void *b)
+{
+  int fa = *(const int *) a;
+  int fb = *(const int *) b;
+
+  if (tfile_frames[fa].tpnum != tfile_frames[fb].tpnum)
+    return tfile_frames[fa].tpnum - tfile_frames[fb].tpnum;
+  return fa - fb;
+}
+
+/* Read through the trace frames, which start at the trace file's
+   current position, recording where each one is, its tracepoint and
+   its pc.  */
+static void
+tfile_build_index (void)
+{
+  gdb_byte header[2 + 4];
+  gdb_byte *data = NULL;
+  unsigned int data_size = 0;
+  int allocated = 0;
+  struct cleanup *old_chain;
+  int i;
+
+  old_chain = make_cleanup (free_current_contents, &data);
+  while (1)
+    {
+      size_t got = fread (header, 1, sizeof (header), tfile_fp);
+      struct tfile_frame *f;
+      unsigned int size;
+      int tpnum;
+
+      /* The buffer ends at a frame for tracepoint zero, or at the end
+	 of the file if the stub didn't write one.  */
+      if (got == 0 || (got >= 2 && extract_unsigned_integer (header, 2) == 0))
+	break;
+      if (got < sizeof (header))
+	error (_("Premature end of trace file \"%s\"."), tfile_filename);
+
+      tpnum = extract_unsigned_integer (header, 2);
+      size = extract_unsigned_integer (header + 2, 4);
+      if (size > data_size)
+	{
+	  data = xrealloc (data, size);
+	  data_size = size;
+	}
+      if (fread (data, 1, size, tfile_fp) != size)
+	error (_("Premature end of trace file \"%s\"."), tfile_filename);
+
+      if (tfile_nframes == allocated)
+	{
+	  allocated = allocated ? 2 * allocated : 1024;
+	  tfile_frames = xrealloc (tfile_frames,
+				   allocated * sizeof (struct tfile_frame));
+	}
+      f = &tfile_frames[tfile_nframes++];
+      f->offset = ftell (tfile_fp) - size;
+      f->size = size;
+      f->tpnum = tpnum;
+      f->pc = tfile_frame_pc (data, size, tpnum);
+
+      if ((tfile_nframes & 0xfff) == 0)
+	QUIT;
+    }
+  do_cleanups (old_chain);
+
+  tfile_frames_by_pc = xmalloc (tfile_nframes * sizeof (int));
+  tfile_frames_by_tp = xmalloc (tfile_nframes * sizeof (int));
+  for (i = 0; i < tfile_nframes; i++)
+    tfile_frames_by_pc[i] = tfile_frames_by_tp[i] = i;
+  qsort (tfile_frames_by_pc, tfile_nframes, sizeof (int),
+	 tfile_compare_by_pc);
+  qsort (tfile_frames_by_tp, tfile_nframes, sizeof (int),
+	 tfile_compare_by_tp);
+}
+
+/* Return the first position in tfile_frames_by_pc whose frame is at a
+   pc above PC, or at PC and numbered FRAMENO or higher.  */
+static int
+tfile_lower_bound_pc (CORE_ADDR pc, int frameno)
+{
+  int lo = 0, hi = tfile_nframes;
+
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      int f = tfile_frames_by_pc[mid];
+
+      if (tfile_frames[f].pc < pc
+	  || (tfile_frames[f].pc == pc && f < frameno))
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Likewise for tfile_frames_by_tp and tracepoint TPNUM.  */
+static int
+tfile_lower_bound_tp (int tpnum, int frameno)
+{
+  int lo = 0, hi = tfile_nframes;
+
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      int f = tfile_frames_by_tp[mid];
+
+      if (tfile_frames[f].tpnum < tpnum
+	  || (tfile_frames[f].tpnum == tpnum && f < frameno))
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Do what the stub would for the QTFrame request TYPE, NUM, ADDR1 and
+   ADDR2: find frame NUM, or the first frame after the selected one
+   that matches.  Return its number and set *TPNUM to its tracepoint,
+   or return -1.  */
+static int
+tfile_trace_find (enum trace_find_type type, int num,
+		  CORE_ADDR addr1, CORE_ADDR addr2, int *tpnum)
+{
+  int start = tfile_current + 1;
+  int found = -1;
+  int i, j;
+
+  switch (type)
+    {
+    case tfind_number:
+      if (num >= 0 && num < tfile_nframes)
+	found = num;
+      break;
+
+    case tfind_pc:
+      i = tfile_lower_bound_pc (addr1, start);
+      if (i < tfile_nframes
+	  && tfile_frames[tfile_frames_by_pc[i]].pc == addr1)
+	found = tfile_frames_by_pc[i];
+      break;
+
+    case tfind_tp:
+      i = tfile_lower_bound_tp (num, start);
+      if (i < tfile_nframes
+	  && tfile_frames[tfile_frames_by_tp[i]].tpnum == num)
+	found = tfile_frames_by_tp[i];
+      break;
+
+    case tfind_range:
+      /* Look for the next frame at each distinct pc in the range.  */
+      i = tfile_lower_bound_pc (addr1, 0);
+      while (i < tfile_nframes
+	     && tfile_frames[tfile_frames_by_pc[i]].pc <= addr2)
+	{
+	  CORE_ADDR pc = tfile_frames[tfile_frames_by_pc[i]].pc;
+
+	  j = tfile_lower_bound_pc (pc, start);
+	  if (j < tfile_nframes
+	      && tfile_frames[tfile_frames_by_pc[j]].pc == pc
+	      && (found == -1 || tfile_frames_by_pc[j] < found))
+	    found = tfile_frames_by_pc[j];
+	  i = tfile_lower_bound_pc (pc, INT_MAX);
+	}
+      break;
+
+    case tfind_outside:
+      for (i = start; i < tfile_nframes; i++)
+	if (tfile_frames[i].pc < addr1 || tfile_frames[i].pc > addr2)
+	  {
+	    found = i;
+	    break;
+	  }
+      break;
+    }
+
+  *tpnum = found == -1 ? -1 : tfile_frames[found].tpnum;
+  return found;
+}
+
+/* Make FRAMENO, or no frame if it is -1, the selected frame.  */
+static void
+tfile_select_frame (int frameno)
+{
+  gdb_byte *data = NULL;
+
+  if (frameno != -1)
+    {
+      struct cleanup *old_chain;
+
+      data = xmalloc (tfile_frames[frameno].size);
+      old_chain = make_cleanup (xfree, data);
+      tfile_read (tfile_frames[frameno].offset, data,
+		  tfile_frames[frameno].size);
+      discard_cleanups (old_chain);
+    }
+
+  xfree (tfile_data);
+  tfile_data = data;
+  tfile_current = frameno;
+
+  /* Without a frame there are no registers, and so no stack.  */
+  tfile_ops.to_has_stack = tfile_ops.to_has_registers = frameno != -1;
+  update_current_target ();
+  dcache_invalidate (target_dcache);
+}
+
+static void
+tfile_close (int quitting)
+{
+  if (tfile_fp == NULL)
+    return;
+
+  fclose (tfile_fp);
+  tfile_fp = NULL;
+  xfree (tfile_filename);
+  tfile_filename = NULL;
+  xfree (tfile_tracepoints);
+  tfile_tracepoints = NULL;
+  tfile_ntracepoints = 0;
+  xfree (tfile_frames);
+  tfile_frames = NULL;
+  xfree (tfile_frames_by_pc);
+  tfile_frames_by_pc = NULL;
+  xfree (tfile_frames_by_tp);
+  tfile_frames_by_tp = NULL;
+  tfile_nframes = 0;
+  xfree (tfile_data);
+  tfile_data = NULL;
+  tfile_current = -1;
+  tfile_regblock_size = 0;
+  tfile_ops.to_has_stack = tfile_ops.to_has_registers = 0;
+
+  inferior_ptid = null_ptid;
+  if (!quitting)
+    {
+      set_traceframe_num (-1);
+      set_tracepoint_num (-1);
+      set_traceframe_context (-1);
+    }
+}
+
+static void
+tfile_close_cleanup (void *ignore)
+{
+  tfile_close (0);
+}
+
+static void
+tfile_open (char *args, int from_tty)
+{
+  char *filename;
+  struct cleanup *old_chain;
+  FILE *fp;
+
+  target_preopen (from_tty);
+  if (args == NULL || *args == '\0')
+    error (_("No trace file specified."));
+
+  filename = tilde_expand (args);
+  if (!IS_ABSOLUTE_PATH (filename))
+    {
+      char *temp = concat (current_directory, "/", filename, (char *) NULL);
+      xfree (filename);
+      filename = temp;
+    }
+  old_chain = make_cleanup (xfree, filename);
+
+  fp = fopen (filename, FOPEN_RB);
+  if (fp == NULL)
+    perror_with_name (filename);
+
+  /* Toss the old trace file and read the new one.  */
+  discard_cleanups (old_chain);
+  unpush_target (&tfile_ops);
+  tfile_fp = fp;
+  tfile_filename = filename;
+  old_chain = make_cleanup (tfile_close_cleanup, NULL);
+
+  tfile_read_header ();
+  tfile_build_index ();
+
+  discard_cleanups (old_chain);
+  push_target (&tfile_ops);
+  inferior_ptid = pid_to_ptid (TFILE_PID);
+  set_traceframe_num (-1);
+  set_tracepoint_num (-1);
+
+  if (from_tty)
+    printf_filtered (_("Read %d trace frames from \"%s\".\n"),
+		     tfile_nframes, tfile_filename);
+}
+
+static void
+tfile_files_info (struct target_ops *t)
+{
+  printf_filtered ("\t`%s', %d trace frames", tfile_filename, tfile_nframes);
+  if (tfile_current != -1)
+    printf_filtered (", frame %d selected", tfile_current);
+  printf_filtered (".\n");
+}
+
+/* Supply the selected frame's registers.  Those it didn't collect are
+   unavailable, except the pc, which is its tracepoint's address.  */
+static void
+tfile_fetch_registers (int regno)
+{
+  const gdb_byte *regs = NULL;
+  int i;
+
+  if (tfile_current != -1)
+    regs = tfile_find_block (tfile_data, tfile_frames[tfile_current].size,
+			     'R');
+
+  for (i = 0; i < NUM_REGS; i++)
+    {
+      if (regs != NULL && tfile_register_in_block (i))
+	regcache_raw_supply (current_regcache, i,
+			     regs + 1 + DEPRECATED_REGISTER_BYTE (i));
+      else if (i == PC_REGNUM && tfile_current != -1)
+	{
+	  gdb_byte buf[MAX_REGISTER_SIZE];
+
+	  store_unsigned_integer (buf, register_size (current_gdbarch, i),
+				  tfile_frames[tfile_current].pc);
+	  regcache_raw_supply (current_regcache, i, buf);
+	}
+      else
+	{
+	  regcache_raw_supply (current_regcache, i, NULL);
+	  set_register_cached (i, -1);
+	}
+    }
+}
+
+/* Read memory the selected frame collected.  The frame can't be
+   written, and anything it didn't collect is left to the targets
+   below, so that the executable can still supply the text.  */
+static LONGEST
+tfile_xfer_partial (struct target_ops *ops, enum target_object object,
+		    const char *annex, gdb_byte *readbuf,
+		    const gdb_byte *writebuf, ULONGEST offset, LONGEST len)
+{
+  unsigned int pos, size, blocklen;
+
+  if (object != TARGET_OBJECT_MEMORY)
+    {
+      if (ops->beneath != NULL)
+	return ops->beneath->to_xfer_partial (ops->beneath, object, annex,
+					      readbuf, writebuf, offset, len);
+      return -1;
+    }
+
+  if (readbuf == NULL || tfile_current == -1)
+    return -1;
+
+  size = tfile_frames[tfile_current].size;
+  for (pos = 0; pos < size; pos += blocklen)
+    {
+      const gdb_byte *block = tfile_data + pos;
+
+      blocklen = tfile_block_length (block, size - pos);
+      if (block[0] == 'M')
+	{
+	  ULONGEST addr = extract_unsigned_integer (block + 1, 8);
+	  unsigned int mlen = extract_unsigned_integer (block + 1 + 8, 2);
+
+	  if (offset >= addr && offset < addr + mlen)
+	    {
+	      LONGEST n = addr + mlen - offset;
+
+	      if (n > len)
+		n = len;
+	      memcpy (readbuf, block + 1 + 8 + 2 + (offset - addr), n);
+	      return n;
+	    }
+	}
+    }
+  return -1;
+}
+
+static int
+tfile_thread_alive (ptid_t ptid)
+{
+  return 1;
+}
+
+static void
+init_tfile_ops (void)
+{
+  tfile_ops.to_shortname = "tfile";
+  tfile_ops.to_longname = "Local trace dump file";
+  tfile_ops.to_doc =
+    "Use a trace file as a target.  Specify the filename of the trace file.";
+  tfile_ops.to_open = tfile_open;
+  tfile_ops.to_close = tfile_close;
+  tfile_ops.to_attach = find_default_attach;
+  tfile_ops.to_fetch_registers = tfile_fetch_registers;
+  tfile_ops.to_xfer_partial = tfile_xfer_partial;
+  tfile_ops.to_files_info = tfile_files_info;
+  tfile_ops.to_create_inferior = find_default_create_inferior;
+  tfile_ops.to_thread_alive = tfile_thread_alive;
+  tfile_ops.to_stratum = process_stratum;
+  tfile_ops.to_has_memory = 1;
+  tfile_ops.to_magic = OPS_MAGIC;
+}
+
+struct tsave_state
+{
+  FILE *fp;
+  char *pathname;
+  int finished;
+};
+
+static void
+tsave_cleanup (void *arg)
+{
+  struct tsave_state *state = arg;
+
+  fclose (state->fp);
+  /* Don't leave half a trace buffer behind.  */
+  if (!state->finished)
+    unlink (state->pathname);
+  xfree (state->pathname);
+}
+
+/* tsave command */
+static void
+trace_save_command (char *args, int from_tty)
+{
+  struct tracepoint *t;
+  struct tsave_state state;
+  struct cleanup *old_chain;
+  long sizeof_buf = 2 * TSAVE_CHUNK_SIZE + 32;
+  char *buf, *reply;
+  gdb_byte *data;
+  ULONGEST offset = 0;
+
+  if (!target_is_remote ())
+    error (_("Trace can only be run on remote targets."));
+  if (args == 0 || *args == 0)
+    error (_("Argument required (file name in which to save trace data)."));
+
+  state.pathname = tilde_expand (args);
+  state.finished = 0;
+  state.fp = fopen (state.pathname, FOPEN_WB);
+  if (state.fp == NULL)
+    {
+      make_cleanup (xfree, state.pathname);
+      error (_("Unable to open file '%s' for saving trace data (%s)"),
+	     args, safe_strerror (errno));
+    }
+  old_chain = make_cleanup (tsave_cleanup, &state);
+
+  fputs (TRACE_FILE_MAGIC, state.fp);
+  fprintf (state.fp, "R %x\n", trace_regblock_size ());
+  ALL_TRACEPOINTS (t)
+    fprintf (state.fp, "tp %x:%s\n", t->number, paddr_nz (t->address));
+  fputs ("\n", state.fp);
+
+  /* Stream the buffer over in as few packets as the stub allows.  */
+  buf = xmalloc (sizeof_buf);
+  make_cleanup (xfree, buf);
+  data = xmalloc (TSAVE_CHUNK_SIZE);
+  make_cleanup (xfree, data);
+  while (1)
+    {
+      int got;
+
+      sprintf (buf, "qTBuffer:%s,%x", phex_nz (offset, sizeof (offset)),
+	       TSAVE_CHUNK_SIZE);
+      putpkt (buf);
+      reply = remote_get_noisy_reply (buf, sizeof_buf);
+      if (reply[0] == 'l')
+	break;
+
+      got = hex2mem (reply, data, TSAVE_CHUNK_SIZE);
+      if (got == 0)
+	error (_("Bogus reply from target: %s"), reply);
+      if (fwrite (data, 1, got, state.fp) != got)
+	perror_with_name (state.pathname);
+      offset += got;
+    }
+
+  if (fflush (state.fp) != 0)
+    perror_with_name (state.pathname);
+  state.finished = 1;
+  if (from_tty)
+    printf_filtered (_("Saved %s bytes of trace data to \"%s\".\n"),
+		     paddr_u (offset), state.pathname);
+  do_cleanups (old_chain);
+}
+/* APPLE LOCAL end trace file  */
+
+/* Worker function for the various flavors of the tfind command.
+   APPLE LOCAL trace file: Select the trace frame TYPE, NUM, ADDR1 and
+   ADDR2 describe, by asking the stub or by searching the trace file.  */
+static void
+finish_tfind_command (enum trace_find_type type, int num,
+		      CORE_ADDR addr1, CORE_ADDR addr2, int from_tty)
 {
   int target_frameno = -1, target_tracept = -1;
-  CORE_ADDR old_frame_addr;
-  struct symbol *old_func;
+  CORE_ADDR old_frame_addr = 0;
+  struct symbol *old_func = NULL;
+  char addr1_str[40], addr2_str[40];
   char *reply;
 
-  old_frame_addr = get_frame_base (get_current_frame ());
-  old_func = find_pc_function (read_pc ());
+  /* APPLE LOCAL begin trace file  */
+  /* A trace file has no stack until a frame is selected.  */
+  if (target_has_stack)
+    {
+      old_frame_addr = get_frame_base (get_current_frame ());
+      old_func = find_pc_function (read_pc ());
+    }
 
-  putpkt (msg);
-  reply = remote_get_noisy_reply (msg, sizeof_msg);
+  if (tfile_target_p ())
+    {
+      target_frameno = tfile_trace_find (type, num, addr1, addr2,
+					 &target_tracept);
+      if (target_frameno == -1 && !(type == tfind_number && num == -1))
+	{
+	  /* As below.  */
+	  if (from_tty)
+	    error (_("Target failed to find requested trace frame."));
+	  else if (info_verbose)
+	    printf_filtered ("End of trace buffer.\n");
+	}
+      tfile_select_frame (target_frameno);
+      reply = NULL;
+    }
+  else
+    {
+      sprintf_vma (addr1_str, addr1);
+      sprintf_vma (addr2_str, addr2);
+      switch (type)
+	{
+	case tfind_number:
+	  sprintf (target_buf, "QTFrame:%x", num);
+	  break;
+	case tfind_pc:
+	  sprintf (target_buf, "QTFrame:pc:%s", addr1_str);
+	  break;
+	case tfind_tp:
+	  sprintf (target_buf, "QTFrame:tdp:%x", num);
+	  break;
+	case tfind_range:
+	  sprintf (target_buf, "QTFrame:range:%s:%s", addr1_str, addr2_str);
+	  break;
+	case tfind_outside:
+	  sprintf (target_buf, "QTFrame:outside:%s:%s",
+		   addr1_str, addr2_str);
+	  break;
+	}
+      putpkt (target_buf);
+      reply = remote_get_noisy_reply (target_buf, sizeof (target_buf));
+    }
+  /* APPLE LOCAL end trace file  */
 
   while (reply && *reply)
     switch (*reply)
@@ -1960,7 +2883,9 @@ finish_tfind_command (char *msg,
 
   flush_cached_frames ();
   registers_changed ();
-  select_frame (get_current_frame ());
+  /* APPLE LOCAL trace file  */
+  if (target_has_stack)
+    select_frame (get_current_frame ());
   set_traceframe_num (target_frameno);
   set_tracepoint_num (target_tracept);
   if (target_frameno == -1)
@@ -1968,7 +2893,8 @@ finish_tfind_command (char *msg,
   else
     set_traceframe_context (read_pc ());
 
-  if (from_tty)
+  /* APPLE LOCAL trace file  */
+  if (from_tty && target_has_stack)
     {
       enum print_what print_what;
 
@@ -2020,7 +2946,8 @@ trace_find_command (char *args, int from_tty)
 { /* this should only be called with a numeric argument */
   int frameno = -1;
 
-  if (target_is_remote ())
+  /* APPLE LOCAL trace file  */
+  if (trace_buffer_target_p ())
     {
       if (deprecated_trace_find_hook)
 	deprecated_trace_find_hook (args, from_tty);
@@ -2047,8 +2974,8 @@ trace_find_command (char *args, int from_tty)
       if (frameno < -1)
 	error (_("invalid input (%d is less than zero)"), frameno);
 
-      sprintf (target_buf, "QTFrame:%x", frameno);
-      finish_tfind_command (target_buf, sizeof (target_buf), from_tty);
+      /* APPLE LOCAL trace file  */
+      finish_tfind_command (tfind_number, frameno, 0, 0, from_tty);
     }
   else
     error (_("Trace can only be run on remote targets."));
@@ -2080,18 +3007,17 @@ static void
 trace_find_pc_command (char *args, int from_tty)
 {
   CORE_ADDR pc;
-  char tmp[40];
 
-  if (target_is_remote ())
+  /* APPLE LOCAL trace file  */
+  if (trace_buffer_target_p ())
     {
       if (args == 0 || *args == 0)
 	pc = read_pc ();	/* default is current pc */
       else
 	pc = parse_and_eval_address (args);
 
-      sprintf_vma (tmp, pc);
-      sprintf (target_buf, "QTFrame:pc:%s", tmp);
-      finish_tfind_command (target_buf, sizeof (target_buf), from_tty);
+      /* APPLE LOCAL trace file  */
+      finish_tfind_command (tfind_pc, 0, pc, 0, from_tty);
     }
   else
     error (_("Trace can only be run on remote targets."));
@@ -2103,7 +3029,8 @@ trace_find_tracepoint_command (char *args, int from_tty)
 {
   int tdp;
 
-  if (target_is_remote ())
+  /* APPLE LOCAL trace file  */
+  if (trace_buffer_target_p ())
     {
       if (args == 0 || *args == 0)
 	{
@@ -2115,8 +3042,8 @@ trace_find_tracepoint_command (char *args, int from_tty)
       else
 	tdp = parse_and_eval_long (args);
 
-      sprintf (target_buf, "QTFrame:tdp:%x", tdp);
-      finish_tfind_command (target_buf, sizeof (target_buf), from_tty);
+      /* APPLE LOCAL trace file  */
+      finish_tfind_command (tfind_tp, tdp, 0, 0, from_tty);
     }
   else
     error (_("Trace can only be run on remote targets."));
@@ -2137,9 +3064,9 @@ trace_find_line_command (char *args, int from_tty)
   struct symtabs_and_lines sals;
   struct symtab_and_line sal;
   struct cleanup *old_chain;
-  char   startpc_str[40], endpc_str[40];
 
-  if (target_is_remote ())
+  /* APPLE LOCAL trace file  */
+  if (trace_buffer_target_p ())
     {
       if (args == 0 || *args == 0)
 	{
@@ -2204,18 +3131,15 @@ trace_find_line_command (char *args, int from_tty)
 	error (_("Line number %d is out of range for \"%s\"."),
 	       sal.line, sal.symtab->filename);
 
-      sprintf_vma (startpc_str, start_pc);
-      sprintf_vma (endpc_str, end_pc - 1);
+      /* APPLE LOCAL trace file  */
       /* Find within range of stated line.  */
       if (args && *args)
-	sprintf (target_buf, "QTFrame:range:%s:%s", 
-		 startpc_str, endpc_str);
+	finish_tfind_command (tfind_range, 0, start_pc, end_pc - 1,
+			      from_tty);
       /* Find OUTSIDE OF range of CURRENT line.  */
       else
-	sprintf (target_buf, "QTFrame:outside:%s:%s", 
-		 startpc_str, endpc_str);
-      finish_tfind_command (target_buf, sizeof (target_buf), 
-			    from_tty);
+	finish_tfind_command (tfind_outside, 0, start_pc, end_pc - 1,
+			      from_tty);
       do_cleanups (old_chain);
     }
   else
@@ -2227,10 +3151,10 @@ static void
 trace_find_range_command (char *args, int from_tty)
 {
   static CORE_ADDR start, stop;
-  char start_str[40], stop_str[40];
   char *tmp;
 
-  if (target_is_remote ())
+  /* APPLE LOCAL trace file  */
+  if (trace_buffer_target_p ())
     {
       if (args == 0 || *args == 0)
 	{ /* XXX FIXME: what should default behavior be?  */
@@ -2252,10 +3176,8 @@ trace_find_range_command (char *args, int from_tty)
 	  stop = start + 1;	/* ??? */
 	}
 
-      sprintf_vma (start_str, start);
-      sprintf_vma (stop_str, stop);
-      sprintf (target_buf, "QTFrame:range:%s:%s", start_str, stop_str);
-      finish_tfind_command (target_buf, sizeof (target_buf), from_tty);
+      /* APPLE LOCAL trace file  */
+      finish_tfind_command (tfind_range, 0, start, stop, from_tty);
     }
   else
     error (_("Trace can only be run on remote targets."));
@@ -2266,10 +3188,10 @@ static void
 trace_find_outside_command (char *args, int from_tty)
 {
   CORE_ADDR start, stop;
-  char start_str[40], stop_str[40];
   char *tmp;
 
-  if (target_is_remote ())
+  /* APPLE LOCAL trace file  */
+  if (trace_buffer_target_p ())
     {
       if (args == 0 || *args == 0)
 	{ /* XXX FIXME: what should default behavior be? */
@@ -2291,10 +3213,8 @@ trace_find_outside_command (char *args, int from_tty)
 	  stop = start + 1;	/* ??? */
 	}
 
-      sprintf_vma (start_str, start);
-      sprintf_vma (stop_str, stop);
-      sprintf (target_buf, "QTFrame:outside:%s:%s", start_str, stop_str);
-      finish_tfind_command (target_buf, sizeof (target_buf), from_tty);
+      /* APPLE LOCAL trace file  */
+      finish_tfind_command (tfind_outside, 0, start, stop, from_tty);
     }
   else
     error (_("Trace can only be run on remote targets."));
@@ -2328,13 +3248,16 @@ tracepoint_save_command (char *args, int from_tty)
   
   ALL_TRACEPOINTS (tp)
   {
+    /* APPLE LOCAL begin fast tracepoints  */
     if (tp->addr_string)
-      fprintf (fp, "trace %s\n", tp->addr_string);
+      fprintf (fp, "%s %s\n", tp->fast_p ? "ftrace" : "trace",
+	       tp->addr_string);
     else
       {
 	sprintf_vma (tmp, tp->address);
-	fprintf (fp, "trace *0x%s\n", tmp);
+	fprintf (fp, "%s *0x%s\n", tp->fast_p ? "ftrace" : "trace", tmp);
       }
+    /* APPLE LOCAL end fast tracepoints  */
 
     if (tp->pass_count)
       fprintf (fp, "  passcount %d\n", tp->pass_count);
@@ -2547,7 +3470,8 @@ trace_dump_command (char *args, int from_tty)
   int stepping_actions = 0;
   int stepping_frame = 0;
 
-  if (!target_is_remote ())
+  /* APPLE LOCAL trace file  */
+  if (!trace_buffer_target_p ())
     {
       error (_("Trace can only be run on remote targets."));
       return;
@@ -2674,6 +3598,37 @@ mem2hex (gdb_byte *mem, char *buf, int count)
   return buf;
 }
 
+/* APPLE LOCAL begin trace file  */
+static int
+fromhex (int a)
+{
+  if (a >= '0' && a <= '9')
+    return a - '0';
+  else if (a >= 'a' && a <= 'f')
+    return a - 'a' + 10;
+  else if (a >= 'A' && a <= 'F')
+    return a - 'A' + 10;
+  else
+    error (_("Reply contains invalid hex digit %d"), a);
+}
+
+/* Convert the hex digits at BUF into at most COUNT bytes at MEM.
+   Return the number of bytes converted.  */
+
+static int
+hex2mem (char *buf, gdb_byte *mem, int count)
+{
+  int i;
+
+  for (i = 0; i < count && isxdigit (buf[0]) && isxdigit (buf[1]); i++)
+    {
+      mem[i] = (fromhex (buf[0]) << 4) | fromhex (buf[1]);
+      buf += 2;
+    }
+  return i;
+}
+/* APPLE LOCAL end trace file  */
+
 int
 get_traceframe_number (void)
 {
@@ -2746,6 +3701,17 @@ Use the 'source' command in another debug session to restore them."));
   add_com ("tdump", class_trace, trace_dump_command,
 	   _("Print everything collected at the current tracepoint."));
 
+  /* APPLE LOCAL begin trace file  */
+  c = add_com ("tsave", class_trace, trace_save_command, _("\
+Save the target's trace buffer in a file.\n\
+Use \"target tfile\" in another debug session to look at the trace\n\
+frames in it with tfind and tdump."));
+  set_cmd_completer (c, filename_completer);
+
+  init_tfile_ops ();
+  add_target (&tfile_ops);
+  /* APPLE LOCAL end trace file  */
+
   add_prefix_cmd ("tfind", class_trace, trace_find_command, _("\
 Select a trace frame;\n\
 No argument means forward by one frame; '-' means backward by one frame."),
@@ -2866,6 +3832,15 @@ If an address is specified, trace at that exact address.\n\n\
 Do \"help tracepoints\" for info on other tracepoint commands."));
   set_cmd_completer (c, location_completer);
 
+  /* APPLE LOCAL begin fast tracepoints  */
+  c = add_com ("ftrace", class_trace, ftrace_command, _("\
+Set a fast tracepoint at a specified line or function or address.\n\
+Like \"trace\", but asks the target to collect the data from a jump\n\
+to code it runs in the program, rather than trapping into the stub.\n\
+The instruction at the location must be at least as long as the jump."));
+  set_cmd_completer (c, location_completer);
+  /* APPLE LOCAL end fast tracepoints  */
+
   add_com_alias ("tp", "trace", class_alias, 0);
   add_com_alias ("tr", "trace", class_alias, 1);
   add_com_alias ("tra", "trace", class_alias, 1);
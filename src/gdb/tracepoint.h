@@ -96,6 +96,14 @@ struct tracepoint
     /* BFD section, in case of overlays: no, I don't know if
        tracepoints are really gonna work with overlays.  */
     asection *section;
+
+    /* APPLE LOCAL begin fast tracepoints  */
+    /* Non-zero if the stub should collect this tracepoint from a jump
+       pad in the inferior instead of a trap, and the length of the
+       instruction the jump replaces.  */
+    int fast_p;
+    int fast_insn_len;
+    /* APPLE LOCAL end fast tracepoints  */
   };
 
 enum actionline_type
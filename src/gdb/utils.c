@@ -2326,6 +2326,36 @@ fputs_maybe_filtered (const char *linebuffer, struct ui_file *stream,
       return;
     }
 
+  /* APPLE LOCAL begin bulk output  */
+  /* If we will never stop for a new page and no wrap point is pending,
+     the loop below would pass every character straight through, so
+     write the whole buffer at once and just keep the counts up to
+     date.  This is the usual case when the output is a pipe or a file
+     and only the width is set.  A wrap point can't become pending part
+     way through, since that takes a call to wrap_here.  */
+  if (lines_per_page == UINT_MAX && wrap_column == 0)
+    {
+      fputs_unfiltered (linebuffer, stream);
+      for (lineptr = linebuffer; *lineptr; lineptr++)
+	{
+	  if (*lineptr == '\n')
+	    chars_printed = 0;
+	  else
+	    {
+	      if (*lineptr == '\t')
+		chars_printed = ((chars_printed >> 3) + 1) << 3;
+	      else
+		chars_printed++;
+	      if (chars_printed < chars_per_line)
+		continue;
+	      chars_printed = 0;
+	    }
+	  lines_printed++;
+	}
+      return;
+    }
+  /* APPLE LOCAL end bulk output  */
+
   /* Go through and output each character.  Show line extension
      when this is necessary; prompt user for new page when this is
      necessary.  */
@@ -3929,7 +3959,6 @@ void
 unlimit_file_rlimit ()
 {
   struct rlimit limit;
-  rlim_t reserve;
   int ret;
 
   getrlimit (RLIMIT_NOFILE, &limit);
@@ -3943,25 +3972,12 @@ unlimit_file_rlimit ()
       limit.rlim_cur = 10000;
       ret = setrlimit (RLIMIT_NOFILE, &limit);
     }
-  /* rlim_max is set to RLIM_INFINITY on X, at least on Leopard &
-     SnowLeopard.  so it's better to see what we really got and use
-     cur, not max below...  */ 
-  getrlimit (RLIMIT_NOFILE, &limit);
-
-  /* Reserve 10% of file descriptors for non-BFD uses, or 5, whichever
-     is greater.  Allocate at least one file descriptor for use by
-     BFD. */
-
-  reserve = limit.rlim_cur * 0.1;
-  reserve = (reserve > 5) ? reserve : 5;
-  if (reserve >= limit.rlim_cur)
-    {
-      bfd_set_cache_max_open (1);
-    }
-  else
-    {
-      bfd_set_cache_max_open (limit.rlim_cur - reserve);
-    }
+  /* APPLE LOCAL begin bfd cache  */
+  /* Have BFD size its file cache from what we really got; it reserves
+     a tenth of the descriptors for everything else and gives more
+     back if it finds it has run out.  */
+  bfd_set_cache_max_open (0);
+  /* APPLE LOCAL end bfd cache  */
 }
 
 // Not even a little bit thread safe
@@ -4010,15 +4026,39 @@ re_comp (const char *str)
 
 int
 re_exec (const char *str)
+{
+  return re_exec_buf (&rebuf, str);
+}
+
+/* APPLE LOCAL begin shared regex buffers  */
+/* Like re_comp, but compile STR into BUF instead of the one buffer
+   re_exec uses.  Returns NULL on success, in which case BUF must be
+   regfree'd, and a message otherwise.  */
+
+const char *
+re_comp_buf (regex_t *buf, const char *str)
+{
+  if (regcomp (buf, str, regex_fmt) != 0)
+    return "re_comp failed on given pattern";
+  return NULL;
+}
+
+/* Like re_exec, but match against BUF, compiled by re_comp_buf.
+   Matching doesn't change BUF, so several threads can use one
+   buffer at once.  */
+
+int
+re_exec_buf (const regex_t *buf, const char *str)
 {
   regmatch_t matches[10];
   memset (matches, 0, sizeof (regmatch_t) * 10);
-  if (regexec (&rebuf, str, 10, matches, 0) != 0)
+  if (regexec (buf, str, 10, matches, 0) != 0)
     return 0;
   if (matches[0].rm_so == matches[0].rm_eo)
     return 0;
   return 1;
 }
+/* APPLE LOCAL end shared regex buffers  */
 
 /* Some people use re_search() as a simpler way to call regexec() without
    really needing the "find a match, now find the next match, etc" behavior
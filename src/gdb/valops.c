@@ -47,6 +47,8 @@
 #include "gdb_assert.h"
 #include "cp-support.h"
 #include "observer.h"
+/* APPLE LOCAL overload resolution cache  */
+#include "objfiles.h"
 
 extern int overload_debug;
 /* Local functions.  */
@@ -2003,6 +2005,167 @@ value_find_oload_method_list (struct value **argp, char *method, int offset,
   return find_method_list (argp, method, 0, t, num_fns, basetype, boffset);
 }
 
+/* APPLE LOCAL begin overload resolution cache  */
+/* Conditional breakpoints and displays evaluate the same overloaded
+   calls and operators over and over, and find_overload_match used to
+   rank every candidate again each time.  The ranking only depends on
+   the candidates and the argument types - never on the inferior's
+   state - so remember its outcome here.
+
+   For methods the candidates are identified by the method list found
+   in the object's type.  For functions they are the overloads of FSYM
+   visible from the selected block, which is part of the key because
+   make_symbol_overload_list searches out from it.
+
+   The set of symbols only changes when an objfile is added or
+   re-read, which bumps symbol_generation, so entries from an older
+   generation are treated as empty.  The whole table is also dropped
+   when an objfile whose types or symbols it mentions is freed.  */
+
+#define OLOAD_CACHE_SIZE 64
+
+struct oload_cache_entry
+{
+  /* The value of symbol_generation when this entry was stored, or
+     zero if the slot is empty.  */
+  unsigned int generation;
+
+  /* The method list searched, or the function symbol whose overloads
+     were.  */
+  const void *candidates;
+  const struct block *block;
+
+  int nargs;
+  struct type **arg_types;
+
+  /* The index of the champion among the methods, or its symbol.  */
+  int champ;
+  struct symbol *sym;
+  enum oload_classification quality;
+};
+
+static struct oload_cache_entry oload_cache[OLOAD_CACHE_SIZE];
+
+static const struct objfile_data *oload_cache_objfile_data;
+
+static int oload_cache_enabled = 1;
+
+static void
+show_oload_cache_enabled (struct ui_file *file, int from_tty,
+			  struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Caching of C++ overload resolution results is %s.\n"),
+		    value);
+}
+
+static void
+oload_cache_flush (void)
+{
+  int i;
+
+  for (i = 0; i < OLOAD_CACHE_SIZE; i++)
+    oload_cache[i].generation = 0;
+}
+
+static void
+oload_cache_objfile_freed (struct objfile *objfile, void *data)
+{
+  oload_cache_flush ();
+}
+
+/* Make sure the cache is flushed if OBJFILE goes away.  */
+
+static void
+oload_cache_note_objfile (struct objfile *objfile)
+{
+  if (objfile != NULL
+      && objfile_data (objfile, oload_cache_objfile_data) == NULL)
+    set_objfile_data (objfile, oload_cache_objfile_data, oload_cache);
+}
+
+static struct oload_cache_entry *
+oload_cache_slot (const void *candidates, const struct block *block,
+		  struct type **arg_types, int nargs)
+{
+  unsigned long hash;
+  int i;
+
+  hash = (unsigned long) candidates ^ ((unsigned long) block >> 3);
+  for (i = 0; i < nargs; i++)
+    hash = hash * 31 + ((unsigned long) arg_types[i] >> 3);
+  hash ^= hash >> 11;
+  return &oload_cache[hash % OLOAD_CACHE_SIZE];
+}
+
+/* If the overload resolution of ARG_TYPES against CANDIDATES from
+   BLOCK has been stored, set *CHAMP, *SYM and *QUALITY from it and
+   return 1.  Otherwise return 0.  */
+
+static int
+oload_cache_lookup (const void *candidates, const struct block *block,
+		    struct type **arg_types, int nargs, int *champ,
+		    struct symbol **sym, enum oload_classification *quality)
+{
+  struct oload_cache_entry *entry;
+
+  if (!oload_cache_enabled)
+    return 0;
+
+  entry = oload_cache_slot (candidates, block, arg_types, nargs);
+  if (entry->generation != (unsigned int) symbol_generation
+      || entry->candidates != candidates || entry->block != block
+      || entry->nargs != nargs
+      || memcmp (entry->arg_types, arg_types,
+		 nargs * sizeof (struct type *)) != 0)
+    return 0;
+
+  *champ = entry->champ;
+  *sym = entry->sym;
+  *quality = entry->quality;
+  return 1;
+}
+
+/* Remember CHAMP, SYM and QUALITY as the outcome of resolving
+   ARG_TYPES against CANDIDATES from BLOCK.  OWNER is the objfile the
+   candidates' types belong to.  */
+
+static void
+oload_cache_store (const void *candidates, const struct block *block,
+		   struct objfile *owner, struct type **arg_types, int nargs,
+		   int champ, struct symbol *sym,
+		   enum oload_classification quality)
+{
+  struct oload_cache_entry *entry;
+  int i;
+
+  if (!oload_cache_enabled)
+    return;
+
+  oload_cache_note_objfile (owner);
+  for (i = 0; i < nargs; i++)
+    if (arg_types[i] != NULL)
+      oload_cache_note_objfile (TYPE_OBJFILE (arg_types[i]));
+  if (sym != NULL && SYMBOL_TYPE (sym) != NULL)
+    oload_cache_note_objfile (TYPE_OBJFILE (SYMBOL_TYPE (sym)));
+
+  entry = oload_cache_slot (candidates, block, arg_types, nargs);
+  if (entry->nargs != nargs || entry->arg_types == NULL)
+    {
+      entry->arg_types = xrealloc (entry->arg_types,
+				   (nargs + 1) * sizeof (struct type *));
+      entry->nargs = nargs;
+    }
+  memcpy (entry->arg_types, arg_types, nargs * sizeof (struct type *));
+  entry->candidates = candidates;
+  entry->block = block;
+  entry->champ = champ;
+  entry->sym = sym;
+  entry->quality = quality;
+  entry->generation = symbol_generation;
+}
+/* APPLE LOCAL end overload resolution cache  */
+
 /* Given an array of argument types (ARGTYPES) (which includes an
    entry for "this" in the case of C++ methods), the number of
    arguments NARGS, the NAME of a function whether it's a method or
@@ -2053,6 +2216,10 @@ find_overload_match (struct type **arg_types, int nargs, char *name, int method,
   const char *obj_type_name = NULL;
   char *func_name = NULL;
   enum oload_classification match_quality;
+  /* APPLE LOCAL begin overload resolution cache  */
+  struct symbol *oload_sym = NULL;
+  struct block *block;
+  /* APPLE LOCAL end overload resolution cache  */
 
   /* Get the list of overloaded methods or functions */
   if (method)
@@ -2104,8 +2271,26 @@ find_overload_match (struct type **arg_types, int nargs, char *name, int method,
 	 been resolved by find_method_list via value_find_oload_method_list
 	 above.  */
       gdb_assert (TYPE_DOMAIN_TYPE (fns_ptr[0].type) != NULL);
-      oload_champ = find_oload_champ (arg_types, nargs, method, num_fns,
-				      fns_ptr, oload_syms, &oload_champ_bv);
+      /* APPLE LOCAL begin overload resolution cache  */
+      if (!oload_cache_lookup (fns_ptr, NULL, arg_types, nargs,
+			       &oload_champ, &oload_sym, &match_quality))
+	{
+	  oload_champ = find_oload_champ (arg_types, nargs, method, num_fns,
+					  fns_ptr, oload_syms,
+					  &oload_champ_bv);
+	  old_cleanups = make_cleanup (xfree, oload_champ_bv);
+
+	  /* Check how bad the best match is.  */
+	  match_quality
+	    = classify_oload_match (oload_champ_bv, nargs,
+				    oload_method_static (method, fns_ptr,
+							 oload_champ));
+	  oload_cache_store (fns_ptr, NULL,
+			     TYPE_OBJFILE (TYPE_DOMAIN_TYPE (fns_ptr[0].type)),
+			     arg_types, nargs, oload_champ, NULL,
+			     match_quality);
+	}
+      /* APPLE LOCAL end overload resolution cache  */
     }
   else
     {
@@ -2121,23 +2306,32 @@ find_overload_match (struct type **arg_types, int nargs, char *name, int method,
         }
 
       old_cleanups = make_cleanup (xfree, func_name);
-      make_cleanup (xfree, oload_syms);
-      make_cleanup (xfree, oload_champ_bv);
 
-      oload_champ = find_oload_champ_namespace (arg_types, nargs,
-						func_name,
-						qualified_name,
-						&oload_syms,
-						&oload_champ_bv);
+      /* APPLE LOCAL begin overload resolution cache  */
+      block = get_selected_block (0);
+      if (!oload_cache_lookup (fsym, block, arg_types, nargs,
+			       &oload_champ, &oload_sym, &match_quality))
+	{
+	  oload_champ = find_oload_champ_namespace (arg_types, nargs,
+						    func_name,
+						    qualified_name,
+						    &oload_syms,
+						    &oload_champ_bv);
+	  make_cleanup (xfree, oload_syms);
+	  make_cleanup (xfree, oload_champ_bv);
+
+	  /* Check how bad the best match is.  */
+	  match_quality = classify_oload_match (oload_champ_bv, nargs, 0);
+	  oload_sym = oload_syms[oload_champ];
+	  oload_cache_store (fsym, block,
+			     (SYMBOL_TYPE (fsym) != NULL
+			      ? TYPE_OBJFILE (SYMBOL_TYPE (fsym)) : NULL),
+			     arg_types, nargs, oload_champ, oload_sym,
+			     match_quality);
+	}
+      /* APPLE LOCAL end overload resolution cache  */
     }
 
-  /* Check how bad the best match is.  */
-
-  match_quality
-    = classify_oload_match (oload_champ_bv, nargs,
-			    oload_method_static (method, fns_ptr,
-						 oload_champ));
-
   if (match_quality == INCOMPATIBLE)
     {
       if (method)
@@ -2172,7 +2366,8 @@ find_overload_match (struct type **arg_types, int nargs, char *name, int method,
     }
   else
     {
-      *symp = oload_syms[oload_champ];
+      /* APPLE LOCAL overload resolution cache  */
+      *symp = oload_sym;
     }
 
   if (objp)
@@ -3270,4 +3465,20 @@ Show overload resolution in evaluating C++ functions."), NULL,
 			   show_overload_resolution,
 			   &setlist, &showlist);
   overload_resolution = 1;
+
+  /* APPLE LOCAL begin overload resolution cache  */
+  oload_cache_objfile_data
+    = register_objfile_data_with_cleanup (oload_cache_objfile_freed);
+
+  add_setshow_boolean_cmd ("overload-resolution-cache", class_maintenance,
+			   &oload_cache_enabled, _("\
+Set whether C++ overload resolution results are remembered."), _("\
+Show whether C++ overload resolution results are remembered."), _("\
+When on, the overloaded function or method chosen for a call is\n\
+remembered along with the argument types it was chosen for, and reused\n\
+the next time the same call is evaluated until the symbols change."),
+			   NULL, show_oload_cache_enabled,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end overload resolution cache  */
 }
@@ -34,6 +34,8 @@
 #include "valprint.h"
 #include "floatformat.h"
 #include "doublest.h"
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
 
 #include <errno.h>
 /* APPLE LOCAL: for isprint() */
@@ -171,6 +173,235 @@ show_addressprint (struct ui_file *file, int from_tty,
 }
 
 
+/* APPLE LOCAL begin print prefetch  */
+/* The aggregate being printed is already in GDB's memory by the time
+   val_print sees it, but every char pointer in it sends
+   val_print_string back to the target, a few bytes at a time.  When
+   print_prefetch is on, the outermost val_print first collects the
+   char pointers anywhere in the value, and reads the start of all the
+   strings they point to in as few target reads as it can, merging
+   strings that lie close together.  partial_memory_read then serves
+   the string reads from those blocks.  */
+
+static int print_prefetch = 0;
+
+static void
+show_print_prefetch (struct ui_file *file, int from_tty,
+		     struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Prefetching of the strings a printed value points to is %s.\n"), value);
+}
+
+/* How many bytes of each string to prefetch.  */
+#define PRINT_PREFETCH_STRING 64
+
+/* Strings closer together than this are read with a single read.  */
+#define PRINT_PREFETCH_GAP 256
+
+/* No single prefetch block grows beyond this many bytes.  */
+#define PRINT_PREFETCH_MAX_BLOCK 16384
+
+/* Most string pointers collected from a single value.  */
+#define PRINT_PREFETCH_MAX_STRINGS 1024
+
+struct print_prefetch_block
+{
+  CORE_ADDR addr;
+  int len;
+  gdb_byte *data;
+  struct print_prefetch_block *next;
+};
+
+/* Nonzero while the outermost val_print has prefetched blocks.  */
+static int print_prefetch_active;
+
+static struct print_prefetch_block *print_prefetch_blocks;
+
+/* The value of target_stop_generation when the blocks were read.
+   Printing can run the inferior, e.g. for "print-object"; if it has,
+   the blocks are ignored.  */
+static unsigned int print_prefetch_generation;
+
+/* Add the address of every string c_val_print would print from the
+   object of type TYPE at VALADDR to the NUM entries at *ADDRS, which
+   has room for *SIZE.  */
+
+static void
+print_prefetch_scan (struct type *type, const gdb_byte *valaddr,
+		     CORE_ADDR **addrs, int *num, int *size)
+{
+  struct type *elttype;
+  CORE_ADDR addr;
+  int eltlen;
+  int i;
+
+  type = check_typedef (type);
+  switch (TYPE_CODE (type))
+    {
+    case TYPE_CODE_PTR:
+      elttype = check_typedef (TYPE_TARGET_TYPE (type));
+      if (TYPE_LENGTH (elttype) != 1 || TYPE_CODE (elttype) != TYPE_CODE_INT)
+	break;
+      addr = unpack_pointer (type, valaddr);
+      if (addr == 0 || *num >= PRINT_PREFETCH_MAX_STRINGS)
+	break;
+      if (*num == *size)
+	{
+	  *size = *size ? *size * 2 : 16;
+	  *addrs = xrealloc (*addrs, *size * sizeof (CORE_ADDR));
+	}
+      (*addrs)[(*num)++] = addr;
+      break;
+
+    case TYPE_CODE_ARRAY:
+      elttype = check_typedef (TYPE_TARGET_TYPE (type));
+      eltlen = TYPE_LENGTH (elttype);
+      /* Only look inside elements that can hold a pointer.  */
+      if (eltlen == 0
+	  || (TYPE_CODE (elttype) != TYPE_CODE_PTR
+	      && TYPE_CODE (elttype) != TYPE_CODE_ARRAY
+	      && TYPE_CODE (elttype) != TYPE_CODE_STRUCT
+	      && TYPE_CODE (elttype) != TYPE_CODE_UNION))
+	break;
+      /* The printer gives up after print_max elements; so do we.  */
+      for (i = 0;
+	   i < TYPE_LENGTH (type) / eltlen && i < print_max
+	     && *num < PRINT_PREFETCH_MAX_STRINGS;
+	   i++)
+	print_prefetch_scan (elttype, valaddr + i * eltlen, addrs, num, size);
+      break;
+
+    case TYPE_CODE_STRUCT:
+    case TYPE_CODE_UNION:
+      for (i = 0; i < TYPE_NFIELDS (type); i++)
+	{
+	  if (TYPE_FIELD_STATIC (type, i) || TYPE_FIELD_PACKED (type, i))
+	    continue;
+	  /* A virtual base isn't at a fixed offset.  */
+	  if (i < TYPE_N_BASECLASSES (type) && BASETYPE_VIA_VIRTUAL (type, i))
+	    continue;
+	  if (TYPE_FIELD_BITPOS (type, i) / 8
+	      + TYPE_LENGTH (check_typedef (TYPE_FIELD_TYPE (type, i)))
+	      > TYPE_LENGTH (type))
+	    continue;
+	  print_prefetch_scan (TYPE_FIELD_TYPE (type, i),
+			       valaddr + TYPE_FIELD_BITPOS (type, i) / 8,
+			       addrs, num, size);
+	}
+      break;
+
+    default:
+      break;
+    }
+}
+
+static int
+compare_core_addr (const void *a, const void *b)
+{
+  CORE_ADDR x = *(const CORE_ADDR *) a;
+  CORE_ADDR y = *(const CORE_ADDR *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+static void
+print_prefetch_end (void *unused)
+{
+  struct print_prefetch_block *block, *next;
+
+  for (block = print_prefetch_blocks; block != NULL; block = next)
+    {
+      next = block->next;
+      xfree (block->data);
+      xfree (block);
+    }
+  print_prefetch_blocks = NULL;
+  print_prefetch_active = 0;
+}
+
+/* Prefetch the strings the object of type TYPE at VALADDR points to,
+   and return a cleanup that forgets them again.  */
+
+static struct cleanup *
+print_prefetch_begin (struct type *type, const gdb_byte *valaddr)
+{
+  struct cleanup *old_chain;
+  CORE_ADDR *addrs = NULL;
+  int num = 0;
+  int size = 0;
+  int chunk;
+  int i, j;
+
+  print_prefetch_active = 1;
+  print_prefetch_generation = target_stop_generation;
+  old_chain = make_cleanup (print_prefetch_end, NULL);
+
+  print_prefetch_scan (type, valaddr, &addrs, &num, &size);
+  if (num == 0)
+    return old_chain;
+  make_cleanup (xfree, addrs);
+
+  /* One more than print_max, for val_print_string's peek past the
+     last character it prints.  */
+  chunk = PRINT_PREFETCH_STRING;
+  if (print_max < chunk)
+    chunk = print_max + 1;
+
+  qsort (addrs, num, sizeof (CORE_ADDR), compare_core_addr);
+  for (i = 0; i < num; i = j)
+    {
+      struct print_prefetch_block *block;
+      CORE_ADDR end = addrs[i] + chunk;
+
+      for (j = i + 1; j < num; j++)
+	{
+	  if (addrs[j] > end + PRINT_PREFETCH_GAP
+	      || addrs[j] + chunk - addrs[i] > PRINT_PREFETCH_MAX_BLOCK)
+	    break;
+	  if (addrs[j] + chunk > end)
+	    end = addrs[j] + chunk;
+	}
+
+      /* A string near the end of its mapping can make the whole block
+	 unreadable; its strings are then read the usual way.  */
+      block = xmalloc (sizeof (struct print_prefetch_block));
+      block->addr = addrs[i];
+      block->len = end - addrs[i];
+      block->data = xmalloc (block->len);
+      if (target_read_memory (block->addr, block->data, block->len) != 0)
+	{
+	  xfree (block->data);
+	  xfree (block);
+	  continue;
+	}
+      block->next = print_prefetch_blocks;
+      print_prefetch_blocks = block;
+    }
+  return old_chain;
+}
+
+/* If the LEN bytes at MEMADDR were prefetched, copy them to MYADDR
+   and return nonzero.  */
+
+static int
+print_prefetch_lookup (CORE_ADDR memaddr, gdb_byte *myaddr, int len)
+{
+  struct print_prefetch_block *block;
+
+  if (print_prefetch_generation != target_stop_generation)
+    return 0;
+  for (block = print_prefetch_blocks; block != NULL; block = block->next)
+    if (memaddr >= block->addr
+	&& memaddr + len <= block->addr + block->len)
+      {
+	memcpy (myaddr, block->data + (memaddr - block->addr), len);
+	return 1;
+      }
+  return 0;
+}
+/* APPLE LOCAL end print prefetch  */
+
 /* Print data of type TYPE located at VALADDR (within GDB), which came from
    the inferior at address ADDRESS, onto stdio stream STREAM according to
    FORMAT (a letter, or 0 for natural format using TYPE).
@@ -197,6 +428,12 @@ val_print (struct type *type, const gdb_byte *valaddr, int embedded_offset,
 	   int deref_ref, int recurse, enum val_prettyprint pretty)
 {
   struct type *real_type = check_typedef (type);
+  /* APPLE LOCAL gdb stats  */
+  struct gdb_stat_timer timer;
+  int ret;
+  /* APPLE LOCAL print prefetch  */
+  struct cleanup *old_chain;
+
   if (pretty == Val_pretty_default)
     {
       pretty = prettyprint_structs ? Val_prettyprint : Val_no_prettyprint;
@@ -215,8 +452,22 @@ val_print (struct type *type, const gdb_byte *valaddr, int embedded_offset,
       return (0);
     }
 
-  return (LA_VAL_PRINT (type, valaddr, embedded_offset, address,
-			stream, format, deref_ref, recurse, pretty));
+  /* APPLE LOCAL begin print prefetch  */
+  old_chain = make_cleanup (null_cleanup, NULL);
+  if (print_prefetch && !print_prefetch_active && valaddr != NULL
+      && (format == 0 || format == 's'))
+    print_prefetch_begin (real_type, valaddr + embedded_offset);
+  /* APPLE LOCAL end print prefetch  */
+
+  /* APPLE LOCAL begin gdb stats  */
+  gdb_stat_start (GDB_STAT_OUTPUT, &timer);
+  ret = LA_VAL_PRINT (type, valaddr, embedded_offset, address,
+		      stream, format, deref_ref, recurse, pretty);
+  gdb_stat_stop (GDB_STAT_OUTPUT, &timer, 0);
+  /* APPLE LOCAL end gdb stats  */
+  /* APPLE LOCAL print prefetch  */
+  do_cleanups (old_chain);
+  return ret;
 }
 
 /* Check whether the value VAL is printable.  Return 1 if it is;
@@ -1114,6 +1365,15 @@ partial_memory_read (CORE_ADDR memaddr, char *myaddr, int len, int *errnoptr)
   int nread;			/* Number of bytes actually read. */
   int errcode;			/* Error from last read. */
 
+  /* APPLE LOCAL begin print prefetch  */
+  if (print_prefetch_lookup (memaddr, (gdb_byte *) myaddr, len))
+    {
+      if (errnoptr != NULL)
+	*errnoptr = 0;
+      return len;
+    }
+  /* APPLE LOCAL end print prefetch  */
+
   /* First try a complete read. */
   errcode = target_read_memory (memaddr, myaddr, len);
   if (errcode == 0)
@@ -1141,6 +1401,13 @@ partial_memory_read (CORE_ADDR memaddr, char *myaddr, int len, int *errnoptr)
   return (nread);
 }
 
+/* APPLE LOCAL begin chunked string reads  */
+/* The first and largest reads val_print_string makes when looking
+   for the end of a string, in bytes.  */
+#define STRING_READ_MIN_CHUNK 64
+#define STRING_READ_MAX_CHUNK 4096
+/* APPLE LOCAL end chunked string reads  */
+
 /*  Print a string from the inferior, starting at ADDR and printing up to LEN
    characters, of WIDTH bytes a piece, to STREAM.  If LEN is -1, printing
    stops at the first null byte, otherwise printing proceeds (including null
@@ -1182,7 +1449,20 @@ val_print_string (CORE_ADDR addr, int len, int width, struct ui_file *stream)
      minimum of 8 and fetchlimit.  We used to use 200 instead of 8 but
      200 is way too big for remote debugging over a serial line.  */
 
-  chunksize = (len == -1 ? min (8, fetchlimit) : fetchlimit);
+  /* APPLE LOCAL begin chunked string reads  */
+  /* Reading eight characters at a time turns every string into a
+     flood of tiny reads, none of which the memory caches can help
+     with.  Instead read up to the next STRING_READ_MIN_CHUNK boundary
+     first, and double the size of each later read, always ending on a
+     boundary of its own size, up to STRING_READ_MAX_CHUNK.  Short
+     strings still cost one small read, reads never cross a page, and
+     long ones quickly get to page-sized reads.  The chunk size is in
+     characters of WIDTH bytes; FETCHLIMIT still bounds how many are
+     read in all.  */
+
+  chunksize = (len == -1 ? max (STRING_READ_MIN_CHUNK / width, 1)
+	       : fetchlimit);
+  /* APPLE LOCAL end chunked string reads  */
 
   /* Loop until we either have all the characters to print, or we encounter
      some error, such as bumping into the end of the address space. */
@@ -1207,7 +1487,14 @@ val_print_string (CORE_ADDR addr, int len, int width, struct ui_file *stream)
       do
 	{
 	  QUIT;
-	  nfetch = min (chunksize, fetchlimit - bufsize);
+	  /* APPLE LOCAL begin chunked string reads  */
+	  nfetch = (chunksize * width - addr % (chunksize * width)) / width;
+	  if (nfetch == 0)
+	    nfetch = 1;
+	  nfetch = min (nfetch, fetchlimit - bufsize);
+	  if (chunksize * width < STRING_READ_MAX_CHUNK)
+	    chunksize *= 2;
+	  /* APPLE LOCAL end chunked string reads  */
 
 	  if (buffer == NULL)
 	    buffer = (char *) xmalloc (nfetch * width);
@@ -1232,6 +1519,26 @@ val_print_string (CORE_ADDR addr, int len, int width, struct ui_file *stream)
 	     the buffer. */
 
 	  limit = bufptr + nfetch * width;
+	  /* APPLE LOCAL begin chunked string reads  */
+	  if (width == 1)
+	    {
+	      char *nul = memchr (bufptr, 0, limit - bufptr);
+
+	      if (nul != NULL)
+		{
+		  addr += nul + 1 - bufptr;
+		  bufptr = nul + 1;
+		  errcode = 0;
+		  found_nul = 1;
+		}
+	      else
+		{
+		  addr += limit - bufptr;
+		  bufptr = limit;
+		}
+	    }
+	  else
+	  /* APPLE LOCAL end chunked string reads  */
 	  while (bufptr < limit)
 	    {
 	      unsigned long c;
@@ -1556,6 +1863,19 @@ Show the default input and output number radices.\n\
 Use 'show input-radix' or 'show output-radix' to independently show each."),
 	   &showlist);
 
+  /* APPLE LOCAL begin print prefetch  */
+  add_setshow_boolean_cmd ("print-prefetch", class_obscure,
+			   &print_prefetch, _("\
+Set whether strings pointed to by a printed value are read in bulk."), _("\
+Show whether strings pointed to by a printed value are read in bulk."), _("\
+When on, printing a value first reads the beginning of every string its\n\
+char pointers point to, merging the reads of strings that lie close\n\
+together, instead of fetching each string a few bytes at a time.  This\n\
+reads some memory that printing wouldn't otherwise touch."),
+			   NULL, show_print_prefetch,
+			   &setlist, &showlist);
+  /* APPLE LOCAL end print prefetch  */
+
   /* Give people the defaults which they are used to.  */
   prettyprint_structs = 1;
   prettyprint_arrays = 0;
@@ -165,6 +165,11 @@ struct value
   int var_status;
   /* APPLE LOCAL end variable initialized status.  */
 
+  /* APPLE LOCAL value recycling: How many bytes of contents were
+     allocated for this value; at least the length of its enclosing
+     type.  */
+  int contents_room;
+
   /* Actual contents of the value.  For use of this value; setting it
      uses the stuff above.  Not valid if lazy is nonzero.  Target
      byte-order.  We force it to be aligned properly for any possible
@@ -290,6 +295,96 @@ static int value_history_count;	/* Abs number of last entry stored */
 
 static struct value *all_values;
 
+/* APPLE LOCAL begin value recycling  */
+/* Evaluating an expression allocates and frees values by the
+   thousand, almost all of them with a few bytes of contents.  Rather
+   than handing those back to malloc, value_free keeps them on free
+   lists sorted by how much room they have for contents, and
+   allocate_value takes them from there.  Values with more than
+   VALUE_RECYCLE_MAX_CONTENTS bytes are always malloc'd and freed.  */
+
+static int value_recycling = 1;
+
+static void
+show_value_recycling (struct ui_file *file, int from_tty,
+		      struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Recycling of freed values is %s.\n"), value);
+}
+
+#define VALUE_RECYCLE_GRAIN 16
+#define VALUE_RECYCLE_MAX_CONTENTS 256
+#define VALUE_RECYCLE_CLASSES \
+  (VALUE_RECYCLE_MAX_CONTENTS / VALUE_RECYCLE_GRAIN + 1)
+
+/* Most values kept on each free list.  */
+#define VALUE_RECYCLE_LIMIT 1024
+
+/* The free lists, chained through the values' NEXT fields.  Those on
+   list I have exactly I * VALUE_RECYCLE_GRAIN bytes of room.  */
+static struct value *recycled_values[VALUE_RECYCLE_CLASSES];
+static int recycled_value_count[VALUE_RECYCLE_CLASSES];
+
+/* Return a zeroed value with room for at least LENGTH bytes of
+   contents, not yet on any chain.  */
+
+static struct value *
+allocate_value_storage (int length)
+{
+  struct value *val;
+  int class;
+
+  if (length > VALUE_RECYCLE_MAX_CONTENTS)
+    {
+      val = xzalloc (sizeof (struct value) + length);
+      val->contents_room = length;
+      return val;
+    }
+
+  class = (length + VALUE_RECYCLE_GRAIN - 1) / VALUE_RECYCLE_GRAIN;
+  val = recycled_values[class];
+  if (val != NULL)
+    {
+      recycled_values[class] = val->next;
+      recycled_value_count[class]--;
+      memset (val, 0,
+	      sizeof (struct value) + class * VALUE_RECYCLE_GRAIN);
+    }
+  else
+    val = xzalloc (sizeof (struct value) + class * VALUE_RECYCLE_GRAIN);
+  val->contents_room = class * VALUE_RECYCLE_GRAIN;
+  return val;
+}
+
+/* Forget all the values on the free lists.  */
+
+static void
+flush_recycled_values (void)
+{
+  struct value *val, *next;
+  int class;
+
+  for (class = 0; class < VALUE_RECYCLE_CLASSES; class++)
+    {
+      for (val = recycled_values[class]; val != NULL; val = next)
+	{
+	  next = val->next;
+	  xfree (val);
+	}
+      recycled_values[class] = NULL;
+      recycled_value_count[class] = 0;
+    }
+}
+
+static void
+set_value_recycling (char *args, int from_tty, struct cmd_list_element *c)
+{
+  /* Don't leave anything behind for valgrind to puzzle over.  */
+  if (!value_recycling)
+    flush_recycled_values ();
+}
+/* APPLE LOCAL end value recycling  */
+
 /* Allocate a  value  that has the correct length for type TYPE.  */
 
 struct value *
@@ -298,7 +393,8 @@ allocate_value (struct type *type)
   struct value *val;
   struct type *atype = check_typedef (type);
 
-  val = (struct value *) xzalloc (sizeof (struct value) + TYPE_LENGTH (atype));
+  /* APPLE LOCAL value recycling  */
+  val = allocate_value_storage (TYPE_LENGTH (atype));
   val->next = all_values;
   all_values = val;
   val->type = type;
@@ -572,6 +668,26 @@ value_free_to_mark (struct value *mark)
 void
 value_free (struct value *val)
 {
+  /* APPLE LOCAL begin value recycling  */
+  int class;
+
+  if (val == NULL)
+    return;
+
+  if (value_recycling
+      && val->contents_room <= VALUE_RECYCLE_MAX_CONTENTS
+      && val->contents_room % VALUE_RECYCLE_GRAIN == 0)
+    {
+      class = val->contents_room / VALUE_RECYCLE_GRAIN;
+      if (recycled_value_count[class] < VALUE_RECYCLE_LIMIT)
+	{
+	  val->next = recycled_values[class];
+	  recycled_values[class] = val;
+	  recycled_value_count[class]++;
+	  return;
+	}
+    }
+  /* APPLE LOCAL end value recycling  */
   xfree (val);
 }
 
@@ -912,6 +1028,9 @@ clear_internalvars (void)
 {
   struct internalvar *var;
 
+  /* APPLE LOCAL expression cache: Cached parses point at these.  */
+  parsed_expression_cache_flush ();
+
   while (internalvars)
     {
       var = internalvars;
@@ -1273,6 +1392,14 @@ value_change_enclosing_type (struct value *val, struct type *new_encl_type)
       val->enclosing_type = new_encl_type;
       return val;
     }
+  /* APPLE LOCAL begin value recycling  */
+  else if (TYPE_LENGTH (new_encl_type) <= val->contents_room)
+    {
+      /* There's room enough left over from rounding the allocation.  */
+      val->enclosing_type = new_encl_type;
+      return val;
+    }
+  /* APPLE LOCAL end value recycling  */
   else
     {
       struct value *new_val;
@@ -1281,6 +1408,8 @@ value_change_enclosing_type (struct value *val, struct type *new_encl_type)
       new_val = (struct value *) xrealloc (val, sizeof (struct value) + TYPE_LENGTH (new_encl_type));
 
       new_val->enclosing_type = new_encl_type;
+      /* APPLE LOCAL value recycling  */
+      new_val->contents_room = TYPE_LENGTH (new_encl_type);
  
       /* We have to make sure this ends up in the same place in the value
 	 chain as the original copy, so it's clean-up behavior is the same. 
@@ -1772,4 +1901,17 @@ A few convenience variables are given values automatically:\n\
   add_cmd ("values", no_class, show_values,
 	   _("Elements of value history around item number IDX (or last ten)."),
 	   &showlist);
+
+  /* APPLE LOCAL begin value recycling  */
+  add_setshow_boolean_cmd ("value-recycling", class_maintenance,
+			   &value_recycling, _("\
+Set whether freed values are kept for reuse."), _("\
+Show whether freed values are kept for reuse."), _("\
+When on, values freed at the end of a command are kept on free lists\n\
+and handed out again by later evaluations instead of going back to\n\
+malloc.  Turn it off to let a memory checker see every value freed."),
+			   set_value_recycling, show_value_recycling,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+  /* APPLE LOCAL end value recycling  */
 }
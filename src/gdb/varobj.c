@@ -40,6 +40,8 @@
 
 #include "varobj.h"
 #include "parser-defs.h"
+/* APPLE LOCAL gdb stats  */
+#include "gdb-stats.h"
 
 /* Non-zero if we want to see trace of varobj level stuff.  */
 
@@ -50,6 +52,13 @@ int varobjdebug = 0;
 static int varobj_use_dynamic_type = 1;
 /* APPLE LOCAL end */
 
+/* APPLE LOCAL begin incremental varobj update  */
+/* Non-zero if varobj_update should leave alone the children whose
+   parent hasn't changed and whose own memory still holds the same
+   bytes, rather than computing every child afresh.  */
+static int varobj_incremental_update = 0;
+/* APPLE LOCAL end incremental varobj update  */
+
 /* APPLE LOCAL: We use this to lookup from fake child to type index.  */
 static int varobj_get_type_index_from_fake_child (struct varobj *parent, int index);
 static int varobj_value_struct_elt_by_index (struct varobj *parent, int index,
@@ -213,6 +222,18 @@ struct varobj
   /* A list of this object's children */
   struct varobj_child *children;
 
+  /* APPLE LOCAL begin varobj child window  */
+  /* Only the children somebody has asked for are created, so a big
+     array may have a few of its children here and there.  Once there
+     are VAROBJ_CHILD_HASH_MIN of them, CHILD_HASH (of CHILD_HASH_SIZE
+     buckets, chained through the children's CHILD_HASH_NEXT) finds a
+     child by its index without walking CHILDREN.  */
+  int child_count;
+  struct varobj **child_hash;
+  int child_hash_size;
+  struct varobj *child_hash_next;
+  /* APPLE LOCAL end varobj child window  */
+
   /* APPLE LOCAL begin */
   /* Marker that this is a "fake" child - e.g. the Public, Private, Protected
      varobj's for C++ */
@@ -228,6 +249,17 @@ struct varobj
   /* Was this variable updated via a varobj_set_value operation */
   int updated;
 
+  /* APPLE LOCAL begin incremental varobj update  */
+  /* Set by varobj_update if VALUE is known to be exactly what it was
+     before the update, so that children computed from it needn't be
+     computed again.  */
+  int unchanged;
+
+  /* Set by varobj_check_memory if the memory VALUE was read from
+     still holds the same bytes.  */
+  int memory_unchanged;
+  /* APPLE LOCAL end incremental varobj update  */
+
   /* This is the list of the objfiles that were referenced in creating
      the varobj.  */
   struct objfile_hitlist *hitlist;
@@ -307,6 +339,14 @@ static void save_child_in_parent (struct varobj *, struct varobj *);
 
 static void remove_child_from_parent (struct varobj *, struct varobj *);
 
+/* APPLE LOCAL begin varobj child window  */
+#define VAROBJ_CHILD_HASH_MIN 16
+
+static void varobj_child_hash_insert (struct varobj *, struct varobj *);
+
+static void varobj_child_hash_rebuild (struct varobj *);
+/* APPLE LOCAL end varobj child window  */
+
 /* Utility routines */
 
 static struct varobj *new_variable (void);
@@ -327,6 +367,14 @@ static enum varobj_display_formats variable_default_display (struct varobj *);
 
 static int my_value_equal (struct value *, struct value *, int *);
 
+/* APPLE LOCAL begin incremental varobj update  */
+static int varobj_values_identical (struct value *, struct value *);
+
+static void varobj_check_memory (struct varobj *root);
+
+static int varobj_child_reusable (struct varobj *var);
+/* APPLE LOCAL end incremental varobj update  */
+
 static struct varobj_changelist *varobj_changelist_init ();
 
 static void varobj_add_to_changelist(struct varobj_changelist *changelist, 
@@ -360,6 +408,10 @@ static struct value *value_of_root (struct varobj **var_handle, enum varobj_type
 static struct value *value_of_child (struct varobj *parent, int index,
 				     enum varobj_type_change *);
 
+/* APPLE LOCAL gdb stats  */
+static struct value *compute_value_of_child (struct varobj *parent, int index,
+					     enum varobj_type_change *);
+
 static struct type *type_of_child (struct varobj *var);
 
 static int variable_editable (struct varobj *var);
@@ -586,9 +638,16 @@ varobj_evaluate_expression (struct expression *exp, struct value **value)
   struct cleanup *print_closure_cleanup;
   int ret_val;
 
+  /* APPLE LOCAL gdb stats  */
+  struct gdb_stat_timer timer;
+
   print_closure_cleanup = make_cleanup_set_restore_print_closure (0);
 
+  /* APPLE LOCAL gdb stats  */
+  gdb_stat_start (GDB_STAT_VAROBJ_EVAL, &timer);
   ret_val = gdb_evaluate_expression (exp, value);
+  /* APPLE LOCAL gdb stats  */
+  gdb_stat_stop (GDB_STAT_VAROBJ_EVAL, &timer, 0);
 
   do_cleanups (print_closure_cleanup);
 
@@ -1313,10 +1372,24 @@ varobj_get_num_children (struct varobj *var)
 
 int
 varobj_list_children (struct varobj *var, struct varobj ***childlist)
+{
+  /* APPLE LOCAL varobj child window  */
+  return varobj_list_children_range (var, 0, -1, childlist);
+}
+
+/* APPLE LOCAL begin varobj child window  */
+/* Like varobj_list_children, but only list (and so only create) the
+   children with indices FROM up to but not including TO.  A TO of -1
+   means the last child.  Still returns the total number of children
+   VAR has, so the caller knows how many more there are to ask for.  */
+
+int
+varobj_list_children_range (struct varobj *var, int from, int to,
+			    struct varobj ***childlist)
 {
   struct varobj *child;
   char *name;
-  int i;
+  int i, n;
 
   /* sanity check: have we been passed a pointer? */
   if (childlist == NULL)
@@ -1327,13 +1400,20 @@ varobj_list_children (struct varobj *var, struct varobj ***childlist)
   if (var->num_children == -1)
     var->num_children = number_of_children (var);
 
+  if (to < 0 || to > var->num_children)
+    to = var->num_children;
+  if (from < 0)
+    from = 0;
+  if (from > to)
+    from = to;
+
   /* List of children */
-  *childlist = xmalloc ((var->num_children + 1) * sizeof (struct varobj *));
+  *childlist = xmalloc ((to - from + 1) * sizeof (struct varobj *));
 
-  for (i = 0; i < var->num_children; i++)
+  for (i = from, n = 0; i < to; i++, n++)
     {
       /* Mark as the end in case we bail out */
-      *((*childlist) + i) = NULL;
+      *((*childlist) + n) = NULL;
 
       /* check if child exists, if not create */
       child = child_exists (var, i);
@@ -1343,14 +1423,15 @@ varobj_list_children (struct varobj *var, struct varobj ***childlist)
 	  child = create_child (var, i, name);
 	}
 
-      *((*childlist) + i) = child;
+      *((*childlist) + n) = child;
     }
 
   /* End of list is marked by a NULL pointer */
-  *((*childlist) + i) = NULL;
+  *((*childlist) + n) = NULL;
 
   return var->num_children;
 }
+/* APPLE LOCAL end varobj child window  */
 
 int 
 varobj_is_fake_child (struct varobj *var)
@@ -1694,6 +1775,16 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
       (*varp)->root->in_scope = 1;
     }
 
+  /* APPLE LOCAL begin incremental varobj update  */
+  (*varp)->unchanged = (varobj_incremental_update
+			&& type_changed == VAROBJ_TYPE_UNCHANGED
+			&& !came_in_scope
+			&& !(*varp)->updated
+			&& varobj_values_identical ((*varp)->value, new));
+  if (varobj_incremental_update && type_changed == VAROBJ_TYPE_UNCHANGED)
+    varobj_check_memory (*varp);
+  /* APPLE LOCAL end incremental varobj update  */
+
   /* Now make up the change list */
 
   result = varobj_changelist_init ();
@@ -1746,6 +1837,22 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
   v = vpop (&stack);
   while (v != NULL)
     {
+      /* APPLE LOCAL begin incremental varobj update  */
+      /* If V was computed from a parent that is still the same, and
+	 the memory it was read from is too, it can't have changed.  */
+      if (varobj_incremental_update && !came_in_scope
+	  && v->parent->unchanged && varobj_child_reusable (v))
+	{
+	  struct varobj_child *c;
+
+	  v->unchanged = 1;
+	  for (c = v->children; c != NULL; c = c->next)
+	    vpush (&stack, c->child);
+	  v = vpop (&stack);
+	  continue;
+	}
+      /* APPLE LOCAL end incremental varobj update  */
+
       /* First update the child.  Since the dynamic type
 	 might change, we need to do this BEFORE we push
 	 the children on the stack, since we might need to
@@ -1776,6 +1883,17 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
       /* Its value is going to be updated to NEW.  */
       v->error = error;
 
+      /* APPLE LOCAL begin incremental varobj update  */
+      if (v->fake_child)
+	v->unchanged = (v->parent->unchanged
+			&& child_type_changed == VAROBJ_TYPE_UNCHANGED);
+      else
+	v->unchanged = (varobj_incremental_update
+			&& child_type_changed == VAROBJ_TYPE_UNCHANGED
+			&& !came_in_scope
+			&& varobj_values_identical (v->value, new));
+      /* APPLE LOCAL end incremental varobj update  */
+
       /* We must always keep new values, since children depend on it. */
       if (v->value != NULL)
 	value_free (v->value);
@@ -2025,6 +2143,20 @@ child_exists (struct varobj *var, int index)
 {
   struct varobj_child *vc;
 
+  /* APPLE LOCAL begin varobj child window  */
+  if (var->child_hash != NULL)
+    {
+      struct varobj *child;
+
+      child = var->child_hash[(unsigned int) index
+			      & (var->child_hash_size - 1)];
+      for (; child != NULL; child = child->child_hash_next)
+	if (child->index == index)
+	  return child;
+      return NULL;
+    }
+  /* APPLE LOCAL end varobj child window  */
+
   for (vc = var->children; vc != NULL; vc = vc->next)
     {
       /* APPLE LOCAL */
@@ -2144,6 +2276,15 @@ save_child_in_parent (struct varobj *parent, struct varobj *child)
 
   parent->children->next = vc;
   parent->children->child = child;
+
+  /* APPLE LOCAL begin varobj child window  */
+  parent->child_count++;
+  if (parent->child_hash != NULL
+      && parent->child_count <= 2 * parent->child_hash_size)
+    varobj_child_hash_insert (parent, child);
+  else if (parent->child_count >= VAROBJ_CHILD_HASH_MIN)
+    varobj_child_hash_rebuild (parent);
+  /* APPLE LOCAL end varobj child window  */
 }
 
 /* FIXME: This should be a generic remove from list */
@@ -2168,7 +2309,56 @@ remove_child_from_parent (struct varobj *parent, struct varobj *child)
   else
     prev->next = vc->next;
 
+  /* APPLE LOCAL begin varobj child window  */
+  parent->child_count--;
+  if (parent->child_hash != NULL)
+    {
+      struct varobj **slot;
+
+      slot = &parent->child_hash[(unsigned int) child->index
+				 & (parent->child_hash_size - 1)];
+      for (; *slot != NULL; slot = &(*slot)->child_hash_next)
+	if (*slot == child)
+	  {
+	    *slot = child->child_hash_next;
+	    break;
+	  }
+      child->child_hash_next = NULL;
+    }
+  /* APPLE LOCAL end varobj child window  */
+}
+
+/* APPLE LOCAL begin varobj child window  */
+static void
+varobj_child_hash_insert (struct varobj *parent, struct varobj *child)
+{
+  struct varobj **slot;
+
+  slot = &parent->child_hash[(unsigned int) child->index
+			     & (parent->child_hash_size - 1)];
+  child->child_hash_next = *slot;
+  *slot = child;
 }
+
+/* Make PARENT's child hash big enough for the children it has now,
+   and fill it in from the list of children.  */
+
+static void
+varobj_child_hash_rebuild (struct varobj *parent)
+{
+  struct varobj_child *vc;
+  int size = parent->child_hash_size ? parent->child_hash_size : 32;
+
+  while (size < parent->child_count)
+    size *= 2;
+
+  xfree (parent->child_hash);
+  parent->child_hash = xcalloc (size, sizeof (struct varobj *));
+  parent->child_hash_size = size;
+  for (vc = parent->children; vc != NULL; vc = vc->next)
+    varobj_child_hash_insert (parent, vc->child);
+}
+/* APPLE LOCAL end varobj child window  */
 
 
 /*
@@ -2197,10 +2387,18 @@ new_variable (void)
   var->num_children = -1;
   var->parent = NULL;
   var->children = NULL;
+  /* APPLE LOCAL varobj child window  */
+  var->child_count = 0;
+  var->child_hash = NULL;
+  var->child_hash_size = 0;
+  var->child_hash_next = NULL;
   var->fake_child = 0;
   var->format = 0;
   var->root = NULL;
   var->updated = 0;
+  /* APPLE LOCAL incremental varobj update  */
+  var->unchanged = 0;
+  var->memory_unchanged = 0;
   var->hitlist = NULL;
 
   return var;
@@ -2240,6 +2438,8 @@ free_variable (struct varobj *var)
   xfree (var->path_expr);
   xfree (var->obj_name);
   xfree (var->dynamic_type_name);
+  /* APPLE LOCAL varobj child window  */
+  xfree (var->child_hash);
   if (var->value != NULL)
     value_free (var->value);
   if (var->hitlist != NULL)
@@ -2456,6 +2656,229 @@ my_value_equal (struct value *val1, struct value *volatile val2, int *error2)
   return r;
 }
 
+/* APPLE LOCAL begin incremental varobj update  */
+/* Return non-zero if VAL1 and VAL2 are the same bytes of the same type
+   from the same place, so that anything computed from one would come
+   out the same computed from the other.  */
+
+static int
+varobj_values_identical (struct value *val1, struct value *val2)
+{
+  struct type *type;
+
+  if (val1 == NULL || val2 == NULL
+      || value_lazy (val1) || value_lazy (val2))
+    return 0;
+
+  if (value_type (val1) != value_type (val2)
+      || value_enclosing_type (val1) != value_enclosing_type (val2)
+      || value_embedded_offset (val1) != value_embedded_offset (val2)
+      || VALUE_LVAL (val1) != VALUE_LVAL (val2)
+      || value_bitsize (val1) != value_bitsize (val2)
+      || value_bitpos (val1) != value_bitpos (val2))
+    return 0;
+
+  if (VALUE_LVAL (val1) == lval_memory
+      && (VALUE_ADDRESS (val1) + value_offset (val1)
+	  != VALUE_ADDRESS (val2) + value_offset (val2)))
+    return 0;
+
+  type = value_enclosing_type (val1);
+  return memcmp (value_contents_all (val1), value_contents_all (val2),
+		 TYPE_LENGTH (type)) == 0;
+}
+
+/* Values bigger than this aren't worth comparing with memory.  */
+#define VAROBJ_MEMORY_CHECK_MAX 65536
+
+/* Memory reads no further apart than this on the same page are done
+   as one.  */
+#define VAROBJ_MEMORY_READ_GAP 64
+#define VAROBJ_MEMORY_PAGE_SIZE 4096
+
+struct varobj_memory_range
+{
+  struct varobj *var;
+  CORE_ADDR addr;
+  int len;
+};
+
+/* If VAR's value was read straight from memory, return non-zero and
+   store where in *ADDR and *LEN.  */
+
+static int
+varobj_value_memory (struct varobj *var, CORE_ADDR *addr, int *len)
+{
+  struct value *val = var->value;
+
+  if (val == NULL || value_lazy (val)
+      || VALUE_LVAL (val) != lval_memory
+      || value_bitsize (val) != 0)
+    return 0;
+
+  *addr = VALUE_ADDRESS (val) + value_offset (val);
+  *len = TYPE_LENGTH (value_enclosing_type (val));
+  return *len > 0 && *len <= VAROBJ_MEMORY_CHECK_MAX;
+}
+
+static void
+varobj_collect_memory (struct varobj *var,
+		       struct varobj_memory_range **ranges,
+		       int *count, int *size)
+{
+  struct varobj_child *c;
+
+  for (c = var->children; c != NULL; c = c->next)
+    {
+      struct varobj *child = c->child;
+      CORE_ADDR addr;
+      int len;
+
+      child->memory_unchanged = 0;
+      if (varobj_value_memory (child, &addr, &len))
+	{
+	  if (*count == *size)
+	    {
+	      *size = *size ? *size * 2 : 64;
+	      *ranges = xrealloc (*ranges, *size * sizeof (**ranges));
+	    }
+	  (*ranges)[*count].var = child;
+	  (*ranges)[*count].addr = addr;
+	  (*ranges)[*count].len = len;
+	  (*count)++;
+	}
+      varobj_collect_memory (child, ranges, count, size);
+    }
+}
+
+static int
+varobj_compare_memory_ranges (const void *a, const void *b)
+{
+  const struct varobj_memory_range *ra = a;
+  const struct varobj_memory_range *rb = b;
+
+  if (ra->addr < rb->addr)
+    return -1;
+  return ra->addr > rb->addr;
+}
+
+/* Set memory_unchanged on each descendant of ROOT whose value was read
+   from memory that still holds the same bytes.  The memory of the
+   whole tree is read back in as few target reads as we can manage,
+   rather than one per varobj, and those reads go to the target as a
+   single batch.  */
+
+static void
+varobj_check_memory (struct varobj *root)
+{
+  struct varobj_memory_range *ranges = NULL;
+  struct target_memory_range *spans;
+  int *span_first;
+  int count = 0, size = 0;
+  int nspans = 0;
+  gdb_byte *buf;
+  int buf_size = 0;
+  int i, j, s;
+
+  varobj_collect_memory (root, &ranges, &count, &size);
+  if (count == 0)
+    return;
+
+  qsort (ranges, count, sizeof (ranges[0]), varobj_compare_memory_ranges);
+
+  /* There are never more spans than ranges.  SPAN_FIRST[S] is the
+     first range covered by span S; the last is the one before
+     SPAN_FIRST[S + 1].  */
+  spans = xmalloc (count * sizeof (struct target_memory_range));
+  span_first = xmalloc ((count + 1) * sizeof (int));
+
+  for (i = 0; i < count; i = j)
+    {
+      CORE_ADDR start = ranges[i].addr;
+      CORE_ADDR end = start + ranges[i].len;
+
+      /* Gather every range that overlaps, touches, or lies close by
+	 on the same page as the span so far.  */
+      for (j = i + 1; j < count; j++)
+	{
+	  CORE_ADDR next_end = ranges[j].addr + ranges[j].len;
+
+	  if (ranges[j].addr > end + VAROBJ_MEMORY_READ_GAP)
+	    break;
+	  if (ranges[j].addr > end
+	      && (end - 1) / VAROBJ_MEMORY_PAGE_SIZE
+		 != ranges[j].addr / VAROBJ_MEMORY_PAGE_SIZE)
+	    break;
+	  if (next_end - start > VAROBJ_MEMORY_CHECK_MAX)
+	    break;
+	  if (next_end > end)
+	    end = next_end;
+	}
+
+      spans[nspans].addr = start;
+      spans[nspans].len = end - start;
+      span_first[nspans] = i;
+      buf_size += end - start;
+      nspans++;
+    }
+  span_first[nspans] = count;
+
+  buf = xmalloc (buf_size);
+  for (s = 0, buf_size = 0; s < nspans; s++)
+    {
+      spans[s].buf = buf + buf_size;
+      buf_size += spans[s].len;
+    }
+
+  target_read_memory_ranges (spans, nspans);
+
+  for (s = 0; s < nspans; s++)
+    {
+      if (spans[s].status != 0)
+	continue;
+      for (i = span_first[s]; i < span_first[s + 1]; i++)
+	ranges[i].var->memory_unchanged
+	  = memcmp (spans[s].buf + (ranges[i].addr - spans[s].addr),
+		    value_contents_all (ranges[i].var->value),
+		    ranges[i].len) == 0;
+    }
+
+  xfree (buf);
+  xfree (span_first);
+  xfree (spans);
+  xfree (ranges);
+}
+
+/* Return non-zero if VAR's current value can stand in for the one
+   value_of_child would compute now, given that its parent hasn't
+   changed.  A pointer to a struct is kept out of this when we look
+   up dynamic types, since the type of its children depends on memory
+   the pointer's own bytes don't cover.  */
+
+static int
+varobj_child_reusable (struct varobj *var)
+{
+  struct type *type;
+
+  if (!var->memory_unchanged || var->updated || var->fake_child
+      || var->error)
+    return 0;
+
+  type = check_typedef (value_type (var->value));
+  if (varobj_use_dynamic_type
+      && (TYPE_CODE (type) == TYPE_CODE_PTR
+	  || TYPE_CODE (type) == TYPE_CODE_REF))
+    {
+      struct type *target = check_typedef (TYPE_TARGET_TYPE (type));
+
+      if (TYPE_CODE (target) == TYPE_CODE_STRUCT
+	  || TYPE_CODE (target) == TYPE_CODE_UNION)
+	return 0;
+    }
+  return 1;
+}
+/* APPLE LOCAL end incremental varobj update  */
+
 /* Handle the changelist for varobj_update.  This has two data bits for
    each entry, the varobj, and whether its type has changed. */
 
@@ -2948,10 +3371,25 @@ varobj_pc_in_valid_block_p (struct varobj *var)
   return 1;
 }
 
+/* APPLE LOCAL begin gdb stats  */
 /* What is the ``struct value *'' for the INDEX'th child of PARENT? */
 static struct value *
-value_of_child (struct varobj *parent, int index, 
+value_of_child (struct varobj *parent, int index,
 		enum varobj_type_change *type_changed)
+{
+  struct gdb_stat_timer timer;
+  struct value *value;
+
+  gdb_stat_start (GDB_STAT_VAROBJ_EVAL, &timer);
+  value = compute_value_of_child (parent, index, type_changed);
+  gdb_stat_stop (GDB_STAT_VAROBJ_EVAL, &timer, 0);
+  return value;
+}
+/* APPLE LOCAL end gdb stats  */
+
+static struct value *
+compute_value_of_child (struct varobj *parent, int index, 
+			enum varobj_type_change *type_changed)
 {
   struct value *value;
   struct varobj *child;
@@ -4615,6 +5053,18 @@ Set to run all threads when evaluating varobjs."), NULL,
 			   &setlist, &showlist);
   /* APPLE LOCAL end varobj */
 
+  /* APPLE LOCAL begin incremental varobj update  */
+  add_setshow_boolean_cmd ("varobj-incremental-update", class_obscure,
+			   &varobj_incremental_update, _("\
+Set if varobj updates skip children whose memory hasn't changed."), _("\
+Show if varobj updates skip children whose memory hasn't changed."), _("\
+When on, updating a variable object only computes a child again if its\n\
+parent changed or the memory the child was read from holds new bytes.\n\
+The memory of all the children is read back together."),
+			   NULL, NULL,
+			   &setlist, &showlist);
+  /* APPLE LOCAL end incremental varobj update  */
+
   add_setshow_zinteger_cmd ("varobj", class_maintenance,
 			    &varobjdebug, _("\
 Set varobj debugging."), _("\
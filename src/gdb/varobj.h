@@ -106,6 +106,10 @@ extern int varobj_get_num_children (struct varobj *var);
 extern int varobj_list_children (struct varobj *var,
 				 struct varobj ***childlist);
 
+/* APPLE LOCAL varobj child window  */
+extern int varobj_list_children_range (struct varobj *var, int from, int to,
+				       struct varobj ***childlist);
+
 extern int varobj_is_fake_child (struct varobj *var);
 
 extern char *varobj_get_type (struct varobj *var);
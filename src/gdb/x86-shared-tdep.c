@@ -19,6 +19,8 @@
 #include "regcache.h"  /* register_size */
 #include "command.h"
 #include "gdbcmd.h"
+/* APPLE LOCAL prologue analysis cache  */
+#include "prologue-memo.h"
 
 #include "x86-shared-tdep.h"
 #include "i386-tdep.h"
@@ -1023,6 +1025,75 @@ x86_quickie_analyze_prologue (CORE_ADDR func_start_addr, CORE_ADDR limit,
   return func_start_addr;
 }
 
+/* APPLE LOCAL begin prologue analysis cache  */
+/* The fields of an x86_frame_cache that the prologue analyzers fill
+   in, as handed to prologue_memo_store.  The (still frame-relative)
+   SAVED_REGS array follows it, NUM_SAVEDREGS entries long.  */
+
+struct x86_prologue_memo
+{
+  CORE_ADDR func_start_addr;
+  CORE_ADDR scanned_limit;
+  int sp_offset;
+  int ebp_is_frame_pointer;
+  enum prologue_scan_state prologue_scan_status;
+};
+
+static size_t
+x86_prologue_memo_size (struct x86_frame_cache *cache)
+{
+  return sizeof (struct x86_prologue_memo)
+         + cache->num_savedregs * sizeof (CORE_ADDR);
+}
+
+/* Fill in CACHE from an earlier analysis of FUNC_START up to
+   CURRENT_PC, if we have one.  Returns 1 if we did.  */
+
+static int
+x86_prologue_memo_restore (struct x86_frame_cache *cache, CORE_ADDR func_start,
+                           CORE_ADDR current_pc, int potentially_frameless)
+{
+  size_t size = x86_prologue_memo_size (cache);
+  gdb_byte *buf = alloca (size);
+  struct x86_prologue_memo memo;
+
+  if (!prologue_memo_lookup (func_start, current_pc, potentially_frameless,
+                             buf, size))
+    return 0;
+
+  memcpy (&memo, buf, sizeof (memo));
+  cache->func_start_addr = memo.func_start_addr;
+  cache->scanned_limit = memo.scanned_limit;
+  cache->sp_offset = memo.sp_offset;
+  cache->ebp_is_frame_pointer = memo.ebp_is_frame_pointer;
+  cache->prologue_scan_status = memo.prologue_scan_status;
+  memcpy (cache->saved_regs, buf + sizeof (memo),
+          cache->num_savedregs * sizeof (CORE_ADDR));
+  return 1;
+}
+
+static void
+x86_prologue_memo_save (struct x86_frame_cache *cache, CORE_ADDR func_start,
+                        CORE_ADDR current_pc, int potentially_frameless)
+{
+  size_t size = x86_prologue_memo_size (cache);
+  gdb_byte *buf = alloca (size);
+  struct x86_prologue_memo memo;
+
+  memset (&memo, 0, sizeof (memo));
+  memo.func_start_addr = cache->func_start_addr;
+  memo.scanned_limit = cache->scanned_limit;
+  memo.sp_offset = cache->sp_offset;
+  memo.ebp_is_frame_pointer = cache->ebp_is_frame_pointer;
+  memo.prologue_scan_status = cache->prologue_scan_status;
+  memcpy (buf, &memo, sizeof (memo));
+  memcpy (buf + sizeof (memo), cache->saved_regs,
+          cache->num_savedregs * sizeof (CORE_ADDR));
+  prologue_memo_store (func_start, current_pc, potentially_frameless,
+                       buf, size);
+}
+/* APPLE LOCAL end prologue analysis cache  */
+
 struct x86_frame_cache *
 x86_frame_cache (struct frame_info *next_frame, void **this_cache, int wordsize)
 {
@@ -1030,6 +1101,8 @@ x86_frame_cache (struct frame_info *next_frame, void **this_cache, int wordsize)
   int potentially_frameless;
   CORE_ADDR prologue_parsed_to = 0;
   CORE_ADDR current_pc;
+  /* APPLE LOCAL prologue analysis cache  */
+  CORE_ADDR func_start;
 
   if (*this_cache)
     return *this_cache;
@@ -1049,6 +1122,8 @@ x86_frame_cache (struct frame_info *next_frame, void **this_cache, int wordsize)
 
   cache->func_start_addr = frame_func_unwind (next_frame);
   cache->pc = current_pc;
+  /* APPLE LOCAL prologue analysis cache  */
+  func_start = cache->func_start_addr;
 
   /* The nuggets of code that constitute the ObjC trampolines confuse us.
      However, we know that they are in fact little frameless jumps, so we
@@ -1091,17 +1166,30 @@ x86_frame_cache (struct frame_info *next_frame, void **this_cache, int wordsize)
       return cache;
     }
 
-  prologue_parsed_to = x86_quickie_analyze_prologue (cache->func_start_addr, 
-                                     current_pc, cache, potentially_frameless);
-
-  if (cache->prologue_scan_status == quick_scan_failed)
+  /* APPLE LOCAL begin prologue analysis cache  */
+  /* The analysis only depends on the function's text, so if we've
+     been through this function at this pc before, reuse what we
+     found then.  */
+  if (!x86_prologue_memo_restore (cache, func_start, current_pc,
+                                  potentially_frameless))
     {
-      x86_initialize_frame_cache (cache, wordsize);
-      cache->func_start_addr = frame_func_unwind (next_frame);
-      cache->pc = frame_pc_unwind (next_frame);
-      prologue_parsed_to = x86_analyze_prologue (cache->func_start_addr,
-                                                 current_pc, cache);
+      prologue_parsed_to = x86_quickie_analyze_prologue
+                             (cache->func_start_addr, current_pc, cache,
+                              potentially_frameless);
+
+      if (cache->prologue_scan_status == quick_scan_failed)
+        {
+          x86_initialize_frame_cache (cache, wordsize);
+          cache->func_start_addr = frame_func_unwind (next_frame);
+          cache->pc = frame_pc_unwind (next_frame);
+          prologue_parsed_to = x86_analyze_prologue (cache->func_start_addr,
+                                                     current_pc, cache);
+        }
+
+      x86_prologue_memo_save (cache, func_start, current_pc,
+                              potentially_frameless);
     }
+  /* APPLE LOCAL end prologue analysis cache  */
 
   /* If this can't be a frameless function but the i386_analyze_prologue
      claims that it is, then we obviously have a problem.  Either this
@@ -27,6 +27,8 @@
 #include "opintl.h"
 #include "safe-ctype.h"
 #include "floatformat.h"
+/* APPLE LOCAL opcode index  */
+#include "libiberty.h"
 
 /* FIXME: This shouldn't be done here.  */
 #include "coff/internal.h"
@@ -1518,6 +1520,135 @@ enum map_type {
 
 enum map_type last_type;
 int last_mapping_sym = -1;
+
+/* APPLE LOCAL begin opcode index  */
+/* The opcode tables are searched in order for the first entry that
+   matches, which can mean trying a few hundred entries for a single
+   instruction.  So that only the entries that might match are tried,
+   each table gets an index, built the first time it is used, on a few
+   bits that almost every entry's mask covers.  For each value of those
+   key bits the index has a list, in table order, of the entries whose
+   value agrees with it in every key bit their mask covers, ended by
+   OPCODE_INDEX_END.  */
+
+#define OPCODE_INDEX_END 0xffff
+
+struct opcode_index
+{
+  /* The table being indexed; just one of these is set.  */
+  const struct opcode32 *table32;
+  const struct opcode16 *table16;
+
+  /* The key bits, which must be contiguous, and the position of the
+     lowest of them.  */
+  unsigned long key_mask;
+  int key_shift;
+
+  /* The list for each key value, or NULL until the index is built.  */
+  unsigned short **buckets;
+};
+
+static struct opcode_index coprocessor_index =
+  { coprocessor_opcodes, NULL, 0x0ff00000, 20, NULL };
+static struct opcode_index neon_index =
+  { neon_opcodes, NULL, 0x0ff00000, 20, NULL };
+static struct opcode_index arm_index =
+  { arm_opcodes, NULL, 0x0ff00000, 20, NULL };
+static struct opcode_index thumb16_index =
+  { NULL, thumb_opcodes, 0xfc00, 10, NULL };
+static struct opcode_index thumb32_index =
+  { thumb32_opcodes, NULL, 0x1ff00000, 20, NULL };
+
+/* Store the value and mask of entry I of INDEX's table in *VALUE and
+   *MASK.  Return FALSE if entry I is the table's terminator.  */
+
+static bfd_boolean
+opcode_index_entry (const struct opcode_index *index, int i,
+		    unsigned long *value, unsigned long *mask)
+{
+  if (index->table32 != NULL)
+    {
+      *value = index->table32[i].value;
+      *mask = index->table32[i].mask;
+      return index->table32[i].assembler != NULL;
+    }
+
+  *value = index->table16[i].value;
+  *mask = index->table16[i].mask;
+  return index->table16[i].assembler != NULL;
+}
+
+static void
+build_opcode_index (struct opcode_index *index)
+{
+  unsigned long nkeys = (index->key_mask >> index->key_shift) + 1;
+  unsigned long key, value, mask;
+  unsigned short *list;
+  size_t total = 0;
+  int pass, i;
+
+  /* Count the list entries on the first pass, fill them in on the
+     second.  */
+  list = NULL;
+  for (pass = 0; pass < 2; pass++)
+    {
+      if (pass == 1)
+	{
+	  index->buckets = xmalloc (nkeys * sizeof (unsigned short *));
+	  list = xmalloc (total * sizeof (unsigned short));
+	}
+
+      for (key = 0; key < nkeys; key++)
+	{
+	  unsigned long bits = key << index->key_shift;
+
+	  if (pass == 1)
+	    index->buckets[key] = list;
+	  for (i = 0; opcode_index_entry (index, i, &value, &mask); i++)
+	    if (((value ^ bits) & mask & index->key_mask) == 0)
+	      {
+		if (pass == 0)
+		  total++;
+		else
+		  *list++ = i;
+	      }
+	  if (pass == 0)
+	    total++;
+	  else
+	    *list++ = OPCODE_INDEX_END;
+	}
+    }
+}
+
+/* Return the list of the entries in INDEX's table that might match
+   GIVEN.  */
+
+static const unsigned short *
+opcode_index_lookup (struct opcode_index *index, unsigned long given)
+{
+  if (index->buckets == NULL)
+    build_opcode_index (index);
+  return index->buckets[(given & index->key_mask) >> index->key_shift];
+}
+
+/* Return the position of the first iWMMXt instruction in
+   coprocessor_opcodes.  The IWMMXT_INSN_COUNT entries from there on
+   are skipped unless disassembling for an XScale or iWMMXt.  */
+
+static int
+first_iwmmxt_opcode (void)
+{
+  static int first = -1;
+
+  if (first < 0)
+    {
+      for (first = 0; coprocessor_opcodes[first].assembler; first++)
+	if (coprocessor_opcodes[first].value == FIRST_IWMMXT_INSN)
+	  break;
+    }
+  return first;
+}
+/* APPLE LOCAL end opcode index  */
 bfd_vma last_mapping_addr = 0;
 
 
@@ -1642,14 +1773,22 @@ print_insn_coprocessor (bfd_vma pc, struct disassemble_info *info, long given,
   unsigned long mask;
   unsigned long value;
   int cond;
+  /* APPLE LOCAL begin opcode index  */
+  const unsigned short *cand;
+  int first_iwmmxt = first_iwmmxt_opcode ();
 
-  for (insn = coprocessor_opcodes; insn->assembler; insn++)
+  for (cand = opcode_index_lookup (&coprocessor_index, given);
+       *cand != OPCODE_INDEX_END;
+       cand++)
     {
-      if (insn->value == FIRST_IWMMXT_INSN
+      insn = coprocessor_opcodes + *cand;
+      if (*cand >= first_iwmmxt
+	  && *cand < first_iwmmxt + IWMMXT_INSN_COUNT
 	  && info->mach != bfd_mach_arm_XScale
 	  && info->mach != bfd_mach_arm_iWMMXt
 	  && info->mach != bfd_mach_arm_iWMMXt2)
-	insn = insn + IWMMXT_INSN_COUNT;
+	continue;
+      /* APPLE LOCAL end opcode index  */
 
       mask = insn->mask;
       value = insn->value;
@@ -2226,6 +2365,8 @@ static bfd_boolean
 print_insn_neon (struct disassemble_info *info, long given, bfd_boolean thumb)
 {
   const struct opcode32 *insn;
+  /* APPLE LOCAL opcode index  */
+  const unsigned short *cand;
   void *stream = info->stream;
   fprintf_ftype func = info->fprintf_func;
 
@@ -2248,8 +2389,13 @@ print_insn_neon (struct disassemble_info *info, long given, bfd_boolean thumb)
 	return FALSE;
     }
   
-  for (insn = neon_opcodes; insn->assembler; insn++)
+  /* APPLE LOCAL begin opcode index  */
+  for (cand = opcode_index_lookup (&neon_index, given);
+       *cand != OPCODE_INDEX_END;
+       cand++)
     {
+      insn = neon_opcodes + *cand;
+      /* APPLE LOCAL end opcode index  */
       if ((given & insn->mask) == insn->value)
 	{
 	  const char *c;
@@ -2683,6 +2829,8 @@ static void
 print_insn_arm (bfd_vma pc, struct disassemble_info *info, long given)
 {
   const struct opcode32 *insn;
+  /* APPLE LOCAL opcode index  */
+  const unsigned short *cand;
   void *stream = info->stream;
   fprintf_ftype func = info->fprintf_func;
 
@@ -2694,12 +2842,14 @@ print_insn_arm (bfd_vma pc, struct disassemble_info *info, long given)
 
   if (show_opcode_bytes)
     func (stream, "%8.8x ", given);
-  for (insn = arm_opcodes; insn->assembler; insn++)
+  /* APPLE LOCAL begin opcode index: There are no iWMMXt instructions
+     in arm_opcodes, so there is nothing to skip here.  */
+  for (cand = opcode_index_lookup (&arm_index, given);
+       *cand != OPCODE_INDEX_END;
+       cand++)
     {
-      if (insn->value == FIRST_IWMMXT_INSN
-	  && info->mach != bfd_mach_arm_XScale
-	  && info->mach != bfd_mach_arm_iWMMXt)
-	insn = insn + IWMMXT_INSN_COUNT;
+      insn = arm_opcodes + *cand;
+      /* APPLE LOCAL end opcode index  */
 
       if ((given & insn->mask) == insn->value
 	  /* Special case: an instruction with all bits set in the condition field
@@ -3045,12 +3195,19 @@ static void
 print_insn_thumb16 (bfd_vma pc, struct disassemble_info *info, long given)
 {
   const struct opcode16 *insn;
+  /* APPLE LOCAL opcode index  */
+  const unsigned short *cand;
   void *stream = info->stream;
   fprintf_ftype func = info->fprintf_func;
 
   if (show_opcode_bytes)
     func (stream, "%4.4x     ", given);
-  for (insn = thumb_opcodes; insn->assembler; insn++)
+  /* APPLE LOCAL begin opcode index  */
+  for (cand = opcode_index_lookup (&thumb16_index, given);
+       (*cand != OPCODE_INDEX_END
+	&& (insn = thumb_opcodes + *cand) != NULL);
+       cand++)
+    /* APPLE LOCAL end opcode index  */
     if ((given & insn->mask) == insn->value)
       {
 	const char *c = insn->assembler;
@@ -3330,6 +3487,8 @@ static void
 print_insn_thumb32 (bfd_vma pc, struct disassemble_info *info, long given)
 {
   const struct opcode32 *insn;
+  /* APPLE LOCAL opcode index  */
+  const unsigned short *cand;
   void *stream = info->stream;
   fprintf_ftype func = info->fprintf_func;
 
@@ -3341,7 +3500,12 @@ print_insn_thumb32 (bfd_vma pc, struct disassemble_info *info, long given)
 
   if (show_opcode_bytes)
     func (stream, "%8.8x ", given);
-  for (insn = thumb32_opcodes; insn->assembler; insn++)
+  /* APPLE LOCAL begin opcode index  */
+  for (cand = opcode_index_lookup (&thumb32_index, given);
+       (*cand != OPCODE_INDEX_END
+	&& (insn = thumb32_opcodes + *cand) != NULL);
+       cand++)
+    /* APPLE LOCAL end opcode index  */
     if ((given & insn->mask) == insn->value)
       {
 	const char *c = insn->assembler;
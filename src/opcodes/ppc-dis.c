@@ -125,6 +125,33 @@ print_insn_rs6000 (bfd_vma memaddr, struct disassemble_info *info)
   return print_insn_powerpc (memaddr, info, 1, PPC_OPCODE_POWER);
 }
 
+/* APPLE LOCAL begin opcode index  */
+/* powerpc_opcodes is sorted on the major opcode.  The entries for
+   major opcode OP are the ones from POWERPC_OPCD_INDICES[OP] up to
+   POWERPC_OPCD_INDICES[OP + 1].  Filled in on first use.  */
+
+#define PPC_OPCD_SEGS 64
+
+static int powerpc_opcd_indices[PPC_OPCD_SEGS + 1];
+static int powerpc_opcd_indices_built;
+
+static void
+build_powerpc_opcd_indices (void)
+{
+  unsigned long op;
+  int i = 0;
+
+  for (op = 0; op <= PPC_OPCD_SEGS; op++)
+    {
+      while (i < powerpc_num_opcodes
+	     && PPC_OP (powerpc_opcodes[i].opcode) < op)
+	i++;
+      powerpc_opcd_indices[op] = i;
+    }
+  powerpc_opcd_indices_built = 1;
+}
+/* APPLE LOCAL end opcode index  */
+
 /* Print a PowerPC or POWER instruction.  */
 
 static int
@@ -158,25 +185,23 @@ print_insn_powerpc (bfd_vma memaddr,
   /* Get the major opcode of the instruction.  */
   op = PPC_OP (insn);
 
-  /* Find the first match in the opcode table.  We could speed this up
-     a bit by doing a binary search on the major opcode.  */
-  opcode_end = powerpc_opcodes + powerpc_num_opcodes;
+  /* Find the first match in the opcode table.  */
+  /* APPLE LOCAL opcode index: Only look at the entries with the
+     same major opcode.  */
+  if (!powerpc_opcd_indices_built)
+    build_powerpc_opcd_indices ();
+  opcode_end = powerpc_opcodes + powerpc_opcd_indices[op + 1];
  again:
-  for (opcode = powerpc_opcodes; opcode < opcode_end; opcode++)
+  for (opcode = powerpc_opcodes + powerpc_opcd_indices[op];
+       opcode < opcode_end;
+       opcode++)
     {
-      unsigned long table_op;
       const unsigned char *opindex;
       const struct powerpc_operand *operand;
       int invalid;
       int need_comma;
       int need_paren;
 
-      table_op = PPC_OP (opcode->opcode);
-      if (op < table_op)
-	break;
-      if (op > table_op)
-	continue;
-
       if ((insn & opcode->mask) != opcode->opcode
 	  || (opcode->flags & dialect) == 0)
 	continue;